@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Timer.h>
+
+/// Timing state of one benchmark run. The benchmark function does its setup first and then loops while KeepRunning() returns true; only the loop is timed.
+class BenchmarkState
+{
+public:
+    /// Construct with the number of iterations to run.
+    explicit BenchmarkState(unsigned iterations) :
+        iterations_(iterations),
+        remaining_(iterations),
+        elapsedUSec_(0),
+        started_(false)
+    {
+    }
+
+    /// Return whether to run another iteration. Starts the timer on the first call and stops it after the last iteration.
+    bool KeepRunning()
+    {
+        if (!started_)
+        {
+            started_ = true;
+            timer_.Reset();
+        }
+
+        if (remaining_)
+        {
+            --remaining_;
+            return true;
+        }
+
+        elapsedUSec_ = timer_.GetUSec(false);
+        return false;
+    }
+
+    /// Return number of iterations.
+    unsigned GetIterations() const { return iterations_; }
+    /// Return time spent in the loop in microseconds.
+    long long GetElapsedUSec() const { return elapsedUSec_; }
+
+private:
+    /// High-resolution timer.
+    Urho3D::HiresTimer timer_;
+    /// Number of iterations.
+    unsigned iterations_;
+    /// Iterations left.
+    unsigned remaining_;
+    /// Time spent in the loop.
+    long long elapsedUSec_;
+    /// Loop started flag.
+    bool started_;
+};
+
+/// Benchmark function.
+using BenchmarkFunction = void (*)(BenchmarkState& state);
+
+/// Register a benchmark. Called by the URHO3D_BENCHMARK macro at static initialization.
+int RegisterBenchmark(const char* name, BenchmarkFunction function);
+
+/// Prevent the compiler from optimizing away the computation of a value.
+template <class T> inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/// Prevent the compiler from assuming that memory is unchanged between iterations.
+inline void ClobberMemory()
+{
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/// Define and register a benchmark function.
+#define URHO3D_BENCHMARK(name) \
+    static void name(BenchmarkState& state); \
+    static int name##Registration = RegisterBenchmark(#name, name); \
+    static void name(BenchmarkState& state)
@@ -0,0 +1,305 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+#include "Benchmark.h"
+#include "SceneBenchmark.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdio>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Registered benchmark.
+struct BenchmarkInfo
+{
+    /// Name.
+    const char* name_;
+    /// Function.
+    BenchmarkFunction function_;
+};
+
+/// Measured result of a benchmark.
+struct BenchmarkResult
+{
+    /// Name.
+    String name_;
+    /// Iterations per repetition.
+    unsigned iterations_;
+    /// Nanoseconds per iteration of each repetition, sorted.
+    PODVector<double> nsPerIteration_;
+};
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+
+/// Return the registered benchmarks. A function-local static so that registration from other files does not depend on static initialization order.
+static PODVector<BenchmarkInfo>& GetBenchmarks()
+{
+    static PODVector<BenchmarkInfo> benchmarks;
+    return benchmarks;
+}
+
+int RegisterBenchmark(const char* name, BenchmarkFunction function)
+{
+    BenchmarkInfo info;
+    info.name_ = name;
+    info.function_ = function;
+    GetBenchmarks().Push(info);
+    return (int)GetBenchmarks().Size();
+}
+
+static bool CompareBenchmarks(const BenchmarkInfo& lhs, const BenchmarkInfo& rhs)
+{
+    return strcmp(lhs.name_, rhs.name_) < 0;
+}
+
+static double GetMedian(const PODVector<double>& sorted)
+{
+    unsigned size = sorted.Size();
+    return size % 2 ? sorted[size / 2] : (sorted[size / 2 - 1] + sorted[size / 2]) * 0.5;
+}
+
+static double GetMean(const PODVector<double>& values)
+{
+    double sum = 0.0;
+    for (unsigned i = 0; i < values.Size(); ++i)
+        sum += values[i];
+    return values.Size() ? sum / values.Size() : 0.0;
+}
+
+/// Find the number of iterations that runs for at least the minimum time, then time the repetitions with it.
+static BenchmarkResult RunBenchmark(const BenchmarkInfo& info, double minTime, unsigned repetitions)
+{
+    auto minUSec = (long long)(minTime * 1000000.0);
+    unsigned iterations = 1;
+
+    for (;;)
+    {
+        BenchmarkState state(iterations);
+        info.function_(state);
+        long long elapsed = state.GetElapsedUSec();
+        if (elapsed >= minUSec || iterations >= 1000000000U)
+            break;
+
+        // Aim slightly above the minimum time, but grow at most tenfold as the short runs are noisy
+        double multiplier = elapsed > 0 ? 1.4 * minUSec / elapsed : 10.0;
+        iterations = (unsigned)Min(iterations * Clamp(multiplier, 2.0, 10.0), 1000000000.0);
+    }
+
+    BenchmarkResult result;
+    result.name_ = info.name_;
+    result.iterations_ = iterations;
+    for (unsigned i = 0; i < repetitions; ++i)
+    {
+        BenchmarkState state(iterations);
+        info.function_(state);
+        result.nsPerIteration_.Push(state.GetElapsedUSec() * 1000.0 / iterations);
+    }
+    Sort(result.nsPerIteration_.Begin(), result.nsPerIteration_.End());
+
+    return result;
+}
+
+static bool SaveJSON(Context* context, const String& fileName, const Vector<BenchmarkResult>& results, double minTime,
+    unsigned repetitions)
+{
+    JSONFile json(context);
+    JSONValue& root = json.GetRoot();
+
+    JSONValue info;
+    info.Set("date", Time::GetTimeStamp());
+    info.Set("platform", GetPlatform());
+    info.Set("physicalCPUs", GetNumPhysicalCPUs());
+#ifdef NDEBUG
+    info.Set("buildType", "release");
+#else
+    info.Set("buildType", "debug");
+#endif
+#ifdef URHO3D_SSE
+    info.Set("sse", true);
+#else
+    info.Set("sse", false);
+#endif
+    info.Set("minTime", minTime);
+    info.Set("repetitions", repetitions);
+    root.Set("context", info);
+
+    JSONArray benchmarks;
+    for (unsigned i = 0; i < results.Size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        const PODVector<double>& times = result.nsPerIteration_;
+
+        JSONValue benchmark;
+        benchmark.Set("name", result.name_);
+        benchmark.Set("iterations", result.iterations_);
+        benchmark.Set("timeUnit", "ns");
+        benchmark.Set("median", GetMedian(times));
+        benchmark.Set("mean", GetMean(times));
+        benchmark.Set("min", times.Front());
+        benchmark.Set("max", times.Back());
+        benchmarks.Push(benchmark);
+    }
+    root.Set("benchmarks", benchmarks);
+
+    File file(context);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+    return json.Save(file, "  ");
+}
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    String filter;
+    String jsonFileName;
+    double minTime = 0.2;
+    unsigned repetitions = 5;
+    bool listOnly = false;
+    SceneBenchmarkSettings sceneSettings;
+    sceneSettings.frames_ = 300;
+    sceneSettings.gpu_ = false;
+    sceneSettings.replayFrame_ = M_MAX_UNSIGNED;
+    sceneSettings.simulate_ = false;
+
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        const String& arg = arguments[i];
+        bool hasValue = i + 1 < arguments.Size();
+
+        if (arg == "-filter" && hasValue)
+            filter = arguments[++i];
+        else if (arg == "-json" && hasValue)
+            jsonFileName = arguments[++i];
+        else if (arg == "-mintime" && hasValue)
+            minTime = Max(ToDouble(arguments[++i]), 0.001);
+        else if (arg == "-repetitions" && hasValue)
+            repetitions = Max(ToUInt(arguments[++i]), 1U);
+        else if (arg == "-list")
+            listOnly = true;
+        else if (arg == "-scene" && hasValue)
+            sceneSettings.sceneFileName_ = arguments[++i];
+        else if (arg == "-frames" && hasValue)
+            sceneSettings.frames_ = Max(ToUInt(arguments[++i]), 1U);
+        else if (arg == "-gpu")
+            sceneSettings.gpu_ = true;
+        else if (arg == "-record" && hasValue)
+            sceneSettings.recordFileName_ = arguments[++i];
+        else if (arg == "-replay" && hasValue)
+            sceneSettings.replayFileName_ = arguments[++i];
+        else if (arg == "-replayframe" && hasValue)
+            sceneSettings.replayFrame_ = ToUInt(arguments[++i]);
+        else if (arg == "-simulate")
+            sceneSettings.simulate_ = true;
+        else
+        {
+            ErrorExit("Usage: Benchmarks [options]\n\n"
+                "Options:\n"
+                "-filter <text>       Run only the benchmarks whose name contains the text\n"
+                "-json <file>         Write the results to a JSON file\n"
+                "-mintime <seconds>   Minimum duration of each timed repetition, default 0.2\n"
+                "-repetitions <n>     Number of timed repetitions, default 5\n"
+                "-list                List the benchmarks without running them\n"
+                "-scene <file>        Run the scene benchmark instead, \"builtin\" generates the default scene\n"
+                "-frames <n>          Number of frames of the scene benchmark, default 300\n"
+                "-gpu                 Render the scene benchmark through the graphics backend instead of headless\n"
+                "-record <file>       Record the measured frames of the scene benchmark to a scene capture file\n"
+                "-replay <file>       Run the scene benchmark on the frames of a scene capture file instead of a scene\n"
+                "-replayframe <n>     Replay only the given captured frame on every frame\n"
+                "-simulate            Update the scene after applying each replayed frame, to measure the simulation\n\n"
+                "Times are nanoseconds per iteration. The median of the repetitions is the number to compare across builds.\n"
+                "The scene benchmark reports the per-frame milliseconds of each profiling block.");
+        }
+    }
+
+    if (!sceneSettings.sceneFileName_.Empty() || !sceneSettings.replayFileName_.Empty())
+    {
+        sceneSettings.jsonFileName_ = jsonFileName;
+        RunSceneBenchmark(sceneSettings);
+        return;
+    }
+
+    // The Time subsystem sets up the high-resolution timer frequency
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new Time(context));
+
+    PODVector<BenchmarkInfo>& benchmarks = GetBenchmarks();
+    Sort(benchmarks.Begin(), benchmarks.End(), CompareBenchmarks);
+
+    Vector<BenchmarkResult> results;
+    char line[256];
+
+    if (!listOnly)
+    {
+        sprintf(line, "%-36s %12s %12s %12s %8s", "Benchmark", "Iterations", "Median ns", "Min ns", "Spread");
+        PrintLine(line);
+    }
+
+    for (unsigned i = 0; i < benchmarks.Size(); ++i)
+    {
+        if (!filter.Empty() && !String(benchmarks[i].name_).Contains(filter, false))
+            continue;
+
+        if (listOnly)
+        {
+            PrintLine(benchmarks[i].name_);
+            continue;
+        }
+
+        BenchmarkResult result = RunBenchmark(benchmarks[i], minTime, repetitions);
+        const PODVector<double>& times = result.nsPerIteration_;
+        double median = GetMedian(times);
+        double spread = median > 0.0 ? (times.Back() - times.Front()) / median * 100.0 : 0.0;
+        sprintf(line, "%-36s %12u %12.2f %12.2f %7.1f%%", result.name_.CString(), result.iterations_, median, times.Front(), spread);
+        PrintLine(line);
+
+        results.Push(result);
+    }
+
+    if (!jsonFileName.Empty() && !SaveJSON(context, jsonFileName, results, minTime, repetitions))
+        ErrorExit("Could not write " + jsonFileName);
+}
@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Variant.h>
+#include <Urho3D/Math/Random.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+// All inputs are generated from fixed seeds so that every build measures the same work
+
+static const unsigned NUM_ELEMENTS = 1000;
+static const unsigned NUM_SORT_ELEMENTS = 10000;
+
+static PODVector<int> GetRandomInts(unsigned count, unsigned seed)
+{
+    SetRandomSeed(seed);
+    PODVector<int> ret(count);
+    for (unsigned i = 0; i < count; ++i)
+        ret[i] = Rand() * 32768 + Rand();
+    return ret;
+}
+
+static Vector<String> GetRandomStrings(unsigned count, unsigned seed)
+{
+    SetRandomSeed(seed);
+    Vector<String> ret(count);
+    for (unsigned i = 0; i < count; ++i)
+        ret[i] = "Node" + String(Rand()) + "/Component" + String(i);
+    return ret;
+}
+
+URHO3D_BENCHMARK(PODVectorPushBack)
+{
+    while (state.KeepRunning())
+    {
+        PODVector<int> vector;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+            vector.Push(i);
+        DoNotOptimize(vector.Back());
+    }
+}
+
+URHO3D_BENCHMARK(PODVectorIterate)
+{
+    PODVector<int> vector = GetRandomInts(NUM_ELEMENTS, 1);
+    while (state.KeepRunning())
+    {
+        int sum = 0;
+        for (PODVector<int>::ConstIterator i = vector.Begin(); i != vector.End(); ++i)
+            sum += *i;
+        DoNotOptimize(sum);
+        ClobberMemory();
+    }
+}
+
+URHO3D_BENCHMARK(VectorPushBackString)
+{
+    Vector<String> strings = GetRandomStrings(NUM_ELEMENTS, 2);
+    while (state.KeepRunning())
+    {
+        Vector<String> vector;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+            vector.Push(strings[i]);
+        DoNotOptimize(vector.Back());
+    }
+}
+
+URHO3D_BENCHMARK(VectorInsertEraseFront)
+{
+    Vector<String> vector = GetRandomStrings(NUM_ELEMENTS, 3);
+    String value("Inserted");
+    while (state.KeepRunning())
+    {
+        vector.Insert(0, value);
+        vector.Erase(0);
+        DoNotOptimize(vector.Front());
+    }
+}
+
+URHO3D_BENCHMARK(HashMapInsertInt)
+{
+    PODVector<int> keys = GetRandomInts(NUM_ELEMENTS, 4);
+    while (state.KeepRunning())
+    {
+        HashMap<int, int> map;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+            map[keys[i]] = i;
+        DoNotOptimize(map.Size());
+    }
+}
+
+URHO3D_BENCHMARK(HashMapFindInt)
+{
+    PODVector<int> keys = GetRandomInts(NUM_ELEMENTS, 5);
+    HashMap<int, int> map;
+    for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+        map[keys[i]] = i;
+
+    while (state.KeepRunning())
+    {
+        int sum = 0;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+        {
+            HashMap<int, int>::ConstIterator it = map.Find(keys[i]);
+            if (it != map.End())
+                sum += it->second_;
+        }
+        DoNotOptimize(sum);
+    }
+}
+
+URHO3D_BENCHMARK(HashMapFindString)
+{
+    Vector<String> keys = GetRandomStrings(NUM_ELEMENTS, 6);
+    HashMap<String, int> map;
+    for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+        map[keys[i]] = i;
+
+    while (state.KeepRunning())
+    {
+        int sum = 0;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+        {
+            HashMap<String, int>::ConstIterator it = map.Find(keys[i]);
+            if (it != map.End())
+                sum += it->second_;
+        }
+        DoNotOptimize(sum);
+    }
+}
+
+URHO3D_BENCHMARK(HashMapIterate)
+{
+    PODVector<int> keys = GetRandomInts(NUM_ELEMENTS, 7);
+    HashMap<int, int> map;
+    for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+        map[keys[i]] = i;
+
+    while (state.KeepRunning())
+    {
+        int sum = 0;
+        for (HashMap<int, int>::ConstIterator i = map.Begin(); i != map.End(); ++i)
+            sum += i->second_;
+        DoNotOptimize(sum);
+        ClobberMemory();
+    }
+}
+
+URHO3D_BENCHMARK(StringAppend)
+{
+    while (state.KeepRunning())
+    {
+        String str;
+        for (unsigned i = 0; i < 100; ++i)
+            str += "Append";
+        DoNotOptimize(str.Length());
+    }
+}
+
+URHO3D_BENCHMARK(StringCompare)
+{
+    Vector<String> strings = GetRandomStrings(NUM_ELEMENTS, 8);
+    Vector<String> copies = strings;
+    while (state.KeepRunning())
+    {
+        unsigned equal = 0;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+            equal += strings[i] == copies[i];
+        DoNotOptimize(equal);
+    }
+}
+
+URHO3D_BENCHMARK(StringToHash)
+{
+    Vector<String> strings = GetRandomStrings(NUM_ELEMENTS, 9);
+    while (state.KeepRunning())
+    {
+        unsigned hash = 0;
+        for (unsigned i = 0; i < NUM_ELEMENTS; ++i)
+            hash ^= strings[i].ToHash();
+        DoNotOptimize(hash);
+    }
+}
+
+URHO3D_BENCHMARK(StringFind)
+{
+    String str;
+    for (unsigned i = 0; i < 100; ++i)
+        str += "Haystack";
+    str += "Needle";
+
+    while (state.KeepRunning())
+    {
+        DoNotOptimize(str.Find("Needle"));
+        ClobberMemory();
+    }
+}
+
+URHO3D_BENCHMARK(StringFromNumbers)
+{
+    while (state.KeepRunning())
+    {
+        unsigned length = 0;
+        for (int i = 0; i < 100; ++i)
+            length += String(i * 7919).Length() + String(i * 0.37f).Length();
+        DoNotOptimize(length);
+    }
+}
+
+URHO3D_BENCHMARK(SortInt)
+{
+    PODVector<int> source = GetRandomInts(NUM_SORT_ELEMENTS, 10);
+    PODVector<int> vector;
+    while (state.KeepRunning())
+    {
+        vector = source;
+        Sort(vector.Begin(), vector.End());
+        DoNotOptimize(vector.Front());
+    }
+}
+
+URHO3D_BENCHMARK(SortString)
+{
+    Vector<String> source = GetRandomStrings(NUM_ELEMENTS, 11);
+    Vector<String> vector;
+    while (state.KeepRunning())
+    {
+        vector = source;
+        Sort(vector.Begin(), vector.End());
+        DoNotOptimize(vector.Front());
+    }
+}
+
+URHO3D_BENCHMARK(VariantAssign)
+{
+    Variant variant;
+    String str("VariantString");
+    while (state.KeepRunning())
+    {
+        variant = 1;
+        variant = Vector3(1.0f, 2.0f, 3.0f);
+        variant = str;
+        variant = true;
+        DoNotOptimize(variant.GetType());
+    }
+}
+
+URHO3D_BENCHMARK(VariantMapFind)
+{
+    Vector<String> names = GetRandomStrings(NUM_ELEMENTS / 10, 12);
+    PODVector<StringHash> keys;
+    VariantMap map;
+    for (unsigned i = 0; i < names.Size(); ++i)
+    {
+        keys.Push(StringHash(names[i]));
+        map[keys.Back()] = (int)i;
+    }
+
+    while (state.KeepRunning())
+    {
+        int sum = 0;
+        for (unsigned i = 0; i < keys.Size(); ++i)
+        {
+            VariantMap::ConstIterator it = map.Find(keys[i]);
+            if (it != map.End())
+                sum += it->second_.GetInt();
+        }
+        DoNotOptimize(sum);
+    }
+}
@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Math/BoundingBox.h>
+#include <Urho3D/Math/Matrix3x4.h>
+#include <Urho3D/Math/Random.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+// The operands cycle through small arrays that stay in the cache, so the benchmarks measure the arithmetic
+
+static const unsigned NUM_OPERANDS = 64;
+
+static PODVector<Vector3> GetRandomVectors(unsigned seed)
+{
+    SetRandomSeed(seed);
+    PODVector<Vector3> ret(NUM_OPERANDS);
+    for (unsigned i = 0; i < NUM_OPERANDS; ++i)
+        ret[i] = Vector3(Random(-100.0f, 100.0f), Random(-100.0f, 100.0f), Random(-100.0f, 100.0f));
+    return ret;
+}
+
+static PODVector<Quaternion> GetRandomRotations(unsigned seed)
+{
+    SetRandomSeed(seed);
+    PODVector<Quaternion> ret(NUM_OPERANDS);
+    for (unsigned i = 0; i < NUM_OPERANDS; ++i)
+        ret[i] = Quaternion(Random(360.0f), Random(360.0f), Random(360.0f));
+    return ret;
+}
+
+static PODVector<Matrix3x4> GetRandomTransforms(unsigned seed)
+{
+    PODVector<Vector3> translations = GetRandomVectors(seed);
+    PODVector<Quaternion> rotations = GetRandomRotations(seed + 1);
+    PODVector<Matrix3x4> ret(NUM_OPERANDS);
+    for (unsigned i = 0; i < NUM_OPERANDS; ++i)
+        ret[i] = Matrix3x4(translations[i], rotations[i], Vector3(1.0f, 2.0f, 0.5f));
+    return ret;
+}
+
+URHO3D_BENCHMARK(Matrix3x4Multiply)
+{
+    PODVector<Matrix3x4> matrices = GetRandomTransforms(1);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Matrix3x4 result = matrices[index & (NUM_OPERANDS - 1)] * matrices[(index + 1) & (NUM_OPERANDS - 1)];
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(Matrix3x4TransformVector)
+{
+    PODVector<Matrix3x4> matrices = GetRandomTransforms(3);
+    PODVector<Vector3> vectors = GetRandomVectors(5);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Vector3 result = matrices[index & (NUM_OPERANDS - 1)] * vectors[(index + 7) & (NUM_OPERANDS - 1)];
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(Matrix3x4Inverse)
+{
+    PODVector<Matrix3x4> matrices = GetRandomTransforms(6);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Matrix3x4 result = matrices[index & (NUM_OPERANDS - 1)].Inverse();
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(Matrix3x4FromTransform)
+{
+    PODVector<Vector3> translations = GetRandomVectors(8);
+    PODVector<Quaternion> rotations = GetRandomRotations(9);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Matrix3x4 result(translations[index & (NUM_OPERANDS - 1)], rotations[(index + 3) & (NUM_OPERANDS - 1)], 1.5f);
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(Matrix3x4Decompose)
+{
+    PODVector<Matrix3x4> matrices = GetRandomTransforms(10);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Vector3 translation;
+        Quaternion rotation;
+        Vector3 scale;
+        matrices[index & (NUM_OPERANDS - 1)].Decompose(translation, rotation, scale);
+        DoNotOptimize(rotation);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(Matrix4Multiply)
+{
+    PODVector<Matrix3x4> transforms = GetRandomTransforms(12);
+    PODVector<Matrix4> matrices(NUM_OPERANDS);
+    for (unsigned i = 0; i < NUM_OPERANDS; ++i)
+        matrices[i] = transforms[i].ToMatrix4();
+
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Matrix4 result = matrices[index & (NUM_OPERANDS - 1)] * matrices[(index + 1) & (NUM_OPERANDS - 1)];
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(QuaternionMultiply)
+{
+    PODVector<Quaternion> rotations = GetRandomRotations(14);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Quaternion result = rotations[index & (NUM_OPERANDS - 1)] * rotations[(index + 1) & (NUM_OPERANDS - 1)];
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(QuaternionRotateVector)
+{
+    PODVector<Quaternion> rotations = GetRandomRotations(15);
+    PODVector<Vector3> vectors = GetRandomVectors(16);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Vector3 result = rotations[index & (NUM_OPERANDS - 1)] * vectors[(index + 5) & (NUM_OPERANDS - 1)];
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(QuaternionSlerp)
+{
+    PODVector<Quaternion> rotations = GetRandomRotations(17);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        Quaternion result = rotations[index & (NUM_OPERANDS - 1)].Slerp(rotations[(index + 1) & (NUM_OPERANDS - 1)], 0.3f);
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(QuaternionFromEulerAngles)
+{
+    PODVector<Vector3> angles = GetRandomVectors(18);
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        const Vector3& angle = angles[index & (NUM_OPERANDS - 1)];
+        Quaternion result(angle.x_, angle.y_, angle.z_);
+        DoNotOptimize(result);
+        ++index;
+    }
+}
+
+URHO3D_BENCHMARK(BoundingBoxTransformed)
+{
+    PODVector<Matrix3x4> matrices = GetRandomTransforms(19);
+    BoundingBox box(Vector3(-1.0f, -2.0f, -3.0f), Vector3(3.0f, 2.0f, 1.0f));
+    unsigned index = 0;
+    while (state.KeepRunning())
+    {
+        BoundingBox result = box.Transformed(matrices[index & (NUM_OPERANDS - 1)]);
+        DoNotOptimize(result);
+        ++index;
+    }
+}
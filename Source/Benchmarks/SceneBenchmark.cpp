@@ -0,0 +1,747 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/AnimationController.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/Graphics.h>
+#ifdef URHO3D_NULL_GRAPHICS
+#include <Urho3D/Graphics/GraphicsImpl.h>
+#endif
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/SceneCapture.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "SceneBenchmark.h"
+
+#include <cstdio>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Fixed time step of the benchmark frames, so that animation advances the same way on every run.
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+/// Frames run before the measurement to let animations, octree placement and resource loading settle.
+static const unsigned WARMUP_FRAMES = 10;
+
+/// Batch key of the headless view. Mirrors how the renderer groups batches by state and then sorts by distance.
+struct HeadlessBatch
+{
+    /// State key from the material and geometry.
+    unsigned long long sortKey_;
+    /// Distance from the camera.
+    float distance_;
+};
+
+static bool CompareHeadlessBatches(const HeadlessBatch& lhs, const HeadlessBatch& rhs)
+{
+    return lhs.sortKey_ != rhs.sortKey_ ? lhs.sortKey_ < rhs.sortKey_ : lhs.distance_ < rhs.distance_;
+}
+
+/// CPU stages of View::Update without a graphics backend: visibility culling, light queries, batch collection, sorting
+/// and geometry updates. The profiling blocks use the same names as View so that the results are comparable.
+class HeadlessView : public Object
+{
+    URHO3D_OBJECT(HeadlessView, Object);
+
+public:
+    /// Construct.
+    explicit HeadlessView(Context* context) :
+        Object(context),
+        numFrames_(0),
+        numGeometries_(0),
+        numLights_(0),
+        numLitGeometries_(0),
+        numBatches_(0)
+    {
+    }
+
+    /// Update the view for one frame.
+    void Update(Octree* octree, Camera* camera, FrameInfo frame)
+    {
+        URHO3D_PROFILE(UpdateViews);
+
+        frame.camera_ = camera;
+        octree->Update(frame);
+
+        GetDrawables(octree, camera, frame);
+        ProcessLights(octree, frame);
+        GetBaseBatches();
+        SortAndUpdateGeometry(frame);
+
+        ++numFrames_;
+        numGeometries_ += geometries_.Size();
+        numLights_ += lights_.Size();
+    }
+
+    /// Return average number of visible geometries per frame.
+    float GetAverageGeometries() const { return numFrames_ ? (float)numGeometries_ / numFrames_ : 0.0f; }
+    /// Return average number of visible lights per frame.
+    float GetAverageLights() const { return numFrames_ ? (float)numLights_ / numFrames_ : 0.0f; }
+    /// Return average number of lit geometries per frame, counted once per light.
+    float GetAverageLitGeometries() const { return numFrames_ ? (float)numLitGeometries_ / numFrames_ : 0.0f; }
+    /// Return average number of base and lit batches per frame.
+    float GetAverageBatches() const { return numFrames_ ? (float)numBatches_ / numFrames_ : 0.0f; }
+    /// Reset the statistics.
+    void ResetStatistics() { numFrames_ = numGeometries_ = numLights_ = numLitGeometries_ = numBatches_ = 0; }
+
+private:
+    /// Query the drawables in the camera frustum and update their batches.
+    void GetDrawables(Octree* octree, Camera* camera, const FrameInfo& frame)
+    {
+        URHO3D_PROFILE(GetDrawables);
+
+        FrustumOctreeQuery query(drawables_, camera->GetFrustum(), DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, camera->GetViewMask());
+        octree->GetDrawables(query);
+
+        geometries_.Clear();
+        lights_.Clear();
+        for (PODVector<Drawable*>::Iterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+            {
+                drawable->UpdateBatches(frame);
+                drawable->MarkInView(frame);
+                geometries_.Push(drawable);
+            }
+            else
+            {
+                drawable->MarkInView(frame);
+                lights_.Push(static_cast<Light*>(drawable));
+            }
+        }
+    }
+
+    /// Query the geometries lit by each visible light and collect the lit batches.
+    void ProcessLights(Octree* octree, const FrameInfo& frame)
+    {
+        URHO3D_PROFILE(ProcessLights);
+
+        litBatches_.Clear();
+        for (unsigned i = 0; i < lights_.Size(); ++i)
+        {
+            Light* light = lights_[i];
+
+            switch (light->GetLightType())
+            {
+            case LIGHT_DIRECTIONAL:
+                litGeometries_ = geometries_;
+                break;
+
+            case LIGHT_SPOT:
+                {
+                    FrustumOctreeQuery query(litGeometries_, light->GetFrustum(), DRAWABLE_GEOMETRY, frame.camera_->GetViewMask());
+                    octree->GetDrawables(query);
+                }
+                break;
+
+            case LIGHT_POINT:
+                {
+                    SphereOctreeQuery query(litGeometries_, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
+                        DRAWABLE_GEOMETRY, frame.camera_->GetViewMask());
+                    octree->GetDrawables(query);
+                }
+                break;
+            }
+
+            for (PODVector<Drawable*>::Iterator j = litGeometries_.Begin(); j != litGeometries_.End(); ++j)
+            {
+                Drawable* drawable = *j;
+                if (!drawable->IsInView(frame) || !(drawable->GetLightMask() & light->GetLightMask()))
+                    continue;
+
+                ++numLitGeometries_;
+                AddBatches(litBatches_, drawable, i + 1);
+            }
+        }
+    }
+
+    /// Collect the base batches of the visible geometries.
+    void GetBaseBatches()
+    {
+        URHO3D_PROFILE(GetBaseBatches);
+
+        baseBatches_.Clear();
+        for (PODVector<Drawable*>::Iterator i = geometries_.Begin(); i != geometries_.End(); ++i)
+            AddBatches(baseBatches_, *i, 0);
+
+        numBatches_ += baseBatches_.Size() + litBatches_.Size();
+    }
+
+    /// Sort the batches and update the geometries that need it.
+    void SortAndUpdateGeometry(const FrameInfo& frame)
+    {
+        URHO3D_PROFILE(SortAndUpdateGeometry);
+
+        Sort(baseBatches_.Begin(), baseBatches_.End(), CompareHeadlessBatches);
+        Sort(litBatches_.Begin(), litBatches_.End(), CompareHeadlessBatches);
+
+        for (PODVector<Drawable*>::Iterator i = geometries_.Begin(); i != geometries_.End(); ++i)
+        {
+            if ((*i)->GetUpdateGeometryType() != UPDATE_NONE)
+                (*i)->UpdateGeometry(frame);
+        }
+    }
+
+    /// Add the drawable's batches to a batch queue.
+    void AddBatches(PODVector<HeadlessBatch>& dest, Drawable* drawable, unsigned lightIndex)
+    {
+        const Vector<SourceBatch>& batches = drawable->GetBatches();
+        for (unsigned i = 0; i < batches.Size(); ++i)
+        {
+            const SourceBatch& srcBatch = batches[i];
+            if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_)
+                continue;
+
+            HeadlessBatch batch;
+            batch.sortKey_ = ((unsigned long long)(MakeHash(srcBatch.material_.Get()) + lightIndex) << 32u) |
+                MakeHash(srcBatch.geometry_);
+            batch.distance_ = srcBatch.distance_;
+            dest.Push(batch);
+        }
+    }
+
+    /// Drawables in the camera frustum.
+    PODVector<Drawable*> drawables_;
+    /// Visible geometries.
+    PODVector<Drawable*> geometries_;
+    /// Visible lights.
+    PODVector<Light*> lights_;
+    /// Geometries of the light being processed.
+    PODVector<Drawable*> litGeometries_;
+    /// Base batches.
+    PODVector<HeadlessBatch> baseBatches_;
+    /// Lit batches.
+    PODVector<HeadlessBatch> litBatches_;
+    /// Number of updated frames.
+    unsigned numFrames_;
+    /// Accumulated number of visible geometries.
+    unsigned long long numGeometries_;
+    /// Accumulated number of visible lights.
+    unsigned long long numLights_;
+    /// Accumulated number of lit geometries.
+    unsigned long long numLitGeometries_;
+    /// Accumulated number of batches.
+    unsigned long long numBatches_;
+};
+
+/// Per-frame times of one profiling block.
+struct StageTimes
+{
+    /// Block name.
+    String name_;
+    /// Depth in the profiling tree.
+    unsigned depth_{};
+    /// Time on each measured frame in milliseconds. Frames before the block first ran are missing.
+    PODVector<float> frameMs_;
+    /// Total calls.
+    unsigned long long calls_{};
+};
+
+/// Record the previous frame's time of each profiling block.
+static void RecordStages(const ProfilerBlock* block, unsigned depth, HashMap<const ProfilerBlock*, StageTimes>& stages)
+{
+    StageTimes& stage = stages[block];
+    if (stage.name_.Empty())
+    {
+        stage.name_ = block->name_;
+        stage.depth_ = depth;
+    }
+    stage.frameMs_.Push(block->frameTime_ / 1000.0f);
+    stage.calls_ += block->frameCount_;
+
+    for (unsigned i = 0; i < block->children_.Size(); ++i)
+        RecordStages(block->children_[i], depth + 1, stages);
+}
+
+/// Collect the recorded blocks in profiling tree order.
+static void CollectStages(const ProfilerBlock* block, const HashMap<const ProfilerBlock*, StageTimes>& stages,
+    PODVector<const StageTimes*>& dest)
+{
+    HashMap<const ProfilerBlock*, StageTimes>::ConstIterator i = stages.Find(block);
+    if (i == stages.End())
+        return;
+
+    // Skip the blocks that never ran during the measurement, such as the ones from loading the scene
+    if (i->second_.calls_)
+        dest.Push(&i->second_);
+
+    for (unsigned j = 0; j < block->children_.Size(); ++j)
+        CollectStages(block->children_[j], stages, dest);
+}
+
+static void CreateBuiltinScene(Scene* scene)
+{
+    auto* cache = scene->GetSubsystem<ResourceCache>();
+
+    scene->CreateComponent<Octree>();
+
+    Node* zoneNode = scene->CreateChild("Zone");
+    auto* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.0f, 1000.0f));
+    zone->SetAmbientColor(Color(0.15f, 0.15f, 0.15f));
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->SetScale(Vector3(200.0f, 1.0f, 200.0f));
+    auto* floor = floorNode->CreateComponent<StaticModel>();
+    floor->SetModel(cache->GetResource<Model>("Models/Plane.mdl"));
+    floor->SetMaterial(cache->GetResource<Material>("Materials/StoneTiled.xml"));
+
+    Node* sunNode = scene->CreateChild("Sun");
+    sunNode->SetDirection(Vector3(0.6f, -1.0f, 0.8f));
+    auto* sun = sunNode->CreateComponent<Light>();
+    sun->SetLightType(LIGHT_DIRECTIONAL);
+    sun->SetCastShadows(true);
+
+    // Fixed seed so that every run creates the same scene
+    SetRandomSeed(1);
+
+    for (unsigned i = 0; i < 2000; ++i)
+    {
+        Node* objectNode = scene->CreateChild("Object");
+        objectNode->SetPosition(Vector3(Random(-95.0f, 95.0f), 0.0f, Random(-95.0f, 95.0f)));
+        objectNode->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+        objectNode->SetScale(Random(0.5f, 2.0f));
+        auto* object = objectNode->CreateComponent<StaticModel>();
+        if (i & 1u)
+        {
+            object->SetModel(cache->GetResource<Model>("Models/Mushroom.mdl"));
+            object->SetMaterial(cache->GetResource<Material>("Materials/Mushroom.xml"));
+        }
+        else
+        {
+            objectNode->Translate(Vector3(0.0f, 0.5f * objectNode->GetScale().y_, 0.0f));
+            object->SetModel(cache->GetResource<Model>("Models/Box.mdl"));
+            object->SetMaterial(cache->GetResource<Material>("Materials/Stone.xml"));
+        }
+        object->SetCastShadows(true);
+    }
+
+    for (unsigned i = 0; i < 50; ++i)
+    {
+        Node* jackNode = scene->CreateChild("Jack");
+        jackNode->SetPosition(Vector3(Random(-90.0f, 90.0f), 0.0f, Random(-90.0f, 90.0f)));
+        jackNode->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+        auto* jack = jackNode->CreateComponent<AnimatedModel>();
+        jack->SetModel(cache->GetResource<Model>("Models/Jack.mdl"));
+        jack->SetMaterial(cache->GetResource<Material>("Materials/Jack.xml"));
+        jack->SetCastShadows(true);
+        jackNode->CreateComponent<AnimationController>()->PlayExclusive("Models/Jack_Walk.ani", 0, true);
+    }
+
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        Node* lightNode = scene->CreateChild("Light");
+        lightNode->SetPosition(Vector3(Random(-90.0f, 90.0f), Random(2.0f, 8.0f), Random(-90.0f, 90.0f)));
+        auto* light = lightNode->CreateComponent<Light>();
+        light->SetColor(Color(Random(0.5f, 1.0f), Random(0.5f, 1.0f), Random(0.5f, 1.0f)));
+        if (i % 4 == 0)
+        {
+            lightNode->SetDirection(Vector3(Random(-1.0f, 1.0f), -1.0f, Random(-1.0f, 1.0f)));
+            light->SetLightType(LIGHT_SPOT);
+            light->SetRange(25.0f);
+            light->SetFov(60.0f);
+        }
+        else
+        {
+            light->SetLightType(LIGHT_POINT);
+            light->SetRange(15.0f);
+        }
+    }
+}
+
+static bool LoadScene(Scene* scene, const String& fileName)
+{
+    auto* cache = scene->GetSubsystem<ResourceCache>();
+    auto* fileSystem = scene->GetSubsystem<FileSystem>();
+
+    SharedPtr<File> file;
+    if (fileSystem->FileExists(fileName))
+        file = new File(scene->GetContext(), fileName);
+    else
+        file = cache->GetFile(fileName);
+    if (!file || !file->IsOpen())
+        return false;
+
+    String extension = GetExtension(fileName);
+    if (extension == ".xml")
+        return scene->LoadXML(*file);
+    else if (extension == ".json")
+        return scene->LoadJSON(*file);
+    else
+        return scene->Load(*file);
+}
+
+/// Return the bounds of the scene's geometries, which the camera path circles around.
+static BoundingBox GetSceneBounds(Scene* scene)
+{
+    PODVector<Drawable*> drawables;
+    scene->GetDerivedComponents<Drawable>(drawables, true);
+
+    BoundingBox bounds;
+    for (unsigned i = 0; i < drawables.Size(); ++i)
+    {
+        if (drawables[i]->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+            bounds.Merge(drawables[i]->GetWorldBoundingBox());
+    }
+
+    if (!bounds.Defined())
+        bounds.Define(-1.0f, 1.0f);
+    return bounds;
+}
+
+/// Place the camera on its path. The camera circles the scene once during the run, looking at the center.
+static void SetCameraOnPath(Node* cameraNode, const BoundingBox& bounds, unsigned frame, unsigned numFrames)
+{
+    Vector3 center = bounds.Center();
+    Vector3 halfSize = bounds.HalfSize();
+    float radius = Max(Vector2(halfSize.x_, halfSize.z_).Length() * 0.5f, 1.0f);
+    float angle = 360.0f * frame / numFrames;
+
+    cameraNode->SetPosition(center + Vector3(Cos(angle) * radius, halfSize.y_ + radius * 0.1f, Sin(angle) * radius));
+    cameraNode->LookAt(center);
+}
+
+static float GetMedian(PODVector<float> values)
+{
+    if (values.Empty())
+        return 0.0f;
+
+    Sort(values.Begin(), values.End());
+    unsigned size = values.Size();
+    return size % 2 ? values[size / 2] : (values[size / 2 - 1] + values[size / 2]) * 0.5f;
+}
+
+void RunSceneBenchmark(const SceneBenchmarkSettings& settings)
+{
+    SharedPtr<Context> context(new Context());
+    SharedPtr<Engine> engine(new Engine(context));
+
+    // Parse no arguments but still take the resource prefix path from the environment
+    VariantMap engineParameters = Engine::ParseParameters(Vector<String>());
+    engineParameters[EP_HEADLESS] = !settings.gpu_;
+    engineParameters[EP_LOG_NAME] = String::EMPTY;
+    engineParameters[EP_LOG_LEVEL] = LOG_WARNING;
+    engineParameters[EP_FULL_SCREEN] = false;
+    engineParameters[EP_WINDOW_WIDTH] = 1280;
+    engineParameters[EP_WINDOW_HEIGHT] = 720;
+    engineParameters[EP_VSYNC] = false;
+    engineParameters[EP_SOUND] = false;
+    if (!engine->Initialize(engineParameters))
+        ErrorExit("Could not initialize the engine");
+
+    auto* profiler = context->GetSubsystem<Profiler>();
+    if (!profiler)
+        ErrorExit("The scene benchmark needs the profiler, build with URHO3D_PROFILING enabled");
+
+    SharedPtr<Scene> scene(new Scene(context));
+    SharedPtr<SceneCapture> capture(new SceneCapture(context));
+    bool replay = !settings.replayFileName_.Empty();
+    String sceneName = replay ? settings.replayFileName_ : settings.sceneFileName_;
+    if (replay)
+    {
+        File file(context);
+        if (!file.Open(settings.replayFileName_) || !capture->Load(file) || !capture->GetNumFrames())
+            ErrorExit("Could not load scene capture " + settings.replayFileName_);
+        if (settings.replayFrame_ != M_MAX_UNSIGNED && settings.replayFrame_ >= capture->GetNumFrames())
+            ErrorExit("Scene capture has only " + String(capture->GetNumFrames()) + " frames");
+    }
+    else if (settings.sceneFileName_ == "builtin")
+        CreateBuiltinScene(scene);
+    else if (!LoadScene(scene, settings.sceneFileName_))
+        ErrorExit("Could not load scene " + settings.sceneFileName_);
+
+    Camera* camera = nullptr;
+    Node* cameraNode = nullptr;
+    BoundingBox bounds;
+    if (replay)
+    {
+        // The scene and the camera come from the capture, and are recreated when a key frame is loaded
+        capture->ApplyFrame(scene, settings.replayFrame_ != M_MAX_UNSIGNED ? settings.replayFrame_ : 0);
+        camera = capture->GetReplayCamera();
+    }
+    else
+    {
+        bounds = GetSceneBounds(scene);
+        // The benchmark camera is not saved with the scene
+        cameraNode = scene->CreateChild("BenchmarkCamera", LOCAL);
+        camera = cameraNode->CreateComponent<Camera>();
+        camera->SetFarClip(Max(bounds.Size().Length() * 2.0f, 100.0f));
+        camera->SetAspectRatio(1280.0f / 720.0f);
+    }
+
+    if (!scene->GetComponent<Octree>())
+        ErrorExit("Scene has no octree");
+
+    auto* time = context->GetSubsystem<Time>();
+    auto* graphics = context->GetSubsystem<Graphics>();
+    auto* renderer = context->GetSubsystem<Renderer>();
+    if (renderer)
+        renderer->SetViewport(0, new Viewport(context, scene, camera));
+
+    SharedPtr<HeadlessView> headlessView(new HeadlessView(context));
+    HashMap<const ProfilerBlock*, StageTimes> stages;
+    unsigned totalFrames = settings.frames_ + WARMUP_FRAMES;
+
+    for (unsigned i = 0; i < totalFrames; ++i)
+    {
+        // The warmup frames use the start of the path, so that the measured frames always see the same views
+        unsigned pathFrame = i < WARMUP_FRAMES ? 0 : i - WARMUP_FRAMES;
+        float timeStep = FRAME_TIME_STEP;
+
+        // Record only the measured frames, so that a replay sees the same frames in the same order
+        if (i == WARMUP_FRAMES && !settings.recordFileName_.Empty())
+            capture->StartRecording(scene, camera);
+
+        if (replay)
+        {
+            unsigned index = settings.replayFrame_ != M_MAX_UNSIGNED ? settings.replayFrame_ : pathFrame % capture->GetNumFrames();
+            // A simulated frame changes the scene, so restore the captured state from the key frame
+            if (settings.simulate_)
+                capture->ResetReplay();
+            capture->ApplyFrame(scene, index);
+            timeStep = capture->GetFrame(index)->timeStep_;
+            camera = capture->GetReplayCamera();
+            if (renderer)
+                renderer->GetViewport(0)->SetCamera(camera);
+        }
+        else
+            SetCameraOnPath(cameraNode, bounds, pathFrame, settings.frames_);
+
+        time->BeginFrame(timeStep);
+
+        // Replayed frames already are in their captured state
+        if (!replay || settings.simulate_)
+            scene->Update(timeStep);
+
+        if (renderer)
+        {
+            renderer->Update(timeStep);
+            if (graphics->BeginFrame())
+            {
+                renderer->Render();
+                graphics->EndFrame();
+            }
+        }
+        else
+        {
+            FrameInfo frame;
+            frame.frameNumber_ = time->GetFrameNumber();
+            frame.timeStep_ = timeStep;
+            frame.viewSize_ = IntVector2(1280, 720);
+            frame.camera_ = camera;
+            headlessView->Update(scene->GetComponent<Octree>(), camera, frame);
+        }
+
+        time->EndFrame();
+
+        if (i == WARMUP_FRAMES - 1)
+        {
+            headlessView->ResetStatistics();
+#ifdef URHO3D_NULL_GRAPHICS
+            if (graphics)
+                graphics->GetImpl()->ResetTrace();
+#endif
+        }
+        else if (i >= WARMUP_FRAMES)
+            RecordStages(profiler->GetRootBlock(), 0, stages);
+    }
+
+    if (capture->IsRecording())
+    {
+        capture->StopRecording();
+        File file(context);
+        if (!file.Open(settings.recordFileName_, FILE_WRITE) || !capture->Save(file))
+            ErrorExit("Could not write " + settings.recordFileName_);
+        PrintLine("Recorded " + String(capture->GetNumFrames()) + " frames with " + String(capture->GetNumKeyFrames()) +
+            " key frames to " + settings.recordFileName_);
+    }
+
+    PODVector<const StageTimes*> results;
+    CollectStages(profiler->GetRootBlock(), stages, results);
+
+    char line[256];
+    sprintf(line, "Scene %s, %u frames, %s", sceneName.CString(), settings.frames_, renderer ? "rendered" : "headless");
+    PrintLine(line);
+    if (replay)
+    {
+        if (settings.replayFrame_ != M_MAX_UNSIGNED)
+            sprintf(line, "Replaying captured frame %u%s", settings.replayFrame_, settings.simulate_ ? " with simulation" : "");
+        else
+            sprintf(line, "Replaying %u captured frames%s", capture->GetNumFrames(), settings.simulate_ ? " with simulation" : "");
+        PrintLine(line);
+    }
+    if (!renderer)
+    {
+        sprintf(line, "Per frame: %.1f geometries, %.1f lights, %.1f lit geometries, %.1f batches",
+            headlessView->GetAverageGeometries(), headlessView->GetAverageLights(), headlessView->GetAverageLitGeometries(),
+            headlessView->GetAverageBatches());
+        PrintLine(line);
+    }
+#ifdef URHO3D_NULL_GRAPHICS
+    // The null backend counts what the renderer submitted, so print the averages of the measured frames
+    GraphicsTrace trace;
+    float traceFrames = 1.0f;
+    if (renderer)
+    {
+        trace = graphics->GetImpl()->GetTotalTrace();
+        traceFrames = (float)Max(graphics->GetImpl()->GetNumTracedFrames(), 1U);
+        sprintf(line, "Per frame: %.1f draws, %.1f primitives, %.1f shader changes, %.1f texture changes, %.1f state changes",
+            trace.draws_ / traceFrames, trace.primitives_ / traceFrames, trace.shaderChanges_ / traceFrames,
+            trace.textureChanges_ / traceFrames, (trace.blendStateChanges_ + trace.depthStateChanges_ +
+            trace.rasterizerStateChanges_) / traceFrames);
+        PrintLine(line);
+        sprintf(line, "Per frame: %.1f shader parameter updates, %.0f buffer bytes and %.0f texture bytes uploaded",
+            trace.shaderParameterUpdates_ / traceFrames, trace.bufferBytesUploaded_ / traceFrames,
+            trace.textureBytesUploaded_ / traceFrames);
+        PrintLine(line);
+    }
+#endif
+    PrintLine("");
+    sprintf(line, "%-40s %10s %10s %10s %10s", "Stage", "Avg ms", "Median ms", "Max ms", "Calls");
+    PrintLine(line);
+
+    JSONArray stageArray;
+    for (unsigned i = 0; i < results.Size(); ++i)
+    {
+        const StageTimes& stage = *results[i];
+
+        // Frames before the block first ran count as zero time
+        PODVector<float> frameMs;
+        frameMs.Resize(settings.frames_ - stage.frameMs_.Size());
+        for (unsigned j = 0; j < frameMs.Size(); ++j)
+            frameMs[j] = 0.0f;
+        frameMs.Push(stage.frameMs_);
+
+        float sum = 0.0f;
+        float max = 0.0f;
+        for (unsigned j = 0; j < frameMs.Size(); ++j)
+        {
+            sum += frameMs[j];
+            max = Max(max, frameMs[j]);
+        }
+        float average = sum / frameMs.Size();
+        float median = GetMedian(frameMs);
+        float callsPerFrame = (float)stage.calls_ / frameMs.Size();
+
+        String name = String(' ', stage.depth_ * 2) + stage.name_;
+        sprintf(line, "%-40s %10.3f %10.3f %10.3f %10.1f", name.Substring(0, 40).CString(), average, median, max, callsPerFrame);
+        PrintLine(line);
+
+        JSONValue stageValue;
+        stageValue.Set("name", stage.name_);
+        stageValue.Set("depth", stage.depth_);
+        stageValue.Set("timeUnit", "ms");
+        stageValue.Set("mean", average);
+        stageValue.Set("median", median);
+        stageValue.Set("max", max);
+        stageValue.Set("callsPerFrame", callsPerFrame);
+        stageArray.Push(stageValue);
+    }
+
+    if (settings.jsonFileName_.Empty())
+        return;
+
+    JSONFile json(context);
+    JSONValue& root = json.GetRoot();
+
+    JSONValue info;
+    info.Set("date", Time::GetTimeStamp());
+    info.Set("platform", GetPlatform());
+    info.Set("physicalCPUs", GetNumPhysicalCPUs());
+#ifdef NDEBUG
+    info.Set("buildType", "release");
+#else
+    info.Set("buildType", "debug");
+#endif
+    info.Set("scene", sceneName);
+    if (replay)
+    {
+        info.Set("replayFrame", settings.replayFrame_ != M_MAX_UNSIGNED ? (int)settings.replayFrame_ : -1);
+        info.Set("simulate", settings.simulate_);
+    }
+    info.Set("frames", settings.frames_);
+    info.Set("mode", renderer ? "rendered" : "headless");
+    root.Set("context", info);
+
+    if (!renderer)
+    {
+        JSONValue statistics;
+        statistics.Set("geometries", headlessView->GetAverageGeometries());
+        statistics.Set("lights", headlessView->GetAverageLights());
+        statistics.Set("litGeometries", headlessView->GetAverageLitGeometries());
+        statistics.Set("batches", headlessView->GetAverageBatches());
+        root.Set("perFrame", statistics);
+    }
+#ifdef URHO3D_NULL_GRAPHICS
+    else
+    {
+        JSONValue statistics;
+        statistics.Set("draws", trace.draws_ / traceFrames);
+        statistics.Set("instances", trace.instances_ / traceFrames);
+        statistics.Set("primitives", trace.primitives_ / traceFrames);
+        statistics.Set("clears", trace.clears_ / traceFrames);
+        statistics.Set("shaderChanges", trace.shaderChanges_ / traceFrames);
+        statistics.Set("textureChanges", trace.textureChanges_ / traceFrames);
+        statistics.Set("bufferChanges", trace.bufferChanges_ / traceFrames);
+        statistics.Set("renderTargetChanges", trace.renderTargetChanges_ / traceFrames);
+        statistics.Set("blendStateChanges", trace.blendStateChanges_ / traceFrames);
+        statistics.Set("depthStateChanges", trace.depthStateChanges_ / traceFrames);
+        statistics.Set("rasterizerStateChanges", trace.rasterizerStateChanges_ / traceFrames);
+        statistics.Set("viewportChanges", trace.viewportChanges_ / traceFrames);
+        statistics.Set("shaderParameterUpdates", trace.shaderParameterUpdates_ / traceFrames);
+        statistics.Set("bufferBytesUploaded", trace.bufferBytesUploaded_ / traceFrames);
+        statistics.Set("textureBytesUploaded", trace.textureBytesUploaded_ / traceFrames);
+        root.Set("perFrame", statistics);
+    }
+#endif
+
+    root.Set("stages", stageArray);
+
+    File file(context);
+    if (!file.Open(settings.jsonFileName_, FILE_WRITE) || !json.Save(file, "  "))
+        ErrorExit("Could not write " + settings.jsonFileName_);
+}
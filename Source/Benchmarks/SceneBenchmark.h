@@ -0,0 +1,49 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/Str.h>
+
+/// Settings of the scene benchmark.
+struct SceneBenchmarkSettings
+{
+    /// Scene file to load, or "builtin" to generate the default scene.
+    Urho3D::String sceneFileName_;
+    /// Scene capture file to record the run to, empty for none.
+    Urho3D::String recordFileName_;
+    /// Scene capture file to replay instead of loading a scene, empty for none.
+    Urho3D::String replayFileName_;
+    /// Captured frame to replay on every frame, or M_MAX_UNSIGNED to replay the frames in order.
+    unsigned replayFrame_;
+    /// Run the scene update on the replayed frames, restoring the captured state before each.
+    bool simulate_;
+    /// Number of frames to run.
+    unsigned frames_;
+    /// Render through the graphics backend instead of running the view stages headless.
+    bool gpu_;
+    /// JSON file to write the results to, empty for none.
+    Urho3D::String jsonFileName_;
+};
+
+/// Run the scene benchmark and print the per-stage profiler timings.
+void RunSceneBenchmark(const SceneBenchmarkSettings& settings);
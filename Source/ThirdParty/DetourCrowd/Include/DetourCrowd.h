@@ -171,6 +171,12 @@ struct dtCrowdAgent
 	dtPathQueueRef targetPathqRef;		///< Path finder ref.
 	bool targetReplan;					///< Flag indicating that the current path is being replanned.
 	float targetReplanTime;				/// <Time since the agent's target was replanned.
+
+	// Urho3D: Add level of detail support
+	/// True if the agent keeps its previous steering and avoidance, and is only integrated and moved in the next update.
+	bool skipSteering;
+	/// True if the agent uses its desired velocity directly, without obstacle avoidance sampling.
+	bool simplifiedAvoidance;
 };
 
 struct dtCrowdAgentAnimation
@@ -204,11 +210,36 @@ struct dtCrowdAgentDebugInfo
 /// Type for the update callback.
 typedef void (*dtUpdateCallback)(dtCrowdAgent* ag, float dt);
 
+class dtCrowd;
+
+// Urho3D: Add parallel update support
+/// Stages of the crowd update which are independent for each active agent.
+enum dtCrowdUpdateStage
+{
+	DT_CROWD_STAGE_STEERING = 0,		///< Collision boundary, neighbours, corners, off-mesh connection triggers and desired velocity.
+	DT_CROWD_STAGE_AVOIDANCE,			///< Obstacle avoidance velocity planning.
+	DT_CROWD_STAGE_MOVE,				///< Constraining the new positions to the navigation mesh.
+};
+
+/// Type for the parallel update callback. It must call dtCrowd::updateStage() for ranges covering active agents [0, count),
+/// with a distinct thread index in [0, maxThreads) for each concurrently running call, and return when all of them have finished.
+typedef void (*dtParallelUpdateCallback)(dtCrowd* crowd, int stage, int count, void* userData);
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
 {
     dtUpdateCallback m_updateCallback; // Urho3D
+	// Urho3D: Add parallel update support
+	dtParallelUpdateCallback m_parallelUpdateCallback;
+	void* m_parallelUpdateUserData;
+	int m_maxThreads;
+	dtNavMeshQuery** m_threadNavQueries;
+	dtObstacleAvoidanceQuery** m_threadObstacleQueries;
+	int* m_threadSampleCounts;
+	int m_stageAgentCount;
+	float m_stageDt;
+	dtCrowdAgentDebugInfo* m_stageDebug;
 	int m_maxAgents;
 	dtCrowdAgent* m_agents;
 	dtCrowdAgent** m_activeAgents;
@@ -242,6 +273,11 @@ class dtCrowd
 
 	bool requestMoveTargetReplan(const int idx, dtPolyRef ref, const float* pos);
 
+	// Urho3D: Add parallel update support
+	bool initThreads(const int maxThreads);
+	void purgeThreads();
+	void runStage(const int stage, const int nagents);
+
 	void purge();
 	
 public:
@@ -330,6 +366,24 @@ public:
 	///  @param[in]		dt		The time, in seconds, to update the simulation. [Limit: > 0]
 	///  @param[out]	debug	A debug object to load with debug information. [Opt]
 	void update(const float dt, dtCrowdAgentDebugInfo* debug);
+
+	// Urho3D: Add parallel update support
+	/// Sets the callback used to run the per-agent update stages, possibly in several threads. Must be called after #init().
+	///  @param[in]		cb			The parallel update callback, or null to run the stages in the calling thread.
+	///  @param[in]		userData	User data passed to the callback.
+	///  @param[in]		maxThreads	The maximum number of concurrent #updateStage() calls. [Limit: >= 1]
+	/// @return True if the per-thread queries could be allocated.
+	bool setParallelUpdate(dtParallelUpdateCallback cb, void* userData, const int maxThreads);
+
+	/// Runs an update stage for a range of the active agents. Only to be called from the parallel update callback.
+	///  @param[in]		stage		The update stage. (See: #dtCrowdUpdateStage)
+	///  @param[in]		begin		The first active agent index.
+	///  @param[in]		end			One past the last active agent index.
+	///  @param[in]		thread		The thread index. [Limits: 0 <= value < maxThreads]
+	void updateStage(const int stage, const int begin, const int end, const int thread);
+
+	/// The maximum number of concurrent #updateStage() calls.
+	int getMaxThreads() const { return m_maxThreads; }
 	
 	/// Gets the filter used by the crowd.
 	/// @return The filter used by the crowd.
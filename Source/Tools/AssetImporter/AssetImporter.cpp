@@ -32,6 +32,7 @@
 #include <Urho3D/Graphics/IndexBuffer.h>
 #include <Urho3D/Graphics/Light.h>
 #include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/MeshOptimizer.h>
 #include <Urho3D/Graphics/Octree.h>
 #include <Urho3D/Graphics/VertexBuffer.h>
 #include <Urho3D/Graphics/Zone.h>
@@ -58,6 +59,19 @@
 
 using namespace Urho3D;
 
+struct OutGeometry
+{
+    aiMesh* mesh_{};
+    Matrix3x4 vertexTransform_;
+    Matrix3 normalTransform_;
+    /// Order to write the vertices in.
+    PODVector<unsigned> vertexOrder_;
+    /// Triangle lists of the LOD levels, indexing the vertices in write order.
+    Vector<PODVector<unsigned> > lodIndices_;
+    /// Simplification errors of the LOD levels relative to the mesh size.
+    PODVector<float> lodErrors_;
+};
+
 struct OutModel
 {
     String outName_;
@@ -65,6 +79,7 @@ struct OutModel
     HashSet<unsigned> meshIndices_;
     PODVector<aiMesh*> meshes_;
     PODVector<aiNode*> meshNodes_;
+    Vector<OutGeometry> geometries_;
     PODVector<aiNode*> bones_;
     PODVector<aiNode*> pivotlessBones_;
     PODVector<aiAnimation*> animations_;
@@ -135,6 +150,9 @@ const char *transformSuffix[TransformationComp_MAXIMUM] =
 };
 
 static const unsigned MAX_CHANNELS = 4;
+// Generated LOD levels aim at this fraction of the previous level's triangles, and are dropped above the maximum fraction
+static const float LOD_TRIANGLE_RATIO = 0.5f;
+static const float MAX_LOD_TRIANGLE_RATIO = 0.9f;
 
 SharedPtr<Context> context_(new Context());
 const aiScene* scene_ = nullptr;
@@ -163,7 +181,14 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool quantizeNormals_ = false;
+bool quantizeTexCoords_ = false;
+bool optimizeMeshes_ = true;
 unsigned maxBones_ = 64;
+unsigned meshletTriangles_ = 0;
+unsigned generateLods_ = 0;
+float lodDistance_ = 10.0f;
+float lodError_ = 0.02f;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
 
@@ -188,6 +213,8 @@ void CollectBonesFinal(PODVector<aiNode*>& dest, const HashSet<aiNode*>& necessa
 void MoveToBindPose(OutModel& model, aiNode* current);
 void CollectAnimations(OutModel* model = nullptr);
 void BuildBoneCollisionInfo(OutModel& model);
+void ProcessGeometries(OutModel* models, unsigned numModels);
+void ProcessGeometryWork(const WorkItem* item, unsigned threadIndex);
 void BuildAndSaveModel(OutModel& model);
 void BuildAndSaveAnimations(OutModel* model = nullptr);
 
@@ -216,8 +243,6 @@ String GenerateMaterialName(aiMaterial* material);
 String GenerateTextureName(unsigned texIndex);
 unsigned GetNumValidFaces(aiMesh* mesh);
 
-void WriteShortIndices(unsigned short*& dest, aiMesh* mesh, unsigned index, unsigned offset);
-void WriteLargeIndices(unsigned*& dest, aiMesh* mesh, unsigned index, unsigned offset);
 void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, BoundingBox& box,
     const Matrix3x4& vertexTransform, const Matrix3& normalTransform, Vector<PODVector<unsigned char> >& blendIndices,
     Vector<PODVector<float> >& blendWeights);
@@ -286,7 +311,17 @@ void Run(const Vector<String>& arguments)
             "-nz         Do not create a zone and a directional light (scene mode only)\n"
             "-nf         Do not fix infacing normals\n"
             "-ne         Do not save empty nodes (scene mode only)\n"
+            "-no         Do not optimize the vertex and triangle order for the vertex cache,\n"
+            "            overdraw and vertex fetch\n"
             "-mb <x>     Maximum number of bones per submesh. Default 64\n"
+            "-ml <x>     Build meshlets of at most x triangles for cluster culling, 64-128\n"
+            "            is typical. Not built for skinned models\n"
+            "-gl <x>     Generate up to x LOD levels by simplification, each with half the\n"
+            "            triangles of the previous level. Texture seams and open edges are kept\n"
+            "-gd <dist>  Distance of the first generated LOD level, doubled for each further\n"
+            "            level. Default 10\n"
+            "-ge <error> Maximum error of the first generated LOD level relative to the mesh\n"
+            "            size, doubled for each further level. Default 0.02\n"
             "-p <path>   Set path for scene resources. Default is output file path\n"
             "-r <name>   Use the named scene node as root node\n"
             "-f <freq>   Animation tick frequency to use if unspecified. Default 4800\n"
@@ -306,12 +341,18 @@ void Run(const Vector<String>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-q          Quantize normals, tangents and texture coordinates, same as -qn -qt\n"
+            "-qn         Store normals and tangents as 16-bit normalized integers\n"
+            "-qt         Store texture coordinates as half floats. Coordinates far outside\n"
+            "            the 0-1 range lose precision\n"
         );
     }
 
     context_->RegisterSubsystem(new FileSystem(context_));
     context_->RegisterSubsystem(new ResourceCache(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
+    // The meshes are processed in worker threads, with the main thread taking part
+    context_->GetSubsystem<WorkQueue>()->CreateThreads(Max(GetNumPhysicalCPUs(), 1u) - 1);
     RegisterSceneLibrary(context_);
     RegisterGraphicsLibrary(context_);
 #ifdef URHO3D_PHYSICS
@@ -399,6 +440,10 @@ void Run(const Vector<String>& arguments)
                     flags &= ~aiProcess_FixInfacingNormals;
                     break;
 
+                case 'o':
+                    optimizeMeshes_ = false;
+                    break;
+
                 case 'p':
                         suppressFbxPivotNodes_ = false;
                     break;
@@ -412,6 +457,26 @@ void Run(const Vector<String>& arguments)
                     maxBones_ = 1;
                 ++i;
             }
+            else if (argument == "ml" && !value.Empty())
+            {
+                meshletTriangles_ = ToUInt(value);
+                ++i;
+            }
+            else if (argument == "gl" && !value.Empty())
+            {
+                generateLods_ = ToUInt(value);
+                ++i;
+            }
+            else if (argument == "gd" && !value.Empty())
+            {
+                lodDistance_ = Max(ToFloat(value), 0.0f);
+                ++i;
+            }
+            else if (argument == "ge" && !value.Empty())
+            {
+                lodError_ = Max(ToFloat(value), 0.0f);
+                ++i;
+            }
             else if (argument == "p" && !value.Empty())
             {
                 resourcePath_ = AddTrailingSlash(value);
@@ -456,6 +521,15 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "q")
+            {
+                quantizeNormals_ = true;
+                quantizeTexCoords_ = true;
+            }
+            else if (argument == "qn")
+                quantizeNormals_ = true;
+            else if (argument == "qt")
+                quantizeTexCoords_ = true;
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -468,6 +542,10 @@ void Run(const Vector<String>& arguments)
         }
     }
 
+    // The meshes are optimized for the vertex cache after import, which makes Assimp's own pass unnecessary
+    if (optimizeMeshes_)
+        flags &= ~aiProcess_ImproveCacheLocality;
+
     if (command == "model" || command == "scene" || command == "anim" || command == "node" || command == "dump")
     {
         String inFile = arguments[1];
@@ -650,6 +728,7 @@ void ExportModel(const String& outName, bool animationOnly)
     CollectMeshes(model, model.rootNode_);
     CollectBones(model, animationOnly);
     BuildBoneCollisionInfo(model);
+    ProcessGeometries(&model, 1);
     BuildAndSaveModel(model);
     if (!noAnimations_)
     {
@@ -982,6 +1061,112 @@ void BuildBoneCollisionInfo(OutModel& model)
     }
 }
 
+void ProcessGeometries(OutModel* models, unsigned numModels)
+{
+    auto* queue = context_->GetSubsystem<WorkQueue>();
+
+    for (unsigned i = 0; i < numModels; ++i)
+    {
+        OutModel& model = models[i];
+        model.geometries_.Resize(model.meshes_.Size());
+
+        for (unsigned j = 0; j < model.meshes_.Size(); ++j)
+        {
+            OutGeometry& geometry = model.geometries_[j];
+            geometry.mesh_ = model.meshes_[j];
+
+            // Get the world transform of the mesh for baking into the vertices
+            Vector3 pos, scale;
+            Quaternion rot;
+            GetPosRotScale(GetMeshBakingTransform(model.meshNodes_[j], model.rootNode_), pos, rot, scale);
+            geometry.vertexTransform_ = Matrix3x4(pos, rot, scale);
+            geometry.normalTransform_ = rot.RotationMatrix();
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ProcessGeometryWork;
+            item->start_ = &geometry;
+            queue->AddWorkItem(item);
+        }
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void ProcessGeometryWork(const WorkItem* item, unsigned threadIndex)
+{
+    OutGeometry& geometry = *reinterpret_cast<OutGeometry*>(item->start_);
+    aiMesh* mesh = geometry.mesh_;
+    unsigned numVertices = mesh->mNumVertices;
+
+    PODVector<unsigned> indices;
+    indices.Reserve(GetNumValidFaces(mesh) * 3);
+    for (unsigned i = 0; i < mesh->mNumFaces; ++i)
+    {
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices == 3)
+        {
+            indices.Push(face.mIndices[0]);
+            indices.Push(face.mIndices[1]);
+            indices.Push(face.mIndices[2]);
+        }
+    }
+
+    PODVector<Vector3> positions;
+    if (optimizeMeshes_ || generateLods_)
+    {
+        positions.Resize(numVertices);
+        for (unsigned i = 0; i < numVertices; ++i)
+            positions[i] = geometry.vertexTransform_ * ToVector3(mesh->mVertices[i]);
+    }
+
+    if (optimizeMeshes_)
+    {
+        OptimizeVertexCache(indices.Buffer(), indices.Size(), numVertices);
+        OptimizeOverdraw(indices.Buffer(), indices.Size(), positions.Buffer(), numVertices);
+    }
+    geometry.lodIndices_.Push(indices);
+    geometry.lodErrors_.Push(0.0f);
+
+    // Simplify each level from the full detail triangles. The allowed error doubles along with the LOD distance
+    for (unsigned i = 1; i <= generateLods_; ++i)
+    {
+        unsigned previousCount = geometry.lodIndices_.Back().Size();
+        auto targetCount = (unsigned)(indices.Size() * Pow(LOD_TRIANGLE_RATIO, (float)i)) / 3 * 3;
+        PODVector<unsigned> lodIndices;
+        float error = SimplifyMesh(lodIndices, indices.Buffer(), indices.Size(), positions.Buffer(), numVertices, targetCount,
+            lodError_ * (float)(1u << (i - 1)));
+        if (lodIndices.Empty() || lodIndices.Size() > previousCount * MAX_LOD_TRIANGLE_RATIO)
+            break;
+
+        if (optimizeMeshes_)
+            OptimizeVertexCache(lodIndices.Buffer(), lodIndices.Size(), numVertices);
+        geometry.lodIndices_.Push(lodIndices);
+        geometry.lodErrors_.Push(error);
+    }
+
+    // Order the vertices by their first use in the full detail triangles
+    geometry.vertexOrder_.Resize(numVertices);
+    if (optimizeMeshes_)
+    {
+        PODVector<unsigned> remap;
+        OptimizeVertexFetch(remap, indices.Buffer(), indices.Size(), numVertices);
+        for (unsigned i = 0; i < numVertices; ++i)
+            geometry.vertexOrder_[remap[i]] = i;
+        for (unsigned i = 0; i < geometry.lodIndices_.Size(); ++i)
+        {
+            PODVector<unsigned>& lodIndices = geometry.lodIndices_[i];
+            for (unsigned j = 0; j < lodIndices.Size(); ++j)
+                lodIndices[j] = remap[lodIndices[j]];
+        }
+    }
+    else
+    {
+        for (unsigned i = 0; i < numVertices; ++i)
+            geometry.vertexOrder_[i] = i;
+    }
+}
+
 void BuildAndSaveModel(OutModel& model)
 {
     if (!model.rootNode_)
@@ -1005,6 +1190,8 @@ void BuildAndSaveModel(OutModel& model)
 
     unsigned numValidGeometries = 0;
 
+    unsigned totalLodIndices = 0;
+
     bool combineBuffers = true;
     // Check if buffers can be combined (same vertex elements, under 65535 vertices)
     PODVector<VertexElement> elements = GetVertexElements(model.meshes_[0], model.bones_.Size() > 0);
@@ -1013,6 +1200,8 @@ void BuildAndSaveModel(OutModel& model)
         if (GetNumValidFaces(model.meshes_[i]))
         {
             ++numValidGeometries;
+            for (unsigned j = 0; j < model.geometries_[i].lodIndices_.Size(); ++j)
+                totalLodIndices += model.geometries_[i].lodIndices_[j].Size();
             if (i > 0 && GetVertexElements(model.meshes_[i], model.bones_.Size() > 0) != elements)
                 combineBuffers = false;
         }
@@ -1048,11 +1237,16 @@ void BuildAndSaveModel(OutModel& model)
     for (unsigned i = 0; i < model.meshes_.Size(); ++i)
     {
         aiMesh* mesh = model.meshes_[i];
+        const OutGeometry& outGeometry = model.geometries_[i];
         PODVector<VertexElement> elements = GetVertexElements(mesh, isSkinned);
         unsigned validFaces = GetNumValidFaces(mesh);
         if (!validFaces)
             continue;
 
+        unsigned numLodIndices = 0;
+        for (unsigned j = 0; j < outGeometry.lodIndices_.Size(); ++j)
+            numLodIndices += outGeometry.lodIndices_[j].Size();
+
         bool largeIndices;
         if (combineBuffers)
             largeIndices = model.totalIndices_ > 65535;
@@ -1067,12 +1261,12 @@ void BuildAndSaveModel(OutModel& model)
 
             if (combineBuffers)
             {
-                ib->SetSize(model.totalIndices_, largeIndices);
+                ib->SetSize(totalLodIndices, largeIndices);
                 vb->SetSize(model.totalVertices_, elements);
             }
             else
             {
-                ib->SetSize(validFaces * 3, largeIndices);
+                ib->SetSize(numLodIndices, largeIndices);
                 vb->SetSize(mesh->mNumVertices, elements);
             }
 
@@ -1082,19 +1276,16 @@ void BuildAndSaveModel(OutModel& model)
             startIndexOffset = 0;
         }
 
-        // Get the world transform of the mesh for baking into the vertices
-        Matrix3x4 vertexTransform;
-        Matrix3 normalTransform;
-        Vector3 pos, scale;
-        Quaternion rot;
-        GetPosRotScale(GetMeshBakingTransform(model.meshNodes_[i], model.rootNode_), pos, rot, scale);
-        vertexTransform = Matrix3x4(pos, rot, scale);
-        normalTransform = rot.RotationMatrix();
-
-        SharedPtr<Geometry> geom(new Geometry(context_));
+        const Matrix3x4& vertexTransform = outGeometry.vertexTransform_;
+        const Matrix3& normalTransform = outGeometry.normalTransform_;
 
         PrintLine("Writing geometry " + String(i) + " with " + String(mesh->mNumVertices) + " vertices " +
             String(validFaces * 3) + " indices");
+        for (unsigned j = 1; j < outGeometry.lodIndices_.Size(); ++j)
+        {
+            PrintLine("Generated LOD level " + String(j) + " with " + String(outGeometry.lodIndices_[j].Size()) +
+                " indices, error " + String(outGeometry.lodErrors_[j]));
+        }
 
         if (model.bones_.Size() > 0 && !mesh->HasBones())
             PrintLine("Warning: model has bones but geometry " + String(i) + " has no skinning information");
@@ -1102,18 +1293,24 @@ void BuildAndSaveModel(OutModel& model)
         unsigned char* vertexData = vb->GetShadowData();
         unsigned char* indexData = ib->GetShadowData();
 
-        // Build the index data
-        if (!largeIndices)
+        // Build the index data of all LOD levels
+        unsigned lodIndexOffset = startIndexOffset;
+        for (unsigned j = 0; j < outGeometry.lodIndices_.Size(); ++j)
         {
-            unsigned short* dest = (unsigned short*)indexData + startIndexOffset;
-            for (unsigned j = 0; j < mesh->mNumFaces; ++j)
-                WriteShortIndices(dest, mesh, j, startVertexOffset);
-        }
-        else
-        {
-            unsigned* dest = (unsigned*)indexData + startIndexOffset;
-            for (unsigned j = 0; j < mesh->mNumFaces; ++j)
-                WriteLargeIndices(dest, mesh, j, startVertexOffset);
+            const PODVector<unsigned>& lodIndices = outGeometry.lodIndices_[j];
+            if (!largeIndices)
+            {
+                unsigned short* dest = (unsigned short*)indexData + lodIndexOffset;
+                for (unsigned k = 0; k < lodIndices.Size(); ++k)
+                    *dest++ = (unsigned short)(lodIndices[k] + startVertexOffset);
+            }
+            else
+            {
+                unsigned* dest = (unsigned*)indexData + lodIndexOffset;
+                for (unsigned k = 0; k < lodIndices.Size(); ++k)
+                    *dest++ = lodIndices[k] + startVertexOffset;
+            }
+            lodIndexOffset += lodIndices.Size();
         }
 
         // Build the vertex data
@@ -1126,7 +1323,10 @@ void BuildAndSaveModel(OutModel& model)
 
         auto* dest = (float*)((unsigned char*)vertexData + startVertexOffset * vb->GetVertexSize());
         for (unsigned j = 0; j < mesh->mNumVertices; ++j)
-            WriteVertex(dest, mesh, j, isSkinned, box, vertexTransform, normalTransform, blendIndices, blendWeights);
+        {
+            WriteVertex(dest, mesh, outGeometry.vertexOrder_[j], isSkinned, box, vertexTransform, normalTransform, blendIndices,
+                blendWeights);
+        }
 
         // Calculate the geometry center
         Vector3 center = Vector3::ZERO;
@@ -1145,18 +1345,33 @@ void BuildAndSaveModel(OutModel& model)
             center /= (float)validFaces * 3;
         }
 
-        // Define the geometry
-        geom->SetIndexBuffer(ib);
-        geom->SetVertexBuffer(0, vb);
-        geom->SetDrawRange(TRIANGLE_LIST, startIndexOffset, validFaces * 3, true);
-        outModel->SetNumGeometryLodLevels(destGeomIndex, 1);
-        outModel->SetGeometry(destGeomIndex, 0, geom);
+        // Define the geometry LOD levels. The LOD distance doubles for each generated level
+        outModel->SetNumGeometryLodLevels(destGeomIndex, outGeometry.lodIndices_.Size());
+        lodIndexOffset = startIndexOffset;
+        for (unsigned j = 0; j < outGeometry.lodIndices_.Size(); ++j)
+        {
+            SharedPtr<Geometry> geom(new Geometry(context_));
+            geom->SetIndexBuffer(ib);
+            geom->SetVertexBuffer(0, vb);
+            geom->SetDrawRange(TRIANGLE_LIST, lodIndexOffset, outGeometry.lodIndices_[j].Size(), true);
+            if (j)
+                geom->SetLodDistance(lodDistance_ * (float)(1u << (j - 1)));
+            else if (meshletTriangles_ && !isSkinned)
+            {
+                if (geom->BuildMeshlets(meshletTriangles_))
+                    PrintLine("Built " + String(geom->GetNumMeshlets()) + " meshlets for geometry " + String(i));
+                else
+                    PrintLine("Warning: could not build meshlets for geometry " + String(i));
+            }
+            outModel->SetGeometry(destGeomIndex, j, geom);
+            lodIndexOffset += outGeometry.lodIndices_[j].Size();
+        }
         outModel->SetGeometryCenter(destGeomIndex, center);
         if (model.bones_.Size() > maxBones_)
             allBoneMappings.Push(boneMappings);
 
         startVertexOffset += mesh->mNumVertices;
-        startIndexOffset += validFaces * 3;
+        startIndexOffset = lodIndexOffset;
         ++destGeomIndex;
     }
 
@@ -1498,6 +1713,7 @@ void ExportScene(const String& outName, bool asPrefab)
     CollectSceneModels(outScene, rootNode_);
 
     // Save models, their material lists and animations
+    ProcessGeometries(outScene.models_.Buffer(), outScene.models_.Size());
     for (unsigned i = 0; i < outScene.models_.Size(); ++i)
         BuildAndSaveModel(outScene.models_[i]);
 
@@ -2402,26 +2618,6 @@ unsigned GetNumValidFaces(aiMesh* mesh)
     return ret;
 }
 
-void WriteShortIndices(unsigned short*& dest, aiMesh* mesh, unsigned index, unsigned offset)
-{
-    if (mesh->mFaces[index].mNumIndices == 3)
-    {
-        *dest++ = mesh->mFaces[index].mIndices[0] + offset;
-        *dest++ = mesh->mFaces[index].mIndices[1] + offset;
-        *dest++ = mesh->mFaces[index].mIndices[2] + offset;
-    }
-}
-
-void WriteLargeIndices(unsigned*& dest, aiMesh* mesh, unsigned index, unsigned offset)
-{
-    if (mesh->mFaces[index].mNumIndices == 3)
-    {
-        *dest++ = mesh->mFaces[index].mIndices[0] + offset;
-        *dest++ = mesh->mFaces[index].mIndices[1] + offset;
-        *dest++ = mesh->mFaces[index].mIndices[2] + offset;
-    }
-}
-
 void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, BoundingBox& box,
     const Matrix3x4& vertexTransform, const Matrix3& normalTransform, Vector<PODVector<unsigned char> >& blendIndices,
     Vector<PODVector<float> >& blendWeights)
@@ -2435,9 +2631,22 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     if (mesh->HasNormals())
     {
         Vector3 normal = normalTransform * ToVector3(mesh->mNormals[index]);
-        *dest++ = normal.x_;
-        *dest++ = normal.y_;
-        *dest++ = normal.z_;
+        if (quantizeNormals_)
+        {
+            auto* destShorts = (short*)dest;
+            normal.Normalize();
+            *destShorts++ = FloatToSNorm16(normal.x_);
+            *destShorts++ = FloatToSNorm16(normal.y_);
+            *destShorts++ = FloatToSNorm16(normal.z_);
+            *destShorts++ = 0;
+            dest += 2;
+        }
+        else
+        {
+            *dest++ = normal.x_;
+            *dest++ = normal.y_;
+            *dest++ = normal.z_;
+        }
     }
 
     for (unsigned i = 0; i < mesh->GetNumColorChannels() && i < MAX_CHANNELS; ++i)
@@ -2450,8 +2659,18 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     for (unsigned i = 0; i < mesh->GetNumUVChannels() && i < MAX_CHANNELS; ++i)
     {
         Vector3 texCoord = ToVector3(mesh->mTextureCoords[i][index]);
-        *dest++ = texCoord.x_;
-        *dest++ = texCoord.y_;
+        if (quantizeTexCoords_)
+        {
+            auto* destShorts = (unsigned short*)dest;
+            *destShorts++ = FloatToHalf(texCoord.x_);
+            *destShorts++ = FloatToHalf(texCoord.y_);
+            ++dest;
+        }
+        else
+        {
+            *dest++ = texCoord.x_;
+            *dest++ = texCoord.y_;
+        }
     }
 
     if (mesh->HasTangentsAndBitangents())
@@ -2464,10 +2683,23 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
         if ((tangent.CrossProduct(normal)).DotProduct(bitangent) < 0.5f)
             w = -1.0f;
 
-        *dest++ = tangent.x_;
-        *dest++ = tangent.y_;
-        *dest++ = tangent.z_;
-        *dest++ = w;
+        if (quantizeNormals_)
+        {
+            auto* destShorts = (short*)dest;
+            tangent.Normalize();
+            *destShorts++ = FloatToSNorm16(tangent.x_);
+            *destShorts++ = FloatToSNorm16(tangent.y_);
+            *destShorts++ = FloatToSNorm16(tangent.z_);
+            *destShorts++ = FloatToSNorm16(w);
+            dest += 2;
+        }
+        else
+        {
+            *dest++ = tangent.x_;
+            *dest++ = tangent.y_;
+            *dest++ = tangent.z_;
+            *dest++ = w;
+        }
     }
 
     if (isSkinned)
@@ -2499,18 +2731,19 @@ PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned)
     // Position must always be first and of type Vector3 for raycasts to work
     ret.Push(VertexElement(TYPE_VECTOR3, SEM_POSITION));
 
+    // Normals, tangents and texture coordinates can be quantized. The normal is padded to 4 components for alignment
     if (mesh->HasNormals())
-        ret.Push(VertexElement(TYPE_VECTOR3, SEM_NORMAL));
+        ret.Push(VertexElement(quantizeNormals_ ? TYPE_SHORT4_NORM : TYPE_VECTOR3, SEM_NORMAL));
 
     for (unsigned i = 0; i < mesh->GetNumColorChannels() && i < MAX_CHANNELS; ++i)
         ret.Push(VertexElement(TYPE_UBYTE4_NORM, SEM_COLOR, i));
 
     /// \todo Assimp mesh structure can specify 3D UV-coords. How to determine the difference? For now always treated as 2D.
     for (unsigned i = 0; i < mesh->GetNumUVChannels() && i < MAX_CHANNELS; ++i)
-        ret.Push(VertexElement(TYPE_VECTOR2, SEM_TEXCOORD, i));
+        ret.Push(VertexElement(quantizeTexCoords_ ? TYPE_HALF2 : TYPE_VECTOR2, SEM_TEXCOORD, i));
 
     if (mesh->HasTangentsAndBitangents())
-        ret.Push(VertexElement(TYPE_VECTOR4, SEM_TANGENT));
+        ret.Push(VertexElement(quantizeNormals_ ? TYPE_SHORT4_NORM : TYPE_VECTOR4, SEM_TANGENT));
 
     if (isSkinned)
     {
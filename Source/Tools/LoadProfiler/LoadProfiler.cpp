@@ -0,0 +1,372 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/PackageFile.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdio>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Settings of the load replay.
+struct ReplaySettings
+{
+    /// Load list file.
+    String loadListName_;
+    /// Resource directories.
+    Vector<String> resourceDirs_;
+    /// Package files.
+    Vector<String> packageFiles_;
+    /// Number of runs. The first is cold, the rest warm.
+    unsigned runs_{3};
+    /// Number of most expensive resources to report.
+    unsigned top_{20};
+    /// Background loader threads, zero to load synchronously.
+    unsigned backgroundThreads_{};
+    /// Memory map the package files.
+    bool mappedPackages_{};
+    /// Build the resource index before loading.
+    bool resourceIndex_{};
+    /// Initialize graphics so that GPU uploads are included.
+    bool graphics_{};
+    /// JSON file to write the results to, empty for none.
+    String jsonFileName_;
+};
+
+/// Entry of the load list.
+struct LoadListEntry
+{
+    /// Resource type.
+    StringHash type_;
+    /// Resource name.
+    String name_;
+};
+
+/// Results of one replay of the load list.
+struct ReplayRun
+{
+    /// Wall clock time of the whole replay in milliseconds.
+    float wallMs_{};
+    /// Recorded loads.
+    Vector<ResourceLoadRecord> records_;
+    /// Report of the resource cache.
+    String report_;
+};
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+
+static Vector<LoadListEntry> ReadLoadList(Context* context, const String& fileName)
+{
+    File file(context);
+    if (!file.Open(fileName))
+        ErrorExit("Could not open load list " + fileName);
+
+    Vector<LoadListEntry> entries;
+    while (!file.IsEof())
+    {
+        String line = file.ReadLine().Trimmed();
+        if (line.Empty() || line.StartsWith("#"))
+            continue;
+
+        // The type name has no spaces, but the resource name may have
+        unsigned separator = line.Find(' ');
+        if (separator == String::NPOS)
+        {
+            PrintLine("Skipping malformed load list line " + line, true);
+            continue;
+        }
+
+        LoadListEntry entry;
+        entry.type_ = StringHash(line.Substring(0, separator));
+        entry.name_ = line.Substring(separator + 1).Trimmed();
+        entries.Push(entry);
+    }
+
+    return entries;
+}
+
+static ReplayRun ReplayLoadList(Engine* engine, ResourceCache* cache, const Vector<LoadListEntry>& entries, const ReplaySettings& settings)
+{
+    cache->SetLoadProfiling(false);
+    cache->SetLoadProfiling(true);
+
+    HiresTimer timer;
+    if (settings.backgroundThreads_)
+    {
+        for (unsigned i = 0; i < entries.Size(); ++i)
+            cache->BackgroundLoadResource(entries[i].type_, entries[i].name_);
+        // The background loaded resources are finished at the start of each frame
+        while (cache->GetNumBackgroundLoadResources())
+            engine->RunFrame();
+    }
+    else
+    {
+        for (unsigned i = 0; i < entries.Size(); ++i)
+            cache->GetResource(entries[i].type_, entries[i].name_);
+    }
+
+    ReplayRun run;
+    run.wallMs_ = timer.GetUSec(false) / 1000.0f;
+    run.records_ = cache->GetLoadRecords();
+    run.report_ = cache->GetLoadProfileReport(settings.top_);
+    cache->SetLoadProfiling(false);
+    return run;
+}
+
+static void GetTypeTotals(const Vector<ResourceLoadRecord>& records, HashMap<String, LoadStageTimes>& totals)
+{
+    for (unsigned i = 0; i < records.Size(); ++i)
+        totals[records[i].typeName_].Accumulate(records[i].times_);
+}
+
+static bool CompareTypeTotals(const Pair<String, LoadStageTimes>& lhs, const Pair<String, LoadStageTimes>& rhs)
+{
+    return lhs.second_.GetTotal() > rhs.second_.GetTotal();
+}
+
+static JSONValue GetRunValue(const ReplayRun& run, bool cold)
+{
+    JSONValue value;
+    value.Set("cold", cold);
+    value.Set("timeUnit", "ms");
+    value.Set("wall", run.wallMs_);
+    value.Set("loads", run.records_.Size());
+
+    HashMap<String, unsigned> counts;
+    HashMap<String, LoadStageTimes> totals;
+    for (unsigned i = 0; i < run.records_.Size(); ++i)
+        ++counts[run.records_[i].typeName_];
+    GetTypeTotals(run.records_, totals);
+
+    JSONValue types;
+    for (HashMap<String, LoadStageTimes>::ConstIterator i = totals.Begin(); i != totals.End(); ++i)
+    {
+        JSONValue typeValue;
+        typeValue.Set("loads", counts[i->first_]);
+        for (unsigned j = 0; j < MAX_LOADSTAGES; ++j)
+            typeValue.Set(String(GetLoadStageName((LoadStage)j)).ToLower(), i->second_.usec_[j] / 1000.0f);
+        typeValue.Set("total", i->second_.GetTotal() / 1000.0f);
+        types.Set(i->first_, typeValue);
+    }
+    value.Set("types", types);
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    ReplaySettings settings;
+    bool showUsage = false;
+
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        const String& arg = arguments[i];
+        bool hasValue = i + 1 < arguments.Size();
+
+        if (arg == "-path" && hasValue)
+            settings.resourceDirs_.Push(arguments[++i]);
+        else if (arg == "-package" && hasValue)
+            settings.packageFiles_.Push(arguments[++i]);
+        else if (arg == "-runs" && hasValue)
+            settings.runs_ = Max(ToUInt(arguments[++i]), 1U);
+        else if (arg == "-top" && hasValue)
+            settings.top_ = ToUInt(arguments[++i]);
+        else if (arg == "-background" && hasValue)
+            settings.backgroundThreads_ = ToUInt(arguments[++i]);
+        else if (arg == "-mapped")
+            settings.mappedPackages_ = true;
+        else if (arg == "-index")
+            settings.resourceIndex_ = true;
+        else if (arg == "-graphics")
+            settings.graphics_ = true;
+        else if (arg == "-json" && hasValue)
+            settings.jsonFileName_ = arguments[++i];
+        else if (!arg.StartsWith("-") && settings.loadListName_.Empty())
+            settings.loadListName_ = arg;
+        else
+            showUsage = true;
+    }
+
+    if (showUsage || settings.loadListName_.Empty() || (settings.resourceDirs_.Empty() && settings.packageFiles_.Empty()))
+    {
+        ErrorExit("Usage: LoadProfiler <load list> [options]\n\n"
+            "Options:\n"
+            "-path <dir>          Resource directory to load from, can be repeated\n"
+            "-package <file>      Package file to load from, can be repeated\n"
+            "-runs <n>            Number of runs, default 3. The first is cold, the rest warm\n"
+            "-top <n>             Number of most expensive resources to report, default 20\n"
+            "-background <n>      Load in the background with n loader threads instead of synchronously\n"
+            "-mapped              Memory map the package files\n"
+            "-index               Build the resource index before loading\n"
+            "-graphics            Initialize graphics so that textures are loaded and GPU uploads are included\n"
+            "-json <file>         Write the results to a JSON file\n\n"
+            "The load list has one resource per line: the type name, a space and the resource name. It can be captured\n"
+            "with ResourceCache::SaveLoadList() after running the application with load profiling enabled.\n"
+            "The resources are released between runs, so the warm runs read from the operating system's file cache.\n"
+            "For a truly cold first run, drop the file cache before starting.");
+    }
+
+    SharedPtr<Context> context(new Context());
+    SharedPtr<Engine> engine(new Engine(context));
+
+    VariantMap engineParameters;
+    engineParameters[EP_HEADLESS] = !settings.graphics_;
+    engineParameters[EP_WINDOW_WIDTH] = 320;
+    engineParameters[EP_WINDOW_HEIGHT] = 240;
+    engineParameters[EP_RESOURCE_PATHS] = String::EMPTY;
+    engineParameters[EP_AUTOLOAD_PATHS] = String::EMPTY;
+    engineParameters[EP_LOG_NAME] = String::EMPTY;
+    engineParameters[EP_LOG_LEVEL] = LOG_WARNING;
+    engineParameters[EP_SOUND] = false;
+    if (!engine->Initialize(engineParameters))
+        ErrorExit("Could not initialize the engine");
+
+    auto* cache = context->GetSubsystem<ResourceCache>();
+    for (unsigned i = 0; i < settings.packageFiles_.Size(); ++i)
+    {
+        if (!cache->AddPackageFile(settings.packageFiles_[i]))
+            ErrorExit("Could not open package file " + settings.packageFiles_[i]);
+    }
+    for (unsigned i = 0; i < settings.resourceDirs_.Size(); ++i)
+    {
+        if (!cache->AddResourceDir(settings.resourceDirs_[i]))
+            ErrorExit("Could not add resource directory " + settings.resourceDirs_[i]);
+    }
+    cache->SetMemoryMappedPackages(settings.mappedPackages_);
+    if (settings.backgroundThreads_)
+        cache->SetBackgroundLoadThreads(settings.backgroundThreads_);
+    if (settings.resourceIndex_)
+        cache->BuildResourceIndex();
+
+    Vector<LoadListEntry> entries = ReadLoadList(context, settings.loadListName_);
+    PrintLine("Replaying " + String(entries.Size()) + " resource loads " + String(settings.runs_) + " times");
+
+    Vector<ReplayRun> runs;
+    for (unsigned i = 0; i < settings.runs_; ++i)
+    {
+        runs.Push(ReplayLoadList(engine, cache, entries, settings));
+        cache->ReleaseAllResources(true);
+    }
+
+    const ReplayRun& coldRun = runs.Front();
+    PrintLine("\nCold run, " + String(coldRun.records_.Size()) + " loads\n\n" + coldRun.report_);
+    if (runs.Size() > 1)
+    {
+        const ReplayRun& warmRun = runs.Back();
+        PrintLine("Last warm run, " + String(warmRun.records_.Size()) + " loads\n\n" + warmRun.report_);
+    }
+
+    // Compare the cold run to the mean of the warm runs per resource type
+    HashMap<String, LoadStageTimes> coldTotals;
+    HashMap<String, LoadStageTimes> warmTotals;
+    GetTypeTotals(coldRun.records_, coldTotals);
+    float warmWallMs = 0.0f;
+    for (unsigned i = 1; i < runs.Size(); ++i)
+    {
+        GetTypeTotals(runs[i].records_, warmTotals);
+        warmWallMs += runs[i].wallMs_;
+    }
+    unsigned numWarmRuns = runs.Size() - 1;
+
+    Vector<Pair<String, LoadStageTimes> > sortedColdTotals;
+    for (HashMap<String, LoadStageTimes>::ConstIterator i = coldTotals.Begin(); i != coldTotals.End(); ++i)
+        sortedColdTotals.Push(MakePair(i->first_, i->second_));
+    Sort(sortedColdTotals.Begin(), sortedColdTotals.End(), CompareTypeTotals);
+
+    char line[256];
+    PrintLine("Resource Type                 Cold ms  Warm ms   Cold read  Warm read");
+    for (unsigned i = 0; i < sortedColdTotals.Size(); ++i)
+    {
+        const LoadStageTimes& cold = sortedColdTotals[i].second_;
+        const LoadStageTimes& warm = warmTotals[sortedColdTotals[i].first_];
+        float warmMs = numWarmRuns ? warm.GetTotal() / 1000.0f / numWarmRuns : 0.0f;
+        float warmReadMs = numWarmRuns ? warm.usec_[LOADSTAGE_READ] / 1000.0f / numWarmRuns : 0.0f;
+        sprintf(line, "%-28s %8.2f %8.2f %11.2f %10.2f", sortedColdTotals[i].first_.CString(), cold.GetTotal() / 1000.0f, warmMs,
+            cold.usec_[LOADSTAGE_READ] / 1000.0f, warmReadMs);
+        PrintLine(line);
+    }
+    sprintf(line, "%-28s %8.2f %8.2f", "Wall clock", coldRun.wallMs_, numWarmRuns ? warmWallMs / numWarmRuns : 0.0f);
+    PrintLine(line);
+
+    if (settings.jsonFileName_.Empty())
+        return;
+
+    JSONFile json(context);
+    JSONValue& root = json.GetRoot();
+
+    JSONValue info;
+    info.Set("date", Time::GetTimeStamp());
+    info.Set("platform", GetPlatform());
+#ifdef NDEBUG
+    info.Set("buildType", "release");
+#else
+    info.Set("buildType", "debug");
+#endif
+    info.Set("loadList", settings.loadListName_);
+    info.Set("loads", entries.Size());
+    info.Set("backgroundThreads", settings.backgroundThreads_);
+    info.Set("mappedPackages", settings.mappedPackages_);
+    info.Set("resourceIndex", settings.resourceIndex_);
+    info.Set("graphics", settings.graphics_);
+    root.Set("context", info);
+
+    JSONArray runArray;
+    for (unsigned i = 0; i < runs.Size(); ++i)
+        runArray.Push(GetRunValue(runs[i], i == 0));
+    root.Set("runs", runArray);
+
+    File file(context);
+    if (!file.Open(settings.jsonFileName_, FILE_WRITE) || !json.Save(file, "  "))
+        ErrorExit("Could not write " + settings.jsonFileName_);
+}
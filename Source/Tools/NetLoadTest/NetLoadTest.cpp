@@ -0,0 +1,584 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "SimulatedClient.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdio>
+
+#include <Urho3D/DebugNew.h>
+
+/// Target frame rate of the server and the simulated clients.
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+/// Maximum time to wait for the clients to join the scene, in seconds.
+static const float JOIN_TIMEOUT = 30.0f;
+/// Avatar movement speed in units per second.
+static const float AVATAR_SPEED = 5.0f;
+/// Half size of the area the objects and avatars move in.
+static const float AREA_SIZE = 100.0f;
+
+/// Settings of the load test.
+struct LoadTestSettings
+{
+    /// Number of simulated clients.
+    unsigned clients_{100};
+    /// Measured duration in seconds.
+    float duration_{30.0f};
+    /// Control pattern of the clients.
+    ControlPattern pattern_{CP_MIXED};
+    /// Control pattern name.
+    String patternName_{"mixed"};
+    /// Number of moving server-driven objects.
+    unsigned objects_{100};
+    /// Simulated latency in milliseconds.
+    int latency_{};
+    /// Simulated packet loss probability.
+    float packetLoss_{};
+    /// Server port.
+    unsigned short port_{2345};
+    /// Network update rate.
+    int updateFps_{30};
+    /// Interest management radius, zero to replicate everything to every client.
+    float interestRadius_{};
+    /// Prepare the client updates in worker threads.
+    bool threaded_{};
+    /// Coalesce small messages into batches.
+    bool batching_{};
+    /// JSON file to write the results to, empty for none.
+    String jsonFileName_;
+};
+
+/// Server-driven object moving in a circle.
+struct MovingObject
+{
+    /// Node.
+    SharedPtr<Node> node_;
+    /// Circle center.
+    Vector3 center_;
+    /// Circle radius.
+    float radius_;
+    /// Angular speed in degrees per second.
+    float speed_;
+};
+
+/// Client avatar moved by the client's controls.
+struct Avatar
+{
+    /// Client connection.
+    WeakPtr<Connection> connection_;
+    /// Node.
+    SharedPtr<Node> node_;
+};
+
+/// Server frame times in milliseconds.
+struct ServerFrameTimes
+{
+    /// Receiving messages, Network::Update().
+    PODVector<float> receive_;
+    /// Moving the avatars and objects, and the scene update.
+    PODVector<float> simulate_;
+    /// Sending the replication updates, Network::PostUpdate().
+    PODVector<float> replicate_;
+    /// All of the above.
+    PODVector<float> total_;
+};
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+
+static ControlPattern ParsePattern(const String& name)
+{
+    static const char* patternNames[] = { "idle", "walk", "circle", "random", "mixed", nullptr };
+    int index = GetStringListIndex(name.CString(), patternNames, -1, false);
+    if (index < 0)
+        ErrorExit("Unknown control pattern " + name);
+    return (ControlPattern)index;
+}
+
+static float GetPercentile(const PODVector<float>& sorted, float percentile)
+{
+    if (sorted.Empty())
+        return 0.0f;
+    return sorted[Min((unsigned)(percentile * 0.01f * sorted.Size()), sorted.Size() - 1)];
+}
+
+static float GetMean(const PODVector<float>& values)
+{
+    float sum = 0.0f;
+    for (unsigned i = 0; i < values.Size(); ++i)
+        sum += values[i];
+    return values.Size() ? sum / values.Size() : 0.0f;
+}
+
+static void CreateObjects(Scene* scene, unsigned numObjects, Vector<MovingObject>& objects)
+{
+    // Fixed seed so that every run creates the same objects
+    SetRandomSeed(1);
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        MovingObject object;
+        object.node_ = scene->CreateChild("Object");
+        // The component has no model; it is there to replicate component data along the node
+        object.node_->CreateComponent<StaticModel>();
+        object.center_ = Vector3(Random(-AREA_SIZE, AREA_SIZE), 0.0f, Random(-AREA_SIZE, AREA_SIZE));
+        object.radius_ = Random(2.0f, 10.0f);
+        object.speed_ = Random(30.0f, 90.0f);
+        objects.Push(object);
+    }
+}
+
+/// Assign the scene to the new client connections and create their avatars, and remove the avatars of the disconnected ones.
+static void UpdateAvatars(Network* network, Scene* scene, float interestRadius, Vector<Avatar>& avatars)
+{
+    for (unsigned i = avatars.Size() - 1; i < avatars.Size(); --i)
+    {
+        if (avatars[i].connection_.Expired())
+        {
+            avatars[i].node_->Remove();
+            avatars.Erase(i);
+        }
+    }
+
+    Vector<SharedPtr<Connection> > connections = network->GetClientConnections();
+    for (unsigned i = 0; i < connections.Size(); ++i)
+    {
+        Connection* connection = connections[i];
+        if (connection->GetScene())
+            continue;
+
+        connection->SetInterestRadius(interestRadius);
+        connection->SetScene(scene);
+
+        Avatar avatar;
+        avatar.connection_ = connection;
+        avatar.node_ = scene->CreateChild("Avatar");
+        avatar.node_->SetPosition(Vector3(Random(-AREA_SIZE, AREA_SIZE), 0.0f, Random(-AREA_SIZE, AREA_SIZE)));
+        avatar.node_->CreateComponent<StaticModel>();
+        avatar.node_->SetOwner(connection);
+        avatars.Push(avatar);
+    }
+}
+
+static void MoveAvatars(Vector<Avatar>& avatars, float timeStep)
+{
+    for (unsigned i = 0; i < avatars.Size(); ++i)
+    {
+        Connection* connection = avatars[i].connection_;
+        if (!connection || !connection->IsSceneLoaded())
+            continue;
+
+        const Controls& controls = connection->GetControls();
+        Node* node = avatars[i].node_;
+        node->SetRotation(Quaternion(controls.yaw_, Vector3::UP));
+
+        Vector3 direction;
+        if (controls.buttons_ & CTRL_FORWARD)
+            direction += Vector3::FORWARD;
+        if (controls.buttons_ & CTRL_BACK)
+            direction += Vector3::BACK;
+        if (controls.buttons_ & CTRL_LEFT)
+            direction += Vector3::LEFT;
+        if (controls.buttons_ & CTRL_RIGHT)
+            direction += Vector3::RIGHT;
+        if (direction.LengthSquared() == 0.0f)
+            continue;
+
+        node->Translate(direction.Normalized() * AVATAR_SPEED * timeStep);
+        // Keep the avatars within the area so that the interest management sees a steady density
+        Vector3 position = node->GetPosition();
+        node->SetPosition(Vector3(Clamp(position.x_, -AREA_SIZE, AREA_SIZE), 0.0f, Clamp(position.z_, -AREA_SIZE, AREA_SIZE)));
+    }
+}
+
+static void MoveObjects(Vector<MovingObject>& objects, float elapsedTime)
+{
+    for (unsigned i = 0; i < objects.Size(); ++i)
+    {
+        MovingObject& object = objects[i];
+        float angle = object.speed_ * elapsedTime;
+        object.node_->SetPosition(object.center_ + Vector3(Cos(angle), 0.0f, Sin(angle)) * object.radius_);
+        object.node_->SetRotation(Quaternion(-angle, Vector3::UP));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    LoadTestSettings settings;
+
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        const String& arg = arguments[i];
+        bool hasValue = i + 1 < arguments.Size();
+
+        if (arg == "-clients" && hasValue)
+            settings.clients_ = Max(ToUInt(arguments[++i]), 1U);
+        else if (arg == "-duration" && hasValue)
+            settings.duration_ = Max(ToFloat(arguments[++i]), 1.0f);
+        else if (arg == "-pattern" && hasValue)
+        {
+            settings.patternName_ = arguments[++i].ToLower();
+            settings.pattern_ = ParsePattern(settings.patternName_);
+        }
+        else if (arg == "-objects" && hasValue)
+            settings.objects_ = ToUInt(arguments[++i]);
+        else if (arg == "-latency" && hasValue)
+            settings.latency_ = Max(ToInt(arguments[++i]), 0);
+        else if (arg == "-loss" && hasValue)
+            settings.packetLoss_ = Clamp(ToFloat(arguments[++i]), 0.0f, 1.0f);
+        else if (arg == "-port" && hasValue)
+            settings.port_ = (unsigned short)ToUInt(arguments[++i]);
+        else if (arg == "-fps" && hasValue)
+            settings.updateFps_ = Max(ToInt(arguments[++i]), 1);
+        else if (arg == "-interest" && hasValue)
+            settings.interestRadius_ = Max(ToFloat(arguments[++i]), 0.0f);
+        else if (arg == "-threaded")
+            settings.threaded_ = true;
+        else if (arg == "-batching")
+            settings.batching_ = true;
+        else if (arg == "-json" && hasValue)
+            settings.jsonFileName_ = arguments[++i];
+        else
+        {
+            ErrorExit("Usage: NetLoadTest [options]\n\n"
+                "Options:\n"
+                "-clients <n>         Number of simulated clients, default 100\n"
+                "-duration <seconds>  Measured duration after the clients have joined, default 30\n"
+                "-pattern <name>      Control pattern: idle, walk, circle, random or mixed (default)\n"
+                "-objects <n>         Number of moving server-driven objects, default 100\n"
+                "-latency <ms>        Simulated latency of each packet sent, default 0\n"
+                "-loss <probability>  Simulated packet loss between 0 and 1, default 0\n"
+                "-port <port>         Server port, default 2345\n"
+                "-fps <n>             Network update rate, default 30\n"
+                "-interest <radius>   Interest management radius, default 0 replicates everything\n"
+                "-threaded            Prepare the client updates in worker threads\n"
+                "-batching            Coalesce small messages into batches\n"
+                "-json <file>         Write the results to a JSON file\n\n"
+                "The server and the clients run in the same process over the loopback interface. The clients parse the\n"
+                "replication messages without creating nodes, so that the server's cost dominates.");
+        }
+    }
+
+    SharedPtr<Context> context(new Context());
+    SharedPtr<Engine> engine(new Engine(context));
+
+    // The server scene is generated, so no resources are needed
+    VariantMap engineParameters;
+    engineParameters[EP_HEADLESS] = true;
+    engineParameters[EP_RESOURCE_PATHS] = String::EMPTY;
+    engineParameters[EP_AUTOLOAD_PATHS] = String::EMPTY;
+    engineParameters[EP_LOG_NAME] = String::EMPTY;
+    engineParameters[EP_LOG_LEVEL] = LOG_WARNING;
+    engineParameters[EP_SOUND] = false;
+    if (!engine->Initialize(engineParameters))
+        ErrorExit("Could not initialize the engine");
+
+    auto* time = context->GetSubsystem<Time>();
+    auto* network = context->GetSubsystem<Network>();
+    network->SetUpdateFps(settings.updateFps_);
+    network->SetSimulatedLatency(settings.latency_);
+    network->SetSimulatedPacketLoss(settings.packetLoss_);
+    network->SetThreadedServerUpdate(settings.threaded_);
+    network->SetMessageBatching(settings.batching_);
+    if (!network->StartServer(settings.port_, settings.clients_))
+        ErrorExit("Could not start the server on port " + String(settings.port_));
+
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<Octree>();
+    Vector<MovingObject> objects;
+    Vector<Avatar> avatars;
+    CreateObjects(scene, settings.objects_, objects);
+
+    Vector<SharedPtr<SimulatedClient> > clients;
+    for (unsigned i = 0; i < settings.clients_; ++i)
+    {
+        SharedPtr<SimulatedClient> client(new SimulatedClient(context, i, settings.pattern_));
+        client->SetSceneChecksum(scene->GetChecksum());
+        if (!client->Connect("127.0.0.1", settings.port_, settings.latency_, settings.packetLoss_))
+            ErrorExit("Could not start simulated client " + String(i));
+        clients.Push(client);
+    }
+
+    char line[256];
+    sprintf(line, "%u clients, pattern %s, %u objects, %d ms latency, %.1f%% packet loss, %d updates per second",
+        settings.clients_, settings.patternName_.CString(), settings.objects_, settings.latency_, settings.packetLoss_ * 100.0f, settings.updateFps_);
+    PrintLine(line);
+    if ((settings.latency_ || settings.packetLoss_ > 0.0f) && !clients.Front()->IsNetworkSimulatorActive())
+        PrintLine("Warning: SLikeNet simulates latency and packet loss only in debug builds, they have no effect");
+
+    ServerFrameTimes frameTimes;
+    float clientMs = 0.0f;
+    unsigned measuredFrames = 0;
+    float sendInterval = 1.0f / settings.updateFps_;
+    float elapsedTime = 0.0f;
+    float measureStart = -1.0f;
+    HiresTimer frameTimer;
+    HiresTimer stageTimer;
+
+    for (;;)
+    {
+        float timeStep = Min(frameTimer.GetUSec(true) / 1000000.0f, 0.1f);
+        elapsedTime += timeStep;
+
+        bool measuring = measureStart >= 0.0f;
+        if (measuring && elapsedTime - measureStart >= settings.duration_)
+            break;
+
+        // Server frame
+        stageTimer.Reset();
+        time->BeginFrame(timeStep);
+        float receiveMs = stageTimer.GetUSec(true) / 1000.0f;
+        UpdateAvatars(network, scene, settings.interestRadius_, avatars);
+        MoveAvatars(avatars, timeStep);
+        MoveObjects(objects, elapsedTime);
+        scene->Update(timeStep);
+        float simulateMs = stageTimer.GetUSec(true) / 1000.0f;
+        network->PostUpdate(timeStep);
+        float replicateMs = stageTimer.GetUSec(true) / 1000.0f;
+        time->EndFrame();
+
+        // Client frames
+        for (unsigned i = 0; i < clients.Size(); ++i)
+            clients[i]->Update(timeStep, sendInterval);
+        float clientFrameMs = stageTimer.GetUSec(true) / 1000.0f;
+
+        if (measuring)
+        {
+            frameTimes.receive_.Push(receiveMs);
+            frameTimes.simulate_.Push(simulateMs);
+            frameTimes.replicate_.Push(replicateMs);
+            frameTimes.total_.Push(receiveMs + simulateMs + replicateMs);
+            clientMs += clientFrameMs;
+            ++measuredFrames;
+        }
+        else
+        {
+            unsigned joined = 0;
+            unsigned failed = 0;
+            for (unsigned i = 0; i < clients.Size(); ++i)
+            {
+                if (clients[i]->IsSceneLoaded())
+                    ++joined;
+                else if (clients[i]->IsFailed())
+                    ++failed;
+            }
+
+            // Start measuring once everyone has joined, or whoever has joined by the timeout
+            if (joined + failed == clients.Size() || elapsedTime >= JOIN_TIMEOUT)
+            {
+                sprintf(line, "%u clients joined in %.1f seconds, %u failed", joined, elapsedTime, clients.Size() - joined);
+                PrintLine(line);
+                if (!joined)
+                    ErrorExit("No clients joined the scene");
+
+                for (unsigned i = 0; i < clients.Size(); ++i)
+                    clients[i]->ResetStats();
+                measureStart = elapsedTime;
+            }
+        }
+
+        // Run at the target frame rate, so that the network update rate and the timings are those of a real server
+        float frameTime = frameTimer.GetUSec(false) / 1000000.0f;
+        if (frameTime < FRAME_TIME_STEP)
+            Time::SleepUSec((unsigned)((FRAME_TIME_STEP - frameTime) * 1000000.0f));
+    }
+
+    float seconds = elapsedTime - measureStart;
+    unsigned joined = 0;
+    SimulatedClientStats total;
+    for (unsigned i = 0; i < clients.Size(); ++i)
+    {
+        if (!clients[i]->IsSceneLoaded())
+            continue;
+
+        const SimulatedClientStats& stats = clients[i]->GetStats();
+        ++joined;
+        total.bytesIn_ += stats.bytesIn_;
+        total.bytesOut_ += stats.bytesOut_;
+        total.sceneUpdates_ += stats.sceneUpdates_;
+        total.parseErrors_ += stats.parseErrors_;
+        total.roundTripMs_.Push(stats.roundTripMs_);
+        total.updateIntervalMs_.Push(stats.updateIntervalMs_);
+    }
+    for (unsigned i = 0; i < clients.Size(); ++i)
+        clients[i]->Disconnect();
+    network->StopServer();
+
+    if (!joined)
+        ErrorExit("All clients disconnected during the test");
+
+    Sort(total.roundTripMs_.Begin(), total.roundTripMs_.End());
+    Sort(total.updateIntervalMs_.Begin(), total.updateIntervalMs_.End());
+
+    PODVector<float>* stageTimes[] = { &frameTimes.receive_, &frameTimes.simulate_, &frameTimes.replicate_, &frameTimes.total_ };
+    const char* stageNames[] = { "Receive", "Simulate", "Replicate", "Total" };
+    float stageMeans[4];
+
+    sprintf(line, "%u clients connected at the end, %u frames in %.1f seconds", joined, measuredFrames, seconds);
+    PrintLine(line);
+    PrintLine("");
+    sprintf(line, "%-24s %10s %10s %10s %10s", "Server ms per frame", "Mean", "P50", "P99", "Max");
+    PrintLine(line);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        PODVector<float>& times = *stageTimes[i];
+        stageMeans[i] = GetMean(times);
+        Sort(times.Begin(), times.End());
+        sprintf(line, "%-24s %10.3f %10.3f %10.3f %10.3f", stageNames[i], stageMeans[i], GetPercentile(times, 50.0f),
+            GetPercentile(times, 99.0f), times.Empty() ? 0.0f : times.Back());
+        PrintLine(line);
+    }
+
+    float serverUsPerClient = stageMeans[3] * 1000.0f / joined;
+    float bytesInPerClient = total.bytesIn_ / seconds / joined;
+    float bytesOutPerClient = total.bytesOut_ / seconds / joined;
+    float updatesPerClient = total.sceneUpdates_ / seconds / joined;
+    PrintLine("");
+    sprintf(line, "Server CPU per client: %.2f us per frame", serverUsPerClient);
+    PrintLine(line);
+    sprintf(line, "Per client: %.0f bytes/s from the server, %.0f bytes/s to the server, %.1f scene update messages/s",
+        bytesInPerClient, bytesOutPerClient, updatesPerClient);
+    PrintLine(line);
+    sprintf(line, "Client parsing: %.3f ms per frame for all clients, %u messages failed to parse", clientMs / Max(measuredFrames, 1U),
+        total.parseErrors_);
+    PrintLine(line);
+    PrintLine("");
+    sprintf(line, "%-24s %10s %10s %10s %10s %10s", "Latency ms", "Min", "P50", "P90", "P99", "Max");
+    PrintLine(line);
+    const PODVector<float>& rtt = total.roundTripMs_;
+    const PODVector<float>& interval = total.updateIntervalMs_;
+    sprintf(line, "%-24s %10.1f %10.1f %10.1f %10.1f %10.1f", "Round trip", rtt.Empty() ? 0.0f : rtt.Front(),
+        GetPercentile(rtt, 50.0f), GetPercentile(rtt, 90.0f), GetPercentile(rtt, 99.0f), rtt.Empty() ? 0.0f : rtt.Back());
+    PrintLine(line);
+    sprintf(line, "%-24s %10.1f %10.1f %10.1f %10.1f %10.1f", "Scene update interval", interval.Empty() ? 0.0f : interval.Front(),
+        GetPercentile(interval, 50.0f), GetPercentile(interval, 90.0f), GetPercentile(interval, 99.0f),
+        interval.Empty() ? 0.0f : interval.Back());
+    PrintLine(line);
+
+    if (settings.jsonFileName_.Empty())
+        return;
+
+    JSONFile json(context);
+    JSONValue& root = json.GetRoot();
+
+    JSONValue info;
+    info.Set("date", Time::GetTimeStamp());
+    info.Set("platform", GetPlatform());
+    info.Set("physicalCPUs", GetNumPhysicalCPUs());
+#ifdef NDEBUG
+    info.Set("buildType", "release");
+#else
+    info.Set("buildType", "debug");
+#endif
+    info.Set("clients", settings.clients_);
+    info.Set("joinedClients", joined);
+    info.Set("pattern", settings.patternName_);
+    info.Set("objects", settings.objects_);
+    info.Set("latency", settings.latency_);
+    info.Set("packetLoss", settings.packetLoss_);
+    info.Set("networkSimulator", clients.Front()->IsNetworkSimulatorActive());
+    info.Set("updateFps", settings.updateFps_);
+    info.Set("interestRadius", settings.interestRadius_);
+    info.Set("threaded", settings.threaded_);
+    info.Set("batching", settings.batching_);
+    info.Set("seconds", seconds);
+    info.Set("frames", measuredFrames);
+    root.Set("context", info);
+
+    JSONArray stageArray;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const PODVector<float>& times = *stageTimes[i];
+        JSONValue stageValue;
+        stageValue.Set("name", stageNames[i]);
+        stageValue.Set("timeUnit", "ms");
+        stageValue.Set("mean", stageMeans[i]);
+        stageValue.Set("p50", GetPercentile(times, 50.0f));
+        stageValue.Set("p99", GetPercentile(times, 99.0f));
+        stageValue.Set("max", times.Empty() ? 0.0f : times.Back());
+        stageArray.Push(stageValue);
+    }
+    root.Set("serverStages", stageArray);
+
+    JSONValue perClient;
+    perClient.Set("serverUsPerFrame", serverUsPerClient);
+    perClient.Set("bytesInPerSec", bytesInPerClient);
+    perClient.Set("bytesOutPerSec", bytesOutPerClient);
+    perClient.Set("sceneUpdatesPerSec", updatesPerClient);
+    perClient.Set("parseErrors", total.parseErrors_);
+    root.Set("perClient", perClient);
+
+    const PODVector<float>* latencies[] = { &rtt, &interval };
+    const char* latencyNames[] = { "roundTrip", "updateInterval" };
+    JSONValue latency;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        const PODVector<float>& samples = *latencies[i];
+        JSONValue value;
+        value.Set("timeUnit", "ms");
+        value.Set("samples", samples.Size());
+        value.Set("min", samples.Empty() ? 0.0f : samples.Front());
+        value.Set("p50", GetPercentile(samples, 50.0f));
+        value.Set("p90", GetPercentile(samples, 90.0f));
+        value.Set("p99", GetPercentile(samples, 99.0f));
+        value.Set("max", samples.Empty() ? 0.0f : samples.Back());
+        latency.Set(latencyNames[i], value);
+    }
+    root.Set("latency", latency);
+
+    File file(context);
+    if (!file.Open(settings.jsonFileName_, FILE_WRITE) || !json.Save(file, "  "))
+        ErrorExit("Could not write " + settings.jsonFileName_);
+}
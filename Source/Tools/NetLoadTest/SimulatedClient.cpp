@@ -0,0 +1,470 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Network/Protocol.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/ReplicationState.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "SimulatedClient.h"
+
+#include <SLikeNet/MessageIdentifiers.h>
+#include <SLikeNet/peerinterface.h>
+
+#ifdef SendMessage
+#undef SendMessage
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+/// Interval between round trip time measurements.
+static const float PING_INTERVAL = 1.0f;
+/// Turn rate of the circle pattern in degrees per second.
+static const float CIRCLE_TURN_RATE = 45.0f;
+/// Interval of turning around in the walk pattern.
+static const float WALK_TURN_INTERVAL = 4.0f;
+
+SimulatedClient::SimulatedClient(Context* context, unsigned index, ControlPattern pattern) :
+    context_(context),
+    peer_(SLNet::RakPeerInterface::GetInstance()),
+    serverAddress_(new SLNet::SystemAddress()),
+    index_(index),
+    pattern_(pattern == CP_MIXED ? (ControlPattern)(index % CP_MIXED) : pattern),
+    patternTimer_(0.0f),
+    sendAcc_(0.0f),
+    pingAcc_(0.0f),
+    timeStamp_(0),
+    sceneChecksum_(0),
+    hasUpdate_(false),
+    connected_(false),
+    sceneLoaded_(false),
+    failed_(false),
+    simulatorActive_(false)
+{
+    // Spread the initial directions so that the avatars do not all move the same way
+    controls_.yaw_ = index * 137.5f;
+}
+
+SimulatedClient::~SimulatedClient()
+{
+    Disconnect();
+    SLNet::RakPeerInterface::DestroyInstance(peer_);
+    delete serverAddress_;
+}
+
+bool SimulatedClient::Connect(const String& address, unsigned short port, int simulatedLatency, float simulatedPacketLoss)
+{
+    SLNet::SocketDescriptor socket;
+    if (peer_->Startup(1, &socket, 1) != SLNet::RAKNET_STARTED)
+        return false;
+
+    peer_->SetOccasionalPing(true);
+    peer_->ApplyNetworkSimulator(simulatedPacketLoss, (unsigned short)simulatedLatency, 0);
+    simulatorActive_ = peer_->IsNetworkSimulatorActive();
+    return peer_->Connect(address.CString(), port, nullptr, 0) == SLNet::CONNECTION_ATTEMPT_STARTED;
+}
+
+void SimulatedClient::Disconnect()
+{
+    if (!peer_->IsActive())
+        return;
+
+    if (connected_)
+        peer_->CloseConnection(*serverAddress_, true);
+    // Give the disconnection notification a moment to go out
+    peer_->Shutdown(connected_ ? 100 : 0);
+    connected_ = false;
+    sceneLoaded_ = false;
+}
+
+void SimulatedClient::Update(float timeStep, float sendInterval)
+{
+    bool receivedUpdate = false;
+    for (SLNet::Packet* packet = peer_->Receive(); packet; peer_->DeallocatePacket(packet), packet = peer_->Receive())
+    {
+        stats_.bytesIn_ += packet->length;
+        ++stats_.packetsIn_;
+        if (packet->data[0] == ID_CONNECTION_REQUEST_ACCEPTED)
+            *serverAddress_ = packet->systemAddress;
+        if (HandlePacket(packet->data, packet->length))
+            receivedUpdate = true;
+    }
+
+    // The packets of one network update arrive together, so measure the interval between the frames that received any
+    if (receivedUpdate)
+    {
+        if (hasUpdate_)
+            stats_.updateIntervalMs_.Push(updateTimer_.GetUSec(false) / 1000.0f);
+        updateTimer_.Reset();
+        hasUpdate_ = true;
+    }
+
+    if (!sceneLoaded_)
+        return;
+
+    UpdateControls(timeStep);
+
+    sendAcc_ += timeStep;
+    if (sendAcc_ >= sendInterval)
+    {
+        sendAcc_ = fmodf(sendAcc_, sendInterval);
+
+        // Same layout as Connection::SendClientUpdate(), without the optional observer position
+        msg_.Clear();
+        msg_.WriteUInt(controls_.buttons_);
+        msg_.WriteFloat(controls_.yaw_);
+        msg_.WriteFloat(controls_.pitch_);
+        msg_.WriteVariantMap(controls_.extraData_);
+        msg_.WriteUByte(timeStamp_++);
+        SendMessage(MSG_CONTROLS, false, msg_);
+    }
+
+    pingAcc_ += timeStep;
+    if (pingAcc_ >= PING_INTERVAL)
+    {
+        pingAcc_ = 0.0f;
+        int lastPing = peer_->GetLastPing(*serverAddress_);
+        if (lastPing >= 0)
+            stats_.roundTripMs_.Push((float)lastPing);
+        peer_->Ping(*serverAddress_);
+    }
+}
+
+void SimulatedClient::ResetStats()
+{
+    stats_ = SimulatedClientStats();
+    hasUpdate_ = false;
+}
+
+bool SimulatedClient::HandlePacket(const unsigned char* data, unsigned numBytes)
+{
+    unsigned char packetID = data[0];
+    unsigned dataStart = sizeof(char);
+    if (packetID == ID_TIMESTAMP)
+    {
+        dataStart += sizeof(SLNet::Time);
+        packetID = data[dataStart];
+        dataStart += sizeof(char);
+    }
+
+    switch (packetID)
+    {
+    case ID_CONNECTION_REQUEST_ACCEPTED:
+        {
+            connected_ = true;
+
+            VariantMap identity;
+            identity["ClientIndex"] = index_;
+            msg_.Clear();
+            msg_.WriteVariantMap(identity);
+            SendMessage(MSG_IDENTITY, true, msg_);
+        }
+        break;
+
+    case ID_CONNECTION_ATTEMPT_FAILED:
+    case ID_NO_FREE_INCOMING_CONNECTIONS:
+    case ID_CONNECTION_LOST:
+    case ID_DISCONNECTION_NOTIFICATION:
+        connected_ = false;
+        sceneLoaded_ = false;
+        failed_ = true;
+        break;
+
+    default:
+        if (packetID >= ID_USER_PACKET_ENUM)
+        {
+            MemoryBuffer msg(data + dataStart, numBytes - dataStart);
+            return HandleMessage(packetID, msg);
+        }
+        break;
+    }
+
+    return false;
+}
+
+bool SimulatedClient::HandleMessage(int msgID, MemoryBuffer& msg)
+{
+    switch (msgID)
+    {
+    case MSG_LOADSCENE:
+        {
+            // Join directly without loading anything. The client's own scene is the root node of the replicated scene
+            nodes_.Clear();
+            components_.Clear();
+            nodes_[FIRST_REPLICATED_ID] = Scene::GetTypeStatic();
+            sceneLoaded_ = true;
+
+            msg_.Clear();
+            msg_.WriteUInt(sceneChecksum_);
+            SendMessage(MSG_SCENELOADED, true, msg_);
+        }
+        return false;
+
+    case MSG_SCENECHECKSUMERROR:
+        sceneLoaded_ = false;
+        failed_ = true;
+        return false;
+
+    case MSG_CREATENODE:
+    case MSG_NODEDELTAUPDATE:
+    case MSG_NODELATESTDATA:
+    case MSG_REMOVENODE:
+    case MSG_CREATECOMPONENT:
+    case MSG_COMPONENTDELTAUPDATE:
+    case MSG_COMPONENTLATESTDATA:
+    case MSG_REMOVECOMPONENT:
+        ParseSceneUpdate(msgID, msg);
+        return true;
+
+    // Qualified, as SLikeNet has a message ID of the same name
+    case Urho3D::MSG_BATCH:
+        {
+            bool sceneUpdate = false;
+            while (!msg.IsEof())
+            {
+                unsigned numBytes = msg.ReadVLE();
+                if (!numBytes || msg.GetPosition() + numBytes > msg.GetSize())
+                {
+                    ++stats_.parseErrors_;
+                    break;
+                }
+
+                const unsigned char* data = msg.GetData() + msg.GetPosition();
+                msg.Seek(msg.GetPosition() + numBytes);
+                MemoryBuffer subMsg(data + 1, numBytes - 1);
+                if (data[0] != Urho3D::MSG_BATCH && HandleMessage(data[0], subMsg))
+                    sceneUpdate = true;
+            }
+            return sceneUpdate;
+        }
+
+    default:
+        // Remote events and package transfers are only counted in the traffic
+        return false;
+    }
+}
+
+void SimulatedClient::ParseSceneUpdate(int msgID, MemoryBuffer& msg)
+{
+    if (!sceneLoaded_)
+        return;
+
+    ++stats_.sceneUpdates_;
+
+    switch (msgID)
+    {
+    case MSG_CREATENODE:
+        {
+            unsigned nodeID = msg.ReadNetID();
+            HashMap<unsigned, StringHash>::Iterator i = nodes_.Find(nodeID);
+            StringHash nodeType = i != nodes_.End() ? i->second_ : Node::GetTypeStatic();
+            nodes_[nodeID] = nodeType;
+            if (!SkipDeltaUpdate(nodeType, msg))
+            {
+                ++stats_.parseErrors_;
+                return;
+            }
+
+            unsigned numVars = msg.ReadVLE();
+            while (numVars--)
+            {
+                msg.ReadStringHash();
+                msg.ReadVariant();
+            }
+
+            unsigned numComponents = msg.ReadVLE();
+            while (numComponents--)
+            {
+                StringHash type = msg.ReadStringHash();
+                unsigned componentID = msg.ReadNetID();
+                // An unknown component type would desync the rest of the message, like on a real client
+                if (!SkipDeltaUpdate(type, msg))
+                {
+                    ++stats_.parseErrors_;
+                    return;
+                }
+                components_[componentID] = type;
+            }
+        }
+        break;
+
+    case MSG_NODEDELTAUPDATE:
+        {
+            unsigned nodeID = msg.ReadNetID();
+            HashMap<unsigned, StringHash>::Iterator i = nodes_.Find(nodeID);
+            if (i == nodes_.End() || !SkipDeltaUpdate(i->second_, msg))
+            {
+                ++stats_.parseErrors_;
+                return;
+            }
+
+            unsigned changedVars = msg.ReadVLE();
+            while (changedVars--)
+            {
+                msg.ReadStringHash();
+                msg.ReadVariant();
+            }
+        }
+        break;
+
+    case MSG_NODELATESTDATA:
+        {
+            // Latest data may arrive before the node is created. A real client caches it, here it is enough to skip it
+            unsigned nodeID = msg.ReadNetID();
+            HashMap<unsigned, StringHash>::Iterator i = nodes_.Find(nodeID);
+            if (i != nodes_.End())
+                SkipLatestDataUpdate(i->second_, msg);
+        }
+        break;
+
+    case MSG_REMOVENODE:
+        nodes_.Erase(msg.ReadNetID());
+        break;
+
+    case MSG_CREATECOMPONENT:
+        {
+            unsigned nodeID = msg.ReadNetID();
+            StringHash type = msg.ReadStringHash();
+            unsigned componentID = msg.ReadNetID();
+            if (!nodes_.Contains(nodeID) || !SkipDeltaUpdate(type, msg))
+            {
+                ++stats_.parseErrors_;
+                return;
+            }
+            components_[componentID] = type;
+        }
+        break;
+
+    case MSG_COMPONENTDELTAUPDATE:
+        {
+            unsigned componentID = msg.ReadNetID();
+            HashMap<unsigned, StringHash>::Iterator i = components_.Find(componentID);
+            if (i == components_.End() || !SkipDeltaUpdate(i->second_, msg))
+                ++stats_.parseErrors_;
+        }
+        break;
+
+    case MSG_COMPONENTLATESTDATA:
+        {
+            unsigned componentID = msg.ReadNetID();
+            HashMap<unsigned, StringHash>::Iterator i = components_.Find(componentID);
+            if (i != components_.End())
+                SkipLatestDataUpdate(i->second_, msg);
+        }
+        break;
+
+    case MSG_REMOVECOMPONENT:
+        components_.Erase(msg.ReadNetID());
+        break;
+
+    default: break;
+    }
+}
+
+bool SimulatedClient::SkipDeltaUpdate(StringHash type, MemoryBuffer& msg)
+{
+    // Same layout as Serializable::ReadDeltaUpdate(): timestamp, bitmask of the changed attributes, then their values
+    const Vector<AttributeInfo>* attributes = context_->GetNetworkAttributes(type);
+    if (!attributes)
+        return false;
+
+    unsigned numAttributes = attributes->Size();
+    DirtyBits attributeBits;
+    msg.ReadUByte();
+    msg.Read(attributeBits.data_, (numAttributes + 7) >> 3u);
+
+    for (unsigned i = 0; i < numAttributes && !msg.IsEof(); ++i)
+    {
+        if (attributeBits.IsSet(i))
+            msg.ReadVariant(attributes->At(i).type_);
+    }
+
+    return true;
+}
+
+bool SimulatedClient::SkipLatestDataUpdate(StringHash type, MemoryBuffer& msg)
+{
+    // Same layout as Serializable::ReadLatestDataUpdate(): timestamp, then the values of all latest data attributes
+    const Vector<AttributeInfo>* attributes = context_->GetNetworkAttributes(type);
+    if (!attributes)
+        return false;
+
+    msg.ReadUByte();
+    for (unsigned i = 0; i < attributes->Size() && !msg.IsEof(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (attr.mode_ & AM_LATESTDATA)
+            msg.ReadVariant(attr.type_);
+    }
+
+    return true;
+}
+
+void SimulatedClient::UpdateControls(float timeStep)
+{
+    switch (pattern_)
+    {
+    case CP_WALK:
+        controls_.buttons_ = CTRL_FORWARD;
+        patternTimer_ += timeStep;
+        if (patternTimer_ >= WALK_TURN_INTERVAL)
+        {
+            patternTimer_ = 0.0f;
+            controls_.yaw_ += 180.0f;
+        }
+        break;
+
+    case CP_CIRCLE:
+        controls_.buttons_ = CTRL_FORWARD;
+        controls_.yaw_ += CIRCLE_TURN_RATE * timeStep;
+        break;
+
+    case CP_RANDOM:
+        patternTimer_ -= timeStep;
+        if (patternTimer_ <= 0.0f)
+        {
+            patternTimer_ = Random(0.5f, 2.0f);
+            controls_.buttons_ = (unsigned)Random(16);
+            controls_.yaw_ = Random(360.0f);
+        }
+        break;
+
+    default: break;
+    }
+
+    controls_.yaw_ = fmodf(controls_.yaw_, 360.0f);
+}
+
+void SimulatedClient::SendMessage(int msgID, bool reliable, const VectorBuffer& msg)
+{
+    VectorBuffer buffer;
+    buffer.WriteUByte((unsigned char)msgID);
+    buffer.Write(msg.GetData(), msg.GetSize());
+    peer_->Send((const char*)buffer.GetData(), (int)buffer.GetSize(), HIGH_PRIORITY, reliable ? RELIABLE_ORDERED : UNRELIABLE,
+        (char)0, *serverAddress_, false);
+
+    stats_.bytesOut_ += buffer.GetSize();
+    ++stats_.packetsOut_;
+}
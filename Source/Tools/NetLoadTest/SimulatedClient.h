@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/RefCounted.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Input/Controls.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+namespace SLNet
+{
+    class RakPeerInterface;
+    struct SystemAddress;
+}
+
+namespace Urho3D
+{
+
+class Context;
+class MemoryBuffer;
+
+}
+
+using namespace Urho3D;
+
+/// Control buttons sent by the simulated clients. The server moves the client's avatar node by them.
+static const unsigned CTRL_FORWARD = 1;
+static const unsigned CTRL_BACK = 2;
+static const unsigned CTRL_LEFT = 4;
+static const unsigned CTRL_RIGHT = 8;
+
+/// Scripted control patterns of the simulated clients.
+enum ControlPattern
+{
+    /// Send unchanging controls.
+    CP_IDLE = 0,
+    /// Walk forward in a fixed direction, turning around at intervals.
+    CP_WALK,
+    /// Walk forward while turning at a constant rate.
+    CP_CIRCLE,
+    /// Pick random buttons and direction at random intervals.
+    CP_RANDOM,
+    /// Each client uses one of the above patterns by its index.
+    CP_MIXED
+};
+
+/// Traffic and timing statistics of a simulated client.
+struct SimulatedClientStats
+{
+    /// Bytes received.
+    unsigned long long bytesIn_{};
+    /// Bytes sent.
+    unsigned long long bytesOut_{};
+    /// Packets received.
+    unsigned packetsIn_{};
+    /// Packets sent.
+    unsigned packetsOut_{};
+    /// Scene update messages parsed.
+    unsigned sceneUpdates_{};
+    /// Scene update messages that could not be parsed.
+    unsigned parseErrors_{};
+    /// Round trip time samples in milliseconds.
+    PODVector<float> roundTripMs_;
+    /// Time between received packets carrying scene updates in milliseconds.
+    PODVector<float> updateIntervalMs_;
+};
+
+/// Lightweight client for load testing. Performs the client side of the connection protocol with its own SLikeNet peer,
+/// parses the scene replication messages without creating nodes and components, and sends scripted controls.
+class SimulatedClient : public RefCounted
+{
+public:
+    /// Construct.
+    SimulatedClient(Context* context, unsigned index, ControlPattern pattern);
+    /// Destruct. Closes the connection.
+    ~SimulatedClient() override;
+
+    /// Start connecting to a server. Return true if the connection attempt started.
+    bool Connect(const String& address, unsigned short port, int simulatedLatency, float simulatedPacketLoss);
+    /// Disconnect from the server.
+    void Disconnect();
+    /// Process received packets, then send controls if the send interval has elapsed.
+    void Update(float timeStep, float sendInterval);
+    /// Clear the statistics, for example after the clients have joined the scene.
+    void ResetStats();
+
+    /// Set the scene checksum to reply with when the server asks to load a scene.
+    void SetSceneChecksum(unsigned checksum) { sceneChecksum_ = checksum; }
+
+    /// Return whether the connection has been accepted.
+    bool IsConnected() const { return connected_; }
+
+    /// Return whether the scene has been joined.
+    bool IsSceneLoaded() const { return sceneLoaded_; }
+
+    /// Return whether the connection failed or was lost.
+    bool IsFailed() const { return failed_; }
+
+    /// Return whether the simulated latency and packet loss are in effect. SLikeNet only simulates them in debug builds.
+    bool IsNetworkSimulatorActive() const { return simulatorActive_; }
+
+    /// Return number of replicated nodes known to the client.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+
+    /// Return statistics.
+    const SimulatedClientStats& GetStats() const { return stats_; }
+
+private:
+    /// Handle a packet received from the server. Return true if it contained scene updates.
+    bool HandlePacket(const unsigned char* data, unsigned numBytes);
+    /// Handle an Urho3D message. Return true if it was a scene update.
+    bool HandleMessage(int msgID, MemoryBuffer& msg);
+    /// Parse a scene update message the same way as Connection does on the client, but only track node and component IDs.
+    void ParseSceneUpdate(int msgID, MemoryBuffer& msg);
+    /// Skip the delta update of a node or component. Return false if the type has no network attributes.
+    bool SkipDeltaUpdate(StringHash type, MemoryBuffer& msg);
+    /// Skip the latest data update of a node or component. Return false if the type has no network attributes.
+    bool SkipLatestDataUpdate(StringHash type, MemoryBuffer& msg);
+    /// Advance the control pattern.
+    void UpdateControls(float timeStep);
+    /// Send a message to the server.
+    void SendMessage(int msgID, bool reliable, const VectorBuffer& msg);
+
+    /// Context.
+    Context* context_;
+    /// SLikeNet peer of this client.
+    SLNet::RakPeerInterface* peer_;
+    /// Server address.
+    SLNet::SystemAddress* serverAddress_;
+    /// Client index.
+    unsigned index_;
+    /// Control pattern.
+    ControlPattern pattern_;
+    /// Current controls.
+    Controls controls_;
+    /// Time until the random pattern changes the controls.
+    float patternTimer_;
+    /// Time since the last controls update was sent.
+    float sendAcc_;
+    /// Time since the last ping.
+    float pingAcc_;
+    /// Controls timestamp.
+    unsigned char timeStamp_;
+    /// Scene checksum to reply with.
+    unsigned sceneChecksum_;
+    /// Replicated node types by ID.
+    HashMap<unsigned, StringHash> nodes_;
+    /// Replicated component types by ID.
+    HashMap<unsigned, StringHash> components_;
+    /// Reusable message buffer.
+    VectorBuffer msg_;
+    /// Timer for the interval between scene updates.
+    HiresTimer updateTimer_;
+    /// Whether a scene update has been received since the statistics were reset.
+    bool hasUpdate_;
+    /// Connected flag.
+    bool connected_;
+    /// Scene loaded flag.
+    bool sceneLoaded_;
+    /// Failed flag.
+    bool failed_;
+    /// Network simulator active flag.
+    bool simulatorActive_;
+    /// Statistics.
+    SimulatedClientStats stats_;
+};
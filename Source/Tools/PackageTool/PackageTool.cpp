@@ -22,10 +22,20 @@
 
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Container/ArrayPtr.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Mutex.h>
 #include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Thread.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
 #include <Urho3D/IO/PackageFile.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#ifndef MINI_URHO
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/XMLFile.h>
+#endif
 
 #ifdef WIN32
 #include <windows.h>
@@ -33,12 +43,17 @@
 
 #include <LZ4/lz4.h>
 #include <LZ4/lz4hc.h>
+#ifndef MINI_URHO
+#include <PugiXml/pugixml.hpp>
+#endif
 
 #include <Urho3D/DebugNew.h>
 
 using namespace Urho3D;
 
 static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+/// Number of entries per worker thread that may be processed ahead of the entry being written. Bounds the memory use.
+static const unsigned ENTRIES_AHEAD_PER_WORKER = 4;
 
 struct FileEntry
 {
@@ -46,6 +61,33 @@ struct FileEntry
     unsigned offset_{};
     unsigned size_{};
     unsigned checksum_{};
+    bool compressed_{};
+    /// Index of the earlier entry with identical content, or M_MAX_UNSIGNED if this entry's data is written.
+    unsigned duplicateOf_{M_MAX_UNSIGNED};
+    /// Data to write, either LZ4 blocks or the file as is. Released once written.
+    PODVector<unsigned char> data_;
+    /// Whether the data was copied from the previous package.
+    bool reused_{};
+    /// Whether the entry is ready to be written. Protected by the work mutex.
+    bool processed_{};
+};
+
+/// Reads, cooks and compresses files in a worker thread.
+class PackWorker : public RefCounted, public Thread
+{
+public:
+    /// Construct with the directory being processed.
+    explicit PackWorker(const String& rootDir) :
+        rootDir_(rootDir)
+    {
+    }
+
+    /// Process entries until none are left.
+    void ThreadFunction() override;
+
+private:
+    /// Directory being processed.
+    String rootDir_;
 };
 
 SharedPtr<Context> context_(new Context());
@@ -54,9 +96,19 @@ String basePath_;
 Vector<FileEntry> entries_;
 unsigned checksum_ = 0;
 bool compress_ = false;
+bool storeIncompressible_ = false;
+bool cook_ = false;
 bool quiet_ = false;
+bool update_ = false;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
 
+Mutex workMutex_;
+unsigned nextEntry_ = 0;
+unsigned maxNextEntry_ = 0;
+HashMap<unsigned long long, unsigned> contentEntries_;
+SharedPtr<PackageFile> oldPackage_;
+HashMap<unsigned, unsigned> oldStoredSizes_;
+
 String ignoreExtensions_[] = {
     ".bak",
     ".rule",
@@ -66,8 +118,15 @@ String ignoreExtensions_[] = {
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
 void ProcessFile(const String& fileName, const String& rootDir);
+void LoadOldPackage(const String& fileName);
+void PackEntry(unsigned index, const String& rootDir);
+bool ReusePackedData(FileEntry& entry, const PODVector<unsigned char>& buffer);
+unsigned CombineSDBMHash(unsigned hash, unsigned dataHash, unsigned dataSize);
 void WritePackageFile(const String& fileName, const String& rootDir);
 void WriteHeader(File& dest);
+void WriteDirectory(File& dest);
+bool CookFile(const String& fileName, PODVector<unsigned char>& buffer);
+HashMap<unsigned, unsigned> GetStoredSizes(PackageFile* packageFile);
 
 int main(int argc, char** argv)
 {
@@ -91,9 +150,13 @@ void Run(const Vector<String>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-s      With -c, store files that do not get smaller uncompressed (requires the version 2 package format)\n"
+            "-b      Cook XML and JSON files into binary form for faster loading\n"
+            "-u      Update the package if it exists: copy the compressed data of unchanged files instead of compressing again\n"
             "-q      Enable quiet mode\n"
             "\n"
-            "Basepath is an optional prefix that will be added to the file entries.\n\n"
+            "Basepath is an optional prefix that will be added to the file entries.\n"
+            "Files are compressed on all CPU cores, and files with identical content are stored once.\n\n"
             "Alternative output usage: PackageTool <output option> <package name>\n"
             "Output option:\n"
             "-i      Output package file information\n"
@@ -119,6 +182,18 @@ void Run(const Vector<String>& arguments)
                     case 'c':
                         compress_ = true;
                         break;
+                    case 's':
+                        storeIncompressible_ = true;
+                        break;
+                    case 'b':
+#ifdef MINI_URHO
+                        ErrorExit("Cooking is not supported by this build of PackageTool");
+#endif
+                        cook_ = true;
+                        break;
+                    case 'u':
+                        update_ = true;
+                        break;
                     case 'q':
                         quiet_ = true;
                         break;
@@ -130,6 +205,9 @@ void Run(const Vector<String>& arguments)
         }
     }
 
+    if (storeIncompressible_ && !compress_)
+        ErrorExit("Invalid option: -s is applicable with -c only");
+
     if (!isOutputMode)
     {
         if (!quiet_)
@@ -158,6 +236,9 @@ void Run(const Vector<String>& arguments)
         for (unsigned i = 0; i < fileNames.Size(); ++i)
             ProcessFile(fileNames[i], dirName);
 
+        if (update_)
+            LoadOldPackage(packageName);
+
         WritePackageFile(packageName, dirName);
     }
     else
@@ -181,17 +262,17 @@ void Run(const Vector<String>& arguments)
         case 'l':
             {
                 const HashMap<String, PackageEntry>& entries = packageFile->GetEntries();
-                for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End();)
+                HashMap<unsigned, unsigned> storedSizes;
+                if (outputCompressionRatio)
+                    storedSizes = GetStoredSizes(packageFile);
+                for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End(); ++i)
                 {
-                    HashMap<String, PackageEntry>::ConstIterator current = i++;
-                    String fileEntry(current->first_);
+                    String fileEntry(i->first_);
                     if (outputCompressionRatio)
                     {
-                        unsigned compressedSize =
-                            (i == entries.End() ? packageFile->GetTotalSize() - sizeof(unsigned) : i->second_.offset_) -
-                            current->second_.offset_;
-                        fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", current->second_.size_, compressedSize,
-                            compressedSize ? 1.f * current->second_.size_ / compressedSize : 0.f);
+                        unsigned compressedSize = storedSizes[i->second_.offset_];
+                        fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", i->second_.size_, compressedSize,
+                            compressedSize ? 1.f * i->second_.size_ / compressedSize : 0.f);
                     }
                     PrintLine(fileEntry);
                 }
@@ -220,64 +301,106 @@ void ProcessFile(const String& fileName, const String& rootDir)
     entries_.Push(newEntry);
 }
 
-void WritePackageFile(const String& fileName, const String& rootDir)
+void LoadOldPackage(const String& fileName)
 {
-    if (!quiet_)
-        PrintLine("Writing package");
-
-    File dest(context_);
-    if (!dest.Open(fileName, FILE_WRITE))
-        ErrorExit("Could not open output file " + fileName);
-
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader(dest);
+    if (!fileSystem_->FileExists(fileName))
+    {
+        if (!quiet_)
+            PrintLine("No previous package " + fileName + ", packing all files");
+        return;
+    }
 
-    for (unsigned i = 0; i < entries_.Size(); ++i)
+    oldPackage_ = new PackageFile(context_);
+    if (!oldPackage_->Open(fileName))
     {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
+        PrintLine("Could not read previous package " + fileName + ", packing all files");
+        oldPackage_.Reset();
+        return;
     }
 
-    unsigned totalDataSize = 0;
-    unsigned lastOffset;
+    oldStoredSizes_ = GetStoredSizes(oldPackage_);
+}
 
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < entries_.Size(); ++i)
+void PackWorker::ThreadFunction()
+{
+    while (shouldRun_)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        String fileFullPath = rootDir + "/" + entries_[i].name_;
+        unsigned index;
+        {
+            MutexLock lock(workMutex_);
+            if (nextEntry_ >= entries_.Size())
+                return;
+            index = nextEntry_ < maxNextEntry_ ? nextEntry_++ : M_MAX_UNSIGNED;
+        }
 
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
+        // Wait while too far ahead of the entry being written
+        if (index == M_MAX_UNSIGNED)
+            Time::Sleep(1);
+        else
+            PackEntry(index, rootDir_);
+    }
+}
 
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
+void PackEntry(unsigned index, const String& rootDir)
+{
+    FileEntry& entry = entries_[index];
+    String fileFullPath = rootDir + "/" + entry.name_;
+
+    File srcFile(context_, fileFullPath);
+    if (!srcFile.IsOpen())
+        ErrorExit("Could not open file " + fileFullPath);
+
+    PODVector<unsigned char> buffer(entry.size_);
+    if (srcFile.Read(&buffer[0], entry.size_) != entry.size_)
+        ErrorExit("Could not read file " + fileFullPath);
+    srcFile.Close();
+
+    if (cook_)
+        CookFile(entry.name_, buffer);
+
+    // Besides the checksum stored in the package, calculate a 64-bit FNV-1a hash to find identical content
+    unsigned dataSize = buffer.Size();
+    unsigned checksum = 0;
+    unsigned long long contentHash = 14695981039346656037ULL;
+    for (unsigned j = 0; j < dataSize; ++j)
+    {
+        checksum = SDBMHash(checksum, buffer[j]);
+        contentHash = (contentHash ^ buffer[j]) * 1099511628211ULL;
+    }
+    entry.size_ = dataSize;
+    entry.checksum_ = checksum;
 
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
+    {
+        MutexLock lock(workMutex_);
 
-        for (unsigned j = 0; j < dataSize; ++j)
+        // Identical content is stored for the first entry in package order only. As entries finish out of order, a later
+        // entry may have been recorded first; it is not written yet, so it becomes the duplicate instead
+        HashMap<unsigned long long, unsigned>::Iterator i = contentEntries_.Find(contentHash);
+        if (i == contentEntries_.End())
+            contentEntries_[contentHash] = index;
+        else
         {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
-        }
+            FileEntry& other = entries_[i->second_];
+            if (other.size_ == dataSize && other.checksum_ == checksum)
+            {
+                if (i->second_ < index)
+                {
+                    entry.duplicateOf_ = i->second_;
+                    entry.processed_ = true;
+                    return;
+                }
 
-        if (!compress_)
-        {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + String(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
+                other.duplicateOf_ = index;
+                i->second_ = index;
+            }
         }
-        else
-        {
-            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
+    }
 
+    if (!ReusePackedData(entry, buffer))
+    {
+        if (compress_)
+        {
+            PODVector<unsigned char> packedData;
             unsigned pos = 0;
 
             while (pos < dataSize)
@@ -286,28 +409,180 @@ void WritePackageFile(const String& fileName, const String& rootDir)
                 if (pos + unpackedSize > dataSize)
                     unpackedSize = dataSize - pos;
 
-                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
+                // Each block is preceded by its unpacked and packed sizes
+                unsigned start = packedData.Size();
+                packedData.Resize(start + 2 * sizeof(unsigned short) + LZ4_compressBound(unpackedSize));
+                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)&packedData[start + 2 * sizeof(unsigned short)],
+                    unpackedSize, LZ4_compressBound(unpackedSize), 0);
                 if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
+                    ErrorExit("LZ4 compression failed for file " + entry.name_ + " at offset " + String(pos));
 
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.Get(), packedSize);
+                unsigned short sizes[] = { (unsigned short)unpackedSize, (unsigned short)packedSize };
+                memcpy(&packedData[start], sizes, sizeof sizes);
+                packedData.Resize(start + sizeof sizes + packedSize);
 
                 pos += unpackedSize;
             }
 
+            // Already compressed data such as images and sounds is stored as is when allowed
+            entry.compressed_ = !storeIncompressible_ || packedData.Size() < dataSize;
+            if (entry.compressed_)
+                entry.data_.Swap(packedData);
+        }
+
+        if (!entry.compressed_)
+            entry.data_.Swap(buffer);
+    }
+
+    MutexLock lock(workMutex_);
+    entry.processed_ = true;
+}
+
+bool ReusePackedData(FileEntry& entry, const PODVector<unsigned char>& buffer)
+{
+    if (!oldPackage_ || !compress_)
+        return false;
+
+    // Only compressed data is worth reusing. The content is compared in full, as the checksum could match by chance
+    String name = basePath_ + entry.name_;
+    const PackageEntry* oldEntry = oldPackage_->GetEntry(name);
+    if (!oldEntry || !oldEntry->compressed_ || oldEntry->size_ != entry.size_ || oldEntry->checksum_ != entry.checksum_)
+        return false;
+
+    File oldFile(context_, oldPackage_, name);
+    PODVector<unsigned char> oldData(entry.size_);
+    if (!oldFile.IsOpen() || oldFile.Read(&oldData[0], entry.size_) != entry.size_ || memcmp(&oldData[0], &buffer[0], entry.size_))
+        return false;
+    oldFile.Close();
+
+    File package(context_, oldPackage_->GetName());
+    unsigned storedSize = oldStoredSizes_[oldEntry->offset_];
+    entry.data_.Resize(storedSize);
+    if (!package.IsOpen() || !package.Seek(oldEntry->offset_) || package.Read(&entry.data_[0], storedSize) != storedSize)
+    {
+        entry.data_.Clear();
+        return false;
+    }
+
+    entry.compressed_ = true;
+    entry.reused_ = true;
+    return true;
+}
+
+unsigned CombineSDBMHash(unsigned hash, unsigned dataHash, unsigned dataSize)
+{
+    // Each byte multiplies the hash by 65599, so the preceding hash is multiplied by 65599 ^ dataSize
+    unsigned factor = 1;
+    unsigned base = 65599;
+    for (unsigned n = dataSize; n; n >>= 1)
+    {
+        if (n & 1)
+            factor *= base;
+        base *= base;
+    }
+
+    return hash * factor + dataHash;
+}
+
+void WritePackageFile(const String& fileName, const String& rootDir)
+{
+    if (!quiet_)
+        PrintLine("Writing package");
+
+    // The previous package is read while writing, so write the update to a temporary file first
+    String destName = oldPackage_ ? fileName + ".tmp" : fileName;
+    File dest(context_);
+    if (!dest.Open(destName, FILE_WRITE))
+        ErrorExit("Could not open output file " + destName);
+
+    // Write ID, number of files & placeholder for checksum
+    WriteHeader(dest);
+    // Write entries (correct offsets are still unknown, will be filled in later)
+    WriteDirectory(dest);
+
+    // Read, cook and compress the files in worker threads, and write them in order as they finish
+    unsigned numWorkers = Max(GetNumLogicalCPUs(), 1U);
+    maxNextEntry_ = numWorkers * ENTRIES_AHEAD_PER_WORKER;
+    Vector<SharedPtr<PackWorker> > workers;
+    for (unsigned i = 0; i < numWorkers; ++i)
+    {
+        SharedPtr<PackWorker> worker(new PackWorker(rootDir));
+        if (!worker->Run())
+            break;
+        workers.Push(worker);
+    }
+
+    unsigned totalDataSize = 0;
+    unsigned numDuplicates = 0;
+    unsigned numReused = 0;
+
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        FileEntry& entry = entries_[i];
+
+        // Without threads, process each entry just before writing it
+        if (workers.Empty())
+            PackEntry(i, rootDir);
+        else
+        {
+            for (;;)
+            {
+                {
+                    MutexLock lock(workMutex_);
+                    if (entry.processed_)
+                        break;
+                }
+                Time::Sleep(1);
+            }
+        }
+
+        totalDataSize += entry.size_;
+        checksum_ = CombineSDBMHash(checksum_, entry.checksum_, entry.size_);
+
+        if (entry.duplicateOf_ != M_MAX_UNSIGNED)
+        {
+            // The entry with identical content comes earlier, so its data has been written already
+            const FileEntry& original = entries_[entry.duplicateOf_];
+            entry.offset_ = original.offset_;
+            entry.compressed_ = original.compressed_;
+            ++numDuplicates;
+
+            if (!quiet_)
+                PrintLine(entry.name_ + " same as " + original.name_);
+        }
+        else
+        {
+            entry.offset_ = dest.GetSize();
+            dest.Write(entry.data_.Buffer(), entry.data_.Size());
+            if (entry.reused_)
+                ++numReused;
+
             if (!quiet_)
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                String fileEntry(entries_[i].name_);
-                fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
-                PrintLine(fileEntry);
+                if (!entry.compressed_)
+                    PrintLine(entry.name_ + " size " + String(entry.size_));
+                else
+                {
+                    unsigned totalPackedBytes = entry.data_.Size();
+                    String fileEntry(entry.name_);
+                    fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", entry.size_, totalPackedBytes,
+                        totalPackedBytes ? 1.f * entry.size_ / totalPackedBytes : 0.f);
+                    if (entry.reused_)
+                        fileEntry += "\tunchanged";
+                    PrintLine(fileEntry);
+                }
             }
         }
+
+        // Release the data and let the workers proceed further
+        entry.data_.Clear();
+        entry.data_.Compact();
+        MutexLock lock(workMutex_);
+        maxNextEntry_ = i + 1 + numWorkers * ENTRIES_AHEAD_PER_WORKER;
     }
 
+    workers.Clear();
+
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = dest.GetSize();
     dest.WriteUInt(currentSize + sizeof(unsigned));
@@ -315,31 +590,111 @@ void WritePackageFile(const String& fileName, const String& rootDir)
     // Write header again with correct offsets & checksums
     dest.Seek(0);
     WriteHeader(dest);
-
-    for (unsigned i = 0; i < entries_.Size(); ++i)
-    {
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
+    WriteDirectory(dest);
 
     if (!quiet_)
     {
         PrintLine("Number of files: " + String(entries_.Size()));
+        PrintLine("Duplicate files: " + String(numDuplicates));
+        if (update_)
+            PrintLine("Unchanged files: " + String(numReused));
         PrintLine("File data size: " + String(totalDataSize));
         PrintLine("Package size: " + String(dest.GetSize()));
         PrintLine("Checksum: " + String(checksum_));
         PrintLine("Compressed: " + String(compress_ ? "yes" : "no"));
     }
+
+    dest.Close();
+    if (oldPackage_)
+    {
+        oldPackage_.Reset();
+        fileSystem_->Delete(fileName);
+        if (!fileSystem_->Rename(destName, fileName))
+            ErrorExit("Could not rename " + destName + " to " + fileName);
+    }
+}
+
+bool CookFile(const String& fileName, PODVector<unsigned char>& buffer)
+{
+#ifdef MINI_URHO
+    return false;
+#else
+    String extension = GetExtension(fileName);
+    VectorBuffer cookedData;
+
+    if (extension == ".xml")
+    {
+        // Parse with pugixml only, so that patch files keep their inherit attribute and get patched at load time
+        SharedPtr<XMLFile> xmlFile(new XMLFile(context_));
+        if (!xmlFile->GetDocument()->load_buffer(buffer.Buffer(), buffer.Size()) || !xmlFile->SaveBinary(cookedData))
+        {
+            PrintLine("Could not cook " + fileName + ", storing as is");
+            return false;
+        }
+    }
+    else if (extension == ".json")
+    {
+        SharedPtr<JSONFile> jsonFile(new JSONFile(context_));
+        MemoryBuffer source(buffer.Buffer(), buffer.Size());
+        if (!jsonFile->Load(source) || !jsonFile->SaveBinary(cookedData))
+        {
+            PrintLine("Could not cook " + fileName + ", storing as is");
+            return false;
+        }
+    }
+    else
+        return false;
+
+    buffer.Resize(cookedData.GetSize());
+    memcpy(buffer.Buffer(), cookedData.GetData(), cookedData.GetSize());
+    return true;
+#endif
 }
 
 void WriteHeader(File& dest)
 {
     if (!compress_)
         dest.WriteFileID("UPAK");
+    else if (storeIncompressible_)
+        dest.WriteFileID("UPK2");
     else
         dest.WriteFileID("ULZ4");
     dest.WriteUInt(entries_.Size());
     dest.WriteUInt(checksum_);
 }
+
+void WriteDirectory(File& dest)
+{
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        dest.WriteString(basePath_ + entries_[i].name_);
+        dest.WriteUInt(entries_[i].offset_);
+        dest.WriteUInt(entries_[i].size_);
+        dest.WriteUInt(entries_[i].checksum_);
+        if (storeIncompressible_)
+            dest.WriteBool(entries_[i].compressed_);
+    }
+}
+
+HashMap<unsigned, unsigned> GetStoredSizes(PackageFile* packageFile)
+{
+    // Entries with identical content share their data, so the stored size is the distance to the next distinct offset,
+    // or to the package size at the end of the file
+    const HashMap<String, PackageEntry>& entries = packageFile->GetEntries();
+    PODVector<unsigned> offsets;
+    for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End(); ++i)
+        offsets.Push(i->second_.offset_);
+    Sort(offsets.Begin(), offsets.End());
+
+    HashMap<unsigned, unsigned> storedSizes;
+    unsigned dataEnd = packageFile->GetTotalSize() - sizeof(unsigned);
+    for (unsigned i = offsets.Size() - 1; i < offsets.Size(); --i)
+    {
+        if (i + 1 < offsets.Size() && offsets[i + 1] == offsets[i])
+            continue;
+        storedSizes[offsets[i]] = dataEnd - offsets[i];
+        dataEnd = offsets[i];
+    }
+
+    return storedSizes;
+}
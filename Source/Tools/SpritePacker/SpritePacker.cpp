@@ -20,9 +20,11 @@
 // THE SOFTWARE.
 //
 
+#include <Urho3D/Container/Sort.h>
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
 #include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/Log.h>
@@ -34,16 +36,11 @@
 #include <windows.h>
 #endif
 
-#define STBRP_LARGE_RECTS
-#define STB_RECT_PACK_IMPLEMENTATION
-#include <STB/stb_rect_pack.h>
-
 #include <Urho3D/DebugNew.h>
 
 using namespace Urho3D;
 
-// number of nodes allocated to each packer info.  since this packer is not suited for real time purposes we can over allocate.
-const int PACKER_NUM_NODES = 4096;
+const int MIN_TEXTURE_SIZE = 4;
 const int MAX_TEXTURE_SIZE = 2048;
 
 int main(int argc, char** argv);
@@ -54,6 +51,8 @@ class PackerInfo : public RefCounted
 public:
     String path;
     String name;
+    String error;
+    SharedPtr<Image> image;
     int x{};
     int y{};
     int offsetX{};
@@ -62,6 +61,9 @@ public:
     int height{};
     int frameWidth{};
     int frameHeight{};
+    unsigned page{};
+    bool rotated{};
+    bool packed{};
 
     PackerInfo(const String& path_, const String& name_) :
         path(path_),
@@ -72,6 +74,129 @@ public:
     ~PackerInfo() override = default;
 };
 
+/// Rectangle packer using the maximal rectangles algorithm with the best short side fit heuristic.
+class RectPacker
+{
+public:
+    RectPacker(int width, int height, const IntVector2& padding) :
+        padding_(padding)
+    {
+        freeRects_.Push(IntRect(0, 0, width, height));
+    }
+
+    /// Allocate space for a sprite, optionally rotated by 90 degrees. Return false if it does not fit.
+    bool Allocate(int width, int height, bool allowRotate, IntVector2& position, bool& rotated)
+    {
+        IntRect best;
+        int bestShortSide = M_MAX_INT;
+        int bestLongSide = M_MAX_INT;
+
+        for (unsigned i = 0; i < freeRects_.Size(); ++i)
+        {
+            const IntRect& freeRect = freeRects_[i];
+            for (unsigned j = 0; j < (allowRotate ? 2u : 1u); ++j)
+            {
+                int cellWidth = (j ? height : width) + padding_.x_;
+                int cellHeight = (j ? width : height) + padding_.y_;
+                int leftoverX = freeRect.Width() - cellWidth;
+                int leftoverY = freeRect.Height() - cellHeight;
+                if (leftoverX < 0 || leftoverY < 0)
+                    continue;
+
+                int shortSide = Min(leftoverX, leftoverY);
+                int longSide = Max(leftoverX, leftoverY);
+                if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+                {
+                    best = IntRect(freeRect.left_, freeRect.top_, freeRect.left_ + cellWidth, freeRect.top_ + cellHeight);
+                    bestShortSide = shortSide;
+                    bestLongSide = longSide;
+                    rotated = j != 0;
+                }
+            }
+        }
+
+        if (bestShortSide == M_MAX_INT)
+            return false;
+
+        // Split the free rectangles overlapping the allocated one into the maximal rectangles around it
+        PODVector<IntRect> newRects;
+        for (unsigned i = 0; i < freeRects_.Size();)
+        {
+            IntRect freeRect = freeRects_[i];
+            if (best.left_ >= freeRect.right_ || best.right_ <= freeRect.left_ || best.top_ >= freeRect.bottom_ ||
+                best.bottom_ <= freeRect.top_)
+            {
+                ++i;
+                continue;
+            }
+
+            if (best.left_ > freeRect.left_)
+                newRects.Push(IntRect(freeRect.left_, freeRect.top_, best.left_, freeRect.bottom_));
+            if (best.right_ < freeRect.right_)
+                newRects.Push(IntRect(best.right_, freeRect.top_, freeRect.right_, freeRect.bottom_));
+            if (best.top_ > freeRect.top_)
+                newRects.Push(IntRect(freeRect.left_, freeRect.top_, freeRect.right_, best.top_));
+            if (best.bottom_ < freeRect.bottom_)
+                newRects.Push(IntRect(freeRect.left_, best.bottom_, freeRect.right_, freeRect.bottom_));
+            freeRects_.Erase(i);
+        }
+        freeRects_.Push(newRects);
+
+        // Remove the free rectangles contained in others
+        for (int i = 0; i < (int)freeRects_.Size(); ++i)
+        {
+            for (int j = i + 1; j < (int)freeRects_.Size(); ++j)
+            {
+                if (Contains(freeRects_[j], freeRects_[i]))
+                {
+                    freeRects_.Erase(i);
+                    --i;
+                    break;
+                }
+                if (Contains(freeRects_[i], freeRects_[j]))
+                {
+                    freeRects_.Erase(j);
+                    --j;
+                }
+            }
+        }
+
+        position = IntVector2(best.left_, best.top_);
+        return true;
+    }
+
+private:
+    /// Return whether a rectangle contains another.
+    static bool Contains(const IntRect& outer, const IntRect& inner)
+    {
+        return inner.left_ >= outer.left_ && inner.top_ >= outer.top_ && inner.right_ <= outer.right_ &&
+            inner.bottom_ <= outer.bottom_;
+    }
+
+    /// Padding added to each sprite.
+    IntVector2 padding_;
+    /// Free rectangles, which may overlap.
+    PODVector<IntRect> freeRects_;
+};
+
+/// Load settings shared by the worker threads.
+struct LoadSettings
+{
+    Context* context_;
+    unsigned frameWidth_;
+    unsigned frameHeight_;
+    bool trim_;
+};
+
+/// Blit settings shared by the worker threads.
+struct BlitSettings
+{
+    Vector<SharedPtr<Image> >* pages_;
+    int offsetX_;
+    int offsetY_;
+    int extrude_;
+};
+
 void Help()
 {
     ErrorExit("Usage: SpritePacker -options <input file> <input file> <output png file>\n"
@@ -85,6 +210,10 @@ void Help()
         "-frameHeight Sets a fixed height for image and centers within frame.\n"
         "-frameWidth Sets a fixed width for image and centers within frame.\n"
         "-trim Trims excess transparent space from individual images offsets by frame size.\n"
+        "-rotate Allows images to be rotated by 90 degrees for a tighter fit.\n"
+        "-extrude Repeats the edge pixels of each image x times around it, on top of the padding.\n"
+        "-maxSize Sets the maximum sprite sheet texture size, default 2048. Images that do not fit\n"
+        "   are written to further sheets named <output>_1.png, <output>_2.png and so on.\n"
         "-xml \'path\' Generates an SpriteSheet xml file at path.\n"
         "-debug Draws allocation boxes on sprite.\n");
 }
@@ -103,6 +232,168 @@ int main(int argc, char** argv)
     return 0;
 }
 
+void LoadImageWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* packerInfo = reinterpret_cast<PackerInfo*>(item->start_);
+    auto* settings = reinterpret_cast<LoadSettings*>(item->aux_);
+
+    File file(settings->context_, packerInfo->path);
+    SharedPtr<Image> image(new Image(settings->context_));
+    if (!image->Load(file))
+    {
+        packerInfo->error = "Could not load image " + packerInfo->path + ".";
+        return;
+    }
+    if (image->IsCompressed())
+    {
+        packerInfo->error = packerInfo->path + " is compressed. Compressed images are not allowed.";
+        return;
+    }
+
+    int imageWidth = image->GetWidth();
+    int imageHeight = image->GetHeight();
+    int trimOffsetX = 0;
+    int trimOffsetY = 0;
+    int adjustedWidth = imageWidth;
+    int adjustedHeight = imageHeight;
+
+    if (settings->trim_)
+    {
+        int minX = imageWidth;
+        int minY = imageHeight;
+        int maxX = 0;
+        int maxY = 0;
+
+        for (int y = 0; y < imageHeight; ++y)
+        {
+            for (int x = 0; x < imageWidth; ++x)
+            {
+                bool found = (image->GetPixelInt(x, y) & 0xff000000u) != 0;
+                if (found) {
+                    minX = Min(minX, x);
+                    minY = Min(minY, y);
+                    maxX = Max(maxX, x);
+                    maxY = Max(maxY, y);
+                }
+            }
+        }
+
+        // Keep a single pixel of a fully transparent image
+        if (minX > maxX)
+        {
+            minX = maxX = 0;
+            minY = maxY = 0;
+        }
+
+        trimOffsetX = minX;
+        trimOffsetY = minY;
+        adjustedWidth = maxX - minX + 1;
+        adjustedHeight = maxY - minY + 1;
+    }
+
+    if (settings->trim_)
+    {
+        packerInfo->frameWidth = imageWidth;
+        packerInfo->frameHeight = imageHeight;
+    }
+    else if (settings->frameWidth_ || settings->frameHeight_)
+    {
+        packerInfo->frameWidth = settings->frameWidth_;
+        packerInfo->frameHeight = settings->frameHeight_;
+    }
+    packerInfo->width = adjustedWidth;
+    packerInfo->height = adjustedHeight;
+    packerInfo->offsetX -= trimOffsetX;
+    packerInfo->offsetY -= trimOffsetY;
+    packerInfo->image = image;
+}
+
+void BlitImageWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* packerInfo = reinterpret_cast<PackerInfo*>(item->start_);
+    auto* settings = reinterpret_cast<BlitSettings*>(item->aux_);
+    Image* image = packerInfo->image;
+    Image* page = (*settings->pages_)[packerInfo->page];
+    int extrude = settings->extrude_;
+    int left = packerInfo->x + settings->offsetX_ + extrude;
+    int top = packerInfo->y + settings->offsetY_ + extrude;
+
+    // Rotated images are stored turned 90 degrees clockwise. The extruded border repeats the edge of the trimmed image
+    for (int y = -extrude; y < packerInfo->height + extrude; ++y)
+    {
+        int sourceY = Clamp(y, 0, packerInfo->height - 1) - packerInfo->offsetY;
+        for (int x = -extrude; x < packerInfo->width + extrude; ++x)
+        {
+            unsigned color = image->GetPixelInt(Clamp(x, 0, packerInfo->width - 1) - packerInfo->offsetX, sourceY);
+            if (packerInfo->rotated)
+                page->SetPixelInt(left + packerInfo->height - 1 - y, top + x, color);
+            else
+                page->SetPixelInt(left + x, top + y, color);
+        }
+    }
+
+    // The image is not needed anymore
+    packerInfo->image.Reset();
+}
+
+bool CompareSpriteSize(PackerInfo* lhs, PackerInfo* rhs)
+{
+    int lhsSide = Max(lhs->width, lhs->height);
+    int rhsSide = Max(rhs->width, rhs->height);
+    if (lhsSide != rhsSide)
+        return lhsSide > rhsSide;
+    if (lhs->width * lhs->height != rhs->width * rhs->height)
+        return lhs->width * lhs->height > rhs->width * rhs->height;
+    return lhs->name < rhs->name;
+}
+
+bool CompareTextureSize(const IntVector2& lhs, const IntVector2& rhs)
+{
+    if (lhs.x_ * lhs.y_ != rhs.x_ * rhs.y_)
+        return lhs.x_ * lhs.y_ < rhs.x_ * rhs.y_;
+    // Prefer square, then wide textures
+    if (Abs(lhs.x_ - lhs.y_) != Abs(rhs.x_ - rhs.y_))
+        return Abs(lhs.x_ - lhs.y_) < Abs(rhs.x_ - rhs.y_);
+    return lhs.x_ > rhs.x_;
+}
+
+/// Pack images into a texture in order. Unless partial, stop at the first image that does not fit. Return the number of images packed.
+unsigned PackImages(const PODVector<PackerInfo*>& packerInfos, const IntVector2& size, const IntVector2& padding, bool rotate,
+    bool partial)
+{
+    RectPacker packer(size.x_, size.y_, padding);
+    unsigned numPacked = 0;
+
+    for (unsigned i = 0; i < packerInfos.Size(); ++i)
+        packerInfos[i]->packed = false;
+
+    for (unsigned i = 0; i < packerInfos.Size(); ++i)
+    {
+        PackerInfo* packerInfo = packerInfos[i];
+        IntVector2 position;
+        bool rotated = false;
+        if (packer.Allocate(packerInfo->width, packerInfo->height, rotate, position, rotated))
+        {
+            packerInfo->x = position.x_;
+            packerInfo->y = position.y_;
+            packerInfo->rotated = rotated;
+            packerInfo->packed = true;
+            ++numPacked;
+        }
+        else if (!partial)
+            break;
+    }
+
+    return numPacked;
+}
+
+String GetPageFileName(const String& fileName, unsigned page)
+{
+    if (!page)
+        return fileName;
+    return GetPath(fileName) + GetFileName(fileName) + "_" + String(page) + GetExtension(fileName, false);
+}
+
 void Run(Vector<String>& arguments)
 {
     if (arguments.Size() < 2)
@@ -111,7 +402,11 @@ void Run(Vector<String>& arguments)
     SharedPtr<Context> context(new Context());
     context->RegisterSubsystem(new FileSystem(context));
     context->RegisterSubsystem(new Log(context));
+    context->RegisterSubsystem(new WorkQueue(context));
     auto* fileSystem = context->GetSubsystem<FileSystem>();
+    auto* queue = context->GetSubsystem<WorkQueue>();
+    // The images are loaded and copied in worker threads, with the main thread taking part
+    queue->CreateThreads(Max(GetNumPhysicalCPUs(), 1u) - 1);
 
     Vector<String> inputFiles;
     String outputFile;
@@ -123,8 +418,11 @@ void Run(Vector<String>& arguments)
     unsigned offsetY = 0;
     unsigned frameWidth = 0;
     unsigned frameHeight = 0;
+    unsigned extrude = 0;
+    int maxSize = MAX_TEXTURE_SIZE;
     bool help = false;
     bool trim = false;
+    bool rotate = false;
 
     while (arguments.Size() > 0)
     {
@@ -143,6 +441,9 @@ void Run(Vector<String>& arguments)
             else if (arg == "-frameWidth") { frameWidth = ToUInt(arguments[0]); arguments.Erase(0); }
             else if (arg == "-frameHeight") { frameHeight = ToUInt(arguments[0]); arguments.Erase(0); }
             else if (arg == "-trim") { trim = true; }
+            else if (arg == "-rotate") { rotate = true; }
+            else if (arg == "-extrude") { extrude = ToUInt(arguments[0]); arguments.Erase(0); }
+            else if (arg == "-maxSize") { maxSize = ToInt(arguments[0]); arguments.Erase(0); }
             else if (arg == "-xml")  { spriteSheetFileName = arguments[0]; arguments.Erase(0); }
             else if (arg == "-h")  { help = true; break; }
             else if (arg == "-debug")  { debug = true; }
@@ -160,6 +461,9 @@ void Run(Vector<String>& arguments)
     if (frameWidth ^ frameHeight)
         ErrorExit("Both frameHeight and frameWidth must be omitted or specified.");
 
+    if (maxSize < MIN_TEXTURE_SIZE || !IsPowerOfTwo((unsigned)maxSize))
+        ErrorExit("The max sprite sheet texture size must be a power of two of at least " + String(MIN_TEXTURE_SIZE) + ".");
+
     // take last input file as output
     if (inputFiles.Size() > 1)
     {
@@ -188,229 +492,207 @@ void Run(Vector<String>& arguments)
     offsetY = Min((int)offsetY, (int)padY);
 
     Vector<SharedPtr<PackerInfo > > packerInfos;
+    LoadSettings loadSettings{context, frameWidth, frameHeight, trim};
 
+    URHO3D_LOGINFO("Loading " + String(inputFiles.Size()) + " images.");
     for (unsigned i = 0; i < inputFiles.Size(); ++i)
     {
         String path = inputFiles[i];
         String name = ReplaceExtension(GetFileName(path), "");
-        File file(context, path);
-        Image image(context);
-
-        if (!image.Load(file))
-            ErrorExit("Could not load image " + path + ".");
-
-        if (image.IsCompressed())
-            ErrorExit(path + " is compressed. Compressed images are not allowed.");
-
         SharedPtr<PackerInfo> packerInfo(new PackerInfo(path, name));
-        int imageWidth = image.GetWidth();
-        int imageHeight = image.GetHeight();
-        int trimOffsetX = 0;
-        int trimOffsetY = 0;
-        int adjustedWidth = imageWidth;
-        int adjustedHeight = imageHeight;
-
-        if (trim)
-        {
-            int minX = imageWidth;
-            int minY = imageHeight;
-            int maxX = 0;
-            int maxY = 0;
+        packerInfos.Push(packerInfo);
 
-            for (int y = 0; y < imageHeight; ++y)
-            {
-                for (int x = 0; x < imageWidth; ++x)
-                {
-                    bool found = (image.GetPixelInt(x, y) & 0x000000ffu) != 0;
-                    if (found) {
-                        minX = Min(minX, x);
-                        minY = Min(minY, y);
-                        maxX = Max(maxX, x);
-                        maxY = Max(maxY, y);
-                    }
-                }
-            }
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = LoadImageWork;
+        item->start_ = packerInfo.Get();
+        item->aux_ = &loadSettings;
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
 
-            trimOffsetX = minX;
-            trimOffsetY = minY;
-            adjustedWidth = maxX - minX + 1;
-            adjustedHeight = maxY - minY + 1;
-        }
+    for (unsigned i = 0; i < packerInfos.Size(); ++i)
+    {
+        if (!packerInfos[i]->error.Empty())
+            ErrorExit(packerInfos[i]->error);
+    }
 
-        if (trim)
-        {
-            packerInfo->frameWidth = imageWidth;
-            packerInfo->frameHeight = imageHeight;
-        }
-        else if (frameWidth || frameHeight)
-        {
-            packerInfo->frameWidth = frameWidth;
-            packerInfo->frameHeight = frameHeight;
-        }
-        packerInfo->width = adjustedWidth;
-        packerInfo->height = adjustedHeight;
-        packerInfo->offsetX -= trimOffsetX;
-        packerInfo->offsetY -= trimOffsetY;
-        packerInfos.Push(packerInfo);
+    // Pack the largest images first. The extruded border counts as padding on both sides
+    IntVector2 padding(padX + extrude * 2, padY + extrude * 2);
+    PODVector<PackerInfo*> remaining;
+    for (unsigned i = 0; i < packerInfos.Size(); ++i)
+        remaining.Push(packerInfos[i]);
+    Sort(remaining.Begin(), remaining.End(), CompareSpriteSize);
+
+    // fill up an list of tries in increasing size
+    Vector<IntVector2> tries;
+    for (int x = MIN_TEXTURE_SIZE; x <= maxSize; x *= 2)
+    {
+        for (int y = MIN_TEXTURE_SIZE; y <= maxSize; y *= 2)
+            tries.Push(IntVector2(x, y));
     }
+    Sort(tries.Begin(), tries.End(), CompareTextureSize);
 
-    int packedWidth = MAX_TEXTURE_SIZE;
-    int packedHeight = MAX_TEXTURE_SIZE;
+    // Take the smallest texture that fits all remaining images. When none does, fill a texture of the max size and continue
+    // on the next page
+    Vector<IntVector2> pageSizes;
+    while (!remaining.Empty())
     {
-        // fill up an list of tries in increasing size and take the first win
-        Vector<IntVector2> tries;
-        for(unsigned x=2; x<11; ++x)
-        {
-            for(unsigned y=2; y<11; ++y)
-                tries.Push(IntVector2((1u<<x), (1u<<y)));
-        }
+        unsigned page = pageSizes.Size();
+        long long area = 0;
+        for (unsigned i = 0; i < remaining.Size(); ++i)
+            area += (long long)(remaining[i]->width + padding.x_) * (remaining[i]->height + padding.y_);
 
-        // load rectangles
-        auto* packerRects = new stbrp_rect[packerInfos.Size()];
-        for (unsigned i = 0; i < packerInfos.Size(); ++i)
+        IntVector2 pageSize = IntVector2::ZERO;
+        for (unsigned i = 0; i < tries.Size(); ++i)
         {
-            PackerInfo* packerInfo = packerInfos[i];
-            stbrp_rect* packerRect = &packerRects[i];
-            packerRect->id = i;
-            packerRect->h = packerInfo->height + padY;
-            packerRect->w = packerInfo->width + padX;
+            const IntVector2& size = tries[i];
+            if ((long long)size.x_ * size.y_ < area)
+                continue;
+            if (PackImages(remaining, size, padding, rotate, false) == remaining.Size())
+            {
+                pageSize = size;
+                break;
+            }
         }
 
-        bool success = false;
-        while (tries.Size() > 0)
+        if (pageSize == IntVector2::ZERO)
         {
-            IntVector2 size = tries[0];
-            tries.Erase(0);
-            bool fit = true;
-            int textureHeight = size.y_;
-            int textureWidth = size.x_;
-            if (success && textureHeight * textureWidth > packedWidth * packedHeight)
-                continue;
-
-            stbrp_context packerContext;
-            stbrp_node packerMemory[PACKER_NUM_NODES];
-            stbrp_init_target(&packerContext, textureWidth, textureHeight, packerMemory, packerInfos.Size());
-            stbrp_pack_rects(&packerContext, packerRects, packerInfos.Size());
-
-            // check to see if everything fit
-            for (unsigned i = 0; i < packerInfos.Size(); ++i)
+            pageSize = IntVector2(maxSize, maxSize);
+            if (!PackImages(remaining, pageSize, padding, rotate, true))
             {
-                stbrp_rect* packerRect = &packerRects[i];
-                if (!packerRect->was_packed)
-                {
-                    fit = false;
-                    break;
-                }
+                ErrorExit("Could not allocate " + remaining[0]->path + ". The max sprite sheet texture size is " +
+                    String(maxSize) + "x" + String(maxSize) + ".");
             }
-            if (fit)
+        }
+
+        for (unsigned i = 0; i < remaining.Size();)
+        {
+            if (remaining[i]->packed)
             {
-                success = true;
-                // distribute values to packer info
-                for (unsigned i = 0; i < packerInfos.Size(); ++i)
-                {
-                    stbrp_rect* packerRect = &packerRects[i];
-                    PackerInfo* packerInfo = packerInfos[packerRect->id];
-                    packerInfo->x = packerRect->x;
-                    packerInfo->y = packerRect->y;
-                }
-                packedWidth = size.x_;
-                packedHeight = size.y_;
+                remaining[i]->page = page;
+                remaining.Erase(i);
             }
+            else
+                ++i;
         }
-        delete[] packerRects;
-        if (!success)
-            ErrorExit("Could not allocate for all images.  The max sprite sheet texture size is " + String(MAX_TEXTURE_SIZE) + "x" + String(MAX_TEXTURE_SIZE) + ".");
-    }
-
-    // create image for spritesheet
-    Image spriteSheetImage(context);
-    spriteSheetImage.SetSize(packedWidth, packedHeight, 4);
 
-    // zero out image
-    spriteSheetImage.SetData(nullptr);
+        URHO3D_LOGINFO("Allocated sprite sheet " + String(page) + " of " + String(pageSize.x_) + "x" + String(pageSize.y_) + ".");
+        pageSizes.Push(pageSize);
+    }
 
-    XMLFile xml(context);
-    XMLElement root = xml.CreateRoot("TextureAtlas");
-    root.SetAttribute("imagePath", GetFileNameAndExtension(outputFile));
+    // create images for spritesheets
+    Vector<SharedPtr<Image> > pages;
+    for (unsigned i = 0; i < pageSizes.Size(); ++i)
+    {
+        SharedPtr<Image> spriteSheetImage(new Image(context));
+        spriteSheetImage->SetSize(pageSizes[i].x_, pageSizes[i].y_, 4);
+        // zero out image
+        spriteSheetImage->SetData(nullptr);
+        pages.Push(spriteSheetImage);
+    }
 
+    URHO3D_LOGINFO("Transferring images to sprite sheets.");
+    BlitSettings blitSettings{&pages, (int)offsetX, (int)offsetY, (int)extrude};
     for (unsigned i = 0; i < packerInfos.Size(); ++i)
     {
-        SharedPtr<PackerInfo> packerInfo = packerInfos[i];
-        XMLElement subTexture = root.CreateChild("SubTexture");
-        subTexture.SetString("name", packerInfo->name);
-        subTexture.SetInt("x", packerInfo->x + offsetX);
-        subTexture.SetInt("y", packerInfo->y + offsetY);
-        subTexture.SetInt("width", packerInfo->width);
-        subTexture.SetInt("height", packerInfo->height);
-
-        if (packerInfo->frameWidth || packerInfo->frameHeight)
-        {
-            subTexture.SetInt("frameWidth", packerInfo->frameWidth);
-            subTexture.SetInt("frameHeight", packerInfo->frameHeight);
-            subTexture.SetInt("offsetX", packerInfo->offsetX);
-            subTexture.SetInt("offsetY", packerInfo->offsetY);
-        }
-
-        URHO3D_LOGINFO("Transferring " + packerInfo->path + " to sprite sheet.");
-
-        File file(context, packerInfo->path);
-        Image image(context);
-        if (!image.Load(file))
-            ErrorExit("Could not load image " + packerInfo->path + ".");
-
-        for (int y = 0; y < packerInfo->height; ++y)
-        {
-            for (int x = 0; x < packerInfo->width; ++x)
-            {
-                unsigned color = image.GetPixelInt(x - packerInfo->offsetX, y - packerInfo->offsetY);
-                spriteSheetImage.SetPixelInt(
-                    packerInfo->x + offsetX + x,
-                    packerInfo->y + offsetY + y, color);
-            }
-        }
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = BlitImageWork;
+        item->start_ = packerInfos[i].Get();
+        item->aux_ = &blitSettings;
+        queue->AddWorkItem(item);
     }
+    queue->Complete(M_MAX_UNSIGNED);
 
-    if (debug)
+    for (unsigned page = 0; page < pages.Size(); ++page)
     {
-        unsigned OUTER_BOUNDS_DEBUG_COLOR = Color::BLUE.ToUInt();
-        unsigned INNER_BOUNDS_DEBUG_COLOR = Color::GREEN.ToUInt();
+        Image& spriteSheetImage = *pages[page];
+        String pageFileName = GetPageFileName(outputFile, page);
+        String pageSpriteSheetFileName = GetPageFileName(spriteSheetFileName, page);
+
+        XMLFile xml(context);
+        XMLElement root = xml.CreateRoot("TextureAtlas");
+        root.SetAttribute("imagePath", GetFileNameAndExtension(pageFileName));
 
-        URHO3D_LOGINFO("Drawing debug information.");
         for (unsigned i = 0; i < packerInfos.Size(); ++i)
         {
             SharedPtr<PackerInfo> packerInfo = packerInfos[i];
+            if (packerInfo->page != page)
+                continue;
 
-            // Draw outer bounds
-            for (int x = 0; x < packerInfo->frameWidth; ++x)
+            // The rectangle is given as stored in the texture
+            XMLElement subTexture = root.CreateChild("SubTexture");
+            subTexture.SetString("name", packerInfo->name);
+            subTexture.SetInt("x", packerInfo->x + offsetX + extrude);
+            subTexture.SetInt("y", packerInfo->y + offsetY + extrude);
+            subTexture.SetInt("width", packerInfo->rotated ? packerInfo->height : packerInfo->width);
+            subTexture.SetInt("height", packerInfo->rotated ? packerInfo->width : packerInfo->height);
+            if (packerInfo->rotated)
+                subTexture.SetBool("rotated", true);
+
+            if (packerInfo->frameWidth || packerInfo->frameHeight)
             {
-                spriteSheetImage.SetPixelInt(packerInfo->x + x, packerInfo->y, OUTER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + x, packerInfo->y + packerInfo->frameHeight, OUTER_BOUNDS_DEBUG_COLOR);
-            }
-            for (int y = 0; y < packerInfo->frameHeight; ++y)
-            {
-                spriteSheetImage.SetPixelInt(packerInfo->x, packerInfo->y + y, OUTER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + packerInfo->frameWidth, packerInfo->y + y, OUTER_BOUNDS_DEBUG_COLOR);
+                subTexture.SetInt("frameWidth", packerInfo->frameWidth);
+                subTexture.SetInt("frameHeight", packerInfo->frameHeight);
+                subTexture.SetInt("frameX", packerInfo->offsetX);
+                subTexture.SetInt("frameY", packerInfo->offsetY);
             }
+        }
 
-            // Draw inner bounds
-            for (int x = 0; x < packerInfo->width; ++x)
-            {
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + x, packerInfo->y + offsetY, INNER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + x, packerInfo->y + offsetY + packerInfo->height, INNER_BOUNDS_DEBUG_COLOR);
-            }
-            for (int y = 0; y < packerInfo->height; ++y)
+        if (debug)
+        {
+            unsigned OUTER_BOUNDS_DEBUG_COLOR = Color::BLUE.ToUInt();
+            unsigned INNER_BOUNDS_DEBUG_COLOR = Color::GREEN.ToUInt();
+
+            URHO3D_LOGINFO("Drawing debug information.");
+            for (unsigned i = 0; i < packerInfos.Size(); ++i)
             {
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX, packerInfo->y + offsetY + y, INNER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + packerInfo->width, packerInfo->y + offsetY + y, INNER_BOUNDS_DEBUG_COLOR);
+                SharedPtr<PackerInfo> packerInfo = packerInfos[i];
+                if (packerInfo->page != page)
+                    continue;
+
+                int outerWidth = packerInfo->rotated ? packerInfo->frameHeight : packerInfo->frameWidth;
+                int outerHeight = packerInfo->rotated ? packerInfo->frameWidth : packerInfo->frameHeight;
+                int innerX = packerInfo->x + offsetX + extrude;
+                int innerY = packerInfo->y + offsetY + extrude;
+                int innerWidth = packerInfo->rotated ? packerInfo->height : packerInfo->width;
+                int innerHeight = packerInfo->rotated ? packerInfo->width : packerInfo->height;
+
+                // Draw outer bounds
+                for (int x = 0; x < outerWidth; ++x)
+                {
+                    spriteSheetImage.SetPixelInt(packerInfo->x + x, packerInfo->y, OUTER_BOUNDS_DEBUG_COLOR);
+                    spriteSheetImage.SetPixelInt(packerInfo->x + x, packerInfo->y + outerHeight, OUTER_BOUNDS_DEBUG_COLOR);
+                }
+                for (int y = 0; y < outerHeight; ++y)
+                {
+                    spriteSheetImage.SetPixelInt(packerInfo->x, packerInfo->y + y, OUTER_BOUNDS_DEBUG_COLOR);
+                    spriteSheetImage.SetPixelInt(packerInfo->x + outerWidth, packerInfo->y + y, OUTER_BOUNDS_DEBUG_COLOR);
+                }
+
+                // Draw inner bounds
+                for (int x = 0; x < innerWidth; ++x)
+                {
+                    spriteSheetImage.SetPixelInt(innerX + x, innerY, INNER_BOUNDS_DEBUG_COLOR);
+                    spriteSheetImage.SetPixelInt(innerX + x, innerY + innerHeight, INNER_BOUNDS_DEBUG_COLOR);
+                }
+                for (int y = 0; y < innerHeight; ++y)
+                {
+                    spriteSheetImage.SetPixelInt(innerX, innerY + y, INNER_BOUNDS_DEBUG_COLOR);
+                    spriteSheetImage.SetPixelInt(innerX + innerWidth, innerY + y, INNER_BOUNDS_DEBUG_COLOR);
+                }
             }
         }
-    }
 
-    URHO3D_LOGINFO("Saving output image.");
-    spriteSheetImage.SavePNG(outputFile);
+        URHO3D_LOGINFO("Saving output image " + pageFileName + ".");
+        if (!spriteSheetImage.SavePNG(pageFileName))
+            ErrorExit("Could not save " + pageFileName + ".");
 
-    URHO3D_LOGINFO("Saving SpriteSheet xml file.");
-    File spriteSheetFile(context);
-    spriteSheetFile.Open(spriteSheetFileName, FILE_WRITE);
-    xml.Save(spriteSheetFile);
+        URHO3D_LOGINFO("Saving SpriteSheet xml file " + pageSpriteSheetFileName + ".");
+        File spriteSheetFile(context);
+        if (!spriteSheetFile.Open(pageSpriteSheetFileName, FILE_WRITE))
+            ErrorExit("Could not open " + pageSpriteSheetFileName + " for writing.");
+        xml.Save(spriteSheetFile);
+    }
 }
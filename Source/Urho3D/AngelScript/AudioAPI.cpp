@@ -68,6 +68,7 @@ void RegisterSoundSources(asIScriptEngine* engine)
     engine->RegisterObjectMethod("SoundSource3D", "float get_outerAngle() const", asMETHOD(SoundSource3D, GetOuterAngle), asCALL_THISCALL);
     engine->RegisterObjectMethod("SoundSource3D", "void set_rolloffFactor(float)", asMETHOD(SoundSource3D, SetRolloffFactor), asCALL_THISCALL);
     engine->RegisterObjectMethod("SoundSource3D", "float get_rolloffFactor() const", asMETHOD(SoundSource3D, RollAngleoffFactor), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SoundSource3D", "float get_occlusion() const", asMETHOD(SoundSource3D, GetOcclusion), asCALL_THISCALL);
 }
 
 void RegisterSoundListener(asIScriptEngine* engine)
@@ -101,6 +102,22 @@ void RegisterAudio(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Audio", "bool get_interpolation() const", asMETHOD(Audio, GetInterpolation), asCALL_THISCALL);
     engine->RegisterObjectMethod("Audio", "bool get_playing() const", asMETHOD(Audio, IsPlaying), asCALL_THISCALL);
     engine->RegisterObjectMethod("Audio", "bool get_initialized() const", asMETHOD(Audio, IsInitialized), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_maxVoices(uint)", asMETHOD(Audio, SetMaxVoices), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_maxVoices() const", asMETHOD(Audio, GetMaxVoices), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_numVirtualVoices() const", asMETHOD(Audio, GetNumVirtualVoices), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_decodeCacheSize(uint)", asMETHOD(Audio, SetDecodeCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_decodeCacheSize() const", asMETHOD(Audio, GetDecodeCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_decodeCacheMaxLength(float)", asMETHOD(Audio, SetDecodeCacheMaxLength), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "float get_decodeCacheMaxLength() const", asMETHOD(Audio, GetDecodeCacheMaxLength), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_decodeCacheUse() const", asMETHOD(Audio, GetDecodeCacheUse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_streamPrefetch(bool)", asMETHOD(Audio, SetStreamPrefetch), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "bool get_streamPrefetch() const", asMETHOD(Audio, GetStreamPrefetch), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_occlusionMask(uint)", asMETHOD(Audio, SetOcclusionMask), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_occlusionMask() const", asMETHOD(Audio, GetOcclusionMask), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_occlusionAttenuation(float)", asMETHOD(Audio, SetOcclusionAttenuation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "float get_occlusionAttenuation() const", asMETHOD(Audio, GetOcclusionAttenuation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "void set_occlusionRaysPerFrame(uint)", asMETHOD(Audio, SetOcclusionRaysPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Audio", "uint get_occlusionRaysPerFrame() const", asMETHOD(Audio, GetOcclusionRaysPerFrame), asCALL_THISCALL);
     engine->RegisterGlobalFunction("Audio@+ get_audio()", asFUNCTION(GetAudio), asCALL_CDECL);
 }
 
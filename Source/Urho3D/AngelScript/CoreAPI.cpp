@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../AngelScript/APITemplates.h"
+#include "../Core/PerfCounters.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Spline.h"
 
@@ -814,6 +815,26 @@ static void RegisterTimer(asIScriptEngine* engine)
     engine->RegisterGlobalFunction("Time@+ get_time()", asFUNCTION(GetTime), asCALL_CDECL);
 }
 
+static PerfCounters* GetPerfCounters()
+{
+    return GetScriptContext()->GetSubsystem<PerfCounters>();
+}
+
+static void RegisterPerfCounters(asIScriptEngine* engine)
+{
+    RegisterObject<PerfCounters>(engine, "PerfCounters");
+    engine->RegisterObjectMethod("PerfCounters", "void Add(const String&in, double = 1.0)", asMETHOD(PerfCounters, Add), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "void Set(const String&in, double)", asMETHOD(PerfCounters, Set), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "void ClearHistory()", asMETHOD(PerfCounters, ClearHistory), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "String PrintData(const String&in = String()) const", asMETHOD(PerfCounters, PrintData), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "void set_historySize(uint)", asMETHOD(PerfCounters, SetHistorySize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "uint get_historySize() const", asMETHOD(PerfCounters, GetHistorySize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "void set_executeConsoleCommands(bool)", asMETHOD(PerfCounters, SetExecuteConsoleCommands), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "bool get_executeConsoleCommands() const", asMETHOD(PerfCounters, GetExecuteConsoleCommands), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PerfCounters", "uint get_numCounters() const", asMETHOD(PerfCounters, GetNumCounters), asCALL_THISCALL);
+    engine->RegisterGlobalFunction("PerfCounters@+ get_perfCounters()", asFUNCTION(GetPerfCounters), asCALL_CDECL);
+}
+
 static CScriptArray* GetArgumentsToArray()
 {
     return VectorToArray<String>(GetArguments(), "Array<String>");
@@ -1054,6 +1075,7 @@ void RegisterCoreAPI(asIScriptEngine* engine)
     RegisterProcessUtils(engine);
     RegisterObject(engine);
     RegisterTimer(engine);
+    RegisterPerfCounters(engine);
 }
 
 }
@@ -62,6 +62,16 @@ static CScriptArray* DbResultGetRow(unsigned index, DbResult* ptr)
         return VectorToArray<Variant>(rows[index], "Array<Variant>");
 }
 
+static DbResult DbConnectionExecuteWithParameters(const String& sql, CScriptArray* parameters, bool useCursorEvent, DbConnection* ptr)
+{
+    return ptr->Execute(sql, ArrayToVector<Variant>(parameters), useCursorEvent);
+}
+
+static DbResult DbConnectionExecuteBatch(CScriptArray* sql, DbConnection* ptr)
+{
+    return ptr->ExecuteBatch(ArrayToVector<String>(sql));
+}
+
 static void RegisterDbResult(asIScriptEngine* engine)
 {
     engine->RegisterObjectType("DbResult", sizeof(DbResult), asOBJ_VALUE | asOBJ_APP_CLASS_C);
@@ -74,14 +84,34 @@ static void RegisterDbResult(asIScriptEngine* engine)
     engine->RegisterObjectMethod("DbResult", "int64 get_numAffectedRows() const", asMETHOD(DbResult, GetNumAffectedRows), asCALL_THISCALL);
     engine->RegisterObjectMethod("DbResult", "Array<String>@ get_columns() const", asFUNCTION(DbResultGetColumns), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("DbResult", "Array<Variant>@ get_row(uint) const", asFUNCTION(DbResultGetRow), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("DbResult", "const String& get_error() const", asMETHOD(DbResult, GetError), asCALL_THISCALL);
 }
 
 static void RegisterDbConnection(asIScriptEngine* engine)
 {
     RegisterObject<DbConnection>(engine, "DbConnection");
-    engine->RegisterObjectMethod("DbConnection", "DbResult Execute(const String&in, bool useCursorEvent = false)", asMETHOD(DbConnection, Execute), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "DbResult Execute(const String&in, bool useCursorEvent = false)", asMETHODPR(DbConnection, Execute, (const String&, bool), DbResult), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "DbResult Execute(const String&in, Array<Variant>@+, bool useCursorEvent = false)", asFUNCTION(DbConnectionExecuteWithParameters), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("DbConnection", "DbResult ExecuteBatch(Array<String>@+)", asFUNCTION(DbConnectionExecuteBatch), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("DbConnection", "bool BeginTransaction()", asMETHOD(DbConnection, BeginTransaction), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "bool CommitTransaction()", asMETHOD(DbConnection, CommitTransaction), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "void RollbackTransaction()", asMETHOD(DbConnection, RollbackTransaction), asCALL_THISCALL);
     engine->RegisterObjectMethod("DbConnection", "const String& get_connectionString() const", asMETHOD(DbConnection, GetConnectionString), asCALL_THISCALL);
     engine->RegisterObjectMethod("DbConnection", "bool get_connected() const", asMETHOD(DbConnection, IsConnected), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "bool get_inTransaction() const", asMETHOD(DbConnection, IsInTransaction), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "void set_statementCacheSize(uint)", asMETHOD(DbConnection, SetStatementCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "uint get_statementCacheSize() const", asMETHOD(DbConnection, GetStatementCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DbConnection", "uint get_numCachedStatements() const", asMETHOD(DbConnection, GetNumCachedStatements), asCALL_THISCALL);
+}
+
+static unsigned DatabaseExecuteAsync(DbConnection* connection, const String& sql, CScriptArray* parameters, Database* ptr)
+{
+    return ptr->ExecuteAsync(connection, sql, ArrayToVector<Variant>(parameters));
+}
+
+static unsigned DatabaseExecuteBatchAsync(DbConnection* connection, CScriptArray* sql, Database* ptr)
+{
+    return ptr->ExecuteBatchAsync(connection, ArrayToVector<String>(sql));
 }
 
 static Database* GetDatabase()
@@ -106,6 +136,10 @@ void RegisterDatabase(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Database", "bool get_pooling() const", asMETHOD(Database, IsPooling), asCALL_THISCALL);
     engine->RegisterObjectMethod("Database", "void set_poolSize(uint)", asMETHOD(Database, SetPoolSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Database", "uint get_poolSize() const", asMETHOD(Database, GetPoolSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Database", "uint ExecuteAsync(DbConnection@+, const String&in, Array<Variant>@+ parameters = null)", asFUNCTION(DatabaseExecuteAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Database", "uint ExecuteBatchAsync(DbConnection@+, Array<String>@+)", asFUNCTION(DatabaseExecuteBatchAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Database", "void Complete()", asMETHOD(Database, Complete), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Database", "uint get_numPendingRequests() const", asMETHOD(Database, GetNumPendingRequests), asCALL_THISCALL);
 
     engine->RegisterGlobalFunction("Database@+ get_database()", asFUNCTION(GetDatabase), asCALL_CDECL);
     engine->RegisterGlobalFunction("DBAPI get_DBAPI()", asFUNCTION(GetDBAPI), asCALL_CDECL);
@@ -79,6 +79,9 @@ static void RegisterDebugHud(asIScriptEngine* engine)
     engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_MODE", (void*)&DEBUGHUD_SHOW_MODE);
     engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_PROFILER", (void*)&DEBUGHUD_SHOW_PROFILER);
     engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_EVENTPROFILER", (void*)&DEBUGHUD_SHOW_EVENTPROFILER);
+    engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_NETWORK", (void*)&DEBUGHUD_SHOW_NETWORK);
+    engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_COUNTERS", (void*)&DEBUGHUD_SHOW_COUNTERS);
+    engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_WORKQUEUE", (void*)&DEBUGHUD_SHOW_WORKQUEUE);
     engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_MEMORY", (void*)&DEBUGHUD_SHOW_MEMORY);
     engine->RegisterGlobalProperty("const uint DEBUGHUD_SHOW_ALL", (void*)&DEBUGHUD_SHOW_ALL);
 
@@ -100,6 +103,9 @@ static void RegisterDebugHud(asIScriptEngine* engine)
     engine->RegisterObjectMethod("DebugHud", "Text@+ get_modeText() const", asMETHOD(DebugHud, GetModeText), asCALL_THISCALL);
     engine->RegisterObjectMethod("DebugHud", "Text@+ get_profilerText() const", asMETHOD(DebugHud, GetProfilerText), asCALL_THISCALL);
     engine->RegisterObjectMethod("DebugHud", "Text@+ get_memoryText() const", asMETHOD(DebugHud, GetMemoryText), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DebugHud", "Text@+ get_networkText() const", asMETHOD(DebugHud, GetNetworkText), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DebugHud", "UIElement@+ get_countersElement() const", asMETHOD(DebugHud, GetCountersElement), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DebugHud", "Text@+ get_workQueueText() const", asMETHOD(DebugHud, GetWorkQueueText), asCALL_THISCALL);
     engine->RegisterObjectMethod("DebugHud", "void SetAppStats(const String&in, const Variant&in)", asMETHODPR(DebugHud, SetAppStats, (const String&, const Variant&), void), asCALL_THISCALL);
     engine->RegisterObjectMethod("DebugHud", "void SetAppStats(const String&in, const String&in)", asMETHODPR(DebugHud, SetAppStats, (const String&, const String&), void), asCALL_THISCALL);
     engine->RegisterObjectMethod("DebugHud", "void ResetAppStats(const String&in)", asMETHOD(DebugHud, ResetAppStats), asCALL_THISCALL);
@@ -130,6 +136,13 @@ static void RegisterEngine(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Engine", "int get_timeStepSmoothing() const", asMETHOD(Engine, GetTimeStepSmoothing), asCALL_THISCALL);
     engine->RegisterObjectMethod("Engine", "void set_maxInactiveFps(int)", asMETHOD(Engine, SetMaxInactiveFps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Engine", "int get_maxInactiveFps() const", asMETHOD(Engine, GetMaxInactiveFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "void set_gcTimeBudget(int)", asMETHOD(Engine, SetGCTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "int get_gcTimeBudget() const", asMETHOD(Engine, GetGCTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "int get_gcTime() const", asMETHOD(Engine, GetGCTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "void set_pipelinedFrames(bool)", asMETHOD(Engine, SetPipelinedFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "bool get_pipelinedFrames() const", asMETHOD(Engine, GetPipelinedFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "void set_pacedTimeStep(bool)", asMETHOD(Engine, SetPacedTimeStep), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Engine", "bool get_pacedTimeStep() const", asMETHOD(Engine, GetPacedTimeStep), asCALL_THISCALL);
     engine->RegisterObjectMethod("Engine", "void set_pauseMinimized(bool)", asMETHOD(Engine, SetPauseMinimized), asCALL_THISCALL);
     engine->RegisterObjectMethod("Engine", "bool get_pauseMinimized() const", asMETHOD(Engine, GetPauseMinimized), asCALL_THISCALL);
     engine->RegisterObjectMethod("Engine", "void set_autoExit(bool)", asMETHOD(Engine, SetAutoExit), asCALL_THISCALL);
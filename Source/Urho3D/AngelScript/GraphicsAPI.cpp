@@ -23,19 +23,25 @@
 #include "../Precompiled.h"
 
 #include "../AngelScript/APITemplates.h"
+#include "../Graphics/AnimatedCrowd.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
+#include "../Graphics/AnimationLodPolicy.h"
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/CustomGeometry.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/DecalSet.h"
+#include "../Graphics/GPUParticleEmitter.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/HLODGroup.h"
+#include "../Graphics/ImpostorGroup.h"
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Light.h"
 #include "../Graphics/Material.h"
+#include "../Graphics/MaterialArray.h"
 #include "../Graphics/Octree.h"
 #include "../Graphics/ParticleEffect.h"
 #include "../Graphics/ParticleEmitter.h"
@@ -45,11 +51,15 @@
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/Technique.h"
 #include "../Graphics/Terrain.h"
+#include "../Graphics/TerrainClipmap.h"
+#include "../Graphics/TerrainStreamer.h"
 #include "../Graphics/TerrainPatch.h"
 #include "../Graphics/Texture2D.h"
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/ShaderPrecache.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/Skybox.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/Zone.h"
@@ -293,6 +303,7 @@ static void RegisterRenderPath(asIScriptEngine* engine)
     engine->RegisterEnumValue("RenderCommandType", "CMD_LIGHTVOLUMES", CMD_LIGHTVOLUMES);
     engine->RegisterEnumValue("RenderCommandType", "CMD_RENDERUI", CMD_RENDERUI);
     engine->RegisterEnumValue("RenderCommandType", "CMD_SENDEVENT", CMD_SENDEVENT);
+    engine->RegisterEnumValue("RenderCommandType", "CMD_TILEDLIGHTS", CMD_TILEDLIGHTS);
 
     engine->RegisterEnum("RenderCommandSortMode");
     engine->RegisterEnumValue("RenderCommandSortMode", "SORT_FRONTTOBACK", SORT_FRONTTOBACK);
@@ -487,6 +498,11 @@ static void RegisterTextures(asIScriptEngine* engine)
     engine->RegisterObjectMethod("RenderSurface", "Viewport@+ get_viewports(uint) const", asMETHOD(RenderSurface, GetViewport), asCALL_THISCALL);
     engine->RegisterObjectMethod("RenderSurface", "void set_updateMode(RenderSurfaceUpdateMode)", asMETHOD(RenderSurface, SetUpdateMode), asCALL_THISCALL);
     engine->RegisterObjectMethod("RenderSurface", "RenderSurfaceUpdateMode get_updateMode() const", asMETHOD(RenderSurface, GetUpdateMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RenderSurface", "void set_updateInterval(uint)", asMETHOD(RenderSurface, SetUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RenderSurface", "uint get_updateInterval() const", asMETHOD(RenderSurface, GetUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RenderSurface", "void set_updateDistance(float)", asMETHOD(RenderSurface, SetUpdateDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RenderSurface", "float get_updateDistance() const", asMETHOD(RenderSurface, GetUpdateDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RenderSurface", "uint get_lastUpdateFrame() const", asMETHOD(RenderSurface, GetLastUpdateFrame), asCALL_THISCALL);
     engine->RegisterObjectMethod("RenderSurface", "void set_linkedRenderTarget(RenderSurface@+)", asMETHOD(RenderSurface, SetLinkedRenderTarget), asCALL_THISCALL);
     engine->RegisterObjectMethod("RenderSurface", "RenderSurface@+ get_linkedRenderTarget() const", asMETHOD(RenderSurface, GetLinkedRenderTarget), asCALL_THISCALL);
     engine->RegisterObjectMethod("RenderSurface", "void set_linkedDepthStencil(RenderSurface@+)", asMETHOD(RenderSurface, SetLinkedDepthStencil), asCALL_THISCALL);
@@ -497,6 +513,9 @@ static void RegisterTextures(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Texture2D", "bool SetSize(int, int, uint, TextureUsage usage = TEXTURE_STATIC, int multiSample = 1, bool autoResolve = true)", asMETHOD(Texture2D, SetSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "bool SetData(Image@+, bool useAlpha = false)", asMETHODPR(Texture2D, SetData, (Image*, bool), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "RenderSurface@+ get_renderSurface() const", asMETHOD(Texture2D, GetRenderSurface), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Texture2D", "void set_streaming(bool)", asMETHOD(Texture2D, SetStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Texture2D", "bool get_streaming() const", asMETHOD(Texture2D, IsStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Texture2D", "uint get_streamingMipsToSkip() const", asMETHOD(Texture2D, GetStreamingMipsToSkip), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "Image@+ GetImage() const", asFUNCTION(Texture2DGetImage), asCALL_CDECL_OBJLAST);
 
     RegisterTexture<Texture2DArray>(engine, "Texture2DArray");
@@ -515,6 +534,8 @@ static void RegisterTextures(asIScriptEngine* engine)
     engine->RegisterObjectMethod("TextureCube", "bool SetData(CubeMapFace, Image@+, bool useAlpha = false)", asMETHODPR(TextureCube, SetData, (CubeMapFace, Image*, bool), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("TextureCube", "Image@+ GetImage(CubeMapFace) const", asFUNCTION(TextureCubeGetImage), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("TextureCube", "RenderSurface@+ get_renderSurfaces(CubeMapFace) const", asMETHOD(TextureCube, GetRenderSurface), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureCube", "void set_roundRobinFaces(bool)", asMETHOD(TextureCube, SetRoundRobinFaces), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureCube", "bool get_roundRobinFaces() const", asMETHOD(TextureCube, GetRoundRobinFaces), asCALL_THISCALL);
 
     engine->RegisterGlobalFunction("uint GetAlphaFormat()", asFUNCTION(Graphics::GetAlphaFormat), asCALL_CDECL);
     engine->RegisterGlobalFunction("uint GetLuminanceFormat()", asFUNCTION(Graphics::GetLuminanceFormat), asCALL_CDECL);
@@ -760,6 +781,13 @@ static void RegisterBuffers(asIScriptEngine* engine)
     engine->RegisterEnumValue("VertexElementType", "TYPE_VECTOR4", TYPE_VECTOR4);
     engine->RegisterEnumValue("VertexElementType", "TYPE_UBYTE4", TYPE_UBYTE4);
     engine->RegisterEnumValue("VertexElementType", "TYPE_UBYTE4_NORM", TYPE_UBYTE4_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_HALF2", TYPE_HALF2);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_HALF4", TYPE_HALF4);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_SHORT2_NORM", TYPE_SHORT2_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_SHORT4_NORM", TYPE_SHORT4_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_USHORT2_NORM", TYPE_USHORT2_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_USHORT4_NORM", TYPE_USHORT4_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_UINT_10_10_10_2_NORM", TYPE_UINT_10_10_10_2_NORM);
     engine->RegisterEnumValue("VertexElementType", "MAX_VERTEX_ELEMENT_TYPES", MAX_VERTEX_ELEMENT_TYPES);
 
     engine->RegisterEnum("VertexElementSemantic");
@@ -836,6 +864,18 @@ static void RegisterBuffers(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Geometry", "void set_lodDistance(float)", asMETHOD(Geometry, SetLodDistance), asCALL_THISCALL);
     engine->RegisterObjectMethod("Geometry", "float get_lodDistance() const", asMETHOD(Geometry, GetLodDistance), asCALL_THISCALL);
     engine->RegisterObjectMethod("Geometry", "bool get_empty() const", asMETHOD(Geometry, IsEmpty), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Geometry", "bool BuildMeshlets(uint maxTriangles = 128)", asMETHOD(Geometry, BuildMeshlets), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Geometry", "uint get_numMeshlets() const", asMETHOD(Geometry, GetNumMeshlets), asCALL_THISCALL);
+}
+
+static MaterialArray* ConstructMaterialArray()
+{
+    return new MaterialArray(GetScriptContext());
+}
+
+static bool MaterialArrayBuild(CScriptArray* materialsArray, MaterialArray* ptr)
+{
+    return ptr->Build(ArrayToPODVector<Material*>(materialsArray));
 }
 
 static void RegisterMaterial(asIScriptEngine* engine)
@@ -968,8 +1008,17 @@ static void RegisterMaterial(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Material", "uint8 get_renderOrder() const", asMETHOD(Material, GetRenderOrder), asCALL_THISCALL);
     engine->RegisterObjectMethod("Material", "void set_scene(Scene@+)", asMETHOD(Material, SetScene), asCALL_THISCALL);
     engine->RegisterObjectMethod("Material", "Scene@+ get_scene() const", asMETHOD(Material, GetScene), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Material", "Material@+ get_arrayMaterial() const", asMETHOD(Material, GetArrayMaterial), asCALL_THISCALL);
 
     engine->RegisterGlobalFunction("String GetTextureUnitName(TextureUnit)", asFUNCTION(Material::GetTextureUnitName), asCALL_CDECL);
+
+    RegisterObject<MaterialArray>(engine, "MaterialArray");
+    engine->RegisterObjectBehaviour("MaterialArray", asBEHAVE_FACTORY, "MaterialArray@+ f()", asFUNCTION(ConstructMaterialArray), asCALL_CDECL);
+    engine->RegisterObjectMethod("MaterialArray", "bool Build(Array<Material@>@+)", asFUNCTION(MaterialArrayBuild), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("MaterialArray", "void Clear()", asMETHOD(MaterialArray, Clear), asCALL_THISCALL);
+    engine->RegisterObjectMethod("MaterialArray", "Material@+ get_arrayMaterial() const", asMETHOD(MaterialArray, GetArrayMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("MaterialArray", "uint get_numMaterials() const", asMETHOD(MaterialArray, GetNumMaterials), asCALL_THISCALL);
+    engine->RegisterObjectMethod("MaterialArray", "Material@+ get_materials(uint) const", asMETHOD(MaterialArray, GetMaterial), asCALL_THISCALL);
 }
 
 static Model* ModelClone(const String& cloneName, Model* ptr)
@@ -1003,6 +1052,11 @@ static bool ModelSetIndexBuffers(CScriptArray* indexBuffers, Model* ptr)
 
 static void RegisterModel(asIScriptEngine* engine)
 {
+    engine->RegisterEnum("ModelCPUData");
+    engine->RegisterEnumValue("ModelCPUData", "CPUDATA_FULL", CPUDATA_FULL);
+    engine->RegisterEnumValue("ModelCPUData", "CPUDATA_POSITIONS", CPUDATA_POSITIONS);
+    engine->RegisterEnumValue("ModelCPUData", "CPUDATA_NONE", CPUDATA_NONE);
+
     RegisterResourceWithMetadata<Model>(engine, "Model");
     engine->RegisterObjectMethod("Model", "Model@ Clone(const String&in cloneName = String()) const", asFUNCTION(ModelClone), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Model", "bool SetVertexBuffers(Array<VertexBuffer@>@+, Array<uint>@+, Array<uint>@+)", asFUNCTION(ModelSetVertexBuffers), asCALL_CDECL_OBJLAST);
@@ -1019,6 +1073,8 @@ static void RegisterModel(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Model", "bool set_geometryCenters(uint, const Vector3&in)", asMETHOD(Model, SetGeometryCenter), asCALL_THISCALL);
     engine->RegisterObjectMethod("Model", "const Vector3& get_geometryCenters(uint) const", asMETHOD(Model, GetGeometryCenter), asCALL_THISCALL);
     engine->RegisterObjectMethod("Model", "uint get_numMorphs() const", asMETHOD(Model, GetNumMorphs), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Model", "void set_cpuData(ModelCPUData)", asMETHOD(Model, SetCPUData), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Model", "ModelCPUData get_cpuData() const", asMETHOD(Model, GetCPUData), asCALL_THISCALL);
 }
 
 static void ConstructAnimationKeyFrame(AnimationKeyFrame* ptr)
@@ -1132,6 +1188,11 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Animation", "void RemoveTrigger(uint)", asMETHOD(Animation, RemoveTrigger), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void RemoveAllTriggers()", asMETHOD(Animation, RemoveAllTriggers), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "Animation@ Clone(const String&in cloneName = String()) const", asFUNCTION(AnimationClone), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Animation", "void Compress(float sampleRate = 30.0f)", asMETHOD(Animation, Compress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "void Decompress()", asMETHOD(Animation, Decompress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "bool get_compressed() const", asMETHOD(Animation, IsCompressed), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "float get_sampleRate() const", asMETHOD(Animation, GetSampleRate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "uint get_numSamples() const", asMETHOD(Animation, GetNumSamples), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_animationName(const String&in) const", asMETHOD(Animation, SetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "const String& get_animationName() const", asMETHOD(Animation, GetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_length(float)", asMETHOD(Animation, SetLength), asCALL_THISCALL);
@@ -1259,6 +1320,8 @@ static void RegisterLight(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Light", "float get_shadowNearFarRatio() const", asMETHOD(Light, GetShadowNearFarRatio), asCALL_THISCALL);
     engine->RegisterObjectMethod("Light", "void set_shadowMaxExtrusion(float)", asMETHOD(Light, SetShadowMaxExtrusion), asCALL_THISCALL);
     engine->RegisterObjectMethod("Light", "float get_shadowMaxExtrusion() const", asMETHOD(Light, GetShadowMaxExtrusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Light", "void set_shadowCaching(bool)", asMETHOD(Light, SetShadowCaching), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Light", "bool get_shadowCaching() const", asMETHOD(Light, GetShadowCaching), asCALL_THISCALL);
     engine->RegisterObjectMethod("Light", "void set_rampTexture(Texture@+)", asMETHOD(Light, SetRampTexture), asCALL_THISCALL);
     engine->RegisterObjectMethod("Light", "Texture@+ get_rampTexture() const", asMETHOD(Light, GetRampTexture), asCALL_THISCALL);
     engine->RegisterObjectMethod("Light", "void set_shapeTexture(Texture@+)", asMETHOD(Light, SetShapeTexture), asCALL_THISCALL);
@@ -1327,6 +1390,9 @@ static void RegisterStaticModel(asIScriptEngine* engine)
     engine->RegisterObjectMethod("StaticModel", "uint get_numGeometries() const", asMETHOD(StaticModel, GetNumGeometries), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModel", "void set_occlusionLodLevel(uint) const", asMETHOD(StaticModel, SetOcclusionLodLevel), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModel", "uint get_occlusionLodLevel() const", asMETHOD(StaticModel, GetOcclusionLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("StaticModel", "void set_meshletCulling(bool)", asMETHOD(StaticModel, SetMeshletCulling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("StaticModel", "bool get_meshletCulling() const", asMETHOD(StaticModel, GetMeshletCulling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("StaticModel", "uint get_numVisibleMeshlets() const", asMETHOD(StaticModel, GetNumVisibleMeshlets), asCALL_THISCALL);
 }
 
 static void RegisterStaticModelGroup(asIScriptEngine* engine)
@@ -1337,15 +1403,105 @@ static void RegisterStaticModelGroup(asIScriptEngine* engine)
     engine->RegisterObjectMethod("StaticModelGroup", "void AddInstanceNode(Node@+)", asMETHOD(StaticModelGroup, AddInstanceNode), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModelGroup", "void RemoveInstanceNode(Node@+)", asMETHOD(StaticModelGroup, RemoveInstanceNode), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModelGroup", "void RemoveAllInstanceNodes()", asMETHOD(StaticModelGroup, RemoveAllInstanceNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("StaticModelGroup", "void set_staticInstancing(bool)", asMETHOD(StaticModelGroup, SetStaticInstancing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("StaticModelGroup", "bool get_staticInstancing() const", asMETHOD(StaticModelGroup, GetStaticInstancing), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModelGroup", "uint get_numInstanceNodes() const", asMETHOD(StaticModelGroup, GetNumInstanceNodes), asCALL_THISCALL);
     engine->RegisterObjectMethod("StaticModelGroup", "Node@+ get_instanceNodes(uint) const", asMETHOD(StaticModelGroup, GetInstanceNode), asCALL_THISCALL);
 }
 
+static void RegisterAnimatedCrowd(asIScriptEngine* engine)
+{
+    RegisterStaticModel<AnimatedCrowd>(engine, "AnimatedCrowd", true);
+    RegisterSubclass<StaticModelGroup, AnimatedCrowd>(engine, "StaticModelGroup", "AnimatedCrowd");
+    engine->RegisterObjectMethod("AnimatedCrowd", "void set_occlusionLodLevel(uint) const", asMETHOD(AnimatedCrowd, SetOcclusionLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "uint get_occlusionLodLevel() const", asMETHOD(AnimatedCrowd, GetOcclusionLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void AddInstanceNode(Node@+)", asMETHOD(AnimatedCrowd, AddInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void RemoveInstanceNode(Node@+)", asMETHOD(AnimatedCrowd, RemoveInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void RemoveAllInstanceNodes()", asMETHOD(AnimatedCrowd, RemoveAllInstanceNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "uint get_numInstanceNodes() const", asMETHOD(AnimatedCrowd, GetNumInstanceNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "Node@+ get_instanceNodes(uint) const", asMETHOD(AnimatedCrowd, GetInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void AddAnimation(Animation@+)", asMETHOD(AnimatedCrowd, AddAnimation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void RemoveAllAnimations()", asMETHOD(AnimatedCrowd, RemoveAllAnimations), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void SetInstanceAnimation(Node@+, uint, float = 0.0f, float = 1.0f)", asMETHOD(AnimatedCrowd, SetInstanceAnimation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "uint GetInstanceAnimation(Node@+) const", asMETHOD(AnimatedCrowd, GetInstanceAnimation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "float GetInstanceTime(Node@+) const", asMETHOD(AnimatedCrowd, GetInstanceTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "uint get_numAnimations() const", asMETHOD(AnimatedCrowd, GetNumAnimations), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "Animation@+ get_animations(uint) const", asMETHOD(AnimatedCrowd, GetAnimation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "void set_bakeFps(float)", asMETHOD(AnimatedCrowd, SetBakeFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "float get_bakeFps() const", asMETHOD(AnimatedCrowd, GetBakeFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedCrowd", "Texture2D@+ get_animationTexture() const", asMETHOD(AnimatedCrowd, GetAnimationTexture), asCALL_THISCALL);
+}
+
+static void RegisterHLODGroup(asIScriptEngine* engine)
+{
+    RegisterStaticModel<HLODGroup>(engine, "HLODGroup", true);
+    engine->RegisterObjectMethod("HLODGroup", "void set_occlusionLodLevel(uint) const", asMETHOD(HLODGroup, SetOcclusionLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "uint get_occlusionLodLevel() const", asMETHOD(HLODGroup, GetOcclusionLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "void AddMemberNode(Node@+)", asMETHOD(HLODGroup, AddMemberNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "void RemoveMemberNode(Node@+)", asMETHOD(HLODGroup, RemoveMemberNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "void RemoveAllMemberNodes()", asMETHOD(HLODGroup, RemoveAllMemberNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "void UpdateMembers()", asMETHOD(HLODGroup, UpdateMembers), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "bool BuildProxyModel()", asMETHOD(HLODGroup, BuildProxyModel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "bool IsProxyActive(Camera@+) const", asMETHOD(HLODGroup, IsProxyActive), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "void set_switchDistance(float)", asMETHOD(HLODGroup, SetSwitchDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "float get_switchDistance() const", asMETHOD(HLODGroup, GetSwitchDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "uint get_numMemberNodes() const", asMETHOD(HLODGroup, GetNumMemberNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "Node@+ get_memberNodes(uint) const", asMETHOD(HLODGroup, GetMemberNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HLODGroup", "uint get_numMemberDrawables() const", asMETHOD(HLODGroup, GetNumMemberDrawables), asCALL_THISCALL);
+}
+
+static void RegisterImpostorGroup(asIScriptEngine* engine)
+{
+    RegisterDrawable<ImpostorGroup>(engine, "ImpostorGroup");
+    engine->RegisterObjectMethod("ImpostorGroup", "void AddInstanceNode(Node@+)", asMETHOD(ImpostorGroup, AddInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void RemoveInstanceNode(Node@+)", asMETHOD(ImpostorGroup, RemoveInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void RemoveAllInstanceNodes()", asMETHOD(ImpostorGroup, RemoveAllInstanceNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "bool BakeImpostor(StaticModel@+, int cellSize = 256)", asMETHOD(ImpostorGroup, BakeImpostor), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void set_model(Model@+)", asMETHOD(ImpostorGroup, SetModel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "Model@+ get_model() const", asMETHOD(ImpostorGroup, GetModel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void set_material(Material@+)", asMETHOD(ImpostorGroup, SetMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "Material@+ get_material() const", asMETHOD(ImpostorGroup, GetMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void set_numAngles(uint)", asMETHOD(ImpostorGroup, SetNumAngles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "uint get_numAngles() const", asMETHOD(ImpostorGroup, GetNumAngles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "void set_switchDistance(float)", asMETHOD(ImpostorGroup, SetSwitchDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "float get_switchDistance() const", asMETHOD(ImpostorGroup, GetSwitchDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "uint get_numInstanceNodes() const", asMETHOD(ImpostorGroup, GetNumInstanceNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "Node@+ get_instanceNodes(uint) const", asMETHOD(ImpostorGroup, GetInstanceNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ImpostorGroup", "Texture2D@+ get_impostorTexture() const", asMETHOD(ImpostorGroup, GetImpostorTexture), asCALL_THISCALL);
+}
+
 static void RegisterSkybox(asIScriptEngine* engine)
 {
     RegisterStaticModel<Skybox>(engine, "Skybox", true);
 }
 
+static void RegisterAnimationLodPolicy(asIScriptEngine* engine)
+{
+    engine->RegisterObjectType("AnimationLodLevel", 0, asOBJ_REF);
+    engine->RegisterObjectBehaviour("AnimationLodLevel", asBEHAVE_ADDREF, "void f()", asFUNCTION(FakeAddRef), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("AnimationLodLevel", asBEHAVE_RELEASE, "void f()", asFUNCTION(FakeReleaseRef), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectProperty("AnimationLodLevel", "const float minCoverage", offsetof(AnimationLodLevel, minCoverage_));
+    engine->RegisterObjectProperty("AnimationLodLevel", "const uint interval", offsetof(AnimationLodLevel, interval_));
+    engine->RegisterObjectProperty("AnimationLodLevel", "const bool maskBones", offsetof(AnimationLodLevel, maskBones_));
+
+    RegisterResource<AnimationLodPolicy>(engine, "AnimationLodPolicy");
+    engine->RegisterObjectMethod("AnimationLodPolicy", "bool Load(const XMLElement&in)", asMETHODPR(AnimationLodPolicy, Load, (const XMLElement&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "bool Save(XMLElement&) const", asMETHODPR(AnimationLodPolicy, Save, (XMLElement&) const, bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void AddLevel(float, uint, bool maskBones = false)", asMETHOD(AnimationLodPolicy, AddLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void RemoveLevel(uint)", asMETHOD(AnimationLodPolicy, RemoveLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void RemoveAllLevels()", asMETHOD(AnimationLodPolicy, RemoveAllLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void AddMaskedBone(const String&in)", asMETHOD(AnimationLodPolicy, AddMaskedBone), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void RemoveAllMaskedBones()", asMETHOD(AnimationLodPolicy, RemoveAllMaskedBones), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "bool IsBoneMasked(const String&in) const", asMETHOD(AnimationLodPolicy, IsBoneMasked), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "AnimationLodLevel@+ GetLevelForCoverage(float) const", asMETHOD(AnimationLodPolicy, GetLevelForCoverage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "AnimationLodLevel@+ get_levels(uint) const", asMETHOD(AnimationLodPolicy, GetLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "uint get_numLevels() const", asMETHOD(AnimationLodPolicy, GetNumLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void set_invisibleInterval(uint)", asMETHOD(AnimationLodPolicy, SetInvisibleInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "uint get_invisibleInterval() const", asMETHOD(AnimationLodPolicy, GetInvisibleInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "void set_interpolation(bool)", asMETHOD(AnimationLodPolicy, SetInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationLodPolicy", "bool get_interpolation() const", asMETHOD(AnimationLodPolicy, GetInterpolation), asCALL_THISCALL);
+}
+
 static void AnimatedModelSetModel(Model* model, AnimatedModel* ptr)
 {
     ptr->SetModel(model);
@@ -1421,8 +1577,14 @@ static void RegisterAnimatedModel(asIScriptEngine* engine)
     engine->RegisterObjectMethod("AnimatedModel", "void set_model(Model@+)", asFUNCTION(AnimatedModelSetModel), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("AnimatedModel", "void set_animationLodBias(float)", asMETHOD(AnimatedModel, SetAnimationLodBias), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "float get_animationLodBias() const", asMETHOD(AnimatedModel, GetAnimationLodBias), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "void set_animationLodPolicy(AnimationLodPolicy@+)", asMETHOD(AnimatedModel, SetAnimationLodPolicy), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "AnimationLodPolicy@+ get_animationLodPolicy() const", asMETHOD(AnimatedModel, GetAnimationLodPolicy), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "float get_animationLodCoverage() const", asMETHOD(AnimatedModel, GetAnimationLodCoverage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "uint get_animationLodInterval() const", asMETHOD(AnimatedModel, GetAnimationLodInterval), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "void set_updateInvisible(bool)", asMETHOD(AnimatedModel, SetUpdateInvisible), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "bool get_updateInvisible() const", asMETHOD(AnimatedModel, GetUpdateInvisible), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "void set_preSkinning(bool)", asMETHOD(AnimatedModel, SetPreSkinning), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "bool get_preSkinning() const", asMETHOD(AnimatedModel, GetPreSkinning), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "Skeleton@+ get_skeleton()", asMETHOD(AnimatedModel, GetSkeleton), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "uint get_numAnimationStates() const", asMETHOD(AnimatedModel, GetNumAnimationStates), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "AnimationState@+ get_animationStates(const String&in) const", asMETHODPR(AnimatedModel, GetAnimationState, (const String&) const, AnimationState*), asCALL_THISCALL);
@@ -1698,6 +1860,21 @@ static void RegisterParticleEmitter(asIScriptEngine* engine)
     engine->RegisterObjectMethod("ParticleEmitter", "void ApplyEffect()", asMETHOD(ParticleEmitter, ApplyEffect), asCALL_THISCALL);
 }
 
+static void RegisterGPUParticleEmitter(asIScriptEngine* engine)
+{
+    RegisterDrawable<GPUParticleEmitter>(engine, "GPUParticleEmitter");
+    engine->RegisterObjectMethod("GPUParticleEmitter", "void set_effect(ParticleEffect@+)", asMETHOD(GPUParticleEmitter, SetEffect), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "ParticleEffect@+ get_effect() const", asMETHOD(GPUParticleEmitter, GetEffect), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "uint get_numParticles() const", asMETHOD(GPUParticleEmitter, GetNumParticles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "void set_emitting(bool)", asMETHOD(GPUParticleEmitter, SetEmitting), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "bool get_emitting() const", asMETHOD(GPUParticleEmitter, IsEmitting), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "void set_autoRemoveMode(AutoRemoveMode)", asMETHOD(GPUParticleEmitter, SetAutoRemoveMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "AutoRemoveMode get_autoRemoveMode() const", asMETHOD(GPUParticleEmitter, GetAutoRemoveMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "Zone@+ get_zone() const", asMETHOD(GPUParticleEmitter, GetZone), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "void Reset()", asMETHOD(GPUParticleEmitter, Reset), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUParticleEmitter", "void ApplyEffect()", asMETHOD(GPUParticleEmitter, ApplyEffect), asCALL_THISCALL);
+}
+
 static void RegisterRibbonTrail(asIScriptEngine* engine)
 {
     engine->RegisterEnum("TrailType");
@@ -1777,6 +1954,7 @@ static void RegisterDecalSet(asIScriptEngine* engine)
 {
     RegisterDrawable<DecalSet>(engine, "DecalSet");
     engine->RegisterObjectMethod("DecalSet", "bool AddDecal(Drawable@+, const Vector3&in, const Quaternion&in, float, float, float, const Vector2&in, const Vector2&in, float timeToLive = 0.0, float normalCutoff = 0.1, uint subGeometry = 0xffffffff)", asMETHOD(DecalSet, AddDecal), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "bool AddDecalAsync(Drawable@+, const Vector3&in, const Quaternion&in, float, float, float, const Vector2&in, const Vector2&in, float timeToLive = 0.0, float normalCutoff = 0.1, uint subGeometry = 0xffffffff)", asMETHOD(DecalSet, AddDecalAsync), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void RemoveDecals(uint)", asMETHOD(DecalSet, RemoveDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void RemoveAllDecals()", asMETHOD(DecalSet, RemoveAllDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void set_material(Material@+)", asMETHOD(DecalSet, SetMaterial), asCALL_THISCALL);
@@ -1790,14 +1968,25 @@ static void RegisterDecalSet(asIScriptEngine* engine)
     engine->RegisterObjectMethod("DecalSet", "uint get_maxIndices() const", asMETHOD(DecalSet, GetMaxIndices), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void set_optimizeBufferSize(bool)", asMETHOD(DecalSet, SetOptimizeBufferSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "bool get_optimizeBufferSize() const", asMETHOD(DecalSet, GetOptimizeBufferSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "void set_maxDecalsPerFrame(uint)", asMETHOD(DecalSet, SetMaxDecalsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "uint get_maxDecalsPerFrame() const", asMETHOD(DecalSet, GetMaxDecalsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "uint get_numPendingDecals() const", asMETHOD(DecalSet, GetNumPendingDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "Zone@+ get_zone() const", asMETHOD(DecalSet, GetZone), asCALL_THISCALL);
 }
 
 static void RegisterTerrain(asIScriptEngine* engine)
 {
     RegisterDrawable<TerrainPatch>(engine, "TerrainPatch");
+    RegisterDrawable<TerrainClipmap>(engine, "TerrainClipmap");
+    engine->RegisterObjectMethod("TerrainClipmap", "Texture2D@+ get_heightTexture() const", asMETHOD(TerrainClipmap, GetHeightTexture), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainClipmap", "Material@+ get_clipmapMaterial() const", asMETHOD(TerrainClipmap, GetClipmapMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainClipmap", "uint get_numLevels() const", asMETHOD(TerrainClipmap, GetNumLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainClipmap", "uint get_numSelectedNodes() const", asMETHOD(TerrainClipmap, GetNumSelectedNodes), asCALL_THISCALL);
     RegisterComponent<Terrain>(engine, "Terrain");
     engine->RegisterObjectMethod("Terrain", "void ApplyHeightMap()", asMETHOD(Terrain, ApplyHeightMap), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "void ApplyHeightMapRegion(const IntRect&in)", asMETHOD(Terrain, ApplyHeightMapRegion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "void CompleteHeightMapUpdates()", asMETHOD(Terrain, CompleteHeightMapUpdates), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "bool get_updatingHeightMap() const", asMETHOD(Terrain, IsUpdatingHeightMap), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "float GetHeight(const Vector3&in) const", asMETHOD(Terrain, GetHeight), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "Vector3 GetNormal(const Vector3&in) const", asMETHOD(Terrain, GetNormal), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "TerrainPatch@+ GetPatch(int, int) const", asMETHODPR(Terrain, GetPatch, (int, int) const, TerrainPatch*), asCALL_THISCALL);
@@ -1813,6 +2002,9 @@ static void RegisterTerrain(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Terrain", "uint get_occlusionLodLevel() const", asMETHOD(Terrain, GetOcclusionLodLevel), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "void set_smoothing(bool)", asMETHOD(Terrain, SetSmoothing), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "bool get_smoothing() const", asMETHOD(Terrain, GetSmoothing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "void set_clipmap(bool)", asMETHOD(Terrain, SetClipmap), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "bool get_clipmap() const", asMETHOD(Terrain, GetClipmap), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "TerrainClipmap@+ get_clipmapDrawable() const", asMETHOD(Terrain, GetClipmapDrawable), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "void set_heightMap(Image@+)", asMETHOD(Terrain, SetHeightMap), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "Image@+ get_heightMap() const", asMETHOD(Terrain, GetHeightMap), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "void set_patchSize(int)", asMETHOD(Terrain, SetPatchSize), asCALL_THISCALL);
@@ -1854,6 +2046,50 @@ static void RegisterTerrain(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Terrain", "Terrain@+ get_eastNeighbor() const", asMETHOD(Terrain, GetWestNeighbor), asCALL_THISCALL);
 }
 
+static void RegisterTerrainStreamer(asIScriptEngine* engine)
+{
+    RegisterComponent<TerrainStreamer>(engine, "TerrainStreamer");
+    engine->RegisterObjectMethod("TerrainStreamer", "void AddStreamingObserver(Node@+)", asMETHOD(TerrainStreamer, AddStreamingObserver), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void RemoveStreamingObserver(Node@+)", asMETHOD(TerrainStreamer, RemoveStreamingObserver), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void UnloadTiles()", asMETHOD(TerrainStreamer, UnloadTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "IntVector2 GetTileCoordinates(const Vector3&in) const", asMETHOD(TerrainStreamer, GetTileCoordinates), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "Terrain@+ GetTile(const IntVector2&in) const", asMETHOD(TerrainStreamer, GetTile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "float GetHeight(const Vector3&in) const", asMETHOD(TerrainStreamer, GetHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_heightMapPath(const String&in)", asMETHOD(TerrainStreamer, SetHeightMapPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "const String& get_heightMapPath() const", asMETHOD(TerrainStreamer, GetHeightMapPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_heightMapExtension(const String&in)", asMETHOD(TerrainStreamer, SetHeightMapExtension), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "const String& get_heightMapExtension() const", asMETHOD(TerrainStreamer, GetHeightMapExtension), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_numTiles(const IntVector2&in)", asMETHOD(TerrainStreamer, SetNumTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "const IntVector2& get_numTiles() const", asMETHOD(TerrainStreamer, GetNumTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_tileSize(int)", asMETHOD(TerrainStreamer, SetTileSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "int get_tileSize() const", asMETHOD(TerrainStreamer, GetTileSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_spacing(const Vector3&in)", asMETHOD(TerrainStreamer, SetSpacing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "const Vector3& get_spacing() const", asMETHOD(TerrainStreamer, GetSpacing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_patchSize(int)", asMETHOD(TerrainStreamer, SetPatchSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "int get_patchSize() const", asMETHOD(TerrainStreamer, GetPatchSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_maxLodLevels(uint)", asMETHOD(TerrainStreamer, SetMaxLodLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_maxLodLevels() const", asMETHOD(TerrainStreamer, GetMaxLodLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_material(Material@+)", asMETHOD(TerrainStreamer, SetMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "Material@+ get_material() const", asMETHOD(TerrainStreamer, GetMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_drawDistance(float)", asMETHOD(TerrainStreamer, SetDrawDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "float get_drawDistance() const", asMETHOD(TerrainStreamer, GetDrawDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_castShadows(bool)", asMETHOD(TerrainStreamer, SetCastShadows), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "bool get_castShadows() const", asMETHOD(TerrainStreamer, GetCastShadows), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_streamingDistance(float)", asMETHOD(TerrainStreamer, SetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "float get_streamingDistance() const", asMETHOD(TerrainStreamer, GetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_physics(bool)", asMETHOD(TerrainStreamer, SetPhysics), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "bool get_physics() const", asMETHOD(TerrainStreamer, GetPhysics), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_physicsLodLevel(uint)", asMETHOD(TerrainStreamer, SetPhysicsLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_physicsLodLevel() const", asMETHOD(TerrainStreamer, GetPhysicsLodLevel), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_collisionLayer(uint)", asMETHOD(TerrainStreamer, SetCollisionLayer), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_collisionLayer() const", asMETHOD(TerrainStreamer, GetCollisionLayer), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "void set_collisionMask(uint)", asMETHOD(TerrainStreamer, SetCollisionMask), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_collisionMask() const", asMETHOD(TerrainStreamer, GetCollisionMask), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "Vector2 get_tileWorldSize() const", asMETHOD(TerrainStreamer, GetTileWorldSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_numLoadedTiles() const", asMETHOD(TerrainStreamer, GetNumLoadedTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TerrainStreamer", "uint get_numLoadingTiles() const", asMETHOD(TerrainStreamer, GetNumLoadingTiles), asCALL_THISCALL);
+}
+
 
 static CScriptArray* GraphicsGetResolutions(int monitor, Graphics* ptr)
 {
@@ -1881,6 +2117,22 @@ static void GraphicsPrecacheShadersVectorBuffer(VectorBuffer& buffer, Graphics*
     ptr->PrecacheShaders(buffer);
 }
 
+static ShaderPrecacheLoader* GraphicsPrecacheShadersAsync(File* file, Graphics* ptr)
+{
+    return file ? ptr->PrecacheShadersAsync(*file) : nullptr;
+}
+
+static GPUReadback* GraphicsTakeScreenShotAsync(Graphics* ptr)
+{
+    // The graphics subsystem holds a reference until the readback completes, so returning the raw pointer is safe
+    return ptr->TakeScreenShotAsync().Get();
+}
+
+static GPUReadback* GraphicsReadTextureAsync(Texture2D* texture, unsigned level, Graphics* ptr)
+{
+    return ptr->ReadTextureAsync(texture, level).Get();
+}
+
 static Graphics* GetGraphics()
 {
     return GetScriptContext()->GetSubsystem<Graphics>();
@@ -1888,6 +2140,22 @@ static Graphics* GetGraphics()
 
 static void RegisterGraphics(asIScriptEngine* engine)
 {
+    RegisterRefCounted<GPUReadback>(engine, "GPUReadback");
+    engine->RegisterObjectMethod("GPUReadback", "bool GetImage(Image@+) const", asMETHOD(GPUReadback, GetImage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUReadback", "bool get_ready() const", asMETHOD(GPUReadback, IsReady), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUReadback", "bool get_failed() const", asMETHOD(GPUReadback, IsFailed), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUReadback", "int get_width() const", asMETHOD(GPUReadback, GetWidth), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUReadback", "int get_height() const", asMETHOD(GPUReadback, GetHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("GPUReadback", "uint get_format() const", asMETHOD(GPUReadback, GetFormat), asCALL_THISCALL);
+
+    RegisterObject<ShaderPrecacheLoader>(engine, "ShaderPrecacheLoader");
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "void set_maxFrameTime(int)", asMETHOD(ShaderPrecacheLoader, SetMaxFrameTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "int get_maxFrameTime() const", asMETHOD(ShaderPrecacheLoader, GetMaxFrameTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "uint get_numCombinations() const", asMETHOD(ShaderPrecacheLoader, GetNumCombinations), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "uint get_numLoaded() const", asMETHOD(ShaderPrecacheLoader, GetNumLoaded), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "float get_progress() const", asMETHOD(ShaderPrecacheLoader, GetProgress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ShaderPrecacheLoader", "bool get_finished() const", asMETHOD(ShaderPrecacheLoader, IsFinished), asCALL_THISCALL);
+
     RegisterObject<Graphics>(engine, "Graphics");
     engine->RegisterObjectMethod("Graphics", "bool SetMode(int, int, bool, bool, bool, bool, bool, bool, int, int, int)", asMETHODPR(Graphics, SetMode, (int, int, bool, bool, bool, bool, bool, bool, int, int, int), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool SetMode(int, int)", asMETHODPR(Graphics, SetMode, (int, int), bool), asCALL_THISCALL);
@@ -1898,10 +2166,14 @@ static void RegisterGraphics(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Graphics", "void Raise()", asMETHOD(Graphics, Raise), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void Close()", asMETHOD(Graphics, Close), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool TakeScreenShot(Image@+)", asMETHOD(Graphics, TakeScreenShot), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "GPUReadback@+ TakeScreenShotAsync()", asFUNCTION(GraphicsTakeScreenShotAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Graphics", "GPUReadback@+ ReadTextureAsync(Texture2D@+, uint level = 0)", asFUNCTION(GraphicsReadTextureAsync), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Graphics", "void BeginDumpShaders(const String&in)", asMETHOD(Graphics, BeginDumpShaders), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void EndDumpShaders()", asMETHOD(Graphics, EndDumpShaders), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void PrecacheShaders(File@+)", asFUNCTION(GraphicsPrecacheShaders), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Graphics", "void PrecacheShaders(VectorBuffer&)", asFUNCTION(GraphicsPrecacheShadersVectorBuffer), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Graphics", "ShaderPrecacheLoader@+ PrecacheShadersAsync(File@+)", asFUNCTION(GraphicsPrecacheShadersAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Graphics", "ShaderPrecacheLoader@+ get_shaderPrecacheLoader() const", asMETHOD(Graphics, GetShaderPrecacheLoader), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void set_windowTitle(const String&in)", asMETHOD(Graphics, SetWindowTitle), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "const String& get_windowTitle() const", asMETHOD(Graphics, GetWindowTitle), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "const String& get_apiName() const", asMETHOD(Graphics, GetApiName), asCALL_THISCALL);
@@ -1914,6 +2186,8 @@ static void RegisterGraphics(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Graphics", "bool get_dither() const", asMETHOD(Graphics, GetDither), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void set_flushGPU(bool)", asMETHOD(Graphics, SetFlushGPU), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool get_flushGPU() const", asMETHOD(Graphics, GetFlushGPU), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "void set_gpuTiming(bool)", asMETHOD(Graphics, SetGPUTiming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "bool get_gpuTiming() const", asMETHOD(Graphics, GetGPUTiming), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void set_orientations(const String&in)", asMETHOD(Graphics, SetOrientations), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "const String& get_orientations() const", asMETHOD(Graphics, GetOrientations), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "void set_shaderCacheDir(const String&in)", asMETHOD(Graphics, SetShaderCacheDir), asCALL_THISCALL);
@@ -1932,6 +2206,10 @@ static void RegisterGraphics(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Graphics", "uint get_numPrimitives() const", asMETHOD(Graphics, GetNumPrimitives), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "uint get_numBatches() const", asMETHOD(Graphics, GetNumBatches), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool get_instancingSupport() const", asMETHOD(Graphics, GetInstancingSupport), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "bool get_multiDrawSupport() const", asMETHOD(Graphics, GetMultiDrawSupport), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "bool get_gpuTimingSupport() const", asMETHOD(Graphics, GetGPUTimingSupport), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "bool get_asyncReadbackSupport() const", asMETHOD(Graphics, GetAsyncReadbackSupport), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Graphics", "bool GetVertexElementTypeSupport(VertexElementType) const", asMETHOD(Graphics, GetVertexElementTypeSupport), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool get_lightPrepassSupport() const", asMETHOD(Graphics, GetLightPrepassSupport), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool get_deferredSupport() const", asMETHOD(Graphics, GetDeferredSupport), asCALL_THISCALL);
     engine->RegisterObjectMethod("Graphics", "bool get_hardwareShadowSupport() const", asMETHOD(Graphics, GetHardwareShadowSupport), asCALL_THISCALL);
@@ -1974,6 +2252,21 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterEnumValue("ShadowQuality", "SHADOWQUALITY_VSM", SHADOWQUALITY_VSM);
     engine->RegisterEnumValue("ShadowQuality", "SHADOWQUALITY_BLUR_VSM", SHADOWQUALITY_BLUR_VSM);
 
+    RegisterObject<TextureStreamer>(engine, "TextureStreamer");
+    engine->RegisterObjectMethod("TextureStreamer", "void set_memoryBudget(uint64)", asMETHOD(TextureStreamer, SetMemoryBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint64 get_memoryBudget() const", asMETHOD(TextureStreamer, GetMemoryBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "void set_maxMipsToSkip(uint)", asMETHOD(TextureStreamer, SetMaxMipsToSkip), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint get_maxMipsToSkip() const", asMETHODPR(TextureStreamer, GetMaxMipsToSkip, () const, unsigned), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "void set_mipBias(float)", asMETHOD(TextureStreamer, SetMipBias), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "float get_mipBias() const", asMETHOD(TextureStreamer, GetMipBias), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "void set_evictionTime(float)", asMETHOD(TextureStreamer, SetEvictionTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "float get_evictionTime() const", asMETHOD(TextureStreamer, GetEvictionTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "void set_maxConcurrentLoads(uint)", asMETHOD(TextureStreamer, SetMaxConcurrentLoads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint get_maxConcurrentLoads() const", asMETHOD(TextureStreamer, GetMaxConcurrentLoads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint get_numTextures() const", asMETHOD(TextureStreamer, GetNumTextures), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint get_numLoads() const", asMETHOD(TextureStreamer, GetNumLoads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TextureStreamer", "uint64 get_memoryUse() const", asMETHOD(TextureStreamer, GetMemoryUse), asCALL_THISCALL);
+
     RegisterObject<Renderer>(engine, "Renderer");
     engine->RegisterObjectMethod("Renderer", "void DrawDebugGeometry(bool) const", asMETHOD(Renderer, DrawDebugGeometry), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void ReloadShaders() const", asMETHOD(Renderer, ReloadShaders), asCALL_THISCALL);
@@ -2018,6 +2311,10 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "int get_vsmMultiSample() const", asMETHOD(Renderer, GetVSMMultiSample), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_maxShadowMaps(int)", asMETHOD(Renderer, SetMaxShadowMaps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "int get_maxShadowMaps() const", asMETHOD(Renderer, GetMaxShadowMaps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_shadowAtlas(bool)", asMETHOD(Renderer, SetShadowAtlas), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_shadowAtlas() const", asMETHOD(Renderer, GetShadowAtlas), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_shadowAtlasSize(int)", asMETHOD(Renderer, SetShadowAtlasSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "int get_shadowAtlasSize() const", asMETHOD(Renderer, GetShadowAtlasSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_reuseShadowMaps(bool)", asMETHOD(Renderer, SetReuseShadowMaps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "bool get_reuseShadowMaps() const", asMETHOD(Renderer, GetReuseShadowMaps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_dynamicInstancing(bool)", asMETHOD(Renderer, SetDynamicInstancing), asCALL_THISCALL);
@@ -2030,18 +2327,45 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "int get_maxSortedInstances() const", asMETHOD(Renderer, GetMaxSortedInstances), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_maxOccluderTriangles(int)", asMETHOD(Renderer, SetMaxOccluderTriangles), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "int get_maxOccluderTriangles() const", asMETHOD(Renderer, GetMaxOccluderTriangles), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_maxRenderSurfaceUpdates(int)", asMETHOD(Renderer, SetMaxRenderSurfaceUpdates), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "int get_maxRenderSurfaceUpdates() const", asMETHOD(Renderer, GetMaxRenderSurfaceUpdates), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_occlusionBufferSize(int)", asMETHOD(Renderer, SetOcclusionBufferSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "int get_occlusionBufferSize() const", asMETHOD(Renderer, GetOcclusionBufferSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_occluderSizeThreshold(float)", asMETHOD(Renderer, SetOccluderSizeThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "float get_occluderSizeThreshold() const", asMETHOD(Renderer, GetOccluderSizeThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_threadedOcclusion(bool)", asMETHOD(Renderer, SetThreadedOcclusion), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "bool get_threadedOcclusion() const", asMETHOD(Renderer, GetThreadedOcclusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_occlusionReprojection(bool)", asMETHOD(Renderer, SetOcclusionReprojection), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_occlusionReprojection() const", asMETHOD(Renderer, GetOcclusionReprojection), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_shareSceneQueries(bool)", asMETHOD(Renderer, SetShareSceneQueries), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_shareSceneQueries() const", asMETHOD(Renderer, GetShareSceneQueries), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_mobileShadowBiasMul(float)", asMETHOD(Renderer, SetMobileShadowBiasMul), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "float get_mobileShadowBiasMul() const", asMETHOD(Renderer, GetMobileShadowBiasMul), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_mobileShadowBiasAdd(float)", asMETHOD(Renderer, SetMobileShadowBiasAdd), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "float get_mobileShadowBiasAdd() const", asMETHOD(Renderer, GetMobileShadowBiasAdd), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_mobileNormalOffsetMul(float)", asMETHOD(Renderer, SetMobileNormalOffsetMul), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "float get_mobileNormalOffsetMul() const", asMETHOD(Renderer, GetMobileNormalOffsetMul), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_textureStreaming(bool)", asMETHOD(Renderer, SetTextureStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_textureStreaming() const", asMETHOD(Renderer, GetTextureStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_textureCompression(bool)", asMETHOD(Renderer, SetTextureCompression), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_textureCompression() const", asMETHOD(Renderer, GetTextureCompression), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_textureCompressionCacheDir(const String&in)", asMETHOD(Renderer, SetTextureCompressionCacheDir), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "const String& get_textureCompressionCacheDir() const", asMETHOD(Renderer, GetTextureCompressionCacheDir), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_clusteredLighting(bool)", asMETHOD(Renderer, SetClusteredLighting), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_clusteredLighting() const", asMETHOD(Renderer, GetClusteredLighting), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_dynamicResolution(bool)", asMETHOD(Renderer, SetDynamicResolution), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_dynamicResolution() const", asMETHOD(Renderer, GetDynamicResolution), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_dynamicResolutionTargetTime(float)", asMETHOD(Renderer, SetDynamicResolutionTargetTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "float get_dynamicResolutionTargetTime() const", asMETHOD(Renderer, GetDynamicResolutionTargetTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_minResolutionScale(float)", asMETHOD(Renderer, SetMinResolutionScale), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "float get_minResolutionScale() const", asMETHOD(Renderer, GetMinResolutionScale), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_maxResolutionScale(float)", asMETHOD(Renderer, SetMaxResolutionScale), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "float get_maxResolutionScale() const", asMETHOD(Renderer, GetMaxResolutionScale), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "float get_resolutionScale() const", asMETHOD(Renderer, GetResolutionScale), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_renderTargetAliasing(bool)", asMETHOD(Renderer, SetRenderTargetAliasing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_renderTargetAliasing() const", asMETHOD(Renderer, GetRenderTargetAliasing), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "uint64 get_renderTargetMemory() const", asMETHOD(Renderer, GetRenderTargetMemory), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "TextureStreamer@+ get_textureStreamer() const", asMETHOD(Renderer, GetTextureStreamer), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numPrimitives() const", asMETHOD(Renderer, GetNumPrimitives), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numBatches() const", asMETHOD(Renderer, GetNumBatches), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numViews() const", asMETHOD(Renderer, GetNumViews), asCALL_THISCALL);
@@ -2215,6 +2539,8 @@ static void RegisterOctree(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Octree", "Array<Drawable@>@ GetAllDrawables(uint8 drawableFlags = DRAWABLE_ANY, uint viewMask = DEFAULT_VIEWMASK)", asFUNCTION(OctreeGetAllDrawables), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Octree", "const BoundingBox& get_worldBoundingBox() const", asMETHODPR(Octree, GetWorldBoundingBox, () const, const BoundingBox&), asCALL_THISCALL);
     engine->RegisterObjectMethod("Octree", "uint get_numLevels() const", asMETHOD(Octree, GetNumLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Octree", "void set_looseFactor(float)", asMETHOD(Octree, SetLooseFactor), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Octree", "float get_looseFactor() const", asMETHOD(Octree, GetLooseFactor), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "Octree@+ get_octree() const", asFUNCTION(SceneGetOctree), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("Octree@+ get_octree()", asFUNCTION(GetOctree), asCALL_CDECL);
 }
@@ -2241,21 +2567,27 @@ void RegisterGraphicsAPI(asIScriptEngine* engine)
     RegisterBuffers(engine);
     RegisterModel(engine);
     RegisterAnimation(engine);
+    RegisterAnimationLodPolicy(engine);
     RegisterDrawable(engine);
     RegisterLight(engine);
     RegisterZone(engine);
     RegisterStaticModel(engine);
     RegisterStaticModelGroup(engine);
+    RegisterAnimatedCrowd(engine);
+    RegisterHLODGroup(engine);
+    RegisterImpostorGroup(engine);
     RegisterSkybox(engine);
     RegisterAnimatedModel(engine);
     RegisterAnimationController(engine);
     RegisterBillboardSet(engine);
     RegisterParticleEffect(engine);
     RegisterParticleEmitter(engine);
+    RegisterGPUParticleEmitter(engine);
     RegisterRibbonTrail(engine);
     RegisterCustomGeometry(engine);
     RegisterDecalSet(engine);
     RegisterTerrain(engine);
+    RegisterTerrainStreamer(engine);
     RegisterOctree(engine);
     RegisterGraphics(engine);
     RegisterRenderer(engine);
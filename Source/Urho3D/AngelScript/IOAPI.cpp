@@ -291,6 +291,14 @@ static unsigned FileSystemSystemRunAsync(const String& fileName, CScriptArray* s
     return ptr->SystemRunAsync(fileName, destArguments);
 }
 
+static unsigned FileSystemReadFilesAsync(CScriptArray* srcFileNames, FileSystem* ptr)
+{
+    if (!srcFileNames)
+        return M_MAX_UNSIGNED;
+
+    return ptr->ReadFilesAsync(ArrayToVector<String>(srcFileNames));
+}
+
 static void RegisterSerialization(asIScriptEngine* engine)
 {
     engine->RegisterEnum("FileMode");
@@ -321,6 +329,7 @@ static void RegisterSerialization(asIScriptEngine* engine)
     engine->RegisterObjectMethod("File", "FileMode get_mode() const", asMETHOD(File, GetMode), asCALL_THISCALL);
     engine->RegisterObjectMethod("File", "bool get_open()", asMETHOD(File, IsOpen), asCALL_THISCALL);
     engine->RegisterObjectMethod("File", "bool get_packaged()", asMETHOD(File, IsPackaged), asCALL_THISCALL);
+    engine->RegisterObjectMethod("File", "bool get_memoryMapped()", asMETHOD(File, IsMemoryMapped), asCALL_THISCALL);
     RegisterSerializer<File>(engine, "File");
     RegisterDeserializer<File>(engine, "File");
 
@@ -371,6 +380,12 @@ void RegisterFileSystem(asIScriptEngine* engine)
     engine->RegisterObjectMethod("FileSystem", "int SystemRun(const String&in, Array<String>@+)", asFUNCTION(FileSystemSystemRun), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("FileSystem", "uint SystemCommandAsync(const String&in)", asMETHOD(FileSystem, SystemCommandAsync), asCALL_THISCALL);
     engine->RegisterObjectMethod("FileSystem", "uint SystemRunAsync(const String&in, Array<String>@+)", asFUNCTION(FileSystemSystemRunAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("FileSystem", "uint ReadFileAsync(const String&in)", asMETHOD(FileSystem, ReadFileAsync), asCALL_THISCALL);
+    engine->RegisterObjectMethod("FileSystem", "uint ReadFilesAsync(Array<String>@+)", asFUNCTION(FileSystemReadFilesAsync), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("FileSystem", "uint ScanDirAsync(const String&in, const String&in, uint, bool)", asMETHOD(FileSystem, ScanDirAsync), asCALL_THISCALL);
+    engine->RegisterObjectMethod("FileSystem", "void set_numAsyncIOThreads(uint)", asMETHOD(FileSystem, SetNumAsyncIOThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("FileSystem", "uint get_numAsyncIOThreads() const", asMETHOD(FileSystem, GetNumAsyncIOThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("FileSystem", "uint get_numAsyncIORequests() const", asMETHOD(FileSystem, GetNumAsyncIORequests), asCALL_THISCALL);
     engine->RegisterObjectMethod("FileSystem", "bool SystemOpen(const String&in, const String&in)", asMETHOD(FileSystem, SystemOpen), asCALL_THISCALL);
     engine->RegisterObjectMethod("FileSystem", "bool Copy(const String&in, const String&in)", asMETHOD(FileSystem, Copy), asCALL_THISCALL);
     engine->RegisterObjectMethod("FileSystem", "bool Rename(const String&in, const String&in)", asMETHOD(FileSystem, Rename), asCALL_THISCALL);
@@ -425,6 +440,8 @@ static void RegisterPackageFile(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PackageFile", "uint get_totalDataSize() const", asMETHOD(PackageFile, GetTotalDataSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("PackageFile", "uint get_checksum() const", asMETHOD(PackageFile, GetChecksum), asCALL_THISCALL);
     engine->RegisterObjectMethod("PackageFile", "bool compressed() const", asMETHOD(PackageFile, IsCompressed), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PackageFile", "void set_memoryMapped(bool)", asMETHOD(PackageFile, SetMemoryMapped), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PackageFile", "bool get_memoryMapped() const", asMETHOD(PackageFile, IsMemoryMapped), asCALL_THISCALL);
     engine->RegisterObjectMethod("PackageFile", "Array<String>@ GetEntryNames() const", asFUNCTION(PackageFileGetEntryNames), asCALL_CDECL_OBJLAST);
 }
 
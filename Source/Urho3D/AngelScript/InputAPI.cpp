@@ -648,6 +648,17 @@ static void InputSetMouseGrabbed(bool enable, Input* ptr)
     ptr->SetMouseGrabbed(enable, false);
 }
 
+static unsigned InputGetNumRawInputEvents(Input* ptr)
+{
+    return ptr->GetRawInputEvents().Size();
+}
+
+static RawInputEvent* InputGetRawInputEvent(unsigned index, Input* ptr)
+{
+    const PODVector<RawInputEvent>& events = ptr->GetRawInputEvents();
+    return index < events.Size() ? const_cast<RawInputEvent*>(&events[index]) : nullptr;
+}
+
 static void RegisterInput(asIScriptEngine* engine)
 {
     engine->RegisterEnum("MouseMode");
@@ -665,6 +676,32 @@ static void RegisterInput(asIScriptEngine* engine)
     engine->RegisterObjectProperty("TouchState", "const IntVector2 delta", offsetof(TouchState, delta_));
     engine->RegisterObjectProperty("TouchState", "const float pressure", offsetof(TouchState, pressure_));
 
+    engine->RegisterEnum("RawInputType");
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_KEYDOWN", RAWINPUT_KEYDOWN);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_KEYUP", RAWINPUT_KEYUP);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_MOUSEBUTTONDOWN", RAWINPUT_MOUSEBUTTONDOWN);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_MOUSEBUTTONUP", RAWINPUT_MOUSEBUTTONUP);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_MOUSEMOVE", RAWINPUT_MOUSEMOVE);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_MOUSEWHEEL", RAWINPUT_MOUSEWHEEL);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_TOUCHBEGIN", RAWINPUT_TOUCHBEGIN);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_TOUCHMOVE", RAWINPUT_TOUCHMOVE);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_TOUCHEND", RAWINPUT_TOUCHEND);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_JOYSTICKBUTTONDOWN", RAWINPUT_JOYSTICKBUTTONDOWN);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_JOYSTICKBUTTONUP", RAWINPUT_JOYSTICKBUTTONUP);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_JOYSTICKAXISMOVE", RAWINPUT_JOYSTICKAXISMOVE);
+    engine->RegisterEnumValue("RawInputType", "RAWINPUT_JOYSTICKHATMOVE", RAWINPUT_JOYSTICKHATMOVE);
+
+    engine->RegisterObjectType("RawInputEvent", 0, asOBJ_REF);
+    engine->RegisterObjectBehaviour("RawInputEvent", asBEHAVE_ADDREF, "void f()", asFUNCTION(FakeAddRef), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("RawInputEvent", asBEHAVE_RELEASE, "void f()", asFUNCTION(FakeReleaseRef), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectProperty("RawInputEvent", "const RawInputType type", offsetof(RawInputEvent, type_));
+    engine->RegisterObjectProperty("RawInputEvent", "const uint timestamp", offsetof(RawInputEvent, timestamp_));
+    engine->RegisterObjectProperty("RawInputEvent", "const int id", offsetof(RawInputEvent, id_));
+    engine->RegisterObjectProperty("RawInputEvent", "const int index", offsetof(RawInputEvent, index_));
+    engine->RegisterObjectProperty("RawInputEvent", "const IntVector2 position", offsetof(RawInputEvent, position_));
+    engine->RegisterObjectProperty("RawInputEvent", "const IntVector2 delta", offsetof(RawInputEvent, delta_));
+    engine->RegisterObjectProperty("RawInputEvent", "const float value", offsetof(RawInputEvent, value_));
+
     engine->RegisterObjectType("JoystickState", 0, asOBJ_REF);
     engine->RegisterObjectBehaviour("JoystickState", asBEHAVE_ADDREF, "void f()", asFUNCTION(FakeAddRef), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectBehaviour("JoystickState", asBEHAVE_RELEASE, "void f()", asFUNCTION(FakeReleaseRef), asCALL_CDECL_OBJLAST);
@@ -718,6 +755,13 @@ static void RegisterInput(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Input", "bool get_screenKeyboardSupport() const", asMETHOD(Input, GetScreenKeyboardSupport), asCALL_THISCALL);
     engine->RegisterObjectMethod("Input", "void set_touchEmulation(bool)", asMETHOD(Input, SetTouchEmulation), asCALL_THISCALL);
     engine->RegisterObjectMethod("Input", "bool get_touchEmulation() const", asMETHOD(Input, GetTouchEmulation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Input", "void set_coalesceMoveEvents(bool)", asMETHOD(Input, SetCoalesceMoveEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Input", "bool get_coalesceMoveEvents() const", asMETHOD(Input, GetCoalesceMoveEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Input", "void set_rawInputBufferSize(uint)", asMETHOD(Input, SetRawInputBufferSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Input", "uint get_rawInputBufferSize() const", asMETHOD(Input, GetRawInputBufferSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Input", "uint get_numRawInputEvents() const", asFUNCTION(InputGetNumRawInputEvents), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Input", "RawInputEvent@+ get_rawInputEvents(uint) const", asFUNCTION(InputGetRawInputEvent), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Input", "uint get_numDroppedRawInputEvents() const", asMETHOD(Input, GetNumDroppedRawInputEvents), asCALL_THISCALL);
     engine->RegisterObjectMethod("Input", "void set_toggleFullscreen(bool)", asMETHOD(Input, SetToggleFullscreen), asCALL_THISCALL);
     engine->RegisterObjectMethod("Input", "bool get_toggleFullscreen() const", asMETHOD(Input, GetToggleFullscreen), asCALL_THISCALL);
     engine->RegisterObjectMethod("Input", "bool get_keyDown(int) const", asMETHOD(Input, GetKeyDown), asCALL_THISCALL);
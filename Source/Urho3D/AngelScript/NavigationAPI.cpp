@@ -84,6 +84,11 @@ static bool NavigationMeshAddTile(const VectorBuffer& tileData, NavigationMesh*
     return ptr->AddTile(tileData.GetBuffer());
 }
 
+static unsigned NavigationMeshRequestPath(const Vector3& start, const Vector3& end, const Vector3& extents, NavigationMesh* ptr)
+{
+    return ptr->RequestPath(start, end, extents);
+}
+
 static Vector3 NavigationMeshGetRandomPoint(NavigationMesh* ptr)
 {
     return ptr->GetRandomPoint();
@@ -120,6 +125,7 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "bool Build()", asMETHODPR(T, Build, (), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const BoundingBox&in)", asMETHODPR(T, Build, (const BoundingBox&), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const IntVector2&, const IntVector2&)", asMETHODPR(T, Build, (const IntVector2&, const IntVector2&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void CompleteBackgroundBuild()", asMETHOD(T, CompleteBackgroundBuild), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "VectorBuffer GetTileData(const IntVector2&) const", asFUNCTION(NavigationMeshGetTileData), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "bool AddTile(const VectorBuffer&in) const", asFUNCTION(NavigationMeshAddTile), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "void RemoveTile(const IntVector2&)", asMETHOD(T, RemoveTile), asCALL_THISCALL);
@@ -131,6 +137,8 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "float GetAreaCost(uint) const", asMETHOD(T, GetAreaCost), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "Vector3 FindNearestPoint(const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshFindNearestPoint), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "Vector3 MoveAlongSurface(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0), int maxVisited = 3)", asFUNCTION(NavigationMeshMoveAlongSurface), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "uint RequestPath(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshRequestPath), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "bool CancelPathRequest(uint)", asMETHOD(T, CancelPathRequest), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "Vector3 GetRandomPoint()", asFUNCTION(NavigationMeshGetRandomPoint), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "Vector3 GetRandomPointInCircle(const Vector3&in, float, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshGetRandomPointInCircle), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "float GetDistanceToWall(const Vector3&in, float, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshGetDistanceToWall), asCALL_CDECL_OBJLAST);
@@ -174,6 +182,27 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "bool get_drawOffMeshConnections() const", asMETHOD(T, GetDrawOffMeshConnections), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_drawNavAreas(bool)", asMETHOD(T, SetDrawNavAreas), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool get_drawNavAreas() const", asMETHOD(T, GetDrawNavAreas), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_backgroundBuild(bool)", asMETHOD(T, SetBackgroundBuild), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool get_backgroundBuild() const", asMETHOD(T, GetBackgroundBuild), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPendingTiles() const", asMETHOD(T, GetNumPendingTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_pathIterationBudget(uint)", asMETHOD(T, SetPathIterationBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_pathIterationBudget() const", asMETHOD(T, GetPathIterationBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPendingPaths() const", asMETHOD(T, GetNumPendingPaths), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_hierarchicalPathThreshold(uint)", asMETHOD(T, SetHierarchicalPathThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_hierarchicalPathThreshold() const", asMETHOD(T, GetHierarchicalPathThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void UpdatePathGraph()", asMETHOD(T, UpdatePathGraph), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPathGraphRegions() const", asMETHOD(T, GetNumPathGraphRegions), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_streamingPath(const String&in)", asMETHOD(T, SetStreamingPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "const String& get_streamingPath() const", asMETHOD(T, GetStreamingPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_streamingRegionSize(int)", asMETHOD(T, SetStreamingRegionSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "int get_streamingRegionSize() const", asMETHOD(T, GetStreamingRegionSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_streamingDistance(float)", asMETHOD(T, SetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "float get_streamingDistance() const", asMETHOD(T, GetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void AddStreamingObserver(Node@+)", asMETHOD(T, AddStreamingObserver), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void RemoveStreamingObserver(Node@+)", asMETHOD(T, RemoveStreamingObserver), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool SaveRegions(const String&in) const", asMETHOD(T, SaveRegions), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "IntVector2 get_numStreamingRegions() const", asMETHOD(T, GetNumStreamingRegions), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numStreamedRegions() const", asMETHOD(T, GetNumStreamedRegions), asCALL_THISCALL);
 }
 
 void RegisterNavigationMesh(asIScriptEngine* engine)
@@ -280,6 +309,13 @@ void RegisterCrowdManager(asIScriptEngine* engine)
     engine->RegisterObjectMethod("CrowdManager", "uint get_numQueryFilterTypes() const", asMETHOD(CrowdManager, GetNumQueryFilterTypes), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "uint get_numAreas(uint) const", asMETHOD(CrowdManager, GetNumAreas), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "uint get_numObstacleAvoidanceTypes() const", asMETHOD(CrowdManager, GetNumObstacleAvoidanceTypes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_lodDistance(float)", asMETHOD(CrowdManager, SetLodDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "float get_lodDistance() const", asMETHOD(CrowdManager, GetLodDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_lodUpdateInterval(uint)", asMETHOD(CrowdManager, SetLodUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "uint get_lodUpdateInterval() const", asMETHOD(CrowdManager, GetLodUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_invisibleUpdateInterval(uint)", asMETHOD(CrowdManager, SetInvisibleUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "uint get_invisibleUpdateInterval() const", asMETHOD(CrowdManager, GetInvisibleUpdateInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "uint get_numLodAgents() const", asMETHOD(CrowdManager, GetNumLodAgents), asCALL_THISCALL);
 }
 
 void RegisterCrowdAgent(asIScriptEngine* engine)
@@ -86,6 +86,8 @@ static void RegisterConnection(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Connection", "const Vector3& get_position() const", asMETHOD(Connection, GetPosition), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "void set_rotation(const Quaternion&in)", asMETHOD(Connection, SetRotation), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "const Quaternion& get_rotation() const", asMETHOD(Connection, GetRotation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "void set_interestRadius(float)", asMETHOD(Connection, SetInterestRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "float get_interestRadius() const", asMETHOD(Connection, GetInterestRadius), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "void SendPackageToClient(PackageFile@+)", asMETHOD(Connection, SendPackageToClient), asCALL_THISCALL);
     engine->RegisterObjectProperty("Connection", "Controls controls", offsetof(Connection, controls_));
     engine->RegisterObjectProperty("Connection", "uint8 timeStamp", offsetof(Connection, timeStamp_));
@@ -112,6 +114,7 @@ static void RegisterHttpRequest(asIScriptEngine* engine)
     engine->RegisterObjectMethod("HttpRequest", "HttpRequestState get_state() const", asMETHOD(HttpRequest, GetState), asCALL_THISCALL);
     engine->RegisterObjectMethod("HttpRequest", "uint get_availableSize() const", asMETHOD(HttpRequest, GetAvailableSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("HttpRequest", "bool get_open() const", asMETHOD(HttpRequest, IsOpen), asCALL_THISCALL);
+    engine->RegisterObjectMethod("HttpRequest", "bool get_pooled() const", asMETHOD(HttpRequest, IsPooled), asCALL_THISCALL);
 }
 
 static Network* GetNetwork()
@@ -150,6 +153,16 @@ static void NetworkUnregisterRemoteEvent(const String& eventType, Network* ptr)
     ptr->UnregisterRemoteEvent(eventType);
 }
 
+static void NetworkRegisterRemoteEventSchema(const String& eventType, const VariantMap& parameters, Network* ptr)
+{
+    ptr->RegisterRemoteEventSchema(eventType, parameters);
+}
+
+static void NetworkUnregisterRemoteEventSchema(const String& eventType, Network* ptr)
+{
+    ptr->UnregisterRemoteEventSchema(eventType);
+}
+
 static bool NetworkCheckRemoteEvent(const String& eventType, Network* ptr)
 {
     return ptr->CheckRemoteEvent(eventType);
@@ -165,12 +178,22 @@ static HttpRequest* NetworkMakeHttpRequest(const String& url, const String& verb
     return request.Get();
 }
 
+static bool NetworkSaveTrafficStats(File* file, unsigned numWindows, Network* ptr)
+{
+    return file && ptr->SaveTrafficStats(*file, numWindows);
+}
+
+static bool NetworkSaveTrafficStatsVectorBuffer(VectorBuffer& buffer, unsigned numWindows, Network* ptr)
+{
+    return ptr->SaveTrafficStats(buffer, numWindows);
+}
+
 void RegisterNetwork(asIScriptEngine* engine)
 {
     RegisterObject<Network>(engine, "Network");
     engine->RegisterObjectMethod("Network", "bool Connect(const String&in, uint16, Scene@+, const VariantMap&in identity = VariantMap())", asMETHOD(Network, Connect), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void Disconnect(int waitMSec = 0)", asMETHOD(Network, Disconnect), asCALL_THISCALL);
-    engine->RegisterObjectMethod("Network", "bool StartServer(uint16)", asMETHOD(Network, StartServer), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool StartServer(uint16, uint maxConnections = 128)", asMETHOD(Network, StartServer), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "bool DiscoverHosts(uint16)", asMETHOD(Network, DiscoverHosts), asCALL_THISCALL);
 	engine->RegisterObjectMethod("Network", "bool SetDiscoveryBeacon(const VariantMap&in data = VariantMap())", asMETHOD(Network, SetDiscoveryBeacon), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "bool SetPassword(const String&password)", asMETHOD(Network, SetPassword), asCALL_THISCALL);
@@ -186,11 +209,28 @@ void RegisterNetwork(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Network", "void RegisterRemoteEvent(const String&in) const", asFUNCTION(NetworkRegisterRemoteEvent), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Network", "void UnregisterRemoteEvent(const String&in) const", asFUNCTION(NetworkUnregisterRemoteEvent), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Network", "void UnregisterAllRemoteEvents()", asMETHOD(Network, UnregisterAllRemoteEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void RegisterRemoteEventSchema(const String&in, const VariantMap&in)", asFUNCTION(NetworkRegisterRemoteEventSchema), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Network", "void UnregisterRemoteEventSchema(const String&in)", asFUNCTION(NetworkUnregisterRemoteEventSchema), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Network", "bool CheckRemoteEvent(const String&in) const", asFUNCTION(NetworkCheckRemoteEvent), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Network", "HttpRequest@ MakeHttpRequest(const String&in, const String&in verb = String(), Array<String>@+ headers = null, const String&in postData = String())", asFUNCTION(NetworkMakeHttpRequest), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Network", "void SendPackageToClients(Scene@+, PackageFile@+)", asMETHOD(Network, SendPackageToClients), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void set_updateFps(int)", asMETHOD(Network, SetUpdateFps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "int get_updateFps() const", asMETHOD(Network, GetUpdateFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_threadedServerUpdate(bool)", asMETHOD(Network, SetThreadedServerUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool get_threadedServerUpdate() const", asMETHOD(Network, GetThreadedServerUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_messageBatching(bool)", asMETHOD(Network, SetMessageBatching), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool get_messageBatching() const", asMETHOD(Network, GetMessageBatching), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_compression(bool)", asMETHOD(Network, SetCompression), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool get_compression() const", asMETHOD(Network, GetCompression), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_compressionThreshold(uint)", asMETHOD(Network, SetCompressionThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "uint get_compressionThreshold() const", asMETHOD(Network, GetCompressionThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_httpThreads(uint)", asMETHOD(Network, SetHttpThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool SaveTrafficStats(File@+, uint numWindows = 10) const", asFUNCTION(NetworkSaveTrafficStats), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Network", "bool SaveTrafficStats(VectorBuffer&, uint numWindows = 10) const", asFUNCTION(NetworkSaveTrafficStatsVectorBuffer), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Network", "String PrintTrafficStats(uint maxRows = 5, uint numWindows = 10) const", asMETHOD(Network, PrintTrafficStats), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_trafficProfiling(bool)", asMETHOD(Network, SetTrafficProfiling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool get_trafficProfiling() const", asMETHOD(Network, GetTrafficProfiling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "uint get_httpThreads() const", asMETHOD(Network, GetHttpThreads), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void set_simulatedLatency(int)", asMETHOD(Network, SetSimulatedLatency), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "int get_simulatedLatency() const", asMETHOD(Network, GetSimulatedLatency), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void set_simulatedPacketLoss(float)", asMETHOD(Network, SetSimulatedPacketLoss), asCALL_THISCALL);
@@ -250,6 +250,22 @@ static PhysicsRaycastResult PhysicsWorldRaycastSingleSegmented(const Ray& ray, f
     return result;
 }
 
+static CScriptArray* PhysicsWorldRaycastSingleBatch(CScriptArray* rays, float maxDistance, float radius, unsigned collisionMask, PhysicsWorld* ptr)
+{
+    PODVector<Ray> rayVector = ArrayToPODVector<Ray>(rays);
+    PODVector<PhysicsRaycastQuery> queries(rayVector.Size());
+    for (unsigned i = 0; i < rayVector.Size(); ++i)
+    {
+        queries[i].ray_ = rayVector[i];
+        queries[i].maxDistance_ = maxDistance;
+        queries[i].radius_ = radius;
+        queries[i].collisionMask_ = collisionMask;
+    }
+    PODVector<PhysicsRaycastResult> result;
+    ptr->RaycastSingleBatch(result, queries);
+    return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
+}
+
 static PhysicsRaycastResult PhysicsWorldSphereCast(const Ray& ray, float radius, float maxDistance, unsigned collisionMask, PhysicsWorld* ptr)
 {
     PhysicsRaycastResult result;
@@ -307,12 +323,20 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectProperty("PhysicsRaycastResult", "float hitFraction", offsetof(PhysicsRaycastResult, hitFraction_));
     engine->RegisterObjectMethod("PhysicsRaycastResult", "RigidBody@+ get_body() const", asFUNCTION(PhysicsRaycastResultGetRigidBody), asCALL_CDECL_OBJLAST);
 
+    engine->RegisterObjectType("PhysicsStepStats", sizeof(PhysicsStepStats), asOBJ_VALUE | asOBJ_POD | asGetTypeTraits<PhysicsStepStats>() | asOBJ_APP_CLASS_ALLINTS);
+    engine->RegisterObjectProperty("PhysicsStepStats", "uint numActiveBodies", offsetof(PhysicsStepStats, numActiveBodies_));
+    engine->RegisterObjectProperty("PhysicsStepStats", "uint numOverlappingPairs", offsetof(PhysicsStepStats, numOverlappingPairs_));
+    engine->RegisterObjectProperty("PhysicsStepStats", "uint numManifolds", offsetof(PhysicsStepStats, numManifolds_));
+    engine->RegisterObjectProperty("PhysicsStepStats", "uint numTouchingManifolds", offsetof(PhysicsStepStats, numTouchingManifolds_));
+    engine->RegisterObjectProperty("PhysicsStepStats", "uint numCcdHits", offsetof(PhysicsStepStats, numCcdHits_));
+
     RegisterComponent<PhysicsWorld>(engine, "PhysicsWorld");
     engine->RegisterObjectMethod("PhysicsWorld", "void Update(float)", asMETHOD(PhysicsWorld, Update), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void UpdateCollisions()", asMETHOD(PhysicsWorld, UpdateCollisions), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ Raycast(const Ray&in, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycast), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingle(const Ray&in, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingle), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingleSegmented(const Ray&in, float, float, uint collisionMask = 0xffff, float overlapDistance = 0.1f)", asFUNCTION(PhysicsWorldRaycastSingleSegmented), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ RaycastSingleBatch(Array<Ray>@+, float, float radius = 0.0, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingleBatch), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult SphereCast(const Ray&in, float, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldSphereCast), asCALL_CDECL_OBJLAST);
     // There seems to be a bug in AngelScript resulting in a crash if we use an auto handle with this function.
     // Work around by manually releasing the CollisionShape handle
@@ -339,6 +363,38 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_internalEdge() const", asMETHOD(PhysicsWorld, GetInternalEdge), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void set_splitImpulse(bool)", asMETHOD(PhysicsWorld, SetSplitImpulse), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_splitImpulse() const", asMETHOD(PhysicsWorld, GetSplitImpulse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool BeginRewind(uint)", asMETHOD(PhysicsWorld, BeginRewind), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void EndRewind()", asMETHOD(PhysicsWorld, EndRewind), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint GetHistoryStepAt(float) const", asMETHOD(PhysicsWorld, GetHistoryStepAt), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_geometryCacheDir(const String&in)", asMETHOD(PhysicsWorld, SetGeometryCacheDir), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "const String& get_geometryCacheDir() const", asMETHOD(PhysicsWorld, GetGeometryCacheDir), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_syncPositionThreshold(float)", asMETHOD(PhysicsWorld, SetSyncPositionThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "float get_syncPositionThreshold() const", asMETHOD(PhysicsWorld, GetSyncPositionThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_syncRotationThreshold(float)", asMETHOD(PhysicsWorld, SetSyncRotationThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "float get_syncRotationThreshold() const", asMETHOD(PhysicsWorld, GetSyncRotationThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_numSyncedTransforms() const", asMETHOD(PhysicsWorld, GetNumSyncedTransforms), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_collisionEvents(bool)", asMETHOD(PhysicsWorld, SetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_collisionEvents() const", asMETHOD(PhysicsWorld, GetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_contactStream(bool)", asMETHOD(PhysicsWorld, SetContactStream), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_contactStream() const", asMETHOD(PhysicsWorld, GetContactStream), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void WaitForAsyncStep()", asMETHOD(PhysicsWorld, WaitForAsyncStep), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_asyncUpdate(bool)", asMETHOD(PhysicsWorld, SetAsyncUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_asyncUpdate() const", asMETHOD(PhysicsWorld, GetAsyncUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_stepInProgress() const", asMETHOD(PhysicsWorld, IsStepInProgress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_transformHistoryLength(uint)", asMETHOD(PhysicsWorld, SetTransformHistoryLength), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_transformHistoryLength() const", asMETHOD(PhysicsWorld, GetTransformHistoryLength), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_historyStep() const", asMETHOD(PhysicsWorld, GetHistoryStep), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_rewinding() const", asMETHOD(PhysicsWorld, IsRewinding), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_drawIslands(bool)", asMETHOD(PhysicsWorld, SetDrawIslands), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_drawIslands() const", asMETHOD(PhysicsWorld, GetDrawIslands), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "const PhysicsStepStats& get_stepStats() const", asMETHOD(PhysicsWorld, GetStepStats), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_staticBatching(bool)", asMETHOD(PhysicsWorld, SetStaticBatching), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_staticBatching() const", asMETHOD(PhysicsWorld, GetStaticBatching), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_staticBatchCellSize(float)", asMETHOD(PhysicsWorld, SetStaticBatchCellSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "float get_staticBatchCellSize() const", asMETHOD(PhysicsWorld, GetStaticBatchCellSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void RebuildStaticBatches()", asMETHOD(PhysicsWorld, RebuildStaticBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_numStaticBatches() const", asMETHOD(PhysicsWorld, GetNumStaticBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_numBatchedBodies() const", asMETHOD(PhysicsWorld, GetNumBatchedBodies), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "PhysicsWorld@+ get_physicsWorld() const", asFUNCTION(SceneGetPhysicsWorld), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("PhysicsWorld@+ get_physicsWorld()", asFUNCTION(GetPhysicsWorld), asCALL_CDECL);
 }
@@ -116,11 +116,21 @@ static bool ResourceCacheBackgroundLoadResource(const String& type, const String
     return ptr->BackgroundLoadResource(type, name, sendEventOnFailure);
 }
 
+static bool ResourceCacheSaveLoadList(File* file, ResourceCache* ptr)
+{
+    return file && ptr->SaveLoadList(*file);
+}
+
 static Localization* GetLocalization()
 {
     return GetScriptContext()->GetSubsystem<Localization>();
 }
 
+static bool LocalizationSaveBinaryFile(File* file, const String& language, Localization* ptr)
+{
+    return file && ptr->SaveBinaryFile(*file, language);
+}
+
 static void RegisterLocalization(asIScriptEngine* engine)
 {
     RegisterObject<Localization>(engine, "Localization");
@@ -136,6 +146,8 @@ static void RegisterLocalization(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Localization", "void LoadMultipleLanguageJSON(const JSONValue&in)", asMETHOD(Localization, LoadMultipleLanguageJSON), asCALL_THISCALL);
     engine->RegisterObjectMethod("Localization", "void LoadSingleLanguageJSON(const JSONValue&in, const String&language = String(\"\") const)", asMETHOD(Localization, LoadSingleLanguageJSON), asCALL_THISCALL);
     engine->RegisterObjectMethod("Localization", "void LoadJSONFile(const String&in, const String language = String(\"\") const)", asMETHOD(Localization, LoadJSONFile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Localization", "void LoadBinaryFile(const String&in, const String&in)", asMETHOD(Localization, LoadBinaryFile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Localization", "bool SaveBinaryFile(File@+, const String&in) const", asFUNCTION(LocalizationSaveBinaryFile), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("Localization@+ get_localization()", asFUNCTION(GetLocalization), asCALL_CDECL);
 }
 
@@ -176,6 +188,8 @@ static void RegisterResourceCache(asIScriptEngine* engine)
     engine->RegisterObjectMethod("ResourceCache", "Array<String>@ get_resourceDirs() const", asFUNCTION(ResourceCacheGetResourceDirs), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("ResourceCache", "Array<PackageFile@>@ get_packageFiles() const", asFUNCTION(ResourceCacheGetPackageFiles), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("ResourceCache", "void set_searchPackagesFirst(bool)", asMETHOD(ResourceCache, SetSearchPackagesFirst), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void set_memoryMappedPackages(bool)", asMETHOD(ResourceCache, SetMemoryMappedPackages), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool get_memoryMappedPackages() const", asMETHOD(ResourceCache, GetMemoryMappedPackages), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "bool get_seachPackagesFirst() const", asMETHOD(ResourceCache, GetSearchPackagesFirst), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "void set_autoReloadResources(bool)", asMETHOD(ResourceCache, SetAutoReloadResources), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "bool get_autoReloadResources() const", asMETHOD(ResourceCache, GetAutoReloadResources), asCALL_THISCALL);
@@ -183,6 +197,20 @@ static void RegisterResourceCache(asIScriptEngine* engine)
     engine->RegisterObjectMethod("ResourceCache", "bool get_returnFailedResources() const", asMETHOD(ResourceCache, GetReturnFailedResources), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "void set_finishBackgroundResourcesMs(int)", asMETHOD(ResourceCache, SetFinishBackgroundResourcesMs), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "int get_finishBackgroundResourcesMs() const", asMETHOD(ResourceCache, GetFinishBackgroundResourcesMs), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void set_backgroundLoadThreads(uint)", asMETHOD(ResourceCache, SetBackgroundLoadThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "uint get_backgroundLoadThreads() const", asMETHOD(ResourceCache, GetBackgroundLoadThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void BuildResourceIndex()", asMETHOD(ResourceCache, BuildResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void ClearResourceIndex()", asMETHOD(ResourceCache, ClearResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool SaveResourceIndex(const String&in) const", asMETHOD(ResourceCache, SaveResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool LoadResourceIndex(const String&in)", asMETHOD(ResourceCache, LoadResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void set_resourceIndex(bool)", asMETHOD(ResourceCache, SetResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool get_resourceIndex() const", asMETHOD(ResourceCache, GetResourceIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "uint get_resourceIndexSize() const", asMETHOD(ResourceCache, GetResourceIndexSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void set_loadProfiling(bool)", asMETHOD(ResourceCache, SetLoadProfiling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool get_loadProfiling() const", asMETHOD(ResourceCache, GetLoadProfiling), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "void ClearLoadRecords()", asMETHOD(ResourceCache, ClearLoadRecords), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ResourceCache", "bool SaveLoadList(File@+) const", asFUNCTION(ResourceCacheSaveLoadList), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("ResourceCache", "String GetLoadProfileReport(uint maxResources = 20) const", asMETHOD(ResourceCache, GetLoadProfileReport), asCALL_THISCALL);
     engine->RegisterObjectMethod("ResourceCache", "uint get_numBackgroundLoadResources() const", asMETHOD(ResourceCache, GetNumBackgroundLoadResources), asCALL_THISCALL);
     engine->RegisterGlobalFunction("ResourceCache@+ get_resourceCache()", asFUNCTION(GetResourceCache), asCALL_CDECL);
     engine->RegisterGlobalFunction("ResourceCache@+ get_cache()", asFUNCTION(GetResourceCache), asCALL_CDECL);
@@ -212,6 +240,11 @@ static void RegisterImage(asIScriptEngine* engine)
     engine->RegisterEnumValue("CompressedFormat", "CF_PVRTC_RGB_4BPP", 8);
     engine->RegisterEnumValue("CompressedFormat", "CF_PVRTC_RGBA_4BPP", 9);
 
+    engine->RegisterEnum("ResampleFilter");
+    engine->RegisterEnumValue("ResampleFilter", "RESAMPLE_BILINEAR", RESAMPLE_BILINEAR);
+    engine->RegisterEnumValue("ResampleFilter", "RESAMPLE_BOX", RESAMPLE_BOX);
+    engine->RegisterEnumValue("ResampleFilter", "RESAMPLE_LANCZOS", RESAMPLE_LANCZOS);
+
     RegisterResource<Image>(engine, "Image");
     engine->RegisterObjectMethod("Image", "bool SetSize(int, int, uint)", asMETHODPR(Image, SetSize, (int, int, unsigned), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Image", "bool SetSize(int, int, int, uint)", asMETHODPR(Image, SetSize, (int, int, unsigned), bool), asCALL_THISCALL);
@@ -223,7 +256,8 @@ static void RegisterImage(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Image", "bool LoadColorLUT(VectorBuffer&)", asFUNCTION(ImageLoadColorLUTVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Image", "bool FlipHorizontal()", asMETHOD(Image, FlipHorizontal), asCALL_THISCALL);
     engine->RegisterObjectMethod("Image", "bool FlipVertical()", asMETHOD(Image, FlipVertical), asCALL_THISCALL);
-    engine->RegisterObjectMethod("Image", "bool Resize(int, int)", asMETHOD(Image, Resize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Image", "bool Resize(int, int, ResampleFilter = RESAMPLE_BILINEAR)", asMETHOD(Image, Resize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Image", "bool PremultiplyAlpha()", asMETHOD(Image, PremultiplyAlpha), asCALL_THISCALL);
     engine->RegisterObjectMethod("Image", "void Clear(const Color&in)", asMETHOD(Image, Clear), asCALL_THISCALL);
     engine->RegisterObjectMethod("Image", "void ClearInt(uint)", asMETHOD(Image, ClearInt), asCALL_THISCALL);
     engine->RegisterObjectMethod("Image", "bool SaveBMP(const String&in) const", asMETHOD(Image, SaveBMP), asCALL_THISCALL);
@@ -432,6 +466,11 @@ static bool JSONFileSave(File* file, const String& indendation, JSONFile* ptr)
     return file && ptr->Save(*file, indendation);
 }
 
+static bool JSONFileSaveBinary(File* file, JSONFile* ptr)
+{
+    return file && ptr->SaveBinary(*file);
+}
+
 static void RegisterJSONFile(asIScriptEngine* engine)
 {
     RegisterResource<JSONFile>(engine, "JSONFile");
@@ -439,6 +478,7 @@ static void RegisterJSONFile(asIScriptEngine* engine)
     engine->RegisterObjectMethod("JSONFile", "String ToString(const String&in = String(\"\t\")) const", asMETHOD(JSONFile, ToString), asCALL_THISCALL);
     engine->RegisterObjectMethod("JSONFile", "JSONValue& GetRoot()", asMETHODPR(JSONFile, GetRoot, () const, const JSONValue&), asCALL_THISCALL);
     engine->RegisterObjectMethod("JSONFile", "bool Save(File@+, const String&in) const", asFUNCTION(JSONFileSave), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("JSONFile", "bool SaveBinary(File@+) const", asFUNCTION(JSONFileSaveBinary), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("JSONFile", "JSONValue& get_root()", asMETHODPR(JSONFile, GetRoot, () const, const JSONValue&), asCALL_THISCALL);
 }
 
@@ -640,6 +680,11 @@ static bool XMLFileSave(File* file, const String& indendation, XMLFile* ptr)
     return file && ptr->Save(*file, indendation);
 }
 
+static bool XMLFileSaveBinary(File* file, XMLFile* ptr)
+{
+    return file && ptr->SaveBinary(*file);
+}
+
 static void RegisterXMLFile(asIScriptEngine* engine)
 {
     engine->RegisterObjectMethod("XMLFile", "bool FromString(const String&in)", asMETHOD(XMLFile, FromString), asCALL_THISCALL);
@@ -647,6 +692,7 @@ static void RegisterXMLFile(asIScriptEngine* engine)
     engine->RegisterObjectMethod("XMLFile", "XMLElement GetOrCreateRoot(const String&in)", asMETHOD(XMLFile, GetOrCreateRoot), asCALL_THISCALL);
     engine->RegisterObjectMethod("XMLFile", "XMLElement GetRoot(const String&in name = String())", asMETHOD(XMLFile, GetRoot), asCALL_THISCALL);
     engine->RegisterObjectMethod("XMLFile", "bool Save(File@+, const String&in) const", asFUNCTION(XMLFileSave), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("XMLFile", "bool SaveBinary(File@+) const", asFUNCTION(XMLFileSaveBinary), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("XMLFile", "String ToString(const String&in = String(\"\t\")) const", asMETHOD(XMLFile, ToString), asCALL_THISCALL);
     engine->RegisterObjectMethod("XMLFile", "XMLElement get_root()", asFUNCTION(XMLFileGetRootDefault), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("XMLFile", "void Patch(XMLFile@+)", asMETHODPR(XMLFile, Patch, (XMLFile*), void), asCALL_THISCALL);
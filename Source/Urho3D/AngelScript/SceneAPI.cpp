@@ -26,6 +26,7 @@
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/PackageFile.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/PrefabPool.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
@@ -270,13 +271,13 @@ static CScriptArray* GetObjectsByCategory(const String& category)
     HashMap<String, Vector<StringHash> >::ConstIterator i = categories.Find(category);
     if (i != categories.End())
     {
-        const HashMap<StringHash, SharedPtr<ObjectFactory> >& factories = GetScriptContext()->GetObjectFactories();
+        const FlatHashMap<StringHash, SharedPtr<ObjectFactory> >& factories = GetScriptContext()->GetObjectFactories();
         const Vector<StringHash>& factoryHashes = i->second_;
         components.Reserve(factoryHashes.Size());
 
         for (unsigned j = 0; j < factoryHashes.Size(); ++j)
         {
-            HashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator k = factories.Find(factoryHashes[j]);
+            FlatHashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator k = factories.Find(factoryHashes[j]);
             if (k != factories.End())
                 components.Push(k->second_->GetTypeName());
         }
@@ -306,6 +307,28 @@ static void RegisterSmoothedTransform(asIScriptEngine* engine)
     engine->RegisterObjectMethod("SmoothedTransform", "void set_targetWorldRotation(const Quaternion&in)", asMETHOD(SmoothedTransform, SetTargetWorldRotation), asCALL_THISCALL);
     engine->RegisterObjectMethod("SmoothedTransform", "Quaternion get_targetWorldRotation() const", asMETHOD(SmoothedTransform, GetTargetWorldRotation), asCALL_THISCALL);
     engine->RegisterObjectMethod("SmoothedTransform", "bool get_inProgress() const", asMETHOD(SmoothedTransform, IsInProgress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SmoothedTransform", "uint get_numSnapshots() const", asMETHOD(SmoothedTransform, GetNumSnapshots), asCALL_THISCALL);
+}
+
+static void RegisterPrefab(asIScriptEngine* engine)
+{
+    RegisterResource<Prefab>(engine, "Prefab");
+    engine->RegisterObjectMethod("Prefab", "bool SetNode(Node@+)", asMETHOD(Prefab, SetNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Prefab", "Node@+ Instantiate(Node@+, const Vector3&in, const Quaternion&in, CreateMode mode = REPLICATED) const", asMETHOD(Prefab, Instantiate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Prefab", "uint get_numNodes() const", asMETHOD(Prefab, GetNumNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Prefab", "uint get_numComponents() const", asMETHOD(Prefab, GetNumComponents), asCALL_THISCALL);
+
+    RegisterComponent<PrefabPool>(engine, "PrefabPool");
+    engine->RegisterObjectMethod("PrefabPool", "Node@+ Spawn(const Vector3&in, const Quaternion&in rotation = Quaternion())", asMETHOD(PrefabPool, Spawn), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "bool Release(Node@+)", asMETHOD(PrefabPool, Release), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "void Prewarm(uint)", asMETHOD(PrefabPool, Prewarm), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "void ClearIdle()", asMETHOD(PrefabPool, ClearIdle), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "void set_prefab(Prefab@+)", asMETHOD(PrefabPool, SetPrefab), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "Prefab@+ get_prefab() const", asMETHOD(PrefabPool, GetPrefab), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "void set_maxSize(uint)", asMETHOD(PrefabPool, SetMaxSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "uint get_maxSize() const", asMETHOD(PrefabPool, GetMaxSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "uint get_numActive() const", asMETHOD(PrefabPool, GetNumActive), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PrefabPool", "uint get_numIdle() const", asMETHOD(PrefabPool, GetNumIdle), asCALL_THISCALL);
 }
 
 static void RegisterSplinePath(asIScriptEngine* engine)
@@ -336,6 +359,10 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterEnumValue("LoadMode", "LOAD_SCENE", LOAD_SCENE);
     engine->RegisterEnumValue("LoadMode", "LOAD_SCENE_AND_RESOURCES", LOAD_SCENE_AND_RESOURCES);
 
+    engine->RegisterEnum("SmoothingMode");
+    engine->RegisterEnumValue("SmoothingMode", "SMOOTHING_EXPONENTIAL", SMOOTHING_EXPONENTIAL);
+    engine->RegisterEnumValue("SmoothingMode", "SMOOTHING_SNAPSHOT", SMOOTHING_SNAPSHOT);
+
     engine->RegisterGlobalProperty("const uint FIRST_REPLICATED_ID", (void*)&FIRST_REPLICATED_ID);
     engine->RegisterGlobalProperty("const uint LAST_REPLICATED_ID", (void*)&LAST_REPLICATED_ID);
     engine->RegisterGlobalProperty("const uint FIRST_LOCAL_ID", (void*)&FIRST_LOCAL_ID);
@@ -382,6 +409,7 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "Node@+ GetNode(uint) const", asMETHOD(Scene, GetNode), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "const String& GetVarName(StringHash) const", asMETHOD(Scene, GetVarName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void Update(float)", asMETHOD(Scene, Update), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "void UpdateTransforms()", asMETHOD(Scene, UpdateTransforms), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void set_updateEnabled(bool)", asMETHOD(Scene, SetUpdateEnabled), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "bool get_updateEnabled() const", asMETHOD(Scene, IsUpdateEnabled), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void set_timeScale(float)", asMETHOD(Scene, SetTimeScale), asCALL_THISCALL);
@@ -392,6 +420,10 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "float get_smoothingConstant() const", asMETHOD(Scene, GetSmoothingConstant), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void set_snapThreshold(float)", asMETHOD(Scene, SetSnapThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "float get_snapThreshold() const", asMETHOD(Scene, GetSnapThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "void set_smoothingMode(SmoothingMode)", asMETHOD(Scene, SetSmoothingMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "SmoothingMode get_smoothingMode() const", asMETHOD(Scene, GetSmoothingMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "void set_snapshotDelay(float)", asMETHOD(Scene, SetSnapshotDelay), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "float get_snapshotDelay() const", asMETHOD(Scene, GetSnapshotDelay), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "bool get_asyncLoading() const", asMETHOD(Scene, IsAsyncLoading), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "float get_asyncProgress() const", asMETHOD(Scene, GetAsyncProgress), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "LoadMode get_asyncLoadMode() const", asMETHOD(Scene, GetAsyncLoadMode), asCALL_THISCALL);
@@ -418,6 +450,7 @@ void RegisterSceneAPI(asIScriptEngine* engine)
     RegisterAnimatable(engine);
     RegisterNode(engine);
     RegisterSmoothedTransform(engine);
+    RegisterPrefab(engine);
     RegisterSplinePath(engine);
     RegisterScene(engine);
 }
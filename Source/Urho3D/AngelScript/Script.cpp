@@ -27,7 +27,10 @@
 #include "../AngelScript/ScriptAPI.h"
 #include "../AngelScript/ScriptFile.h"
 #include "../AngelScript/ScriptInstance.h"
+#include "../AngelScript/ScriptUpdateScheduler.h"
+#include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -70,9 +73,16 @@ Script::Script(Context* context) :
     Object(context),
     scriptEngine_(nullptr),
     immediateContext_(nullptr),
+    apiRegistered_(false),
+    byteCodeHash_(0),
     scriptNestingLevel_(0),
-    executeConsoleCommands_(false)
+    executeConsoleCommands_(false),
+    gcScheduled_(false),
+    gcCycleBaseline_(0),
+    gcIdleSteps_(0)
 {
+    byteCodeHashCounts_[0] = byteCodeHashCounts_[1] = 0;
+
     scriptEngine_ = asCreateScriptEngine(ANGELSCRIPT_VERSION);
     if (!scriptEngine_)
     {
@@ -102,7 +112,38 @@ Script::Script(Context* context) :
 #endif
 
     // Register Script library object factories
-    RegisterScriptLibrary(context_);
+    context_->RegisterLibrary("Script", RegisterScriptLibrary);
+
+    // With lazy registration, postpone the script API until the engine is first needed
+    if (!context_->GetLazyRegistration())
+        RegisterAPI();
+
+    // Subscribe to console commands
+    SetExecuteConsoleCommands(true);
+
+    SubscribeToEvent(E_GARBAGECOLLECT, URHO3D_HANDLER(Script, HandleGarbageCollect));
+
+    // Create and register resource router for checking for compiled AngelScript files
+    auto* cache = GetSubsystem<ResourceCache>();
+    if (cache)
+    {
+        router_ = new ScriptResourceRouter(context_);
+        cache->AddResourceRouter(router_);
+    }
+
+    // Cache compiled script modules in the user preferences directory by default
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (fileSystem)
+        SetByteCodeCacheDir(fileSystem->GetAppPreferencesDir("urho3d", "ScriptCache"));
+}
+
+void Script::RegisterAPI() const
+{
+    MutexLock lock(apiMutex_);
+    if (apiRegistered_ || !scriptEngine_)
+        return;
+
+    URHO3D_PROFILE(RegisterScriptAPI);
 
     // Register the Array, String & Dictionary API
     RegisterArray(scriptEngine_);
@@ -141,16 +182,7 @@ Script::Script(Context* context) :
     RegisterScriptAPI(scriptEngine_);
     RegisterEngineAPI(scriptEngine_);
 
-    // Subscribe to console commands
-    SetExecuteConsoleCommands(true);
-
-    // Create and register resource router for checking for compiled AngelScript files
-    auto* cache = GetSubsystem<ResourceCache>();
-    if (cache)
-    {
-        router_ = new ScriptResourceRouter(context_);
-        cache->AddResourceRouter(router_);
-    }
+    apiRegistered_ = true;
 }
 
 Script::~Script()
@@ -180,6 +212,7 @@ bool Script::Execute(const String& line)
     // Note: compiling code each time is slow. Not to be used for performance-critical or repeating activity
     URHO3D_PROFILE(ExecuteImmediate);
 
+    RegisterAPI();
     ClearObjectTypeCache();
 
     String wrappedLine = "void f(){\n" + line + ";\n}";
@@ -232,6 +265,111 @@ void Script::SetExecuteConsoleCommands(bool enable)
         UnsubscribeFromEvent(E_CONSOLECOMMAND);
 }
 
+void Script::SetByteCodeCacheDir(const String& pathName)
+{
+    byteCodeCacheDir_ = pathName.Empty() ? String::EMPTY : AddTrailingSlash(pathName);
+    if (!byteCodeCacheDir_.Empty())
+    {
+        auto* fileSystem = GetSubsystem<FileSystem>();
+        if (fileSystem && !fileSystem->CreateDir(byteCodeCacheDir_))
+        {
+            URHO3D_LOGERROR("Could not create script bytecode cache directory " + byteCodeCacheDir_);
+            byteCodeCacheDir_.Clear();
+        }
+    }
+}
+
+void Script::SetJITCompiler(asIJITCompiler* compiler)
+{
+    if (!scriptEngine_)
+        return;
+
+    // The JIT needs the extra JitEntry instructions in the bytecode to know where it may enter a function
+    scriptEngine_->SetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS, (asPWORD)(compiler != nullptr));
+    scriptEngine_->SetJITCompiler(compiler);
+    byteCodeHashCounts_[0] = byteCodeHashCounts_[1] = 0;
+}
+
+asIJITCompiler* Script::GetJITCompiler() const
+{
+    return scriptEngine_ ? scriptEngine_->GetJITCompiler() : nullptr;
+}
+
+unsigned long long Script::GetByteCodeHash()
+{
+    if (!scriptEngine_)
+        return 0;
+
+    RegisterAPI();
+
+    // The API can only grow after the engine has been set up, so the counts are enough to notice that the hash is stale
+    unsigned numFunctions = scriptEngine_->GetGlobalFunctionCount();
+    unsigned numTypes = scriptEngine_->GetObjectTypeCount();
+    if (byteCodeHashCounts_[0] == numFunctions && byteCodeHashCounts_[1] == numTypes)
+        return byteCodeHash_;
+
+    // Hash the declarations with 64-bit FNV-1a, as bytecode refers to the registered functions and types by their signatures
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    auto hashString = [&hash](const char* str)
+    {
+        while (str && *str)
+        {
+            hash ^= (unsigned char)*str++;
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= 0xff;
+        hash *= 0x100000001b3ULL;
+    };
+
+    hashString(ToString("%d %u %d", ANGELSCRIPT_VERSION, (unsigned)sizeof(void*),
+        (int)scriptEngine_->GetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS)).CString());
+
+    for (unsigned i = 0; i < numFunctions; ++i)
+        hashString(scriptEngine_->GetGlobalFunctionByIndex(i)->GetDeclaration(true, true, true));
+
+    for (unsigned i = 0; i < numTypes; ++i)
+    {
+        asITypeInfo* type = scriptEngine_->GetObjectTypeByIndex(i);
+        hashString(type->GetName());
+        hashString(ToString("%u", type->GetSize()).CString());
+        for (unsigned j = 0; j < type->GetFactoryCount(); ++j)
+            hashString(type->GetFactoryByIndex(j)->GetDeclaration(false, false, true));
+        for (unsigned j = 0; j < type->GetBehaviourCount(); ++j)
+            hashString(type->GetBehaviourByIndex(j, nullptr)->GetDeclaration(false, false, true));
+        for (unsigned j = 0; j < type->GetMethodCount(); ++j)
+            hashString(type->GetMethodByIndex(j, false)->GetDeclaration(false, false, true));
+        for (unsigned j = 0; j < type->GetPropertyCount(); ++j)
+            hashString(type->GetPropertyDeclaration(j, false));
+    }
+
+    for (unsigned i = 0; i < scriptEngine_->GetGlobalPropertyCount(); ++i)
+    {
+        const char* name;
+        const char* nameSpace;
+        int typeId;
+        scriptEngine_->GetGlobalPropertyByIndex(i, &name, &nameSpace, &typeId);
+        hashString(name);
+        hashString(scriptEngine_->GetTypeDeclaration(typeId, true));
+    }
+
+    for (unsigned i = 0; i < scriptEngine_->GetEnumCount(); ++i)
+    {
+        asITypeInfo* type = scriptEngine_->GetEnumByIndex(i);
+        hashString(type->GetName());
+        for (unsigned j = 0; j < type->GetEnumValueCount(); ++j)
+        {
+            int value;
+            hashString(type->GetEnumValueByIndex(j, &value));
+            hashString(ToString("%d", value).CString());
+        }
+    }
+
+    byteCodeHash_ = hash;
+    byteCodeHashCounts_[0] = numFunctions;
+    byteCodeHashCounts_[1] = numTypes;
+    return byteCodeHash_;
+}
+
 void Script::MessageCallback(const asSMessageInfo* msg)
 {
     String message;
@@ -295,6 +433,29 @@ Scene* Script::GetDefaultScene() const
     return defaultScene_;
 }
 
+ScriptUpdateScheduler* Script::GetUpdateScheduler(Object* source)
+{
+    if (!source)
+        return nullptr;
+
+    HashMap<Object*, SharedPtr<ScriptUpdateScheduler> >::Iterator i = updateSchedulers_.Find(source);
+    if (i != updateSchedulers_.End() && i->second_->GetSource() == source)
+        return i->second_;
+
+    // Remove the schedulers of destroyed sources, as a new object may have been allocated to the same address
+    for (i = updateSchedulers_.Begin(); i != updateSchedulers_.End();)
+    {
+        if (!i->second_->GetSource())
+            i = updateSchedulers_.Erase(i);
+        else
+            ++i;
+    }
+
+    SharedPtr<ScriptUpdateScheduler> scheduler(new ScriptUpdateScheduler(context_, source));
+    updateSchedulers_[source] = scheduler;
+    return scheduler;
+}
+
 void Script::ClearObjectTypeCache()
 {
     objectTypes_.Clear();
@@ -306,7 +467,8 @@ asITypeInfo* Script::GetObjectType(const char* declaration)
     if (i != objectTypes_.End())
         return i->second_;
 
-    asITypeInfo* type = scriptEngine_->GetTypeInfoById(scriptEngine_->GetTypeIdByDecl(declaration));
+    asIScriptEngine* engine = GetScriptEngine();
+    asITypeInfo* type = engine->GetTypeInfoById(engine->GetTypeIdByDecl(declaration));
     objectTypes_[declaration] = type;
     return type;
 }
@@ -374,6 +536,63 @@ void Script::HandleConsoleCommand(StringHash eventType, VariantMap& eventData)
         Execute(eventData[P_COMMAND].GetString());
 }
 
+void Script::HandleGarbageCollect(StringHash eventType, VariantMap& eventData)
+{
+    using namespace GarbageCollect;
+
+    int budget = eventData[P_TIMEBUDGET].GetInt();
+    if (budget <= 0)
+    {
+        // Not scheduled: return to the automatic collector
+        if (gcScheduled_)
+        {
+            scriptEngine_->SetEngineProperty(asEP_AUTO_GARBAGE_COLLECT, (asPWORD)true);
+            gcScheduled_ = false;
+        }
+        return;
+    }
+
+    URHO3D_PROFILE(ScriptCollectGarbage);
+
+    gcScheduled_ = true;
+    HiresTimer gcTimer;
+    unsigned numObjects, numDestroyed, numDetected, numNewObjects;
+    scriptEngine_->GetGCStatistics(&numObjects, &numDestroyed, &numDetected, &numNewObjects);
+    for (;;)
+    {
+        // A step does not tell whether the cycle finished. Each object takes a handful of steps to scan for cyclic references,
+        // so once there are no new objects and enough steps have passed without finding garbage, consider the cycle finished
+        // and leave the rest of the budget to other collectors
+        if (!numNewObjects && gcIdleSteps_ >= numObjects * 8)
+        {
+            gcCycleBaseline_ = numObjects;
+            break;
+        }
+
+        scriptEngine_->GarbageCollect(asGC_ONE_STEP);
+
+        unsigned destroyed, detected;
+        scriptEngine_->GetGCStatistics(&numObjects, &destroyed, &detected, &numNewObjects);
+        if (destroyed != numDestroyed || detected != numDetected)
+        {
+            numDestroyed = destroyed;
+            numDetected = detected;
+            gcIdleSteps_ = 0;
+        }
+        else
+            ++gcIdleSteps_;
+
+        if (gcTimer.GetUSec(false) >= budget)
+            break;
+    }
+
+    // The automatic collector runs when script objects are created, and may then do a full cycle in the middle of script
+    // code. Keep it disabled unless the number of objects has doubled since the last cycle, as then the budget is not keeping up
+    scriptEngine_->SetEngineProperty(asEP_AUTO_GARBAGE_COLLECT, (asPWORD)(numObjects >= gcCycleBaseline_ * 2 + 100));
+
+    eventData[P_TIMEBUDGET] = budget - (int)gcTimer.GetUSec(false);
+}
+
 void RegisterScriptLibrary(Context* context)
 {
     ScriptFile::RegisterObject(context);
@@ -25,6 +25,9 @@
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
+#include <atomic>
+
+class asIJITCompiler;
 class asIScriptContext;
 class asIScriptEngine;
 class asIScriptModule;
@@ -41,6 +44,7 @@ class ResourceRouter;
 class Scene;
 class ScriptFile;
 class ScriptInstance;
+class ScriptUpdateScheduler;
 
 /// Output mode for DumpAPI method.
 enum DumpMode
@@ -56,6 +60,7 @@ class URHO3D_API Script : public Object
     URHO3D_OBJECT(Script, Object);
 
     friend class ScriptFile;
+    friend class ScriptUpdateScheduler;
 
 public:
     /// Construct.
@@ -71,6 +76,10 @@ public:
     void SetDefaultScene(Scene* scene);
     /// Set whether to execute engine console commands as script code.
     void SetExecuteConsoleCommands(bool enable);
+    /// Set the directory where compiled script modules are cached as bytecode. Empty disables the cache.
+    void SetByteCodeCacheDir(const String& pathName);
+    /// Set the JIT compiler for script modules that are loaded afterward. Null to disable. The compiler is not owned and must outlive the script engine.
+    void SetJITCompiler(asIJITCompiler* compiler);
     /// Print the whole script API (all registered classes, methods and properties) to the log. No-ops when URHO3D_LOGGING not defined.
     void DumpAPI(DumpMode mode = DOXYGEN, const String& sourceTree = String::EMPTY);
     /// Log a message from the script engine.
@@ -80,8 +89,16 @@ public:
     /// Get call stack.
     static String GetCallStack(asIScriptContext* context);
 
-    /// Return the AngelScript engine.
-    asIScriptEngine* GetScriptEngine() const { return scriptEngine_; }
+    /// Return the AngelScript engine. Registers the script API first if it was postponed by lazy registration.
+    asIScriptEngine* GetScriptEngine() const
+    {
+        if (!apiRegistered_)
+            RegisterAPI();
+        return scriptEngine_;
+    }
+
+    /// Return whether the script API has been registered.
+    bool IsAPIRegistered() const { return apiRegistered_; }
 
     /// Return immediate execution script context.
     asIScriptContext* GetImmediateContext() const { return immediateContext_; }
@@ -94,6 +111,14 @@ public:
     /// Return whether is executing engine console commands as script code.
     bool GetExecuteConsoleCommands() const { return executeConsoleCommands_; }
 
+    /// Return the bytecode cache directory. Empty if disabled.
+    const String& GetByteCodeCacheDir() const { return byteCodeCacheDir_; }
+
+    /// Return the JIT compiler, or null if not set.
+    asIJITCompiler* GetJITCompiler() const;
+    /// Return a hash of the registered script API and engine settings that compiled bytecode depends on.
+    unsigned long long GetByteCodeHash();
+
     /// Clear the inbuild object type cache.
     void ClearObjectTypeCache();
     /// Query for an inbuilt object type by constant declaration. Can not be used for script types.
@@ -104,7 +129,8 @@ public:
 
     /// Returns an array of strings of enum value names for Enum Attributes.
     const char** GetEnumValues(int asTypeID);
-
+    /// Return the scheduler that calls the script object update methods for a scene or physics world. Create if necessary.
+    ScriptUpdateScheduler* GetUpdateScheduler(Object* source);
 
 private:
     /// Increase script nesting level.
@@ -118,10 +144,14 @@ private:
 
     /// Return a script function/method execution context for the current execution nesting level.
     asIScriptContext* GetScriptFileContext();
+    /// Register the script API to the AngelScript engine if not registered yet.
+    void RegisterAPI() const;
     /// Output a sanitated row of script API. No-ops when URHO3D_LOGGING not defined.
     void OutputAPIRow(DumpMode mode, const String& row, bool removeReference = false, const String& separator = ";");
     /// Handle a console command event.
     void HandleConsoleCommand(StringHash eventType, VariantMap& eventData);
+    /// Handle the engine's garbage collection time budget.
+    void HandleGarbageCollect(StringHash eventType, VariantMap& eventData);
 
     /// AngelScript engine.
     asIScriptEngine* scriptEngine_;
@@ -139,12 +169,30 @@ private:
     HashMap<int, PODVector<const char*>> enumValues_;
     /// AngelScript resource router.
     SharedPtr<ResourceRouter> router_;
+    /// Script object update schedulers by scene or physics world.
+    HashMap<Object*, SharedPtr<ScriptUpdateScheduler> > updateSchedulers_;
     /// Script module create/delete mutex.
     Mutex moduleMutex_;
+    /// Script API registration mutex, as script files may first use the engine in a background loading thread.
+    mutable Mutex apiMutex_;
+    /// Script API registered flag.
+    mutable std::atomic<bool> apiRegistered_;
+    /// Bytecode cache directory.
+    String byteCodeCacheDir_;
+    /// Hash of the registered script API.
+    unsigned long long byteCodeHash_;
+    /// Number of registered global functions and object types when the API hash was calculated.
+    unsigned byteCodeHashCounts_[2];
     /// Current script execution nesting level.
     unsigned scriptNestingLevel_;
     /// Flag for executing engine console commands as script code. Default to true.
     bool executeConsoleCommands_;
+    /// Garbage collection is driven by the engine's time budget flag.
+    bool gcScheduled_;
+    /// Number of garbage collected objects after the last finished collection cycle.
+    unsigned gcCycleBaseline_;
+    /// Number of garbage collection steps since garbage was last found.
+    unsigned gcIdleSteps_;
 };
 
 /// Register Script library objects.
@@ -192,6 +192,8 @@ void Script::OutputAPIRow(DumpMode mode, const String& row, bool removeReference
 
 void Script::DumpAPI(DumpMode mode, const String& sourceTree)
 {
+    RegisterAPI();
+
     // Does not use URHO3D_LOGRAW macro here to ensure the messages are always dumped regardless of URHO3D_LOGGING compiler directive
     // and of Log subsystem availability
 
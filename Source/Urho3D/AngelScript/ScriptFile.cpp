@@ -25,9 +25,11 @@
 #include "../AngelScript/Script.h"
 #include "../AngelScript/ScriptFile.h"
 #include "../AngelScript/ScriptInstance.h"
+#include "../Container/AllocationTracker.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -40,6 +42,9 @@
 namespace Urho3D
 {
 
+/// Version of the bytecode cache file layout.
+static const unsigned BYTECODE_CACHE_VERSION = 1;
+
 /// Helper class for saving AngelScript bytecode.
 class ByteCodeSerializer : public asIBinaryStream
 {
@@ -115,6 +120,9 @@ bool ScriptFile::BeginLoad(Deserializer& source)
 {
     ReleaseModule();
     loadByteCode_.Reset();
+    loadSections_.Clear();
+    loadSourceHash_ = 0xcbf29ce484222325ULL;
+    loadFromCache_ = false;
 
     asIScriptEngine* engine = script_->GetScriptEngine();
 
@@ -145,13 +153,25 @@ bool ScriptFile::BeginLoad(Deserializer& source)
     // Not bytecode: add the initial section and check for includes.
     // Perform actual building during EndLoad(), as AngelScript can not multithread module compilation,
     // and static initializers may access arbitrary engine functionality which may not be thread-safe
-    return AddScriptSection(engine, source);
+    if (!AddScriptSection(engine, source))
+        return false;
+
+    // The sections are known now, so look for a cached compilation of them
+    ReadCachedByteCode();
+    return true;
 }
 
 bool ScriptFile::EndLoad()
 {
     bool success = false;
 
+    // Cached bytecode is only valid for the script API it was compiled against
+    if (loadByteCode_ && loadFromCache_ && loadByteCodeHash_ != script_->GetByteCodeHash())
+    {
+        URHO3D_LOGDEBUG("Script API has changed, discarding cached bytecode of " + GetName());
+        loadByteCode_.Reset();
+    }
+
     // Load from bytecode if available, else compile
     if (loadByteCode_)
     {
@@ -160,17 +180,39 @@ bool ScriptFile::EndLoad()
 
         if (scriptModule_->LoadByteCode(&deserializer) >= 0)
         {
-            URHO3D_LOGINFO("Loaded script module " + GetName() + " from bytecode");
+            URHO3D_LOGINFO("Loaded script module " + GetName() + (loadFromCache_ ? " from bytecode cache" : " from bytecode"));
             success = true;
         }
+        else if (loadFromCache_)
+        {
+            URHO3D_LOGWARNING("Failed to load cached bytecode of script module " + GetName() + ", recompiling");
+
+            // Start over with a fresh module, as a failed load may leave partial contents behind
+            MutexLock lock(script_->GetModuleMutex());
+            scriptModule_ = script_->GetScriptEngine()->GetModule(GetName().CString(), asGM_ALWAYS_CREATE);
+        }
     }
-    else
+
+    if (!success && !loadSections_.Empty() && scriptModule_)
     {
-        int result = scriptModule_->Build();
+        bool sectionsAdded = true;
+        for (unsigned i = 0; i < loadSections_.Size(); ++i)
+        {
+            const ScriptSection& section = loadSections_[i];
+            if (scriptModule_->AddScriptSection(section.name_.CString(), section.data_.Get(), section.size_) < 0)
+            {
+                URHO3D_LOGERROR("Failed to add script section " + section.name_);
+                sectionsAdded = false;
+                break;
+            }
+        }
+
+        int result = sectionsAdded ? scriptModule_->Build() : -1;
         if (result >= 0)
         {
             URHO3D_LOGINFO("Compiled script module " + GetName());
             success = true;
+            WriteCachedByteCode();
         }
         else
             URHO3D_LOGERROR("Failed to compile script module " + GetName());
@@ -184,6 +226,7 @@ bool ScriptFile::EndLoad()
     }
 
     loadByteCode_.Reset();
+    loadSections_.Clear();
     return success;
 }
 
@@ -305,6 +348,7 @@ bool ScriptFile::Execute(const String& declaration, const VariantVector& paramet
 bool ScriptFile::Execute(asIScriptFunction* function, const VariantVector& parameters, Variant* functionReturn, bool unprepare)
 {
     URHO3D_PROFILE(ExecuteFunction);
+    AllocationTagScope allocationTag(ALLOCTAG_SCRIPT);
 
     if (!compiled_ || !function)
         return false;
@@ -464,6 +508,7 @@ bool ScriptFile::Execute(asIScriptObject* object, asIScriptFunction* method, con
     bool unprepare)
 {
     URHO3D_PROFILE(ExecuteMethod);
+    AllocationTagScope allocationTag(ALLOCTAG_SCRIPT);
 
     if (!compiled_ || !object || !method)
         return false;
@@ -821,17 +866,96 @@ bool ScriptFile::AddScriptSection(asIScriptEngine* engine, Deserializer& source)
         }
     }
 
-    // Then add this section
-    if (scriptModule_->AddScriptSection(source.GetName().CString(), (const char*)buffer.Get(), dataSize) < 0)
+    // Then add this section. The module is built from the sections in EndLoad(), unless cached bytecode of the same
+    // sections is found, so also hash the section with 64-bit FNV-1a
+    ScriptSection section;
+    section.name_ = source.GetName();
+    section.data_ = buffer;
+    section.size_ = dataSize;
+    loadSections_.Push(section);
+
+    const String sizeStr(dataSize);
+    const char* parts[] = {section.name_.CString(), sizeStr.CString()};
+    for (const char* part : parts)
     {
-        URHO3D_LOGERROR("Failed to add script section " + source.GetName());
-        return false;
+        for (const char* c = part; *c; ++c)
+        {
+            loadSourceHash_ ^= (unsigned char)*c;
+            loadSourceHash_ *= 0x100000001b3ULL;
+        }
+        loadSourceHash_ ^= 0xff;
+        loadSourceHash_ *= 0x100000001b3ULL;
+    }
+    for (unsigned i = 0; i < dataSize; ++i)
+    {
+        loadSourceHash_ ^= (unsigned char)buffer[i];
+        loadSourceHash_ *= 0x100000001b3ULL;
     }
 
     SetMemoryUse(GetMemoryUse() + dataSize);
     return true;
 }
 
+String ScriptFile::GetCacheFileName() const
+{
+    const String& cacheDir = script_->GetByteCodeCacheDir();
+    if (cacheDir.Empty() || GetName().Empty())
+        return String::EMPTY;
+
+    return cacheDir + ToStringHex(StringHash(GetName()).Value()) + ".asbc";
+}
+
+void ScriptFile::ReadCachedByteCode()
+{
+    String fileName = GetCacheFileName();
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (fileName.Empty() || !fileSystem || !fileSystem->FileExists(fileName))
+        return;
+
+    File file(context_, fileName);
+    if (!file.IsOpen() || file.ReadFileID() != "ASCC" || file.ReadUInt() != BYTECODE_CACHE_VERSION)
+        return;
+    // Different resources may share the file name hash, and any change in the sources or includes invalidates the bytecode
+    if (file.ReadString() != GetName() || file.ReadUInt64() != loadSourceHash_)
+        return;
+
+    loadByteCodeHash_ = file.ReadUInt64();
+    loadByteCodeSize_ = file.GetSize() - file.GetPosition();
+    loadByteCode_ = new unsigned char[loadByteCodeSize_];
+    if (file.Read(loadByteCode_.Get(), loadByteCodeSize_) != loadByteCodeSize_)
+    {
+        loadByteCode_.Reset();
+        return;
+    }
+
+    loadFromCache_ = true;
+}
+
+void ScriptFile::WriteCachedByteCode()
+{
+    String fileName = GetCacheFileName();
+    if (fileName.Empty())
+        return;
+
+    File file(context_, fileName, FILE_WRITE);
+    if (!file.IsOpen())
+        return;
+
+    file.WriteFileID("ASCC");
+    file.WriteUInt(BYTECODE_CACHE_VERSION);
+    file.WriteString(GetName());
+    file.WriteUInt64(loadSourceHash_);
+    file.WriteUInt64(script_->GetByteCodeHash());
+    // Keep the debug info so that script errors still report the line numbers
+    ByteCodeSerializer serializer = ByteCodeSerializer(file);
+    if (scriptModule_->SaveByteCode(&serializer, false) < 0)
+    {
+        file.Close();
+        GetSubsystem<FileSystem>()->Delete(fileName);
+        URHO3D_LOGWARNING("Failed to write cached bytecode of script module " + GetName());
+    }
+}
+
 void ScriptFile::SetParameters(asIScriptContext* context, asIScriptFunction* function, const VariantVector& parameters)
 {
     unsigned paramCount = function->GetParamCount();
@@ -125,6 +125,12 @@ private:
     void SetParameters(asIScriptContext* context, asIScriptFunction* function, const VariantVector& parameters);
     /// Release the script module.
     void ReleaseModule();
+    /// Return the bytecode cache file name, or empty if the cache is disabled.
+    String GetCacheFileName() const;
+    /// Read cached bytecode matching the collected script sections, if exists. Called at the end of BeginLoad().
+    void ReadCachedByteCode();
+    /// Write the compiled bytecode to the cache.
+    void WriteCachedByteCode();
     /// Handle application update event.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
 
@@ -152,6 +158,24 @@ private:
     SharedArrayPtr<unsigned char> loadByteCode_;
     /// Byte code size for asynchronous loading.
     unsigned loadByteCodeSize_{};
+    /// Script sections collected for compilation.
+    struct ScriptSection
+    {
+        /// Section name.
+        String name_;
+        /// Section source code.
+        SharedArrayPtr<char> data_;
+        /// Section size.
+        unsigned size_;
+    };
+    /// Script sections for asynchronous loading, including the include files.
+    Vector<ScriptSection> loadSections_;
+    /// Hash of the script sections for asynchronous loading.
+    unsigned long long loadSourceHash_{};
+    /// Script API hash stored with the cached bytecode.
+    unsigned long long loadByteCodeHash_{};
+    /// Byte code for asynchronous loading was read from the cache flag.
+    bool loadFromCache_{};
 };
 
 /// Helper class for forwarding events to script objects that are not part of a scene.
@@ -534,16 +534,7 @@ void ScriptInstance::OnSceneSet(Scene* scene)
     if (scene)
         UpdateEventSubscription();
     else
-    {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        subscribed_ = false;
-        subscribedPostFixed_ = false;
-    }
+        RemoveFromUpdateSchedulers();
 }
 
 void ScriptInstance::OnMarkedDirty(Node* node)
@@ -597,8 +588,7 @@ void ScriptInstance::ReleaseObject()
         UnsubscribeFromAllEventsExcept(exceptions, false);
         if (node_)
             node_->RemoveListener(this);
-        subscribed_ = false;
-        subscribedPostFixed_ = false;
+        RemoveFromUpdateSchedulers();
 
         ClearScriptMethods();
         ClearScriptAttributes();
@@ -696,8 +686,8 @@ void ScriptInstance::GetScriptAttributes()
         {
             // For a handle type, check if it's an Object subclass with a registered factory
             StringHash typeHash(typeName);
-            const HashMap<StringHash, SharedPtr<ObjectFactory> >& factories = context_->GetObjectFactories();
-            HashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator j = factories.Find(typeHash);
+            const FlatHashMap<StringHash, SharedPtr<ObjectFactory> >& factories = context_->GetObjectFactories();
+            FlatHashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator j = factories.Find(typeHash);
             if (j != factories.End())
             {
                 // Check base class type. Node & Component are supported as ID attributes, Resource as a resource reference
@@ -770,19 +760,25 @@ void ScriptInstance::UpdateEventSubscription()
     }
 
     bool enabled = scriptObject_ && IsEnabledEffective();
+    auto* script = GetSubsystem<Script>();
 
-    if (enabled)
+    if (enabled && script)
     {
+        // The update methods are called by the schedulers of the scene and physics world, grouped by script class
         if (!subscribed_ && (methods_[METHOD_UPDATE] || methods_[METHOD_DELAYEDSTART] || delayedCalls_.Size()))
         {
-            SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(ScriptInstance, HandleSceneUpdate));
+            updateScheduler_ = script->GetUpdateScheduler(scene);
+            updateScheduler_->AddInstance(this, SCRIPT_UPDATE, methods_[METHOD_UPDATE]);
             subscribed_ = true;
         }
 
         if (!subscribedPostFixed_)
         {
             if (methods_[METHOD_POSTUPDATE])
-                SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ScriptInstance, HandleScenePostUpdate));
+            {
+                updateScheduler_ = script->GetUpdateScheduler(scene);
+                updateScheduler_->AddInstance(this, SCRIPT_POSTUPDATE, methods_[METHOD_POSTUPDATE]);
+            }
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
             if (methods_[METHOD_FIXEDUPDATE] || methods_[METHOD_FIXEDPOSTUPDATE])
@@ -791,10 +787,11 @@ void ScriptInstance::UpdateEventSubscription()
 
                 if (world)
                 {
+                    fixedUpdateScheduler_ = script->GetUpdateScheduler(world);
                     if (methods_[METHOD_FIXEDUPDATE])
-                        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(ScriptInstance, HandlePhysicsPreStep));
+                        fixedUpdateScheduler_->AddInstance(this, SCRIPT_FIXEDUPDATE, methods_[METHOD_FIXEDUPDATE]);
                     if (methods_[METHOD_FIXEDPOSTUPDATE])
-                        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(ScriptInstance, HandlePhysicsPostStep));
+                        fixedUpdateScheduler_->AddInstance(this, SCRIPT_FIXEDPOSTUPDATE, methods_[METHOD_FIXEDPOSTUPDATE]);
                 }
                 else
                     URHO3D_LOGERROR("No physics world, can not subscribe script object to fixed update events");
@@ -808,43 +805,34 @@ void ScriptInstance::UpdateEventSubscription()
     }
     else
     {
-        if (subscribed_)
-        {
-            UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-            subscribed_ = false;
-        }
-
-        if (subscribedPostFixed_)
-        {
-            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-            Component* world = GetFixedUpdateSource();
-            if (world)
-            {
-                UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-                UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-            }
-#endif
-
-            subscribedPostFixed_ = false;
-        }
+        RemoveFromUpdateSchedulers();
 
         if (methods_[METHOD_TRANSFORMCHANGED])
             node_->RemoveListener(this);
     }
 }
 
-void ScriptInstance::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void ScriptInstance::RemoveFromUpdateSchedulers()
 {
-    if (!scriptObject_)
-        return;
-
-    using namespace SceneUpdate;
+    if (updateScheduler_)
+    {
+        updateScheduler_->RemoveInstance(this, SCRIPT_UPDATE);
+        updateScheduler_->RemoveInstance(this, SCRIPT_POSTUPDATE);
+    }
+    if (fixedUpdateScheduler_)
+    {
+        fixedUpdateScheduler_->RemoveInstance(this, SCRIPT_FIXEDUPDATE);
+        fixedUpdateScheduler_->RemoveInstance(this, SCRIPT_FIXEDPOSTUPDATE);
+    }
 
-    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    updateScheduler_.Reset();
+    fixedUpdateScheduler_.Reset();
+    subscribed_ = false;
+    subscribedPostFixed_ = false;
+}
 
-    // Execute delayed calls
+void ScriptInstance::ExecuteDelayedCalls(float timeStep)
+{
     for (unsigned i = 0; i < delayedCalls_.Size();)
     {
         DelayedCall& call = delayedCalls_[i];
@@ -866,69 +854,18 @@ void ScriptInstance::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
         else
             ++i;
     }
-
-    // Execute delayed start before first update
-    if (methods_[METHOD_DELAYEDSTART])
-    {
-        scriptFile_->Execute(scriptObject_, methods_[METHOD_DELAYEDSTART]);
-        methods_[METHOD_DELAYEDSTART] = nullptr;  // Only execute once
-    }
-
-    if (methods_[METHOD_UPDATE])
-    {
-        VariantVector parameters;
-        parameters.Push(timeStep);
-        scriptFile_->Execute(scriptObject_, methods_[METHOD_UPDATE], parameters);
-    }
 }
 
-void ScriptInstance::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void ScriptInstance::ExecuteDelayedStart()
 {
-    if (!scriptObject_)
-        return;
-
-    using namespace ScenePostUpdate;
-
-    VariantVector parameters;
-    parameters.Push(eventData[P_TIMESTEP]);
-    scriptFile_->Execute(scriptObject_, methods_[METHOD_POSTUPDATE], parameters);
-}
-
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-
-void ScriptInstance::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
-{
-    if (!scriptObject_)
-        return;
-
-    // Execute delayed start before first fixed update if not called yet
-    if (methods_[METHOD_DELAYEDSTART])
+    if (scriptObject_ && methods_[METHOD_DELAYEDSTART])
     {
-        scriptFile_->Execute(scriptObject_, methods_[METHOD_DELAYEDSTART]);
+        asIScriptFunction* method = methods_[METHOD_DELAYEDSTART];
         methods_[METHOD_DELAYEDSTART] = nullptr;  // Only execute once
+        scriptFile_->Execute(scriptObject_, method);
     }
-
-    using namespace PhysicsPreStep;
-
-    VariantVector parameters;
-    parameters.Push(eventData[P_TIMESTEP]);
-    scriptFile_->Execute(scriptObject_, methods_[METHOD_FIXEDUPDATE], parameters);
 }
 
-void ScriptInstance::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
-{
-    if (!scriptObject_)
-        return;
-
-    using namespace PhysicsPostStep;
-
-    VariantVector parameters;
-    parameters.Push(eventData[P_TIMESTEP]);
-    scriptFile_->Execute(scriptObject_, methods_[METHOD_FIXEDPOSTUPDATE], parameters);
-}
-
-#endif
-
 void ScriptInstance::HandleScriptEvent(StringHash eventType, VariantMap& eventData)
 {
     if (!IsEnabledEffective() || !scriptFile_ || !scriptObject_)
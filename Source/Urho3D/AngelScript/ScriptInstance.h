@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../AngelScript/ScriptEventListener.h"
+#include "../AngelScript/ScriptUpdateScheduler.h"
 #include "../Scene/Component.h"
 
 class asIScriptFunction;
@@ -59,6 +60,8 @@ class URHO3D_API ScriptInstance : public Component, public ScriptEventListener
 {
     URHO3D_OBJECT(ScriptInstance, Component);
 
+    friend class ScriptUpdateScheduler;
+
 public:
     /// Construct.
     explicit ScriptInstance(Context* context);
@@ -79,6 +82,8 @@ public:
     void ApplyAttributes() override;
     /// Handle enabled/disabled state change.
     void OnSetEnabled() override;
+    /// Return whether the network attributes can be read in worker threads. The script object's network data is read by calling into the script, so it can not.
+    bool IsThreadSafeNetworkUpdate() const override { return false; }
 
     /// Add a scripted event handler.
     void AddEventHandler(StringHash eventType, const String& handlerName) override;
@@ -169,18 +174,14 @@ private:
     void ClearScriptMethods();
     /// Clear attributes to C++ side attributes only.
     void ClearScriptAttributes();
-    /// Subscribe/unsubscribe from scene updates as necessary.
+    /// Register to/unregister from the update schedulers as necessary.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
+    /// Unregister from the update schedulers.
+    void RemoveFromUpdateSchedulers();
+    /// Execute the delayed calls whose time has come. Called by the update scheduler before the update method.
+    void ExecuteDelayedCalls(float timeStep);
+    /// Execute the delayed start method if not executed yet. Called by the update scheduler.
+    void ExecuteDelayedStart();
     /// Handle an event in script.
     void HandleScriptEvent(StringHash eventType, VariantMap& eventData);
     /// Handle script file reload start.
@@ -204,9 +205,15 @@ private:
     HashMap<AttributeInfo*, unsigned> idAttributes_;
     /// Storage for attributes while script object is being hot-reloaded.
     HashMap<String, Variant> storedAttributes_;
-    /// Subscribed to scene update events flag.
+    /// Scheduler of the scene's update methods.
+    WeakPtr<ScriptUpdateScheduler> updateScheduler_;
+    /// Scheduler of the physics world's fixed update methods.
+    WeakPtr<ScriptUpdateScheduler> fixedUpdateScheduler_;
+    /// Positions in the update schedulers.
+    ScriptUpdateSlot updateSlots_[MAX_SCRIPT_UPDATE_EVENTS];
+    /// Registered for scene update flag.
     bool subscribed_{};
-    /// Subscribed to scene post and fixed update events flag.
+    /// Registered for scene post and fixed update flag.
     bool subscribedPostFixed_{};
 };
 
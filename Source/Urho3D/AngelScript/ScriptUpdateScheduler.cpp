@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../AngelScript/Script.h"
+#include "../AngelScript/ScriptFile.h"
+#include "../AngelScript/ScriptInstance.h"
+#include "../AngelScript/ScriptUpdateScheduler.h"
+#include "../Container/AllocationTracker.h"
+#include "../Core/Profiler.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include <AngelScript/angelscript.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Group index of an instance whose registration is deferred until the dispatch finishes.
+static const unsigned PENDING_GROUP = M_MAX_UNSIGNED - 1;
+
+ScriptUpdateScheduler::ScriptUpdateScheduler(Context* context, Object* source) :
+    Object(context),
+    source_(source),
+    dispatching_(0)
+{
+    if (!source)
+        return;
+
+    if (source->GetType() == Scene::GetTypeStatic())
+    {
+        SubscribeToEvent(source, E_SCENEUPDATE, URHO3D_HANDLER(ScriptUpdateScheduler, HandleSceneUpdate));
+        SubscribeToEvent(source, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ScriptUpdateScheduler, HandleScenePostUpdate));
+    }
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    else
+    {
+        SubscribeToEvent(source, E_PHYSICSPRESTEP, URHO3D_HANDLER(ScriptUpdateScheduler, HandlePhysicsPreStep));
+        SubscribeToEvent(source, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(ScriptUpdateScheduler, HandlePhysicsPostStep));
+    }
+#endif
+}
+
+ScriptUpdateScheduler::~ScriptUpdateScheduler()
+{
+    // Leave the remaining instances unregistered
+    for (unsigned i = 0; i < MAX_SCRIPT_UPDATE_EVENTS; ++i)
+    {
+        for (unsigned j = 0; j < groups_[i].Size(); ++j)
+        {
+            const PODVector<ScriptInstance*>& instances = groups_[i][j].instances_;
+            for (unsigned k = 0; k < instances.Size(); ++k)
+            {
+                if (instances[k])
+                    instances[k]->updateSlots_[i] = ScriptUpdateSlot();
+            }
+        }
+    }
+    for (unsigned i = 0; i < pendingAdds_.Size(); ++i)
+        pendingAdds_[i].instance_->updateSlots_[pendingAdds_[i].event_] = ScriptUpdateSlot();
+}
+
+void ScriptUpdateScheduler::AddInstance(ScriptInstance* instance, ScriptUpdateEvent event, asIScriptFunction* method)
+{
+    if (!instance || event >= MAX_SCRIPT_UPDATE_EVENTS || instance->updateSlots_[event].group_ != M_MAX_UNSIGNED)
+        return;
+
+    if (dispatching_)
+    {
+        PendingAdd add;
+        add.instance_ = instance;
+        add.event_ = event;
+        add.method_ = method;
+        pendingAdds_.Push(add);
+        instance->updateSlots_[event].group_ = PENDING_GROUP;
+    }
+    else
+        AddToGroup(instance, event, method);
+}
+
+void ScriptUpdateScheduler::RemoveInstance(ScriptInstance* instance, ScriptUpdateEvent event)
+{
+    if (!instance || event >= MAX_SCRIPT_UPDATE_EVENTS)
+        return;
+
+    ScriptUpdateSlot& slot = instance->updateSlots_[event];
+    if (slot.group_ == PENDING_GROUP)
+    {
+        for (unsigned i = 0; i < pendingAdds_.Size(); ++i)
+        {
+            if (pendingAdds_[i].instance_ == instance && pendingAdds_[i].event_ == event)
+            {
+                pendingAdds_.Erase(i);
+                break;
+            }
+        }
+    }
+    else if (slot.group_ < groups_[event].Size())
+    {
+        // Null the slot so that a dispatch in progress is not disturbed, and compact afterward
+        groups_[event][slot.group_].instances_[slot.index_] = nullptr;
+        dirty_[event] = true;
+        if (!dispatching_)
+            Compact(event);
+    }
+
+    slot = ScriptUpdateSlot();
+}
+
+unsigned ScriptUpdateScheduler::GetNumInstances(ScriptUpdateEvent event) const
+{
+    unsigned num = 0;
+    for (unsigned i = 0; i < groups_[event].Size(); ++i)
+    {
+        const PODVector<ScriptInstance*>& instances = groups_[event][i].instances_;
+        for (unsigned j = 0; j < instances.Size(); ++j)
+        {
+            if (instances[j])
+                ++num;
+        }
+    }
+    return num;
+}
+
+void ScriptUpdateScheduler::AddToGroup(ScriptInstance* instance, ScriptUpdateEvent event, asIScriptFunction* method)
+{
+    Vector<Group>& groups = groups_[event];
+
+    unsigned groupIndex = 0;
+    while (groupIndex < groups.Size() && groups[groupIndex].method_ != method)
+        ++groupIndex;
+
+    if (groupIndex == groups.Size())
+    {
+        Group group;
+        group.method_ = method;
+        if (method)
+            group.profileName_ = String(method->GetObjectName()) + "::" + String(method->GetName());
+        else
+            group.profileName_ = "ScriptDelayedCalls";
+        groups.Push(group);
+    }
+
+    PODVector<ScriptInstance*>& instances = groups[groupIndex].instances_;
+    ScriptUpdateSlot& slot = instance->updateSlots_[event];
+    slot.group_ = groupIndex;
+    slot.index_ = instances.Size();
+    instances.Push(instance);
+}
+
+void ScriptUpdateScheduler::Dispatch(ScriptUpdateEvent event, float timeStep)
+{
+    Vector<Group>& groups = groups_[event];
+    if (groups.Empty())
+        return;
+
+    auto* script = GetSubsystem<Script>();
+    if (!script)
+        return;
+
+#ifdef URHO3D_PROFILING
+    auto* profiler = GetSubsystem<Profiler>();
+#endif
+
+    AllocationTagScope allocationTag(ALLOCTAG_SCRIPT);
+    ++dispatching_;
+
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        Group& group = groups[i];
+
+#ifdef URHO3D_PROFILING
+        if (profiler)
+            profiler->BeginBlock(group.profileName_.CString());
+#endif
+
+        // Take the context of the current nesting level for the whole group. Script calls made meanwhile, such as
+        // delayed calls or calls from within the methods, use the contexts of the next levels
+        asIScriptContext* context = script->GetScriptFileContext();
+        script->IncScriptNestingLevel();
+
+        for (unsigned j = 0; j < group.instances_.Size(); ++j)
+        {
+            ScriptInstance* instance = group.instances_[j];
+            if (!instance)
+                continue;
+
+            if (event == SCRIPT_UPDATE)
+            {
+                if (instance->delayedCalls_.Size())
+                    instance->ExecuteDelayedCalls(timeStep);
+                if (instance->methods_[METHOD_DELAYEDSTART])
+                    instance->ExecuteDelayedStart();
+            }
+            else if (event == SCRIPT_FIXEDUPDATE && instance->methods_[METHOD_DELAYEDSTART])
+                instance->ExecuteDelayedStart();
+
+            // The instance may have been removed by the calls above
+            instance = group.instances_[j];
+            if (!instance || !group.method_ || !instance->scriptObject_)
+                continue;
+
+            // Preparing the same function again is cheap, as AngelScript keeps the previous setup
+            if (context->Prepare(group.method_) < 0)
+                break;
+            context->SetObject(instance->scriptObject_);
+            context->SetArgFloat(0, timeStep);
+            context->Execute();
+        }
+
+        context->Unprepare();
+        script->DecScriptNestingLevel();
+
+#ifdef URHO3D_PROFILING
+        if (profiler)
+            profiler->EndBlock();
+#endif
+    }
+
+    --dispatching_;
+
+    if (!dispatching_)
+    {
+        if (dirty_[event])
+            Compact(event);
+
+        if (!pendingAdds_.Empty())
+        {
+            Vector<PendingAdd> adds;
+            adds.Swap(pendingAdds_);
+            for (unsigned i = 0; i < adds.Size(); ++i)
+            {
+                adds[i].instance_->updateSlots_[adds[i].event_] = ScriptUpdateSlot();
+                AddToGroup(adds[i].instance_, adds[i].event_, adds[i].method_);
+            }
+        }
+    }
+}
+
+void ScriptUpdateScheduler::Compact(ScriptUpdateEvent event)
+{
+    Vector<Group>& groups = groups_[event];
+
+    for (unsigned i = 0; i < groups.Size();)
+    {
+        PODVector<ScriptInstance*>& instances = groups[i].instances_;
+        unsigned numKept = 0;
+        for (unsigned j = 0; j < instances.Size(); ++j)
+        {
+            if (instances[j])
+                instances[numKept++] = instances[j];
+        }
+        instances.Resize(numKept);
+
+        if (instances.Empty())
+            groups.Erase(i);
+        else
+            ++i;
+    }
+
+    // Groups may have moved, so renumber all slots
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        PODVector<ScriptInstance*>& instances = groups[i].instances_;
+        for (unsigned j = 0; j < instances.Size(); ++j)
+        {
+            instances[j]->updateSlots_[event].group_ = i;
+            instances[j]->updateSlots_[event].index_ = j;
+        }
+    }
+
+    dirty_[event] = false;
+}
+
+void ScriptUpdateScheduler::HandleSceneUpdate(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    Dispatch(SCRIPT_UPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void ScriptUpdateScheduler::HandleScenePostUpdate(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace ScenePostUpdate;
+
+    Dispatch(SCRIPT_POSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+
+void ScriptUpdateScheduler::HandlePhysicsPreStep(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    Dispatch(SCRIPT_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void ScriptUpdateScheduler::HandlePhysicsPostStep(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    Dispatch(SCRIPT_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#endif
+
+}
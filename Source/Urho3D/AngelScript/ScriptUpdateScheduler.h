@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Object.h"
+
+class asIScriptFunction;
+
+namespace Urho3D
+{
+
+class ScriptInstance;
+
+/// Update methods of script objects that are dispatched by a script update scheduler.
+enum ScriptUpdateEvent
+{
+    SCRIPT_UPDATE = 0,
+    SCRIPT_POSTUPDATE,
+    SCRIPT_FIXEDUPDATE,
+    SCRIPT_FIXEDPOSTUPDATE,
+    MAX_SCRIPT_UPDATE_EVENTS
+};
+
+/// Position of a script instance in a script update scheduler.
+struct ScriptUpdateSlot
+{
+    /// Group index, or M_MAX_UNSIGNED if not registered.
+    unsigned group_{M_MAX_UNSIGNED};
+    /// Index within the group.
+    unsigned index_{};
+};
+
+/// Calls the update methods of the script instances of one scene or physics world.
+/** Instead of each script instance subscribing to the update events and executing its method through a VariantVector,
+    the scheduler subscribes once and calls the instances grouped by script class and method. The script context of
+    each group is prepared for the same method again for each instance, which AngelScript does cheaply, and the time step
+    is passed as a raw float. Each group is timed as its own profiler block named after the class and method. Instances
+    added during a dispatch are called from the next one.
+  */
+class URHO3D_API ScriptUpdateScheduler : public Object
+{
+    URHO3D_OBJECT(ScriptUpdateScheduler, Object);
+
+public:
+    /// Construct for a scene (update and post-update) or a physics world (fixed update and fixed post-update).
+    ScriptUpdateScheduler(Context* context, Object* source);
+    /// Destruct.
+    ~ScriptUpdateScheduler() override;
+
+    /// Register a script instance for an update method. A null method only handles the instance's delayed calls and delayed start.
+    void AddInstance(ScriptInstance* instance, ScriptUpdateEvent event, asIScriptFunction* method);
+    /// Unregister a script instance from an update method. Safe to call when not registered.
+    void RemoveInstance(ScriptInstance* instance, ScriptUpdateEvent event);
+
+    /// Return the event source.
+    Object* GetSource() const { return source_; }
+    /// Return number of registered instances for an update method.
+    unsigned GetNumInstances(ScriptUpdateEvent event) const;
+    /// Return number of class and method groups for an update method.
+    unsigned GetNumGroups(ScriptUpdateEvent event) const { return groups_[event].Size(); }
+
+private:
+    /// Script instances of one class that share an update method.
+    struct Group
+    {
+        /// Method, or null for instances with only delayed calls.
+        asIScriptFunction* method_;
+        /// Profiler block name.
+        String profileName_;
+        /// Instances. Removed instances are null until the next compaction.
+        PODVector<ScriptInstance*> instances_;
+    };
+
+    /// Registration deferred until the current dispatch finishes.
+    struct PendingAdd
+    {
+        /// Instance.
+        ScriptInstance* instance_;
+        /// Update method.
+        ScriptUpdateEvent event_;
+        /// Script method.
+        asIScriptFunction* method_;
+    };
+
+    /// Add an instance to the group of its method.
+    void AddToGroup(ScriptInstance* instance, ScriptUpdateEvent event, asIScriptFunction* method);
+    /// Call the method of all registered instances.
+    void Dispatch(ScriptUpdateEvent event, float timeStep);
+    /// Remove the nulled instances and empty groups, and renumber the slots of an update method.
+    void Compact(ScriptUpdateEvent event);
+    /// Handle scene update event.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    /// Handle physics pre-step event.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle physics post-step event.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+
+    /// Event source.
+    WeakPtr<Object> source_;
+    /// Groups per update method.
+    Vector<Group> groups_[MAX_SCRIPT_UPDATE_EVENTS];
+    /// Registrations made during a dispatch.
+    Vector<PendingAdd> pendingAdds_;
+    /// Whether an update method has nulled instances.
+    bool dirty_[MAX_SCRIPT_UPDATE_EVENTS]{};
+    /// Dispatch nesting count.
+    unsigned dispatching_;
+};
+
+}
@@ -84,6 +84,10 @@ static void RegisterFont(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Font", "void set_scaledGlyphOffset(const Vector2&)", asMETHOD(Font, SetScaledGlyphOffset), asCALL_THISCALL);
     engine->RegisterObjectMethod("Font", "const Vector2& get_scaledGlyphOffset() const", asMETHOD(Font, GetScaledGlyphOffset), asCALL_THISCALL);
     engine->RegisterObjectMethod("Font", "FontType get_fontType() const", asMETHOD(Font, GetFontType), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Font", "void set_sdfPointSize(float)", asMETHOD(Font, SetSDFPointSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Font", "float get_sdfPointSize() const", asMETHOD(Font, GetSDFPointSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Font", "void set_sdfSpread(int)", asMETHOD(Font, SetSDFSpread), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Font", "int get_sdfSpread() const", asMETHOD(Font, GetSDFSpread), asCALL_THISCALL);
 }
 
 static void RegisterUIElement(asIScriptEngine* engine)
@@ -377,6 +381,17 @@ static void RegisterListView(asIScriptEngine* engine)
     engine->RegisterObjectMethod("ListView", "bool get_hierarchyMode() const", asMETHOD(ListView, GetHierarchyMode), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "void set_baseIndent(int)", asMETHOD(ListView, SetBaseIndent), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "int get_baseIndent() const", asMETHOD(ListView, GetBaseIndent), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void RefreshVirtualItems()", asMETHOD(ListView, RefreshVirtualItems), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualMode(bool)", asMETHOD(ListView, SetVirtualMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "bool get_virtualMode() const", asMETHOD(ListView, GetVirtualMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemCount(uint)", asMETHOD(ListView, SetVirtualItemCount), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "uint get_virtualItemCount() const", asMETHOD(ListView, GetVirtualItemCount), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemHeight(int)", asMETHOD(ListView, SetVirtualItemHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "int get_virtualItemHeight() const", asMETHOD(ListView, GetVirtualItemHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemType(StringHash)", asMETHOD(ListView, SetVirtualItemType), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "StringHash get_virtualItemType() const", asMETHOD(ListView, GetVirtualItemType), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemStyle(const String&in)", asMETHOD(ListView, SetVirtualItemStyle), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "const String& get_virtualItemStyle() const", asMETHOD(ListView, GetVirtualItemStyle), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "void set_clearSelectionOnDefocus(bool)", asMETHOD(ListView, SetClearSelectionOnDefocus), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "bool get_clearSelectionOnDefocus() const", asMETHOD(ListView, GetClearSelectionOnDefocus), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "void set_selectOnClickEnd(bool)", asMETHOD(ListView, SetSelectOnClickEnd), asCALL_THISCALL);
@@ -398,6 +413,7 @@ static void RegisterText(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Text", "Font@+ get_font() const", asMETHOD(Text, GetFont), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "bool set_fontSize(float)", asMETHOD(Text, SetFontSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "float get_fontSize() const", asMETHOD(Text, GetFontSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Text", "void AppendText(const String&in)", asMETHOD(Text, AppendText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "void set_text(const String&in)", asMETHOD(Text, SetText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "const String& get_text() const", asMETHOD(Text, GetText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "void set_textAlignment(HorizontalAlignment)", asMETHOD(Text, SetTextAlignment), asCALL_THISCALL);
@@ -439,6 +455,7 @@ static void RegisterText3D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Text3D", "float get_fontSize() const", asMETHOD(Text3D, GetFontSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text3D", "void set_material(Material@+)", asMETHOD(Text3D, SetMaterial), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text3D", "Material@+ get_material() const", asMETHOD(Text3D, GetMaterial), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Text3D", "void AppendText(const String&in)", asMETHOD(Text3D, AppendText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text3D", "void set_text(const String&in)", asMETHOD(Text3D, SetText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text3D", "const String& get_text() const", asMETHOD(Text3D, GetText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text3D", "void set_textAlignment(HorizontalAlignment)", asMETHOD(Text3D, SetTextAlignment), asCALL_THISCALL);
@@ -798,6 +815,20 @@ static void RegisterUI(asIScriptEngine* engine)
     engine->RegisterObjectMethod("UI", "bool get_useScreenKeyboard() const", asMETHOD(UI, GetUseScreenKeyboard), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_useMutableGlyphs(bool)", asMETHOD(UI, SetUseMutableGlyphs), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "bool get_useMutableGlyphs() const", asMETHOD(UI, GetUseMutableGlyphs), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_maxFontTextures(uint)", asMETHOD(UI, SetMaxFontTextures), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "uint get_maxFontTextures() const", asMETHOD(UI, GetMaxFontTextures), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_fontAsyncRasterization(bool)", asMETHOD(UI, SetFontAsyncRasterization), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "bool get_fontAsyncRasterization() const", asMETHOD(UI, GetFontAsyncRasterization), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void UpdateLayouts()", asMETHOD(UI, UpdateLayouts), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_deferredLayout(bool)", asMETHOD(UI, SetDeferredLayout), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "bool get_deferredLayout() const", asMETHOD(UI, GetDeferredLayout), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_hitTestCellSize(int)", asMETHOD(UI, SetHitTestCellSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "int get_hitTestCellSize() const", asMETHOD(UI, GetHitTestCellSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_textureAtlasSize(int)", asMETHOD(UI, SetTextureAtlasSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "int get_textureAtlasSize() const", asMETHOD(UI, GetTextureAtlasSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_maxAtlasTextureSize(int)", asMETHOD(UI, SetMaxAtlasTextureSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "int get_maxAtlasTextureSize() const", asMETHOD(UI, GetMaxAtlasTextureSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void ClearTextureAtlas()", asMETHOD(UI, ClearTextureAtlas), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_forceAutoHint(bool)", asMETHOD(UI, SetForceAutoHint), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "bool get_forceAutoHint() const", asMETHOD(UI, GetForceAutoHint), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_fontHintLevel(FontHintLevel)", asMETHOD(UI, SetFontHintLevel), asCALL_THISCALL);
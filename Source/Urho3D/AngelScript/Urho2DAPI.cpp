@@ -50,6 +50,7 @@
 #include "../Urho2D/PhysicsWorld2D.h"
 #include "../Urho2D/RigidBody2D.h"
 #include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
 #include "../Urho2D/SpriteSheet2D.h"
 #include "../Urho2D/StretchableSprite2D.h"
 #include "../Urho2D/TileMap2D.h"
@@ -76,6 +77,33 @@ static void RegisterSprite2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Sprite2D", "const IntVector2& get_offset() const", asMETHOD(Sprite2D, GetOffset), asCALL_THISCALL);
     engine->RegisterObjectMethod("Sprite2D", "void set_textureEdgeOffset(float)", asMETHOD(Sprite2D, SetTextureEdgeOffset), asCALL_THISCALL);
     engine->RegisterObjectMethod("Sprite2D", "float get_textureEdgeOffset() const", asMETHOD(Sprite2D, GetTextureEdgeOffset), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Sprite2D", "void set_rotated(bool)", asMETHOD(Sprite2D, SetRotated), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Sprite2D", "bool get_rotated() const", asMETHOD(Sprite2D, IsRotated), asCALL_THISCALL);
+}
+
+static SpriteAtlas2D* GetSpriteAtlas2D()
+{
+    return GetScriptContext()->GetSubsystem<SpriteAtlas2D>();
+}
+
+static void RegisterSpriteAtlas2D(asIScriptEngine* engine)
+{
+    RegisterObject<SpriteAtlas2D>(engine, "SpriteAtlas2D");
+    engine->RegisterObjectMethod("SpriteAtlas2D", "bool AddSprite(Sprite2D@+)", asMETHOD(SpriteAtlas2D, AddSprite), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void Clear()", asMETHOD(SpriteAtlas2D, Clear), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "bool IsPage(Texture2D@+) const", asMETHOD(SpriteAtlas2D, IsPage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_enabled(bool)", asMETHOD(SpriteAtlas2D, SetEnabled), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "bool get_enabled() const", asMETHOD(SpriteAtlas2D, IsEnabled), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_pageSize(int)", asMETHOD(SpriteAtlas2D, SetPageSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "int get_pageSize() const", asMETHOD(SpriteAtlas2D, GetPageSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_maxSpriteSize(int)", asMETHOD(SpriteAtlas2D, SetMaxSpriteSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "int get_maxSpriteSize() const", asMETHOD(SpriteAtlas2D, GetMaxSpriteSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_padding(int)", asMETHOD(SpriteAtlas2D, SetPadding), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "int get_padding() const", asMETHOD(SpriteAtlas2D, GetPadding), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "uint get_numPages() const", asMETHOD(SpriteAtlas2D, GetNumPages), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "Texture2D@+ get_pages(uint) const", asMETHOD(SpriteAtlas2D, GetPage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "uint get_numSprites() const", asMETHOD(SpriteAtlas2D, GetNumSprites), asCALL_THISCALL);
+    engine->RegisterGlobalFunction("SpriteAtlas2D@+ get_spriteAtlas2D()", asFUNCTION(GetSpriteAtlas2D), asCALL_CDECL);
 }
 
 static void RegisterSpriteSheet2D(asIScriptEngine* engine)
@@ -171,6 +199,8 @@ static void RegisterAnimatedSprite2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("AnimatedSprite2D", "LoopMode2D get_loopMode() const", asMETHOD(AnimatedSprite2D, GetLoopMode), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedSprite2D", "void set_speed(float)", asMETHOD(AnimatedSprite2D, SetSpeed), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedSprite2D", "float get_speed() const", asMETHOD(AnimatedSprite2D, GetSpeed), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedSprite2D", "void set_spriterTimeQuantum(float)", asMETHOD(AnimatedSprite2D, SetSpriterTimeQuantum), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedSprite2D", "float get_spriterTimeQuantum() const", asMETHOD(AnimatedSprite2D, GetSpriterTimeQuantum), asCALL_THISCALL);
 }
 
 static void RegisterStretchableSprite2D(asIScriptEngine* engine)
@@ -312,7 +342,9 @@ static void RegisterTileMapLayer2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("TileMapLayer2D", "int get_width() const", asMETHOD(TileMapLayer2D, GetWidth), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMapLayer2D", "int get_height() const", asMETHOD(TileMapLayer2D, GetHeight), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMapLayer2D", "Tile2D@+ GetTile(int, int) const", asMETHOD(TileMapLayer2D, GetTile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TileMapLayer2D", "void SetTile(int, int, uint)", asMETHOD(TileMapLayer2D, SetTile), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMapLayer2D", "Node@+ GetTileNode(int, int) const", asMETHOD(TileMapLayer2D, GetTileNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TileMapLayer2D", "int get_chunkSize() const", asMETHOD(TileMapLayer2D, GetChunkSize), asCALL_THISCALL);
 
     // For object group only
     engine->RegisterObjectMethod("TileMapLayer2D", "uint get_numObjects() const", asMETHOD(TileMapLayer2D, GetNumObjects), asCALL_THISCALL);
@@ -333,6 +365,8 @@ static void RegisterTileMap2D(asIScriptEngine* engine)
 {
     engine->RegisterObjectMethod("TileMap2D", "void set_tmxFile(TmxFile2D@+)", asMETHOD(TileMap2D, SetTmxFile), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMap2D", "TmxFile2D@+ get_tmxFile() const", asMETHOD(TileMap2D, GetTmxFile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TileMap2D", "void set_tileChunkSize(int)", asMETHOD(TileMap2D, SetTileChunkSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("TileMap2D", "int get_tileChunkSize() const", asMETHOD(TileMap2D, GetTileChunkSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMap2D", "TileMapInfo2D@+ get_info() const", asMETHOD(TileMap2D, GetInfo), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMap2D", "uint get_numLayers() const", asMETHOD(TileMap2D, GetNumLayers), asCALL_THISCALL);
     engine->RegisterObjectMethod("TileMap2D", "TileMapLayer2D@+ GetLayer(uint) const", asMETHOD(TileMap2D, GetLayer), asCALL_THISCALL);
@@ -470,6 +504,8 @@ static void RegisterPhysicsWorld2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_continuousPhysics() const", asMETHOD(PhysicsWorld2D, GetContinuousPhysics), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_subStepping(bool)", asMETHOD(PhysicsWorld2D, SetSubStepping), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_subStepping() const", asMETHOD(PhysicsWorld2D, GetSubStepping), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "void set_threadedTransforms(bool)", asMETHOD(PhysicsWorld2D, SetThreadedTransforms), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_threadedTransforms() const", asMETHOD(PhysicsWorld2D, GetThreadedTransforms), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_gravity(const Vector2&in)", asMETHOD(PhysicsWorld2D, SetGravity), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "const Vector2& get_gravity() const", asMETHOD(PhysicsWorld2D, GetGravity), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_autoClearForces(bool)", asMETHOD(PhysicsWorld2D, SetAutoClearForces), asCALL_THISCALL);
@@ -773,6 +809,7 @@ void RegisterUrho2DAPI(asIScriptEngine* engine)
 {
     RegisterSprite2D(engine);
     RegisterSpriteSheet2D(engine);
+    RegisterSpriteAtlas2D(engine);
     RegisterDrawable2D(engine);
     RegisterStaticSprite2D(engine);
 
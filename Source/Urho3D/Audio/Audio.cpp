@@ -23,9 +23,11 @@
 #include "../Precompiled.h"
 
 #include "../Audio/Audio.h"
+#include "../Audio/AudioDecoder.h"
 #include "../Audio/Sound.h"
 #include "../Audio/SoundListener.h"
 #include "../Audio/SoundSource3D.h"
+#include "../Audio/SoundStream.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/ProcessUtils.h"
@@ -34,6 +36,12 @@
 
 #include <SDL/SDL.h>
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -49,9 +57,44 @@ static const int MIN_BUFFERLENGTH = 20;
 static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
 static const StringHash SOUND_MASTER_HASH("Master");
+/// Size of the command queue to the mixing thread, must be a power of two.
+static const unsigned COMMAND_QUEUE_SIZE = 4096;
 
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
+/// Convert mixed samples to 16-bit with clipping.
+static void ClipSamples(short* dest, const float* src, unsigned count)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minValue), maxValue));
+        __m128i high = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), minValue), maxValue));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(low, high));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x4_t low = vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i)));
+        int16x4_t high = vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i + 4)));
+        vst1q_s16(dest + i, vcombine_s16(low, high));
+    }
+#endif
+    for (; i < count; ++i)
+        dest[i] = (short)RoundToInt(Clamp(src[i], -32768.0f, 32767.0f));
+}
+
+/// Compare voices for selection, higher priority and gain first.
+static bool CompareVoices(const SoundVoice* lhs, const SoundVoice* rhs)
+{
+    if (lhs->params_.priority_ != rhs->params_.priority_)
+        return lhs->params_.priority_ > rhs->params_.priority_;
+    return lhs->params_.gain_ > rhs->params_.gain_;
+}
+
 Audio::Audio(Context* context) :
     Object(context)
 {
@@ -60,8 +103,12 @@ Audio::Audio(Context* context) :
     // Set the master to the default value
     masterGain_[SOUND_MASTER_HASH] = 1.0f;
 
+    commands_.Resize(COMMAND_QUEUE_SIZE);
+    decoder_ = new AudioDecoder();
+    spatialBatch_ = new SoundSource3DBatch();
+
     // Register Audio library object factories
-    RegisterAudioLibrary(context_);
+    context_->RegisterLibrary("Audio", RegisterAudioLibrary);
 
     SubscribeToEvent(E_RENDERUPDATE, URHO3D_HANDLER(Audio, HandleRenderUpdate));
 }
@@ -69,6 +116,12 @@ Audio::Audio(Context* context) :
 Audio::~Audio()
 {
     Release();
+    decoder_.Reset();
+
+    // Sound sources that still exist delete their own voices
+    for (unsigned i = 0; i < pendingVoices_.Size(); ++i)
+        delete pendingVoices_[i].second_;
+
     context_->ReleaseSDL();
 }
 
@@ -118,7 +171,7 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
     fragmentSize_ = Min(NextPowerOfTwo((unsigned)mixRate >> 6u), (unsigned)obtained.samples);
     mixRate_ = obtained.freq;
     interpolation_ = interpolation;
-    clipBuffer_ = new int[stereo ? fragmentSize_ << 1u : fragmentSize_];
+    clipBuffer_ = new float[stereo ? fragmentSize_ << 1u : fragmentSize_];
 
     URHO3D_LOGINFO("Set audio mode " + String(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " +
             (interpolation_ ? "interpolated" : ""));
@@ -128,10 +181,11 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
 
 void Audio::Update(float timeStep)
 {
-    if (!playing_)
-        return;
+    if (playing_)
+        UpdateInternal(timeStep);
 
-    UpdateInternal(timeStep);
+    UpdateCommands();
+    decoder_->Update();
 }
 
 bool Audio::Play()
@@ -164,27 +218,30 @@ void Audio::SetMasterGain(const String& type, float gain)
     masterGain_[type] = Clamp(gain, 0.0f, 1.0f);
 
     for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
+    {
         (*i)->UpdateMasterGain();
+        (*i)->UpdateVoiceParams();
+    }
 }
 
 void Audio::PauseSoundType(const String& type)
 {
-    MutexLock lock(audioMutex_);
     pausedSoundTypes_.Insert(type);
+
+    for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
+        (*i)->UpdateVoiceParams();
 }
 
 void Audio::ResumeSoundType(const String& type)
 {
-    MutexLock lock(audioMutex_);
     pausedSoundTypes_.Erase(type);
-    // Update sound sources before resuming playback to make sure 3D positions are up to date
-    // Done under mutex to ensure no mixing happens before we are ready
+    // Update sound sources before resuming playback to make sure 3D positions are up to date. The parameters are
+    // queued after the updates, so no mixing happens before we are ready
     UpdateInternal(0.0f);
 }
 
 void Audio::ResumeAll()
 {
-    MutexLock lock(audioMutex_);
     pausedSoundTypes_.Clear();
     UpdateInternal(0.0f);
 }
@@ -194,6 +251,41 @@ void Audio::SetListener(SoundListener* listener)
     listener_ = listener;
 }
 
+void Audio::SetMaxVoices(unsigned voices)
+{
+    maxVoices_ = voices;
+}
+
+void Audio::SetOcclusionMask(unsigned mask)
+{
+    occlusionMask_ = mask;
+}
+
+void Audio::SetOcclusionAttenuation(float attenuation)
+{
+    occlusionAttenuation_ = Clamp(attenuation, 0.0f, 1.0f);
+}
+
+void Audio::SetOcclusionRaysPerFrame(unsigned rays)
+{
+    occlusionRaysPerFrame_ = rays;
+}
+
+void Audio::SetDecodeCacheSize(unsigned size)
+{
+    decoder_->SetCacheSize(size);
+}
+
+void Audio::SetDecodeCacheMaxLength(float length)
+{
+    decoder_->SetCacheMaxLength(length);
+}
+
+void Audio::SetStreamPrefetch(bool enable)
+{
+    decoder_->SetPrefetch(enable);
+}
+
 void Audio::StopSound(Sound* sound)
 {
     for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
@@ -213,6 +305,26 @@ float Audio::GetMasterGain(const String& type) const
     return findIt->second_.GetFloat();
 }
 
+unsigned Audio::GetDecodeCacheSize() const
+{
+    return decoder_->GetCacheSize();
+}
+
+float Audio::GetDecodeCacheMaxLength() const
+{
+    return decoder_->GetCacheMaxLength();
+}
+
+unsigned Audio::GetDecodeCacheUse() const
+{
+    return decoder_->GetCacheUse();
+}
+
+bool Audio::GetStreamPrefetch() const
+{
+    return decoder_->GetPrefetch();
+}
+
 bool Audio::IsSoundTypePaused(const String& type) const
 {
     return pausedSoundTypes_.Contains(type);
@@ -225,8 +337,22 @@ SoundListener* Audio::GetListener() const
 
 void Audio::AddSoundSource(SoundSource* soundSource)
 {
-    MutexLock lock(audioMutex_);
     soundSources_.Push(soundSource);
+
+    AudioCommand command;
+    command.type_ = AUDIO_ADD_VOICE;
+    command.voice_ = soundSource->GetVoice();
+    QueueCommand(command);
+}
+
+void Audio::AddSoundSource3D(SoundSource3D* soundSource)
+{
+    soundSources3D_.Push(soundSource);
+}
+
+void Audio::RemoveSoundSource3D(SoundSource3D* soundSource)
+{
+    soundSources3D_.Remove(soundSource);
 }
 
 void Audio::RemoveSoundSource(SoundSource* soundSource)
@@ -234,11 +360,35 @@ void Audio::RemoveSoundSource(SoundSource* soundSource)
     PODVector<SoundSource*>::Iterator i = soundSources_.Find(soundSource);
     if (i != soundSources_.End())
     {
-        MutexLock lock(audioMutex_);
         soundSources_.Erase(i);
+
+        // The voice is deleted once the mixing thread has removed it
+        AudioCommand command;
+        command.type_ = AUDIO_REMOVE_VOICE;
+        command.voice_ = soundSource->GetVoice();
+        QueueCommand(command);
+        pendingVoices_.Push(MakePair(commandWrite_.load(std::memory_order_relaxed) + overflowCommands_.Size(), command.voice_));
     }
 }
 
+void Audio::QueueCommand(const AudioCommand& command)
+{
+    // Keep the order of the commands that did not fit
+    if (!overflowCommands_.Empty() || !WriteCommand(command))
+        overflowCommands_.Push(command);
+}
+
+SharedPtr<SoundStream> Audio::GetDecoderStream(Sound* sound)
+{
+    return decoder_->GetDecoderStream(sound);
+}
+
+void Audio::ReleaseAfterMix(RefCounted* object)
+{
+    if (object)
+        pendingReleases_.Push(MakePair(commandWrite_.load(std::memory_order_relaxed) + overflowCommands_.Size(), SharedPtr<RefCounted>(object)));
+}
+
 float Audio::GetSoundSourceMasterGain(StringHash typeHash) const
 {
     HashMap<StringHash, Variant>::ConstIterator masterIt = masterGain_.Find(SOUND_MASTER_HASH);
@@ -257,20 +407,22 @@ float Audio::GetSoundSourceMasterGain(StringHash typeHash) const
 void SDLAudioCallback(void* userdata, Uint8* stream, int len)
 {
     auto* audio = static_cast<Audio*>(userdata);
-    {
-        MutexLock Lock(audio->GetMutex());
-        audio->MixOutput(stream, len / audio->GetSampleSize());
-    }
+    audio->MixOutput(stream, len / audio->GetSampleSize());
 }
 
 void Audio::MixOutput(void* dest, unsigned samples)
 {
+    unsigned mixedCommands = ProcessCommands();
+
     if (!playing_ || !clipBuffer_)
     {
         memset(dest, 0, samples * (size_t)sampleSize_);
+        commandMixed_.store(mixedCommands, std::memory_order_release);
         return;
     }
 
+    unsigned numAudible = SelectVoices();
+
     while (samples)
     {
         // If sample count exceeds the fragment (clip buffer) size, split the work
@@ -280,30 +432,21 @@ void Audio::MixOutput(void* dest, unsigned samples)
             clipSamples <<= 1;
 
         // Clear clip buffer
-        int* clipPtr = clipBuffer_.Get();
-        memset(clipPtr, 0, clipSamples * sizeof(int));
-
-        // Mix samples to clip buffer
-        for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
-        {
-            SoundSource* source = *i;
+        float* clipPtr = clipBuffer_.Get();
+        memset(clipPtr, 0, clipSamples * sizeof(float));
 
-            // Check for pause if necessary
-            if (!pausedSoundTypes_.Empty())
-            {
-                if (pausedSoundTypes_.Contains(source->GetSoundType()))
-                    continue;
-            }
+        // Mix samples to clip buffer. The virtualized voices only advance their playback position
+        for (unsigned i = 0; i < mixVoices_.Size(); ++i)
+            mixVoices_[i]->Mix(clipPtr, workSamples, mixRate_, stereo_, interpolation_, i < numAudible);
 
-            source->Mix(clipPtr, workSamples, mixRate_, stereo_, interpolation_);
-        }
         // Copy output from clip buffer to destination
-        auto* destPtr = (short*)dest;
-        while (clipSamples--)
-            *destPtr++ = (short)Clamp(*clipPtr++, -32768, 32767);
+        ClipSamples((short*)dest, clipPtr, clipSamples);
         samples -= workSamples;
         ((unsigned char*&)dest) += sampleSize_ * workSamples;
     }
+
+    // The sounds and voices released before the applied commands are no longer referenced
+    commandMixed_.store(mixedCommands, std::memory_order_release);
 }
 
 void Audio::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
@@ -329,6 +472,28 @@ void Audio::UpdateInternal(float timeStep)
 {
     URHO3D_PROFILE(UpdateAudio);
 
+    // Without an audio device, simulate playback to check stopping and looping
+    if (!deviceID_)
+    {
+        commandMixed_.store(ProcessCommands(), std::memory_order_release);
+        for (PODVector<SoundVoice*>::Iterator i = voices_.Begin(); i != voices_.End(); ++i)
+            (*i)->MixNull(timeStep);
+    }
+
+    // Calculate the attenuation of all unpaused 3D sound sources at once
+    PODVector<SoundSource3D*>& sources3D = spatialBatch_->sources_;
+    sources3D.Clear();
+    for (PODVector<SoundSource3D*>::Iterator i = soundSources3D_.Begin(); i != soundSources3D_.End(); ++i)
+    {
+        if (pausedSoundTypes_.Empty() || !pausedSoundTypes_.Contains((*i)->GetSoundType()))
+            sources3D.Push(*i);
+    }
+    if (!sources3D.Empty())
+    {
+        URHO3D_PROFILE(CalculateSoundAttenuations);
+        SoundSource3D::CalculateAttenuations(*spatialBatch_, this, timeStep);
+    }
+
     // Update in reverse order, because sound sources might remove themselves
     for (unsigned i = soundSources_.Size() - 1; i < soundSources_.Size(); --i)
     {
@@ -343,6 +508,118 @@ void Audio::UpdateInternal(float timeStep)
 
         source->Update(timeStep);
     }
+
+    // Pass the changed playback parameters to the mixing thread after all updates, as sources may have removed themselves
+    for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
+        (*i)->UpdateVoiceParams();
+}
+
+unsigned Audio::SelectVoices()
+{
+    mixVoices_.Clear();
+    for (PODVector<SoundVoice*>::Iterator i = voices_.Begin(); i != voices_.End(); ++i)
+    {
+        SoundVoice* voice = *i;
+        if (voice->IsPlaying() && voice->params_.active_)
+            mixVoices_.Push(voice);
+    }
+
+    unsigned numAudible = mixVoices_.Size();
+    unsigned maxVoices = maxVoices_.load(std::memory_order_relaxed);
+    if (maxVoices && numAudible > maxVoices)
+    {
+        // Partition the most important voices first, without fully sorting
+        std::nth_element(mixVoices_.Buffer(), mixVoices_.Buffer() + maxVoices, mixVoices_.Buffer() + mixVoices_.Size(),
+            CompareVoices);
+        numAudible = maxVoices;
+    }
+
+    numVirtualVoices_.store(mixVoices_.Size() - numAudible, std::memory_order_relaxed);
+    return numAudible;
+}
+
+bool Audio::WriteCommand(const AudioCommand& command)
+{
+    unsigned write = commandWrite_.load(std::memory_order_relaxed);
+    if (write - commandRead_.load(std::memory_order_acquire) >= COMMAND_QUEUE_SIZE)
+        return false;
+
+    commands_[write & (COMMAND_QUEUE_SIZE - 1)] = command;
+    commandWrite_.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+unsigned Audio::ProcessCommands()
+{
+    unsigned read = commandRead_.load(std::memory_order_relaxed);
+    unsigned write = commandWrite_.load(std::memory_order_acquire);
+
+    for (; read != write; ++read)
+    {
+        const AudioCommand& command = commands_[read & (COMMAND_QUEUE_SIZE - 1)];
+        SoundVoice* voice = command.voice_;
+
+        switch (command.type_)
+        {
+        case AUDIO_ADD_VOICE:
+            voices_.Push(voice);
+            break;
+
+        case AUDIO_REMOVE_VOICE:
+            voices_.RemoveSwap(voice);
+            break;
+
+        case AUDIO_SET_PARAMS:
+            voice->params_ = command.params_;
+            break;
+
+        case AUDIO_PLAY:
+            voice->Play(command.sound_, command.stream_, command.streamBuffer_, command.playId_);
+            break;
+
+        case AUDIO_STOP:
+            voice->Stop();
+            break;
+
+        case AUDIO_SET_POSITION:
+            voice->SetPlayPosition(command.position_);
+            break;
+
+        case AUDIO_SEEK:
+            voice->Seek(command.position_, command.time_);
+            break;
+        }
+    }
+
+    commandRead_.store(read, std::memory_order_release);
+    return read;
+}
+
+void Audio::UpdateCommands()
+{
+    unsigned numWritten = 0;
+    while (numWritten < overflowCommands_.Size() && WriteCommand(overflowCommands_[numWritten]))
+        ++numWritten;
+    if (numWritten)
+        overflowCommands_.Erase(0, numWritten);
+
+    // Without an audio device there is no mixing thread, so apply the commands here
+    if (!deviceID_)
+        commandMixed_.store(ProcessCommands(), std::memory_order_release);
+
+    // Free what has been released before the commands the mixing thread has finished with. The positions are in order
+    unsigned mixed = commandMixed_.load(std::memory_order_acquire);
+    unsigned numReleased = 0;
+    while (numReleased < pendingReleases_.Size() && (int)(mixed - pendingReleases_[numReleased].first_) >= 0)
+        ++numReleased;
+    if (numReleased)
+        pendingReleases_.Erase(0, numReleased);
+
+    unsigned numDeleted = 0;
+    while (numDeleted < pendingVoices_.Size() && (int)(mixed - pendingVoices_[numDeleted].first_) >= 0)
+        delete pendingVoices_[numDeleted++].second_;
+    if (numDeleted)
+        pendingVoices_.Erase(0, numDeleted);
 }
 
 void RegisterAudioLibrary(Context* context)
@@ -23,18 +23,22 @@
 #pragma once
 
 #include "../Audio/AudioDefs.h"
+#include "../Audio/SoundVoice.h"
 #include "../Container/ArrayPtr.h"
 #include "../Container/HashSet.h"
-#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
 namespace Urho3D
 {
 
+class AudioDecoder;
 class AudioImpl;
 class Sound;
+class SoundStream;
 class SoundListener;
 class SoundSource;
+class SoundSource3D;
+struct SoundSource3DBatch;
 
 /// %Audio subsystem.
 class URHO3D_API Audio : public Object
@@ -44,12 +48,12 @@ class URHO3D_API Audio : public Object
 public:
     /// Construct.
     explicit Audio(Context* context);
-    /// Destruct. Terminate the audio thread and free the audio buffer.
+    /// Destruct. Terminate the audio thread and free the audio buffer and the voices not yet deleted.
     ~Audio() override;
 
     /// Initialize sound output with specified buffer length and output mode.
     bool SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpolation = true);
-    /// Run update on sound sources. Not required for continued playback, but frees unused sound sources & sounds and updates 3D positions.
+    /// Run update on sound sources and pass their changes to the mixing thread. Not required for continued playback, but frees unused sound sources & sounds and updates 3D positions.
     void Update(float timeStep);
     /// Restart sound output.
     bool Play();
@@ -67,6 +71,20 @@ public:
     void SetListener(SoundListener* listener);
     /// Stop any sound source playing a certain sound clip.
     void StopSound(Sound* sound);
+    /// Set maximum number of sound sources mixed at once. The rest with lowest priority and gain are virtualized: faded out and only advanced in time until they become audible again. Zero (default) is unlimited.
+    void SetMaxVoices(unsigned voices);
+    /// Set memory budget in bytes for fully decoded short compressed sounds, so that they are decoded only once and not in the mixing thread. Zero disables the decode cache. Default 16 MB.
+    void SetDecodeCacheSize(unsigned size);
+    /// Set maximum length in seconds of compressed sounds to keep fully decoded. Default 5.
+    void SetDecodeCacheMaxLength(float length);
+    /// Set whether compressed sounds not played from the decode cache are decoded ahead in a worker thread instead of the mixing thread. Has no effect without threading support. Default true.
+    void SetStreamPrefetch(bool enable);
+    /// Set physics collision mask of the rigid bodies that occlude 3D sounds from the listener. Zero (default) disables occlusion. Requires the physics subsystem and a PhysicsWorld in the listener's scene.
+    void SetOcclusionMask(unsigned mask);
+    /// Set gain multiplier of fully occluded 3D sounds. Default 0.3.
+    void SetOcclusionAttenuation(float attenuation);
+    /// Set number of 3D sound sources tested for occlusion on each update. The sources are tested in turn. Default 16.
+    void SetOcclusionRaysPerFrame(unsigned rays);
 
     /// Return byte size of one sample.
     unsigned GetSampleSize() const { return sampleSize_; }
@@ -86,6 +104,30 @@ public:
     /// Return whether an audio stream has been reserved.
     bool IsInitialized() const { return deviceID_ != 0; }
 
+    /// Return maximum number of sound sources mixed at once.
+    unsigned GetMaxVoices() const { return maxVoices_; }
+
+    /// Return number of playing sound sources virtualized in the last mix.
+    unsigned GetNumVirtualVoices() const { return numVirtualVoices_; }
+
+    /// Return memory budget in bytes for fully decoded short compressed sounds.
+    unsigned GetDecodeCacheSize() const;
+    /// Return maximum length in seconds of compressed sounds to keep fully decoded.
+    float GetDecodeCacheMaxLength() const;
+    /// Return memory use of fully decoded compressed sounds in bytes.
+    unsigned GetDecodeCacheUse() const;
+    /// Return whether compressed sounds are decoded ahead in a worker thread.
+    bool GetStreamPrefetch() const;
+
+    /// Return physics collision mask of the rigid bodies that occlude 3D sounds.
+    unsigned GetOcclusionMask() const { return occlusionMask_; }
+
+    /// Return gain multiplier of fully occluded 3D sounds.
+    float GetOcclusionAttenuation() const { return occlusionAttenuation_; }
+
+    /// Return number of 3D sound sources tested for occlusion on each update.
+    unsigned GetOcclusionRaysPerFrame() const { return occlusionRaysPerFrame_; }
+
     /// Return master gain for a specific sound source type. Unknown sound types will return full gain (1).
     float GetMasterGain(const String& type) const;
 
@@ -105,14 +147,22 @@ public:
     void AddSoundSource(SoundSource* soundSource);
     /// Remove a sound source. Called by SoundSource.
     void RemoveSoundSource(SoundSource* soundSource);
-
-    /// Return audio thread mutex.
-    Mutex& GetMutex() { return audioMutex_; }
+    /// Add a 3D sound source to calculate attenuation for. Called by SoundSource3D.
+    void AddSoundSource3D(SoundSource3D* soundSource);
+    /// Remove a 3D sound source. Called by SoundSource3D.
+    void RemoveSoundSource3D(SoundSource3D* soundSource);
+
+    /// Queue a command to the mixing thread. Never blocks; if the queue is full, the command is queued again on the next update. Called by SoundSource.
+    void QueueCommand(const AudioCommand& command);
+    /// Keep an object referenced by the mixing thread alive until the commands queued so far have been applied. Called by SoundSource.
+    void ReleaseAfterMix(RefCounted* object);
+    /// Return a new decoder sound stream for a compressed sound, using the decode cache or decoding ahead if possible. Called by SoundSource.
+    SharedPtr<SoundStream> GetDecoderStream(Sound* sound);
 
     /// Return sound type specific gain multiplied by master gain.
     float GetSoundSourceMasterGain(StringHash typeHash) const;
 
-    /// Mix sound sources into the buffer.
+    /// Apply the queued commands and mix the voices into the buffer. Called from the audio device thread.
     void MixOutput(void* dest, unsigned samples);
 
 private:
@@ -122,11 +172,17 @@ private:
     void Release();
     /// Actually update sound sources with the specific timestep. Called internally.
     void UpdateInternal(float timeStep);
-
-    /// Clipping buffer for mixing.
-    SharedArrayPtr<int> clipBuffer_;
-    /// Audio thread mutex.
-    Mutex audioMutex_;
+    /// Collect the voices to mix, with the audible ones first. Return number of audible voices.
+    unsigned SelectVoices();
+    /// Write a command to the queue. Return false if the queue is full.
+    bool WriteCommand(const AudioCommand& command);
+    /// Apply the queued commands to the voices and return the new read position. Called from the mixing thread, or the main thread when there is no audio device.
+    unsigned ProcessCommands();
+    /// Queue the commands that did not fit before, and free the objects the mixing thread no longer references.
+    void UpdateCommands();
+
+    /// Floating point clipping buffer for mixing.
+    SharedArrayPtr<float> clipBuffer_;
     /// SDL audio device ID.
     unsigned deviceID_{};
     /// Sample size.
@@ -147,8 +203,42 @@ private:
     HashSet<StringHash> pausedSoundTypes_;
     /// Sound sources.
     PODVector<SoundSource*> soundSources_;
+    /// 3D sound sources.
+    PODVector<SoundSource3D*> soundSources3D_;
+    /// Attenuation calculation data of the 3D sound sources.
+    UniquePtr<SoundSource3DBatch> spatialBatch_;
+    /// Voices of the sound sources. Only accessed by the mixing thread.
+    PODVector<SoundVoice*> voices_;
+    /// Voices to mix. Only accessed by the mixing thread.
+    PODVector<SoundVoice*> mixVoices_;
+    /// Command queue ring buffer to the mixing thread.
+    PODVector<AudioCommand> commands_;
+    /// Commands that did not fit in the queue, in order.
+    PODVector<AudioCommand> overflowCommands_;
+    /// Command queue write position.
+    std::atomic<unsigned> commandWrite_{};
+    /// Command queue read position.
+    std::atomic<unsigned> commandRead_{};
+    /// Command queue position up to which the mixing thread has finished using the previous state, published at the end of each mix.
+    std::atomic<unsigned> commandMixed_{};
+    /// Objects to release, with the command queue position after which they are no longer referenced.
+    Vector<Pair<unsigned, SharedPtr<RefCounted> > > pendingReleases_;
+    /// Voices to delete, with the command queue position after which they are no longer referenced.
+    PODVector<Pair<unsigned, SoundVoice*> > pendingVoices_;
+    /// Maximum number of mixed sound sources.
+    std::atomic<unsigned> maxVoices_{};
+    /// Number of virtualized sound sources in the last mix.
+    std::atomic<unsigned> numVirtualVoices_{};
+    /// Occluding rigid body collision mask.
+    unsigned occlusionMask_{};
+    /// Gain of fully occluded 3D sounds.
+    float occlusionAttenuation_{0.3f};
+    /// Number of occlusion tests per update.
+    unsigned occlusionRaysPerFrame_{16};
     /// Sound listener.
     WeakPtr<SoundListener> listener_;
+    /// Decoder of compressed sounds.
+    SharedPtr<AudioDecoder> decoder_;
 };
 
 /// Register Audio library objects.
@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Audio/AudioDecoder.h"
+#include "../Audio/OggVorbisSoundStream.h"
+#include "../Audio/Sound.h"
+#include "../Core/Timer.h"
+
+#ifndef STB_VORBIS_HEADER_ONLY
+#define STB_VORBIS_HEADER_ONLY
+#endif
+#include <STB/stb_vorbis.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Default memory budget of the decode cache.
+static const unsigned DEFAULT_CACHE_SIZE = 16 * 1024 * 1024;
+/// Default maximum length in seconds of sounds to decode fully.
+static const float DEFAULT_CACHE_MAX_LENGTH = 5.0f;
+/// Decode ahead length in milliseconds.
+static const unsigned PREFETCH_LENGTH = 500;
+/// Decoder thread sleep time in milliseconds when there is nothing to decode.
+static const unsigned DECODER_SLEEP_TIME = 5;
+
+AudioDecoder::AudioDecoder() :
+    cacheSize_(DEFAULT_CACHE_SIZE),
+    cacheUse_(0),
+    cacheMaxLength_(DEFAULT_CACHE_MAX_LENGTH),
+    useCounter_(0),
+    numPendingDecodes_(0),
+    prefetch_(true)
+{
+}
+
+AudioDecoder::~AudioDecoder()
+{
+    Stop();
+
+    for (HashMap<const Sound*, DecodedSound>::Iterator i = cache_.Begin(); i != cache_.End(); ++i)
+    {
+        if (i->second_.job_)
+        {
+            delete[] i->second_.job_->data_;
+            delete i->second_.job_;
+        }
+    }
+}
+
+void AudioDecoder::ThreadFunction()
+{
+    while (shouldRun_)
+    {
+        bool decoded = false;
+
+        // Take one full decode, and decode it without holding the lock
+        SoundDecodeJob* job = nullptr;
+        {
+            MutexLock lock(decoderMutex_);
+            if (!jobs_.Empty())
+            {
+                job = jobs_.Front();
+                jobs_.Erase(0);
+                job->started_ = true;
+            }
+        }
+        if (job)
+        {
+            Decode(*job);
+            MutexLock lock(decoderMutex_);
+            job->finished_ = true;
+            decoded = true;
+        }
+
+        // Decode ahead for the streams. The lock is held for each stream, so that it is not freed meanwhile
+        for (unsigned i = 0;; ++i)
+        {
+            MutexLock lock(decoderMutex_);
+            if (i >= streams_.Size())
+                break;
+            if (streams_[i]->Prefetch())
+                decoded = true;
+        }
+
+        if (!decoded)
+            Time::Sleep(DECODER_SLEEP_TIME);
+    }
+}
+
+SharedPtr<SoundStream> AudioDecoder::GetDecoderStream(Sound* sound)
+{
+    if (!sound || !sound->IsCompressed())
+        return SharedPtr<SoundStream>();
+
+    // Play short sounds from the decode cache once they have been decoded
+    float length = sound->GetLength();
+    if (length <= cacheMaxLength_ && length * sound->GetFrequency() * sound->GetSampleSize() <= (float)cacheSize_)
+    {
+        HashMap<const Sound*, DecodedSound>::Iterator i = cache_.Find(sound);
+        // Decode again if the sound has been reloaded or is a new sound at the same address
+        if (i != cache_.End() && !i->second_.job_ && (i->second_.sound_.Expired() || i->second_.source_ != sound->GetData()))
+        {
+            cacheUse_ -= i->second_.dataSize_;
+            cache_.Erase(i);
+            i = cache_.End();
+        }
+
+        if (i == cache_.End())
+        {
+            DecodedSound& entry = cache_[sound];
+            entry.sound_ = sound;
+            entry.source_ = sound->GetData();
+            QueueDecode(entry);
+            i = cache_.Find(sound);
+        }
+
+        DecodedSound& entry = i->second_;
+        if (entry.data_ && entry.source_ == sound->GetData())
+        {
+            entry.lastUse_ = ++useCounter_;
+            return SharedPtr<SoundStream>(new OggVorbisSoundStream(sound, entry.data_, entry.dataSize_));
+        }
+    }
+
+    SharedPtr<OggVorbisSoundStream> stream(new OggVorbisSoundStream(sound));
+    if (prefetch_ && StartThread())
+    {
+        stream->SetPrefetch(stream->GetSampleSize() * sound->GetIntFrequency() * PREFETCH_LENGTH / 1000);
+
+        MutexLock lock(decoderMutex_);
+        streams_.Push(stream);
+    }
+
+    return SharedPtr<SoundStream>(stream);
+}
+
+void AudioDecoder::Update()
+{
+    // Stop decoding ahead for the streams only referenced by the decoder
+    for (unsigned i = 0; i < streams_.Size(); ++i)
+    {
+        if (streams_[i]->Refs() == 1)
+        {
+            MutexLock lock(decoderMutex_);
+            for (unsigned j = streams_.Size() - 1; j < streams_.Size(); --j)
+            {
+                if (streams_[j]->Refs() == 1)
+                    streams_.Erase(j);
+            }
+            break;
+        }
+    }
+
+    if (!numPendingDecodes_)
+        return;
+
+    MutexLock lock(decoderMutex_);
+
+    for (HashMap<const Sound*, DecodedSound>::Iterator i = cache_.Begin(); i != cache_.End();)
+    {
+        DecodedSound& entry = i->second_;
+        if (!entry.job_ || !entry.job_->finished_)
+        {
+            ++i;
+            continue;
+        }
+
+        SoundDecodeJob* job = entry.job_;
+        entry.job_ = nullptr;
+        --numPendingDecodes_;
+
+        // Keep the decoded samples if the sound still exists unchanged, and they fit the budget
+        if (job->data_ && !entry.sound_.Expired() && entry.source_ == entry.sound_->GetData() && job->dataSize_ <= cacheSize_)
+        {
+            FreeCache(cacheSize_ - job->dataSize_);
+            entry.data_ = job->data_;
+            entry.dataSize_ = job->dataSize_;
+            entry.lastUse_ = ++useCounter_;
+            cacheUse_ += entry.dataSize_;
+            delete job;
+            ++i;
+        }
+        else
+        {
+            delete[] job->data_;
+            delete job;
+            i = cache_.Erase(i);
+        }
+    }
+}
+
+void AudioDecoder::SetCacheSize(unsigned size)
+{
+    cacheSize_ = size;
+    FreeCache(size);
+}
+
+void AudioDecoder::SetCacheMaxLength(float length)
+{
+    cacheMaxLength_ = Max(length, 0.0f);
+}
+
+void AudioDecoder::SetPrefetch(bool enable)
+{
+    prefetch_ = enable;
+}
+
+bool AudioDecoder::Decode(SoundDecodeJob& job)
+{
+    int error;
+    stb_vorbis* vorbis = stb_vorbis_open_memory((const unsigned char*)job.source_, job.sourceSize_, &error, nullptr);
+    if (!vorbis)
+        return false;
+
+    stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+    unsigned channels = info.channels > 1 ? 2 : 1;
+    unsigned numShorts = stb_vorbis_stream_length_in_samples(vorbis) * channels;
+
+    job.data_ = new signed char[numShorts * sizeof(short)];
+    auto outSamples = (unsigned)stb_vorbis_get_samples_short_interleaved(vorbis, channels, (short*)job.data_, numShorts);
+    job.dataSize_ = outSamples * channels * sizeof(short);
+    stb_vorbis_close(vorbis);
+    return true;
+}
+
+bool AudioDecoder::StartThread()
+{
+    return IsStarted() || Run();
+}
+
+void AudioDecoder::QueueDecode(DecodedSound& entry)
+{
+    auto* job = new SoundDecodeJob();
+    job->source_ = entry.source_.Get();
+    job->sourceSize_ = entry.sound_->GetDataSize();
+    entry.job_ = job;
+    ++numPendingDecodes_;
+
+    if (StartThread())
+    {
+        MutexLock lock(decoderMutex_);
+        jobs_.Push(job);
+    }
+    else
+    {
+        // Without threads, decode right away. The result is taken by the next update
+        Decode(*job);
+        job->finished_ = true;
+    }
+}
+
+void AudioDecoder::FreeCache(unsigned size)
+{
+    while (cacheUse_ > size)
+    {
+        HashMap<const Sound*, DecodedSound>::Iterator oldest = cache_.End();
+        for (HashMap<const Sound*, DecodedSound>::Iterator i = cache_.Begin(); i != cache_.End(); ++i)
+        {
+            if (i->second_.data_ && (oldest == cache_.End() || i->second_.lastUse_ < oldest->second_.lastUse_))
+                oldest = i;
+        }
+        if (oldest == cache_.End())
+            break;
+
+        // Streams playing the sound keep their own reference to the samples
+        cacheUse_ -= oldest->second_.dataSize_;
+        cache_.Erase(oldest);
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/ArrayPtr.h"
+#include "../Container/HashMap.h"
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+
+namespace Urho3D
+{
+
+class OggVorbisSoundStream;
+class Sound;
+class SoundStream;
+
+/// Full decode of a compressed sound into 16-bit samples.
+struct SoundDecodeJob
+{
+    /// Compressed sound data.
+    const signed char* source_{};
+    /// Compressed sound data size in bytes.
+    unsigned sourceSize_{};
+    /// Decoded sample data.
+    signed char* data_{};
+    /// Decoded sample data size in bytes.
+    unsigned dataSize_{};
+    /// Whether the decoder thread has taken the job.
+    bool started_{};
+    /// Whether decoding has finished.
+    bool finished_{};
+};
+
+/// Fully decoded compressed sound in the decode cache.
+struct DecodedSound
+{
+    /// Sound.
+    WeakPtr<Sound> sound_;
+    /// Compressed sound data the samples were decoded from.
+    SharedArrayPtr<signed char> source_;
+    /// Decoded sample data.
+    SharedArrayPtr<signed char> data_;
+    /// Decoded sample data size in bytes.
+    unsigned dataSize_{};
+    /// Counter value of the last use.
+    unsigned lastUse_{};
+    /// Decode in progress.
+    SoundDecodeJob* job_{};
+};
+
+/// Decoder of compressed sounds outside the mixing thread. Keeps a cache of fully decoded short sounds, and decodes the longer ones ahead into the ring buffers of their streams in a worker thread. Owned by the audio subsystem.
+class URHO3D_API AudioDecoder : public RefCounted, public Thread
+{
+public:
+    /// Construct. Does not start the decoder thread yet.
+    AudioDecoder();
+    /// Destruct. Stop the decoder thread and free the decode cache.
+    ~AudioDecoder() override;
+
+    /// Decode in the worker thread.
+    void ThreadFunction() override;
+
+    /// Return a new decoder stream for a compressed sound, playing from the decode cache if possible. Otherwise start decoding the sound for the cache, or decode it ahead in the worker thread. Called from the main thread.
+    SharedPtr<SoundStream> GetDecoderStream(Sound* sound);
+    /// Move finished decodes to the cache and stop decoding ahead for streams no longer in use. Called from the main thread.
+    void Update();
+    /// Set memory budget of the decode cache in bytes. Zero disables the cache.
+    void SetCacheSize(unsigned size);
+    /// Set maximum length in seconds of sounds to decode fully.
+    void SetCacheMaxLength(float length);
+    /// Set whether to decode streams ahead in the worker thread.
+    void SetPrefetch(bool enable);
+
+    /// Return memory budget of the decode cache in bytes.
+    unsigned GetCacheSize() const { return cacheSize_; }
+
+    /// Return maximum length in seconds of sounds to decode fully.
+    float GetCacheMaxLength() const { return cacheMaxLength_; }
+
+    /// Return memory use of the decode cache in bytes.
+    unsigned GetCacheUse() const { return cacheUse_; }
+
+    /// Return whether streams are decoded ahead in the worker thread.
+    bool GetPrefetch() const { return prefetch_; }
+
+    /// Decode a compressed sound fully. Return true if successful.
+    static bool Decode(SoundDecodeJob& job);
+
+private:
+    /// Start the decoder thread if not started yet. Return true if running.
+    bool StartThread();
+    /// Queue a full decode, or decode right away if threads are not available.
+    void QueueDecode(DecodedSound& entry);
+    /// Free the least recently used decoded sounds until the cache fits the given memory use.
+    void FreeCache(unsigned size);
+
+    /// Mutex for the jobs and streams shared with the decoder thread.
+    Mutex decoderMutex_;
+    /// Full decodes waiting for the decoder thread.
+    PODVector<SoundDecodeJob*> jobs_;
+    /// Streams to decode ahead.
+    Vector<SharedPtr<OggVorbisSoundStream> > streams_;
+    /// Decoded sounds.
+    HashMap<const Sound*, DecodedSound> cache_;
+    /// Memory budget of the decode cache in bytes.
+    unsigned cacheSize_;
+    /// Memory use of the decode cache in bytes.
+    unsigned cacheUse_;
+    /// Maximum length in seconds of sounds to decode fully.
+    float cacheMaxLength_;
+    /// Counter for the least recently used order.
+    unsigned useCounter_;
+    /// Number of full decodes in progress.
+    unsigned numPendingDecodes_;
+    /// Decode ahead flag.
+    bool prefetch_;
+};
+
+}
@@ -32,6 +32,9 @@
 namespace Urho3D
 {
 
+/// Maximum bytes decoded ahead at once.
+static const unsigned PREFETCH_CHUNK_SIZE = 8192;
+
 OggVorbisSoundStream::OggVorbisSoundStream(const Sound* sound)
 {
     assert(sound && sound->IsCompressed());
@@ -47,6 +50,18 @@ OggVorbisSoundStream::OggVorbisSoundStream(const Sound* sound)
     decoder_ = stb_vorbis_open_memory((unsigned char*)data_.Get(), dataSize_, &error, nullptr);
 }
 
+OggVorbisSoundStream::OggVorbisSoundStream(const Sound* sound, const SharedArrayPtr<signed char>& decodedData, unsigned decodedSize) :
+    decoder_(nullptr),
+    dataSize_(0),
+    decodedData_(decodedData),
+    decodedSize_(decodedSize)
+{
+    assert(sound && sound->IsCompressed());
+
+    SetFormat(sound->GetIntFrequency(), sound->IsSixteenBit(), sound->IsStereo());
+    SetStopAtEnd(!sound->IsLooped());
+}
+
 OggVorbisSoundStream::~OggVorbisSoundStream()
 {
     // Close decoder
@@ -61,9 +76,27 @@ OggVorbisSoundStream::~OggVorbisSoundStream()
 
 bool OggVorbisSoundStream::Seek(unsigned sample_number)
 {
+    if (decodedData_)
+    {
+        unsigned position = sample_number * GetSampleSize();
+        if (position > decodedSize_)
+            return false;
+
+        decodedPosition_ = position;
+        return true;
+    }
+
     if (!decoder_)
         return false;
 
+    // When decoding ahead, the decoder thread seeks and discards the decoded samples
+    if (prefetchBuffer_)
+    {
+        seekSample_.store(sample_number, std::memory_order_relaxed);
+        seekRequest_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
     auto* vorbis = static_cast<stb_vorbis*>(decoder_);
 
     return stb_vorbis_seek(vorbis, sample_number) == 1;
@@ -71,9 +104,119 @@ bool OggVorbisSoundStream::Seek(unsigned sample_number)
 
 unsigned OggVorbisSoundStream::GetData(signed char* dest, unsigned numBytes)
 {
+    if (decodedData_)
+    {
+        // Copy from the decode cache, rewinding if looping
+        unsigned outBytes = 0;
+        while (outBytes < numBytes)
+        {
+            if (decodedPosition_ >= decodedSize_)
+            {
+                if (stopAtEnd_ || !decodedSize_)
+                    break;
+                decodedPosition_ = 0;
+            }
+
+            unsigned copySize = Min(numBytes - outBytes, decodedSize_ - decodedPosition_);
+            memcpy(dest + outBytes, decodedData_.Get() + decodedPosition_, copySize);
+            decodedPosition_ += copySize;
+            outBytes += copySize;
+        }
+
+        return outBytes;
+    }
+
+    if (prefetchBuffer_)
+    {
+        // Output silence until the decoder thread has seeked
+        if (seekDone_.load(std::memory_order_acquire) != seekRequest_.load(std::memory_order_relaxed))
+        {
+            memset(dest, 0, numBytes);
+            return numBytes;
+        }
+
+        bool ended = prefetchEnded_.load(std::memory_order_acquire);
+        unsigned read = prefetchRead_.load(std::memory_order_relaxed);
+        unsigned outBytes = Min(prefetchWrite_.load(std::memory_order_acquire) - read, numBytes);
+        unsigned offset = read & (prefetchSize_ - 1);
+        unsigned firstSize = Min(outBytes, prefetchSize_ - offset);
+        memcpy(dest, prefetchBuffer_.Get() + offset, firstSize);
+        memcpy(dest + firstSize, prefetchBuffer_.Get(), outBytes - firstSize);
+        prefetchRead_.store(read + outBytes, std::memory_order_release);
+
+        // If the decoder thread has fallen behind, output silence instead of stopping
+        if (outBytes < numBytes && !ended)
+        {
+            memset(dest + outBytes, 0, numBytes - outBytes);
+            outBytes = numBytes;
+        }
+
+        return outBytes;
+    }
+
     if (!decoder_)
         return 0;
 
+    return Decode(dest, numBytes);
+}
+
+void OggVorbisSoundStream::SetPrefetch(unsigned bufferSize)
+{
+    if (!decoder_ || prefetchBuffer_)
+        return;
+
+    prefetchSize_ = NextPowerOfTwo(Max(bufferSize, PREFETCH_CHUNK_SIZE));
+    prefetchBuffer_ = new signed char[prefetchSize_];
+
+    // Decode the start right away, so that playback does not begin with an underrun
+    while (prefetchWrite_.load(std::memory_order_relaxed) < prefetchSize_ / 4 && Prefetch())
+        ;
+}
+
+bool OggVorbisSoundStream::Prefetch()
+{
+    if (!decoder_ || !prefetchBuffer_)
+        return false;
+
+    auto* vorbis = static_cast<stb_vorbis*>(decoder_);
+
+    // Seek if requested. The mixing thread does not read while a seek is pending, so the ring buffer can be emptied
+    unsigned request = seekRequest_.load(std::memory_order_acquire);
+    if (request != seekDone_.load(std::memory_order_relaxed))
+    {
+        stb_vorbis_seek(vorbis, seekSample_.load(std::memory_order_relaxed));
+        prefetchWrite_.store(prefetchRead_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        prefetchEnded_.store(false, std::memory_order_relaxed);
+        seekDone_.store(request, std::memory_order_release);
+    }
+
+    if (prefetchEnded_.load(std::memory_order_relaxed))
+        return false;
+
+    // Decode into the free space after the write position, up to the end of the ring buffer. All writes are whole
+    // samples, so they never straddle the end
+    unsigned write = prefetchWrite_.load(std::memory_order_relaxed);
+    unsigned freeSize = prefetchSize_ - (write - prefetchRead_.load(std::memory_order_acquire));
+    unsigned offset = write & (prefetchSize_ - 1);
+    unsigned numBytes = Min(Min(freeSize, prefetchSize_ - offset), PREFETCH_CHUNK_SIZE);
+    numBytes -= numBytes % GetSampleSize();
+    if (!numBytes)
+        return false;
+
+    unsigned outBytes = Decode(prefetchBuffer_.Get() + offset, numBytes);
+    if (!outBytes)
+    {
+        if (stopAtEnd_)
+            prefetchEnded_.store(true, std::memory_order_release);
+        return false;
+    }
+
+    prefetchWrite_.store(write + outBytes, std::memory_order_release);
+    return true;
+}
+
+unsigned OggVorbisSoundStream::Decode(signed char* dest, unsigned numBytes)
+{
     auto* vorbis = static_cast<stb_vorbis*>(decoder_);
 
     unsigned channels = stereo_ ? 2 : 1;
@@ -25,6 +25,8 @@
 #include "../Audio/SoundStream.h"
 #include "../Container/ArrayPtr.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -36,6 +38,8 @@ class URHO3D_API OggVorbisSoundStream : public SoundStream
 public:
     /// Construct from an Ogg Vorbis compressed sound.
     explicit OggVorbisSoundStream(const Sound* sound);
+    /// Construct to play the fully decoded samples of an Ogg Vorbis compressed sound.
+    OggVorbisSoundStream(const Sound* sound, const SharedArrayPtr<signed char>& decodedData, unsigned decodedSize);
     /// Destruct.
     ~OggVorbisSoundStream() override;
 
@@ -45,13 +49,46 @@ public:
     /// Produce sound data into destination. Return number of bytes produced. Called by SoundSource from the mixing thread.
     unsigned GetData(signed char* dest, unsigned numBytes) override;
 
+    /// Enable decoding ahead into a ring buffer by Prefetch() calls from another thread, so that the mixing thread only copies the samples. Decodes the start of the sound right away. Must be called before playback.
+    void SetPrefetch(unsigned bufferSize);
+    /// Decode ahead into the ring buffer. Return true if samples were decoded. Called from the decoder thread.
+    bool Prefetch();
+
+    /// Return whether decodes ahead.
+    bool IsPrefetching() const { return prefetchBuffer_.NotNull(); }
+
 protected:
+    /// Decode samples into destination, rewinding if looped. Return number of bytes produced.
+    unsigned Decode(signed char* dest, unsigned numBytes);
+
     /// Decoder state.
     void* decoder_;
     /// Compressed sound data.
     SharedArrayPtr<signed char> data_;
     /// Compressed sound data size in bytes.
     unsigned dataSize_;
+    /// Fully decoded sample data when playing from the decode cache.
+    SharedArrayPtr<signed char> decodedData_;
+    /// Fully decoded sample data size in bytes.
+    unsigned decodedSize_{};
+    /// Byte position in the fully decoded sample data.
+    unsigned decodedPosition_{};
+    /// Decode ahead ring buffer.
+    SharedArrayPtr<signed char> prefetchBuffer_;
+    /// Decode ahead ring buffer size in bytes, a power of two.
+    unsigned prefetchSize_{};
+    /// Total bytes written to the ring buffer by the decoder thread.
+    std::atomic<unsigned> prefetchWrite_{};
+    /// Total bytes read from the ring buffer by the mixing thread.
+    std::atomic<unsigned> prefetchRead_{};
+    /// Seek request counter, incremented by the mixing thread.
+    std::atomic<unsigned> seekRequest_{};
+    /// Seek request counter value last completed by the decoder thread.
+    std::atomic<unsigned> seekDone_{};
+    /// Sample number of the last seek request.
+    std::atomic<unsigned> seekSample_{};
+    /// Set by the decoder thread when a non-looping sound has been decoded to the end.
+    std::atomic<bool> prefetchEnded_{};
 };
 
 }
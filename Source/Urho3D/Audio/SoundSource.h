@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Audio/AudioDefs.h"
+#include "../Audio/SoundVoice.h"
 #include "../Scene/Component.h"
 
 namespace Urho3D
@@ -72,6 +73,8 @@ public:
     void SetAttenuation(float attenuation);
     /// Set stereo panning. -1.0 is full left and 1.0 is full right.
     void SetPanning(float panning);
+    /// Set voice priority. When the audio subsystem limits the number of mixed voices, higher priority sources are mixed first, then the most audible.
+    void SetPriority(int priority);
     /// Set to remove either the sound source component or its owner node from the scene automatically on sound playback completion. Disabled by default.
     void SetAutoRemoveMode(AutoRemoveMode mode);
     /// Set new playback position.
@@ -80,14 +83,14 @@ public:
     /// Return sound.
     Sound* GetSound() const { return sound_; }
 
-    /// Return playback position.
-    volatile signed char* GetPlayPosition() const { return position_; }
+    /// Return playback position as last mixed.
+    signed char* GetPlayPosition() const;
 
     /// Return sound type, determines the master gain group.
     String GetSoundType() const { return soundType_; }
 
-    /// Return playback time position.
-    float GetTimePosition() const { return timePosition_; }
+    /// Return playback time position as last mixed.
+    float GetTimePosition() const;
 
     /// Return frequency.
     float GetFrequency() const { return frequency_; }
@@ -101,6 +104,12 @@ public:
     /// Return stereo panning.
     float GetPanning() const { return panning_; }
 
+    /// Return voice priority.
+    int GetPriority() const { return priority_; }
+
+    /// Return gain multiplied by attenuation and the master gain of the sound type.
+    float GetEffectiveGain() const { return masterGain_ * attenuation_ * gain_; }
+
     /// Return automatic removal mode on sound playback completion.
     AutoRemoveMode GetAutoRemoveMode() const { return autoRemove_; }
 
@@ -109,10 +118,13 @@ public:
 
     /// Update the sound source. Perform subclass specific operations. Called by Audio.
     virtual void Update(float timeStep);
-    /// Mix sound source output to a 32-bit clipping buffer. Called by Audio.
-    void Mix(int* dest, unsigned samples, int mixRate, bool stereo, bool interpolation);
     /// Update the effective master gain. Called internally and by Audio when the master gain changes.
     void UpdateMasterGain();
+    /// Send the playback parameters to the mixing thread if they have changed. Called internally and by Audio.
+    void UpdateVoiceParams();
+
+    /// Return the mixing state. Only accessed by the mixing thread, apart from its status values.
+    SoundVoice* GetVoice() const { return voice_; }
 
     /// Set sound attribute.
     void SetSoundAttr(const ResourceRef& value);
@@ -142,55 +154,35 @@ protected:
     float panning_;
     /// Effective master gain.
     float masterGain_{};
+    /// Voice priority.
+    int priority_;
     /// Whether finished event should be sent on playback stop.
     bool sendFinishedEvent_;
     /// Automatic removal mode.
     AutoRemoveMode autoRemove_;
 
 private:
-    /// Play a sound without locking the audio mutex. Called internally.
-    void PlayLockless(Sound* sound);
-    /// Play a sound stream without locking the audio mutex. Called internally.
-    void PlayLockless(const SharedPtr<SoundStream>& stream);
-    /// Stop sound without locking the audio mutex. Called internally.
-    void StopLockless();
-    /// Set new playback position without locking the audio mutex. Called internally.
-    void SetPlayPositionLockless(signed char* pos);
-    /// Mix mono sample to mono buffer.
-    void MixMonoToMono(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer.
-    void MixMonoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to mono buffer interpolated.
-    void MixMonoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer interpolated.
-    void MixMonoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer.
-    void MixStereoToMono(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer.
-    void MixStereoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer interpolated.
-    void MixStereoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer interpolated.
-    void MixStereoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Advance playback pointer without producing audible output.
-    void MixZeroVolume(Sound* sound, unsigned samples, int mixRate);
-    /// Advance playback pointer to simulate audio playback in headless mode.
-    void MixNull(float timeStep);
+    /// Start playing a sound, or the decoder stream of a compressed sound. Called internally.
+    void PlayInternal(Sound* sound);
+    /// Start playing a sound stream. Called internally.
+    void PlayInternal(const SharedPtr<SoundStream>& stream);
+    /// Stop playback and queue the stream for release. Called internally.
+    void StopInternal();
+    /// Release the sound stream and decode buffer once the mixing thread no longer uses them. Called internally.
+    void ReleaseStream();
 
     /// Sound that is being played.
     SharedPtr<Sound> sound_;
     /// Sound stream that is being played.
     SharedPtr<SoundStream> soundStream_;
-    /// Playback position.
-    volatile signed char* position_;
-    /// Playback fractional position.
-    volatile int fractPosition_;
-    /// Playback time position.
-    volatile float timePosition_;
     /// Decode buffer.
     SharedPtr<Sound> streamBuffer_;
-    /// Unused stream bytes from previous frame.
-    int unusedStreamSize_;
+    /// Mixing state. Deleted by the audio subsystem after the mixing thread has removed it.
+    SoundVoice* voice_;
+    /// Playback parameters last sent to the mixing thread.
+    SoundVoiceParams voiceParams_;
+    /// ID of the current playback, or zero if stopped.
+    unsigned playId_;
 };
 
 }
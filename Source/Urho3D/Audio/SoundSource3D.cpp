@@ -28,7 +28,11 @@
 #include "../Audio/SoundSource3D.h"
 #include "../Core/Context.h"
 #include "../Graphics/DebugRenderer.h"
-#include "../Scene/Node.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/PhysicsWorld.h"
+#include "../Physics/RigidBody.h"
+#endif
+#include "../Scene/Scene.h"
 
 namespace Urho3D
 {
@@ -40,6 +44,10 @@ static const float DEFAULT_ANGLE = 360.0f;
 static const float MIN_ROLLOFF = 0.1f;
 static const Color INNER_COLOR(1.0f, 0.5f, 1.0f);
 static const Color OUTER_COLOR(1.0f, 0.0f, 1.0f);
+/// Occlusion amount change per second.
+static const float OCCLUSION_FADE_SPEED = 4.0f;
+/// Distance from the source at which occlusion rays stop.
+static const float OCCLUSION_MARGIN = 0.1f;
 
 extern const char* AUDIO_CATEGORY;
 
@@ -49,10 +57,22 @@ SoundSource3D::SoundSource3D(Context* context) :
     farDistance_(DEFAULT_FARDISTANCE),
     innerAngle_(DEFAULT_ANGLE),
     outerAngle_(DEFAULT_ANGLE),
-    rolloffFactor_(DEFAULT_ROLLOFF)
+    rolloffFactor_(DEFAULT_ROLLOFF),
+    occlusion_(0.0f),
+    occluded_(false),
+    attenuationUpdated_(false)
 {
     // Start from zero volume until attenuation properly calculated
     attenuation_ = 0.0f;
+
+    if (audio_)
+        audio_->AddSoundSource3D(this);
+}
+
+SoundSource3D::~SoundSource3D()
+{
+    if (audio_)
+        audio_->RemoveSoundSource3D(this);
 }
 
 void SoundSource3D::RegisterObject(Context* context)
@@ -97,7 +117,11 @@ void SoundSource3D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 
 void SoundSource3D::Update(float timeStep)
 {
-    CalculateAttenuation();
+    // The attenuation is normally calculated by the audio subsystem for all 3D sources at once
+    if (!attenuationUpdated_)
+        CalculateAttenuation();
+    attenuationUpdated_ = false;
+
     SoundSource::Update(timeStep);
 }
 
@@ -173,29 +197,8 @@ void SoundSource3D::CalculateAttenuation()
             // Panning
             panning_ = relativePos.Normalized().x_;
 
-            // Angle attenuation
-            if (innerAngle_ < DEFAULT_ANGLE && outerAngle_ > 0.0f)
-            {
-                Vector3 listenerRelativePos
-                    (node_->GetWorldRotation().Inverse() * (listenerNode->GetWorldPosition() - node_->GetWorldPosition()));
-                float listenerDot = Vector3::FORWARD.DotProduct(listenerRelativePos.Normalized());
-                float listenerAngle = acosf(listenerDot) * M_RADTODEG * 2.0f;
-                float angleInterval = Max(outerAngle_ - innerAngle_, 0.0f);
-                float angleAttenuation = 1.0f;
-
-                if (angleInterval > 0.0f)
-                {
-                    if (listenerAngle > innerAngle_)
-                    {
-                        angleAttenuation = powf(1.0f - Clamp(listenerAngle - innerAngle_, 0.0f, angleInterval) / angleInterval,
-                            rolloffFactor_);
-                    }
-                }
-                else
-                    angleAttenuation = listenerAngle <= innerAngle_ ? 1.0f : 0.0f;
-
-                attenuation_ *= angleAttenuation;
-            }
+            // Angle attenuation and occlusion
+            attenuation_ *= GetAngleAttenuation(listenerNode->GetWorldPosition()) * GetOcclusionGain();
         }
         else
             attenuation_ = 0.0f;
@@ -204,4 +207,170 @@ void SoundSource3D::CalculateAttenuation()
         attenuation_ = 0.0f;
 }
 
+void SoundSource3D::CalculateAttenuations(SoundSource3DBatch& batch, Audio* audio, float timeStep)
+{
+    const PODVector<SoundSource3D*>& sources = batch.sources_;
+    unsigned numSources = sources.Size();
+
+    SoundListener* listener = audio->GetListener();
+    if (!listener || !listener->IsEnabledEffective())
+    {
+        for (unsigned i = 0; i < numSources; ++i)
+        {
+            sources[i]->attenuation_ = 0.0f;
+            sources[i]->attenuationUpdated_ = true;
+        }
+        return;
+    }
+
+    batch.positions_.Resize(numSources);
+    batch.distances_.Resize(numSources);
+    batch.nearDistances_.Resize(numSources);
+    batch.intervals_.Resize(numSources);
+    batch.rolloffFactors_.Resize(numSources);
+    batch.attenuations_.Resize(numSources);
+    Vector3* positions = batch.positions_.Buffer();
+    float* distances = batch.distances_.Buffer();
+    float* nearDistances = batch.nearDistances_.Buffer();
+    float* intervals = batch.intervals_.Buffer();
+    float* rolloffFactors = batch.rolloffFactors_.Buffer();
+    float* attenuations = batch.attenuations_.Buffer();
+
+    // Gather the positions in listener space with one transform, and the attenuation parameters. Sources without a node,
+    // or in a different scene than the listener, are silenced
+    Node* listenerNode = listener->GetNode();
+    Scene* listenerScene = listener->GetScene();
+    Vector3 listenerPosition = listenerNode->GetWorldPosition();
+    Matrix3x4 listenerInverse = Matrix3x4(listenerPosition, listenerNode->GetWorldRotation(), 1.0f).Inverse();
+    for (unsigned i = 0; i < numSources; ++i)
+    {
+        SoundSource3D* source = sources[i];
+        if (source->node_ && (!listenerScene || listenerScene == source->GetScene()))
+        {
+            positions[i] = listenerInverse * source->node_->GetWorldPosition();
+            nearDistances[i] = source->nearDistance_;
+            intervals[i] = source->farDistance_ - source->nearDistance_;
+            rolloffFactors[i] = source->rolloffFactor_;
+        }
+        else
+        {
+            positions[i] = Vector3::ZERO;
+            nearDistances[i] = -1.0f;
+            intervals[i] = 0.0f;
+            rolloffFactors[i] = 1.0f;
+        }
+    }
+
+    // Distance attenuation
+    for (unsigned i = 0; i < numSources; ++i)
+    {
+        const Vector3& pos = positions[i];
+        float distance = sqrtf(pos.x_ * pos.x_ + pos.y_ * pos.y_ + pos.z_ * pos.z_);
+        float interval = intervals[i];
+        distances[i] = distance;
+
+        if (interval > 0.0f)
+        {
+            float attenuation = 1.0f - Clamp(distance - nearDistances[i], 0.0f, interval) / interval;
+            float rolloff = rolloffFactors[i];
+            attenuations[i] = rolloff == 2.0f ? attenuation * attenuation : powf(attenuation, rolloff);
+        }
+        else
+            attenuations[i] = distance <= nearDistances[i] ? 1.0f : 0.0f;
+    }
+
+    // Test a limited number of audible sources for occlusion each update
+#ifdef URHO3D_PHYSICS
+    unsigned occlusionMask = audio->GetOcclusionMask();
+    PhysicsWorld* physicsWorld = occlusionMask && listenerScene ? listenerScene->GetComponent<PhysicsWorld>() : nullptr;
+    if (physicsWorld && numSources)
+    {
+        PODVector<PhysicsRaycastQuery> queries;
+        PODVector<unsigned> queryIndices;
+        unsigned numTests = Min(audio->GetOcclusionRaysPerFrame(), numSources);
+        for (unsigned j = 0; j < numTests; ++j)
+        {
+            unsigned i = (batch.occlusionIndex_ + j) % numSources;
+            if (attenuations[i] <= 0.0f || distances[i] <= OCCLUSION_MARGIN)
+            {
+                sources[i]->occluded_ = false;
+                continue;
+            }
+
+            PhysicsRaycastQuery query;
+            query.ray_ = Ray(listenerPosition, sources[i]->node_->GetWorldPosition() - listenerPosition);
+            query.maxDistance_ = distances[i] - OCCLUSION_MARGIN;
+            query.collisionMask_ = occlusionMask;
+            queries.Push(query);
+            queryIndices.Push(i);
+        }
+        batch.occlusionIndex_ = (batch.occlusionIndex_ + numTests) % numSources;
+
+        PODVector<PhysicsRaycastResult> results;
+        physicsWorld->RaycastSingleBatch(results, queries);
+        for (unsigned j = 0; j < results.Size(); ++j)
+        {
+            // Do not count the bodies the source or the listener are attached to
+            SoundSource3D* source = sources[queryIndices[j]];
+            Node* hitNode = results[j].body_ ? results[j].body_->GetNode() : nullptr;
+            source->occluded_ = hitNode && hitNode != source->node_ && !source->node_->IsChildOf(hitNode) &&
+                hitNode != listenerNode && !listenerNode->IsChildOf(hitNode);
+        }
+    }
+    else
+#endif
+    {
+        for (unsigned i = 0; i < numSources; ++i)
+            sources[i]->occluded_ = false;
+    }
+
+    // Fade the occlusion, apply the angle attenuation for directional sources and write the results
+    float occlusionFade = timeStep * OCCLUSION_FADE_SPEED;
+    for (unsigned i = 0; i < numSources; ++i)
+    {
+        SoundSource3D* source = sources[i];
+        if (source->occluded_)
+            source->occlusion_ = Min(source->occlusion_ + occlusionFade, 1.0f);
+        else
+            source->occlusion_ = Max(source->occlusion_ - occlusionFade, 0.0f);
+
+        float attenuation = attenuations[i];
+        if (nearDistances[i] >= 0.0f)
+        {
+            if (attenuation > 0.0f)
+                attenuation *= source->GetAngleAttenuation(listenerPosition) * source->GetOcclusionGain();
+            source->panning_ = distances[i] > 0.0f ? positions[i].x_ / distances[i] : 0.0f;
+        }
+
+        source->attenuation_ = attenuation;
+        source->attenuationUpdated_ = true;
+    }
+}
+
+float SoundSource3D::GetAngleAttenuation(const Vector3& listenerPosition) const
+{
+    if (innerAngle_ >= DEFAULT_ANGLE || outerAngle_ <= 0.0f)
+        return 1.0f;
+
+    Vector3 listenerRelativePos(node_->GetWorldRotation().Inverse() * (listenerPosition - node_->GetWorldPosition()));
+    float listenerDot = Vector3::FORWARD.DotProduct(listenerRelativePos.Normalized());
+    float listenerAngle = acosf(listenerDot) * M_RADTODEG * 2.0f;
+    float angleInterval = Max(outerAngle_ - innerAngle_, 0.0f);
+
+    if (angleInterval > 0.0f)
+    {
+        if (listenerAngle > innerAngle_)
+            return powf(1.0f - Clamp(listenerAngle - innerAngle_, 0.0f, angleInterval) / angleInterval, rolloffFactor_);
+        else
+            return 1.0f;
+    }
+    else
+        return listenerAngle <= innerAngle_ ? 1.0f : 0.0f;
+}
+
+float SoundSource3D::GetOcclusionGain() const
+{
+    return occlusion_ > 0.0f ? 1.0f - occlusion_ * (1.0f - audio_->GetOcclusionAttenuation()) : 1.0f;
+}
+
 }
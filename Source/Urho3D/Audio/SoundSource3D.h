@@ -28,15 +28,40 @@ namespace Urho3D
 {
 
 class Audio;
+class SoundSource3D;
+
+/// Scratch data for calculating the attenuation of many 3D sound sources in one pass.
+struct SoundSource3DBatch
+{
+    /// Sound sources to update.
+    PODVector<SoundSource3D*> sources_;
+    /// Source positions in listener space.
+    PODVector<Vector3> positions_;
+    /// Distances to the listener.
+    PODVector<float> distances_;
+    /// Near distances, negative for sources that are silenced.
+    PODVector<float> nearDistances_;
+    /// Far minus near distances.
+    PODVector<float> intervals_;
+    /// Rolloff factors.
+    PODVector<float> rolloffFactors_;
+    /// Distance attenuations.
+    PODVector<float> attenuations_;
+    /// Index of the next source to test for occlusion.
+    unsigned occlusionIndex_{};
+};
 
 /// %Sound source component with three-dimensional position.
 class URHO3D_API SoundSource3D : public SoundSource
 {
     URHO3D_OBJECT(SoundSource3D, SoundSource);
+    URHO3D_POOLED_OBJECT(SoundSource3D);
 
 public:
     /// Construct.
     explicit SoundSource3D(Context* context);
+    /// Destruct.
+    ~SoundSource3D() override;
     /// Register object factory.
     static void RegisterObject(Context* context);
 
@@ -61,6 +86,8 @@ public:
     void SetRolloffFactor(float factor);
     /// Calculate attenuation and panning based on current position and listener position.
     void CalculateAttenuation();
+    /// Calculate attenuation and panning of the sound sources in a batch in one pass, and test some of them for occlusion by physics geometry. Called by Audio.
+    static void CalculateAttenuations(SoundSource3DBatch& batch, Audio* audio, float timeStep);
 
     /// Return near distance.
     float GetNearDistance() const { return nearDistance_; }
@@ -77,6 +104,9 @@ public:
     /// Return rolloff power factor.
     float RollAngleoffFactor() const { return rolloffFactor_; }
 
+    /// Return occlusion amount, 0 when unoccluded and 1 when fully occluded. Fades in and out as the occlusion tests change.
+    float GetOcclusion() const { return occlusion_; }
+
 protected:
     /// Near distance.
     float nearDistance_;
@@ -88,6 +118,18 @@ protected:
     float outerAngle_;
     /// Rolloff power factor.
     float rolloffFactor_;
+    /// Occlusion amount.
+    float occlusion_;
+    /// Result of the last occlusion test.
+    bool occluded_;
+    /// Whether the attenuation has already been calculated by the audio subsystem for this update.
+    bool attenuationUpdated_;
+
+private:
+    /// Return attenuation by the direction to the listener for directional sounds.
+    float GetAngleAttenuation(const Vector3& listenerPosition) const;
+    /// Return the gain multiplier for the occlusion amount.
+    float GetOcclusionGain() const;
 };
 
 }
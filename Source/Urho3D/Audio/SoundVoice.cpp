@@ -0,0 +1,1005 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Audio/Sound.h"
+#include "../Audio/SoundStream.h"
+#include "../Audio/SoundVoice.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+#define INC_POS_LOOPED() \
+    pos += intAdd; \
+    fractPos += fractAdd; \
+    if (fractPos > 65535) \
+    { \
+        fractPos &= 65535; \
+        ++pos; \
+    } \
+    while (pos >= end) \
+        pos -= (end - repeat); \
+
+#define INC_POS_ONESHOT() \
+    pos += intAdd; \
+    fractPos += fractAdd; \
+    if (fractPos > 65535) \
+    { \
+        fractPos &= 65535; \
+        ++pos; \
+    } \
+    if (pos >= end) \
+    { \
+        pos = 0; \
+        break; \
+    } \
+
+#define INC_POS_STEREO_LOOPED() \
+    pos += ((unsigned)intAdd << 1u); \
+    fractPos += fractAdd; \
+    if (fractPos > 65535) \
+    { \
+        fractPos &= 65535; \
+        pos += 2; \
+    } \
+    while (pos >= end) \
+        pos -= (end - repeat); \
+
+#define INC_POS_STEREO_ONESHOT() \
+    pos += ((unsigned)intAdd << 1u); \
+    fractPos += fractAdd; \
+    if (fractPos > 65535) \
+    { \
+        fractPos &= 65535; \
+        pos += 2; \
+    } \
+    if (pos >= end) \
+    { \
+        pos = 0; \
+        break; \
+    } \
+
+#define GET_IP_SAMPLE() (((((int)pos[1] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
+
+#define GET_IP_SAMPLE_LEFT() (((((int)pos[2] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
+
+#define GET_IP_SAMPLE_RIGHT() (((((int)pos[3] - (int)pos[1]) * fractPos) / 65536) + (int)pos[1])
+
+static const int STREAM_SAFETY_SAMPLES = 4;
+/// Gain below which a voice is not mixed.
+static const float MIN_MIX_GAIN = 1.0f / 512.0f;
+
+void SoundVoice::Play(Sound* sound, SoundStream* stream, Sound* streamBuffer, unsigned playId)
+{
+    sound_ = sound;
+    soundStream_ = stream;
+    streamBuffer_ = streamBuffer;
+    position_ = stream ? streamBuffer->GetStart() : sound->GetStart();
+    fractPosition_ = 0;
+    timePosition_ = 0.0f;
+    unusedStreamSize_ = 0;
+    playId_ = playId;
+    resetMixGain_ = true;
+
+    UpdateStatus();
+}
+
+void SoundVoice::Stop()
+{
+    sound_ = nullptr;
+    soundStream_ = nullptr;
+    streamBuffer_ = nullptr;
+    position_ = nullptr;
+    timePosition_ = 0.0f;
+
+    UpdateStatus();
+}
+
+void SoundVoice::SetPlayPosition(unsigned offset)
+{
+    // Setting position on a stream is not supported
+    if (!sound_ || soundStream_)
+        return;
+
+    signed char* start = sound_->GetStart();
+    signed char* end = sound_->GetEnd();
+    signed char* pos = start + Min(offset, (unsigned)(end - start));
+    if (sound_->IsSixteenBit() && (pos - start) & 1u)
+        ++pos;
+    if (pos > end)
+        pos = end;
+
+    position_ = pos;
+    timePosition_ = ((float)(int)(size_t)(pos - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
+
+    UpdateStatus();
+}
+
+void SoundVoice::Seek(unsigned position, float seekTime)
+{
+    if (position_ && soundStream_ && soundStream_->Seek(position))
+    {
+        timePosition_ = seekTime;
+        UpdateStatus();
+    }
+}
+
+void SoundVoice::Mix(float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation, bool audible)
+{
+    if (!position_ || !params_.active_)
+        return;
+
+    int streamFilledSize, outBytes;
+
+    if (soundStream_ && streamBuffer_)
+    {
+        int streamBufferSize = streamBuffer_->GetDataSize();
+        // Calculate how many bytes of stream sound data is needed
+        auto neededSize = (int)((float)samples * params_.frequency_ / (float)mixRate);
+        // Add a little safety buffer. Subtract previous unused data
+        neededSize += STREAM_SAFETY_SAMPLES;
+        neededSize *= soundStream_->GetSampleSize();
+        neededSize -= unusedStreamSize_;
+        neededSize = Clamp(neededSize, 0, streamBufferSize - unusedStreamSize_);
+
+        // Always start play position at the beginning of the stream buffer
+        position_ = streamBuffer_->GetStart();
+
+        // Request new data from the stream
+        signed char* destination = streamBuffer_->GetStart() + unusedStreamSize_;
+        outBytes = neededSize ? soundStream_->GetData(destination, (unsigned)neededSize) : 0;
+        destination += outBytes;
+        // Zero-fill rest if stream did not produce enough data
+        if (outBytes < neededSize)
+            memset(destination, 0, (size_t)(neededSize - outBytes));
+
+        // Calculate amount of total bytes of data in stream buffer now, to know how much went unused after mixing
+        streamFilledSize = neededSize + unusedStreamSize_;
+    }
+
+    // If streaming, play the stream buffer. Otherwise play the original sound
+    Sound* sound = soundStream_ ? streamBuffer_ : sound_;
+    if (!sound)
+        return;
+
+    // Ramp to the current gains, or to silence if the voice has been virtualized. Stereo sounds are not panned
+    float totalGain = audible ? params_.gain_ : 0.0f;
+    if (stereo && !sound->IsStereo())
+        targetMixGain_ = Vector2((1.0f - params_.panning_) * totalGain, (1.0f + params_.panning_) * totalGain);
+    else
+        targetMixGain_ = Vector2(totalGain, totalGain);
+    if (resetMixGain_)
+    {
+        mixGain_ = targetMixGain_;
+        resetMixGain_ = false;
+    }
+
+    // Choose the correct mixing routine
+    if (!sound->IsStereo())
+    {
+        if (interpolation)
+        {
+            if (stereo)
+                MixMonoToStereoIP(sound, dest, samples, mixRate);
+            else
+                MixMonoToMonoIP(sound, dest, samples, mixRate);
+        }
+        else
+        {
+            if (stereo)
+                MixMonoToStereo(sound, dest, samples, mixRate);
+            else
+                MixMonoToMono(sound, dest, samples, mixRate);
+        }
+    }
+    else
+    {
+        if (interpolation)
+        {
+            if (stereo)
+                MixStereoToStereoIP(sound, dest, samples, mixRate);
+            else
+                MixStereoToMonoIP(sound, dest, samples, mixRate);
+        }
+        else
+        {
+            if (stereo)
+                MixStereoToStereo(sound, dest, samples, mixRate);
+            else
+                MixStereoToMono(sound, dest, samples, mixRate);
+        }
+    }
+
+    // Update the time position. In stream mode, copy unused data back to the beginning of the stream buffer
+    if (soundStream_)
+    {
+        timePosition_ += ((float)samples / (float)mixRate) * params_.frequency_ / soundStream_->GetFrequency();
+
+        unusedStreamSize_ = Max(streamFilledSize - (int)(size_t)(position_ - streamBuffer_->GetStart()), 0);
+        if (unusedStreamSize_)
+            memcpy(streamBuffer_->GetStart(), (const void*)position_, (size_t)unusedStreamSize_);
+
+        // If stream did not produce any data, stop if applicable
+        if (!outBytes && soundStream_->GetStopAtEnd())
+            position_ = nullptr;
+    }
+    else if (position_)
+        timePosition_ = ((float)(int)(size_t)(position_ - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
+
+    UpdateStatus();
+}
+
+void SoundVoice::MixNull(float timeStep)
+{
+    if (!position_ || !sound_ || !params_.active_)
+        return;
+
+    // Advance only the time position
+    timePosition_ += timeStep * params_.frequency_ / sound_->GetFrequency();
+
+    if (sound_->IsLooped())
+    {
+        // For simulated playback, simply reset the time position to zero when the sound loops
+        if (timePosition_ >= sound_->GetLength())
+            timePosition_ -= sound_->GetLength();
+    }
+    else
+    {
+        if (timePosition_ >= sound_->GetLength())
+        {
+            position_ = nullptr;
+            timePosition_ = 0.0f;
+        }
+    }
+
+    UpdateStatus();
+}
+
+void SoundVoice::MixMonoToMono(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixMonoToStereo(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float leftVol, rightVol, leftStep, rightStep;
+    if (!GetMixGain(sound, samples, leftVol, rightVol, leftStep, rightStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * leftVol;
+                ++dest;
+                *dest += (float)*pos * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * leftVol;
+                ++dest;
+                *dest += (float)*pos * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * leftVol;
+                ++dest;
+                *dest += (float)*pos * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)*pos * leftVol;
+                ++dest;
+                *dest += (float)*pos * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixMonoToMonoIP(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixMonoToStereoIP(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float leftVol, rightVol, leftStep, rightStep;
+    if (!GetMixGain(sound, samples, leftVol, rightVol, leftStep, rightStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = GET_IP_SAMPLE();
+                *dest += (float)s * leftVol;
+                ++dest;
+                *dest += (float)s * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = GET_IP_SAMPLE();
+                *dest += (float)s * leftVol;
+                ++dest;
+                *dest += (float)s * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = GET_IP_SAMPLE();
+                *dest += (float)s * leftVol;
+                ++dest;
+                *dest += (float)s * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = GET_IP_SAMPLE();
+                *dest += (float)s * leftVol;
+                ++dest;
+                *dest += (float)s * rightVol;
+                ++dest;
+                leftVol += leftStep;
+                rightVol += rightStep;
+                INC_POS_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixStereoToMono(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = ((int)pos[0] + (int)pos[1]) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = ((int)pos[0] + (int)pos[1]) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = ((int)pos[0] + (int)pos[1]) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = ((int)pos[0] + (int)pos[1]) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixStereoToStereo(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)pos[0] * vol;
+                ++dest;
+                *dest += (float)pos[1] * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)pos[0] * vol;
+                ++dest;
+                *dest += (float)pos[1] * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)pos[0] * vol;
+                ++dest;
+                *dest += (float)pos[1] * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)pos[0] * vol;
+                ++dest;
+                *dest += (float)pos[1] * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixStereoToMonoIP(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
+                *dest += (float)s * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+void SoundVoice::MixStereoToStereoIP(Sound* sound, float* dest, unsigned samples, int mixRate)
+{
+    float vol, volStep;
+    if (!GetMixGain(sound, samples, vol, volStep))
+    {
+        MixZeroVolume(sound, samples, mixRate);
+        return;
+    }
+
+    float add = params_.frequency_ / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    int fractPos = fractPosition_;
+
+    if (sound->IsSixteenBit())
+    {
+        auto* pos = (short*)position_;
+        auto* end = (short*)sound->GetEnd();
+        auto* repeat = (short*)sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE_LEFT() * vol;
+                ++dest;
+                *dest += (float)GET_IP_SAMPLE_RIGHT() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = (signed char*)pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE_LEFT() * vol;
+                ++dest;
+                *dest += (float)GET_IP_SAMPLE_RIGHT() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = (signed char*)pos;
+        }
+    }
+    else
+    {
+        auto* pos = (signed char*)position_;
+        signed char* end = sound->GetEnd();
+        signed char* repeat = sound->GetRepeat();
+
+        if (sound->IsLooped())
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE_LEFT() * vol;
+                ++dest;
+                *dest += (float)GET_IP_SAMPLE_RIGHT() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_LOOPED();
+            }
+            position_ = pos;
+        }
+        else
+        {
+            while (samples--)
+            {
+                *dest += (float)GET_IP_SAMPLE_LEFT() * vol;
+                ++dest;
+                *dest += (float)GET_IP_SAMPLE_RIGHT() * vol;
+                ++dest;
+                vol += volStep;
+                INC_POS_STEREO_ONESHOT();
+            }
+            position_ = pos;
+        }
+    }
+
+    fractPosition_ = fractPos;
+}
+
+bool SoundVoice::GetMixGain(Sound* sound, unsigned samples, float& vol, float& volStep)
+{
+    float rightVol, rightStep;
+    return GetMixGain(sound, samples, vol, rightVol, volStep, rightStep);
+}
+
+bool SoundVoice::GetMixGain(Sound* sound, unsigned samples, float& leftVol, float& rightVol, float& leftStep, float& rightStep)
+{
+    Vector2 startGain = mixGain_;
+    mixGain_ = targetMixGain_;
+    if (Max(startGain.x_, startGain.y_) < MIN_MIX_GAIN && Max(targetMixGain_.x_, targetMixGain_.y_) < MIN_MIX_GAIN)
+        return false;
+
+    // 8-bit samples are scaled up to the 16-bit range
+    float scale = sound->IsSixteenBit() ? 1.0f : 256.0f;
+    float rampScale = scale / (float)Max(samples, 1U);
+    leftVol = startGain.x_ * scale;
+    rightVol = startGain.y_ * scale;
+    leftStep = (targetMixGain_.x_ - startGain.x_) * rampScale;
+    rightStep = (targetMixGain_.y_ - startGain.y_) * rampScale;
+    return true;
+}
+
+void SoundVoice::MixZeroVolume(Sound* sound, unsigned samples, int mixRate)
+{
+    float add = params_.frequency_ * (float)samples / (float)mixRate;
+    auto intAdd = (int)add;
+    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
+    unsigned sampleSize = sound->GetSampleSize();
+
+    fractPosition_ += fractAdd;
+    if (fractPosition_ > 65535)
+    {
+        fractPosition_ &= 65535;
+        position_ += sampleSize;
+    }
+    position_ += intAdd * sampleSize;
+
+    if (position_ > sound->GetEnd())
+    {
+        if (sound->IsLooped())
+        {
+            while (position_ >= sound->GetEnd())
+            {
+                position_ -= (sound->GetEnd() - sound->GetRepeat());
+            }
+        }
+        else
+            position_ = nullptr;
+    }
+}
+
+
+void SoundVoice::UpdateStatus()
+{
+    if (position_)
+    {
+        Sound* sound = soundStream_ ? streamBuffer_ : sound_;
+        playOffset_.store((unsigned)(position_ - sound->GetStart()), std::memory_order_relaxed);
+        playTime_.store(timePosition_, std::memory_order_relaxed);
+    }
+    else
+        finishedPlayId_.store(playId_, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Math/Vector2.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+class Sound;
+class SoundStream;
+
+/// Playback parameters of a sound source, copied to its voice by the mixing thread.
+struct SoundVoiceParams
+{
+    /// Test for equality with another parameter set.
+    bool operator ==(const SoundVoiceParams& rhs) const
+    {
+        return frequency_ == rhs.frequency_ && gain_ == rhs.gain_ && panning_ == rhs.panning_ && priority_ == rhs.priority_ &&
+            active_ == rhs.active_;
+    }
+
+    /// Test for inequality with another parameter set.
+    bool operator !=(const SoundVoiceParams& rhs) const { return !(*this == rhs); }
+
+    /// Frequency.
+    float frequency_{};
+    /// Gain multiplied by attenuation and the master gain of the sound type.
+    float gain_{};
+    /// Stereo panning.
+    float panning_{};
+    /// Voice priority.
+    int priority_{};
+    /// Whether the sound source is enabled and its sound type is not paused.
+    bool active_{};
+};
+
+/// Mixing thread command type.
+enum AudioCommandType
+{
+    AUDIO_ADD_VOICE = 0,
+    AUDIO_REMOVE_VOICE,
+    AUDIO_SET_PARAMS,
+    AUDIO_PLAY,
+    AUDIO_STOP,
+    AUDIO_SET_POSITION,
+    AUDIO_SEEK
+};
+
+class SoundVoice;
+
+/// Command from the main thread to the mixing thread.
+struct AudioCommand
+{
+    /// Command type.
+    AudioCommandType type_{};
+    /// Target voice.
+    SoundVoice* voice_{};
+    /// Sound to play, or the compressed sound decoded by the stream.
+    Sound* sound_{};
+    /// Sound stream to play.
+    SoundStream* stream_{};
+    /// Decode buffer of the sound stream.
+    Sound* streamBuffer_{};
+    /// Playback ID.
+    unsigned playId_{};
+    /// Playback position in bytes, or sample position of a stream to seek to.
+    unsigned position_{};
+    /// Time position to seek to.
+    float time_{};
+    /// Playback parameters.
+    SoundVoiceParams params_;
+};
+
+/// Mixing state of a sound source. Apart from the status values, it is only accessed by the thread that mixes audio. The sounds and streams it plays are kept alive by the sound source and the audio subsystem.
+class URHO3D_API SoundVoice
+{
+public:
+    /// Start playing a sound, or a sound stream through its decode buffer.
+    void Play(Sound* sound, SoundStream* stream, Sound* streamBuffer, unsigned playId);
+    /// Stop playback.
+    void Stop();
+    /// Set new playback position in bytes from the start of the sound. Not supported for streams.
+    void SetPlayPosition(unsigned offset);
+    /// Seek a sound stream to a sample position and set the time position.
+    void Seek(unsigned position, float seekTime);
+    /// Mix output to a floating point clipping buffer in the 16-bit sample range. Gain changes are ramped over the mixed samples. When not audible, fade out and then only advance the playback position.
+    void Mix(float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation, bool audible = true);
+    /// Advance playback to simulate audio playback in headless mode.
+    void MixNull(float timeStep);
+
+    /// Return whether is playing.
+    bool IsPlaying() const { return position_ != nullptr; }
+
+    /// Playback parameters.
+    SoundVoiceParams params_;
+    /// ID of the last playback that has finished. Read by the main thread.
+    std::atomic<unsigned> finishedPlayId_{};
+    /// Playback position in bytes from the start of the sound or decode buffer. Read by the main thread.
+    std::atomic<unsigned> playOffset_{};
+    /// Playback time position. Read by the main thread.
+    std::atomic<float> playTime_{};
+
+private:
+    /// Mix mono sample to mono buffer.
+    void MixMonoToMono(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix mono sample to stereo buffer.
+    void MixMonoToStereo(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix mono sample to mono buffer interpolated.
+    void MixMonoToMonoIP(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix mono sample to stereo buffer interpolated.
+    void MixMonoToStereoIP(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix stereo sample to mono buffer.
+    void MixStereoToMono(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix stereo sample to stereo buffer.
+    void MixStereoToStereo(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix stereo sample to mono buffer interpolated.
+    void MixStereoToMonoIP(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Mix stereo sample to stereo buffer interpolated.
+    void MixStereoToStereoIP(Sound* sound, float* dest, unsigned samples, int mixRate);
+    /// Return the mono gain ramp for mixing samples, scaled to the 16-bit range of the clipping buffer, and advance the mixing gain to the target. Return false if inaudible throughout.
+    bool GetMixGain(Sound* sound, unsigned samples, float& vol, float& volStep);
+    /// Return the stereo gain ramp for mixing samples, scaled to the 16-bit range of the clipping buffer, and advance the mixing gain to the target. Return false if inaudible throughout.
+    bool GetMixGain(Sound* sound, unsigned samples, float& leftVol, float& rightVol, float& leftStep, float& rightStep);
+    /// Advance playback pointer without producing audible output.
+    void MixZeroVolume(Sound* sound, unsigned samples, int mixRate);
+    /// Publish the playback position to the main thread, and the playback ID if playback has finished.
+    void UpdateStatus();
+
+    /// Sound that is being played.
+    Sound* sound_{};
+    /// Sound stream that is being played.
+    SoundStream* soundStream_{};
+    /// Decode buffer.
+    Sound* streamBuffer_{};
+    /// Playback position.
+    signed char* position_{};
+    /// Playback fractional position.
+    int fractPosition_{};
+    /// Playback time position.
+    float timePosition_{};
+    /// Unused stream bytes from previous frame.
+    int unusedStreamSize_{};
+    /// ID of the current playback.
+    unsigned playId_{};
+    /// Left and right gains at the end of the previous mix.
+    Vector2 mixGain_;
+    /// Left and right gains to ramp to during the current mix.
+    Vector2 targetMixGain_;
+    /// Start the next mix at the target gains instead of ramping, set when playback starts.
+    bool resetMixGain_{true};
+};
+
+}
@@ -0,0 +1,375 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/AllocationTracker.h"
+#include "../Container/Sort.h"
+#include "../Container/Str.h"
+#include "../Container/Vector.h"
+#include "../Core/Mutex.h"
+#include "../Math/MathDefs.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define URHO3D_EXECINFO
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Number of distinct call stacks kept. Further call stacks are not recorded once the table is full.
+static const unsigned MAX_ALLOCATION_SAMPLES = 512;
+/// Number of stack frames of the tracker itself, which are left out of the samples.
+static const unsigned SKIPPED_FRAMES = 2;
+
+static const char* allocationTagNames[] =
+{
+    "General",
+    "Scene",
+    "Render",
+    "UI",
+    "Script",
+    "Network",
+    nullptr
+};
+
+static_assert(sizeof(allocationTagNames) / sizeof(const char*) == (size_t)MAX_ALLOCATION_TAGS + 1, "Allocation tag name array is out-of-date");
+
+/// Running counters of one tag.
+struct AllocationTagCounters
+{
+    /// Number of allocations.
+    std::atomic<long long> allocations_;
+    /// Bytes allocated.
+    std::atomic<long long> bytes_;
+};
+
+/// Tracker state shared by all threads.
+struct AllocationTrackerShared
+{
+    /// Construct.
+    AllocationTrackerShared() :
+        sampleInterval_(0),
+        numSamples_(0)
+    {
+        Clear();
+    }
+
+    /// Clear the counters and the samples.
+    void Clear()
+    {
+        for (unsigned i = 0; i < MAX_ALLOCATION_TAGS; ++i)
+        {
+            counters_[i].allocations_ = 0;
+            counters_[i].bytes_ = 0;
+            frameStartAllocations_[i] = 0;
+            frameStartBytes_[i] = 0;
+            frameAllocations_[i] = 0;
+            frameBytes_[i] = 0;
+        }
+        numSamples_ = 0;
+    }
+
+    /// Running counters per tag.
+    AllocationTagCounters counters_[MAX_ALLOCATION_TAGS];
+    /// Allocation count at the start of the current frame per tag.
+    long long frameStartAllocations_[MAX_ALLOCATION_TAGS];
+    /// Bytes at the start of the current frame per tag.
+    long long frameStartBytes_[MAX_ALLOCATION_TAGS];
+    /// Allocations of the last completed frame per tag.
+    long long frameAllocations_[MAX_ALLOCATION_TAGS];
+    /// Bytes of the last completed frame per tag.
+    long long frameBytes_[MAX_ALLOCATION_TAGS];
+    /// Call stack sampling interval.
+    std::atomic<unsigned> sampleInterval_;
+    /// Mutex for the samples.
+    Mutex samplesMutex_;
+    /// Hashes of the sampled call stacks.
+    unsigned sampleHashes_[MAX_ALLOCATION_SAMPLES];
+    /// Sampled call stacks. Stored in fixed arrays, as sampling must not allocate.
+    AllocationSample samples_[MAX_ALLOCATION_SAMPLES];
+    /// Number of sampled call stacks in use.
+    unsigned numSamples_;
+};
+
+namespace Detail
+{
+
+std::atomic<bool> allocationTracking(false);
+
+}
+
+static AllocationTrackerShared& GetTrackerShared()
+{
+    // Intentionally leaked, as allocations may still be tracked by static destructors during exit
+    static AllocationTrackerShared* shared = new AllocationTrackerShared();
+    return *shared;
+}
+
+static thread_local AllocationTag threadTag = ALLOCTAG_GENERAL;
+static thread_local unsigned threadSampleCounter = 0;
+static thread_local bool threadSampling = false;
+
+static unsigned CaptureCallstack(void** frames, unsigned maxFrames)
+{
+    void* captured[MAX_ALLOCATION_SAMPLE_FRAMES + SKIPPED_FRAMES];
+    unsigned numCaptured = 0;
+
+#if defined(_WIN32)
+    numCaptured = CaptureStackBackTrace(0, MAX_ALLOCATION_SAMPLE_FRAMES + SKIPPED_FRAMES, captured, nullptr);
+#elif defined(URHO3D_EXECINFO)
+    numCaptured = (unsigned)backtrace(captured, MAX_ALLOCATION_SAMPLE_FRAMES + SKIPPED_FRAMES);
+#endif
+
+    if (numCaptured <= SKIPPED_FRAMES)
+        return 0;
+
+    unsigned numFrames = Min(numCaptured - SKIPPED_FRAMES, maxFrames);
+    for (unsigned i = 0; i < numFrames; ++i)
+        frames[i] = captured[i + SKIPPED_FRAMES];
+    return numFrames;
+}
+
+static void SampleAllocation(AllocationTag tag, std::size_t size)
+{
+    void* frames[MAX_ALLOCATION_SAMPLE_FRAMES];
+    unsigned numFrames = CaptureCallstack(frames, MAX_ALLOCATION_SAMPLE_FRAMES);
+    if (!numFrames)
+        return;
+
+    // FNV-1a over the return addresses and the tag
+    unsigned hash = 2166136261u ^ (unsigned)tag;
+    for (unsigned i = 0; i < numFrames; ++i)
+    {
+        auto address = (size_t)frames[i];
+        hash = (hash ^ (unsigned)address ^ (unsigned)(address >> 16 >> 16)) * 16777619u;
+    }
+
+    AllocationTrackerShared& shared = GetTrackerShared();
+    MutexLock lock(shared.samplesMutex_);
+
+    for (unsigned i = 0; i < shared.numSamples_; ++i)
+    {
+        AllocationSample& sample = shared.samples_[i];
+        if (shared.sampleHashes_[i] == hash && sample.tag_ == tag && sample.numFrames_ == numFrames &&
+            !memcmp(sample.frames_, frames, numFrames * sizeof(void*)))
+        {
+            ++sample.count_;
+            sample.bytes_ += size;
+            return;
+        }
+    }
+
+    if (shared.numSamples_ < MAX_ALLOCATION_SAMPLES)
+    {
+        AllocationSample& sample = shared.samples_[shared.numSamples_];
+        shared.sampleHashes_[shared.numSamples_] = hash;
+        sample.tag_ = tag;
+        sample.count_ = 1;
+        sample.bytes_ = size;
+        sample.numFrames_ = numFrames;
+        memcpy(sample.frames_, frames, numFrames * sizeof(void*));
+        ++shared.numSamples_;
+    }
+}
+
+namespace Detail
+{
+
+void TrackAllocationSlow(std::size_t size)
+{
+    AllocationTrackerShared& shared = GetTrackerShared();
+    AllocationTag tag = threadTag;
+    shared.counters_[tag].allocations_.fetch_add(1, std::memory_order_relaxed);
+    shared.counters_[tag].bytes_.fetch_add((long long)size, std::memory_order_relaxed);
+
+    unsigned interval = shared.sampleInterval_.load(std::memory_order_relaxed);
+    if (interval && !threadSampling && ++threadSampleCounter >= interval)
+    {
+        threadSampleCounter = 0;
+        // Guard against recursion in case capturing the call stack allocates through a tracked hook
+        threadSampling = true;
+        SampleAllocation(tag, size);
+        threadSampling = false;
+    }
+}
+
+}
+
+void SetAllocationTracking(bool enable)
+{
+    if (enable == GetAllocationTracking())
+        return;
+
+    if (enable)
+    {
+        AllocationTrackerShared& shared = GetTrackerShared();
+        MutexLock lock(shared.samplesMutex_);
+        shared.Clear();
+    }
+
+    Detail::allocationTracking.store(enable);
+}
+
+bool GetAllocationTracking()
+{
+    return Detail::allocationTracking.load(std::memory_order_relaxed);
+}
+
+void SetAllocationSampleInterval(unsigned interval)
+{
+    GetTrackerShared().sampleInterval_.store(interval);
+}
+
+unsigned GetAllocationSampleInterval()
+{
+    return GetTrackerShared().sampleInterval_.load();
+}
+
+AllocationTag SetAllocationTag(AllocationTag tag)
+{
+    AllocationTag previous = threadTag;
+    threadTag = tag < MAX_ALLOCATION_TAGS ? tag : ALLOCTAG_GENERAL;
+    return previous;
+}
+
+AllocationTag GetAllocationTag()
+{
+    return threadTag;
+}
+
+void EndAllocationFrame()
+{
+    AllocationTrackerShared& shared = GetTrackerShared();
+    for (unsigned i = 0; i < MAX_ALLOCATION_TAGS; ++i)
+    {
+        long long allocations = shared.counters_[i].allocations_.load(std::memory_order_relaxed);
+        long long bytes = shared.counters_[i].bytes_.load(std::memory_order_relaxed);
+        shared.frameAllocations_[i] = allocations - shared.frameStartAllocations_[i];
+        shared.frameBytes_[i] = bytes - shared.frameStartBytes_[i];
+        shared.frameStartAllocations_[i] = allocations;
+        shared.frameStartBytes_[i] = bytes;
+    }
+}
+
+AllocationTagStats GetAllocationTagStats(AllocationTag tag)
+{
+    AllocationTagStats stats{};
+    if (tag >= MAX_ALLOCATION_TAGS)
+        return stats;
+
+    AllocationTrackerShared& shared = GetTrackerShared();
+    stats.totalAllocations_ = shared.counters_[tag].allocations_.load(std::memory_order_relaxed);
+    stats.totalBytes_ = shared.counters_[tag].bytes_.load(std::memory_order_relaxed);
+    stats.frameAllocations_ = shared.frameAllocations_[tag];
+    stats.frameBytes_ = shared.frameBytes_[tag];
+    return stats;
+}
+
+unsigned GetNumAllocationSamples()
+{
+    AllocationTrackerShared& shared = GetTrackerShared();
+    MutexLock lock(shared.samplesMutex_);
+    return shared.numSamples_;
+}
+
+bool GetAllocationSample(unsigned index, AllocationSample& dest)
+{
+    AllocationTrackerShared& shared = GetTrackerShared();
+    MutexLock lock(shared.samplesMutex_);
+    if (index >= shared.numSamples_)
+        return false;
+
+    dest = shared.samples_[index];
+    return true;
+}
+
+static bool CompareAllocationSamples(const AllocationSample& lhs, const AllocationSample& rhs)
+{
+    return lhs.count_ > rhs.count_;
+}
+
+String PrintAllocationStats(unsigned maxSamples)
+{
+    char line[256];
+    String output = "Tag            Frame allocs   Frame bytes   Total allocs    Total bytes\n";
+    for (unsigned i = 0; i < MAX_ALLOCATION_TAGS; ++i)
+    {
+        AllocationTagStats stats = GetAllocationTagStats((AllocationTag)i);
+        sprintf(line, "%-12s %14lld %13lld %14lld %14lld\n", allocationTagNames[i], stats.frameAllocations_, stats.frameBytes_,
+            stats.totalAllocations_, stats.totalBytes_);
+        output.Append(line);
+    }
+
+    // Copy the samples first, as building the output allocates and may be sampled itself
+    Vector<AllocationSample> samples;
+    unsigned numSamples = GetNumAllocationSamples();
+    samples.Resize(numSamples);
+    for (unsigned i = 0; i < numSamples; ++i)
+    {
+        if (!GetAllocationSample(i, samples[i]))
+        {
+            samples.Resize(i);
+            break;
+        }
+    }
+    Sort(samples.Begin(), samples.End(), CompareAllocationSamples);
+
+    for (unsigned i = 0; i < samples.Size() && i < maxSamples; ++i)
+    {
+        const AllocationSample& sample = samples[i];
+        sprintf(line, "\n%s: %u samples, %lld bytes\n", allocationTagNames[sample.tag_], sample.count_, sample.bytes_);
+        output.Append(line);
+
+#ifdef URHO3D_EXECINFO
+        char** symbols = backtrace_symbols(sample.frames_, sample.numFrames_);
+        for (unsigned j = 0; j < sample.numFrames_; ++j)
+            output += "  " + String(symbols ? symbols[j] : "") + "\n";
+        free(symbols);
+#else
+        for (unsigned j = 0; j < sample.numFrames_; ++j)
+        {
+            sprintf(line, "  %p\n", sample.frames_[j]);
+            output.Append(line);
+        }
+#endif
+    }
+
+    return output;
+}
+
+const char* GetAllocationTagName(AllocationTag tag)
+{
+    return tag < MAX_ALLOCATION_TAGS ? allocationTagNames[tag] : "";
+}
+
+}
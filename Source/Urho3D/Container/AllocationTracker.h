@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+
+namespace Urho3D
+{
+
+class String;
+
+/// Subsystem tag of tracked allocations. The tag of the allocating thread is set with AllocationTagScope.
+enum AllocationTag
+{
+    ALLOCTAG_GENERAL = 0,
+    ALLOCTAG_SCENE,
+    ALLOCTAG_RENDER,
+    ALLOCTAG_UI,
+    ALLOCTAG_SCRIPT,
+    ALLOCTAG_NETWORK,
+    MAX_ALLOCATION_TAGS
+};
+
+/// Maximum number of call stack frames recorded per sampled allocation.
+static const unsigned MAX_ALLOCATION_SAMPLE_FRAMES = 16;
+
+/// Allocation statistics of one tag.
+struct AllocationTagStats
+{
+    /// Number of allocations since tracking was enabled.
+    long long totalAllocations_;
+    /// Bytes allocated since tracking was enabled.
+    long long totalBytes_;
+    /// Number of allocations during the last completed frame.
+    long long frameAllocations_;
+    /// Bytes allocated during the last completed frame.
+    long long frameBytes_;
+};
+
+/// Call stack of sampled allocations, with the number of samples that had it.
+struct AllocationSample
+{
+    /// Tag.
+    AllocationTag tag_;
+    /// Number of samples.
+    unsigned count_;
+    /// Bytes of the sampled allocations.
+    long long bytes_;
+    /// Number of frames.
+    unsigned numFrames_;
+    /// Return addresses, innermost first.
+    void* frames_[MAX_ALLOCATION_SAMPLE_FRAMES];
+};
+
+namespace Detail
+{
+
+/// Allocation tracking flag. Read inline by the hooks so that they cost one branch when tracking is off.
+extern URHO3D_API std::atomic<bool> allocationTracking;
+
+/// Count an allocation under the current thread's tag.
+URHO3D_API void TrackAllocationSlow(std::size_t size);
+
+}
+
+/// Count an allocation if tracking is enabled. Called by the String, Vector, Allocator and pooled allocator hooks.
+inline void TrackAllocation(std::size_t size)
+{
+    if (Detail::allocationTracking.load(std::memory_order_relaxed))
+        Detail::TrackAllocationSlow(size);
+}
+
+/// Enable or disable allocation tracking. Enabling clears the statistics and the call stack samples.
+URHO3D_API void SetAllocationTracking(bool enable);
+/// Return whether allocation tracking is enabled.
+URHO3D_API bool GetAllocationTracking();
+/// Set how often the call stack of an allocation is sampled: every Nth allocation of each thread. 0 (default) disables sampling.
+/// Call stacks are captured on Windows, Linux and Apple platforms only.
+URHO3D_API void SetAllocationSampleInterval(unsigned interval);
+/// Return the call stack sampling interval.
+URHO3D_API unsigned GetAllocationSampleInterval();
+/// Set the tag of the current thread's allocations. Return the previous tag.
+URHO3D_API AllocationTag SetAllocationTag(AllocationTag tag);
+/// Return the tag of the current thread's allocations.
+URHO3D_API AllocationTag GetAllocationTag();
+/// Complete the allocation frame, so that the per-frame statistics refer to the allocations since the previous call. Called by the Engine.
+URHO3D_API void EndAllocationFrame();
+/// Return statistics of a tag.
+URHO3D_API AllocationTagStats GetAllocationTagStats(AllocationTag tag);
+/// Return number of distinct sampled call stacks.
+URHO3D_API unsigned GetNumAllocationSamples();
+/// Return a sampled call stack by index. Return false if the index is out of range.
+URHO3D_API bool GetAllocationSample(unsigned index, AllocationSample& dest);
+/// Return the statistics of all tags and the most frequent sampled call stacks as text. Symbol names are resolved where the platform allows.
+URHO3D_API String PrintAllocationStats(unsigned maxSamples = 10);
+/// Return name of an allocation tag.
+URHO3D_API const char* GetAllocationTagName(AllocationTag tag);
+
+/// Sets the allocation tag of the current thread for its lifetime, and restores the previous tag on destruction.
+class AllocationTagScope
+{
+public:
+    /// Construct and set the tag.
+    explicit AllocationTagScope(AllocationTag tag) :
+        previous_(SetAllocationTag(tag))
+    {
+    }
+
+    /// Destruct and restore the previous tag.
+    ~AllocationTagScope() { SetAllocationTag(previous_); }
+
+    /// Prevent copy construction.
+    AllocationTagScope(const AllocationTagScope& rhs) = delete;
+    /// Prevent assignment.
+    AllocationTagScope& operator =(const AllocationTagScope& rhs) = delete;
+
+private:
+    /// Previous tag.
+    AllocationTag previous_;
+};
+
+}
@@ -22,17 +22,26 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
+#include "../Container/PoolAllocator.h"
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+static unsigned AllocatorBlockSize(unsigned nodeSize, unsigned capacity)
+{
+    return (unsigned)sizeof(AllocatorBlock) + capacity * ((unsigned)sizeof(AllocatorNode) + nodeSize);
+}
+
 AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSize, unsigned capacity)
 {
     if (!capacity)
         capacity = 1;
 
-    auto* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize)];
+    // Small blocks, such as the first block of a list or map, come from the pooled allocator
+    auto* blockPtr = static_cast<unsigned char*>(PoolAllocate(AllocatorBlockSize(nodeSize, capacity), MEMCAT_CONTAINER));
     auto* newBlock = reinterpret_cast<AllocatorBlock*>(blockPtr);
     newBlock->nodeSize_ = nodeSize;
     newBlock->capacity_ = capacity;
@@ -76,11 +85,23 @@ AllocatorBlock* AllocatorInitialize(unsigned nodeSize, unsigned initialCapacity)
 
 void AllocatorUninitialize(AllocatorBlock* allocator)
 {
+    if (!allocator)
+        return;
+
+    // The first block's capacity is the total of the chain, so subtract the others to get its own
+    unsigned firstCapacity = allocator->capacity_;
+    for (AllocatorBlock* block = allocator->next_; block; block = block->next_)
+        firstCapacity -= block->capacity_;
+
+    unsigned nodeSize = allocator->nodeSize_;
+    unsigned capacity = firstCapacity;
     while (allocator)
     {
         AllocatorBlock* next = allocator->next_;
-        delete[] reinterpret_cast<unsigned char*>(allocator);
+        PoolFree(allocator, AllocatorBlockSize(nodeSize, capacity), MEMCAT_CONTAINER);
         allocator = next;
+        if (allocator)
+            capacity = allocator->capacity_;
     }
 }
 
@@ -97,6 +118,8 @@ void* AllocatorReserve(AllocatorBlock* allocator)
         allocator->capacity_ += newCapacity;
     }
 
+    TrackAllocation(allocator->nodeSize_);
+
     // We should have new free node(s) chained
     AllocatorNode* freeNode = allocator->free_;
     void* ptr = (reinterpret_cast<unsigned char*>(freeNode)) + sizeof(AllocatorNode);
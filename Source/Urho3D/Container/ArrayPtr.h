@@ -159,10 +159,10 @@ public:
     T* Get() const { return ptr_; }
 
     /// Return the array's reference count, or 0 if the pointer is null.
-    int Refs() const { return refCount_ ? refCount_->refs_ : 0; }
+    int Refs() const { return refCount_ ? refCount_->Refs() : 0; }
 
     /// Return the array's weak reference count, or 0 if the pointer is null.
-    int WeakRefs() const { return refCount_ ? refCount_->weakRefs_ : 0; }
+    int WeakRefs() const { return refCount_ ? refCount_->WeakRefs() : 0; }
 
     /// Return pointer to the RefCount structure.
     RefCount* RefCountPtr() const { return refCount_; }
@@ -179,8 +179,8 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->refs_ >= 0);
-            ++(refCount_->refs_);
+            assert(refCount_->Refs() >= 0);
+            refCount_->AddRef();
         }
     }
 
@@ -189,15 +189,14 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->refs_ > 0);
-            --(refCount_->refs_);
-            if (!refCount_->refs_)
+            assert(refCount_->Refs() > 0);
+            if (!refCount_->ReleaseRef())
             {
-                refCount_->refs_ = -1;
+                refCount_->SetExpired();
                 delete[] ptr_;
             }
 
-            if (refCount_->refs_ < 0 && !refCount_->weakRefs_)
+            if (refCount_->Refs() < 0 && !refCount_->WeakRefs())
                 delete refCount_;
         }
 
@@ -376,13 +375,13 @@ public:
     bool NotNull() const { return refCount_ != 0; }
 
     /// Return the array's reference count, or 0 if null pointer or if array has expired.
-    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int Refs() const { return (refCount_ && refCount_->Refs() >= 0) ? refCount_->Refs() : 0; }
 
     /// Return the array's weak reference count.
-    int WeakRefs() const { return refCount_ ? refCount_->weakRefs_ : 0; }
+    int WeakRefs() const { return refCount_ ? refCount_->WeakRefs() : 0; }
 
     /// Return whether the array has expired. If null pointer, always return true.
-    bool Expired() const { return refCount_ ? refCount_->refs_ < 0 : true; }
+    bool Expired() const { return refCount_ ? refCount_->Refs() < 0 : true; }
 
     /// Return pointer to RefCount structure.
     RefCount* RefCountPtr() const { return refCount_; }
@@ -399,8 +398,8 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->weakRefs_ >= 0);
-            ++(refCount_->weakRefs_);
+            assert(refCount_->WeakRefs() >= 0);
+            refCount_->AddWeakRef();
         }
     }
 
@@ -409,12 +408,12 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->weakRefs_ >= 0);
+            assert(refCount_->WeakRefs() >= 0);
 
-            if (refCount_->weakRefs_ > 0)
-                --(refCount_->weakRefs_);
+            if (refCount_->WeakRefs() > 0)
+                refCount_->ReleaseWeakRef();
 
-            if (Expired() && !refCount_->weakRefs_)
+            if (Expired() && !refCount_->WeakRefs())
                 delete refCount_;
         }
 
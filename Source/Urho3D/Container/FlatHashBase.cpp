@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+unsigned FlatHashBase::GrowthToCapacity(unsigned growth)
+{
+    unsigned capacity = FlatHashGroup::WIDTH - 1;
+    while (CapacityToGrowth(capacity) < growth)
+        capacity = capacity * 2 + 1;
+    return capacity;
+}
+
+void FlatHashBase::AllocateControl(unsigned capacity)
+{
+    ctrl_ = new signed char[capacity + FlatHashGroup::WIDTH];
+    capacity_ = capacity;
+    ResetControl();
+}
+
+void FlatHashBase::ResetControl()
+{
+    if (!ctrl_)
+        return;
+
+    memset(ctrl_, FLATHASH_EMPTY, capacity_ + FlatHashGroup::WIDTH);
+    ctrl_[capacity_] = FLATHASH_SENTINEL;
+    growthLeft_ = CapacityToGrowth(capacity_) - size_;
+}
+
+void FlatHashBase::FreeControl()
+{
+    delete[] ctrl_;
+    ctrl_ = nullptr;
+    capacity_ = 0;
+    growthLeft_ = 0;
+}
+
+unsigned FlatHashBase::FindFirstNonFull(unsigned long long hash) const
+{
+    unsigned offset = H1(hash) & capacity_;
+    unsigned step = 0;
+
+    for (;;)
+    {
+        unsigned mask = FlatHashGroup(ctrl_ + offset).MatchEmptyOrDeleted();
+        if (mask)
+            return (offset + FlatHashLowestBit(mask)) & capacity_;
+
+        step += FlatHashGroup::WIDTH;
+        offset = (offset + step) & capacity_;
+    }
+}
+
+void FlatHashBase::EraseControl(unsigned index)
+{
+    // If the empty slots around the erased one leave no full group of occupied slots, no lookup can have probed past this
+    // slot, and it may become empty again. Otherwise it must stay as a tombstone so that later lookups keep probing
+    unsigned indexBefore = (index - FlatHashGroup::WIDTH) & capacity_;
+    unsigned emptyAfter = FlatHashGroup(ctrl_ + index).MatchEmpty();
+    unsigned emptyBefore = FlatHashGroup(ctrl_ + indexBefore).MatchEmpty();
+
+    bool wasNeverFull = false;
+    if (emptyAfter && emptyBefore)
+    {
+        unsigned trailingFull = FlatHashLowestBit(emptyAfter);
+        unsigned leadingFull = 0;
+        while (!(emptyBefore & (1u << (FlatHashGroup::WIDTH - 1 - leadingFull))))
+            ++leadingFull;
+        wasNeverFull = trailingFull + leadingFull < FlatHashGroup::WIDTH;
+    }
+
+    SetControl(index, wasNeverFull ? FLATHASH_EMPTY : FLATHASH_DELETED);
+    if (wasNeverFull)
+        ++growthLeft_;
+    --size_;
+}
+
+}
@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Urho3D
+{
+
+/// Control byte of an empty slot.
+static const signed char FLATHASH_EMPTY = -128;
+/// Control byte of an erased slot. Probing continues past it.
+static const signed char FLATHASH_DELETED = -2;
+/// Control byte that terminates iteration, stored after the last slot.
+static const signed char FLATHASH_SENTINEL = -1;
+
+/// Return the index of the lowest set bit of a non-zero mask.
+inline unsigned FlatHashLowestBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#elif defined(__GNUC__)
+    return (unsigned)__builtin_ctz(mask);
+#else
+    unsigned index = 0;
+    while (!(mask & 1u))
+    {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// Group of control bytes that are matched at once.
+struct FlatHashGroup
+{
+    /// Number of control bytes in a group.
+    static const unsigned WIDTH = 16;
+
+    /// Load the group starting at a control byte.
+    explicit FlatHashGroup(const signed char* ctrl)
+    {
+#ifdef URHO3D_SSE
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        for (unsigned i = 0; i < WIDTH; ++i)
+            ctrl_[i] = ctrl[i];
+#endif
+    }
+
+    /// Return a bitmask of the slots whose control byte equals the value.
+    unsigned Match(signed char value) const
+    {
+#ifdef URHO3D_SSE
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), ctrl_));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < WIDTH; ++i)
+        {
+            if (ctrl_[i] == value)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Return a bitmask of the empty slots.
+    unsigned MatchEmpty() const { return Match(FLATHASH_EMPTY); }
+
+    /// Return a bitmask of the empty or erased slots.
+    unsigned MatchEmptyOrDeleted() const
+    {
+#ifdef URHO3D_SSE
+        return (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(FLATHASH_SENTINEL), ctrl_));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < WIDTH; ++i)
+        {
+            if (ctrl_[i] < FLATHASH_SENTINEL)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Control bytes.
+#ifdef URHO3D_SSE
+    __m128i ctrl_;
+#else
+    signed char ctrl_[WIDTH];
+#endif
+};
+
+/// Flat hash set/map base class. Manages the control bytes of an open addressing table, while the slots are owned by the template subclass.
+/** The table capacity is always one less than a power of two, and at least FlatHashGroup::WIDTH - 1. Each slot has a control byte
+    that is either empty, erased, or holds 7 bits of the key's hash, so that a lookup compares a whole group of candidate slots with
+    one instruction before touching any key. The first control bytes are mirrored after the sentinel, so that a group can be loaded
+    at any slot without wrapping around.
+
+    Note that to prevent extra memory use due to vtable pointer, %FlatHashBase intentionally does not declare a virtual destructor
+    and therefore %FlatHashBase pointers should never be used.
+  */
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Slot index returned when a key is not found.
+    static const unsigned NOT_FOUND = 0xffffffff;
+
+    /// Construct.
+    FlatHashBase() :
+        ctrl_(nullptr),
+        capacity_(0),
+        size_(0),
+        growthLeft_(0)
+    {
+    }
+
+    /// Swap the control bytes with another flat hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(ctrl_, rhs.ctrl_);
+        Urho3D::Swap(capacity_, rhs.capacity_);
+        Urho3D::Swap(size_, rhs.size_);
+        Urho3D::Swap(growthLeft_, rhs.growthLeft_);
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return number of slots.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return size_ == 0; }
+
+protected:
+    /// Return the mixed 64-bit hash of a key.
+    template <class T> static unsigned long long MixHash(const T& key)
+    {
+        // The engine's hash functions may leave the low bits poorly distributed (for example pointers), so spread them over
+        // the whole 64-bit value. The upper half selects the probe position and the bits below it the control byte
+        return (unsigned long long)MakeHash(key) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    /// Return the probe start position of a mixed hash.
+    static unsigned H1(unsigned long long hash) { return (unsigned)(hash >> 32u); }
+
+    /// Return the control byte of a mixed hash.
+    static signed char H2(unsigned long long hash) { return (signed char)((hash >> 25u) & 0x7fu); }
+
+    /// Return whether a control byte belongs to an occupied slot.
+    static bool IsFull(signed char ctrl) { return ctrl >= 0; }
+
+    /// Return the number of elements that fit into a capacity before the table grows.
+    static unsigned CapacityToGrowth(unsigned capacity) { return capacity - capacity / 8; }
+
+    /// Return the smallest capacity that holds a number of elements.
+    static unsigned GrowthToCapacity(unsigned growth);
+
+    /// Allocate and reset the control bytes for a new capacity. The old control bytes must have been released by the caller.
+    void AllocateControl(unsigned capacity);
+    /// Mark all slots empty, keeping the capacity.
+    void ResetControl();
+    /// Free the control bytes.
+    void FreeControl();
+    /// Set the control byte of a slot and its mirrored copy.
+    void SetControl(unsigned index, signed char ctrl)
+    {
+        ctrl_[index] = ctrl;
+        ctrl_[((index - (FlatHashGroup::WIDTH - 1)) & capacity_) + (FlatHashGroup::WIDTH - 1)] = ctrl;
+    }
+    /// Return the first empty or erased slot on the probe sequence of a hash. The table must have room.
+    unsigned FindFirstNonFull(unsigned long long hash) const;
+    /// Release the control byte of an erased element and update the element count. The slot is marked empty if no probe
+    /// sequence can have passed it while it was occupied, otherwise erased.
+    void EraseControl(unsigned index);
+
+    /// Control bytes, capacity + FlatHashGroup::WIDTH of them.
+    signed char* ctrl_;
+    /// Number of slots.
+    unsigned capacity_;
+    /// Number of elements.
+    unsigned size_;
+    /// Number of elements that can still be inserted into empty slots before the table must grow.
+    unsigned growthLeft_;
+};
+
+/// Flat hash set/map iterator base class.
+template <class TSlot> struct FlatHashIteratorBase
+{
+    /// Construct.
+    FlatHashIteratorBase() :
+        ctrl_(nullptr),
+        slot_(nullptr)
+    {
+    }
+
+    /// Construct with a control byte and slot pointer.
+    FlatHashIteratorBase(const signed char* ctrl, TSlot* slot) :
+        ctrl_(ctrl),
+        slot_(slot)
+    {
+    }
+
+    /// Test for equality with another iterator.
+    bool operator ==(const FlatHashIteratorBase& rhs) const { return slot_ == rhs.slot_; }
+
+    /// Test for inequality with another iterator.
+    bool operator !=(const FlatHashIteratorBase& rhs) const { return slot_ != rhs.slot_; }
+
+    /// Skip to the first occupied slot at or after the current one. The sentinel stops the search.
+    void SkipEmpty()
+    {
+        while (*ctrl_ < FLATHASH_SENTINEL)
+        {
+            ++ctrl_;
+            ++slot_;
+        }
+    }
+
+    /// Go to the next occupied slot.
+    void GotoNext()
+    {
+        ++ctrl_;
+        ++slot_;
+        SkipEmpty();
+    }
+
+    /// Control byte pointer.
+    const signed char* ctrl_;
+    /// Slot pointer.
+    TSlot* slot_;
+};
+
+}
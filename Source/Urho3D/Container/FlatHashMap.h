@@ -0,0 +1,555 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Vector.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Open addressing hash map template class with the same lookup and iteration interface as HashMap.
+/** The pairs are stored directly in one array of slots, so a lookup does not chase node pointers. Unlike HashMap, the iteration
+    order is unspecified, and inserting may invalidate iterators and pointers to the pairs when the table grows. Erasing does not
+    move the other pairs, so it is safe to erase the current pair while iterating.
+  */
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    using KeyType = T;
+    using ValueType = U;
+
+    /// Hash map key-value pair with const key.
+    class KeyValue
+    {
+    public:
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first_(first),
+            second_(second)
+        {
+        }
+
+        /// Copy-construct.
+        KeyValue(const KeyValue& value) :
+            first_(value.first_),
+            second_(value.second_)
+        {
+        }
+
+        /// Move-construct. Used when the table grows.
+        KeyValue(KeyValue&& value) noexcept :
+            first_(value.first_),
+            second_(std::move(value.second_))
+        {
+        }
+
+        /// Prevent assignment.
+        KeyValue& operator =(const KeyValue& rhs) = delete;
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+        /// Key.
+        const T first_;
+        /// Value.
+        U second_;
+    };
+
+    /// Hash map iterator.
+    struct Iterator : public FlatHashIteratorBase<KeyValue>
+    {
+        /// Construct.
+        Iterator() = default;
+
+        /// Construct with a control byte and slot pointer.
+        Iterator(const signed char* ctrl, KeyValue* slot) :
+            FlatHashIteratorBase<KeyValue>(ctrl, slot)
+        {
+        }
+
+        /// Preincrement the pointer.
+        Iterator& operator ++()
+        {
+            this->GotoNext();
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        Iterator operator ++(int)
+        {
+            Iterator it = *this;
+            this->GotoNext();
+            return it;
+        }
+
+        /// Point to the pair.
+        KeyValue* operator ->() const { return this->slot_; }
+
+        /// Dereference the pair.
+        KeyValue& operator *() const { return *this->slot_; }
+    };
+
+    /// Hash map const iterator.
+    struct ConstIterator : public FlatHashIteratorBase<KeyValue>
+    {
+        /// Construct.
+        ConstIterator() = default;
+
+        /// Construct with a control byte and slot pointer.
+        ConstIterator(const signed char* ctrl, KeyValue* slot) :
+            FlatHashIteratorBase<KeyValue>(ctrl, slot)
+        {
+        }
+
+        /// Construct from a non-const iterator.
+        ConstIterator(const Iterator& rhs) :        // NOLINT(google-explicit-constructor)
+            FlatHashIteratorBase<KeyValue>(rhs.ctrl_, rhs.slot_)
+        {
+        }
+
+        /// Assign from a non-const iterator.
+        ConstIterator& operator =(const Iterator& rhs)
+        {
+            this->ctrl_ = rhs.ctrl_;
+            this->slot_ = rhs.slot_;
+            return *this;
+        }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            this->GotoNext();
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            this->GotoNext();
+            return it;
+        }
+
+        /// Point to the pair.
+        const KeyValue* operator ->() const { return this->slot_; }
+
+        /// Dereference the pair.
+        const KeyValue& operator *() const { return *this->slot_; }
+    };
+
+    /// Construct empty.
+    FlatHashMap() :
+        slots_(nullptr)
+    {
+    }
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map) :
+        slots_(nullptr)
+    {
+        *this = map;
+    }
+
+    /// Move-construct from another hash map.
+    FlatHashMap(FlatHashMap<T, U> && map) noexcept :
+        slots_(nullptr)
+    {
+        Swap(map);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashMap(const std::initializer_list<Pair<T, U>>& list) : FlatHashMap()
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashMap()
+    {
+        DestroySlots();
+        FreeSlots();
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash map.
+    FlatHashMap& operator =(FlatHashMap<T, U> && rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Add-assign a pair.
+    FlatHashMap& operator +=(const Pair<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash map.
+    FlatHashMap& operator +=(const FlatHashMap<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned long long hash = MixHash(key);
+        unsigned index = FindIndex(key, hash);
+        if (index == NOT_FOUND)
+            index = InsertNew(key, U(), hash);
+        return slots_[index].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        return index != NOT_FOUND ? &slots_[index].second_ : nullptr;
+    }
+
+    /// Populate the map using variadic template. This handles the base case.
+    FlatHashMap& Populate(const T& key, const U& value)
+    {
+        this->operator [](key) = value;
+        return *this;
+    }
+
+    /// Populate the map using variadic template.
+    template <typename... Args> FlatHashMap& Populate(const T& key, const U& value, const Args&... args)
+    {
+        this->operator [](key) = value;
+        return Populate(args...);
+    }
+
+    /// Insert a pair. Return an iterator to it.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        unsigned long long hash = MixHash(pair.first_);
+        unsigned index = FindIndex(pair.first_, hash);
+        exists = index != NOT_FOUND;
+        if (exists)
+            slots_[index].second_ = pair.second_;
+        else
+            index = InsertNew(pair.first_, pair.second_, hash);
+        return MakeIterator(index);
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        Reserve(Size() + map.Size());
+        for (ConstIterator it = map.Begin(); it != map.End(); ++it)
+            Insert(MakePair(it->first_, it->second_));
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        if (index == NOT_FOUND)
+            return false;
+
+        EraseSlot(index);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair.
+    Iterator Erase(const Iterator& it)
+    {
+        if (!ctrl_ || it == End())
+            return End();
+
+        auto index = (unsigned)(it.slot_ - slots_);
+        EraseSlot(index);
+
+        Iterator next(ctrl_ + index, slots_ + index);
+        next.SkipEmpty();
+        return next;
+    }
+
+    /// Clear the map, keeping the capacity.
+    void Clear()
+    {
+        DestroySlots();
+        size_ = 0;
+        ResetControl();
+    }
+
+    /// Reserve room for a number of pairs so that inserting them does not grow the table.
+    void Reserve(unsigned size)
+    {
+        if (size > size_ + growthLeft_)
+            Resize(GrowthToCapacity(size));
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        return index != NOT_FOUND ? MakeIterator(index) : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        return index != NOT_FOUND ? ConstIterator(ctrl_ + index, slots_ + index) : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindIndex(key, MixHash(key)) != NOT_FOUND; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        if (index == NOT_FOUND)
+            return false;
+
+        out = slots_[index].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        Urho3D::Swap(slots_, rhs.slots_);
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin()
+    {
+        if (!size_)
+            return End();
+
+        Iterator it(ctrl_, slots_);
+        it.SkipEmpty();
+        return it;
+    }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return const_cast<FlatHashMap<T, U>*>(this)->Begin(); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return *Begin(); }
+
+private:
+    /// Return iterator to a slot.
+    Iterator MakeIterator(unsigned index) { return Iterator(ctrl_ + index, slots_ + index); }
+
+    /// Return the slot index of a key, or NOT_FOUND.
+    unsigned FindIndex(const T& key, unsigned long long hash) const
+    {
+        if (!size_)
+            return NOT_FOUND;
+
+        signed char h2 = H2(hash);
+        unsigned offset = H1(hash) & capacity_;
+        unsigned step = 0;
+
+        for (;;)
+        {
+            FlatHashGroup group(ctrl_ + offset);
+            for (unsigned mask = group.Match(h2); mask; mask &= mask - 1)
+            {
+                unsigned index = (offset + FlatHashLowestBit(mask)) & capacity_;
+                if (slots_[index].first_ == key)
+                    return index;
+            }
+
+            if (group.MatchEmpty())
+                return NOT_FOUND;
+
+            step += FlatHashGroup::WIDTH;
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    /// Insert a key that is known not to exist. Return its slot index.
+    unsigned InsertNew(const T& key, const U& value, unsigned long long hash)
+    {
+        if (!ctrl_)
+            Resize(GrowthToCapacity(1));
+
+        unsigned index = FindFirstNonFull(hash);
+        if (!growthLeft_ && ctrl_[index] != FLATHASH_DELETED)
+        {
+            // If erased slots take up much of the table, rebuilding at the same size is enough to reclaim them
+            Resize(size_ < CapacityToGrowth(capacity_) / 2 ? capacity_ : capacity_ * 2 + 1);
+            index = FindFirstNonFull(hash);
+        }
+
+        if (ctrl_[index] == FLATHASH_EMPTY)
+            --growthLeft_;
+        ++size_;
+        SetControl(index, H2(hash));
+        new(slots_ + index) KeyValue(key, value);
+        return index;
+    }
+
+    /// Erase the pair in a slot.
+    void EraseSlot(unsigned index)
+    {
+        // Release the control byte first, so that the pair can not be found while it is being destructed
+        EraseControl(index);
+        (slots_ + index)->~KeyValue();
+    }
+
+    /// Rebuild the table with a new capacity.
+    void Resize(unsigned capacity)
+    {
+        signed char* oldCtrl = ctrl_;
+        KeyValue* oldSlots = slots_;
+        unsigned oldCapacity = capacity_;
+
+        AllocateControl(capacity);
+        slots_ = static_cast<KeyValue*>(::operator new(capacity * sizeof(KeyValue)));
+
+        for (unsigned i = 0; i < oldCapacity; ++i)
+        {
+            if (IsFull(oldCtrl[i]))
+            {
+                unsigned long long hash = MixHash(oldSlots[i].first_);
+                unsigned index = FindFirstNonFull(hash);
+                SetControl(index, H2(hash));
+                new(slots_ + index) KeyValue(std::move(oldSlots[i]));
+                (oldSlots + i)->~KeyValue();
+            }
+        }
+
+        delete[] oldCtrl;
+        ::operator delete(oldSlots);
+    }
+
+    /// Destruct all pairs and mark their slots empty. The element count is left for the caller to reset.
+    void DestroySlots()
+    {
+        for (unsigned i = 0; i < capacity_; ++i)
+        {
+            if (IsFull(ctrl_[i]))
+            {
+                SetControl(i, FLATHASH_EMPTY);
+                (slots_ + i)->~KeyValue();
+            }
+        }
+    }
+
+    /// Free the slot and control byte storage.
+    void FreeSlots()
+    {
+        FreeControl();
+        ::operator delete(slots_);
+        slots_ = nullptr;
+    }
+
+    /// Slots. Only the ones with a full control byte are constructed.
+    KeyValue* slots_;
+};
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
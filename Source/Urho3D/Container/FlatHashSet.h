@@ -0,0 +1,443 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Open addressing hash set template class with the same lookup and iteration interface as HashSet.
+/** The keys are stored directly in one array of slots. Unlike HashSet, the iteration order is unspecified, and inserting may
+    invalidate iterators when the table grows. Erasing does not move the other keys, so it is safe to erase the current key
+    while iterating.
+  */
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    /// Hash set iterator.
+    struct Iterator : public FlatHashIteratorBase<T>
+    {
+        /// Construct.
+        Iterator() = default;
+
+        /// Construct with a control byte and slot pointer.
+        Iterator(const signed char* ctrl, T* slot) :
+            FlatHashIteratorBase<T>(ctrl, slot)
+        {
+        }
+
+        /// Preincrement the pointer.
+        Iterator& operator ++()
+        {
+            this->GotoNext();
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        Iterator operator ++(int)
+        {
+            Iterator it = *this;
+            this->GotoNext();
+            return it;
+        }
+
+        /// Point to the key.
+        const T* operator ->() const { return this->slot_; }
+
+        /// Dereference the key.
+        const T& operator *() const { return *this->slot_; }
+    };
+
+    /// Hash set const iterator.
+    struct ConstIterator : public FlatHashIteratorBase<T>
+    {
+        /// Construct.
+        ConstIterator() = default;
+
+        /// Construct with a control byte and slot pointer.
+        ConstIterator(const signed char* ctrl, T* slot) :
+            FlatHashIteratorBase<T>(ctrl, slot)
+        {
+        }
+
+        /// Construct from a non-const iterator.
+        ConstIterator(const Iterator& rhs) :    // NOLINT(google-explicit-constructor)
+            FlatHashIteratorBase<T>(rhs.ctrl_, rhs.slot_)
+        {
+        }
+
+        /// Assign from a non-const iterator.
+        ConstIterator& operator =(const Iterator& rhs)
+        {
+            this->ctrl_ = rhs.ctrl_;
+            this->slot_ = rhs.slot_;
+            return *this;
+        }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            this->GotoNext();
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            this->GotoNext();
+            return it;
+        }
+
+        /// Point to the key.
+        const T* operator ->() const { return this->slot_; }
+
+        /// Dereference the key.
+        const T& operator *() const { return *this->slot_; }
+    };
+
+    /// Construct empty.
+    FlatHashSet() :
+        slots_(nullptr)
+    {
+    }
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set) :
+        slots_(nullptr)
+    {
+        *this = set;
+    }
+
+    /// Move-construct from another hash set.
+    FlatHashSet(FlatHashSet<T> && set) noexcept :
+        slots_(nullptr)
+    {
+        Swap(set);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashSet(const std::initializer_list<T>& list) : FlatHashSet()
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashSet()
+    {
+        DestroySlots();
+        FreeSlots();
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash set.
+    FlatHashSet& operator =(FlatHashSet<T> && rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Add-assign a value.
+    FlatHashSet& operator +=(const T& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash set.
+    FlatHashSet& operator +=(const FlatHashSet<T>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator it = Begin(); it != End(); ++it)
+        {
+            if (!rhs.Contains(*it))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return an iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned long long hash = MixHash(key);
+        unsigned index = FindIndex(key, hash);
+        exists = index != NOT_FOUND;
+        if (!exists)
+            index = InsertNew(key, hash);
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        Reserve(Size() + set.Size());
+        for (ConstIterator it = set.Begin(); it != set.End(); ++it)
+            Insert(*it);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        if (index == NOT_FOUND)
+            return false;
+
+        EraseSlot(index);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key.
+    Iterator Erase(const Iterator& it)
+    {
+        if (!ctrl_ || it == End())
+            return End();
+
+        auto index = (unsigned)(it.slot_ - slots_);
+        EraseSlot(index);
+
+        Iterator next(ctrl_ + index, slots_ + index);
+        next.SkipEmpty();
+        return next;
+    }
+
+    /// Clear the set, keeping the capacity.
+    void Clear()
+    {
+        DestroySlots();
+        size_ = 0;
+        ResetControl();
+    }
+
+    /// Reserve room for a number of keys so that inserting them does not grow the table.
+    void Reserve(unsigned size)
+    {
+        if (size > size_ + growthLeft_)
+            Resize(GrowthToCapacity(size));
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        return index != NOT_FOUND ? Iterator(ctrl_ + index, slots_ + index) : End();
+    }
+
+    /// Return const iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, MixHash(key));
+        return index != NOT_FOUND ? ConstIterator(ctrl_ + index, slots_ + index) : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindIndex(key, MixHash(key)) != NOT_FOUND; }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        Urho3D::Swap(slots_, rhs.slots_);
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin()
+    {
+        if (!size_)
+            return End();
+
+        Iterator it(ctrl_, slots_);
+        it.SkipEmpty();
+        return it;
+    }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return const_cast<FlatHashSet<T>*>(this)->Begin(); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    /// Return first key.
+    const T& Front() const { return *Begin(); }
+
+private:
+    /// Return the slot index of a key, or NOT_FOUND.
+    unsigned FindIndex(const T& key, unsigned long long hash) const
+    {
+        if (!size_)
+            return NOT_FOUND;
+
+        signed char h2 = H2(hash);
+        unsigned offset = H1(hash) & capacity_;
+        unsigned step = 0;
+
+        for (;;)
+        {
+            FlatHashGroup group(ctrl_ + offset);
+            for (unsigned mask = group.Match(h2); mask; mask &= mask - 1)
+            {
+                unsigned index = (offset + FlatHashLowestBit(mask)) & capacity_;
+                if (slots_[index] == key)
+                    return index;
+            }
+
+            if (group.MatchEmpty())
+                return NOT_FOUND;
+
+            step += FlatHashGroup::WIDTH;
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    /// Insert a key that is known not to exist. Return its slot index.
+    unsigned InsertNew(const T& key, unsigned long long hash)
+    {
+        if (!ctrl_)
+            Resize(GrowthToCapacity(1));
+
+        unsigned index = FindFirstNonFull(hash);
+        if (!growthLeft_ && ctrl_[index] != FLATHASH_DELETED)
+        {
+            // If erased slots take up much of the table, rebuilding at the same size is enough to reclaim them
+            Resize(size_ < CapacityToGrowth(capacity_) / 2 ? capacity_ : capacity_ * 2 + 1);
+            index = FindFirstNonFull(hash);
+        }
+
+        if (ctrl_[index] == FLATHASH_EMPTY)
+            --growthLeft_;
+        ++size_;
+        SetControl(index, H2(hash));
+        new(slots_ + index) T(key);
+        return index;
+    }
+
+    /// Erase the key in a slot.
+    void EraseSlot(unsigned index)
+    {
+        // Release the control byte first, so that the key can not be found while it is being destructed
+        EraseControl(index);
+        (slots_ + index)->~T();
+    }
+
+    /// Rebuild the table with a new capacity.
+    void Resize(unsigned capacity)
+    {
+        signed char* oldCtrl = ctrl_;
+        T* oldSlots = slots_;
+        unsigned oldCapacity = capacity_;
+
+        AllocateControl(capacity);
+        slots_ = static_cast<T*>(::operator new(capacity * sizeof(T)));
+
+        for (unsigned i = 0; i < oldCapacity; ++i)
+        {
+            if (IsFull(oldCtrl[i]))
+            {
+                unsigned long long hash = MixHash(oldSlots[i]);
+                unsigned index = FindFirstNonFull(hash);
+                SetControl(index, H2(hash));
+                new(slots_ + index) T(std::move(oldSlots[i]));
+                (oldSlots + i)->~T();
+            }
+        }
+
+        delete[] oldCtrl;
+        ::operator delete(oldSlots);
+    }
+
+    /// Destruct all keys and mark their slots empty. The element count is left for the caller to reset.
+    void DestroySlots()
+    {
+        for (unsigned i = 0; i < capacity_; ++i)
+        {
+            if (IsFull(ctrl_[i]))
+            {
+                SetControl(i, FLATHASH_EMPTY);
+                (slots_ + i)->~T();
+            }
+        }
+    }
+
+    /// Free the slot and control byte storage.
+    void FreeSlots()
+    {
+        FreeControl();
+        ::operator delete(slots_);
+        slots_ = nullptr;
+    }
+
+    /// Slots. Only the ones with a full control byte are constructed.
+    T* slots_;
+};
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::Iterator begin(Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::Iterator end(Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashMap.h"
+#include "../Container/InternedString.h"
+#include "../Core/Mutex.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+const InternedString InternedString::EMPTY;
+
+/// Interned string table. Allocated on first use so that interned strings can be created during static initialization.
+struct InternedStringTable
+{
+    /// Mutex for accessing the table from several threads.
+    Mutex mutex_;
+    /// Storage by string. The entries are allocated separately so that their addresses stay stable when the table grows.
+    FlatHashMap<String, InternedString::Entry*> entries_;
+};
+
+static InternedStringTable& GetInternedStringTable()
+{
+    // Intentionally leaked, so that interned strings held by other static objects stay valid during exit
+    static InternedStringTable* table = new InternedStringTable();
+    return *table;
+}
+
+InternedString::InternedString(const String& str) :
+    entry_(str.Empty() ? nullptr : Intern(str))
+{
+}
+
+InternedString::InternedString(const char* str) :
+    entry_(nullptr)
+{
+    if (str && *str)
+        entry_ = Intern(String(str));
+}
+
+unsigned InternedString::GetNumInterned()
+{
+    InternedStringTable& table = GetInternedStringTable();
+    MutexLock lock(table.mutex_);
+    return table.entries_.Size();
+}
+
+const InternedString::Entry* InternedString::Intern(const String& str)
+{
+    InternedStringTable& table = GetInternedStringTable();
+    MutexLock lock(table.mutex_);
+
+    Entry*& entry = table.entries_[str];
+    if (!entry)
+    {
+        // The entries are never freed, as any copy of an interned string may still point to them
+        entry = new Entry();
+        entry->string_ = str;
+        entry->hash_ = str.ToHash();
+    }
+    return entry;
+}
+
+}
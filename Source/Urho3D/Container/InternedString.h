@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Str.h"
+
+namespace Urho3D
+{
+
+/// Immutable string that is stored only once for the whole program. Comparison and hashing do not touch the characters.
+/** Interning is meant for a limited set of names that are compared or looked up often, such as attribute, parameter or
+    bone names. The interned strings are never freed, so it should not be used for arbitrary user text.
+  */
+class URHO3D_API InternedString
+{
+public:
+    /// Construct empty.
+    InternedString() noexcept :
+        entry_(nullptr)
+    {
+    }
+
+    /// Construct by interning a string.
+    explicit InternedString(const String& str);
+
+    /// Construct by interning a C string.
+    explicit InternedString(const char* str);
+
+    /// Test for equality with another interned string.
+    bool operator ==(const InternedString& rhs) const { return entry_ == rhs.entry_; }
+
+    /// Test for inequality with another interned string.
+    bool operator !=(const InternedString& rhs) const { return entry_ != rhs.entry_; }
+
+    /// Test if less than another interned string. Compares the storage addresses, so the order is only stable within one run.
+    bool operator <(const InternedString& rhs) const { return entry_ < rhs.entry_; }
+
+    /// Return the string.
+    const String& GetString() const { return entry_ ? entry_->string_ : String::EMPTY; }
+
+    /// Return the C string.
+    const char* CString() const { return GetString().CString(); }
+
+    /// Return length.
+    unsigned Length() const { return GetString().Length(); }
+
+    /// Return whether the string is empty.
+    bool Empty() const { return entry_ == nullptr; }
+
+    /// Return hash value for HashSet & HashMap. Equals the hash of the uninterned string.
+    unsigned ToHash() const { return entry_ ? entry_->hash_ : 0; }
+
+    /// Return the number of interned strings.
+    static unsigned GetNumInterned();
+
+    /// Empty interned string.
+    static const InternedString EMPTY;
+
+private:
+    friend struct InternedStringTable;
+
+    /// Interned string storage.
+    struct Entry
+    {
+        /// String.
+        String string_;
+        /// Precomputed hash.
+        unsigned hash_;
+    };
+
+    /// Find or add the storage of a non-empty string.
+    static const Entry* Intern(const String& str);
+
+    /// Shared storage, null when empty.
+    const Entry* entry_;
+};
+
+}
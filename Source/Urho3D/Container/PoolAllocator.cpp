@@ -0,0 +1,382 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/AllocationTracker.h"
+#include "../Container/PoolAllocator.h"
+#include "../Core/Mutex.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+// DebugNew.h is not included, as the pool calls the global allocation functions directly
+
+namespace Urho3D
+{
+
+/// Number of size classes.
+static const unsigned NUM_SIZE_CLASSES = 16;
+/// Size of the memory spans that are split into blocks of one size class.
+static const unsigned SPAN_SIZE = 64 * 1024;
+/// Number of blocks moved at once between a thread cache and the shared lists.
+static const unsigned TRANSFER_COUNT = 32;
+/// Number of free blocks of one size class a thread may cache before returning some to the shared lists.
+static const unsigned THREAD_CACHE_LIMIT = 2 * TRANSFER_COUNT;
+
+/// Block sizes of the size classes.
+static const unsigned sizeClasses[NUM_SIZE_CLASSES] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+
+static const char* memoryCategoryNames[] =
+{
+    "General",
+    "Object",
+    "RefCount",
+    "WorkItem",
+    "Container",
+    nullptr
+};
+
+static_assert(sizeof(memoryCategoryNames) / sizeof(const char*) == (size_t)MAX_MEMORY_CATEGORIES + 1, "Memory category name array is out-of-date");
+
+/// Link of a free block.
+struct PoolBlock
+{
+    /// Next free block.
+    PoolBlock* next_;
+};
+
+/// Statistics of one memory category, updated only by the owning thread.
+struct PoolThreadStats
+{
+    /// Number of allocations in use. May be negative if the thread frees memory allocated by others.
+    std::atomic<long long> numAllocations_;
+    /// Bytes in use.
+    std::atomic<long long> bytes_;
+    /// Number of allocations made.
+    std::atomic<long long> totalAllocations_;
+};
+
+/// Per-thread cache of free blocks.
+struct PoolThreadCache
+{
+    /// Free blocks per size class.
+    PoolBlock* free_[NUM_SIZE_CLASSES];
+    /// Number of free blocks per size class.
+    unsigned numFree_[NUM_SIZE_CLASSES];
+    /// Statistics per memory category.
+    PoolThreadStats stats_[MAX_MEMORY_CATEGORIES];
+    /// Previous cache in the list of live thread caches.
+    PoolThreadCache* prev_;
+    /// Next cache in the list of live thread caches.
+    PoolThreadCache* next_;
+};
+
+/// Shared free list of one size class.
+struct PoolSizeClassList
+{
+    /// Mutex for the list.
+    Mutex mutex_;
+    /// Free blocks.
+    PoolBlock* free_;
+};
+
+/// Allocator state shared by all threads.
+struct PoolShared
+{
+    /// Construct.
+    PoolShared() :
+        threadCaches_(nullptr),
+        reservedBytes_(0)
+    {
+        for (auto& list : lists_)
+            list.free_ = nullptr;
+        memset(exitedStats_, 0, sizeof exitedStats_);
+    }
+
+    /// Free lists per size class.
+    PoolSizeClassList lists_[NUM_SIZE_CLASSES];
+    /// Mutex for the thread cache list and the statistics of exited threads.
+    Mutex statsMutex_;
+    /// Live thread caches.
+    PoolThreadCache* threadCaches_;
+    /// Statistics of threads that have exited, and of allocations made without a thread cache.
+    PoolCategoryStats exitedStats_[MAX_MEMORY_CATEGORIES];
+    /// Bytes reserved for spans.
+    std::atomic<unsigned long long> reservedBytes_;
+};
+
+static PoolShared& GetPoolShared()
+{
+    // Intentionally leaked, as pooled memory may still be freed by static destructors during exit
+    static PoolShared* shared = new PoolShared();
+    return *shared;
+}
+
+static void ReleaseThreadCache();
+
+/// Returns the thread cache's blocks to the shared lists when the thread exits.
+struct PoolThreadCacheGuard
+{
+    /// Destruct.
+    ~PoolThreadCacheGuard() { ReleaseThreadCache(); }
+};
+
+static thread_local PoolThreadCache* threadCache = nullptr;
+static thread_local bool threadCacheReleased = false;
+static thread_local PoolThreadCacheGuard threadCacheGuard;
+
+static unsigned GetSizeClass(std::size_t size)
+{
+    auto s = (unsigned)size;
+    if (s <= 128)
+        return s ? (s - 1) >> 4u : 0;
+    else if (s <= 256)
+        return 8 + ((s - 129) >> 5u);
+    else
+        return 12 + ((s - 257) >> 6u);
+}
+
+static PoolThreadCache* GetThreadCache()
+{
+    PoolThreadCache* cache = threadCache;
+    if (cache || threadCacheReleased)
+        return cache;
+
+    // Touch the guard so that it is constructed, and destroyed at thread exit
+    (void)&threadCacheGuard;
+
+    // Value-initialize to zero the lists and counters
+    cache = new PoolThreadCache();
+
+    PoolShared& shared = GetPoolShared();
+    {
+        MutexLock lock(shared.statsMutex_);
+        cache->next_ = shared.threadCaches_;
+        if (shared.threadCaches_)
+            shared.threadCaches_->prev_ = cache;
+        shared.threadCaches_ = cache;
+    }
+
+    threadCache = cache;
+    return cache;
+}
+
+static void UpdateStats(PoolThreadCache* cache, MemoryCategory category, long long count, long long bytes)
+{
+    if (cache)
+    {
+        // Only this thread writes the counters, so a relaxed load and store is enough
+        PoolThreadStats& stats = cache->stats_[category];
+        stats.numAllocations_.store(stats.numAllocations_.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        stats.bytes_.store(stats.bytes_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        if (count > 0)
+            stats.totalAllocations_.store(stats.totalAllocations_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    else
+    {
+        PoolShared& shared = GetPoolShared();
+        MutexLock lock(shared.statsMutex_);
+        PoolCategoryStats& stats = shared.exitedStats_[category];
+        stats.numAllocations_ += count;
+        stats.bytes_ += bytes;
+        if (count > 0)
+            ++stats.totalAllocations_;
+    }
+}
+
+/// Take up to maxCount blocks of a size class from the shared list, reserving a new span if it is empty. Return the number of blocks.
+static unsigned FetchBlocks(unsigned sizeClass, PoolBlock*& head, unsigned maxCount)
+{
+    PoolShared& shared = GetPoolShared();
+    PoolSizeClassList& list = shared.lists_[sizeClass];
+    MutexLock lock(list.mutex_);
+
+    if (!list.free_)
+    {
+        unsigned blockSize = sizeClasses[sizeClass];
+        unsigned numBlocks = SPAN_SIZE / blockSize;
+        auto* span = static_cast<unsigned char*>(::operator new(SPAN_SIZE));
+        shared.reservedBytes_.fetch_add(SPAN_SIZE, std::memory_order_relaxed);
+
+        for (unsigned i = 0; i < numBlocks; ++i)
+        {
+            auto* block = reinterpret_cast<PoolBlock*>(span + i * blockSize);
+            block->next_ = i + 1 < numBlocks ? reinterpret_cast<PoolBlock*>(span + (i + 1) * blockSize) : nullptr;
+        }
+        list.free_ = reinterpret_cast<PoolBlock*>(span);
+    }
+
+    head = list.free_;
+    PoolBlock* last = head;
+    unsigned count = 1;
+    while (count < maxCount && last->next_)
+    {
+        last = last->next_;
+        ++count;
+    }
+    list.free_ = last->next_;
+    last->next_ = nullptr;
+    return count;
+}
+
+/// Return a chain of blocks of a size class to the shared list.
+static void ReturnBlocks(unsigned sizeClass, PoolBlock* head, PoolBlock* last)
+{
+    PoolSizeClassList& list = GetPoolShared().lists_[sizeClass];
+    MutexLock lock(list.mutex_);
+    last->next_ = list.free_;
+    list.free_ = head;
+}
+
+static void ReleaseThreadCache()
+{
+    PoolThreadCache* cache = threadCache;
+    threadCache = nullptr;
+    threadCacheReleased = true;
+    if (!cache)
+        return;
+
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        PoolBlock* head = cache->free_[i];
+        if (!head)
+            continue;
+        PoolBlock* last = head;
+        while (last->next_)
+            last = last->next_;
+        ReturnBlocks(i, head, last);
+    }
+
+    PoolShared& shared = GetPoolShared();
+    MutexLock lock(shared.statsMutex_);
+    for (unsigned i = 0; i < MAX_MEMORY_CATEGORIES; ++i)
+    {
+        shared.exitedStats_[i].numAllocations_ += cache->stats_[i].numAllocations_.load(std::memory_order_relaxed);
+        shared.exitedStats_[i].bytes_ += cache->stats_[i].bytes_.load(std::memory_order_relaxed);
+        shared.exitedStats_[i].totalAllocations_ += cache->stats_[i].totalAllocations_.load(std::memory_order_relaxed);
+    }
+    if (cache->prev_)
+        cache->prev_->next_ = cache->next_;
+    else
+        shared.threadCaches_ = cache->next_;
+    if (cache->next_)
+        cache->next_->prev_ = cache->prev_;
+
+    delete cache;
+}
+
+void* PoolAllocate(std::size_t size, MemoryCategory category)
+{
+    TrackAllocation(size);
+    PoolThreadCache* cache = GetThreadCache();
+
+    if (size > POOL_MAX_ALLOCATION_SIZE)
+    {
+        UpdateStats(cache, category, 1, (long long)size);
+        return ::operator new(size);
+    }
+
+    unsigned sizeClass = GetSizeClass(size);
+    UpdateStats(cache, category, 1, sizeClasses[sizeClass]);
+
+    PoolBlock* block;
+    if (!cache)
+        FetchBlocks(sizeClass, block, 1);
+    else
+    {
+        if (!cache->free_[sizeClass])
+            cache->numFree_[sizeClass] = FetchBlocks(sizeClass, cache->free_[sizeClass], TRANSFER_COUNT);
+        block = cache->free_[sizeClass];
+        cache->free_[sizeClass] = block->next_;
+        --cache->numFree_[sizeClass];
+    }
+
+    return block;
+}
+
+void PoolFree(void* ptr, std::size_t size, MemoryCategory category)
+{
+    if (!ptr)
+        return;
+
+    PoolThreadCache* cache = GetThreadCache();
+
+    if (size > POOL_MAX_ALLOCATION_SIZE)
+    {
+        UpdateStats(cache, category, -1, -(long long)size);
+        ::operator delete(ptr);
+        return;
+    }
+
+    unsigned sizeClass = GetSizeClass(size);
+    UpdateStats(cache, category, -1, -(long long)sizeClasses[sizeClass]);
+
+    auto* block = static_cast<PoolBlock*>(ptr);
+    if (!cache)
+    {
+        ReturnBlocks(sizeClass, block, block);
+        return;
+    }
+
+    // The block goes to the freeing thread's cache, so memory freed on another thread than it was allocated on needs no locking
+    block->next_ = cache->free_[sizeClass];
+    cache->free_[sizeClass] = block;
+    if (++cache->numFree_[sizeClass] > THREAD_CACHE_LIMIT)
+    {
+        PoolBlock* last = block;
+        for (unsigned i = 1; i < TRANSFER_COUNT; ++i)
+            last = last->next_;
+        cache->free_[sizeClass] = last->next_;
+        cache->numFree_[sizeClass] -= TRANSFER_COUNT;
+        ReturnBlocks(sizeClass, block, last);
+    }
+}
+
+PoolCategoryStats GetPoolCategoryStats(MemoryCategory category)
+{
+    PoolShared& shared = GetPoolShared();
+    MutexLock lock(shared.statsMutex_);
+
+    PoolCategoryStats ret = shared.exitedStats_[category];
+    for (PoolThreadCache* cache = shared.threadCaches_; cache; cache = cache->next_)
+    {
+        const PoolThreadStats& stats = cache->stats_[category];
+        ret.numAllocations_ += stats.numAllocations_.load(std::memory_order_relaxed);
+        ret.bytes_ += stats.bytes_.load(std::memory_order_relaxed);
+        ret.totalAllocations_ += stats.totalAllocations_.load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+unsigned long long GetPoolReservedBytes()
+{
+    return GetPoolShared().reservedBytes_.load(std::memory_order_relaxed);
+}
+
+const char* GetMemoryCategoryName(MemoryCategory category)
+{
+    return category < MAX_MEMORY_CATEGORIES ? memoryCategoryNames[category] : "";
+}
+
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include <cstddef>
+
+namespace Urho3D
+{
+
+/// Memory category of pooled allocations, used for statistics.
+enum MemoryCategory
+{
+    MEMCAT_GENERAL = 0,
+    MEMCAT_OBJECT,
+    MEMCAT_REFCOUNT,
+    MEMCAT_WORKITEM,
+    MEMCAT_CONTAINER,
+    MAX_MEMORY_CATEGORIES
+};
+
+/// Largest allocation served by the pool. Larger allocations go to the heap.
+static const unsigned POOL_MAX_ALLOCATION_SIZE = 512;
+
+/// Statistics of one memory category.
+struct PoolCategoryStats
+{
+    /// Number of allocations in use.
+    long long numAllocations_;
+    /// Bytes in use. Pooled allocations are rounded up to their size class.
+    long long bytes_;
+    /// Number of allocations made since startup.
+    long long totalAllocations_;
+};
+
+/// Allocate memory from the thread-safe pooled allocator. Small sizes are served from a per-thread cache without locking.
+URHO3D_API void* PoolAllocate(std::size_t size, MemoryCategory category = MEMCAT_GENERAL);
+/// Free memory allocated with PoolAllocate(). The size and category must be the same as when allocating, but the thread may be different.
+URHO3D_API void PoolFree(void* ptr, std::size_t size, MemoryCategory category = MEMCAT_GENERAL);
+/// Return statistics of a memory category, summed over all threads.
+URHO3D_API PoolCategoryStats GetPoolCategoryStats(MemoryCategory category);
+/// Return number of bytes the pool has reserved from the heap for small allocations.
+URHO3D_API unsigned long long GetPoolReservedBytes();
+/// Return name of a memory category.
+URHO3D_API const char* GetMemoryCategoryName(MemoryCategory category);
+
+}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+// DebugNew.h redefines new with file and line arguments, which the class-specific operators hide unless they are overloaded too.
+// The matching delete is only called if a constructor throws, and as the size is not known then, the block is leaked
+#define URHO3D_POOL_ALLOCATED_DEBUG_NEW(category) \
+    static void* operator new(std::size_t size, int, const char*, int) { return Urho3D::PoolAllocate(size, category); } \
+    static void operator delete(void*, int, const char*, int) { }
+#else
+#define URHO3D_POOL_ALLOCATED_DEBUG_NEW(category)
+#endif
+
+/// Allocate objects of a class and its subclasses with PoolAllocate(). The class must have a virtual destructor if subclasses
+/// are deleted through a base pointer, so that the sized delete receives the correct size.
+#define URHO3D_POOL_ALLOCATED(category) \
+    static void* operator new(std::size_t size) { return Urho3D::PoolAllocate(size, category); } \
+    static void operator delete(void* ptr, std::size_t size) { Urho3D::PoolFree(ptr, size, category); } \
+    static void* operator new(std::size_t, void* ptr) { return ptr; } \
+    static void operator delete(void*, void*) { } \
+    URHO3D_POOL_ALLOCATED_DEBUG_NEW(category)
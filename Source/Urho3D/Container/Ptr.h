@@ -157,9 +157,9 @@ public:
         if (ptr_)
         {
             RefCount* refCount = RefCountPtr();
-            ++refCount->refs_; // 2 refs
+            refCount->AddRef(); // 2 refs
             Reset(); // 1 ref
-            --refCount->refs_; // 0 refs
+            refCount->ReleaseRef(); // 0 refs
         }
         return ptr;
     }
@@ -438,7 +438,11 @@ public:
     bool NotNull() const { return refCount_ != nullptr; }
 
     /// Return the object's reference count, or 0 if null pointer or if object has expired.
-    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int Refs() const
+    {
+        int refs = refCount_ ? refCount_->Refs() : 0;
+        return refs >= 0 ? refs : 0;
+    }
 
     /// Return the object's weak reference count.
     int WeakRefs() const
@@ -446,11 +450,11 @@ public:
         if (!Expired())
             return ptr_->WeakRefs();
         else
-            return refCount_ ? refCount_->weakRefs_ : 0;
+            return refCount_ ? refCount_->WeakRefs() : 0;
     }
 
     /// Return whether the object has expired. If null pointer, always return true.
-    bool Expired() const { return refCount_ ? refCount_->refs_ < 0 : true; }
+    bool Expired() const { return refCount_ ? refCount_->Refs() < 0 : true; }
 
     /// Return pointer to the RefCount structure.
     RefCount* RefCountPtr() const { return refCount_; }
@@ -466,8 +470,8 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->weakRefs_ >= 0);
-            ++(refCount_->weakRefs_);
+            assert(refCount_->WeakRefs() >= 0);
+            refCount_->AddWeakRef();
         }
     }
 
@@ -476,11 +480,13 @@ private:
     {
         if (refCount_)
         {
-            assert(refCount_->weakRefs_ > 0);
-            --(refCount_->weakRefs_);
-
-            if (Expired() && !refCount_->weakRefs_)
+            assert(refCount_->WeakRefs() > 0);
+            // The object holds a weak reference to itself until destroyed, so only the last release after expiry owns the structure
+            if (refCount_->ReleaseWeakRefAndCheckOwner())
+            {
+                assert(Expired());
                 delete refCount_;
+            }
         }
 
         ptr_ = nullptr;
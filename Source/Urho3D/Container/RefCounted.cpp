@@ -32,20 +32,23 @@ namespace Urho3D
 RefCounted::RefCounted() :
     refCount_(new RefCount())
 {
+#ifdef URHO3D_ATOMIC_REFCOUNT
+    refCount_->atomic_ = true;
+#endif
+
     // Hold a weak ref to self to avoid possible double delete of the refcount
-    (refCount_->weakRefs_)++;
+    refCount_->AddWeakRef();
 }
 
 RefCounted::~RefCounted()
 {
     assert(refCount_);
-    assert(refCount_->refs_ == 0);
-    assert(refCount_->weakRefs_ > 0);
+    assert(refCount_->Refs() == 0);
+    assert(refCount_->WeakRefs() > 0);
 
     // Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
-    refCount_->refs_ = -1;
-    (refCount_->weakRefs_)--;
-    if (!refCount_->weakRefs_)
+    refCount_->SetExpired();
+    if (refCount_->ReleaseWeakRefAndCheckOwner())
         delete refCount_;
 
     refCount_ = nullptr;
@@ -53,27 +56,36 @@ RefCounted::~RefCounted()
 
 void RefCounted::AddRef()
 {
-    assert(refCount_->refs_ >= 0);
-    (refCount_->refs_)++;
+    assert(refCount_->Refs() >= 0);
+    refCount_->AddRef();
 }
 
 void RefCounted::ReleaseRef()
 {
-    assert(refCount_->refs_ > 0);
-    (refCount_->refs_)--;
-    if (!refCount_->refs_)
+    assert(refCount_->Refs() > 0);
+    if (!refCount_->ReleaseRef())
         delete this;
 }
 
 int RefCounted::Refs() const
 {
-    return refCount_->refs_;
+    return refCount_->Refs();
 }
 
 int RefCounted::WeakRefs() const
 {
     // Subtract one to not return the internally held reference
-    return refCount_->weakRefs_ - 1;
+    return refCount_->WeakRefs() - 1;
+}
+
+void RefCounted::SetAtomicRefCount(bool enable)
+{
+#ifdef URHO3D_ATOMIC_REFCOUNT
+    // All objects are in atomic mode
+    (void)enable;
+#else
+    refCount_->atomic_ = enable;
+#endif
 }
 
 }
@@ -28,16 +28,26 @@
 #include <Urho3D/Urho3D.h>
 #endif
 
+#include "../Container/PoolAllocator.h"
+
+#include <atomic>
+
 namespace Urho3D
 {
 
 /// Reference count structure.
+/** The counts are stored as atomics, but only objects in atomic mode pay for atomic read-modify-write operations. In the
+    default mode the counts are updated with plain loads and stores, and must only be changed from one thread at a time.
+  */
 struct RefCount
 {
+    URHO3D_POOL_ALLOCATED(MEMCAT_REFCOUNT)
+
     /// Construct.
     RefCount() :
         refs_(0),
-        weakRefs_(0)
+        weakRefs_(0),
+        atomic_(false)
     {
     }
 
@@ -45,20 +55,103 @@ struct RefCount
     ~RefCount()
     {
         // Set reference counts below zero to fire asserts if this object is still accessed
-        refs_ = -1;
-        weakRefs_ = -1;
+        refs_.store(-1, std::memory_order_relaxed);
+        weakRefs_.store(-1, std::memory_order_relaxed);
+    }
+
+    /// Increment the reference count.
+    void AddRef()
+    {
+        if (atomic_)
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        else
+            refs_.store(refs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /// Decrement the reference count and return the new count.
+    int ReleaseRef()
+    {
+        if (atomic_)
+            return refs_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+        int refs = refs_.load(std::memory_order_relaxed) - 1;
+        refs_.store(refs, std::memory_order_relaxed);
+        return refs;
+    }
+
+    /// Increment the reference count only if it is above zero. Return whether succeeded.
+    bool TryAddRef()
+    {
+        int refs = refs_.load(std::memory_order_relaxed);
+        while (refs > 0)
+        {
+            if (refs_.compare_exchange_weak(refs, refs + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    /// Increment the weak reference count.
+    void AddWeakRef()
+    {
+        if (atomic_)
+            weakRefs_.fetch_add(1, std::memory_order_relaxed);
+        else
+            weakRefs_.store(weakRefs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
 
+    /// Decrement the weak reference count and return the new count.
+    int ReleaseWeakRef()
+    {
+        if (atomic_)
+            return weakRefs_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+        int weakRefs = weakRefs_.load(std::memory_order_relaxed) - 1;
+        weakRefs_.store(weakRefs, std::memory_order_relaxed);
+        return weakRefs;
+    }
+
+    /// Release one weak reference of a RefCounted object and return whether the caller now owns the reference count structure and must delete it.
+    /** In atomic mode the count is settled with a compare-and-swap, so that of the destructor releasing the self weak reference and the last weak pointers being released concurrently, exactly the one that takes the count from one to zero owns the structure.
+      */
+    bool ReleaseWeakRefAndCheckOwner()
+    {
+        if (!atomic_)
+            return ReleaseWeakRef() == 0;
+
+        int weakRefs = weakRefs_.load(std::memory_order_relaxed);
+        while (!weakRefs_.compare_exchange_weak(weakRefs, weakRefs - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+        }
+        return weakRefs == 1;
+    }
+
+    /// Mark the object destroyed.
+    void SetExpired() { refs_.store(-1, std::memory_order_release); }
+
+    /// Return reference count.
+    int Refs() const { return refs_.load(std::memory_order_acquire); }
+
+    /// Return weak reference count.
+    int WeakRefs() const { return weakRefs_.load(std::memory_order_acquire); }
+
+    /// Return whether the object has been destroyed.
+    bool Expired() const { return Refs() < 0; }
+
     /// Reference count. If below zero, the object has been destroyed.
-    int refs_;
+    std::atomic<int> refs_;
     /// Weak reference count.
-    int weakRefs_;
+    std::atomic<int> weakRefs_;
+    /// Atomic mode flag. When set, the counts can be changed from several threads at once.
+    bool atomic_;
 };
 
 /// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable.
 class URHO3D_API RefCounted
 {
 public:
+    URHO3D_POOL_ALLOCATED(MEMCAT_OBJECT)
+
     /// Construct. Allocate the reference count structure and set an initial self weak reference.
     RefCounted();
     /// Destruct. Mark as expired and also delete the reference count structure if no outside weak references exist.
@@ -77,10 +170,16 @@ public:
     int Refs() const;
     /// Return weak reference count.
     int WeakRefs() const;
+    /// Return whether the reference counts are atomic, so that shared and weak pointers to this object can be copied and released on several threads at once.
+    bool IsAtomicRefCount() const { return refCount_->atomic_; }
 
     /// Return pointer to the reference count structure.
     RefCount* RefCountPtr() { return refCount_; }
 
+protected:
+    /// Set whether to use atomic reference counts. Always on when the engine is built with URHO3D_ATOMIC_REFCOUNT. Must be called before the object is shared between threads, normally in the constructor.
+    void SetAtomicRefCount(bool enable);
+
 private:
     /// Pointer to the reference count structure.
     RefCount* refCount_;
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Ptr.h"
+
+namespace Urho3D
+{
+
+/// Non-owning reference to a RefCounted object for passing between threads. The object should use atomic reference counts, see RefCounted::SetAtomicRefCount().
+/** Works like a WeakPtr, but Lock() only succeeds while the object has strong references, so it never races with the last
+    SharedPtr being released on another thread. Moving a handle does not touch the reference counts.
+  */
+template <class T> class RefHandle
+{
+public:
+    /// Construct a null handle.
+    RefHandle() noexcept :
+        ptr_(nullptr),
+        refCount_(nullptr)
+    {
+    }
+
+    /// Construct from a raw pointer.
+    explicit RefHandle(T* ptr) :
+        ptr_(ptr),
+        refCount_(ptr ? ptr->RefCountPtr() : nullptr)
+    {
+        assert(!ptr || ptr->IsAtomicRefCount());
+        AddRef();
+    }
+
+    /// Construct from a shared pointer.
+    explicit RefHandle(const SharedPtr<T>& ptr) :
+        RefHandle(ptr.Get())
+    {
+    }
+
+    /// Copy-construct.
+    RefHandle(const RefHandle<T>& rhs) :
+        ptr_(rhs.ptr_),
+        refCount_(rhs.refCount_)
+    {
+        AddRef();
+    }
+
+    /// Move-construct.
+    RefHandle(RefHandle<T>&& rhs) noexcept :
+        ptr_(rhs.ptr_),
+        refCount_(rhs.refCount_)
+    {
+        rhs.ptr_ = nullptr;
+        rhs.refCount_ = nullptr;
+    }
+
+    /// Destruct.
+    ~RefHandle()
+    {
+        ReleaseRef();
+    }
+
+    /// Assign from another handle.
+    RefHandle<T>& operator =(const RefHandle<T>& rhs)
+    {
+        if (refCount_ == rhs.refCount_)
+            return *this;
+
+        ReleaseRef();
+        ptr_ = rhs.ptr_;
+        refCount_ = rhs.refCount_;
+        AddRef();
+        return *this;
+    }
+
+    /// Move-assign from another handle.
+    RefHandle<T>& operator =(RefHandle<T>&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            ReleaseRef();
+            ptr_ = rhs.ptr_;
+            refCount_ = rhs.refCount_;
+            rhs.ptr_ = nullptr;
+            rhs.refCount_ = nullptr;
+        }
+        return *this;
+    }
+
+    /// Return a shared pointer to the object, or null if it has no strong references left.
+    SharedPtr<T> Lock() const
+    {
+        if (!refCount_ || !refCount_->TryAddRef())
+            return SharedPtr<T>();
+
+        // The reference taken above keeps the object alive until the shared pointer holds its own
+        SharedPtr<T> ret(ptr_);
+        refCount_->ReleaseRef();
+        return ret;
+    }
+
+    /// Release the reference.
+    void Reset() { ReleaseRef(); }
+
+    /// Test for equality with another handle.
+    bool operator ==(const RefHandle<T>& rhs) const { return refCount_ == rhs.refCount_; }
+
+    /// Test for inequality with another handle.
+    bool operator !=(const RefHandle<T>& rhs) const { return refCount_ != rhs.refCount_; }
+
+    /// Return whether is a null handle.
+    bool Null() const { return refCount_ == nullptr; }
+
+    /// Return whether is not a null handle.
+    bool NotNull() const { return refCount_ != nullptr; }
+
+    /// Return whether the object has no strong references left.
+    bool Expired() const { return refCount_ ? refCount_->Refs() <= 0 : true; }
+
+    /// Return hash value for HashSet & HashMap.
+    unsigned ToHash() const { return (unsigned)((size_t)ptr_ / sizeof(T)); }
+
+private:
+    /// Add a weak reference, which keeps the reference count structure alive.
+    void AddRef()
+    {
+        if (refCount_)
+            refCount_->AddWeakRef();
+    }
+
+    /// Release the weak reference and delete the reference count structure if it was the last one.
+    void ReleaseRef()
+    {
+        // The object holds a weak reference to itself until destroyed, so a zero count means it is gone
+        if (refCount_ && refCount_->ReleaseWeakRefAndCheckOwner())
+            delete refCount_;
+
+        ptr_ = nullptr;
+        refCount_ = nullptr;
+    }
+
+    /// Pointer to the object.
+    T* ptr_;
+    /// Pointer to the RefCount structure.
+    RefCount* refCount_;
+};
+
+}
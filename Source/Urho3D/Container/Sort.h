@@ -29,6 +29,7 @@ namespace Urho3D
 {
 
 static const int QUICKSORT_THRESHOLD = 16;
+static const int RADIXSORT_THRESHOLD = 64;
 
 // Based on Comparison of several sorting algorithms by Juha Nieminen
 // http://warp.povusers.org/SortComparison/
@@ -141,4 +142,75 @@ template <class T, class U> void Sort(RandomAccessIterator<T> begin, RandomAcces
     InsertionSort(begin, end, compare);
 }
 
+/// Key and value pair for radix sort.
+template <class T> struct RadixSortEntry
+{
+    /// Sort key.
+    unsigned long long key_;
+    /// Value.
+    T value_;
+};
+
+/// Sort key and value pairs in ascending order of the keys using a stable least significant byte first radix sort. The buffer must have room for as many entries as the range. Key bytes that are the same in all entries are skipped.
+template <class T> void RadixSort(RadixSortEntry<T>* begin, RadixSortEntry<T>* end, RadixSortEntry<T>* buffer)
+{
+    auto count = (unsigned)(end - begin);
+
+    // Short ranges are faster to sort with an insertion sort, which is stable as well
+    if (count <= RADIXSORT_THRESHOLD)
+    {
+        for (RadixSortEntry<T>* i = begin + 1; i < end; ++i)
+        {
+            RadixSortEntry<T> temp = *i;
+            RadixSortEntry<T>* j = i;
+            while (j > begin && temp.key_ < (j - 1)->key_)
+            {
+                *j = *(j - 1);
+                --j;
+            }
+            *j = temp;
+        }
+        return;
+    }
+
+    // Count the occurrences of each byte value for all key bytes in one go
+    unsigned histograms[8][256] = {};
+    for (RadixSortEntry<T>* i = begin; i < end; ++i)
+    {
+        unsigned long long key = i->key_;
+        for (unsigned j = 0; j < 8; ++j)
+            ++histograms[j][(key >> (j * 8)) & 0xffu];
+    }
+
+    RadixSortEntry<T>* src = begin;
+    RadixSortEntry<T>* dest = buffer;
+    for (unsigned j = 0; j < 8; ++j)
+    {
+        unsigned* histogram = histograms[j];
+        unsigned shift = j * 8;
+        if (histogram[(src->key_ >> shift) & 0xffu] == count)
+            continue;
+
+        unsigned offset = 0;
+        for (unsigned k = 0; k < 256; ++k)
+        {
+            unsigned numEntries = histogram[k];
+            histogram[k] = offset;
+            offset += numEntries;
+        }
+
+        for (RadixSortEntry<T>* i = src; i < src + count; ++i)
+            dest[histogram[(i->key_ >> shift) & 0xffu]++] = *i;
+
+        Swap(src, dest);
+    }
+
+    // After an odd number of passes the result is in the buffer
+    if (src != begin)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            begin[i] = src[i];
+    }
+}
+
 }
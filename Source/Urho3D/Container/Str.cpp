@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../IO/Log.h"
 
 #include <cstdio>
@@ -35,22 +36,16 @@
 namespace Urho3D
 {
 
-char String::endZero = 0;
-
 const String String::EMPTY;
 
 String::String(const WString& str) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     SetUTF8FromWChar(str.CString());
 }
 
 String::String(int value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%d", value);
@@ -58,9 +53,7 @@ String::String(int value) :
 }
 
 String::String(short value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%d", value);
@@ -68,9 +61,7 @@ String::String(short value) :
 }
 
 String::String(long value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%ld", value);
@@ -78,9 +69,7 @@ String::String(long value) :
 }
 
 String::String(long long value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%lld", value);
@@ -88,9 +77,7 @@ String::String(long long value) :
 }
 
 String::String(unsigned value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%u", value);
@@ -98,9 +85,7 @@ String::String(unsigned value) :
 }
 
 String::String(unsigned short value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%u", value);
@@ -108,9 +93,7 @@ String::String(unsigned short value) :
 }
 
 String::String(unsigned long value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%lu", value);
@@ -118,9 +101,7 @@ String::String(unsigned long value) :
 }
 
 String::String(unsigned long long value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%llu", value);
@@ -128,9 +109,7 @@ String::String(unsigned long long value) :
 }
 
 String::String(float value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%g", value);
@@ -138,9 +117,7 @@ String::String(float value) :
 }
 
 String::String(double value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%.15g", value);
@@ -148,9 +125,7 @@ String::String(double value) :
 }
 
 String::String(bool value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     if (value)
         *this = "true";
@@ -159,22 +134,18 @@ String::String(bool value) :
 }
 
 String::String(char value) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     Resize(1);
-    buffer_[0] = value;
+    Buffer()[0] = value;
 }
 
 String::String(char value, unsigned length) :
-    length_(0),
-    capacity_(0),
-    buffer_(&endZero)
+    local_()
 {
     Resize(length);
     for (unsigned i = 0; i < length; ++i)
-        buffer_[i] = value;
+        Buffer()[i] = value;
 }
 
 String& String::operator +=(int rhs)
@@ -231,19 +202,19 @@ void String::Replace(char replaceThis, char replaceWith, bool caseSensitive)
 {
     if (caseSensitive)
     {
-        for (unsigned i = 0; i < length_; ++i)
+        for (unsigned i = 0; i < Length(); ++i)
         {
-            if (buffer_[i] == replaceThis)
-                buffer_[i] = replaceWith;
+            if (Buffer()[i] == replaceThis)
+                Buffer()[i] = replaceWith;
         }
     }
     else
     {
         replaceThis = (char)tolower(replaceThis);
-        for (unsigned i = 0; i < length_; ++i)
+        for (unsigned i = 0; i < Length(); ++i)
         {
-            if (tolower(buffer_[i]) == replaceThis)
-                buffer_[i] = replaceWith;
+            if (tolower(Buffer()[i]) == replaceThis)
+                Buffer()[i] = replaceWith;
         }
     }
 }
@@ -252,29 +223,29 @@ void String::Replace(const String& replaceThis, const String& replaceWith, bool
 {
     unsigned nextPos = 0;
 
-    while (nextPos < length_)
+    while (nextPos < Length())
     {
         unsigned pos = Find(replaceThis, nextPos, caseSensitive);
         if (pos == NPOS)
             break;
-        Replace(pos, replaceThis.length_, replaceWith);
-        nextPos = pos + replaceWith.length_;
+        Replace(pos, replaceThis.Length(), replaceWith);
+        nextPos = pos + replaceWith.Length();
     }
 }
 
 void String::Replace(unsigned pos, unsigned length, const String& replaceWith)
 {
     // If substring is illegal, do nothing
-    if (pos + length > length_)
+    if (pos + length > Length())
         return;
 
-    Replace(pos, length, replaceWith.buffer_, replaceWith.length_);
+    Replace(pos, length, replaceWith.Buffer(), replaceWith.Length());
 }
 
 void String::Replace(unsigned pos, unsigned length, const char* replaceWith)
 {
     // If substring is illegal, do nothing
-    if (pos + length > length_)
+    if (pos + length > Length())
         return;
 
     Replace(pos, length, replaceWith, CStringLength(replaceWith));
@@ -283,7 +254,7 @@ void String::Replace(unsigned pos, unsigned length, const char* replaceWith)
 String::Iterator String::Replace(const String::Iterator& start, const String::Iterator& end, const String& replaceWith)
 {
     unsigned pos = (unsigned)(start - Begin());
-    if (pos >= length_)
+    if (pos >= Length())
         return End();
     auto length = (unsigned)(end - start);
     Replace(pos, length, replaceWith);
@@ -324,19 +295,19 @@ String& String::Append(const char* str, unsigned length)
 {
     if (str)
     {
-        unsigned oldLength = length_;
+        unsigned oldLength = Length();
         Resize(oldLength + length);
-        CopyChars(&buffer_[oldLength], str, length);
+        CopyChars(&Buffer()[oldLength], str, length);
     }
     return *this;
 }
 
 void String::Insert(unsigned pos, const String& str)
 {
-    if (pos > length_)
-        pos = length_;
+    if (pos > Length())
+        pos = Length();
 
-    if (pos == length_)
+    if (pos == Length())
         (*this) += str;
     else
         Replace(pos, 0, str);
@@ -344,25 +315,25 @@ void String::Insert(unsigned pos, const String& str)
 
 void String::Insert(unsigned pos, char c)
 {
-    if (pos > length_)
-        pos = length_;
+    if (pos > Length())
+        pos = Length();
 
-    if (pos == length_)
+    if (pos == Length())
         (*this) += c;
     else
     {
-        unsigned oldLength = length_;
-        Resize(length_ + 1);
+        unsigned oldLength = Length();
+        Resize(Length() + 1);
         MoveRange(pos + 1, pos, oldLength - pos);
-        buffer_[pos] = c;
+        Buffer()[pos] = c;
     }
 }
 
 String::Iterator String::Insert(const String::Iterator& dest, const String& str)
 {
     unsigned pos = (unsigned)(dest - Begin());
-    if (pos > length_)
-        pos = length_;
+    if (pos > Length())
+        pos = Length();
     Insert(pos, str);
 
     return Begin() + pos;
@@ -371,8 +342,8 @@ String::Iterator String::Insert(const String::Iterator& dest, const String& str)
 String::Iterator String::Insert(const String::Iterator& dest, const String::Iterator& start, const String::Iterator& end)
 {
     unsigned pos = (unsigned)(dest - Begin());
-    if (pos > length_)
-        pos = length_;
+    if (pos > Length())
+        pos = Length();
     auto length = (unsigned)(end - start);
     Replace(pos, 0, &(*start), length);
 
@@ -382,8 +353,8 @@ String::Iterator String::Insert(const String::Iterator& dest, const String::Iter
 String::Iterator String::Insert(const String::Iterator& dest, char c)
 {
     unsigned pos = (unsigned)(dest - Begin());
-    if (pos > length_)
-        pos = length_;
+    if (pos > Length())
+        pos = Length();
     Insert(pos, c);
 
     return Begin() + pos;
@@ -397,7 +368,7 @@ void String::Erase(unsigned pos, unsigned length)
 String::Iterator String::Erase(const String::Iterator& it)
 {
     unsigned pos = (unsigned)(it - Begin());
-    if (pos >= length_)
+    if (pos >= Length())
         return End();
     Erase(pos);
 
@@ -407,7 +378,7 @@ String::Iterator String::Erase(const String::Iterator& it)
 String::Iterator String::Erase(const String::Iterator& start, const String::Iterator& end)
 {
     unsigned pos = (unsigned)(start - Begin());
-    if (pos >= length_)
+    if (pos >= Length())
         return End();
     auto length = (unsigned)(end - start);
     Erase(pos, length);
@@ -417,62 +388,89 @@ String::Iterator String::Erase(const String::Iterator& start, const String::Iter
 
 void String::Resize(unsigned newLength)
 {
-    if (!capacity_)
+    if (IsLocal())
     {
-        // If zero length requested, do not allocate buffer yet
-        if (!newLength)
-            return;
-
-        // Calculate initial capacity
-        capacity_ = newLength + 1;
-        if (capacity_ < MIN_CAPACITY)
-            capacity_ = MIN_CAPACITY;
-
-        buffer_ = new char[capacity_];
+        // Stay in the inline buffer as long as the string fits
+        if (newLength >= LOCAL_CAPACITY)
+        {
+            // Calculate initial capacity
+            unsigned newCapacity = newLength + 1;
+            if (newCapacity < MIN_CAPACITY)
+                newCapacity = MIN_CAPACITY;
+
+            auto* newBuffer = new char[newCapacity];
+            TrackAllocation(newCapacity);
+            // Move the existing data out of the inline buffer before the heap storage overwrites it
+            unsigned length = Length();
+            if (length)
+                CopyChars(newBuffer, local_, length);
+
+            heap_.buffer_ = newBuffer;
+            heap_.capacity_ = newCapacity | HEAP_FLAG;
+        }
     }
     else
     {
-        if (newLength && capacity_ < newLength + 1)
+        unsigned capacity = Capacity();
+        if (newLength && capacity < newLength + 1)
         {
             // Increase the capacity with half each time it is exceeded
-            while (capacity_ < newLength + 1)
-                capacity_ += (capacity_ + 1) >> 1u;
+            while (capacity < newLength + 1)
+                capacity += (capacity + 1) >> 1u;
 
-            auto* newBuffer = new char[capacity_];
+            auto* newBuffer = new char[capacity];
+            TrackAllocation(capacity);
             // Move the existing data to the new buffer, then delete the old buffer
-            if (length_)
-                CopyChars(newBuffer, buffer_, length_);
-            delete[] buffer_;
+            if (heap_.length_)
+                CopyChars(newBuffer, heap_.buffer_, heap_.length_);
+            delete[] heap_.buffer_;
 
-            buffer_ = newBuffer;
+            heap_.buffer_ = newBuffer;
+            heap_.capacity_ = capacity | HEAP_FLAG;
         }
     }
 
-    buffer_[newLength] = 0;
-    length_ = newLength;
+    Buffer()[newLength] = 0;
+    SetLength(newLength);
 }
 
 void String::Reserve(unsigned newCapacity)
 {
-    if (newCapacity < length_ + 1)
-        newCapacity = length_ + 1;
-    if (newCapacity == capacity_)
+    unsigned length = Length();
+    if (newCapacity < length + 1)
+        newCapacity = length + 1;
+
+    // A capacity that fits the inline buffer moves the string back there
+    if (newCapacity <= LOCAL_CAPACITY)
+    {
+        if (!IsLocal())
+        {
+            char* oldBuffer = heap_.buffer_;
+            CopyChars(local_, oldBuffer, length + 1);
+            local_[LOCAL_CAPACITY] = (char)length;
+            delete[] oldBuffer;
+        }
+        return;
+    }
+    if (newCapacity == Capacity())
         return;
 
     auto* newBuffer = new char[newCapacity];
+    TrackAllocation(newCapacity);
     // Move the existing data to the new buffer, then delete the old buffer
-    CopyChars(newBuffer, buffer_, length_ + 1);
-    if (capacity_)
-        delete[] buffer_;
+    CopyChars(newBuffer, Buffer(), length + 1);
+    if (!IsLocal())
+        delete[] heap_.buffer_;
 
-    capacity_ = newCapacity;
-    buffer_ = newBuffer;
+    heap_.buffer_ = newBuffer;
+    heap_.length_ = length;
+    heap_.capacity_ = newCapacity | HEAP_FLAG;
 }
 
 void String::Compact()
 {
-    if (capacity_)
-        Reserve(length_ + 1);
+    if (!IsLocal())
+        Reserve(Length() + 1);
 }
 
 void String::Clear()
@@ -482,18 +480,20 @@ void String::Clear()
 
 void String::Swap(String& str)
 {
-    Urho3D::Swap(length_, str.length_);
-    Urho3D::Swap(capacity_, str.capacity_);
-    Urho3D::Swap(buffer_, str.buffer_);
+    // The inline buffer holds no pointers to itself and overlays the whole storage, so it can be swapped bytewise
+    char temp[LOCAL_CAPACITY + 1];
+    memcpy(temp, local_, sizeof temp);
+    memcpy(local_, str.local_, sizeof temp);
+    memcpy(str.local_, temp, sizeof temp);
 }
 
 String String::Substring(unsigned pos) const
 {
-    if (pos < length_)
+    if (pos < Length())
     {
         String ret;
-        ret.Resize(length_ - pos);
-        CopyChars(ret.buffer_, buffer_ + pos, ret.length_);
+        ret.Resize(Length() - pos);
+        CopyChars(ret.Buffer(), Buffer() + pos, ret.Length());
 
         return ret;
     }
@@ -503,13 +503,13 @@ String String::Substring(unsigned pos) const
 
 String String::Substring(unsigned pos, unsigned length) const
 {
-    if (pos < length_)
+    if (pos < Length())
     {
         String ret;
-        if (pos + length > length_)
-            length = length_ - pos;
+        if (pos + length > Length())
+            length = Length() - pos;
         ret.Resize(length);
-        CopyChars(ret.buffer_, buffer_ + pos, ret.length_);
+        CopyChars(ret.Buffer(), Buffer() + pos, ret.Length());
 
         return ret;
     }
@@ -520,18 +520,18 @@ String String::Substring(unsigned pos, unsigned length) const
 String String::Trimmed() const
 {
     unsigned trimStart = 0;
-    unsigned trimEnd = length_;
+    unsigned trimEnd = Length();
 
     while (trimStart < trimEnd)
     {
-        char c = buffer_[trimStart];
+        char c = Buffer()[trimStart];
         if (c != ' ' && c != 9)
             break;
         ++trimStart;
     }
     while (trimEnd > trimStart)
     {
-        char c = buffer_[trimEnd - 1];
+        char c = Buffer()[trimEnd - 1];
         if (c != ' ' && c != 9)
             break;
         --trimEnd;
@@ -543,8 +543,8 @@ String String::Trimmed() const
 String String::ToLower() const
 {
     String ret(*this);
-    for (unsigned i = 0; i < ret.length_; ++i)
-        ret[i] = (char)tolower(buffer_[i]);
+    for (unsigned i = 0; i < ret.Length(); ++i)
+        ret[i] = (char)tolower(Buffer()[i]);
 
     return ret;
 }
@@ -552,8 +552,8 @@ String String::ToLower() const
 String String::ToUpper() const
 {
     String ret(*this);
-    for (unsigned i = 0; i < ret.length_; ++i)
-        ret[i] = (char)toupper(buffer_[i]);
+    for (unsigned i = 0; i < ret.Length(); ++i)
+        ret[i] = (char)toupper(Buffer()[i]);
 
     return ret;
 }
@@ -572,18 +572,18 @@ unsigned String::Find(char c, unsigned startPos, bool caseSensitive) const
 {
     if (caseSensitive)
     {
-        for (unsigned i = startPos; i < length_; ++i)
+        for (unsigned i = startPos; i < Length(); ++i)
         {
-            if (buffer_[i] == c)
+            if (Buffer()[i] == c)
                 return i;
         }
     }
     else
     {
         c = (char)tolower(c);
-        for (unsigned i = startPos; i < length_; ++i)
+        for (unsigned i = startPos; i < Length(); ++i)
         {
-            if (tolower(buffer_[i]) == c)
+            if (tolower(Buffer()[i]) == c)
                 return i;
         }
     }
@@ -593,16 +593,16 @@ unsigned String::Find(char c, unsigned startPos, bool caseSensitive) const
 
 unsigned String::Find(const String& str, unsigned startPos, bool caseSensitive) const
 {
-    if (!str.length_ || str.length_ > length_)
+    if (!str.Length() || str.Length() > Length())
         return NPOS;
 
-    char first = str.buffer_[0];
+    char first = str.Buffer()[0];
     if (!caseSensitive)
         first = (char)tolower(first);
 
-    for (unsigned i = startPos; i <= length_ - str.length_; ++i)
+    for (unsigned i = startPos; i <= Length() - str.Length(); ++i)
     {
-        char c = buffer_[i];
+        char c = Buffer()[i];
         if (!caseSensitive)
             c = (char)tolower(c);
 
@@ -610,10 +610,10 @@ unsigned String::Find(const String& str, unsigned startPos, bool caseSensitive)
         {
             unsigned skip = NPOS;
             bool found = true;
-            for (unsigned j = 1; j < str.length_; ++j)
+            for (unsigned j = 1; j < str.Length(); ++j)
             {
-                c = buffer_[i + j];
-                char d = str.buffer_[j];
+                c = Buffer()[i + j];
+                char d = str.Buffer()[j];
                 if (!caseSensitive)
                 {
                     c = (char)tolower(c);
@@ -641,23 +641,23 @@ unsigned String::Find(const String& str, unsigned startPos, bool caseSensitive)
 
 unsigned String::FindLast(char c, unsigned startPos, bool caseSensitive) const
 {
-    if (startPos >= length_)
-        startPos = length_ - 1;
+    if (startPos >= Length())
+        startPos = Length() - 1;
 
     if (caseSensitive)
     {
-        for (unsigned i = startPos; i < length_; --i)
+        for (unsigned i = startPos; i < Length(); --i)
         {
-            if (buffer_[i] == c)
+            if (Buffer()[i] == c)
                 return i;
         }
     }
     else
     {
         c = (char)tolower(c);
-        for (unsigned i = startPos; i < length_; --i)
+        for (unsigned i = startPos; i < Length(); --i)
         {
-            if (tolower(buffer_[i]) == c)
+            if (tolower(Buffer()[i]) == c)
                 return i;
         }
     }
@@ -667,28 +667,28 @@ unsigned String::FindLast(char c, unsigned startPos, bool caseSensitive) const
 
 unsigned String::FindLast(const String& str, unsigned startPos, bool caseSensitive) const
 {
-    if (!str.length_ || str.length_ > length_)
+    if (!str.Length() || str.Length() > Length())
         return NPOS;
-    if (startPos > length_ - str.length_)
-        startPos = length_ - str.length_;
+    if (startPos > Length() - str.Length())
+        startPos = Length() - str.Length();
 
-    char first = str.buffer_[0];
+    char first = str.Buffer()[0];
     if (!caseSensitive)
         first = (char)tolower(first);
 
-    for (unsigned i = startPos; i < length_; --i)
+    for (unsigned i = startPos; i < Length(); --i)
     {
-        char c = buffer_[i];
+        char c = Buffer()[i];
         if (!caseSensitive)
             c = (char)tolower(c);
 
         if (c == first)
         {
             bool found = true;
-            for (unsigned j = 1; j < str.length_; ++j)
+            for (unsigned j = 1; j < str.Length(); ++j)
             {
-                c = buffer_[i + j];
-                char d = str.buffer_[j];
+                c = Buffer()[i + j];
+                char d = str.Buffer()[j];
                 if (!caseSensitive)
                 {
                     c = (char)tolower(c);
@@ -781,10 +781,10 @@ unsigned String::LengthUTF8() const
 {
     unsigned ret = 0;
 
-    const char* src = buffer_;
+    const char* src = Buffer();
     if (!src)
         return ret;
-    const char* end = buffer_ + length_;
+    const char* end = Buffer() + Length();
 
     while (src < end)
     {
@@ -800,7 +800,7 @@ unsigned String::ByteOffsetUTF8(unsigned index) const
     unsigned byteOffset = 0;
     unsigned utfPos = 0;
 
-    while (utfPos < index && byteOffset < length_)
+    while (utfPos < index && byteOffset < Length())
     {
         NextUTF8Char(byteOffset);
         ++utfPos;
@@ -811,12 +811,12 @@ unsigned String::ByteOffsetUTF8(unsigned index) const
 
 unsigned String::NextUTF8Char(unsigned& byteOffset) const
 {
-    if (!buffer_)
+    if (!Buffer())
         return 0;
 
-    const char* src = buffer_ + byteOffset;
+    const char* src = Buffer() + byteOffset;
     unsigned ret = DecodeUTF8(src);
-    byteOffset = (unsigned)(src - buffer_);
+    byteOffset = (unsigned)(src - Buffer());
 
     return ret;
 }
@@ -832,7 +832,7 @@ void String::ReplaceUTF8(unsigned index, unsigned unicodeChar)
     unsigned utfPos = 0;
     unsigned byteOffset = 0;
 
-    while (utfPos < index && byteOffset < length_)
+    while (utfPos < index && byteOffset < Length())
     {
         NextUTF8Char(byteOffset);
         ++utfPos;
@@ -1215,23 +1215,23 @@ void String::Replace(unsigned pos, unsigned length, const char* srcStart, unsign
 {
     int delta = (int)srcLength - (int)length;
 
-    if (pos + length < length_)
+    if (pos + length < Length())
     {
         if (delta < 0)
         {
-            MoveRange(pos + srcLength, pos + length, length_ - pos - length);
-            Resize(length_ + delta);
+            MoveRange(pos + srcLength, pos + length, Length() - pos - length);
+            Resize(Length() + delta);
         }
         if (delta > 0)
         {
-            Resize(length_ + delta);
-            MoveRange(pos + srcLength, pos + length, length_ - pos - length - delta);
+            Resize(Length() + delta);
+            MoveRange(pos + srcLength, pos + length, Length() - pos - length - delta);
         }
     }
     else
-        Resize(length_ + delta);
+        Resize(Length() + delta);
 
-    CopyChars(buffer_ + pos, srcStart, srcLength);
+    CopyChars(Buffer() + pos, srcStart, srcLength);
 }
 
 WString::WString() :
@@ -42,7 +42,7 @@ template <class T, class U> class HashMap;
 /// Map of strings.
 using StringMap = HashMap<StringHash, String>;
 
-/// %String class.
+/// %String class. Strings shorter than LOCAL_CAPACITY are stored inline without a heap allocation.
 class URHO3D_API String
 {
 public:
@@ -51,72 +51,56 @@ public:
 
     /// Construct empty.
     String() noexcept :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
     }
 
     /// Construct from another string.
     String(const String& str) :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         *this = str;
     }
 
     /// Move-construct from another string.
     String(String && str) noexcept :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         Swap(str);
     }
 
     /// Construct from a C string.
     String(const char* str) :   // NOLINT(google-explicit-constructor)
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         *this = str;
     }
 
     /// Construct from a C string.
     String(char* str) :         // NOLINT(google-explicit-constructor)
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         *this = (const char*)str;
     }
 
     /// Construct from a char array and length.
     String(const char* str, unsigned length) :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         Resize(length);
-        CopyChars(buffer_, str, length);
+        CopyChars(Buffer(), str, length);
     }
 
     /// Construct from a null-terminated wide character array.
     explicit String(const wchar_t* str) :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         SetUTF8FromWChar(str);
     }
 
     /// Construct from a null-terminated wide character array.
     explicit String(wchar_t* str) :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         SetUTF8FromWChar(str);
     }
@@ -153,9 +137,7 @@ public:
 
     /// Construct from a convertible value.
     template <class T> explicit String(const T& value) :
-        length_(0),
-        capacity_(0),
-        buffer_(&endZero)
+        local_()
     {
         *this = value.ToString();
     }
@@ -163,8 +145,8 @@ public:
     /// Destruct.
     ~String()
     {
-        if (capacity_)
-            delete[] buffer_;
+        if (!IsLocal())
+            delete[] heap_.buffer_;
     }
 
     /// Assign a string.
@@ -172,8 +154,8 @@ public:
     {
         if (&rhs != this)
         {
-            Resize(rhs.length_);
-            CopyChars(buffer_, rhs.buffer_, rhs.length_);
+            Resize(rhs.Length());
+            CopyChars(Buffer(), rhs.Buffer(), rhs.Length());
         }
 
         return *this;
@@ -192,7 +174,7 @@ public:
     {
         unsigned rhsLength = CStringLength(rhs);
         Resize(rhsLength);
-        CopyChars(buffer_, rhs, rhsLength);
+        CopyChars(Buffer(), rhs, rhsLength);
 
         return *this;
     }
@@ -200,9 +182,9 @@ public:
     /// Add-assign a string.
     String& operator +=(const String& rhs)
     {
-        unsigned oldLength = length_;
-        Resize(length_ + rhs.length_);
-        CopyChars(buffer_ + oldLength, rhs.buffer_, rhs.length_);
+        unsigned oldLength = Length();
+        Resize(Length() + rhs.Length());
+        CopyChars(Buffer() + oldLength, rhs.Buffer(), rhs.Length());
 
         return *this;
     }
@@ -211,9 +193,9 @@ public:
     String& operator +=(const char* rhs)
     {
         unsigned rhsLength = CStringLength(rhs);
-        unsigned oldLength = length_;
-        Resize(length_ + rhsLength);
-        CopyChars(buffer_ + oldLength, rhs, rhsLength);
+        unsigned oldLength = Length();
+        Resize(Length() + rhsLength);
+        CopyChars(Buffer() + oldLength, rhs, rhsLength);
 
         return *this;
     }
@@ -221,9 +203,9 @@ public:
     /// Add-assign a character.
     String& operator +=(char rhs)
     {
-        unsigned oldLength = length_;
-        Resize(length_ + 1);
-        buffer_[oldLength] = rhs;
+        unsigned oldLength = Length();
+        Resize(Length() + 1);
+        Buffer()[oldLength] = rhs;
 
         return *this;
     }
@@ -256,9 +238,9 @@ public:
     String operator +(const String& rhs) const
     {
         String ret;
-        ret.Resize(length_ + rhs.length_);
-        CopyChars(ret.buffer_, buffer_, length_);
-        CopyChars(ret.buffer_ + length_, rhs.buffer_, rhs.length_);
+        ret.Resize(Length() + rhs.Length());
+        CopyChars(ret.Buffer(), Buffer(), Length());
+        CopyChars(ret.Buffer() + Length(), rhs.Buffer(), rhs.Length());
 
         return ret;
     }
@@ -268,9 +250,9 @@ public:
     {
         unsigned rhsLength = CStringLength(rhs);
         String ret;
-        ret.Resize(length_ + rhsLength);
-        CopyChars(ret.buffer_, buffer_, length_);
-        CopyChars(ret.buffer_ + length_, rhs, rhsLength);
+        ret.Resize(Length() + rhsLength);
+        CopyChars(ret.Buffer(), Buffer(), Length());
+        CopyChars(ret.Buffer() + Length(), rhs, rhsLength);
 
         return ret;
     }
@@ -302,29 +284,29 @@ public:
     /// Return char at index.
     char& operator [](unsigned index)
     {
-        assert(index < length_);
-        return buffer_[index];
+        assert(index < Length());
+        return Buffer()[index];
     }
 
     /// Return const char at index.
     const char& operator [](unsigned index) const
     {
-        assert(index < length_);
-        return buffer_[index];
+        assert(index < Length());
+        return Buffer()[index];
     }
 
     /// Return char at index.
     char& At(unsigned index)
     {
-        assert(index < length_);
-        return buffer_[index];
+        assert(index < Length());
+        return Buffer()[index];
     }
 
     /// Return const char at index.
     const char& At(unsigned index) const
     {
-        assert(index < length_);
-        return buffer_[index];
+        assert(index < Length());
+        return Buffer()[index];
     }
 
     /// Replace all occurrences of a character.
@@ -377,22 +359,22 @@ public:
     void Swap(String& str);
 
     /// Return iterator to the beginning.
-    Iterator Begin() { return Iterator(buffer_); }
+    Iterator Begin() { return Iterator(Buffer()); }
 
     /// Return const iterator to the beginning.
-    ConstIterator Begin() const { return ConstIterator(buffer_); }
+    ConstIterator Begin() const { return ConstIterator(Buffer()); }
 
     /// Return iterator to the end.
-    Iterator End() { return Iterator(buffer_ + length_); }
+    Iterator End() { return Iterator(Buffer() + Length()); }
 
     /// Return const iterator to the end.
-    ConstIterator End() const { return ConstIterator(buffer_ + length_); }
+    ConstIterator End() const { return ConstIterator(Buffer() + Length()); }
 
     /// Return first char, or 0 if empty.
-    char Front() const { return buffer_[0]; }
+    char Front() const { return Buffer()[0]; }
 
     /// Return last char, or 0 if empty.
-    char Back() const { return length_ ? buffer_[length_ - 1] : buffer_[0]; }
+    char Back() const { return Length() ? Buffer()[Length() - 1] : Buffer()[0]; }
 
     /// Return a substring from position to end.
     String Substring(unsigned pos) const;
@@ -422,16 +404,16 @@ public:
     bool EndsWith(const String& str, bool caseSensitive = true) const;
 
     /// Return the C string.
-    const char* CString() const { return buffer_; }
+    const char* CString() const { return Buffer(); }
 
     /// Return length.
-    unsigned Length() const { return length_; }
+    unsigned Length() const { return IsLocal() ? (unsigned char)local_[LOCAL_CAPACITY] : heap_.length_; }
 
-    /// Return buffer capacity.
-    unsigned Capacity() const { return capacity_; }
+    /// Return buffer capacity, including the null terminator.
+    unsigned Capacity() const { return IsLocal() ? LOCAL_CAPACITY : heap_.capacity_ & ~HEAP_FLAG; }
 
     /// Return whether the string is empty.
-    bool Empty() const { return length_ == 0; }
+    bool Empty() const { return Length() == 0; }
 
     /// Return comparison result with a string.
     int Compare(const String& str, bool caseSensitive = true) const;
@@ -469,7 +451,7 @@ public:
     unsigned ToHash() const
     {
         unsigned hash = 0;
-        const char* ptr = buffer_;
+        const char* ptr = Buffer();
         while (*ptr)
         {
             hash = *ptr + (hash << 6u) + (hash << 16u) - hash;
@@ -509,15 +491,38 @@ public:
     static const unsigned NPOS = 0xffffffff;
     /// Initial dynamic allocation size.
     static const unsigned MIN_CAPACITY = 8;
+    /// Size of the inline buffer, including the null terminator. The inline buffer overlays the heap pointer, length and capacity, so that the string does not grow.
+    static const unsigned LOCAL_CAPACITY = sizeof(void*) + sizeof(unsigned) * 2 - 1;
     /// Empty string.
     static const String EMPTY;
 
 private:
+    /// Capacity bit that marks the heap storage as used. On the little-endian platforms the engine supports it falls into the last inline byte, which holds the inline length otherwise.
+    static const unsigned HEAP_FLAG = 0x80000000;
+
+    /// Return whether the characters are stored inline.
+    bool IsLocal() const { return !((unsigned char)local_[LOCAL_CAPACITY] & 0x80u); }
+
+    /// Set the length without touching the characters.
+    void SetLength(unsigned length)
+    {
+        if (IsLocal())
+            local_[LOCAL_CAPACITY] = (char)length;
+        else
+            heap_.length_ = length;
+    }
+
+    /// Return the character buffer.
+    char* Buffer() { return IsLocal() ? local_ : heap_.buffer_; }
+
+    /// Return the character buffer.
+    const char* Buffer() const { return IsLocal() ? local_ : heap_.buffer_; }
+
     /// Move a range of characters within the string.
     void MoveRange(unsigned dest, unsigned src, unsigned count)
     {
         if (count)
-            memmove(buffer_ + dest, buffer_ + src, count);
+            memmove(Buffer() + dest, Buffer() + src, count);
     }
 
     /// Copy chars from one buffer to another.
@@ -540,17 +545,25 @@ private:
     /// Replace a substring with another substring.
     void Replace(unsigned pos, unsigned length, const char* srcStart, unsigned srcLength);
 
-    /// String length.
-    unsigned length_;
-    /// Capacity, zero if buffer not allocated.
-    unsigned capacity_;
-    /// String buffer, point to &endZero if buffer is not allocated.
-    char* buffer_;
-
-    /// End zero for empty strings.
-    static char endZero;
+    union
+    {
+        /// Heap storage, used when the heap flag is set.
+        struct
+        {
+            /// String buffer.
+            char* buffer_;
+            /// String length.
+            unsigned length_;
+            /// Buffer capacity combined with the heap flag.
+            unsigned capacity_;
+        } heap_;
+        /// Inline buffer for short strings followed by the inline length. All zero bytes are an empty string.
+        char local_[LOCAL_CAPACITY + 1];
+    };
 };
 
+static_assert(sizeof(String) == sizeof(void*) + sizeof(unsigned) * 2, "Unexpected size of String");
+
 /// Add a string to a C string.
 inline String operator +(const char* lhs, const String& rhs)
 {
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../Container/VectorBase.h"
 
 #include "../DebugNew.h"
@@ -31,6 +32,7 @@ namespace Urho3D
 
 unsigned char* VectorBase::AllocateBuffer(unsigned size)
 {
+    TrackAllocation(size);
     return new unsigned char[size];
 }
 
@@ -54,7 +54,9 @@ enum AttributeMode
 };
 URHO3D_FLAGSET(AttributeMode, AttributeModeFlags);
 
+class Deserializer;
 class Serializable;
+class Serializer;
 
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
@@ -64,6 +66,12 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+    /// Read the attribute from binary data and set it without a Variant. Return false without reading if not supported.
+    virtual bool Read(Serializable* ptr, Deserializer& source) { return false; }
+    /// Write the attribute to binary data without a Variant. Return false without writing if not supported.
+    virtual bool Write(const Serializable* ptr, Serializer& dest) const { return false; }
+    /// Set the attribute from float components in the memory order of its type without a Variant. Return false without setting if not supported.
+    virtual bool SetFloats(Serializable* ptr, const float* values) { return false; }
 };
 
 /// Description of an automatically serializable variable.
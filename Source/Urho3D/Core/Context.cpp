@@ -121,15 +121,18 @@ void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attribute
 }
 
 Context::Context() :
-    eventHandler_(nullptr)
+    eventHandler_(nullptr),
+    lazyRegistration_(false),
+    registeringLibrary_(false)
 {
 #ifdef __ANDROID__
     // Always reset the random seed on Android, as the Urho3D library might not be unloaded between runs
     SetRandomSeed(1);
 #endif
 
-    // Set the main thread ID (assuming the Context is created in it)
-    Thread::SetMainThread();
+    // Set the main thread ID (assuming the Context is created in it), unless the context runs in a thread of its own
+    if (!Thread::IsContextThread())
+        Thread::SetMainThread();
 }
 
 Context::~Context()
@@ -153,7 +156,10 @@ Context::~Context()
 
 SharedPtr<Object> Context::CreateObject(StringHash objectType)
 {
-    HashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator i = factories_.Find(objectType);
+    FlatHashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator i = factories_.Find(objectType);
+    while (i == factories_.End() && RegisterNextPendingLibrary())
+        i = factories_.Find(objectType);
+
     if (i != factories_.End())
         return i->second_->CreateObject();
     else
@@ -186,6 +192,43 @@ void Context::RegisterSubsystem(Object* object)
     subsystems_[object->GetType()] = object;
 }
 
+void Context::RegisterLibrary(const String& name, LibraryRegisterFunction function)
+{
+    if (!function || libraries_.Contains(name))
+        return;
+
+    libraries_.Insert(name);
+    if (lazyRegistration_)
+        pendingLibraries_.Push(MakePair(name, function));
+    else
+    {
+        // Libraries registered earlier may be pending and must come first, as later libraries can copy their attributes
+        RegisterPendingLibraries();
+        function(this);
+    }
+}
+
+void Context::RegisterPendingLibraries()
+{
+    while (!pendingLibraries_.Empty())
+    {
+        Pair<String, LibraryRegisterFunction> library = pendingLibraries_.Front();
+        pendingLibraries_.Erase(0);
+
+        URHO3D_LOGDEBUG("Registering library " + library.first_);
+        registeringLibrary_ = true;
+        library.second_(this);
+        registeringLibrary_ = false;
+    }
+}
+
+void Context::SetLazyRegistration(bool enable)
+{
+    lazyRegistration_ = enable;
+    if (!enable)
+        RegisterPendingLibraries();
+}
+
 void Context::RemoveSubsystem(StringHash objectType)
 {
     HashMap<StringHash, SharedPtr<Object> >::Iterator i = subsystems_.Find(objectType);
@@ -382,13 +425,17 @@ Object* Context::GetEventSender() const
 const String& Context::GetTypeName(StringHash objectType) const
 {
     // Search factories to find the hash-to-name mapping
-    HashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator i = factories_.Find(objectType);
+    FlatHashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator i = factories_.Find(objectType);
+    while (i == factories_.End() && RegisterNextPendingLibrary())
+        i = factories_.Find(objectType);
     return i != factories_.End() ? i->second_->GetTypeName() : String::EMPTY;
 }
 
 AttributeInfo* Context::GetAttribute(StringHash objectType, const char* name)
 {
     HashMap<StringHash, Vector<AttributeInfo> >::Iterator i = attributes_.Find(objectType);
+    while (i == attributes_.End() && RegisterNextPendingLibrary())
+        i = attributes_.Find(objectType);
     if (i == attributes_.End())
         return nullptr;
 
@@ -403,6 +450,43 @@ AttributeInfo* Context::GetAttribute(StringHash objectType, const char* name)
     return nullptr;
 }
 
+bool Context::RegisterNextPendingLibrary() const
+{
+    // The registration tables are not locked, so only the main thread may grow them. A registration function may also look
+    // up its base classes, which must not pull in later libraries out of order
+    if (pendingLibraries_.Empty() || registeringLibrary_ || !Thread::IsMainThread())
+        return false;
+
+    auto* self = const_cast<Context*>(this);
+    Pair<String, LibraryRegisterFunction> library = self->pendingLibraries_.Front();
+    self->pendingLibraries_.Erase(0);
+
+    URHO3D_LOGDEBUG("Registering library " + library.first_ + " on demand");
+    self->registeringLibrary_ = true;
+    library.second_(self);
+    self->registeringLibrary_ = false;
+    return true;
+}
+
+void Context::RegisterPendingLibrariesOnDemand() const
+{
+    while (RegisterNextPendingLibrary())
+        continue;
+}
+
+const Vector<AttributeInfo>* Context::FindPendingAttributes(const HashMap<StringHash, Vector<AttributeInfo> >& table,
+    StringHash type) const
+{
+    while (RegisterNextPendingLibrary())
+    {
+        HashMap<StringHash, Vector<AttributeInfo> >::ConstIterator i = table.Find(type);
+        if (i != table.End())
+            return &i->second_;
+    }
+
+    return nullptr;
+}
+
 void Context::AddEventReceiver(Object* receiver, StringHash eventType)
 {
     SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
@@ -421,10 +505,10 @@ void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash even
 
 void Context::RemoveEventSender(Object* sender)
 {
-    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+    FlatHashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
     if (i != specificEventReceivers_.End())
     {
-        for (HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+        for (FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
         {
             for (PODVector<Object*>::Iterator k = j->second_->receivers_.Begin(); k != j->second_->receivers_.End(); ++k)
             {
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
@@ -29,6 +30,9 @@
 namespace Urho3D
 {
 
+/// Library registration function, which registers the object factories and attributes of a library.
+using LibraryRegisterFunction = void (*)(Context* context);
+
 /// Tracking structure for event receivers.
 class URHO3D_API EventReceiverGroup : public RefCounted
 {
@@ -86,6 +90,12 @@ public:
     void RegisterFactory(ObjectFactory* factory, const char* category);
     /// Register a subsystem.
     void RegisterSubsystem(Object* object);
+    /// Register the object factories and attributes of a library by calling its registration function. With lazy registration the call is postponed until a type that is not yet known is requested. Each library name is registered only once.
+    void RegisterLibrary(const String& name, LibraryRegisterFunction function);
+    /// Register all libraries whose registration has been postponed.
+    void RegisterPendingLibraries();
+    /// Set whether libraries are registered lazily. Disabling registers the pending libraries immediately. Default false.
+    void SetLazyRegistration(bool enable);
     /// Remove a subsystem.
     void RemoveSubsystem(StringHash objectType);
     /// Register object attribute.
@@ -146,10 +156,29 @@ public:
     const HashMap<StringHash, SharedPtr<Object> >& GetSubsystems() const { return subsystems_; }
 
     /// Return all object factories.
-    const HashMap<StringHash, SharedPtr<ObjectFactory> >& GetObjectFactories() const { return factories_; }
+    const FlatHashMap<StringHash, SharedPtr<ObjectFactory> >& GetObjectFactories() const
+    {
+        if (!pendingLibraries_.Empty())
+            RegisterPendingLibrariesOnDemand();
+        return factories_;
+    }
 
     /// Return all object categories.
-    const HashMap<String, Vector<StringHash> >& GetObjectCategories() const { return objectCategories_; }
+    const HashMap<String, Vector<StringHash> >& GetObjectCategories() const
+    {
+        if (!pendingLibraries_.Empty())
+            RegisterPendingLibrariesOnDemand();
+        return objectCategories_;
+    }
+
+    /// Return whether libraries are registered lazily.
+    bool GetLazyRegistration() const { return lazyRegistration_; }
+
+    /// Return whether a library has been registered or is pending registration.
+    bool HasLibrary(const String& name) const { return libraries_.Contains(name); }
+
+    /// Return number of libraries whose registration is pending.
+    unsigned GetNumPendingLibraries() const { return pendingLibraries_.Size(); }
 
     /// Return active event sender. Null outside event handling.
     Object* GetEventSender() const;
@@ -170,26 +199,35 @@ public:
     const Vector<AttributeInfo>* GetAttributes(StringHash type) const
     {
         HashMap<StringHash, Vector<AttributeInfo> >::ConstIterator i = attributes_.Find(type);
-        return i != attributes_.End() ? &i->second_ : nullptr;
+        if (i != attributes_.End())
+            return &i->second_;
+        return pendingLibraries_.Empty() ? nullptr : FindPendingAttributes(attributes_, type);
     }
 
     /// Return network replication attribute descriptions for an object type, or null if none defined.
     const Vector<AttributeInfo>* GetNetworkAttributes(StringHash type) const
     {
         HashMap<StringHash, Vector<AttributeInfo> >::ConstIterator i = networkAttributes_.Find(type);
-        return i != networkAttributes_.End() ? &i->second_ : nullptr;
+        if (i != networkAttributes_.End())
+            return &i->second_;
+        return pendingLibraries_.Empty() ? nullptr : FindPendingAttributes(networkAttributes_, type);
     }
 
     /// Return all registered attributes.
-    const HashMap<StringHash, Vector<AttributeInfo> >& GetAllAttributes() const { return attributes_; }
+    const HashMap<StringHash, Vector<AttributeInfo> >& GetAllAttributes() const
+    {
+        if (!pendingLibraries_.Empty())
+            RegisterPendingLibrariesOnDemand();
+        return attributes_;
+    }
 
     /// Return event receivers for a sender and event type, or null if they do not exist.
     EventReceiverGroup* GetEventReceivers(Object* sender, StringHash eventType)
     {
-        HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+        FlatHashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
         if (i != specificEventReceivers_.End())
         {
-            HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
+            FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
             return j != i->second_.End() ? j->second_ : nullptr;
         }
         else
@@ -199,7 +237,7 @@ public:
     /// Return event receivers for an event type, or null if they do not exist.
     EventReceiverGroup* GetEventReceivers(StringHash eventType)
     {
-        HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
+        FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
         return i != eventReceivers_.End() ? i->second_ : nullptr;
     }
 
@@ -221,9 +259,15 @@ private:
 
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
+    /// Register the next pending library in registration order for a lookup that missed. Return false if nothing could be registered.
+    bool RegisterNextPendingLibrary() const;
+    /// Register all pending libraries for a lookup that needs the complete tables.
+    void RegisterPendingLibrariesOnDemand() const;
+    /// Register pending libraries until attributes for a type are found in the given table.
+    const Vector<AttributeInfo>* FindPendingAttributes(const HashMap<StringHash, Vector<AttributeInfo> >& table, StringHash type) const;
 
     /// Object factories.
-    HashMap<StringHash, SharedPtr<ObjectFactory> > factories_;
+    FlatHashMap<StringHash, SharedPtr<ObjectFactory> > factories_;
     /// Subsystems.
     HashMap<StringHash, SharedPtr<Object> > subsystems_;
     /// Attribute descriptions per object type.
@@ -231,9 +275,9 @@ private:
     /// Network replication attribute descriptions per object type.
     HashMap<StringHash, Vector<AttributeInfo> > networkAttributes_;
     /// Event receivers for non-specific events.
-    HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
+    FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
     /// Event receivers for specific senders' events.
-    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
+    FlatHashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
     /// Event sender stack.
     PODVector<Object*> eventSenders_;
     /// Event data stack.
@@ -242,6 +286,14 @@ private:
     EventHandler* eventHandler_;
     /// Object categories.
     HashMap<String, Vector<StringHash> > objectCategories_;
+    /// Libraries whose registration is postponed, in registration order.
+    Vector<Pair<String, LibraryRegisterFunction> > pendingLibraries_;
+    /// Names of registered and pending libraries.
+    HashSet<String> libraries_;
+    /// Lazy library registration flag.
+    bool lazyRegistration_;
+    /// Library registration in progress flag. Lookups made by a registration function do not register further libraries.
+    bool registeringLibrary_;
     /// Variant map for global variables that can persist throughout application execution.
     VariantMap globalVars_;
 };
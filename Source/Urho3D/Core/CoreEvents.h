@@ -58,6 +58,17 @@ URHO3D_EVENT(E_POSTRENDERUPDATE, PostRenderUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Pipelined update begin event. Sent with pipelined frames after the render update, before rendering. Work started here runs in worker threads while the frame is being rendered.
+URHO3D_EVENT(E_BEGINPIPELINEDUPDATE, BeginPipelinedUpdate)
+{
+    URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
+}
+
+/// Pipelined update end event. Sent with pipelined frames after rendering. Work started in E_BEGINPIPELINEDUPDATE must be completed here.
+URHO3D_EVENT(E_ENDPIPELINEDUPDATE, EndPipelinedUpdate)
+{
+}
+
 /// Frame end event.
 URHO3D_EVENT(E_ENDFRAME, EndFrame)
 {
@@ -33,11 +33,20 @@ class URHO3D_API EventProfilerBlock : public ProfilerBlock
 public:
     /// Construct with the specified parent block and event ID.
     EventProfilerBlock(EventProfilerBlock* parent, StringHash eventID) :
-        ProfilerBlock(parent, GetEventNameRegister().GetString(eventID).CString()),
+        ProfilerBlock(parent, GetEventName(eventID).CString()),
         eventID_(eventID)
     {
     }
 
+    /// Return the name of an event for display. Falls back to the hash value if the name is unknown.
+    static String GetEventName(StringHash eventID)
+    {
+        if (GetEventNameRegister().Contains(eventID))
+            return GetEventNameRegister().GetString(eventID);
+        String name = eventID.Reverse();
+        return name.Empty() ? eventID.ToString() : name;
+    }
+
     /// Return child block with the specified event ID.
     EventProfilerBlock* GetChild(StringHash eventID)
     {
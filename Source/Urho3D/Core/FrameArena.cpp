@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/FrameArena.h"
+#include "../Core/PerfCounters.h"
+#include "../Core/WorkQueue.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+FrameArena::FrameArena(Context* context) :
+    Object(context),
+    chunkSize_(DEFAULT_CHUNK_SIZE),
+    frameNumber_(1),
+    lastFrameUsed_(0)
+{
+    // The main thread can allocate before the first frame begins
+    subArenas_.Resize(1);
+
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (perfCounters)
+        usedBytesCounter_ = perfCounters->GetCounter("FrameArenaBytes", PCT_GAUGE);
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(FrameArena, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(FrameArena, HandleEndFrame));
+}
+
+FrameArena::~FrameArena()
+{
+    for (unsigned i = 0; i < subArenas_.Size(); ++i)
+    {
+        PODVector<Chunk>& chunks = subArenas_[i].chunks_;
+        for (unsigned j = 0; j < chunks.Size(); ++j)
+            delete[] chunks[j].data_;
+    }
+}
+
+void* FrameArena::Allocate(unsigned size, unsigned threadIndex, unsigned alignment)
+{
+    assert(threadIndex < subArenas_.Size());
+    SubArena& arena = subArenas_[threadIndex];
+
+    if (arena.current_ < arena.chunks_.Size())
+    {
+        const Chunk& chunk = arena.chunks_[arena.current_];
+        auto address = reinterpret_cast<size_t>(chunk.data_ + arena.offset_);
+        unsigned padding = (unsigned)((alignment - (address & (alignment - 1))) & (alignment - 1));
+        if (arena.offset_ + padding + size <= chunk.size_)
+        {
+            void* ret = chunk.data_ + arena.offset_ + padding;
+            arena.offset_ += padding + size;
+            return ret;
+        }
+    }
+
+    return AllocateSlow(arena, size, alignment);
+}
+
+void FrameArena::Reset()
+{
+    lastFrameUsed_ = GetUsedBytes();
+    if (usedBytesCounter_)
+        usedBytesCounter_->Set(lastFrameUsed_);
+
+    for (unsigned i = 0; i < subArenas_.Size(); ++i)
+    {
+        SubArena& arena = subArenas_[i];
+
+        // If the frame needed several chunks, replace them with one chunk that holds all, so that the next frame does not allocate
+        if (arena.chunks_.Size() > 1)
+        {
+            unsigned totalSize = 0;
+            for (unsigned j = 0; j < arena.chunks_.Size(); ++j)
+            {
+                totalSize += arena.chunks_[j].size_;
+                delete[] arena.chunks_[j].data_;
+            }
+
+            arena.chunks_.Resize(1);
+            arena.chunks_[0].data_ = new unsigned char[totalSize];
+            arena.chunks_[0].size_ = totalSize;
+        }
+
+        arena.current_ = 0;
+        arena.offset_ = 0;
+        arena.previousUsed_ = 0;
+    }
+
+    ++frameNumber_;
+}
+
+void FrameArena::SetChunkSize(unsigned size)
+{
+    chunkSize_ = Max(size, 1024U);
+}
+
+unsigned FrameArena::GetUsedBytes() const
+{
+    unsigned used = 0;
+    for (unsigned i = 0; i < subArenas_.Size(); ++i)
+        used += subArenas_[i].previousUsed_ + subArenas_[i].offset_;
+    return used;
+}
+
+unsigned FrameArena::GetReservedBytes() const
+{
+    unsigned reserved = 0;
+    for (unsigned i = 0; i < subArenas_.Size(); ++i)
+    {
+        const PODVector<Chunk>& chunks = subArenas_[i].chunks_;
+        for (unsigned j = 0; j < chunks.Size(); ++j)
+            reserved += chunks[j].size_;
+    }
+    return reserved;
+}
+
+void* FrameArena::AllocateSlow(SubArena& arena, unsigned size, unsigned alignment)
+{
+    // Move to the next chunk that can hold the allocation, or create a new one after the current chunks
+    if (arena.current_ < arena.chunks_.Size())
+    {
+        arena.previousUsed_ += arena.offset_;
+        ++arena.current_;
+    }
+    arena.offset_ = 0;
+
+    while (arena.current_ < arena.chunks_.Size() && arena.chunks_[arena.current_].size_ < size + alignment)
+        ++arena.current_;
+
+    if (arena.current_ >= arena.chunks_.Size())
+    {
+        Chunk chunk;
+        chunk.size_ = Max(chunkSize_, size + alignment);
+        chunk.data_ = new unsigned char[chunk.size_];
+        arena.current_ = arena.chunks_.Size();
+        arena.chunks_.Push(chunk);
+    }
+
+    const Chunk& chunk = arena.chunks_[arena.current_];
+    auto address = reinterpret_cast<size_t>(chunk.data_);
+    unsigned padding = (unsigned)((alignment - (address & (alignment - 1))) & (alignment - 1));
+    arena.offset_ = padding + size;
+    return chunk.data_ + padding;
+}
+
+void FrameArena::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Worker threads are created after the subsystem, so check their number each frame. No allocations are in progress here
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numSubArenas = queue ? queue->GetNumThreads() + 1 : 1;
+    if (subArenas_.Size() < numSubArenas)
+        subArenas_.Resize(numSubArenas);
+}
+
+void FrameArena::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    Reset();
+}
+
+}
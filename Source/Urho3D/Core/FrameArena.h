@@ -0,0 +1,347 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Object.h"
+
+#include <cstring>
+
+namespace Urho3D
+{
+
+class PerfCounter;
+
+/// Per-frame linear memory arena subsystem. Allocation bumps a pointer in a thread's own sub-arena, and all memory is released at once at the end of the frame.
+/** Intended for transient data that is rebuilt every frame, such as batch instance lists and sort temporaries. Each worker
+    thread of the WorkQueue has its own sub-arena, indexed with the same thread index (0 = main thread) that work functions
+    receive, so threaded allocation needs no locking. When a frame needs more than one chunk of memory, the chunks are
+    merged into one at reset, after which steady state frames do not touch the heap. Memory from the arena must not be used
+    after E_ENDFRAME, and destructors of objects placed in it are not called.
+  */
+class URHO3D_API FrameArena : public Object
+{
+    URHO3D_OBJECT(FrameArena, Object);
+
+public:
+    /// Construct.
+    explicit FrameArena(Context* context);
+    /// Destruct. Free all memory.
+    ~FrameArena() override;
+
+    /// Allocate memory from a thread's sub-arena. Alignment must be a power of two.
+    void* Allocate(unsigned size, unsigned threadIndex = 0, unsigned alignment = 16);
+    /// Allocate an uninitialized array from a thread's sub-arena.
+    template <class T> T* AllocateArray(unsigned count, unsigned threadIndex = 0)
+    {
+        return static_cast<T*>(Allocate(count * (unsigned)sizeof(T), threadIndex, alignof(T) > 16 ? (unsigned)alignof(T) : 16));
+    }
+    /// Release all allocations and begin a new arena frame. Called automatically at the end of the frame.
+    void Reset();
+    /// Set the size of newly allocated chunks.
+    void SetChunkSize(unsigned size);
+
+    /// Return the arena frame number, which changes on each reset.
+    unsigned GetFrameNumber() const { return frameNumber_; }
+    /// Return chunk size.
+    unsigned GetChunkSize() const { return chunkSize_; }
+    /// Return number of sub-arenas.
+    unsigned GetNumSubArenas() const { return subArenas_.Size(); }
+    /// Return bytes allocated during the current frame, including alignment padding.
+    unsigned GetUsedBytes() const;
+    /// Return bytes used in the previous frame.
+    unsigned GetLastFrameUsedBytes() const { return lastFrameUsed_; }
+    /// Return bytes reserved from the heap.
+    unsigned GetReservedBytes() const;
+
+private:
+    /// Memory chunk.
+    struct Chunk
+    {
+        /// Memory.
+        unsigned char* data_;
+        /// Size in bytes.
+        unsigned size_;
+    };
+
+    /// Allocation state of one thread.
+    struct SubArena
+    {
+        /// Chunks in allocation order.
+        PODVector<Chunk> chunks_;
+        /// Index of the chunk being allocated from.
+        unsigned current_{};
+        /// Allocation offset in the current chunk.
+        unsigned offset_{};
+        /// Bytes used in the chunks before the current one.
+        unsigned previousUsed_{};
+        /// Padding to keep the sub-arenas of different threads on separate cache lines.
+        unsigned char padding_[64]{};
+    };
+
+    /// Allocate from a new chunk when the current one is full.
+    void* AllocateSlow(SubArena& arena, unsigned size, unsigned alignment);
+    /// Create a sub-arena for each thread of the work queue.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Reset the arena.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Sub-arenas indexed by thread.
+    Vector<SubArena> subArenas_;
+    /// Size of newly allocated chunks.
+    unsigned chunkSize_;
+    /// Arena frame number.
+    unsigned frameNumber_;
+    /// Bytes used in the previous frame.
+    unsigned lastFrameUsed_;
+    /// Used bytes gauge, published at reset.
+    SharedPtr<PerfCounter> usedBytesCounter_;
+};
+
+/// %Vector template class for POD types that allocates from the frame arena of one thread. Without an arena it uses the heap.
+/** Growing abandons the old buffer in the arena instead of freeing it, so reserve the expected size where it is known. The
+    contents are lost when the arena is reset; using the vector in a later frame starts it empty.
+  */
+template <class T> class FrameVector
+{
+public:
+    using ValueType = T;
+    using Iterator = RandomAccessIterator<T>;
+    using ConstIterator = RandomAccessConstIterator<T>;
+
+    /// Construct empty.
+    FrameVector() noexcept = default;
+
+    /// Construct empty with an arena.
+    explicit FrameVector(FrameArena* arena, unsigned threadIndex = 0) noexcept
+    {
+        SetArena(arena, threadIndex);
+    }
+
+    /// Construct with an arena and initial size.
+    FrameVector(FrameArena* arena, unsigned threadIndex, unsigned size)
+    {
+        SetArena(arena, threadIndex);
+        Resize(size);
+    }
+
+    /// Copy-construct from another vector. The copy uses the same arena.
+    FrameVector(const FrameVector<T>& vector)
+    {
+        SetArena(vector.arena_, vector.threadIndex_);
+        *this = vector;
+    }
+
+    /// Move-construct from another vector.
+    FrameVector(FrameVector<T>&& vector) noexcept
+    {
+        Swap(vector);
+    }
+
+    /// Destruct.
+    ~FrameVector()
+    {
+        if (!arena_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+    }
+
+    /// Assign from another vector.
+    FrameVector<T>& operator =(const FrameVector<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Resize(rhs.Size());
+            if (size_)
+                memcpy(buffer_, rhs.buffer_, size_ * sizeof(T));
+        }
+        return *this;
+    }
+
+    /// Move-assign from another vector.
+    FrameVector<T>& operator =(FrameVector<T>&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Set the arena and thread index to allocate from. Clears the vector.
+    void SetArena(FrameArena* arena, unsigned threadIndex = 0)
+    {
+        Release();
+        arena_ = arena;
+        threadIndex_ = threadIndex;
+        frameNumber_ = arena ? arena->GetFrameNumber() : 0;
+    }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        if (size_ < Capacity())
+            buffer_[size_++] = value;
+        else
+        {
+            // The value may point into the buffer, so copy it before growing
+            T valueCopy = value;
+            CheckFrame();
+            Resize(size_ + 1);
+            buffer_[size_ - 1] = valueCopy;
+        }
+    }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+            --size_;
+    }
+
+    /// Resize the vector. New elements are uninitialized.
+    void Resize(unsigned newSize)
+    {
+        CheckFrame();
+        if (newSize > Capacity())
+        {
+            unsigned newCapacity = capacity_ ? capacity_ : 1;
+            while (newCapacity < newSize)
+                newCapacity += (newCapacity + 1) >> 1u;
+            Reserve(newCapacity);
+        }
+        size_ = newSize;
+    }
+
+    /// Set new capacity.
+    void Reserve(unsigned newCapacity)
+    {
+        CheckFrame();
+        if (newCapacity <= capacity_)
+            return;
+
+        T* newBuffer = arena_ ? arena_->AllocateArray<T>(newCapacity, threadIndex_) :
+            reinterpret_cast<T*>(new unsigned char[newCapacity * sizeof(T)]);
+        if (size_)
+            memcpy(newBuffer, buffer_, size_ * sizeof(T));
+        if (!arena_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+        buffer_ = newBuffer;
+        capacity_ = newCapacity;
+    }
+
+    /// Clear the vector, keeping the buffer if it is still valid.
+    void Clear()
+    {
+        CheckFrame();
+        size_ = 0;
+    }
+
+    /// Swap with another vector.
+    void Swap(FrameVector<T>& rhs)
+    {
+        Urho3D::Swap(buffer_, rhs.buffer_);
+        Urho3D::Swap(size_, rhs.size_);
+        Urho3D::Swap(capacity_, rhs.capacity_);
+        Urho3D::Swap(arena_, rhs.arena_);
+        Urho3D::Swap(threadIndex_, rhs.threadIndex_);
+        Urho3D::Swap(frameNumber_, rhs.frameNumber_);
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(buffer_); }
+    /// Return const iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(buffer_); }
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(buffer_ + size_); }
+    /// Return const iterator to the end.
+    ConstIterator End() const { return ConstIterator(buffer_ + size_); }
+    /// Return first element.
+    T& Front() { return buffer_[0]; }
+    /// Return const first element.
+    const T& Front() const { return buffer_[0]; }
+    /// Return last element.
+    T& Back() { return buffer_[size_ - 1]; }
+    /// Return const last element.
+    const T& Back() const { return buffer_[size_ - 1]; }
+    /// Return size of vector.
+    unsigned Size() const { return size_; }
+    /// Return capacity of vector.
+    unsigned Capacity() const { return arena_ && frameNumber_ != arena_->GetFrameNumber() ? 0 : capacity_; }
+    /// Return whether vector is empty.
+    bool Empty() const { return size_ == 0; }
+    /// Return the buffer.
+    T* Buffer() { return buffer_; }
+    /// Return the const buffer.
+    const T* Buffer() const { return buffer_; }
+    /// Return the arena.
+    FrameArena* GetArena() const { return arena_; }
+
+private:
+    /// Drop the buffer if it belongs to an earlier arena frame.
+    void CheckFrame()
+    {
+        if (arena_ && frameNumber_ != arena_->GetFrameNumber())
+        {
+            buffer_ = nullptr;
+            size_ = 0;
+            capacity_ = 0;
+            frameNumber_ = arena_->GetFrameNumber();
+        }
+    }
+
+    /// Free a heap buffer and reset to empty.
+    void Release()
+    {
+        if (!arena_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+        buffer_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    /// Buffer.
+    T* buffer_{};
+    /// Number of elements.
+    unsigned size_{};
+    /// Number of elements the buffer can hold.
+    unsigned capacity_{};
+    /// Arena, or null to use the heap.
+    FrameArena* arena_{};
+    /// Sub-arena thread index.
+    unsigned threadIndex_{};
+    /// Arena frame number when the buffer was allocated.
+    unsigned frameNumber_{};
+};
+
+}
@@ -305,24 +305,35 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     if (blockEvents_)
         return;
 
+    Context* context = context_;
+
+    // Return early if neither the specific nor the non-specific receiver group has receivers
+    // Note: groups are held alive with shared ptrs, as they may get destroyed along with the sender
+    SharedPtr<EventReceiverGroup> specificGroup(context->GetEventReceivers(this, eventType));
+    if (specificGroup && specificGroup->receivers_.Empty())
+        specificGroup.Reset();
+    if (!specificGroup)
+    {
+        EventReceiverGroup* group = context->GetEventReceivers(eventType);
+        if (!group || group->receivers_.Empty())
+            return;
+    }
+
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
-    Context* context = context_;
     HashSet<Object*> processed;
 
     context->BeginSendEvent(this, eventType);
 
     // Check first the specific event receivers
-    // Note: group is held alive with a shared ptr, as it may get destroyed along with the sender
-    SharedPtr<EventReceiverGroup> group(context->GetEventReceivers(this, eventType));
-    if (group)
+    if (specificGroup)
     {
-        group->BeginSendEvent();
+        specificGroup->BeginSendEvent();
 
-        const unsigned numReceivers = group->receivers_.Size();
+        const unsigned numReceivers = specificGroup->receivers_.Size();
         for (unsigned i = 0; i < numReceivers; ++i)
         {
-            Object* receiver = group->receivers_[i];
+            Object* receiver = specificGroup->receivers_[i];
             // Holes may exist if receivers removed during send
             if (!receiver)
                 continue;
@@ -332,7 +343,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
             {
-                group->EndSendEvent();
+                specificGroup->EndSendEvent();
                 context->EndSendEvent();
                 return;
             }
@@ -340,11 +351,11 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             processed.Insert(receiver);
         }
 
-        group->EndSendEvent();
+        specificGroup->EndSendEvent();
     }
 
-    // Then the non-specific receivers
-    group = context->GetEventReceivers(eventType);
+    // Then the non-specific receivers. Look them up only now, as the specific receivers may have created or added to the group
+    SharedPtr<EventReceiverGroup> group(context->GetEventReceivers(eventType));
     if (group)
     {
         group->BeginSendEvent();
@@ -395,6 +406,15 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     context->EndSendEvent();
 }
 
+bool Object::HasEventReceivers(StringHash eventType) const
+{
+    EventReceiverGroup* group = context_->GetEventReceivers(const_cast<Object*>(this), eventType);
+    if (group && !group->receivers_.Empty())
+        return true;
+    group = context_->GetEventReceivers(eventType);
+    return group && !group->receivers_.Empty();
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
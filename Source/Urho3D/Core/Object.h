@@ -161,6 +161,8 @@ public:
 
     /// Return whether has subscribed to any event.
     bool HasEventHandlers() const { return !eventHandlers_.Empty(); }
+    /// Return whether an event sent from this object would reach any receivers. Can be used to skip filling the event data.
+    bool HasEventReceivers(StringHash eventType) const;
 
     /// Template version of returning a subsystem.
     template <class T> T* GetSubsystem() const;
@@ -355,11 +357,12 @@ private:
     std::function<void(StringHash, VariantMap&)> function_;
 };
 
-/// Get register of event names.
+/// Get register of event names. Contains the event names registered from script. Event IDs declared in C++ are constants
+/// and are only reversible through StringHash::Reverse() if URHO3D_HASH_DEBUG is on.
 URHO3D_API StringHashRegister& GetEventNameRegister();
 
 /// Describe an event's hash ID and begin a namespace in which to define its parameters.
-#define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::GetEventNameRegister().RegisterString(#eventName)); namespace eventName
+#define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(#eventName); namespace eventName
 /// Describe an event's parameter hash ID. Should be used inside an event namespace.
 #define URHO3D_PARAM(paramID, paramName) static const Urho3D::StringHash paramID(#paramName)
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/ObjectPool.h"
+
+// DebugNew.h is not included, as it would redefine the operator new calls
+
+namespace Urho3D
+{
+
+ObjectPool::ObjectPool(unsigned blockSize, unsigned initialCapacity) :
+    allocator_(nullptr),
+    blockSize_(blockSize),
+    initialCapacity_(initialCapacity),
+    numUsed_(0)
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+    // If objects are still alive, for example ones held in static pointers destroyed after this, leave the blocks allocated
+    if (!numUsed_)
+        AllocatorUninitialize(allocator_);
+}
+
+void* ObjectPool::Allocate(size_t size)
+{
+    if (size != blockSize_)
+        return ::operator new(size);
+
+    MutexLock lock(mutex_);
+
+    if (!allocator_)
+        allocator_ = AllocatorInitialize(blockSize_, initialCapacity_);
+    ++numUsed_;
+    return AllocatorReserve(allocator_);
+}
+
+void ObjectPool::Free(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size != blockSize_)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    MutexLock lock(mutex_);
+
+    AllocatorFree(allocator_, ptr);
+    --numUsed_;
+}
+
+void ObjectPool::Free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    {
+        MutexLock lock(mutex_);
+
+        // The first block's capacity is the total of the chain, so subtract the others to get its own
+        unsigned firstCapacity = GetCapacity();
+        for (AllocatorBlock* block = allocator_ ? allocator_->next_ : nullptr; block; block = block->next_)
+            firstCapacity -= block->capacity_;
+
+        auto* bytePtr = static_cast<unsigned char*>(ptr);
+        for (AllocatorBlock* block = allocator_; block; block = block->next_)
+        {
+            unsigned capacity = block == allocator_ ? firstCapacity : block->capacity_;
+            unsigned char* begin = reinterpret_cast<unsigned char*>(block) + sizeof(AllocatorBlock);
+            if (bytePtr > begin && bytePtr < begin + capacity * (sizeof(AllocatorNode) + blockSize_))
+            {
+                AllocatorFree(allocator_, ptr);
+                --numUsed_;
+                return;
+            }
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
+unsigned ObjectPool::GetCapacity() const
+{
+    // The first block stores the total capacity of the chain
+    return allocator_ ? allocator_->capacity_ : 0;
+}
+
+}
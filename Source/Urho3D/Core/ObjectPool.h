@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Core/Mutex.h"
+
+namespace Urho3D
+{
+
+/// Thread-safe pool of fixed-size memory blocks for the allocations of one class. Allocations of a different size, such as subclasses, go to the heap. Freed blocks are kept for reuse, and returned to the heap only when the pool is destroyed with no blocks in use.
+class URHO3D_API ObjectPool
+{
+public:
+    /// Construct with the block size and the number of blocks to reserve on first allocation.
+    explicit ObjectPool(unsigned blockSize, unsigned initialCapacity = 64);
+    /// Destruct.
+    ~ObjectPool();
+
+    /// Prevent copy construction.
+    ObjectPool(const ObjectPool& rhs) = delete;
+    /// Prevent assignment.
+    ObjectPool& operator =(const ObjectPool& rhs) = delete;
+
+    /// Allocate memory. Use a pooled block if the size matches.
+    void* Allocate(size_t size);
+    /// Free memory allocated with the same size.
+    void Free(void* ptr, size_t size);
+    /// Free memory when the allocation size is not known. Slower, as the block allocator is searched for the pointer.
+    void Free(void* ptr);
+
+    /// Return block size.
+    unsigned GetBlockSize() const { return blockSize_; }
+    /// Return number of blocks in use.
+    unsigned GetNumUsed() const { return numUsed_; }
+    /// Return number of blocks reserved, including the ones in use.
+    unsigned GetCapacity() const;
+
+private:
+    /// Block allocator.
+    AllocatorBlock* allocator_;
+    /// Mutex for the allocator.
+    Mutex mutex_;
+    /// Block size.
+    unsigned blockSize_;
+    /// Number of blocks to reserve on first allocation.
+    unsigned initialCapacity_;
+    /// Number of blocks in use.
+    unsigned numUsed_;
+};
+
+}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+// DebugNew.h redefines new with file and line arguments, which the class-specific operators hide unless they are overloaded too
+#define URHO3D_POOLED_OBJECT_DEBUG_NEW \
+    static void* operator new(std::size_t size, int, const char*, int) { return GetObjectPool().Allocate(size); } \
+    static void operator delete(void* ptr, int, const char*, int) { GetObjectPool().Free(ptr); }
+#else
+#define URHO3D_POOLED_OBJECT_DEBUG_NEW
+#endif
+
+/// Allocate objects of a class from an ObjectPool. Subclasses inherit the operators, but their allocations go to the heap as their size is different. Place after URHO3D_OBJECT in the class definition.
+#define URHO3D_POOLED_OBJECT(typeName) \
+    public: \
+        static void* operator new(std::size_t size) { return GetObjectPool().Allocate(size); } \
+        static void operator delete(void* ptr, std::size_t size) { GetObjectPool().Free(ptr, size); } \
+        URHO3D_POOLED_OBJECT_DEBUG_NEW \
+        static Urho3D::ObjectPool& GetObjectPool() { static Urho3D::ObjectPool pool(sizeof(typeName)); return pool; } \
+
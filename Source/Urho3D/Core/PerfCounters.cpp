@@ -0,0 +1,284 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/PerfCounters.h"
+#include "../Engine/EngineEvents.h"
+#include "../IO/Log.h"
+
+#include <cstdio>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned DEFAULT_HISTORY_SIZE = 120;
+
+/// Return the index of the first counter whose name is not less than the given name.
+static unsigned LowerBound(const Vector<SharedPtr<PerfCounter> >& counters, const String& name)
+{
+    unsigned low = 0;
+    unsigned high = counters.Size();
+    while (low < high)
+    {
+        unsigned mid = (low + high) >> 1u;
+        if (counters[mid]->GetName() < name)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+PerfCounter::PerfCounter(const String& name, PerfCounterType type, unsigned historySize) :
+    name_(name),
+    type_(type),
+    value_(0.0),
+    first_(0),
+    numSamples_(0)
+{
+    SetHistorySize(historySize);
+}
+
+void PerfCounter::Sample()
+{
+    double value = type_ == PCT_COUNTER ? value_.exchange(0.0, std::memory_order_relaxed) : value_.load(std::memory_order_relaxed);
+
+    if (history_.Empty())
+        return;
+
+    if (numSamples_ < history_.Size())
+        history_[(first_ + numSamples_++) % history_.Size()] = (float)value;
+    else
+    {
+        history_[first_] = (float)value;
+        first_ = (first_ + 1) % history_.Size();
+    }
+}
+
+void PerfCounter::SetHistorySize(unsigned size)
+{
+    history_.Resize(Max(size, 1U));
+    ClearHistory();
+}
+
+void PerfCounter::ClearHistory()
+{
+    first_ = 0;
+    numSamples_ = 0;
+}
+
+float PerfCounter::GetMin() const
+{
+    if (!numSamples_)
+        return 0.0f;
+
+    float ret = M_INFINITY;
+    for (unsigned i = 0; i < numSamples_; ++i)
+        ret = Min(ret, GetSample(i));
+    return ret;
+}
+
+float PerfCounter::GetMax() const
+{
+    if (!numSamples_)
+        return 0.0f;
+
+    float ret = -M_INFINITY;
+    for (unsigned i = 0; i < numSamples_; ++i)
+        ret = Max(ret, GetSample(i));
+    return ret;
+}
+
+float PerfCounter::GetAverage() const
+{
+    if (!numSamples_)
+        return 0.0f;
+
+    double sum = 0.0;
+    for (unsigned i = 0; i < numSamples_; ++i)
+        sum += GetSample(i);
+    return (float)(sum / numSamples_);
+}
+
+float PerfCounter::GetPercentile(float percentile) const
+{
+    if (!numSamples_)
+        return 0.0f;
+
+    PODVector<float> sorted(numSamples_);
+    for (unsigned i = 0; i < numSamples_; ++i)
+        sorted[i] = GetSample(i);
+    Sort(sorted.Begin(), sorted.End());
+
+    // Nearest rank
+    auto rank = (unsigned)Ceil(Clamp(percentile, 0.0f, 100.0f) * 0.01f * numSamples_);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+float PerfCounter::GetSample(unsigned index) const
+{
+    return index < numSamples_ ? history_[(first_ + index) % history_.Size()] : 0.0f;
+}
+
+PerfCounters::PerfCounters(Context* context) :
+    Object(context),
+    historySize_(DEFAULT_HISTORY_SIZE),
+    frameBegun_(false),
+    executeConsoleCommands_(false)
+{
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(PerfCounters, HandleBeginFrame));
+}
+
+PerfCounters::~PerfCounters() = default;
+
+PerfCounter* PerfCounters::GetCounter(const String& name, PerfCounterType type)
+{
+    MutexLock lock(countersMutex_);
+
+    unsigned index = LowerBound(counters_, name);
+    if (index < counters_.Size() && counters_[index]->GetName() == name)
+        return counters_[index];
+
+    SharedPtr<PerfCounter> counter(new PerfCounter(name, type, historySize_));
+    counters_.Insert(index, counter);
+    return counter;
+}
+
+void PerfCounters::Add(const String& name, double value)
+{
+    GetCounter(name, PCT_COUNTER)->Add(value);
+}
+
+void PerfCounters::Set(const String& name, double value)
+{
+    GetCounter(name, PCT_GAUGE)->Set(value);
+}
+
+void PerfCounters::Sample()
+{
+    MutexLock lock(countersMutex_);
+
+    for (unsigned i = 0; i < counters_.Size(); ++i)
+        counters_[i]->Sample();
+}
+
+void PerfCounters::ClearHistory()
+{
+    MutexLock lock(countersMutex_);
+
+    for (unsigned i = 0; i < counters_.Size(); ++i)
+        counters_[i]->ClearHistory();
+}
+
+void PerfCounters::SetHistorySize(unsigned size)
+{
+    MutexLock lock(countersMutex_);
+
+    historySize_ = Max(size, 1U);
+    for (unsigned i = 0; i < counters_.Size(); ++i)
+        counters_[i]->SetHistorySize(historySize_);
+}
+
+void PerfCounters::SetExecuteConsoleCommands(bool enable)
+{
+    if (enable == executeConsoleCommands_)
+        return;
+
+    executeConsoleCommands_ = enable;
+    if (enable)
+        SubscribeToEvent(E_CONSOLECOMMAND, URHO3D_HANDLER(PerfCounters, HandleConsoleCommand));
+    else
+        UnsubscribeFromEvent(E_CONSOLECOMMAND);
+}
+
+PerfCounter* PerfCounters::FindCounter(const String& name) const
+{
+    MutexLock lock(countersMutex_);
+
+    unsigned index = LowerBound(counters_, name);
+    return index < counters_.Size() && counters_[index]->GetName() == name ? counters_[index].Get() : nullptr;
+}
+
+String PerfCounters::PrintData(const String& filter) const
+{
+    MutexLock lock(countersMutex_);
+
+    String output;
+    char line[256];
+    bool first = true;
+
+    for (unsigned i = 0; i < counters_.Size(); ++i)
+    {
+        const PerfCounter* counter = counters_[i];
+        if (!filter.Empty() && !counter->GetName().Contains(filter, false))
+            continue;
+
+        if (first)
+        {
+            sprintf(line, "%-28s %10s %10s %10s %10s %10s\n", "Counter", "Last", "Min", "Avg", "Max", "P95");
+            output.Append(line);
+            first = false;
+        }
+
+        sprintf(line, "%-28s %10.2f %10.2f %10.2f %10.2f %10.2f\n", counter->GetName().Substring(0, 28).CString(),
+            counter->GetLast(), counter->GetMin(), counter->GetAverage(), counter->GetMax(), counter->GetPercentile(95.0f));
+        output.Append(line);
+    }
+
+    return output;
+}
+
+void PerfCounters::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // The previous frame is complete now
+    if (frameBegun_)
+        Sample();
+    frameBegun_ = true;
+}
+
+void PerfCounters::HandleConsoleCommand(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ConsoleCommand;
+
+    if (eventData[P_ID].GetString() != GetTypeName())
+        return;
+
+    String command = eventData[P_COMMAND].GetString().Trimmed();
+    if (command == "clear")
+    {
+        ClearHistory();
+        return;
+    }
+
+    String output = PrintData(command);
+    if (output.Empty())
+        URHO3D_LOGRAW("No performance counters match \"" + command + "\"\n");
+    else
+        URHO3D_LOGRAW(output);
+}
+
+}
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Performance counter type.
+enum PerfCounterType
+{
+    /// Value is accumulated during the frame and starts from zero on the next frame.
+    PCT_COUNTER = 0,
+    /// Value is set to the current level and kept until set again.
+    PCT_GAUGE
+};
+
+/// Named performance counter or gauge with a rolling history of per-frame samples.
+/** Publishers should get the counter once and keep the pointer, as adding to or setting the value is a lock-free atomic
+    operation that can be done from any thread. The history is sampled and the statistics are read in the main thread.
+  */
+class URHO3D_API PerfCounter : public RefCounted
+{
+public:
+    /// Construct.
+    PerfCounter(const String& name, PerfCounterType type, unsigned historySize);
+
+    /// Add to the value of the current frame.
+    void Add(double value = 1.0)
+    {
+        double old = value_.load(std::memory_order_relaxed);
+        while (!value_.compare_exchange_weak(old, old + value, std::memory_order_relaxed))
+        {
+        }
+    }
+    /// Set the value of the current frame.
+    void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+    /// Store the current value to the history and begin a new frame. Counters restart from zero. Called by PerfCounters.
+    void Sample();
+    /// Set number of frames in the history. Clears the history.
+    void SetHistorySize(unsigned size);
+    /// Clear the history.
+    void ClearHistory();
+
+    /// Return name.
+    const String& GetName() const { return name_; }
+    /// Return type.
+    PerfCounterType GetType() const { return type_; }
+    /// Return the value accumulated or set during the current frame.
+    double GetValue() const { return value_.load(std::memory_order_relaxed); }
+    /// Return the most recent sampled value.
+    float GetLast() const { return numSamples_ ? GetSample(numSamples_ - 1) : 0.0f; }
+    /// Return minimum of the history.
+    float GetMin() const;
+    /// Return maximum of the history.
+    float GetMax() const;
+    /// Return average of the history.
+    float GetAverage() const;
+    /// Return a percentile (0-100) of the history.
+    float GetPercentile(float percentile) const;
+    /// Return number of frames in the history.
+    unsigned GetHistorySize() const { return history_.Size(); }
+    /// Return number of sampled frames, up to the history size.
+    unsigned GetNumSamples() const { return numSamples_; }
+    /// Return a sampled value. Index 0 is the oldest.
+    float GetSample(unsigned index) const;
+
+private:
+    /// Name.
+    String name_;
+    /// Type.
+    PerfCounterType type_;
+    /// Value of the current frame.
+    std::atomic<double> value_;
+    /// Ring buffer of sampled values.
+    PODVector<float> history_;
+    /// Index of the oldest sample in the ring buffer.
+    unsigned first_;
+    /// Number of sampled frames.
+    unsigned numSamples_;
+};
+
+/// Registry of performance counters and gauges that subsystems and the application publish to.
+/** All counters are sampled once per frame when the next frame begins, so that values published during E_ENDFRAME still
+    belong to their own frame. The statistics are shown by the DebugHud and can be queried from the Console.
+  */
+class URHO3D_API PerfCounters : public Object
+{
+    URHO3D_OBJECT(PerfCounters, Object);
+
+public:
+    /// Construct.
+    explicit PerfCounters(Context* context);
+    /// Destruct.
+    ~PerfCounters() override;
+
+    /// Return a counter by name, creating it if it does not exist. The type of an existing counter is not changed. Thread-safe.
+    PerfCounter* GetCounter(const String& name, PerfCounterType type = PCT_COUNTER);
+    /// Add to a counter by name, creating it if it does not exist. Slower than keeping the counter pointer.
+    void Add(const String& name, double value = 1.0);
+    /// Set a gauge by name, creating it if it does not exist. Slower than keeping the counter pointer.
+    void Set(const String& name, double value);
+    /// Sample all counters and begin a new frame. Called automatically on frame begin.
+    void Sample();
+    /// Clear the history of all counters.
+    void ClearHistory();
+    /// Set number of frames in the history of each counter. Clears the history.
+    void SetHistorySize(unsigned size);
+    /// Set whether to handle "PerfCounters" console commands. The command text filters counters by name, or "clear" clears the history.
+    void SetExecuteConsoleCommands(bool enable);
+
+    /// Return a counter by name, or null if not found. Thread-safe.
+    PerfCounter* FindCounter(const String& name) const;
+    /// Return number of counters.
+    unsigned GetNumCounters() const { return counters_.Size(); }
+    /// Return counter by index. Counters are sorted by name.
+    PerfCounter* GetCounter(unsigned index) const { return index < counters_.Size() ? counters_[index].Get() : nullptr; }
+    /// Return number of frames in the history of each counter.
+    unsigned GetHistorySize() const { return historySize_; }
+    /// Return whether console commands are handled.
+    bool GetExecuteConsoleCommands() const { return executeConsoleCommands_; }
+    /// Return the statistics of counters whose name contains the filter string as text.
+    String PrintData(const String& filter = String::EMPTY) const;
+
+private:
+    /// Handle frame begin event.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle a console command event.
+    void HandleConsoleCommand(StringHash eventType, VariantMap& eventData);
+
+    /// Counters sorted by name.
+    Vector<SharedPtr<PerfCounter> > counters_;
+    /// Mutex for creating counters.
+    mutable Mutex countersMutex_;
+    /// Number of frames in the history.
+    unsigned historySize_;
+    /// Frame begun flag. The first frame begin has no previous frame to sample.
+    bool frameBegun_;
+    /// Console commands flag.
+    bool executeConsoleCommands_;
+};
+
+}
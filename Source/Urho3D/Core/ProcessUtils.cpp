@@ -495,6 +495,101 @@ unsigned GetNumLogicalCPUs()
 #endif
 }
 
+/// Detect the performance and efficiency cores once. On a homogeneous CPU all cores count as performance cores.
+static void GetCoreMasks(unsigned long long& performanceMask, unsigned long long& efficiencyMask)
+{
+    static unsigned long long performance = 0;
+    static unsigned long long efficiency = 0;
+    static bool detected = false;
+
+    if (!detected)
+    {
+        unsigned numCPUs = Min(GetNumLogicalCPUs(), 64U);
+        unsigned long long allMask = numCPUs >= 64 ? ~0ULL : (1ULL << numCPUs) - 1;
+
+#if defined(__linux__)
+        // Efficiency cores report a clearly lower maximum frequency. Allow for small differences between the preferred
+        // cores of a homogeneous CPU
+        unsigned maxFreqs[64];
+        unsigned highest = 0;
+        for (unsigned i = 0; i < numCPUs; ++i)
+        {
+            maxFreqs[i] = 0;
+            char path[96];
+            sprintf(path, "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", i);
+            FILE* fp = fopen(path, "r");
+            if (fp)
+            {
+                if (fscanf(fp, "%u", &maxFreqs[i]) != 1)                // NOLINT(cert-err34-c)
+                    maxFreqs[i] = 0;
+                fclose(fp);
+            }
+            highest = Max(highest, maxFreqs[i]);
+        }
+        for (unsigned i = 0; i < numCPUs; ++i)
+        {
+            if (maxFreqs[i] && maxFreqs[i] < highest / 5 * 4)
+                efficiency |= 1ULL << i;
+        }
+#elif defined(_MSC_VER)
+        // Higher efficiency class means a more performant core
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+        if (GetLastError() == ERROR_INSUFFICIENT_BUFFER && length)
+        {
+            PODVector<unsigned char> buffer(length);
+            auto* first = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.Buffer());
+            if (GetLogicalProcessorInformationEx(RelationProcessorCore, first, &length))
+            {
+                unsigned char highestClass = 0;
+                for (DWORD offset = 0; offset < length;)
+                {
+                    auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.Buffer() + offset);
+                    highestClass = Max(highestClass, info->Processor.EfficiencyClass);
+                    offset += info->Size;
+                }
+                for (DWORD offset = 0; offset < length;)
+                {
+                    auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.Buffer() + offset);
+                    if (info->Processor.EfficiencyClass < highestClass && info->Processor.GroupMask[0].Group == 0)
+                        efficiency |= (unsigned long long)info->Processor.GroupMask[0].Mask;
+                    offset += info->Size;
+                }
+            }
+        }
+#endif
+        // Apple platforms do not support affinity, so their core types are left undetected. Thread priorities still
+        // map to the quality of service classes, which decide the core type there
+
+        efficiency &= allMask;
+        performance = allMask & ~efficiency;
+        // Ignore a detection which found no performance cores
+        if (!performance)
+        {
+            performance = allMask;
+            efficiency = 0;
+        }
+        detected = true;
+    }
+
+    performanceMask = performance;
+    efficiencyMask = efficiency;
+}
+
+unsigned long long GetPerformanceCoreMask()
+{
+    unsigned long long performance, efficiency;
+    GetCoreMasks(performance, efficiency);
+    return performance;
+}
+
+unsigned long long GetEfficiencyCoreMask()
+{
+    unsigned long long performance, efficiency;
+    GetCoreMasks(performance, efficiency);
+    return efficiency;
+}
+
 void SetMiniDumpDir(const String& pathName)
 {
     miniDumpDir = AddTrailingSlash(pathName);
@@ -67,6 +67,10 @@ URHO3D_API String GetPlatform();
 URHO3D_API unsigned GetNumPhysicalCPUs();
 /// Return the number of logical CPUs (different from physical if hyperthreading is used.)
 URHO3D_API unsigned GetNumLogicalCPUs();
+/// Return a bitmask of the logical CPUs which are performance cores of a heterogeneous (big.LITTLE or hybrid) CPU. Returns all logical CPUs if the CPU is homogeneous or the core types can not be detected. Only the first 64 logical CPUs are represented.
+URHO3D_API unsigned long long GetPerformanceCoreMask();
+/// Return a bitmask of the logical CPUs which are efficiency cores of a heterogeneous CPU. Returns zero if the CPU is homogeneous or the core types can not be detected.
+URHO3D_API unsigned long long GetEfficiencyCoreMask();
 /// Set minidump write location as an absolute path. If empty, uses default (UserProfile/AppData/Roaming/urho3D/crashdumps) Minidumps are only supported on MSVC compiler.
 URHO3D_API void SetMiniDumpDir(const String& pathName);
 /// Return minidump write location.
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Profiler.h"
+#include "../IO/Serializer.h"
 
 #include <cstdio>
 
@@ -35,15 +36,23 @@ Profiler::Profiler(Context* context) :
     Object(context),
     current_(nullptr),
     root_(nullptr),
-    intervalFrames_(0)
+    gpuCurrent_(nullptr),
+    gpuRoot_(nullptr),
+    intervalFrames_(0),
+    timelineWriteIndex_(0),
+    timelineCapture_(false)
 {
     current_ = root_ = new ProfilerBlock(nullptr, "RunFrame");
+    timelineEvents_.Resize(TIMELINE_EVENTS);
+    gpuRoot_ = new ProfilerBlock(nullptr, "GPUFrame");
 }
 
 Profiler::~Profiler()
 {
     delete root_;
     root_ = nullptr;
+    delete gpuRoot_;
+    gpuRoot_ = nullptr;
 }
 
 void Profiler::BeginFrame()
@@ -60,15 +69,82 @@ void Profiler::EndFrame()
     EndBlock();
     ++intervalFrames_;
     root_->EndFrame();
+    gpuRoot_->EndFrame();
     current_ = root_;
 }
 
 void Profiler::BeginInterval()
 {
     root_->BeginInterval();
+    gpuRoot_->BeginInterval();
     intervalFrames_ = 0;
 }
 
+void Profiler::BeginTimelineCapture()
+{
+    timelineCapture_ = false;
+    timelineWriteIndex_ = 0;
+    timelineTimer_.Reset();
+    timelineCapture_ = true;
+}
+
+void Profiler::EndTimelineCapture()
+{
+    timelineCapture_ = false;
+}
+
+bool Profiler::SaveTimeline(Serializer& dest) const
+{
+    unsigned writeIndex = timelineWriteIndex_.load();
+    unsigned numEvents = Min(writeIndex, TIMELINE_EVENTS);
+    unsigned first = writeIndex - numEvents;
+    unsigned mask = TIMELINE_EVENTS - 1;
+
+    // Map thread IDs to small numbers, the main thread first
+    PODVector<ThreadID> threadIDs;
+    threadIDs.Push(Thread::GetMainThreadID());
+
+    String output("{\"traceEvents\":[\n");
+    char line[128];
+    for (unsigned i = 0; i < numEvents; ++i)
+    {
+        const TimelineEvent& event = timelineEvents_[(first + i) & mask];
+
+        unsigned threadIndex = threadIDs.IndexOf(event.threadID_);
+        if (threadIndex == threadIDs.Size())
+            threadIDs.Push(event.threadID_);
+
+        if (event.begin_)
+            sprintf(line, "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%lld,\"pid\":0,\"tid\":%u}", event.name_, event.time_, threadIndex);
+        else
+            sprintf(line, "{\"ph\":\"E\",\"ts\":%lld,\"pid\":0,\"tid\":%u}", event.time_, threadIndex);
+        output.Append(line);
+        output += i < numEvents - 1 ? ",\n" : "\n";
+    }
+    output += "]}\n";
+
+    return dest.Write(output.CString(), output.Length()) == output.Length();
+}
+
+void Profiler::RecordTimelineEvent(const char* name, bool begin)
+{
+    // Claim a slot without locking. If the ring buffer wraps, the oldest events are overwritten
+    unsigned index = timelineWriteIndex_.fetch_add(1, std::memory_order_relaxed) & (TIMELINE_EVENTS - 1);
+    TimelineEvent& event = timelineEvents_[index];
+
+    unsigned length = 0;
+    if (name)
+    {
+        // Leave out characters that would need escaping in JSON
+        for (; length < TIMELINE_NAME_LENGTH - 1 && name[length]; ++length)
+            event.name_[length] = (name[length] == '"' || name[length] == '\\') ? '_' : name[length];
+    }
+    event.name_[length] = 0;
+    event.time_ = timelineTimer_.GetUSec(false);
+    event.threadID_ = Thread::GetCurrentThreadID();
+    event.begin_ = begin;
+}
+
 const String& Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxDepth) const
 {
     static String output;
@@ -86,6 +162,13 @@ const String& Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxD
 
     PrintData(root_, output, 0, maxDepth, showUnused, showTotal);
 
+    // The GPU times are shown only when Graphics has reported them
+    if (gpuRoot_->totalCount_)
+    {
+        output += "\n";
+        PrintData(gpuRoot_, output, 0, maxDepth, showUnused, showTotal);
+    }
+
     return output;
 }
 
@@ -26,9 +26,31 @@
 #include "../Core/Thread.h"
 #include "../Core/Timer.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
+class Serializer;
+
+/// Maximum stored length of a profiling block name in the timeline.
+static const unsigned TIMELINE_NAME_LENGTH = 32;
+/// Number of events in the timeline ring buffer. Must be a power of two.
+static const unsigned TIMELINE_EVENTS = 65536;
+
+/// Begin or end of a profiling block on the timeline.
+struct TimelineEvent
+{
+    /// Block name. Empty for an end event.
+    char name_[TIMELINE_NAME_LENGTH];
+    /// Time in microseconds since the capture began.
+    long long time_;
+    /// Thread the event was recorded on.
+    ThreadID threadID_;
+    /// Begin event flag.
+    bool begin_;
+};
+
 /// Profiling data for one block in the profiling tree.
 class URHO3D_API ProfilerBlock
 {
@@ -86,6 +108,15 @@ public:
         time_ += time;
     }
 
+    /// Add a call with a duration measured elsewhere, such as on the GPU.
+    void AddTime(long long time)
+    {
+        ++count_;
+        if (time > maxTime_)
+            maxTime_ = time;
+        time_ += time;
+    }
+
     /// End profiling frame and update interval and total values.
     void EndFrame()
     {
@@ -182,7 +213,10 @@ public:
     /// Begin timing a profiling block.
     void BeginBlock(const char* name)
     {
-        // Profiler supports only the main thread currently
+        if (timelineCapture_)
+            RecordTimelineEvent(name, true);
+
+        // Hierarchical profiling supports only the main thread, the timeline records all threads
         if (!Thread::IsMainThread())
             return;
 
@@ -193,6 +227,9 @@ public:
     /// End timing the current profiling block.
     void EndBlock()
     {
+        if (timelineCapture_)
+            RecordTimelineEvent(nullptr, false);
+
         if (!Thread::IsMainThread())
             return;
 
@@ -201,12 +238,36 @@ public:
             current_ = current_->parent_;
     }
 
+    /// Begin a block in the GPU profiling tree. The first block opened is the GPU frame root. Called by Graphics when the timer query results of a past frame become available.
+    void BeginGPUBlock(const char* name)
+    {
+        gpuCurrent_ = gpuCurrent_ ? gpuCurrent_->GetChild(name) : gpuRoot_;
+    }
+
+    /// End the current block in the GPU profiling tree with its duration in microseconds.
+    void EndGPUBlock(long long time)
+    {
+        if (!gpuCurrent_)
+            return;
+
+        gpuCurrent_->AddTime(time);
+        gpuCurrent_ = gpuCurrent_->parent_;
+    }
+
     /// Begin the profiling frame. Called by HandleBeginFrame().
     void BeginFrame();
     /// End the profiling frame. Called by HandleEndFrame().
     void EndFrame();
     /// Begin a new interval.
     void BeginInterval();
+    /// Begin capturing the begin and end times of profiling blocks from all threads into a ring buffer that holds the latest TIMELINE_EVENTS events. Should be called from the main thread when no worker thread is profiling.
+    void BeginTimelineCapture();
+    /// End capturing the timeline. The captured events are retained until the next capture.
+    void EndTimelineCapture();
+    /// Write the captured timeline as Chrome trace event JSON, viewable in chrome://tracing or Perfetto. Return true if successful.
+    bool SaveTimeline(Serializer& dest) const;
+    /// Return whether the timeline is being captured.
+    bool IsTimelineCapturing() const { return timelineCapture_; }
 
     /// Return profiling data as text output. This method is not thread-safe.
     const String& PrintData(bool showUnused = false, bool showTotal = false, unsigned maxDepth = M_MAX_UNSIGNED) const;
@@ -214,8 +275,12 @@ public:
     const ProfilerBlock* GetCurrentBlock() { return current_; }
     /// Return the root profiling block.
     const ProfilerBlock* GetRootBlock() { return root_; }
+    /// Return the root block of the GPU profiling tree.
+    const ProfilerBlock* GetGPURootBlock() { return gpuRoot_; }
 
 protected:
+    /// Record a begin or end event to the timeline. Is thread-safe.
+    void RecordTimelineEvent(const char* name, bool begin);
     /// Return profiling data as text output for a specified profiling block.
     void PrintData(ProfilerBlock* block, String& output, unsigned depth, unsigned maxDepth, bool showUnused, bool showTotal) const;
 
@@ -223,8 +288,20 @@ protected:
     ProfilerBlock* current_;
     /// Root profiling block.
     ProfilerBlock* root_;
+    /// Current block of the GPU profiling tree, null between GPU frames.
+    ProfilerBlock* gpuCurrent_;
+    /// Root block of the GPU profiling tree.
+    ProfilerBlock* gpuRoot_;
     /// Frames in the current interval.
     unsigned intervalFrames_;
+    /// Timeline ring buffer. Allocated in the constructor and never resized, so that recording threads can write to it without locking.
+    PODVector<TimelineEvent> timelineEvents_;
+    /// Timer for the timeline timestamps.
+    HiresTimer timelineTimer_;
+    /// Total number of events recorded during the capture. The ring buffer holds the latest ones.
+    std::atomic<unsigned> timelineWriteIndex_;
+    /// Timeline capture flag.
+    std::atomic<bool> timelineCapture_;
 };
 
 /// Helper class for automatically beginning and ending a profiling block
@@ -0,0 +1,346 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Task.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../IO/FileSystem.h"
+#include "../IO/IOEvents.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Completes a task when an event is sent.
+class TaskEventWaiter : public Object
+{
+    URHO3D_OBJECT(TaskEventWaiter, Object);
+
+public:
+    /// Construct and subscribe to the event.
+    TaskEventWaiter(Context* context, Object* sender, StringHash eventType, const TaskPromise<VariantMap>& promise,
+        const std::function<bool(VariantMap&)>& filter) :
+        Object(context),
+        sender_(sender),
+        promise_(promise),
+        filter_(filter),
+        hasSender_(sender != nullptr),
+        completed_(false)
+    {
+        if (sender)
+            SubscribeToEvent(sender, eventType, URHO3D_HANDLER(TaskEventWaiter, HandleEvent));
+        else
+            SubscribeToEvent(eventType, URHO3D_HANDLER(TaskEventWaiter, HandleEvent));
+    }
+
+    /// Return whether will not complete anymore, either because has completed or because the sender was destroyed.
+    bool IsFinished() const { return completed_ || (hasSender_ && sender_.Expired()); }
+
+private:
+    /// Handle the event.
+    void HandleEvent(StringHash /*eventType*/, VariantMap& eventData)
+    {
+        if (completed_ || (filter_ && !filter_(eventData)))
+            return;
+
+        completed_ = true;
+        UnsubscribeFromAllEvents();
+        promise_.SetResult(eventData);
+    }
+
+    /// Event sender.
+    WeakPtr<Object> sender_;
+    /// Promise to complete.
+    TaskPromise<VariantMap> promise_;
+    /// Event filter.
+    std::function<bool(VariantMap&)> filter_;
+    /// Whether waits for a specific sender.
+    bool hasSender_;
+    /// Completed flag.
+    bool completed_;
+};
+
+static void RunTaskWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto* func = static_cast<std::function<void()>*>(item->aux_);
+    (*func)();
+    delete func;
+}
+
+TaskScheduler::TaskScheduler(Context* context) :
+    Object(context)
+{
+    // Tasks refer to the scheduler from worker threads
+    SetAtomicRefCount(true);
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(TaskScheduler, HandleBeginFrame));
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(TaskScheduler, HandleUpdate));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(TaskScheduler, HandleEndFrame));
+}
+
+TaskScheduler::~TaskScheduler() = default;
+
+Task<unsigned> TaskScheduler::NextFrame(TaskResume point)
+{
+    TaskPromise<unsigned> promise(this);
+    auto* time = GetSubsystem<Time>();
+    AddWait([promise, time]()
+    {
+        promise.SetResult(time ? time->GetFrameNumber() : 0);
+        return true;
+    }, point);
+    return promise.GetTask();
+}
+
+Task<float> TaskScheduler::Delay(float seconds, TaskResume point)
+{
+    TaskPromise<float> promise(this);
+    auto* time = GetSubsystem<Time>();
+    float start = time ? time->GetElapsedTime() : 0.0f;
+    AddWait([promise, time, start, seconds]()
+    {
+        float elapsed = time ? time->GetElapsedTime() - start : seconds;
+        if (elapsed < seconds)
+            return false;
+        promise.SetResult(elapsed);
+        return true;
+    }, point);
+    return promise.GetTask();
+}
+
+Task<bool> TaskScheduler::WaitUntil(const std::function<bool()>& condition, TaskResume point)
+{
+    TaskPromise<bool> promise(this);
+    AddWait([promise, condition]()
+    {
+        if (!condition())
+            return false;
+        promise.SetResult(true);
+        return true;
+    }, point);
+    return promise.GetTask();
+}
+
+Task<VariantMap> TaskScheduler::WaitForEvent(Object* sender, StringHash eventType, const std::function<bool(VariantMap&)>& filter)
+{
+    TaskPromise<VariantMap> promise(this);
+    eventWaiters_.Push(SharedPtr<Object>(new TaskEventWaiter(context_, sender, eventType, promise, filter)));
+    return promise.GetTask();
+}
+
+Task<SharedPtr<Resource> > TaskScheduler::LoadResourceAsync(StringHash type, const String& name)
+{
+    TaskPromise<SharedPtr<Resource> > promise(this);
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    String sanitatedName = cache ? cache->SanitateResourceName(name) : String::EMPTY;
+    if (sanitatedName.Empty() || !context_->GetObjectFactories().Contains(type))
+    {
+        promise.SetResult(SharedPtr<Resource>());
+        return promise.GetTask();
+    }
+
+    // The background loader finishes resources in the main thread, so the event can not be missed between queuing and
+    // subscribing. Loading may also have been queued before, in which case only the event is waited for
+    if (Resource* existing = cache->GetExistingResource(type, sanitatedName))
+    {
+        promise.SetResult(SharedPtr<Resource>(existing));
+        return promise.GetTask();
+    }
+
+    cache->BackgroundLoadResource(type, sanitatedName);
+
+    // Without threading the resource was loaded right away
+    if (Resource* existing = cache->GetExistingResource(type, sanitatedName))
+    {
+        promise.SetResult(SharedPtr<Resource>(existing));
+        return promise.GetTask();
+    }
+
+    WaitForEvent(cache, E_RESOURCEBACKGROUNDLOADED, [sanitatedName](VariantMap& eventData)
+    {
+        return eventData[ResourceBackgroundLoaded::P_RESOURCENAME].GetString() == sanitatedName;
+    }).Then([promise](const VariantMap& eventData)
+    {
+        using namespace ResourceBackgroundLoaded;
+
+        VariantMap::ConstIterator success = eventData.Find(P_SUCCESS);
+        VariantMap::ConstIterator resource = eventData.Find(P_RESOURCE);
+        if (success != eventData.End() && success->second_.GetBool() && resource != eventData.End())
+            promise.SetResult(SharedPtr<Resource>(static_cast<Resource*>(resource->second_.GetPtr())));
+        else
+            promise.SetResult(SharedPtr<Resource>());
+    }, RESUME_IMMEDIATE);
+
+    return promise.GetTask();
+}
+
+Task<PODVector<unsigned char> > TaskScheduler::ReadFileAsync(const String& fileName)
+{
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    unsigned requestID = fileSystem ? fileSystem->ReadFileAsync(fileName) : M_MAX_UNSIGNED;
+    if (requestID == M_MAX_UNSIGNED)
+    {
+        TaskPromise<PODVector<unsigned char> > promise(this);
+        promise.SetResult(PODVector<unsigned char>());
+        return promise.GetTask();
+    }
+
+    // The read results are posted in the main thread on the next frame, so subscribing after the request is safe
+    return WaitForEvent(fileSystem, E_ASYNCREADFINISHED, [requestID](VariantMap& eventData)
+    {
+        return eventData[AsyncReadFinished::P_REQUESTID].GetUInt() == requestID;
+    }).Then([](const VariantMap& eventData)
+    {
+        using namespace AsyncReadFinished;
+
+        VariantMap::ConstIterator data = eventData.Find(P_DATA);
+        return data != eventData.End() ? data->second_.GetBuffer() : PODVector<unsigned char>();
+    }, RESUME_IMMEDIATE);
+}
+
+void TaskScheduler::Post(const std::function<void()>& func, TaskResume resume)
+{
+    switch (resume)
+    {
+    case RESUME_IMMEDIATE:
+        func();
+        break;
+
+    case RESUME_WORKER:
+        SubmitWork(func, WORK_BACKGROUND);
+        break;
+
+    default:
+        {
+            MutexLock lock(queueMutex_);
+            queues_[resume].Push(func);
+        }
+        break;
+    }
+}
+
+unsigned TaskScheduler::GetNumPending(TaskResume point) const
+{
+    if (point <= RESUME_WORKER || point >= MAX_TASK_RESUME)
+        return 0;
+
+    MutexLock lock(queueMutex_);
+    return queues_[point].Size() + waits_[point].Size();
+}
+
+void TaskScheduler::SubmitWork(const std::function<void()>& func, WorkClass workClass)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !Thread::IsMainThread())
+    {
+        func();
+        return;
+    }
+
+    SharedPtr<WorkItem> item = queue->GetFreeItem();
+    item->priority_ = 0;
+    item->workClass_ = workClass;
+    item->workFunction_ = RunTaskWork;
+    item->name_ = "RunTaskWork";
+    item->aux_ = new std::function<void()>(func);
+    queue->AddWorkItem(item);
+}
+
+void TaskScheduler::AddWait(const std::function<bool()>& wait, TaskResume point)
+{
+    if (point <= RESUME_WORKER || point >= MAX_TASK_RESUME)
+        point = RESUME_UPDATE;
+
+    MutexLock lock(queueMutex_);
+    waits_[point].Push(wait);
+}
+
+void TaskScheduler::ProcessPoint(TaskResume point)
+{
+    // Check the waits added before this point was reached, so that a wait added now completes on the next frame at the earliest
+    Vector<std::function<bool()> > waits;
+    {
+        MutexLock lock(queueMutex_);
+        waits.Swap(waits_[point]);
+    }
+    if (!waits.Empty())
+    {
+        Vector<std::function<bool()> > remaining;
+        for (unsigned i = 0; i < waits.Size(); ++i)
+        {
+            if (!waits[i]())
+                remaining.Push(waits[i]);
+        }
+
+        MutexLock lock(queueMutex_);
+        remaining.Push(waits_[point]);
+        waits_[point].Swap(remaining);
+    }
+
+    // Run the queued functions, including those queued by the continuations run meanwhile
+    for (;;)
+    {
+        Vector<std::function<void()> > funcs;
+        {
+            MutexLock lock(queueMutex_);
+            if (queues_[point].Empty())
+                break;
+            funcs.Swap(queues_[point]);
+        }
+
+        for (unsigned i = 0; i < funcs.Size(); ++i)
+            funcs[i]();
+    }
+}
+
+void TaskScheduler::HandleBeginFrame(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    // Remove the event waiters that will not complete anymore
+    for (unsigned i = eventWaiters_.Size() - 1; i < eventWaiters_.Size(); --i)
+    {
+        if (static_cast<TaskEventWaiter*>(eventWaiters_[i].Get())->IsFinished())
+            eventWaiters_.Erase(i);
+    }
+
+    ProcessPoint(RESUME_BEGINFRAME);
+}
+
+void TaskScheduler::HandleUpdate(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    ProcessPoint(RESUME_UPDATE);
+}
+
+void TaskScheduler::HandleEndFrame(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    ProcessPoint(RESUME_ENDFRAME);
+}
+
+}
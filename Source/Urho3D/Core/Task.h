@@ -0,0 +1,380 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+#include "../Core/WorkQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <utility>
+
+namespace Urho3D
+{
+
+class Resource;
+template <class T> class Task;
+template <class T> class TaskPromise;
+
+/// Point at which a task continuation is resumed.
+enum TaskResume
+{
+    /// Right away in the thread that completed the antecedent task. Should only be used for short continuations.
+    RESUME_IMMEDIATE = 0,
+    /// In a WorkQueue thread. A continuation of a task completed outside the main thread runs in the completing thread.
+    RESUME_WORKER,
+    /// In the main thread at the start of the frame (E_BEGINFRAME).
+    RESUME_BEGINFRAME,
+    /// In the main thread before the scene update (E_UPDATE).
+    RESUME_UPDATE,
+    /// In the main thread at the end of the frame (E_ENDFRAME).
+    RESUME_ENDFRAME,
+    MAX_TASK_RESUME
+};
+
+/// %Task scheduler subsystem. Creates tasks for asynchronous engine operations and resumes task continuations in worker threads or at the frame points of Engine::RunFrame().
+/** The engine is compiled as C++11, so instead of C++20 coroutines a task is a future whose continuations are chained
+    with Task::Then(). A continuation returning another task is resumed only after that task completes, which allows
+    writing a loading or streaming flow as one chain without intermediate events or polling.
+  */
+class URHO3D_API TaskScheduler : public Object
+{
+    URHO3D_OBJECT(TaskScheduler, Object);
+
+public:
+    /// Construct.
+    explicit TaskScheduler(Context* context);
+    /// Destruct. Continuations not yet resumed are discarded.
+    ~TaskScheduler() override;
+
+    /// Run a function in a WorkQueue thread and return a task for its result. When called outside the main thread, the function runs in the calling thread.
+    template <class F> Task<typename std::decay<decltype(std::declval<F&>()())>::type> RunAsync(F func, WorkClass workClass = WORK_BACKGROUND);
+    /// Return a task that completes with the frame number at the next occurrence of a main thread frame point.
+    Task<unsigned> NextFrame(TaskResume point = RESUME_UPDATE);
+    /// Return a task that completes with the elapsed time in seconds once at least the specified time has passed. Checked at a main thread frame point.
+    Task<float> Delay(float seconds, TaskResume point = RESUME_UPDATE);
+    /// Return a task that completes once a condition becomes true. The condition is checked at a main thread frame point, for example to wait for the state of an HttpRequest.
+    Task<bool> WaitUntil(const std::function<bool()>& condition, TaskResume point = RESUME_UPDATE);
+    /// Return a task that completes with a copy of the event data when an event is sent, optionally only by a specific sender and accepted by a filter. Must be called from the main thread. Does not complete if the sender is destroyed first.
+    Task<VariantMap> WaitForEvent(Object* sender, StringHash eventType, const std::function<bool(VariantMap&)>& filter = std::function<bool(VariantMap&)>());
+    /// Load a resource in the background and return a task for it. Completes with null if the resource can not be loaded. Must be called from the main thread.
+    Task<SharedPtr<Resource> > LoadResourceAsync(StringHash type, const String& name);
+    /// Load a resource in the background and return a task for it. Template version.
+    template <class T> Task<SharedPtr<T> > LoadResourceAsync(const String& name);
+    /// Read a file with the asynchronous I/O of the FileSystem and return a task for its contents. Completes with empty data if the file can not be read. Must be called from the main thread.
+    Task<PODVector<unsigned char> > ReadFileAsync(const String& fileName);
+    /// Return a task that completes with the results of all tasks in order once they have completed.
+    template <class T> Task<Vector<T> > WhenAll(const Vector<Task<T> >& tasks);
+
+    /// Queue a function to run at a resume point. Can be called from any thread.
+    void Post(const std::function<void()>& func, TaskResume resume);
+    /// Return the number of functions and waits pending at a main thread frame point.
+    unsigned GetNumPending(TaskResume point) const;
+
+private:
+    /// Execute a function in a WorkQueue thread, or in the calling thread if not on the main thread or there are no worker threads.
+    void SubmitWork(const std::function<void()>& func, WorkClass workClass);
+    /// Queue a wait that is checked at a frame point until it returns true.
+    void AddWait(const std::function<bool()>& wait, TaskResume point);
+    /// Resume the waits and functions of a frame point.
+    void ProcessPoint(TaskResume point);
+    /// Handle frame start event.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle update event.
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle frame end event.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Mutex for the queues.
+    mutable Mutex queueMutex_;
+    /// Functions queued for each frame point.
+    Vector<std::function<void()> > queues_[MAX_TASK_RESUME];
+    /// Waits checked at each frame point.
+    Vector<std::function<bool()> > waits_[MAX_TASK_RESUME];
+    /// Objects waiting for events. Accessed only by the main thread.
+    Vector<SharedPtr<Object> > eventWaiters_;
+};
+
+/// Shared state of a task. Completed once by a promise, after which the result does not change.
+template <class T> class TaskState : public RefCounted
+{
+public:
+    /// Construct.
+    explicit TaskState(TaskScheduler* scheduler) :
+        scheduler_(scheduler),
+        ready_(false)
+    {
+        SetAtomicRefCount(true);
+    }
+
+    /// Complete with a result and call the ready callbacks in the calling thread. Return false if was already completed.
+    bool SetResult(const T& result)
+    {
+        Vector<std::function<void(const T&)> > callbacks;
+        {
+            MutexLock lock(mutex_);
+            if (ready_)
+                return false;
+            result_ = result;
+            ready_.store(true, std::memory_order_release);
+            callbacks.Swap(callbacks_);
+        }
+
+        for (unsigned i = 0; i < callbacks.Size(); ++i)
+            callbacks[i](result_);
+        return true;
+    }
+
+    /// Call a function with the result once completed. Called right away in the calling thread if already completed.
+    void OnReady(const std::function<void(const T&)>& callback)
+    {
+        {
+            MutexLock lock(mutex_);
+            if (!ready_)
+            {
+                callbacks_.Push(callback);
+                return;
+            }
+        }
+
+        callback(result_);
+    }
+
+    /// Return whether has completed.
+    bool IsReady() const { return ready_.load(std::memory_order_acquire); }
+    /// Return the result. Only valid once completed.
+    const T& GetResult() const { return result_; }
+    /// Return the scheduler that resumes the continuations.
+    TaskScheduler* GetScheduler() const { return scheduler_; }
+
+private:
+    /// Scheduler.
+    WeakPtr<TaskScheduler> scheduler_;
+    /// Mutex for completing and adding callbacks.
+    Mutex mutex_;
+    /// Result.
+    T result_{};
+    /// Completed flag.
+    std::atomic<bool> ready_;
+    /// Callbacks waiting for completion.
+    Vector<std::function<void(const T&)> > callbacks_;
+};
+
+/// Completes the return value of a task continuation.
+template <class R> struct TaskContinuation
+{
+    /// Result type of the task returned by Task::Then().
+    using ResultType = R;
+
+    /// Call the continuation and complete the promise with its return value.
+    template <class F, class A> static void Invoke(const TaskPromise<ResultType>& promise, F& func, const A& arg)
+    {
+        promise.SetResult(func(arg));
+    }
+};
+
+/// Completes a task continuation without return value. The result is true.
+template <> struct TaskContinuation<void>
+{
+    /// Result type of the task returned by Task::Then().
+    using ResultType = bool;
+
+    /// Call the continuation and complete the promise. The promise type is a template parameter, as TaskPromise is not yet complete here.
+    template <class P, class F, class A> static void Invoke(const P& promise, F& func, const A& arg)
+    {
+        func(arg);
+        promise.SetResult(true);
+    }
+};
+
+/// Completes a task continuation which returns another task, once that task has completed.
+template <class U> struct TaskContinuation<Task<U> >
+{
+    /// Result type of the task returned by Task::Then().
+    using ResultType = U;
+
+    /// Call the continuation and forward the result of the returned task to the promise.
+    template <class F, class A> static void Invoke(const TaskPromise<ResultType>& promise, F& func, const A& arg)
+    {
+        Task<U> inner = func(arg);
+        if (inner.state_)
+            inner.state_->OnReady([promise](const U& result) { promise.SetResult(result); });
+        else
+            promise.SetResult(U());
+    }
+};
+
+/// Result of an asynchronous operation, which can be polled or continued with a function.
+template <class T> class Task
+{
+    template <class U> friend class Task;
+    template <class U> friend class TaskPromise;
+    template <class R> friend struct TaskContinuation;
+    friend class TaskScheduler;
+
+public:
+    /// Construct invalid.
+    Task() = default;
+
+    /// Return whether is associated with an operation.
+    bool IsValid() const { return state_.NotNull(); }
+    /// Return whether has completed.
+    bool IsReady() const { return state_ && state_->IsReady(); }
+    /// Return the result. Only valid once completed.
+    const T& GetResult() const
+    {
+        assert(IsReady());
+        return state_->GetResult();
+    }
+
+    /// Continue with a function taking the result, resumed at the specified point. Return a task for the function's return value. If the function returns a task, the returned task completes with its result.
+    template <class F> Task<typename TaskContinuation<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>::ResultType>
+        Then(F func, TaskResume resume = RESUME_UPDATE) const
+    {
+        using Continuation = TaskContinuation<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>;
+        using ResultType = typename Continuation::ResultType;
+
+        if (!state_)
+            return Task<ResultType>();
+
+        WeakPtr<TaskScheduler> scheduler(state_->GetScheduler());
+        TaskPromise<ResultType> promise(scheduler);
+        state_->OnReady([scheduler, promise, func, resume](const T& result)
+        {
+            if (resume == RESUME_IMMEDIATE)
+            {
+                F call(func);
+                Continuation::Invoke(promise, call, result);
+            }
+            else if (scheduler)
+            {
+                T value(result);
+                scheduler->Post([promise, func, value]()
+                {
+                    F call(func);
+                    Continuation::Invoke(promise, call, value);
+                }, resume);
+            }
+        });
+
+        return promise.GetTask();
+    }
+
+private:
+    /// Construct from a shared state.
+    explicit Task(const SharedPtr<TaskState<T> >& state) :
+        state_(state)
+    {
+    }
+
+    /// Shared state.
+    SharedPtr<TaskState<T> > state_;
+};
+
+/// Producer side of a task. Used to complete a task from a callback, event handler or thread. Copies refer to the same task.
+template <class T> class TaskPromise
+{
+public:
+    /// Construct with a new task. The scheduler resumes the task's continuations.
+    explicit TaskPromise(TaskScheduler* scheduler) :
+        state_(new TaskState<T>(scheduler))
+    {
+    }
+
+    /// Complete the task. Return false if was already completed.
+    bool SetResult(const T& result) const { return state_->SetResult(result); }
+    /// Return the task.
+    Task<T> GetTask() const { return Task<T>(state_); }
+
+private:
+    /// Shared state.
+    SharedPtr<TaskState<T> > state_;
+};
+
+template <class F> Task<typename std::decay<decltype(std::declval<F&>()())>::type> TaskScheduler::RunAsync(F func, WorkClass workClass)
+{
+    using ResultType = typename std::decay<decltype(std::declval<F&>()())>::type;
+
+    TaskPromise<ResultType> promise(this);
+    SubmitWork([promise, func]()
+    {
+        F call(func);
+        promise.SetResult(call());
+    }, workClass);
+    return promise.GetTask();
+}
+
+template <class T> Task<SharedPtr<T> > TaskScheduler::LoadResourceAsync(const String& name)
+{
+    return LoadResourceAsync(T::GetTypeStatic(), name).Then([](const SharedPtr<Resource>& resource)
+    {
+        return SharedPtr<T>(static_cast<T*>(resource.Get()));
+    }, RESUME_IMMEDIATE);
+}
+
+template <class T> Task<Vector<T> > TaskScheduler::WhenAll(const Vector<Task<T> >& tasks)
+{
+    /// Results collected so far.
+    struct Results : public RefCounted
+    {
+        explicit Results(unsigned count) :
+            values_(count),
+            remaining_(count)
+        {
+            SetAtomicRefCount(true);
+        }
+
+        Vector<T> values_;
+        std::atomic<unsigned> remaining_;
+    };
+
+    TaskPromise<Vector<T> > promise(this);
+    if (tasks.Empty())
+    {
+        promise.SetResult(Vector<T>());
+        return promise.GetTask();
+    }
+
+    // Each task writes its own element, and the last one to complete publishes the whole vector
+    SharedPtr<Results> results(new Results(tasks.Size()));
+    for (unsigned i = 0; i < tasks.Size(); ++i)
+    {
+        auto complete = [results, promise, i](const T& value)
+        {
+            results->values_[i] = value;
+            if (--results->remaining_ == 0)
+                promise.SetResult(results->values_);
+        };
+
+        if (tasks[i].state_)
+            tasks[i].state_->OnReady(complete);
+        else
+            complete(T());
+    }
+
+    return promise.GetTask();
+}
+
+}
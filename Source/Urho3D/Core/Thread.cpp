@@ -29,6 +29,14 @@
 #else
 #include <pthread.h>
 #endif
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread/qos.h>
+#endif
 
 #include "../DebugNew.h"
 
@@ -36,11 +44,21 @@ namespace Urho3D
 {
 
 #ifdef URHO3D_THREADING
+/// Apply the scheduling settings of a thread that has just started.
+static void ApplySchedulingSettings(Thread* thread)
+{
+    if (thread->GetAffinityMask())
+        Thread::SetCurrentThreadAffinity(thread->GetAffinityMask());
+    if (thread->GetPriorityClass() != TP_NORMAL)
+        Thread::SetCurrentThreadPriority(thread->GetPriorityClass());
+}
+
 #ifdef _WIN32
 
 static DWORD WINAPI ThreadFunctionStatic(void* data)
 {
     Thread* thread = static_cast<Thread*>(data);
+    ApplySchedulingSettings(thread);
     thread->ThreadFunction();
     return 0;
 }
@@ -50,6 +68,7 @@ static DWORD WINAPI ThreadFunctionStatic(void* data)
 static void* ThreadFunctionStatic(void* data)
 {
     auto* thread = static_cast<Thread*>(data);
+    ApplySchedulingSettings(thread);
     thread->ThreadFunction();
     pthread_exit((void*)nullptr);
     return nullptr;
@@ -60,9 +79,15 @@ static void* ThreadFunctionStatic(void* data)
 
 ThreadID Thread::mainThreadID;
 
+#ifdef URHO3D_THREADING
+static thread_local bool contextThread = false;
+#endif
+
 Thread::Thread() :
     handle_(nullptr),
-    shouldRun_(false)
+    shouldRun_(false),
+    affinityMask_(0),
+    priorityClass_(TP_NORMAL)
 {
 }
 
@@ -147,13 +172,72 @@ ThreadID Thread::GetCurrentThreadID()
 #endif // URHO3D_THREADING
 }
 
+bool Thread::SetCurrentThreadAffinity(unsigned long long mask)
+{
+#ifdef URHO3D_THREADING
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)mask) != 0;
+#elif defined(__linux__) && !defined(__EMSCRIPTEN__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        if (mask & (1ULL << i))
+            CPU_SET(i, &cpuSet);
+    }
+    return sched_setaffinity(0, sizeof cpuSet, &cpuSet) == 0;
+#else
+    return false;
+#endif
+#else
+    return false;
+#endif // URHO3D_THREADING
+}
+
+bool Thread::SetCurrentThreadPriority(ThreadPriority priority)
+{
+#ifdef URHO3D_THREADING
+#ifdef _WIN32
+    static const int priorities[] = { THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_ABOVE_NORMAL };
+    return SetThreadPriority(GetCurrentThread(), priorities[priority]) != 0;
+#elif defined(__linux__) && !defined(__EMSCRIPTEN__)
+    // Linux threads have their own nice value. Raising the priority usually requires privileges, in which case this fails
+    static const int niceValues[] = { 10, 0, -5 };
+    return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), niceValues[priority]) == 0;
+#elif defined(__APPLE__)
+    static const qos_class_t qosClasses[] = { QOS_CLASS_UTILITY, QOS_CLASS_DEFAULT, QOS_CLASS_USER_INTERACTIVE };
+    return pthread_set_qos_class_self_np(qosClasses[priority], 0) == 0;
+#else
+    return false;
+#endif
+#else
+    return false;
+#endif // URHO3D_THREADING
+}
+
 bool Thread::IsMainThread()
 {
 #ifdef URHO3D_THREADING
-    return GetCurrentThreadID() == mainThreadID;
+    return contextThread || GetCurrentThreadID() == mainThreadID;
 #else
     return true;
 #endif // URHO3D_THREADING
 }
 
+void Thread::SetContextThread(bool enable)
+{
+#ifdef URHO3D_THREADING
+    contextThread = enable;
+#endif // URHO3D_THREADING
+}
+
+bool Thread::IsContextThread()
+{
+#ifdef URHO3D_THREADING
+    return contextThread;
+#else
+    return false;
+#endif // URHO3D_THREADING
+}
+
 }
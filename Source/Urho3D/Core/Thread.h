@@ -38,6 +38,17 @@ using ThreadID = unsigned;
 namespace Urho3D
 {
 
+/// Thread scheduling priority class.
+enum ThreadPriority
+{
+    /// Background work which may be delayed. Prefers efficiency cores where the OS decides the core type.
+    TP_LOW = 0,
+    /// Default priority.
+    TP_NORMAL,
+    /// Latency-critical work.
+    TP_HIGH
+};
+
 /// Operating system thread.
 class URHO3D_API Thread
 {
@@ -56,22 +67,44 @@ public:
     void Stop();
     /// Set thread priority. The thread must have been started first.
     void SetPriority(int priority);
+    /// Set the logical CPUs the thread may run on as a bitmask. Zero (default) does not restrict. Takes effect when the thread is started.
+    void SetAffinityMask(unsigned long long mask) { affinityMask_ = mask; }
+    /// Set the scheduling priority class. Takes effect when the thread is started.
+    void SetPriorityClass(ThreadPriority priority) { priorityClass_ = priority; }
 
     /// Return whether thread exists.
     bool IsStarted() const { return handle_ != nullptr; }
+    /// Return the CPU affinity mask.
+    unsigned long long GetAffinityMask() const { return affinityMask_; }
+    /// Return the scheduling priority class.
+    ThreadPriority GetPriorityClass() const { return priorityClass_; }
 
     /// Set the current thread as the main thread.
     static void SetMainThread();
     /// Return the current thread's ID.
     static ThreadID GetCurrentThreadID();
-    /// Return whether is executing in the main thread.
+    /// Return whether is executing in the main thread, or in the main thread of a context of its own.
     static bool IsMainThread();
+    /// Set whether the current thread runs a context of its own besides the main thread, as in SimulationThread. Such threads pass the main thread checks of their context, but do not own the Log.
+    static void SetContextThread(bool enable);
+    /// Return whether the current thread runs a context of its own besides the main thread.
+    static bool IsContextThread();
+    /// Return the main thread's ID.
+    static ThreadID GetMainThreadID() { return mainThreadID; }
+    /// Restrict the calling thread to the logical CPUs in a bitmask. Return true if successful. Not supported on Apple platforms and the web.
+    static bool SetCurrentThreadAffinity(unsigned long long mask);
+    /// Set the scheduling priority class of the calling thread. Return true if successful.
+    static bool SetCurrentThreadPriority(ThreadPriority priority);
 
 protected:
     /// Thread handle.
     void* handle_;
     /// Running flag.
     volatile bool shouldRun_;
+    /// CPU affinity mask applied on start.
+    unsigned long long affinityMask_;
+    /// Scheduling priority class applied on start.
+    ThreadPriority priorityClass_;
 
     /// Main thread's thread ID.
     static ThreadID mainThreadID;
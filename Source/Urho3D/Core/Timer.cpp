@@ -187,6 +187,48 @@ void Time::Sleep(unsigned mSec)
 #endif
 }
 
+void Time::SleepUSec(unsigned uSec)
+{
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+    // Per-thread waitable timer
+    struct WaitableTimer
+    {
+        WaitableTimer()
+        {
+            // High-resolution timers exist since Windows 10 version 1803. Older versions fall back to a normal timer, which
+            // is limited by the timer period set with timeBeginPeriod()
+            handle_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (!handle_)
+                handle_ = CreateWaitableTimerW(nullptr, TRUE, nullptr);
+        }
+
+        ~WaitableTimer()
+        {
+            if (handle_)
+                CloseHandle(handle_);
+        }
+
+        HANDLE handle_;
+    };
+
+    static thread_local WaitableTimer timer;
+
+    // Negative due time is relative, in 100 nanosecond units
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -(LONGLONG)uSec * 10;
+    if (timer.handle_ && SetWaitableTimer(timer.handle_, &dueTime, 0, nullptr, nullptr, FALSE))
+        WaitForSingleObject(timer.handle_, INFINITE);
+    else
+        ::Sleep((uSec + 999) / 1000);
+#else
+    timespec time{static_cast<time_t>(uSec / 1000000), static_cast<long>((uSec % 1000000) * 1000)};
+    nanosleep(&time, nullptr);
+#endif
+}
+
 float Time::GetFramesPerSecond() const
 {
     return 1.0f / timeStep_;
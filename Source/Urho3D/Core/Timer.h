@@ -115,6 +115,8 @@ public:
     static String GetTimeStamp();
     /// Sleep for a number of milliseconds.
     static void Sleep(unsigned mSec);
+    /// Sleep for a number of microseconds. Uses a high-resolution timer where available, so the wait is not rounded to the system timer period.
+    static void SleepUSec(unsigned uSec);
 
 private:
     /// Elapsed time since program start.
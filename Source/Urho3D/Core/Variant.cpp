@@ -89,31 +89,31 @@ Variant& Variant::operator =(const Variant& rhs)
     switch (type_)
     {
     case VAR_STRING:
-        value_.string_ = rhs.value_.string_;
+        *value_.string_ = *rhs.value_.string_;
         break;
 
     case VAR_BUFFER:
-        value_.buffer_ = rhs.value_.buffer_;
+        *value_.buffer_ = *rhs.value_.buffer_;
         break;
 
     case VAR_RESOURCEREF:
-        value_.resourceRef_ = rhs.value_.resourceRef_;
+        *value_.resourceRef_ = *rhs.value_.resourceRef_;
         break;
 
     case VAR_RESOURCEREFLIST:
-        value_.resourceRefList_ = rhs.value_.resourceRefList_;
+        *value_.resourceRefList_ = *rhs.value_.resourceRefList_;
         break;
 
     case VAR_VARIANTVECTOR:
-        value_.variantVector_ = rhs.value_.variantVector_;
+        *value_.variantVector_ = *rhs.value_.variantVector_;
         break;
 
     case VAR_STRINGVECTOR:
-        value_.stringVector_ = rhs.value_.stringVector_;
+        *value_.stringVector_ = *rhs.value_.stringVector_;
         break;
 
     case VAR_VARIANTMAP:
-        value_.variantMap_ = rhs.value_.variantMap_;
+        *value_.variantMap_ = *rhs.value_.variantMap_;
         break;
 
     case VAR_PTR:
@@ -140,10 +140,27 @@ Variant& Variant::operator =(const Variant& rhs)
     return *this;
 }
 
+Variant& Variant::operator =(Variant&& rhs) noexcept
+{
+    if (&rhs == this)
+        return *this;
+
+    // A custom value stored inline may not be relocatable, so copy it instead
+    if (rhs.type_ == VAR_CUSTOM_STACK)
+        return *this = static_cast<const Variant&>(rhs);
+
+    // All other values are either trivially copyable, a WeakPtr or a heap pointer, so they can be relocated bitwise
+    SetType(VAR_NONE);
+    memcpy(&value_, &rhs.value_, sizeof(VariantValue));     // NOLINT(bugprone-undefined-memory-manipulation)
+    type_ = rhs.type_;
+    rhs.type_ = VAR_NONE;
+    return *this;
+}
+
 Variant& Variant::operator =(const VectorBuffer& rhs)
 {
     SetType(VAR_BUFFER);
-    value_.buffer_ = rhs.GetBuffer();
+    *value_.buffer_ = rhs.GetBuffer();
     return *this;
 }
 
@@ -186,25 +203,25 @@ bool Variant::operator ==(const Variant& rhs) const
         return value_.color_ == rhs.value_.color_;
 
     case VAR_STRING:
-        return value_.string_ == rhs.value_.string_;
+        return *value_.string_ == *rhs.value_.string_;
 
     case VAR_BUFFER:
-        return value_.buffer_ == rhs.value_.buffer_;
+        return *value_.buffer_ == *rhs.value_.buffer_;
 
     case VAR_RESOURCEREF:
-        return value_.resourceRef_ == rhs.value_.resourceRef_;
+        return *value_.resourceRef_ == *rhs.value_.resourceRef_;
 
     case VAR_RESOURCEREFLIST:
-        return value_.resourceRefList_ == rhs.value_.resourceRefList_;
+        return *value_.resourceRefList_ == *rhs.value_.resourceRefList_;
 
     case VAR_VARIANTVECTOR:
-        return value_.variantVector_ == rhs.value_.variantVector_;
+        return *value_.variantVector_ == *rhs.value_.variantVector_;
 
     case VAR_STRINGVECTOR:
-        return value_.stringVector_ == rhs.value_.stringVector_;
+        return *value_.stringVector_ == *rhs.value_.stringVector_;
 
     case VAR_VARIANTMAP:
-        return value_.variantMap_ == rhs.value_.variantMap_;
+        return *value_.variantMap_ == *rhs.value_.variantMap_;
 
     case VAR_INTRECT:
         return value_.intRect_ == rhs.value_.intRect_;
@@ -238,7 +255,7 @@ bool Variant::operator ==(const Variant& rhs) const
 bool Variant::operator ==(const PODVector<unsigned char>& rhs) const
 {
     // Use strncmp() instead of PODVector<unsigned char>::operator ==()
-    const PODVector<unsigned char>& buffer = value_.buffer_;
+    const PODVector<unsigned char>& buffer = *value_.buffer_;
     return type_ == VAR_BUFFER && buffer.Size() == rhs.Size() ?
         strncmp(reinterpret_cast<const char*>(&buffer[0]), reinterpret_cast<const char*>(&rhs[0]), buffer.Size()) == 0 :
         false;
@@ -246,7 +263,7 @@ bool Variant::operator ==(const PODVector<unsigned char>& rhs) const
 
 bool Variant::operator ==(const VectorBuffer& rhs) const
 {
-    const PODVector<unsigned char>& buffer = value_.buffer_;
+    const PODVector<unsigned char>& buffer = *value_.buffer_;
     return type_ == VAR_BUFFER && buffer.Size() == rhs.GetSize() ?
         strncmp(reinterpret_cast<const char*>(&buffer[0]), reinterpret_cast<const char*>(rhs.GetData()), buffer.Size()) == 0 :
         false;
@@ -313,7 +330,7 @@ void Variant::FromString(VariantType type, const char* value)
 
     case VAR_BUFFER:
         SetType(VAR_BUFFER);
-        StringToBuffer(value_.buffer_, value);
+        StringToBuffer(*value_.buffer_, value);
         break;
 
     case VAR_VOIDPTR:
@@ -327,8 +344,8 @@ void Variant::FromString(VariantType type, const char* value)
         if (values.Size() == 2)
         {
             SetType(VAR_RESOURCEREF);
-            value_.resourceRef_.type_ = values[0];
-            value_.resourceRef_.name_ = values[1];
+            value_.resourceRef_->type_ = values[0];
+            value_.resourceRef_->name_ = values[1];
         }
         break;
     }
@@ -339,10 +356,10 @@ void Variant::FromString(VariantType type, const char* value)
         if (values.Size() >= 1)
         {
             SetType(VAR_RESOURCEREFLIST);
-            value_.resourceRefList_.type_ = values[0];
-            value_.resourceRefList_.names_.Resize(values.Size() - 1);
+            value_.resourceRefList_->type_ = values[0];
+            value_.resourceRefList_->names_.Resize(values.Size() - 1);
             for (unsigned i = 1; i < values.Size(); ++i)
-                value_.resourceRefList_.names_[i - 1] = values[i];
+                value_.resourceRefList_->names_[i - 1] = values[i];
         }
         break;
     }
@@ -395,7 +412,7 @@ void Variant::SetBuffer(const void* data, unsigned size)
         size = 0;
 
     SetType(VAR_BUFFER);
-    PODVector<unsigned char>& buffer = value_.buffer_;
+    PODVector<unsigned char>& buffer = *value_.buffer_;
     buffer.Resize(size);
     if (size)
         memcpy(&buffer[0], data, size);
@@ -429,7 +446,7 @@ void Variant::SetCustomVariantValue(const CustomVariantValue& value)
 
 VectorBuffer Variant::GetVectorBuffer() const
 {
-    return VectorBuffer(type_ == VAR_BUFFER ? value_.buffer_ : emptyBuffer);
+    return VectorBuffer(type_ == VAR_BUFFER ? *value_.buffer_ : emptyBuffer);
 }
 
 String Variant::GetTypeName() const
@@ -469,11 +486,11 @@ String Variant::ToString() const
         return value_.color_.ToString();
 
     case VAR_STRING:
-        return value_.string_;
+        return *value_.string_;
 
     case VAR_BUFFER:
         {
-            const PODVector<unsigned char>& buffer = value_.buffer_;
+            const PODVector<unsigned char>& buffer = *value_.buffer_;
             String ret;
             BufferToString(ret, buffer.Begin().ptr_, buffer.Size());
             return ret;
@@ -553,20 +570,20 @@ bool Variant::IsZero() const
         return value_.color_ == Color::WHITE;
 
     case VAR_STRING:
-        return value_.string_.Empty();
+        return value_.string_->Empty();
 
     case VAR_BUFFER:
-        return value_.buffer_.Empty();
+        return value_.buffer_->Empty();
 
     case VAR_VOIDPTR:
         return value_.voidPtr_ == nullptr;
 
     case VAR_RESOURCEREF:
-        return value_.resourceRef_.name_.Empty();
+        return value_.resourceRef_->name_.Empty();
 
     case VAR_RESOURCEREFLIST:
     {
-        const StringVector& names = value_.resourceRefList_.names_;
+        const StringVector& names = value_.resourceRefList_->names_;
         for (StringVector::ConstIterator i = names.Begin(); i != names.End(); ++i)
         {
             if (!i->Empty())
@@ -576,13 +593,13 @@ bool Variant::IsZero() const
     }
 
     case VAR_VARIANTVECTOR:
-        return value_.variantVector_.Empty();
+        return value_.variantVector_->Empty();
 
     case VAR_STRINGVECTOR:
-        return value_.stringVector_.Empty();
+        return value_.stringVector_->Empty();
 
     case VAR_VARIANTMAP:
-        return value_.variantMap_.Empty();
+        return value_.variantMap_->Empty();
 
     case VAR_INTRECT:
         return value_.intRect_ == IntRect::ZERO;
@@ -628,31 +645,31 @@ void Variant::SetType(VariantType newType)
     switch (type_)
     {
     case VAR_STRING:
-        value_.string_.~String();
+        delete value_.string_;
         break;
 
     case VAR_BUFFER:
-        value_.buffer_.~PODVector<unsigned char>();
+        delete value_.buffer_;
         break;
 
     case VAR_RESOURCEREF:
-        value_.resourceRef_.~ResourceRef();
+        delete value_.resourceRef_;
         break;
 
     case VAR_RESOURCEREFLIST:
-        value_.resourceRefList_.~ResourceRefList();
+        delete value_.resourceRefList_;
         break;
 
     case VAR_VARIANTVECTOR:
-        value_.variantVector_.~VariantVector();
+        delete value_.variantVector_;
         break;
 
     case VAR_STRINGVECTOR:
-        value_.stringVector_.~StringVector();
+        delete value_.stringVector_;
         break;
 
     case VAR_VARIANTMAP:
-        value_.variantMap_.~VariantMap();
+        delete value_.variantMap_;
         break;
 
     case VAR_PTR:
@@ -688,31 +705,31 @@ void Variant::SetType(VariantType newType)
     switch (type_)
     {
     case VAR_STRING:
-        new(&value_.string_) String();
+        value_.string_ = new String();
         break;
 
     case VAR_BUFFER:
-        new(&value_.buffer_) PODVector<unsigned char>();
+        value_.buffer_ = new PODVector<unsigned char>();
         break;
 
     case VAR_RESOURCEREF:
-        new(&value_.resourceRef_) ResourceRef();
+        value_.resourceRef_ = new ResourceRef();
         break;
 
     case VAR_RESOURCEREFLIST:
-        new(&value_.resourceRefList_) ResourceRefList();
+        value_.resourceRefList_ = new ResourceRefList();
         break;
 
     case VAR_VARIANTVECTOR:
-        new(&value_.variantVector_) VariantVector();
+        value_.variantVector_ = new VariantVector();
         break;
 
     case VAR_STRINGVECTOR:
-        new(&value_.stringVector_) StringVector();
+        value_.stringVector_ = new StringVector();
         break;
 
     case VAR_VARIANTMAP:
-        new(&value_.variantMap_) VariantMap();
+        value_.variantMap_ = new VariantMap();
         break;
 
     case VAR_PTR:
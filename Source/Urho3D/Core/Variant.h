@@ -80,7 +80,7 @@ using VariantVector = Vector<Variant>;
 /// Vector of strings.
 using StringVector = Vector<String>;
 
-/// Map of variants.
+/// Map of variants. Uses node-based storage, so that references to the values stay valid while other keys are inserted, and iterates in insertion order.
 using VariantMap = HashMap<StringHash, Variant>;
 
 /// Typed resource reference.
@@ -272,10 +272,11 @@ private:
 /// Make custom variant value.
 template <typename T> CustomVariantValueImpl<T> MakeCustomValue(const T& value) { return CustomVariantValueImpl<T>(value); }
 
-/// Size of variant value. 16 bytes on 32-bit platform, 32 bytes on 64-bit platform.
-static const unsigned VARIANT_VALUE_SIZE = sizeof(void*) * 4;
+/// Size of variant value. Holds a Vector4, Quaternion, Color or WeakPtr inline.
+static const unsigned VARIANT_VALUE_SIZE = 16;
 
-/// Union for the possible variant values. Objects exceeding the VARIANT_VALUE_SIZE are allocated on the heap.
+/// Union for the possible variant values. Strings, containers, resource references, matrices and objects exceeding the
+/// VARIANT_VALUE_SIZE are allocated on the heap, so that copying small values stays cheap.
 union VariantValue
 {
     unsigned char storage_[VARIANT_VALUE_SIZE];
@@ -298,13 +299,13 @@ union VariantValue
     Matrix4* matrix4_;
     Quaternion quaternion_;
     Color color_;
-    String string_;
-    StringVector stringVector_;
-    VariantVector variantVector_;
-    VariantMap variantMap_;
-    PODVector<unsigned char> buffer_;
-    ResourceRef resourceRef_;
-    ResourceRefList resourceRefList_;
+    String* string_;
+    StringVector* stringVector_;
+    VariantVector* variantVector_;
+    VariantMap* variantMap_;
+    PODVector<unsigned char>* buffer_;
+    ResourceRef* resourceRef_;
+    ResourceRefList* resourceRefList_;
     CustomVariantValue* customValueHeap_;
     CustomVariantValue customValueStack_;
 
@@ -548,6 +549,12 @@ public:
         *this = value;
     }
 
+    /// Move-construct from another variant.
+    Variant(Variant&& value) noexcept
+    {
+        *this = std::move(value);
+    }
+
     /// Destruct.
     ~Variant()
     {
@@ -563,6 +570,9 @@ public:
     /// Assign from another variant.
     Variant& operator =(const Variant& rhs);
 
+    /// Move-assign from another variant. Heap allocated values are taken over without copying.
+    Variant& operator =(Variant&& rhs) noexcept;
+
     /// Assign from an integer.
     Variant& operator =(int rhs)
     {
@@ -671,7 +681,7 @@ public:
     Variant& operator =(const String& rhs)
     {
         SetType(VAR_STRING);
-        value_.string_ = rhs;
+        *value_.string_ = rhs;
         return *this;
     }
 
@@ -679,7 +689,7 @@ public:
     Variant& operator =(const char* rhs)
     {
         SetType(VAR_STRING);
-        value_.string_ = rhs;
+        *value_.string_ = rhs;
         return *this;
     }
 
@@ -687,7 +697,7 @@ public:
     Variant& operator =(const PODVector<unsigned char>& rhs)
     {
         SetType(VAR_BUFFER);
-        value_.buffer_ = rhs;
+        *value_.buffer_ = rhs;
         return *this;
     }
 
@@ -706,7 +716,7 @@ public:
     Variant& operator =(const ResourceRef& rhs)
     {
         SetType(VAR_RESOURCEREF);
-        value_.resourceRef_ = rhs;
+        *value_.resourceRef_ = rhs;
         return *this;
     }
 
@@ -714,7 +724,7 @@ public:
     Variant& operator =(const ResourceRefList& rhs)
     {
         SetType(VAR_RESOURCEREFLIST);
-        value_.resourceRefList_ = rhs;
+        *value_.resourceRefList_ = rhs;
         return *this;
     }
 
@@ -722,7 +732,7 @@ public:
     Variant& operator =(const VariantVector& rhs)
     {
         SetType(VAR_VARIANTVECTOR);
-        value_.variantVector_ = rhs;
+        *value_.variantVector_ = rhs;
         return *this;
     }
 
@@ -730,7 +740,7 @@ public:
     Variant& operator =(const StringVector& rhs)
     {
         SetType(VAR_STRINGVECTOR);
-        value_.stringVector_ = rhs;
+        *value_.stringVector_ = rhs;
         return *this;
     }
 
@@ -738,7 +748,7 @@ public:
     Variant& operator =(const VariantMap& rhs)
     {
         SetType(VAR_VARIANTMAP);
-        value_.variantMap_ = rhs;
+        *value_.variantMap_ = rhs;
         return *this;
     }
 
@@ -871,7 +881,7 @@ public:
     /// Test for equality with a string. To return true, both the type and value must match.
     bool operator ==(const String& rhs) const
     {
-        return type_ == VAR_STRING ? value_.string_ == rhs : false;
+        return type_ == VAR_STRING ? *value_.string_ == rhs : false;
     }
 
     /// Test for equality with a buffer. To return true, both the type and value must match.
@@ -893,31 +903,31 @@ public:
     /// Test for equality with a resource reference. To return true, both the type and value must match.
     bool operator ==(const ResourceRef& rhs) const
     {
-        return type_ == VAR_RESOURCEREF ? value_.resourceRef_ == rhs : false;
+        return type_ == VAR_RESOURCEREF ? *value_.resourceRef_ == rhs : false;
     }
 
     /// Test for equality with a resource reference list. To return true, both the type and value must match.
     bool operator ==(const ResourceRefList& rhs) const
     {
-        return type_ == VAR_RESOURCEREFLIST ? value_.resourceRefList_ == rhs : false;
+        return type_ == VAR_RESOURCEREFLIST ? *value_.resourceRefList_ == rhs : false;
     }
 
     /// Test for equality with a variant vector. To return true, both the type and value must match.
     bool operator ==(const VariantVector& rhs) const
     {
-        return type_ == VAR_VARIANTVECTOR ? value_.variantVector_ == rhs : false;
+        return type_ == VAR_VARIANTVECTOR ? *value_.variantVector_ == rhs : false;
     }
 
     /// Test for equality with a string vector. To return true, both the type and value must match.
     bool operator ==(const StringVector& rhs) const
     {
-        return type_ == VAR_STRINGVECTOR ? value_.stringVector_ == rhs : false;
+        return type_ == VAR_STRINGVECTOR ? *value_.stringVector_ == rhs : false;
     }
 
     /// Test for equality with a variant map. To return true, both the type and value must match.
     bool operator ==(const VariantMap& rhs) const
     {
-        return type_ == VAR_VARIANTMAP ? value_.variantMap_ == rhs : false;
+        return type_ == VAR_VARIANTMAP ? *value_.variantMap_ == rhs : false;
     }
 
     /// Test for equality with a rect. To return true, both the type and value must match.
@@ -1192,12 +1202,12 @@ public:
     const Color& GetColor() const { return (type_ == VAR_COLOR || type_ == VAR_VECTOR4) ? value_.color_ : Color::WHITE; }
 
     /// Return string or empty on type mismatch.
-    const String& GetString() const { return type_ == VAR_STRING ? value_.string_ : String::EMPTY; }
+    const String& GetString() const { return type_ == VAR_STRING ? *value_.string_ : String::EMPTY; }
 
     /// Return buffer or empty on type mismatch.
     const PODVector<unsigned char>& GetBuffer() const
     {
-        return type_ == VAR_BUFFER ? value_.buffer_ : emptyBuffer;
+        return type_ == VAR_BUFFER ? *value_.buffer_ : emptyBuffer;
     }
 
     /// Return %VectorBuffer containing the buffer or empty on type mismatch.
@@ -1217,31 +1227,31 @@ public:
     /// Return a resource reference or empty on type mismatch.
     const ResourceRef& GetResourceRef() const
     {
-        return type_ == VAR_RESOURCEREF ? value_.resourceRef_ : emptyResourceRef;
+        return type_ == VAR_RESOURCEREF ? *value_.resourceRef_ : emptyResourceRef;
     }
 
     /// Return a resource reference list or empty on type mismatch.
     const ResourceRefList& GetResourceRefList() const
     {
-        return type_ == VAR_RESOURCEREFLIST ? value_.resourceRefList_ : emptyResourceRefList;
+        return type_ == VAR_RESOURCEREFLIST ? *value_.resourceRefList_ : emptyResourceRefList;
     }
 
     /// Return a variant vector or empty on type mismatch.
     const VariantVector& GetVariantVector() const
     {
-        return type_ == VAR_VARIANTVECTOR ? value_.variantVector_ : emptyVariantVector;
+        return type_ == VAR_VARIANTVECTOR ? *value_.variantVector_ : emptyVariantVector;
     }
 
     /// Return a string vector or empty on type mismatch.
     const StringVector& GetStringVector() const
     {
-        return type_ == VAR_STRINGVECTOR ? value_.stringVector_ : emptyStringVector;
+        return type_ == VAR_STRINGVECTOR ? *value_.stringVector_ : emptyStringVector;
     }
 
     /// Return a variant map or empty on type mismatch.
     const VariantMap& GetVariantMap() const
     {
-        return type_ == VAR_VARIANTMAP ? value_.variantMap_ : emptyVariantMap;
+        return type_ == VAR_VARIANTMAP ? *value_.variantMap_ : emptyVariantMap;
     }
 
     /// Return a rect or empty on type mismatch.
@@ -1345,17 +1355,17 @@ public:
     /// Return a pointer to a modifiable buffer or null on type mismatch.
     PODVector<unsigned char>* GetBufferPtr()
     {
-        return type_ == VAR_BUFFER ? &value_.buffer_ : nullptr;
+        return type_ == VAR_BUFFER ? value_.buffer_ : nullptr;
     }
 
     /// Return a pointer to a modifiable variant vector or null on type mismatch.
-    VariantVector* GetVariantVectorPtr() { return type_ == VAR_VARIANTVECTOR ? &value_.variantVector_ : nullptr; }
+    VariantVector* GetVariantVectorPtr() { return type_ == VAR_VARIANTVECTOR ? value_.variantVector_ : nullptr; }
 
     /// Return a pointer to a modifiable string vector or null on type mismatch.
-    StringVector* GetStringVectorPtr() { return type_ == VAR_STRINGVECTOR ? &value_.stringVector_ : nullptr; }
+    StringVector* GetStringVectorPtr() { return type_ == VAR_STRINGVECTOR ? value_.stringVector_ : nullptr; }
 
     /// Return a pointer to a modifiable variant map or null on type mismatch.
-    VariantMap* GetVariantMapPtr() { return type_ == VAR_VARIANTMAP ? &value_.variantMap_ : nullptr; }
+    VariantMap* GetVariantMapPtr() { return type_ == VAR_VARIANTMAP ? value_.variantMap_ : nullptr; }
 
     /// Return a pointer to a modifiable custom variant value or null on type mismatch.
     template <class T> T* GetCustomPtr()
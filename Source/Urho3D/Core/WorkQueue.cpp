@@ -23,22 +23,112 @@
 #include "../Precompiled.h"
 
 #include "../Core/CoreEvents.h"
+#include "../Core/PerfCounters.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
+#include "../Container/Sort.h"
 #include "../IO/Log.h"
+#include "../IO/Serializer.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
 
 namespace Urho3D
 {
 
+struct WorkPool;
+
+/// Executions of one work function since the telemetry was last collected.
+struct WorkFunctionSamples
+{
+    /// Name of the work items.
+    const char* name_{};
+    /// Number of executions.
+    unsigned count_{};
+    /// Total execution time in microseconds.
+    long long totalUSec_{};
+    /// Longest execution time in microseconds.
+    long long maxUSec_{};
+    /// Execution time histogram.
+    unsigned buckets_[NUM_WORK_DURATION_BUCKETS]{};
+};
+
+/// Telemetry recorded by one thread, and taken by the main thread at frame begin.
+struct WorkerTelemetry : public RefCounted
+{
+    /// Record the execution of a work function.
+    void AddExecution(unsigned long long function, const char* name, long long usec)
+    {
+        unsigned bucket = 0;
+        while (bucket < NUM_WORK_DURATION_BUCKETS - 1 && usec >= (1LL << bucket))
+            ++bucket;
+
+        MutexLock lock(mutex_);
+        busyUSec_ += usec;
+        ++numItems_;
+
+        WorkFunctionSamples& samples = functions_[function];
+        if (name)
+            samples.name_ = name;
+        ++samples.count_;
+        samples.totalUSec_ += usec;
+        samples.maxUSec_ = Max(samples.maxUSec_, usec);
+        ++samples.buckets_[bucket];
+    }
+
+    /// Clear the statistics.
+    void Reset()
+    {
+        MutexLock lock(mutex_);
+        busyUSec_ = 0;
+        lockWaitUSec_ = 0;
+        numItems_ = 0;
+        functions_.Clear();
+    }
+
+    /// Record a wait for the shared queue mutex.
+    void AddLockWait(long long usec)
+    {
+        MutexLock lock(mutex_);
+        lockWaitUSec_ += usec;
+    }
+
+    /// Mutex for the statistics.
+    Mutex mutex_;
+    /// Time spent executing work since last collected.
+    long long busyUSec_{};
+    /// Time spent waiting for the queue mutex since last collected.
+    long long lockWaitUSec_{};
+    /// Number of executions since last collected.
+    unsigned numItems_{};
+    /// Executions per work function address since last collected. The entries are kept to avoid allocating on every frame.
+    HashMap<unsigned long long, WorkFunctionSamples> functions_;
+};
+
+/// Telemetry of the worker or pool thread running on this thread.
+static thread_local WorkerTelemetry* threadTelemetry = nullptr;
+
+/// Names of the work classes in the telemetry output.
+static const char* workClassNames[] =
+{
+    "critical",
+    "background",
+    "low",
+    nullptr
+};
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
 public:
-    /// Construct.
-    WorkerThread(WorkQueue* owner, unsigned index) :
+    /// Construct. A pool thread executes only the items of its pool.
+    WorkerThread(WorkQueue* owner, unsigned index, WorkPool* pool = nullptr) :
         owner_(owner),
-        index_(index)
+        index_(index),
+        pool_(pool),
+        telemetry_(new WorkerTelemetry())
     {
     }
 
@@ -47,29 +137,114 @@ public:
     {
         // Init FPU state first
         InitFPU();
-        owner_->ProcessItems(index_);
+        threadTelemetry = telemetry_;
+        if (pool_)
+            owner_->ProcessPoolItems(pool_, index_);
+        else
+            owner_->ProcessItems(index_);
     }
 
     /// Return thread index.
     unsigned GetIndex() const { return index_; }
 
+    /// Return telemetry of the thread.
+    WorkerTelemetry* GetTelemetry() const { return telemetry_; }
+
 private:
     /// Work queue.
     WorkQueue* owner_;
     /// Thread index.
     unsigned index_;
+    /// Pool, or null for a critical worker thread.
+    WorkPool* pool_;
+    /// Telemetry of the thread.
+    SharedPtr<WorkerTelemetry> telemetry_;
 };
 
+/// Job queue owned by one thread. The owner pushes and pops at the back, other threads steal from the front.
+struct JobDeque : public RefCounted
+{
+    /// Queue mutex.
+    Mutex mutex_;
+    /// Ready jobs.
+    PODVector<WorkItem*> items_;
+    /// Number of ready jobs. Updated under the mutex, read without it to skip empty queues.
+    std::atomic<unsigned> size_{};
+};
+
+/// Thread pool of a non-critical work class. The threads sleep on the condition instead of spinning, as the work is not waited on by the frame.
+struct WorkPool : public RefCounted
+{
+    /// Queue mutex.
+    std::mutex mutex_;
+    /// Condition signaled when items are added or the queue shuts down.
+    std::condition_variable condition_;
+    /// Prioritized queue.
+    List<WorkItem*> queue_;
+    /// Pool threads.
+    Vector<SharedPtr<WorkerThread> > threads_;
+    /// Requested number of threads, zero for automatic.
+    unsigned numThreads_{};
+};
+
+/// Insert a work item to a queue ordered by descending priority.
+static void InsertByPriority(List<WorkItem*>& queue, WorkItem* item)
+{
+    for (List<WorkItem*>::Iterator i = queue.Begin(); i != queue.End(); ++i)
+    {
+        if ((*i)->priority_ <= item->priority_)
+        {
+            queue.Insert(i, item);
+            return;
+        }
+    }
+
+    queue.Push(item);
+}
+
+/// Return the number of logical CPUs in a mask.
+static unsigned CountCores(unsigned long long mask)
+{
+    return CountSetBits((unsigned)mask) + CountSetBits((unsigned)(mask >> 32u));
+}
+
+void WorkItem::AddDependency(WorkItem* dependency)
+{
+    if (!dependency || dependency == this)
+        return;
+
+    dependency->dependents_.Push(this);
+    ++pendingDependencies_;
+}
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    nextPoolThreadIndex_(1),
+    numPendingJobs_(0),
+    nextJobDeque_(0),
     shutDown_(false),
     pausing_(false),
     paused_(false),
     completing_(false),
     tolerance_(10),
     lastSize_(0),
-    maxNonThreadedWorkMs_(5)
+    maxNonThreadedWorkMs_(5),
+    corePinning_(true),
+    telemetry_(false),
+    mainTelemetry_(new WorkerTelemetry()),
+    completeWaitUSec_(0),
+    maxQueueDepth_(0),
+    firstTelemetryFrame_(0),
+    telemetryHistorySize_(300)
 {
+    jobDeques_.Push(SharedPtr<JobDeque>(new JobDeque()));
+    for (unsigned i = 0; i < MAX_WORK_CLASSES; ++i)
+        pools_.Push(SharedPtr<WorkPool>(new WorkPool()));
+
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (perfCounters)
+        occupancyCounter_ = perfCounters->GetCounter("WorkQueueOccupancy", PCT_GAUGE);
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -81,6 +256,17 @@ WorkQueue::~WorkQueue()
 
     for (unsigned i = 0; i < threads_.Size(); ++i)
         threads_[i]->Stop();
+
+    for (unsigned i = 0; i < pools_.Size(); ++i)
+    {
+        WorkPool* pool = pools_[i];
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex_);
+        }
+        pool->condition_.notify_all();
+        for (unsigned j = 0; j < pool->threads_.Size(); ++j)
+            pool->threads_[j]->Stop();
+    }
 }
 
 void WorkQueue::CreateThreads(unsigned numThreads)
@@ -94,12 +280,24 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     // Start threads in paused mode
     Pause();
 
+    for (unsigned i = 0; i < numThreads; ++i)
+        jobDeques_.Push(SharedPtr<JobDeque>(new JobDeque()));
+
+    // On a heterogeneous CPU keep as many workers on the performance cores as there are free besides the main thread,
+    // so that the critical work is not delayed by a slow core. The rest may run anywhere
+    unsigned long long performanceMask = GetPerformanceCoreMask();
+    unsigned numPinned = corePinning_ && GetEfficiencyCoreMask() ? CountCores(performanceMask) - 1 : 0;
+
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
+        if (i < numPinned)
+            thread->SetAffinityMask(performanceMask);
         thread->Run();
         threads_.Push(thread);
     }
+
+    nextPoolThreadIndex_ = numThreads + 1;
 #else
     URHO3D_LOGERROR("Can not create worker threads as threading is disabled");
 #endif
@@ -138,36 +336,66 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     workItems_.Push(item);
     item->completed_ = false;
 
+    // Non-critical items go to the thread pool of their class. Without worker threads they are executed like critical items
+    if (item->workClass_ > WORK_CRITICAL && item->workClass_ < MAX_WORK_CLASSES && threads_.Size())
+    {
+        WorkPool* pool = GetPool(item->workClass_);
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex_);
+            InsertByPriority(pool->queue_, item);
+        }
+        pool->condition_.notify_one();
+        return;
+    }
+
     // Make sure worker threads' list is safe to modify
     if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
+        AcquireQueue(0);
 
     // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
+    InsertByPriority(queue_, item);
+
+    if (threads_.Size())
     {
-        bool inserted = false;
+        queueMutex_.Release();
+        paused_ = false;
+    }
 
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
-        {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.Insert(i, item);
-                inserted = true;
-                break;
-            }
-        }
+    if (telemetry_.load(std::memory_order_relaxed))
+        UpdateMaxQueueDepth();
+}
 
-        if (!inserted)
-            queue_.Push(item);
+void WorkQueue::AddJob(const SharedPtr<WorkItem>& item)
+{
+    if (!item)
+    {
+        URHO3D_LOGERROR("Null job submitted to the work queue");
+        return;
     }
 
-    if (threads_.Size())
+    assert(!workItems_.Contains(item));
+
+    workItems_.Push(item);
+    item->completed_ = false;
+    item->job_ = true;
+    ++numPendingJobs_;
+
+    // Release the submission reference. If no dependencies are pending, distribute to the worker queues in turn
+    if (--item->pendingDependencies_ == 0)
     {
-        queueMutex_.Release();
-        paused_ = false;
+        unsigned threadIndex = 0;
+        if (threads_.Size())
+        {
+            threadIndex = nextJobDeque_ % threads_.Size() + 1;
+            ++nextJobDeque_;
+        }
+        PushJob(item, threadIndex);
     }
+
+    if (telemetry_.load(std::memory_order_relaxed))
+        UpdateMaxQueueDepth();
+
+    Resume();
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -178,20 +406,19 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
     MutexLock lock(queueMutex_);
 
     // Can only remove successfully if the item was not yet taken by threads for execution
+    List<SharedPtr<WorkItem> >::Iterator j = workItems_.Find(item);
+    if (j == workItems_.End())
+        return false;
+
     List<WorkItem*>::Iterator i = queue_.Find(item.Get());
     if (i != queue_.End())
-    {
-        List<SharedPtr<WorkItem> >::Iterator j = workItems_.Find(item);
-        if (j != workItems_.End())
-        {
-            queue_.Erase(i);
-            ReturnToPool(item);
-            workItems_.Erase(j);
-            return true;
-        }
-    }
+        queue_.Erase(i);
+    else if (!RemoveFromPools(item.Get()))
+        return false;
 
-    return false;
+    ReturnToPool(item);
+    workItems_.Erase(j);
+    return true;
 }
 
 unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
@@ -201,18 +428,19 @@ unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
 
     for (Vector<SharedPtr<WorkItem> >::ConstIterator i = items.Begin(); i != items.End(); ++i)
     {
+        List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(*i);
+        if (k == workItems_.End())
+            continue;
+
         List<WorkItem*>::Iterator j = queue_.Find(i->Get());
         if (j != queue_.End())
-        {
-            List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(*i);
-            if (k != workItems_.End())
-            {
-                queue_.Erase(j);
-                ReturnToPool(*k);
-                workItems_.Erase(k);
-                ++removed;
-            }
-        }
+            queue_.Erase(j);
+        else if (!RemoveFromPools(i->Get()))
+            continue;
+
+        ReturnToPool(*k);
+        workItems_.Erase(k);
+        ++removed;
     }
 
     return removed;
@@ -252,13 +480,13 @@ void WorkQueue::Complete(unsigned priority)
         // Take work items also in the main thread until queue empty or no high-priority items anymore
         while (!queue_.Empty())
         {
-            queueMutex_.Acquire();
+            AcquireQueue(0);
             if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
             {
                 WorkItem* item = queue_.Front();
                 queue_.PopFront();
                 queueMutex_.Release();
-                item->workFunction_(item, 0);
+                ExecuteItem(item, 0);
                 item->completed_ = true;
             }
             else
@@ -268,24 +496,41 @@ void WorkQueue::Complete(unsigned priority)
             }
         }
 
-        // Wait for threaded work to complete
+        // Wait for threaded work to complete. Help with jobs as they become ready. The jobs executed here are not waiting
+        bool telemetry = telemetry_.load(std::memory_order_relaxed);
+        long long busyUSec = mainTelemetry_->busyUSec_;
+        HiresTimer waitTimer;
+
         while (!IsCompleted(priority))
         {
+            WorkItem* job = PopJob(0, priority);
+            if (job)
+                ExecuteJob(job, 0);
         }
 
+        if (telemetry)
+            completeWaitUSec_ += Max(waitTimer.GetUSec(false) - (mainTelemetry_->busyUSec_ - busyUSec), 0LL);
+
         // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.Empty())
+        if (queue_.Empty() && !numPendingJobs_)
             Pause();
     }
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+        for (;;)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+            {
+                WorkItem* item = queue_.Front();
+                queue_.PopFront();
+                ExecuteItem(item, 0);
+                item->completed_ = true;
+            }
+            else if (WorkItem* job = PopJob(0, priority))
+                ExecuteJob(job, 0);
+            else
+                break;
         }
     }
 
@@ -293,6 +538,69 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = false;
 }
 
+void WorkQueue::SetNumPoolThreads(WorkClass workClass, unsigned numThreads)
+{
+    if (workClass > WORK_CRITICAL && workClass < MAX_WORK_CLASSES)
+        pools_[workClass]->numThreads_ = numThreads;
+}
+
+unsigned WorkQueue::GetNumPoolThreads(WorkClass workClass) const
+{
+    return workClass > WORK_CRITICAL && workClass < MAX_WORK_CLASSES ? pools_[workClass]->threads_.Size() : 0;
+}
+
+void WorkQueue::SetTelemetry(bool enable)
+{
+    if (enable == telemetry_.load())
+        return;
+
+    if (enable)
+    {
+        // Discard what the threads recorded before telemetry was last disabled
+        mainTelemetry_->Reset();
+        for (unsigned i = 0; i < threads_.Size(); ++i)
+            threads_[i]->GetTelemetry()->Reset();
+        for (unsigned i = WORK_CRITICAL + 1; i < pools_.Size(); ++i)
+        {
+            const Vector<SharedPtr<WorkerThread> >& poolThreads = pools_[i]->threads_;
+            for (unsigned j = 0; j < poolThreads.Size(); ++j)
+                poolThreads[j]->GetTelemetry()->Reset();
+        }
+
+        telemetryFrames_.Clear();
+        firstTelemetryFrame_ = 0;
+        functionStats_.Clear();
+        completeWaitUSec_ = 0;
+        maxQueueDepth_ = 0;
+        telemetryTimer_.Reset();
+
+        auto* perfCounters = GetSubsystem<PerfCounters>();
+        if (perfCounters && !utilizationCounter_)
+        {
+            utilizationCounter_ = perfCounters->GetCounter("WorkQueueUtilization", PCT_GAUGE);
+            completeWaitCounter_ = perfCounters->GetCounter("WorkQueueCompleteWaitMs", PCT_GAUGE);
+            lockWaitCounter_ = perfCounters->GetCounter("WorkQueueLockWaitMs", PCT_GAUGE);
+        }
+    }
+
+    telemetry_ = enable;
+}
+
+void WorkQueue::SetTelemetryHistorySize(unsigned size)
+{
+    telemetryHistorySize_ = Max(size, 1U);
+    telemetryFrames_.Clear();
+    firstTelemetryFrame_ = 0;
+}
+
+const WorkQueueTelemetryFrame* WorkQueue::GetTelemetryFrame(unsigned index) const
+{
+    if (index >= telemetryFrames_.Size())
+        return nullptr;
+
+    return &telemetryFrames_[(firstTelemetryFrame_ + index) % telemetryFrames_.Size()];
+}
+
 bool WorkQueue::IsCompleted(unsigned priority) const
 {
     for (List<SharedPtr<WorkItem> >::ConstIterator i = workItems_.Begin(); i != workItems_.End(); ++i)
@@ -313,11 +621,20 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
         if (shutDown_)
             return;
 
+        // Jobs in the own queue or stealable from other threads take precedence over the shared queue
+        WorkItem* job = PopJob(threadIndex, 0);
+        if (job)
+        {
+            wasActive = true;
+            ExecuteJob(job, threadIndex);
+            continue;
+        }
+
         if (pausing_ && !wasActive)
             Time::Sleep(0);
         else
         {
-            queueMutex_.Acquire();
+            AcquireQueue(threadIndex);
             if (!queue_.Empty())
             {
                 wasActive = true;
@@ -325,7 +642,10 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
                 WorkItem* item = queue_.Front();
                 queue_.PopFront();
                 queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
+                {
+                    URHO3D_PROFILE(ExecuteWorkItem);
+                    ExecuteItem(item, threadIndex);
+                }
                 item->completed_ = true;
             }
             else
@@ -339,6 +659,78 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
     }
 }
 
+void WorkQueue::ProcessPoolItems(WorkPool* pool, unsigned threadIndex)
+{
+    for (;;)
+    {
+        WorkItem* item;
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex_);
+            pool->condition_.wait(lock, [&] { return shutDown_ || !pool->queue_.Empty(); });
+            if (shutDown_)
+                return;
+
+            item = pool->queue_.Front();
+            pool->queue_.PopFront();
+        }
+
+        {
+            URHO3D_PROFILE(ExecuteWorkItem);
+            ExecuteItem(item, threadIndex);
+        }
+        item->completed_ = true;
+    }
+}
+
+WorkPool* WorkQueue::GetPool(WorkClass workClass)
+{
+    WorkPool* pool = pools_[workClass];
+    if (!pool->threads_.Empty())
+        return pool;
+
+    // Background work mostly waits for I/O, so a couple of threads suffice. Low-priority work gets the efficiency cores,
+    // or half as many threads as the critical work on a homogeneous CPU
+    unsigned long long efficiencyMask = corePinning_ ? GetEfficiencyCoreMask() : 0;
+    unsigned numThreads = pool->numThreads_;
+    if (!numThreads)
+    {
+        if (workClass == WORK_BACKGROUND)
+            numThreads = 2;
+        else
+            numThreads = efficiencyMask ? CountCores(efficiencyMask) : Max(threads_.Size() / 2, 1U);
+    }
+
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        SharedPtr<WorkerThread> thread(new WorkerThread(this, nextPoolThreadIndex_++, pool));
+        if (efficiencyMask)
+            thread->SetAffinityMask(efficiencyMask);
+        if (workClass == WORK_LOW)
+            thread->SetPriorityClass(TP_LOW);
+        thread->Run();
+        pool->threads_.Push(thread);
+    }
+
+    return pool;
+}
+
+bool WorkQueue::RemoveFromPools(WorkItem* item)
+{
+    for (unsigned i = WORK_CRITICAL + 1; i < pools_.Size(); ++i)
+    {
+        WorkPool* pool = pools_[i];
+        std::lock_guard<std::mutex> lock(pool->mutex_);
+        List<WorkItem*>::Iterator j = pool->queue_.Find(item);
+        if (j != pool->queue_.End())
+        {
+            pool->queue_.Erase(j);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void WorkQueue::PurgeCompleted(unsigned priority)
 {
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
@@ -390,16 +782,147 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->end_ = nullptr;
         item->aux_ = nullptr;
         item->workFunction_ = nullptr;
+        item->name_ = nullptr;
         item->priority_ = M_MAX_UNSIGNED;
+        item->workClass_ = WORK_CRITICAL;
         item->sendEvent_ = false;
         item->completed_ = false;
+        item->job_ = false;
+        item->dependents_.Clear();
+        item->pendingDependencies_ = 1;
 
         poolItems_.Push(item);
     }
 }
 
+void WorkQueue::PushJob(WorkItem* item, unsigned threadIndex)
+{
+    JobDeque& deque = *jobDeques_[threadIndex];
+    MutexLock lock(deque.mutex_);
+    deque.items_.Push(item);
+    deque.size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+WorkItem* WorkQueue::PopJob(unsigned threadIndex, unsigned priority)
+{
+    // Own queue first, newest job first for cache locality
+    JobDeque& own = *jobDeques_[threadIndex];
+    if (own.size_.load(std::memory_order_relaxed))
+    {
+        MutexLock lock(own.mutex_);
+        if (!own.items_.Empty() && own.items_.Back()->priority_ >= priority)
+        {
+            WorkItem* item = own.items_.Back();
+            own.items_.Pop();
+            own.size_.fetch_sub(1, std::memory_order_relaxed);
+            return item;
+        }
+    }
+
+    // Then steal the oldest job from the other threads. Do not block on a contended queue, rather try the next one
+    unsigned numDeques = jobDeques_.Size();
+    for (unsigned i = 1; i < numDeques; ++i)
+    {
+        JobDeque& victim = *jobDeques_[(threadIndex + i) % numDeques];
+        if (!victim.size_.load(std::memory_order_relaxed) || !victim.mutex_.TryAcquire())
+            continue;
+
+        WorkItem* item = nullptr;
+        if (!victim.items_.Empty() && victim.items_.Front()->priority_ >= priority)
+        {
+            item = victim.items_.Front();
+            victim.items_.Erase(0);
+            victim.size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        victim.mutex_.Release();
+
+        if (item)
+            return item;
+    }
+
+    return nullptr;
+}
+
+void WorkQueue::ExecuteJob(WorkItem* item, unsigned threadIndex)
+{
+    {
+        URHO3D_PROFILE(ExecuteJob);
+        ExecuteItem(item, threadIndex);
+    }
+
+    // Dependents that became ready go to this thread's queue, as they are likely to use the same data
+    for (PODVector<WorkItem*>::ConstIterator i = item->dependents_.Begin(); i != item->dependents_.End(); ++i)
+    {
+        if (--(*i)->pendingDependencies_ == 0)
+            PushJob(*i, threadIndex);
+    }
+
+    // Re-arm the item, so that it can be resubmitted even if it is not a pooled item
+    item->dependents_.Clear();
+    item->pendingDependencies_ = 1;
+
+    --numPendingJobs_;
+    item->completed_ = true;
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    if (!telemetry_.load(std::memory_order_relaxed))
+    {
+        item->workFunction_(item, threadIndex);
+        return;
+    }
+
+    void (* function)(const WorkItem*, unsigned) = item->workFunction_;
+    const char* name = item->name_;
+
+    HiresTimer timer;
+    function(item, threadIndex);
+    long long usec = timer.GetUSec(false);
+
+    // Thread index 0 is always the main thread, other threads have their own telemetry
+    WorkerTelemetry* telemetry = threadIndex ? threadTelemetry : mainTelemetry_.Get();
+    if (telemetry)
+        telemetry->AddExecution((unsigned long long)reinterpret_cast<size_t>(function), name, usec);
+}
+
+void WorkQueue::AcquireQueue(unsigned threadIndex)
+{
+    if (!telemetry_.load(std::memory_order_relaxed))
+    {
+        queueMutex_.Acquire();
+        return;
+    }
+
+    if (queueMutex_.TryAcquire())
+        return;
+
+    // While the queue is paused the workers are idle rather than contending
+    bool paused = paused_;
+    HiresTimer timer;
+    queueMutex_.Acquire();
+
+    WorkerTelemetry* telemetry = threadIndex ? threadTelemetry : mainTelemetry_.Get();
+    if (telemetry && !paused)
+        telemetry->AddLockWait(timer.GetUSec(false));
+}
+
+void WorkQueue::UpdateMaxQueueDepth()
+{
+    maxQueueDepth_ = Max(maxQueueDepth_, queue_.Size() + numPendingJobs_.load());
+}
+
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
+    if (occupancyCounter_)
+    {
+        MutexLock lock(queueMutex_);
+        occupancyCounter_->Set(queue_.Size() + numPendingJobs_.load());
+    }
+
+    if (telemetry_.load(std::memory_order_relaxed))
+        EndTelemetryFrame();
+
     // If no worker threads, complete low-priority work here
     if (threads_.Empty() && !queue_.Empty())
     {
@@ -411,14 +934,269 @@ void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
         {
             WorkItem* item = queue_.Front();
             queue_.PopFront();
-            item->workFunction_(item, 0);
+            ExecuteItem(item, 0);
             item->completed_ = true;
         }
     }
 
+    if (threads_.Empty() && numPendingJobs_)
+    {
+        URHO3D_PROFILE(CompleteJobsNonthreaded);
+
+        HiresTimer timer;
+
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
+        {
+            WorkItem* job = PopJob(0, 0);
+            if (!job)
+                break;
+            ExecuteJob(job, 0);
+        }
+    }
+
     // Complete and signal items down to the lowest priority
     PurgeCompleted(0);
     PurgePool();
 }
 
+void WorkQueue::EndTelemetryFrame()
+{
+    WorkQueueTelemetryFrame frame;
+    frame.frameUSec_ = telemetryTimer_.GetUSec(true);
+    frame.completeWaitUSec_ = completeWaitUSec_;
+    {
+        MutexLock lock(queueMutex_);
+        frame.queueDepth_ = queue_.Size() + numPendingJobs_.load();
+    }
+    frame.maxQueueDepth_ = Max(maxQueueDepth_, frame.queueDepth_);
+    completeWaitUSec_ = 0;
+    maxQueueDepth_ = frame.queueDepth_;
+
+    CollectTelemetry(mainTelemetry_, 0, WORK_CRITICAL, frame);
+    for (unsigned i = 0; i < threads_.Size(); ++i)
+        CollectTelemetry(threads_[i]->GetTelemetry(), threads_[i]->GetIndex(), WORK_CRITICAL, frame);
+    for (unsigned i = WORK_CRITICAL + 1; i < pools_.Size(); ++i)
+    {
+        const Vector<SharedPtr<WorkerThread> >& poolThreads = pools_[i]->threads_;
+        for (unsigned j = 0; j < poolThreads.Size(); ++j)
+            CollectTelemetry(poolThreads[j]->GetTelemetry(), poolThreads[j]->GetIndex(), (WorkClass)i, frame);
+    }
+
+    if (utilizationCounter_)
+    {
+        // Utilization is averaged over the critical worker threads, as the main thread has other work and the pool threads
+        // are expected to idle
+        long long busyUSec = 0;
+        long long lockWaitUSec = 0;
+        for (unsigned i = 0; i < frame.threads_.Size(); ++i)
+        {
+            const WorkThreadStats& stats = frame.threads_[i];
+            if (stats.threadIndex_ && stats.workClass_ == WORK_CRITICAL)
+                busyUSec += stats.busyUSec_;
+            lockWaitUSec += stats.lockWaitUSec_;
+        }
+
+        double workerUSec = (double)frame.frameUSec_ * threads_.Size();
+        utilizationCounter_->Set(workerUSec > 0.0 ? 100.0 * busyUSec / workerUSec : 0.0);
+        completeWaitCounter_->Set(frame.completeWaitUSec_ / 1000.0);
+        lockWaitCounter_->Set(lockWaitUSec / 1000.0);
+    }
+
+    if (telemetryFrames_.Size() < telemetryHistorySize_)
+        telemetryFrames_.Push(frame);
+    else
+    {
+        telemetryFrames_[firstTelemetryFrame_] = frame;
+        firstTelemetryFrame_ = (firstTelemetryFrame_ + 1) % telemetryFrames_.Size();
+    }
+}
+
+void WorkQueue::CollectTelemetry(WorkerTelemetry* telemetry, unsigned threadIndex, WorkClass workClass, WorkQueueTelemetryFrame& frame)
+{
+    WorkThreadStats stats;
+    stats.threadIndex_ = threadIndex;
+    stats.workClass_ = workClass;
+
+    MutexLock lock(telemetry->mutex_);
+    stats.busyUSec_ = telemetry->busyUSec_;
+    stats.lockWaitUSec_ = telemetry->lockWaitUSec_;
+    stats.numItems_ = telemetry->numItems_;
+    telemetry->busyUSec_ = 0;
+    telemetry->lockWaitUSec_ = 0;
+    telemetry->numItems_ = 0;
+
+    for (HashMap<unsigned long long, WorkFunctionSamples>::Iterator i = telemetry->functions_.Begin();
+        i != telemetry->functions_.End(); ++i)
+    {
+        WorkFunctionSamples& samples = i->second_;
+        if (!samples.count_)
+            continue;
+
+        WorkFunctionStats& functionStats = functionStats_[i->first_];
+        if (samples.name_ && functionStats.name_ != samples.name_)
+            functionStats.name_ = samples.name_;
+        else if (functionStats.name_.Empty())
+        {
+            char address[32];
+            sprintf(address, "0x%llx", i->first_);
+            functionStats.name_ = address;
+        }
+
+        functionStats.count_ += samples.count_;
+        functionStats.totalUSec_ += samples.totalUSec_;
+        functionStats.maxUSec_ = Max(functionStats.maxUSec_, samples.maxUSec_);
+        for (unsigned j = 0; j < NUM_WORK_DURATION_BUCKETS; ++j)
+            functionStats.buckets_[j] += samples.buckets_[j];
+
+        samples = WorkFunctionSamples();
+    }
+
+    frame.threads_.Push(stats);
+}
+
+static bool CompareWorkFunctionStats(const WorkFunctionStats& lhs, const WorkFunctionStats& rhs)
+{
+    return lhs.totalUSec_ > rhs.totalUSec_;
+}
+
+Vector<WorkFunctionStats> WorkQueue::GetWorkFunctionStats() const
+{
+    Vector<WorkFunctionStats> ret = functionStats_.Values();
+    Sort(ret.Begin(), ret.End(), CompareWorkFunctionStats);
+    return ret;
+}
+
+String WorkQueue::PrintTelemetry(unsigned maxFunctions) const
+{
+    unsigned numFrames = telemetryFrames_.Size();
+    if (!numFrames)
+        return telemetry_.load() ? "No work queue telemetry collected yet\n" : "Work queue telemetry disabled\n";
+
+    long long totalFrameUSec = 0;
+    long long totalCompleteWaitUSec = 0;
+    long long maxCompleteWaitUSec = 0;
+    long long totalQueueDepth = 0;
+    unsigned maxQueueDepth = 0;
+    // Sums per thread index, with the frame time of the frames the thread existed in as the busy time's reference
+    Vector<WorkThreadStats> threadTotals;
+    PODVector<long long> threadFrameUSec;
+    PODVector<unsigned> threadFrames;
+
+    for (unsigned i = 0; i < numFrames; ++i)
+    {
+        const WorkQueueTelemetryFrame& frame = *GetTelemetryFrame(i);
+        totalFrameUSec += frame.frameUSec_;
+        totalCompleteWaitUSec += frame.completeWaitUSec_;
+        maxCompleteWaitUSec = Max(maxCompleteWaitUSec, frame.completeWaitUSec_);
+        totalQueueDepth += frame.queueDepth_;
+        maxQueueDepth = Max(maxQueueDepth, frame.maxQueueDepth_);
+
+        for (unsigned j = 0; j < frame.threads_.Size(); ++j)
+        {
+            const WorkThreadStats& stats = frame.threads_[j];
+            unsigned index = stats.threadIndex_;
+            while (index >= threadTotals.Size())
+            {
+                threadTotals.Push(WorkThreadStats());
+                threadFrameUSec.Push(0);
+                threadFrames.Push(0);
+            }
+
+            WorkThreadStats& totals = threadTotals[index];
+            totals.threadIndex_ = index;
+            totals.workClass_ = stats.workClass_;
+            totals.busyUSec_ += stats.busyUSec_;
+            totals.lockWaitUSec_ += stats.lockWaitUSec_;
+            totals.numItems_ += stats.numItems_;
+            threadFrameUSec[index] += frame.frameUSec_;
+            ++threadFrames[index];
+        }
+    }
+
+    String output;
+    char line[256];
+    sprintf(line, "Work queue telemetry of %u frames, average frame %.2f ms\n", numFrames, totalFrameUSec / 1000.0 / numFrames);
+    output.Append(line);
+    sprintf(line, "Queue depth average %.1f max %u, Complete() wait average %.2f ms max %.2f ms\n\n",
+        (double)totalQueueDepth / numFrames, maxQueueDepth, totalCompleteWaitUSec / 1000.0 / numFrames, maxCompleteWaitUSec / 1000.0);
+    output.Append(line);
+    output.Append("Thread Class        Busy %  Items/frame  Lock wait ms/frame\n");
+
+    for (unsigned i = 0; i < threadTotals.Size(); ++i)
+    {
+        if (!threadFrames[i])
+            continue;
+
+        const WorkThreadStats& totals = threadTotals[i];
+        sprintf(line, "%-6u %-10s %8.1f %12.1f %19.3f\n", i, i ? workClassNames[totals.workClass_] : "main",
+            threadFrameUSec[i] ? 100.0 * totals.busyUSec_ / threadFrameUSec[i] : 0.0, (double)totals.numItems_ / threadFrames[i],
+            totals.lockWaitUSec_ / 1000.0 / threadFrames[i]);
+        output.Append(line);
+    }
+
+    Vector<WorkFunctionStats> functions = GetWorkFunctionStats();
+    if (!functions.Empty())
+    {
+        output.Append("\nWork function                      Count    Avg us    Max us   Total ms\n");
+        for (unsigned i = 0; i < functions.Size() && i < maxFunctions; ++i)
+        {
+            const WorkFunctionStats& stats = functions[i];
+            sprintf(line, "%-32.32s %8u %9.1f %9lld %10.2f\n", stats.name_.CString(), stats.count_,
+                stats.count_ ? (double)stats.totalUSec_ / stats.count_ : 0.0, stats.maxUSec_, stats.totalUSec_ / 1000.0);
+            output.Append(line);
+        }
+    }
+
+    return output;
+}
+
+bool WorkQueue::SaveTelemetry(Serializer& dest) const
+{
+    unsigned numFrames = telemetryFrames_.Size();
+    String output("{\"frames\":[\n");
+    char line[256];
+
+    for (unsigned i = 0; i < numFrames; ++i)
+    {
+        const WorkQueueTelemetryFrame& frame = *GetTelemetryFrame(i);
+        sprintf(line, "{\"frameUs\":%lld,\"completeWaitUs\":%lld,\"queueDepth\":%u,\"maxQueueDepth\":%u,\"threads\":[",
+            frame.frameUSec_, frame.completeWaitUSec_, frame.queueDepth_, frame.maxQueueDepth_);
+        output.Append(line);
+
+        for (unsigned j = 0; j < frame.threads_.Size(); ++j)
+        {
+            const WorkThreadStats& stats = frame.threads_[j];
+            sprintf(line, "%s{\"index\":%u,\"class\":\"%s\",\"busyUs\":%lld,\"lockWaitUs\":%lld,\"items\":%u}", j ? "," : "",
+                stats.threadIndex_, workClassNames[stats.workClass_], stats.busyUSec_, stats.lockWaitUSec_, stats.numItems_);
+            output.Append(line);
+        }
+
+        output += i < numFrames - 1 ? "]},\n" : "]}\n";
+    }
+
+    output += "],\"functions\":[\n";
+
+    Vector<WorkFunctionStats> functions = GetWorkFunctionStats();
+    for (unsigned i = 0; i < functions.Size(); ++i)
+    {
+        const WorkFunctionStats& stats = functions[i];
+        // Leave out characters that would need escaping in JSON
+        String name = stats.name_.Replaced('"', '_').Replaced('\\', '_');
+        sprintf(line, "\",\"count\":%u,\"totalUs\":%lld,\"maxUs\":%lld,\"histogram\":[", stats.count_, stats.totalUSec_, stats.maxUSec_);
+        output += "{\"name\":\"" + name + line;
+
+        for (unsigned j = 0; j < NUM_WORK_DURATION_BUCKETS; ++j)
+        {
+            sprintf(line, "%s%u", j ? "," : "", stats.buckets_[j]);
+            output.Append(line);
+        }
+
+        output += i < functions.Size() - 1 ? "]},\n" : "]}\n";
+    }
+
+    output += "]}\n";
+
+    return dest.Write(output.CString(), output.Length()) == output.Length();
+}
+
 }
@@ -25,6 +25,9 @@
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
+#include "../Core/Timer.h"
+
+#include <atomic>
 
 namespace Urho3D
 {
@@ -35,7 +38,72 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
     URHO3D_PARAM(P_ITEM, Item);                        // WorkItem ptr
 }
 
+class PerfCounter;
+class Serializer;
 class WorkerThread;
+struct JobDeque;
+struct WorkerTelemetry;
+struct WorkPool;
+
+/// Class of a work item, which selects the worker threads that execute it.
+enum WorkClass
+{
+    /// Latency-critical work such as rendering and update tasks. Executed by the main worker threads, and by the main thread in WorkQueue::Complete().
+    WORK_CRITICAL = 0,
+    /// Background work which may block on I/O, such as resource streaming.
+    WORK_BACKGROUND,
+    /// Low-priority work which may take several frames, executed on efficiency cores when available.
+    WORK_LOW,
+    MAX_WORK_CLASSES
+};
+
+/// Number of buckets in the work function duration histograms. Bucket N counts the executions that took less than 2^N microseconds, the last bucket also the longer ones.
+static const unsigned NUM_WORK_DURATION_BUCKETS = 16;
+
+/// Execution statistics of one work function, collected while work queue telemetry is enabled.
+struct URHO3D_API WorkFunctionStats
+{
+    /// Name of the work items, or the function address if they were not named.
+    String name_;
+    /// Number of executions.
+    unsigned count_{};
+    /// Total execution time in microseconds.
+    long long totalUSec_{};
+    /// Longest execution time in microseconds.
+    long long maxUSec_{};
+    /// Execution time histogram.
+    unsigned buckets_[NUM_WORK_DURATION_BUCKETS]{};
+};
+
+/// Activity of one thread during a work queue telemetry frame.
+struct WorkThreadStats
+{
+    /// Thread index. 0 is the main thread.
+    unsigned threadIndex_{};
+    /// Work class executed by the thread.
+    WorkClass workClass_{};
+    /// Microseconds spent executing work items and jobs.
+    long long busyUSec_{};
+    /// Microseconds spent waiting for the shared queue lock. Waiting while the queue is paused is not included.
+    long long lockWaitUSec_{};
+    /// Number of executed work items and jobs.
+    unsigned numItems_{};
+};
+
+/// Work queue telemetry of one frame.
+struct URHO3D_API WorkQueueTelemetryFrame
+{
+    /// Frame duration in microseconds.
+    long long frameUSec_{};
+    /// Microseconds the main thread spent blocked in WorkQueue::Complete(), not counting the work it executed itself.
+    long long completeWaitUSec_{};
+    /// Queued work items and pending jobs at the start of the frame.
+    unsigned queueDepth_{};
+    /// Largest number of queued work items and pending jobs during the frame.
+    unsigned maxQueueDepth_{};
+    /// Activity of the main thread, the worker threads and the pool threads.
+    PODVector<WorkThreadStats> threads_;
+};
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -43,6 +111,8 @@ struct WorkItem : public RefCounted
     friend class WorkQueue;
 
 public:
+    URHO3D_POOL_ALLOCATED(MEMCAT_WORKITEM)
+
     /// Work function. Called with the work item and thread index (0 = main thread) as parameters.
     void (* workFunction_)(const WorkItem*, unsigned){};
     /// Data start pointer.
@@ -51,15 +121,28 @@ public:
     void* end_{};
     /// Auxiliary data pointer.
     void* aux_{};
+    /// Name shown in the work queue telemetry. Should be a string literal, as only the pointer is stored.
+    const char* name_{};
     /// Priority. Higher value = will be completed first.
     unsigned priority_{};
+    /// Work class. Items of other classes than critical are executed by a separate thread pool and are given thread indices above GetNumThreads(). Not used by jobs.
+    WorkClass workClass_{};
     /// Whether to send event on completion.
     bool sendEvent_{};
     /// Completed flag.
     volatile bool completed_{};
 
+    /// Make this item wait for another item to complete before executing. Both items must be submitted with WorkQueue::AddJob(), and the dependency must be added before either is submitted.
+    void AddDependency(WorkItem* dependency);
+
 private:
     bool pooled_{};
+    /// Job graph mode flag.
+    bool job_{};
+    /// Items waiting on this item to complete. Cleared when the item completes.
+    PODVector<WorkItem*> dependents_;
+    /// Number of unfinished dependencies, plus one until the item has been submitted. Reset to one when the item completes.
+    std::atomic<int> pendingDependencies_{1};
 };
 
 /// Work queue subsystem for multithreading.
@@ -81,6 +164,8 @@ public:
     SharedPtr<WorkItem> GetFreeItem();
     /// Add a work item and resume worker threads.
     void AddWorkItem(const SharedPtr<WorkItem>& item);
+    /// Add a job graph item and resume worker threads. The job is queued to a worker's own queue once all its dependencies have completed, and idle workers steal jobs from each other. Complete() waits for jobs the same way as for work items.
+    void AddJob(const SharedPtr<WorkItem>& item);
     /// Remove a work item before it has started executing. Return true if successfully removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
@@ -98,8 +183,35 @@ public:
     /// Set how many milliseconds maximum per frame to spend on low-priority work, when there are no worker threads.
     void SetNonThreadedWorkMs(int ms) { maxNonThreadedWorkMs_ = Max(ms, 1); }
 
+    /// Set the number of threads for a non-critical work class. Zero (default) chooses automatically. The pool threads are created when the first item of the class is added, after which the amount is fixed.
+    void SetNumPoolThreads(WorkClass workClass, unsigned numThreads);
+    /// Set whether to pin worker threads to performance or efficiency cores on heterogeneous CPUs. Must be called before CreateThreads(). Default true.
+    void SetCorePinning(bool enable) { corePinning_ = enable; }
+    /// Set whether to collect telemetry of thread utilization, queue depth, lock contention and work function durations. Enabling clears the collected data. Default false.
+    void SetTelemetry(bool enable);
+    /// Set number of frames kept in the telemetry history. Clears the history. Default 300.
+    void SetTelemetryHistorySize(unsigned size);
+
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.Size(); }
+    /// Return number of created threads for a non-critical work class.
+    unsigned GetNumPoolThreads(WorkClass workClass) const;
+    /// Return whether worker threads are pinned to core types on heterogeneous CPUs.
+    bool GetCorePinning() const { return corePinning_; }
+    /// Return whether telemetry is collected.
+    bool GetTelemetry() const { return telemetry_.load(std::memory_order_relaxed); }
+    /// Return number of frames kept in the telemetry history.
+    unsigned GetTelemetryHistorySize() const { return telemetryHistorySize_; }
+    /// Return number of frames in the telemetry history.
+    unsigned GetNumTelemetryFrames() const { return telemetryFrames_.Size(); }
+    /// Return a telemetry frame by index, oldest first. Return null if out of range.
+    const WorkQueueTelemetryFrame* GetTelemetryFrame(unsigned index) const;
+    /// Return the work function statistics accumulated since telemetry was enabled, the most total time first.
+    Vector<WorkFunctionStats> GetWorkFunctionStats() const;
+    /// Return the telemetry history averaged per thread, and the work functions with the most total time, as text.
+    String PrintTelemetry(unsigned maxFunctions = 10) const;
+    /// Write the telemetry history and the work function histograms as JSON. Return true if successful.
+    bool SaveTelemetry(Serializer& dest) const;
 
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(unsigned priority) const;
@@ -115,12 +227,34 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Process the work items of a pool until shut down. Called by the pool threads.
+    void ProcessPoolItems(WorkPool* pool, unsigned threadIndex);
+    /// Return the pool of a non-critical work class, creating its threads if not yet created.
+    WorkPool* GetPool(WorkClass workClass);
+    /// Remove an item from the pool queues if not yet taken for execution. Return true if found.
+    bool RemoveFromPools(WorkItem* item);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
     void PurgePool();
     /// Return a work item to the pool.
     void ReturnToPool(SharedPtr<WorkItem>& item);
+    /// Push a ready job to the queue of the specified thread.
+    void PushJob(WorkItem* item, unsigned threadIndex);
+    /// Pop a job from the thread's own queue, or steal one from another thread. Return null if no job with at least the specified priority found.
+    WorkItem* PopJob(unsigned threadIndex, unsigned priority);
+    /// Execute a job and queue the dependents that became ready.
+    void ExecuteJob(WorkItem* item, unsigned threadIndex);
+    /// Call the work function of an item or a job, recording its duration if telemetry is enabled.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Acquire the shared queue mutex, recording the wait if telemetry is enabled.
+    void AcquireQueue(unsigned threadIndex);
+    /// Update the largest queue depth of the telemetry frame.
+    void UpdateMaxQueueDepth();
+    /// Complete the telemetry frame: collect the thread statistics into the history and publish the performance counters.
+    void EndTelemetryFrame();
+    /// Take the statistics of a thread into a telemetry frame and the work function statistics.
+    void CollectTelemetry(WorkerTelemetry* telemetry, unsigned threadIndex, WorkClass workClass, WorkQueueTelemetryFrame& frame);
     /// Handle frame start event. Purge completed work from the main thread queue, and perform work if no threads at all.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
 
@@ -134,6 +268,16 @@ private:
     List<WorkItem*> queue_;
     /// Worker queue mutex.
     Mutex queueMutex_;
+    /// Per-thread job queues. Index 0 is the main thread.
+    Vector<SharedPtr<JobDeque> > jobDeques_;
+    /// Thread pools of the non-critical work classes. Index 0 (critical) is unused.
+    Vector<SharedPtr<WorkPool> > pools_;
+    /// Next thread index to give to a pool thread.
+    unsigned nextPoolThreadIndex_;
+    /// Number of submitted jobs which have not yet completed.
+    std::atomic<unsigned> numPendingJobs_;
+    /// Next queue to receive a job submitted from the main thread.
+    unsigned nextJobDeque_;
     /// Shutting down flag.
     volatile bool shutDown_;
     /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
@@ -148,6 +292,34 @@ private:
     unsigned lastSize_;
     /// Maximum milliseconds per frame to spend on low-priority work, when there are no worker threads.
     int maxNonThreadedWorkMs_;
+    /// Core pinning flag.
+    bool corePinning_;
+    /// Queued work items and pending jobs gauge, published at frame begin.
+    SharedPtr<PerfCounter> occupancyCounter_;
+    /// Telemetry flag.
+    std::atomic<bool> telemetry_;
+    /// Telemetry of the main thread.
+    SharedPtr<WorkerTelemetry> mainTelemetry_;
+    /// Telemetry frame timer.
+    HiresTimer telemetryTimer_;
+    /// Main thread wait in Complete() during the current telemetry frame.
+    long long completeWaitUSec_;
+    /// Largest queue depth during the current telemetry frame.
+    unsigned maxQueueDepth_;
+    /// Telemetry history. Used as a ring buffer once full.
+    Vector<WorkQueueTelemetryFrame> telemetryFrames_;
+    /// Index of the oldest frame in the telemetry history.
+    unsigned firstTelemetryFrame_;
+    /// Number of frames to keep in the telemetry history.
+    unsigned telemetryHistorySize_;
+    /// Work function statistics keyed by function address.
+    HashMap<unsigned long long, WorkFunctionStats> functionStats_;
+    /// Average worker thread utilization percentage gauge.
+    SharedPtr<PerfCounter> utilizationCounter_;
+    /// Main thread wait in Complete() milliseconds gauge.
+    SharedPtr<PerfCounter> completeWaitCounter_;
+    /// Queue lock wait milliseconds gauge, summed over all threads.
+    SharedPtr<PerfCounter> lockWaitCounter_;
 };
 
 }
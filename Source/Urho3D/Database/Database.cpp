@@ -22,20 +22,63 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Database/Database.h"
+#include "../Database/DatabaseEvents.h"
+#include "../IO/Log.h"
 
 namespace Urho3D
 {
 
+/// Database worker thread.
+class DbWorkerThread : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    explicit DbWorkerThread(Database* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Execute requests until stopped.
+    void ThreadFunction() override
+    {
+        owner_->ProcessRequests();
+    }
+
+private:
+    /// Owning database subsystem.
+    Database* owner_;
+};
+
 Database::Database(Context* context_) :
     Object(context_),
 #ifdef ODBC_3_OR_LATER
-    poolSize_(0)
+    poolSize_(0),
 #else
-    poolSize_(M_MAX_UNSIGNED)
+    poolSize_(M_MAX_UNSIGNED),
 #endif
+    nextRequestId_(1),
+    shutDown_(false)
 {
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(Database, HandleBeginFrame));
+}
+
+Database::~Database()
+{
+    if (workerThread_)
+    {
+        // The worker thread executes the remaining requests before it exits, so that no queued writes are lost
+        {
+            MutexLock lock(requestMutex_);
+            shutDown_ = true;
+        }
+        requestCondition_.Set();
+        workerThread_->Stop();
+        workerThread_.Reset();
+    }
 }
 
 DBAPI Database::GetAPI()
@@ -85,6 +128,19 @@ void Database::Disconnect(DbConnection* connection)
     SharedPtr<DbConnection> dbConnection(connection);
     connections_.Remove(dbConnection);
 
+    // Cancel the queued requests. A request being executed holds the connection, so finalizing waits for it
+    {
+        MutexLock lock(requestMutex_);
+        for (List<DbRequest>::Iterator i = requests_.Begin(); i != requests_.End(); ++i)
+        {
+            if (i->connection_ == dbConnection && i->state_ == DB_REQUEST_QUEUED)
+            {
+                i->result_.error_ = "cancelled by disconnect";
+                i->state_ = DB_REQUEST_COMPLETED;
+            }
+        }
+    }
+
     // Must finalize the connection before closing the connection or returning it to the pool
     connection->Finalize();
 
@@ -96,4 +152,187 @@ void Database::Disconnect(DbConnection* connection)
     }
 }
 
+unsigned Database::ExecuteAsync(DbConnection* connection, const String& sql, const VariantVector& parameters)
+{
+    StringVector statements(1, sql);
+    return QueueRequest(connection, statements, parameters.Empty() ? Vector<VariantVector>() : Vector<VariantVector>(1, parameters),
+        false);
+}
+
+unsigned Database::ExecuteBatchAsync(DbConnection* connection, const StringVector& sql, const Vector<VariantVector>& parameters)
+{
+    return QueueRequest(connection, sql, parameters, true);
+}
+
+void Database::Complete()
+{
+    URHO3D_PROFILE(CompleteDatabaseRequests);
+
+    for (;;)
+    {
+        requestMutex_.Acquire();
+        bool completed = true;
+        for (List<DbRequest>::ConstIterator i = requests_.Begin(); i != requests_.End(); ++i)
+        {
+            if (i->state_ != DB_REQUEST_COMPLETED)
+            {
+                completed = false;
+                break;
+            }
+        }
+        requestMutex_.Release();
+
+        if (completed)
+            break;
+        completedCondition_.Wait();
+    }
+
+    SendCompletionEvents();
+}
+
+unsigned Database::GetNumPendingRequests() const
+{
+    MutexLock lock(requestMutex_);
+
+    unsigned num = 0;
+    for (List<DbRequest>::ConstIterator i = requests_.Begin(); i != requests_.End(); ++i)
+    {
+        if (i->state_ != DB_REQUEST_COMPLETED)
+            ++num;
+    }
+    return num;
+}
+
+unsigned Database::QueueRequest(DbConnection* connection, const StringVector& sql, const Vector<VariantVector>& parameters,
+    bool batch)
+{
+    if (!connection || !connection->IsConnected())
+    {
+        URHO3D_LOGERROR("Could not queue database request: connection is not valid");
+        return 0;
+    }
+    if (sql.Empty())
+        return 0;
+
+    unsigned id = nextRequestId_++;
+    if (!nextRequestId_)
+        nextRequestId_ = 1;
+
+    {
+        MutexLock lock(requestMutex_);
+
+        // The request is filled in place, as the list nodes are not moved when other requests are added or removed
+        requests_.Push(DbRequest());
+        DbRequest& request = requests_.Back();
+        request.id_ = id;
+        request.connection_ = connection;
+        request.sql_ = sql;
+        request.parameters_ = parameters;
+        request.batch_ = batch;
+        request.state_ = DB_REQUEST_QUEUED;
+
+        if (!workerThread_)
+        {
+            workerThread_ = new DbWorkerThread(this);
+            workerThread_->Run();
+        }
+    }
+
+    requestCondition_.Set();
+    return id;
+}
+
+void Database::ProcessRequests()
+{
+    for (;;)
+    {
+        requestMutex_.Acquire();
+
+        DbRequest* request = nullptr;
+        for (List<DbRequest>::Iterator i = requests_.Begin(); i != requests_.End(); ++i)
+        {
+            if (i->state_ == DB_REQUEST_QUEUED)
+            {
+                request = &(*i);
+                break;
+            }
+        }
+
+        if (!request)
+        {
+            bool shutDown = shutDown_;
+            requestMutex_.Release();
+            if (shutDown)
+            {
+                // Pass the wakeup on in case the main thread is waiting
+                completedCondition_.Set();
+                break;
+            }
+            requestCondition_.Wait();
+            continue;
+        }
+
+        request->state_ = DB_REQUEST_EXECUTING;
+        requestMutex_.Release();
+
+        // Execute without holding the request mutex, so that the main thread can queue more meanwhile. The main thread does
+        // not touch the request while it is executing, and only reads the connection pointer without changing its refcount
+        DbConnection* connection = request->connection_.Get();
+        if (request->batch_)
+            request->result_ = connection->ExecuteBatch(request->sql_, request->parameters_);
+        else
+            request->result_ = connection->Execute(request->sql_[0], request->parameters_.Empty() ? Variant::emptyVariantVector :
+                request->parameters_[0]);
+
+        requestMutex_.Acquire();
+        request->state_ = DB_REQUEST_COMPLETED;
+        requestMutex_.Release();
+
+        completedCondition_.Set();
+    }
+}
+
+void Database::SendCompletionEvents()
+{
+    for (;;)
+    {
+        using namespace DbExecuteCompleted;
+
+        // Take the request out of the list before sending, so that a nested Complete() from an event handler does not send it twice
+        SharedPtr<DbConnection> connection;
+        VariantMap& eventData = GetEventDataMap();
+        {
+            MutexLock lock(requestMutex_);
+            if (requests_.Empty() || requests_.Front().state_ != DB_REQUEST_COMPLETED)
+                break;
+
+            DbRequest& request = requests_.Front();
+            const DbResult& result = request.result_;
+            connection = request.connection_;
+
+            VariantVector rows(result.GetNumRows());
+            for (unsigned i = 0; i < rows.Size(); ++i)
+                rows[i] = result.GetRows()[i];
+
+            eventData[P_DBCONNECTION] = connection.Get();
+            eventData[P_REQUESTID] = request.id_;
+            eventData[P_SQL] = request.sql_[0];
+            eventData[P_SUCCESS] = result.GetError().Empty();
+            eventData[P_ERROR] = result.GetError();
+            eventData[P_NUMAFFECTEDROWS] = (long long)result.GetNumAffectedRows();
+            eventData[P_COLHEADERS] = result.GetColumns();
+            eventData[P_ROWS] = rows;
+
+            requests_.PopFront();
+        }
+
+        SendEvent(E_DBEXECUTECOMPLETED, eventData);
+    }
+}
+
+void Database::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    SendCompletionEvents();
+}
+
 }
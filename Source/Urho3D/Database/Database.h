@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include "../Container/List.h"
+#include "../Core/Condition.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Database/DbConnection.h"
 
@@ -35,7 +38,35 @@ enum DBAPI
     DBAPI_ODBC
 };
 
+/// Asynchronous database request state.
+enum DbRequestState
+{
+    DB_REQUEST_QUEUED = 0,
+    DB_REQUEST_EXECUTING,
+    DB_REQUEST_COMPLETED
+};
+
 class DbConnection;
+class DbWorkerThread;
+
+/// Asynchronous database request.
+struct DbRequest
+{
+    /// Request ID.
+    unsigned id_;
+    /// Connection to execute on.
+    SharedPtr<DbConnection> connection_;
+    /// SQL statements. A batch may have several.
+    StringVector sql_;
+    /// Parameters of each statement, or empty if none.
+    Vector<VariantVector> parameters_;
+    /// Whether to execute the statements as a batch in one transaction.
+    bool batch_;
+    /// Execution state.
+    DbRequestState state_;
+    /// Result when completed.
+    DbResult result_;
+};
 
 /// %Database subsystem. Manage database connections.
 class URHO3D_API Database : public Object
@@ -45,13 +76,24 @@ class URHO3D_API Database : public Object
 public:
     /// Construct.
     explicit Database(Context* context_);
+    /// Destruct. Wait for the queued requests to be executed and stop the database worker thread.
+    ~Database() override;
     /// Return the underlying database API.
     static DBAPI GetAPI();
 
     /// Create new database connection. Return 0 if failed.
     DbConnection* Connect(const String& connectionString);
-    /// Disconnect a database connection. The connection object pointer should not be used anymore after this.
+    /// Disconnect a database connection. The connection object pointer should not be used anymore after this. Its queued asynchronous requests are cancelled.
     void Disconnect(DbConnection* connection);
+    /// Queue an SQL statement with parameters for execution on the database worker thread. E_DBEXECUTECOMPLETED is sent in the main thread after it has been executed. Return the request ID, or 0 if the connection is not valid.
+    unsigned ExecuteAsync(DbConnection* connection, const String& sql, const VariantVector& parameters = Variant::emptyVariantVector);
+    /// Queue SQL statements for execution in one transaction on the database worker thread, each with its own parameters when the parameters are not empty. E_DBEXECUTECOMPLETED is sent in the main thread after the transaction has been committed or rolled back. Return the request ID, or 0 if the connection is not valid.
+    unsigned ExecuteBatchAsync(DbConnection* connection, const StringVector& sql, const Vector<VariantVector>& parameters = Vector<VariantVector>());
+    /// Wait until all queued requests have been executed and send their completion events.
+    void Complete();
+
+    /// Return the number of asynchronous requests that have not been completed yet.
+    unsigned GetNumPendingRequests() const;
 
     /// Return true when using internal database connection pool. The internal database pool is managed by the Database subsystem itself and should not be confused with ODBC connection pool option when ODBC is being used.
     bool IsPooling() const { return (bool)poolSize_; }
@@ -63,12 +105,37 @@ public:
     void SetPoolSize(unsigned poolSize) { poolSize_ = poolSize; }
 
 private:
+    friend class DbWorkerThread;
+
+    /// Queue a request and start the worker thread if not started yet.
+    unsigned QueueRequest(DbConnection* connection, const StringVector& sql, const Vector<VariantVector>& parameters, bool batch);
+    /// Execute queued requests until shut down. Called by the worker thread.
+    void ProcessRequests();
+    /// Send completion events for the completed requests in queueing order.
+    void SendCompletionEvents();
+    /// Handle begin frame event. Send completion events.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
     /// %Database connection pool size. Default to 0 when using ODBC 3.0 or later as ODBC 3.0 driver manager could manage its own database connection pool.
     unsigned poolSize_;
     /// Active database connections.
     Vector<SharedPtr<DbConnection> > connections_;
     ///%Database connections pool.
     HashMap<String, Vector<SharedPtr<DbConnection> > > connectionsPool_;
+    /// Asynchronous requests in queueing order. Removed after the completion event has been sent.
+    List<DbRequest> requests_;
+    /// Mutex for the requests.
+    mutable Mutex requestMutex_;
+    /// Condition for waking up the worker thread when requests are queued.
+    Condition requestCondition_;
+    /// Condition for waking up the main thread when a request completes.
+    Condition completedCondition_;
+    /// Database worker thread.
+    SharedPtr<DbWorkerThread> workerThread_;
+    /// Next request ID.
+    unsigned nextRequestId_;
+    /// Shutdown flag for the worker thread.
+    volatile bool shutDown_;
 };
 
 }
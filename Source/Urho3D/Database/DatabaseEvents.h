@@ -41,4 +41,17 @@ URHO3D_EVENT(E_DBCURSOR, DbCursor)
     URHO3D_PARAM(P_ABORT, Abort);                  // bool [in]
 }
 
+/// Asynchronous database request executed. Sent in the main thread.
+URHO3D_EVENT(E_DBEXECUTECOMPLETED, DbExecuteCompleted)
+{
+    URHO3D_PARAM(P_DBCONNECTION, DbConnection);    // DbConnection pointer
+    URHO3D_PARAM(P_REQUESTID, RequestID);          // unsigned
+    URHO3D_PARAM(P_SQL, SQL);                      // String, the first statement of a batch
+    URHO3D_PARAM(P_SUCCESS, Success);              // bool
+    URHO3D_PARAM(P_ERROR, Error);                  // String
+    URHO3D_PARAM(P_NUMAFFECTEDROWS, NumAffectedRows); // int64, -1 if not available
+    URHO3D_PARAM(P_COLHEADERS, ColHeaders);        // StringVector
+    URHO3D_PARAM(P_ROWS, Rows);                    // VariantVector of row VariantVectors
+}
+
 }
@@ -38,7 +38,9 @@ namespace Urho3D
 
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
-    connectionString_(connectionString)
+    connectionString_(connectionString),
+    statementCacheSize_(64),
+    statementUseCounter_(0)
 {
     try
     {
@@ -67,16 +69,67 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    MutexLock lock(mutex_);
+
+    // A transaction left open must not be committed by the next user of a pooled connection
+    RollbackTransaction();
+    statementCache_.Clear();
 }
 
 DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    return Execute(sql, Variant::emptyVariantVector, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(const String& sql, const VariantVector& parameters, bool useCursorEvent)
 {
     DbResult result;
 
+    MutexLock lock(mutex_);
+
+    String trimmedSqlStr = sql.Trimmed();
+    bool cached = false;
+
     try
     {
-        result.resultImpl_ = nanodbc::execute(connectionImpl_, sql.Trimmed().CString());
+        nanodbc::statement statement = AcquireStatement(trimmedSqlStr, cached);
+
+        // The values are bound by pointer, so they must stay in place until the statement has been executed
+        unsigned numParams = parameters.Size();
+        PODVector<long long> integers(numParams);
+        PODVector<double> doubles(numParams);
+        Vector<nanodbc::string> strings(numParams);
+        for (unsigned i = 0; i < numParams; ++i)
+        {
+            const Variant& value = parameters[i];
+            switch (value.GetType())
+            {
+            case VAR_NONE:
+                statement.bind_null((short)i);
+                break;
+
+            case VAR_BOOL:
+            case VAR_INT:
+            case VAR_INT64:
+                integers[i] = value.GetType() == VAR_BOOL ? (long long)value.GetBool() : value.GetInt64();
+                statement.bind((short)i, &integers[i]);
+                break;
+
+            case VAR_FLOAT:
+            case VAR_DOUBLE:
+                doubles[i] = value.GetDouble();
+                statement.bind((short)i, &doubles[i]);
+                break;
+
+            default:
+                // All other types are bound using their string representation
+                strings[i] = value.ToString().CString();
+                statement.bind((short)i, strings[i].c_str());
+                break;
+            }
+        }
+
+        result.resultImpl_ = nanodbc::execute(statement);
         unsigned numCols = (unsigned)result.resultImpl_.columns();
         if (numCols)
         {
@@ -150,11 +203,189 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
     catch (std::runtime_error& e)
     {
         HandleRuntimeError("Could not execute", e.what());
+        result.error_ = e.what();
+    }
+
+    ReleaseStatement(trimmedSqlStr, cached);
+    return result;
+}
+
+DbResult DbConnection::ExecuteBatch(const StringVector& sql, const Vector<VariantVector>& parameters)
+{
+    DbResult result;
+    if (!parameters.Empty() && parameters.Size() != sql.Size())
+    {
+        URHO3D_LOGERROR("Could not execute batch: the number of parameter sets does not match the statements");
+        result.error_ = "the number of parameter sets does not match the statements";
+        return result;
+    }
+
+    MutexLock lock(mutex_);
+
+    if (transaction_)
+    {
+        URHO3D_LOGERROR("Could not execute batch: a transaction is already open");
+        result.error_ = "a transaction is already open";
+        return result;
+    }
+    if (!BeginTransaction())
+    {
+        result.error_ = "could not begin transaction";
+        return result;
+    }
+
+    long numAffectedRows = 0;
+    for (unsigned i = 0; i < sql.Size(); ++i)
+    {
+        DbResult statementResult = Execute(sql[i], parameters.Empty() ? Variant::emptyVariantVector : parameters[i]);
+        if (!statementResult.error_.Empty())
+        {
+            RollbackTransaction();
+            result.error_ = statementResult.error_;
+            return result;
+        }
+        if (statementResult.numAffectedRows_ > 0)
+            numAffectedRows += statementResult.numAffectedRows_;
+    }
+
+    if (!CommitTransaction())
+    {
+        RollbackTransaction();
+        result.error_ = "could not commit transaction";
+        return result;
     }
 
+    result.numAffectedRows_ = numAffectedRows;
     return result;
 }
 
+bool DbConnection::BeginTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (transaction_)
+    {
+        URHO3D_LOGERROR("Could not begin transaction: a transaction is already open");
+        return false;
+    }
+
+    try
+    {
+        transaction_ = new nanodbc::transaction(connectionImpl_);
+        return true;
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not begin transaction", e.what());
+        return false;
+    }
+}
+
+bool DbConnection::CommitTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!transaction_)
+    {
+        URHO3D_LOGERROR("Could not commit transaction: no transaction is open");
+        return false;
+    }
+
+    // If the commit fails the transaction stays open, so that it can still be rolled back
+    try
+    {
+        transaction_->commit();
+        transaction_.Reset();
+        return true;
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not commit transaction", e.what());
+        return false;
+    }
+}
+
+void DbConnection::RollbackTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!transaction_)
+        return;
+
+    // Destroying an uncommitted transaction rolls it back
+    transaction_->rollback();
+    transaction_.Reset();
+}
+
+void DbConnection::SetStatementCacheSize(unsigned size)
+{
+    MutexLock lock(mutex_);
+
+    statementCacheSize_ = size;
+    while (statementCache_.Size() > statementCacheSize_ && EvictStatement())
+        ;
+}
+
+nanodbc::statement DbConnection::AcquireStatement(const String& sql, bool& cached)
+{
+    cached = false;
+
+    HashMap<String, CachedStatement>::Iterator i = statementCache_.Find(sql);
+    if (i != statementCache_.End() && !i->second_.inUse_)
+    {
+        i->second_.statement_.reset_parameters();
+        i->second_.lastUse_ = ++statementUseCounter_;
+        i->second_.inUse_ = true;
+        cached = true;
+        return i->second_.statement_;
+    }
+
+    nanodbc::statement statement(connectionImpl_);
+    nanodbc::prepare(statement, sql.CString());
+
+    // A statement that is already being executed, for example by an outer execution sending cursor events, is prepared again
+    // for the nested execution but not cached twice
+    if (statementCacheSize_ && i == statementCache_.End())
+    {
+        if (statementCache_.Size() >= statementCacheSize_)
+            EvictStatement();
+
+        CachedStatement& entry = statementCache_[sql];
+        entry.statement_ = statement;
+        entry.lastUse_ = ++statementUseCounter_;
+        entry.inUse_ = true;
+        cached = true;
+    }
+
+    return statement;
+}
+
+void DbConnection::ReleaseStatement(const String& sql, bool cached)
+{
+    if (!cached)
+        return;
+
+    HashMap<String, CachedStatement>::Iterator i = statementCache_.Find(sql);
+    if (i != statementCache_.End())
+        i->second_.inUse_ = false;
+}
+
+bool DbConnection::EvictStatement()
+{
+    HashMap<String, CachedStatement>::Iterator oldest = statementCache_.End();
+    for (HashMap<String, CachedStatement>::Iterator i = statementCache_.Begin(); i != statementCache_.End(); ++i)
+    {
+        if (!i->second_.inUse_ && (oldest == statementCache_.End() || i->second_.lastUse_ < oldest->second_.lastUse_))
+            oldest = i;
+    }
+
+    if (oldest == statementCache_.End())
+        return false;
+
+    statementCache_.Erase(oldest);
+    return true;
+}
+
 void DbConnection::HandleRuntimeError(const char* message, const char* cause)
 {
     StringVector tokens = (String(cause) + "::").Split(':');      // Added "::" as sentinels against unexpected cause format
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../../Core/Mutex.h"
 #include "../../Core/Object.h"
 #include "../../Database/DbResult.h"
 
@@ -45,6 +46,18 @@ public:
 
     /// Execute an SQL statements immediately. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
     DbResult Execute(const String& sql, bool useCursorEvent = false);
+    /// Execute an SQL statement with parameters bound to its placeholders in order. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
+    DbResult Execute(const String& sql, const VariantVector& parameters, bool useCursorEvent = false);
+    /// Execute SQL statements in one transaction, each with its own parameters when the parameters are not empty. The result has the total number of affected rows, or the error if a statement failed and the transaction was rolled back.
+    DbResult ExecuteBatch(const StringVector& sql, const Vector<VariantVector>& parameters = Vector<VariantVector>());
+    /// Begin a transaction. The following statements are not committed until CommitTransaction(). Return true if successful.
+    bool BeginTransaction();
+    /// Commit the current transaction. Return true if successful.
+    bool CommitTransaction();
+    /// Roll back the current transaction.
+    void RollbackTransaction();
+    /// Set the maximum number of cached prepared statements. The least recently used statement is released when the cache is full. 0 disables the cache. Default 64.
+    void SetStatementCacheSize(unsigned size);
 
     /// Return database connection string. The connection string for SQLite3 is using the URI format described in https://www.sqlite.org/uri.html, while the connection string for ODBC is using DSN format as per ODBC standard.
     const String& GetConnectionString() const { return connectionString_; }
@@ -55,7 +68,33 @@ public:
     /// Return true when the connection object is connected to the associated database.
     bool IsConnected() const { return connectionImpl_.connected(); }
 
+    /// Return true when a transaction is open.
+    bool IsInTransaction() const { return transaction_.NotNull(); }
+
+    /// Return the maximum number of cached prepared statements.
+    unsigned GetStatementCacheSize() const { return statementCacheSize_; }
+
+    /// Return the number of cached prepared statements.
+    unsigned GetNumCachedStatements() const { return statementCache_.Size(); }
+
 private:
+    /// Prepared statement in the cache.
+    struct CachedStatement
+    {
+        /// Statement.
+        nanodbc::statement statement_;
+        /// Use counter value when last executed.
+        unsigned lastUse_;
+        /// Whether the statement is being executed.
+        bool inUse_;
+    };
+
+    /// Return the prepared statement of an SQL string, from the cache if possible. Throws on failure.
+    nanodbc::statement AcquireStatement(const String& sql, bool& cached);
+    /// Release a statement after execution if it is cached.
+    void ReleaseStatement(const String& sql, bool cached);
+    /// Release the least recently used statement that is not being executed. Return false if none.
+    bool EvictStatement();
     /// Internal helper method to handle runtime exception by logging it to stderr stream.
     void HandleRuntimeError(const char* message, const char* cause);
 
@@ -63,6 +102,16 @@ private:
     String connectionString_;
     /// The underlying implementation connection object.
     nanodbc::connection connectionImpl_;
+    /// Open transaction, null when none.
+    UniquePtr<nanodbc::transaction> transaction_;
+    /// Prepared statements by SQL string.
+    HashMap<String, CachedStatement> statementCache_;
+    /// Maximum number of cached prepared statements.
+    unsigned statementCacheSize_;
+    /// Statement use counter for finding the least recently used statement.
+    unsigned statementUseCounter_;
+    /// Mutex for executing from the database worker thread and the main thread.
+    Mutex mutex_;
 };
 
 }
@@ -32,6 +32,7 @@ namespace Urho3D
 /// %Database query result.
 class URHO3D_API DbResult
 {
+    friend class Database;
     friend class DbConnection;
 
 public:
@@ -59,6 +60,9 @@ public:
     /// Return fetched rows collection. Filtered rows are not included in the collection.
     const Vector<VariantVector>& GetRows() const { return rows_; }
 
+    /// Return the error message if the execution failed, or empty if it succeeded.
+    const String& GetError() const { return error_; }
+
 private:
     /// The underlying implementation connection object.
     nanodbc::result resultImpl_;
@@ -68,6 +72,8 @@ private:
     Vector<VariantVector> rows_;
     /// Number of affected rows by recent DML query.
     long numAffectedRows_;
+    /// Error message of a failed execution.
+    String error_;
 };
 
 }
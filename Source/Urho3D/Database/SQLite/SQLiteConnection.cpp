@@ -31,7 +31,10 @@ namespace Urho3D
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
     connectionString_(connectionString),
-    connectionImpl_(nullptr)
+    connectionImpl_(nullptr),
+    statementCacheSize_(64),
+    statementUseCounter_(0),
+    inTransaction_(false)
 {
     if (sqlite3_open(connectionString.CString(), &connectionImpl_) != SQLITE_OK)
     {
@@ -55,30 +58,39 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    MutexLock lock(mutex_);
+
+    // A transaction left open must not be committed by the next user of a pooled connection
+    if (inTransaction_)
+        RollbackTransaction();
+
+    for (HashMap<String, CachedStatement>::Iterator i = statementCache_.Begin(); i != statementCache_.End(); ++i)
+        sqlite3_finalize(i->second_.statement_);
+    statementCache_.Clear();
 }
 
 DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    return Execute(sql, Variant::emptyVariantVector, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(const String& sql, const VariantVector& parameters, bool useCursorEvent)
 {
     DbResult result;
-    const char* zLeftover = nullptr;
-    sqlite3_stmt* pStmt = nullptr;
     assert(connectionImpl_);
 
+    MutexLock lock(mutex_);
+
     // 2016-10-09: Prevent string corruption when trimmed is returned.
     String trimmedSqlStr = sql.Trimmed();
 
-    int rc = sqlite3_prepare_v2(connectionImpl_, trimmedSqlStr.CString(), -1, &pStmt, &zLeftover);
-    if (rc != SQLITE_OK)
-    {
-        URHO3D_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        assert(!pStmt);
+    bool cached;
+    sqlite3_stmt* pStmt = AcquireStatement(trimmedSqlStr, result, cached);
+    if (!pStmt)
         return result;
-    }
-    if (*zLeftover)
+    if (!BindParameters(pStmt, parameters, result))
     {
-        URHO3D_LOGERROR("Could not execute: only one SQL statement is allowed");
-        sqlite3_finalize(pStmt);
+        ReleaseStatement(trimmedSqlStr, pStmt, cached);
         return result;
     }
 
@@ -92,7 +104,7 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
 
     while (true)
     {
-        rc = sqlite3_step(pStmt);
+        int rc = sqlite3_step(pStmt);
         if (rc == SQLITE_ROW)
         {
             VariantVector colValues(numCols);
@@ -145,22 +157,271 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
             if (!filtered)
                 result.rows_.Push(colValues);
             if (aborted)
-            {
-                sqlite3_finalize(pStmt);
                 break;
-            }
         }
-        else if (rc != SQLITE_DONE)
-            URHO3D_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        if (rc != SQLITE_ROW)
+        else
         {
-            sqlite3_finalize(pStmt);
+            if (rc != SQLITE_DONE)
+                HandleError(result, "Could not execute", sqlite3_errmsg(connectionImpl_));
             break;
         }
     }
 
     result.numAffectedRows_ = numCols ? -1 : sqlite3_changes(connectionImpl_);
+    ReleaseStatement(trimmedSqlStr, pStmt, cached);
     return result;
 }
 
+DbResult DbConnection::ExecuteBatch(const StringVector& sql, const Vector<VariantVector>& parameters)
+{
+    DbResult result;
+    if (!parameters.Empty() && parameters.Size() != sql.Size())
+    {
+        HandleError(result, "Could not execute batch", "the number of parameter sets does not match the statements");
+        return result;
+    }
+
+    MutexLock lock(mutex_);
+
+    if (inTransaction_)
+    {
+        HandleError(result, "Could not execute batch", "a transaction is already open");
+        return result;
+    }
+    // The failed statement has already logged its error
+    if (!BeginTransaction())
+    {
+        result.error_ = sqlite3_errmsg(connectionImpl_);
+        return result;
+    }
+
+    long numAffectedRows = 0;
+    for (unsigned i = 0; i < sql.Size(); ++i)
+    {
+        DbResult statementResult = Execute(sql[i], parameters.Empty() ? Variant::emptyVariantVector : parameters[i]);
+        if (!statementResult.error_.Empty())
+        {
+            RollbackTransaction();
+            result.error_ = statementResult.error_;
+            return result;
+        }
+        if (statementResult.numAffectedRows_ > 0)
+            numAffectedRows += statementResult.numAffectedRows_;
+    }
+
+    if (!CommitTransaction())
+    {
+        result.error_ = sqlite3_errmsg(connectionImpl_);
+        RollbackTransaction();
+        return result;
+    }
+
+    result.numAffectedRows_ = numAffectedRows;
+    return result;
+}
+
+bool DbConnection::BeginTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (inTransaction_)
+    {
+        URHO3D_LOGERROR("Could not begin transaction: a transaction is already open");
+        return false;
+    }
+
+    inTransaction_ = Execute("BEGIN").error_.Empty();
+    return inTransaction_;
+}
+
+bool DbConnection::CommitTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!inTransaction_)
+    {
+        URHO3D_LOGERROR("Could not commit transaction: no transaction is open");
+        return false;
+    }
+
+    // If the commit fails the transaction stays open, so that it can still be rolled back
+    if (!Execute("COMMIT").error_.Empty())
+        return false;
+    inTransaction_ = false;
+    return true;
+}
+
+void DbConnection::RollbackTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!inTransaction_)
+        return;
+
+    Execute("ROLLBACK");
+    inTransaction_ = false;
+}
+
+void DbConnection::SetStatementCacheSize(unsigned size)
+{
+    MutexLock lock(mutex_);
+
+    statementCacheSize_ = size;
+    while (statementCache_.Size() > statementCacheSize_ && EvictStatement())
+        ;
+}
+
+sqlite3_stmt* DbConnection::AcquireStatement(const String& sql, DbResult& result, bool& cached)
+{
+    cached = false;
+
+    HashMap<String, CachedStatement>::Iterator i = statementCache_.Find(sql);
+    if (i != statementCache_.End() && !i->second_.inUse_)
+    {
+        i->second_.lastUse_ = ++statementUseCounter_;
+        i->second_.inUse_ = true;
+        cached = true;
+        return i->second_.statement_;
+    }
+
+    const char* zLeftover = nullptr;
+    sqlite3_stmt* pStmt = nullptr;
+    if (sqlite3_prepare_v2(connectionImpl_, sql.CString(), -1, &pStmt, &zLeftover) != SQLITE_OK)
+    {
+        HandleError(result, "Could not execute", sqlite3_errmsg(connectionImpl_));
+        assert(!pStmt);
+        return nullptr;
+    }
+    // An empty statement leaves nothing to execute
+    if (!pStmt)
+        return nullptr;
+    if (*zLeftover)
+    {
+        HandleError(result, "Could not execute", "only one SQL statement is allowed");
+        sqlite3_finalize(pStmt);
+        return nullptr;
+    }
+
+    // A statement that is already being executed, for example by an outer execution sending cursor events, is prepared again
+    // for the nested execution but not cached twice
+    if (statementCacheSize_ && i == statementCache_.End())
+    {
+        if (statementCache_.Size() >= statementCacheSize_)
+            EvictStatement();
+
+        CachedStatement& entry = statementCache_[sql];
+        entry.statement_ = pStmt;
+        entry.lastUse_ = ++statementUseCounter_;
+        entry.inUse_ = true;
+        cached = true;
+    }
+
+    return pStmt;
+}
+
+void DbConnection::ReleaseStatement(const String& sql, sqlite3_stmt* statement, bool cached)
+{
+    if (cached)
+    {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        HashMap<String, CachedStatement>::Iterator i = statementCache_.Find(sql);
+        if (i != statementCache_.End())
+            i->second_.inUse_ = false;
+    }
+    else
+        sqlite3_finalize(statement);
+}
+
+bool DbConnection::EvictStatement()
+{
+    HashMap<String, CachedStatement>::Iterator oldest = statementCache_.End();
+    for (HashMap<String, CachedStatement>::Iterator i = statementCache_.Begin(); i != statementCache_.End(); ++i)
+    {
+        if (!i->second_.inUse_ && (oldest == statementCache_.End() || i->second_.lastUse_ < oldest->second_.lastUse_))
+            oldest = i;
+    }
+
+    if (oldest == statementCache_.End())
+        return false;
+
+    sqlite3_finalize(oldest->second_.statement_);
+    statementCache_.Erase(oldest);
+    return true;
+}
+
+bool DbConnection::BindParameters(sqlite3_stmt* statement, const VariantVector& parameters, DbResult& result)
+{
+    if ((int)parameters.Size() != sqlite3_bind_parameter_count(statement))
+    {
+        HandleError(result, "Could not bind parameters", "the number of parameters does not match the placeholders");
+        return false;
+    }
+
+    for (unsigned i = 0; i < parameters.Size(); ++i)
+    {
+        const Variant& value = parameters[i];
+        int index = (int)i + 1;
+        int rc;
+
+        // The parameters outlive the execution, so strings and buffers are bound without copying
+        switch (value.GetType())
+        {
+        case VAR_NONE:
+            rc = sqlite3_bind_null(statement, index);
+            break;
+
+        case VAR_BOOL:
+            rc = sqlite3_bind_int(statement, index, value.GetBool() ? 1 : 0);
+            break;
+
+        case VAR_INT:
+            rc = sqlite3_bind_int(statement, index, value.GetInt());
+            break;
+
+        case VAR_INT64:
+            rc = sqlite3_bind_int64(statement, index, value.GetInt64());
+            break;
+
+        case VAR_FLOAT:
+        case VAR_DOUBLE:
+            rc = sqlite3_bind_double(statement, index, value.GetDouble());
+            break;
+
+        case VAR_STRING:
+            rc = sqlite3_bind_text(statement, index, value.GetString().CString(), value.GetString().Length(), SQLITE_STATIC);
+            break;
+
+        case VAR_BUFFER:
+            {
+                const PODVector<unsigned char>& buffer = value.GetBuffer();
+                rc = sqlite3_bind_blob(statement, index, buffer.Buffer(), buffer.Size(), SQLITE_STATIC);
+            }
+            break;
+
+        default:
+            // All other types are bound using their string representation
+            {
+                String str = value.ToString();
+                rc = sqlite3_bind_text(statement, index, str.CString(), str.Length(), SQLITE_TRANSIENT);
+            }
+            break;
+        }
+
+        if (rc != SQLITE_OK)
+        {
+            HandleError(result, "Could not bind parameters", sqlite3_errmsg(connectionImpl_));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DbConnection::HandleError(DbResult& result, const char* message, const String& cause)
+{
+    result.error_ = cause;
+    URHO3D_LOGERRORF("%s: %s", message, cause.CString());
+}
+
 }
@@ -26,15 +26,23 @@
 #include "../Core/Profiler.h"
 #include "../Core/EventProfiler.h"
 #include "../Core/Context.h"
+#include "../Core/PerfCounters.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/DebugHud.h"
 #include "../Engine/Engine.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
 #include "../Resource/ResourceCache.h"
 #include "../IO/Log.h"
+#ifdef URHO3D_NETWORK
+#include "../Network/Network.h"
+#endif
 #include "../UI/Font.h"
 #include "../UI/Text.h"
 #include "../UI/UI.h"
+#include "../UI/UIBatch.h"
+
+#include <cstdio>
 
 #include "../DebugNew.h"
 
@@ -59,6 +67,61 @@ static const char* shadowQualityTexts[] =
     "Blurred VSM"
 };
 
+static const int COUNTER_GRAPH_WIDTH = 240;
+static const int COUNTER_GRAPH_HEIGHT = 24;
+
+/// %UI element that draws the history of a performance counter as a bar graph scaled to the maximum value.
+class PerfCounterGraph : public UIElement
+{
+    URHO3D_OBJECT(PerfCounterGraph, UIElement);
+
+public:
+    /// Construct.
+    explicit PerfCounterGraph(Context* context) :
+        UIElement(context)
+    {
+        SetFixedSize(COUNTER_GRAPH_WIDTH, COUNTER_GRAPH_HEIGHT);
+    }
+
+    /// Return UI rendering batches.
+    void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override
+    {
+        UIBatch batch(this, BLEND_ALPHA, currentScissor, nullptr, &vertexData);
+        batch.SetColor(Color(0.0f, 0.0f, 0.0f, 0.5f));
+        batch.AddQuad(0, 0, GetWidth(), GetHeight(), 0, 0);
+
+        unsigned numSamples = counter_ ? counter_->GetNumSamples() : 0;
+        float maxValue = counter_ ? counter_->GetMax() : 0.0f;
+        if (numSamples && maxValue > 0.0f)
+        {
+            // Newest sample is at the right edge
+            float barWidth = (float)GetWidth() / counter_->GetHistorySize();
+            float x = GetWidth() - numSamples * barWidth;
+            float scale = (float)GetHeight() / maxValue;
+            batch.SetColor(Color(0.4f, 1.0f, 0.4f, 0.8f));
+            for (unsigned i = 0; i < numSamples; ++i, x += barWidth)
+            {
+                float height = Max(counter_->GetSample(i), 0.0f) * scale;
+                if (height > 0.0f)
+                    batch.AddQuad(x, GetHeight() - height, barWidth, height, 0, 0);
+            }
+        }
+
+        UIBatch::AddOrMerge(batch, batches);
+    }
+
+    /// Set counter to draw.
+    void SetCounter(PerfCounter* counter)
+    {
+        counter_ = counter;
+        MarkBatchesDirty();
+    }
+
+private:
+    /// Counter to draw.
+    SharedPtr<PerfCounter> counter_;
+};
+
 DebugHud::DebugHud(Context* context) :
     Object(context),
     profilerMaxDepth_(M_MAX_UNSIGNED),
@@ -99,6 +162,25 @@ DebugHud::DebugHud(Context* context) :
     eventProfilerText_->SetVisible(false);
     uiRoot->AddChild(eventProfilerText_);
 
+    networkText_ = new Text(context_);
+    networkText_->SetAlignment(HA_RIGHT, VA_BOTTOM);
+    networkText_->SetPriority(100);
+    networkText_->SetVisible(false);
+    uiRoot->AddChild(networkText_);
+
+    countersElement_ = new UIElement(context_);
+    countersElement_->SetAlignment(HA_CENTER, VA_TOP);
+    countersElement_->SetLayout(LM_VERTICAL, 2);
+    countersElement_->SetPriority(100);
+    countersElement_->SetVisible(false);
+    uiRoot->AddChild(countersElement_);
+
+    workQueueText_ = new Text(context_);
+    workQueueText_->SetAlignment(HA_LEFT, VA_CENTER);
+    workQueueText_->SetPriority(100);
+    workQueueText_->SetVisible(false);
+    uiRoot->AddChild(workQueueText_);
+
     SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(DebugHud, HandlePostUpdate));
 }
 
@@ -109,6 +191,9 @@ DebugHud::~DebugHud()
     profilerText_->Remove();
     memoryText_->Remove();
     eventProfilerText_->Remove();
+    networkText_->Remove();
+    countersElement_->Remove();
+    workQueueText_->Remove();
 }
 
 void DebugHud::Update()
@@ -151,6 +236,10 @@ void DebugHud::Update()
             renderer->GetNumShadowMaps(true),
             renderer->GetNumOccluders(true));
 
+        auto* engine = GetSubsystem<Engine>();
+        if (engine && engine->GetGCTimeBudget())
+            stats.AppendWithFormat("\nGC %.2f ms", engine->GetGCTime() / 1000.0f);
+
         if (!appStats_.Empty())
         {
             stats.Append("\n");
@@ -203,6 +292,31 @@ void DebugHud::Update()
 
     if (memoryText_->IsVisible())
         memoryText_->SetText(GetSubsystem<ResourceCache>()->PrintMemoryUsage());
+
+#ifdef URHO3D_NETWORK
+    if (networkText_->IsVisible() && networkTimer_.GetMSec(false) >= profilerInterval_)
+    {
+        networkTimer_.Reset();
+
+        auto* network = GetSubsystem<Network>();
+        if (network && network->GetTrafficProfiling())
+            networkText_->SetText(network->PrintTrafficStats());
+        else
+            networkText_->SetText("Network traffic profiling disabled");
+    }
+#endif
+
+    if (countersElement_->IsVisible())
+        UpdateCounters();
+
+    if (workQueueText_->IsVisible() && workQueueTimer_.GetMSec(false) >= profilerInterval_)
+    {
+        workQueueTimer_.Reset();
+
+        auto* workQueue = GetSubsystem<WorkQueue>();
+        if (workQueue)
+            workQueueText_->SetText(workQueue->PrintTelemetry());
+    }
 }
 
 void DebugHud::SetDefaultStyle(XMLFile* style)
@@ -220,6 +334,13 @@ void DebugHud::SetDefaultStyle(XMLFile* style)
     memoryText_->SetStyle("DebugHudText");
     eventProfilerText_->SetDefaultStyle(style);
     eventProfilerText_->SetStyle("DebugHudText");
+    networkText_->SetDefaultStyle(style);
+    networkText_->SetStyle("DebugHudText");
+    workQueueText_->SetDefaultStyle(style);
+    workQueueText_->SetStyle("DebugHudText");
+    countersElement_->SetDefaultStyle(style);
+    for (unsigned i = 0; i < countersElement_->GetNumChildren(); i += 2)
+        countersElement_->GetChild(i)->SetStyle("DebugHudText");
 }
 
 void DebugHud::SetMode(unsigned mode)
@@ -229,6 +350,9 @@ void DebugHud::SetMode(unsigned mode)
     profilerText_->SetVisible((mode & DEBUGHUD_SHOW_PROFILER) != 0);
     memoryText_->SetVisible((mode & DEBUGHUD_SHOW_MEMORY) != 0);
     eventProfilerText_->SetVisible((mode & DEBUGHUD_SHOW_EVENTPROFILER) != 0);
+    networkText_->SetVisible((mode & DEBUGHUD_SHOW_NETWORK) != 0);
+    countersElement_->SetVisible((mode & DEBUGHUD_SHOW_COUNTERS) != 0);
+    workQueueText_->SetVisible((mode & DEBUGHUD_SHOW_WORKQUEUE) != 0);
 
     memoryText_->SetPosition(0, modeText_->IsVisible() ? modeText_->GetHeight() * -2 : 0);
 
@@ -239,6 +363,11 @@ void DebugHud::SetMode(unsigned mode)
         EventProfiler::SetActive((mode & DEBUGHUD_SHOW_EVENTPROFILER) != 0);
 #endif
 
+    // Work queue telemetry is collected only when needed. Hiding the view leaves it on, as the application may be using it
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    if (workQueue && (mode & DEBUGHUD_SHOW_WORKQUEUE) && !(mode_ & DEBUGHUD_SHOW_WORKQUEUE))
+        workQueue->SetTelemetry(true);
+
     mode_ = mode;
 }
 
@@ -307,4 +436,40 @@ void DebugHud::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
     Update();
 }
 
+void DebugHud::UpdateCounters()
+{
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    unsigned numCounters = perfCounters ? perfCounters->GetNumCounters() : 0;
+
+    bool updateTexts = countersTimer_.GetMSec(false) >= profilerInterval_;
+    if (updateTexts)
+        countersTimer_.Reset();
+
+    // Counters are never removed, so add rows for the new ones. The rows follow the sorted counter order
+    if (countersElement_->GetNumChildren() < numCounters * 2)
+    {
+        while (countersElement_->GetNumChildren() < numCounters * 2)
+        {
+            auto* text = countersElement_->CreateChild<Text>();
+            text->SetStyle("DebugHudText");
+            countersElement_->AddChild(new PerfCounterGraph(context_));
+        }
+        updateTexts = true;
+    }
+
+    for (unsigned i = 0; i < numCounters; ++i)
+    {
+        PerfCounter* counter = perfCounters->GetCounter(i);
+        countersElement_->GetChildStaticCast<PerfCounterGraph>(i * 2 + 1)->SetCounter(counter);
+
+        if (updateTexts)
+        {
+            char text[256];
+            snprintf(text, sizeof text, "%s %.2f (min %.2f avg %.2f max %.2f p95 %.2f)", counter->GetName().CString(),
+                counter->GetLast(), counter->GetMin(), counter->GetAverage(), counter->GetMax(), counter->GetPercentile(95.0f));
+            countersElement_->GetChildStaticCast<Text>(i * 2)->SetText(text);
+        }
+    }
+}
+
 }
@@ -31,6 +31,7 @@ namespace Urho3D
 class Engine;
 class Font;
 class Text;
+class UIElement;
 class XMLFile;
 
 static const unsigned DEBUGHUD_SHOW_NONE = 0x0;
@@ -39,6 +40,9 @@ static const unsigned DEBUGHUD_SHOW_MODE = 0x2;
 static const unsigned DEBUGHUD_SHOW_PROFILER = 0x4;
 static const unsigned DEBUGHUD_SHOW_MEMORY = 0x8;
 static const unsigned DEBUGHUD_SHOW_EVENTPROFILER = 0x10;
+static const unsigned DEBUGHUD_SHOW_NETWORK = 0x20;
+static const unsigned DEBUGHUD_SHOW_COUNTERS = 0x40;
+static const unsigned DEBUGHUD_SHOW_WORKQUEUE = 0x80;
 static const unsigned DEBUGHUD_SHOW_ALL = DEBUGHUD_SHOW_STATS | DEBUGHUD_SHOW_MODE | DEBUGHUD_SHOW_PROFILER | DEBUGHUD_SHOW_MEMORY;
 
 /// Displays rendering stats and profiling information.
@@ -84,6 +88,15 @@ public:
     /// Return memory text.
     Text* GetMemoryText() const { return memoryText_; }
 
+    /// Return network traffic text.
+    Text* GetNetworkText() const { return networkText_; }
+
+    /// Return performance counters panel.
+    UIElement* GetCountersElement() const { return countersElement_; }
+
+    /// Return work queue telemetry text.
+    Text* GetWorkQueueText() const { return workQueueText_; }
+
     /// Return currently shown elements.
     unsigned GetMode() const { return mode_; }
 
@@ -108,6 +121,8 @@ public:
 private:
     /// Handle logic post-update event. The HUD texts are updated here.
     void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Update the performance counter texts and graphs.
+    void UpdateCounters();
 
     /// Rendering stats text.
     SharedPtr<Text> statsText_;
@@ -119,10 +134,22 @@ private:
     SharedPtr<Text> eventProfilerText_;
     /// Memory stats text.
     SharedPtr<Text> memoryText_;
+    /// Network traffic text.
+    SharedPtr<Text> networkText_;
+    /// Performance counters panel with a text and a graph for each counter.
+    SharedPtr<UIElement> countersElement_;
+    /// Work queue telemetry text.
+    SharedPtr<Text> workQueueText_;
     /// Hashmap containing application specific stats.
     HashMap<String, String> appStats_;
     /// Profiler timer.
     Timer profilerTimer_;
+    /// Network traffic text update timer.
+    Timer networkTimer_;
+    /// Performance counter text update timer.
+    Timer countersTimer_;
+    /// Work queue telemetry text update timer.
+    Timer workQueueTimer_;
     /// Profiler max block depth.
     unsigned profilerMaxDepth_;
     /// Profiler accumulation interval.
@@ -23,15 +23,20 @@
 #include "../Precompiled.h"
 
 #include "../Audio/Audio.h"
+#include "../Container/AllocationTracker.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/EventProfiler.h"
+#include "../Core/FrameArena.h"
+#include "../Core/PerfCounters.h"
 #include "../Core/ProcessUtils.h"
+#include "../Core/Task.h"
 #include "../Core/WorkQueue.h"
 #include "../Engine/Console.h"
 #include "../Engine/DebugHud.h"
 #include "../Engine/Engine.h"
 #include "../Engine/EngineDefs.h"
+#include "../Engine/EngineEvents.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
 #include "../Input/Input.h"
@@ -60,6 +65,7 @@
 #include "../Scene/SceneEvents.h"
 #include "../UI/UI.h"
 #ifdef URHO3D_URHO2D
+#include "../Urho2D/SpriteAtlas2D.h"
 #include "../Urho2D/Urho2D.h"
 #endif
 
@@ -92,8 +98,15 @@ namespace Urho3D
 
 extern const char* logLevelPrefixes[];
 
+/// Lower limit of the frame limiter's adaptive sleep margin in microseconds.
+static const long long MIN_SLEEP_MARGIN = 50;
+/// Upper limit of the frame limiter's adaptive sleep margin in microseconds.
+static const long long MAX_SLEEP_MARGIN = 4000;
+
 Engine::Engine(Context* context) :
     Object(context),
+    lastFrameTime_(0),
+    sleepMargin_(1000),
     timeStep_(0.0f),
     timeStepSmoothing_(2),
     minFps_(10),
@@ -106,6 +119,10 @@ Engine::Engine(Context* context) :
     maxInactiveFps_(60),
     pauseMinimized_(false),
 #endif
+    gcTimeBudget_(1000),
+    gcTime_(0),
+    pipelinedFrames_(false),
+    pacedTimeStep_(true),
 #ifdef URHO3D_TESTING
     timeOut_(0),
 #endif
@@ -118,9 +135,15 @@ Engine::Engine(Context* context) :
     // Register self as a subsystem
     context_->RegisterSubsystem(this);
 
+    // Postpone library registration until Initialize() knows whether it should be done lazily
+    context_->SetLazyRegistration(true);
+
     // Create subsystems which do not depend on engine initialization or startup parameters
     context_->RegisterSubsystem(new Time(context_));
+    context_->RegisterSubsystem(new PerfCounters(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
+    context_->RegisterSubsystem(new FrameArena(context_));
+    context_->RegisterSubsystem(new TaskScheduler(context_));
 #ifdef URHO3D_PROFILING
     context_->RegisterSubsystem(new Profiler(context_));
 #endif
@@ -141,18 +164,18 @@ Engine::Engine(Context* context) :
     context_->RegisterSubsystem(new UI(context_));
 
     // Register object factories for libraries which are not automatically registered along with subsystem creation
-    RegisterSceneLibrary(context_);
+    context_->RegisterLibrary("Scene", RegisterSceneLibrary);
 
 #ifdef URHO3D_IK
-    RegisterIKLibrary(context_);
+    context_->RegisterLibrary("IK", RegisterIKLibrary);
 #endif
 
 #ifdef URHO3D_PHYSICS
-    RegisterPhysicsLibrary(context_);
+    context_->RegisterLibrary("Physics", RegisterPhysicsLibrary);
 #endif
 
 #ifdef URHO3D_NAVIGATION
-    RegisterNavigationLibrary(context_);
+    context_->RegisterLibrary("Navigation", RegisterNavigationLibrary);
 #endif
 
     SubscribeToEvent(E_EXITREQUESTED, URHO3D_HANDLER(Engine, HandleExitRequested));
@@ -170,6 +193,9 @@ bool Engine::Initialize(const VariantMap& parameters)
     // Set headless mode
     headless_ = GetParameter(parameters, EP_HEADLESS, false).GetBool();
 
+    // Register the postponed libraries now, unless they should be registered on first use
+    context_->SetLazyRegistration(GetParameter(parameters, EP_LAZY_REGISTRATION, false).GetBool());
+
     // Register the rest of the subsystems
     if (!headless_)
     {
@@ -179,12 +205,13 @@ bool Engine::Initialize(const VariantMap& parameters)
     else
     {
         // Register graphics library objects explicitly in headless mode to allow them to work without using actual GPU resources
-        RegisterGraphicsLibrary(context_);
+        context_->RegisterLibrary("Graphics", RegisterGraphicsLibrary);
     }
 
 #ifdef URHO3D_URHO2D
     // 2D graphics library is dependent on 3D graphics library
-    RegisterUrho2DLibrary(context_);
+    context_->RegisterLibrary("Urho2D", RegisterUrho2DLibrary);
+    context_->RegisterSubsystem(new SpriteAtlas2D(context_));
 #endif
 
     // Start logging
@@ -194,6 +221,7 @@ bool Engine::Initialize(const VariantMap& parameters)
         if (HasParameter(parameters, EP_LOG_LEVEL))
             log->SetLevel(GetParameter(parameters, EP_LOG_LEVEL).GetInt());
         log->SetQuiet(GetParameter(parameters, EP_LOG_QUIET, false).GetBool());
+        log->SetAsync(GetParameter(parameters, EP_LOG_ASYNC, false).GetBool());
         log->Open(GetParameter(parameters, EP_LOG_NAME, "Urho3D.log").GetString());
     }
 
@@ -204,6 +232,12 @@ bool Engine::Initialize(const VariantMap& parameters)
     if (GetParameter(parameters, EP_FRAME_LIMITER, true) == false)
         SetMaxFps(0);
 
+    if (GetParameter(parameters, EP_ALLOCATION_TRACKING, false).GetBool())
+        SetAllocationTracking(true);
+
+    SetPipelinedFrames(GetParameter(parameters, EP_PIPELINED_FRAMES, false).GetBool());
+    SetPacedTimeStep(GetParameter(parameters, EP_PACED_TIME_STEP, true).GetBool());
+
     // Set amount of worker threads according to the available physical CPU cores. Using also hyperthreaded cores results in
     // unpredictable extra synchronization overhead. Also reserve one core for the main thread
 #ifdef URHO3D_THREADING
@@ -312,6 +346,7 @@ bool Engine::Initialize(const VariantMap& parameters)
     }
 #endif
     frameTimer_.Reset();
+    lastFrameTime_ = 0;
 
     URHO3D_LOGINFO("Initialized engine");
     initialized_ = true;
@@ -495,6 +530,7 @@ void Engine::RunFrame()
 #endif
 
     time->BeginFrame(timeStep_);
+    bool pipelined = false;
 
     // If pause when minimized -mode is in use, stop updates and audio as necessary
     if (pauseMinimized_ && input->IsMinimized())
@@ -515,12 +551,27 @@ void Engine::RunFrame()
         }
 
         Update();
+        pipelined = pipelinedFrames_;
     }
 
+    // With pipelined frames, the worker threads start on the next frame's update while the main thread renders
+    if (pipelined)
+        BeginPipelinedUpdate();
+
     Render();
+
+    if (pipelined)
+    {
+        URHO3D_PROFILE(EndPipelinedUpdate);
+        SendEvent(E_ENDPIPELINEDUPDATE);
+    }
+
     ApplyFrameLimit();
 
     time->EndFrame();
+
+    if (GetAllocationTracking())
+        PublishAllocationStats();
 }
 
 Console* Engine::CreateConsole()
@@ -575,6 +626,21 @@ void Engine::SetMaxInactiveFps(int fps)
     maxInactiveFps_ = (unsigned)Max(fps, 0);
 }
 
+void Engine::SetGCTimeBudget(int usec)
+{
+    gcTimeBudget_ = Max(usec, 0);
+}
+
+void Engine::SetPipelinedFrames(bool enable)
+{
+    pipelinedFrames_ = enable;
+}
+
+void Engine::SetPacedTimeStep(bool enable)
+{
+    pacedTimeStep_ = enable;
+}
+
 void Engine::SetPauseMinimized(bool enable)
 {
     pauseMinimized_ = enable;
@@ -628,10 +694,10 @@ void Engine::DumpResources(bool dumpFileName)
         URHO3D_LOGRAW("Used resources:\n");
         for (HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups.Begin(); i != resourceGroups.End(); ++i)
         {
-            const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
+            const FlatHashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
             if (dumpFileName)
             {
-                for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
+                for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
                     URHO3D_LOGRAW(j->second_->GetName() + "\n");
             }
         }
@@ -644,6 +710,20 @@ void Engine::DumpResources(bool dumpFileName)
 void Engine::DumpMemory()
 {
 #ifdef URHO3D_LOGGING
+    for (unsigned i = 0; i < MAX_MEMORY_CATEGORIES; ++i)
+    {
+        auto category = (MemoryCategory)i;
+        PoolCategoryStats stats = GetPoolCategoryStats(category);
+        char line[256];
+        sprintf(line, "%-12s %10lld allocations %12lld bytes in use, %14lld allocations total\n", GetMemoryCategoryName(category),
+            stats.numAllocations_, stats.bytes_, stats.totalAllocations_);
+        URHO3D_LOGRAW(line);
+    }
+    URHO3D_LOGRAW("Pooled allocator reserved " + String(GetPoolReservedBytes()) + " bytes\n\n");
+
+    if (GetAllocationTracking())
+        URHO3D_LOGRAW(PrintAllocationStats() + "\n");
+
 #if defined(_MSC_VER) && defined(_DEBUG)
     _CrtMemState state;
     _CrtMemCheckpoint(&state);
@@ -675,12 +755,35 @@ void Engine::DumpMemory()
     }
 
     URHO3D_LOGRAW("Total allocated memory " + String(total) + " bytes in " + String(blocks) + " blocks\n\n");
-#else
-    URHO3D_LOGRAW("DumpMemory() supported on MSVC debug mode only\n\n");
 #endif
 #endif
 }
 
+void Engine::PublishAllocationStats()
+{
+    EndAllocationFrame();
+
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (!perfCounters)
+        return;
+
+    if (allocationCounters_.Empty())
+    {
+        for (unsigned i = 0; i < MAX_ALLOCATION_TAGS; ++i)
+            allocationCounters_.Push(perfCounters->GetCounter("Allocations" + String(GetAllocationTagName((AllocationTag)i))));
+        allocationCounters_.Push(perfCounters->GetCounter("AllocationBytes"));
+    }
+
+    long long bytes = 0;
+    for (unsigned i = 0; i < MAX_ALLOCATION_TAGS; ++i)
+    {
+        AllocationTagStats stats = GetAllocationTagStats((AllocationTag)i);
+        allocationCounters_[i]->Add((double)stats.frameAllocations_);
+        bytes += stats.frameBytes_;
+    }
+    allocationCounters_[MAX_ALLOCATION_TAGS]->Add((double)bytes);
+}
+
 void Engine::Update()
 {
     URHO3D_PROFILE(Update);
@@ -719,17 +822,42 @@ void Engine::Render()
     graphics->EndFrame();
 }
 
+void Engine::BeginPipelinedUpdate()
+{
+    URHO3D_PROFILE(BeginPipelinedUpdate);
+
+    // Rendering must not see the transforms that the pipelined update changes, so let the views take their own copies first
+    auto* renderer = GetSubsystem<Renderer>();
+    if (renderer)
+        renderer->SnapshotViews();
+
+    using namespace BeginPipelinedUpdate;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_TIMESTEP] = timeStep_;
+    SendEvent(E_BEGINPIPELINEDUPDATE, eventData);
+}
+
 void Engine::ApplyFrameLimit()
 {
     if (!initialized_)
         return;
 
+    // A headless process never has input focus, so the inactive limit does not apply to it
     unsigned maxFps = maxFps_;
     auto* input = GetSubsystem<Input>();
-    if (input && !input->HasFocus())
+    if (!headless_ && input && !input->HasFocus())
         maxFps = Min(maxInactiveFps_, maxFps);
 
-    long long elapsed = 0;
+    // The frame limit is kept on an absolute schedule: the deadline is one period after the previous frame boundary, so that
+    // waking up late shortens the next wait instead of accumulating into drift
+    long long period = maxFps ? 1000000LL / maxFps : 0;
+    long long deadline = lastFrameTime_ + period;
+    bool waited = false;
+
+    // Collect garbage in the time that would otherwise be spent waiting
+    long long spareTime = maxFps ? deadline - frameTimer_.GetUSec(false) : 0;
+    CollectGarbage(Clamp(spareTime, (long long)gcTimeBudget_ / 4, (long long)gcTimeBudget_));
 
 #ifndef __EMSCRIPTEN__
     // Perform waiting loop if maximum FPS set
@@ -743,25 +871,23 @@ void Engine::ApplyFrameLimit()
     {
         URHO3D_PROFILE(ApplyFrameLimit);
 
-        long long targetMax = 1000000LL / maxFps;
-
-        for (;;)
-        {
-            elapsed = frameTimer_.GetUSec(false);
-            if (elapsed >= targetMax)
-                break;
-
-            // Sleep if 1 ms or more off the frame limiting goal
-            if (targetMax - elapsed >= 1000LL)
-            {
-                auto sleepTime = (unsigned)((targetMax - elapsed) / 1000LL);
-                Time::Sleep(sleepTime);
-            }
-        }
+        // In headless mode and on mobile devices, trade frame timing accuracy for not spinning the CPU
+#if defined(__ANDROID__) || defined(IOS) || defined(TVOS)
+        WaitUntil(deadline, false);
+#else
+        WaitUntil(deadline, !headless_);
+#endif
+        waited = true;
     }
 #endif
 
-    elapsed = frameTimer_.GetUSec(true);
+    long long now = frameTimer_.GetUSec(false);
+    long long elapsed = now - lastFrameTime_;
+
+    // A frame that waited for its deadline stays on the schedule. A frame that was late by more than half a period restarts it
+    // from the current time rather than trying to catch up with a burst of short frames
+    bool onSchedule = waited && now - deadline < period / 2;
+    lastFrameTime_ = onSchedule ? deadline : now;
 #ifdef URHO3D_TESTING
     if (timeOut_ > 0)
     {
@@ -771,6 +897,23 @@ void Engine::ApplyFrameLimit()
     }
 #endif
 
+    // The frame will be presented one interval after the previous one, so use that interval as the timestep instead of the
+    // measured time which includes the wake-up or swap jitter
+    if (pacedTimeStep_)
+    {
+        long long vsyncPeriod;
+        if (onSchedule)
+            elapsed = period;
+        else if ((vsyncPeriod = GetVSyncPeriod()) != 0)
+        {
+            // With vertical sync the frames can only be presented at whole refresh periods, so snap measured times close to one
+            long long intervals = (elapsed + vsyncPeriod / 2) / vsyncPeriod;
+            long long snapped = intervals * vsyncPeriod;
+            if (intervals && elapsed - snapped < vsyncPeriod / 8 && snapped - elapsed < vsyncPeriod / 8)
+                elapsed = snapped;
+        }
+    }
+
     // If FPS lower than minimum, clamp elapsed time
     if (minFps_)
     {
@@ -794,6 +937,59 @@ void Engine::ApplyFrameLimit()
         timeStep_ = lastTimeSteps_.Back();
 }
 
+void Engine::WaitUntil(long long deadline, bool spin)
+{
+    for (;;)
+    {
+        long long now = frameTimer_.GetUSec(false);
+        long long remaining = deadline - now;
+        if (remaining <= 0)
+            break;
+
+        if (!spin)
+            Time::SleepUSec((unsigned)remaining);
+        else if (remaining > sleepMargin_)
+        {
+            long long sleepTime = remaining - sleepMargin_;
+            Time::SleepUSec((unsigned)sleepTime);
+
+            // Follow the worst oversleep immediately, but let the margin decay slowly so that a single late wake-up does not
+            // make the following frames spin for long
+            long long overshoot = frameTimer_.GetUSec(false) - now - sleepTime;
+            sleepMargin_ = Clamp(Max(overshoot + overshoot / 4, sleepMargin_ - sleepMargin_ / 32), MIN_SLEEP_MARGIN,
+                MAX_SLEEP_MARGIN);
+        }
+    }
+}
+
+long long Engine::GetVSyncPeriod() const
+{
+    auto* graphics = GetSubsystem<Graphics>();
+    if (headless_ || !graphics || !graphics->IsInitialized() || !graphics->GetVSync())
+        return 0;
+
+    // The refresh rate is only known when it was requested, otherwise it is the rate of the monitor the window is on
+    int refreshRate = graphics->GetRefreshRate();
+    if (refreshRate <= 0)
+        refreshRate = graphics->GetDesktopRefreshRate(graphics->GetCurrentMonitor());
+    return refreshRate > 0 ? 1000000LL / refreshRate : 0;
+}
+
+void Engine::CollectGarbage(long long budget)
+{
+    URHO3D_PROFILE(CollectGarbage);
+
+    HiresTimer gcTimer;
+
+    using namespace GarbageCollect;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_TIMEBUDGET] = (int)budget;
+    SendEvent(E_GARBAGECOLLECT, eventData);
+
+    gcTime_ = (int)gcTimer.GetUSec(false);
+}
+
 VariantMap Engine::ParseParameters(const Vector<String>& arguments)
 {
     VariantMap ret;
@@ -30,6 +30,7 @@ namespace Urho3D
 
 class Console;
 class DebugHud;
+class PerfCounter;
 
 /// Urho3D engine. Creates the other subsystems.
 class URHO3D_API Engine : public Object
@@ -58,6 +59,12 @@ public:
     void SetMaxFps(int fps);
     /// Set maximum frames per second when the application does not have input focus.
     void SetMaxInactiveFps(int fps);
+    /// Set the per-frame time budget in microseconds for incremental garbage collection of the script engines. The spare time before the frame limit is used up to the budget, and at least a quarter of it even without spare time so that collection keeps up. 0 leaves the collectors to run on their own. Default 1000.
+    void SetGCTimeBudget(int usec);
+    /// Set whether to pipeline frames, so that the worker thread part of the next frame's scene update runs while the current frame is being rendered. Default false.
+    void SetPipelinedFrames(bool enable);
+    /// Set whether to use the predicted presentation interval as the timestep when frames are paced by the frame limit or vertical sync, instead of the measured frame time which includes the wake-up jitter. Default true.
+    void SetPacedTimeStep(bool enable);
     /// Set how many frames to average for timestep smoothing. Default is 2. 1 disables smoothing.
     void SetTimeStepSmoothing(int frames);
     /// Set whether to pause update events and audio when minimized.
@@ -72,7 +79,7 @@ public:
     void DumpProfiler();
     /// Dump information of all resources to the log.
     void DumpResources(bool dumpFileName = false);
-    /// Dump information of all memory allocations to the log. Supported in MSVC debug mode only.
+    /// Dump statistics of the pooled allocator per memory category, and of the allocation tracker if enabled, to the log. In MSVC debug mode, also dump all heap memory allocations.
     void DumpMemory();
 
     /// Get timestep of the next frame. Updated by ApplyFrameLimit().
@@ -87,6 +94,18 @@ public:
     /// Return the maximum frames per second when the application does not have input focus.
     int GetMaxInactiveFps() const { return maxInactiveFps_; }
 
+    /// Return the per-frame garbage collection time budget in microseconds.
+    int GetGCTimeBudget() const { return gcTimeBudget_; }
+
+    /// Return the time spent in garbage collection during the last frame in microseconds.
+    int GetGCTime() const { return gcTime_; }
+
+    /// Return whether frames are pipelined.
+    bool GetPipelinedFrames() const { return pipelinedFrames_; }
+
+    /// Return whether the timestep follows the predicted presentation interval of paced frames.
+    bool GetPacedTimeStep() const { return pacedTimeStep_; }
+
     /// Return how many frames to average for timestep smoothing.
     int GetTimeStepSmoothing() const { return timeStepSmoothing_; }
 
@@ -125,11 +144,27 @@ private:
     void HandleExitRequested(StringHash eventType, VariantMap& eventData);
     /// Actually perform the exit actions.
     void DoExit();
+    /// Let the script engines collect garbage within a time budget.
+    void CollectGarbage(long long budget);
+    /// Take the render snapshot and start the pipelined update.
+    void BeginPipelinedUpdate();
+    /// Complete the allocation tracker frame and publish the per-frame allocation counts to the performance counters.
+    void PublishAllocationStats();
+    /// Wait until a frame timer deadline in microseconds. Sleeps for most of the wait and spins only for the part the sleep could overshoot, unless spinning is disabled.
+    void WaitUntil(long long deadline, bool spin);
+    /// Return the display refresh period in microseconds if presentation is synchronized to it, or 0 if not.
+    long long GetVSyncPeriod() const;
 
     /// Frame update timer.
     HiresTimer frameTimer_;
+    /// Frame timer value of the last frame boundary in microseconds. Follows the ideal schedule while paced frames are on time.
+    long long lastFrameTime_;
+    /// Time before a deadline in microseconds where waiting switches from sleeping to spinning. Adapts to the observed oversleep.
+    long long sleepMargin_;
     /// Previous timesteps for smoothing.
     PODVector<float> lastTimeSteps_;
+    /// Performance counters of allocations per tag, followed by allocated bytes. Created when allocation tracking is first published.
+    PODVector<PerfCounter*> allocationCounters_;
     /// Next frame timestep in seconds.
     float timeStep_;
     /// How many frames to average for the smoothed timestep.
@@ -142,6 +177,14 @@ private:
     unsigned maxInactiveFps_;
     /// Pause when minimized flag.
     bool pauseMinimized_;
+    /// Per-frame garbage collection time budget in microseconds.
+    int gcTimeBudget_;
+    /// Time spent in garbage collection during the last frame in microseconds.
+    int gcTime_;
+    /// Pipelined frames flag.
+    bool pipelinedFrames_;
+    /// Paced timestep flag.
+    bool pacedTimeStep_;
 #ifdef URHO3D_TESTING
     /// Time out counter for testing.
     long long timeOut_;
@@ -26,6 +26,7 @@ namespace Urho3D
 {
 
 // Engine parameters
+static const String EP_ALLOCATION_TRACKING = "AllocationTracking";
 static const String EP_AUTOLOAD_PATHS = "AutoloadPaths";
 static const String EP_BORDERLESS = "Borderless";
 static const String EP_DUMP_SHADERS = "DumpShaders";
@@ -37,15 +38,19 @@ static const String EP_FRAME_LIMITER = "FrameLimiter";
 static const String EP_FULL_SCREEN = "FullScreen";
 static const String EP_HEADLESS = "Headless";
 static const String EP_HIGH_DPI = "HighDPI";
+static const String EP_LAZY_REGISTRATION = "LazyRegistration";
 static const String EP_LOG_LEVEL = "LogLevel";
 static const String EP_LOG_NAME = "LogName";
 static const String EP_LOG_QUIET = "LogQuiet";
+static const String EP_LOG_ASYNC = "LogAsync";
 static const String EP_LOW_QUALITY_SHADOWS = "LowQualityShadows";
 static const String EP_MATERIAL_QUALITY = "MaterialQuality";
 static const String EP_MONITOR = "Monitor";
 static const String EP_MULTI_SAMPLE = "MultiSample";
 static const String EP_ORIENTATIONS = "Orientations";
+static const String EP_PACED_TIME_STEP = "PacedTimeStep";
 static const String EP_PACKAGE_CACHE_DIR = "PackageCacheDir";
+static const String EP_PIPELINED_FRAMES = "PipelinedFrames";
 static const String EP_RENDER_PATH = "RenderPath";
 static const String EP_REFRESH_RATE = "RefreshRate";
 static const String EP_RESOURCE_PACKAGES = "ResourcePackages";
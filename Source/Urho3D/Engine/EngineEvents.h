@@ -34,4 +34,10 @@ URHO3D_EVENT(E_CONSOLECOMMAND, ConsoleCommand)
     URHO3D_PARAM(P_ID, Id);                        // String
 }
 
+/// Time for incremental garbage collection of the script engines, sent by the engine before frame limiting. Handlers should subtract the time they spend from the budget. A zero budget means the collectors should run on their own.
+URHO3D_EVENT(E_GARBAGECOLLECT, GarbageCollect)
+{
+    URHO3D_PARAM(P_TIMEBUDGET, TimeBudget);        // int (microseconds)
+}
+
 }
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Engine/SimulationThread.h"
+#include "../Graphics/Graphics.h"
+#include "../IO/FileSystem.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Scene.h"
+#ifdef URHO3D_NETWORK
+#include "../Network/Network.h"
+#endif
+#ifdef URHO3D_NAVIGATION
+#include "../Navigation/NavigationMesh.h"
+#endif
+#ifdef URHO3D_PHYSICS
+#include "../Physics/PhysicsWorld.h"
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+SimulationThread::SimulationThread() :
+    updateFps_(60)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::SetUpdateFps(int fps)
+{
+    updateFps_ = Max(fps, 1);
+}
+
+void SimulationThread::ThreadFunction()
+{
+    // The context must be created in the thread, so that the thread becomes its main thread. Log messages are queued to the
+    // Log of the main thread, as the Log is shared by the whole process
+    Thread::SetContextThread(true);
+    context_ = new Context();
+
+    // Each simulation has its own subsystems. The work queue has no threads of its own, as the simulations already run in
+    // parallel
+    context_->RegisterSubsystem(new Time(context_));
+    context_->RegisterSubsystem(new WorkQueue(context_));
+    context_->RegisterSubsystem(new FileSystem(context_));
+    context_->RegisterSubsystem(new ResourceCache(context_));
+#ifdef URHO3D_NETWORK
+    context_->RegisterSubsystem(new Network(context_));
+#endif
+    context_->RegisterLibrary("Scene", RegisterSceneLibrary);
+    context_->RegisterLibrary("Graphics", RegisterGraphicsLibrary);
+#ifdef URHO3D_PHYSICS
+    context_->RegisterLibrary("Physics", RegisterPhysicsLibrary);
+#endif
+#ifdef URHO3D_NAVIGATION
+    context_->RegisterLibrary("Navigation", RegisterNavigationLibrary);
+#endif
+
+    if (Start())
+    {
+        auto* time = context_->GetSubsystem<Time>();
+        float timeStep = 1.0f / updateFps_;
+        long long frameUSec = 1000000LL / updateFps_;
+        HiresTimer frameTimer;
+
+        while (shouldRun_)
+        {
+            // Send the same frame events as the Engine, so that scenes, physics and network replication update as usual
+            time->BeginFrame(timeStep);
+
+            using namespace Update;
+
+            VariantMap& eventData = context_->GetEventDataMap();
+            eventData[P_TIMESTEP] = timeStep;
+            time->SendEvent(E_UPDATE, eventData);
+            time->SendEvent(E_POSTUPDATE, eventData);
+            time->SendEvent(E_RENDERUPDATE, eventData);
+            time->SendEvent(E_POSTRENDERUPDATE, eventData);
+
+            time->EndFrame();
+
+            // Run at a fixed rate. When behind, the next frame starts right away
+            long long elapsed = frameTimer.GetUSec(true);
+            if (elapsed < frameUSec)
+            {
+                Time::Sleep((unsigned)((frameUSec - elapsed) / 1000));
+                frameTimer.Reset();
+            }
+        }
+    }
+
+    Shutdown();
+    context_.Reset();
+    Thread::SetContextThread(false);
+}
+
+}
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Thread.h"
+
+namespace Urho3D
+{
+
+class Context;
+
+/// Runs an independent simulation, such as a server match, in a worker thread with its own Context, subsystems, scenes and update loop, so that several simulations can run concurrently in one process. The thread acts as the main thread of its context. Subclass to create the scenes in Start().
+class URHO3D_API SimulationThread : public RefCounted, public Thread
+{
+public:
+    /// Construct. Does not start the thread yet.
+    SimulationThread();
+    /// Destruct. Stop the thread.
+    ~SimulationThread() override;
+
+    /// Create the context and run the update loop until stopped.
+    void ThreadFunction() override;
+
+    /// Set the number of updates per second. Takes effect when the thread is started. Default 60.
+    void SetUpdateFps(int fps);
+
+    /// Return the number of updates per second.
+    int GetUpdateFps() const { return updateFps_; }
+
+    /// Return the context of the simulation, or null if not running. Only to be accessed from the simulation thread.
+    Context* GetContext() const { return context_; }
+
+protected:
+    /// Set up the simulation in the thread, for example create the scenes, load resources and start a Network server on a port of its own. Return false to exit the thread.
+    virtual bool Start() = 0;
+    /// Clean up in the thread before the context is destroyed.
+    virtual void Shutdown() { }
+
+private:
+    /// Context of the simulation.
+    SharedPtr<Context> context_;
+    /// Updates per second.
+    int updateFps_;
+};
+
+}
@@ -0,0 +1,544 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/AnimatedCrowd.h"
+#include "../Graphics/Animation.h"
+#include "../Graphics/Batch.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/Log.h"
+#include "../Math/Sphere.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+
+static const String BAKEDANIM_DEFINE("BAKEDANIM");
+static const String BAKEDANIM_OFFSET_PARAM("BakedAnimOffset");
+static const float DEFAULT_BAKE_FPS = 30.0f;
+static const int MAX_BAKED_TEXTURE_SIZE = 8192;
+
+/// Return the transform of a bone relative to the model, resolving its parents first.
+static const Matrix3x4& GetModelSpaceTransform(const Vector<Bone>& bones, const PODVector<Matrix3x4>& localTransforms,
+    PODVector<Matrix3x4>& modelTransforms, PODVector<bool>& resolved, unsigned index)
+{
+    if (!resolved[index])
+    {
+        unsigned parentIndex = bones[index].parentIndex_;
+        if (parentIndex == index || parentIndex >= bones.Size())
+            modelTransforms[index] = localTransforms[index];
+        else
+        {
+            modelTransforms[index] = GetModelSpaceTransform(bones, localTransforms, modelTransforms, resolved, parentIndex) *
+                localTransforms[index];
+        }
+        resolved[index] = true;
+    }
+
+    return modelTransforms[index];
+}
+
+AnimatedCrowd::AnimatedCrowd(Context* context) :
+    StaticModelGroup(context),
+    animationsAttr_(Animation::GetTypeStatic()),
+    bakeFps_(DEFAULT_BAKE_FPS)
+{
+}
+
+AnimatedCrowd::~AnimatedCrowd() = default;
+
+void AnimatedCrowd::RegisterObject(Context* context)
+{
+    context->RegisterFactory<AnimatedCrowd>(GEOMETRY_CATEGORY);
+
+    URHO3D_COPY_BASE_ATTRIBUTES(StaticModelGroup);
+    URHO3D_ACCESSOR_ATTRIBUTE("Bake FPS", GetBakeFps, SetBakeFps, float, DEFAULT_BAKE_FPS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animations", GetAnimationsAttr, SetAnimationsAttr, ResourceRefList,
+        ResourceRefList(Animation::GetTypeStatic()), AM_DEFAULT);
+}
+
+void AnimatedCrowd::UpdateBatches(const FrameInfo& frame)
+{
+    StaticModelGroup::UpdateBatches(frame);
+
+    // The instance animations are only available from the crowd's own instancing buffer
+    if (drawBaked_)
+    {
+        VertexBuffer* instancingBuffer = batches_.Size() && batches_[0].numWorldTransforms_ ? crowdInstancingBuffer_.Get() : nullptr;
+        for (unsigned i = 0; i < batches_.Size(); ++i)
+            batches_[i].instancingBuffer_ = instancingBuffer;
+    }
+}
+
+void AnimatedCrowd::UpdateGeometry(const FrameInfo& frame)
+{
+    StaticModelGroup::UpdateGeometry(frame);
+
+    if (animationTexture_ && animationTexture_->IsDataLost())
+        Bake();
+
+    bool drawBaked = CanDrawBaked();
+    if (drawBaked != drawBaked_)
+    {
+        drawBaked_ = drawBaked;
+        instancesDirty_ = true;
+        ApplyMaterials();
+    }
+
+    if (drawBaked_ && (instancesDirty_ || crowdInstancingBuffer_->IsDataLost()))
+        UploadInstances();
+}
+
+UpdateGeometryType AnimatedCrowd::GetUpdateGeometryType()
+{
+    if ((animationTexture_ && animationTexture_->IsDataLost()) || CanDrawBaked() != drawBaked_ ||
+        (drawBaked_ && (instancesDirty_ || crowdInstancingBuffer_->IsDataLost())))
+        return UPDATE_MAIN_THREAD;
+    else
+        return StaticModelGroup::GetUpdateGeometryType();
+}
+
+void AnimatedCrowd::SetModel(Model* model)
+{
+    if (model == model_)
+        return;
+
+    StaticModelGroup::SetModel(model);
+    materials_.Resize(batches_.Size());
+    Bake();
+}
+
+void AnimatedCrowd::SetMaterial(Material* material)
+{
+    for (unsigned i = 0; i < materials_.Size(); ++i)
+        materials_[i] = material;
+
+    UpdateMaterials();
+    MarkNetworkUpdate();
+}
+
+bool AnimatedCrowd::SetMaterial(unsigned index, Material* material)
+{
+    if (index >= materials_.Size())
+    {
+        URHO3D_LOGERROR("Material index out of bounds");
+        return false;
+    }
+
+    materials_[index] = material;
+    UpdateMaterials();
+    MarkNetworkUpdate();
+    return true;
+}
+
+void AnimatedCrowd::AddAnimation(Animation* animation)
+{
+    if (!animation)
+        return;
+
+    animations_.Push(SharedPtr<Animation>(animation));
+    Bake();
+    MarkNetworkUpdate();
+}
+
+void AnimatedCrowd::RemoveAllAnimations()
+{
+    animations_.Clear();
+    Bake();
+    MarkNetworkUpdate();
+}
+
+void AnimatedCrowd::SetBakeFps(float fps)
+{
+    fps = Max(fps, 1.0f);
+    if (fps == bakeFps_)
+        return;
+
+    bakeFps_ = fps;
+    Bake();
+    MarkNetworkUpdate();
+}
+
+void AnimatedCrowd::SetInstanceAnimation(Node* node, unsigned index, float time, float speed)
+{
+    if (!node)
+        return;
+
+    Scene* scene = GetScene();
+    CrowdInstanceAnimation& playback = instanceAnimations_[node->GetID()];
+    playback.clip_ = index;
+    playback.time_ = time;
+    playback.speed_ = speed;
+    playback.sceneTime_ = scene ? scene->GetElapsedTime() : 0.0f;
+    instancesDirty_ = true;
+}
+
+Material* AnimatedCrowd::GetMaterial(unsigned index) const
+{
+    return index < materials_.Size() ? materials_[index] : nullptr;
+}
+
+Animation* AnimatedCrowd::GetAnimation(unsigned index) const
+{
+    return index < animations_.Size() ? animations_[index] : nullptr;
+}
+
+unsigned AnimatedCrowd::GetInstanceAnimation(Node* node) const
+{
+    HashMap<unsigned, CrowdInstanceAnimation>::ConstIterator i = node ? instanceAnimations_.Find(node->GetID()) :
+        instanceAnimations_.End();
+    return i != instanceAnimations_.End() ? i->second_.clip_ : 0;
+}
+
+float AnimatedCrowd::GetInstanceTime(Node* node) const
+{
+    HashMap<unsigned, CrowdInstanceAnimation>::ConstIterator i = node ? instanceAnimations_.Find(node->GetID()) :
+        instanceAnimations_.End();
+    CrowdInstanceAnimation playback = i != instanceAnimations_.End() ? i->second_ : CrowdInstanceAnimation();
+    Animation* animation = GetAnimation(playback.clip_);
+    if (!animation || animation->GetLength() <= 0.0f)
+        return 0.0f;
+
+    Scene* scene = GetScene();
+    float sceneTime = scene ? scene->GetElapsedTime() : 0.0f;
+    float time = fmodf(playback.time_ + (sceneTime - playback.sceneTime_) * playback.speed_, animation->GetLength());
+    return time < 0.0f ? time + animation->GetLength() : time;
+}
+
+void AnimatedCrowd::SetAnimationsAttr(const ResourceRefList& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    animations_.Clear();
+    for (unsigned i = 0; i < value.names_.Size(); ++i)
+    {
+        auto* animation = cache->GetResource<Animation>(value.names_[i]);
+        if (animation)
+            animations_.Push(SharedPtr<Animation>(animation));
+    }
+
+    Bake();
+}
+
+const ResourceRefList& AnimatedCrowd::GetAnimationsAttr() const
+{
+    animationsAttr_.names_.Resize(animations_.Size());
+    for (unsigned i = 0; i < animations_.Size(); ++i)
+        animationsAttr_.names_[i] = GetResourceName(animations_[i]);
+
+    return animationsAttr_;
+}
+
+void AnimatedCrowd::OnWorldBoundingBoxUpdate()
+{
+    StaticModelGroup::OnWorldBoundingBoxUpdate();
+    instancesDirty_ = true;
+}
+
+void AnimatedCrowd::Bake()
+{
+    clips_.Clear();
+    geometryColumns_.Clear();
+    animationTexture_.Reset();
+    instancesDirty_ = true;
+
+    if (!model_ || animations_.Empty() || !model_->GetSkeleton().GetNumBones())
+    {
+        if (model_)
+            SetBoundingBox(model_->GetBoundingBox());
+        UpdateMaterials();
+        return;
+    }
+
+    URHO3D_PROFILE(BakeCrowdAnimations);
+
+    const Vector<Bone>& bones = model_->GetSkeleton().GetBones();
+    const Vector<PODVector<unsigned> >& boneMappings = model_->GetGeometryBoneMappings();
+    unsigned numBones = bones.Size();
+
+    // Geometries with a bone mapping index their own subset of the bones, the others index the whole skeleton.
+    // Each bone takes three texels holding the rows of its skin matrix
+    PODVector<unsigned> columnBones;
+    unsigned skeletonColumn = M_MAX_UNSIGNED;
+    geometryColumns_.Resize(batches_.Size());
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        if (i < boneMappings.Size() && !boneMappings[i].Empty())
+        {
+            geometryColumns_[i] = columnBones.Size() * 3;
+            columnBones.Push(boneMappings[i]);
+        }
+        else
+        {
+            if (skeletonColumn == M_MAX_UNSIGNED)
+            {
+                skeletonColumn = columnBones.Size() * 3;
+                for (unsigned j = 0; j < numBones; ++j)
+                    columnBones.Push(j);
+            }
+            geometryColumns_[i] = skeletonColumn;
+        }
+    }
+
+    // Each animation frame takes one texture row
+    int width = columnBones.Size() * 3;
+    int height = 0;
+    for (unsigned i = 0; i < animations_.Size(); ++i)
+    {
+        float length = animations_[i]->GetLength();
+        BakedAnimationClip clip;
+        clip.firstRow_ = (unsigned)height;
+        clip.numFrames_ = (unsigned)Max(RoundToInt(length * bakeFps_), 1);
+        clip.frameRate_ = length > 0.0f ? clip.numFrames_ / length : 0.0f;
+        clips_.Push(clip);
+        height += clip.numFrames_;
+    }
+
+    if (width > MAX_BAKED_TEXTURE_SIZE || height > MAX_BAKED_TEXTURE_SIZE)
+    {
+        URHO3D_LOGERRORF("Baked crowd animations need a %dx%d texture, exceeding the maximum size %d", width, height,
+            MAX_BAKED_TEXTURE_SIZE);
+        clips_.Clear();
+        geometryColumns_.Clear();
+        UpdateMaterials();
+        return;
+    }
+
+    PODVector<float> data((unsigned)(width * height * 4));
+    PODVector<Matrix3x4> localTransforms(numBones);
+    PODVector<Matrix3x4> modelTransforms(numBones);
+    PODVector<bool> resolved(numBones);
+    PODVector<const AnimationTrack*> tracks(numBones);
+    PODVector<unsigned> keyFrames(numBones);
+    PODVector<float> samples;
+    BoundingBox boundingBox = model_->GetBoundingBox();
+
+    for (unsigned i = 0; i < animations_.Size(); ++i)
+    {
+        Animation* animation = animations_[i];
+        const BakedAnimationClip& clip = clips_[i];
+        bool compressed = animation->IsCompressed();
+        if (compressed)
+            samples.Resize(animation->GetSampleBufferSize());
+
+        for (unsigned j = 0; j < numBones; ++j)
+        {
+            tracks[j] = bones[j].animated_ ? animation->GetTrack(bones[j].nameHash_) : nullptr;
+            keyFrames[j] = 0;
+        }
+
+        for (unsigned frame = 0; frame < clip.numFrames_; ++frame)
+        {
+            float time = clip.frameRate_ > 0.0f ? frame / clip.frameRate_ : 0.0f;
+            if (compressed)
+                animation->Sample(time, true, samples.Buffer());
+
+            for (unsigned j = 0; j < numBones; ++j)
+            {
+                const Bone& bone = bones[j];
+                const AnimationTrack* track = tracks[j];
+                Vector3 position = bone.initialPosition_;
+                Quaternion rotation = bone.initialRotation_;
+                Vector3 scale = bone.initialScale_;
+
+                if (track && compressed)
+                {
+                    const unsigned* offsets = track->sampleOffsets_;
+                    if (offsets[0] != M_MAX_UNSIGNED)
+                        position = Vector3(&samples[offsets[0]]);
+                    if (offsets[1] != M_MAX_UNSIGNED)
+                        rotation = Quaternion(&samples[offsets[1]]).Normalized();
+                    if (offsets[2] != M_MAX_UNSIGNED)
+                        scale = Vector3(&samples[offsets[2]]);
+                }
+                else if (track && !track->keyFrames_.Empty())
+                {
+                    Vector3 trackPosition;
+                    Quaternion trackRotation;
+                    Vector3 trackScale;
+                    track->Sample(time, animation->GetLength(), true, keyFrames[j], trackPosition, trackRotation, trackScale);
+                    if (track->channelMask_ & CHANNEL_POSITION)
+                        position = trackPosition;
+                    if (track->channelMask_ & CHANNEL_ROTATION)
+                        rotation = trackRotation;
+                    if (track->channelMask_ & CHANNEL_SCALE)
+                        scale = trackScale;
+                }
+
+                localTransforms[j] = Matrix3x4(position, rotation, scale);
+                resolved[j] = false;
+            }
+
+            for (unsigned j = 0; j < numBones; ++j)
+            {
+                const Matrix3x4& transform = GetModelSpaceTransform(bones, localTransforms, modelTransforms, resolved, j);
+
+                // Grow the bounding box to contain the animated bones
+                const Bone& bone = bones[j];
+                if (bone.collisionMask_ & BONECOLLISION_BOX)
+                    boundingBox.Merge(bone.boundingBox_.Transformed(transform));
+                if (bone.collisionMask_ & BONECOLLISION_SPHERE)
+                    boundingBox.Merge(Sphere(transform.Translation(), bone.radius_ * transform.Scale().x_));
+            }
+
+            float* dest = &data[(clip.firstRow_ + frame) * width * 4];
+            for (unsigned j = 0; j < columnBones.Size(); ++j)
+            {
+                unsigned boneIndex = columnBones[j];
+                Matrix3x4 skinMatrix = boneIndex < numBones ? modelTransforms[boneIndex] * bones[boneIndex].offsetMatrix_ :
+                    Matrix3x4::IDENTITY;
+                memcpy(dest, skinMatrix.Data(), sizeof(Matrix3x4));
+                dest += 12;
+            }
+        }
+    }
+
+    SetBoundingBox(boundingBox);
+
+    // Without instancing the baked animation could not be drawn
+    auto* graphics = GetSubsystem<Graphics>();
+    if (graphics && graphics->GetInstancingSupport())
+    {
+        animationTexture_ = new Texture2D(context_);
+        animationTexture_->SetNumLevels(1);
+        animationTexture_->SetFilterMode(FILTER_NEAREST);
+        animationTexture_->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+        animationTexture_->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+        if (!animationTexture_->SetSize(width, height, Graphics::GetRGBAFloat32Format()) ||
+            !animationTexture_->SetData(0, 0, 0, width, height, data.Buffer()))
+        {
+            URHO3D_LOGERROR("Failed to create animation texture for crowd");
+            animationTexture_.Reset();
+        }
+        else if (!crowdInstancingBuffer_)
+            crowdInstancingBuffer_ = new VertexBuffer(context_);
+    }
+
+    UpdateMaterials();
+}
+
+void AnimatedCrowd::UpdateMaterials()
+{
+    bakedMaterials_.Clear();
+
+    if (animationTexture_)
+    {
+        auto* renderer = GetSubsystem<Renderer>();
+        Material* defaultMaterial = renderer ? renderer->GetDefaultMaterial() : nullptr;
+
+        bakedMaterials_.Resize(materials_.Size());
+        for (unsigned i = 0; i < materials_.Size(); ++i)
+        {
+            Material* material = materials_[i] ? materials_[i].Get() : defaultMaterial;
+            if (!material || i >= geometryColumns_.Size())
+                continue;
+
+            SharedPtr<Material> bakedMaterial = material->Clone();
+            bakedMaterial->SetVertexShaderDefines((material->GetVertexShaderDefines() + " " + BAKEDANIM_DEFINE).Trimmed());
+            bakedMaterial->SetTexture(TU_CUSTOM1, animationTexture_);
+            bakedMaterial->SetShaderParameter(BAKEDANIM_OFFSET_PARAM, (float)geometryColumns_[i]);
+            bakedMaterials_[i] = bakedMaterial;
+        }
+    }
+
+    ApplyMaterials();
+}
+
+void AnimatedCrowd::ApplyMaterials()
+{
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        Material* bakedMaterial = drawBaked_ && i < bakedMaterials_.Size() ? bakedMaterials_[i].Get() : nullptr;
+        batches_[i].material_ = bakedMaterial ? bakedMaterial : GetMaterial(i);
+    }
+}
+
+void AnimatedCrowd::UploadInstances()
+{
+    instancesDirty_ = false;
+
+    // Use the same vertex layout as the shared instancing buffer, as the instancing shaders expect it
+    auto* renderer = GetSubsystem<Renderer>();
+    VertexBuffer* sharedBuffer = renderer ? renderer->GetInstancingBuffer() : nullptr;
+    unsigned numInstances = GetNumInstanceNodes();
+    if (!sharedBuffer || !numInstances)
+        return;
+
+    const PODVector<VertexElement>& elements = sharedBuffer->GetElements();
+    if (crowdInstancingBuffer_->GetVertexCount() < numInstances || crowdInstancingBuffer_->GetElements() != elements)
+        crowdInstancingBuffer_->SetSize(numInstances, elements, true);
+    crowdInstancingBuffer_->ClearDataLost();
+
+    // The first extra element holds x = first texture row of the animation, y = number of frames, z = frames per second of
+    // scene time and w = frame at scene time zero. The shader derives the frame from the scene elapsed time, so the
+    // buffer only changes when instances move or change animation
+    unsigned vertexSize = crowdInstancingBuffer_->GetVertexSize();
+    PODVector<unsigned char> data(numInstances * vertexSize);
+    memset(data.Buffer(), 0, data.Size());
+    unsigned char* dest = data.Buffer();
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        Node* node = GetInstanceNode(i);
+        if (!node || !node->IsEnabled())
+            continue;
+
+        HashMap<unsigned, CrowdInstanceAnimation>::ConstIterator j = instanceAnimations_.Find(node->GetID());
+        CrowdInstanceAnimation playback = j != instanceAnimations_.End() ? j->second_ : CrowdInstanceAnimation();
+        const BakedAnimationClip& clip = clips_[Min(playback.clip_, clips_.Size() - 1)];
+        float frameRate = clip.frameRate_ * playback.speed_;
+        float frameOffset = fmodf(playback.time_ * clip.frameRate_ - playback.sceneTime_ * frameRate, (float)clip.numFrames_);
+        Vector4 animation((float)clip.firstRow_, (float)clip.numFrames_, frameRate, frameOffset);
+
+        memcpy(dest, &node->GetWorldTransform(), sizeof(Matrix3x4));
+        memcpy(dest + sizeof(Matrix3x4), &animation, sizeof(Vector4));
+        dest += vertexSize;
+        ++count;
+    }
+
+    if (count)
+        crowdInstancingBuffer_->SetDataRange(data.Buffer(), 0, count);
+}
+
+bool AnimatedCrowd::CanDrawBaked() const
+{
+    if (!animationTexture_ || !crowdInstancingBuffer_)
+        return false;
+
+    auto* renderer = GetSubsystem<Renderer>();
+    return renderer && renderer->GetDynamicInstancing() && renderer->GetNumExtraInstancingBufferElements() > 0;
+}
+
+}
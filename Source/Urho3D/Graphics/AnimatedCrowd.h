@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Graphics/StaticModelGroup.h"
+
+namespace Urho3D
+{
+
+class Animation;
+class Texture2D;
+class VertexBuffer;
+
+/// Rows of one animation in the baked animation texture.
+struct BakedAnimationClip
+{
+    /// First texture row.
+    unsigned firstRow_{};
+    /// Number of rows, one per frame.
+    unsigned numFrames_{};
+    /// Frames per second of animation time.
+    float frameRate_{};
+};
+
+/// Animation playback of one crowd instance.
+struct CrowdInstanceAnimation
+{
+    /// Animation index.
+    unsigned clip_{};
+    /// Animation time at the scene time below.
+    float time_{};
+    /// Playback speed.
+    float speed_{1.0f};
+    /// Scene elapsed time when the playback was set.
+    float sceneTime_{};
+};
+
+/// Renders instances of a skinned model with animations baked into a texture, so that all instances are drawn with hardware instancing. The skin matrices of each animation frame are stored in a texture row, and each instance selects its animation and time through the first extra instancing buffer element. Animations always loop and are not blended. Requires instancing, at least one extra instancing buffer element and OpenGL 3 or Direct3D 11; otherwise the instances are drawn in the bind pose.
+class URHO3D_API AnimatedCrowd : public StaticModelGroup
+{
+    URHO3D_OBJECT(AnimatedCrowd, StaticModelGroup);
+
+public:
+    /// Construct.
+    explicit AnimatedCrowd(Context* context);
+    /// Destruct.
+    ~AnimatedCrowd() override;
+    /// Register object factory. StaticModelGroup must be registered first.
+    static void RegisterObject(Context* context);
+
+    /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
+    void UpdateBatches(const FrameInfo& frame) override;
+    /// Prepare geometry for rendering. Uploads the instance transforms and animations.
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
+
+    /// Set model. The model must have a skeleton.
+    void SetModel(Model* model) override;
+    /// Set material on all geometries.
+    void SetMaterial(Material* material) override;
+    /// Set material on one geometry. Return true if successful.
+    bool SetMaterial(unsigned index, Material* material) override;
+    /// Add an animation to bake. Its index selects it in SetInstanceAnimation().
+    void AddAnimation(Animation* animation);
+    /// Remove all animations.
+    void RemoveAllAnimations();
+    /// Set animation sampling rate in frames per second.
+    void SetBakeFps(float fps);
+    /// Set the animation of an instance node, the animation time to start from and the playback speed.
+    void SetInstanceAnimation(Node* node, unsigned index, float time = 0.0f, float speed = 1.0f);
+
+    /// Return material of the first geometry.
+    Material* GetMaterial() const override { return GetMaterial(0); }
+    /// Return material by geometry index.
+    Material* GetMaterial(unsigned index) const override;
+
+    /// Return number of animations.
+    unsigned GetNumAnimations() const { return animations_.Size(); }
+
+    /// Return animation by index.
+    Animation* GetAnimation(unsigned index) const;
+
+    /// Return animation sampling rate.
+    float GetBakeFps() const { return bakeFps_; }
+
+    /// Return the animation index of an instance node.
+    unsigned GetInstanceAnimation(Node* node) const;
+    /// Return the current animation time of an instance node.
+    float GetInstanceTime(Node* node) const;
+
+    /// Return the baked animation texture.
+    Texture2D* GetAnimationTexture() const { return animationTexture_; }
+
+    /// Set animations attribute.
+    void SetAnimationsAttr(const ResourceRefList& value);
+    /// Return animations attribute.
+    const ResourceRefList& GetAnimationsAttr() const;
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    /// Sample the skin matrices of the animations into the animation texture and recreate the materials.
+    void Bake();
+    /// Recreate the materials that read the animation texture.
+    void UpdateMaterials();
+    /// Assign the baked or the original materials to the batches.
+    void ApplyMaterials();
+    /// Upload the instance transforms and animations to the instancing buffer.
+    void UploadInstances();
+    /// Return whether the baked animation can be drawn.
+    bool CanDrawBaked() const;
+
+    /// Animations.
+    Vector<SharedPtr<Animation> > animations_;
+    /// Texture rows of the animations.
+    PODVector<BakedAnimationClip> clips_;
+    /// Playback of the instance nodes by node ID.
+    HashMap<unsigned, CrowdInstanceAnimation> instanceAnimations_;
+    /// Materials as set, by geometry.
+    Vector<SharedPtr<Material> > materials_;
+    /// Materials with the baked animation shader define, by geometry.
+    Vector<SharedPtr<Material> > bakedMaterials_;
+    /// First texture column of each geometry's bones.
+    PODVector<unsigned> geometryColumns_;
+    /// Skin matrices of all animation frames.
+    SharedPtr<Texture2D> animationTexture_;
+    /// Instancing buffer holding the transforms and animations.
+    SharedPtr<VertexBuffer> crowdInstancingBuffer_;
+    /// Animations attribute.
+    mutable ResourceRefList animationsAttr_;
+    /// Animation sampling rate.
+    float bakeFps_;
+    /// Whether the batches use the baked materials.
+    bool drawBaked_{};
+    /// Whether the instancing buffer needs to be uploaded.
+    bool instancesDirty_{};
+};
+
+}
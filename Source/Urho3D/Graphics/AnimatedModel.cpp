@@ -26,6 +26,7 @@
 #include "../Core/Profiler.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
+#include "../Graphics/AnimationLodPolicy.h"
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -67,6 +68,14 @@ static bool CompareAnimationOrder(const SharedPtr<AnimationState>& lhs, const Sh
 
 static const unsigned MAX_ANIMATION_STATES = 256;
 
+static float GetScreenCoverage(const Camera* camera, float distance, float scale)
+{
+    float viewSize = 2.0f * camera->GetHalfViewSize();
+    if (!camera->IsOrthographic())
+        viewSize *= distance;
+    return scale / Max(viewSize, M_EPSILON);
+}
+
 AnimatedModel::AnimatedModel(Context* context) :
     StaticModel(context),
     animationLodFrameNumber_(0),
@@ -74,7 +83,12 @@ AnimatedModel::AnimatedModel(Context* context) :
     animationLodBias_(1.0f),
     animationLodTimer_(-1.0f),
     animationLodDistance_(0.0f),
+    animationLodCoverage_(M_LARGE_VALUE),
+    poseBlend_(1.0f),
+    animationLodUpdateFrame_(0),
+    animationLodInterval_(1),
     updateInvisible_(false),
+    preSkinning_(false),
     animationDirty_(false),
     animationOrderDirty_(false),
     morphsDirty_(false),
@@ -83,7 +97,10 @@ AnimatedModel::AnimatedModel(Context* context) :
     isMaster_(true),
     loading_(false),
     assignBonesPending_(false),
-    forceAnimationUpdate_(false)
+    forceAnimationUpdate_(false),
+    latePosePending_(false),
+    animationLodMaskBones_(false),
+    animationLodMaskDirty_(true)
 {
 }
 
@@ -115,6 +132,9 @@ void AnimatedModel::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Shadow Distance", GetShadowDistance, SetShadowDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Bias", GetAnimationLodBias, SetAnimationLodBias, float, 1.0f, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Animation LOD Policy", GetAnimationLodPolicyAttr, SetAnimationLodPolicyAttr, ResourceRef,
+        ResourceRef(AnimationLodPolicy::GetTypeStatic()), AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Pre-Skinning", GetPreSkinning, SetPreSkinning, bool, false, AM_DEFAULT);
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Bone Animation Enabled", GetBonesEnabledAttr, SetBonesEnabledAttr, VariantVector,
         Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
@@ -248,6 +268,7 @@ void AnimatedModel::Update(const FrameInfo& frame)
             return;
         float scale = GetWorldBoundingBox().Size().DotProduct(DOT_SCALE);
         animationLodDistance_ = frame.camera_->GetLodDistance(distance, scale, lodBias_);
+        animationLodCoverage_ = -1.0f;
     }
 
     if (animationDirty_ || animationOrderDirty_)
@@ -277,20 +298,28 @@ void AnimatedModel::UpdateBatches(const FrameInfo& frame)
     BoundingBox transformedBoundingBox = boundingBox_.Transformed(worldTransform);
     float scale = transformedBoundingBox.Size().DotProduct(DOT_SCALE);
     float newLodDistance = frame.camera_->GetLodDistance(distance_, scale, lodBias_);
+    float newCoverage = GetScreenCoverage(frame.camera_, distance_, scale);
 
-    // If model is rendered from several views, use the minimum LOD distance for animation LOD
+    // If model is rendered from several views, use the minimum LOD distance and maximum coverage for animation LOD
     if (frame.frameNumber_ != animationLodFrameNumber_)
     {
         animationLodDistance_ = newLodDistance;
+        animationLodCoverage_ = newCoverage;
         animationLodFrameNumber_ = frame.frameNumber_;
     }
     else
+    {
         animationLodDistance_ = Min(animationLodDistance_, newLodDistance);
+        animationLodCoverage_ = Max(animationLodCoverage_, newCoverage);
+    }
 
     if (newLodDistance != lodDistance_)
     {
         lodDistance_ = newLodDistance;
         CalculateLodLevels();
+        // Pre-skinned buffers only contain valid data for the LOD levels that were drawn
+        if (!preSkinnedVertexBuffers_.Empty())
+            skinningDirty_ = true;
     }
 }
 
@@ -314,6 +343,22 @@ UpdateGeometryType AnimatedModel::GetUpdateGeometryType()
 {
     if (morphsDirty_ || forceAnimationUpdate_)
         return UPDATE_MAIN_THREAD;
+    else if (!preSkinnedVertexBuffers_.Empty())
+    {
+        // Writing the pre-skinned vertex buffers has to happen in the main thread
+        if (!skinningDirty_)
+        {
+            for (unsigned i = 0; i < preSkinnedVertexBuffers_.Size(); ++i)
+            {
+                if (preSkinnedVertexBuffers_[i] && preSkinnedVertexBuffers_[i]->IsDataLost())
+                {
+                    skinningDirty_ = true;
+                    break;
+                }
+            }
+        }
+        return skinningDirty_ ? UPDATE_MAIN_THREAD : UPDATE_NONE;
+    }
     else if (skinningDirty_)
         return UPDATE_WORKER_THREAD;
     else
@@ -398,32 +443,8 @@ void AnimatedModel::SetModel(Model* model, bool createBones)
         skinMatrices_.Resize(skeleton_.GetNumBones());
         SetGeometryBoneMappings();
 
-        // Enable skinning in batches
-        for (unsigned i = 0; i < batches_.Size(); ++i)
-        {
-            if (skinMatrices_.Size())
-            {
-                batches_[i].geometryType_ = GEOM_SKINNED;
-                // Check if model has per-geometry bone mappings
-                if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
-                {
-                    batches_[i].worldTransform_ = &geometrySkinMatrices_[i][0];
-                    batches_[i].numWorldTransforms_ = geometrySkinMatrices_[i].Size();
-                }
-                // If not, use the global skin matrices
-                else
-                {
-                    batches_[i].worldTransform_ = &skinMatrices_[0];
-                    batches_[i].numWorldTransforms_ = skinMatrices_.Size();
-                }
-            }
-            else
-            {
-                batches_[i].geometryType_ = GEOM_STATIC;
-                batches_[i].worldTransform_ = &node_->GetWorldTransform();
-                batches_[i].numWorldTransforms_ = 1;
-            }
-        }
+        // Set up the geometries and batches for either pre-skinning or skinning in the vertex shader
+        SetupPreSkinning();
     }
     else
     {
@@ -431,6 +452,7 @@ void AnimatedModel::SetModel(Model* model, bool createBones)
         SetNumGeometries(0);
         geometryBoneMappings_.Clear();
         morphVertexBuffers_.Clear();
+        preSkinnedVertexBuffers_.Clear();
         morphs_.Clear();
         morphElementMask_ = MASK_NONE;
         SetBoundingBox(BoundingBox());
@@ -542,6 +564,16 @@ void AnimatedModel::SetAnimationLodBias(float bias)
     MarkNetworkUpdate();
 }
 
+void AnimatedModel::SetAnimationLodPolicy(AnimationLodPolicy* policy)
+{
+    animationLodPolicy_ = policy;
+    animationLodMaskDirty_ = true;
+    previousPose_.Clear();
+    poseBlend_ = 1.0f;
+    animationLodInterval_ = 1;
+    MarkNetworkUpdate();
+}
+
 void AnimatedModel::SetUpdateInvisible(bool enable)
 {
     updateInvisible_ = enable;
@@ -549,6 +581,17 @@ void AnimatedModel::SetUpdateInvisible(bool enable)
 }
 
 
+void AnimatedModel::SetPreSkinning(bool enable)
+{
+    if (enable != preSkinning_)
+    {
+        preSkinning_ = enable;
+        if (model_)
+            SetupPreSkinning();
+        MarkNetworkUpdate();
+    }
+}
+
 void AnimatedModel::SetMorphWeight(unsigned index, float weight)
 {
     if (index >= morphs_.Size())
@@ -693,6 +736,8 @@ AnimationState* AnimatedModel::GetAnimationState(unsigned index) const
 
 void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
 {
+    animationLodMaskDirty_ = true;
+
     if (!node_ && createBones)
     {
         URHO3D_LOGERROR("AnimatedModel not attached to a scene node, can not create bone nodes");
@@ -859,6 +904,17 @@ void AnimatedModel::SetMorphsAttr(const PODVector<unsigned char>& value)
         SetMorphWeight(index, (float)value[index] / 255.0f);
 }
 
+void AnimatedModel::SetAnimationLodPolicyAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetAnimationLodPolicy(cache->GetResource<AnimationLodPolicy>(value.name_));
+}
+
+ResourceRef AnimatedModel::GetAnimationLodPolicyAttr() const
+{
+    return GetResourceRef(animationLodPolicy_, AnimationLodPolicy::GetTypeStatic());
+}
+
 ResourceRef AnimatedModel::GetModelAttr() const
 {
     return GetResourceRef(model_, Model::GetTypeStatic());
@@ -1134,7 +1190,7 @@ void AnimatedModel::CloneGeometries()
     {
         for (unsigned j = 0; j < geometries_[i].Size(); ++j)
         {
-            SharedPtr<Geometry> original = geometries_[i][j];
+            SharedPtr<Geometry> original = model_->GetGeometries()[i][j];
             SharedPtr<Geometry> clone(new Geometry(context_));
 
             // Add an additional vertex stream into the clone, which supplies only the morphable vertex data, while the static
@@ -1176,6 +1232,131 @@ void AnimatedModel::CloneGeometries()
     // Make sure the rendering batches use the new cloned geometries
     ResetLodLevels();
     MarkMorphsDirty();
+
+    // Pre-skinned geometries already include the morphed vertices, so use them instead if enabled
+    if (!preSkinnedVertexBuffers_.Empty())
+        SetupPreSkinning();
+}
+
+void AnimatedModel::SetupPreSkinning()
+{
+    const Vector<Vector<SharedPtr<Geometry> > >& geometries = model_->GetGeometries();
+    const Vector<SharedPtr<VertexBuffer> >& originalVertexBuffers = model_->GetVertexBuffers();
+    preSkinnedVertexBuffers_.Clear();
+
+    // Pre-skinning requires float positions, blend weights and blend indices
+    if (preSkinning_ && skinMatrices_.Size())
+    {
+        bool hasSkinnedBuffers = false;
+        preSkinnedVertexBuffers_.Resize(originalVertexBuffers.Size());
+
+        for (unsigned i = 0; i < originalVertexBuffers.Size(); ++i)
+        {
+            VertexBuffer* original = originalVertexBuffers[i];
+            if (!original->GetShadowData() || !original->HasElement(TYPE_VECTOR3, SEM_POSITION) ||
+                !original->HasElement(TYPE_VECTOR4, SEM_BLENDWEIGHTS) || !original->HasElement(TYPE_UBYTE4, SEM_BLENDINDICES))
+                continue;
+
+            PODVector<VertexElement> elements;
+            elements.Push(VertexElement(TYPE_VECTOR3, SEM_POSITION));
+            if (original->HasElement(TYPE_VECTOR3, SEM_NORMAL))
+                elements.Push(VertexElement(TYPE_VECTOR3, SEM_NORMAL));
+            if (original->HasElement(TYPE_VECTOR4, SEM_TANGENT))
+                elements.Push(VertexElement(TYPE_VECTOR4, SEM_TANGENT));
+
+            SharedPtr<VertexBuffer> skinned(new VertexBuffer(context_));
+            skinned->SetSize(original->GetVertexCount(), elements, true);
+            preSkinnedVertexBuffers_[i] = skinned;
+            hasSkinnedBuffers = true;
+        }
+
+        if (!hasSkinnedBuffers)
+            preSkinnedVertexBuffers_.Clear();
+    }
+
+    if (!preSkinnedVertexBuffers_.Empty())
+    {
+        // Clone the model's geometries and add the pre-skinned vertex streams at greater indices to override the original
+        // positions/normals/tangents. Morphs are applied before skinning, so the morph streams are not needed
+        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+            {
+                Geometry* original = geometries[i][j];
+                SharedPtr<Geometry> clone(new Geometry(context_));
+
+                const Vector<SharedPtr<VertexBuffer> >& originalBuffers = original->GetVertexBuffers();
+                PODVector<VertexBuffer*> buffers;
+                for (unsigned k = 0; k < originalBuffers.Size(); ++k)
+                    buffers.Push(originalBuffers[k]);
+                for (unsigned k = 0; k < originalBuffers.Size(); ++k)
+                {
+                    unsigned index = originalVertexBuffers.IndexOf(originalBuffers[k]);
+                    if (index < preSkinnedVertexBuffers_.Size() && preSkinnedVertexBuffers_[index])
+                        buffers.Push(preSkinnedVertexBuffers_[index]);
+                }
+
+                clone->SetNumVertexBuffers(buffers.Size());
+                for (unsigned k = 0; k < buffers.Size(); ++k)
+                    clone->SetVertexBuffer(k, buffers[k]);
+                clone->SetIndexBuffer(original->GetIndexBuffer());
+                clone->SetDrawRange(original->GetPrimitiveType(), original->GetIndexStart(), original->GetIndexCount(),
+                    original->GetVertexStart(), original->GetVertexCount(), false);
+                clone->SetLodDistance(original->GetLodDistance());
+
+                geometries_[i][j] = clone;
+            }
+        }
+
+        skinningDirty_ = true;
+    }
+    else
+    {
+        // Restore the model's geometries, or the morph geometries if morphs are in use
+        for (unsigned i = 0; i < geometries_.Size() && i < geometries.Size(); ++i)
+            geometries_[i] = geometries[i];
+        if (!morphVertexBuffers_.Empty())
+            CloneGeometries();
+    }
+
+    ResetLodLevels();
+    SetupSkinningBatches();
+}
+
+void AnimatedModel::SetupSkinningBatches()
+{
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        if (skinMatrices_.Size() && !preSkinnedVertexBuffers_.Empty())
+        {
+            // Pre-skinned vertices are already in world space
+            batches_[i].geometryType_ = GEOM_STATIC;
+            batches_[i].worldTransform_ = &Matrix3x4::IDENTITY;
+            batches_[i].numWorldTransforms_ = 1;
+        }
+        else if (skinMatrices_.Size())
+        {
+            batches_[i].geometryType_ = GEOM_SKINNED;
+            // Check if model has per-geometry bone mappings
+            if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
+            {
+                batches_[i].worldTransform_ = &geometrySkinMatrices_[i][0];
+                batches_[i].numWorldTransforms_ = geometrySkinMatrices_[i].Size();
+            }
+            // If not, use the global skin matrices
+            else
+            {
+                batches_[i].worldTransform_ = &skinMatrices_[0];
+                batches_[i].numWorldTransforms_ = skinMatrices_.Size();
+            }
+        }
+        else
+        {
+            batches_[i].geometryType_ = GEOM_STATIC;
+            batches_[i].worldTransform_ = &node_->GetWorldTransform();
+            batches_[i].numWorldTransforms_ = 1;
+        }
+    }
 }
 
 void AnimatedModel::CopyMorphVertices(void* destVertexData, void* srcVertexData, unsigned vertexCount, VertexBuffer* destBuffer,
@@ -1254,6 +1435,43 @@ void AnimatedModel::SetGeometryBoneMappings()
 
 void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
 {
+    if (CheckAnimationLod(frame))
+        ApplyAnimation();
+    else if (IsPoseInterpolated())
+        ApplyPose();
+}
+
+bool AnimatedModel::CheckAnimationLod(const FrameInfo& frame)
+{
+    if (animationLodPolicy_ && animationLodBias_ > 0.0f)
+    {
+        // Choose the update interval by screen coverage, or use the invisible interval
+        const AnimationLodLevel* level = animationLodCoverage_ >= 0.0f ?
+            animationLodPolicy_->GetLevelForCoverage(animationLodCoverage_ * animationLodBias_) : nullptr;
+        unsigned interval = level ? level->interval_ : animationLodPolicy_->GetInvisibleInterval();
+        unsigned elapsed = frame.frameNumber_ - animationLodUpdateFrame_;
+
+        // Perform the first update always regardless of the interval, and without interpolating from the old pose
+        if (animationLodTimer_ >= 0.0f && elapsed < interval)
+        {
+            poseBlend_ = Min((float)elapsed / (float)animationLodInterval_, 1.0f);
+            return false;
+        }
+
+        bool interpolate = animationLodPolicy_->GetInterpolation() && interval > 1 && animationLodTimer_ >= 0.0f;
+        if (interpolate)
+            previousPose_.Swap(pose_);
+        else
+            previousPose_.Clear();
+
+        animationLodTimer_ = 0.0f;
+        animationLodUpdateFrame_ = frame.frameNumber_;
+        animationLodInterval_ = interval;
+        animationLodMaskBones_ = level ? level->maskBones_ : true;
+        poseBlend_ = interpolate ? 0.0f : 1.0f;
+        return true;
+    }
+
     // If using animation LOD, accumulate time and see if it is time to update
     if (animationLodBias_ > 0.0f && animationLodDistance_ > 0.0f)
     {
@@ -1264,16 +1482,39 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
             if (animationLodTimer_ >= animationLodDistance_)
                 animationLodTimer_ = fmodf(animationLodTimer_, animationLodDistance_);
             else
-                return;
+                return false;
         }
         else
             animationLodTimer_ = 0.0f;
     }
 
-    ApplyAnimation();
+    animationLodMaskBones_ = false;
+    poseBlend_ = 1.0f;
+    return true;
+}
+
+bool AnimatedModel::IsPoseInterpolated() const
+{
+    return isMaster_ && poseBlend_ < 1.0f && previousPose_.Size() == pose_.Size();
+}
+
+void AnimatedModel::UpdateAnimationLodMask()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    animationLodMask_.Resize(bones.Size());
+    for (unsigned i = 0; i < bones.Size(); ++i)
+        animationLodMask_[i] = animationLodPolicy_ && animationLodPolicy_->IsBoneMasked(bones[i].name_);
+
+    animationLodMaskDirty_ = false;
 }
 
 void AnimatedModel::ApplyAnimation()
+{
+    CalculatePose();
+    ApplyPose();
+}
+
+void AnimatedModel::CalculatePose()
 {
     // Make sure animations are in ascending priority order
     if (animationOrderDirty_)
@@ -1282,15 +1523,62 @@ void AnimatedModel::ApplyAnimation()
         animationOrderDirty_ = false;
     }
 
-    // Reset skeleton, apply all animations, calculate bones' bounding box. Make sure this is only done for the master model
-    // (first AnimatedModel in a node)
+    // Only the master model (first AnimatedModel in a node) animates the skeleton
+    if (!isMaster_)
+        return;
+
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    if (animationLodMaskDirty_ || animationLodMask_.Size() != bones.Size())
+        UpdateAnimationLodMask();
+
+    // Start from the initial pose, then blend all animations on top of it. Bones masked at the current animation LOD level
+    // are left out and keep their last transform
+    pose_.Resize(bones.Size());
+    for (unsigned i = 0; i < bones.Size(); ++i)
+    {
+        const Bone& bone = bones[i];
+        BonePose& bonePose = pose_[i];
+        bonePose.position_ = bone.initialPosition_;
+        bonePose.rotation_ = bone.initialRotation_;
+        bonePose.scale_ = bone.initialScale_;
+        bonePose.animated_ = bone.animated_ && bone.node_ && !(animationLodMaskBones_ && animationLodMask_[i]);
+    }
+
+    for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+        (*i)->ApplyToPose(pose_);
+}
+
+void AnimatedModel::ApplyPose()
+{
     if (isMaster_)
     {
-        skeleton_.ResetSilent();
-        for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
-            (*i)->Apply();
+        // Write the pose "silently" to avoid repeated marking dirty. Mark dirty once afterward
+        const Vector<Bone>& bones = skeleton_.GetBones();
+        unsigned numBones = Min(bones.Size(), pose_.Size());
+        if (IsPoseInterpolated())
+        {
+            for (unsigned i = 0; i < numBones; ++i)
+            {
+                const BonePose& bonePose = pose_[i];
+                const BonePose& previousBonePose = previousPose_[i];
+                if (bonePose.animated_ && bones[i].node_)
+                {
+                    bones[i].node_->SetTransformSilent(previousBonePose.position_.Lerp(bonePose.position_, poseBlend_),
+                        previousBonePose.rotation_.Nlerp(bonePose.rotation_, poseBlend_, true),
+                        previousBonePose.scale_.Lerp(bonePose.scale_, poseBlend_));
+                }
+            }
+        }
+        else
+        {
+            for (unsigned i = 0; i < numBones; ++i)
+            {
+                const BonePose& bonePose = pose_[i];
+                if (bonePose.animated_ && bones[i].node_)
+                    bones[i].node_->SetTransformSilent(bonePose.position_, bonePose.rotation_, bonePose.scale_);
+            }
+        }
 
-        // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
         node_->MarkDirty();
 
         // Calculate new bone bounding box
@@ -1300,6 +1588,30 @@ void AnimatedModel::ApplyAnimation()
     animationDirty_ = false;
 }
 
+void AnimatedModel::CalculateLateAnimation(const FrameInfo& frame)
+{
+    if (!forceAnimationUpdate_)
+        return;
+
+    forceAnimationUpdate_ = false;
+    if (CheckAnimationLod(frame))
+    {
+        CalculatePose();
+        latePosePending_ = true;
+    }
+    else
+        latePosePending_ = IsPoseInterpolated();
+}
+
+void AnimatedModel::ApplyLateAnimation()
+{
+    if (latePosePending_)
+    {
+        ApplyPose();
+        latePosePending_ = false;
+    }
+}
+
 void AnimatedModel::UpdateSkinning()
 {
     // Note: the model's world transform will be baked in the skin matrices
@@ -1336,9 +1648,165 @@ void AnimatedModel::UpdateSkinning()
         }
     }
 
+    if (!preSkinnedVertexBuffers_.Empty())
+        UpdatePreSkinning();
+
     skinningDirty_ = false;
 }
 
+void AnimatedModel::UpdatePreSkinning()
+{
+    URHO3D_PROFILE(UpdatePreSkinning);
+
+    // Lock each buffer only once with discard, as several batches may draw from the same buffer
+    PODVector<void*> lockedData(preSkinnedVertexBuffers_.Size());
+    for (unsigned i = 0; i < preSkinnedVertexBuffers_.Size(); ++i)
+    {
+        VertexBuffer* buffer = preSkinnedVertexBuffers_[i];
+        lockedData[i] = buffer ? buffer->Lock(0, buffer->GetVertexCount(), true) : nullptr;
+    }
+
+    // Skin only the vertex ranges of the current LOD levels
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        Geometry* geometry = batches_[i].geometry_;
+        if (!geometry)
+            continue;
+
+        const Matrix3x4* skinMatrices;
+        unsigned numSkinMatrices;
+        if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
+        {
+            skinMatrices = &geometrySkinMatrices_[i][0];
+            numSkinMatrices = geometrySkinMatrices_[i].Size();
+        }
+        else
+        {
+            skinMatrices = &skinMatrices_[0];
+            numSkinMatrices = skinMatrices_.Size();
+        }
+
+        const Vector<SharedPtr<VertexBuffer> >& buffers = geometry->GetVertexBuffers();
+        for (unsigned j = 0; j < buffers.Size(); ++j)
+        {
+            unsigned index = preSkinnedVertexBuffers_.IndexOf(buffers[j]);
+            if (index >= preSkinnedVertexBuffers_.Size() || !lockedData[index])
+                continue;
+
+            unsigned start = geometry->GetVertexStart();
+            unsigned count = geometry->GetVertexCount();
+            if (!count || start + count > buffers[j]->GetVertexCount())
+            {
+                start = 0;
+                count = buffers[j]->GetVertexCount();
+            }
+
+            SkinVertices(lockedData[index], index, start, count, skinMatrices, numSkinMatrices);
+        }
+    }
+
+    for (unsigned i = 0; i < preSkinnedVertexBuffers_.Size(); ++i)
+    {
+        if (lockedData[i])
+        {
+            preSkinnedVertexBuffers_[i]->Unlock();
+            preSkinnedVertexBuffers_[i]->ClearDataLost();
+        }
+    }
+}
+
+void AnimatedModel::SkinVertices(void* destVertexData, unsigned bufferIndex, unsigned start, unsigned count,
+    const Matrix3x4* skinMatrices, unsigned numSkinMatrices)
+{
+    VertexBuffer* original = model_->GetVertexBuffers()[bufferIndex];
+    VertexBuffer* dest = preSkinnedVertexBuffers_[bufferIndex];
+    // If the buffer is morphed, read positions, normals and tangents from the morph buffer instead
+    VertexBuffer* morphed = bufferIndex < morphVertexBuffers_.Size() ? morphVertexBuffers_[bufferIndex].Get() : nullptr;
+
+    const unsigned char* srcData = original->GetShadowData();
+    unsigned srcVertexSize = original->GetVertexSize();
+    unsigned weightOffset = original->GetElementOffset(SEM_BLENDWEIGHTS);
+    unsigned indexOffset = original->GetElementOffset(SEM_BLENDINDICES);
+
+    const unsigned char* posData = srcData + original->GetElementOffset(SEM_POSITION);
+    unsigned posStride = srcVertexSize;
+    const unsigned char* normalData = srcData + original->GetElementOffset(SEM_NORMAL);
+    unsigned normalStride = srcVertexSize;
+    const unsigned char* tangentData = srcData + original->GetElementOffset(SEM_TANGENT);
+    unsigned tangentStride = srcVertexSize;
+    if (morphed)
+    {
+        const unsigned char* morphData = morphed->GetShadowData();
+        unsigned morphVertexSize = morphed->GetVertexSize();
+        if (morphed->HasElement(SEM_POSITION))
+        {
+            posData = morphData + morphed->GetElementOffset(SEM_POSITION);
+            posStride = morphVertexSize;
+        }
+        if (morphed->HasElement(SEM_NORMAL))
+        {
+            normalData = morphData + morphed->GetElementOffset(SEM_NORMAL);
+            normalStride = morphVertexSize;
+        }
+        if (morphed->HasElement(SEM_TANGENT))
+        {
+            tangentData = morphData + morphed->GetElementOffset(SEM_TANGENT);
+            tangentStride = morphVertexSize;
+        }
+    }
+
+    bool hasNormal = dest->HasElement(SEM_NORMAL);
+    bool hasTangent = dest->HasElement(SEM_TANGENT);
+    unsigned destVertexSize = dest->GetVertexSize();
+    unsigned char* destData = (unsigned char*)destVertexData + start * destVertexSize;
+
+    for (unsigned i = start; i < start + count; ++i)
+    {
+        const auto* weights = (const float*)(srcData + i * srcVertexSize + weightOffset);
+        const unsigned char* indices = srcData + i * srcVertexSize + indexOffset;
+
+        // Blend the skinning matrices by the vertex weights
+        Matrix3x4 skinMatrix(Matrix3x4::ZERO);
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            if (weights[j] != 0.0f && indices[j] < numSkinMatrices)
+                skinMatrix = skinMatrix + skinMatrices[indices[j]] * weights[j];
+        }
+
+        auto* dest = (float*)destData;
+        const Vector3& position = *(const Vector3*)(posData + i * posStride);
+        Vector3 skinnedPosition = skinMatrix * position;
+        dest[0] = skinnedPosition.x_;
+        dest[1] = skinnedPosition.y_;
+        dest[2] = skinnedPosition.z_;
+        dest += 3;
+
+        if (hasNormal || hasTangent)
+        {
+            Matrix3 rotation = skinMatrix.ToMatrix3();
+            if (hasNormal)
+            {
+                Vector3 normal = (rotation * *(const Vector3*)(normalData + i * normalStride)).Normalized();
+                dest[0] = normal.x_;
+                dest[1] = normal.y_;
+                dest[2] = normal.z_;
+                dest += 3;
+            }
+            if (hasTangent)
+            {
+                const auto* tangentSrc = (const float*)(tangentData + i * tangentStride);
+                Vector3 tangent = (rotation * Vector3(tangentSrc[0], tangentSrc[1], tangentSrc[2])).Normalized();
+                dest[0] = tangent.x_;
+                dest[1] = tangent.y_;
+                dest[2] = tangent.z_;
+                dest[3] = tangentSrc[3];
+            }
+        }
+
+        destData += destVertexSize;
+    }
+}
+
 void AnimatedModel::UpdateMorphs()
 {
     auto* graphics = GetSubsystem<Graphics>();
@@ -1380,6 +1848,10 @@ void AnimatedModel::UpdateMorphs()
         }
     }
 
+    // Pre-skinned vertices are built from the morphed vertices, so they need to be updated too
+    if (!preSkinnedVertexBuffers_.Empty())
+        skinningDirty_ = true;
+
     morphsDirty_ = false;
 }
 
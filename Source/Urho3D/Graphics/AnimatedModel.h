@@ -30,12 +30,27 @@ namespace Urho3D
 {
 
 class Animation;
+class AnimationLodPolicy;
 class AnimationState;
 
+/// Bone transform in the animation pose buffer.
+struct BonePose
+{
+    /// Position.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+    /// Scale.
+    Vector3 scale_;
+    /// Whether the bone is animated this update.
+    bool animated_;
+};
+
 /// Animated model component.
 class URHO3D_API AnimatedModel : public StaticModel
 {
     URHO3D_OBJECT(AnimatedModel, StaticModel);
+    URHO3D_POOLED_OBJECT(AnimatedModel);
 
     friend class AnimationState;
 
@@ -86,8 +101,12 @@ public:
     void RemoveAllAnimationStates();
     /// Set animation LOD bias.
     void SetAnimationLodBias(float bias);
+    /// Set animation LOD policy. When set, it replaces the distance-based update skipping: the update interval is chosen by screen coverage (multiplied by the animation LOD bias), and bones may be masked and interpolated. A zero animation LOD bias disables the policy.
+    void SetAnimationLodPolicy(AnimationLodPolicy* policy);
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     void SetUpdateInvisible(bool enable);
+    /// Set pre-skinning mode. When enabled, vertices are skinned once per frame into a dynamic vertex buffer and all passes draw the result as static geometry.
+    void SetPreSkinning(bool enable);
     /// Set vertex morph weight by index.
     void SetMorphWeight(unsigned index, float weight);
     /// Set vertex morph weight by name.
@@ -98,6 +117,14 @@ public:
     void ResetMorphWeights();
     /// Apply all animation states to nodes.
     void ApplyAnimation();
+    /// Sample and blend all animation states into the pose buffer without modifying the bone nodes. Does not modify the scene, so may be called from a worker thread.
+    void CalculatePose();
+    /// Write the pose buffer to the bone nodes and recalculate the bone bounding box.
+    void ApplyPose();
+    /// Perform the first part of a late animation update for a model that came into view, respecting animation LOD. Called by View from worker threads before the geometry update.
+    void CalculateLateAnimation(const FrameInfo& frame);
+    /// Perform the second part of a late animation update by applying the calculated pose. Called by View from the main thread.
+    void ApplyLateAnimation();
 
     /// Return skeleton.
     Skeleton& GetSkeleton() { return skeleton_; }
@@ -119,9 +146,23 @@ public:
 
     /// Return animation LOD bias.
     float GetAnimationLodBias() const { return animationLodBias_; }
+    /// Return animation LOD policy.
+    AnimationLodPolicy* GetAnimationLodPolicy() const { return animationLodPolicy_; }
+    /// Return the screen coverage used for animation LOD, the maximum of all views last frame. Negative if not visible.
+    float GetAnimationLodCoverage() const { return animationLodCoverage_; }
+    /// Return the current animation update interval in frames.
+    unsigned GetAnimationLodInterval() const { return animationLodInterval_; }
 
     /// Return whether to update animation when not visible.
     bool GetUpdateInvisible() const { return updateInvisible_; }
+    /// Return whether an animation update is pending for when the geometry is updated, as the model came into view.
+    bool IsLateAnimationPending() const { return forceAnimationUpdate_; }
+
+    /// Return whether pre-skinning mode is enabled.
+    bool GetPreSkinning() const { return preSkinning_; }
+
+    /// Return pre-skinned vertex buffers. Empty if not pre-skinning.
+    const Vector<SharedPtr<VertexBuffer> >& GetPreSkinnedVertexBuffers() const { return preSkinnedVertexBuffers_; }
 
     /// Return all vertex morphs.
     const Vector<ModelMorph>& GetMorphs() const { return morphs_; }
@@ -150,6 +191,8 @@ public:
     void SetAnimationStatesAttr(const VariantVector& value);
     /// Set morphs attribute.
     void SetMorphsAttr(const PODVector<unsigned char>& value);
+    /// Set animation LOD policy attribute.
+    void SetAnimationLodPolicyAttr(const ResourceRef& value);
     /// Return model attribute.
     ResourceRef GetModelAttr() const;
     /// Return bones' animation enabled attribute.
@@ -158,6 +201,8 @@ public:
     VariantVector GetAnimationStatesAttr() const;
     /// Return morphs attribute.
     const PODVector<unsigned char>& GetMorphsAttr() const;
+    /// Return animation LOD policy attribute.
+    ResourceRef GetAnimationLodPolicyAttr() const;
 
     /// Return per-geometry bone mappings.
     const Vector<PODVector<unsigned> >& GetGeometryBoneMappings() const { return geometryBoneMappings_; }
@@ -195,12 +240,27 @@ private:
     void SetGeometryBoneMappings();
     /// Clone geometries for vertex morphing.
     void CloneGeometries();
+    /// Create geometries that draw from pre-skinned vertex buffers, or restore the normal geometries.
+    void SetupPreSkinning();
+    /// Set geometry type and world transforms of the rendering batches according to the skinning mode.
+    void SetupSkinningBatches();
     /// Copy morph vertices.
     void CopyMorphVertices(void* destVertexData, void* srcVertexData, unsigned vertexCount, VertexBuffer* destBuffer, VertexBuffer* srcBuffer);
     /// Recalculate animations. Called from Update().
     void UpdateAnimation(const FrameInfo& frame);
+    /// Advance the animation LOD timer and return whether animations should be recalculated this frame.
+    bool CheckAnimationLod(const FrameInfo& frame);
+    /// Return whether the bone transforms are being interpolated between sparse animation updates.
+    bool IsPoseInterpolated() const;
+    /// Rebuild the per-bone mask of the animation LOD policy.
+    void UpdateAnimationLodMask();
     /// Recalculate skinning.
     void UpdateSkinning();
+    /// Write skinned vertices into the pre-skinned vertex buffers.
+    void UpdatePreSkinning();
+    /// Skin a vertex range from an original vertex buffer.
+    void SkinVertices(void* destVertexData, unsigned bufferIndex, unsigned start, unsigned count, const Matrix3x4* skinMatrices,
+        unsigned numSkinMatrices);
     /// Reapply all vertex morphs.
     void UpdateMorphs();
     /// Apply a vertex morph.
@@ -213,10 +273,20 @@ private:
     Skeleton skeleton_;
     /// Morph vertex buffers.
     Vector<SharedPtr<VertexBuffer> > morphVertexBuffers_;
+    /// Pre-skinned vertex buffers, indexed by the model's vertex buffers. Null for buffers without skinning data.
+    Vector<SharedPtr<VertexBuffer> > preSkinnedVertexBuffers_;
     /// Vertex morphs.
     Vector<ModelMorph> morphs_;
     /// Animation states.
     Vector<SharedPtr<AnimationState> > animationStates_;
+    /// Animation pose buffer, indexed by bone.
+    Vector<BonePose> pose_;
+    /// Previous animation pose to interpolate from.
+    Vector<BonePose> previousPose_;
+    /// Bones masked by the animation LOD policy at the levels which mask bones.
+    PODVector<bool> animationLodMask_;
+    /// Animation LOD policy.
+    SharedPtr<AnimationLodPolicy> animationLodPolicy_;
     /// Skinning matrices.
     PODVector<Matrix3x4> skinMatrices_;
     /// Mapping of subgeometry bone indices, used if more bones than skinning shader can manage.
@@ -239,8 +309,18 @@ private:
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Animation LOD screen coverage, the maximum of all views last frame. Negative if not visible.
+    float animationLodCoverage_;
+    /// Interpolation weight of the current pose from the previous pose.
+    float poseBlend_;
+    /// Frame number of the last animation update with an animation LOD policy.
+    unsigned animationLodUpdateFrame_;
+    /// Frames between animation updates at the current animation LOD level.
+    unsigned animationLodInterval_;
     /// Update animation when invisible flag.
     bool updateInvisible_;
+    /// Pre-skinning mode flag.
+    bool preSkinning_;
     /// Animation dirty flag.
     bool animationDirty_;
     /// Animation order dirty flag.
@@ -259,6 +339,12 @@ private:
     bool assignBonesPending_;
     /// Force animation update after becoming visible flag.
     bool forceAnimationUpdate_;
+    /// Late animation pose calculated and waiting to be applied flag.
+    bool latePosePending_;
+    /// Mask the bones of the animation LOD policy flag.
+    bool animationLodMaskBones_;
+    /// Animation LOD bone mask needs rebuild flag.
+    bool animationLodMaskDirty_;
 };
 
 }
@@ -34,11 +34,52 @@
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Decode quantized values by interpolating between two sample times. The count must be a multiple of 4.
+static inline void DecodeSamples(const short* first, const short* second, float t, const float* scales, const float* biases,
+    float* dest, unsigned count)
+{
+#ifdef URHO3D_SSE
+    __m128 t4 = _mm_set1_ps(t);
+    for (unsigned i = 0; i < count; i += 4)
+    {
+        // Sign-extend the 16-bit values by unpacking them into the high halves and shifting down
+        __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(first + i));
+        __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(second + i));
+        __m128 fa = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16));
+        __m128 fb = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16));
+        __m128 value = _mm_add_ps(fa, _mm_mul_ps(_mm_sub_ps(fb, fa), t4));
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(biases + i), _mm_mul_ps(value, _mm_loadu_ps(scales + i))));
+    }
+#elif defined(__ARM_NEON)
+    float32x4_t t4 = vdupq_n_f32(t);
+    for (unsigned i = 0; i < count; i += 4)
+    {
+        float32x4_t fa = vcvtq_f32_s32(vmovl_s16(vld1_s16(first + i)));
+        float32x4_t fb = vcvtq_f32_s32(vmovl_s16(vld1_s16(second + i)));
+        float32x4_t value = vmlaq_f32(fa, vsubq_f32(fb, fa), t4);
+        vst1q_f32(dest + i, vmlaq_f32(vld1q_f32(biases + i), value, vld1q_f32(scales + i)));
+    }
+#else
+    for (unsigned i = 0; i < count; ++i)
+    {
+        float a = (float)first[i];
+        float value = a + ((float)second[i] - a) * t;
+        dest[i] = biases[i] + value * scales[i];
+    }
+#endif
+}
+
 inline bool CompareTriggers(AnimationTriggerPoint& lhs, AnimationTriggerPoint& rhs)
 {
     return lhs.time_ < rhs.time_;
@@ -97,6 +138,27 @@ void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
     if (index >= keyFrames_.Size())
         index = keyFrames_.Size() - 1;
 
+    // Playback usually stays on the same keyframe or advances to the next. After a larger jump, binary search instead of
+    // stepping through the keyframes
+    bool ahead = index && time < keyFrames_[index].time_;
+    bool behind = index + 1 < keyFrames_.Size() && time >= keyFrames_[index + 1].time_;
+    if ((ahead && index > 1 && time < keyFrames_[index - 1].time_) ||
+        (behind && index + 2 < keyFrames_.Size() && time >= keyFrames_[index + 2].time_))
+    {
+        unsigned low = 0;
+        unsigned high = keyFrames_.Size() - 1;
+        while (low < high)
+        {
+            unsigned mid = (low + high + 1) / 2;
+            if (time < keyFrames_[mid].time_)
+                high = mid - 1;
+            else
+                low = mid;
+        }
+        index = low;
+        return;
+    }
+
     // Check for being too far ahead
     while (index && time < keyFrames_[index].time_)
         --index;
@@ -106,9 +168,63 @@ void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
         ++index;
 }
 
+void AnimationTrack::Sample(float time, float animationLength, bool looped, unsigned& index, Vector3& position, Quaternion& rotation,
+    Vector3& scale) const
+{
+    if (keyFrames_.Empty())
+        return;
+
+    GetKeyFrameIndex(time, index);
+
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    unsigned nextIndex = index + 1;
+    bool interpolate = true;
+    if (nextIndex >= keyFrames_.Size())
+    {
+        if (!looped)
+        {
+            nextIndex = index;
+            interpolate = false;
+        }
+        else
+            nextIndex = 0;
+    }
+
+    const AnimationKeyFrame* keyFrame = &keyFrames_[index];
+
+    if (interpolate)
+    {
+        const AnimationKeyFrame* nextKeyFrame = &keyFrames_[nextIndex];
+        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
+        if (timeInterval < 0.0f)
+            timeInterval += animationLength;
+        float t = timeInterval > 0.0f ? (time - keyFrame->time_) / timeInterval : 1.0f;
+
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+    }
+    else
+    {
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame->position_;
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame->rotation_;
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame->scale_;
+    }
+}
+
 Animation::Animation(Context* context) :
     ResourceWithMetadata(context),
-    length_(0.f)
+    length_(0.f),
+    sampleRate_(0.0f),
+    numSamples_(0),
+    lastKeyFrameTime_(0.0f),
+    sampleStride_(0)
 {
 }
 
@@ -135,6 +251,14 @@ bool Animation::BeginLoad(Deserializer& source)
     animationNameHash_ = animationName_;
     length_ = source.ReadFloat();
     tracks_.Clear();
+    sampleRate_ = 0.0f;
+    numSamples_ = 0;
+    lastKeyFrameTime_ = 0.0f;
+    sampleStride_ = 0;
+    samples_.Clear();
+    sampleScales_.Clear();
+    sampleBiases_.Clear();
+    constantSamples_.Clear();
 
     unsigned tracks = source.ReadUInt();
     memoryUse += tracks * sizeof(AnimationTrack);
@@ -223,6 +347,14 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
+    // Save a compressed animation as one keyframe per sample
+    if (IsCompressed())
+    {
+        SharedPtr<Animation> decompressed = Clone(GetName());
+        decompressed->Decompress();
+        return decompressed->Save(dest);
+    }
+
     // Write ID, name and length
     dest.WriteFileID("UANI");
     dest.WriteString(animationName_);
@@ -375,12 +507,295 @@ SharedPtr<Animation> Animation::Clone(const String& cloneName) const
     ret->length_ = length_;
     ret->tracks_ = tracks_;
     ret->triggers_ = triggers_;
+    ret->sampleRate_ = sampleRate_;
+    ret->numSamples_ = numSamples_;
+    ret->lastKeyFrameTime_ = lastKeyFrameTime_;
+    ret->sampleStride_ = sampleStride_;
+    ret->samples_ = samples_;
+    ret->sampleScales_ = sampleScales_;
+    ret->sampleBiases_ = sampleBiases_;
+    ret->constantSamples_ = constantSamples_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
 
     return ret;
 }
 
+void Animation::Compress(float sampleRate)
+{
+    if (sampleRate <= 0.0f)
+    {
+        URHO3D_LOGERROR("Animation sample rate must be positive");
+        return;
+    }
+
+    URHO3D_PROFILE(CompressAnimation);
+
+    if (IsCompressed())
+        Decompress();
+
+    static const AnimationChannel channels[] = { CHANNEL_POSITION, CHANNEL_ROTATION, CHANNEL_SCALE };
+    static const unsigned channelSizes[] = { 3, 4, 3 };
+    static const unsigned channelStarts[] = { 0, 3, 7 };
+    static const unsigned SAMPLE_SIZE = 10;
+
+    // Sample with looped playback, which interpolates from the last keyframe towards the first. Add a row for the last keyframe,
+    // which non-looped playback holds
+    auto numSamples = (unsigned)CeilToInt(length_ * sampleRate) + 1;
+    unsigned numRows = numSamples + 1;
+    float lastKeyFrameTime = 0.0f;
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (!i->second_.keyFrames_.Empty())
+            lastKeyFrameTime = Max(lastKeyFrameTime, i->second_.keyFrames_.Back().time_);
+    }
+    lastKeyFrameTime = Min(lastKeyFrameTime, length_);
+
+    // Non-constant channels, which are quantized per sample time
+    struct QuantizedChannel
+    {
+        unsigned offset_;
+        unsigned size_;
+        PODVector<float> values_;
+    };
+    Vector<QuantizedChannel> quantizedChannels;
+    // Track channel offsets into the constant values, which follow the quantized values in the sample buffer
+    PODVector<unsigned*> constantOffsets;
+    unsigned stride = 0;
+    constantSamples_.Clear();
+
+    PODVector<float> trackValues(numRows * SAMPLE_SIZE);
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        AnimationTrack& track = i->second_;
+        for (unsigned& offset : track.sampleOffsets_)
+            offset = M_MAX_UNSIGNED;
+        if (track.keyFrames_.Empty())
+            continue;
+
+        unsigned index = 0;
+        Quaternion lastRotation;
+        for (unsigned j = 0; j < numRows; ++j)
+        {
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 scale(Vector3::ONE);
+            if (j < numSamples)
+                track.Sample(Min((float)j / sampleRate, length_), length_, true, index, position, rotation, scale);
+            else
+                track.Sample(length_, length_, false, index, position, rotation, scale);
+
+            // Keep consecutive rotations in the same hemisphere, so that the linear interpolation takes the shorter path
+            if (j && rotation.DotProduct(lastRotation) < 0.0f)
+                rotation = -rotation;
+            lastRotation = rotation;
+
+            float* dest = &trackValues[j * SAMPLE_SIZE];
+            memcpy(dest + channelStarts[0], position.Data(), 3 * sizeof(float));
+            memcpy(dest + channelStarts[1], rotation.Data(), 4 * sizeof(float));
+            memcpy(dest + channelStarts[2], scale.Data(), 3 * sizeof(float));
+        }
+
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            if (!(track.channelMask_ & channels[j]))
+                continue;
+
+            unsigned start = channelStarts[j];
+            unsigned size = channelSizes[j];
+            bool constant = true;
+            for (unsigned k = 1; k < numRows && constant; ++k)
+            {
+                for (unsigned l = 0; l < size; ++l)
+                {
+                    if (trackValues[k * SAMPLE_SIZE + start + l] != trackValues[start + l])
+                    {
+                        constant = false;
+                        break;
+                    }
+                }
+            }
+
+            if (constant)
+            {
+                track.sampleOffsets_[j] = constantSamples_.Size();
+                constantOffsets.Push(&track.sampleOffsets_[j]);
+                for (unsigned l = 0; l < size; ++l)
+                    constantSamples_.Push(trackValues[start + l]);
+            }
+            else
+            {
+                quantizedChannels.Resize(quantizedChannels.Size() + 1);
+                QuantizedChannel& channel = quantizedChannels.Back();
+                channel.offset_ = stride;
+                channel.size_ = size;
+                channel.values_.Resize(numRows * size);
+                for (unsigned k = 0; k < numRows; ++k)
+                {
+                    for (unsigned l = 0; l < size; ++l)
+                        channel.values_[k * size + l] = trackValues[k * SAMPLE_SIZE + start + l];
+                }
+                track.sampleOffsets_[j] = stride;
+                stride += size;
+            }
+        }
+    }
+
+    // Pad the sample times for the decoding kernel, which processes 4 values at a time
+    sampleStride_ = (stride + 3) & ~3u;
+    for (unsigned i = 0; i < constantOffsets.Size(); ++i)
+        *constantOffsets[i] += sampleStride_;
+
+    samples_.Resize(numRows * sampleStride_);
+    sampleScales_.Resize(sampleStride_);
+    sampleBiases_.Resize(sampleStride_);
+    for (unsigned i = 0; i < samples_.Size(); ++i)
+        samples_[i] = 0;
+    for (unsigned i = 0; i < sampleStride_; ++i)
+    {
+        sampleScales_[i] = 0.0f;
+        sampleBiases_[i] = 0.0f;
+    }
+
+    // Quantize each value to 16 bits over its range in the animation
+    for (unsigned i = 0; i < quantizedChannels.Size(); ++i)
+    {
+        const QuantizedChannel& channel = quantizedChannels[i];
+        for (unsigned l = 0; l < channel.size_; ++l)
+        {
+            float minValue = M_INFINITY;
+            float maxValue = -M_INFINITY;
+            for (unsigned k = 0; k < numRows; ++k)
+            {
+                float value = channel.values_[k * channel.size_ + l];
+                minValue = Min(minValue, value);
+                maxValue = Max(maxValue, value);
+            }
+
+            float range = maxValue - minValue;
+            float scale = range / 65535.0f;
+            unsigned offset = channel.offset_ + l;
+            sampleScales_[offset] = scale;
+            sampleBiases_[offset] = minValue + 32768.0f * scale;
+
+            for (unsigned k = 0; k < numRows; ++k)
+            {
+                float value = channel.values_[k * channel.size_ + l];
+                int quantized = range > 0.0f ? RoundToInt((value - minValue) / range * 65535.0f) - 32768 : 0;
+                samples_[k * sampleStride_ + offset] = (short)Clamp(quantized, -32768, 32767);
+            }
+        }
+    }
+
+    sampleRate_ = sampleRate;
+    numSamples_ = numSamples;
+    lastKeyFrameTime_ = lastKeyFrameTime;
+
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        i->second_.keyFrames_.Clear();
+        i->second_.keyFrames_.Compact();
+    }
+
+    UpdateMemoryUse();
+}
+
+void Animation::Decompress()
+{
+    if (!IsCompressed())
+        return;
+
+    // Restore the samples before the last keyframe, and the last keyframe itself, so that both looped and non-looped playback
+    // stay the same
+    unsigned numKeyFrames = 0;
+    while (numKeyFrames < numSamples_ && (float)numKeyFrames / sampleRate_ < lastKeyFrameTime_)
+        ++numKeyFrames;
+
+    PODVector<float> buffer(GetSampleBufferSize());
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        AnimationTrack& track = i->second_;
+        if (track.sampleOffsets_[0] != M_MAX_UNSIGNED || track.sampleOffsets_[1] != M_MAX_UNSIGNED ||
+            track.sampleOffsets_[2] != M_MAX_UNSIGNED)
+            track.keyFrames_.Resize(numKeyFrames + 1);
+    }
+
+    for (unsigned i = 0; i <= numKeyFrames; ++i)
+    {
+        float time = i < numKeyFrames ? (float)i / sampleRate_ : lastKeyFrameTime_;
+        Sample(time, i < numKeyFrames, buffer.Buffer());
+
+        for (HashMap<StringHash, AnimationTrack>::Iterator j = tracks_.Begin(); j != tracks_.End(); ++j)
+        {
+            AnimationTrack& track = j->second_;
+            if (track.keyFrames_.Empty())
+                continue;
+
+            AnimationKeyFrame& keyFrame = track.keyFrames_[i];
+            keyFrame.time_ = time;
+            if (track.sampleOffsets_[0] != M_MAX_UNSIGNED)
+                keyFrame.position_ = Vector3(&buffer[track.sampleOffsets_[0]]);
+            if (track.sampleOffsets_[1] != M_MAX_UNSIGNED)
+                keyFrame.rotation_ = Quaternion(&buffer[track.sampleOffsets_[1]]).Normalized();
+            if (track.sampleOffsets_[2] != M_MAX_UNSIGNED)
+                keyFrame.scale_ = Vector3(&buffer[track.sampleOffsets_[2]]);
+        }
+    }
+
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        for (unsigned& offset : i->second_.sampleOffsets_)
+            offset = M_MAX_UNSIGNED;
+    }
+
+    sampleRate_ = 0.0f;
+    numSamples_ = 0;
+    lastKeyFrameTime_ = 0.0f;
+    sampleStride_ = 0;
+    samples_.Clear();
+    sampleScales_.Clear();
+    sampleBiases_.Clear();
+    constantSamples_.Clear();
+
+    UpdateMemoryUse();
+}
+
+void Animation::Sample(float time, bool looped, float* dest) const
+{
+    if (!numSamples_)
+        return;
+
+    float position = Clamp(time, 0.0f, length_) * sampleRate_;
+    unsigned index = Min((unsigned)position, numSamples_ - 1);
+    unsigned nextIndex = Min(index + 1, numSamples_ - 1);
+    float t = Min(position - (float)index, 1.0f);
+
+    // Non-looped playback interpolates towards the last keyframe, and holds it after its time. The last keyframe is stored after
+    // the samples
+    if (!looped)
+    {
+        float sampleTime = (float)index / sampleRate_;
+        if (time >= lastKeyFrameTime_)
+        {
+            index = nextIndex = numSamples_;
+            t = 0.0f;
+        }
+        else if ((float)nextIndex / sampleRate_ > lastKeyFrameTime_)
+        {
+            nextIndex = numSamples_;
+            t = (time - sampleTime) / (lastKeyFrameTime_ - sampleTime);
+        }
+    }
+
+    if (sampleStride_)
+    {
+        DecodeSamples(&samples_[index * sampleStride_], &samples_[nextIndex * sampleStride_], t, sampleScales_.Buffer(),
+            sampleBiases_.Buffer(), dest, sampleStride_);
+    }
+    if (constantSamples_.Size())
+        memcpy(dest + sampleStride_, constantSamples_.Buffer(), constantSamples_.Size() * sizeof(float));
+}
+
 AnimationTrack* Animation::GetTrack(unsigned index)
 {
     if (index >= GetNumTracks())
@@ -410,6 +825,17 @@ AnimationTrack* Animation::GetTrack(StringHash nameHash)
     return i != tracks_.End() ? &i->second_ : nullptr;
 }
 
+void Animation::UpdateMemoryUse()
+{
+    unsigned memoryUse = sizeof(Animation) + tracks_.Size() * sizeof(AnimationTrack);
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+        memoryUse += i->second_.keyFrames_.Size() * sizeof(AnimationKeyFrame);
+    memoryUse += samples_.Size() * sizeof(short);
+    memoryUse += (sampleScales_.Size() + sampleBiases_.Size() + constantSamples_.Size()) * sizeof(float);
+    memoryUse += triggers_.Size() * sizeof(AnimationTriggerPoint);
+    SetMemoryUse(memoryUse);
+}
+
 AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
 {
     return index < triggers_.Size() ? &triggers_[index] : nullptr;
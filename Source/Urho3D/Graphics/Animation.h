@@ -85,6 +85,8 @@ struct URHO3D_API AnimationTrack
     unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
     /// Return keyframe index based on time and previous index.
     void GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Sample the included channels at time, interpolating between keyframes. The keyframe index is used as a cursor and updated. When looped, times after the last keyframe interpolate towards the first keyframe at the animation length.
+    void Sample(float time, float animationLength, bool looped, unsigned& index, Vector3& position, Quaternion& rotation, Vector3& scale) const;
 
     /// Bone or scene node name.
     String name_;
@@ -94,6 +96,8 @@ struct URHO3D_API AnimationTrack
     AnimationChannelFlags channelMask_{};
     /// Keyframes.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Offsets of the position, rotation and scale in the sample buffer of a compressed animation, or M_MAX_UNSIGNED if not included.
+    unsigned sampleOffsets_[3]{M_MAX_UNSIGNED, M_MAX_UNSIGNED, M_MAX_UNSIGNED};
 };
 
 /// %Animation trigger point.
@@ -153,6 +157,12 @@ public:
     void SetNumTriggers(unsigned num);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const String& cloneName = String::EMPTY) const;
+    /// Resample the tracks at a fixed rate into 16-bit samples quantized to the range of each channel, and release the keyframes. Playback then indexes the samples directly and decodes all tracks of the animation at once. Constant channels are stored only once. Rotations are interpolated linearly and normalized, so the result may differ slightly from the keyframes. The last keyframe is stored separately for non-looped playback. This is unsafe if the animation is currently used in playback.
+    void Compress(float sampleRate = 30.0f);
+    /// Restore one keyframe per sample from the compressed data and release it. This is unsafe if the animation is currently used in playback.
+    void Decompress();
+    /// Decode all tracks of a compressed animation at time into a buffer of GetSampleBufferSize() floats. The tracks' sample offsets locate their position, rotation (W, X, Y, Z, not normalized) and scale.
+    void Sample(float time, bool looped, float* dest) const;
 
     /// Return animation name.
     const String& GetAnimationName() const { return animationName_; }
@@ -186,7 +196,22 @@ public:
     /// Return a trigger point by index.
     AnimationTriggerPoint* GetTrigger(unsigned index);
 
+    /// Return whether the animation is compressed.
+    bool IsCompressed() const { return sampleRate_ > 0.0f; }
+
+    /// Return sample rate of a compressed animation, or 0 if not compressed.
+    float GetSampleRate() const { return sampleRate_; }
+
+    /// Return number of samples per channel of a compressed animation.
+    unsigned GetNumSamples() const { return numSamples_; }
+
+    /// Return the sample buffer size in floats.
+    unsigned GetSampleBufferSize() const { return sampleStride_ + constantSamples_.Size(); }
+
 private:
+    /// Update memory use from the tracks, compressed samples and triggers.
+    void UpdateMemoryUse();
+
     /// Animation name.
     String animationName_;
     /// Animation name hash.
@@ -197,6 +222,22 @@ private:
     HashMap<StringHash, AnimationTrack> tracks_;
     /// Animation trigger points.
     Vector<AnimationTriggerPoint> triggers_;
+    /// Sample rate when compressed.
+    float sampleRate_;
+    /// Number of compressed samples per channel, not including the last keyframe.
+    unsigned numSamples_;
+    /// Time of the last keyframe, after which non-looped playback holds it.
+    float lastKeyFrameTime_;
+    /// Number of quantized values per sample time, a multiple of 4.
+    unsigned sampleStride_;
+    /// Quantized values of the non-constant channels, grouped by sample time and followed by the last keyframe.
+    PODVector<short> samples_;
+    /// Dequantization scale of each value in a sample time.
+    PODVector<float> sampleScales_;
+    /// Dequantization bias of each value in a sample time.
+    PODVector<float> sampleBiases_;
+    /// Values of the constant channels, copied after the decoded values.
+    PODVector<float> constantSamples_;
 };
 
 }
@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/AnimationLodPolicy.h"
+#include "../IO/Log.h"
+#include "../Resource/XMLFile.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned DEFAULT_INVISIBLE_INTERVAL = 8;
+
+AnimationLodPolicy::AnimationLodPolicy(Context* context) :
+    Resource(context),
+    invisibleInterval_(DEFAULT_INVISIBLE_INTERVAL),
+    interpolation_(false)
+{
+}
+
+AnimationLodPolicy::~AnimationLodPolicy() = default;
+
+void AnimationLodPolicy::RegisterObject(Context* context)
+{
+    context->RegisterFactory<AnimationLodPolicy>();
+}
+
+bool AnimationLodPolicy::BeginLoad(Deserializer& source)
+{
+    XMLFile file(context_);
+    if (!file.Load(source))
+    {
+        URHO3D_LOGERROR("Load animation LOD policy file failed");
+        return false;
+    }
+
+    bool success = Load(file.GetRoot());
+    if (success)
+        SetMemoryUse(sizeof(AnimationLodPolicy) + levels_.Size() * sizeof(AnimationLodLevel));
+    return success;
+}
+
+bool AnimationLodPolicy::Save(Serializer& dest) const
+{
+    SharedPtr<XMLFile> xml(new XMLFile(context_));
+    XMLElement rootElem = xml->CreateRoot("animationlod");
+
+    Save(rootElem);
+    return xml->Save(dest);
+}
+
+bool AnimationLodPolicy::Load(const XMLElement& source)
+{
+    // Reset to defaults first so that missing parameters in case of a live reload behave as expected
+    levels_.Clear();
+    maskedBones_.Clear();
+    invisibleInterval_ = DEFAULT_INVISIBLE_INTERVAL;
+    interpolation_ = false;
+
+    if (source.IsNull())
+    {
+        URHO3D_LOGERROR("Can not load animation LOD policy from null XML element");
+        return false;
+    }
+
+    if (source.HasAttribute("invisibleinterval"))
+        SetInvisibleInterval(source.GetUInt("invisibleinterval"));
+    if (source.HasAttribute("interpolation"))
+        SetInterpolation(source.GetBool("interpolation"));
+
+    for (XMLElement levelElem = source.GetChild("level"); levelElem; levelElem = levelElem.GetNext("level"))
+        AddLevel(levelElem.GetFloat("coverage"), levelElem.GetUInt("interval"), levelElem.GetBool("maskbones"));
+
+    for (XMLElement boneElem = source.GetChild("maskbone"); boneElem; boneElem = boneElem.GetNext("maskbone"))
+        AddMaskedBone(boneElem.GetAttribute("name"));
+
+    return true;
+}
+
+bool AnimationLodPolicy::Save(XMLElement& dest) const
+{
+    if (dest.IsNull())
+    {
+        URHO3D_LOGERROR("Can not save animation LOD policy to null XML element");
+        return false;
+    }
+
+    dest.SetUInt("invisibleinterval", invisibleInterval_);
+    dest.SetBool("interpolation", interpolation_);
+
+    for (unsigned i = 0; i < levels_.Size(); ++i)
+    {
+        XMLElement levelElem = dest.CreateChild("level");
+        levelElem.SetFloat("coverage", levels_[i].minCoverage_);
+        levelElem.SetUInt("interval", levels_[i].interval_);
+        levelElem.SetBool("maskbones", levels_[i].maskBones_);
+    }
+
+    for (unsigned i = 0; i < maskedBones_.Size(); ++i)
+        dest.CreateChild("maskbone").SetAttribute("name", maskedBones_[i]);
+
+    return true;
+}
+
+void AnimationLodPolicy::AddLevel(float minCoverage, unsigned interval, bool maskBones)
+{
+    AnimationLodLevel level;
+    level.minCoverage_ = Max(minCoverage, 0.0f);
+    level.interval_ = Max(interval, 1U);
+    level.maskBones_ = maskBones;
+
+    unsigned index = 0;
+    while (index < levels_.Size() && levels_[index].minCoverage_ >= level.minCoverage_)
+        ++index;
+    levels_.Insert(index, level);
+}
+
+void AnimationLodPolicy::RemoveLevel(unsigned index)
+{
+    if (index < levels_.Size())
+        levels_.Erase(index);
+}
+
+void AnimationLodPolicy::RemoveAllLevels()
+{
+    levels_.Clear();
+}
+
+void AnimationLodPolicy::AddMaskedBone(const String& name)
+{
+    if (!name.Empty())
+        maskedBones_.Push(name);
+}
+
+void AnimationLodPolicy::RemoveAllMaskedBones()
+{
+    maskedBones_.Clear();
+}
+
+void AnimationLodPolicy::SetInvisibleInterval(unsigned interval)
+{
+    invisibleInterval_ = Max(interval, 1U);
+}
+
+void AnimationLodPolicy::SetInterpolation(bool enable)
+{
+    interpolation_ = enable;
+}
+
+const AnimationLodLevel* AnimationLodPolicy::GetLevelForCoverage(float coverage) const
+{
+    if (levels_.Empty())
+        return nullptr;
+
+    for (unsigned i = 0; i < levels_.Size(); ++i)
+    {
+        if (coverage >= levels_[i].minCoverage_)
+            return &levels_[i];
+    }
+
+    return &levels_.Back();
+}
+
+bool AnimationLodPolicy::IsBoneMasked(const String& name) const
+{
+    for (unsigned i = 0; i < maskedBones_.Size(); ++i)
+    {
+        if (name.Contains(maskedBones_[i], false))
+            return true;
+    }
+
+    return false;
+}
+
+}
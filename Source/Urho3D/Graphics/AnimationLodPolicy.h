@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+class XMLElement;
+
+/// Animation LOD level.
+struct AnimationLodLevel
+{
+    /// Minimum screen coverage, as a fraction of the view height, for the level to be used.
+    float minCoverage_;
+    /// Number of frames between animation updates.
+    unsigned interval_;
+    /// Whether to skip the masked bones.
+    bool maskBones_;
+};
+
+/// Animation LOD policy shared by animated models. Selects how often the animations are updated, based on the model's screen coverage or invisibility, and which bones are left out at the lower levels.
+class URHO3D_API AnimationLodPolicy : public Resource
+{
+    URHO3D_OBJECT(AnimationLodPolicy, Resource);
+
+public:
+    /// Construct.
+    explicit AnimationLodPolicy(Context* context);
+    /// Destruct.
+    ~AnimationLodPolicy() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Save resource. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Load from an XML element. Return true if successful.
+    bool Load(const XMLElement& source);
+    /// Save to an XML element. Return true if successful.
+    bool Save(XMLElement& dest) const;
+
+    /// Add a level. Levels are kept sorted from the highest minimum coverage to the lowest.
+    void AddLevel(float minCoverage, unsigned interval, bool maskBones = false);
+    /// Remove a level by index.
+    void RemoveLevel(unsigned index);
+    /// Remove all levels.
+    void RemoveAllLevels();
+    /// Add a bone name to mask at the levels which mask bones. Bones with names containing it, case-insensitively, are masked.
+    void AddMaskedBone(const String& name);
+    /// Remove all masked bone names.
+    void RemoveAllMaskedBones();
+    /// Set number of frames between animation updates when the model is not visible, but updated while invisible.
+    void SetInvisibleInterval(unsigned interval);
+    /// Set whether to interpolate the bone transforms between the animation updates. This delays the animation by one update interval.
+    void SetInterpolation(bool enable);
+
+    /// Return number of levels.
+    unsigned GetNumLevels() const { return levels_.Size(); }
+    /// Return level by index.
+    const AnimationLodLevel* GetLevel(unsigned index) const { return index < levels_.Size() ? &levels_[index] : nullptr; }
+    /// Return the level to use for a screen coverage, which is the first level its coverage reaches, or the last level. Return null if there are no levels.
+    const AnimationLodLevel* GetLevelForCoverage(float coverage) const;
+    /// Return masked bone names.
+    const Vector<String>& GetMaskedBones() const { return maskedBones_; }
+    /// Return whether a bone name is masked.
+    bool IsBoneMasked(const String& name) const;
+    /// Return number of frames between animation updates when not visible.
+    unsigned GetInvisibleInterval() const { return invisibleInterval_; }
+    /// Return whether bone transforms are interpolated between the animation updates.
+    bool GetInterpolation() const { return interpolation_; }
+
+private:
+    /// LOD levels.
+    PODVector<AnimationLodLevel> levels_;
+    /// Masked bone names.
+    Vector<String> maskedBones_;
+    /// Update interval when not visible.
+    unsigned invisibleInterval_;
+    /// Interpolation flag.
+    bool interpolation_;
+};
+
+}
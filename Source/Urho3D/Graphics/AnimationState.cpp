@@ -452,8 +452,33 @@ void AnimationState::Apply()
         ApplyToNodes();
 }
 
+void AnimationState::ApplyToPose(Vector<BonePose>& pose)
+{
+    if (!animation_ || !IsEnabled() || !model_)
+        return;
+
+    SampleCompressed();
+
+    const Bone* bones = model_->GetSkeleton().GetBones().Buffer();
+    for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
+    {
+        AnimationStateTrack& stateTrack = *i;
+        float finalWeight = weight_ * stateTrack.weight_;
+
+        // Do not apply if zero effective weight or the bone is not animated in this update
+        if (Equals(finalWeight, 0.0f))
+            continue;
+
+        unsigned boneIndex = (unsigned)(stateTrack.bone_ - bones);
+        if (boneIndex < pose.Size() && pose[boneIndex].animated_)
+            BlendTrack(stateTrack, finalWeight, pose[boneIndex]);
+    }
+}
+
 void AnimationState::ApplyToModel()
 {
+    SampleCompressed();
+
     for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
     {
         AnimationStateTrack& stateTrack = *i;
@@ -469,66 +494,91 @@ void AnimationState::ApplyToModel()
 
 void AnimationState::ApplyToNodes()
 {
+    SampleCompressed();
+
     // When applying to a node hierarchy, can only use full weight (nothing to blend to)
     for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
         ApplyTrack(*i, 1.0f, false);
 }
 
+void AnimationState::SampleCompressed()
+{
+    // Decode all tracks of a compressed animation in one pass
+    if (animation_->IsCompressed())
+    {
+        samples_.Resize(animation_->GetSampleBufferSize());
+        animation_->Sample(time_, looped_, samples_.Buffer());
+    }
+}
+
 void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent)
 {
-    const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
-
-    if (track->keyFrames_.Empty() || !node)
+    if (!node)
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
+    BonePose pose;
+    pose.position_ = node->GetPosition();
+    pose.rotation_ = node->GetRotation();
+    pose.scale_ = node->GetScale();
+    AnimationChannelFlags channelMask = BlendTrack(stateTrack, weight, pose);
 
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
+    if (silent)
     {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPositionSilent(pose.position_);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotationSilent(pose.rotation_);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScaleSilent(pose.scale_);
     }
+    else
+    {
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPosition(pose.position_);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotation(pose.rotation_);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScale(pose.scale_);
+    }
+}
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    const AnimationChannelFlags channelMask = track->channelMask_;
-
+AnimationChannelFlags AnimationState::BlendTrack(AnimationStateTrack& stateTrack, float weight, BonePose& pose)
+{
+    const AnimationTrack* track = stateTrack.track_;
+    AnimationChannelFlags channelMask = track->channelMask_;
     Vector3 newPosition;
     Quaternion newRotation;
     Vector3 newScale;
 
-    if (interpolate)
+    if (animation_->IsCompressed())
     {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+        // The samples were decoded for all tracks already. Rotations are interpolated linearly and need normalization
+        const unsigned* offsets = track->sampleOffsets_;
+        channelMask = CHANNEL_NONE;
+        if (offsets[0] != M_MAX_UNSIGNED)
+        {
+            newPosition = Vector3(&samples_[offsets[0]]);
+            channelMask |= CHANNEL_POSITION;
+        }
+        if (offsets[1] != M_MAX_UNSIGNED)
+        {
+            newRotation = Quaternion(&samples_[offsets[1]]).Normalized();
+            channelMask |= CHANNEL_ROTATION;
+        }
+        if (offsets[2] != M_MAX_UNSIGNED)
+        {
+            newScale = Vector3(&samples_[offsets[2]]);
+            channelMask |= CHANNEL_SCALE;
+        }
+        if (!channelMask)
+            return CHANNEL_NONE;
     }
     else
     {
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
+        if (track->keyFrames_.Empty())
+            return CHANNEL_NONE;
+        track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, newPosition, newRotation, newScale);
     }
 
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
@@ -536,19 +586,19 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (channelMask & CHANNEL_POSITION)
         {
             Vector3 delta = newPosition - stateTrack.bone_->initialPosition_;
-            newPosition = node->GetPosition() + delta * weight;
+            newPosition = pose.position_ + delta * weight;
         }
         if (channelMask & CHANNEL_ROTATION)
         {
             Quaternion delta = newRotation * stateTrack.bone_->initialRotation_.Inverse();
-            newRotation = (delta * node->GetRotation()).Normalized();
+            newRotation = (delta * pose.rotation_).Normalized();
             if (!Equals(weight, 1.0f))
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                newRotation = pose.rotation_.Slerp(newRotation, weight);
         }
         if (channelMask & CHANNEL_SCALE)
         {
             Vector3 delta = newScale - stateTrack.bone_->initialScale_;
-            newScale = node->GetScale() + delta * weight;
+            newScale = pose.scale_ + delta * weight;
         }
     }
     else
@@ -556,32 +606,22 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (!Equals(weight, 1.0f)) // not full weight
         {
             if (channelMask & CHANNEL_POSITION)
-                newPosition = node->GetPosition().Lerp(newPosition, weight);
+                newPosition = pose.position_.Lerp(newPosition, weight);
             if (channelMask & CHANNEL_ROTATION)
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                newRotation = pose.rotation_.Slerp(newRotation, weight);
             if (channelMask & CHANNEL_SCALE)
-                newScale = node->GetScale().Lerp(newScale, weight);
+                newScale = pose.scale_.Lerp(newScale, weight);
         }
     }
 
-    if (silent)
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(newScale);
-    }
-    else
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(newScale);
-    }
+    if (channelMask & CHANNEL_POSITION)
+        pose.position_ = newPosition;
+    if (channelMask & CHANNEL_ROTATION)
+        pose.rotation_ = newRotation;
+    if (channelMask & CHANNEL_SCALE)
+        pose.scale_ = newScale;
+
+    return channelMask;
 }
 
 }
@@ -24,6 +24,7 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/Ptr.h"
+#include "../Graphics/Animation.h"
 
 namespace Urho3D
 {
@@ -35,6 +36,7 @@ class Serializer;
 class Skeleton;
 struct AnimationTrack;
 struct Bone;
+struct BonePose;
 
 /// %Animation blending mode.
 enum AnimationBlendMode
@@ -144,14 +146,20 @@ public:
 
     /// Apply the animation at the current time position.
     void Apply();
+    /// Blend the animation at the current time position into an animated model's pose buffer, which is indexed by bone. Does not modify the scene.
+    void ApplyToPose(Vector<BonePose>& pose);
 
 private:
     /// Apply animation to a skeleton. Transform changes are applied silently, so the model needs to dirty its root model afterward.
     void ApplyToModel();
     /// Apply animation to a scene node hierarchy.
     void ApplyToNodes();
+    /// Decode all tracks at the current time position if the animation is compressed.
+    void SampleCompressed();
     /// Apply track.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Sample a track and blend it into a bone transform. Return the channels that were changed.
+    AnimationChannelFlags BlendTrack(AnimationStateTrack& stateTrack, float weight, BonePose& pose);
 
     /// Animated model (model mode.)
     WeakPtr<AnimatedModel> model_;
@@ -163,6 +171,8 @@ private:
     Bone* startBone_;
     /// Per-track data.
     Vector<AnimationStateTrack> stateTracks_;
+    /// Decoded tracks of a compressed animation.
+    PODVector<float> samples_;
     /// Looped flag.
     bool looped_;
     /// Blending weight.
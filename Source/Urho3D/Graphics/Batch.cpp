@@ -40,34 +40,22 @@
 namespace Urho3D
 {
 
-inline bool CompareBatchesState(Batch* lhs, Batch* rhs)
+/// Return the bits of a float as an unsigned integer that sorts in the same order.
+inline unsigned GetSortableFloatBits(float value)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->sortKey_ != rhs->sortKey_)
-        return lhs->sortKey_ < rhs->sortKey_;
-    else
-        return lhs->distance_ < rhs->distance_;
+    unsigned bits;
+    memcpy(&bits, &value, sizeof bits);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
 }
 
-inline bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+/// Return packed distance sort key of a batch: render order, then distance, then the shader and light part of the state sort key.
+inline unsigned long long GetDistanceSortKey(const Batch* batch, bool backToFront)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
-}
+    unsigned distanceBits = GetSortableFloatBits(batch->distance_);
+    if (backToFront)
+        distanceBits = ~distanceBits;
 
-inline bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
-{
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    return ((unsigned long long)batch->renderOrder_) << 56u | ((unsigned long long)distanceBits) << 24u | batch->sortKey_ >> 40u;
 }
 
 inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
@@ -224,7 +212,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
     }
 
     // Set global (per-frame) shader parameters
-    if (graphics->NeedParameterUpdate(SP_FRAME, nullptr))
+    if (graphics->NeedParameterUpdate(SP_FRAME, view->GetGlobalShaderParameterSource()))
         view->SetGlobalShaderParameters();
 
     // Set camera & viewport shader parameters
@@ -596,7 +584,9 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
     // Set material-specific shader parameters and textures
     if (material_)
     {
-        if (graphics->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material_->GetShaderParameterHash())))
+        // With constant buffers the material binds its own prebuilt buffers instead
+        if (!graphics->SetMaterialShaderParameters(material_) &&
+            graphics->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material_->GetShaderParameterHash())))
         {
             const HashMap<StringHash, MaterialShaderParameter>& parameters = material_->GetShaderParameters();
             for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
@@ -631,25 +621,53 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             graphics->SetTexture(TU_LIGHTSHAPE, shapeTexture);
         }
     }
+
+    // Set the light grid for base passes using clustered forward lighting
+    if (isBase_ && graphics->HasTextureUnit(TU_LIGHTBUFFER))
+    {
+        Texture2D* clusterTexture = view->GetClusterTexture();
+        if (clusterTexture)
+            graphics->SetTexture(TU_LIGHTBUFFER, clusterTexture);
+    }
 }
 
 void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 {
     if (!geometry_->IsEmpty())
     {
-        Prepare(view, camera, true, allowDepthWrite);
-        geometry_->Draw(view->GetGraphics());
+        if (geometryType_ == GEOM_INSTANCED && instancingBuffer_)
+        {
+            // Draw all instances from the persistent instancing buffer, the transforms are already uploaded
+            Graphics* graphics = view->GetGraphics();
+            Prepare(view, camera, false, allowDepthWrite);
+
+            // Hack: use a const_cast to avoid dynamic allocation of new temp vectors
+            auto& vertexBuffers = const_cast<Vector<SharedPtr<VertexBuffer> >&>(geometry_->GetVertexBuffers());
+            vertexBuffers.Push(SharedPtr<VertexBuffer>(instancingBuffer_));
+
+            graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
+            graphics->SetVertexBuffers(vertexBuffers);
+            graphics->DrawInstanced(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
+                geometry_->GetVertexStart(), geometry_->GetVertexCount(), numWorldTransforms_);
+
+            vertexBuffers.Pop();
+        }
+        else
+        {
+            Prepare(view, camera, true, allowDepthWrite);
+            geometry_->Draw(view->GetGraphics());
+        }
     }
 }
 
-void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
+void BatchGroup::SetInstancingData(void*& lockedData, unsigned stride, unsigned& freeIndex)
 {
     // Do not use up buffer space if not going to draw as instanced
     if (geometryType_ != GEOM_INSTANCED)
         return;
 
     startIndex_ = freeIndex;
-    unsigned char* buffer = static_cast<unsigned char*>(lockedData) + startIndex_ * stride;
+    unsigned char* buffer = static_cast<unsigned char*>(lockedData);
 
     for (unsigned i = 0; i < instances_.Size(); ++i)
     {
@@ -662,6 +680,7 @@ void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned&
         buffer += stride;
     }
 
+    lockedData = buffer;
     freeIndex += instances_.Size();
 }
 
@@ -711,6 +730,57 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
     }
 }
 
+bool BatchGroup::IsMultiDrawCompatible(const BatchGroup& rhs) const
+{
+    // Both groups must have their instance data in the instancing buffer
+    if (geometryType_ != GEOM_INSTANCED || rhs.geometryType_ != GEOM_INSTANCED || startIndex_ == M_MAX_UNSIGNED ||
+        rhs.startIndex_ == M_MAX_UNSIGNED || instances_.Empty() || rhs.instances_.Empty())
+        return false;
+
+    // The render state set by Prepare() must be the same
+    if (vertexShader_ != rhs.vertexShader_ || pixelShader_ != rhs.pixelShader_ || pass_ != rhs.pass_ ||
+        material_ != rhs.material_ || zone_ != rhs.zone_ || lightQueue_ != rhs.lightQueue_ || isBase_ != rhs.isBase_)
+        return false;
+
+    // The geometries may differ, but they must be drawn from the same buffers
+    return !geometry_->IsEmpty() && !rhs.geometry_->IsEmpty() && geometry_->GetIndexBuffer() &&
+        geometry_->GetIndexBuffer() == rhs.geometry_->GetIndexBuffer() &&
+        geometry_->GetPrimitiveType() == rhs.geometry_->GetPrimitiveType() &&
+        geometry_->GetVertexBuffers() == rhs.geometry_->GetVertexBuffers();
+}
+
+void BatchGroup::MultiDraw(View* view, Camera* camera, bool allowDepthWrite, BatchGroup* const* groups, unsigned numGroups,
+    PODVector<InstancedDrawCommand>& commands) const
+{
+    Graphics* graphics = view->GetGraphics();
+    Renderer* renderer = view->GetRenderer();
+
+    Batch::Prepare(view, camera, false, allowDepthWrite);
+
+    commands.Resize(numGroups);
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        const BatchGroup* group = groups[i];
+        InstancedDrawCommand& command = commands[i];
+        command.indexStart_ = group->geometry_->GetIndexStart();
+        command.indexCount_ = group->geometry_->GetIndexCount();
+        command.minVertex_ = group->geometry_->GetVertexStart();
+        command.vertexCount_ = group->geometry_->GetVertexCount();
+        command.instanceStart_ = group->startIndex_;
+        command.instanceCount_ = group->instances_.Size();
+    }
+
+    // Hack: use a const_cast to avoid dynamic allocation of new temp vectors
+    auto& vertexBuffers = const_cast<Vector<SharedPtr<VertexBuffer> >&>(geometry_->GetVertexBuffers());
+    vertexBuffers.Push(SharedPtr<VertexBuffer>(renderer->GetInstancingBuffer()));
+
+    graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
+    graphics->SetVertexBuffers(vertexBuffers);
+    graphics->MultiDrawInstanced(geometry_->GetPrimitiveType(), commands);
+
+    vertexBuffers.Pop();
+}
+
 unsigned BatchGroupKey::ToHash() const
 {
     return (unsigned)((size_t)zone_ / sizeof(Zone) + (size_t)lightQueue_ / sizeof(LightBatchQueue) + (size_t)pass_ / sizeof(Pass) +
@@ -727,12 +797,19 @@ void BatchQueue::Clear(int maxSortedInstances)
 
 void BatchQueue::SortBackToFront()
 {
-    sortedBatches_.Resize(batches_.Size());
+    sortEntries_.Resize(batches_.Size());
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
-        sortedBatches_[i] = &batches_[i];
+    {
+        sortEntries_[i].key_ = GetDistanceSortKey(&batches_[i], true);
+        sortEntries_[i].value_ = &batches_[i];
+    }
+
+    SortEntries();
 
-    Sort(sortedBatches_.Begin(), sortedBatches_.End(), CompareBatchesBackToFront);
+    sortedBatches_.Resize(batches_.Size());
+    for (unsigned i = 0; i < sortEntries_.Size(); ++i)
+        sortedBatches_[i] = sortEntries_[i].value_;
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
@@ -764,7 +841,7 @@ void BatchQueue::SortFrontToBack()
         else
         {
             float minDistance = M_INFINITY;
-            for (PODVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
+            for (FrameVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
                 minDistance = Min(minDistance, j->distance_);
             i->second_.distance_ = minDistance;
         }
@@ -781,21 +858,43 @@ void BatchQueue::SortFrontToBack()
 
 void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
 {
+    // The batches are sorted through packed 64-bit keys with a stable radix sort, so sorting by the less significant
+    // criteria first retains their order among batches that are equal by the more significant criteria
+    sortEntries_.Resize(batches.Size());
+
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
     // method is also time consuming, so just sort with state having priority
 #ifdef GL_ES_VERSION_2_0
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        sortEntries_[i].key_ = GetSortableFloatBits(batches[i]->distance_);
+        sortEntries_[i].value_ = batches[i];
+    }
+    SortEntries();
+
+    for (unsigned i = 0; i < sortEntries_.Size(); ++i)
+        sortEntries_[i].key_ = sortEntries_[i].value_->sortKey_;
+    SortEntries();
+
+    for (unsigned i = 0; i < sortEntries_.Size(); ++i)
+        sortEntries_[i].key_ = sortEntries_[i].value_->renderOrder_;
+    SortEntries();
 #else
     // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        sortEntries_[i].key_ = GetDistanceSortKey(batches[i], false);
+        sortEntries_[i].value_ = batches[i];
+    }
+    SortEntries();
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
     unsigned short freeGeometryID = 0;
 
-    for (PODVector<Batch*>::Iterator i = batches.Begin(); i != batches.End(); ++i)
+    for (PODVector<RadixSortEntry<Batch*> >::Iterator i = sortEntries_.Begin(); i != sortEntries_.End(); ++i)
     {
-        Batch* batch = *i;
+        Batch* batch = i->value_;
 
         auto shaderID = (unsigned)(batch->sortKey_ >> 32u);
         HashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
@@ -828,23 +927,62 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         }
 
         batch->sortKey_ = (((unsigned long long)shaderID) << 32u) | (((unsigned long long)materialID) << 16u) | geometryID;
+        // The remapped shader IDs are sequential, so 23 bits and the base pass flag fit between render order and material
+        i->key_ = ((unsigned long long)batch->renderOrder_) << 56u | ((unsigned long long)(shaderID & 0x7fffffu)) << 32u |
+            (shaderID & 0x80000000u ? 0x80000000000000ULL : 0ULL) | (((unsigned long long)materialID) << 16u) | geometryID;
     }
 
     shaderRemapping_.Clear();
     materialRemapping_.Clear();
     geometryRemapping_.Clear();
 
-    // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    // Finally sort again with the rewritten ID's. Batches with the same state remain sorted front to back
+    SortEntries();
 #endif
+
+    for (unsigned i = 0; i < sortEntries_.Size(); ++i)
+        batches[i] = sortEntries_[i].value_;
+}
+
+void BatchQueue::SortEntries()
+{
+    sortBuffer_.Resize(sortEntries_.Size());
+    RadixSort(sortEntries_.Begin().ptr_, sortEntries_.End().ptr_, sortBuffer_.Begin().ptr_);
 }
 
-void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
+void BatchQueue::SetInstancingData(void*& lockedData, unsigned stride, unsigned& freeIndex)
 {
     for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         i->second_.SetInstancingData(lockedData, stride, freeIndex);
 }
 
+void BatchQueue::SnapshotTransforms(FrameArena* arena)
+{
+    for (PODVector<Batch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
+    {
+        if (!i->worldTransform_ || !i->numWorldTransforms_)
+            continue;
+
+        auto* transforms = arena->AllocateArray<Matrix3x4>(i->numWorldTransforms_);
+        memcpy(transforms, i->worldTransform_, i->numWorldTransforms_ * sizeof(Matrix3x4));
+        i->worldTransform_ = transforms;
+    }
+
+    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    {
+        FrameVector<InstanceData>& instances = i->second_.instances_;
+        if (instances.Empty())
+            continue;
+
+        auto* transforms = arena->AllocateArray<Matrix3x4>(instances.Size());
+        for (unsigned j = 0; j < instances.Size(); ++j)
+        {
+            transforms[j] = *instances[j].worldTransform_;
+            instances[j].worldTransform_ = &transforms[j];
+        }
+    }
+}
+
 void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const
 {
     Graphics* graphics = view->GetGraphics();
@@ -860,14 +998,28 @@ void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool using
             graphics->SetStencilTest(false);
     }
 
-    // Instanced
-    for (PODVector<BatchGroup*>::ConstIterator i = sortedBatchGroups_.Begin(); i != sortedBatchGroups_.End(); ++i)
+    // Instanced. Merge consecutive groups that differ only by geometry within the same buffers, if multi-draw is supported
+    bool multiDraw = graphics->GetMultiDrawSupport() && renderer->GetInstancingBuffer();
+    for (unsigned i = 0; i < sortedBatchGroups_.Size();)
     {
-        BatchGroup* group = *i;
+        BatchGroup* group = sortedBatchGroups_[i];
         if (markToStencil)
             graphics->SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, group->lightMask_);
 
-        group->Draw(view, camera, allowDepthWrite);
+        unsigned end = i + 1;
+        if (multiDraw)
+        {
+            while (end < sortedBatchGroups_.Size() && group->IsMultiDrawCompatible(*sortedBatchGroups_[end]) &&
+                (!markToStencil || sortedBatchGroups_[end]->lightMask_ == group->lightMask_))
+                ++end;
+        }
+
+        if (end - i > 1)
+            group->MultiDraw(view, camera, allowDepthWrite, &sortedBatchGroups_[i], end - i, drawCommands_);
+        else
+            group->Draw(view, camera, allowDepthWrite);
+
+        i = end;
     }
     // Non-instanced
     for (PODVector<Batch*>::ConstIterator i = sortedBatches_.Begin(); i != sortedBatches_.End(); ++i)
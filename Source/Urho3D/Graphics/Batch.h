@@ -23,6 +23,8 @@
 #pragma once
 
 #include "../Container/Ptr.h"
+#include "../Container/Sort.h"
+#include "../Core/FrameArena.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Material.h"
 #include "../Math/MathDefs.h"
@@ -45,6 +47,7 @@ class VertexBuffer;
 class View;
 class Zone;
 struct LightBatchQueue;
+struct ShadowMapCache;
 
 /// Queued 3D geometry draw call.
 struct Batch
@@ -62,6 +65,7 @@ struct Batch
         worldTransform_(rhs.worldTransform_),
         numWorldTransforms_(rhs.numWorldTransforms_),
         instancingData_(rhs.instancingData_),
+        instancingBuffer_(rhs.instancingBuffer_),
         lightQueue_(nullptr),
         geometryType_(rhs.geometryType_)
     {
@@ -94,6 +98,8 @@ struct Batch
     unsigned numWorldTransforms_{};
     /// Per-instance data. If not null, must contain enough data to fill instancing buffer.
     void* instancingData_{};
+    /// Persistent instancing buffer holding the world transforms, or null to use the renderer's shared instancing buffer.
+    VertexBuffer* instancingBuffer_{};
     /// Zone.
     Zone* zone_{};
     /// Light properties.
@@ -163,13 +169,18 @@ struct BatchGroup : public Batch
         }
     }
 
-    /// Pre-set the instance data. Buffer must be big enough to hold all data.
-    void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Pre-set the instance data. Buffer must be big enough to hold all data. The locked data points to the free index and is advanced past the written instances.
+    void SetInstancingData(void*& lockedData, unsigned stride, unsigned& freeIndex);
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
+    /// Return whether can be drawn in the same multi-draw call as another group. Requires pre-set instance data and the same render state, vertex and index buffers.
+    bool IsMultiDrawCompatible(const BatchGroup& rhs) const;
+    /// Prepare and draw compatible groups, starting from this one, with one multi-draw call.
+    void MultiDraw(View* view, Camera* camera, bool allowDepthWrite, BatchGroup* const* groups, unsigned numGroups,
+        PODVector<InstancedDrawCommand>& commands) const;
 
     /// Instance data.
-    PODVector<InstanceData> instances_;
+    FrameVector<InstanceData> instances_;
     /// Instance stream start index, or M_MAX_UNSIGNED if transforms not pre-set.
     unsigned startIndex_;
 };
@@ -234,8 +245,12 @@ public:
     void SortFrontToBack();
     /// Sort batches front to back while also maintaining state sorting.
     void SortFrontToBack2Pass(PODVector<Batch*>& batches);
-    /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
-    void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Radix sort the packed sort keys.
+    void SortEntries();
+    /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data. The locked data points to the free index and is advanced past the written instances.
+    void SetInstancingData(void*& lockedData, unsigned stride, unsigned& freeIndex);
+    /// Copy the world transforms of all draw calls into the frame arena and point the draw calls to the copies.
+    void SnapshotTransforms(FrameArena* arena);
     /// Draw.
     void Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const;
     /// Return the combined amount of instances.
@@ -259,6 +274,12 @@ public:
     PODVector<Batch*> sortedBatches_;
     /// Sorted instanced draw calls.
     PODVector<BatchGroup*> sortedBatchGroups_;
+    /// Draw commands of merged instanced draw calls.
+    mutable PODVector<InstancedDrawCommand> drawCommands_;
+    /// Packed sort keys of the draw calls being sorted.
+    PODVector<RadixSortEntry<Batch*> > sortEntries_;
+    /// Radix sort scratch buffer.
+    PODVector<RadixSortEntry<Batch*> > sortBuffer_;
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
     /// Whether the pass command contains extra shader defines.
@@ -280,8 +301,10 @@ struct ShadowBatchQueue
     Camera* shadowCamera_{};
     /// Shadow map viewport.
     IntRect shadowViewport_;
-    /// Shadow caster draw calls.
+    /// Shadow caster draw calls. With shadow caching, only the dynamic shadow casters.
     BatchQueue shadowBatches_;
+    /// Static shadow caster draw calls with shadow caching.
+    BatchQueue staticShadowBatches_;
     /// Directional light cascade near split distance.
     float nearSplit_{};
     /// Directional light cascade far split distance.
@@ -297,6 +320,14 @@ struct LightBatchQueue
     bool negative_;
     /// Shadow map depth texture.
     Texture2D* shadowMap_;
+    /// Area of the shadow map used by the light. Covers the whole shadow map unless allocated from the shadow atlas.
+    IntRect shadowMapRect_;
+    /// Shadow map is a shadow atlas tile flag.
+    bool shadowAtlas_;
+    /// Cached shadow maps with shadow caching.
+    ShadowMapCache* shadowMapCache_;
+    /// Static shadow casters and their geometries with shadow caching, for detecting changes to the cached shadow map.
+    PODVector<void*> staticShadowCasters_;
     /// Lit geometry draw calls, base (replace blend mode)
     BatchQueue litBaseBatches_;
     /// Lit geometry draw calls, non-base (additive)
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/BillboardSet.h"
 #include "../Graphics/Camera.h"
@@ -44,6 +46,8 @@ namespace Urho3D
 extern const char* GEOMETRY_CATEGORY;
 
 static const float INV_SQRT_TWO = 1.0f / sqrtf(2.0f);
+/// Minimum number of billboards per work item when writing the vertex buffer in parallel.
+static const unsigned BILLBOARD_VERTEX_CHUNK_SIZE = 1024;
 
 const char* faceCameraModeNames[] =
 {
@@ -69,9 +73,10 @@ static const StringVector billboardsStructureElementNames =
     "   Is Enabled"
 };
 
-inline bool CompareBillboards(Billboard* lhs, Billboard* rhs)
+void WriteBillboardVerticesWork(const WorkItem* item, unsigned threadIndex)
 {
-    return lhs->sortDistance_ > rhs->sortDistance_;
+    auto* billboardSet = reinterpret_cast<BillboardSet*>(item->aux_);
+    billboardSet->WriteVertices(reinterpret_cast<Billboard**>(item->start_), reinterpret_cast<Billboard**>(item->end_));
 }
 
 BillboardSet::BillboardSet(Context* context) :
@@ -94,7 +99,8 @@ BillboardSet::BillboardSet(Context* context) :
     sortThisFrame_(false),
     hasOrthoCamera_(false),
     sortFrameNumber_(0),
-    previousOffset_(Vector3::ZERO)
+    previousOffset_(Vector3::ZERO),
+    vertexDest_(nullptr)
 {
     geometry_->SetVertexBuffer(0, vertexBuffer_);
     geometry_->SetIndexBuffer(indexBuffer_);
@@ -244,10 +250,14 @@ void BillboardSet::UpdateGeometry(const FrameInfo& frame)
 
 UpdateGeometryType BillboardSet::GetUpdateGeometryType()
 {
-    // If using camera facing, always need some kind of geometry update, in case the billboard set is rendered from several views
+    // Writing the buffers has to happen in the main thread. With multiple views, fixed screen size may also need a rewrite
     if (bufferDirty_ || bufferSizeDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost() || sortThisFrame_ ||
-        faceCameraMode_ != FC_NONE || fixedScreenSize_)
+        (fixedScreenSize_ && viewCameras_.Size() > 1))
         return UPDATE_MAIN_THREAD;
+    // If using camera facing, the rotation needs to be updated in case the billboard set is rendered from several views. This is
+    // safe to do in a worker thread
+    else if (faceCameraMode_ != FC_NONE)
+        return UPDATE_WORKER_THREAD;
     else
         return UPDATE_NONE;
 }
@@ -627,21 +637,75 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
 
     if (sorted_)
     {
-        Sort(sortedBillboards_.Begin(), sortedBillboards_.End(), CompareBillboards);
+        // Radix sort back to front. The squared distances are non-negative, so their bits sort in the same order as the values
+        sortEntries_.Resize(enabledBillboards);
+        sortBuffer_.Resize(enabledBillboards);
+        for (unsigned i = 0; i < enabledBillboards; ++i)
+        {
+            unsigned distanceBits;
+            memcpy(&distanceBits, &sortedBillboards_[i]->sortDistance_, sizeof distanceBits);
+            sortEntries_[i].key_ = ~distanceBits;
+            sortEntries_[i].value_ = sortedBillboards_[i];
+        }
+        RadixSort(sortEntries_.Buffer(), sortEntries_.Buffer() + enabledBillboards, sortBuffer_.Buffer());
+        for (unsigned i = 0; i < enabledBillboards; ++i)
+            sortedBillboards_[i] = sortEntries_[i].value_;
+
         Vector3 worldPos = node_->GetWorldPosition();
         // Store the "last sorted position" now
         previousOffset_ = (worldPos - frame.camera_->GetNode()->GetWorldPosition());
     }
 
-    auto* dest = (float*)vertexBuffer_->Lock(0, enabledBillboards * 4, true);
-    if (!dest)
+    vertexDest_ = (float*)vertexBuffer_->Lock(0, enabledBillboards * 4, true);
+    if (!vertexDest_)
         return;
+    vertexScale_ = billboardScale;
+
+    Billboard** billboards = &sortedBillboards_[0];
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = queue && Thread::IsMainThread() ? queue->GetNumThreads() + 1 : 1;
+    unsigned chunkSize = Max((enabledBillboards + numWorkItems - 1) / numWorkItems, BILLBOARD_VERTEX_CHUNK_SIZE);
+
+    // Split large billboard sets into chunks written in parallel directly to the locked buffer
+    if (chunkSize < enabledBillboards)
+    {
+        URHO3D_PROFILE(WriteBillboardVertices);
+
+        for (unsigned start = 0; start < enabledBillboards; start += chunkSize)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = WriteBillboardVerticesWork;
+            item->name_ = "WriteBillboardVerticesWork";
+            item->aux_ = this;
+            item->start_ = billboards + start;
+            item->end_ = billboards + Min(start + chunkSize, enabledBillboards);
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+    else
+        WriteVertices(billboards, billboards + enabledBillboards);
+
+    vertexBuffer_->Unlock();
+    vertexBuffer_->ClearDataLost();
+    vertexDest_ = nullptr;
+}
+
+void BillboardSet::WriteVertices(Billboard** start, Billboard** end) const
+{
+    const Vector3& billboardScale = vertexScale_;
+    auto numBillboards = (unsigned)(end - start);
+    auto startIndex = (unsigned)(start - &sortedBillboards_[0]);
 
     if (faceCameraMode_ != FC_DIRECTION)
     {
-        for (unsigned i = 0; i < enabledBillboards; ++i)
+        float* dest = vertexDest_ + startIndex * 32;
+
+        for (unsigned i = 0; i < numBillboards; ++i)
         {
-            Billboard& billboard = *sortedBillboards_[i];
+            Billboard& billboard = *start[i];
 
             Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
             unsigned color = billboard.color_.ToUInt();
@@ -694,9 +758,11 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     }
     else
     {
-        for (unsigned i = 0; i < enabledBillboards; ++i)
+        float* dest = vertexDest_ + startIndex * 44;
+
+        for (unsigned i = 0; i < numBillboards; ++i)
         {
-            Billboard& billboard = *sortedBillboards_[i];
+            Billboard& billboard = *start[i];
 
             Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
             unsigned color = billboard.color_.ToUInt();
@@ -759,9 +825,6 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             dest += 44;
         }
     }
-
-    vertexBuffer_->Unlock();
-    vertexBuffer_->ClearDataLost();
 }
 
 void BillboardSet::MarkPositionsDirty()
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/Sort.h"
 #include "../Graphics/Drawable.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/Color.h"
@@ -33,6 +34,7 @@ namespace Urho3D
 
 class IndexBuffer;
 class VertexBuffer;
+struct WorkItem;
 
 /// One billboard in the billboard set.
 struct URHO3D_API Billboard
@@ -61,6 +63,9 @@ struct URHO3D_API Billboard
 class URHO3D_API BillboardSet : public Drawable
 {
     URHO3D_OBJECT(BillboardSet, Drawable);
+    URHO3D_POOLED_OBJECT(BillboardSet);
+
+    friend void WriteBillboardVerticesWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -176,6 +181,8 @@ private:
     void UpdateBufferSize();
     /// Rewrite billboard vertex buffer.
     void UpdateVertexBuffer(const FrameInfo& frame);
+    /// Write vertices of a range of the sorted billboards to the locked vertex buffer. May be called from a worker thread.
+    void WriteVertices(Billboard** start, Billboard** end) const;
     /// Calculate billboard scale factors in fixed screen size mode.
     void CalculateFixedScreenSize(const FrameInfo& frame);
 
@@ -205,6 +212,14 @@ private:
     Vector3 previousOffset_;
     /// Billboard pointers for sorting.
     Vector<Billboard*> sortedBillboards_;
+    /// Radix sort entries by distance.
+    PODVector<RadixSortEntry<Billboard*> > sortEntries_;
+    /// Radix sort scratch buffer.
+    PODVector<RadixSortEntry<Billboard*> > sortBuffer_;
+    /// Locked vertex data during the vertex buffer rewrite.
+    float* vertexDest_;
+    /// Billboard size scale during the vertex buffer rewrite.
+    Vector3 vertexScale_;
     /// Attribute buffer for network replication.
     mutable VectorBuffer attrBuffer_;
 };
@@ -58,6 +58,9 @@ public:
     /// Return size.
     unsigned GetSize() const { return size_; }
 
+    /// Return CPU-side copy of the data.
+    const unsigned char* GetShadowData() const { return shadowData_.Get(); }
+
     /// Return whether has unapplied data.
     bool IsDirty() const { return dirty_; }
 
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/CustomGeometry.h"
@@ -347,66 +348,101 @@ void CustomGeometry::Commit()
         vertexBuffer_->IsDynamic() != dynamic_)
         vertexBuffer_->SetSize(totalVertices, elementMask_, dynamic_);
 
+    unsigned vertexStart = 0;
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        geometries_[i]->SetVertexBuffer(0, vertexBuffer_);
+        geometries_[i]->SetDrawRange(primitiveTypes_[i], 0, 0, vertexStart, vertices_[i].Size());
+        vertexStart += vertices_[i].Size();
+    }
+
+    // A dynamic geometry writes its vertices when it is next rendered, possibly in a worker thread. This also avoids
+    // rewriting the buffer when committing several times per frame
+    bufferDirty_ = dynamic_;
+    uploadPending_ = false;
+    if (dynamic_)
+        return;
+
     if (totalVertices)
     {
         auto* dest = (unsigned char*)vertexBuffer_->Lock(0, totalVertices, true);
         if (dest)
         {
-            unsigned vertexStart = 0;
+            WriteVertices(dest);
+            vertexBuffer_->Unlock();
+        }
+        else
+            URHO3D_LOGERROR("Failed to lock custom geometry vertex buffer");
+    }
 
-            for (unsigned i = 0; i < vertices_.Size(); ++i)
-            {
-                unsigned vertexCount = 0;
+    vertexBuffer_->ClearDataLost();
+}
 
-                for (unsigned j = 0; j < vertices_[i].Size(); ++j)
-                {
-                    *((Vector3*)dest) = vertices_[i][j].position_;
-                    dest += sizeof(Vector3);
+void CustomGeometry::UpdateGeometry(const FrameInfo& frame)
+{
+    vertexData_.Resize(vertexBuffer_->GetVertexCount() * vertexBuffer_->GetVertexSize());
+    if (vertexData_.Size())
+        WriteVertices(vertexData_.Buffer());
 
-                    if (elementMask_ & MASK_NORMAL)
-                    {
-                        *((Vector3*)dest) = vertices_[i][j].normal_;
-                        dest += sizeof(Vector3);
-                    }
-                    if (elementMask_ & MASK_COLOR)
-                    {
-                        *((unsigned*)dest) = vertices_[i][j].color_;
-                        dest += sizeof(unsigned);
-                    }
-                    if (elementMask_ & MASK_TEXCOORD1)
-                    {
-                        *((Vector2*)dest) = vertices_[i][j].texCoord_;
-                        dest += sizeof(Vector2);
-                    }
-                    if (elementMask_ & MASK_TANGENT)
-                    {
-                        *((Vector4*)dest) = vertices_[i][j].tangent_;
-                        dest += sizeof(Vector4);
-                    }
+    bufferDirty_ = false;
+    uploadPending_ = true;
 
-                    ++vertexCount;
-                }
+    // If not in a worker thread, upload right away
+    if (Thread::IsMainThread())
+        FinishUpdateGeometry();
+}
 
-                geometries_[i]->SetVertexBuffer(0, vertexBuffer_);
-                geometries_[i]->SetDrawRange(primitiveTypes_[i], 0, 0, vertexStart, vertexCount);
-                vertexStart += vertexCount;
-            }
+void CustomGeometry::FinishUpdateGeometry()
+{
+    if (!uploadPending_)
+        return;
 
-            vertexBuffer_->Unlock();
-        }
-        else
-            URHO3D_LOGERROR("Failed to lock custom geometry vertex buffer");
-    }
+    uploadPending_ = false;
+    if (vertexData_.Size() && !vertexBuffer_->SetDataRange(vertexData_.Buffer(), 0, vertexBuffer_->GetVertexCount(), true))
+        URHO3D_LOGERROR("Failed to update custom geometry vertex buffer");
+    vertexBuffer_->ClearDataLost();
+}
+
+UpdateGeometryType CustomGeometry::GetUpdateGeometryType()
+{
+    // Writing the vertices is safe in a worker thread, as the upload is done afterward in the main thread
+    if (bufferDirty_ || vertexBuffer_->IsDataLost())
+        return UPDATE_WORKER_THREAD;
     else
+        return UPDATE_NONE;
+}
+
+void CustomGeometry::WriteVertices(unsigned char* dest) const
+{
+    for (unsigned i = 0; i < vertices_.Size(); ++i)
     {
-        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        for (unsigned j = 0; j < vertices_[i].Size(); ++j)
         {
-            geometries_[i]->SetVertexBuffer(0, vertexBuffer_);
-            geometries_[i]->SetDrawRange(primitiveTypes_[i], 0, 0, 0, 0);
+            *((Vector3*)dest) = vertices_[i][j].position_;
+            dest += sizeof(Vector3);
+
+            if (elementMask_ & MASK_NORMAL)
+            {
+                *((Vector3*)dest) = vertices_[i][j].normal_;
+                dest += sizeof(Vector3);
+            }
+            if (elementMask_ & MASK_COLOR)
+            {
+                *((unsigned*)dest) = vertices_[i][j].color_;
+                dest += sizeof(unsigned);
+            }
+            if (elementMask_ & MASK_TEXCOORD1)
+            {
+                *((Vector2*)dest) = vertices_[i][j].texCoord_;
+                dest += sizeof(Vector2);
+            }
+            if (elementMask_ & MASK_TANGENT)
+            {
+                *((Vector4*)dest) = vertices_[i][j].tangent_;
+                dest += sizeof(Vector4);
+            }
         }
     }
-
-    vertexBuffer_->ClearDataLost();
 }
 
 void CustomGeometry::SetMaterial(Material* material)
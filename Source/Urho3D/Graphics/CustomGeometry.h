@@ -65,12 +65,18 @@ public:
     unsigned GetNumOccluderTriangles() override;
     /// Draw to occlusion buffer. Return true if did not run out of triangles.
     bool DrawOcclusion(OcclusionBuffer* buffer) override;
+    /// Prepare geometry for rendering. Called from a worker thread if possible (no GPU update).
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Upload the vertex data written by a worker thread geometry update.
+    void FinishUpdateGeometry() override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
 
     /// Clear all geometries.
     void Clear();
     /// Set number of geometries.
     void SetNumGeometries(unsigned num);
-    /// Set vertex buffer dynamic mode. A dynamic buffer should be faster to update frequently. Effective at the next Commit() call.
+    /// Set vertex buffer dynamic mode. A dynamic buffer should be faster to update frequently. Effective at the next Commit() call. In dynamic mode Commit() defers writing the vertex buffer until the geometry is rendered, which allows it to happen in a worker thread.
     void SetDynamic(bool enable);
     /// Begin defining a geometry. Clears existing vertices in that index.
     void BeginGeometry(unsigned index, PrimitiveType type);
@@ -127,6 +133,9 @@ protected:
     void OnWorldBoundingBoxUpdate() override;
 
 private:
+    /// Write the interleaved vertices of all geometries.
+    void WriteVertices(unsigned char* dest) const;
+
     /// Primitive type per geometry.
     PODVector<PrimitiveType> primitiveTypes_;
     /// Source vertices per geometry.
@@ -143,6 +152,12 @@ private:
     mutable ResourceRefList materialsAttr_;
     /// Vertex buffer dynamic flag.
     bool dynamic_;
+    /// Vertex data written in UpdateGeometry() for uploading in the main thread.
+    PODVector<unsigned char> vertexData_;
+    /// Vertex buffer needs rewrite flag.
+    bool bufferDirty_{};
+    /// Vertex data waiting to be uploaded flag.
+    bool uploadPending_{};
 };
 
 }
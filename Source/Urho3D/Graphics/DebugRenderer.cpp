@@ -25,10 +25,12 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Light.h"
 #include "../Graphics/ShaderVariation.h"
 #include "../Graphics/VertexBuffer.h"
@@ -46,12 +48,114 @@ extern const char* SUBSYSTEM_CATEGORY;
 static const unsigned MAX_LINES = 1000000;
 // Cap the amount of triangles to prevent crash.
 static const unsigned MAX_TRIANGLES = 100000;
+// Cap the amount of shape instances.
+static const unsigned MAX_SHAPES = 100000;
+// Persistent layers not drawn for this many frames are removed.
+static const unsigned LAYER_EXPIRE_FRAMES = 60;
+
+static bool CompareShapeInstances(const DebugShapeInstance& lhs, const DebugShapeInstance& rhs)
+{
+    return lhs.shape_ != rhs.shape_ ? lhs.shape_ < rhs.shape_ : lhs.color_ < rhs.color_;
+}
+
+static void WriteLineVertex(float*& dest, const Vector3& position, unsigned color)
+{
+    dest[0] = position.x_;
+    dest[1] = position.y_;
+    dest[2] = position.z_;
+    ((unsigned&)dest[3]) = color;
+    dest += 4;
+}
+
+void DebugGeometry::AddLine(const Vector3& start, const Vector3& end, unsigned color, bool depthTest)
+{
+    if (lines_.Size() + noDepthLines_.Size() >= MAX_LINES)
+        return;
+
+    if (depthTest)
+        lines_.Push(DebugLine(start, end, color));
+    else
+        noDepthLines_.Push(DebugLine(start, end, color));
+}
+
+void DebugGeometry::AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest)
+{
+    if (triangles_.Size() + noDepthTriangles_.Size() >= MAX_TRIANGLES)
+        return;
+
+    if (depthTest)
+        triangles_.Push(DebugTriangle(v1, v2, v3, color));
+    else
+        noDepthTriangles_.Push(DebugTriangle(v1, v2, v3, color));
+}
+
+void DebugGeometry::AddShape(DebugShape shape, const Matrix3x4& transform, unsigned color, bool depthTest)
+{
+    if (shapes_.Size() + noDepthShapes_.Size() >= MAX_SHAPES)
+        return;
+
+    if (depthTest)
+        shapes_.Push(DebugShapeInstance(shape, transform, color));
+    else
+        noDepthShapes_.Push(DebugShapeInstance(shape, transform, color));
+}
+
+void DebugGeometry::Append(const DebugGeometry& geometry)
+{
+    lines_.Push(geometry.lines_);
+    noDepthLines_.Push(geometry.noDepthLines_);
+    triangles_.Push(geometry.triangles_);
+    noDepthTriangles_.Push(geometry.noDepthTriangles_);
+    shapes_.Push(geometry.shapes_);
+    noDepthShapes_.Push(geometry.noDepthShapes_);
+}
+
+void DebugGeometry::Clear()
+{
+    unsigned linesSize = lines_.Size();
+    unsigned noDepthLinesSize = noDepthLines_.Size();
+    unsigned trianglesSize = triangles_.Size();
+    unsigned noDepthTrianglesSize = noDepthTriangles_.Size();
+    unsigned shapesSize = shapes_.Size();
+    unsigned noDepthShapesSize = noDepthShapes_.Size();
+
+    lines_.Clear();
+    noDepthLines_.Clear();
+    triangles_.Clear();
+    noDepthTriangles_.Clear();
+    shapes_.Clear();
+    noDepthShapes_.Clear();
+
+    if (lines_.Capacity() > linesSize * 2)
+        lines_.Reserve(linesSize);
+    if (noDepthLines_.Capacity() > noDepthLinesSize * 2)
+        noDepthLines_.Reserve(noDepthLinesSize);
+    if (triangles_.Capacity() > trianglesSize * 2)
+        triangles_.Reserve(trianglesSize);
+    if (noDepthTriangles_.Capacity() > noDepthTrianglesSize * 2)
+        noDepthTriangles_.Reserve(noDepthTrianglesSize);
+    if (shapes_.Capacity() > shapesSize * 2)
+        shapes_.Reserve(shapesSize);
+    if (noDepthShapes_.Capacity() > noDepthShapesSize * 2)
+        noDepthShapes_.Reserve(noDepthShapesSize);
+}
+
+bool DebugGeometry::IsEmpty() const
+{
+    return lines_.Empty() && noDepthLines_.Empty() && triangles_.Empty() && noDepthTriangles_.Empty() && shapes_.Empty() &&
+        noDepthShapes_.Empty();
+}
 
 DebugRenderer::DebugRenderer(Context* context) :
     Component(context),
+    currentGeometry_(&frame_.geometry_),
+    frameNumber_(0),
     lineAntiAlias_(false)
 {
-    vertexBuffer_ = new VertexBuffer(context_);
+    frame_.vertexBuffer_ = new VertexBuffer(context_);
+    frame_.instanceBuffer_ = new VertexBuffer(context_);
+
+    CreateShapes();
 
     SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(DebugRenderer, HandleEndFrame));
 }
@@ -91,13 +195,13 @@ void DebugRenderer::AddLine(const Vector3& start, const Vector3& end, const Colo
 
 void DebugRenderer::AddLine(const Vector3& start, const Vector3& end, unsigned color, bool depthTest)
 {
-    if (lines_.Size() + noDepthLines_.Size() >= MAX_LINES)
-        return;
-
-    if (depthTest)
-        lines_.Push(DebugLine(start, end, color));
+    if (Thread::IsMainThread())
+        currentGeometry_->AddLine(start, end, color, depthTest);
     else
-        noDepthLines_.Push(DebugLine(start, end, color));
+    {
+        MutexLock lock(threadedMutex_);
+        threadedGeometry_.AddLine(start, end, color, depthTest);
+    }
 }
 
 void DebugRenderer::AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, const Color& color, bool depthTest)
@@ -107,13 +211,13 @@ void DebugRenderer::AddTriangle(const Vector3& v1, const Vector3& v2, const Vect
 
 void DebugRenderer::AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest)
 {
-    if (triangles_.Size() + noDepthTriangles_.Size() >= MAX_TRIANGLES)
-        return;
-
-    if (depthTest)
-        triangles_.Push(DebugTriangle(v1, v2, v3, color));
+    if (Thread::IsMainThread())
+        currentGeometry_->AddTriangle(v1, v2, v3, color, depthTest);
     else
-        noDepthTriangles_.Push(DebugTriangle(v1, v2, v3, color));
+    {
+        MutexLock lock(threadedMutex_);
+        threadedGeometry_.AddTriangle(v1, v2, v3, color, depthTest);
+    }
 }
 
 void DebugRenderer::AddPolygon(const Vector3& v1, const Vector3& v2, const Vector3& v3, const Vector3& v4, const Color& color, bool depthTest)
@@ -156,20 +260,7 @@ void DebugRenderer::AddBoundingBox(const BoundingBox& box, const Color& color, b
     unsigned uintColor = color.ToUInt();
 
     if (!solid)
-    {
-        AddLine(min, v1, uintColor, depthTest);
-        AddLine(v1, v2, uintColor, depthTest);
-        AddLine(v2, v3, uintColor, depthTest);
-        AddLine(v3, min, uintColor, depthTest);
-        AddLine(v4, v5, uintColor, depthTest);
-        AddLine(v5, max, uintColor, depthTest);
-        AddLine(max, v6, uintColor, depthTest);
-        AddLine(v6, v4, uintColor, depthTest);
-        AddLine(min, v4, uintColor, depthTest);
-        AddLine(v1, v5, uintColor, depthTest);
-        AddLine(v2, max, uintColor, depthTest);
-        AddLine(v3, v6, uintColor, depthTest);
-    }
+        AddShape(DEBUGSHAPE_BOX, Matrix3x4(box.Center(), Quaternion::IDENTITY, box.Size()), uintColor, depthTest);
     else
     {
         AddPolygon(min, v1, v2, v3, uintColor, depthTest);
@@ -183,6 +274,12 @@ void DebugRenderer::AddBoundingBox(const BoundingBox& box, const Color& color, b
 
 void DebugRenderer::AddBoundingBox(const BoundingBox& box, const Matrix3x4& transform, const Color& color, bool depthTest, bool solid)
 {
+    if (!solid)
+    {
+        AddShape(DEBUGSHAPE_BOX, transform * Matrix3x4(box.Center(), Quaternion::IDENTITY, box.Size()), color, depthTest);
+        return;
+    }
+
     const Vector3& min = box.min_;
     const Vector3& max = box.max_;
 
@@ -197,30 +294,12 @@ void DebugRenderer::AddBoundingBox(const BoundingBox& box, const Matrix3x4& tran
 
     unsigned uintColor = color.ToUInt();
 
-    if (!solid)
-    {
-        AddLine(v0, v1, uintColor, depthTest);
-        AddLine(v1, v2, uintColor, depthTest);
-        AddLine(v2, v3, uintColor, depthTest);
-        AddLine(v3, v0, uintColor, depthTest);
-        AddLine(v4, v5, uintColor, depthTest);
-        AddLine(v5, v7, uintColor, depthTest);
-        AddLine(v7, v6, uintColor, depthTest);
-        AddLine(v6, v4, uintColor, depthTest);
-        AddLine(v0, v4, uintColor, depthTest);
-        AddLine(v1, v5, uintColor, depthTest);
-        AddLine(v2, v7, uintColor, depthTest);
-        AddLine(v3, v6, uintColor, depthTest);
-    }
-    else
-    {
-        AddPolygon(v0, v1, v2, v3, uintColor, depthTest);
-        AddPolygon(v4, v5, v7, v6, uintColor, depthTest);
-        AddPolygon(v0, v4, v6, v3, uintColor, depthTest);
-        AddPolygon(v1, v5, v7, v2, uintColor, depthTest);
-        AddPolygon(v3, v2, v7, v6, uintColor, depthTest);
-        AddPolygon(v0, v1, v5, v4, uintColor, depthTest);
-    }
+    AddPolygon(v0, v1, v2, v3, uintColor, depthTest);
+    AddPolygon(v4, v5, v7, v6, uintColor, depthTest);
+    AddPolygon(v0, v4, v6, v3, uintColor, depthTest);
+    AddPolygon(v1, v5, v7, v2, uintColor, depthTest);
+    AddPolygon(v3, v2, v7, v6, uintColor, depthTest);
+    AddPolygon(v0, v1, v5, v4, uintColor, depthTest);
 }
 
 void DebugRenderer::AddFrustum(const Frustum& frustum, const Color& color, bool depthTest)
@@ -259,23 +338,7 @@ void DebugRenderer::AddPolyhedron(const Polyhedron& poly, const Color& color, bo
 
 void DebugRenderer::AddSphere(const Sphere& sphere, const Color& color, bool depthTest)
 {
-    unsigned uintColor = color.ToUInt();
-
-    for (auto j = 0; j < 180; j += 45)
-    {
-        for (auto i = 0; i < 360; i += 45)
-        {
-            Vector3 p1 = sphere.GetPoint(i, j);
-            Vector3 p2 = sphere.GetPoint(i + 45, j);
-            Vector3 p3 = sphere.GetPoint(i, j + 45);
-            Vector3 p4 = sphere.GetPoint(i + 45, j + 45);
-
-            AddLine(p1, p2, uintColor, depthTest);
-            AddLine(p3, p4, uintColor, depthTest);
-            AddLine(p1, p3, uintColor, depthTest);
-            AddLine(p2, p4, uintColor, depthTest);
-        }
-    }
+    AddShape(DEBUGSHAPE_SPHERE, Matrix3x4(sphere.center_, Quaternion::IDENTITY, sphere.radius_), color, depthTest);
 }
 
 void DebugRenderer::AddSphereSector(const Sphere& sphere, const Quaternion& rotation, float angle,
@@ -334,21 +397,40 @@ void DebugRenderer::AddSphereSector(const Sphere& sphere, const Quaternion& rota
 
 void DebugRenderer::AddCylinder(const Vector3& position, float radius, float height, const Color& color, bool depthTest)
 {
-    Sphere sphere(position, radius);
-    Vector3 heightVec(0, height, 0);
-    Vector3 offsetXVec(radius, 0, 0);
-    Vector3 offsetZVec(0, 0, radius);
-    for (auto i = 0; i < 360; i += 45)
+    AddShape(DEBUGSHAPE_CYLINDER, Matrix3x4(position, Quaternion::IDENTITY, Vector3(radius, height, radius)), color, depthTest);
+}
+
+void DebugRenderer::AddCapsule(const Vector3& start, const Vector3& end, float radius, const Color& color, bool depthTest)
+{
+    Vector3 axis = end - start;
+    float length = axis.Length();
+    Quaternion rotation;
+    if (length > M_EPSILON)
+        rotation.FromRotationTo(Vector3::UP, axis / length);
+
+    unsigned uintColor = color.ToUInt();
+    AddShape(DEBUGSHAPE_CYLINDER, Matrix3x4(start, rotation, Vector3(radius, length, radius)), uintColor, depthTest);
+    AddShape(DEBUGSHAPE_HEMISPHERE, Matrix3x4(end, rotation, radius), uintColor, depthTest);
+    AddShape(DEBUGSHAPE_HEMISPHERE, Matrix3x4(start, rotation * Quaternion(180.0f, Vector3::RIGHT), radius), uintColor, depthTest);
+}
+
+void DebugRenderer::AddShape(DebugShape shape, const Matrix3x4& transform, const Color& color, bool depthTest)
+{
+    AddShape(shape, transform, color.ToUInt(), depthTest);
+}
+
+void DebugRenderer::AddShape(DebugShape shape, const Matrix3x4& transform, unsigned color, bool depthTest)
+{
+    if (shape >= MAX_DEBUGSHAPES)
+        return;
+
+    if (Thread::IsMainThread())
+        currentGeometry_->AddShape(shape, transform, color, depthTest);
+    else
     {
-        Vector3 p1 = sphere.GetPoint(i, 90);
-        Vector3 p2 = sphere.GetPoint(i + 45, 90);
-        AddLine(p1, p2, color, depthTest);
-        AddLine(p1 + heightVec, p2 + heightVec, color, depthTest);
+        MutexLock lock(threadedMutex_);
+        threadedGeometry_.AddShape(shape, transform, color, depthTest);
     }
-    AddLine(position + offsetXVec, position + heightVec + offsetXVec, color, depthTest);
-    AddLine(position - offsetXVec, position + heightVec - offsetXVec, color, depthTest);
-    AddLine(position + offsetZVec, position + heightVec + offsetZVec, color, depthTest);
-    AddLine(position - offsetZVec, position + heightVec - offsetZVec, color, depthTest);
 }
 
 void DebugRenderer::AddSkeleton(const Skeleton& skeleton, const Color& color, bool depthTest)
@@ -485,8 +567,56 @@ void DebugRenderer::AddQuad(const Vector3& center, float width, float height, co
     AddLine(v3, v0, uintColor, depthTest);
 }
 
+void DebugRenderer::BeginLayer(StringHash name, unsigned version, const Matrix3x4& transform)
+{
+    DebugLayer& layer = layers_[name];
+    layer.geometry_.Clear();
+    layer.transform_ = transform;
+    layer.version_ = version;
+    layer.frameNumber_ = frameNumber_;
+    layer.dirty_ = true;
+    currentGeometry_ = &layer.geometry_;
+}
+
+void DebugRenderer::EndLayer()
+{
+    currentGeometry_ = &frame_.geometry_;
+}
+
+bool DebugRenderer::DrawLayer(StringHash name, unsigned version, const Matrix3x4& transform)
+{
+    HashMap<StringHash, DebugLayer>::Iterator i = layers_.Find(name);
+    if (i == layers_.End() || i->second_.version_ != version)
+        return false;
+
+    i->second_.transform_ = transform;
+    i->second_.frameNumber_ = frameNumber_;
+    return true;
+}
+
+void DebugRenderer::RemoveLayer(StringHash name)
+{
+    HashMap<StringHash, DebugLayer>::Iterator i = layers_.Find(name);
+    if (i == layers_.End())
+        return;
+
+    if (currentGeometry_ == &i->second_.geometry_)
+        currentGeometry_ = &frame_.geometry_;
+    layers_.Erase(i);
+}
+
 void DebugRenderer::Render()
 {
+    // Merge the geometry added from worker threads
+    {
+        MutexLock lock(threadedMutex_);
+        if (!threadedGeometry_.IsEmpty())
+        {
+            frame_.geometry_.Append(threadedGeometry_);
+            threadedGeometry_.Clear();
+        }
+    }
+
     if (!HasContent())
         return;
 
@@ -496,179 +626,399 @@ void DebugRenderer::Render()
 
     URHO3D_PROFILE(RenderDebugGeometry);
 
-    ShaderVariation* vs = graphics->GetShader(VS, "Basic", "VERTEXCOLOR");
-    ShaderVariation* ps = graphics->GetShader(PS, "Basic", "VERTEXCOLOR");
+    graphics->SetColorWrite(true);
+    graphics->SetCullMode(CULL_NONE);
+    graphics->SetLineAntiAlias(lineAntiAlias_);
+    graphics->SetScissorTest(false);
+    graphics->SetStencilTest(false);
 
-    unsigned numVertices = (lines_.Size() + noDepthLines_.Size()) * 2 + (triangles_.Size() + noDepthTriangles_.Size()) * 3;
-    // Resize the vertex buffer if too small or much too large
-    if (vertexBuffer_->GetVertexCount() < numVertices || vertexBuffer_->GetVertexCount() > numVertices * 2)
-        vertexBuffer_->SetSize(numVertices, MASK_POSITION | MASK_COLOR, true);
+    // The frame geometry may be added to between views, so it is uploaded every time
+    frame_.dirty_ = true;
+    frame_.frameNumber_ = frameNumber_;
+    RenderLayer(frame_);
 
-    auto* dest = (float*)vertexBuffer_->Lock(0, numVertices, true);
-    if (!dest)
-        return;
+    for (HashMap<StringHash, DebugLayer>::Iterator i = layers_.Begin(); i != layers_.End(); ++i)
+    {
+        // Do not draw a layer while it is still being recorded
+        if (i->second_.frameNumber_ == frameNumber_ && currentGeometry_ != &i->second_.geometry_)
+            RenderLayer(i->second_);
+    }
+
+    graphics->SetLineAntiAlias(false);
+}
+
+bool DebugRenderer::IsInside(const BoundingBox& box) const
+{
+    return frustum_.IsInsideFast(box) == INSIDE;
+}
+
+bool DebugRenderer::HasContent() const
+{
+    if (!frame_.geometry_.IsEmpty())
+        return true;
 
-    for (unsigned i = 0; i < lines_.Size(); ++i)
+    for (HashMap<StringHash, DebugLayer>::ConstIterator i = layers_.Begin(); i != layers_.End(); ++i)
     {
-        const DebugLine& line = lines_[i];
+        const DebugLayer& layer = i->second_;
+        if (layer.frameNumber_ == frameNumber_ && (layer.dirty_ ? !layer.geometry_.IsEmpty() : layer.vertexCounts_[0] ||
+            layer.vertexCounts_[1] || layer.vertexCounts_[2] || layer.vertexCounts_[3]))
+            return true;
+    }
+
+    return false;
+}
 
-        dest[0] = line.start_.x_;
-        dest[1] = line.start_.y_;
-        dest[2] = line.start_.z_;
-        ((unsigned&)dest[3]) = line.color_;
-        dest[4] = line.end_.x_;
-        dest[5] = line.end_.y_;
-        dest[6] = line.end_.z_;
-        ((unsigned&)dest[7]) = line.color_;
+void DebugRenderer::CreateShapes()
+{
+    // The shapes are line lists, matching the wireframes that were previously generated per call
+    Sphere unitSphere(Vector3::ZERO, 1.0f);
+
+    shapeStarts_[DEBUGSHAPE_BOX] = shapeVertices_.Size();
+    const Vector3 corners[] = {
+        Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, -0.5f), Vector3(-0.5f, 0.5f, -0.5f),
+        Vector3(-0.5f, -0.5f, 0.5f), Vector3(0.5f, -0.5f, 0.5f), Vector3(0.5f, 0.5f, 0.5f), Vector3(-0.5f, 0.5f, 0.5f)
+    };
+    const unsigned edges[] = {0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6, 6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7};
+    for (unsigned edge : edges)
+        shapeVertices_.Push(corners[edge]);
+
+    shapeStarts_[DEBUGSHAPE_SPHERE] = shapeVertices_.Size();
+    for (auto j = 0; j < 180; j += 45)
+    {
+        for (auto i = 0; i < 360; i += 45)
+        {
+            Vector3 p1 = unitSphere.GetLocalPoint(i, j);
+            Vector3 p2 = unitSphere.GetLocalPoint(i + 45, j);
+            Vector3 p3 = unitSphere.GetLocalPoint(i, j + 45);
+            Vector3 p4 = unitSphere.GetLocalPoint(i + 45, j + 45);
+
+            shapeVertices_.Push(p1);
+            shapeVertices_.Push(p2);
+            shapeVertices_.Push(p3);
+            shapeVertices_.Push(p4);
+            shapeVertices_.Push(p1);
+            shapeVertices_.Push(p3);
+            shapeVertices_.Push(p2);
+            shapeVertices_.Push(p4);
+        }
+    }
 
-        dest += 8;
+    shapeStarts_[DEBUGSHAPE_CYLINDER] = shapeVertices_.Size();
+    for (auto i = 0; i < 360; i += 45)
+    {
+        Vector3 p1 = unitSphere.GetLocalPoint(i, 90);
+        Vector3 p2 = unitSphere.GetLocalPoint(i + 45, 90);
+        shapeVertices_.Push(p1);
+        shapeVertices_.Push(p2);
+        shapeVertices_.Push(p1 + Vector3::UP);
+        shapeVertices_.Push(p2 + Vector3::UP);
+    }
+    const Vector3 sides[] = {Vector3::RIGHT, Vector3::LEFT, Vector3::FORWARD, Vector3::BACK};
+    for (const Vector3& side : sides)
+    {
+        shapeVertices_.Push(side);
+        shapeVertices_.Push(side + Vector3::UP);
     }
 
-    for (unsigned i = 0; i < noDepthLines_.Size(); ++i)
+    shapeStarts_[DEBUGSHAPE_HEMISPHERE] = shapeVertices_.Size();
+    for (auto j = 0; j < 90; j += 45)
     {
-        const DebugLine& line = noDepthLines_[i];
+        for (auto i = 0; i < 360; i += 45)
+        {
+            Vector3 p1 = unitSphere.GetLocalPoint(i, j);
+            Vector3 p3 = unitSphere.GetLocalPoint(i, j + 45);
+            Vector3 p4 = unitSphere.GetLocalPoint(i + 45, j + 45);
+
+            shapeVertices_.Push(p3);
+            shapeVertices_.Push(p4);
+            shapeVertices_.Push(p1);
+            shapeVertices_.Push(p3);
+        }
+    }
 
-        dest[0] = line.start_.x_;
-        dest[1] = line.start_.y_;
-        dest[2] = line.start_.z_;
-        ((unsigned&)dest[3]) = line.color_;
-        dest[4] = line.end_.x_;
-        dest[5] = line.end_.y_;
-        dest[6] = line.end_.z_;
-        ((unsigned&)dest[7]) = line.color_;
+    shapeStarts_[MAX_DEBUGSHAPES] = shapeVertices_.Size();
 
-        dest += 8;
+    // The instanced shapes are drawn white and colored by the material diffuse color
+    unsigned numVertices = shapeVertices_.Size();
+    PODVector<float> vertexData(numVertices * 4);
+    PODVector<unsigned short> indexData(numVertices);
+    float* dest = &vertexData[0];
+    for (unsigned i = 0; i < numVertices; ++i)
+    {
+        WriteLineVertex(dest, shapeVertices_[i], Color::WHITE.ToUInt());
+        indexData[i] = (unsigned short)i;
     }
 
-    for (unsigned i = 0; i < triangles_.Size(); ++i)
+    shapeVertexBuffer_ = new VertexBuffer(context_);
+    shapeVertexBuffer_->SetShadowed(true);
+    shapeVertexBuffer_->SetSize(numVertices, MASK_POSITION | MASK_COLOR);
+    shapeVertexBuffer_->SetData(&vertexData[0]);
+
+    shapeIndexBuffer_ = new IndexBuffer(context_);
+    shapeIndexBuffer_->SetShadowed(true);
+    shapeIndexBuffer_->SetSize(numVertices, false);
+    shapeIndexBuffer_->SetData(&indexData[0]);
+}
+
+void DebugRenderer::UpdateLayer(DebugLayer& layer, bool dynamic)
+{
+    auto* graphics = GetSubsystem<Graphics>();
+    DebugGeometry& geometry = layer.geometry_;
+    // The persistent layers are uploaded once, so their shapes are baked to lines and drawn with the layer transform
+    bool instancing = dynamic && graphics->GetInstancingSupport();
+
+    // Without instancing the shapes are transformed to lines here
+    unsigned shapeVertices = 0;
+    unsigned noDepthShapeVertices = 0;
+    if (!instancing)
     {
-        const DebugTriangle& triangle = triangles_[i];
+        for (unsigned i = 0; i < geometry.shapes_.Size(); ++i)
+            shapeVertices += shapeStarts_[geometry.shapes_[i].shape_ + 1] - shapeStarts_[geometry.shapes_[i].shape_];
+        for (unsigned i = 0; i < geometry.noDepthShapes_.Size(); ++i)
+        {
+            noDepthShapeVertices += shapeStarts_[geometry.noDepthShapes_[i].shape_ + 1] -
+                shapeStarts_[geometry.noDepthShapes_[i].shape_];
+        }
+    }
 
-        dest[0] = triangle.v1_.x_;
-        dest[1] = triangle.v1_.y_;
-        dest[2] = triangle.v1_.z_;
-        ((unsigned&)dest[3]) = triangle.color_;
+    layer.vertexCounts_[0] = geometry.lines_.Size() * 2 + shapeVertices;
+    layer.vertexCounts_[1] = geometry.noDepthLines_.Size() * 2 + noDepthShapeVertices;
+    layer.vertexCounts_[2] = geometry.triangles_.Size() * 3;
+    layer.vertexCounts_[3] = geometry.noDepthTriangles_.Size() * 3;
+    unsigned numVertices = layer.vertexCounts_[0] + layer.vertexCounts_[1] + layer.vertexCounts_[2] + layer.vertexCounts_[3];
 
-        dest[4] = triangle.v2_.x_;
-        dest[5] = triangle.v2_.y_;
-        dest[6] = triangle.v2_.z_;
-        ((unsigned&)dest[7]) = triangle.color_;
+    if (!layer.vertexBuffer_)
+        layer.vertexBuffer_ = new VertexBuffer(context_);
 
-        dest[8] = triangle.v3_.x_;
-        dest[9] = triangle.v3_.y_;
-        dest[10] = triangle.v3_.z_;
-        ((unsigned&)dest[11]) = triangle.color_;
+    if (numVertices)
+    {
+        // Resize the vertex buffer if too small or much too large
+        VertexBuffer* buffer = layer.vertexBuffer_;
+        if (buffer->GetVertexCount() < numVertices || buffer->GetVertexCount() > numVertices * 2 || buffer->IsDynamic() != dynamic)
+            buffer->SetSize(numVertices, MASK_POSITION | MASK_COLOR, dynamic);
+
+        auto* dest = (float*)buffer->Lock(0, numVertices, true);
+        if (!dest)
+            return;
+
+        for (unsigned i = 0; i < geometry.lines_.Size(); ++i)
+        {
+            WriteLineVertex(dest, geometry.lines_[i].start_, geometry.lines_[i].color_);
+            WriteLineVertex(dest, geometry.lines_[i].end_, geometry.lines_[i].color_);
+        }
+        for (unsigned i = 0; i < geometry.shapes_.Size() && !instancing; ++i)
+        {
+            const DebugShapeInstance& shape = geometry.shapes_[i];
+            for (unsigned j = shapeStarts_[shape.shape_]; j < shapeStarts_[shape.shape_ + 1]; ++j)
+                WriteLineVertex(dest, shape.transform_ * shapeVertices_[j], shape.color_);
+        }
+        for (unsigned i = 0; i < geometry.noDepthLines_.Size(); ++i)
+        {
+            WriteLineVertex(dest, geometry.noDepthLines_[i].start_, geometry.noDepthLines_[i].color_);
+            WriteLineVertex(dest, geometry.noDepthLines_[i].end_, geometry.noDepthLines_[i].color_);
+        }
+        for (unsigned i = 0; i < geometry.noDepthShapes_.Size() && !instancing; ++i)
+        {
+            const DebugShapeInstance& shape = geometry.noDepthShapes_[i];
+            for (unsigned j = shapeStarts_[shape.shape_]; j < shapeStarts_[shape.shape_ + 1]; ++j)
+                WriteLineVertex(dest, shape.transform_ * shapeVertices_[j], shape.color_);
+        }
+        for (unsigned i = 0; i < geometry.triangles_.Size(); ++i)
+        {
+            const DebugTriangle& triangle = geometry.triangles_[i];
+            WriteLineVertex(dest, triangle.v1_, triangle.color_);
+            WriteLineVertex(dest, triangle.v2_, triangle.color_);
+            WriteLineVertex(dest, triangle.v3_, triangle.color_);
+        }
+        for (unsigned i = 0; i < geometry.noDepthTriangles_.Size(); ++i)
+        {
+            const DebugTriangle& triangle = geometry.noDepthTriangles_[i];
+            WriteLineVertex(dest, triangle.v1_, triangle.color_);
+            WriteLineVertex(dest, triangle.v2_, triangle.color_);
+            WriteLineVertex(dest, triangle.v3_, triangle.color_);
+        }
 
-        dest += 12;
+        buffer->Unlock();
     }
 
-    for (unsigned i = 0; i < noDepthTriangles_.Size(); ++i)
+    unsigned numInstances = geometry.shapes_.Size() + geometry.noDepthShapes_.Size();
+    if (instancing && numInstances)
     {
-        const DebugTriangle& triangle = noDepthTriangles_[i];
+        // Sort the instances so that each shape and color is drawn with one call
+        Sort(geometry.shapes_.Begin(), geometry.shapes_.End(), CompareShapeInstances);
+        Sort(geometry.noDepthShapes_.Begin(), geometry.noDepthShapes_.End(), CompareShapeInstances);
+
+        if (!layer.instanceBuffer_)
+            layer.instanceBuffer_ = new VertexBuffer(context_);
+
+        VertexBuffer* buffer = layer.instanceBuffer_;
+        if (buffer->GetVertexCount() < numInstances || buffer->GetVertexCount() > numInstances * 2 || buffer->IsDynamic() != dynamic)
+        {
+            PODVector<VertexElement> elements;
+            for (unsigned i = 0; i < 3; ++i)
+                elements.Push(VertexElement(TYPE_VECTOR4, SEM_TEXCOORD, (unsigned char)(4 + i), true));
+            buffer->SetSize(numInstances, elements, dynamic);
+        }
+
+        auto* dest = (Matrix3x4*)buffer->Lock(0, numInstances, true);
+        if (!dest)
+            return;
 
-        dest[0] = triangle.v1_.x_;
-        dest[1] = triangle.v1_.y_;
-        dest[2] = triangle.v1_.z_;
-        ((unsigned&)dest[3]) = triangle.color_;
+        for (unsigned i = 0; i < geometry.shapes_.Size(); ++i)
+            *dest++ = geometry.shapes_[i].transform_;
+        for (unsigned i = 0; i < geometry.noDepthShapes_.Size(); ++i)
+            *dest++ = geometry.noDepthShapes_[i].transform_;
 
-        dest[4] = triangle.v2_.x_;
-        dest[5] = triangle.v2_.y_;
-        dest[6] = triangle.v2_.z_;
-        ((unsigned&)dest[7]) = triangle.color_;
+        buffer->Unlock();
+    }
+
+    // The persistent layers keep only what is needed for drawing
+    if (!dynamic)
+    {
+        geometry.lines_.Clear();
+        geometry.noDepthLines_.Clear();
+        geometry.triangles_.Clear();
+        geometry.noDepthTriangles_.Clear();
+        geometry.shapes_.Clear();
+        geometry.noDepthShapes_.Clear();
+    }
 
-        dest[8] = triangle.v3_.x_;
-        dest[9] = triangle.v3_.y_;
-        dest[10] = triangle.v3_.z_;
-        ((unsigned&)dest[11]) = triangle.color_;
+    layer.dirty_ = false;
+}
 
-        dest += 12;
+void DebugRenderer::RenderLayer(DebugLayer& layer)
+{
+    if (layer.dirty_)
+    {
+        bool dynamic = &layer == &frame_;
+        if (layer.geometry_.IsEmpty())
+        {
+            if (dynamic)
+                return;
+            // A recorded layer may be empty, which is still valid
+            layer.vertexCounts_[0] = layer.vertexCounts_[1] = layer.vertexCounts_[2] = layer.vertexCounts_[3] = 0;
+            layer.dirty_ = false;
+        }
+        else
+            UpdateLayer(layer, dynamic);
     }
 
-    vertexBuffer_->Unlock();
+    auto* graphics = GetSubsystem<Graphics>();
+    const PODVector<DebugShapeInstance>& shapes = layer.geometry_.shapes_;
+    const PODVector<DebugShapeInstance>& noDepthShapes = layer.geometry_.noDepthShapes_;
+    bool hasInstances = graphics->GetInstancingSupport() && layer.instanceBuffer_ && (shapes.Size() || noDepthShapes.Size());
+    if (!layer.vertexCounts_[0] && !layer.vertexCounts_[1] && !layer.vertexCounts_[2] && !layer.vertexCounts_[3] && !hasInstances)
+        return;
+
+    ShaderVariation* vs = graphics->GetShader(VS, "Basic", "VERTEXCOLOR");
+    ShaderVariation* ps = graphics->GetShader(PS, "Basic", "VERTEXCOLOR");
 
     graphics->SetBlendMode(lineAntiAlias_ ? BLEND_ALPHA : BLEND_REPLACE);
-    graphics->SetColorWrite(true);
-    graphics->SetCullMode(CULL_NONE);
     graphics->SetDepthWrite(true);
-    graphics->SetLineAntiAlias(lineAntiAlias_);
-    graphics->SetScissorTest(false);
-    graphics->SetStencilTest(false);
     graphics->SetShaders(vs, ps);
-    graphics->SetShaderParameter(VSP_MODEL, Matrix3x4::IDENTITY);
+    graphics->SetShaderParameter(VSP_MODEL, layer.transform_);
     graphics->SetShaderParameter(VSP_VIEW, view_);
     graphics->SetShaderParameter(VSP_VIEWINV, view_.Inverse());
     graphics->SetShaderParameter(VSP_VIEWPROJ, gpuProjection_ * view_);
     graphics->SetShaderParameter(PSP_MATDIFFCOLOR, Color(1.0f, 1.0f, 1.0f, 1.0f));
-    graphics->SetVertexBuffer(vertexBuffer_);
+    graphics->SetVertexBuffer(layer.vertexBuffer_);
 
     unsigned start = 0;
-    unsigned count = 0;
-    if (lines_.Size())
+    unsigned count = layer.vertexCounts_[0];
+    if (count)
     {
-        count = lines_.Size() * 2;
         graphics->SetDepthTest(CMP_LESSEQUAL);
         graphics->Draw(LINE_LIST, start, count);
         start += count;
     }
-    if (noDepthLines_.Size())
+    count = layer.vertexCounts_[1];
+    if (count)
     {
-        count = noDepthLines_.Size() * 2;
         graphics->SetDepthTest(CMP_ALWAYS);
         graphics->Draw(LINE_LIST, start, count);
         start += count;
     }
 
+    if (hasInstances)
+    {
+        graphics->SetShaders(graphics->GetShader(VS, "Basic", "VERTEXCOLOR INSTANCED"), ps);
+        graphics->SetShaderParameter(VSP_VIEW, view_);
+        graphics->SetShaderParameter(VSP_VIEWINV, view_.Inverse());
+        graphics->SetShaderParameter(VSP_VIEWPROJ, gpuProjection_ * view_);
+        graphics->SetIndexBuffer(shapeIndexBuffer_);
+
+        graphics->SetDepthTest(CMP_LESSEQUAL);
+        DrawShapes(shapes, layer.instanceBuffer_, 0);
+        graphics->SetDepthTest(CMP_ALWAYS);
+        DrawShapes(noDepthShapes, layer.instanceBuffer_, shapes.Size());
+
+        graphics->SetShaders(vs, ps);
+        graphics->SetShaderParameter(VSP_MODEL, layer.transform_);
+        graphics->SetShaderParameter(VSP_VIEW, view_);
+        graphics->SetShaderParameter(VSP_VIEWINV, view_.Inverse());
+        graphics->SetShaderParameter(VSP_VIEWPROJ, gpuProjection_ * view_);
+        graphics->SetVertexBuffer(layer.vertexBuffer_);
+    }
+
     graphics->SetBlendMode(BLEND_ALPHA);
     graphics->SetDepthWrite(false);
+    graphics->SetShaderParameter(PSP_MATDIFFCOLOR, Color(1.0f, 1.0f, 1.0f, 1.0f));
 
-    if (triangles_.Size())
+    count = layer.vertexCounts_[2];
+    if (count)
     {
-        count = triangles_.Size() * 3;
         graphics->SetDepthTest(CMP_LESSEQUAL);
         graphics->Draw(TRIANGLE_LIST, start, count);
         start += count;
     }
-    if (noDepthTriangles_.Size())
+    count = layer.vertexCounts_[3];
+    if (count)
     {
-        count = noDepthTriangles_.Size() * 3;
         graphics->SetDepthTest(CMP_ALWAYS);
         graphics->Draw(TRIANGLE_LIST, start, count);
     }
-
-    graphics->SetLineAntiAlias(false);
 }
 
-bool DebugRenderer::IsInside(const BoundingBox& box) const
+void DebugRenderer::DrawShapes(const PODVector<DebugShapeInstance>& shapes, VertexBuffer* instanceBuffer, unsigned instanceStart)
 {
-    return frustum_.IsInsideFast(box) == INSIDE;
-}
+    auto* graphics = GetSubsystem<Graphics>();
+    PODVector<VertexBuffer*> buffers;
+    buffers.Push(shapeVertexBuffer_);
+    buffers.Push(instanceBuffer);
 
-bool DebugRenderer::HasContent() const
-{
-    return !(lines_.Empty() && noDepthLines_.Empty() && triangles_.Empty() && noDepthTriangles_.Empty());
+    unsigned i = 0;
+    while (i < shapes.Size())
+    {
+        unsigned first = i;
+        DebugShape shape = shapes[i].shape_;
+        unsigned color = shapes[i].color_;
+        while (i < shapes.Size() && shapes[i].shape_ == shape && shapes[i].color_ == color)
+            ++i;
+
+        Color diffColor;
+        diffColor.FromUInt(color);
+        graphics->SetShaderParameter(PSP_MATDIFFCOLOR, diffColor);
+        graphics->SetVertexBuffers(buffers, instanceStart + first);
+        graphics->DrawInstanced(LINE_LIST, shapeStarts_[shape], shapeStarts_[shape + 1] - shapeStarts_[shape], 0,
+            shapeStarts_[MAX_DEBUGSHAPES], i - first);
+    }
 }
 
 void DebugRenderer::HandleEndFrame(StringHash eventType, VariantMap& eventData)
 {
-    // When the amount of debug geometry is reduced, release memory
-    unsigned linesSize = lines_.Size();
-    unsigned noDepthLinesSize = noDepthLines_.Size();
-    unsigned trianglesSize = triangles_.Size();
-    unsigned noDepthTrianglesSize = noDepthTriangles_.Size();
+    frame_.geometry_.Clear();
+    currentGeometry_ = &frame_.geometry_;
 
-    lines_.Clear();
-    noDepthLines_.Clear();
-    triangles_.Clear();
-    noDepthTriangles_.Clear();
+    // Remove the layers that have not been drawn for a while
+    for (HashMap<StringHash, DebugLayer>::Iterator i = layers_.Begin(); i != layers_.End();)
+    {
+        if (frameNumber_ - i->second_.frameNumber_ >= LAYER_EXPIRE_FRAMES)
+            i = layers_.Erase(i);
+        else
+            ++i;
+    }
 
-    if (lines_.Capacity() > linesSize * 2)
-        lines_.Reserve(linesSize);
-    if (noDepthLines_.Capacity() > noDepthLinesSize * 2)
-        noDepthLines_.Reserve(noDepthLinesSize);
-    if (triangles_.Capacity() > trianglesSize * 2)
-        triangles_.Reserve(trianglesSize);
-    if (noDepthTriangles_.Capacity() > noDepthTrianglesSize * 2)
-        noDepthTriangles_.Reserve(noDepthTrianglesSize);
+    ++frameNumber_;
 }
 
 }
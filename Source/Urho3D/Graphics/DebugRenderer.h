@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/Mutex.h"
 #include "../Math/Color.h"
 #include "../Math/Frustum.h"
 #include "../Scene/Component.h"
@@ -31,6 +32,7 @@ namespace Urho3D
 
 class BoundingBox;
 class Camera;
+class IndexBuffer;
 class Polyhedron;
 class Drawable;
 class Light;
@@ -87,7 +89,94 @@ struct DebugTriangle
     unsigned color_{};
 };
 
-/// Debug geometry rendering component. Should be added only to the root scene node.
+/// Unit shape drawn with instancing.
+enum DebugShape
+{
+    /// Box from -0.5 to 0.5 on each axis.
+    DEBUGSHAPE_BOX = 0,
+    /// Sphere with radius 1.
+    DEBUGSHAPE_SPHERE,
+    /// Cylinder with radius 1 from Y 0 to 1.
+    DEBUGSHAPE_CYLINDER,
+    /// Upper half of a sphere with radius 1.
+    DEBUGSHAPE_HEMISPHERE,
+    MAX_DEBUGSHAPES
+};
+
+/// Debug render shape instance.
+struct DebugShapeInstance
+{
+    /// Construct undefined.
+    DebugShapeInstance() = default;
+
+    /// Construct with shape, transform and color.
+    DebugShapeInstance(DebugShape shape, const Matrix3x4& transform, unsigned color) :
+        transform_(transform),
+        shape_(shape),
+        color_(color)
+    {
+    }
+
+    /// Transform of the unit shape.
+    Matrix3x4 transform_;
+    /// Shape.
+    DebugShape shape_{};
+    /// Color.
+    unsigned color_{};
+};
+
+/// Debug geometry of a frame or a persistent layer.
+struct DebugGeometry
+{
+    /// Add a line.
+    void AddLine(const Vector3& start, const Vector3& end, unsigned color, bool depthTest);
+    /// Add a triangle.
+    void AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest);
+    /// Add a shape instance.
+    void AddShape(DebugShape shape, const Matrix3x4& transform, unsigned color, bool depthTest);
+    /// Append geometry from another.
+    void Append(const DebugGeometry& geometry);
+    /// Clear geometry. When the amount of geometry is reduced, release memory.
+    void Clear();
+    /// Return whether has no geometry.
+    bool IsEmpty() const;
+
+    /// Lines rendered with depth test.
+    PODVector<DebugLine> lines_;
+    /// Lines rendered without depth test.
+    PODVector<DebugLine> noDepthLines_;
+    /// Triangles rendered with depth test.
+    PODVector<DebugTriangle> triangles_;
+    /// Triangles rendered without depth test.
+    PODVector<DebugTriangle> noDepthTriangles_;
+    /// Shape instances rendered with depth test.
+    PODVector<DebugShapeInstance> shapes_;
+    /// Shape instances rendered without depth test.
+    PODVector<DebugShapeInstance> noDepthShapes_;
+};
+
+/// Debug geometry with its vertex buffers, either for the current frame or kept in a persistent layer.
+struct DebugLayer
+{
+    /// Geometry.
+    DebugGeometry geometry_;
+    /// Vertex buffer for lines and triangles.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Instancing vertex buffer for the shapes.
+    SharedPtr<VertexBuffer> instanceBuffer_;
+    /// Transform to draw with.
+    Matrix3x4 transform_;
+    /// Vertex counts of lines with and without depth test and triangles with and without depth test, as uploaded.
+    unsigned vertexCounts_[4]{};
+    /// Version number given when recorded.
+    unsigned version_{};
+    /// Frame number when last drawn.
+    unsigned frameNumber_{};
+    /// Whether the buffers need to be updated from the geometry.
+    bool dirty_{true};
+};
+
+/// Debug geometry rendering component. Should be added only to the root scene node. The geometry can also be added from worker threads, in which case it is drawn in the current frame.
 class URHO3D_API DebugRenderer : public Component
 {
     URHO3D_OBJECT(DebugRenderer, Component);
@@ -133,6 +222,12 @@ public:
         bool drawLines, const Color& color, bool depthTest = true);
     /// Add a cylinder
     void AddCylinder(const Vector3& position, float radius, float height, const Color& color, bool depthTest = true);
+    /// Add a capsule between the centers of its end caps.
+    void AddCapsule(const Vector3& start, const Vector3& end, float radius, const Color& color, bool depthTest = true);
+    /// Add a unit shape with transform. Drawn with instancing when supported.
+    void AddShape(DebugShape shape, const Matrix3x4& transform, const Color& color, bool depthTest = true);
+    /// Add a unit shape with transform and color already converted to unsigned.
+    void AddShape(DebugShape shape, const Matrix3x4& transform, unsigned color, bool depthTest = true);
     /// Add a skeleton.
     void AddSkeleton(const Skeleton& skeleton, const Color& color, bool depthTest = true);
     /// Add a triangle mesh.
@@ -148,6 +243,15 @@ public:
     /// Add a quad on the XZ plane.
     void AddQuad(const Vector3& center, float width, float height, const Color& color, bool depthTest = true);
 
+    /// Begin recording the geometry added from the main thread into a persistent layer, replacing its contents, until EndLayer(). The version number tells when the layer needs to be recorded again. The layer is drawn this frame.
+    void BeginLayer(StringHash name, unsigned version, const Matrix3x4& transform = Matrix3x4::IDENTITY);
+    /// End recording a persistent layer.
+    void EndLayer();
+    /// Draw a persistent layer this frame without submitting its geometry again. Return false if the layer does not exist or was recorded with another version, in which case it should be recorded again.
+    bool DrawLayer(StringHash name, unsigned version, const Matrix3x4& transform = Matrix3x4::IDENTITY);
+    /// Remove a persistent layer. Layers not drawn for a while are also removed automatically.
+    void RemoveLayer(StringHash name);
+
     /// Update vertex buffer and render all debug lines. The viewport and rendertarget should be set before.
     void Render();
 
@@ -168,18 +272,41 @@ public:
     /// Return whether has something to render.
     bool HasContent() const;
 
+    /// Return number of persistent layers.
+    unsigned GetNumLayers() const { return layers_.Size(); }
+
 private:
+    /// Create the unit shape geometry.
+    void CreateShapes();
+    /// Update the vertex buffers of a layer from its geometry.
+    void UpdateLayer(DebugLayer& layer, bool dynamic);
+    /// Render a layer.
+    void RenderLayer(DebugLayer& layer);
+    /// Draw runs of shape instances with the same shape and color.
+    void DrawShapes(const PODVector<DebugShapeInstance>& shapes, VertexBuffer* instanceBuffer, unsigned instanceStart);
     /// Handle end of frame. Clear debug geometry.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
-    /// Lines rendered with depth test.
-    PODVector<DebugLine> lines_;
-    /// Lines rendered without depth test.
-    PODVector<DebugLine> noDepthLines_;
-    /// Triangles rendered with depth test.
-    PODVector<DebugTriangle> triangles_;
-    /// Triangles rendered without depth test.
-    PODVector<DebugTriangle> noDepthTriangles_;
+    /// Geometry of the current frame.
+    DebugLayer frame_;
+    /// Geometry added from worker threads and not yet merged to the current frame.
+    DebugGeometry threadedGeometry_;
+    /// Mutex for the geometry added from worker threads.
+    Mutex threadedMutex_;
+    /// Persistent layers.
+    HashMap<StringHash, DebugLayer> layers_;
+    /// Geometry the main thread adds to, either of the current frame or of the layer being recorded.
+    DebugGeometry* currentGeometry_;
+    /// Unit shape line vertices.
+    PODVector<Vector3> shapeVertices_;
+    /// Start vertex of each unit shape, and the total vertex count.
+    unsigned shapeStarts_[MAX_DEBUGSHAPES + 1]{};
+    /// Unit shape vertex buffer.
+    SharedPtr<VertexBuffer> shapeVertexBuffer_;
+    /// Unit shape index buffer.
+    SharedPtr<IndexBuffer> shapeIndexBuffer_;
+    /// Frame number for layer expiry.
+    unsigned frameNumber_;
     /// View transform.
     Matrix3x4 view_;
     /// Projection transform.
@@ -188,8 +315,6 @@ private:
     Matrix4 gpuProjection_;
     /// View frustum.
     Frustum frustum_;
-    /// Vertex buffer.
-    SharedPtr<VertexBuffer> vertexBuffer_;
     /// Line antialiasing flag.
     bool lineAntiAlias_;
 };
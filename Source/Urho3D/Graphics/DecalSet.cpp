@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -33,6 +34,7 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Tangent.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -56,10 +58,18 @@ static const unsigned MIN_INDICES = 6;
 static const unsigned MAX_VERTICES = 65536;
 static const unsigned DEFAULT_MAX_VERTICES = 512;
 static const unsigned DEFAULT_MAX_INDICES = 1024;
+static const unsigned DEFAULT_MAX_DECALS_PER_FRAME = 8;
 static const VertexMaskFlags STATIC_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT;
 static const VertexMaskFlags SKINNED_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT |
     MASK_BLENDWEIGHTS | MASK_BLENDINDICES;
 
+void BuildDecalWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* decalSet = reinterpret_cast<DecalSet*>(item->aux_);
+    auto* request = reinterpret_cast<DecalRequest*>(item->start_);
+    decalSet->BuildDecal(*request);
+}
+
 static DecalVertex ClipEdge(const DecalVertex& v0, const DecalVertex& v1, float d0, float d1, bool skinned)
 {
     DecalVertex ret;
@@ -160,6 +170,7 @@ DecalSet::DecalSet(Context* context) :
     numIndices_(0),
     maxVertices_(DEFAULT_MAX_VERTICES),
     maxIndices_(DEFAULT_MAX_INDICES),
+    maxDecalsPerFrame_(DEFAULT_MAX_DECALS_PER_FRAME),
     optimizeBufferSize_(false),
     skinned_(false),
     bufferDirty_(true),
@@ -187,6 +198,8 @@ void DecalSet::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Max Vertices", GetMaxVertices, SetMaxVertices, unsigned, DEFAULT_MAX_VERTICES, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Max Indices", GetMaxIndices, SetMaxIndices, unsigned, DEFAULT_MAX_INDICES, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Optimize Buffer Size", GetOptimizeBufferSize, SetOptimizeBufferSize, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Decals Per Frame", GetMaxDecalsPerFrame, SetMaxDecalsPerFrame, unsigned, DEFAULT_MAX_DECALS_PER_FRAME,
+        AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
@@ -298,6 +311,12 @@ void DecalSet::SetOptimizeBufferSize(bool enable)
     }
 }
 
+void DecalSet::SetMaxDecalsPerFrame(unsigned num)
+{
+    maxDecalsPerFrame_ = num;
+    MarkNetworkUpdate();
+}
+
 bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
     float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive, float normalCutoff,
     unsigned subGeometry)
@@ -308,177 +327,64 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     if (!node_ || !GetSubsystem<Graphics>())
         return false;
 
-    if (!target || !target->GetNode())
-    {
-        URHO3D_LOGERROR("Null target drawable for decal");
+    DecalRequest request;
+    request.target_ = target;
+    request.worldPosition_ = worldPosition;
+    request.worldRotation_ = worldRotation;
+    request.size_ = size;
+    request.aspectRatio_ = aspectRatio;
+    request.depth_ = depth;
+    request.topLeftUV_ = topLeftUV;
+    request.bottomRightUV_ = bottomRightUV;
+    request.timeToLive_ = timeToLive;
+    request.normalCutoff_ = normalCutoff;
+    request.subGeometry_ = subGeometry;
+
+    if (!PrepareDecal(request))
         return false;
-    }
 
-    // Check for animated target and switch into skinned/static mode if necessary
-    auto* animatedModel = dynamic_cast<AnimatedModel*>(target);
-    if ((animatedModel && !skinned_) || (!animatedModel && skinned_))
-    {
-        RemoveAllDecals();
-        skinned_ = animatedModel != nullptr;
-        bufferDirty_ = true;
-    }
-
-    // Center the decal frustum on the world position
-    Vector3 adjustedWorldPosition = worldPosition - 0.5f * depth * (worldRotation * Vector3::FORWARD);
-    /// \todo target transform is not right if adding a decal to StaticModelGroup
-    Matrix3x4 targetTransform = target->GetNode()->GetWorldTransform().Inverse();
-
-    // For an animated model, adjust the decal position back to the bind pose
-    // To do this, need to find the bone the decal is colliding with
-    if (animatedModel)
-    {
-        Skeleton& skeleton = animatedModel->GetSkeleton();
-        unsigned numBones = skeleton.GetNumBones();
-        Bone* bestBone = nullptr;
-        float bestSize = 0.0f;
-
-        for (unsigned i = 0; i < numBones; ++i)
-        {
-            Bone* bone = skeleton.GetBone(i);
-            if (!bone->node_ || !bone->collisionMask_)
-                continue;
-
-            // Represent the decal as a sphere, try to find the biggest colliding bone
-            Sphere decalSphere
-                (bone->node_->GetWorldTransform().Inverse() * worldPosition, 0.5f * size / bone->node_->GetWorldScale().Length());
-
-            if (bone->collisionMask_ & BONECOLLISION_BOX)
-            {
-                float size = bone->boundingBox_.HalfSize().Length();
-                if (bone->boundingBox_.IsInside(decalSphere) && size > bestSize)
-                {
-                    bestBone = bone;
-                    bestSize = size;
-                }
-            }
-            else if (bone->collisionMask_ & BONECOLLISION_SPHERE)
-            {
-                Sphere boneSphere(Vector3::ZERO, bone->radius_);
-                float size = bone->radius_;
-                if (boneSphere.IsInside(decalSphere) && size > bestSize)
-                {
-                    bestBone = bone;
-                    bestSize = size;
-                }
-            }
-        }
-
-        if (bestBone)
-            targetTransform = (bestBone->node_->GetWorldTransform() * bestBone->offsetMatrix_).Inverse();
-    }
-
-    // Build the decal frustum
-    Frustum decalFrustum;
-    Matrix3x4 frustumTransform = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
-    decalFrustum.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, frustumTransform);
-
-    Vector3 decalNormal = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
-
-    decals_.Resize(decals_.Size() + 1);
-    Decal& newDecal = decals_.Back();
-    newDecal.timeToLive_ = timeToLive;
-
-    Vector<PODVector<DecalVertex> > faces;
-    PODVector<DecalVertex> tempFace;
-
-    unsigned numBatches = target->GetBatches().Size();
-
-    // Use either a specified subgeometry in the target, or all
-    if (subGeometry < numBatches)
-        GetFaces(faces, target, subGeometry, decalFrustum, decalNormal, normalCutoff);
-    else
-    {
-        for (unsigned i = 0; i < numBatches; ++i)
-            GetFaces(faces, target, i, decalFrustum, decalNormal, normalCutoff);
-    }
-
-    // Clip the acquired faces against all frustum planes
-    for (const auto& plane : decalFrustum.planes_)
-    {
-        for (unsigned j = 0; j < faces.Size(); ++j)
-        {
-            PODVector<DecalVertex>& face = faces[j];
-            if (face.Empty())
-                continue;
-
-            ClipPolygon(tempFace, face, plane, skinned_);
-            face = tempFace;
-        }
-    }
-
-    // Now triangulate the resulting faces into decal vertices
-    for (unsigned i = 0; i < faces.Size(); ++i)
-    {
-        PODVector<DecalVertex>& face = faces[i];
-        if (face.Size() < 3)
-            continue;
-
-        for (unsigned j = 2; j < face.Size(); ++j)
-        {
-            newDecal.AddVertex(face[0]);
-            newDecal.AddVertex(face[j - 1]);
-            newDecal.AddVertex(face[j]);
-        }
-    }
+    BuildDecal(request);
+    return InsertDecal(request);
+}
 
-    // Check if resulted in no triangles
-    if (newDecal.vertices_.Empty())
-    {
-        decals_.Pop();
-        return true;
-    }
+bool DecalSet::AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+    float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive, float normalCutoff,
+    unsigned subGeometry)
+{
+    // Do not add decals in headless mode
+    if (!node_ || !GetSubsystem<Graphics>())
+        return false;
 
-    if (newDecal.vertices_.Size() > maxVertices_)
+    if (!target || !target->GetNode())
     {
-        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(newDecal.vertices_.Size()) + " exceeds maximum " +
-                   String(maxVertices_));
-        decals_.Pop();
+        URHO3D_LOGERROR("Null target drawable for decal");
         return false;
     }
-    if (newDecal.indices_.Size() > maxIndices_)
+
+    // Skinned decals remap the bones of the decal set while clipping, so they are added immediately
+    if (dynamic_cast<AnimatedModel*>(target))
     {
-        URHO3D_LOGWARNING("Can not add decal, index count " + String(newDecal.indices_.Size()) + " exceeds maximum " +
-                   String(maxIndices_));
-        decals_.Pop();
-        return false;
+        return AddDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+            normalCutoff, subGeometry);
     }
 
-    // Calculate UVs
-    Matrix4 projection(Matrix4::ZERO);
-    projection.m11_ = (1.0f / (size * 0.5f));
-    projection.m00_ = projection.m11_ / aspectRatio;
-    projection.m22_ = 1.0f / depth;
-    projection.m33_ = 1.0f;
-
-    CalculateUVs(newDecal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
-
-    // Transform vertices to this node's local space and generate tangents
-    Matrix3x4 decalTransform = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
-    TransformVertices(newDecal, skinned_ ? Matrix3x4::IDENTITY : decalTransform);
-    GenerateTangents(&newDecal.vertices_[0], sizeof(DecalVertex), &newDecal.indices_[0], sizeof(unsigned short), 0,
-        newDecal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
-        tangent_));
-
-    newDecal.CalculateBoundingBox();
-    numVertices_ += newDecal.vertices_.Size();
-    numIndices_ += newDecal.indices_.Size();
-
-    // Remove oldest decals if total vertices exceeded
-    while (decals_.Size() && (numVertices_ > maxVertices_ || numIndices_ > maxIndices_))
-        RemoveDecals(1);
-
-    URHO3D_LOGDEBUG("Added decal with " + String(newDecal.vertices_.Size()) + " vertices");
-
-    // If new decal is time limited, subscribe to scene post-update
-    if (newDecal.timeToLive_ > 0.0f && !subscribed_)
+    decalRequests_.Resize(decalRequests_.Size() + 1);
+    DecalRequest& request = decalRequests_.Back();
+    request.target_ = target;
+    request.worldPosition_ = worldPosition;
+    request.worldRotation_ = worldRotation;
+    request.size_ = size;
+    request.aspectRatio_ = aspectRatio;
+    request.depth_ = depth;
+    request.topLeftUV_ = topLeftUV;
+    request.bottomRightUV_ = bottomRightUV;
+    request.timeToLive_ = timeToLive;
+    request.normalCutoff_ = normalCutoff;
+    request.subGeometry_ = subGeometry;
+
+    // The requests are processed in the scene post-update
+    if (!subscribed_)
         UpdateEventSubscription(false);
-
-    MarkDecalsDirty();
     return true;
 }
 
@@ -694,11 +600,247 @@ void DecalSet::OnWorldBoundingBoxUpdate()
     }
 }
 
-void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-    const Vector3& decalNormal, float normalCutoff)
+bool DecalSet::PrepareDecal(DecalRequest& request)
+{
+    Drawable* target = request.target_;
+    if (!target || !target->GetNode())
+    {
+        URHO3D_LOGERROR("Null target drawable for decal");
+        return false;
+    }
+
+    // Check for animated target and switch into skinned/static mode if necessary
+    auto* animatedModel = dynamic_cast<AnimatedModel*>(target);
+    if ((animatedModel && !skinned_) || (!animatedModel && skinned_))
+    {
+        RemoveAllDecals();
+        skinned_ = animatedModel != nullptr;
+        bufferDirty_ = true;
+    }
+
+    const Vector3& worldPosition = request.worldPosition_;
+    const Quaternion& worldRotation = request.worldRotation_;
+    float size = request.size_;
+
+    // Center the decal frustum on the world position
+    Vector3 adjustedWorldPosition = worldPosition - 0.5f * request.depth_ * (worldRotation * Vector3::FORWARD);
+    /// \todo target transform is not right if adding a decal to StaticModelGroup
+    Matrix3x4 targetTransform = target->GetNode()->GetWorldTransform().Inverse();
+
+    // For an animated model, adjust the decal position back to the bind pose
+    // To do this, need to find the bone the decal is colliding with
+    if (animatedModel)
+    {
+        Skeleton& skeleton = animatedModel->GetSkeleton();
+        unsigned numBones = skeleton.GetNumBones();
+        Bone* bestBone = nullptr;
+        float bestSize = 0.0f;
+
+        for (unsigned i = 0; i < numBones; ++i)
+        {
+            Bone* bone = skeleton.GetBone(i);
+            if (!bone->node_ || !bone->collisionMask_)
+                continue;
+
+            // Represent the decal as a sphere, try to find the biggest colliding bone
+            Sphere decalSphere
+                (bone->node_->GetWorldTransform().Inverse() * worldPosition, 0.5f * size / bone->node_->GetWorldScale().Length());
+
+            if (bone->collisionMask_ & BONECOLLISION_BOX)
+            {
+                float size = bone->boundingBox_.HalfSize().Length();
+                if (bone->boundingBox_.IsInside(decalSphere) && size > bestSize)
+                {
+                    bestBone = bone;
+                    bestSize = size;
+                }
+            }
+            else if (bone->collisionMask_ & BONECOLLISION_SPHERE)
+            {
+                Sphere boneSphere(Vector3::ZERO, bone->radius_);
+                float size = bone->radius_;
+                if (boneSphere.IsInside(decalSphere) && size > bestSize)
+                {
+                    bestBone = bone;
+                    bestSize = size;
+                }
+            }
+        }
+
+        if (bestBone)
+            targetTransform = (bestBone->node_->GetWorldTransform() * bestBone->offsetMatrix_).Inverse();
+    }
+
+    // Build the decal frustum
+    request.frustumTransform_ = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
+    request.frustum_.DefineOrtho(size, request.aspectRatio_, 1.0, 0.0f, request.depth_, request.frustumTransform_);
+    request.decalNormal_ = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+    request.decalTransform_ = skinned_ ? Matrix3x4::IDENTITY : node_->GetWorldTransform().Inverse() *
+        target->GetNode()->GetWorldTransform();
+
+    // Use either a specified subgeometry in the target, or all. Try to use the most accurate LOD level if possible
+    unsigned numBatches = target->GetBatches().Size();
+    request.geometries_.Resize(numBatches);
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        request.geometries_[i] = (request.subGeometry_ >= numBatches || request.subGeometry_ == i) ?
+            target->GetLodGeometry(i, 0) : nullptr;
+    }
+
+    request.decal_.timeToLive_ = request.timeToLive_;
+    return true;
+}
+
+void DecalSet::BuildDecal(DecalRequest& request)
+{
+    Drawable* target = request.target_;
+    const Frustum& decalFrustum = request.frustum_;
+    Decal& newDecal = request.decal_;
+
+    Vector<PODVector<DecalVertex> > faces;
+    PODVector<DecalVertex> tempFace;
+
+    for (unsigned i = 0; i < request.geometries_.Size(); ++i)
+    {
+        if (request.geometries_[i])
+            GetFaces(faces, target, i, request.geometries_[i], decalFrustum, request.decalNormal_, request.normalCutoff_);
+    }
+
+    // Clip the acquired faces against all frustum planes
+    for (const auto& plane : decalFrustum.planes_)
+    {
+        for (unsigned j = 0; j < faces.Size(); ++j)
+        {
+            PODVector<DecalVertex>& face = faces[j];
+            if (face.Empty())
+                continue;
+
+            ClipPolygon(tempFace, face, plane, skinned_);
+            face = tempFace;
+        }
+    }
+
+    // Now triangulate the resulting faces into decal vertices
+    for (unsigned i = 0; i < faces.Size(); ++i)
+    {
+        PODVector<DecalVertex>& face = faces[i];
+        if (face.Size() < 3)
+            continue;
+
+        for (unsigned j = 2; j < face.Size(); ++j)
+        {
+            newDecal.AddVertex(face[0]);
+            newDecal.AddVertex(face[j - 1]);
+            newDecal.AddVertex(face[j]);
+        }
+    }
+
+    // Leave decals with no triangles or too many vertices to be rejected when inserting
+    if (newDecal.vertices_.Empty() || newDecal.vertices_.Size() > maxVertices_ || newDecal.indices_.Size() > maxIndices_)
+        return;
+
+    // Calculate UVs
+    Matrix4 projection(Matrix4::ZERO);
+    projection.m11_ = (1.0f / (request.size_ * 0.5f));
+    projection.m00_ = projection.m11_ / request.aspectRatio_;
+    projection.m22_ = 1.0f / request.depth_;
+    projection.m33_ = 1.0f;
+
+    CalculateUVs(newDecal, request.frustumTransform_.Inverse(), projection, request.topLeftUV_, request.bottomRightUV_);
+
+    // Transform vertices to this node's local space and generate tangents
+    TransformVertices(newDecal, request.decalTransform_);
+    GenerateTangents(&newDecal.vertices_[0], sizeof(DecalVertex), &newDecal.indices_[0], sizeof(unsigned short), 0,
+        newDecal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
+        tangent_));
+
+    newDecal.CalculateBoundingBox();
+}
+
+bool DecalSet::InsertDecal(DecalRequest& request)
+{
+    Decal& newDecal = request.decal_;
+
+    // Check if resulted in no triangles
+    if (newDecal.vertices_.Empty())
+        return true;
+
+    if (newDecal.vertices_.Size() > maxVertices_)
+    {
+        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(newDecal.vertices_.Size()) + " exceeds maximum " +
+                   String(maxVertices_));
+        return false;
+    }
+    if (newDecal.indices_.Size() > maxIndices_)
+    {
+        URHO3D_LOGWARNING("Can not add decal, index count " + String(newDecal.indices_.Size()) + " exceeds maximum " +
+                   String(maxIndices_));
+        return false;
+    }
+
+    numVertices_ += newDecal.vertices_.Size();
+    numIndices_ += newDecal.indices_.Size();
+    URHO3D_LOGDEBUG("Added decal with " + String(newDecal.vertices_.Size()) + " vertices");
+    decals_.Push(newDecal);
+
+    // Remove oldest decals if total vertices exceeded
+    while (decals_.Size() && (numVertices_ > maxVertices_ || numIndices_ > maxIndices_))
+        RemoveDecals(1);
+
+    // If new decal is time limited, subscribe to scene post-update
+    if (newDecal.timeToLive_ > 0.0f && !subscribed_)
+        UpdateEventSubscription(false);
+
+    MarkDecalsDirty();
+    return true;
+}
+
+void DecalSet::ProcessDecalRequests()
+{
+    URHO3D_PROFILE(ProcessDecalRequests);
+
+    unsigned numRequests = decalRequests_.Size();
+    if (maxDecalsPerFrame_ && numRequests > maxDecalsPerFrame_)
+        numRequests = maxDecalsPerFrame_;
+
+    // Prepare the requests in the main thread. Requests whose target was destroyed are skipped
+    List<DecalRequest>::Iterator end = decalRequests_.Begin();
+    for (unsigned i = 0; i < numRequests; ++i, ++end)
+    {
+        if (!PrepareDecal(*end))
+            end->geometries_.Clear();
+    }
+
+    // Clip against the targets' shadow geometry data in worker threads. The main thread waits, so the geometry can not
+    // change meanwhile
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (List<DecalRequest>::Iterator i = decalRequests_.Begin(); i != end; ++i)
+    {
+        if (i->geometries_.Empty())
+            continue;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = BuildDecalWork;
+        item->name_ = "BuildDecalWork";
+        item->aux_ = this;
+        item->start_ = &(*i);
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+
+    // Insert the finished decals in request order. The buffers are rewritten once in the geometry update
+    for (List<DecalRequest>::Iterator i = decalRequests_.Begin(); i != end;)
+    {
+        if (!i->geometries_.Empty())
+            InsertDecal(*i);
+        i = decalRequests_.Erase(i);
+    }
+}
+
+void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, Geometry* geometry,
+    const Frustum& frustum, const Vector3& decalNormal, float normalCutoff)
 {
-    // Try to use the most accurate LOD level if possible
-    Geometry* geometry = target->GetLodGeometry(batchIndex, 0);
     if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
         return;
 
@@ -760,6 +902,49 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
         }
     }
 
+    // If the target is static and its triangle hierarchy covers the same data, only visit the triangles near the frustum.
+    // Skinned targets are clipped in bone space, where the hierarchy does not apply
+    if (!skinned_)
+    {
+        SharedPtr<TriangleBVH> bvh = geometry->GetTriangleBVH();
+        unsigned start = indexData ? geometry->GetIndexStart() : geometry->GetVertexStart();
+        unsigned count = indexData ? geometry->GetIndexCount() : geometry->GetVertexCount();
+
+        if (bvh && bvh->IsBuiltFrom(positionData, indexData, start, count))
+        {
+            PODVector<unsigned> triangles;
+            bvh->GetTriangles(frustum, triangles);
+
+            for (unsigned i = 0; i < triangles.Size(); ++i)
+            {
+                unsigned first = triangles[i];
+                unsigned i0 = first;
+                unsigned i1 = first + 1;
+                unsigned i2 = first + 2;
+
+                if (indexData && indexStride == sizeof(unsigned short))
+                {
+                    const unsigned short* indices = ((const unsigned short*)indexData) + first;
+                    i0 = indices[0];
+                    i1 = indices[1];
+                    i2 = indices[2];
+                }
+                else if (indexData)
+                {
+                    const unsigned* indices = ((const unsigned*)indexData) + first;
+                    i0 = indices[0];
+                    i1 = indices[1];
+                    i2 = indices[2];
+                }
+
+                GetFace(faces, target, batchIndex, i0, i1, i2, positionData, normalData, skinningData, positionStride,
+                    normalStride, skinningStride, frustum, decalNormal, normalCutoff);
+            }
+
+            return;
+        }
+    }
+
     if (indexData)
     {
         unsigned indexStart = geometry->GetIndexStart();
@@ -1140,8 +1325,8 @@ void DecalSet::UpdateEventSubscription(bool checkAllDecals)
             }
         }
 
-        // If no time limited decals, no need to subscribe to scene update
-        enabled = hasTimeLimitedDecals;
+        // If no time limited decals or pending requests, no need to subscribe to scene update
+        enabled = hasTimeLimitedDecals || !decalRequests_.Empty();
     }
 
     if (enabled && !subscribed_)
@@ -1172,6 +1357,13 @@ void DecalSet::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData
         else
             ++i;
     }
+
+    if (!decalRequests_.Empty())
+    {
+        ProcessDecalRequests();
+        if (decalRequests_.Empty())
+            UpdateEventSubscription(true);
+    }
 }
 
 }
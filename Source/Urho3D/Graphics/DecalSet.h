@@ -32,6 +32,7 @@ namespace Urho3D
 
 class IndexBuffer;
 class VertexBuffer;
+struct WorkItem;
 
 /// %Decal vertex.
 struct DecalVertex
@@ -99,11 +100,52 @@ struct Decal
     PODVector<unsigned short> indices_;
 };
 
+/// Decal waiting to be clipped against its target geometry.
+struct DecalRequest
+{
+    /// Target drawable.
+    WeakPtr<Drawable> target_;
+    /// World position.
+    Vector3 worldPosition_;
+    /// World rotation.
+    Quaternion worldRotation_;
+    /// Size.
+    float size_;
+    /// Aspect ratio.
+    float aspectRatio_;
+    /// Depth.
+    float depth_;
+    /// Top left texture coordinates.
+    Vector2 topLeftUV_;
+    /// Bottom right texture coordinates.
+    Vector2 bottomRightUV_;
+    /// Time to live in seconds (0 = infinite)
+    float timeToLive_;
+    /// Normal cutoff.
+    float normalCutoff_;
+    /// Target subgeometry, or M_MAX_UNSIGNED for all.
+    unsigned subGeometry_;
+    /// Target geometries by batch index, null for the batches not used. Empty if the request could not be prepared.
+    PODVector<Geometry*> geometries_;
+    /// Decal frustum in the target geometry's space.
+    Frustum frustum_;
+    /// Decal frustum transform in the target geometry's space.
+    Matrix3x4 frustumTransform_;
+    /// Decal normal in the target geometry's space.
+    Vector3 decalNormal_;
+    /// Transform from the target geometry's space to the decal set's local space.
+    Matrix3x4 decalTransform_;
+    /// Resulting decal.
+    Decal decal_;
+};
+
 /// %Decal renderer component.
 class URHO3D_API DecalSet : public Drawable
 {
     URHO3D_OBJECT(DecalSet, Drawable);
 
+    friend void BuildDecalWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit DecalSet(Context* context);
@@ -137,6 +179,12 @@ public:
     bool AddDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
         float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
         unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Queue a decal to be added at world coordinates in the scene post-update, using a target drawable's geometry for reference. The clipping against the target geometry runs in worker threads, and at most the maximum number of decals per frame are processed. Decals on an AnimatedModel are added immediately. Return true if queued.
+    bool AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+        float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f,
+        float normalCutoff = 0.1f, unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Set maximum number of queued decals to process per frame. 0 = unlimited.
+    void SetMaxDecalsPerFrame(unsigned num);
     /// Remove n oldest decals.
     void RemoveDecals(unsigned num);
     /// Remove all decals.
@@ -163,6 +211,12 @@ public:
     /// Return whether is optimizing GPU buffer sizes according to current amount of decals.
     bool GetOptimizeBufferSize() const { return optimizeBufferSize_; }
 
+    /// Return maximum number of queued decals to process per frame.
+    unsigned GetMaxDecalsPerFrame() const { return maxDecalsPerFrame_; }
+
+    /// Return number of queued decals waiting to be processed.
+    unsigned GetNumPendingDecals() const { return decalRequests_.Size(); }
+
     /// Set material attribute.
     void SetMaterialAttr(const ResourceRef& value);
     /// Set decals attribute.
@@ -179,9 +233,17 @@ protected:
     void OnMarkedDirty(Node* node) override;
 
 private:
+    /// Find the decal frustum and the target geometries of a decal request. Return true if successful.
+    bool PrepareDecal(DecalRequest& request);
+    /// Clip the target geometries of a prepared decal request into its decal. May be called from a worker thread if the target is not skinned.
+    void BuildDecal(DecalRequest& request);
+    /// Add the built decal of a request to the decals. Return true if successful.
+    bool InsertDecal(DecalRequest& request);
+    /// Process queued decal requests up to the per-frame maximum.
+    void ProcessDecalRequests();
     /// Get triangle faces from the target geometry.
-    void GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-        const Vector3& decalNormal, float normalCutoff);
+    void GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, Geometry* geometry,
+        const Frustum& frustum, const Vector3& decalNormal, float normalCutoff);
     /// Get triangle face from the target geometry.
     void GetFace
         (Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1, unsigned i2,
@@ -223,6 +285,8 @@ private:
     SharedPtr<IndexBuffer> indexBuffer_;
     /// Decals.
     List<Decal> decals_;
+    /// Queued decal requests.
+    List<DecalRequest> decalRequests_;
     /// Bones used for skinned decals.
     Vector<Bone> bones_;
     /// Skinning matrices.
@@ -235,6 +299,8 @@ private:
     unsigned maxVertices_;
     /// Maximum indices.
     unsigned maxIndices_;
+    /// Maximum queued decals to process per frame.
+    unsigned maxDecalsPerFrame_;
     /// Optimize buffer sizes flag.
     bool optimizeBufferSize_;
     /// Skinned mode flag.
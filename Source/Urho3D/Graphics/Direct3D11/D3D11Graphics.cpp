@@ -31,6 +31,7 @@
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
 #include "../../Graphics/IndexBuffer.h"
+#include "../../Graphics/Material.h"
 #include "../../Graphics/Renderer.h"
 #include "../../Graphics/Shader.h"
 #include "../../Graphics/ShaderPrecache.h"
@@ -212,7 +213,7 @@ Graphics::Graphics(Context* context) :
     context_->RequireSDL(SDL_INIT_VIDEO);
 
     // Register Graphics library object factories
-    RegisterGraphicsLibrary(context_);
+    context_->RegisterLibrary("Graphics", RegisterGraphicsLibrary);
 }
 
 Graphics::~Graphics()
@@ -248,6 +249,9 @@ Graphics::~Graphics()
     }
     impl_->rasterizerStates_.Clear();
 
+    ReleaseGPUTimers();
+    ReleaseReadbacks();
+
     URHO3D_SAFE_RELEASE(impl_->defaultRenderTargetView_);
     URHO3D_SAFE_RELEASE(impl_->defaultDepthStencilView_);
     URHO3D_SAFE_RELEASE(impl_->defaultDepthTexture_);
@@ -571,6 +575,9 @@ bool Graphics::BeginFrame()
     numPrimitives_ = 0;
     numBatches_ = 0;
 
+    UpdateReadbacks();
+    BeginGPUTimerFrame();
+
     SendEvent(E_BEGINRENDERING);
     return true;
 }
@@ -584,6 +591,7 @@ void Graphics::EndFrame()
         URHO3D_PROFILE(Present);
 
         SendEvent(E_ENDRENDERING);
+        EndGPUTimerFrame();
         impl_->swapChain_->Present(vsync_ ? 1 : 0, 0);
     }
 
@@ -884,6 +892,44 @@ void Graphics::DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned i
     ++numBatches_;
 }
 
+void Graphics::MultiDrawInstanced(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands)
+{
+    if (commands.Empty() || !impl_->shaderProgram_)
+        return;
+
+    // The start instance location of each draw offsets the instance data instead of the vertex buffer offset,
+    // so the render state only needs to be prepared once
+    PODVector<VertexBuffer*> vertexBuffers(vertexBuffers_, MAX_VERTEX_STREAMS);
+    SetVertexBuffers(vertexBuffers, 0);
+
+    PrepareDraw();
+
+    if (fillMode_ == FILL_POINT)
+        type = POINT_LIST;
+
+    for (unsigned i = 0; i < commands.Size(); ++i)
+    {
+        const InstancedDrawCommand& command = commands[i];
+        if (!command.indexCount_ || !command.instanceCount_)
+            continue;
+
+        unsigned primitiveCount;
+        D3D_PRIMITIVE_TOPOLOGY d3dPrimitiveType;
+
+        GetD3DPrimitiveType(command.indexCount_, type, primitiveCount, d3dPrimitiveType);
+        if (d3dPrimitiveType != primitiveType_)
+        {
+            impl_->deviceContext_->IASetPrimitiveTopology(d3dPrimitiveType);
+            primitiveType_ = d3dPrimitiveType;
+        }
+        impl_->deviceContext_->DrawIndexedInstanced(command.indexCount_, command.instanceCount_, command.indexStart_, 0,
+            command.instanceStart_);
+
+        numPrimitives_ += command.instanceCount_ * primitiveCount;
+        ++numBatches_;
+    }
+}
+
 void Graphics::SetVertexBuffer(VertexBuffer* buffer)
 {
     // Note: this is not multi-instance safe
@@ -1044,9 +1090,6 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             impl_->shaderProgram_ = newProgram;
         }
 
-        bool vsBuffersChanged = false;
-        bool psBuffersChanged = false;
-
         for (unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
         {
             ID3D11Buffer* vsBuffer = impl_->shaderProgram_->vsConstantBuffers_[i] ? (ID3D11Buffer*)impl_->shaderProgram_->vsConstantBuffers_[i]->
@@ -1055,7 +1098,7 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             {
                 impl_->constantBuffers_[VS][i] = vsBuffer;
                 shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
-                vsBuffersChanged = true;
+                impl_->constantBuffersDirty_ = true;
             }
 
             ID3D11Buffer* psBuffer = impl_->shaderProgram_->psConstantBuffers_[i] ? (ID3D11Buffer*)impl_->shaderProgram_->psConstantBuffers_[i]->
@@ -1064,14 +1107,9 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             {
                 impl_->constantBuffers_[PS][i] = psBuffer;
                 shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
-                psBuffersChanged = true;
+                impl_->constantBuffersDirty_ = true;
             }
         }
-
-        if (vsBuffersChanged)
-            impl_->deviceContext_->VSSetConstantBuffers(0, MAX_SHADER_PARAMETER_GROUPS, &impl_->constantBuffers_[VS][0]);
-        if (psBuffersChanged)
-            impl_->deviceContext_->PSSetConstantBuffers(0, MAX_SHADER_PARAMETER_GROUPS, &impl_->constantBuffers_[PS][0]);
     }
     else
         impl_->shaderProgram_ = nullptr;
@@ -1228,6 +1266,75 @@ bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* sourc
         return false;
 }
 
+bool Graphics::SetMaterialShaderParameters(Material* material)
+{
+    ShaderProgram* program = impl_->shaderProgram_;
+    if (!program || !material)
+        return false;
+
+    ConstantBuffer* sharedBuffers[2] = {program->vsConstantBuffers_[SP_MATERIAL], program->psConstantBuffers_[SP_MATERIAL]};
+    if (!sharedBuffers[VS] && !sharedBuffers[PS])
+        return false;
+
+    HashMap<unsigned, MaterialConstantBuffer>& materialBuffers = material->GetConstantBuffers();
+    unsigned parameterHash = material->GetShaderParameterHash();
+    MaterialConstantBuffer* entries[2] = {};
+    bool needFill = false;
+
+    for (unsigned i = VS; i <= PS; ++i)
+    {
+        if (!sharedBuffers[i])
+            continue;
+
+        MaterialConstantBuffer& entry = materialBuffers[program->materialLayoutHashes_[i]];
+        // Also recreate after device loss, which releases the buffer
+        if (!entry.buffer_ || entry.buffer_->GetSize() != sharedBuffers[i]->GetSize())
+        {
+            entry.buffer_ = new ConstantBuffer(context_);
+            entry.buffer_->SetSize(sharedBuffers[i]->GetSize());
+            entry.parameterHash_ = parameterHash + 1;
+        }
+        if (entry.parameterHash_ != parameterHash)
+            needFill = true;
+        entries[i] = &entry;
+    }
+
+    if (needFill)
+    {
+        // Write the parameters through the shared buffers for the same conversions as when setting them individually, then
+        // copy the whole layout
+        const HashMap<StringHash, MaterialShaderParameter>& parameters = material->GetShaderParameters();
+        for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
+            SetShaderParameter(i->first_, i->second_.value_);
+        shaderParameterSources_[SP_MATERIAL] = (const void*)M_MAX_UNSIGNED;
+
+        for (unsigned i = VS; i <= PS; ++i)
+        {
+            if (entries[i] && entries[i]->parameterHash_ != parameterHash)
+            {
+                entries[i]->buffer_->SetParameter(0, sharedBuffers[i]->GetSize(), sharedBuffers[i]->GetShadowData());
+                entries[i]->buffer_->Apply();
+                entries[i]->parameterHash_ = parameterHash;
+            }
+        }
+    }
+
+    for (unsigned i = VS; i <= PS; ++i)
+    {
+        if (!entries[i])
+            continue;
+
+        auto* object = (ID3D11Buffer*)entries[i]->buffer_->GetGPUObject();
+        if (object != impl_->constantBuffers_[i][SP_MATERIAL])
+        {
+            impl_->constantBuffers_[i][SP_MATERIAL] = object;
+            impl_->constantBuffersDirty_ = true;
+        }
+    }
+
+    return true;
+}
+
 bool Graphics::HasShaderParameter(StringHash param)
 {
     return impl_->shaderProgram_ && impl_->shaderProgram_->parameters_.Find(param) != impl_->shaderProgram_->parameters_.End();
@@ -1249,6 +1356,12 @@ void Graphics::ClearParameterSources()
         shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
 }
 
+void Graphics::ClearViewParameterSources()
+{
+    for (unsigned i = SP_CAMERA; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+        shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
+}
+
 void Graphics::ClearTransformSources()
 {
     shaderParameterSources_[SP_CAMERA] = (const void*)M_MAX_UNSIGNED;
@@ -1320,6 +1433,17 @@ void Graphics::SetDefaultTextureFilterMode(TextureFilterMode mode)
     }
 }
 
+bool Graphics::BeginBackgroundUpload()
+{
+    // Not supported on Direct3D11
+    return false;
+}
+
+void Graphics::EndBackgroundUpload()
+{
+    // No-op on Direct3D11
+}
+
 void Graphics::SetDefaultTextureAnisotropy(unsigned level)
 {
     level = Max(level, 1U);
@@ -2294,11 +2418,211 @@ void Graphics::CheckFeatureSupport()
     deferredSupport_ = true;
     hardwareShadowSupport_ = true;
     instancingSupport_ = true;
+    multiDrawSupport_ = true;
     shadowMapFormat_ = DXGI_FORMAT_R16_TYPELESS;
     hiresShadowMapFormat_ = DXGI_FORMAT_R32_TYPELESS;
     dummyColorFormat_ = DXGI_FORMAT_UNKNOWN;
     sRGBSupport_ = true;
     sRGBWriteSupport_ = true;
+    compressedVertexSupport_ = ((1u << MAX_VERTEX_ELEMENT_TYPES) - 1) & ~((1u << TYPE_HALF2) - 1);
+    gpuTimingSupport_ = true;
+    asyncReadbackSupport_ = true;
+}
+
+void Graphics::BeginTimerQueryFrame(unsigned frame)
+{
+    ID3D11Query*& disjointQuery = impl_->disjointQueries_[frame];
+    if (!disjointQuery)
+    {
+        D3D11_QUERY_DESC queryDesc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+        if (FAILED(impl_->device_->CreateQuery(&queryDesc, &disjointQuery)))
+            return;
+    }
+
+    impl_->deviceContext_->Begin(disjointQuery);
+}
+
+void Graphics::EndTimerQueryFrame(unsigned frame)
+{
+    if (impl_->disjointQueries_[frame])
+        impl_->deviceContext_->End(impl_->disjointQueries_[frame]);
+}
+
+void Graphics::IssueTimerQuery(unsigned frame, unsigned index)
+{
+    ID3D11Query*& query = impl_->timerQueries_[frame][index];
+    if (!query)
+    {
+        D3D11_QUERY_DESC queryDesc = {D3D11_QUERY_TIMESTAMP, 0};
+        if (FAILED(impl_->device_->CreateQuery(&queryDesc, &query)))
+            return;
+    }
+
+    impl_->deviceContext_->End(query);
+}
+
+bool Graphics::GetTimerQueryResults(unsigned frame, unsigned count, PODVector<long long>& dest)
+{
+    ID3D11DeviceContext* context = impl_->deviceContext_;
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+    if (!impl_->disjointQueries_[frame] || context->GetData(impl_->disjointQueries_[frame], &disjoint, sizeof disjoint,
+        D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        return false;
+
+    dest.Resize(count);
+    UINT64 firstTime = 0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        UINT64 time = 0;
+        if (impl_->timerQueries_[frame][i] && context->GetData(impl_->timerQueries_[frame][i], &time, sizeof time,
+            D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+            return false;
+        if (!i)
+            firstTime = time;
+        // Convert ticks to microseconds relative to the frame start so that the product does not overflow
+        dest[i] = disjoint.Disjoint ? 0 : (long long)((time - firstTime) * 1000000 / disjoint.Frequency);
+    }
+
+    return true;
+}
+
+void Graphics::ReleaseTimerQueries()
+{
+    for (unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+    {
+        URHO3D_SAFE_RELEASE(impl_->disjointQueries_[i]);
+        for (unsigned j = 0; j < MAX_GPU_TIMER_QUERIES; ++j)
+        {
+            URHO3D_SAFE_RELEASE(impl_->timerQueries_[i][j]);
+        }
+    }
+}
+
+bool Graphics::IssueTextureReadback(GPUReadback* readback, Texture2D* texture, unsigned level)
+{
+    if (texture->IsResolveDirty())
+        ResolveToTexture(texture);
+
+    D3D11_TEXTURE2D_DESC textureDesc;
+    memset(&textureDesc, 0, sizeof textureDesc);
+    textureDesc.Width = (UINT)readback->width_;
+    textureDesc.Height = (UINT)readback->height_;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = (DXGI_FORMAT)readback->format_;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_STAGING;
+    textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    ID3D11Texture2D* stagingTexture = nullptr;
+    HRESULT hr = impl_->device_->CreateTexture2D(&textureDesc, nullptr, &stagingTexture);
+    if (FAILED(hr))
+    {
+        URHO3D_LOGD3DERROR("Failed to create staging texture for readback", hr);
+        URHO3D_SAFE_RELEASE(stagingTexture);
+        return false;
+    }
+
+    auto* srcResource = (ID3D11Resource*)(texture->GetResolveTexture() ? texture->GetResolveTexture() : texture->GetGPUObject());
+    unsigned srcSubResource = D3D11CalcSubresource(level, 0, texture->GetLevels());
+
+    D3D11_BOX srcBox;
+    srcBox.left = 0;
+    srcBox.right = (UINT)readback->width_;
+    srcBox.top = 0;
+    srcBox.bottom = (UINT)readback->height_;
+    srcBox.front = 0;
+    srcBox.back = 1;
+    impl_->deviceContext_->CopySubresourceRegion(stagingTexture, 0, 0, 0, 0, srcResource, srcSubResource, &srcBox);
+
+    // The staging texture is mapped once the copy has finished
+    readback->object_.ptr_ = stagingTexture;
+    return true;
+}
+
+bool Graphics::IssueScreenReadback(GPUReadback* readback)
+{
+    D3D11_TEXTURE2D_DESC textureDesc;
+    memset(&textureDesc, 0, sizeof textureDesc);
+    textureDesc.Width = (UINT)width_;
+    textureDesc.Height = (UINT)height_;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_STAGING;
+    textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    ID3D11Texture2D* stagingTexture = nullptr;
+    HRESULT hr = impl_->device_->CreateTexture2D(&textureDesc, nullptr, &stagingTexture);
+    if (FAILED(hr))
+    {
+        URHO3D_SAFE_RELEASE(stagingTexture);
+        URHO3D_LOGD3DERROR("Could not create staging texture for screenshot", hr);
+        return false;
+    }
+
+    ID3D11Resource* source = nullptr;
+    impl_->defaultRenderTargetView_->GetResource(&source);
+
+    if (multiSample_ > 1)
+    {
+        // If backbuffer is multisampled, need another DEFAULT usage texture to resolve the data to first
+        CreateResolveTexture();
+
+        if (!impl_->resolveTexture_)
+        {
+            stagingTexture->Release();
+            source->Release();
+            return false;
+        }
+
+        impl_->deviceContext_->ResolveSubresource(impl_->resolveTexture_, 0, source, 0, DXGI_FORMAT_R8G8B8A8_UNORM);
+        impl_->deviceContext_->CopyResource(stagingTexture, impl_->resolveTexture_);
+    }
+    else
+        impl_->deviceContext_->CopyResource(stagingTexture, source);
+
+    source->Release();
+
+    readback->object_.ptr_ = stagingTexture;
+    return true;
+}
+
+bool Graphics::GetReadbackData(GPUReadback* readback)
+{
+    if (!readback->object_.ptr_)
+        return true;
+
+    auto* stagingTexture = (ID3D11Resource*)readback->object_.ptr_;
+    D3D11_MAPPED_SUBRESOURCE mappedData;
+    mappedData.pData = nullptr;
+    HRESULT hr = impl_->deviceContext_->Map(stagingTexture, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedData);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+        return false;
+    if (FAILED(hr) || !mappedData.pData)
+    {
+        URHO3D_LOGD3DERROR("Failed to map staging texture for readback", hr);
+        readback->failed_ = true;
+        return true;
+    }
+
+    readback->data_.Resize(readback->rowSize_ * readback->numRows_);
+    for (unsigned row = 0; row < readback->numRows_; ++row)
+    {
+        memcpy(&readback->data_[row * readback->rowSize_], (unsigned char*)mappedData.pData + row * mappedData.RowPitch,
+            readback->rowSize_);
+    }
+
+    impl_->deviceContext_->Unmap(stagingTexture, 0);
+    return true;
+}
+
+void Graphics::ReleaseReadbackObjects(GPUReadback* readback)
+{
+    URHO3D_SAFE_RELEASE(readback->object_.ptr_);
 }
 
 void Graphics::ResetCachedState()
@@ -2328,6 +2652,8 @@ void Graphics::ResetCachedState()
     {
         impl_->constantBuffers_[VS][i] = nullptr;
         impl_->constantBuffers_[PS][i] = nullptr;
+        impl_->boundConstantBuffers_[VS][i] = nullptr;
+        impl_->boundConstantBuffers_[PS][i] = nullptr;
     }
 
     depthStencil_ = nullptr;
@@ -2369,6 +2695,7 @@ void Graphics::ResetCachedState()
     impl_->rasterizerStateDirty_ = true;
     impl_->scissorRectDirty_ = true;
     impl_->stencilRefDirty_ = true;
+    impl_->constantBuffersDirty_ = false;
     impl_->blendStateHash_ = M_MAX_UNSIGNED;
     impl_->depthStateHash_ = M_MAX_UNSIGNED;
     impl_->rasterizerStateHash_ = M_MAX_UNSIGNED;
@@ -2607,6 +2934,23 @@ void Graphics::PrepareDraw()
         impl_->scissorRectDirty_ = false;
     }
 
+    // Constant buffers are bound only here, as a material's own buffers may replace the shader program's shared buffers after
+    // the shaders are set
+    if (impl_->constantBuffersDirty_)
+    {
+        if (memcmp(impl_->constantBuffers_[VS], impl_->boundConstantBuffers_[VS], sizeof impl_->constantBuffers_[VS]))
+        {
+            impl_->deviceContext_->VSSetConstantBuffers(0, MAX_SHADER_PARAMETER_GROUPS, &impl_->constantBuffers_[VS][0]);
+            memcpy(impl_->boundConstantBuffers_[VS], impl_->constantBuffers_[VS], sizeof impl_->constantBuffers_[VS]);
+        }
+        if (memcmp(impl_->constantBuffers_[PS], impl_->boundConstantBuffers_[PS], sizeof impl_->constantBuffers_[PS]))
+        {
+            impl_->deviceContext_->PSSetConstantBuffers(0, MAX_SHADER_PARAMETER_GROUPS, &impl_->constantBuffers_[PS][0]);
+            memcpy(impl_->boundConstantBuffers_[PS], impl_->constantBuffers_[PS], sizeof impl_->constantBuffers_[PS]);
+        }
+        impl_->constantBuffersDirty_ = false;
+    }
+
     for (unsigned i = 0; i < impl_->dirtyConstantBuffers_.Size(); ++i)
         impl_->dirtyConstantBuffers_[i]->Apply();
     impl_->dirtyConstantBuffers_.Clear();
@@ -39,6 +39,7 @@ GraphicsImpl::GraphicsImpl() :
     defaultDepthStencilView_(nullptr),
     depthStencilView_(nullptr),
     resolveTexture_(nullptr),
+    constantBuffersDirty_(false),
     shaderProgram_(nullptr)
 {
     for (unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
@@ -61,6 +62,15 @@ GraphicsImpl::GraphicsImpl() :
     {
         constantBuffers_[VS][i] = nullptr;
         constantBuffers_[PS][i] = nullptr;
+        boundConstantBuffers_[VS][i] = nullptr;
+        boundConstantBuffers_[PS][i] = nullptr;
+    }
+
+    for (unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+    {
+        disjointQueries_[i] = nullptr;
+        for (unsigned j = 0; j < MAX_GPU_TIMER_QUERIES; ++j)
+            timerQueries_[i][j] = nullptr;
     }
 }
 
@@ -97,8 +97,10 @@ private:
     ID3D11SamplerState* samplers_[MAX_TEXTURE_UNITS];
     /// Bound vertex buffers.
     ID3D11Buffer* vertexBuffers_[MAX_VERTEX_STREAMS];
-    /// Bound constant buffers.
+    /// Constant buffers to bind before the next draw call.
     ID3D11Buffer* constantBuffers_[2][MAX_SHADER_PARAMETER_GROUPS];
+    /// Bound constant buffers.
+    ID3D11Buffer* boundConstantBuffers_[2][MAX_SHADER_PARAMETER_GROUPS];
     /// Vertex sizes per buffer.
     unsigned vertexSizes_[MAX_VERTEX_STREAMS];
     /// Vertex stream offsets per buffer.
@@ -119,6 +121,8 @@ private:
     bool scissorRectDirty_;
     /// Stencil ref dirty flag.
     bool stencilRefDirty_;
+    /// Constant buffers dirty flag.
+    bool constantBuffersDirty_;
     /// Hash of current blend state.
     unsigned blendStateHash_;
     /// Hash of current depth state.
@@ -143,6 +147,10 @@ private:
     ShaderProgramMap shaderPrograms_;
     /// Shader program in use.
     ShaderProgram* shaderProgram_;
+    /// Timestamp disjoint queries per GPU timer frame.
+    ID3D11Query* disjointQueries_[GPU_TIMER_FRAMES];
+    /// Timestamp queries per GPU timer frame, created on first use.
+    ID3D11Query* timerQueries_[GPU_TIMER_FRAMES][MAX_GPU_TIMER_QUERIES];
 };
 
 }
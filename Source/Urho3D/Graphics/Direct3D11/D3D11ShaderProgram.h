@@ -70,6 +70,14 @@ public:
         // Optimize shader parameter lookup by rehashing to next power of two
         parameters_.Rehash(NextPowerOfTwo(parameters_.Size()));
 
+        // Hash the material parameter layouts, so that programs with the same layout share the material constant buffers
+        for (HashMap<StringHash, ShaderParameter>::ConstIterator i = parameters_.Begin(); i != parameters_.End(); ++i)
+        {
+            if (i->second_.buffer_ == SP_MATERIAL)
+                materialLayoutHashes_[i->second_.type_] += (i->first_.Value() + i->second_.offset_) * 2654435761u;
+        }
+        materialLayoutHashes_[VS] = materialLayoutHashes_[VS] * 31 + vsBufferSizes[SP_MATERIAL] * 2;
+        materialLayoutHashes_[PS] = materialLayoutHashes_[PS] * 31 + psBufferSizes[SP_MATERIAL] * 2 + 1;
     }
 
     /// Destruct.
@@ -83,6 +91,8 @@ public:
     SharedPtr<ConstantBuffer> vsConstantBuffers_[MAX_SHADER_PARAMETER_GROUPS];
     /// Pixel shader constant buffers.
     SharedPtr<ConstantBuffer> psConstantBuffers_[MAX_SHADER_PARAMETER_GROUPS];
+    /// Material parameter layout hashes of the vertex and pixel shader.
+    unsigned materialLayoutHashes_[2]{};
 };
 
 }
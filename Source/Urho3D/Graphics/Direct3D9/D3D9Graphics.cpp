@@ -265,7 +265,7 @@ Graphics::Graphics(Context* context) :
     context_->RequireSDL(SDL_INIT_VIDEO);
 
     // Register Graphics library object factories
-    RegisterGraphicsLibrary(context_);
+    context_->RegisterLibrary("Graphics", RegisterGraphicsLibrary);
 }
 
 Graphics::~Graphics()
@@ -284,6 +284,8 @@ Graphics::~Graphics()
     URHO3D_SAFE_RELEASE(impl_->defaultColorSurface_);
     URHO3D_SAFE_RELEASE(impl_->defaultDepthStencilSurface_);
     URHO3D_SAFE_RELEASE(impl_->frameQuery_);
+    ReleaseGPUTimers();
+    ReleaseReadbacks();
     URHO3D_SAFE_RELEASE(impl_->device_);
     URHO3D_SAFE_RELEASE(impl_->interface_);
 
@@ -732,6 +734,9 @@ bool Graphics::BeginFrame()
     numPrimitives_ = 0;
     numBatches_ = 0;
 
+    UpdateReadbacks();
+    BeginGPUTimerFrame();
+
     SendEvent(E_BEGINRENDERING);
 
     return true;
@@ -747,6 +752,8 @@ void Graphics::EndFrame()
 
         SendEvent(E_ENDRENDERING);
 
+        EndGPUTimerFrame();
+
         impl_->device_->EndScene();
         impl_->device_->Present(nullptr, nullptr, nullptr, nullptr);
     }
@@ -1023,6 +1030,11 @@ void Graphics::DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned i
     ++numBatches_;
 }
 
+void Graphics::MultiDrawInstanced(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands)
+{
+    MultiDrawInstancedFallback(type, commands);
+}
+
 void Graphics::SetVertexBuffer(VertexBuffer* buffer)
 {
     // Note: this is not multi-instance safe
@@ -1377,6 +1389,12 @@ bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* sourc
         return false;
 }
 
+bool Graphics::SetMaterialShaderParameters(Material* /*material*/)
+{
+    // No constant buffers, the parameters are set individually
+    return false;
+}
+
 bool Graphics::HasShaderParameter(StringHash param)
 {
     return impl_->shaderProgram_ && impl_->shaderProgram_->parameters_.Find(param) != impl_->shaderProgram_->parameters_.End();
@@ -1398,6 +1416,12 @@ void Graphics::ClearParameterSources()
         shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
 }
 
+void Graphics::ClearViewParameterSources()
+{
+    for (unsigned i = SP_CAMERA; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+        shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
+}
+
 void Graphics::ClearTransformSources()
 {
     shaderParameterSources_[SP_CAMERA] = (const void*)M_MAX_UNSIGNED;
@@ -1518,6 +1542,17 @@ void Graphics::SetDefaultTextureFilterMode(TextureFilterMode mode)
     defaultTextureFilterMode_ = mode;
 }
 
+bool Graphics::BeginBackgroundUpload()
+{
+    // Not supported on Direct3D9
+    return false;
+}
+
+void Graphics::EndBackgroundUpload()
+{
+    // No-op on Direct3D9
+}
+
 void Graphics::SetDefaultTextureAnisotropy(unsigned level)
 {
     defaultTextureAnisotropy_ = Max(level, 1U);
@@ -2501,6 +2536,22 @@ void Graphics::CheckFeatureSupport()
             deferredSupport_ = true;
     }
 
+    // Check for compressed vertex element types
+    compressedVertexSupport_ = 0;
+    const DWORD declTypes = impl_->deviceCaps_.DeclTypes;
+    if (declTypes & D3DDTCAPS_FLOAT16_2)
+        compressedVertexSupport_ |= 1u << TYPE_HALF2;
+    if (declTypes & D3DDTCAPS_FLOAT16_4)
+        compressedVertexSupport_ |= 1u << TYPE_HALF4;
+    if (declTypes & D3DDTCAPS_SHORT2N)
+        compressedVertexSupport_ |= 1u << TYPE_SHORT2_NORM;
+    if (declTypes & D3DDTCAPS_SHORT4N)
+        compressedVertexSupport_ |= 1u << TYPE_SHORT4_NORM;
+    if (declTypes & D3DDTCAPS_USHORT2N)
+        compressedVertexSupport_ |= 1u << TYPE_USHORT2_NORM;
+    if (declTypes & D3DDTCAPS_USHORT4N)
+        compressedVertexSupport_ |= 1u << TYPE_USHORT4_NORM;
+
     // Check for stream offset (needed for instancing)
     if (impl_->deviceCaps_.DevCaps2 & D3DDEVCAPS2_STREAMOFFSET)
         instancingSupport_ = true;
@@ -2509,6 +2560,11 @@ void Graphics::CheckFeatureSupport()
     /// \todo Should be checked for each texture format separately
     sRGBSupport_ = impl_->CheckFormatSupport(D3DFMT_X8R8G8B8, D3DUSAGE_QUERY_SRGBREAD, D3DRTYPE_TEXTURE);
     sRGBWriteSupport_ = impl_->CheckFormatSupport(D3DFMT_X8R8G8B8, D3DUSAGE_QUERY_SRGBWRITE, D3DRTYPE_TEXTURE);
+
+    // Check for timestamp queries (needed for GPU timing)
+    gpuTimingSupport_ = impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMP, nullptr) == D3D_OK &&
+        impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMPDISJOINT, nullptr) == D3D_OK &&
+        impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMPFREQ, nullptr) == D3D_OK;
 }
 
 void Graphics::ResetDevice()
@@ -2541,6 +2597,8 @@ void Graphics::OnDeviceLost()
         impl_->frameQuery_->Release();
         impl_->frameQuery_ = nullptr;
     }
+    ReleaseGPUTimers();
+    ReleaseReadbacks();
 
     {
         MutexLock lock(gpuObjectMutex_);
@@ -2573,6 +2631,104 @@ void Graphics::OnDeviceReset()
     SendEvent(E_DEVICERESET);
 }
 
+void Graphics::BeginTimerQueryFrame(unsigned frame)
+{
+    IDirect3DQuery9*& disjointQuery = impl_->disjointQueries_[frame];
+    if (!disjointQuery && impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMPDISJOINT, &disjointQuery) != D3D_OK)
+        return;
+    IDirect3DQuery9*& frequencyQuery = impl_->frequencyQueries_[frame];
+    if (!frequencyQuery && impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMPFREQ, &frequencyQuery) != D3D_OK)
+        return;
+
+    disjointQuery->Issue(D3DISSUE_BEGIN);
+}
+
+void Graphics::EndTimerQueryFrame(unsigned frame)
+{
+    if (impl_->frequencyQueries_[frame])
+        impl_->frequencyQueries_[frame]->Issue(D3DISSUE_END);
+    if (impl_->disjointQueries_[frame])
+        impl_->disjointQueries_[frame]->Issue(D3DISSUE_END);
+}
+
+void Graphics::IssueTimerQuery(unsigned frame, unsigned index)
+{
+    IDirect3DQuery9*& query = impl_->timerQueries_[frame][index];
+    if (!query && impl_->device_->CreateQuery(D3DQUERYTYPE_TIMESTAMP, &query) != D3D_OK)
+        return;
+
+    query->Issue(D3DISSUE_END);
+}
+
+bool Graphics::GetTimerQueryResults(unsigned frame, unsigned count, PODVector<long long>& dest)
+{
+    BOOL disjoint = FALSE;
+    UINT64 frequency = 0;
+    if (!impl_->disjointQueries_[frame] || !impl_->frequencyQueries_[frame] ||
+        impl_->disjointQueries_[frame]->GetData(&disjoint, sizeof disjoint, 0) != S_OK ||
+        impl_->frequencyQueries_[frame]->GetData(&frequency, sizeof frequency, 0) != S_OK)
+        return false;
+
+    dest.Resize(count);
+    UINT64 firstTime = 0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        UINT64 time = 0;
+        if (impl_->timerQueries_[frame][i] && impl_->timerQueries_[frame][i]->GetData(&time, sizeof time, 0) != S_OK)
+            return false;
+        if (!i)
+            firstTime = time;
+        // Convert ticks to microseconds relative to the frame start so that the product does not overflow
+        dest[i] = (disjoint || !frequency) ? 0 : (long long)((time - firstTime) * 1000000 / frequency);
+    }
+
+    return true;
+}
+
+void Graphics::ReleaseTimerQueries()
+{
+    for (unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+    {
+        URHO3D_SAFE_RELEASE(impl_->disjointQueries_[i]);
+        URHO3D_SAFE_RELEASE(impl_->frequencyQueries_[i]);
+        for (unsigned j = 0; j < MAX_GPU_TIMER_QUERIES; ++j)
+        {
+            URHO3D_SAFE_RELEASE(impl_->timerQueries_[i][j]);
+        }
+    }
+}
+
+bool Graphics::IssueTextureReadback(GPUReadback* readback, Texture2D* texture, unsigned level)
+{
+    // No asynchronous copy is available, so read the data immediately
+    readback->data_.Resize(readback->rowSize_ * readback->numRows_);
+    return texture->GetData(level, readback->data_.Buffer());
+}
+
+bool Graphics::IssueScreenReadback(GPUReadback* readback)
+{
+    SharedPtr<Image> image(new Image(context_));
+    if (!TakeScreenShot(*image))
+        return false;
+
+    SharedPtr<Image> rgbaImage = image->ConvertToRGBA();
+    if (!rgbaImage)
+        return false;
+
+    readback->data_.Resize(readback->rowSize_ * readback->numRows_);
+    memcpy(readback->data_.Buffer(), rgbaImage->GetData(), readback->data_.Size());
+    return true;
+}
+
+bool Graphics::GetReadbackData(GPUReadback* readback)
+{
+    return true;
+}
+
+void Graphics::ReleaseReadbackObjects(GPUReadback* readback)
+{
+}
+
 void Graphics::ResetCachedState()
 {
     for (unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
@@ -43,6 +43,9 @@ GraphicsImpl::GraphicsImpl() :
     queryIssued_(false)
 {
     memset(&presentParams_, 0, sizeof presentParams_);
+    memset(disjointQueries_, 0, sizeof disjointQueries_);
+    memset(frequencyQueries_, 0, sizeof frequencyQueries_);
+    memset(timerQueries_, 0, sizeof timerQueries_);
 }
 
 bool GraphicsImpl::CheckFormatSupport(D3DFORMAT format, DWORD usage, D3DRESOURCETYPE type)
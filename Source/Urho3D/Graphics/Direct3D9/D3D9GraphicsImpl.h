@@ -131,6 +131,12 @@ private:
     ShaderProgramMap shaderPrograms_;
     /// Shader program in use.
     ShaderProgram* shaderProgram_;
+    /// Timestamp disjoint queries per GPU timer frame.
+    IDirect3DQuery9* disjointQueries_[GPU_TIMER_FRAMES];
+    /// Timestamp frequency queries per GPU timer frame.
+    IDirect3DQuery9* frequencyQueries_[GPU_TIMER_FRAMES];
+    /// Timestamp queries per GPU timer frame, created on first use.
+    IDirect3DQuery9* timerQueries_[GPU_TIMER_FRAMES][MAX_GPU_TIMER_QUERIES];
 
 };
 
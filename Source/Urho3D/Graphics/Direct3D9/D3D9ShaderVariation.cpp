@@ -76,33 +76,19 @@ void ShaderVariation::OnDeviceLost()
 
 bool ShaderVariation::Create()
 {
-    Release();
+    MutexLock lock(prepareMutex_);
 
-    if (!graphics_)
-        return false;
-
-    if (!owner_)
+    // Use the bytecode if already prepared in a worker thread, otherwise load or compile it now
+    if (!prepared_)
     {
-        compilerOutput_ = "Owner shader has expired";
-        return false;
-    }
-
-    // Check for up-to-date bytecode on disk
-    String path, name, extension;
-    SplitPath(owner_->GetName(), path, name, extension);
-    extension = type_ == VS ? ".vs3" : ".ps3";
-
-    String binaryShaderName = graphics_->GetShaderCacheDir() + name + "_" + StringHash(defines_).ToString() + extension;
-
-    if (!LoadByteCode(binaryShaderName))
-    {
-        // Compile shader if don't have valid bytecode
-        if (!Compile())
+        Release();
+        if (!PrepareByteCode())
             return false;
-        // Save the bytecode after successful compile, but not if the source is from a package
-        if (owner_->GetTimeStamp())
-            SaveByteCode(binaryShaderName);
     }
+    prepared_ = false;
+
+    if (!graphics_)
+        return false;
 
     // Then create shader from the bytecode
     IDirect3DDevice9* device = graphics_->GetImpl()->GetDevice();
@@ -136,8 +122,52 @@ bool ShaderVariation::Create()
     return object_.ptr_ != nullptr;
 }
 
+bool ShaderVariation::Prepare()
+{
+    MutexLock lock(prepareMutex_);
+
+    if (prepared_ || object_.ptr_)
+        return true;
+
+    return PrepareByteCode();
+}
+
+bool ShaderVariation::PrepareByteCode()
+{
+    if (!graphics_)
+        return false;
+
+    if (!owner_)
+    {
+        compilerOutput_ = "Owner shader has expired";
+        return false;
+    }
+
+    // Check for up-to-date bytecode on disk
+    String path, name, extension;
+    SplitPath(owner_->GetName(), path, name, extension);
+    extension = type_ == VS ? ".vs3" : ".ps3";
+
+    String binaryShaderName = graphics_->GetShaderCacheDir() + name + "_" + StringHash(defines_).ToString() + extension;
+
+    if (!LoadByteCode(binaryShaderName))
+    {
+        // Compile shader if don't have valid bytecode
+        if (!Compile())
+            return false;
+        // Save the bytecode after successful compile, but not if the source is from a package
+        if (owner_->GetTimeStamp())
+            SaveByteCode(binaryShaderName);
+    }
+
+    prepared_ = true;
+    return true;
+}
+
 void ShaderVariation::Release()
 {
+    MutexLock lock(prepareMutex_);
+
     if (object_.ptr_ && graphics_)
     {
         graphics_->CleanupShaderPrograms(this);
@@ -161,6 +191,8 @@ void ShaderVariation::Release()
     for (unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
         useTextureUnits_[i] = false;
     parameters_.Clear();
+    byteCode_.Clear();
+    prepared_ = false;
 }
 
 void ShaderVariation::SetDefines(const String& defines)
@@ -230,7 +230,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         unsigned format = 0;
 
         // Discard unnecessary mip levels
-        for (unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+        for (unsigned i = 0; i < mipsToSkip_[quality] + streamingMipsToSkip_; ++i)
         {
             mipImage = image->GetNextLevel(); image = mipImage;
             levelData = image->GetData();
@@ -294,7 +294,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             needDecompress = true;
         }
 
-        unsigned mipsToSkip = mipsToSkip_[quality];
+        unsigned mipsToSkip = mipsToSkip_[quality] + streamingMipsToSkip_;
         if (mipsToSkip >= levels)
             mipsToSkip = levels - 1;
         while (mipsToSkip && (width / (1 << mipsToSkip) < 4 || height / (1 << mipsToSkip) < 4))
@@ -305,21 +305,30 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         SetNumLevels(Max((levels - mipsToSkip), 1U));
         SetSize(width, height, format);
 
+        // Decompress all the used levels at once, so that large levels can be decompressed in the worker threads
+        SharedPtr<Image> decompressed;
+        PODVector<Image*> decompressedLevels;
+        if (needDecompress)
+        {
+            decompressed = image->GetDecompressedImage(mipsToSkip);
+            if (!decompressed)
+                return false;
+            decompressed->GetLevels(decompressedLevels);
+        }
+
         for (unsigned i = 0; i < levels_ && i < levels - mipsToSkip; ++i)
         {
-            CompressedLevel level = image->GetCompressedLevel(i + mipsToSkip);
             if (!needDecompress)
             {
+                CompressedLevel level = image->GetCompressedLevel(i + mipsToSkip);
                 SetData(i, 0, 0, level.width_, level.height_, level.data_);
                 memoryUse += level.rows_ * level.rowSize_;
             }
             else
             {
-                unsigned char* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
-                level.Decompress(rgbaData);
-                SetData(i, 0, 0, level.width_, level.height_, rgbaData);
-                memoryUse += level.width_ * level.height_ * 4;
-                delete[] rgbaData;
+                Image* level = decompressedLevels[i];
+                SetData(i, 0, 0, level->GetWidth(), level->GetHeight(), level->GetData());
+                memoryUse += level->GetWidth() * level->GetHeight() * 4;
             }
         }
     }
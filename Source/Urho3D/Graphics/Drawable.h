@@ -45,11 +45,13 @@ static const float ANIMATION_LOD_BASESCALE = 2500.0f;
 class Camera;
 class File;
 class Geometry;
+class HLODGroup;
 class Light;
 class Material;
 class OcclusionBuffer;
 class Octant;
 class RayOctreeQuery;
+class VertexBuffer;
 class Zone;
 struct RayQueryResult;
 struct WorkItem;
@@ -100,6 +102,8 @@ struct URHO3D_API SourceBatch
     unsigned numWorldTransforms_{1};
     /// Per-instance data. If not null, must contain enough data to fill instancing buffer.
     void* instancingData_{};
+    /// Persistent instancing buffer which already holds the world transforms. If not null, the batch is drawn instanced from it instead of the renderer's shared instancing buffer.
+    VertexBuffer* instancingBuffer_{};
     /// %Geometry type.
     GeometryType geometryType_{GEOM_STATIC};
 };
@@ -131,6 +135,8 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering.
     virtual void UpdateGeometry(const FrameInfo& frame) { }
+    /// Finish a geometry update that was made in a worker thread, for example by uploading the vertex data it wrote. Called from the main thread.
+    virtual void FinishUpdateGeometry() { }
 
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType() { return UPDATE_NONE; }
@@ -225,6 +231,8 @@ public:
     void SetZone(Zone* zone, bool temporary = false);
     /// Set sorting value.
     void SetSortValue(float value);
+    /// Set hierarchical LOD group. Called by HLODGroup.
+    void SetHLODGroup(HLODGroup* group) { hlodGroup_ = group; }
 
     /// Set view-space depth bounds.
     void SetMinMaxZ(float minZ, float maxZ)
@@ -278,6 +286,12 @@ public:
     /// Return the first added per-pixel light.
     Light* GetFirstLight() const { return firstLight_; }
 
+    /// Return the frame number on which the drawable was last updated in the octree due to moving or animating.
+    unsigned GetUpdateFrameNumber() const { return updateFrameNumber_; }
+
+    /// Return hierarchical LOD group which replaces this drawable with its proxy at a distance. A group returns itself.
+    HLODGroup* GetHLODGroup() const { return hlodGroup_; }
+
     /// Return the minimum view-space depth.
     float GetMinZ() const { return minZ_; }
 
@@ -345,8 +359,12 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in the octant's drawable list.
+    unsigned octantIndex_;
     /// Current zone.
     Zone* zone_;
+    /// Hierarchical LOD group.
+    HLODGroup* hlodGroup_;
     /// View mask.
     unsigned viewMask_;
     /// Light mask.
@@ -357,6 +375,8 @@ protected:
     unsigned zoneMask_;
     /// Last visible frame number.
     unsigned viewFrameNumber_;
+    /// Last octree update frame number.
+    unsigned updateFrameNumber_;
     /// Current distance to camera.
     float distance_;
     /// LOD scaled distance.
@@ -65,4 +65,27 @@ URHO3D_EVENT(E_TERRAINCREATED, TerrainCreated)
     URHO3D_PARAM(P_NODE, Node);                    // Node pointer
 }
 
+/// Terrain height data changed in a region without recreating the terrain.
+URHO3D_EVENT(E_TERRAINREGIONUPDATED, TerrainRegionUpdated)
+{
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+    URHO3D_PARAM(P_REGION, Region);                // IntRect, height data vertex coordinates, inclusive
+}
+
+/// Streamed terrain tile created and linked to its neighbors. Sent from the TerrainStreamer node.
+URHO3D_EVENT(E_TERRAINTILELOADED, TerrainTileLoaded)
+{
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+    URHO3D_PARAM(P_TILE, Tile);                    // IntVector2
+    URHO3D_PARAM(P_TERRAIN, Terrain);              // Terrain pointer
+}
+
+/// Streamed terrain tile about to be removed. Sent from the TerrainStreamer node.
+URHO3D_EVENT(E_TERRAINTILEUNLOADED, TerrainTileUnloaded)
+{
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+    URHO3D_PARAM(P_TILE, Tile);                    // IntVector2
+    URHO3D_PARAM(P_TERRAIN, Terrain);              // Terrain pointer
+}
+
 }
@@ -0,0 +1,521 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/DrawableEvents.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/GPUParticleEmitter.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/IndexBuffer.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/ParticleEffect.h"
+#include "../Graphics/Technique.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/Node.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+extern const char* autoRemoveModeNames[];
+
+/// Emitter time after which it is wrapped by whole emission cycles to keep the shader calculations precise.
+static const float TIME_WRAP_THRESHOLD = 1024.0f;
+static const float SQRT_TWO = sqrtf(2.0f);
+
+static const String GPU_PARTICLE_SHADER("GPUParticle");
+static const String PARAM_TIME("GPUParticleTime");
+static const String PARAM_FORCE("GPUParticleForce");
+static const String PARAM_SIZE("GPUParticleSize");
+static const String PARAM_UV("GPUParticleUV");
+static const String PARAM_COLORS("GPUParticleColors");
+static const String PARAM_COLOR_TIMES("GPUParticleColorTimes");
+
+static const unsigned GPU_PARTICLE_VERTEX_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TEXCOORD2 | MASK_TANGENT;
+
+static const float cornerCoords[4][2] = {
+    { -1.0f, 1.0f },
+    { 1.0f, 1.0f },
+    { 1.0f, -1.0f },
+    { -1.0f, -1.0f }
+};
+
+static float GetSizeScale(float sizeAdd, float sizeMul, float time)
+{
+    // Closed form of the per-frame size update done by ParticleEmitter: the scale grows by sizeAdd and sizeMul - 1 times itself per second
+    float k = sizeMul - 1.0f;
+    float scale;
+    if (Abs(k) < M_EPSILON)
+        scale = 1.0f + sizeAdd * time;
+    else
+        scale = (1.0f + sizeAdd / k) * expf(k * time) - sizeAdd / k;
+    return Max(scale, 0.0f);
+}
+
+GPUParticleEmitter::GPUParticleEmitter(Context* context) :
+    Drawable(context, DRAWABLE_GEOMETRY),
+    geometry_(new Geometry(context)),
+    vertexBuffer_(new VertexBuffer(context_)),
+    indexBuffer_(new IndexBuffer(context_)),
+    numParticles_(0),
+    cycleTime_(1.0f),
+    time_(0.0f),
+    emitStartTime_(0.0f),
+    emitEndTime_(M_LARGE_VALUE),
+    periodTimer_(0.0f),
+    emitting_(true),
+    sendFinishedEvent_(true),
+    autoRemove_(REMOVE_DISABLED)
+{
+    // Keep shadow copies of the static particle data so that it survives device loss without needing to be regenerated
+    vertexBuffer_->SetShadowed(true);
+    indexBuffer_->SetShadowed(true);
+    geometry_->SetVertexBuffer(0, vertexBuffer_);
+    geometry_->SetIndexBuffer(indexBuffer_);
+
+    // Billboard geometry type makes the camera rotation available to the vertex shader
+    batches_.Resize(1);
+    batches_[0].geometry_ = geometry_;
+    batches_[0].geometryType_ = GEOM_BILLBOARD;
+}
+
+GPUParticleEmitter::~GPUParticleEmitter() = default;
+
+void GPUParticleEmitter::RegisterObject(Context* context)
+{
+    context->RegisterFactory<GPUParticleEmitter>(GEOMETRY_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Effect", GetEffectAttr, SetEffectAttr, ResourceRef, ResourceRef(ParticleEffect::GetTypeStatic()),
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Emitting", IsEmitting, SetEmitting, bool, true, AM_FILE);
+    URHO3D_ATTRIBUTE("Period Timer", float, periodTimer_, 0.0f, AM_FILE | AM_NOEDIT);
+    URHO3D_ENUM_ATTRIBUTE("Autoremove Mode", autoRemove_, autoRemoveModeNames, REMOVE_DISABLED, AM_DEFAULT);
+    URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
+}
+
+void GPUParticleEmitter::OnSetEnabled()
+{
+    Drawable::OnSetEnabled();
+
+    Scene* scene = GetScene();
+    if (scene)
+    {
+        if (IsEnabledEffective())
+            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(GPUParticleEmitter, HandleScenePostUpdate));
+        else
+            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+    }
+}
+
+void GPUParticleEmitter::SetEffect(ParticleEffect* effect)
+{
+    if (effect == effect_)
+        return;
+
+    // Unsubscribe from the reload event of previous effect (if any), then subscribe to the new
+    if (effect_)
+        UnsubscribeFromEvent(effect_, E_RELOADFINISHED);
+
+    effect_ = effect;
+
+    if (effect_)
+        SubscribeToEvent(effect_, E_RELOADFINISHED, URHO3D_HANDLER(GPUParticleEmitter, HandleEffectReloadFinished));
+
+    Reset();
+    ApplyEffect();
+    MarkNetworkUpdate();
+}
+
+void GPUParticleEmitter::SetEmitting(bool enable)
+{
+    if (enable != emitting_)
+    {
+        emitting_ = enable;
+        sendFinishedEvent_ = enable;
+        periodTimer_ = 0.0f;
+
+        if (enable)
+        {
+            emitStartTime_ = time_;
+            emitEndTime_ = M_LARGE_VALUE;
+        }
+        else
+            emitEndTime_ = time_;
+
+        UpdateShaderParameters();
+        MarkNetworkUpdate();
+    }
+}
+
+void GPUParticleEmitter::SetAutoRemoveMode(AutoRemoveMode mode)
+{
+    autoRemove_ = mode;
+    MarkNetworkUpdate();
+}
+
+void GPUParticleEmitter::Reset()
+{
+    time_ = 0.0f;
+    emitStartTime_ = 0.0f;
+    emitEndTime_ = M_LARGE_VALUE;
+    periodTimer_ = 0.0f;
+    emitting_ = true;
+    sendFinishedEvent_ = true;
+
+    UpdateShaderParameters();
+}
+
+void GPUParticleEmitter::ApplyEffect()
+{
+    CreateGeometry();
+    CreateMaterial();
+    UpdateShaderParameters();
+
+    OnMarkedDirty(node_);
+}
+
+ParticleEffect* GPUParticleEmitter::GetEffect() const
+{
+    return effect_;
+}
+
+void GPUParticleEmitter::SetEffectAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetEffect(cache->GetResource<ParticleEffect>(value.name_));
+}
+
+ResourceRef GPUParticleEmitter::GetEffectAttr() const
+{
+    return GetResourceRef(effect_, ParticleEffect::GetTypeStatic());
+}
+
+void GPUParticleEmitter::OnSceneSet(Scene* scene)
+{
+    Drawable::OnSceneSet(scene);
+
+    if (scene && IsEnabledEffective())
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(GPUParticleEmitter, HandleScenePostUpdate));
+    else if (!scene)
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+}
+
+void GPUParticleEmitter::OnWorldBoundingBoxUpdate()
+{
+    worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform());
+}
+
+void GPUParticleEmitter::CreateGeometry()
+{
+    numParticles_ = 0;
+    boundingBox_ = BoundingBox(Vector3::ZERO, Vector3::ZERO);
+    geometry_->SetDrawRange(TRIANGLE_LIST, 0, 0, false);
+
+    // In headless mode the particles would never be drawn
+    if (!effect_ || !GetSubsystem<Graphics>())
+        return;
+
+    float maxTimeToLive = Max(effect_->GetMaxTimeToLive(), M_EPSILON);
+    float emissionRate = Max(0.5f * (effect_->GetMinEmissionRate() + effect_->GetMaxEmissionRate()), M_EPSILON);
+
+    // Each particle is emitted once per cycle at a fixed offset within it. Do not create more particles than can be alive at once.
+    // If the particles run out before the oldest die, the cycle is lengthened to the maximum lifetime, which limits the emission
+    // rate the same way as running out of free particles does on the CPU
+    numParticles_ = Min(effect_->GetNumParticles(), (unsigned)CeilToInt(emissionRate * maxTimeToLive));
+    if (!numParticles_)
+        return;
+    cycleTime_ = Max((float)numParticles_ / emissionRate, maxTimeToLive);
+
+    unsigned numVertices = numParticles_ * 4;
+    bool largeIndices = numVertices > 0x10000;
+    vertexBuffer_->SetSize(numVertices, GPU_PARTICLE_VERTEX_MASK);
+    indexBuffer_->SetSize(numParticles_ * 6, largeIndices);
+
+    auto* vertices = static_cast<float*>(vertexBuffer_->Lock(0, numVertices, true));
+    void* indices = indexBuffer_->Lock(0, numParticles_ * 6, true);
+    if (!vertices || !indices)
+    {
+        vertexBuffer_->Unlock();
+        indexBuffer_->Unlock();
+        numParticles_ = 0;
+        return;
+    }
+
+    for (unsigned i = 0; i < numParticles_; ++i)
+    {
+        Vector3 startPos = effect_->GetRandomPosition();
+        Vector3 velocity = effect_->GetRandomDirection().Normalized() * effect_->GetRandomVelocity();
+        Vector2 size = effect_->GetRandomSize();
+        float emitOffset = (float)i * cycleTime_ / (float)numParticles_;
+        float timeToLive = effect_->GetRandomTimeToLive();
+        float rotation = effect_->GetRandomRotation();
+        float rotationSpeed = effect_->GetRandomRotationSpeed();
+
+        // All four corners share the particle data, only the corner coordinates differ
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            vertices[0] = startPos.x_;
+            vertices[1] = startPos.y_;
+            vertices[2] = startPos.z_;
+            vertices[3] = velocity.x_;
+            vertices[4] = velocity.y_;
+            vertices[5] = velocity.z_;
+            vertices[6] = cornerCoords[j][0];
+            vertices[7] = cornerCoords[j][1];
+            vertices[8] = emitOffset;
+            vertices[9] = timeToLive;
+            vertices[10] = size.x_;
+            vertices[11] = size.y_;
+            vertices[12] = rotation;
+            vertices[13] = rotationSpeed;
+            vertices += 14;
+        }
+
+        unsigned vertexIndex = i * 4;
+        if (largeIndices)
+        {
+            auto* dest = static_cast<unsigned*>(indices) + i * 6;
+            dest[0] = vertexIndex;
+            dest[1] = vertexIndex + 1;
+            dest[2] = vertexIndex + 2;
+            dest[3] = vertexIndex + 2;
+            dest[4] = vertexIndex + 3;
+            dest[5] = vertexIndex;
+        }
+        else
+        {
+            auto* dest = static_cast<unsigned short*>(indices) + i * 6;
+            dest[0] = (unsigned short)vertexIndex;
+            dest[1] = (unsigned short)(vertexIndex + 1);
+            dest[2] = (unsigned short)(vertexIndex + 2);
+            dest[3] = (unsigned short)(vertexIndex + 2);
+            dest[4] = (unsigned short)(vertexIndex + 3);
+            dest[5] = (unsigned short)vertexIndex;
+        }
+    }
+
+    vertexBuffer_->Unlock();
+    indexBuffer_->Unlock();
+    geometry_->SetDrawRange(TRIANGLE_LIST, 0, numParticles_ * 6, false);
+
+    // Conservative bounds: the emitter shape expanded by the furthest distance a particle can travel during its lifetime, and the
+    // largest particle size. Damping only shortens the distance
+    float maxVelocity = Max(Abs(effect_->GetMinVelocity()), Abs(effect_->GetMaxVelocity()));
+    float maxDistance = maxVelocity * maxTimeToLive + 0.5f * effect_->GetConstantForce().Length() * maxTimeToLive * maxTimeToLive;
+    float maxScale = Max(GetSizeScale(effect_->GetSizeAdd(), effect_->GetSizeMul(), maxTimeToLive), 1.0f);
+    const Vector2& maxSize = effect_->GetMaxParticleSize();
+    float maxRadius = SQRT_TWO * Max(maxSize.x_, maxSize.y_) * maxScale;
+    Vector3 halfSize = effect_->GetEmitterSize() * 0.5f + Vector3::ONE * (maxDistance + maxRadius);
+    boundingBox_ = BoundingBox(-halfSize, halfSize);
+}
+
+void GPUParticleEmitter::CreateMaterial()
+{
+    Material* effectMaterial = effect_ ? effect_->GetMaterial() : nullptr;
+    if (!effectMaterial || !GetSubsystem<Graphics>())
+    {
+        material_.Reset();
+        batches_[0].material_.Reset();
+        return;
+    }
+
+    // Clone the material so that the emitter can have its own shader parameters, and its techniques to replace the particle shaders
+    material_ = effectMaterial->Clone();
+    const Vector<TechniqueEntry>& techniques = effectMaterial->GetTechniques();
+    for (unsigned i = 0; i < techniques.Size(); ++i)
+    {
+        const TechniqueEntry& entry = techniques[i];
+        if (!entry.technique_)
+            continue;
+
+        SharedPtr<Technique> technique = entry.technique_->Clone();
+        PODVector<Pass*> passes = technique->GetPasses();
+        for (unsigned j = 0; j < passes.Size(); ++j)
+        {
+            Pass* pass = passes[j];
+            // The GPU particle shaders are unlit, so per-pixel lit passes are removed
+            if (pass->GetLightingMode() == LIGHTING_PERPIXEL)
+                technique->RemovePass(pass->GetName());
+            else
+            {
+                pass->SetVertexShader(GPU_PARTICLE_SHADER);
+                pass->SetPixelShader(GPU_PARTICLE_SHADER);
+            }
+        }
+
+        material_->SetTechnique(i, technique, entry.qualityLevel_, entry.lodDistance_);
+    }
+
+    // Size change parameters and the first texture frame
+    material_->SetShaderParameter(PARAM_SIZE, Vector4(effect_->GetSizeAdd(), effect_->GetSizeMul() - 1.0f, 0.0f, 0.0f));
+    const TextureFrame* textureFrame = effect_->GetTextureFrame(0);
+    const Rect& uv = textureFrame ? textureFrame->uv_ : Rect::POSITIVE;
+    material_->SetShaderParameter(PARAM_UV, Vector4(uv.min_.x_, uv.min_.y_, uv.max_.x_, uv.max_.y_));
+
+    // Color frames are padded to the maximum count by repeating the last frame
+    const Vector<ColorFrame>& colorFrames = effect_->GetColorFrames();
+    float colors[MAX_GPU_PARTICLE_COLOR_FRAMES * 4];
+    float colorTimes[MAX_GPU_PARTICLE_COLOR_FRAMES];
+    for (unsigned i = 0; i < MAX_GPU_PARTICLE_COLOR_FRAMES; ++i)
+    {
+        ColorFrame frame;
+        if (!colorFrames.Empty())
+            frame = colorFrames[Min(i, colorFrames.Size() - 1)];
+        colors[i * 4] = frame.color_.r_;
+        colors[i * 4 + 1] = frame.color_.g_;
+        colors[i * 4 + 2] = frame.color_.b_;
+        colors[i * 4 + 3] = frame.color_.a_;
+        colorTimes[i] = frame.time_;
+    }
+
+    PODVector<unsigned char> colorData(sizeof colors);
+    memcpy(&colorData[0], colors, sizeof colors);
+    material_->SetShaderParameter(PARAM_COLORS, Variant(colorData));
+    PODVector<unsigned char> colorTimeData(sizeof colorTimes);
+    memcpy(&colorTimeData[0], colorTimes, sizeof colorTimes);
+    material_->SetShaderParameter(PARAM_COLOR_TIMES, Variant(colorTimeData));
+
+    batches_[0].material_ = material_;
+}
+
+void GPUParticleEmitter::UpdateShaderParameters()
+{
+    if (!material_ || !effect_)
+        return;
+
+    // The particles are simulated in the emitter's local space, so bring the constant force there
+    Vector3 constantForce = effect_->GetConstantForce();
+    float sizeScale = 1.0f;
+    if (node_)
+    {
+        constantForce = node_->GetWorldRotation().Inverse() * constantForce;
+        if (effect_->IsScaled())
+        {
+            Vector3 worldScale = node_->GetWorldScale();
+            sizeScale = 0.5f * (worldScale.x_ + worldScale.y_);
+        }
+    }
+
+    material_->SetShaderParameter(PARAM_TIME, Vector4(time_, cycleTime_, emitStartTime_, emitEndTime_));
+    material_->SetShaderParameter(PARAM_FORCE, Vector4(constantForce, effect_->GetDampingForce()));
+    material_->SetShaderParameter(PARAM_SIZE, Vector4(effect_->GetSizeAdd(), effect_->GetSizeMul() - 1.0f, sizeScale, 0.0f));
+}
+
+bool GPUParticleEmitter::CheckActiveParticles() const
+{
+    return emitting_ || (effect_ && time_ - emitEndTime_ < effect_->GetMaxTimeToLive());
+}
+
+void GPUParticleEmitter::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // Use scene's timestep instead of global timestep, as time scale may be other than 1
+    using namespace ScenePostUpdate;
+
+    if (!effect_)
+        return;
+
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    time_ += timeStep;
+
+    // Check active/inactive period switching
+    periodTimer_ += timeStep;
+    if (emitting_)
+    {
+        float activeTime = effect_->GetActiveTime();
+        if (activeTime && periodTimer_ >= activeTime)
+        {
+            emitting_ = false;
+            emitEndTime_ = time_;
+            periodTimer_ -= activeTime;
+        }
+    }
+    else
+    {
+        float inactiveTime = effect_->GetInactiveTime();
+        if (inactiveTime && periodTimer_ >= inactiveTime)
+        {
+            emitting_ = true;
+            sendFinishedEvent_ = true;
+            emitStartTime_ = time_;
+            emitEndTime_ = M_LARGE_VALUE;
+            periodTimer_ -= inactiveTime;
+        }
+        // If emitter has an indefinite stop interval, keep period timer reset to allow restarting emission in the editor
+        if (inactiveTime == 0.0f)
+            periodTimer_ = 0.0f;
+    }
+
+    // Shifting all times by whole cycles does not change which particles are visible or their ages. The emission start and end
+    // can be clamped once they are further in the past than any particle could have been emitted
+    if (time_ >= TIME_WRAP_THRESHOLD)
+    {
+        float wrap = floorf(time_ / cycleTime_) * cycleTime_;
+        time_ -= wrap;
+        emitStartTime_ = Max(emitStartTime_ - wrap, -2.0f * cycleTime_);
+        if (!emitting_)
+            emitEndTime_ = Max(emitEndTime_ - wrap, -2.0f * cycleTime_ - effect_->GetMaxTimeToLive());
+    }
+
+    UpdateShaderParameters();
+
+    // Send finished event only once all particles are gone
+    if (node_ && !emitting_ && sendFinishedEvent_ && !CheckActiveParticles())
+    {
+        sendFinishedEvent_ = false;
+
+        // Make a weak pointer to self to check for destruction during event handling
+        WeakPtr<GPUParticleEmitter> self(this);
+
+        using namespace ParticleEffectFinished;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_EFFECT] = effect_;
+
+        node_->SendEvent(E_PARTICLEEFFECTFINISHED, eventData);
+
+        if (self.Expired())
+            return;
+
+        DoAutoRemove(autoRemove_);
+    }
+}
+
+void GPUParticleEmitter::HandleEffectReloadFinished(StringHash eventType, VariantMap& eventData)
+{
+    // When particle effect file is live-edited, restart the emission with the new effect parameters
+    Reset();
+    ApplyEffect();
+}
+
+}
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Graphics/Drawable.h"
+
+namespace Urho3D
+{
+
+class IndexBuffer;
+class ParticleEffect;
+class VertexBuffer;
+
+/// Maximum number of color animation frames used by the GPU particle shader.
+static const unsigned MAX_GPU_PARTICLE_COLOR_FRAMES = 8;
+
+/// %Particle emitter component which simulates the particles entirely on the GPU. Uses the same ParticleEffect definitions as ParticleEmitter.
+class URHO3D_API GPUParticleEmitter : public Drawable
+{
+    URHO3D_OBJECT(GPUParticleEmitter, Drawable);
+
+public:
+    /// Construct.
+    explicit GPUParticleEmitter(Context* context);
+    /// Destruct.
+    ~GPUParticleEmitter() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Handle enabled/disabled state change.
+    void OnSetEnabled() override;
+
+    /// Set particle effect.
+    void SetEffect(ParticleEffect* effect);
+    /// Set whether should be emitting. If the state was changed, also resets the emission period timer.
+    void SetEmitting(bool enable);
+    /// Set to remove either the emitter component or its owner node from the scene automatically on particle effect completion. Disabled by default.
+    void SetAutoRemoveMode(AutoRemoveMode mode);
+    /// Reset the particle emitter completely. Removes current particles, sets emitting state on, and resets the emission timer.
+    void Reset();
+    /// Apply the particle effect: recreate the particle vertex data and shader parameters. Call this if you change the effect programmatically.
+    void ApplyEffect();
+
+    /// Return particle effect.
+    ParticleEffect* GetEffect() const;
+    /// Return number of particles in the vertex data.
+    unsigned GetNumParticles() const { return numParticles_; }
+    /// Return whether is currently emitting.
+    bool IsEmitting() const { return emitting_; }
+    /// Return automatic removal mode on particle effect completion.
+    AutoRemoveMode GetAutoRemoveMode() const { return autoRemove_; }
+
+    /// Set particle effect attribute.
+    void SetEffectAttr(const ResourceRef& value);
+    /// Return particle effect attribute.
+    ResourceRef GetEffectAttr() const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    /// Create the particle vertex and index data from the effect.
+    void CreateGeometry();
+    /// Create the material which replaces the effect material's shaders with the GPU particle shaders.
+    void CreateMaterial();
+    /// Update the shader parameters which change during the emission.
+    void UpdateShaderParameters();
+    /// Return whether particles emitted before emission stopped are still alive.
+    bool CheckActiveParticles() const;
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle live reload of the particle effect.
+    void HandleEffectReloadFinished(StringHash eventType, VariantMap& eventData);
+
+    /// Particle effect.
+    SharedPtr<ParticleEffect> effect_;
+    /// Geometry.
+    SharedPtr<Geometry> geometry_;
+    /// Vertex buffer.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Index buffer.
+    SharedPtr<IndexBuffer> indexBuffer_;
+    /// Material with the GPU particle shaders.
+    SharedPtr<Material> material_;
+    /// Number of particles in the vertex data.
+    unsigned numParticles_;
+    /// Emission cycle length, after which each particle is emitted again.
+    float cycleTime_;
+    /// Emitter time.
+    float time_;
+    /// Emitter time when emission started.
+    float emitStartTime_;
+    /// Emitter time when emission stopped.
+    float emitEndTime_;
+    /// Active/inactive period timer.
+    float periodTimer_;
+    /// Currently emitting flag.
+    bool emitting_;
+    /// Ready to send effect finish event flag.
+    bool sendFinishedEvent_;
+    /// Automatic removal mode.
+    AutoRemoveMode autoRemove_;
+};
+
+}
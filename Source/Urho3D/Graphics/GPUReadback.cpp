@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Graphics/GPUReadback.h"
+#include "../Graphics/Graphics.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+GPUReadback::GPUReadback(int width, int height, unsigned format) :
+    width_(width),
+    height_(height),
+    format_(format)
+{
+}
+
+GPUReadback::~GPUReadback() = default;
+
+bool GPUReadback::GetImage(Image& destImage) const
+{
+    if (!ready_ || failed_)
+    {
+        URHO3D_LOGERROR("Readback data is not available");
+        return false;
+    }
+
+    unsigned components;
+    if (format_ == Graphics::GetRGBAFormat())
+        components = 4;
+    else if (format_ == Graphics::GetRGBFormat())
+        components = 3;
+    else if (format_ == Graphics::GetLuminanceAlphaFormat())
+        components = 2;
+    else if (format_ == Graphics::GetAlphaFormat() || format_ == Graphics::GetLuminanceFormat())
+        components = 1;
+    else
+    {
+        URHO3D_LOGERROR("Unsupported readback format for image conversion");
+        return false;
+    }
+
+    if (data_.Size() < (unsigned)(width_ * height_) * components)
+    {
+        URHO3D_LOGERROR("Readback data size does not match the image size");
+        return false;
+    }
+
+    destImage.SetSize(width_, height_, components);
+    memcpy(destImage.GetData(), data_.Buffer(), (size_t)(width_ * height_) * components);
+    return true;
+}
+
+}
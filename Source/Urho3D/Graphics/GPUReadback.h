@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Container/Vector.h"
+#include "../Graphics/GPUObject.h"
+
+namespace Urho3D
+{
+
+class Image;
+
+/// Texture or backbuffer data requested from the GPU with Graphics::ReadTextureAsync() or Graphics::TakeScreenShotAsync(). The data becomes available a few frames after the request.
+class URHO3D_API GPUReadback : public RefCounted
+{
+    friend class Graphics;
+
+public:
+    /// Construct with the size and API-specific format of the data.
+    GPUReadback(int width, int height, unsigned format);
+    /// Destruct.
+    ~GPUReadback() override;
+
+    /// Copy the data to an image. Supported for uncompressed formats with 8 bits per channel. Return true if successful.
+    bool GetImage(Image& destImage) const;
+
+    /// Return whether the data has been read, or the readback has failed.
+    bool IsReady() const { return ready_; }
+    /// Return whether the readback has failed, for example due to device loss.
+    bool IsFailed() const { return failed_; }
+    /// Return width.
+    int GetWidth() const { return width_; }
+    /// Return height.
+    int GetHeight() const { return height_; }
+    /// Return API-specific format of the data.
+    unsigned GetFormat() const { return format_; }
+    /// Return the data, laid out like Texture2D::GetData(). Empty until ready.
+    const PODVector<unsigned char>& GetData() const { return data_; }
+
+private:
+    /// Data.
+    PODVector<unsigned char> data_;
+    /// Staging buffer or texture the data is copied to on the GPU. Null when the data was read immediately.
+    GPUObjectHandle object_{};
+    /// Fence that signals the copy has completed. Used only on OpenGL.
+    void* fence_{};
+    /// Width.
+    int width_;
+    /// Height.
+    int height_;
+    /// API-specific format.
+    unsigned format_;
+    /// Data size of one row, or one row of blocks for compressed formats.
+    unsigned rowSize_{};
+    /// Number of rows, or rows of blocks for compressed formats.
+    unsigned numRows_{};
+    /// Flip rows when copying the data. Used for OpenGL backbuffer reads.
+    bool flipVertical_{};
+    /// Ready flag.
+    bool ready_{};
+    /// Failed flag.
+    bool failed_{};
+};
+
+}
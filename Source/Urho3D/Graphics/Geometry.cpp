@@ -24,9 +24,13 @@
 
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
+#include "../Core/Mutex.h"
+#include "../Core/Profiler.h"
 #include "../Graphics/IndexBuffer.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
+#include "../Math/BoundingBox.h"
 #include "../Math/Ray.h"
 
 #include "../DebugNew.h"
@@ -34,6 +38,12 @@
 namespace Urho3D
 {
 
+/// Minimum number of triangles to build a triangle bounding volume hierarchy for.
+static const unsigned MIN_BVH_TRIANGLES = 64;
+
+/// Mutex for building triangle bounding volume hierarchies from worker threads.
+static Mutex triangleBVHMutex;
+
 Geometry::Geometry(Context* context) :
     Object(context),
     primitiveType_(TRIANGLE_LIST),
@@ -60,6 +70,7 @@ bool Geometry::SetNumVertexBuffers(unsigned num)
 
     unsigned oldSize = vertexBuffers_.Size();
     vertexBuffers_.Resize(num);
+    triangleBVH_.Reset();
 
     return true;
 }
@@ -73,12 +84,14 @@ bool Geometry::SetVertexBuffer(unsigned index, VertexBuffer* buffer)
     }
 
     vertexBuffers_[index] = buffer;
+    triangleBVH_.Reset();
     return true;
 }
 
 void Geometry::SetIndexBuffer(IndexBuffer* buffer)
 {
     indexBuffer_ = buffer;
+    triangleBVH_.Reset();
 }
 
 bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned indexCount, bool getUsedVertexRange)
@@ -158,6 +171,7 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, const
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elements);
     rawElements_ = elements;
+    triangleBVH_.Reset();
 }
 
 void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsigned elementMask)
@@ -165,12 +179,168 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsig
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elementMask);
     rawElements_ = VertexBuffer::GetElements(elementMask);
+    triangleBVH_.Reset();
 }
 
 void Geometry::SetRawIndexData(const SharedArrayPtr<unsigned char>& data, unsigned indexSize)
 {
     rawIndexData_ = data;
     rawIndexSize_ = indexSize;
+    triangleBVH_.Reset();
+}
+
+void Geometry::SetMeshlets(const PODVector<Meshlet>& meshlets)
+{
+    meshlets_ = meshlets;
+}
+
+bool Geometry::BuildMeshlets(unsigned maxTriangles)
+{
+    const unsigned char* vertexData;
+    const unsigned char* indexData;
+    unsigned vertexSize;
+    unsigned indexSize;
+    const PODVector<VertexElement>* elements;
+
+    GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+    unsigned char* destIndexData = indexBuffer_ ? indexBuffer_->GetShadowData() : nullptr;
+    if (primitiveType_ != TRIANGLE_LIST || !vertexData || !elements || !destIndexData || destIndexData != indexData ||
+        VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+    {
+        URHO3D_LOGERROR("Meshlets need a triangle list with shadowed index data and Vector3 positions");
+        return false;
+    }
+
+    maxTriangles = Max(maxTriangles, 1U);
+    unsigned numTriangles = indexCount_ / 3;
+    meshlets_.Clear();
+    if (!numTriangles)
+        return true;
+
+    PODVector<unsigned> indices(numTriangles * 3);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        unsigned index = indexStart_ + i;
+        indices[i] = indexSize == sizeof(unsigned) ? ((const unsigned*)indexData)[index] :
+            ((const unsigned short*)indexData)[index];
+    }
+
+    auto GetPosition = [&](unsigned index) { return *reinterpret_cast<const Vector3*>(vertexData + index * vertexSize); };
+
+    // Front faces are clockwise, so the cross product points out of the surface
+    PODVector<Vector3> normals(numTriangles);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        Vector3 v0 = GetPosition(indices[i * 3]);
+        normals[i] = (GetPosition(indices[i * 3 + 1]) - v0).CrossProduct(GetPosition(indices[i * 3 + 2]) - v0).Normalized();
+    }
+
+    // Build the vertex to triangle adjacency for growing the clusters over connected triangles
+    unsigned numVertices = vertexStart_ + vertexCount_;
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        numVertices = Max(numVertices, indices[i] + 1);
+    PODVector<unsigned> adjacencyOffsets(numVertices + 1);
+    for (unsigned i = 0; i <= numVertices; ++i)
+        adjacencyOffsets[i] = 0;
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        ++adjacencyOffsets[indices[i] + 1];
+    for (unsigned i = 0; i < numVertices; ++i)
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    PODVector<unsigned> adjacency(indices.Size());
+    PODVector<unsigned> fill(&adjacencyOffsets[0], numVertices);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    // Grow each cluster breadth-first from the first unassigned triangle. Triangles facing away from the seed are left for
+    // other clusters to keep the normal cones narrow for backface culling
+    static const float MAX_NORMAL_DEVIATION = 0.5f;
+    PODVector<unsigned char> assigned(numTriangles);
+    for (unsigned i = 0; i < numTriangles; ++i)
+        assigned[i] = 0;
+    PODVector<unsigned> order;
+    order.Reserve(numTriangles);
+
+    unsigned seed = 0;
+    while (order.Size() < numTriangles)
+    {
+        while (assigned[seed])
+            ++seed;
+
+        unsigned first = order.Size();
+        const Vector3 seedNormal = normals[seed];
+        assigned[seed] = 1;
+        order.Push(seed);
+
+        for (unsigned head = first; head < order.Size() && order.Size() - first < maxTriangles; ++head)
+        {
+            unsigned triangle = order[head];
+            for (unsigned j = 0; j < 3 && order.Size() - first < maxTriangles; ++j)
+            {
+                unsigned vertex = indices[triangle * 3 + j];
+                for (unsigned k = adjacencyOffsets[vertex]; k < adjacencyOffsets[vertex + 1]; ++k)
+                {
+                    unsigned neighbor = adjacency[k];
+                    if (assigned[neighbor] || (normals[neighbor] != Vector3::ZERO &&
+                        normals[neighbor].DotProduct(seedNormal) < MAX_NORMAL_DEVIATION))
+                        continue;
+
+                    assigned[neighbor] = 1;
+                    order.Push(neighbor);
+                    if (order.Size() - first >= maxTriangles)
+                        break;
+                }
+            }
+        }
+
+        // Calculate the bounds
+        Meshlet meshlet;
+        meshlet.indexStart_ = indexStart_ + first * 3;
+        meshlet.indexCount_ = (order.Size() - first) * 3;
+
+        BoundingBox box;
+        Vector3 normalSum = Vector3::ZERO;
+        for (unsigned j = first; j < order.Size(); ++j)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+                box.Merge(GetPosition(indices[order[j] * 3 + k]));
+            normalSum += normals[order[j]];
+        }
+        meshlet.center_ = box.Center();
+        meshlet.radius_ = 0.0f;
+        for (unsigned j = first; j < order.Size(); ++j)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+                meshlet.radius_ = Max(meshlet.radius_, (GetPosition(indices[order[j] * 3 + k]) - meshlet.center_).Length());
+        }
+
+        meshlet.coneAxis_ = normalSum.Normalized();
+        float minDot = 1.0f;
+        for (unsigned j = first; j < order.Size(); ++j)
+            minDot = Min(minDot, normals[order[j]].DotProduct(meshlet.coneAxis_));
+        // A cone of more than about 84 degrees half angle can not be culled from any useful viewpoint
+        meshlet.coneCutoff_ = minDot > 0.1f ? sqrtf(1.0f - minDot * minDot) : 1.0f;
+
+        meshlets_.Push(meshlet);
+    }
+
+    // Write the triangles in cluster order
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            unsigned index = indices[order[i] * 3 + j];
+            unsigned dest = indexStart_ + i * 3 + j;
+            if (indexSize == sizeof(unsigned))
+                ((unsigned*)destIndexData)[dest] = index;
+            else
+                ((unsigned short*)destIndexData)[dest] = (unsigned short)index;
+        }
+    }
+    indexBuffer_->SetDataRange(destIndexData + indexStart_ * indexSize, indexStart_, numTriangles * 3);
+    // The triangle order changed in place
+    triangleBVH_.Reset();
+
+    return true;
 }
 
 void Geometry::Draw(Graphics* graphics)
@@ -326,6 +496,96 @@ float Geometry::GetHitDistance(const Ray& ray, Vector3* outNormal, Vector2* outU
         uvOffset) : ray.HitDistance(vertexData, vertexSize, vertexStart_, vertexCount_, outNormal, outUV, uvOffset);
 }
 
+float Geometry::GetStaticHitDistance(const Ray& ray, Vector3* outNormal, Vector2* outUV) const
+{
+    SharedPtr<TriangleBVH> bvh = GetTriangleBVH();
+    if (!bvh)
+        return GetHitDistance(ray, outNormal, outUV);
+
+    const unsigned char* vertexData;
+    const unsigned char* indexData;
+    unsigned vertexSize;
+    unsigned indexSize;
+    const PODVector<VertexElement>* elements;
+
+    GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+    unsigned uvOffset = VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR2, SEM_TEXCOORD);
+
+    if (outUV && uvOffset == M_MAX_UNSIGNED)
+    {
+        // requested UV output, but no texture data in vertex buffer
+        URHO3D_LOGWARNING("Illegal GetStaticHitDistance call: UV return requested on vertex buffer without UV coords");
+        *outUV = Vector2::ZERO;
+        outUV = nullptr;
+    }
+
+    Vector3 barycentric;
+    unsigned triangle;
+    float distance = bvh->HitDistance(ray, outNormal, outUV ? &barycentric : nullptr, &triangle);
+
+    if (outUV)
+    {
+        if (distance == M_INFINITY)
+            *outUV = Vector2::ZERO;
+        else
+        {
+            auto GetIndex = [&](unsigned i) -> unsigned
+            {
+                if (!indexData)
+                    return i;
+                return indexSize == sizeof(unsigned short) ? ((const unsigned short*)indexData)[i] :
+                    ((const unsigned*)indexData)[i];
+            };
+
+            // Interpolate the UV coordinate using barycentric coordinate
+            const Vector2& uv0 = *((const Vector2*)(&vertexData[uvOffset + GetIndex(triangle) * vertexSize]));
+            const Vector2& uv1 = *((const Vector2*)(&vertexData[uvOffset + GetIndex(triangle + 1) * vertexSize]));
+            const Vector2& uv2 = *((const Vector2*)(&vertexData[uvOffset + GetIndex(triangle + 2) * vertexSize]));
+            *outUV = Vector2(uv0.x_ * barycentric.x_ + uv1.x_ * barycentric.y_ + uv2.x_ * barycentric.z_,
+                uv0.y_ * barycentric.x_ + uv1.y_ * barycentric.y_ + uv2.y_ * barycentric.z_);
+        }
+    }
+
+    return distance;
+}
+
+SharedPtr<TriangleBVH> Geometry::GetTriangleBVH() const
+{
+    if (primitiveType_ != TRIANGLE_LIST)
+        return SharedPtr<TriangleBVH>();
+
+    const unsigned char* vertexData;
+    const unsigned char* indexData;
+    unsigned vertexSize;
+    unsigned indexSize;
+    const PODVector<VertexElement>* elements;
+
+    GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+    if (!vertexData || !elements || VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+        return SharedPtr<TriangleBVH>();
+
+    unsigned start = indexData ? indexStart_ : vertexStart_;
+    unsigned count = indexData ? indexCount_ : vertexCount_;
+    if (count / 3 < MIN_BVH_TRIANGLES)
+        return SharedPtr<TriangleBVH>();
+
+    MutexLock lock(triangleBVHMutex);
+
+    // Rebuild if the data or the draw range has changed since
+    if (!triangleBVH_ || !triangleBVH_->IsBuiltFrom(vertexData, indexData, start, count))
+    {
+        URHO3D_PROFILE(BuildTriangleBVH);
+
+        SharedPtr<TriangleBVH> bvh(new TriangleBVH());
+        bvh->Build(vertexData, vertexSize, indexData, indexSize, start, count);
+        triangleBVH_ = bvh;
+    }
+
+    return triangleBVH_;
+}
+
 bool Geometry::IsInside(const Ray& ray) const
 {
     const unsigned char* vertexData;
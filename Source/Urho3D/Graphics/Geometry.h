@@ -25,15 +25,37 @@
 #include "../Container/ArrayPtr.h"
 #include "../Core/Object.h"
 #include "../Graphics/GraphicsDefs.h"
+#include "../Math/Vector3.h"
 
 namespace Urho3D
 {
 
+/// Default maximum number of triangles in a meshlet.
+static const unsigned DEFAULT_MESHLET_TRIANGLES = 128;
+
 class IndexBuffer;
 class Ray;
 class Graphics;
+class TriangleBVH;
 class VertexBuffer;
 
+/// Cluster of nearby triangles in a geometry's index range, with bounds for culling it separately.
+struct Meshlet
+{
+    /// Start index of the triangles.
+    unsigned indexStart_;
+    /// Number of indices.
+    unsigned indexCount_;
+    /// Bounding sphere center.
+    Vector3 center_;
+    /// Bounding sphere radius.
+    float radius_;
+    /// Average triangle normal.
+    Vector3 coneAxis_;
+    /// Sine of the half angle of the cone containing the triangle normals. When 1, the cluster is never backfacing.
+    float coneCutoff_;
+};
+
 /// Defines one or more vertex buffers, an index buffer and a draw range.
 class URHO3D_API Geometry : public Object
 {
@@ -64,6 +86,10 @@ public:
     void SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsigned elementMask);
     /// Override raw index data to be returned for CPU-side operations.
     void SetRawIndexData(const SharedArrayPtr<unsigned char>& data, unsigned indexSize);
+    /// Set meshlets. They must cover the draw range.
+    void SetMeshlets(const PODVector<Meshlet>& meshlets);
+    /// Group the triangles into meshlets of at most the given number of triangles and reorder the index buffer to match. Requires a triangle list, shadowed index data and shadowed Vector3 positions. Return true if successful.
+    bool BuildMeshlets(unsigned maxTriangles = DEFAULT_MESHLET_TRIANGLES);
     /// Draw.
     void Draw(Graphics* graphics);
 
@@ -106,12 +132,22 @@ public:
         unsigned& indexSize, const PODVector<VertexElement>*& elements) const;
     /// Return ray hit distance or infinity if no hit. Requires raw data to be set. Optionally return hit normal and hit uv coordinates at intersect point.
     float GetHitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector2* outUV = nullptr) const;
+    /// Return ray hit distance or infinity if no hit, using the triangle bounding volume hierarchy when the geometry is large enough. Requires raw data to be set and not modified in place afterward. Optionally return hit normal and hit uv coordinates at intersect point.
+    float GetStaticHitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector2* outUV = nullptr) const;
+    /// Return the triangle bounding volume hierarchy of the draw range, building it on first use. Safe to call from worker threads. Return null if the geometry is not a triangle list with raw Vector3 positions or has too few triangles to benefit.
+    SharedPtr<TriangleBVH> GetTriangleBVH() const;
     /// Return whether or not the ray is inside geometry.
     bool IsInside(const Ray& ray) const;
 
     /// Return whether has empty draw range.
     bool IsEmpty() const { return indexCount_ == 0 && vertexCount_ == 0; }
 
+    /// Return meshlets.
+    const PODVector<Meshlet>& GetMeshlets() const { return meshlets_; }
+
+    /// Return number of meshlets.
+    unsigned GetNumMeshlets() const { return meshlets_.Size(); }
+
 private:
     /// Vertex buffers.
     Vector<SharedPtr<VertexBuffer> > vertexBuffers_;
@@ -139,6 +175,10 @@ private:
     unsigned rawVertexSize_;
     /// Raw index data override size.
     unsigned rawIndexSize_;
+    /// Meshlets.
+    PODVector<Meshlet> meshlets_;
+    /// Triangle bounding volume hierarchy, built on demand.
+    mutable SharedPtr<TriangleBVH> triangleBVH_;
 };
 
 }
@@ -23,15 +23,21 @@
 #include "../Precompiled.h"
 
 #include "../Core/Profiler.h"
+#include "../Graphics/AnimatedCrowd.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
+#include "../Graphics/AnimationLodPolicy.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/CustomGeometry.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/DecalSet.h"
+#include "../Graphics/GPUParticleEmitter.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/GraphicsImpl.h"
+#include "../Graphics/HLODGroup.h"
+#include "../Graphics/ImpostorGroup.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Octree.h"
 #include "../Graphics/ParticleEffect.h"
@@ -43,8 +49,10 @@
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/Technique.h"
 #include "../Graphics/Terrain.h"
+#include "../Graphics/TerrainClipmap.h"
 #include "../Graphics/TerrainPatch.h"
-#ifdef _WIN32
+#include "../Graphics/TerrainStreamer.h"
+#if defined(_WIN32) || defined(URHO3D_NULL_GRAPHICS)
 #include "../Graphics/Texture2D.h"
 #endif
 #include "../Graphics/Texture2DArray.h"
@@ -223,6 +231,18 @@ IntVector2 Graphics::GetDesktopResolution(int monitor) const
 #endif
 }
 
+int Graphics::GetDesktopRefreshRate(int monitor) const
+{
+#if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
+    SDL_DisplayMode mode;
+    if (SDL_GetDesktopDisplayMode(monitor, &mode) == 0)
+        return mode.refresh_rate;
+    return 0;
+#else
+    return refreshRate_;
+#endif
+}
+
 int Graphics::GetMonitorCount() const
 {
     return SDL_GetNumVideoDisplays();
@@ -286,6 +306,14 @@ void Graphics::PrecacheShaders(Deserializer& source)
     ShaderPrecache::LoadShaders(this, source);
 }
 
+ShaderPrecacheLoader* Graphics::PrecacheShadersAsync(Deserializer& source)
+{
+    if (!shaderPrecacheLoader_)
+        shaderPrecacheLoader_ = new ShaderPrecacheLoader(context_);
+
+    return shaderPrecacheLoader_->Load(source) ? shaderPrecacheLoader_.Get() : nullptr;
+}
+
 void Graphics::SetShaderCacheDir(const String& path)
 {
     String trimmedPath = path.Trimmed();
@@ -293,6 +321,133 @@ void Graphics::SetShaderCacheDir(const String& path)
         shaderCacheDir_ = AddTrailingSlash(trimmedPath);
 }
 
+void Graphics::MultiDrawInstancedFallback(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands)
+{
+    PODVector<VertexBuffer*> vertexBuffers(vertexBuffers_, MAX_VERTEX_STREAMS);
+
+    for (unsigned i = 0; i < commands.Size(); ++i)
+    {
+        const InstancedDrawCommand& command = commands[i];
+        SetVertexBuffers(vertexBuffers, command.instanceStart_);
+        DrawInstanced(type, command.indexStart_, command.indexCount_, command.minVertex_, command.vertexCount_, command.instanceCount_);
+    }
+}
+
+void Graphics::SetGPUTiming(bool enable)
+{
+    gpuTiming_ = enable;
+}
+
+void Graphics::BeginGPUBlock(const char* name)
+{
+    if (!gpuTimerFrameActive_)
+        return;
+
+    GPUTimerFrame& frame = gpuTimerFrames_[gpuTimerFrameIndex_];
+    // Reserve the end queries of the open blocks, and skip the children of a block that was already skipped
+    if (frame.numQueries_ + gpuTimerBlockStack_.Size() + 2 > MAX_GPU_TIMER_QUERIES ||
+        (gpuTimerBlockStack_.Size() && gpuTimerBlockStack_.Back() == M_MAX_UNSIGNED))
+    {
+        gpuTimerBlockStack_.Push(M_MAX_UNSIGNED);
+        return;
+    }
+
+    if (frame.blocks_.Size() <= frame.numBlocks_)
+        frame.blocks_.Resize(frame.numBlocks_ + 1);
+
+    GPUTimerBlock& block = frame.blocks_[frame.numBlocks_];
+    block.name_ = name;
+    block.depth_ = gpuTimerBlockStack_.Size();
+    block.beginQuery_ = frame.numQueries_++;
+    block.endQuery_ = M_MAX_UNSIGNED;
+    IssueTimerQuery(gpuTimerFrameIndex_, block.beginQuery_);
+
+    gpuTimerBlockStack_.Push(frame.numBlocks_++);
+}
+
+void Graphics::EndGPUBlock()
+{
+    if (!gpuTimerFrameActive_ || gpuTimerBlockStack_.Empty())
+        return;
+
+    unsigned index = gpuTimerBlockStack_.Back();
+    gpuTimerBlockStack_.Pop();
+    if (index == M_MAX_UNSIGNED)
+        return;
+
+    GPUTimerFrame& frame = gpuTimerFrames_[gpuTimerFrameIndex_];
+    GPUTimerBlock& block = frame.blocks_[index];
+    block.endQuery_ = frame.numQueries_++;
+    IssueTimerQuery(gpuTimerFrameIndex_, block.endQuery_);
+}
+
+SharedPtr<GPUReadback> Graphics::TakeScreenShotAsync()
+{
+    URHO3D_PROFILE(TakeScreenShotAsync);
+
+    if (!IsInitialized())
+        return SharedPtr<GPUReadback>();
+
+    if (IsDeviceLost())
+    {
+        URHO3D_LOGERROR("Can not take screenshot while device is lost");
+        return SharedPtr<GPUReadback>();
+    }
+
+    SharedPtr<GPUReadback> readback(new GPUReadback(width_, height_, GetRGBAFormat()));
+    readback->rowSize_ = (unsigned)width_ * 4;
+    readback->numRows_ = (unsigned)height_;
+    if (!IssueScreenReadback(readback))
+    {
+        ReleaseReadbackObjects(readback);
+        return SharedPtr<GPUReadback>();
+    }
+
+    pendingReadbacks_.Push(readback);
+    return readback;
+}
+
+SharedPtr<GPUReadback> Graphics::ReadTextureAsync(Texture2D* texture, unsigned level)
+{
+    if (!texture || !texture->GetGPUObject())
+    {
+        URHO3D_LOGERROR("No texture created, can not read data");
+        return SharedPtr<GPUReadback>();
+    }
+
+    if (level >= texture->GetLevels())
+    {
+        URHO3D_LOGERROR("Illegal mip level for reading data");
+        return SharedPtr<GPUReadback>();
+    }
+
+    if (IsDeviceLost())
+    {
+        URHO3D_LOGWARNING("Reading texture data while device is lost");
+        return SharedPtr<GPUReadback>();
+    }
+
+    if (texture->GetMultiSample() > 1 && !texture->GetAutoResolve())
+    {
+        URHO3D_LOGERROR("Can not read data from multisampled texture without autoresolve");
+        return SharedPtr<GPUReadback>();
+    }
+
+    int width = texture->GetLevelWidth(level);
+    int height = texture->GetLevelHeight(level);
+    SharedPtr<GPUReadback> readback(new GPUReadback(width, height, texture->GetFormat()));
+    readback->rowSize_ = texture->GetRowDataSize(width);
+    readback->numRows_ = (unsigned)(texture->IsCompressed() ? (height + 3) >> 2 : height);
+    if (!IssueTextureReadback(readback, texture, level))
+    {
+        ReleaseReadbackObjects(readback);
+        return SharedPtr<GPUReadback>();
+    }
+
+    pendingReadbacks_.Push(readback);
+    return readback;
+}
+
 void Graphics::AddGPUObject(GPUObject* object)
 {
     MutexLock lock(gpuObjectMutex_);
@@ -385,6 +540,119 @@ void Graphics::CleanupScratchBuffers()
     maxScratchBufferRequest_ = 0;
 }
 
+void Graphics::BeginGPUTimerFrame()
+{
+    // Read the results of past frames oldest first, stopping at the first frame the GPU has not finished yet
+    auto* profiler = GetSubsystem<Profiler>();
+    for (unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+    {
+        unsigned frameIndex = (gpuTimerFrameIndex_ + i) % GPU_TIMER_FRAMES;
+        GPUTimerFrame& frame = gpuTimerFrames_[frameIndex];
+        if (!frame.pending_)
+            continue;
+        if (!GetTimerQueryResults(frameIndex, frame.numQueries_, gpuTimerResults_))
+            break;
+
+        frame.pending_ = false;
+        // The first block spans the whole frame
+        if (frame.numBlocks_ && !frame.blocks_[0].depth_)
+            gpuFrameTime_ = Max(gpuTimerResults_[frame.blocks_[0].endQuery_] - gpuTimerResults_[frame.blocks_[0].beginQuery_], 0LL);
+        if (!profiler)
+            continue;
+
+        // Replay the blocks into the profiler's GPU tree, closing each block when a block at the same or lower depth begins
+        gpuTimerBlockStack_.Clear();
+        for (unsigned j = 0; j <= frame.numBlocks_; ++j)
+        {
+            unsigned depth = j < frame.numBlocks_ ? frame.blocks_[j].depth_ : 0;
+            while (gpuTimerBlockStack_.Size() > depth)
+            {
+                const GPUTimerBlock& open = frame.blocks_[gpuTimerBlockStack_.Back()];
+                gpuTimerBlockStack_.Pop();
+                profiler->EndGPUBlock(Max(gpuTimerResults_[open.endQuery_] - gpuTimerResults_[open.beginQuery_], 0LL));
+            }
+            if (j < frame.numBlocks_)
+            {
+                profiler->BeginGPUBlock(frame.blocks_[j].name_.CString());
+                gpuTimerBlockStack_.Push(j);
+            }
+        }
+    }
+
+    gpuTimerBlockStack_.Clear();
+    if (!gpuTiming_ || !gpuTimingSupport_)
+        return;
+
+    // If the oldest frame is still not finished, its results are dropped
+    GPUTimerFrame& frame = gpuTimerFrames_[gpuTimerFrameIndex_];
+    frame.numBlocks_ = 0;
+    frame.numQueries_ = 0;
+    frame.pending_ = false;
+
+    BeginTimerQueryFrame(gpuTimerFrameIndex_);
+    gpuTimerFrameActive_ = true;
+    BeginGPUBlock("GPUFrame");
+}
+
+void Graphics::EndGPUTimerFrame()
+{
+    if (!gpuTimerFrameActive_)
+        return;
+
+    while (gpuTimerBlockStack_.Size())
+        EndGPUBlock();
+
+    EndTimerQueryFrame(gpuTimerFrameIndex_);
+    gpuTimerFrames_[gpuTimerFrameIndex_].pending_ = gpuTimerFrames_[gpuTimerFrameIndex_].numQueries_ > 0;
+    gpuTimerFrameIndex_ = (gpuTimerFrameIndex_ + 1) % GPU_TIMER_FRAMES;
+    gpuTimerFrameActive_ = false;
+}
+
+void Graphics::ReleaseGPUTimers()
+{
+    ReleaseTimerQueries();
+
+    for (auto& frame : gpuTimerFrames_)
+        frame.pending_ = false;
+    gpuTimerBlockStack_.Clear();
+    gpuTimerFrameActive_ = false;
+}
+
+void Graphics::UpdateReadbacks()
+{
+    using namespace GPUReadbackComplete;
+
+    // The copies finish in request order, so stop at the first readback the GPU has not finished yet
+    while (pendingReadbacks_.Size())
+    {
+        SharedPtr<GPUReadback> readback = pendingReadbacks_.Front();
+        if (!GetReadbackData(readback))
+            break;
+
+        ReleaseReadbackObjects(readback);
+        readback->ready_ = true;
+        pendingReadbacks_.Erase(0);
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_READBACK] = readback.Get();
+        SendEvent(E_GPUREADBACKCOMPLETE, eventData);
+    }
+}
+
+void Graphics::ReleaseReadbacks()
+{
+    for (unsigned i = 0; i < pendingReadbacks_.Size(); ++i)
+    {
+        GPUReadback* readback = pendingReadbacks_[i];
+        ReleaseReadbackObjects(readback);
+        readback->data_.Clear();
+        readback->ready_ = true;
+        readback->failed_ = true;
+    }
+
+    pendingReadbacks_.Clear();
+}
+
 void Graphics::CreateWindowIcon()
 {
     if (windowIcon_)
@@ -401,6 +669,7 @@ void Graphics::CreateWindowIcon()
 void RegisterGraphicsLibrary(Context* context)
 {
     Animation::RegisterObject(context);
+    AnimationLodPolicy::RegisterObject(context);
     Material::RegisterObject(context);
     Model::RegisterObject(context);
     Shader::RegisterObject(context);
@@ -414,17 +683,23 @@ void RegisterGraphicsLibrary(Context* context)
     Light::RegisterObject(context);
     StaticModel::RegisterObject(context);
     StaticModelGroup::RegisterObject(context);
+    AnimatedCrowd::RegisterObject(context);
+    HLODGroup::RegisterObject(context);
+    ImpostorGroup::RegisterObject(context);
     Skybox::RegisterObject(context);
     AnimatedModel::RegisterObject(context);
     AnimationController::RegisterObject(context);
     BillboardSet::RegisterObject(context);
     ParticleEffect::RegisterObject(context);
     ParticleEmitter::RegisterObject(context);
+    GPUParticleEmitter::RegisterObject(context);
     RibbonTrail::RegisterObject(context);
     CustomGeometry::RegisterObject(context);
     DecalSet::RegisterObject(context);
     Terrain::RegisterObject(context);
     TerrainPatch::RegisterObject(context);
+    TerrainClipmap::RegisterObject(context);
+    TerrainStreamer::RegisterObject(context);
     DebugRenderer::RegisterObject(context);
     Octree::RegisterObject(context);
     Zone::RegisterObject(context);
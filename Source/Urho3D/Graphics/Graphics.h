@@ -26,6 +26,7 @@
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
+#include "../Graphics/GPUReadback.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../Graphics/ShaderVariation.h"
 #include "../Math/Color.h"
@@ -44,9 +45,11 @@ class Image;
 class IndexBuffer;
 class GPUObject;
 class GraphicsImpl;
+class Material;
 class RenderSurface;
 class Shader;
 class ShaderPrecache;
+class ShaderPrecacheLoader;
 class ShaderProgram;
 class ShaderVariation;
 class Texture;
@@ -77,6 +80,32 @@ struct ScratchBuffer
     bool reserved_;
 };
 
+/// GPU timing block recorded during a frame.
+struct GPUTimerBlock
+{
+    /// Block name.
+    String name_;
+    /// Nesting depth, 0 for the frame.
+    unsigned depth_;
+    /// Index of the timestamp query at the block begin.
+    unsigned beginQuery_;
+    /// Index of the timestamp query at the block end.
+    unsigned endQuery_;
+};
+
+/// GPU timing blocks of a frame, waiting for the timer query results.
+struct GPUTimerFrame
+{
+    /// Blocks in begin order. Only the first numBlocks_ are in use, the rest are kept to avoid reallocating the names.
+    Vector<GPUTimerBlock> blocks_;
+    /// Number of blocks in use.
+    unsigned numBlocks_{};
+    /// Number of timestamp queries issued.
+    unsigned numQueries_{};
+    /// Waiting for results flag.
+    bool pending_{};
+};
+
 /// %Graphics subsystem. Manages the application window, rendering state and GPU resources.
 class URHO3D_API Graphics : public Object
 {
@@ -112,6 +141,8 @@ public:
     void SetFlushGPU(bool enable);
     /// Set forced use of OpenGL 2 even if OpenGL 3 is available. Must be called before setting the screen mode for the first time. Default false. No effect on Direct3D9 & 11.
     void SetForceGL2(bool enable);
+    /// Set whether to measure the GPU time of rendering with timer queries. The results are added to the GPU tree of the profiler a few frames later. Default false.
+    void SetGPUTiming(bool enable);
     /// Set allowed screen orientations as a space-separated list of "LandscapeLeft", "LandscapeRight", "Portrait" and "PortraitUpsideDown". Affects currently only iOS platform.
     void SetOrientations(const String& orientations);
     /// Toggle between full screen and windowed mode. Return true if successful.
@@ -120,10 +151,18 @@ public:
     void Close();
     /// Take a screenshot. Return true if successful.
     bool TakeScreenShot(Image& destImage);
+    /// Queue an asynchronous screenshot, which does not stall the GPU pipeline. The data is 8-bit RGBA. Return the readback, which becomes ready a few frames later and sends E_GPUREADBACKCOMPLETE, or null on error.
+    SharedPtr<GPUReadback> TakeScreenShotAsync();
+    /// Queue an asynchronous read of a texture mip level, which does not stall the GPU pipeline. The data is laid out like Texture2D::GetData(). Return the readback, which becomes ready a few frames later and sends E_GPUREADBACKCOMPLETE, or null on error.
+    SharedPtr<GPUReadback> ReadTextureAsync(Texture2D* texture, unsigned level = 0);
     /// Begin frame rendering. Return true if device available and can render.
     bool BeginFrame();
     /// End frame rendering and swap buffers.
     void EndFrame();
+    /// Begin a GPU timing block. Blocks can be nested. No-op unless GPU timing is enabled and supported.
+    void BeginGPUBlock(const char* name);
+    /// End the current GPU timing block.
+    void EndGPUBlock();
     /// Clear any or all of rendertarget, depth buffer and stencil buffer.
     void Clear(ClearTargetFlags flags, const Color& color = Color(0.0f, 0.0f, 0.0f, 0.0f), float depth = 1.0f, unsigned stencil = 0);
     /// Resolve multisampled backbuffer to a texture rendertarget. The texture's size should match the viewport size.
@@ -144,6 +183,8 @@ public:
     /// Draw indexed, instanced geometry with vertex index offset.
     void DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned indexCount, unsigned baseVertexIndex, unsigned minVertex,
         unsigned vertexCount, unsigned instanceCount);
+    /// Draw several indexed, instanced geometries from the current vertex and index buffers. The instance data of each command starts at its own index in the instancing vertex buffer, so the instance offset of SetVertexBuffers is ignored. Uses one multi-draw call when supported.
+    void MultiDrawInstanced(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands);
     /// Set vertex buffer.
     void SetVertexBuffer(VertexBuffer* buffer);
     /// Set multiple vertex buffers.
@@ -180,6 +221,8 @@ public:
     void SetShaderParameter(StringHash param, const Variant& value);
     /// Check whether a shader parameter group needs update. Does not actually check whether parameters exist in the shaders.
     bool NeedParameterUpdate(ShaderParameterGroup group, const void* source);
+    /// Bind the material's own constant buffers for the material shader parameter group of the current shaders, building them from its parameters on first use or when they have changed. Return false if the shaders do not keep material parameters in constant buffers, in which case they must be set individually.
+    bool SetMaterialShaderParameters(Material* material);
     /// Check whether a shader parameter exists on the currently set shaders.
     bool HasShaderParameter(StringHash param);
     /// Check whether the current vertex or pixel shader uses a texture unit.
@@ -188,6 +231,8 @@ public:
     void ClearParameterSource(ShaderParameterGroup group);
     /// Clear remembered shader parameter sources.
     void ClearParameterSources();
+    /// Clear remembered shader parameter sources when starting to render a view, except the global (per-frame) group.
+    void ClearViewParameterSources();
     /// Clear remembered transform shader parameter sources.
     void ClearTransformSources();
     /// Set texture.
@@ -198,6 +243,10 @@ public:
     void SetTextureParametersDirty();
     /// Set default texture filtering mode. Called by Renderer before rendering.
     void SetDefaultTextureFilterMode(TextureFilterMode mode);
+    /// Make the GPU upload context current on the calling worker thread, so that a resource loading in the background can create and fill its GPU objects there. Waits while another thread is uploading. Must be paired with EndBackgroundUpload() if successful. Used only on desktop OpenGL 3, return false on other APIs and on the main thread.
+    bool BeginBackgroundUpload();
+    /// Wait until the GPU has finished the uploads and release the upload context from the calling thread.
+    void EndBackgroundUpload();
     /// Set default texture anisotropy level. Called by Renderer before rendering.
     void SetDefaultTextureAnisotropy(unsigned level);
     /// Reset all rendertargets, depth-stencil surface and viewport.
@@ -249,9 +298,13 @@ public:
     void EndDumpShaders();
     /// Precache shader variations from an XML file generated with BeginDumpShaders().
     void PrecacheShaders(Deserializer& source);
-    /// Set shader cache directory, Direct3D only. This can either be an absolute path or a path within the resource system.
+    /// Begin precaching shader variations from an XML file generated with BeginDumpShaders() over several frames, compiling in worker threads where the API allows. Return the loader for querying progress, or null if failed.
+    ShaderPrecacheLoader* PrecacheShadersAsync(Deserializer& source);
+    /// Set shader cache directory for Direct3D shader bytecode and OpenGL program binaries. This can either be an absolute path or a path within the resource system.
     void SetShaderCacheDir(const String& path);
 
+    /// Return the asynchronous shader precache loader, or null if not used.
+    ShaderPrecacheLoader* GetShaderPrecacheLoader() const { return shaderPrecacheLoader_; }
     /// Return whether rendering initialized.
     bool IsInitialized() const;
 
@@ -318,6 +371,12 @@ public:
     /// Return whether the GPU command buffer is flushed each frame.
     bool GetFlushGPU() const { return flushGPU_; }
 
+    /// Return whether GPU timing is enabled.
+    bool GetGPUTiming() const { return gpuTiming_; }
+
+    /// Return the GPU time of the latest frame whose timer query results have been read, in microseconds. Zero if GPU timing has not measured any frame yet.
+    long long GetGPUFrameTime() const { return gpuFrameTime_; }
+
     /// Return whether OpenGL 2 use is forced. Effective only on OpenGL.
     bool GetForceGL2() const { return forceGL2_; }
 
@@ -345,6 +404,9 @@ public:
     /// Return whether hardware instancing is supported.
     bool GetInstancingSupport() const { return instancingSupport_; }
 
+    /// Return whether MultiDrawInstanced submits several instanced draws with one call, or with one state setup on Direct3D11.
+    bool GetMultiDrawSupport() const { return multiDrawSupport_; }
+
     /// Return whether light pre-pass rendering is supported.
     bool GetLightPrepassSupport() const { return lightPrepassSupport_; }
 
@@ -366,12 +428,26 @@ public:
     /// Return whether sRGB conversion on rendertarget writing is supported.
     bool GetSRGBWriteSupport() const { return sRGBWriteSupport_; }
 
+    /// Return whether GPU timer queries are supported.
+    bool GetGPUTimingSupport() const { return gpuTimingSupport_; }
+
+    /// Return whether readbacks are copied without stalling. If not, the data is read immediately on request, but still delivered with the next frame.
+    bool GetAsyncReadbackSupport() const { return asyncReadbackSupport_; }
+
+    /// Return whether a vertex element type is supported. The compressed types starting from TYPE_HALF2 depend on the hardware.
+    bool GetVertexElementTypeSupport(VertexElementType type) const
+    {
+        return type < TYPE_HALF2 || (type < MAX_VERTEX_ELEMENT_TYPES && (compressedVertexSupport_ & (1u << type)));
+    }
+
     /// Return supported fullscreen resolutions (third component is refreshRate). Will be empty if listing the resolutions is not supported on the platform (e.g. Web).
     PODVector<IntVector3> GetResolutions(int monitor) const;
     /// Return supported multisampling levels.
     PODVector<int> GetMultiSampleLevels() const;
     /// Return the desktop resolution.
     IntVector2 GetDesktopResolution(int monitor) const;
+    /// Return the desktop refresh rate in Hz, or 0 if not known.
+    int GetDesktopRefreshRate(int monitor) const;
     /// Return the number of currently connected monitors.
     int GetMonitorCount() const;
     /// Returns the index of the display containing the center of the window on success or a negative error code on failure.
@@ -527,6 +603,10 @@ public:
     void SetVBO(unsigned object);
     /// Bind a UBO, avoiding redundant operation. Used only on OpenGL.
     void SetUBO(unsigned object);
+    /// Clean up a deleted VBO from the cached vertex attribute pointers. Used only on OpenGL.
+    void CleanupVBO(unsigned object);
+    /// Clean up a released constant buffer from the cached bindings. Used only on OpenGL.
+    void CleanupConstantBuffer(ConstantBuffer* buffer);
 
     /// Return the API-specific alpha texture format.
     static unsigned GetAlphaFormat();
@@ -604,6 +684,8 @@ private:
     void SetTextureUnitMappings();
     /// Process dirtied state before draw.
     void PrepareDraw();
+    /// Draw instanced draw commands one at a time, offsetting the instancing vertex buffer for each.
+    void MultiDrawInstancedFallback(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands);
     /// Create intermediate texture for multisampled backbuffer resolve. No-op if already exists.
     void CreateResolveTexture();
     /// Clean up all framebuffers. Called when destroying the context. Used only on OpenGL.
@@ -626,6 +708,34 @@ private:
     void SetVertexAttribDivisor(unsigned location, unsigned divisor);
     /// Release/clear GPU objects and optionally close the window. Used only on OpenGL.
     void Release(bool clearGPUObjects, bool closeWindow);
+    /// Begin GPU timing of a frame and report the timer query results of earlier frames that have become available.
+    void BeginGPUTimerFrame();
+    /// End GPU timing of a frame.
+    void EndGPUTimerFrame();
+    /// Release the timer queries and discard the frames waiting for results.
+    void ReleaseGPUTimers();
+    /// Begin a frame of timer queries. Used for the disjoint query on Direct3D.
+    void BeginTimerQueryFrame(unsigned frame);
+    /// End a frame of timer queries.
+    void EndTimerQueryFrame(unsigned frame);
+    /// Issue a timestamp query. The query is created on first use.
+    void IssueTimerQuery(unsigned frame, unsigned index);
+    /// Read the timestamps of a frame in microseconds without waiting. Return false if not available yet. The destination is left empty if the timestamps are unreliable, for example due to a GPU clock change.
+    bool GetTimerQueryResults(unsigned frame, unsigned count, PODVector<long long>& dest);
+    /// Release the API-specific timer queries.
+    void ReleaseTimerQueries();
+    /// Deliver the readbacks whose data has become available.
+    void UpdateReadbacks();
+    /// Fail the pending readbacks and release their API-specific objects.
+    void ReleaseReadbacks();
+    /// Issue the copy of a texture level for a readback. Read the data immediately if asynchronous readback is not supported. Return true if successful.
+    bool IssueTextureReadback(GPUReadback* readback, Texture2D* texture, unsigned level);
+    /// Issue the copy of the backbuffer for a readback. Read the data immediately if asynchronous readback is not supported. Return true if successful.
+    bool IssueScreenReadback(GPUReadback* readback);
+    /// Copy the data of a readback without waiting. Return false if the GPU has not finished the copy yet.
+    bool GetReadbackData(GPUReadback* readback);
+    /// Release the API-specific objects of a readback.
+    void ReleaseReadbackObjects(GPUReadback* readback);
 
     /// Mutex for accessing the GPU objects vector from several threads.
     Mutex gpuObjectMutex_;
@@ -685,10 +795,34 @@ private:
     bool hardwareShadowSupport_{};
     /// Instancing support flag.
     bool instancingSupport_{};
+    /// Multi-draw instancing support flag.
+    bool multiDrawSupport_{};
     /// sRGB conversion on read support flag.
     bool sRGBSupport_{};
     /// sRGB conversion on write support flag.
     bool sRGBWriteSupport_{};
+    /// GPU timer query support flag.
+    bool gpuTimingSupport_{};
+    /// Asynchronous readback support flag.
+    bool asyncReadbackSupport_{};
+    /// Supported compressed vertex element types as a bitmask indexed by the element type.
+    unsigned compressedVertexSupport_{};
+    /// GPU timing enabled flag.
+    bool gpuTiming_{};
+    /// GPU timing of the current frame in progress flag.
+    bool gpuTimerFrameActive_{};
+    /// GPU timing frames waiting for the timer query results.
+    GPUTimerFrame gpuTimerFrames_[GPU_TIMER_FRAMES];
+    /// Index of the current GPU timing frame.
+    unsigned gpuTimerFrameIndex_{};
+    /// Block indices of the open GPU timing blocks, M_MAX_UNSIGNED for blocks that were dropped.
+    PODVector<unsigned> gpuTimerBlockStack_;
+    /// Timestamps read from the timer queries.
+    PODVector<long long> gpuTimerResults_;
+    /// GPU time of the latest measured frame in microseconds.
+    long long gpuFrameTime_{};
+    /// Readbacks waiting for the GPU, in request order.
+    Vector<SharedPtr<GPUReadback> > pendingReadbacks_;
     /// Number of primitives this frame.
     unsigned numPrimitives_{};
     /// Number of batches this frame.
@@ -789,6 +923,8 @@ private:
     mutable String lastShaderName_;
     /// Shader precache utility.
     SharedPtr<ShaderPrecache> shaderPrecache_;
+    /// Asynchronous shader precache loader.
+    SharedPtr<ShaderPrecacheLoader> shaderPrecacheLoader_;
     /// Allowed screen orientations.
     String orientations_;
     /// Graphics API name.
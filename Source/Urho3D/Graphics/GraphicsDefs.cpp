@@ -89,6 +89,9 @@ extern URHO3D_API const StringHash PSP_LIGHTRAD("LightRad");
 extern URHO3D_API const StringHash PSP_LIGHTLENGTH("LightLength");
 extern URHO3D_API const StringHash PSP_ZONEMIN("ZoneMin");
 extern URHO3D_API const StringHash PSP_ZONEMAX("ZoneMax");
+extern URHO3D_API const StringHash PSP_CLUSTERMATRIX("ClusterMatrix");
+extern URHO3D_API const StringHash PSP_CLUSTERPARAMS("ClusterParams");
+extern URHO3D_API const StringHash PSP_OCCLUSIONDEPTHSTEP("OcclusionDepthStep");
 
 extern URHO3D_API const Vector3 DOT_SCALE(1 / 3.0f, 1 / 3.0f, 1 / 3.0f);
 
@@ -118,6 +121,13 @@ extern URHO3D_API const unsigned ELEMENT_TYPESIZES[] =
     3 * sizeof(float),
     4 * sizeof(float),
     sizeof(unsigned),
+    sizeof(unsigned),
+    2 * sizeof(unsigned short),
+    4 * sizeof(unsigned short),
+    2 * sizeof(short),
+    4 * sizeof(short),
+    2 * sizeof(unsigned short),
+    4 * sizeof(unsigned short),
     sizeof(unsigned)
 };
 
@@ -159,6 +159,15 @@ enum VertexElementType
     TYPE_VECTOR4,
     TYPE_UBYTE4,
     TYPE_UBYTE4_NORM,
+    // The compressed types below depend on hardware support, see Graphics::GetVertexElementTypeSupport()
+    TYPE_HALF2,
+    TYPE_HALF4,
+    TYPE_SHORT2_NORM,
+    TYPE_SHORT4_NORM,
+    TYPE_USHORT2_NORM,
+    TYPE_USHORT4_NORM,
+    // 10 bits for each of XYZ and 2 bits for W, unsigned normalized. Not supported on D3D9
+    TYPE_UINT_10_10_10_2_NORM,
     MAX_VERTEX_ELEMENT_TYPES
 };
 
@@ -218,6 +227,23 @@ struct URHO3D_API VertexElement
     unsigned offset_;
 };
 
+/// Draw command for one of several instanced geometries drawn from the same vertex and index buffers.
+struct URHO3D_API InstancedDrawCommand
+{
+    /// Index start.
+    unsigned indexStart_;
+    /// Index count.
+    unsigned indexCount_;
+    /// First vertex referenced by the indices.
+    unsigned minVertex_;
+    /// Number of vertices referenced by the indices.
+    unsigned vertexCount_;
+    /// Start index in the instancing vertex buffer.
+    unsigned instanceStart_;
+    /// Number of instances.
+    unsigned instanceCount_;
+};
+
 /// Sizes of vertex element types.
 extern URHO3D_API const unsigned ELEMENT_TYPESIZES[];
 
@@ -427,6 +453,9 @@ extern URHO3D_API const StringHash PSP_LIGHTRAD;
 extern URHO3D_API const StringHash PSP_LIGHTLENGTH;
 extern URHO3D_API const StringHash PSP_ZONEMIN;
 extern URHO3D_API const StringHash PSP_ZONEMAX;
+extern URHO3D_API const StringHash PSP_CLUSTERMATRIX;
+extern URHO3D_API const StringHash PSP_CLUSTERPARAMS;
+extern URHO3D_API const StringHash PSP_OCCLUSIONDEPTHSTEP;
 
 // Scale calculation from bounding box diagonal.
 extern URHO3D_API const Vector3 DOT_SCALE;
@@ -471,6 +500,8 @@ URHO3D_FLAGSET(VertexMask, VertexMaskFlags);
 static const int MAX_RENDERTARGETS = 4;
 static const int MAX_VERTEX_STREAMS = 4;
 static const int MAX_CONSTANT_REGISTERS = 256;
+static const unsigned GPU_TIMER_FRAMES = 4;
+static const unsigned MAX_GPU_TIMER_QUERIES = 256;
 
 static const int BITS_PER_COMPONENT = 8;
 }
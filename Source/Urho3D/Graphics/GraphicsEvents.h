@@ -133,6 +133,24 @@ URHO3D_EVENT(E_RENDERPATHEVENT, RenderPathEvent)
     URHO3D_PARAM(P_NAME, Name);                    // String
 }
 
+/// Shader combinations have been loaded by ShaderPrecacheLoader.
+URHO3D_EVENT(E_SHADERPRECACHEPROGRESS, ShaderPrecacheProgress)
+{
+    URHO3D_PARAM(P_LOADED, Loaded);                // int
+    URHO3D_PARAM(P_TOTAL, Total);                  // int
+}
+
+/// All shader combinations have been loaded by ShaderPrecacheLoader.
+URHO3D_EVENT(E_SHADERPRECACHEFINISHED, ShaderPrecacheFinished)
+{
+}
+
+/// Asynchronous texture or backbuffer readback has completed. Check the readback for failure before using the data.
+URHO3D_EVENT(E_GPUREADBACKCOMPLETE, GPUReadbackComplete)
+{
+    URHO3D_PARAM(P_READBACK, Readback);            // GPUReadback pointer
+}
+
 /// Graphics context has been lost. Some or all (depending on the API) GPU objects have lost their contents.
 URHO3D_EVENT(E_DEVICELOST, DeviceLost)
 {
@@ -0,0 +1,450 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/HLODGroup.h"
+#include "../Graphics/IndexBuffer.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/Log.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+
+static const StringVector memberNodesStructureElementNames =
+{
+    "Member Count",
+    "   NodeID"
+};
+
+/// Merged proxy geometry for one material and vertex format.
+struct HLODProxyGeometry
+{
+    /// Material.
+    SharedPtr<Material> material_;
+    /// Vertex elements.
+    PODVector<VertexElement> elements_;
+    /// Vertex size.
+    unsigned vertexSize_;
+    /// Vertex data.
+    PODVector<unsigned char> vertexData_;
+    /// Indices.
+    PODVector<unsigned> indices_;
+};
+
+HLODGroup::HLODGroup(Context* context) :
+    StaticModel(context)
+{
+    // The group itself is rendered only when the proxy is active
+    hlodGroup_ = this;
+
+    // Initialize the default node IDs attribute
+    UpdateNodeIDs();
+}
+
+HLODGroup::~HLODGroup()
+{
+    ClearMembers();
+}
+
+void HLODGroup::RegisterObject(Context* context)
+{
+    context->RegisterFactory<HLODGroup>(GEOMETRY_CATEGORY);
+
+    URHO3D_COPY_BASE_ATTRIBUTES(StaticModel);
+    URHO3D_ACCESSOR_ATTRIBUTE("Switch Distance", GetSwitchDistance, SetSwitchDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Member Nodes", GetNodeIDsAttr, SetNodeIDsAttr,
+        VariantVector, Variant::emptyVariantVector, AM_DEFAULT | AM_NODEIDVECTOR)
+        .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, memberNodesStructureElementNames);
+}
+
+void HLODGroup::ApplyAttributes()
+{
+    if (!nodesDirty_)
+        return;
+
+    memberNodes_.Clear();
+
+    Scene* scene = GetScene();
+    if (scene)
+    {
+        // The first index stores the number of IDs redundantly. This is for editing
+        for (unsigned i = 1; i < nodeIDsAttr_.Size(); ++i)
+        {
+            Node* node = scene->GetNode(nodeIDsAttr_[i].GetUInt());
+            if (node)
+                memberNodes_.Push(WeakPtr<Node>(node));
+        }
+    }
+
+    nodesDirty_ = false;
+    UpdateMembers();
+}
+
+void HLODGroup::AddMemberNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> memberWeak(node);
+    if (memberNodes_.Contains(memberWeak))
+        return;
+
+    memberNodes_.Push(memberWeak);
+    nodeIDsDirty_ = true;
+    UpdateMembers();
+    MarkNetworkUpdate();
+}
+
+void HLODGroup::RemoveMemberNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> memberWeak(node);
+    Vector<WeakPtr<Node> >::Iterator i = memberNodes_.Find(memberWeak);
+    if (i == memberNodes_.End())
+        return;
+
+    memberNodes_.Erase(i);
+    nodeIDsDirty_ = true;
+    UpdateMembers();
+    MarkNetworkUpdate();
+}
+
+void HLODGroup::RemoveAllMemberNodes()
+{
+    memberNodes_.Clear();
+    nodeIDsDirty_ = true;
+    UpdateMembers();
+    MarkNetworkUpdate();
+}
+
+void HLODGroup::UpdateMembers()
+{
+    ClearMembers();
+
+    PODVector<Drawable*> drawables;
+    for (unsigned i = 0; i < memberNodes_.Size(); ++i)
+    {
+        Node* node = memberNodes_[i];
+        if (!node)
+            continue;
+
+        node->GetDerivedComponents<Drawable>(drawables, true);
+        for (unsigned j = 0; j < drawables.Size(); ++j)
+        {
+            Drawable* drawable = drawables[j];
+            // Groups are not nested, and a drawable can belong to one group only
+            if (drawable == this || drawable->GetHLODGroup())
+                continue;
+
+            drawable->SetHLODGroup(this);
+            memberDrawables_.Push(WeakPtr<Drawable>(drawable));
+        }
+    }
+}
+
+void HLODGroup::SetSwitchDistance(float distance)
+{
+    switchDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+bool HLODGroup::BuildProxyModel()
+{
+    if (!node_)
+    {
+        URHO3D_LOGERROR("Can not build HLOD proxy model without a scene node");
+        return false;
+    }
+
+    Vector<HLODProxyGeometry> proxyGeometries;
+    BoundingBox proxyBox;
+    Matrix3x4 groupInverse = node_->GetWorldTransform().Inverse();
+
+    for (unsigned i = 0; i < memberDrawables_.Size(); ++i)
+    {
+        // Only plain static models can be merged. Other drawables stay visible as they are
+        auto* member = dynamic_cast<StaticModel*>(memberDrawables_[i].Get());
+        Model* model = member ? member->GetModel() : nullptr;
+        if (!model || member->GetType() != StaticModel::GetTypeStatic())
+            continue;
+
+        Matrix3x4 transform = groupInverse * member->GetNode()->GetWorldTransform();
+        Matrix3 normalTransform = transform.ToMatrix3().Inverse().Transpose();
+        Matrix3 rotation = transform.RotationMatrix();
+
+        for (unsigned j = 0; j < model->GetNumGeometries(); ++j)
+        {
+            // Use the coarsest LOD level, as the proxy is only seen from a distance
+            Geometry* geometry = model->GetGeometry(j, model->GetNumGeometryLodLevels(j) - 1);
+            if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
+                continue;
+
+            const unsigned char* vertexData;
+            const unsigned char* indexData;
+            unsigned vertexSize;
+            unsigned indexSize;
+            const PODVector<VertexElement>* elements;
+            geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+            if (!vertexData || !indexData || !elements ||
+                VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) == M_MAX_UNSIGNED)
+            {
+                URHO3D_LOGWARNING("Skipping geometry without CPU-side data in HLOD proxy model");
+                continue;
+            }
+
+            Material* material = member->GetMaterial(j);
+            HLODProxyGeometry* proxy = nullptr;
+            for (unsigned k = 0; k < proxyGeometries.Size(); ++k)
+            {
+                if (proxyGeometries[k].material_ == material && proxyGeometries[k].elements_ == *elements)
+                {
+                    proxy = &proxyGeometries[k];
+                    break;
+                }
+            }
+            if (!proxy)
+            {
+                proxyGeometries.Resize(proxyGeometries.Size() + 1);
+                proxy = &proxyGeometries.Back();
+                proxy->material_ = material;
+                proxy->elements_ = *elements;
+                proxy->vertexSize_ = vertexSize;
+            }
+
+            // Copy the used vertex range, transformed into the group node's space
+            unsigned vertexStart = geometry->GetVertexStart();
+            unsigned vertexCount = geometry->GetVertexCount();
+            unsigned baseVertex = proxy->vertexData_.Size() / vertexSize;
+            proxy->vertexData_.Resize(proxy->vertexData_.Size() + vertexCount * vertexSize);
+            unsigned char* dest = &proxy->vertexData_[baseVertex * vertexSize];
+            memcpy(dest, vertexData + vertexStart * vertexSize, vertexCount * vertexSize);
+
+            unsigned positionOffset = VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION);
+            unsigned normalOffset = VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_NORMAL);
+            unsigned tangentOffset = VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR4, SEM_TANGENT);
+
+            for (unsigned k = 0; k < vertexCount; ++k)
+            {
+                unsigned char* vertex = dest + k * vertexSize;
+
+                auto& position = *reinterpret_cast<Vector3*>(vertex + positionOffset);
+                position = transform * position;
+                proxyBox.Merge(position);
+
+                if (normalOffset != M_MAX_UNSIGNED)
+                {
+                    auto& normal = *reinterpret_cast<Vector3*>(vertex + normalOffset);
+                    normal = (normalTransform * normal).Normalized();
+                }
+                if (tangentOffset != M_MAX_UNSIGNED)
+                {
+                    auto& tangent = *reinterpret_cast<Vector3*>(vertex + tangentOffset);
+                    tangent = (rotation * tangent).Normalized();
+                }
+            }
+
+            unsigned indexStart = geometry->GetIndexStart();
+            unsigned indexCount = geometry->GetIndexCount();
+            for (unsigned k = indexStart; k < indexStart + indexCount; ++k)
+            {
+                unsigned index = indexSize == sizeof(unsigned) ? reinterpret_cast<const unsigned*>(indexData)[k] :
+                    reinterpret_cast<const unsigned short*>(indexData)[k];
+                proxy->indices_.Push(index - vertexStart + baseVertex);
+            }
+        }
+    }
+
+    if (proxyGeometries.Empty())
+    {
+        URHO3D_LOGERROR("No static model geometries to build HLOD proxy model from");
+        return false;
+    }
+
+    SharedPtr<Model> proxyModel(new Model(context_));
+    Vector<SharedPtr<VertexBuffer> > vertexBuffers;
+    Vector<SharedPtr<IndexBuffer> > indexBuffers;
+    PODVector<unsigned> morphRangeStarts;
+    PODVector<unsigned> morphRangeCounts;
+
+    proxyModel->SetNumGeometries(proxyGeometries.Size());
+
+    for (unsigned i = 0; i < proxyGeometries.Size(); ++i)
+    {
+        const HLODProxyGeometry& proxy = proxyGeometries[i];
+        unsigned vertexCount = proxy.vertexData_.Size() / proxy.vertexSize_;
+
+        SharedPtr<VertexBuffer> vertexBuffer(new VertexBuffer(context_));
+        vertexBuffer->SetShadowed(true);
+        vertexBuffer->SetSize(vertexCount, proxy.elements_);
+        vertexBuffer->SetData(proxy.vertexData_.Buffer());
+
+        SharedPtr<IndexBuffer> indexBuffer(new IndexBuffer(context_));
+        indexBuffer->SetShadowed(true);
+        if (vertexCount > 65535)
+        {
+            indexBuffer->SetSize(proxy.indices_.Size(), true);
+            indexBuffer->SetData(proxy.indices_.Buffer());
+        }
+        else
+        {
+            PODVector<unsigned short> shortIndices(proxy.indices_.Size());
+            for (unsigned j = 0; j < proxy.indices_.Size(); ++j)
+                shortIndices[j] = (unsigned short)proxy.indices_[j];
+            indexBuffer->SetSize(shortIndices.Size(), false);
+            indexBuffer->SetData(shortIndices.Buffer());
+        }
+
+        SharedPtr<Geometry> geometry(new Geometry(context_));
+        geometry->SetVertexBuffer(0, vertexBuffer);
+        geometry->SetIndexBuffer(indexBuffer);
+        geometry->SetDrawRange(TRIANGLE_LIST, 0, proxy.indices_.Size(), 0, vertexCount);
+
+        proxyModel->SetNumGeometryLodLevels(i, 1);
+        proxyModel->SetGeometry(i, 0, geometry);
+
+        vertexBuffers.Push(vertexBuffer);
+        indexBuffers.Push(indexBuffer);
+        morphRangeStarts.Push(0);
+        morphRangeCounts.Push(0);
+    }
+
+    proxyModel->SetVertexBuffers(vertexBuffers, morphRangeStarts, morphRangeCounts);
+    proxyModel->SetIndexBuffers(indexBuffers);
+    proxyModel->SetBoundingBox(proxyBox);
+
+    SetModel(proxyModel);
+    for (unsigned i = 0; i < proxyGeometries.Size(); ++i)
+        SetMaterial(i, proxyGeometries[i].material_);
+
+    return true;
+}
+
+Node* HLODGroup::GetMemberNode(unsigned index) const
+{
+    return index < memberNodes_.Size() ? memberNodes_[index] : nullptr;
+}
+
+bool HLODGroup::IsProxyActive(Camera* camera) const
+{
+    if (!model_ || switchDistance_ <= 0.0f || !camera)
+        return false;
+
+    // The world bounding box has been updated by the octree before the view is culled
+    float distance = camera->GetDistance(worldBoundingBox_.Center());
+    return camera->GetLodDistance(distance, 1.0f, 1.0f) > switchDistance_;
+}
+
+void HLODGroup::SetNodeIDsAttr(const VariantVector& value)
+{
+    // Just remember the node IDs. They need to go through the SceneResolver, and we actually find the nodes during
+    // ApplyAttributes()
+    if (value.Size())
+    {
+        nodeIDsAttr_.Clear();
+
+        unsigned index = 0;
+        unsigned numMembers = value[index++].GetUInt();
+        // Prevent crash on entering negative value in the editor
+        if (numMembers > M_MAX_INT)
+            numMembers = 0;
+
+        nodeIDsAttr_.Push(numMembers);
+        while (numMembers--)
+        {
+            // If vector contains less IDs than should, fill the rest with zeroes
+            if (index < value.Size())
+                nodeIDsAttr_.Push(value[index++].GetUInt());
+            else
+                nodeIDsAttr_.Push(0);
+        }
+    }
+    else
+    {
+        nodeIDsAttr_.Clear();
+        nodeIDsAttr_.Push(0);
+    }
+
+    nodesDirty_ = true;
+    nodeIDsDirty_ = false;
+}
+
+const VariantVector& HLODGroup::GetNodeIDsAttr() const
+{
+    if (nodeIDsDirty_)
+        UpdateNodeIDs();
+
+    return nodeIDsAttr_;
+}
+
+void HLODGroup::OnSceneSet(Scene* scene)
+{
+    StaticModel::OnSceneSet(scene);
+
+    // Members are shown normally while the group is not in a scene
+    if (scene)
+        UpdateMembers();
+    else
+        ClearMembers();
+}
+
+void HLODGroup::ClearMembers()
+{
+    for (unsigned i = 0; i < memberDrawables_.Size(); ++i)
+    {
+        Drawable* drawable = memberDrawables_[i];
+        if (drawable && drawable->GetHLODGroup() == this)
+            drawable->SetHLODGroup(nullptr);
+    }
+
+    memberDrawables_.Clear();
+}
+
+void HLODGroup::UpdateNodeIDs() const
+{
+    unsigned numMembers = memberNodes_.Size();
+
+    nodeIDsAttr_.Clear();
+    nodeIDsAttr_.Push(numMembers);
+
+    for (unsigned i = 0; i < numMembers; ++i)
+    {
+        Node* node = memberNodes_[i];
+        nodeIDsAttr_.Push(node ? node->GetID() : 0);
+    }
+
+    nodeIDsDirty_ = false;
+}
+
+}
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Graphics/StaticModel.h"
+
+namespace Urho3D
+{
+
+/// Hierarchical LOD cluster. Renders a merged proxy model in place of the drawables of its member nodes when the camera is further than the switch distance.
+class URHO3D_API HLODGroup : public StaticModel
+{
+    URHO3D_OBJECT(HLODGroup, StaticModel);
+
+public:
+    /// Construct.
+    explicit HLODGroup(Context* context);
+    /// Destruct.
+    ~HLODGroup() override;
+    /// Register object factory. StaticModel must be registered first.
+    static void RegisterObject(Context* context);
+
+    /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
+    void ApplyAttributes() override;
+
+    /// Add a member scene node. The drawables of the node and its children are replaced by the proxy at a distance.
+    void AddMemberNode(Node* node);
+    /// Remove a member scene node.
+    void RemoveMemberNode(Node* node);
+    /// Remove all member scene nodes.
+    void RemoveAllMemberNodes();
+    /// Re-find the drawables of the member nodes. Call after adding or removing drawables in the member nodes.
+    void UpdateMembers();
+    /// Set distance beyond which the proxy replaces the members. Zero (default) never uses the proxy.
+    void SetSwitchDistance(float distance);
+    /// Merge the static models of the members into a proxy model, using their lowest LOD levels. Geometries with the same material and vertex format are merged into one. The model can then be saved, and have its geometries and materials replaced with atlased ones in a modeling tool. Return true if successful.
+    bool BuildProxyModel();
+
+    /// Return number of member nodes.
+    unsigned GetNumMemberNodes() const { return memberNodes_.Size(); }
+    /// Return member node by index.
+    Node* GetMemberNode(unsigned index) const;
+    /// Return number of member drawables.
+    unsigned GetNumMemberDrawables() const { return memberDrawables_.Size(); }
+    /// Return distance beyond which the proxy replaces the members.
+    float GetSwitchDistance() const { return switchDistance_; }
+    /// Return whether the proxy replaces the members when viewed from a camera. May be called from a worker thread.
+    bool IsProxyActive(Camera* camera) const;
+
+    /// Set node IDs attribute.
+    void SetNodeIDsAttr(const VariantVector& value);
+    /// Return node IDs attribute.
+    const VariantVector& GetNodeIDsAttr() const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Clear the group from the member drawables.
+    void ClearMembers();
+    /// Update node IDs attribute from the actual nodes.
+    void UpdateNodeIDs() const;
+
+    /// Member nodes.
+    Vector<WeakPtr<Node> > memberNodes_;
+    /// Drawables of the member nodes.
+    Vector<WeakPtr<Drawable> > memberDrawables_;
+    /// IDs of member nodes for serialization.
+    mutable VariantVector nodeIDsAttr_;
+    /// Switch distance.
+    float switchDistance_{};
+    /// Whether node IDs have been set and nodes should be searched for during ApplyAttributes.
+    bool nodesDirty_{};
+    /// Whether nodes have been manipulated by the API and node ID attribute should be refreshed.
+    mutable bool nodeIDsDirty_{};
+};
+
+}
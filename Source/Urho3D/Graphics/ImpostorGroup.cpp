@@ -0,0 +1,597 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/GraphicsEvents.h"
+#include "../Graphics/ImpostorGroup.h"
+#include "../Graphics/IndexBuffer.h"
+#include "../Graphics/Light.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/Octree.h"
+#include "../Graphics/StaticModel.h"
+#include "../Graphics/Technique.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../Graphics/Viewport.h"
+#include "../Graphics/Zone.h"
+#include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+
+static const unsigned DEFAULT_NUM_ANGLES = 8;
+static const float DEFAULT_SWITCH_DISTANCE = 100.0f;
+
+static const StringVector instanceNodesStructureElementNames =
+{
+    "Instance Count",
+    "   NodeID"
+};
+
+/// Return the impostor quad size that covers a model of the given bounding box size from any angle around the vertical axis.
+static float GetImpostorSize(const Vector3& boxSize)
+{
+    return Max(boxSize.y_, sqrtf(boxSize.x_ * boxSize.x_ + boxSize.z_ * boxSize.z_));
+}
+
+ImpostorGroup::ImpostorGroup(Context* context) :
+    Drawable(context, DRAWABLE_GEOMETRY),
+    geometry_(new Geometry(context)),
+    vertexBuffer_(new VertexBuffer(context_)),
+    indexBuffer_(new IndexBuffer(context_)),
+    numAngles_(DEFAULT_NUM_ANGLES),
+    switchDistance_(DEFAULT_SWITCH_DISTANCE)
+{
+    geometry_->SetVertexBuffer(0, vertexBuffer_);
+    geometry_->SetIndexBuffer(indexBuffer_);
+
+    // The vertices are in world space
+    batches_.Resize(1);
+    batches_[0].geometry_ = geometry_;
+    batches_[0].geometryType_ = GEOM_STATIC_NOINSTANCING;
+    batches_[0].worldTransform_ = &Matrix3x4::IDENTITY;
+
+    // Initialize the default node IDs attribute
+    UpdateNodeIDs();
+}
+
+ImpostorGroup::~ImpostorGroup() = default;
+
+void ImpostorGroup::RegisterObject(Context* context)
+{
+    context->RegisterFactory<ImpostorGroup>(GEOMETRY_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Model", GetModelAttr, SetModelAttr, ResourceRef, ResourceRef(Model::GetTypeStatic()), AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Material", GetMaterialAttr, SetMaterialAttr, ResourceRef, ResourceRef(Material::GetTypeStatic()),
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Number of Angles", GetNumAngles, SetNumAngles, unsigned, DEFAULT_NUM_ANGLES, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Switch Distance", GetSwitchDistance, SetSwitchDistance, float, DEFAULT_SWITCH_DISTANCE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("View Mask", int, viewMask_, DEFAULT_VIEWMASK, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Light Mask", int, lightMask_, DEFAULT_LIGHTMASK, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Zone Mask", int, zoneMask_, DEFAULT_ZONEMASK, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Instance Nodes", GetNodeIDsAttr, SetNodeIDsAttr,
+        VariantVector, Variant::emptyVariantVector, AM_DEFAULT | AM_NODEIDVECTOR)
+        .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, instanceNodesStructureElementNames);
+}
+
+void ImpostorGroup::ApplyAttributes()
+{
+    if (!nodesDirty_)
+        return;
+
+    // Remove all old instance nodes before searching for new
+    for (unsigned i = 0; i < instanceNodes_.Size(); ++i)
+    {
+        Node* node = instanceNodes_[i];
+        if (node)
+            node->RemoveListener(this);
+    }
+
+    instanceNodes_.Clear();
+
+    Scene* scene = GetScene();
+    if (scene)
+    {
+        // The first index stores the number of IDs redundantly. This is for editing
+        for (unsigned i = 1; i < nodeIDsAttr_.Size(); ++i)
+        {
+            Node* node = scene->GetNode(nodeIDsAttr_[i].GetUInt());
+            if (node)
+            {
+                WeakPtr<Node> instanceWeak(node);
+                node->AddListener(this);
+                instanceNodes_.Push(instanceWeak);
+                ApplySwitchDistance(node);
+            }
+        }
+    }
+
+    worldTransforms_.Resize(instanceNodes_.Size());
+    numWorldTransforms_ = 0; // Correct amount will be found during world bounding box update
+    nodesDirty_ = false;
+
+    OnMarkedDirty(GetNode());
+}
+
+void ImpostorGroup::UpdateBatches(const FrameInfo& frame)
+{
+    // Getting the world bounding box ensures the instance transforms are updated
+    const BoundingBox& worldBoundingBox = GetWorldBoundingBox();
+    distance_ = frame.camera_->GetDistance(worldBoundingBox.Center());
+    batches_[0].distance_ = distance_;
+}
+
+void ImpostorGroup::UpdateGeometry(const FrameInfo& frame)
+{
+    if (bufferDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+        UpdateBuffers();
+}
+
+UpdateGeometryType ImpostorGroup::GetUpdateGeometryType()
+{
+    if (bufferDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+        return UPDATE_MAIN_THREAD;
+    else
+        return UPDATE_NONE;
+}
+
+void ImpostorGroup::SetModel(Model* model)
+{
+    if (model == model_)
+        return;
+
+    model_ = model;
+    bufferDirty_ = true;
+    OnMarkedDirty(GetNode());
+    MarkNetworkUpdate();
+}
+
+void ImpostorGroup::SetMaterial(Material* material)
+{
+    batches_[0].material_ = material;
+    MarkNetworkUpdate();
+}
+
+void ImpostorGroup::SetNumAngles(unsigned num)
+{
+    num = Max(num, 1U);
+    if (num == numAngles_)
+        return;
+
+    numAngles_ = num;
+    bufferDirty_ = true;
+    MarkNetworkUpdate();
+}
+
+void ImpostorGroup::SetSwitchDistance(float distance)
+{
+    distance = Max(distance, 0.0f);
+    if (distance == switchDistance_)
+        return;
+
+    switchDistance_ = distance;
+    for (unsigned i = 0; i < instanceNodes_.Size(); ++i)
+        ApplySwitchDistance(instanceNodes_[i]);
+
+    bufferDirty_ = true;
+    MarkNetworkUpdate();
+}
+
+void ImpostorGroup::AddInstanceNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> instanceWeak(node);
+    if (instanceNodes_.Contains(instanceWeak))
+        return;
+
+    // Add as a listener for the instance node, so that we know to dirty the impostors when the node moves or is enabled/disabled
+    node->AddListener(this);
+    instanceNodes_.Push(instanceWeak);
+    ApplySwitchDistance(node);
+    UpdateNumInstances();
+}
+
+void ImpostorGroup::RemoveInstanceNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> instanceWeak(node);
+    Vector<WeakPtr<Node> >::Iterator i = instanceNodes_.Find(instanceWeak);
+    if (i == instanceNodes_.End())
+        return;
+
+    node->RemoveListener(this);
+    instanceNodes_.Erase(i);
+    UpdateNumInstances();
+}
+
+void ImpostorGroup::RemoveAllInstanceNodes()
+{
+    for (unsigned i = 0; i < instanceNodes_.Size(); ++i)
+    {
+        Node* node = instanceNodes_[i];
+        if (node)
+            node->RemoveListener(this);
+    }
+
+    instanceNodes_.Clear();
+    UpdateNumInstances();
+}
+
+bool ImpostorGroup::BakeImpostor(StaticModel* source, int cellSize)
+{
+    if (!source || !source->GetModel() || !source->GetNode())
+    {
+        URHO3D_LOGERROR("Null source model for impostor bake");
+        return false;
+    }
+    if (cellSize <= 0)
+    {
+        URHO3D_LOGERROR("Invalid impostor cell size " + String(cellSize));
+        return false;
+    }
+
+    // Can not render in headless mode
+    auto* graphics = GetSubsystem<Graphics>();
+    if (!graphics)
+        return false;
+
+    Model* model = source->GetModel();
+    Vector3 scale = source->GetNode()->GetWorldScale();
+    BoundingBox box = model->GetBoundingBox().Transformed(Matrix3x4(Vector3::ZERO, Quaternion::IDENTITY, scale));
+    Vector3 center = box.Center();
+    float size = GetImpostorSize(box.Size());
+    if (size <= 0.0f)
+    {
+        URHO3D_LOGERROR("Zero-sized model for impostor bake");
+        return false;
+    }
+
+    // Build an offscreen scene with the model lit from a fixed direction and a transparent background
+    bakeScene_ = new Scene(context_);
+    bakeScene_->CreateComponent<Octree>();
+
+    auto* zone = bakeScene_->CreateChild("Zone")->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(center - Vector3::ONE * size * 4.0f, center + Vector3::ONE * size * 4.0f));
+    zone->SetAmbientColor(Color(0.4f, 0.4f, 0.4f));
+    zone->SetFogColor(Color(0.0f, 0.0f, 0.0f, 0.0f));
+    zone->SetFogStart(size * 4.0f);
+    zone->SetFogEnd(size * 8.0f);
+
+    Node* lightNode = bakeScene_->CreateChild("Light");
+    lightNode->SetDirection(Vector3(0.5f, -1.0f, 0.5f));
+    lightNode->CreateComponent<Light>()->SetLightType(LIGHT_DIRECTIONAL);
+
+    Node* modelNode = bakeScene_->CreateChild("Model");
+    modelNode->SetScale(scale);
+    auto* bakeModel = modelNode->CreateComponent<StaticModel>();
+    bakeModel->SetModel(model);
+    for (unsigned i = 0; i < source->GetNumGeometries(); ++i)
+        bakeModel->SetMaterial(i, source->GetMaterial(i));
+
+    impostorTexture_ = new Texture2D(context_);
+    impostorTexture_->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+    impostorTexture_->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+    if (!impostorTexture_->SetSize(cellSize * numAngles_, cellSize, Graphics::GetRGBAFormat(), TEXTURE_RENDERTARGET))
+    {
+        impostorTexture_.Reset();
+        bakeScene_.Reset();
+        return false;
+    }
+
+    // One orthographic view per atlas cell, looking at the model from evenly spaced angles around the vertical axis.
+    // Cell 0 looks at the model's front, and the angle increases clockwise when seen from above
+    RenderSurface* surface = impostorTexture_->GetRenderSurface();
+    surface->SetUpdateMode(SURFACE_MANUALUPDATE);
+    surface->SetNumViewports(numAngles_);
+    for (unsigned i = 0; i < numAngles_; ++i)
+    {
+        float angle = 360.0f * i / numAngles_;
+        Node* cameraNode = bakeScene_->CreateChild("Camera");
+        cameraNode->SetPosition(center + Vector3(Sin(angle), 0.0f, Cos(angle)) * size);
+        cameraNode->LookAt(center);
+        auto* camera = cameraNode->CreateComponent<Camera>();
+        camera->SetOrthographic(true);
+        camera->SetOrthoSize(size);
+        camera->SetFarClip(size * 2.0f);
+
+        IntRect rect(i * cellSize, 0, (i + 1) * cellSize, cellSize);
+        surface->SetViewport(i, new Viewport(context_, bakeScene_, camera, rect));
+    }
+    surface->QueueUpdate();
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    SharedPtr<Material> material(new Material(context_));
+    material->SetTechnique(0, cache->GetResource<Technique>("Techniques/Impostor.xml"));
+    material->SetTexture(TU_DIFFUSE, impostorTexture_);
+
+    SetModel(model);
+    SetMaterial(material);
+
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(ImpostorGroup, HandleEndRendering));
+    return true;
+}
+
+Material* ImpostorGroup::GetMaterial() const
+{
+    return batches_[0].material_;
+}
+
+Node* ImpostorGroup::GetInstanceNode(unsigned index) const
+{
+    return index < instanceNodes_.Size() ? instanceNodes_[index] : nullptr;
+}
+
+void ImpostorGroup::SetModelAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetModel(cache->GetResource<Model>(value.name_));
+}
+
+void ImpostorGroup::SetMaterialAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetMaterial(cache->GetResource<Material>(value.name_));
+}
+
+void ImpostorGroup::SetNodeIDsAttr(const VariantVector& value)
+{
+    // Just remember the node IDs. They need to go through the SceneResolver, and we actually find the nodes during
+    // ApplyAttributes()
+    if (value.Size())
+    {
+        nodeIDsAttr_.Clear();
+
+        unsigned index = 0;
+        unsigned numInstances = value[index++].GetUInt();
+        // Prevent crash on entering negative value in the editor
+        if (numInstances > M_MAX_INT)
+            numInstances = 0;
+
+        nodeIDsAttr_.Push(numInstances);
+        while (numInstances--)
+        {
+            // If vector contains less IDs than should, fill the rest with zeroes
+            if (index < value.Size())
+                nodeIDsAttr_.Push(value[index++].GetUInt());
+            else
+                nodeIDsAttr_.Push(0);
+        }
+    }
+    else
+    {
+        nodeIDsAttr_.Clear();
+        nodeIDsAttr_.Push(0);
+    }
+
+    nodesDirty_ = true;
+    nodeIDsDirty_ = false;
+}
+
+ResourceRef ImpostorGroup::GetModelAttr() const
+{
+    return GetResourceRef(model_, Model::GetTypeStatic());
+}
+
+ResourceRef ImpostorGroup::GetMaterialAttr() const
+{
+    return GetResourceRef(batches_[0].material_, Material::GetTypeStatic());
+}
+
+const VariantVector& ImpostorGroup::GetNodeIDsAttr() const
+{
+    if (nodeIDsDirty_)
+        UpdateNodeIDs();
+
+    return nodeIDsAttr_;
+}
+
+void ImpostorGroup::OnNodeSetEnabled(Node* node)
+{
+    Drawable::OnMarkedDirty(node);
+}
+
+void ImpostorGroup::OnWorldBoundingBoxUpdate()
+{
+    // Store the instance transforms and merge the impostor quads' extents, which cover the model from any angle
+    unsigned index = 0;
+
+    BoundingBox worldBox;
+
+    if (model_)
+    {
+        const BoundingBox& modelBox = model_->GetBoundingBox();
+
+        for (unsigned i = 0; i < instanceNodes_.Size(); ++i)
+        {
+            Node* node = instanceNodes_[i];
+            if (!node || !node->IsEnabled())
+                continue;
+
+            const Matrix3x4& worldTransform = node->GetWorldTransform();
+            worldTransforms_[index++] = worldTransform;
+
+            Vector3 center = worldTransform * modelBox.Center();
+            Vector3 halfSize = Vector3::ONE * 0.5f * GetImpostorSize(modelBox.Size() * worldTransform.Scale());
+            worldBox.Merge(BoundingBox(center - halfSize, center + halfSize));
+        }
+    }
+
+    worldBoundingBox_ = worldBox;
+
+    // Store the amount of valid instances we found instead of resizing worldTransforms_. This is because this function may be
+    // called from multiple worker threads simultaneously
+    numWorldTransforms_ = index;
+    bufferDirty_ = true;
+}
+
+void ImpostorGroup::UpdateNumInstances()
+{
+    worldTransforms_.Resize(instanceNodes_.Size());
+    numWorldTransforms_ = 0; // Correct amount will be found during world bounding box update
+    nodeIDsDirty_ = true;
+
+    OnMarkedDirty(GetNode());
+    MarkNetworkUpdate();
+}
+
+void ImpostorGroup::ApplySwitchDistance(Node* node) const
+{
+    if (!node)
+        return;
+
+    PODVector<StaticModel*> models;
+    node->GetComponents<StaticModel>(models);
+    for (unsigned i = 0; i < models.Size(); ++i)
+        models[i]->SetDrawDistance(switchDistance_);
+}
+
+void ImpostorGroup::UpdateNodeIDs() const
+{
+    unsigned numInstances = instanceNodes_.Size();
+
+    nodeIDsAttr_.Clear();
+    nodeIDsAttr_.Push(numInstances);
+
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        Node* node = instanceNodes_[i];
+        nodeIDsAttr_.Push(node ? node->GetID() : 0);
+    }
+
+    nodeIDsDirty_ = false;
+}
+
+void ImpostorGroup::UpdateBuffers()
+{
+    bufferDirty_ = false;
+
+    // Make sure instance transforms are up-to-date
+    GetWorldBoundingBox();
+
+    unsigned numInstances = model_ ? numWorldTransforms_ : 0;
+    unsigned numVertices = numInstances * 4;
+    unsigned numIndices = numInstances * 6;
+    unsigned indexCapacity = NextPowerOfTwo(numIndices);
+    bool largeIndices = indexCapacity / 6 * 4 > 65536;
+
+    if (vertexBuffer_->GetVertexCount() < numVertices)
+        vertexBuffer_->SetSize(NextPowerOfTwo(numVertices), MASK_POSITION | MASK_TEXCOORD1 | MASK_TEXCOORD2 | MASK_TANGENT, true);
+    if (indexBuffer_->GetIndexCount() < numIndices || indexBuffer_->GetIndexSize() != (largeIndices ? sizeof(unsigned) :
+        sizeof(unsigned short)) || indexBuffer_->IsDataLost())
+    {
+        indexBuffer_->SetSize(indexCapacity, largeIndices);
+
+        // The quads never change their vertex order, so write indices for the whole capacity at once
+        void* destPtr = indexBuffer_->Lock(0, indexCapacity, true);
+        if (destPtr)
+        {
+            for (unsigned i = 0; i < indexCapacity / 6; ++i)
+            {
+                unsigned quad[] = {i * 4, i * 4 + 1, i * 4 + 2, i * 4 + 2, i * 4 + 3, i * 4};
+                for (unsigned j = 0; j < 6; ++j)
+                {
+                    if (largeIndices)
+                        ((unsigned*)destPtr)[i * 6 + j] = quad[j];
+                    else
+                        ((unsigned short*)destPtr)[i * 6 + j] = (unsigned short)quad[j];
+                }
+            }
+            indexBuffer_->Unlock();
+            indexBuffer_->ClearDataLost();
+        }
+    }
+
+    geometry_->SetDrawRange(TRIANGLE_LIST, 0, numIndices, 0, numVertices);
+    if (!numVertices)
+        return;
+
+    auto* dest = (float*)vertexBuffer_->Lock(0, numVertices, true);
+    if (!dest)
+        return;
+
+    static const Vector2 corners[] = {Vector2(-0.5f, 0.5f), Vector2(0.5f, 0.5f), Vector2(0.5f, -0.5f), Vector2(-0.5f, -0.5f)};
+    const BoundingBox& modelBox = model_->GetBoundingBox();
+
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        const Matrix3x4& worldTransform = worldTransforms_[i];
+        Vector3 center = worldTransform * modelBox.Center();
+        float size = GetImpostorSize(modelBox.Size() * worldTransform.Scale());
+
+        // Forward direction on the XZ plane selects the atlas cell in the shader
+        Vector3 forward = worldTransform * Vector4(Vector3::FORWARD, 0.0f);
+        Vector2 forwardXZ(forward.x_, forward.z_);
+        forwardXZ = forwardXZ.LengthSquared() > M_EPSILON ? forwardXZ.Normalized() : Vector2(0.0f, 1.0f);
+
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            dest[0] = center.x_;
+            dest[1] = center.y_;
+            dest[2] = center.z_;
+            dest[3] = corners[j].x_;
+            dest[4] = corners[j].y_;
+            dest[5] = size;
+            dest[6] = size;
+            dest[7] = forwardXZ.x_;
+            dest[8] = forwardXZ.y_;
+            dest[9] = (float)numAngles_;
+            dest[10] = switchDistance_;
+            dest += 11;
+        }
+    }
+
+    vertexBuffer_->Unlock();
+    vertexBuffer_->ClearDataLost();
+}
+
+void ImpostorGroup::HandleEndRendering(StringHash eventType, VariantMap& eventData)
+{
+    // Keep the offscreen scene until the queued update has been rendered
+    if (impostorTexture_ && impostorTexture_->GetRenderSurface()->IsUpdateQueued())
+        return;
+
+    if (impostorTexture_)
+        impostorTexture_->GetRenderSurface()->SetNumViewports(0);
+    bakeScene_.Reset();
+    UnsubscribeFromEvent(E_ENDRENDERING);
+}
+
+}
@@ -0,0 +1,154 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Graphics/Drawable.h"
+
+namespace Urho3D
+{
+
+class IndexBuffer;
+class Model;
+class Scene;
+class StaticModel;
+class Texture2D;
+class VertexBuffer;
+
+/// Renders distant instances of a model as camera-facing impostor quads in one batch. The impostor texture is an atlas of the model seen from several angles around the vertical axis.
+class URHO3D_API ImpostorGroup : public Drawable
+{
+    URHO3D_OBJECT(ImpostorGroup, Drawable);
+
+public:
+    /// Construct.
+    explicit ImpostorGroup(Context* context);
+    /// Destruct.
+    ~ImpostorGroup() override;
+    /// Register object factory. Drawable must be registered first.
+    static void RegisterObject(Context* context);
+
+    /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
+    void ApplyAttributes() override;
+    /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
+    void UpdateBatches(const FrameInfo& frame) override;
+    /// Prepare geometry for rendering.
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
+
+    /// Set the model the impostors stand in for. Its bounding box defines the impostor size.
+    void SetModel(Model* model);
+    /// Set the impostor material. Its diffuse texture should be an atlas of the model in a single row of cells, see BakeImpostor().
+    void SetMaterial(Material* material);
+    /// Set number of view angles in the impostor atlas.
+    void SetNumAngles(unsigned num);
+    /// Set distance beyond which the impostors replace the models. Also applied as the draw distance of the static models in the instance nodes.
+    void SetSwitchDistance(float distance);
+    /// Add an instance scene node. Its static models should use the same model.
+    void AddInstanceNode(Node* node);
+    /// Remove an instance scene node.
+    void RemoveInstanceNode(Node* node);
+    /// Remove all instance scene nodes.
+    void RemoveAllInstanceNodes();
+    /// Render the impostor atlas of a static model offscreen, with cells of the given size in pixels. The model is lit by a fixed directional light. Also sets the model and a material using the atlas. The atlas is rendered during the next frame. Return true if the rendering was queued.
+    bool BakeImpostor(StaticModel* source, int cellSize = 256);
+
+    /// Return model.
+    Model* GetModel() const { return model_; }
+    /// Return impostor material.
+    Material* GetMaterial() const;
+    /// Return number of view angles in the impostor atlas.
+    unsigned GetNumAngles() const { return numAngles_; }
+    /// Return distance beyond which the impostors replace the models.
+    float GetSwitchDistance() const { return switchDistance_; }
+    /// Return number of instance nodes.
+    unsigned GetNumInstanceNodes() const { return instanceNodes_.Size(); }
+    /// Return instance node by index.
+    Node* GetInstanceNode(unsigned index) const;
+    /// Return the atlas texture of the last bake, or null if not baked at runtime.
+    Texture2D* GetImpostorTexture() const { return impostorTexture_; }
+
+    /// Set model attribute.
+    void SetModelAttr(const ResourceRef& value);
+    /// Set material attribute.
+    void SetMaterialAttr(const ResourceRef& value);
+    /// Set node IDs attribute.
+    void SetNodeIDsAttr(const VariantVector& value);
+    /// Return model attribute.
+    ResourceRef GetModelAttr() const;
+    /// Return material attribute.
+    ResourceRef GetMaterialAttr() const;
+    /// Return node IDs attribute.
+    const VariantVector& GetNodeIDsAttr() const;
+
+protected:
+    /// Handle scene node enabled status changing.
+    void OnNodeSetEnabled(Node* node) override;
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    /// Ensure proper size of the instance data when nodes are added/removed. Also mark node IDs dirty.
+    void UpdateNumInstances();
+    /// Apply the switch distance to the static models of an instance node.
+    void ApplySwitchDistance(Node* node) const;
+    /// Update node IDs attribute from the actual nodes.
+    void UpdateNodeIDs() const;
+    /// Rewrite the vertex and index buffers.
+    void UpdateBuffers();
+    /// Release the offscreen scene after the bake has been rendered.
+    void HandleEndRendering(StringHash eventType, VariantMap& eventData);
+
+    /// Model.
+    SharedPtr<Model> model_;
+    /// Geometry.
+    SharedPtr<Geometry> geometry_;
+    /// Vertex buffer.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Index buffer.
+    SharedPtr<IndexBuffer> indexBuffer_;
+    /// Instance nodes.
+    Vector<WeakPtr<Node> > instanceNodes_;
+    /// World transforms of valid (existing and enabled) instances.
+    PODVector<Matrix3x4> worldTransforms_;
+    /// IDs of instance nodes for serialization.
+    mutable VariantVector nodeIDsAttr_;
+    /// Atlas texture rendered by BakeImpostor().
+    SharedPtr<Texture2D> impostorTexture_;
+    /// Offscreen scene used while baking.
+    SharedPtr<Scene> bakeScene_;
+    /// Number of valid instance transforms.
+    unsigned numWorldTransforms_{};
+    /// Number of view angles.
+    unsigned numAngles_;
+    /// Switch distance.
+    float switchDistance_;
+    /// Buffers need rewrite flag.
+    bool bufferDirty_{true};
+    /// Whether node IDs have been set and nodes should be searched for during ApplyAttributes.
+    bool nodesDirty_{};
+    /// Whether nodes have been manipulated by the API and node ID attribute should be refreshed.
+    mutable bool nodeIDsDirty_{};
+};
+
+}
@@ -111,7 +111,8 @@ Light::Light(Context* context) :
     shadowNearFarRatio_(DEFAULT_SHADOWNEARFARRATIO),
     shadowMaxExtrusion_(DEFAULT_SHADOWMAXEXTRUSION),
     perVertex_(false),
-    usePhysicalValues_(false)
+    usePhysicalValues_(false),
+    shadowCaching_(false)
 {
 }
 
@@ -162,6 +163,7 @@ void Light::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Max Extrusion", GetShadowMaxExtrusion, SetShadowMaxExtrusion, float, DEFAULT_SHADOWMAXEXTRUSION, AM_DEFAULT);
     URHO3D_ATTRIBUTE("View Mask", int, viewMask_, DEFAULT_VIEWMASK, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Light Mask", int, lightMask_, DEFAULT_LIGHTMASK, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Shadow Caching", GetShadowCaching, SetShadowCaching, bool, false, AM_DEFAULT);
 }
 
 void Light::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
@@ -271,6 +273,8 @@ void Light::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 void Light::SetLightType(LightType type)
 {
     lightType_ = type;
+    // The light volume changes shape, so refresh the cached query even if the bounding box stays the same
+    queryCache_.octree_ = nullptr;
     OnMarkedDirty(node_);
     MarkNetworkUpdate();
 }
@@ -356,6 +360,12 @@ void Light::SetShadowMaxExtrusion(float extrusion)
     MarkNetworkUpdate();
 }
 
+void Light::SetShadowCaching(bool enable)
+{
+    shadowCaching_ = enable;
+    MarkNetworkUpdate();
+}
+
 void Light::SetFadeDistance(float distance)
 {
     fadeDistance_ = Max(distance, 0.0f);
@@ -539,6 +549,13 @@ ResourceRef Light::GetShapeTextureAttr() const
     return GetResourceRef(shapeTexture_, lightType_ == LIGHT_POINT ? TextureCube::GetTypeStatic() : Texture2D::GetTypeStatic());
 }
 
+void Light::OnSceneSet(Scene* scene)
+{
+    queryCache_.drawables_.Clear();
+    queryCache_.octree_ = nullptr;
+    Drawable::OnSceneSet(scene);
+}
+
 void Light::OnWorldBoundingBoxUpdate()
 {
     switch (lightType_)
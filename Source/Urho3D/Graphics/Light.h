@@ -31,6 +31,7 @@ namespace Urho3D
 {
 
 class Camera;
+class Octree;
 struct LightBatchQueue;
 
 /// %Light types.
@@ -144,10 +145,24 @@ struct URHO3D_API FocusParameters
     float minView_;
 };
 
+/// Octree query result of a point or spot light, shared by the views of a frame.
+struct LightQueryCache
+{
+    /// Drawables in range of the light.
+    PODVector<Drawable*> drawables_;
+    /// Octree queried.
+    Octree* octree_{};
+    /// Drawable layers queried.
+    unsigned viewMask_{};
+    /// Octree change count at the time of the query.
+    unsigned numChanges_{};
+};
+
 /// %Light component.
 class URHO3D_API Light : public Drawable
 {
     URHO3D_OBJECT(Light, Drawable);
+    URHO3D_POOLED_OBJECT(Light);
 
 public:
     /// Construct.
@@ -206,6 +221,8 @@ public:
     void SetShadowNearFarRatio(float nearFarRatio);
     /// Set maximum shadow extrusion for directional lights. The actual extrusion will be the smaller of this and camera far clip. Default 1000.
     void SetShadowMaxExtrusion(float extrusion);
+    /// Set shadow caching. When enabled, the shadow casters that have not moved recently are rendered once into a cached static shadow map, and each frame only the moving casters are rendered on top of it. Requires a depth shadow map on OpenGL (desktop) or Direct3D11.
+    void SetShadowCaching(bool enable);
     /// Set range attenuation texture.
     void SetRampTexture(Texture* texture);
     /// Set spotlight attenuation texture.
@@ -283,6 +300,9 @@ public:
     /// Return maximum shadow extrusion distance for directional lights.
     float GetShadowMaxExtrusion() const { return shadowMaxExtrusion_; }
 
+    /// Return whether shadow caching is enabled.
+    bool GetShadowCaching() const { return shadowCaching_; }
+
     /// Return range attenuation texture.
     Texture* GetRampTexture() const { return rampTexture_; }
 
@@ -311,6 +331,8 @@ public:
 
     /// Return light queue. Called by View.
     LightBatchQueue* GetLightQueue() const { return lightQueue_; }
+    /// Return the octree query cache. Called by View, from one thread at a time.
+    LightQueryCache& GetQueryCache() { return queryCache_; }
 
     /// Return a divisor value based on intensity for calculating the sort value.
     float GetIntensityDivisor(float attenuation = 1.0f) const
@@ -331,6 +353,8 @@ public:
     static Matrix3x4 GetFullscreenQuadTransform(Camera* camera);
 
 protected:
+    /// Handle scene being assigned. Discard the cached query of the previous octree.
+    void OnSceneSet(Scene* scene) override;
     /// Recalculate the world-space bounding box.
     void OnWorldBoundingBoxUpdate() override;
 
@@ -365,6 +389,8 @@ private:
     SharedPtr<Texture> shapeTexture_;
     /// Light queue.
     LightBatchQueue* lightQueue_;
+    /// Octree query cache.
+    LightQueryCache queryCache_;
     /// Specular intensity.
     float specularIntensity_;
     /// Brightness multiplier.
@@ -391,6 +417,8 @@ private:
     bool perVertex_;
     /// Use physical light values flag.
     bool usePhysicalValues_;
+    /// Shadow caching flag.
+    bool shadowCaching_;
 };
 
 inline bool CompareLights(Light* lhs, Light* rhs)
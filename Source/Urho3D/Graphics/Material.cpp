@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Graphics/ConstantBuffer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Renderer.h"
@@ -1173,9 +1174,16 @@ void Material::SortTechniques()
     Sort(techniques_.Begin(), techniques_.End(), CompareTechniqueEntries);
 }
 
-void Material::MarkForAuxView(unsigned frameNumber)
+void Material::MarkForAuxView(unsigned frameNumber, float distance)
 {
     auxViewFrameNumber_ = frameNumber;
+    auxViewDistance_ = distance;
+}
+
+void Material::SetArrayMaterial(Material* material, const PODVector<Vector4>& instanceData)
+{
+    arrayMaterial_ = material;
+    arrayInstanceData_ = material ? instanceData : PODVector<Vector4>();
 }
 
 const TechniqueEntry& Material::GetTechniqueEntry(unsigned index) const
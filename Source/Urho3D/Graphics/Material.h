@@ -31,6 +31,7 @@
 namespace Urho3D
 {
 
+class ConstantBuffer;
 class Material;
 class Pass;
 class Scene;
@@ -52,6 +53,15 @@ struct MaterialShaderParameter
     Variant value_;
 };
 
+/// %Material's shader parameters built into a constant buffer for one parameter layout.
+struct MaterialConstantBuffer
+{
+    /// Constant buffer.
+    SharedPtr<ConstantBuffer> buffer_;
+    /// Shader parameter hash value when the buffer was last filled.
+    unsigned parameterHash_{};
+};
+
 /// %Material's technique list entry.
 struct TechniqueEntry
 {
@@ -181,8 +191,10 @@ public:
     SharedPtr<Material> Clone(const String& cloneName = String::EMPTY) const;
     /// Ensure that material techniques are listed in correct order.
     void SortTechniques();
-    /// Mark material for auxiliary view rendering.
-    void MarkForAuxView(unsigned frameNumber);
+    /// Mark material for auxiliary view rendering, with the camera distance of the nearest drawable using it.
+    void MarkForAuxView(unsigned frameNumber, float distance = 0.0f);
+    /// Set the shared material that has this material's textures packed into texture arrays, and the extra instancing data that selects them. Used by MaterialArray.
+    void SetArrayMaterial(Material* material, const PODVector<Vector4>& instanceData = PODVector<Vector4>());
 
     /// Return number of techniques.
     unsigned GetNumTechniques() const { return techniques_.Size(); }
@@ -243,18 +255,30 @@ public:
     /// Return last auxiliary view rendered frame number.
     unsigned GetAuxViewFrameNumber() const { return auxViewFrameNumber_; }
 
+    /// Return nearest drawable distance recorded for auxiliary view rendering on the last frame.
+    float GetAuxViewDistance() const { return auxViewDistance_; }
+
     /// Return whether should render occlusion.
     bool GetOcclusion() const { return occlusion_; }
 
     /// Return whether should render specular.
     bool GetSpecular() const { return specular_; }
 
+    /// Return the shared texture array material used in instanced rendering.
+    Material* GetArrayMaterial() const { return arrayMaterial_; }
+
+    /// Return the extra instancing data for the texture array material.
+    const PODVector<Vector4>& GetArrayInstanceData() const { return arrayInstanceData_; }
+
     /// Return the scene associated with the material for shader parameter animation updates.
     Scene* GetScene() const;
 
     /// Return shader parameter hash value. Used as an optimization to avoid setting shader parameters unnecessarily.
     unsigned GetShaderParameterHash() const { return shaderParameterHash_; }
 
+    /// Return constant buffers built from the shader parameters, by parameter layout hash. Used by Graphics when constant buffers are in use.
+    HashMap<unsigned, MaterialConstantBuffer>& GetConstantBuffers() { return constantBuffers_; }
+
     /// Return name for texture unit.
     static String GetTextureUnitName(TextureUnit unit);
     /// Parse a shader parameter value from a string. Retunrs either a bool, a float, or a 2 to 4-component vector.
@@ -287,6 +311,8 @@ private:
     HashMap<TextureUnit, SharedPtr<Texture> > textures_;
     /// %Shader parameters.
     HashMap<StringHash, MaterialShaderParameter> shaderParameters_;
+    /// Constant buffers built from the shader parameters, by parameter layout hash.
+    HashMap<unsigned, MaterialConstantBuffer> constantBuffers_;
     /// %Shader parameters animation infos.
     HashMap<StringHash, SharedPtr<ShaderParameterAnimationInfo> > shaderParameterAnimationInfos_;
     /// Vertex shader defines.
@@ -305,6 +331,8 @@ private:
     unsigned char renderOrder_{};
     /// Last auxiliary view rendered frame number.
     unsigned auxViewFrameNumber_{};
+    /// Nearest drawable distance recorded for auxiliary view rendering.
+    float auxViewDistance_{};
     /// Shader parameter hash value.
     unsigned shaderParameterHash_{};
     /// Alpha-to-coverage flag.
@@ -325,6 +353,10 @@ private:
     SharedPtr<JSONFile> loadJSONFile_;
     /// Associated scene for shader parameter animation updates.
     WeakPtr<Scene> scene_;
+    /// Shared texture array material.
+    SharedPtr<Material> arrayMaterial_;
+    /// Extra instancing data for the texture array material.
+    PODVector<Vector4> arrayInstanceData_;
 };
 
 }
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/MaterialArray.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Technique.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/Texture2DArray.h"
+#include "../IO/Log.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const TextureUnit arrayTextureUnits[] = { TU_DIFFUSE, TU_NORMAL, TU_SPECULAR, TU_EMISSIVE };
+static const StringHash PARAM_MATDIFFCOLOR("MatDiffColor");
+static const String TEXARRAY_DEFINE("TEXARRAY");
+
+static bool IsArrayTextureUnit(TextureUnit unit)
+{
+    for (TextureUnit arrayUnit : arrayTextureUnits)
+    {
+        if (unit == arrayUnit)
+            return true;
+    }
+    return false;
+}
+
+static bool CheckCompatibility(Material* first, Material* material)
+{
+    const Vector<TechniqueEntry>& techniques = first->GetTechniques();
+    const Vector<TechniqueEntry>& otherTechniques = material->GetTechniques();
+    if (techniques.Size() != otherTechniques.Size())
+        return false;
+    for (unsigned i = 0; i < techniques.Size(); ++i)
+    {
+        if (techniques[i].original_ != otherTechniques[i].original_ || techniques[i].qualityLevel_ != otherTechniques[i].qualityLevel_ ||
+            techniques[i].lodDistance_ != otherTechniques[i].lodDistance_)
+            return false;
+    }
+
+    if (first->GetVertexShaderDefines() != material->GetVertexShaderDefines() ||
+        first->GetPixelShaderDefines() != material->GetPixelShaderDefines() || first->GetCullMode() != material->GetCullMode() ||
+        first->GetShadowCullMode() != material->GetShadowCullMode() || first->GetFillMode() != material->GetFillMode() ||
+        first->GetDepthBias().constantBias_ != material->GetDepthBias().constantBias_ ||
+        first->GetDepthBias().slopeScaledBias_ != material->GetDepthBias().slopeScaledBias_ ||
+        first->GetAlphaToCoverage() != material->GetAlphaToCoverage() || first->GetLineAntiAlias() != material->GetLineAntiAlias() ||
+        first->GetRenderOrder() != material->GetRenderOrder())
+        return false;
+
+    // Only the diffuse color RGB may differ, as it is passed per instance
+    const HashMap<StringHash, MaterialShaderParameter>& parameters = first->GetShaderParameters();
+    const HashMap<StringHash, MaterialShaderParameter>& otherParameters = material->GetShaderParameters();
+    if (parameters.Size() != otherParameters.Size())
+        return false;
+    for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
+    {
+        HashMap<StringHash, MaterialShaderParameter>::ConstIterator j = otherParameters.Find(i->first_);
+        if (j == otherParameters.End())
+            return false;
+        if (i->first_ == PARAM_MATDIFFCOLOR)
+        {
+            if (i->second_.value_.GetVector4().w_ != j->second_.value_.GetVector4().w_)
+                return false;
+        }
+        else if (i->second_.value_ != j->second_.value_)
+            return false;
+        if (first->GetShaderParameterAnimation(i->second_.name_) || material->GetShaderParameterAnimation(i->second_.name_))
+            return false;
+    }
+
+    // The packed textures must match in size and format, other textures must be shared
+    const HashMap<TextureUnit, SharedPtr<Texture> >& textures = first->GetTextures();
+    const HashMap<TextureUnit, SharedPtr<Texture> >& otherTextures = material->GetTextures();
+    if (textures.Size() != otherTextures.Size())
+        return false;
+    for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
+    {
+        HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator j = otherTextures.Find(i->first_);
+        if (j == otherTextures.End())
+            return false;
+
+        Texture* texture = i->second_;
+        Texture* otherTexture = j->second_;
+        if (IsArrayTextureUnit(i->first_))
+        {
+            if (!texture || !otherTexture || texture->GetType() != Texture2D::GetTypeStatic() ||
+                otherTexture->GetType() != Texture2D::GetTypeStatic() || texture->GetWidth() != otherTexture->GetWidth() ||
+                texture->GetHeight() != otherTexture->GetHeight() || texture->GetFormat() != otherTexture->GetFormat() ||
+                texture->GetLevels() != otherTexture->GetLevels() || texture->GetSRGB() != otherTexture->GetSRGB())
+                return false;
+        }
+        else if (texture != otherTexture)
+            return false;
+    }
+
+    return true;
+}
+
+MaterialArray::MaterialArray(Context* context) :
+    Object(context)
+{
+}
+
+MaterialArray::~MaterialArray()
+{
+    Clear();
+}
+
+bool MaterialArray::Build(const PODVector<Material*>& materials)
+{
+    Clear();
+
+    if (materials.Empty() || materials.Size() > MAX_MATERIAL_ARRAY_SIZE)
+    {
+        URHO3D_LOGERROR("Material array must contain 1 - " + String(MAX_MATERIAL_ARRAY_SIZE) + " materials");
+        return false;
+    }
+
+    auto* graphics = GetSubsystem<Graphics>();
+    if (!graphics)
+        return false;
+    if (!Graphics::GetGL3Support() || !graphics->GetInstancingSupport())
+    {
+        URHO3D_LOGERROR("Material array requires instancing and OpenGL 3 or Direct3D 11");
+        return false;
+    }
+
+    auto* renderer = GetSubsystem<Renderer>();
+    unsigned numElements = renderer ? (unsigned)renderer->GetNumExtraInstancingBufferElements() : 0;
+    if (!numElements)
+        URHO3D_LOGWARNING("Material array is not used until Renderer's extra instancing buffer elements are set to 1 or more");
+
+    Material* first = materials[0];
+    for (unsigned i = 0; i < materials.Size(); ++i)
+    {
+        if (!materials[i] || !CheckCompatibility(first, materials[i]))
+        {
+            URHO3D_LOGERROR("Material " + String(i) + " is not compatible with the material array");
+            return false;
+        }
+    }
+
+    // Alpha masking in the other shaders, like shadow and depth, does not sample texture arrays
+    const Vector<TechniqueEntry>& techniques = first->GetTechniques();
+    for (unsigned i = 0; i < techniques.Size(); ++i)
+    {
+        if (!techniques[i].technique_)
+            continue;
+        PODVector<Pass*> passes = techniques[i].technique_->GetPasses();
+        for (unsigned j = 0; j < passes.Size(); ++j)
+        {
+            if (passes[j]->GetPixelShader() != "LitSolid" && passes[j]->GetPixelShaderDefines().Contains("ALPHAMASK"))
+            {
+                URHO3D_LOGERROR("Material array does not support alpha masking in shader " + passes[j]->GetPixelShader());
+                return false;
+            }
+        }
+    }
+
+    SharedPtr<Material> arrayMaterial = first->Clone();
+    arrayMaterial->SetVertexShaderDefines((first->GetVertexShaderDefines() + " " + TEXARRAY_DEFINE).Trimmed());
+    arrayMaterial->SetPixelShaderDefines((first->GetPixelShaderDefines() + " " + TEXARRAY_DEFINE).Trimmed());
+    float diffAlpha = first->GetShaderParameter("MatDiffColor").GetVector4().w_;
+    arrayMaterial->SetShaderParameter("MatDiffColor", Vector4(1.0f, 1.0f, 1.0f, diffAlpha));
+
+    // Copy each texture unit's textures into the layers of a texture array, using the material index as the layer
+    PODVector<unsigned char> levelData;
+    for (TextureUnit unit : arrayTextureUnits)
+    {
+        auto* firstTexture = static_cast<Texture2D*>(first->GetTexture(unit));
+        if (!firstTexture)
+            continue;
+
+        SharedPtr<Texture2DArray> textureArray(new Texture2DArray(context_));
+        textureArray->SetNumLevels(firstTexture->GetLevels());
+        textureArray->SetFilterMode(firstTexture->GetFilterMode());
+        textureArray->SetAddressMode(COORD_U, firstTexture->GetAddressMode(COORD_U));
+        textureArray->SetAddressMode(COORD_V, firstTexture->GetAddressMode(COORD_V));
+        textureArray->SetAnisotropy(firstTexture->GetAnisotropy());
+        textureArray->SetSRGB(firstTexture->GetSRGB());
+        if (!textureArray->SetSize(materials.Size(), firstTexture->GetWidth(), firstTexture->GetHeight(), firstTexture->GetFormat()))
+            return false;
+
+        for (unsigned layer = 0; layer < materials.Size(); ++layer)
+        {
+            auto* texture = static_cast<Texture2D*>(materials[layer]->GetTexture(unit));
+            for (unsigned level = 0; level < texture->GetLevels(); ++level)
+            {
+                int levelWidth = texture->GetLevelWidth(level);
+                int levelHeight = texture->GetLevelHeight(level);
+                levelData.Resize(texture->GetDataSize(levelWidth, levelHeight));
+                if (!texture->GetData(level, levelData.Buffer()) ||
+                    !textureArray->SetData(layer, level, 0, 0, levelWidth, levelHeight, levelData.Buffer()))
+                {
+                    URHO3D_LOGERROR("Failed to copy texture " + texture->GetName() + " to material array");
+                    return false;
+                }
+            }
+        }
+
+        arrayMaterial->SetTexture(unit, textureArray);
+    }
+
+    // The instance data holds the diffuse color RGB and the layer index
+    arrayMaterial_ = arrayMaterial;
+    PODVector<Vector4> instanceData(Max(numElements, 1U));
+    for (unsigned i = 0; i < materials.Size(); ++i)
+    {
+        Material* material = materials[i];
+        const Vector4& diffColor = material->GetShaderParameter("MatDiffColor").GetVector4();
+        instanceData[0] = Vector4(diffColor.x_, diffColor.y_, diffColor.z_, (float)i);
+        for (unsigned j = 1; j < instanceData.Size(); ++j)
+            instanceData[j] = Vector4::ZERO;
+
+        material->SetArrayMaterial(arrayMaterial_, instanceData);
+        materials_.Push(SharedPtr<Material>(material));
+    }
+
+    return true;
+}
+
+void MaterialArray::Clear()
+{
+    for (unsigned i = 0; i < materials_.Size(); ++i)
+    {
+        if (materials_[i]->GetArrayMaterial() == arrayMaterial_)
+            materials_[i]->SetArrayMaterial(nullptr);
+    }
+
+    materials_.Clear();
+    arrayMaterial_.Reset();
+}
+
+Material* MaterialArray::GetMaterial(unsigned index) const
+{
+    return index < materials_.Size() ? materials_[index] : nullptr;
+}
+
+}
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class Material;
+
+/// Maximum number of materials in a material array.
+static const unsigned MAX_MATERIAL_ARRAY_SIZE = 256;
+
+/// Packs the textures of compatible materials into texture arrays, so that instanced batches using different materials can be drawn together with one shared array material. Requires instancing, OpenGL 3 or Direct3D 11, and shaders that implement the TEXARRAY define.
+class URHO3D_API MaterialArray : public Object
+{
+    URHO3D_OBJECT(MaterialArray, Object);
+
+public:
+    /// Construct.
+    explicit MaterialArray(Context* context);
+    /// Destruct. Removes the array material from the materials.
+    ~MaterialArray() override;
+
+    /// Build the array material and assign it to the materials. The materials must share techniques, shader defines, render state and shader parameters, except for the diffuse color RGB. Textures of each unit must have the same size, format and mip levels. Return true if successful.
+    bool Build(const PODVector<Material*>& materials);
+    /// Remove the array material from the materials.
+    void Clear();
+
+    /// Return the shared array material, or null if not built.
+    Material* GetArrayMaterial() const { return arrayMaterial_; }
+    /// Return number of materials.
+    unsigned GetNumMaterials() const { return materials_.Size(); }
+    /// Return material by index.
+    Material* GetMaterial(unsigned index) const;
+
+private:
+    /// Materials packed into the array.
+    Vector<SharedPtr<Material> > materials_;
+    /// Shared array material.
+    SharedPtr<Material> arrayMaterial_;
+};
+
+}
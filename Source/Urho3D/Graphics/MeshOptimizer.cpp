@@ -0,0 +1,675 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/HashMap.h"
+#include "../Container/Sort.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "../Math/BoundingBox.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Size of the LRU cache simulated when ordering triangles.
+static const unsigned LRU_CACHE_SIZE = 32;
+/// Size of the FIFO cache simulated when splitting triangles into clusters.
+static const unsigned FIFO_CACHE_SIZE = 16;
+/// Score of the vertices of the last emitted triangle.
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+/// Falloff of the score with the position in the LRU cache.
+static const float CACHE_DECAY_POWER = 1.5f;
+/// Score boost of vertices with few remaining triangles.
+static const float VALENCE_BOOST_SCALE = 2.0f;
+
+/// Error quadric of a sum of weighted planes.
+struct Quadric
+{
+    /// Add a plane with a weight.
+    void AddPlane(const Vector3& normal, float d, float weight)
+    {
+        a00_ += normal.x_ * normal.x_ * weight;
+        a11_ += normal.y_ * normal.y_ * weight;
+        a22_ += normal.z_ * normal.z_ * weight;
+        a10_ += normal.y_ * normal.x_ * weight;
+        a20_ += normal.z_ * normal.x_ * weight;
+        a21_ += normal.z_ * normal.y_ * weight;
+        b0_ += normal.x_ * d * weight;
+        b1_ += normal.y_ * d * weight;
+        b2_ += normal.z_ * d * weight;
+        c_ += d * d * weight;
+        weight_ += weight;
+    }
+
+    /// Add another quadric.
+    void Add(const Quadric& rhs)
+    {
+        a00_ += rhs.a00_;
+        a11_ += rhs.a11_;
+        a22_ += rhs.a22_;
+        a10_ += rhs.a10_;
+        a20_ += rhs.a20_;
+        a21_ += rhs.a21_;
+        b0_ += rhs.b0_;
+        b1_ += rhs.b1_;
+        b2_ += rhs.b2_;
+        c_ += rhs.c_;
+        weight_ += rhs.weight_;
+    }
+
+    /// Return the weighted mean of the squared distances of a point to the planes.
+    float Evaluate(const Vector3& point) const
+    {
+        float rx = a00_ * point.x_ + a10_ * point.y_ + a20_ * point.z_;
+        float ry = a10_ * point.x_ + a11_ * point.y_ + a21_ * point.z_;
+        float rz = a20_ * point.x_ + a21_ * point.y_ + a22_ * point.z_;
+        float error = rx * point.x_ + ry * point.y_ + rz * point.z_ + 2.0f * (b0_ * point.x_ + b1_ * point.y_ + b2_ * point.z_) + c_;
+        return weight_ > 0.0f ? Abs(error) / weight_ : 0.0f;
+    }
+
+    float a00_{}, a11_{}, a22_{}, a10_{}, a20_{}, a21_{};
+    float b0_{}, b1_{}, b2_{};
+    float c_{};
+    float weight_{};
+};
+
+/// Edge collapse candidate.
+struct CollapseCandidate
+{
+    /// Error of moving the vertex to the target.
+    float cost_;
+    /// Vertex to remove.
+    unsigned vertex_;
+    /// Vertex to collapse onto.
+    unsigned target_;
+};
+
+/// Score of a vertex by its position in the LRU cache and the number of triangles still to emit, as in Tom Forsyth's linear-speed vertex cache optimization.
+static float GetVertexScore(int cachePosition, unsigned remainingTriangles)
+{
+    if (!remainingTriangles)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+            score = LAST_TRIANGLE_SCORE;
+        else
+            score = Pow(1.0f - (float)(cachePosition - 3) / (float)(LRU_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+    }
+
+    return score + VALENCE_BOOST_SCALE / Sqrt((float)remainingTriangles);
+}
+
+/// Build the lists of the triangles using each vertex.
+static void BuildTriangleAdjacency(PODVector<unsigned>& offsets, PODVector<unsigned>& triangles, const unsigned* indices,
+    unsigned indexCount, unsigned vertexCount)
+{
+    offsets.Resize(vertexCount + 1);
+    for (unsigned i = 0; i <= vertexCount; ++i)
+        offsets[i] = 0;
+    for (unsigned i = 0; i < indexCount; ++i)
+        ++offsets[indices[i] + 1];
+    for (unsigned i = 0; i < vertexCount; ++i)
+        offsets[i + 1] += offsets[i];
+
+    PODVector<unsigned> fill(offsets);
+    triangles.Resize(indexCount);
+    for (unsigned i = 0; i < indexCount; ++i)
+        triangles[fill[indices[i]]++] = i / 3;
+}
+
+/// Simulate a FIFO vertex cache for a triangle and return the number of misses.
+static unsigned UpdateFIFOCache(const unsigned* triangle, PODVector<unsigned>& timestamps, unsigned& time)
+{
+    unsigned misses = 0;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        unsigned& timestamp = timestamps[triangle[i]];
+        if (time - timestamp > FIFO_CACHE_SIZE)
+        {
+            timestamp = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+/// Return the unnormalized normal of a triangle.
+static Vector3 GetTriangleNormal(const Vector3& v0, const Vector3& v1, const Vector3& v2)
+{
+    return (v1 - v0).CrossProduct(v2 - v0);
+}
+
+void OptimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount)
+{
+    unsigned numTriangles = indexCount / 3;
+    if (numTriangles < 2)
+        return;
+
+    PODVector<unsigned> offsets;
+    PODVector<unsigned> adjacency;
+    BuildTriangleAdjacency(offsets, adjacency, indices, numTriangles * 3, vertexCount);
+
+    // The triangles still to emit are kept first in each vertex's adjacency list
+    PODVector<unsigned> remaining(vertexCount);
+    PODVector<int> cachePositions(vertexCount);
+    PODVector<float> vertexScores(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        remaining[i] = offsets[i + 1] - offsets[i];
+        cachePositions[i] = -1;
+        vertexScores[i] = GetVertexScore(-1, remaining[i]);
+    }
+
+    PODVector<float> triangleScores(numTriangles);
+    PODVector<bool> emitted(numTriangles, false);
+    unsigned bestTriangle = 0;
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        const unsigned* triangle = indices + i * 3;
+        triangleScores[i] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+        if (triangleScores[i] > triangleScores[bestTriangle])
+            bestTriangle = i;
+    }
+
+    PODVector<unsigned> result(numTriangles * 3);
+    unsigned cache[LRU_CACHE_SIZE + 3];
+    unsigned newCache[LRU_CACHE_SIZE + 3];
+    unsigned cacheSize = 0;
+    unsigned nextTriangle = 0;
+
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        // At a dead end continue from the next triangle in the original order
+        if (bestTriangle == M_MAX_UNSIGNED)
+        {
+            while (emitted[nextTriangle])
+                ++nextTriangle;
+            bestTriangle = nextTriangle;
+        }
+
+        const unsigned* triangle = indices + bestTriangle * 3;
+        emitted[bestTriangle] = true;
+        result[i * 3] = triangle[0];
+        result[i * 3 + 1] = triangle[1];
+        result[i * 3 + 2] = triangle[2];
+
+        // Move the triangle's vertices to the front of the cache and remove the triangle from their lists
+        unsigned newCacheSize = 0;
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            unsigned vertex = triangle[j];
+            unsigned* begin = &adjacency[offsets[vertex]];
+            unsigned& count = remaining[vertex];
+            for (unsigned k = 0; k < count; ++k)
+            {
+                if (begin[k] == bestTriangle)
+                {
+                    begin[k] = begin[--count];
+                    begin[count] = bestTriangle;
+                    newCache[newCacheSize++] = vertex;
+                    break;
+                }
+            }
+        }
+        for (unsigned j = 0; j < cacheSize; ++j)
+        {
+            unsigned vertex = cache[j];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheSize++] = vertex;
+        }
+
+        // Rescore the cached vertices, including those pushed out, and pick the best triangle using them
+        for (unsigned j = 0; j < newCacheSize; ++j)
+        {
+            unsigned vertex = newCache[j];
+            cachePositions[vertex] = j < LRU_CACHE_SIZE ? (int)j : -1;
+            vertexScores[vertex] = GetVertexScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        bestTriangle = M_MAX_UNSIGNED;
+        float bestScore = 0.0f;
+        for (unsigned j = 0; j < newCacheSize; ++j)
+        {
+            unsigned vertex = newCache[j];
+            const unsigned* begin = &adjacency[offsets[vertex]];
+            for (unsigned k = 0; k < remaining[vertex]; ++k)
+            {
+                unsigned candidate = begin[k];
+                const unsigned* candidateTriangle = indices + candidate * 3;
+                float score = vertexScores[candidateTriangle[0]] + vertexScores[candidateTriangle[1]] +
+                    vertexScores[candidateTriangle[2]];
+                triangleScores[candidate] = score;
+                if (bestTriangle == M_MAX_UNSIGNED || score > bestScore)
+                {
+                    bestTriangle = candidate;
+                    bestScore = score;
+                }
+            }
+        }
+
+        cacheSize = Min(newCacheSize, LRU_CACHE_SIZE);
+        for (unsigned j = 0; j < cacheSize; ++j)
+            cache[j] = newCache[j];
+    }
+
+    memcpy(indices, result.Buffer(), numTriangles * 3 * sizeof(unsigned));
+}
+
+void OptimizeOverdraw(unsigned* indices, unsigned indexCount, const Vector3* positions, unsigned vertexCount, float threshold)
+{
+    unsigned numTriangles = indexCount / 3;
+    if (numTriangles < 2)
+        return;
+
+    // Split into clusters where the cache starts over, meaning the previous triangles could be drawn in any order
+    PODVector<unsigned> timestamps(vertexCount, 0);
+    unsigned time = FIFO_CACHE_SIZE + 1;
+    PODVector<unsigned> hardBoundaries;
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        if (UpdateFIFOCache(indices + i * 3, timestamps, time) == 3 || !i)
+            hardBoundaries.Push(i);
+    }
+    hardBoundaries.Push(numTriangles);
+
+    // Split further as soon as the cache misses of a cluster fall within the threshold of the whole hard cluster's, with the cache starting empty
+    PODVector<unsigned> clusters;
+    for (unsigned i = 0; i < hardBoundaries.Size() - 1; ++i)
+    {
+        unsigned start = hardBoundaries[i];
+        unsigned end = hardBoundaries[i + 1];
+
+        time += FIFO_CACHE_SIZE + 1;
+        unsigned misses = 0;
+        for (unsigned j = start; j < end; ++j)
+            misses += UpdateFIFOCache(indices + j * 3, timestamps, time);
+        float clusterThreshold = threshold * (float)misses / (float)(end - start);
+
+        time += FIFO_CACHE_SIZE + 1;
+        clusters.Push(start);
+        unsigned clusterStart = start;
+        misses = 0;
+        for (unsigned j = start; j < end - 1; ++j)
+        {
+            misses += UpdateFIFOCache(indices + j * 3, timestamps, time);
+            if ((float)misses <= clusterThreshold * (float)(j + 1 - clusterStart))
+            {
+                clusters.Push(j + 1);
+                clusterStart = j + 1;
+                misses = 0;
+                time += FIFO_CACHE_SIZE + 1;
+            }
+        }
+    }
+    unsigned numClusters = clusters.Size();
+    clusters.Push(numTriangles);
+
+    // Sort the clusters by how much their area-weighted normal points away from the mesh center
+    Vector3 meshCenter = Vector3::ZERO;
+    for (unsigned i = 0; i < numTriangles * 3; ++i)
+        meshCenter += positions[indices[i]];
+    meshCenter /= (float)(numTriangles * 3);
+
+    PODVector<Pair<float, unsigned> > sortKeys(numClusters);
+    for (unsigned i = 0; i < numClusters; ++i)
+    {
+        Vector3 center = Vector3::ZERO;
+        Vector3 normal = Vector3::ZERO;
+        float area = 0.0f;
+        for (unsigned j = clusters[i]; j < clusters[i + 1]; ++j)
+        {
+            const Vector3& v0 = positions[indices[j * 3]];
+            const Vector3& v1 = positions[indices[j * 3 + 1]];
+            const Vector3& v2 = positions[indices[j * 3 + 2]];
+            Vector3 triangleNormal = GetTriangleNormal(v0, v1, v2);
+            float triangleArea = triangleNormal.Length();
+            center += (v0 + v1 + v2) * triangleArea;
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        center = area > 0.0f ? center / (area * 3.0f) : meshCenter;
+        sortKeys[i] = MakePair((center - meshCenter).DotProduct(normal.Normalized()), i);
+    }
+
+    Sort(sortKeys.Begin(), sortKeys.End(), [](const Pair<float, unsigned>& lhs, const Pair<float, unsigned>& rhs)
+    {
+        return lhs.first_ > rhs.first_ || (lhs.first_ == rhs.first_ && lhs.second_ < rhs.second_);
+    });
+
+    PODVector<unsigned> result;
+    result.Reserve(numTriangles * 3);
+    for (unsigned i = 0; i < numClusters; ++i)
+    {
+        unsigned cluster = sortKeys[i].second_;
+        result.Push(PODVector<unsigned>(indices + clusters[cluster] * 3, (clusters[cluster + 1] - clusters[cluster]) * 3));
+    }
+
+    memcpy(indices, result.Buffer(), numTriangles * 3 * sizeof(unsigned));
+}
+
+void OptimizeVertexFetch(PODVector<unsigned>& remap, const unsigned* indices, unsigned indexCount, unsigned vertexCount)
+{
+    remap.Resize(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        remap[i] = M_MAX_UNSIGNED;
+
+    unsigned nextVertex = 0;
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        if (remap[indices[i]] == M_MAX_UNSIGNED)
+            remap[indices[i]] = nextVertex++;
+    }
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == M_MAX_UNSIGNED)
+            remap[i] = nextVertex++;
+    }
+}
+
+float SimplifyMesh(PODVector<unsigned>& dest, const unsigned* indices, unsigned indexCount, const Vector3* positions,
+    unsigned vertexCount, unsigned targetIndexCount, float maxError)
+{
+    unsigned count = indexCount - indexCount % 3;
+    dest.Resize(count);
+    if (count)
+        memcpy(dest.Buffer(), indices, count * sizeof(unsigned));
+    if (count <= targetIndexCount)
+        return 0.0f;
+
+    // Scale the positions to unit size so that the errors are relative to the mesh size
+    BoundingBox box;
+    for (unsigned i = 0; i < count; ++i)
+        box.Merge(positions[dest[i]]);
+    Vector3 size = box.Size();
+    float scale = Max(Max(size.x_, size.y_), size.z_);
+    if (scale <= 0.0f)
+        return 0.0f;
+
+    PODVector<Vector3> points(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        points[i] = (positions[i] - box.min_) / scale;
+
+    // Find the vertices sharing a position. The first vertex of each position represents the others
+    PODVector<unsigned> order(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        order[i] = i;
+    Sort(order.Begin(), order.End(), [&points](unsigned lhs, unsigned rhs)
+    {
+        const Vector3& l = points[lhs];
+        const Vector3& r = points[rhs];
+        if (l.x_ != r.x_)
+            return l.x_ < r.x_;
+        if (l.y_ != r.y_)
+            return l.y_ < r.y_;
+        if (l.z_ != r.z_)
+            return l.z_ < r.z_;
+        return lhs < rhs;
+    });
+
+    PODVector<unsigned> wedges(vertexCount);
+    PODVector<bool> locked(vertexCount, false);
+    for (unsigned i = 0; i < vertexCount;)
+    {
+        unsigned first = order[i];
+        unsigned j = i + 1;
+        while (j < vertexCount && points[order[j]] == points[first])
+            ++j;
+        for (unsigned k = i; k < j; ++k)
+            wedges[order[k]] = first;
+        // Moving a seam vertex would tear the seam open
+        if (j - i > 1)
+            locked[first] = true;
+        i = j;
+    }
+
+    // Lock the vertices on open and non-manifold edges
+    HashMap<unsigned long long, unsigned> edges;
+    for (unsigned i = 0; i < count; i += 3)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            unsigned long long start = wedges[dest[i + j]];
+            unsigned long long end = wedges[dest[i + (j + 1) % 3]];
+            ++edges[start << 32u | end];
+        }
+    }
+    for (HashMap<unsigned long long, unsigned>::ConstIterator i = edges.Begin(); i != edges.End(); ++i)
+    {
+        auto start = (unsigned)(i->first_ >> 32u);
+        auto end = (unsigned)(i->first_ & M_MAX_UNSIGNED);
+        HashMap<unsigned long long, unsigned>::ConstIterator j = edges.Find((unsigned long long)end << 32u | start);
+        if (i->second_ != 1 || j == edges.End() || j->second_ != 1)
+            locked[start] = locked[end] = true;
+    }
+    edges.Clear();
+
+    // Accumulate the planes of the triangles using each position, weighted by area
+    PODVector<Quadric> quadrics(vertexCount);
+    for (unsigned i = 0; i < count; i += 3)
+    {
+        const Vector3& v0 = points[dest[i]];
+        Vector3 normal = GetTriangleNormal(v0, points[dest[i + 1]], points[dest[i + 2]]);
+        float area = normal.Length();
+        if (area <= 0.0f)
+            continue;
+        normal /= area;
+        float d = -normal.DotProduct(v0);
+        for (unsigned j = 0; j < 3; ++j)
+            quadrics[wedges[dest[i + j]]].AddPlane(normal, d, area);
+    }
+
+    float maxCost = maxError * maxError;
+    float resultCost = 0.0f;
+    PODVector<unsigned> offsets;
+    PODVector<unsigned> adjacency;
+    PODVector<CollapseCandidate> candidates;
+    PODVector<bool> collapsed(vertexCount);
+    PODVector<bool> removedTriangles;
+    PODVector<unsigned> neighbors;
+    PODVector<unsigned> opposites;
+
+    // Collapse the cheapest edges in passes, each moving a vertex at most once, until the target or the error limit is reached
+    while (count > targetIndexCount)
+    {
+        BuildTriangleAdjacency(offsets, adjacency, dest.Buffer(), count, vertexCount);
+        removedTriangles.Resize(count / 3);
+        for (unsigned i = 0; i < count / 3; ++i)
+            removedTriangles[i] = false;
+        for (unsigned i = 0; i < vertexCount; ++i)
+            collapsed[i] = false;
+
+        candidates.Clear();
+        for (unsigned i = 0; i < vertexCount; ++i)
+        {
+            if (locked[wedges[i]])
+                continue;
+
+            CollapseCandidate best{M_INFINITY, i, M_MAX_UNSIGNED};
+            for (unsigned j = offsets[i]; j < offsets[i + 1]; ++j)
+            {
+                const unsigned* triangle = &dest[adjacency[j] * 3];
+                for (unsigned k = 0; k < 3; ++k)
+                {
+                    if (triangle[k] == i)
+                        continue;
+                    float cost = quadrics[i].Evaluate(points[triangle[k]]);
+                    if (cost < best.cost_)
+                    {
+                        best.cost_ = cost;
+                        best.target_ = triangle[k];
+                    }
+                }
+            }
+            if (best.target_ != M_MAX_UNSIGNED && best.cost_ <= maxCost)
+                candidates.Push(best);
+        }
+
+        Sort(candidates.Begin(), candidates.End(), [](const CollapseCandidate& lhs, const CollapseCandidate& rhs)
+        {
+            return lhs.cost_ < rhs.cost_ || (lhs.cost_ == rhs.cost_ && lhs.vertex_ < rhs.vertex_);
+        });
+
+        unsigned remainingCount = count;
+        unsigned numCollapses = 0;
+        for (unsigned i = 0; i < candidates.Size() && remainingCount > targetIndexCount; ++i)
+        {
+            unsigned vertex = candidates[i].vertex_;
+            unsigned target = candidates[i].target_;
+            if (collapsed[vertex] || collapsed[target])
+                continue;
+
+            const Vector3& oldPosition = points[vertex];
+            const Vector3& newPosition = points[target];
+            bool valid = true;
+            neighbors.Clear();
+            opposites.Clear();
+
+            for (unsigned j = offsets[vertex]; j < offsets[vertex + 1] && valid; ++j)
+            {
+                unsigned t = adjacency[j];
+                if (removedTriangles[t])
+                    continue;
+                const unsigned* triangle = &dest[t * 3];
+                if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+                {
+                    for (unsigned k = 0; k < 3; ++k)
+                    {
+                        if (triangle[k] != vertex && triangle[k] != target)
+                            opposites.Push(wedges[triangle[k]]);
+                    }
+                    continue;
+                }
+
+                // The remaining triangles must not become degenerate by meeting a vertex sharing the target's position, or flip over
+                for (unsigned k = 0; k < 3; ++k)
+                {
+                    if (triangle[k] != vertex)
+                    {
+                        if (wedges[triangle[k]] == wedges[target])
+                            valid = false;
+                        neighbors.Push(wedges[triangle[k]]);
+                    }
+                }
+                unsigned k = triangle[0] == vertex ? 0 : (triangle[1] == vertex ? 1 : 2);
+                const Vector3& v1 = points[triangle[(k + 1) % 3]];
+                const Vector3& v2 = points[triangle[(k + 2) % 3]];
+                if (GetTriangleNormal(oldPosition, v1, v2).DotProduct(GetTriangleNormal(newPosition, v1, v2)) <= 0.0f)
+                    valid = false;
+            }
+            if (!valid || opposites.Empty())
+                continue;
+
+            // Vertices connected to both ends other than through the collapsing triangles would make the surface fold
+            for (unsigned j = offsets[target]; j < offsets[target + 1] && valid; ++j)
+            {
+                unsigned t = adjacency[j];
+                if (removedTriangles[t])
+                    continue;
+                const unsigned* triangle = &dest[t * 3];
+                if (triangle[0] == vertex || triangle[1] == vertex || triangle[2] == vertex)
+                    continue;
+                for (unsigned k = 0; k < 3; ++k)
+                {
+                    unsigned neighbor = wedges[triangle[k]];
+                    if (triangle[k] != target && neighbors.Contains(neighbor) && !opposites.Contains(neighbor))
+                        valid = false;
+                }
+            }
+            if (!valid)
+                continue;
+
+            for (unsigned j = offsets[vertex]; j < offsets[vertex + 1]; ++j)
+            {
+                unsigned t = adjacency[j];
+                if (removedTriangles[t])
+                    continue;
+                unsigned* triangle = &dest[t * 3];
+                if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+                {
+                    removedTriangles[t] = true;
+                    remainingCount -= 3;
+                }
+                else
+                {
+                    for (unsigned k = 0; k < 3; ++k)
+                    {
+                        if (triangle[k] == vertex)
+                            triangle[k] = target;
+                    }
+                }
+            }
+
+            quadrics[wedges[target]].Add(quadrics[vertex]);
+            collapsed[vertex] = collapsed[target] = true;
+            resultCost = Max(resultCost, candidates[i].cost_);
+            ++numCollapses;
+        }
+
+        if (!numCollapses)
+            break;
+
+        unsigned newCount = 0;
+        for (unsigned i = 0; i < count / 3; ++i)
+        {
+            if (removedTriangles[i])
+                continue;
+            dest[newCount++] = dest[i * 3];
+            dest[newCount++] = dest[i * 3 + 1];
+            dest[newCount++] = dest[i * 3 + 2];
+        }
+        count = newCount;
+    }
+
+    dest.Resize(count);
+    return Sqrt(resultCost);
+}
+
+float GetVertexCacheMissRatio(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize)
+{
+    unsigned numTriangles = indexCount / 3;
+    if (!numTriangles)
+        return 0.0f;
+
+    PODVector<unsigned> timestamps(vertexCount, 0);
+    unsigned time = cacheSize + 1;
+    unsigned misses = 0;
+    for (unsigned i = 0; i < numTriangles * 3; ++i)
+    {
+        unsigned& timestamp = timestamps[indices[i]];
+        if (time - timestamp > cacheSize)
+        {
+            timestamp = time++;
+            ++misses;
+        }
+    }
+
+    return (float)misses / (float)numTriangles;
+}
+
+}
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/Vector3.h"
+
+namespace Urho3D
+{
+
+/// Reorder the triangles of an indexed triangle list for the post-transform vertex cache.
+URHO3D_API void OptimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount);
+/// Reorder clusters of vertex cache optimized triangles so that the clusters facing away from the mesh center, which are likely to occlude the rest, are drawn first. The threshold is the allowed increase of vertex cache misses, for example 1.05 for 5%.
+URHO3D_API void OptimizeOverdraw(unsigned* indices, unsigned indexCount, const Vector3* positions, unsigned vertexCount,
+    float threshold = 1.05f);
+/// Build a vertex remap table that orders the vertices by their first use in the index data, with unreferenced vertices last. The table gives the new position of each original vertex.
+URHO3D_API void OptimizeVertexFetch(PODVector<unsigned>& remap, const unsigned* indices, unsigned indexCount, unsigned vertexCount);
+/// Simplify an indexed triangle list by collapsing edges onto existing vertices, so that all vertex attributes stay valid, until the target index count or the maximum error relative to the mesh size is reached. Vertices on open edges and vertices sharing a position with others, such as texture seams, are not moved. Return the error of the result relative to the mesh size.
+URHO3D_API float SimplifyMesh(PODVector<unsigned>& dest, const unsigned* indices, unsigned indexCount, const Vector3* positions,
+    unsigned vertexCount, unsigned targetIndexCount, float maxError);
+/// Return the average number of vertex shader invocations per triangle of an indexed triangle list with a FIFO vertex cache of the given size.
+URHO3D_API float GetVertexCacheMissRatio(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize = 16);
+
+}
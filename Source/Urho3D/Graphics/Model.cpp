@@ -32,6 +32,7 @@
 #include "../IO/Log.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 
@@ -84,6 +85,7 @@ bool Model::BeginLoad(Deserializer& source)
 
     bool hasVertexDeclarations = (fileID == "UMD2");
 
+    cpuData_ = CPUDATA_FULL;
     geometries_.Clear();
     geometryBoneMappings_.Clear();
     geometryCenters_.Clear();
@@ -120,6 +122,15 @@ bool Model::BeginLoad(Deserializer& source)
                 auto type = (VertexElementType)(elementDesc & 0xffu);
                 auto semantic = (VertexElementSemantic)((elementDesc >> 8u) & 0xffu);
                 auto index = (unsigned char)((elementDesc >> 16u) & 0xffu);
+                if (type >= MAX_VERTEX_ELEMENT_TYPES)
+                {
+                    URHO3D_LOGERROR("Unknown vertex element type " + String((unsigned)type) + " in model " + GetName());
+                    return false;
+                }
+                auto* graphics = GetSubsystem<Graphics>();
+                if (graphics && !graphics->GetVertexElementTypeSupport(type))
+                    URHO3D_LOGWARNING("Vertex element type " + String((unsigned)type) + " in model " + GetName() +
+                        " is not supported by the GPU");
                 desc.vertexElements_.Push(VertexElement(type, semantic, index));
             }
         }
@@ -140,6 +151,7 @@ bool Model::BeginLoad(Deserializer& source)
         else
         {
             // If not async loading, use locking to avoid extra allocation & copy
+            LoadStageTimer timer(LOADSTAGE_UPLOAD);
             desc.data_.Reset(); // Make sure no previous data
             buffer->SetShadowed(true);
             buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
@@ -175,6 +187,7 @@ bool Model::BeginLoad(Deserializer& source)
         else
         {
             // If not async loading, use locking to avoid extra allocation & copy
+            LoadStageTimer timer(LOADSTAGE_UPLOAD);
             loadIBData_[i].data_.Reset(); // Make sure no previous data
             buffer->SetShadowed(true);
             buffer->SetSize(indexCount, indexSize > sizeof(unsigned short));
@@ -187,6 +200,17 @@ bool Model::BeginLoad(Deserializer& source)
         indexBuffers_.Push(buffer);
     }
 
+    // Upload on the loader thread if supported, so that EndLoad() does not stall the main thread
+    if (async)
+    {
+        auto* graphics = GetSubsystem<Graphics>();
+        if (graphics && graphics->BeginBackgroundUpload())
+        {
+            UploadBufferData();
+            graphics->EndBackgroundUpload();
+        }
+    }
+
     // Read geometries
     unsigned numGeometries = source.ReadUInt();
     geometries_.Reserve(numGeometries);
@@ -307,6 +331,31 @@ bool Model::BeginLoad(Deserializer& source)
         geometryCenters_.Push(Vector3::ZERO);
     memoryUse += sizeof(Vector3) * geometries_.Size();
 
+    // Read meshlets if present
+    if (!source.IsEof() && source.ReadFileID() == "MSHL")
+    {
+        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+            {
+                unsigned numMeshlets = source.ReadUInt();
+                PODVector<Meshlet> meshlets(numMeshlets);
+                for (unsigned k = 0; k < numMeshlets; ++k)
+                {
+                    Meshlet& meshlet = meshlets[k];
+                    meshlet.indexStart_ = source.ReadUInt();
+                    meshlet.indexCount_ = source.ReadUInt();
+                    meshlet.center_ = source.ReadVector3();
+                    meshlet.radius_ = source.ReadFloat();
+                    meshlet.coneAxis_ = source.ReadVector3();
+                    meshlet.coneCutoff_ = source.ReadFloat();
+                }
+                geometries_[i][j]->SetMeshlets(meshlets);
+                memoryUse += numMeshlets * sizeof(Meshlet);
+            }
+        }
+    }
+
     // Read metadata
     auto* cache = GetSubsystem<ResourceCache>();
     String xmlName = ReplaceExtension(GetName(), ".xml");
@@ -320,31 +369,8 @@ bool Model::BeginLoad(Deserializer& source)
 
 bool Model::EndLoad()
 {
-    // Upload vertex buffer data
-    for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
-    {
-        VertexBuffer* buffer = vertexBuffers_[i];
-        VertexBufferDesc& desc = loadVBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
-            buffer->SetData(desc.data_.Get());
-        }
-    }
-
-    // Upload index buffer data
-    for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
-    {
-        IndexBuffer* buffer = indexBuffers_[i];
-        IndexBufferDesc& desc = loadIBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
-            buffer->SetData(desc.data_.Get());
-        }
-    }
+    // Upload the buffer data, unless already uploaded in the background
+    UploadBufferData();
 
     // Set up geometries
     for (unsigned i = 0; i < geometries_.Size(); ++i)
@@ -367,6 +393,12 @@ bool Model::EndLoad()
 
 bool Model::Save(Serializer& dest) const
 {
+    if (cpuData_ != CPUDATA_FULL)
+    {
+        URHO3D_LOGERROR("Can not save model " + GetName() + " after its CPU-side data has been released");
+        return false;
+    }
+
     // Write ID
     if (!dest.WriteFileID("UMD2"))
         return false;
@@ -461,6 +493,42 @@ bool Model::Save(Serializer& dest) const
     for (unsigned i = 0; i < geometryCenters_.Size(); ++i)
         dest.WriteVector3(geometryCenters_[i]);
 
+    // Write meshlets if any geometry has them
+    bool hasMeshlets = false;
+    for (unsigned i = 0; i < geometries_.Size() && !hasMeshlets; ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        {
+            if (geometries_[i][j]->GetNumMeshlets())
+            {
+                hasMeshlets = true;
+                break;
+            }
+        }
+    }
+    if (hasMeshlets)
+    {
+        dest.WriteFileID("MSHL");
+        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+            {
+                const PODVector<Meshlet>& meshlets = geometries_[i][j]->GetMeshlets();
+                dest.WriteUInt(meshlets.Size());
+                for (unsigned k = 0; k < meshlets.Size(); ++k)
+                {
+                    const Meshlet& meshlet = meshlets[k];
+                    dest.WriteUInt(meshlet.indexStart_);
+                    dest.WriteUInt(meshlet.indexCount_);
+                    dest.WriteVector3(meshlet.center_);
+                    dest.WriteFloat(meshlet.radius_);
+                    dest.WriteVector3(meshlet.coneAxis_);
+                    dest.WriteFloat(meshlet.coneCutoff_);
+                }
+            }
+        }
+    }
+
     // Write metadata
     if (HasMetadata())
     {
@@ -614,8 +682,126 @@ void Model::SetMorphs(const Vector<ModelMorph>& morphs)
     morphs_ = morphs;
 }
 
+void Model::SetCPUData(ModelCPUData mode)
+{
+    if (mode == cpuData_)
+        return;
+    if (mode < cpuData_)
+    {
+        URHO3D_LOGERROR("Can not restore released CPU-side data of model " + GetName());
+        return;
+    }
+
+    // Compact copies of the positions, shared by the geometries that use the same vertex buffer. The index data is shared
+    // with the index buffer, so it survives the buffer releasing its shadow copy
+    HashMap<VertexBuffer*, SharedArrayPtr<unsigned char> > positionData;
+    if (mode == CPUDATA_POSITIONS)
+    {
+        for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
+        {
+            VertexBuffer* buffer = vertexBuffers_[i];
+            const unsigned char* src = buffer ? buffer->GetShadowData() : nullptr;
+            unsigned offset = buffer ? buffer->GetElementOffset(TYPE_VECTOR3, SEM_POSITION) : M_MAX_UNSIGNED;
+            if (!src || offset == M_MAX_UNSIGNED)
+                continue;
+
+            unsigned vertexCount = buffer->GetVertexCount();
+            unsigned vertexSize = buffer->GetVertexSize();
+            SharedArrayPtr<unsigned char> positions(new unsigned char[vertexCount * sizeof(Vector3)]);
+            for (unsigned j = 0; j < vertexCount; ++j)
+                memcpy(&positions[j * sizeof(Vector3)], src + j * vertexSize + offset, sizeof(Vector3));
+            positionData[buffer] = positions;
+        }
+    }
+
+    // Index buffers used with morphed vertex buffers stay shadowed, as the geometries fall back to the vertex buffers' data
+    HashSet<IndexBuffer*> morphedIndexBuffers;
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        {
+            Geometry* geometry = geometries_[i][j];
+            if (!geometry)
+                continue;
+
+            VertexBuffer* vertexBuffer = geometry->GetVertexBuffer(0);
+            IndexBuffer* indexBuffer = geometry->GetIndexBuffer();
+            if (vertexBuffer && morphRangeCounts_[LookupVertexBuffer(vertexBuffer, vertexBuffers_)])
+            {
+                morphedIndexBuffers.Insert(indexBuffer);
+                continue;
+            }
+
+            HashMap<VertexBuffer*, SharedArrayPtr<unsigned char> >::ConstIterator k = positionData.Find(vertexBuffer);
+            if (k != positionData.End() && (!indexBuffer || indexBuffer->GetShadowData()))
+            {
+                geometry->SetRawVertexData(k->second_, MASK_POSITION);
+                if (indexBuffer)
+                    geometry->SetRawIndexData(indexBuffer->GetShadowDataShared(), indexBuffer->GetIndexSize());
+            }
+            else
+            {
+                geometry->SetRawVertexData(SharedArrayPtr<unsigned char>(), MASK_NONE);
+                geometry->SetRawIndexData(SharedArrayPtr<unsigned char>(), 0);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
+    {
+        if (vertexBuffers_[i] && !morphRangeCounts_[i])
+            vertexBuffers_[i]->SetShadowed(false);
+    }
+    for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
+    {
+        if (indexBuffers_[i] && !morphedIndexBuffers.Contains(indexBuffers_[i]))
+            indexBuffers_[i]->SetShadowed(false);
+    }
+
+    cpuData_ = mode;
+}
+
+void Model::UploadBufferData()
+{
+    // Upload vertex buffer data
+    for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
+    {
+        VertexBuffer* buffer = vertexBuffers_[i];
+        VertexBufferDesc& desc = loadVBData_[i];
+        if (desc.data_)
+        {
+            LoadStageTimer timer(LOADSTAGE_UPLOAD);
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
+            buffer->SetData(desc.data_.Get());
+            desc.data_.Reset();
+        }
+    }
+
+    // Upload index buffer data
+    for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
+    {
+        IndexBuffer* buffer = indexBuffers_[i];
+        IndexBufferDesc& desc = loadIBData_[i];
+        if (desc.data_)
+        {
+            LoadStageTimer timer(LOADSTAGE_UPLOAD);
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
+            buffer->SetData(desc.data_.Get());
+            desc.data_.Reset();
+        }
+    }
+}
+
 SharedPtr<Model> Model::Clone(const String& cloneName) const
 {
+    if (cpuData_ != CPUDATA_FULL)
+    {
+        URHO3D_LOGERROR("Can not clone model " + GetName() + " after its CPU-side data has been released");
+        return SharedPtr<Model>();
+    }
+
     SharedPtr<Model> ret(new Model(context_));
 
     ret->SetName(cloneName);
@@ -705,6 +891,7 @@ SharedPtr<Model> Model::Clone(const String& cloneName) const
                 cloneGeometry->SetDrawRange(origGeometry->GetPrimitiveType(), origGeometry->GetIndexStart(),
                     origGeometry->GetIndexCount(), origGeometry->GetVertexStart(), origGeometry->GetVertexCount(), false);
                 cloneGeometry->SetLodDistance(origGeometry->GetLodDistance());
+                cloneGeometry->SetMeshlets(origGeometry->GetMeshlets());
             }
 
             ret->geometries_[i][j] = cloneGeometry;
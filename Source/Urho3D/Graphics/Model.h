@@ -104,6 +104,17 @@ struct GeometryDesc
     unsigned indexCount_;
 };
 
+/// CPU-side vertex and index data kept by a model for raycasts, decals, physics and navigation.
+enum ModelCPUData
+{
+    /// Full copies of the vertex and index buffers.
+    CPUDATA_FULL = 0,
+    /// Vertex positions and indices. Enough for raycasts, triangle mesh collision and navigation geometry, but not for decals or vertex morphs.
+    CPUDATA_POSITIONS,
+    /// No CPU-side data.
+    CPUDATA_NONE
+};
+
 /// 3D model resource.
 class URHO3D_API Model : public ResourceWithMetadata
 {
@@ -145,6 +156,8 @@ public:
     void SetGeometryBoneMappings(const Vector<PODVector<unsigned> >& geometryBoneMappings);
     /// Set vertex morphs.
     void SetMorphs(const Vector<ModelMorph>& morphs);
+    /// Release CPU-side copies of the vertex and index data that are not needed, for example after physics and navigation geometry has been built. Data can only be reduced, not restored without reloading. Vertex buffers with morph ranges keep their full data. Data lost along with the graphics context can not be restored either.
+    void SetCPUData(ModelCPUData mode);
     /// Clone the model. The geometry data is deep-copied and can be modified in the clone without affecting the original.
     SharedPtr<Model> Clone(const String& cloneName = String::EMPTY) const;
 
@@ -201,7 +214,13 @@ public:
     /// Return vertex buffer morph range vertex count.
     unsigned GetMorphRangeCount(unsigned bufferIndex) const;
 
+    /// Return CPU-side vertex and index data kept.
+    ModelCPUData GetCPUData() const { return cpuData_; }
+
 private:
+    /// Upload the vertex and index buffer data read for asynchronous loading.
+    void UploadBufferData();
+
     /// Bounding box.
     BoundingBox boundingBox_;
     /// Skeleton.
@@ -228,6 +247,8 @@ private:
     Vector<IndexBufferDesc> loadIBData_;
     /// Geometry definitions for asynchronous loading.
     Vector<PODVector<GeometryDesc> > loadGeometries_;
+    /// CPU-side vertex and index data kept.
+    ModelCPUData cpuData_{CPUDATA_FULL};
 };
 
 }
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../../Precompiled.h"
+
+#include "../../Graphics/Graphics.h"
+#include "../../Graphics/GraphicsImpl.h"
+
+#include "../../DebugNew.h"
+
+namespace Urho3D
+{
+
+void GraphicsTrace::Accumulate(const GraphicsTrace& rhs)
+{
+    draws_ += rhs.draws_;
+    instances_ += rhs.instances_;
+    primitives_ += rhs.primitives_;
+    clears_ += rhs.clears_;
+    shaderChanges_ += rhs.shaderChanges_;
+    textureChanges_ += rhs.textureChanges_;
+    bufferChanges_ += rhs.bufferChanges_;
+    renderTargetChanges_ += rhs.renderTargetChanges_;
+    blendStateChanges_ += rhs.blendStateChanges_;
+    depthStateChanges_ += rhs.depthStateChanges_;
+    rasterizerStateChanges_ += rhs.rasterizerStateChanges_;
+    viewportChanges_ += rhs.viewportChanges_;
+    shaderParameterUpdates_ += rhs.shaderParameterUpdates_;
+    bufferBytesUploaded_ += rhs.bufferBytesUploaded_;
+    textureBytesUploaded_ += rhs.textureBytesUploaded_;
+}
+
+void GraphicsImpl::ResetTrace()
+{
+    totalTrace_ = GraphicsTrace();
+    numTracedFrames_ = 0;
+}
+
+void GraphicsImpl::SetRecordCommands(bool enable)
+{
+    recordCommands_ = enable;
+    if (!enable)
+    {
+        frameCommands_.Clear();
+        lastFrameCommands_.Clear();
+    }
+}
+
+void GraphicsImpl::AddBufferUpload(unsigned bytes)
+{
+    frameTrace_.bufferBytesUploaded_ += bytes;
+    if (recordCommands_)
+        RecordCommand("UploadBuffer " + String(bytes));
+}
+
+void GraphicsImpl::AddTextureUpload(unsigned bytes)
+{
+    frameTrace_.textureBytesUploaded_ += bytes;
+    if (recordCommands_)
+        RecordCommand("UploadTexture " + String(bytes));
+}
+
+void GraphicsImpl::EndFrameTrace()
+{
+    lastFrameTrace_ = frameTrace_;
+    totalTrace_.Accumulate(frameTrace_);
+    ++numTracedFrames_;
+    frameTrace_ = GraphicsTrace();
+
+    lastFrameCommands_.Clear();
+    lastFrameCommands_.Swap(frameCommands_);
+}
+
+}
@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../../Graphics/GraphicsDefs.h"
+#include "../../Graphics/ShaderProgram.h"
+
+namespace Urho3D
+{
+
+class RenderSurface;
+class Texture;
+
+/// Texture formats of the null graphics backend. The values only need to be unique, as nothing is uploaded to a GPU.
+enum NullTextureFormat
+{
+    NF_UNKNOWN = 0,
+    NF_A8,
+    NF_R8,
+    NF_RG8,
+    NF_RGBA8,
+    NF_RGBA8_SRGB,
+    NF_RGBA16,
+    NF_RGBA16F,
+    NF_RGBA32F,
+    NF_RG16,
+    NF_RG16F,
+    NF_RG32F,
+    NF_R16F,
+    NF_R32F,
+    NF_D16,
+    NF_D24S8,
+    NF_D32,
+    NF_DXT1,
+    NF_DXT1_SRGB,
+    NF_DXT3,
+    NF_DXT3_SRGB,
+    NF_DXT5,
+    NF_DXT5_SRGB
+};
+
+using ShaderProgramMap = HashMap<Pair<ShaderVariation*, ShaderVariation*>, SharedPtr<ShaderProgram> >;
+
+/// Counts of the commands submitted to the null graphics backend. State changes are counted when a draw call applies them,
+/// so redundant sets that a real backend would filter out are not included.
+struct URHO3D_API GraphicsTrace
+{
+    /// Add the counts of another trace.
+    void Accumulate(const GraphicsTrace& rhs);
+
+    /// Draw calls.
+    unsigned draws_{};
+    /// Instances drawn by instanced draw calls.
+    unsigned instances_{};
+    /// Primitives drawn.
+    unsigned primitives_{};
+    /// Clears.
+    unsigned clears_{};
+    /// Shader program changes.
+    unsigned shaderChanges_{};
+    /// Texture unit changes.
+    unsigned textureChanges_{};
+    /// Vertex or index buffer binding changes.
+    unsigned bufferChanges_{};
+    /// Rendertarget or depth-stencil changes.
+    unsigned renderTargetChanges_{};
+    /// Blend state changes.
+    unsigned blendStateChanges_{};
+    /// Depth-stencil state changes.
+    unsigned depthStateChanges_{};
+    /// Rasterizer state changes, including the scissor rectangle.
+    unsigned rasterizerStateChanges_{};
+    /// Viewport changes.
+    unsigned viewportChanges_{};
+    /// Shader parameter updates.
+    unsigned shaderParameterUpdates_{};
+    /// Bytes written to vertex and index buffers.
+    unsigned long long bufferBytesUploaded_{};
+    /// Bytes written to textures.
+    unsigned long long textureBytesUploaded_{};
+};
+
+/// %Graphics implementation of the null backend. Tracks the bound state and counts the submitted commands instead of rendering.
+class URHO3D_API GraphicsImpl
+{
+    friend class Graphics;
+
+public:
+    /// Construct.
+    GraphicsImpl() = default;
+
+    /// Return the counts of the last completed frame.
+    const GraphicsTrace& GetFrameTrace() const { return lastFrameTrace_; }
+
+    /// Return the counts accumulated from all completed frames since the trace was last reset.
+    const GraphicsTrace& GetTotalTrace() const { return totalTrace_; }
+
+    /// Return number of completed frames since the trace was last reset.
+    unsigned GetNumTracedFrames() const { return numTracedFrames_; }
+
+    /// Reset the accumulated counts.
+    void ResetTrace();
+
+    /// Set whether to record a textual log of the commands in addition to counting them.
+    void SetRecordCommands(bool enable);
+
+    /// Return whether a textual log of the commands is recorded.
+    bool GetRecordCommands() const { return recordCommands_; }
+
+    /// Return the recorded commands of the last completed frame.
+    const Vector<String>& GetCommands() const { return lastFrameCommands_; }
+
+    /// Count bytes written to a vertex or index buffer.
+    void AddBufferUpload(unsigned bytes);
+
+    /// Count bytes written to a texture.
+    void AddTextureUpload(unsigned bytes);
+
+private:
+    /// Record a command if the textual log is enabled.
+    void RecordCommand(const String& command)
+    {
+        if (recordCommands_)
+            frameCommands_.Push(command);
+    }
+
+    /// Complete the current frame of the trace.
+    void EndFrameTrace();
+
+    /// Initialized flag, set by the first screen mode change.
+    bool initialized_{};
+    /// Rendertargets dirty flag.
+    bool renderTargetsDirty_{};
+    /// Textures dirty flag.
+    bool texturesDirty_{};
+    /// Vertex buffers dirty flag.
+    bool vertexBuffersDirty_{};
+    /// Blend state dirty flag.
+    bool blendStateDirty_{};
+    /// Depth state dirty flag.
+    bool depthStateDirty_{};
+    /// Rasterizer state dirty flag.
+    bool rasterizerStateDirty_{};
+    /// Scissor rect dirty flag.
+    bool scissorRectDirty_{};
+    /// Hash of current blend state.
+    unsigned blendStateHash_{};
+    /// Hash of current depth state.
+    unsigned depthStateHash_{};
+    /// Hash of current rasterizer state.
+    unsigned rasterizerStateHash_{};
+    /// Vertex stream offsets per buffer.
+    unsigned vertexOffsets_[MAX_VERTEX_STREAMS]{};
+    /// Textures applied by the previous draw call.
+    Texture* appliedTextures_[MAX_TEXTURE_UNITS]{};
+    /// Rendertargets applied by the previous draw call.
+    RenderSurface* appliedRenderTargets_[MAX_RENDERTARGETS]{};
+    /// Depth-stencil surface applied by the previous draw call.
+    RenderSurface* appliedDepthStencil_{};
+    /// Shader programs.
+    ShaderProgramMap shaderPrograms_;
+    /// Shader program in use.
+    ShaderProgram* shaderProgram_{};
+    /// Shader program applied by the previous draw call.
+    ShaderProgram* appliedShaderProgram_{};
+    /// Counts of the current frame.
+    GraphicsTrace frameTrace_;
+    /// Counts of the last completed frame.
+    GraphicsTrace lastFrameTrace_;
+    /// Accumulated counts.
+    GraphicsTrace totalTrace_;
+    /// Number of accumulated frames.
+    unsigned numTracedFrames_{};
+    /// Textual command log flag.
+    bool recordCommands_{};
+    /// Commands of the current frame.
+    Vector<String> frameCommands_;
+    /// Commands of the last completed frame.
+    Vector<String> lastFrameCommands_;
+};
+
+}
@@ -28,6 +28,12 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -44,6 +50,115 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
+/// Rasterize a horizontal span of depth values, keeping the nearest. Processes 4 pixels at a time when SIMD is available.
+static inline void DrawSpan(int* dest, int* end, int invZ, int dInvZ)
+{
+#ifdef URHO3D_SSE
+    if (end - dest >= 4)
+    {
+        __m128i z = _mm_add_epi32(_mm_set1_epi32(invZ), _mm_set_epi32(3 * dInvZ, 2 * dInvZ, dInvZ, 0));
+        __m128i step = _mm_set1_epi32(4 * dInvZ);
+        while (end - dest >= 4)
+        {
+            // SSE2 has no 32-bit integer minimum, so select by comparison instead
+            __m128i depth = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest));
+            __m128i nearer = _mm_cmplt_epi32(z, depth);
+            depth = _mm_or_si128(_mm_and_si128(nearer, z), _mm_andnot_si128(nearer, depth));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), depth);
+            z = _mm_add_epi32(z, step);
+            dest += 4;
+        }
+        invZ = _mm_cvtsi128_si32(z);
+    }
+#elif defined(__ARM_NEON)
+    if (end - dest >= 4)
+    {
+        const int offsets[] = {0, dInvZ, 2 * dInvZ, 3 * dInvZ};
+        int32x4_t z = vaddq_s32(vdupq_n_s32(invZ), vld1q_s32(offsets));
+        int32x4_t step = vdupq_n_s32(4 * dInvZ);
+        while (end - dest >= 4)
+        {
+            vst1q_s32(dest, vminq_s32(z, vld1q_s32(dest)));
+            z = vaddq_s32(z, step);
+            dest += 4;
+        }
+        invZ = vgetq_lane_s32(z, 0);
+    }
+#endif
+
+    while (dest < end)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZ;
+        ++dest;
+    }
+}
+
+/// Merge a span of depth values into another, keeping the nearest.
+static inline void MergeSpan(int* dest, const int* src, int count)
+{
+#ifdef URHO3D_SSE
+    for (; count >= 4; count -= 4)
+    {
+        __m128i depth = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest));
+        __m128i srcDepth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i nearer = _mm_cmplt_epi32(srcDepth, depth);
+        depth = _mm_or_si128(_mm_and_si128(nearer, srcDepth), _mm_andnot_si128(nearer, depth));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), depth);
+        src += 4;
+        dest += 4;
+    }
+#elif defined(__ARM_NEON)
+    for (; count >= 4; count -= 4)
+    {
+        vst1q_s32(dest, vminq_s32(vld1q_s32(src), vld1q_s32(dest)));
+        src += 4;
+        dest += 4;
+    }
+#endif
+
+    while (count--)
+    {
+        if (*src < *dest)
+            *dest = *src;
+        ++src;
+        ++dest;
+    }
+}
+
+/// Return whether any depth value in a span is at or behind the test depth, ie. not occluding it.
+static inline bool IsSpanVisible(const int* src, const int* end, int z)
+{
+#ifdef URHO3D_SSE
+    __m128i z4 = _mm_set1_epi32(z);
+    for (; end - src >= 4; src += 4)
+    {
+        // All four values must be nearer than the test depth to be occluded
+        __m128i occluded = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), z4);
+        if (_mm_movemask_epi8(occluded) != 0xffff)
+            return true;
+    }
+#elif defined(__ARM_NEON)
+    int32x4_t z4 = vdupq_n_s32(z);
+    for (; end - src >= 4; src += 4)
+    {
+        uint32x4_t visible = vcgeq_s32(vld1q_s32(src), z4);
+        uint32x2_t combined = vorr_u32(vget_low_u32(visible), vget_high_u32(visible));
+        if (vget_lane_u32(vpmax_u32(combined, combined), 0))
+            return true;
+    }
+#endif
+
+    for (; src < end; ++src)
+    {
+        if (z <= *src)
+            return true;
+    }
+
+    return false;
+}
+
 void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
@@ -217,9 +332,10 @@ void OcclusionBuffer::DrawTriangles()
             SharedPtr<WorkItem> item = queue->GetFreeItem();
             item->priority_ = M_MAX_UNSIGNED;
             item->workFunction_ = DrawOcclusionBatchWork;
+            item->name_ = "DrawOcclusionBatchWork";
             item->aux_ = this;
             item->start_ = &(*i);
-            queue->AddWorkItem(item);
+            queue->AddJob(item);
         }
 
         queue->Complete(M_MAX_UNSIGNED);
@@ -231,6 +347,59 @@ void OcclusionBuffer::DrawTriangles()
     batches_.Clear();
 }
 
+void OcclusionBuffer::Reproject(const OcclusionDepthData& data)
+{
+    if (buffers_.Empty() || data.depth_.Size() < (unsigned)(data.width_ * data.height_))
+        return;
+
+    URHO3D_PROFILE(ReprojectOcclusion);
+
+    // Transform from the earlier view space to the current projection space
+    Matrix4 transform = viewProj_ * data.cameraTransform_;
+    // Push the reprojected depth slightly further to counter the loss of precision in the downsampled depth
+    float depthScale = data.farClip_ * (1.0f + OCCLUSION_REPROJECTION_BIAS);
+    int* buffer = buffers_[0].data_;
+
+    for (int y = 0; y < data.height_; ++y)
+    {
+        const float* src = &data.depth_[y * data.width_];
+        float ndcY = 1.0f - 2.0f * ((float)y + 0.5f) / (float)data.height_;
+        if (data.flipVertical_)
+            ndcY = -ndcY;
+
+        for (int x = 0; x < data.width_; ++x)
+        {
+            // Skip the far plane, such as sky, which does not occlude anything
+            float depth = src[x];
+            if (depth >= 1.0f || depth <= 0.0f)
+                continue;
+
+            float ndcX = 2.0f * ((float)x + 0.5f) / (float)data.width_ - 1.0f;
+            float viewZ = depth * depthScale;
+            Vector3 nearPos = data.inverseProjection_ * Vector3(ndcX, ndcY, 0.0f);
+            Vector3 viewPos = data.orthographic_ ? Vector3(nearPos.x_, nearPos.y_, viewZ) : nearPos * (viewZ / nearPos.z_);
+
+            Vector4 vertex = transform * Vector4(viewPos, 1.0f);
+            if (vertex.w_ <= nearClip_)
+                continue;
+
+            Vector3 projected = ViewportTransform(vertex);
+            auto px = (int)projected.x_;
+            auto py = (int)projected.y_;
+            if (px < 0 || py < 0 || px >= width_ || py >= height_ || projected.z_ >= OCCLUSION_Z_SCALE)
+                continue;
+
+            // Holes left by the reprojection remain at the far plane, which keeps the result conservative
+            int z = RoundToInt(projected.z_);
+            int& dest = buffer[py * width_ + px];
+            if (z < dest)
+                dest = z;
+        }
+    }
+
+    depthHierarchyDirty_ = true;
+}
+
 void OcclusionBuffer::BuildDepthHierarchy()
 {
     if (buffers_.Empty() || !depthHierarchyDirty_)
@@ -441,14 +610,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
-        int* src = row + rect.left_;
-        int* end = row + rect.right_;
-        while (src <= end)
-        {
-            if (z <= *src)
-                return true;
-            ++src;
-        }
+        if (IsSpanVisible(row + rect.left_, row + rect.right_ + 1, z))
+            return true;
         row += width_;
     }
 
@@ -901,16 +1064,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
             int* endRow = bufferData + middleY * width_;
             while (row < endRow)
             {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (topToMiddle.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
+                DrawSpan(row + (topToBottom.x_ >> 16u), row + (topToMiddle.x_ >> 16u), topToBottom.invZ_, gradients.dInvZdXInt_);
 
                 topToBottom.x_ += topToBottom.xStep_;
                 topToBottom.invZ_ += topToBottom.invZStep_;
@@ -927,16 +1081,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
             int* endRow = bufferData + bottomY * width_;
             while (row < endRow)
             {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (middleToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
+                DrawSpan(row + (topToBottom.x_ >> 16u), row + (middleToBottom.x_ >> 16u), topToBottom.invZ_, gradients.dInvZdXInt_);
 
                 topToBottom.x_ += topToBottom.xStep_;
                 topToBottom.invZ_ += topToBottom.invZStep_;
@@ -955,16 +1100,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
             int* endRow = bufferData + middleY * width_;
             while (row < endRow)
             {
-                int invZ = topToMiddle.invZ_;
-                int* dest = row + (topToMiddle.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
+                DrawSpan(row + (topToMiddle.x_ >> 16u), row + (topToBottom.x_ >> 16u), topToMiddle.invZ_, gradients.dInvZdXInt_);
 
                 topToMiddle.x_ += topToMiddle.xStep_;
                 topToMiddle.invZ_ += topToMiddle.invZStep_;
@@ -981,16 +1117,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
             int* endRow = bufferData + bottomY * width_;
             while (row < endRow)
             {
-                int invZ = middleToBottom.invZ_;
-                int* dest = row + (middleToBottom.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
+                DrawSpan(row + (middleToBottom.x_ >> 16u), row + (topToBottom.x_ >> 16u), middleToBottom.invZ_, gradients.dInvZdXInt_);
 
                 middleToBottom.x_ += middleToBottom.xStep_;
                 middleToBottom.invZ_ += middleToBottom.invZStep_;
@@ -1010,18 +1137,8 @@ void OcclusionBuffer::MergeBuffers()
         if (!buffers_[i].used_)
             continue;
 
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
-
-        while (count--)
-        {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
-        }
+        // If thread buffer's depth value is closer, overwrite the original
+        MergeSpan(buffers_[0].data_, buffers_[i].data_, width_ * height_);
     }
 }
 
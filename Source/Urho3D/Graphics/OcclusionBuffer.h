@@ -78,12 +78,34 @@ struct OcclusionBatch
     unsigned drawCount_;
 };
 
+/// Scene depth of an earlier frame, to be reprojected into the occlusion buffer.
+struct OcclusionDepthData
+{
+    /// Camera world transform when the depth was rendered.
+    Matrix3x4 cameraTransform_;
+    /// Inverse of the camera projection.
+    Matrix4 inverseProjection_;
+    /// Camera far clip distance. The depth values are view space depth divided by it.
+    float farClip_{};
+    /// Orthographic camera flag.
+    bool orthographic_{};
+    /// Whether the first row of depth values is at the bottom of the view.
+    bool flipVertical_{};
+    /// Width in texels.
+    int width_{};
+    /// Height in texels.
+    int height_{};
+    /// Linear depth values.
+    PODVector<float> depth_;
+};
+
 static const int OCCLUSION_MIN_SIZE = 8;
 static const int OCCLUSION_DEFAULT_MAX_TRIANGLES = 5000;
 static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const float OCCLUSION_REPROJECTION_BIAS = 0.01f;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -115,6 +137,8 @@ public:
         unsigned indexStart, unsigned indexCount);
     /// Draw submitted batches. Uses worker threads if enabled during SetSize().
     void DrawTriangles();
+    /// Reproject the scene depth of an earlier frame into the buffer, to act as occluders in addition to the submitted triangles. Call after Clear().
+    void Reproject(const OcclusionDepthData& data);
     /// Build reduced size mip levels.
     void BuildDepthHierarchy();
     /// Reset last used timer.
@@ -34,6 +34,12 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -45,6 +51,12 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+static const float DEFAULT_LOOSE_FACTOR = 2.0f;
+static const float MAX_LOOSE_FACTOR = 4.0f;
+static const unsigned MIN_THREADED_REINSERTIONS = 256;
+static const unsigned FRUSTUM_TEST_BATCH_SIZE = 64;
+/// Maximum number of changed bounding boxes kept in the change history. The older half is discarded when exceeded.
+static const unsigned MAX_CHANGE_HISTORY = 4096;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
@@ -63,6 +75,105 @@ void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
+static void FindReinsertionTargets(Drawable** start, Drawable** end, Octant** targets)
+{
+    while (start != end)
+    {
+        Drawable* drawable = *start++;
+        Octant* octant = drawable->GetOctant();
+        Octree* root = octant ? octant->GetRoot() : nullptr;
+
+        // Keep the current octant if the drawable still fits it
+        if (root)
+        {
+            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            if (!drawable->IsOccludee() || octant->GetCullingBox().IsInside(box) != INSIDE || !octant->CheckDrawableFit(box))
+                octant = root->GetInsertionOctant(drawable);
+        }
+
+        *targets++ = octant;
+    }
+}
+
+void FindReinsertionTargetsWork(const WorkItem* item, unsigned threadIndex)
+{
+    FindReinsertionTargets(reinterpret_cast<Drawable**>(item->start_), reinterpret_cast<Drawable**>(item->end_),
+        reinterpret_cast<Octant**>(item->aux_));
+}
+
+/// Return a bit mask of the four packed bounding boxes that are (partially) inside a frustum. Same test as Frustum::IsInsideFast().
+static inline unsigned GetBoundsInsideMask(const OctantBounds& bounds, const Frustum& frustum)
+{
+#ifdef URHO3D_SSE
+    __m128 centerX = _mm_loadu_ps(bounds.centerX_);
+    __m128 centerY = _mm_loadu_ps(bounds.centerY_);
+    __m128 centerZ = _mm_loadu_ps(bounds.centerZ_);
+    __m128 halfSizeX = _mm_loadu_ps(bounds.halfSizeX_);
+    __m128 halfSizeY = _mm_loadu_ps(bounds.halfSizeY_);
+    __m128 halfSizeZ = _mm_loadu_ps(bounds.halfSizeZ_);
+    __m128 outside = _mm_setzero_ps();
+
+    for (const auto& plane : frustum.planes_)
+    {
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x_), centerX),
+            _mm_mul_ps(_mm_set1_ps(plane.normal_.y_), centerY)), _mm_mul_ps(_mm_set1_ps(plane.normal_.z_), centerZ)),
+            _mm_set1_ps(plane.d_));
+        __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.absNormal_.x_), halfSizeX),
+            _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y_), halfSizeY)), _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z_), halfSizeZ));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist)));
+    }
+
+    return ~(unsigned)_mm_movemask_ps(outside) & 0xfu;
+#elif defined(__ARM_NEON)
+    float32x4_t centerX = vld1q_f32(bounds.centerX_);
+    float32x4_t centerY = vld1q_f32(bounds.centerY_);
+    float32x4_t centerZ = vld1q_f32(bounds.centerZ_);
+    float32x4_t halfSizeX = vld1q_f32(bounds.halfSizeX_);
+    float32x4_t halfSizeY = vld1q_f32(bounds.halfSizeY_);
+    float32x4_t halfSizeZ = vld1q_f32(bounds.halfSizeZ_);
+    uint32x4_t outside = vdupq_n_u32(0);
+
+    for (const auto& plane : frustum.planes_)
+    {
+        float32x4_t dist = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(centerX, plane.normal_.x_),
+            vmulq_n_f32(centerY, plane.normal_.y_)), vmulq_n_f32(centerZ, plane.normal_.z_)), vdupq_n_f32(plane.d_));
+        float32x4_t absDist = vaddq_f32(vaddq_f32(vmulq_n_f32(halfSizeX, plane.absNormal_.x_),
+            vmulq_n_f32(halfSizeY, plane.absNormal_.y_)), vmulq_n_f32(halfSizeZ, plane.absNormal_.z_));
+        outside = vorrq_u32(outside, vcltq_f32(dist, vnegq_f32(absDist)));
+    }
+
+    const uint32_t laneBits[] = {1, 2, 4, 8};
+    uint32x4_t inside = vbicq_u32(vld1q_u32(laneBits), outside);
+    return vgetq_lane_u32(inside, 0) | vgetq_lane_u32(inside, 1) | vgetq_lane_u32(inside, 2) | vgetq_lane_u32(inside, 3);
+#else
+    unsigned mask = 0;
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        Vector3 center(bounds.centerX_[i], bounds.centerY_[i], bounds.centerZ_[i]);
+        Vector3 edge(bounds.halfSizeX_[i], bounds.halfSizeY_[i], bounds.halfSizeZ_[i]);
+        bool inside = true;
+
+        for (const auto& plane : frustum.planes_)
+        {
+            float dist = plane.normal_.DotProduct(center) + plane.d_;
+            float absDist = plane.absNormal_.DotProduct(edge);
+
+            if (dist < -absDist)
+            {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside)
+            mask |= 1u << i;
+    }
+
+    return mask;
+#endif
+}
+
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
@@ -81,14 +192,17 @@ Octant::~Octant()
 {
     if (root_)
     {
-        // Remove the drawables (if any) from this octant to the root octant
-        for (PODVector<Drawable*>::Iterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+        // Remove the drawables (if any) from this octant to the root octant. Keep the old packed bounds, so that the octree
+        // update still sees the drawables that have moved meanwhile as changed
+        for (unsigned i = 0; i < drawables_.Size(); ++i)
         {
-            (*i)->SetOctant(root_);
-            root_->drawables_.Push(*i);
-            root_->QueueUpdate(*i);
+            Drawable* drawable = drawables_[i];
+            root_->PushDrawable(drawable);
+            root_->SetBounds(drawable->octantIndex_, GetBounds(i));
+            root_->QueueUpdate(drawable);
         }
         drawables_.Clear();
+        bounds_.Clear();
         numDrawables_ = 0;
     }
 
@@ -148,11 +262,18 @@ void Octant::InsertDrawable(Drawable* drawable)
         Octant* oldOctant = drawable->octant_;
         if (oldOctant != this)
         {
+            // Moves are recorded by the octree update. Newly added drawables are recorded here
+            if (!oldOctant)
+                root_->MarkChanged(box);
+
+            unsigned oldIndex = drawable->octantIndex_;
             // Add first, then remove, because drawable count going to zero deletes the octree branch in question
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+                oldOctant->RemoveDrawableAt(drawable, oldIndex, false);
         }
+        else
+            SetBounds(drawable->octantIndex_, box);
     }
     else
     {
@@ -165,6 +286,72 @@ void Octant::InsertDrawable(Drawable* drawable)
     }
 }
 
+Octant* Octant::GetInsertionOctant(Drawable* drawable)
+{
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Octant* octant = this;
+
+    // Follow the same rules as InsertDrawable()
+    if (octant == root_ && (!drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE))
+        return octant;
+
+    Vector3 boxCenter = box.Center();
+    while (!octant->CheckDrawableFit(box))
+    {
+        unsigned x = boxCenter.x_ < octant->center_.x_ ? 0 : 1;
+        unsigned y = boxCenter.y_ < octant->center_.y_ ? 0 : 2;
+        unsigned z = boxCenter.z_ < octant->center_.z_ ? 0 : 4;
+
+        octant = octant->children_[x + y + z];
+        if (!octant)
+            return nullptr;
+    }
+
+    return octant;
+}
+
+void Octant::RemoveDrawable(Drawable* drawable, bool resetOctant)
+{
+    RemoveDrawableAt(drawable, drawable->octantIndex_, resetOctant);
+}
+
+void Octant::UpdateDrawableBounds(Drawable* drawable)
+{
+    SetBounds(drawable->octantIndex_, drawable->GetWorldBoundingBox());
+}
+
+BoundingBox Octant::GetDrawableBounds(Drawable* drawable) const
+{
+    return GetBounds(drawable->octantIndex_);
+}
+
+void Octant::RemoveMovedDrawables()
+{
+    unsigned numKept = 0;
+    for (unsigned i = 0; i < drawables_.Size(); ++i)
+    {
+        Drawable* drawable = drawables_[i];
+        if (drawable->octant_ == this)
+        {
+            if (numKept != i)
+            {
+                drawables_[numKept] = drawable;
+                CopyBounds(numKept, i);
+                drawable->octantIndex_ = numKept;
+            }
+            ++numKept;
+        }
+    }
+
+    unsigned numRemoved = drawables_.Size() - numKept;
+    if (numRemoved)
+    {
+        drawables_.Resize(numKept);
+        bounds_.Resize((numKept + 3) >> 2u);
+        DecDrawableCount(numRemoved);
+    }
+}
+
 bool Octant::CheckDrawableFit(const BoundingBox& box) const
 {
     Vector3 boxSize = box.Size();
@@ -176,12 +363,13 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     // Also check if the box can not fit a child octant's culling box, in that case size OK (must insert here)
     else
     {
-        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - 0.5f * halfSize_.x_ ||
-            box.max_.x_ >= worldBoundingBox_.max_.x_ + 0.5f * halfSize_.x_ ||
-            box.min_.y_ <= worldBoundingBox_.min_.y_ - 0.5f * halfSize_.y_ ||
-            box.max_.y_ >= worldBoundingBox_.max_.y_ + 0.5f * halfSize_.y_ ||
-            box.min_.z_ <= worldBoundingBox_.min_.z_ - 0.5f * halfSize_.z_ ||
-            box.max_.z_ >= worldBoundingBox_.max_.z_ + 0.5f * halfSize_.z_)
+        Vector3 childExpand = 0.5f * (root_->GetLooseFactor() - 1.0f) * halfSize_;
+        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - childExpand.x_ ||
+            box.max_.x_ >= worldBoundingBox_.max_.x_ + childExpand.x_ ||
+            box.min_.y_ <= worldBoundingBox_.min_.y_ - childExpand.y_ ||
+            box.max_.y_ >= worldBoundingBox_.max_.y_ + childExpand.y_ ||
+            box.min_.z_ <= worldBoundingBox_.min_.z_ - childExpand.z_ ||
+            box.max_.z_ >= worldBoundingBox_.max_.z_ + childExpand.z_)
             return true;
     }
 
@@ -218,12 +406,98 @@ void Octant::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     }
 }
 
+void Octant::PushDrawable(Drawable* drawable)
+{
+    unsigned index = drawables_.Size();
+    drawable->SetOctant(this);
+    drawable->octantIndex_ = index;
+    drawables_.Push(drawable);
+    if (!(index & 3u))
+        bounds_.Resize(bounds_.Size() + 1);
+    SetBounds(index, drawable->GetWorldBoundingBox());
+}
+
+void Octant::RemoveDrawableAt(Drawable* drawable, unsigned index, bool resetOctant)
+{
+    if (index >= drawables_.Size() || drawables_[index] != drawable)
+    {
+        index = drawables_.IndexOf(drawable);
+        if (index == drawables_.Size())
+            return;
+    }
+
+    // Record drawables leaving the octree, so that cached queries no longer return them
+    if (resetOctant && root_)
+        root_->MarkChanged(GetBounds(index));
+
+    unsigned last = drawables_.Size() - 1;
+    if (index != last)
+    {
+        Drawable* moved = drawables_[last];
+        drawables_[index] = moved;
+        CopyBounds(index, last);
+        // A drawable already added to another octant during batched reinsertion keeps its new index
+        if (moved->octant_ == this)
+            moved->octantIndex_ = index;
+    }
+
+    drawables_.Pop();
+    if (!(last & 3u))
+        bounds_.Pop();
+
+    if (resetOctant)
+        drawable->SetOctant(nullptr);
+    DecDrawableCount();
+}
+
+void Octant::SetBounds(unsigned index, const BoundingBox& box)
+{
+    OctantBounds& bounds = bounds_[index >> 2u];
+    unsigned lane = index & 3u;
+    Vector3 center = box.Center();
+    Vector3 halfSize = center - box.min_;
+
+    bounds.centerX_[lane] = center.x_;
+    bounds.centerY_[lane] = center.y_;
+    bounds.centerZ_[lane] = center.z_;
+    bounds.halfSizeX_[lane] = halfSize.x_;
+    bounds.halfSizeY_[lane] = halfSize.y_;
+    bounds.halfSizeZ_[lane] = halfSize.z_;
+}
+
+void Octant::CopyBounds(unsigned dest, unsigned src)
+{
+    const OctantBounds& srcBounds = bounds_[src >> 2u];
+    OctantBounds& destBounds = bounds_[dest >> 2u];
+    unsigned srcLane = src & 3u;
+    unsigned destLane = dest & 3u;
+
+    destBounds.centerX_[destLane] = srcBounds.centerX_[srcLane];
+    destBounds.centerY_[destLane] = srcBounds.centerY_[srcLane];
+    destBounds.centerZ_[destLane] = srcBounds.centerZ_[srcLane];
+    destBounds.halfSizeX_[destLane] = srcBounds.halfSizeX_[srcLane];
+    destBounds.halfSizeY_[destLane] = srcBounds.halfSizeY_[srcLane];
+    destBounds.halfSizeZ_[destLane] = srcBounds.halfSizeZ_[srcLane];
+}
+
+BoundingBox Octant::GetBounds(unsigned index) const
+{
+    const OctantBounds& bounds = bounds_[index >> 2u];
+    unsigned lane = index & 3u;
+    Vector3 center(bounds.centerX_[lane], bounds.centerY_[lane], bounds.centerZ_[lane]);
+    Vector3 halfSize(bounds.halfSizeX_[lane], bounds.halfSizeY_[lane], bounds.halfSizeZ_[lane]);
+    return BoundingBox(center - halfSize, center + halfSize);
+}
+
 void Octant::Initialize(const BoundingBox& box)
 {
     worldBoundingBox_ = box;
     center_ = box.Center();
     halfSize_ = 0.5f * box.Size();
-    cullingBox_ = BoundingBox(worldBoundingBox_.min_ - halfSize_, worldBoundingBox_.max_ + halfSize_);
+    // The root octant's culling box is not used by queries, and the octree is not constructed yet when the root is first
+    // initialized, so it always uses the default loose factor
+    Vector3 expand = root_ != this ? (root_->GetLooseFactor() - 1.0f) * halfSize_ : halfSize_;
+    cullingBox_ = BoundingBox(worldBoundingBox_.min_ - expand, worldBoundingBox_.max_ + expand);
 }
 
 void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
@@ -242,9 +516,15 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
 
     if (drawables_.Size())
     {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.Size();
-        query.TestDrawables(start, end, inside);
+        const Frustum* frustum = inside ? nullptr : query.GetDrawableFrustum();
+        if (frustum)
+            GetDrawablesInternal(query, *frustum);
+        else
+        {
+            auto** start = const_cast<Drawable**>(&drawables_[0]);
+            Drawable** end = start + drawables_.Size();
+            query.TestDrawables(start, end, inside);
+        }
     }
 
     for (auto child : children_)
@@ -254,6 +534,86 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     }
 }
 
+void Octant::GetDrawablesInternal(OctreeQuery& query, const Frustum& frustum) const
+{
+    // Pass the drawables inside the frustum to the query in small batches
+    Drawable* batch[FRUSTUM_TEST_BATCH_SIZE];
+    unsigned numBatched = 0;
+    unsigned numDrawables = drawables_.Size();
+
+    for (unsigned i = 0; i < numDrawables; i += 4)
+    {
+        unsigned mask = GetBoundsInsideMask(bounds_[i >> 2u], frustum);
+        // Mask out the unused lanes of the last element
+        if (numDrawables - i < 4)
+            mask &= (1u << (numDrawables - i)) - 1;
+
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            if (mask & (1u << j))
+                batch[numBatched++] = drawables_[i + j];
+        }
+
+        if (numBatched > FRUSTUM_TEST_BATCH_SIZE - 4)
+        {
+            query.TestDrawables(batch, batch + numBatched, true);
+            numBatched = 0;
+        }
+    }
+
+    if (numBatched)
+        query.TestDrawables(batch, batch + numBatched, true);
+}
+
+void Octant::GetDrawablesInternal(MultiFrustumOctreeQuery& query, unsigned activeMask, unsigned insideMask) const
+{
+    unsigned numFrustums = query.frustums_.Size();
+
+    if (this != root_)
+    {
+        for (unsigned i = 0; i < numFrustums; ++i)
+        {
+            unsigned bit = 1u << i;
+            if ((activeMask & bit) && !(insideMask & bit))
+            {
+                Intersection res = query.frustums_[i].IsInside(cullingBox_);
+                if (res == INSIDE)
+                    insideMask |= bit;
+                else if (res == OUTSIDE)
+                    activeMask &= ~bit;
+            }
+        }
+
+        // Outside all the frustums, so cull this octant, its children & drawables
+        if (!activeMask)
+            return;
+    }
+
+    for (PODVector<Drawable*>::ConstIterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+    {
+        Drawable* drawable = *i;
+        if (!(drawable->GetDrawableFlags() & query.drawableFlags_))
+            continue;
+
+        unsigned viewMask = drawable->GetViewMask();
+        for (unsigned j = 0; j < numFrustums; ++j)
+        {
+            unsigned bit = 1u << j;
+            if ((activeMask & bit) && (viewMask & query.viewMasks_[j]))
+            {
+                PODVector<Drawable*>& dest = (insideMask & bit) ? *query.insideResults_[j] : *query.intersectingResults_[j];
+                dest.Push(drawable);
+            }
+        }
+    }
+
+    for (auto child : children_)
+    {
+        if (child)
+            child->GetDrawablesInternal(query, activeMask, insideMask);
+    }
+}
+
 void Octant::GetDrawablesInternal(RayOctreeQuery& query) const
 {
     float octantDist = query.ray_.HitDistance(cullingBox_);
@@ -311,7 +671,9 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, nullptr, this),
-    numLevels_(DEFAULT_OCTREE_LEVELS)
+    numChanges_(0),
+    numLevels_(DEFAULT_OCTREE_LEVELS),
+    looseFactor_(DEFAULT_LOOSE_FACTOR)
 {
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
     // to allow raycasts and animation update
@@ -336,6 +698,7 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Loose Factor", GetLooseFactor, SetLooseFactor, float, DEFAULT_LOOSE_FACTOR, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -361,6 +724,17 @@ void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
     numLevels_ = Max(numLevels, 1U);
 }
 
+void Octree::SetLooseFactor(float factor)
+{
+    factor = Clamp(factor, DEFAULT_LOOSE_FACTOR, MAX_LOOSE_FACTOR);
+    if (factor == looseFactor_)
+        return;
+
+    looseFactor_ = factor;
+    // Child octants are recreated with the new culling boxes as drawables are reinserted
+    SetSize(worldBoundingBox_, numLevels_);
+}
+
 void Octree::Update(const FrameInfo& frame)
 {
     if (!Thread::IsMainThread())
@@ -390,6 +764,7 @@ void Octree::Update(const FrameInfo& frame)
             SharedPtr<WorkItem> item = queue->GetFreeItem();
             item->priority_ = M_MAX_UNSIGNED;
             item->workFunction_ = UpdateDrawablesWork;
+            item->name_ = "UpdateDrawablesWork";
             item->aux_ = const_cast<FrameInfo*>(&frame);
 
             PODVector<Drawable*>::Iterator end = drawableUpdates_.End();
@@ -398,7 +773,7 @@ void Octree::Update(const FrameInfo& frame)
 
             item->start_ = &(*start);
             item->end_ = &(*end);
-            queue->AddWorkItem(item);
+            queue->AddJob(item);
 
             start = end;
         }
@@ -443,32 +818,109 @@ void Octree::Update(const FrameInfo& frame)
     {
         URHO3D_PROFILE(ReinsertToOctree);
 
-        for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        // Find the target octants first, in worker threads if there are many drawables. The octree is not modified meanwhile
+        reinsertionTargets_.Resize(drawableUpdates_.Size());
+        auto* queue = GetSubsystem<WorkQueue>();
+        if (queue->GetNumThreads() && drawableUpdates_.Size() >= MIN_THREADED_REINSERTIONS)
         {
-            Drawable* drawable = *i;
+            URHO3D_PROFILE(FindReinsertionTargets);
+
+            unsigned numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+            unsigned drawablesPerItem = drawableUpdates_.Size() / numWorkItems;
+
+            unsigned start = 0;
+            for (unsigned i = 0; i < numWorkItems; ++i)
+            {
+                unsigned end = i < numWorkItems - 1 ? start + drawablesPerItem : drawableUpdates_.Size();
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = FindReinsertionTargetsWork;
+                item->name_ = "FindReinsertionTargetsWork";
+                item->start_ = drawableUpdates_.Buffer() + start;
+                item->end_ = drawableUpdates_.Buffer() + end;
+                item->aux_ = reinsertionTargets_.Buffer() + start;
+                queue->AddJob(item);
+
+                start = end;
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+        else
+            FindReinsertionTargets(drawableUpdates_.Buffer(), drawableUpdates_.Buffer() + drawableUpdates_.Size(),
+                reinsertionTargets_.Buffer());
+
+        // Add the drawables to their existing target octants. They are removed from the old octants afterward, so that
+        // the old octants keep a nonzero drawable count and are not deleted in the meanwhile
+        for (unsigned i = 0; i < drawableUpdates_.Size(); ++i)
+        {
+            Drawable* drawable = drawableUpdates_[i];
             drawable->updateQueued_ = false;
+            drawable->updateFrameNumber_ = frame.frameNumber_;
             Octant* octant = drawable->GetOctant();
-            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            Octant* target = reinsertionTargets_[i];
 
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
-            // Skip if still fits the current octant
-            if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
-                continue;
 
-            InsertDrawable(drawable);
+            // Record both the old and the new bounds if changed. The new bounds are compared in their packed form
+            BoundingBox oldBox = octant->GetDrawableBounds(drawable);
+            const BoundingBox& newBox = drawable->GetWorldBoundingBox();
+            Vector3 newCenter = newBox.Center();
+            Vector3 newHalfSize = newCenter - newBox.min_;
+            if (oldBox.min_ != newCenter - newHalfSize || oldBox.max_ != newCenter + newHalfSize)
+            {
+                MarkChanged(oldBox);
+                MarkChanged(newBox);
+            }
+
+            // If staying in the current octant, only the packed bounds need to be refreshed
+            if (target == octant)
+                octant->UpdateDrawableBounds(drawable);
+            else if (target)
+            {
+                target->AddDrawable(drawable);
+                movedFromOctants_.Push(octant);
+            }
+            else
+                newOctantDrawables_.Push(drawable);
+        }
+
+        // Drawables that need new child octants are inserted one by one
+        for (PODVector<Drawable*>::Iterator i = newOctantDrawables_.Begin(); i != newOctantDrawables_.End(); ++i)
+            InsertDrawable(*i);
+
+        // Remove the moved drawables from each old octant in one pass
+        Sort(movedFromOctants_.Begin(), movedFromOctants_.End());
+        Octant* lastOctant = nullptr;
+        for (PODVector<Octant*>::Iterator i = movedFromOctants_.Begin(); i != movedFromOctants_.End(); ++i)
+        {
+            if (*i != lastOctant)
+            {
+                lastOctant = *i;
+                lastOctant->RemoveMovedDrawables();
+            }
+        }
+
+        movedFromOctants_.Clear();
+        newOctantDrawables_.Clear();
 
 #ifdef _DEBUG
-            // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
-            if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
+        // Verify that the drawables will be culled correctly
+        for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            Octant* octant = drawable->GetOctant();
+            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            if (octant && octant->GetRoot() == this && octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
             {
                 URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
                          " octant box " + octant->GetCullingBox().ToString());
             }
-#endif
         }
+#endif
     }
 
     drawableUpdates_.Clear();
@@ -498,6 +950,19 @@ void Octree::GetDrawables(OctreeQuery& query) const
     GetDrawablesInternal(query, false);
 }
 
+void Octree::GetDrawables(MultiFrustumOctreeQuery& query) const
+{
+    unsigned numFrustums = query.frustums_.Size();
+    for (unsigned i = 0; i < numFrustums; ++i)
+    {
+        query.insideResults_[i]->Clear();
+        query.intersectingResults_[i]->Clear();
+    }
+
+    if (numFrustums)
+        GetDrawablesInternal(query, numFrustums < MAX_QUERY_FRUSTUMS ? (1u << numFrustums) - 1 : M_MAX_UNSIGNED, 0);
+}
+
 void Octree::Raycast(RayOctreeQuery& query) const
 {
     URHO3D_PROFILE(Raycast);
@@ -547,6 +1012,45 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+void Octree::MarkChanged(const BoundingBox& box)
+{
+    if (changedBoxes_.Size() >= MAX_CHANGE_HISTORY)
+        changedBoxes_.Erase(0, MAX_CHANGE_HISTORY / 2);
+
+    changedBoxes_.Push(box);
+    ++numChanges_;
+}
+
+bool Octree::HasChanges(unsigned sinceChange, const Sphere& sphere) const
+{
+    unsigned firstChange = numChanges_ - changedBoxes_.Size();
+    if (sinceChange < firstChange || sinceChange > numChanges_)
+        return true;
+
+    for (unsigned i = sinceChange - firstChange; i < changedBoxes_.Size(); ++i)
+    {
+        if (sphere.IsInsideFast(changedBoxes_[i]) != OUTSIDE)
+            return true;
+    }
+
+    return false;
+}
+
+bool Octree::HasChanges(unsigned sinceChange, const Frustum& frustum) const
+{
+    unsigned firstChange = numChanges_ - changedBoxes_.Size();
+    if (sinceChange < firstChange || sinceChange > numChanges_)
+        return true;
+
+    for (unsigned i = sinceChange - firstChange; i < changedBoxes_.Size(); ++i)
+    {
+        if (frustum.IsInsideFast(changedBoxes_[i]) != OUTSIDE)
+            return true;
+    }
+
+    return false;
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
@@ -35,6 +35,23 @@ class Octree;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// World bounding boxes of four drawables in an octant as centers and half sizes, in structure-of-arrays layout for testing them together with SIMD.
+struct OctantBounds
+{
+    /// Center X coordinates.
+    float centerX_[4];
+    /// Center Y coordinates.
+    float centerY_[4];
+    /// Center Z coordinates.
+    float centerZ_[4];
+    /// Half sizes on the X axis.
+    float halfSizeX_[4];
+    /// Half sizes on the Y axis.
+    float halfSizeY_[4];
+    /// Half sizes on the Z axis.
+    float halfSizeZ_[4];
+};
+
 /// %Octree octant
 class URHO3D_API Octant
 {
@@ -52,25 +69,25 @@ public:
     void InsertDrawable(Drawable* drawable);
     /// Check if a drawable object fits.
     bool CheckDrawableFit(const BoundingBox& box) const;
+    /// Return the existing octant a drawable object would be inserted to, or null if a child octant would need to be created. Does not modify the octree.
+    Octant* GetInsertionOctant(Drawable* drawable);
 
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
-        drawable->SetOctant(this);
-        drawables_.Push(drawable);
+        PushDrawable(drawable);
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
-    void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
-    {
-        if (drawables_.Remove(drawable))
-        {
-            if (resetOctant)
-                drawable->SetOctant(nullptr);
-            DecDrawableCount();
-        }
-    }
+    void RemoveDrawable(Drawable* drawable, bool resetOctant = true);
+    /// Copy a drawable object's current world bounding box to the packed bounds of this octant.
+    void UpdateDrawableBounds(Drawable* drawable);
+    /// Return the packed world bounding box of a drawable object in this octant, as of its last insertion or reinsertion.
+    BoundingBox GetDrawableBounds(Drawable* drawable) const;
+
+    /// Remove drawable objects that have already been added to another octant. Used to apply batched reinsertions.
+    void RemoveMovedDrawables();
 
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
@@ -101,8 +118,22 @@ public:
 protected:
     /// Initialize bounding box.
     void Initialize(const BoundingBox& box);
+    /// Add a drawable object to the drawable list and the packed bounds without changing the drawable count.
+    void PushDrawable(Drawable* drawable);
+    /// Remove a drawable object from the drawable list by its expected index. The last drawable is moved into its place.
+    void RemoveDrawableAt(Drawable* drawable, unsigned index, bool resetOctant);
+    /// Copy a world bounding box to the packed bounds at index.
+    void SetBounds(unsigned index, const BoundingBox& box);
+    /// Copy packed bounds from one index to another.
+    void CopyBounds(unsigned dest, unsigned src);
+    /// Return packed bounds at index as a bounding box.
+    BoundingBox GetBounds(unsigned index) const;
     /// Return drawable objects by a query, called internally.
     void GetDrawablesInternal(OctreeQuery& query, bool inside) const;
+    /// Return drawable objects that are inside a frustum by a query, testing the packed bounds four at a time. Called internally.
+    void GetDrawablesInternal(OctreeQuery& query, const Frustum& frustum) const;
+    /// Return drawable objects by a multi-frustum query, called internally. The masks have a bit for each frustum still intersecting and fully containing the octant.
+    void GetDrawablesInternal(MultiFrustumOctreeQuery& query, unsigned activeMask, unsigned insideMask) const;
     /// Return drawable objects by a ray query, called internally.
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
@@ -117,11 +148,11 @@ protected:
     }
 
     /// Decrease drawable object count recursively and remove octant if it becomes empty.
-    void DecDrawableCount()
+    void DecDrawableCount(unsigned count = 1)
     {
         Octant* parent = parent_;
 
-        --numDrawables_;
+        numDrawables_ -= count;
         if (!numDrawables_)
         {
             if (parent)
@@ -129,7 +160,7 @@ protected:
         }
 
         if (parent)
-            parent->DecDrawableCount();
+            parent->DecDrawableCount(count);
     }
 
     /// World bounding box.
@@ -138,6 +169,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     PODVector<Drawable*> drawables_;
+    /// World bounding boxes of the drawable objects, four per element.
+    PODVector<OctantBounds> bounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -174,6 +207,8 @@ public:
 
     /// Set size and maximum subdivision levels. If octree is not empty, drawable objects will be temporarily moved to the root.
     void SetSize(const BoundingBox& box, unsigned numLevels);
+    /// Set ratio of octant culling box size to octant size, clamped to 2-4. Larger values let moving drawables stay in their octant longer, which reduces reinsertions but makes octant culling less precise. Drawable objects will be temporarily moved to the root.
+    void SetLooseFactor(float factor);
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
     /// Add a drawable manually.
@@ -183,6 +218,8 @@ public:
 
     /// Return drawable objects by a query.
     void GetDrawables(OctreeQuery& query) const;
+    /// Return drawable objects by a multi-frustum query, traversing the octree only once for all the frustums.
+    void GetDrawables(MultiFrustumOctreeQuery& query) const;
     /// Return drawable objects by a ray query.
     void Raycast(RayOctreeQuery& query) const;
     /// Return the closest drawable object by a ray query.
@@ -190,6 +227,17 @@ public:
 
     /// Return subdivision levels.
     unsigned GetNumLevels() const { return numLevels_; }
+    /// Return ratio of octant culling box size to octant size.
+    float GetLooseFactor() const { return looseFactor_; }
+
+    /// Record the world bounding box of a drawable object that was added, removed, moved or resized. Called internally.
+    void MarkChanged(const BoundingBox& box);
+    /// Return whether a drawable object was added, removed, moved or resized within a sphere since the change count. Also true if that part of the change history has been discarded.
+    bool HasChanges(unsigned sinceChange, const Sphere& sphere) const;
+    /// Return whether a drawable object was added, removed, moved or resized within a frustum since the change count. Also true if that part of the change history has been discarded.
+    bool HasChanges(unsigned sinceChange, const Frustum& frustum) const;
+    /// Return number of changed drawable object bounding boxes recorded so far. Used with HasChanges() to validate cached queries.
+    unsigned GetNumChanges() const { return numChanges_; }
 
     /// Mark drawable object as requiring an update and a reinsertion.
     void QueueUpdate(Drawable* drawable);
@@ -208,12 +256,24 @@ private:
     PODVector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     PODVector<Drawable*> threadedDrawableUpdates_;
+    /// Target octants of the drawable objects that require update, found during reinsertion.
+    PODVector<Octant*> reinsertionTargets_;
+    /// Octants that drawable objects were moved from during reinsertion.
+    PODVector<Octant*> movedFromOctants_;
+    /// Drawable objects that require new child octants during reinsertion.
+    PODVector<Drawable*> newOctantDrawables_;
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable PODVector<Drawable*> rayQueryDrawables_;
+    /// Recent change history of drawable object bounding boxes.
+    Vector<BoundingBox> changedBoxes_;
+    /// Number of changed bounding boxes recorded.
+    unsigned numChanges_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Ratio of octant culling box size to octant size.
+    float looseFactor_;
 };
 
 }
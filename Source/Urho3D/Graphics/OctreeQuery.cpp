@@ -117,6 +117,18 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+bool MultiFrustumOctreeQuery::AddFrustum(const Frustum& frustum, unsigned viewMask, PODVector<Drawable*>& inside,
+    PODVector<Drawable*>& intersecting)
+{
+    if (frustums_.Size() >= MAX_QUERY_FRUSTUMS)
+        return false;
+
+    frustums_.Push(frustum);
+    viewMasks_.Push(viewMask);
+    insideResults_.Push(&inside);
+    intersectingResults_.Push(&intersecting);
+    return true;
+}
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
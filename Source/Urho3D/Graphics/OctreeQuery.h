@@ -58,6 +58,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Return a frustum that the drawables must be inside. If not null, the drawables of octants intersecting the frustum are tested against it in batches, and only the drawables inside are passed to TestDrawables() as inside.
+    virtual const Frustum* GetDrawableFrustum() const { return nullptr; }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -146,6 +148,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Return the frustum for batched drawable tests.
+    const Frustum* GetDrawableFrustum() const override { return &frustum_; }
 
     /// Frustum.
     Frustum frustum_;
@@ -252,6 +256,39 @@ public:
     RayQueryLevel level_;
 };
 
+/// Maximum number of frustums in a multi-frustum octree query.
+static const unsigned MAX_QUERY_FRUSTUMS = 32;
+
+/// %Frustum octree query for several frustums in one traversal. Each frustum has its own view mask and result vectors: drawables of octants fully inside the frustum, and drawables of intersecting octants, which still need to be tested individually.
+class URHO3D_API MultiFrustumOctreeQuery
+{
+public:
+    /// Construct with drawable flags.
+    explicit MultiFrustumOctreeQuery(unsigned char drawableFlags = DRAWABLE_ANY) :
+        drawableFlags_(drawableFlags)
+    {
+    }
+
+    /// Prevent copy construction.
+    MultiFrustumOctreeQuery(const MultiFrustumOctreeQuery& rhs) = delete;
+    /// Prevent assignment.
+    MultiFrustumOctreeQuery& operator =(const MultiFrustumOctreeQuery& rhs) = delete;
+
+    /// Add a frustum with its view mask and result vectors. Return false if the maximum number of frustums has been reached.
+    bool AddFrustum(const Frustum& frustum, unsigned viewMask, PODVector<Drawable*>& inside, PODVector<Drawable*>& intersecting);
+
+    /// Frustums.
+    Vector<Frustum> frustums_;
+    /// Drawable layers to include for each frustum.
+    PODVector<unsigned> viewMasks_;
+    /// Result vectors for drawables in octants fully inside each frustum.
+    PODVector<PODVector<Drawable*>*> insideResults_;
+    /// Result vectors for drawables in octants intersecting each frustum.
+    PODVector<PODVector<Drawable*>*> intersectingResults_;
+    /// Drawable flags to include.
+    unsigned char drawableFlags_;
+};
+
 class URHO3D_API AllContentOctreeQuery : public OctreeQuery
 {
 public:
@@ -42,6 +42,7 @@ void ConstantBuffer::Release()
 #ifndef GL_ES_VERSION_2_0
         graphics_->SetUBO(0);
         glDeleteBuffers(1, &object_.name_);
+        graphics_->CleanupConstantBuffer(this);
 #endif
         object_.name_ = 0;
     }
@@ -26,11 +26,13 @@
 #include "../../Core/Mutex.h"
 #include "../../Core/ProcessUtils.h"
 #include "../../Core/Profiler.h"
+#include "../../Core/Thread.h"
 #include "../../Graphics/ConstantBuffer.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
 #include "../../Graphics/IndexBuffer.h"
+#include "../../Graphics/Material.h"
 #include "../../Graphics/RenderSurface.h"
 #include "../../Graphics/Shader.h"
 #include "../../Graphics/ShaderPrecache.h"
@@ -52,6 +54,16 @@
 #define glClearDepth glClearDepthf
 #endif
 
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+#ifndef GL_UNSIGNED_INT_2_10_10_10_REV
+#define GL_UNSIGNED_INT_2_10_10_10_REV 0x8368
+#endif
+
 #ifdef __EMSCRIPTEN__
 // Emscripten provides even all GL extension functions via static linking. However there is
 // no GLES2-specific extension header at the moment to include instanced rendering declarations,
@@ -145,7 +157,8 @@ static const unsigned glStencilOps[] =
 };
 #endif
 
-static const unsigned glElementTypes[] =
+// Not const, as the half float type of GLES2 comes from an extension and differs from the core one
+static unsigned glElementTypes[] =
 {
     GL_INT,
     GL_FLOAT,
@@ -153,7 +166,14 @@ static const unsigned glElementTypes[] =
     GL_FLOAT,
     GL_FLOAT,
     GL_UNSIGNED_BYTE,
-    GL_UNSIGNED_BYTE
+    GL_UNSIGNED_BYTE,
+    GL_HALF_FLOAT,
+    GL_HALF_FLOAT,
+    GL_SHORT,
+    GL_SHORT,
+    GL_UNSIGNED_SHORT,
+    GL_UNSIGNED_SHORT,
+    GL_UNSIGNED_INT_2_10_10_10_REV
 };
 
 static const unsigned glElementComponents[] =
@@ -164,9 +184,34 @@ static const unsigned glElementComponents[] =
     3,
     4,
     4,
+    4,
+    2,
+    4,
+    2,
+    4,
+    2,
+    4,
     4
 };
 
+static const bool glElementNormalized[] =
+{
+    false,
+    false,
+    false,
+    false,
+    false,
+    false,
+    true,
+    false,
+    false,
+    true,
+    true,
+    true,
+    true,
+    true
+};
+
 #ifdef GL_ES_VERSION_2_0
 static unsigned glesDepthStencilFormat = GL_DEPTH_COMPONENT16;
 static unsigned glesReadableDepthFormat = GL_DEPTH_COMPONENT;
@@ -241,7 +286,7 @@ Graphics::Graphics(Context* context) :
     context_->RequireSDL(SDL_INIT_VIDEO);
 
     // Register Graphics library object factories
-    RegisterGraphicsLibrary(context_);
+    context_->RegisterLibrary("Graphics", RegisterGraphicsLibrary);
 }
 
 Graphics::~Graphics()
@@ -641,6 +686,9 @@ bool Graphics::BeginFrame()
     numPrimitives_ = 0;
     numBatches_ = 0;
 
+    UpdateReadbacks();
+    BeginGPUTimerFrame();
+
     SendEvent(E_BEGINRENDERING);
 
     return true;
@@ -655,6 +703,8 @@ void Graphics::EndFrame()
 
     SendEvent(E_ENDRENDERING);
 
+    EndGPUTimerFrame();
+
     SDL_GL_SwapWindow(window_);
 
     // Clean up too large scratch buffers
@@ -982,6 +1032,55 @@ void Graphics::DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned i
 #endif
 }
 
+void Graphics::MultiDrawInstanced(PrimitiveType type, const PODVector<InstancedDrawCommand>& commands)
+{
+    if (!multiDrawSupport_)
+    {
+        MultiDrawInstancedFallback(type, commands);
+        return;
+    }
+
+#ifndef GL_ES_VERSION_2_0
+    if (commands.Empty() || !indexBuffer_ || !indexBuffer_->GetGPUObjectName())
+        return;
+
+    // The base instance of each command offsets the instance data instead of the attribute pointers
+    PODVector<VertexBuffer*> vertexBuffers(vertexBuffers_, MAX_VERTEX_STREAMS);
+    SetVertexBuffers(vertexBuffers, 0);
+
+    PrepareDraw();
+
+    unsigned indexSize = indexBuffer_->GetIndexSize();
+    unsigned primitiveCount;
+    GLenum glPrimitiveType = GL_TRIANGLES;
+    GLenum indexType = indexSize == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    // Fill the indirect commands: index count, instance count, first index, base vertex and base instance
+    impl_->indirectCommands_.Resize(commands.Size() * 5);
+    unsigned* dest = impl_->indirectCommands_.Buffer();
+    for (unsigned i = 0; i < commands.Size(); ++i)
+    {
+        const InstancedDrawCommand& command = commands[i];
+        GetGLPrimitiveType(command.indexCount_, type, primitiveCount, glPrimitiveType);
+        *dest++ = command.indexCount_;
+        *dest++ = command.instanceCount_;
+        *dest++ = command.indexStart_;
+        *dest++ = 0;
+        *dest++ = command.instanceStart_;
+        numPrimitives_ += command.instanceCount_ * primitiveCount;
+    }
+
+    if (!impl_->indirectBuffer_)
+        glGenBuffers(1, &impl_->indirectBuffer_);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, impl_->indirectBuffer_);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, impl_->indirectCommands_.Size() * sizeof(unsigned), impl_->indirectCommands_.Buffer(),
+        GL_STREAM_DRAW);
+    glMultiDrawElementsIndirect(glPrimitiveType, indexType, nullptr, commands.Size(), 0);
+
+    ++numBatches_;
+#endif
+}
+
 void Graphics::SetVertexBuffer(VertexBuffer* buffer)
 {
     // Note: this is not multi-instance safe
@@ -1026,6 +1125,12 @@ bool Graphics::SetVertexBuffers(const Vector<SharedPtr<VertexBuffer> >& buffers,
 
 void Graphics::SetIndexBuffer(IndexBuffer* buffer)
 {
+    if (!Thread::IsMainThread())
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer ? buffer->GetGPUObjectName() : 0);
+        return;
+    }
+
     if (indexBuffer_ == buffer)
         return;
 
@@ -1141,11 +1246,8 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             ConstantBuffer* buffer = constantBuffers[i].Get();
             if (buffer != impl_->constantBuffers_[i])
             {
-                unsigned object = buffer ? buffer->GetGPUObjectName() : 0;
-                glBindBufferBase(GL_UNIFORM_BUFFER, i, object);
-                // Calling glBindBufferBase also affects the generic buffer binding point
-                impl_->boundUBO_ = object;
                 impl_->constantBuffers_[i] = buffer;
+                impl_->constantBuffersDirty_ = true;
                 ShaderProgram::ClearGlobalParameterSource((ShaderParameterGroup)(i % MAX_SHADER_PARAMETER_GROUPS));
             }
         }
@@ -1483,6 +1585,80 @@ bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* sourc
     return impl_->shaderProgram_ ? impl_->shaderProgram_->NeedParameterUpdate(group, source) : false;
 }
 
+bool Graphics::SetMaterialShaderParameters(Material* material)
+{
+#ifndef GL_ES_VERSION_2_0
+    ShaderProgram* program = impl_->shaderProgram_;
+    if (!gl3Support || !program || !material)
+        return false;
+
+    const SharedPtr<ConstantBuffer>* constantBuffers = program->GetConstantBuffers();
+    ConstantBuffer* sharedBuffers[2] = {constantBuffers[SP_MATERIAL], constantBuffers[SP_MATERIAL + MAX_SHADER_PARAMETER_GROUPS]};
+    if (!sharedBuffers[VS] && !sharedBuffers[PS])
+        return false;
+
+    HashMap<unsigned, MaterialConstantBuffer>& materialBuffers = material->GetConstantBuffers();
+    unsigned parameterHash = material->GetShaderParameterHash();
+    MaterialConstantBuffer* entries[2] = {};
+    bool needFill = false;
+
+    for (unsigned i = VS; i <= PS; ++i)
+    {
+        if (!sharedBuffers[i])
+            continue;
+
+        MaterialConstantBuffer& entry = materialBuffers[program->GetMaterialLayoutHash((ShaderType)i)];
+        // Also recreate after context loss, which releases the buffer
+        if (!entry.buffer_ || entry.buffer_->GetSize() != sharedBuffers[i]->GetSize())
+        {
+            entry.buffer_ = new ConstantBuffer(context_);
+            entry.buffer_->SetSize(sharedBuffers[i]->GetSize());
+            entry.parameterHash_ = parameterHash + 1;
+        }
+        if (entry.parameterHash_ != parameterHash)
+            needFill = true;
+        entries[i] = &entry;
+    }
+
+    if (needFill)
+    {
+        // Write the parameters through the shared buffers for the same conversions as when setting them individually, then
+        // copy the whole layout
+        const HashMap<StringHash, MaterialShaderParameter>& parameters = material->GetShaderParameters();
+        for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
+            SetShaderParameter(i->first_, i->second_.value_);
+        program->ClearParameterSource(SP_MATERIAL);
+
+        for (unsigned i = VS; i <= PS; ++i)
+        {
+            if (entries[i] && entries[i]->parameterHash_ != parameterHash)
+            {
+                entries[i]->buffer_->SetParameter(0, sharedBuffers[i]->GetSize(), sharedBuffers[i]->GetShadowData());
+                entries[i]->buffer_->Apply();
+                entries[i]->parameterHash_ = parameterHash;
+            }
+        }
+    }
+
+    for (unsigned i = VS; i <= PS; ++i)
+    {
+        if (!entries[i])
+            continue;
+
+        unsigned binding = SP_MATERIAL + (i == PS ? MAX_SHADER_PARAMETER_GROUPS : 0);
+        if (entries[i]->buffer_ != impl_->constantBuffers_[binding])
+        {
+            impl_->constantBuffers_[binding] = entries[i]->buffer_;
+            impl_->constantBuffersDirty_ = true;
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool Graphics::HasShaderParameter(StringHash param)
 {
     return impl_->shaderProgram_ && impl_->shaderProgram_->HasParameter(param);
@@ -1504,6 +1680,11 @@ void Graphics::ClearParameterSources()
     ShaderProgram::ClearParameterSources();
 }
 
+void Graphics::ClearViewParameterSources()
+{
+    ShaderProgram::ClearViewParameterSources();
+}
+
 void Graphics::ClearTransformSources()
 {
     if (impl_->shaderProgram_)
@@ -1587,6 +1768,13 @@ void Graphics::SetTexture(unsigned index, Texture* texture)
 
 void Graphics::SetTextureForUpdate(Texture* texture)
 {
+    // Background uploads bind the texture in the upload context, without touching the cached rendering state
+    if (!Thread::IsMainThread())
+    {
+        glBindTexture(texture->GetTarget(), texture->GetGPUObjectName());
+        return;
+    }
+
     if (impl_->activeTexture_ != 0)
     {
         glActiveTexture(GL_TEXTURE0);
@@ -1611,6 +1799,54 @@ void Graphics::SetDefaultTextureFilterMode(TextureFilterMode mode)
     }
 }
 
+bool Graphics::BeginBackgroundUpload()
+{
+    if (!impl_->uploadContext_ || Thread::IsMainThread())
+        return false;
+
+    impl_->uploadMutex_.Acquire();
+    // The context may have been released while waiting
+    if (!impl_->uploadContext_ || SDL_GL_MakeCurrent(window_, impl_->uploadContext_) != 0)
+    {
+        impl_->uploadMutex_.Release();
+        return false;
+    }
+
+#ifndef GL_ES_VERSION_2_0
+    if (!impl_->uploadContextInitialized_)
+    {
+        // A core profile context needs a vertex array object bound for index buffer uploads
+        unsigned vertexArrayObject;
+        glGenVertexArrays(1, &vertexArrayObject);
+        glBindVertexArray(vertexArrayObject);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        impl_->uploadContextInitialized_ = true;
+    }
+#endif
+
+    return true;
+}
+
+void Graphics::EndBackgroundUpload()
+{
+#ifndef GL_ES_VERSION_2_0
+    // Wait on the loader thread, so that the objects are complete when the main thread starts using them
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (fence)
+    {
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+            ;
+        glDeleteSync(fence);
+    }
+    else
+        glFinish();
+#endif
+
+    SDL_GL_MakeCurrent(window_, nullptr);
+    impl_->uploadMutex_.Release();
+}
+
 void Graphics::SetDefaultTextureAnisotropy(unsigned level)
 {
     level = Max(level, 1U);
@@ -2393,6 +2629,8 @@ void Graphics::Release(bool clearGPUObjects, bool closeWindow)
     }
 
     CleanupFramebuffers();
+    ReleaseGPUTimers();
+    ReleaseReadbacks();
     impl_->depthTextures_.Clear();
 
     // End fullscreen mode first to counteract transition and getting stuck problems on OS X
@@ -2407,6 +2645,21 @@ void Graphics::Release(bool clearGPUObjects, bool closeWindow)
         if (!clearGPUObjects)
             URHO3D_LOGINFO("OpenGL context lost");
 
+        if (impl_->indirectBuffer_)
+        {
+            if (!IsDeviceLost())
+                glDeleteBuffers(1, &impl_->indirectBuffer_);
+            impl_->indirectBuffer_ = 0;
+        }
+
+        if (impl_->uploadContext_)
+        {
+            // Wait for a background upload in progress
+            MutexLock lock(impl_->uploadMutex_);
+            SDL_GL_DeleteContext(impl_->uploadContext_);
+            impl_->uploadContext_ = nullptr;
+        }
+
         SDL_GL_DeleteContext(impl_->context_);
         impl_->context_ = nullptr;
     }
@@ -2488,6 +2741,19 @@ void Graphics::Restore()
             unsigned vertexArrayObject;
             glGenVertexArrays(1, &vertexArrayObject);
             glBindVertexArray(vertexArrayObject);
+
+#ifndef __APPLE__
+            // Create a second context sharing the objects, so that resources loaded in the background can upload their
+            // data on the loader thread. Creating it makes it current, so switch back to the main context
+            MutexLock lock(impl_->uploadMutex_);
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+            impl_->uploadContext_ = SDL_GL_CreateContext(window_);
+            impl_->uploadContextInitialized_ = false;
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+            SDL_GL_MakeCurrent(window_, impl_->context_);
+            if (!impl_->uploadContext_)
+                URHO3D_LOGWARNINGF("Could not create OpenGL upload context, root cause '%s'", SDL_GetError());
+#endif
         }
         else if (GLEW_VERSION_2_0)
         {
@@ -2538,6 +2804,12 @@ void Graphics::MarkFBODirty()
 
 void Graphics::SetVBO(unsigned object)
 {
+    if (!Thread::IsMainThread())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, object);
+        return;
+    }
+
     if (impl_->boundVBO_ != object)
     {
         if (object)
@@ -2546,6 +2818,30 @@ void Graphics::SetVBO(unsigned object)
     }
 }
 
+void Graphics::CleanupVBO(unsigned object)
+{
+    // The name may be reused by a new buffer, so forget the pointers that referred to the deleted one
+    for (auto& pointer : impl_->vertexAttributePointers_)
+    {
+        if (pointer.buffer_ == object)
+            pointer = VertexAttributePointer();
+    }
+}
+
+void Graphics::CleanupConstantBuffer(ConstantBuffer* buffer)
+{
+    for (unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS * 2; ++i)
+    {
+        if (impl_->constantBuffers_[i] == buffer)
+        {
+            impl_->constantBuffers_[i] = nullptr;
+            impl_->constantBuffersDirty_ = true;
+        }
+        if (impl_->boundConstantBuffers_[i] == buffer)
+            impl_->boundConstantBuffers_[i] = nullptr;
+    }
+}
+
 void Graphics::SetUBO(unsigned object)
 {
 #ifndef GL_ES_VERSION_2_0
@@ -2746,12 +3042,19 @@ void Graphics::CheckFeatureSupport()
     lightPrepassSupport_ = false;
     deferredSupport_ = false;
 
+    // Identify the driver for validating cached program binaries
+    impl_->driverHash_ = StringHash(String((const char*)glGetString(GL_VENDOR)) + String((const char*)glGetString(GL_RENDERER)) +
+        String((const char*)glGetString(GL_VERSION))).Value();
+
 #ifndef GL_ES_VERSION_2_0
     int numSupportedRTs = 1;
     if (gl3Support)
     {
         // Work around GLEW failure to check extensions properly from a GL3 context
         instancingSupport_ = glDrawElementsInstanced != nullptr && glVertexAttribDivisor != nullptr;
+        // Multi-draw needs the base instance of each indirect command to be honored
+        multiDrawSupport_ = instancingSupport_ && glMultiDrawElementsIndirect != nullptr &&
+            glDrawElementsInstancedBaseInstance != nullptr;
         dxtTextureSupport_ = true;
         anisotropySupport_ = true;
         sRGBSupport_ = true;
@@ -2770,6 +3073,18 @@ void Graphics::CheckFeatureSupport()
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS_EXT, &numSupportedRTs);
     }
 
+    gpuTimingSupport_ = gl3Support ? glQueryCounter != nullptr : GLEW_ARB_timer_query != 0;
+    // Pixel buffer objects are core since OpenGL 2.1, fence syncs since 3.2
+    asyncReadbackSupport_ = gl3Support ? glFenceSync != nullptr : GLEW_ARB_pixel_buffer_object && GLEW_ARB_sync;
+
+    // Normalized shorts are core since OpenGL 2, half floats and the packed type need GL3 or extensions
+    compressedVertexSupport_ = (1u << TYPE_SHORT2_NORM) | (1u << TYPE_SHORT4_NORM) | (1u << TYPE_USHORT2_NORM) |
+        (1u << TYPE_USHORT4_NORM);
+    if (gl3Support || GLEW_ARB_half_float_vertex)
+        compressedVertexSupport_ |= (1u << TYPE_HALF2) | (1u << TYPE_HALF4);
+    if (gl3Support || GLEW_ARB_vertex_type_2_10_10_10_rev)
+        compressedVertexSupport_ |= 1u << TYPE_UINT_10_10_10_2_NORM;
+
     // Must support 2 rendertargets for light pre-pass, and 4 for deferred
     if (numSupportedRTs >= 2)
         lightPrepassSupport_ = true;
@@ -2799,6 +3114,21 @@ void Graphics::CheckFeatureSupport()
     pvrtcTextureSupport_ = CheckExtension("IMG_texture_compression_pvrtc");
 #endif
 
+    // Check for compressed vertex element types. WebGL 2 has half floats and the packed type in core, while GLES2 only has
+    // half floats as an extension, with a different type enum
+    compressedVertexSupport_ = (1u << TYPE_SHORT2_NORM) | (1u << TYPE_SHORT4_NORM) | (1u << TYPE_USHORT2_NORM) |
+        (1u << TYPE_USHORT4_NORM);
+#ifdef __EMSCRIPTEN__
+    if (strstr((const char *)glGetString(GL_VERSION), "WebGL 2.") != 0)
+        compressedVertexSupport_ |= (1u << TYPE_HALF2) | (1u << TYPE_HALF4) | (1u << TYPE_UINT_10_10_10_2_NORM);
+#else
+    if (CheckExtension("OES_vertex_half_float"))
+    {
+        compressedVertexSupport_ |= (1u << TYPE_HALF2) | (1u << TYPE_HALF4);
+        glElementTypes[TYPE_HALF2] = glElementTypes[TYPE_HALF4] = GL_HALF_FLOAT_OES;
+    }
+#endif
+
     // Check for best supported depth renderbuffer format for GLES2
     if (CheckExtension("GL_OES_depth24"))
         glesDepthStencilFormat = GL_DEPTH_COMPONENT24_OES;
@@ -2838,6 +3168,25 @@ void Graphics::PrepareDraw()
 #ifndef GL_ES_VERSION_2_0
     if (gl3Support)
     {
+        // Constant buffers are bound only here, as a material's own buffers may replace the shader program's shared buffers
+        // after the shaders are set
+        if (impl_->constantBuffersDirty_)
+        {
+            for (unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS * 2; ++i)
+            {
+                ConstantBuffer* buffer = impl_->constantBuffers_[i];
+                if (buffer != impl_->boundConstantBuffers_[i])
+                {
+                    unsigned object = buffer ? buffer->GetGPUObjectName() : 0;
+                    glBindBufferBase(GL_UNIFORM_BUFFER, i, object);
+                    // Calling glBindBufferBase also affects the generic buffer binding point
+                    impl_->boundUBO_ = object;
+                    impl_->boundConstantBuffers_[i] = buffer;
+                }
+            }
+            impl_->constantBuffersDirty_ = false;
+        }
+
         for (PODVector<ConstantBuffer*>::Iterator i = impl_->dirtyConstantBuffers_.Begin(); i != impl_->dirtyConstantBuffers_.End(); ++i)
             (*i)->Apply();
         impl_->dirtyConstantBuffers_.Clear();
@@ -3119,10 +3468,20 @@ void Graphics::PrepareDraw()
                         }
                     }
 
-                    SetVBO(buffer->GetGPUObjectName());
-                    glVertexAttribPointer(location, glElementComponents[element.type_], glElementTypes[element.type_],
-                        element.type_ == TYPE_UBYTE4_NORM ? GL_TRUE : GL_FALSE, (unsigned)buffer->GetVertexSize(),
-                        (const void *)(size_t)dataStart);
+                    // Skip the pointer if it is unchanged, as only the buffer set or the shader program may have changed
+                    VertexAttributePointer& pointer = impl_->vertexAttributePointers_[location];
+                    if (pointer.buffer_ != buffer->GetGPUObjectName() || pointer.offset_ != dataStart ||
+                        pointer.stride_ != buffer->GetVertexSize() || pointer.type_ != element.type_)
+                    {
+                        SetVBO(buffer->GetGPUObjectName());
+                        glVertexAttribPointer(location, glElementComponents[element.type_], glElementTypes[element.type_],
+                            glElementNormalized[element.type_] ? GL_TRUE : GL_FALSE, (unsigned)buffer->GetVertexSize(),
+                            (const void *)(size_t)dataStart);
+                        pointer.buffer_ = buffer->GetGPUObjectName();
+                        pointer.offset_ = dataStart;
+                        pointer.stride_ = buffer->GetVertexSize();
+                        pointer.type_ = element.type_;
+                    }
                 }
             }
         }
@@ -3171,6 +3530,190 @@ void Graphics::CleanupFramebuffers()
     impl_->frameBuffers_.Clear();
 }
 
+void Graphics::BeginTimerQueryFrame(unsigned frame)
+{
+    // Timestamp queries need no frame-level query on OpenGL
+}
+
+void Graphics::EndTimerQueryFrame(unsigned frame)
+{
+}
+
+void Graphics::IssueTimerQuery(unsigned frame, unsigned index)
+{
+#ifndef GL_ES_VERSION_2_0
+    unsigned& query = impl_->timerQueries_[frame][index];
+    if (!query)
+        glGenQueries(1, &query);
+    glQueryCounter(query, GL_TIMESTAMP);
+#endif
+}
+
+bool Graphics::GetTimerQueryResults(unsigned frame, unsigned count, PODVector<long long>& dest)
+{
+#ifndef GL_ES_VERSION_2_0
+    dest.Resize(count);
+    if (!count)
+        return true;
+
+    // The queries complete in order, so the last one being available means all are
+    GLint available = 0;
+    glGetQueryObjectiv(impl_->timerQueries_[frame][count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return false;
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        GLuint64 time = 0;
+        glGetQueryObjectui64v(impl_->timerQueries_[frame][i], GL_QUERY_RESULT, &time);
+        // Convert nanoseconds to microseconds as used by the profiler
+        dest[i] = (long long)(time / 1000);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Graphics::ReleaseTimerQueries()
+{
+#ifndef GL_ES_VERSION_2_0
+    for (auto& frameQueries : impl_->timerQueries_)
+    {
+        for (unsigned& query : frameQueries)
+        {
+            if (query && !IsDeviceLost())
+                glDeleteQueries(1, &query);
+            query = 0;
+        }
+    }
+#endif
+}
+
+bool Graphics::IssueTextureReadback(GPUReadback* readback, Texture2D* texture, unsigned level)
+{
+    unsigned dataSize = readback->rowSize_ * readback->numRows_;
+
+#ifndef GL_ES_VERSION_2_0
+    if (asyncReadbackSupport_)
+    {
+        if (texture->IsResolveDirty())
+            ResolveToTexture(texture);
+
+        // Copy into a pixel buffer object, which returns without waiting for the GPU
+        glGenBuffers(1, &readback->object_.name_);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->object_.name_);
+        glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        SetTextureForUpdate(texture);
+        unsigned format = texture->GetFormat();
+        if (!texture->IsCompressed())
+            glGetTexImage(texture->GetTarget(), level, Texture::GetExternalFormat(format), Texture::GetDataType(format), nullptr);
+        else
+            glGetCompressedTexImage(texture->GetTarget(), level, nullptr);
+        SetTexture(0, nullptr);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback->fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return true;
+    }
+#endif
+
+    readback->data_.Resize(dataSize);
+    return texture->GetData(level, readback->data_.Buffer());
+}
+
+bool Graphics::IssueScreenReadback(GPUReadback* readback)
+{
+    unsigned dataSize = readback->rowSize_ * readback->numRows_;
+
+    ResetRenderTargets();
+
+    // On OpenGL the rows need to be flipped after reading
+    readback->flipVertical_ = true;
+
+#ifndef GL_ES_VERSION_2_0
+    if (asyncReadbackSupport_)
+    {
+        glGenBuffers(1, &readback->object_.name_);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->object_.name_);
+        glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback->fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return true;
+    }
+#endif
+
+    PODVector<unsigned char> rows(dataSize);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, rows.Buffer());
+    readback->data_.Resize(dataSize);
+    for (unsigned i = 0; i < readback->numRows_; ++i)
+        memcpy(&readback->data_[i * readback->rowSize_], &rows[(readback->numRows_ - 1 - i) * readback->rowSize_], readback->rowSize_);
+    return true;
+}
+
+bool Graphics::GetReadbackData(GPUReadback* readback)
+{
+#ifndef GL_ES_VERSION_2_0
+    if (!readback->object_.name_)
+        return true;
+
+    GLenum status = glClientWaitSync((GLsync)readback->fence_, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    if (status == GL_WAIT_FAILED)
+    {
+        URHO3D_LOGERROR("Failed to wait for texture readback");
+        readback->failed_ = true;
+        return true;
+    }
+
+    unsigned dataSize = readback->rowSize_ * readback->numRows_;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->object_.name_);
+    auto* src = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (src)
+    {
+        readback->data_.Resize(dataSize);
+        for (unsigned i = 0; i < readback->numRows_; ++i)
+        {
+            unsigned srcRow = readback->flipVertical_ ? readback->numRows_ - 1 - i : i;
+            memcpy(&readback->data_[i * readback->rowSize_], src + srcRow * readback->rowSize_, readback->rowSize_);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        URHO3D_LOGERROR("Failed to map pixel buffer for texture readback");
+        readback->failed_ = true;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
+    return true;
+}
+
+void Graphics::ReleaseReadbackObjects(GPUReadback* readback)
+{
+#ifndef GL_ES_VERSION_2_0
+    if (readback->fence_)
+    {
+        if (!IsDeviceLost())
+            glDeleteSync((GLsync)readback->fence_);
+        readback->fence_ = nullptr;
+    }
+    if (readback->object_.name_)
+    {
+        if (!IsDeviceLost())
+            glDeleteBuffers(1, &readback->object_.name_);
+        readback->object_.name_ = 0;
+    }
+#endif
+}
+
 void Graphics::ResetCachedState()
 {
     for (auto& vertexBuffer : vertexBuffers_)
@@ -3217,6 +3760,8 @@ void Graphics::ResetCachedState()
     impl_->enabledVertexAttributes_ = 0;
     impl_->usedVertexAttributes_ = 0;
     impl_->instancingVertexAttributes_ = 0;
+    for (auto& pointer : impl_->vertexAttributePointers_)
+        pointer = VertexAttributePointer();
     impl_->boundFBO_ = impl_->systemFBO_;
     impl_->boundVBO_ = 0;
     impl_->boundUBO_ = 0;
@@ -3233,6 +3778,9 @@ void Graphics::ResetCachedState()
 
     for (auto& constantBuffer : impl_->constantBuffers_)
         constantBuffer = nullptr;
+    for (auto& constantBuffer : impl_->boundConstantBuffers_)
+        constantBuffer = nullptr;
+    impl_->constantBuffersDirty_ = false;
     impl_->dirtyConstantBuffers_.Clear();
 }
 
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../../Container/HashMap.h"
+#include "../../Core/Mutex.h"
 #include "../../Core/Timer.h"
 #include "../../Graphics/ConstantBuffer.h"
 #include "../../Graphics/ShaderProgram.h"
@@ -74,6 +75,22 @@ class Context;
 using ConstantBufferMap = HashMap<unsigned, SharedPtr<ConstantBuffer> >;
 using ShaderProgramMap = HashMap<Pair<ShaderVariation*, ShaderVariation*>, SharedPtr<ShaderProgram> >;
 
+/// Maximum number of vertex attribute locations tracked by the attribute bitmasks.
+static const unsigned MAX_VERTEX_ATTRIBUTE_LOCATIONS = 32;
+
+/// Cached vertex attribute pointer, to avoid redundant glVertexAttribPointer calls.
+struct VertexAttributePointer
+{
+    /// Vertex buffer handle.
+    unsigned buffer_{};
+    /// Data offset in the vertex buffer.
+    unsigned offset_{};
+    /// Vertex size in bytes.
+    unsigned stride_{};
+    /// Element data type.
+    VertexElementType type_{};
+};
+
 /// Cached state of a frame buffer object
 struct FrameBufferObject
 {
@@ -101,9 +118,16 @@ public:
     /// Return the GL Context.
     const SDL_GLContext& GetGLContext() { return context_; }
 
+    /// Return hash of the GL vendor, renderer and version strings.
+    unsigned GetDriverHash() const { return driverHash_; }
+
 private:
     /// SDL OpenGL context.
     SDL_GLContext context_{};
+    /// Context sharing the objects of the main context, for uploading resources from a loader thread.
+    SDL_GLContext uploadContext_{};
+    /// Mutex for using the upload context.
+    Mutex uploadMutex_;
     /// iOS/tvOS system framebuffer handle.
     unsigned systemFBO_{};
     /// Active texture unit.
@@ -114,6 +138,8 @@ private:
     unsigned usedVertexAttributes_{};
     /// Vertex attribute instancing bitmask for keeping track of divisors.
     unsigned instancingVertexAttributes_{};
+    /// Vertex attribute pointers last set by location.
+    VertexAttributePointer vertexAttributePointers_[MAX_VERTEX_ATTRIBUTE_LOCATIONS]{};
     /// Current mapping of vertex attribute locations by semantic. The map is owned by the shader program, so care must be taken to switch a null shader program when it's destroyed.
     const HashMap<Pair<unsigned char, unsigned char>, unsigned>* vertexAttributes_{};
     /// Currently bound frame buffer object.
@@ -122,6 +148,10 @@ private:
     unsigned boundVBO_{};
     /// Currently bound uniform buffer object.
     unsigned boundUBO_{};
+    /// Indirect draw command buffer for multi-draw.
+    unsigned indirectBuffer_{};
+    /// Indirect draw command staging data.
+    PODVector<unsigned> indirectCommands_;
     /// Read frame buffer for multisampled texture resolves.
     unsigned resolveSrcFBO_{};
     /// Write frame buffer for multisampled texture resolves.
@@ -134,8 +164,10 @@ private:
     unsigned textureTypes_[MAX_TEXTURE_UNITS]{};
     /// Constant buffer search map.
     ConstantBufferMap allConstantBuffers_;
-    /// Currently bound constant buffers.
+    /// Constant buffers to bind before the next draw call.
     ConstantBuffer* constantBuffers_[MAX_SHADER_PARAMETER_GROUPS * 2]{};
+    /// Currently bound constant buffers.
+    ConstantBuffer* boundConstantBuffers_[MAX_SHADER_PARAMETER_GROUPS * 2]{};
     /// Dirty constant buffers.
     PODVector<ConstantBuffer*> dirtyConstantBuffers_;
     /// Last used instance data offset.
@@ -148,10 +180,18 @@ private:
     ShaderProgramMap shaderPrograms_;
     /// Need FBO commit flag.
     bool fboDirty_{};
+    /// Constant buffers dirty flag.
+    bool constantBuffersDirty_{};
     /// Need vertex attribute pointer update flag.
     bool vertexBuffersDirty_{};
     /// sRGB write mode flag.
     bool sRGBWrite_{};
+    /// Upload context initialized flag.
+    bool uploadContextInitialized_{};
+    /// Hash of the GL vendor, renderer and version strings.
+    unsigned driverHash_{};
+    /// Timestamp query objects per GPU timer frame, created on first use.
+    unsigned timerQueries_[GPU_TIMER_FRAMES][MAX_GPU_TIMER_QUERIES]{};
 };
 
 }
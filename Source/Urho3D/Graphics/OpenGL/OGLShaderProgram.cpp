@@ -25,8 +25,11 @@
 #include "../../Graphics/ConstantBuffer.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsImpl.h"
+#include "../../Graphics/Shader.h"
 #include "../../Graphics/ShaderProgram.h"
 #include "../../Graphics/ShaderVariation.h"
+#include "../../IO/File.h"
+#include "../../IO/FileSystem.h"
 #include "../../IO/Log.h"
 
 #include "../../DebugNew.h"
@@ -44,6 +47,9 @@ static const char* shaderParameterGroups[] = {
     "custom"
 };
 
+/// Program binary cache file version. Increment when the shader source preprocessing or the file layout changes.
+static const unsigned PROGRAM_BINARY_VERSION = 1;
+
 static unsigned NumberPostfix(const String& str)
 {
     for (unsigned i = 0; i < str.Length(); ++i)
@@ -107,6 +113,7 @@ void ShaderProgram::Release()
             useTextureUnit = false;
         for (unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
             constantBuffers_[i].Reset();
+        materialLayoutHashes_[VS] = materialLayoutHashes_[PS] = 0;
     }
 }
 
@@ -124,23 +131,53 @@ bool ShaderProgram::Link()
         return false;
     }
 
-    glAttachShader(object_.name_, vertexShader_->GetGPUObjectName());
-    glAttachShader(object_.name_, pixelShader_->GetGPUObjectName());
-    glLinkProgram(object_.name_);
+    int linked = 0, length;
+
+#ifndef GL_ES_VERSION_2_0
+    // Try the program binary cache first. The binary is keyed by the shader names and validated by a hash of the sources
+    String binaryName;
+    unsigned sourceHash = 0;
+    Shader* vsOwner = vertexShader_->GetOwner();
+    Shader* psOwner = pixelShader_->GetOwner();
+    if (GLEW_ARB_get_program_binary && vsOwner && psOwner && !graphics_->GetShaderCacheDir().Empty())
+    {
+        binaryName = graphics_->GetShaderCacheDir() + StringHash(vertexShader_->GetFullName() + " " +
+            pixelShader_->GetFullName()).ToString() + ".glp";
+        sourceHash = StringHash(vsOwner->GetSourceCode(VS) + vertexShader_->GetDefines() + psOwner->GetSourceCode(PS) +
+            pixelShader_->GetDefines()).Value();
+        linked = LoadProgramBinary(binaryName, sourceHash);
+    }
+#endif
 
-    int linked, length;
-    glGetProgramiv(object_.name_, GL_LINK_STATUS, &linked);
     if (!linked)
     {
-        glGetProgramiv(object_.name_, GL_INFO_LOG_LENGTH, &length);
-        linkerOutput_.Resize((unsigned)length);
-        int outLength;
-        glGetProgramInfoLog(object_.name_, length, &outLength, &linkerOutput_[0]);
-        glDeleteProgram(object_.name_);
-        object_.name_ = 0;
+        glAttachShader(object_.name_, vertexShader_->GetGPUObjectName());
+        glAttachShader(object_.name_, pixelShader_->GetGPUObjectName());
+#ifndef GL_ES_VERSION_2_0
+        if (!binaryName.Empty())
+            glProgramParameteri(object_.name_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+        glLinkProgram(object_.name_);
+
+        glGetProgramiv(object_.name_, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            glGetProgramiv(object_.name_, GL_INFO_LOG_LENGTH, &length);
+            linkerOutput_.Resize((unsigned)length);
+            int outLength;
+            glGetProgramInfoLog(object_.name_, length, &outLength, &linkerOutput_[0]);
+            glDeleteProgram(object_.name_);
+            object_.name_ = 0;
+        }
+        else
+        {
+            linkerOutput_.Clear();
+#ifndef GL_ES_VERSION_2_0
+            if (!binaryName.Empty())
+                SaveProgramBinary(binaryName, sourceHash);
+#endif
+        }
     }
-    else
-        linkerOutput_.Clear();
 
     if (!object_.name_)
         return false;
@@ -314,7 +351,100 @@ bool ShaderProgram::Link()
     vertexAttributes_.Rehash(NextPowerOfTwo(vertexAttributes_.Size()));
     shaderParameters_.Rehash(NextPowerOfTwo(shaderParameters_.Size()));
 
+#ifndef GL_ES_VERSION_2_0
+    // Hash the material parameter layouts, so that programs with the same layout share the material constant buffers
+    ConstantBuffer* vsMaterialBuffer = constantBuffers_[SP_MATERIAL];
+    ConstantBuffer* psMaterialBuffer = constantBuffers_[SP_MATERIAL + MAX_SHADER_PARAMETER_GROUPS];
+    materialLayoutHashes_[VS] = materialLayoutHashes_[PS] = 0;
+    for (HashMap<StringHash, ShaderParameter>::ConstIterator i = shaderParameters_.Begin(); i != shaderParameters_.End(); ++i)
+    {
+        ConstantBuffer* buffer = i->second_.bufferPtr_;
+        if (buffer && (buffer == vsMaterialBuffer || buffer == psMaterialBuffer))
+            materialLayoutHashes_[buffer == psMaterialBuffer] += (i->first_.Value() + i->second_.offset_) * 2654435761u;
+    }
+    materialLayoutHashes_[VS] = materialLayoutHashes_[VS] * 31 + (vsMaterialBuffer ? vsMaterialBuffer->GetSize() : 0) * 2;
+    materialLayoutHashes_[PS] = materialLayoutHashes_[PS] * 31 + (psMaterialBuffer ? psMaterialBuffer->GetSize() : 0) * 2 + 1;
+#endif
+
+    return true;
+}
+
+bool ShaderProgram::LoadProgramBinary(const String& binaryName, unsigned sourceHash)
+{
+#ifndef GL_ES_VERSION_2_0
+    auto* fileSystem = graphics_->GetSubsystem<FileSystem>();
+    if (!fileSystem->FileExists(binaryName))
+        return false;
+
+    File file(graphics_->GetContext(), binaryName);
+    if (file.ReadFileID() != "UGLP" || file.ReadUInt() != PROGRAM_BINARY_VERSION)
+        return false;
+
+    // The binary is only valid for the same driver and shader sources it was saved with
+    if (file.ReadUInt() != graphics_->GetImpl()->GetDriverHash() || file.ReadUInt() != sourceHash)
+        return false;
+
+    auto format = (GLenum)file.ReadUInt();
+    unsigned size = file.ReadUInt();
+    if (!size || size > file.GetSize() - file.GetPosition())
+        return false;
+
+    SharedArrayPtr<unsigned char> binary(new unsigned char[size]);
+    if (file.Read(binary.Get(), size) != size)
+        return false;
+
+    // The driver may reject the binary, for example after an update. In that case link normally
+    glProgramBinary(object_.name_, format, binary.Get(), (GLsizei)size);
+    int linked;
+    glGetProgramiv(object_.name_, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        URHO3D_LOGDEBUG("Program binary " + binaryName + " was rejected by the driver");
+        return false;
+    }
+
+    URHO3D_LOGDEBUG("Loaded program binary " + binaryName);
     return true;
+#else
+    return false;
+#endif
+}
+
+void ShaderProgram::SaveProgramBinary(const String& binaryName, unsigned sourceHash)
+{
+#ifndef GL_ES_VERSION_2_0
+    int size = 0;
+    glGetProgramiv(object_.name_, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return;
+
+    SharedArrayPtr<unsigned char> binary(new unsigned char[size]);
+    GLenum format = 0;
+    int outSize = 0;
+    glGetProgramBinary(object_.name_, (GLsizei)size, &outSize, &format, binary.Get());
+    if (outSize <= 0)
+        return;
+
+    auto* fileSystem = graphics_->GetSubsystem<FileSystem>();
+    String path = GetPath(binaryName);
+    if (!fileSystem->DirExists(path))
+        fileSystem->CreateDir(path);
+
+    File file(graphics_->GetContext(), binaryName, FILE_WRITE);
+    if (!file.IsOpen())
+    {
+        URHO3D_LOGERROR("Failed to save program binary " + binaryName);
+        return;
+    }
+
+    file.WriteFileID("UGLP");
+    file.WriteUInt(PROGRAM_BINARY_VERSION);
+    file.WriteUInt(graphics_->GetImpl()->GetDriverHash());
+    file.WriteUInt(sourceHash);
+    file.WriteUInt(format);
+    file.WriteUInt((unsigned)outSize);
+    file.Write(binary.Get(), (unsigned)outSize);
+#endif
 }
 
 ShaderVariation* ShaderProgram::GetVertexShader() const
@@ -409,6 +539,18 @@ void ShaderProgram::ClearParameterSources()
 #endif
 }
 
+void ShaderProgram::ClearViewParameterSources()
+{
+#ifndef GL_ES_VERSION_2_0
+    // Individual uniforms are remembered per program and must be set again
+    const void* frameSource = globalParameterSources[SP_FRAME];
+    ClearParameterSources();
+    globalParameterSources[SP_FRAME] = frameSource;
+#else
+    ClearParameterSources();
+#endif
+}
+
 void ShaderProgram::ClearGlobalParameterSource(ShaderParameterGroup group)
 {
     globalParameterSources[group] = (const void*)M_MAX_UNSIGNED;
@@ -76,6 +76,9 @@ public:
     /// Return all constant buffers.
     const SharedPtr<ConstantBuffer>* GetConstantBuffers() const { return &constantBuffers_[0]; }
 
+    /// Return material parameter layout hash of the vertex or pixel shader.
+    unsigned GetMaterialLayoutHash(ShaderType type) const { return materialLayoutHashes_[type]; }
+
     /// Check whether a shader parameter group needs update. Does not actually check whether parameters exist in the shaders.
     bool NeedParameterUpdate(ShaderParameterGroup group, const void* source);
     /// Clear a parameter source. Affects only the current shader program if appropriate.
@@ -83,10 +86,17 @@ public:
 
     /// Clear all parameter sources from all shader programs by incrementing the global parameter source framenumber.
     static void ClearParameterSources();
+    /// Clear all parameter sources except the global (per-frame) group in constant buffer mode.
+    static void ClearViewParameterSources();
     /// Clear a global parameter source when constant buffers change.
     static void ClearGlobalParameterSource(ShaderParameterGroup group);
 
 private:
+    /// Load the linked program from a binary in the shader cache. Return true if successful.
+    bool LoadProgramBinary(const String& binaryName, unsigned sourceHash);
+    /// Save the linked program as a binary to the shader cache.
+    void SaveProgramBinary(const String& binaryName, unsigned sourceHash);
+
     /// Vertex shader.
     WeakPtr<ShaderVariation> vertexShader_;
     /// Pixel shader.
@@ -101,6 +111,8 @@ private:
     unsigned usedVertexAttributes_{};
     /// Constant buffers by binding index.
     SharedPtr<ConstantBuffer> constantBuffers_[MAX_SHADER_PARAMETER_GROUPS * 2];
+    /// Material parameter layout hashes of the vertex and pixel shader.
+    unsigned materialLayoutHashes_[2]{};
     /// Remembered shader parameter sources for individual uniform mode.
     const void* parameterSources_[MAX_SHADER_PARAMETER_GROUPS]{};
     /// Shader link error string.
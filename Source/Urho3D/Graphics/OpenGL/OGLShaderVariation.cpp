@@ -193,6 +193,8 @@ void ShaderVariation::SetDefines(const String& defines)
 }
 
 // These methods are no-ops for OpenGL
+bool ShaderVariation::Prepare() { return true; }
+bool ShaderVariation::PrepareByteCode() { return false; }
 bool ShaderVariation::LoadByteCode(const String& binaryShaderName) { return false; }
 bool ShaderVariation::Compile() { return false; }
 void ShaderVariation::ParseParameters(unsigned char* bufData, unsigned bufSize) {}
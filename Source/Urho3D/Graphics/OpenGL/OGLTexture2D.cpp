@@ -24,6 +24,7 @@
 
 #include "../../Core/Context.h"
 #include "../../Core/Profiler.h"
+#include "../../Core/Thread.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -162,7 +163,9 @@ bool Texture2D::SetData(unsigned level, int x, int y, int width, int height, con
             glCompressedTexSubImage2D(target_, level, x, y, width, height, format, GetDataSize(width, height), data);
     }
 
-    graphics_->SetTexture(0, nullptr);
+    // Background uploads leave the rendering state to the main thread
+    if (Thread::IsMainThread())
+        graphics_->SetTexture(0, nullptr);
     return true;
 }
 
@@ -200,7 +203,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         unsigned format = 0;
 
         // Discard unnecessary mip levels
-        for (unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+        for (unsigned i = 0; i < mipsToSkip_[quality] + streamingMipsToSkip_; ++i)
         {
             mipImage = image->GetNextLevel(); image = mipImage;
             levelData = image->GetData();
@@ -266,7 +269,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             needDecompress = true;
         }
 
-        unsigned mipsToSkip = mipsToSkip_[quality];
+        unsigned mipsToSkip = mipsToSkip_[quality] + streamingMipsToSkip_;
         if (mipsToSkip >= levels)
             mipsToSkip = levels - 1;
         while (mipsToSkip && (width / (1u << mipsToSkip) < 4 || height / (1u << mipsToSkip) < 4))
@@ -277,21 +280,30 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         SetNumLevels(Max((levels - mipsToSkip), 1U));
         SetSize(width, height, format);
 
+        // Decompress all the used levels at once, so that large levels can be decompressed in the worker threads
+        SharedPtr<Image> decompressed;
+        PODVector<Image*> decompressedLevels;
+        if (needDecompress)
+        {
+            decompressed = image->GetDecompressedImage(mipsToSkip);
+            if (!decompressed)
+                return false;
+            decompressed->GetLevels(decompressedLevels);
+        }
+
         for (unsigned i = 0; i < levels_ && i < levels - mipsToSkip; ++i)
         {
-            CompressedLevel level = image->GetCompressedLevel(i + mipsToSkip);
             if (!needDecompress)
             {
+                CompressedLevel level = image->GetCompressedLevel(i + mipsToSkip);
                 SetData(i, 0, 0, level.width_, level.height_, level.data_);
                 memoryUse += level.rows_ * level.rowSize_;
             }
             else
             {
-                auto* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
-                level.Decompress(rgbaData);
-                SetData(i, 0, 0, level.width_, level.height_, rgbaData);
-                memoryUse += level.width_ * level.height_ * 4;
-                delete[] rgbaData;
+                Image* level = decompressedLevels[i];
+                SetData(i, 0, 0, level->GetWidth(), level->GetHeight(), level->GetData());
+                memoryUse += level->GetWidth() * level->GetHeight() * 4;
             }
         }
     }
@@ -486,7 +498,8 @@ bool Texture2D::Create()
 
     // Set initial parameters, then unbind the texture
     UpdateParameters();
-    graphics_->SetTexture(0, nullptr);
+    if (Thread::IsMainThread())
+        graphics_->SetTexture(0, nullptr);
 
     return success;
 }
@@ -69,6 +69,7 @@ void VertexBuffer::Release()
 
             graphics_->SetVBO(0);
             glDeleteBuffers(1, &object_.name_);
+            graphics_->CleanupVBO(object_.name_);
         }
 
         object_.name_ = 0;
@@ -147,7 +148,11 @@ bool VertexBuffer::SetDataRange(const void* data, unsigned start, unsigned count
             if (!discard || start != 0)
                 glBufferSubData(GL_ARRAY_BUFFER, start * (size_t)vertexSize_, count * vertexSize_, data);
             else
-                glBufferData(GL_ARRAY_BUFFER, count * (size_t)vertexSize_, data, dynamic_ ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+            {
+                // Orphan the whole buffer so that its size stays the same for later range updates
+                glBufferData(GL_ARRAY_BUFFER, vertexCount_ * (size_t)vertexSize_, nullptr, dynamic_ ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, count * (size_t)vertexSize_, data);
+            }
         }
         else
         {
@@ -186,6 +191,16 @@ void* VertexBuffer::Lock(unsigned start, unsigned count, bool discard)
     lockCount_ = count;
     discardLock_ = discard;
 
+#ifndef GL_ES_VERSION_2_0
+    // Map the range unsynchronized for no-overwrite locks. Because shadow data must be kept in sync, the buffer must not be shadowed
+    if (noOverwriteLock_ && object_.name_ && !shadowData_ && Graphics::GetGL3Support())
+    {
+        void* hwData = MapBuffer(start, count, discard);
+        if (hwData)
+            return hwData;
+    }
+#endif
+
     if (shadowData_)
     {
         lockState_ = LOCK_SHADOW;
@@ -205,6 +220,10 @@ void VertexBuffer::Unlock()
 {
     switch (lockState_)
     {
+    case LOCK_HARDWARE:
+        UnmapBuffer();
+        break;
+
     case LOCK_SHADOW:
         SetDataRange(shadowData_.Get() + lockStart_ * vertexSize_, lockStart_, lockCount_, discardLock_);
         lockState_ = LOCK_NONE;
@@ -264,13 +283,36 @@ bool VertexBuffer::UpdateToGPU()
 
 void* VertexBuffer::MapBuffer(unsigned start, unsigned count, bool discard)
 {
-    // Never called on OpenGL
-    return nullptr;
+    void* hwData = nullptr;
+
+#ifndef GL_ES_VERSION_2_0
+    if (object_.name_ && !graphics_->IsDeviceLost())
+    {
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        access |= discard ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT;
+
+        graphics_->SetVBO(object_.name_);
+        hwData = glMapBufferRange(GL_ARRAY_BUFFER, start * (size_t)vertexSize_, count * (size_t)vertexSize_, access);
+        if (hwData)
+            lockState_ = LOCK_HARDWARE;
+        else
+            URHO3D_LOGERROR("Failed to map vertex buffer");
+    }
+#endif
+
+    return hwData;
 }
 
 void VertexBuffer::UnmapBuffer()
 {
-    // Never called on OpenGL
+#ifndef GL_ES_VERSION_2_0
+    if (object_.name_ && lockState_ == LOCK_HARDWARE)
+    {
+        graphics_->SetVBO(object_.name_);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        lockState_ = LOCK_NONE;
+    }
+#endif
 }
 
 }
@@ -787,6 +787,56 @@ const TextureFrame* ParticleEffect::GetTextureFrame(unsigned index) const
     return index < textureFrames_.Size() ? &textureFrames_[index] : nullptr;
 }
 
+Vector3 ParticleEffect::GetRandomPosition() const
+{
+    switch (emitterType_)
+    {
+    case EMITTER_SPHERE:
+        {
+            Vector3 dir(
+                Random(2.0f) - 1.0f,
+                Random(2.0f) - 1.0f,
+                Random(2.0f) - 1.0f
+            );
+            dir.Normalize();
+            return emitterSize_ * dir * 0.5f;
+        }
+
+    case EMITTER_BOX:
+        return Vector3(
+            Random(emitterSize_.x_) - emitterSize_.x_ * 0.5f,
+            Random(emitterSize_.y_) - emitterSize_.y_ * 0.5f,
+            Random(emitterSize_.z_) - emitterSize_.z_ * 0.5f
+        );
+
+    case EMITTER_SPHEREVOLUME:
+        {
+            Vector3 dir(
+                Random(2.0f) - 1.0f,
+                Random(2.0f) - 1.0f,
+                Random(2.0f) - 1.0f
+            );
+            dir.Normalize();
+            return emitterSize_ * dir * Pow(Random(), 1.0f / 3.0f) * 0.5f;
+        }
+
+    case EMITTER_CYLINDER:
+        {
+            float angle = Random(360.0f);
+            float radius = Sqrt(Random()) * 0.5f;
+            return Vector3(Cos(angle) * radius, Random() - 0.5f, Sin(angle) * radius) * emitterSize_;
+        }
+
+    case EMITTER_RING:
+        {
+            float angle = Random(360.0f);
+            return Vector3(Cos(angle), Random(2.0f) - 1.0f, Sin(angle)) * emitterSize_ * 0.5f;
+        }
+    }
+
+    return Vector3::ZERO;
+}
+
 Vector3 ParticleEffect::GetRandomDirection() const
 {
     return Vector3(Lerp(directionMin_.x_, directionMax_.x_, Random(1.0f)), Lerp(directionMin_.y_, directionMax_.y_, Random(1.0f)),
@@ -332,6 +332,8 @@ public:
     /// Return how the particles rotate in relation to the camera.
     FaceCameraMode GetFaceCameraMode() const { return faceCameraMode_; }
 
+    /// Return random start position within the emitter shape.
+    Vector3 GetRandomPosition() const;
     /// Return random direction.
     Vector3 GetRandomDirection() const;
     /// Return random size.
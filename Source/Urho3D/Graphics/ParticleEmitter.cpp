@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/DrawableEvents.h"
+#include "../Graphics/Graphics.h"
 #include "../Graphics/ParticleEffect.h"
 #include "../Graphics/ParticleEmitter.h"
 #include "../Resource/ResourceCache.h"
@@ -138,6 +139,14 @@ void ParticleEmitter::Update(const FrameInfo& frame)
             periodTimer_ = 0.0f;
     }
 
+    // In headless mode the particles would never be drawn, so only simulate the emission periods. This keeps the
+    // finished event and autoremove working, though they happen as soon as emission stops
+    if (!GetSubsystem<Graphics>())
+    {
+        needUpdate_ = false;
+        return;
+    }
+
     // Check for emitting new particles
     if (emitting_)
     {
@@ -454,64 +463,10 @@ bool ParticleEmitter::EmitNewParticle()
     Particle& particle = particles_[index];
     Billboard& billboard = billboards_[index];
 
-    Vector3 startDir;
-    Vector3 startPos;
-
-    startDir = effect_->GetRandomDirection();
+    Vector3 startDir = effect_->GetRandomDirection();
     startDir.Normalize();
 
-    switch (effect_->GetEmitterType())
-    {
-    case EMITTER_SPHERE:
-        {
-            Vector3 dir(
-                Random(2.0f) - 1.0f,
-                Random(2.0f) - 1.0f,
-                Random(2.0f) - 1.0f
-            );
-            dir.Normalize();
-            startPos = effect_->GetEmitterSize() * dir * 0.5f;
-        }
-        break;
-
-    case EMITTER_BOX:
-        {
-            const Vector3& emitterSize = effect_->GetEmitterSize();
-            startPos = Vector3(
-                Random(emitterSize.x_) - emitterSize.x_ * 0.5f,
-                Random(emitterSize.y_) - emitterSize.y_ * 0.5f,
-                Random(emitterSize.z_) - emitterSize.z_ * 0.5f
-            );
-        }
-        break;
-
-    case EMITTER_SPHEREVOLUME:
-        {
-            Vector3 dir(
-                Random(2.0f) - 1.0f,
-                Random(2.0f) - 1.0f,
-                Random(2.0f) - 1.0f
-            );
-            dir.Normalize();
-            startPos = effect_->GetEmitterSize() * dir * Pow(Random(), 1.0f / 3.0f) * 0.5f;
-        }
-        break;
-
-    case EMITTER_CYLINDER:
-        {
-            float angle = Random(360.0f);
-            float radius = Sqrt(Random()) * 0.5f;
-            startPos = Vector3(Cos(angle) * radius, Random() - 0.5f, Sin(angle) * radius) * effect_->GetEmitterSize();
-        }
-        break;
-
-    case EMITTER_RING:
-        {
-            float angle = Random(360.0f);
-            startPos = Vector3(Cos(angle), Random(2.0f) - 1.0f, Sin(angle)) * effect_->GetEmitterSize() * 0.5f;
-        }
-        break;
-    }
+    Vector3 startPos = effect_->GetRandomPosition();
 
     particle.size_ = effect_->GetRandomSize();
     particle.timer_ = 0.0f;
@@ -54,6 +54,7 @@ struct Particle
 class URHO3D_API ParticleEmitter : public BillboardSet
 {
     URHO3D_OBJECT(ParticleEmitter, BillboardSet);
+    URHO3D_POOLED_OBJECT(ParticleEmitter);
 
 public:
     /// Construct.
@@ -47,6 +47,7 @@ static const char* commandTypeNames[] =
     "lightvolumes",
     "renderui",
     "sendevent",
+    "tiledlights",
     nullptr
 };
 
@@ -162,6 +163,7 @@ void RenderPathCommand::Load(const XMLElement& element)
         break;
 
     case CMD_LIGHTVOLUMES:
+    case CMD_TILEDLIGHTS:
     case CMD_QUAD:
         vertexShaderName_ = element.GetAttribute("vs");
         pixelShaderName_ = element.GetAttribute("ps");
@@ -306,6 +308,19 @@ CubeMapFace RenderPathCommand::GetOutputFace(unsigned index) const
     return index < outputs_.Size() ? outputs_[index].second_ : FACE_POSITIVE_X;
 }
 
+String RenderPathCommand::GetDisplayName() const
+{
+    if (!tag_.Empty())
+        return tag_;
+
+    String name(commandTypeNames[type_]);
+    if (type_ == CMD_QUAD && !pixelShaderName_.Empty())
+        name += " " + pixelShaderName_;
+    else if (!pass_.Empty())
+        name += " " + pass_;
+    return name;
+}
+
 RenderPath::RenderPath() = default;
 
 RenderPath::~RenderPath() = default;
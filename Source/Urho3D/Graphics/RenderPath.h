@@ -44,7 +44,8 @@ enum RenderCommandType
     CMD_FORWARDLIGHTS,
     CMD_LIGHTVOLUMES,
     CMD_RENDERUI,
-    CMD_SENDEVENT
+    CMD_SENDEVENT,
+    CMD_TILEDLIGHTS
 };
 
 /// Rendering path sorting modes.
@@ -131,6 +132,8 @@ struct URHO3D_API RenderPathCommand
 
     /// Return depth-stencil output name.
     const String& GetDepthStencilName() const { return depthStencilName_; }
+    /// Return a name for profiling: the tag if set, otherwise the command type with the pass or pixel shader name.
+    String GetDisplayName() const;
 
     /// Tag name.
     String tag_;
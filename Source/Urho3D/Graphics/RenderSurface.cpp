@@ -57,6 +57,16 @@ void RenderSurface::SetUpdateMode(RenderSurfaceUpdateMode mode)
     updateMode_ = mode;
 }
 
+void RenderSurface::SetUpdateInterval(unsigned frames)
+{
+    updateInterval_ = frames;
+}
+
+void RenderSurface::SetUpdateDistance(float distance)
+{
+    updateDistance_ = Max(distance, 0.0f);
+}
+
 void RenderSurface::SetLinkedRenderTarget(RenderSurface* renderTarget)
 {
     if (renderTarget != this)
@@ -74,11 +84,41 @@ void RenderSurface::QueueUpdate()
     updateQueued_ = true;
 }
 
+void RenderSurface::QueueVisibleUpdate(float distance)
+{
+    visibleDistance_ = Min(visibleDistance_, distance);
+}
+
 void RenderSurface::ResetUpdateQueued()
 {
     updateQueued_ = false;
 }
 
+bool RenderSurface::IsUpdateDue(unsigned frameNumber) const
+{
+    // Manually queued updates are not throttled
+    if (updateQueued_)
+        return true;
+
+    bool visible = visibleDistance_ < M_INFINITY;
+    if (updateMode_ == SURFACE_MANUALUPDATE || (updateMode_ == SURFACE_UPDATEVISIBLE && !visible))
+        return false;
+    if (lastUpdateFrame_ == M_MAX_UNSIGNED)
+        return true;
+
+    unsigned interval = Max(updateInterval_, 1U);
+    if (updateDistance_ > 0.0f && visible)
+        interval *= 1 + (unsigned)Min(visibleDistance_ / updateDistance_, 255.0f);
+
+    return frameNumber - lastUpdateFrame_ >= interval;
+}
+
+void RenderSurface::MarkUpdated(unsigned frameNumber)
+{
+    lastUpdateFrame_ = frameNumber;
+    updateQueued_ = false;
+}
+
 int RenderSurface::GetWidth() const
 {
     return parentTexture_->GetWidth();
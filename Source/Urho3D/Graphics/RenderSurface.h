@@ -49,12 +49,18 @@ public:
     void SetViewport(unsigned index, Viewport* viewport);
     /// Set viewport update mode. Default is to update when visible.
     void SetUpdateMode(RenderSurfaceUpdateMode mode);
+    /// Set minimum number of frames between automatic viewport updates. 0 or 1 (default) updates on every frame.
+    void SetUpdateInterval(unsigned frames);
+    /// Set camera distance step for throttling automatic updates. The update interval is multiplied by one more for each whole step of distance to the nearest visible user of the surface. 0 (default) disables.
+    void SetUpdateDistance(float distance);
     /// Set linked color rendertarget.
     void SetLinkedRenderTarget(RenderSurface* renderTarget);
     /// Set linked depth-stencil surface.
     void SetLinkedDepthStencil(RenderSurface* depthStencil);
     /// Queue manual update of the viewport(s).
     void QueueUpdate();
+    /// Queue automatic update from a view that sees the surface used at the given camera distance. Called internally.
+    void QueueVisibleUpdate(float distance);
     /// Release surface.
     void Release();
     /// Mark the GPU resource destroyed on graphics context destruction. Only used on OpenGL.
@@ -86,6 +92,15 @@ public:
     /// Return viewport update mode.
     RenderSurfaceUpdateMode GetUpdateMode() const { return updateMode_; }
 
+    /// Return minimum number of frames between automatic viewport updates.
+    unsigned GetUpdateInterval() const { return updateInterval_; }
+
+    /// Return camera distance step for throttling automatic updates.
+    float GetUpdateDistance() const { return updateDistance_; }
+
+    /// Return frame number of the last viewport update, or M_MAX_UNSIGNED if never updated.
+    unsigned GetLastUpdateFrame() const { return lastUpdateFrame_; }
+
     /// Return linked color rendertarget.
     RenderSurface* GetLinkedRenderTarget() const { return linkedRenderTarget_; }
 
@@ -98,6 +113,15 @@ public:
     /// Reset update queued flag. Called internally.
     void ResetUpdateQueued();
 
+    /// Reset the automatic update request from views for the next frame. Called internally.
+    void ResetVisibleUpdate() { visibleDistance_ = M_INFINITY; }
+
+    /// Return whether the viewport(s) should be updated on the given frame according to the update mode, interval and distance. Called internally.
+    bool IsUpdateDue(unsigned frameNumber) const;
+
+    /// Mark the viewport(s) updated on the given frame and reset the update queued flag. Called internally.
+    void MarkUpdated(unsigned frameNumber);
+
     /// Return parent texture.
     Texture* GetParentTexture() const { return parentTexture_; }
 
@@ -152,6 +176,14 @@ private:
     WeakPtr<RenderSurface> linkedDepthStencil_;
     /// Update mode for viewports.
     RenderSurfaceUpdateMode updateMode_{SURFACE_UPDATEVISIBLE};
+    /// Minimum number of frames between automatic updates.
+    unsigned updateInterval_{};
+    /// Camera distance step for throttling automatic updates.
+    float updateDistance_{};
+    /// Nearest camera distance at which the surface was seen on this frame.
+    float visibleDistance_{M_INFINITY};
+    /// Frame number of the last update.
+    unsigned lastUpdateFrame_{M_MAX_UNSIGNED};
     /// Update queued flag.
     bool updateQueued_{};
     /// Multisampled resolve dirty flag.
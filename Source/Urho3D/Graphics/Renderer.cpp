@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/Camera.h"
@@ -40,6 +41,7 @@
 #include "../Graphics/Technique.h"
 #include "../Graphics/Texture2D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../Graphics/Zone.h"
@@ -254,6 +256,21 @@ static const unsigned MAX_BUFFER_AGE = 1000;
 
 static const int MAX_EXTRA_INSTANCING_BUFFER_ELEMENTS = 4;
 
+/// Dynamic resolution scale step. The scale is quantized so that the screen buffers are not reallocated every frame.
+static const float RESOLUTION_SCALE_STEP = 0.05f;
+/// Fraction of the distance to the scale that meets the target time covered each frame. The measurements lag a few frames behind, so converge gradually.
+static const float RESOLUTION_SCALE_RATE = 0.1f;
+/// Lowest allowed dynamic resolution scale.
+static const float MIN_RESOLUTION_SCALE = 0.25f;
+
+static bool CompareRenderSurfaceUpdates(RenderSurface* lhs, RenderSurface* rhs)
+{
+    // Manually queued updates first, then the surfaces updated longest ago. Adding one wraps the never updated surfaces' frame number to zero
+    if (lhs->IsUpdateQueued() != rhs->IsUpdateQueued())
+        return lhs->IsUpdateQueued();
+    return lhs->GetLastUpdateFrame() + 1 < rhs->GetLastUpdateFrame() + 1;
+}
+
 inline PODVector<VertexElement> CreateInstancingBufferElements(unsigned numExtraElements)
 {
     static const unsigned NUM_INSTANCEMATRIX_ELEMENTS = 3;
@@ -456,6 +473,29 @@ void Renderer::SetMaxShadowMaps(int shadowMaps)
     }
 }
 
+void Renderer::SetShadowAtlas(bool enable)
+{
+    if (!graphics_)
+        return;
+
+    shadowAtlas_ = enable;
+    if (!shadowAtlas_)
+        shadowAtlasTexture_.Reset();
+}
+
+void Renderer::SetShadowAtlasSize(int size)
+{
+    if (!graphics_)
+        return;
+
+    size = NextPowerOfTwo((unsigned)Max(size, SHADOW_MIN_PIXELS));
+    if (size != shadowAtlasSize_)
+    {
+        shadowAtlasSize_ = size;
+        shadowAtlasTexture_.Reset();
+    }
+}
+
 void Renderer::SetDynamicInstancing(bool enable)
 {
     if (!instancingBuffer_)
@@ -488,6 +528,11 @@ void Renderer::SetMaxOccluderTriangles(int triangles)
     maxOccluderTriangles_ = Max(triangles, 0);
 }
 
+void Renderer::SetMaxRenderSurfaceUpdates(int surfaces)
+{
+    maxRenderSurfaceUpdates_ = Max(surfaces, 0);
+}
+
 void Renderer::SetOcclusionBufferSize(int size)
 {
     occlusionBufferSize_ = Max(size, 1);
@@ -509,6 +554,67 @@ void Renderer::SetMobileNormalOffsetMul(float mul)
     mobileNormalOffsetMul_ = mul;
 }
 
+void Renderer::SetTextureStreaming(bool enable)
+{
+    if (enable == textureStreamer_.NotNull())
+        return;
+
+    // Textures already streamed keep their current mip levels when streaming is disabled, until reloaded
+    if (enable)
+        textureStreamer_ = new TextureStreamer(context_);
+    else
+        textureStreamer_.Reset();
+}
+
+void Renderer::SetTextureCompression(bool enable)
+{
+    // Only affects textures loaded from now on
+    textureCompression_ = enable;
+}
+
+void Renderer::SetTextureCompressionCacheDir(const String& path)
+{
+    textureCompressionCacheDir_ = path;
+}
+
+void Renderer::SetClusteredLighting(bool enable)
+{
+    clusteredLighting_ = enable;
+}
+
+void Renderer::SetDynamicResolution(bool enable)
+{
+    dynamicResolution_ = enable;
+    targetResolutionScale_ = resolutionScale_ = enable ? maxResolutionScale_ : 1.0f;
+
+    // The scale is driven by the measured GPU frame time
+    auto* graphics = GetSubsystem<Graphics>();
+    if (enable && graphics)
+        graphics->SetGPUTiming(true);
+}
+
+void Renderer::SetDynamicResolutionTargetTime(float msec)
+{
+    dynamicResolutionTargetTime_ = Max(msec, M_EPSILON);
+}
+
+void Renderer::SetMinResolutionScale(float scale)
+{
+    minResolutionScale_ = Clamp(scale, MIN_RESOLUTION_SCALE, 1.0f);
+    maxResolutionScale_ = Max(maxResolutionScale_, minResolutionScale_);
+}
+
+void Renderer::SetMaxResolutionScale(float scale)
+{
+    maxResolutionScale_ = Clamp(scale, MIN_RESOLUTION_SCALE, 1.0f);
+    minResolutionScale_ = Min(minResolutionScale_, maxResolutionScale_);
+}
+
+void Renderer::SetRenderTargetAliasing(bool enable)
+{
+    renderTargetAliasing_ = enable;
+}
+
 void Renderer::SetOccluderSizeThreshold(float screenSize)
 {
     occluderSizeThreshold_ = Max(screenSize, 0.0f);
@@ -523,6 +629,20 @@ void Renderer::SetThreadedOcclusion(bool enable)
     }
 }
 
+void Renderer::SetOcclusionReprojection(bool enable)
+{
+    if (enable != occlusionReprojection_)
+    {
+        occlusionReprojection_ = enable;
+        occlusionDepthHistories_.Clear();
+    }
+}
+
+void Renderer::SetShareSceneQueries(bool enable)
+{
+    shareSceneQueries_ = enable;
+}
+
 void Renderer::ReloadShaders()
 {
     shadersDirty_ = true;
@@ -588,6 +708,17 @@ unsigned Renderer::GetNumGeometries(bool allViews) const
     return numGeometries;
 }
 
+unsigned long long Renderer::GetRenderTargetMemory() const
+{
+    unsigned long long memory = 0;
+    for (unsigned i = 0; i < views_.Size(); ++i)
+    {
+        if (views_[i])
+            memory = Max(memory, views_[i]->GetRenderTargetMemory());
+    }
+    return memory;
+}
+
 unsigned Renderer::GetNumLights(bool allViews) const
 {
     unsigned numLights = 0;
@@ -647,6 +778,7 @@ unsigned Renderer::GetNumOccluders(bool allViews) const
 void Renderer::Update(float timeStep)
 {
     URHO3D_PROFILE(UpdateViews);
+    AllocationTagScope allocationTag(ALLOCTAG_RENDER);
 
     views_.Clear();
     preparedViews_.Clear();
@@ -663,11 +795,18 @@ void Renderer::Update(float timeStep)
     numShadowCameras_ = 0;
     numOcclusionBuffers_ = 0;
     updatedOctrees_.Clear();
+    numSharedSceneQueries_ = 0;
 
     // Reload shaders now if needed
     if (shadersDirty_)
         LoadShaders();
 
+    // Apply finished texture streaming loads and begin new ones based on the previous frame's requests
+    if (textureStreamer_)
+        textureStreamer_->Update(timeStep);
+
+    UpdateResolutionScale();
+
     // Queue update of the main viewports. Use reverse order, as rendering order is also reverse
     // to render auxiliary views before dependent main views
     for (unsigned i = viewports_.Size() - 1; i < viewports_.Size(); --i)
@@ -675,15 +814,35 @@ void Renderer::Update(float timeStep)
 
     // Update main viewports. This may queue further views
     unsigned numMainViewports = queuedViewports_.Size();
+    PrepareSharedSceneQueries(0, numMainViewports);
     for (unsigned i = 0; i < numMainViewports; ++i)
         UpdateQueuedViewport(i);
 
     // Gather queued & autoupdated render surfaces
     SendEvent(E_RENDERSURFACEUPDATE);
 
-    // Update viewports that were added as result of the event above
-    for (unsigned i = numMainViewports; i < queuedViewports_.Size(); ++i)
-        UpdateQueuedViewport(i);
+    // If more surfaces are due than the budget allows, update the most stale ones
+    if (pendingRenderSurfaces_.Size())
+    {
+        if (pendingRenderSurfaces_.Size() > (unsigned)maxRenderSurfaceUpdates_)
+            Sort(pendingRenderSurfaces_.Begin(), pendingRenderSurfaces_.End(), CompareRenderSurfaceUpdates);
+        for (unsigned i = 0; i < pendingRenderSurfaces_.Size() && i < (unsigned)maxRenderSurfaceUpdates_; ++i)
+        {
+            QueueRenderSurface(pendingRenderSurfaces_[i]);
+            pendingRenderSurfaces_[i]->MarkUpdated(frame_.frameNumber_);
+        }
+        pendingRenderSurfaces_.Clear();
+    }
+
+    // Update viewports that were added as result of the event above, and the views they queue in turn
+    for (unsigned start = numMainViewports; start < queuedViewports_.Size();)
+    {
+        unsigned end = queuedViewports_.Size();
+        PrepareSharedSceneQueries(start, end);
+        for (unsigned i = start; i < end; ++i)
+            UpdateQueuedViewport(i);
+        start = end;
+    }
 
     queuedViewports_.Clear();
     resetViews_ = false;
@@ -695,6 +854,7 @@ void Renderer::Render()
     assert(graphics_ && graphics_->IsInitialized() && !graphics_->IsDeviceLost());
 
     URHO3D_PROFILE(RenderViews);
+    AllocationTagScope allocationTag(ALLOCTAG_RENDER);
 
     // If the indirection textures have lost content (OpenGL mode only), restore them now
     if (faceSelectCubeMap_ && faceSelectCubeMap_->IsDataLost())
@@ -724,6 +884,9 @@ void Renderer::Render()
         graphics_->Clear(CLEAR_COLOR | CLEAR_DEPTH | CLEAR_STENCIL, defaultZone_->GetFogColor());
     }
 
+    // The global shader parameters are shared by the views of a scene during the frame, so forget them now
+    graphics_->ClearParameterSources();
+
     // Render views from last to first. Each main (backbuffer) view is rendered after the auxiliary views it depends on
     for (unsigned i = views_.Size() - 1; i < views_.Size(); --i)
     {
@@ -746,6 +909,21 @@ void Renderer::Render()
     SendEvent(E_ENDALLVIEWSRENDER);
 }
 
+void Renderer::SnapshotViews()
+{
+    if (!graphics_ || !graphics_->IsInitialized() || graphics_->IsDeviceLost())
+        return;
+
+    URHO3D_PROFILE(SnapshotViews);
+
+    // Use the same order as rendering, so that the geometries are updated in the same order
+    for (unsigned i = views_.Size() - 1; i < views_.Size(); --i)
+    {
+        if (views_[i])
+            views_[i]->SnapshotTransforms();
+    }
+}
+
 void Renderer::DrawDebugGeometry(bool depthTest)
 {
     URHO3D_PROFILE(RendererDrawDebug);
@@ -800,6 +978,25 @@ void Renderer::QueueRenderSurface(RenderSurface* renderTarget)
     }
 }
 
+void Renderer::QueueRenderSurfaceUpdate(RenderSurface* renderTarget)
+{
+    if (!renderTarget)
+        return;
+
+    if (renderTarget->IsUpdateDue(frame_.frameNumber_))
+    {
+        if (maxRenderSurfaceUpdates_)
+            pendingRenderSurfaces_.Push(renderTarget);
+        else
+        {
+            QueueRenderSurface(renderTarget);
+            renderTarget->MarkUpdated(frame_.frameNumber_);
+        }
+    }
+
+    renderTarget->ResetVisibleUpdate();
+}
+
 void Renderer::QueueViewport(RenderSurface* renderTarget, Viewport* viewport)
 {
     if (viewport)
@@ -835,59 +1032,9 @@ Geometry* Renderer::GetQuadGeometry()
 
 Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight)
 {
-    LightType type = light->GetLightType();
-    const FocusParameters& parameters = light->GetShadowFocus();
-    float size = (float)shadowMapSize_ * light->GetShadowResolution();
-    // Automatically reduce shadow map size when far away
-    if (parameters.autoSize_ && type != LIGHT_DIRECTIONAL)
-    {
-        const Matrix3x4& view = camera->GetView();
-        const Matrix4& projection = camera->GetProjection();
-        BoundingBox lightBox;
-        float lightPixels;
-
-        if (type == LIGHT_POINT)
-        {
-            // Calculate point light pixel size from the projection of its diagonal
-            Vector3 center = view * light->GetNode()->GetWorldPosition();
-            float extent = 0.58f * light->GetRange();
-            lightBox.Define(center + Vector3(extent, extent, extent), center - Vector3(extent, extent, extent));
-        }
-        else
-        {
-            // Calculate spot light pixel size from the projection of its frustum far vertices
-            Frustum lightFrustum = light->GetViewSpaceFrustum(view);
-            lightBox.Define(&lightFrustum.vertices_[4], 4);
-        }
-
-        Vector2 projectionSize = lightBox.Projected(projection).Size();
-        lightPixels = Max(0.5f * (float)viewWidth * projectionSize.x_, 0.5f * (float)viewHeight * projectionSize.y_);
-
-        // Clamp pixel amount to a sufficient minimum to avoid self-shadowing artifacts due to loss of precision
-        if (lightPixels < SHADOW_MIN_PIXELS)
-            lightPixels = SHADOW_MIN_PIXELS;
-
-        size = Min(size, lightPixels);
-    }
-
-    /// \todo Allow to specify maximum shadow maps per resolution, as smaller shadow maps take less memory
-    int width = NextPowerOfTwo((unsigned)size);
-    int height = width;
-
-    // Adjust the size for directional or point light shadow map atlases
-    if (type == LIGHT_DIRECTIONAL)
-    {
-        auto numSplits = (unsigned)light->GetNumShadowSplits();
-        if (numSplits > 1)
-            width *= 2;
-        if (numSplits > 2)
-            height *= 2;
-    }
-    else if (type == LIGHT_POINT)
-    {
-        width *= 2;
-        height *= 3;
-    }
+    IntVector2 size = CalculateShadowMapSize(light, camera, viewWidth, viewHeight);
+    int width = size.x_;
+    int height = size.y_;
 
     int searchKey = width << 16u | height;
     if (shadowMaps_.Contains(searchKey))
@@ -909,11 +1056,60 @@ Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, unsigned viewWid
         }
     }
 
-    // Find format and usage of the shadow map
-    unsigned shadowMapFormat = 0;
-    TextureUsage shadowMapUsage = TEXTURE_DEPTHSTENCIL;
-    int multiSample = 1;
+    // If failed to create, store a null pointer so that we will not retry
+    SharedPtr<Texture2D> newShadowMap = CreateShadowMap(width, height);
+    shadowMaps_[searchKey].Push(newShadowMap);
+    if (!reuseShadowMaps_)
+        shadowMapAllocations_[searchKey].Push(light);
+
+    return newShadowMap;
+}
+
+Texture2D* Renderer::GetShadowAtlasTile(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight, IntRect& tile)
+{
+    // Point light shadow sampling assumes the unwrapped cube covers the whole texture, and the VSM blur would bleed
+    // between tiles, so those use separate shadow maps
+    if (!shadowAtlas_ || light->GetLightType() == LIGHT_POINT || shadowQuality_ == SHADOWQUALITY_VSM ||
+        shadowQuality_ == SHADOWQUALITY_BLUR_VSM)
+        return nullptr;
+
+    if (!shadowAtlasTexture_)
+    {
+        shadowAtlasTexture_ = CreateShadowMap(shadowAtlasSize_, shadowAtlasSize_);
+        if (!shadowAtlasTexture_)
+        {
+            URHO3D_LOGERROR("Failed to create shadow atlas, falling back to separate shadow maps");
+            shadowAtlas_ = false;
+            return nullptr;
+        }
+        shadowAtlasAllocator_.Reset(shadowAtlasTexture_->GetWidth(), shadowAtlasTexture_->GetHeight(), 0, 0, false);
+    }
+
+    // The tile size already accounts for the light's screen size. If the atlas is full, try smaller tiles before
+    // falling back to a separate shadow map
+    IntVector2 size = CalculateShadowMapSize(light, camera, viewWidth, viewHeight);
+    while (Min(size.x_, size.y_) >= SHADOW_MIN_PIXELS)
+    {
+        int x, y;
+        if (shadowAtlasAllocator_.Allocate(size.x_, size.y_, x, y))
+        {
+            tile = IntRect(x, y, x + size.x_, y + size.y_);
+            return shadowAtlasTexture_;
+        }
 
+        size.x_ >>= 1;
+        size.y_ >>= 1;
+    }
+
+    return nullptr;
+}
+
+ShadowMapCache* Renderer::GetShadowMapCache(Light* light)
+{
+#if defined(URHO3D_D3D11) || defined(URHO3D_NULL_GRAPHICS) || (defined(URHO3D_OPENGL) && !defined(GL_ES_VERSION_2_0))
+    // The static shadow map is copied to the shadow map by sampling it as a depth texture, so only depth shadow maps
+    // can be cached
+    unsigned shadowMapFormat = 0;
     switch (shadowQuality_)
     {
     case SHADOWQUALITY_SIMPLE_16BIT:
@@ -926,71 +1122,91 @@ Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, unsigned viewWid
         shadowMapFormat = graphics_->GetHiresShadowMapFormat();
         break;
 
-    case SHADOWQUALITY_VSM:
-    case SHADOWQUALITY_BLUR_VSM:
-        shadowMapFormat = graphics_->GetRGFloat32Format();
-        shadowMapUsage = TEXTURE_RENDERTARGET;
-        multiSample = vsmMultiSample_;
+    default:
         break;
     }
 
     if (!shadowMapFormat)
         return nullptr;
 
-    SharedPtr<Texture2D> newShadowMap(new Texture2D(context_));
-    int retries = 3;
-    unsigned dummyColorFormat = graphics_->GetDummyColorFormat();
+    // Cached shadow maps are not reduced in size by the light's onscreen size, as that would invalidate them
+    int width = NextPowerOfTwo((unsigned)((float)shadowMapSize_ * light->GetShadowResolution()));
+    int height = width;
+    LightType type = light->GetLightType();
+    if (type == LIGHT_DIRECTIONAL)
+    {
+        auto numSplits = (unsigned)light->GetNumShadowSplits();
+        if (numSplits > 1)
+            width *= 2;
+        if (numSplits > 2)
+            height *= 2;
+    }
+    else if (type == LIGHT_POINT)
+    {
+        width *= 2;
+        height *= 3;
+    }
 
-    // Disable mipmaps from the shadow map
-    newShadowMap->SetNumLevels(1);
+    SharedPtr<ShadowMapCache>& cache = shadowMapCaches_[light];
+    // If the light was destroyed and another was created to the same address, start over
+    if (!cache || cache->light_ != light)
+    {
+        cache = new ShadowMapCache();
+        cache->light_ = light;
+    }
+    cache->useTimer_.Reset();
 
-    while (retries)
+    if (!cache->shadowMap_ || cache->shadowMap_->GetWidth() != width || cache->shadowMap_->GetHeight() != height ||
+        cache->shadowMap_->GetFormat() != shadowMapFormat)
     {
-        if (!newShadowMap->SetSize(width, height, shadowMapFormat, shadowMapUsage, multiSample))
+        int searchKey = width << 16u | height;
+        unsigned dummyColorFormat = graphics_->GetDummyColorFormat();
+        if (dummyColorFormat && !colorShadowMaps_.Contains(searchKey))
         {
-            width >>= 1;
-            height >>= 1;
-            --retries;
+            colorShadowMaps_[searchKey] = new Texture2D(context_);
+            colorShadowMaps_[searchKey]->SetNumLevels(1);
+            colorShadowMaps_[searchKey]->SetSize(width, height, dummyColorFormat, TEXTURE_RENDERTARGET);
         }
-        else
+
+        for (unsigned i = 0; i < 2; ++i)
         {
-#ifndef GL_ES_VERSION_2_0
-            // OpenGL (desktop) and D3D11: shadow compare mode needs to be specifically enabled for the shadow map
-            newShadowMap->SetFilterMode(FILTER_BILINEAR);
-            newShadowMap->SetShadowCompare(shadowMapUsage == TEXTURE_DEPTHSTENCIL);
-#endif
-#ifndef URHO3D_OPENGL
-            // Direct3D9: when shadow compare must be done manually, use nearest filtering so that the filtering of point lights
-            // and other shadowed lights matches
-            newShadowMap->SetFilterMode(graphics_->GetHardwareShadowSupport() ? FILTER_BILINEAR : FILTER_NEAREST);
-#endif
-            // Create dummy color texture for the shadow map if necessary: Direct3D9, or OpenGL when working around an OS X +
-            // Intel driver bug
-            if (shadowMapUsage == TEXTURE_DEPTHSTENCIL && dummyColorFormat)
+            SharedPtr<Texture2D> newShadowMap(new Texture2D(context_));
+            newShadowMap->SetNumLevels(1);
+            if (!newShadowMap->SetSize(width, height, shadowMapFormat, TEXTURE_DEPTHSTENCIL))
             {
-                // If no dummy color rendertarget for this size exists yet, create one now
-                if (!colorShadowMaps_.Contains(searchKey))
-                {
-                    colorShadowMaps_[searchKey] = new Texture2D(context_);
-                    colorShadowMaps_[searchKey]->SetNumLevels(1);
-                    colorShadowMaps_[searchKey]->SetSize(width, height, dummyColorFormat, TEXTURE_RENDERTARGET);
-                }
-                // Link the color rendertarget to the shadow map
-                newShadowMap->GetRenderSurface()->SetLinkedRenderTarget(colorShadowMaps_[searchKey]->GetRenderSurface());
+                shadowMapCaches_.Erase(light);
+                return nullptr;
             }
-            break;
+
+            // The static shadow map is sampled as plain depth values when copying
+            newShadowMap->SetFilterMode(i ? FILTER_BILINEAR : FILTER_NEAREST);
+            newShadowMap->SetShadowCompare(i != 0);
+            if (dummyColorFormat)
+                newShadowMap->GetRenderSurface()->SetLinkedRenderTarget(colorShadowMaps_[searchKey]->GetRenderSurface());
+
+            if (i)
+                cache->shadowMap_ = newShadowMap;
+            else
+                cache->staticShadowMap_ = newShadowMap;
         }
-    }
 
-    // If failed to set size, store a null pointer so that we will not retry
-    if (!retries)
-        newShadowMap.Reset();
+        cache->staticValid_ = false;
+        cache->valid_ = false;
+    }
 
-    shadowMaps_[searchKey].Push(newShadowMap);
-    if (!reuseShadowMaps_)
-        shadowMapAllocations_[searchKey].Push(light);
+    // Rendered contents are lost if the graphics context was lost
+    if (cache->shadowMap_->IsDataLost() || cache->staticShadowMap_->IsDataLost())
+    {
+        cache->shadowMap_->ClearDataLost();
+        cache->staticShadowMap_->ClearDataLost();
+        cache->staticValid_ = false;
+        cache->valid_ = false;
+    }
 
-    return newShadowMap;
+    return cache;
+#else
+    return nullptr;
+#endif
 }
 
 Texture* Renderer::GetScreenBuffer(int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb,
@@ -1120,6 +1336,45 @@ OcclusionBuffer* Renderer::GetOcclusionBuffer(Camera* camera)
     return buffer;
 }
 
+OcclusionDepthHistory* Renderer::GetOcclusionDepthHistory(Camera* camera, bool create, int width, int height)
+{
+    HashMap<Camera*, SharedPtr<OcclusionDepthHistory> >::Iterator i = occlusionDepthHistories_.Find(camera);
+    OcclusionDepthHistory* history = i != occlusionDepthHistories_.End() ? i->second_.Get() : nullptr;
+    // If the camera was destroyed and another was created to the same address, start over
+    if (history && history->camera_ != camera)
+    {
+        occlusionDepthHistories_.Erase(i);
+        history = nullptr;
+    }
+
+    if (!create)
+        return history;
+
+    unsigned format = Graphics::GetFloat32Format();
+    if (!format || width <= 0 || height <= 0)
+        return nullptr;
+
+    if (!history || history->textures_[0]->GetWidth() != width || history->textures_[0]->GetHeight() != height)
+    {
+        SharedPtr<OcclusionDepthHistory> newHistory(new OcclusionDepthHistory());
+        newHistory->camera_ = camera;
+        for (auto& texture : newHistory->textures_)
+        {
+            texture = new Texture2D(context_);
+            texture->SetNumLevels(1);
+            texture->SetFilterMode(FILTER_NEAREST);
+            if (!texture->SetSize(width, height, format, TEXTURE_RENDERTARGET))
+                return nullptr;
+        }
+
+        occlusionDepthHistories_[camera] = newHistory;
+        history = newHistory;
+    }
+
+    history->useTimer_.Reset();
+    return history;
+}
+
 Camera* Renderer::GetShadowCamera()
 {
     MutexLock lock(rendererMutex_);
@@ -1366,9 +1621,34 @@ bool Renderer::ResizeInstancingBuffer(unsigned numInstances)
     }
 
     URHO3D_LOGDEBUG("Resized instancing buffer to " + String(newSize));
+    instancingBufferOffset_ = 0;
     return true;
 }
 
+void* Renderer::LockInstancingBuffer(unsigned numInstances, unsigned& startIndex)
+{
+    if (!numInstances || !ResizeInstancingBuffer(numInstances))
+        return nullptr;
+
+    // Append after the instances of the previous views without waiting for the GPU, so that the driver does not need to rename
+    // the buffer for each view. Discard only when wrapping around, as the draw calls reading the old contents have been issued
+    void* data;
+    if (instancingBufferOffset_ + numInstances <= instancingBuffer_->GetVertexCount())
+    {
+        startIndex = instancingBufferOffset_;
+        data = instancingBuffer_->LockNoOverwrite(startIndex, numInstances);
+    }
+    else
+    {
+        startIndex = 0;
+        data = instancingBuffer_->Lock(0, numInstances, true);
+    }
+
+    if (data)
+        instancingBufferOffset_ = startIndex + numInstances;
+    return data;
+}
+
 void Renderer::OptimizeLightByScissor(Light* light, Camera* camera)
 {
     if (light && light->GetLightType() != LIGHT_DIRECTIONAL)
@@ -1493,7 +1773,6 @@ void Renderer::UpdateQueuedViewport(unsigned index)
 
     views_.Push(WeakPtr<View>(view));
 
-    const IntRect& viewRect = viewport->GetRect();
     Scene* scene = viewport->GetScene();
     if (!scene)
         return;
@@ -1503,26 +1782,141 @@ void Renderer::UpdateQueuedViewport(unsigned index)
     // Update octree (perform early update for drawables which need that, and reinsert moved drawables.)
     // However, if the same scene is viewed from multiple cameras, update the octree only once
     if (!updatedOctrees_.Contains(octree))
-    {
-        frame_.camera_ = viewport->GetCamera();
-        frame_.viewSize_ = viewRect.Size();
-        if (frame_.viewSize_ == IntVector2::ZERO)
-            frame_.viewSize_ = IntVector2(graphics_->GetWidth(), graphics_->GetHeight());
-        octree->Update(frame_);
-        updatedOctrees_.Insert(octree);
-
-        // Set also the view for the debug renderer already here, so that it can use culling
-        /// \todo May result in incorrect debug geometry culling if the same scene is drawn from multiple viewports
-        auto* debug = scene->GetComponent<DebugRenderer>();
-        if (debug && viewport->GetDrawDebug())
-            debug->SetView(viewport->GetCamera());
-    }
+        UpdateOctree(octree, viewport);
 
     // Update view. This may queue further views. View will send update begin/end events once its state is set
     ResetShadowMapAllocations(); // Each view can reuse the same shadow maps
     view->Update(frame_);
 }
 
+void Renderer::UpdateOctree(Octree* octree, Viewport* viewport)
+{
+    frame_.camera_ = viewport->GetCamera();
+    frame_.viewSize_ = viewport->GetRect().Size();
+    if (frame_.viewSize_ == IntVector2::ZERO)
+        frame_.viewSize_ = IntVector2(graphics_->GetWidth(), graphics_->GetHeight());
+    octree->Update(frame_);
+    updatedOctrees_.Insert(octree);
+
+    // Set also the view for the debug renderer already here, so that it can use culling
+    /// \todo May result in incorrect debug geometry culling if the same scene is drawn from multiple viewports
+    auto* debug = viewport->GetScene()->GetComponent<DebugRenderer>();
+    if (debug && viewport->GetDrawDebug())
+        debug->SetView(viewport->GetCamera());
+}
+
+void Renderer::PrepareSharedSceneQueries(unsigned start, unsigned end)
+{
+    if (!shareSceneQueries_ || end - start < 2)
+        return;
+
+    // Group the viewports by octree, one per culling camera. Cameras already queried earlier in the frame keep their result
+    HashMap<Octree*, PODVector<Viewport*> > octreeViewports;
+    for (unsigned i = start; i < end; ++i)
+    {
+        WeakPtr<RenderSurface>& renderTarget = queuedViewports_[i].first_;
+        WeakPtr<Viewport>& viewport = queuedViewports_[i].second_;
+        if ((renderTarget.NotNull() && renderTarget.Expired()) || viewport.Expired())
+            continue;
+
+        Scene* scene = viewport->GetScene();
+        Camera* camera = viewport->GetCullCamera() ? viewport->GetCullCamera() : viewport->GetCamera();
+        auto* octree = scene ? scene->GetComponent<Octree>() : nullptr;
+        if (!octree || !camera || GetSharedSceneQuery(octree, camera))
+            continue;
+
+        PODVector<Viewport*>& viewports = octreeViewports[octree];
+        bool found = false;
+        for (unsigned j = 0; j < viewports.Size(); ++j)
+        {
+            if ((viewports[j]->GetCullCamera() ? viewports[j]->GetCullCamera() : viewports[j]->GetCamera()) == camera)
+            {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            viewports.Push(viewport);
+    }
+
+    for (HashMap<Octree*, PODVector<Viewport*> >::Iterator i = octreeViewports.Begin(); i != octreeViewports.End(); ++i)
+    {
+        Octree* octree = i->first_;
+        const PODVector<Viewport*>& viewports = i->second_;
+        if (viewports.Size() < 2)
+            continue;
+
+        URHO3D_PROFILE(SharedSceneQuery);
+
+        // The moved drawables must be reinserted before querying
+        if (!updatedOctrees_.Contains(octree))
+            UpdateOctree(octree, viewports[0]);
+
+        unsigned first = numSharedSceneQueries_;
+        unsigned count = Min(viewports.Size(), MAX_QUERY_FRUSTUMS);
+        numSharedSceneQueries_ += count;
+        if (sharedSceneQueries_.Size() < numSharedSceneQueries_)
+            sharedSceneQueries_.Resize(numSharedSceneQueries_);
+
+        MultiFrustumOctreeQuery query(DRAWABLE_GEOMETRY | DRAWABLE_LIGHT | DRAWABLE_ZONE);
+        for (unsigned j = 0; j < count; ++j)
+        {
+            Viewport* viewport = viewports[j];
+            Camera* camera = viewport->GetCullCamera() ? viewport->GetCullCamera() : viewport->GetCamera();
+            SharedSceneQuery& sharedQuery = sharedSceneQueries_[first + j];
+            sharedQuery.octree_ = octree;
+            sharedQuery.camera_ = camera;
+            sharedQuery.frustum_ = camera->GetFrustum();
+            sharedQuery.viewMask_ = camera->GetViewMask();
+            query.AddFrustum(sharedQuery.frustum_, sharedQuery.viewMask_, sharedQuery.inside_, sharedQuery.intersecting_);
+        }
+
+        octree->GetDrawables(query);
+    }
+}
+
+const SharedSceneQuery* Renderer::GetSharedSceneQuery(Octree* octree, Camera* camera) const
+{
+    for (unsigned i = 0; i < numSharedSceneQueries_; ++i)
+    {
+        const SharedSceneQuery& sharedQuery = sharedSceneQueries_[i];
+        if (sharedQuery.octree_ == octree && sharedQuery.camera_ == camera)
+            return &sharedQuery;
+    }
+
+    return nullptr;
+}
+
+void Renderer::UpdateResolutionScale()
+{
+    if (!dynamicResolution_)
+    {
+        resolutionScale_ = 1.0f;
+        return;
+    }
+
+    // Without measurements keep the current scale
+    long long frameTime = graphics_->GetGPUTiming() ? graphics_->GetGPUFrameTime() : 0;
+    if (frameTime > 0)
+    {
+        // GPU time is assumed proportional to the pixel count, so the linear scale that meets the target is the square root of
+        // the time ratio. Base it on the scale in effect, as the measured frames were rendered at that
+        float ratio = dynamicResolutionTargetTime_ * 1000.0f / (float)frameTime;
+        float scale = Clamp(resolutionScale_ * sqrtf(ratio), minResolutionScale_, maxResolutionScale_);
+        targetResolutionScale_ = Lerp(targetResolutionScale_, scale, RESOLUTION_SCALE_RATE);
+    }
+
+    // Change the quantized scale only when the target has moved three quarters of a step away, to avoid flickering between
+    // two steps
+    if (Abs(targetResolutionScale_ - resolutionScale_) > RESOLUTION_SCALE_STEP * 0.75f)
+    {
+        float steps = Round(targetResolutionScale_ / RESOLUTION_SCALE_STEP);
+        resolutionScale_ = Clamp(steps * RESOLUTION_SCALE_STEP, minResolutionScale_, maxResolutionScale_);
+    }
+    else
+        resolutionScale_ = Clamp(resolutionScale_, minResolutionScale_, maxResolutionScale_);
+}
+
 void Renderer::PrepareViewRender()
 {
     ResetScreenBufferAllocations();
@@ -1561,12 +1955,38 @@ void Renderer::RemoveUnusedBuffers()
             screenBuffers_.Erase(current);
         }
     }
+
+    for (HashMap<Light*, SharedPtr<ShadowMapCache> >::Iterator i = shadowMapCaches_.Begin(); i != shadowMapCaches_.End();)
+    {
+        HashMap<Light*, SharedPtr<ShadowMapCache> >::Iterator current = i++;
+        ShadowMapCache* cache = current->second_;
+        if (!cache->light_ || !cache->light_->GetShadowCaching() || cache->useTimer_.GetMSec(false) > MAX_BUFFER_AGE)
+        {
+            URHO3D_LOGDEBUG("Removed unused cached shadow map");
+            shadowMapCaches_.Erase(current);
+        }
+    }
+
+    for (HashMap<Camera*, SharedPtr<OcclusionDepthHistory> >::Iterator i = occlusionDepthHistories_.Begin();
+        i != occlusionDepthHistories_.End();)
+    {
+        HashMap<Camera*, SharedPtr<OcclusionDepthHistory> >::Iterator current = i++;
+        OcclusionDepthHistory* history = current->second_;
+        if (!history->camera_ || history->useTimer_.GetMSec(false) > MAX_BUFFER_AGE)
+        {
+            URHO3D_LOGDEBUG("Removed unused occlusion reprojection depth");
+            occlusionDepthHistories_.Erase(current);
+        }
+    }
 }
 
 void Renderer::ResetShadowMapAllocations()
 {
     for (HashMap<int, PODVector<Light*> >::Iterator i = shadowMapAllocations_.Begin(); i != shadowMapAllocations_.End(); ++i)
         i->second_.Clear();
+
+    if (shadowAtlasTexture_)
+        shadowAtlasAllocator_.Reset(shadowAtlasTexture_->GetWidth(), shadowAtlasTexture_->GetHeight(), 0, 0, false);
 }
 
 void Renderer::ResetScreenBufferAllocations()
@@ -1887,6 +2307,7 @@ void Renderer::CreateInstancingBuffer()
     }
 
     instancingBuffer_ = new VertexBuffer(context_);
+    instancingBufferOffset_ = 0;
     const PODVector<VertexElement> instancingBufferElements = CreateInstancingBufferElements(numExtraInstancingBufferElements_);
     if (!instancingBuffer_->SetSize(INSTANCING_BUFFER_DEFAULT_SIZE, instancingBufferElements, true))
     {
@@ -1900,11 +2321,156 @@ void Renderer::ResetShadowMaps()
     shadowMaps_.Clear();
     shadowMapAllocations_.Clear();
     colorShadowMaps_.Clear();
+    shadowMapCaches_.Clear();
+    shadowAtlasTexture_.Reset();
+}
+
+IntVector2 Renderer::CalculateShadowMapSize(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight) const
+{
+    LightType type = light->GetLightType();
+    const FocusParameters& parameters = light->GetShadowFocus();
+    float size = (float)shadowMapSize_ * light->GetShadowResolution();
+    // Automatically reduce shadow map size when far away
+    if (parameters.autoSize_ && type != LIGHT_DIRECTIONAL)
+    {
+        const Matrix3x4& view = camera->GetView();
+        const Matrix4& projection = camera->GetProjection();
+        BoundingBox lightBox;
+        float lightPixels;
+
+        if (type == LIGHT_POINT)
+        {
+            // Calculate point light pixel size from the projection of its diagonal
+            Vector3 center = view * light->GetNode()->GetWorldPosition();
+            float extent = 0.58f * light->GetRange();
+            lightBox.Define(center + Vector3(extent, extent, extent), center - Vector3(extent, extent, extent));
+        }
+        else
+        {
+            // Calculate spot light pixel size from the projection of its frustum far vertices
+            Frustum lightFrustum = light->GetViewSpaceFrustum(view);
+            lightBox.Define(&lightFrustum.vertices_[4], 4);
+        }
+
+        Vector2 projectionSize = lightBox.Projected(projection).Size();
+        lightPixels = Max(0.5f * (float)viewWidth * projectionSize.x_, 0.5f * (float)viewHeight * projectionSize.y_);
+
+        // Clamp pixel amount to a sufficient minimum to avoid self-shadowing artifacts due to loss of precision
+        if (lightPixels < SHADOW_MIN_PIXELS)
+            lightPixels = SHADOW_MIN_PIXELS;
+
+        size = Min(size, lightPixels);
+    }
+
+    /// \todo Allow to specify maximum shadow maps per resolution, as smaller shadow maps take less memory
+    int width = NextPowerOfTwo((unsigned)size);
+    int height = width;
+
+    // Adjust the size for directional or point light shadow map atlases
+    if (type == LIGHT_DIRECTIONAL)
+    {
+        auto numSplits = (unsigned)light->GetNumShadowSplits();
+        if (numSplits > 1)
+            width *= 2;
+        if (numSplits > 2)
+            height *= 2;
+    }
+    else if (type == LIGHT_POINT)
+    {
+        width *= 2;
+        height *= 3;
+    }
+
+    return {width, height};
+}
+
+SharedPtr<Texture2D> Renderer::CreateShadowMap(int width, int height)
+{
+    int searchKey = width << 16u | height;
+
+    // Find format and usage of the shadow map
+    unsigned shadowMapFormat = 0;
+    TextureUsage shadowMapUsage = TEXTURE_DEPTHSTENCIL;
+    int multiSample = 1;
+
+    switch (shadowQuality_)
+    {
+    case SHADOWQUALITY_SIMPLE_16BIT:
+    case SHADOWQUALITY_PCF_16BIT:
+        shadowMapFormat = graphics_->GetShadowMapFormat();
+        break;
+
+    case SHADOWQUALITY_SIMPLE_24BIT:
+    case SHADOWQUALITY_PCF_24BIT:
+        shadowMapFormat = graphics_->GetHiresShadowMapFormat();
+        break;
+
+    case SHADOWQUALITY_VSM:
+    case SHADOWQUALITY_BLUR_VSM:
+        shadowMapFormat = graphics_->GetRGFloat32Format();
+        shadowMapUsage = TEXTURE_RENDERTARGET;
+        multiSample = vsmMultiSample_;
+        break;
+    }
+
+    if (!shadowMapFormat)
+        return SharedPtr<Texture2D>();
+
+    SharedPtr<Texture2D> newShadowMap(new Texture2D(context_));
+    int retries = 3;
+    unsigned dummyColorFormat = graphics_->GetDummyColorFormat();
+
+    // Disable mipmaps from the shadow map
+    newShadowMap->SetNumLevels(1);
+
+    while (retries)
+    {
+        if (!newShadowMap->SetSize(width, height, shadowMapFormat, shadowMapUsage, multiSample))
+        {
+            width >>= 1;
+            height >>= 1;
+            --retries;
+        }
+        else
+        {
+#ifndef GL_ES_VERSION_2_0
+            // OpenGL (desktop) and D3D11: shadow compare mode needs to be specifically enabled for the shadow map
+            newShadowMap->SetFilterMode(FILTER_BILINEAR);
+            newShadowMap->SetShadowCompare(shadowMapUsage == TEXTURE_DEPTHSTENCIL);
+#endif
+#ifndef URHO3D_OPENGL
+            // Direct3D9: when shadow compare must be done manually, use nearest filtering so that the filtering of point lights
+            // and other shadowed lights matches
+            newShadowMap->SetFilterMode(graphics_->GetHardwareShadowSupport() ? FILTER_BILINEAR : FILTER_NEAREST);
+#endif
+            // Create dummy color texture for the shadow map if necessary: Direct3D9, or OpenGL when working around an OS X +
+            // Intel driver bug
+            if (shadowMapUsage == TEXTURE_DEPTHSTENCIL && dummyColorFormat)
+            {
+                // If no dummy color rendertarget for this size exists yet, create one now
+                if (!colorShadowMaps_.Contains(searchKey))
+                {
+                    colorShadowMaps_[searchKey] = new Texture2D(context_);
+                    colorShadowMaps_[searchKey]->SetNumLevels(1);
+                    colorShadowMaps_[searchKey]->SetSize(width, height, dummyColorFormat, TEXTURE_RENDERTARGET);
+                }
+                // Link the color rendertarget to the shadow map
+                newShadowMap->GetRenderSurface()->SetLinkedRenderTarget(colorShadowMaps_[searchKey]->GetRenderSurface());
+            }
+            break;
+        }
+    }
+
+    if (!retries)
+        newShadowMap.Reset();
+
+    return newShadowMap;
 }
 
 void Renderer::ResetBuffers()
 {
     occlusionBuffers_.Clear();
+    occlusionDepthHistories_.Clear();
     screenBuffers_.Clear();
     screenBufferAllocations_.Clear();
 }
@@ -24,10 +24,14 @@
 
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
+#include "../Core/Timer.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/Viewport.h"
+#include "../Math/AreaAllocator.h"
 #include "../Math/Color.h"
+#include "../Math/Frustum.h"
 
 namespace Urho3D
 {
@@ -50,6 +54,7 @@ class Technique;
 class Texture;
 class Texture2D;
 class TextureCube;
+class TextureStreamer;
 class View;
 class Zone;
 struct BatchQueue;
@@ -169,6 +174,70 @@ enum DeferredLightPSVariation
     MAX_DEFERRED_LIGHT_PS_VARIATIONS
 };
 
+/// Cached shadow map of a light with shadow caching enabled.
+struct ShadowMapCache : public RefCounted
+{
+    /// Light.
+    WeakPtr<Light> light_;
+    /// Depth of the static shadow casters.
+    SharedPtr<Texture2D> staticShadowMap_;
+    /// Static shadow map with the dynamic shadow casters rendered on top, used for lighting.
+    SharedPtr<Texture2D> shadowMap_;
+    /// Static shadow casters and their geometries rendered into the static shadow map, for detecting changes.
+    PODVector<void*> staticCasters_;
+    /// Shadow camera view-projection matrices of the static shadow map.
+    Vector<Matrix4> shadowCameras_;
+    /// Depth bias of the static shadow map.
+    Vector2 depthBias_;
+    /// Static shadow map up to date flag.
+    bool staticValid_{};
+    /// Shadow map up to date flag. Remains set as long as there are no dynamic shadow casters.
+    bool valid_{};
+    /// Time since last use.
+    Timer useTimer_;
+};
+
+/// Number of downsampled depth textures per camera for occlusion reprojection. The depth is read back this many frames minus one after rendering it.
+static const unsigned NUM_OCCLUSION_DEPTH_TEXTURES = 3;
+
+/// Downsampled scene depth of a camera from earlier frames, for reprojection into the occlusion buffer.
+struct OcclusionDepthHistory : public RefCounted
+{
+    /// Camera.
+    WeakPtr<Camera> camera_;
+    /// Depth textures, rendered and read back in turn.
+    SharedPtr<Texture2D> textures_[NUM_OCCLUSION_DEPTH_TEXTURES];
+    /// Camera state of each depth texture when rendered. Depth values are not stored.
+    OcclusionDepthData views_[NUM_OCCLUSION_DEPTH_TEXTURES];
+    /// Whether each depth texture has been rendered to.
+    bool rendered_[NUM_OCCLUSION_DEPTH_TEXTURES]{};
+    /// Index of the depth texture to render next.
+    unsigned nextTexture_{};
+    /// Most recent depth read back.
+    OcclusionDepthData data_;
+    /// Whether depth has been read back.
+    bool valid_{};
+    /// Time since last use.
+    Timer useTimer_;
+};
+
+/// Octree query result of a culling camera, shared by the views of a frame that use the camera.
+struct SharedSceneQuery
+{
+    /// Octree queried.
+    Octree* octree_{};
+    /// Culling camera.
+    Camera* camera_{};
+    /// Camera frustum at the time of the query.
+    Frustum frustum_;
+    /// Camera view mask at the time of the query.
+    unsigned viewMask_{};
+    /// Zones, lights and geometries of octants fully inside the frustum.
+    PODVector<Drawable*> inside_;
+    /// Zones, lights and geometries of octants intersecting the frustum. Not yet tested individually.
+    PODVector<Drawable*> intersecting_;
+};
+
 /// High-level rendering subsystem. Manages drawing of 3D views.
 class URHO3D_API Renderer : public Object
 {
@@ -222,6 +291,10 @@ public:
     void SetReuseShadowMaps(bool enable);
     /// Set maximum number of shadow maps created for one resolution. Only has effect if reuse of shadow maps is disabled.
     void SetMaxShadowMaps(int shadowMaps);
+    /// Set whether directional and spot light shadow maps are allocated as tiles of one shadow atlas texture, rendered with a single rendertarget binding per view. Point lights, VSM shadows and cached shadows keep separate shadow maps. Default false.
+    void SetShadowAtlas(bool enable);
+    /// Set shadow atlas texture size. Default 4096.
+    void SetShadowAtlasSize(int size);
     /// Set dynamic instancing on/off. When on (default), drawables using the same static-type geometry and material will be automatically combined to an instanced draw call.
     void SetDynamicInstancing(bool enable);
     /// Set number of extra instancing buffer elements. Default is 0. Extra 4-vectors are available through TEXCOORD7 and further.
@@ -232,18 +305,42 @@ public:
     void SetMaxSortedInstances(int instances);
     /// Set maximum number of occluder triangles.
     void SetMaxOccluderTriangles(int triangles);
+    /// Set maximum number of render surfaces updated per frame. When exceeded, the surfaces updated longest ago are preferred and the rest wait for the next frame. 0 (default) is unlimited.
+    void SetMaxRenderSurfaceUpdates(int surfaces);
     /// Set occluder buffer width.
     void SetOcclusionBufferSize(int size);
     /// Set required screen size (1.0 = full screen) for occluders.
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set whether to reproject the scene depth of earlier frames into the occlusion buffer, so that all rendered geometry can occlude, not just the occluders. Requires a render path with a "depth" rendertarget, such as ForwardDepth or the deferred paths. Default false.
+    void SetOcclusionReprojection(bool enable);
+    /// Set whether views of the same scene share one octree traversal per frame, instead of each querying the octree for its culling camera. Default true.
+    void SetShareSceneQueries(bool enable);
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect.)
     void SetMobileShadowBiasMul(float mul);
     /// Set shadow depth bias addition for mobile platforms to counteract possible worse shadow map precision. Default 0.0 (no effect.)
     void SetMobileShadowBiasAdd(float add);
     /// Set shadow normal offset multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect.)
     void SetMobileNormalOffsetMul(float mul);
+    /// Set texture mip level streaming on/off. When on, textures enabled for streaming load their highest mip levels only when needed on screen. Default off.
+    void SetTextureStreaming(bool enable);
+    /// Set whether to compress uncompressed 2D textures to DXT format on load, when the GPU supports it. Textures with alpha are compressed to DXT5, others to DXT1. Default off.
+    void SetTextureCompression(bool enable);
+    /// Set directory to cache the textures compressed on load, keyed by a hash of the source image file. Empty (default) disables the cache.
+    void SetTextureCompressionCacheDir(const String& path);
+    /// Set clustered forward lighting on/off. When on, unshadowed point and spot lights are gathered into a per-view light grid and applied in the base pass instead of drawing each lit object once per light. Only has effect in forward rendering on desktop platforms. Default off.
+    void SetClusteredLighting(bool enable);
+    /// Set dynamic resolution on/off. When on, the backbuffer views render the scene at a scaled resolution, which is adjusted each frame to keep the measured GPU frame time at the target, and upscale the result to the backbuffer before the UI is drawn. Enables GPU timing in Graphics. Default off.
+    void SetDynamicResolution(bool enable);
+    /// Set the target GPU frame time of dynamic resolution in milliseconds. Default 16.67 (60 frames per second.)
+    void SetDynamicResolutionTargetTime(float msec);
+    /// Set the minimum resolution scale of dynamic resolution. Default 0.5.
+    void SetMinResolutionScale(float scale);
+    /// Set the maximum resolution scale of dynamic resolution. Default 1.0 (full resolution.)
+    void SetMaxResolutionScale(float scale);
+    /// Set whether non-persistent render path rendertargets with the same format and size share a screen buffer when their use in the render path commands does not overlap. Default true.
+    void SetRenderTargetAliasing(bool enable);
     /// Force reload of shaders.
     void ReloadShaders();
 
@@ -304,6 +401,15 @@ public:
     /// Return maximum number of shadow maps per resolution.
     int GetMaxShadowMaps() const { return maxShadowMaps_; }
 
+    /// Return whether shadow maps are allocated from the shadow atlas.
+    bool GetShadowAtlas() const { return shadowAtlas_; }
+
+    /// Return shadow atlas texture size.
+    int GetShadowAtlasSize() const { return shadowAtlasSize_; }
+
+    /// Return shadow atlas texture, or null if not created.
+    Texture2D* GetShadowAtlasTexture() const { return shadowAtlasTexture_; }
+
     /// Return whether dynamic instancing is in use.
     bool GetDynamicInstancing() const { return dynamicInstancing_; }
 
@@ -319,6 +425,9 @@ public:
     /// Return maximum number of occluder triangles.
     int GetMaxOccluderTriangles() const { return maxOccluderTriangles_; }
 
+    /// Return maximum number of render surfaces updated per frame.
+    int GetMaxRenderSurfaceUpdates() const { return maxRenderSurfaceUpdates_; }
+
     /// Return occlusion buffer width.
     int GetOcclusionBufferSize() const { return occlusionBufferSize_; }
 
@@ -328,6 +437,12 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether the scene depth of earlier frames is reprojected into the occlusion buffer.
+    bool GetOcclusionReprojection() const { return occlusionReprojection_; }
+
+    /// Return whether views of the same scene share one octree traversal per frame.
+    bool GetShareSceneQueries() const { return shareSceneQueries_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
 
@@ -337,6 +452,39 @@ public:
     /// Return shadow normal offset multiplier for mobile platforms.
     float GetMobileNormalOffsetMul() const { return mobileNormalOffsetMul_; }
 
+    /// Return whether texture mip level streaming is enabled.
+    bool GetTextureStreaming() const { return textureStreamer_.NotNull(); }
+
+    /// Return the texture streamer, or null if texture streaming is disabled.
+    TextureStreamer* GetTextureStreamer() const { return textureStreamer_; }
+
+    /// Return whether textures are compressed on load.
+    bool GetTextureCompression() const { return textureCompression_; }
+
+    /// Return the compressed texture cache directory.
+    const String& GetTextureCompressionCacheDir() const { return textureCompressionCacheDir_; }
+
+    /// Return whether clustered forward lighting is enabled.
+    bool GetClusteredLighting() const { return clusteredLighting_; }
+
+    /// Return whether dynamic resolution is enabled.
+    bool GetDynamicResolution() const { return dynamicResolution_; }
+
+    /// Return the target GPU frame time of dynamic resolution in milliseconds.
+    float GetDynamicResolutionTargetTime() const { return dynamicResolutionTargetTime_; }
+
+    /// Return the minimum resolution scale of dynamic resolution.
+    float GetMinResolutionScale() const { return minResolutionScale_; }
+
+    /// Return the maximum resolution scale of dynamic resolution.
+    float GetMaxResolutionScale() const { return maxResolutionScale_; }
+
+    /// Return the resolution scale the backbuffer views render at this frame. 1.0 when dynamic resolution is off.
+    float GetResolutionScale() const { return resolutionScale_; }
+
+    /// Return whether render path rendertargets share screen buffers when their use does not overlap.
+    bool GetRenderTargetAliasing() const { return renderTargetAliasing_; }
+
     /// Return number of views rendered.
     unsigned GetNumViews() const { return views_.Size(); }
 
@@ -348,6 +496,8 @@ public:
 
     /// Return number of geometries rendered.
     unsigned GetNumGeometries(bool allViews = false) const;
+    /// Return GPU memory of the screen buffers of the view using the most this frame in bytes, excluding depth-stencil buffers. As the views render one after another, they share the screen buffers that are not persistent.
+    unsigned long long GetRenderTargetMemory() const;
     /// Return number of lights rendered.
     unsigned GetNumLights(bool allViews = false) const;
     /// Return number of shadow maps rendered.
@@ -383,10 +533,14 @@ public:
     void Update(float timeStep);
     /// Render. Called by Engine.
     void Render();
+    /// Update the geometries of the views prepared for rendering and copy the world transforms of their batches, so that rendering no longer reads the scene's transforms. Called by Engine with pipelined frames.
+    void SnapshotViews();
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry(bool depthTest);
     /// Queue a render surface's viewports for rendering. Called by the surface, or by View.
     void QueueRenderSurface(RenderSurface* renderTarget);
+    /// Queue a render surface's viewports for rendering if its update is due and the per-frame budget allows. Called by the parent texture on the render surface update event.
+    void QueueRenderSurfaceUpdate(RenderSurface* renderTarget);
     /// Queue a viewport for rendering. Null surface means backbuffer.
     void QueueViewport(RenderSurface* renderTarget, Viewport* viewport);
 
@@ -396,6 +550,10 @@ public:
     Geometry* GetQuadGeometry();
     /// Allocate a shadow map. If shadow map reuse is disabled, a different map is returned each time.
     Texture2D* GetShadowMap(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight);
+    /// Allocate a shadow atlas tile for a light. Return the atlas texture and fill the tile rectangle, or return null if the light can not use the atlas or it is full.
+    Texture2D* GetShadowAtlasTile(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight, IntRect& tile);
+    /// Allocate the cached shadow maps of a light with shadow caching enabled. Return null if shadow caching is not supported with the current graphics API or shadow quality.
+    ShadowMapCache* GetShadowMapCache(Light* light);
     /// Allocate a rendertarget or depth-stencil texture for deferred rendering or postprocessing. Should only be called during actual rendering, not before.
     Texture* GetScreenBuffer
         (int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb, unsigned persistentKey = 0);
@@ -403,12 +561,16 @@ public:
     RenderSurface* GetDepthStencil(int width, int height, int multiSample, bool autoResolve);
     /// Allocate an occlusion buffer.
     OcclusionBuffer* GetOcclusionBuffer(Camera* camera);
+    /// Return the occlusion reprojection depth textures of a camera, optionally creating them with the given size. Return null if not found or if not supported.
+    OcclusionDepthHistory* GetOcclusionDepthHistory(Camera* camera, bool create = false, int width = 0, int height = 0);
     /// Allocate a temporary shadow camera and a scene node for it. Is thread-safe.
     Camera* GetShadowCamera();
     /// Mark a view as prepared by the specified culling camera.
     void StorePreparedView(View* view, Camera* camera);
     /// Return a prepared view if exists for the specified camera. Used to avoid duplicate view preparation CPU work.
     View* GetPreparedView(Camera* camera);
+    /// Return the shared octree query result of a culling camera for this frame, or null if not queried. Called by View.
+    const SharedSceneQuery* GetSharedSceneQuery(Octree* octree, Camera* camera) const;
     /// Choose shaders for a forward rendering batch. The related batch queue is provided in case it has extra shader compilation defines.
     void SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows, const BatchQueue& queue);
     /// Choose shaders for a deferred light volume batch.
@@ -418,6 +580,8 @@ public:
     void SetCullMode(CullMode mode, Camera* camera);
     /// Ensure sufficient size of the instancing vertex buffer. Return true if successful.
     bool ResizeInstancingBuffer(unsigned numInstances);
+    /// Lock space for instances in the instancing vertex buffer, which is used as a ring. Return pointer to the locked data and the index of the first instance, or null if failed.
+    void* LockInstancingBuffer(unsigned numInstances, unsigned& startIndex);
     /// Optimize a light by scissor rectangle.
     void OptimizeLightByScissor(Light* light, Camera* camera);
     /// Optimize a light by marking it to the stencil buffer and setting a stencil test.
@@ -447,9 +611,15 @@ private:
     void SetIndirectionTextureData();
     /// Update a queued viewport for rendering.
     void UpdateQueuedViewport(unsigned index);
+    /// Adjust the dynamic resolution scale from the measured GPU frame time.
+    void UpdateResolutionScale();
+    /// Update an octree once per frame, using a viewport's camera.
+    void UpdateOctree(Octree* octree, Viewport* viewport);
+    /// Query the octree once for the culling cameras of queued viewports that share a scene.
+    void PrepareSharedSceneQueries(unsigned start, unsigned end);
     /// Prepare for rendering of a new view.
     void PrepareViewRender();
-    /// Remove unused occlusion and screen buffers.
+    /// Remove unused occlusion and screen buffers, and cached shadow maps.
     void RemoveUnusedBuffers();
     /// Reset shadow map allocation counts.
     void ResetShadowMapAllocations();
@@ -457,6 +627,10 @@ private:
     void ResetScreenBufferAllocations();
     /// Remove all shadow maps. Called when global shadow map resolution or format is changed.
     void ResetShadowMaps();
+    /// Return shadow map size for a light, including the layout of its splits or cube faces.
+    IntVector2 CalculateShadowMapSize(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight) const;
+    /// Create a shadow map texture with the current shadow quality. Return null if failed.
+    SharedPtr<Texture2D> CreateShadowMap(int width, int height);
     /// Remove all occlusion and screen buffers.
     void ResetBuffers();
     /// Find variations for shadow shaders
@@ -484,6 +658,8 @@ private:
     SharedPtr<Geometry> pointLightGeometry_;
     /// Instance stream vertex buffer.
     SharedPtr<VertexBuffer> instancingBuffer_;
+    /// Index in the instancing buffer from which the next instances are written.
+    unsigned instancingBufferOffset_{};
     /// Default material.
     SharedPtr<Material> defaultMaterial_;
     /// Default range attenuation texture.
@@ -494,16 +670,28 @@ private:
     SharedPtr<TextureCube> faceSelectCubeMap_;
     /// Indirection cube map for shadowed pointlights.
     SharedPtr<TextureCube> indirectionCubeMap_;
+    /// Texture mip level streamer.
+    SharedPtr<TextureStreamer> textureStreamer_;
+    /// Compressed texture cache directory.
+    String textureCompressionCacheDir_;
     /// Reusable scene nodes with shadow camera components.
     Vector<SharedPtr<Node> > shadowCameraNodes_;
     /// Reusable occlusion buffers.
     Vector<SharedPtr<OcclusionBuffer> > occlusionBuffers_;
+    /// Occlusion reprojection depth textures by camera.
+    HashMap<Camera*, SharedPtr<OcclusionDepthHistory> > occlusionDepthHistories_;
     /// Shadow maps by resolution.
     HashMap<int, Vector<SharedPtr<Texture2D> > > shadowMaps_;
     /// Shadow map dummy color buffers by resolution.
     HashMap<int, SharedPtr<Texture2D> > colorShadowMaps_;
     /// Shadow map allocations by resolution.
     HashMap<int, PODVector<Light*> > shadowMapAllocations_;
+    /// Cached shadow maps by light.
+    HashMap<Light*, SharedPtr<ShadowMapCache> > shadowMapCaches_;
+    /// Shadow atlas texture.
+    SharedPtr<Texture2D> shadowAtlasTexture_;
+    /// Shadow atlas tile allocator, reset for each view.
+    AreaAllocator shadowAtlasAllocator_;
     /// Instance of shadow map filter
     Object* shadowMapFilterInstance_{};
     /// Function pointer of shadow map filter
@@ -518,12 +706,18 @@ private:
     Vector<SharedPtr<Viewport> > viewports_;
     /// Render surface viewports queued for update.
     Vector<Pair<WeakPtr<RenderSurface>, WeakPtr<Viewport> > > queuedViewports_;
+    /// Render surfaces due for update that are waiting for the per-frame budget.
+    PODVector<RenderSurface*> pendingRenderSurfaces_;
     /// Views that have been processed this frame.
     Vector<WeakPtr<View> > views_;
     /// Prepared views by culling camera.
     HashMap<Camera*, WeakPtr<View> > preparedViews_;
     /// Octrees that have been updated during the frame.
     HashSet<Octree*> updatedOctrees_;
+    /// Shared octree query results. Only the first numSharedSceneQueries_ are valid for the frame, the rest keep their memory.
+    Vector<SharedSceneQuery> sharedSceneQueries_;
+    /// Number of shared octree query results this frame.
+    unsigned numSharedSceneQueries_{};
     /// Techniques for which missing shader error has been displayed.
     HashSet<Technique*> shaderErrorDisplayed_;
     /// Mutex for shadow camera allocation.
@@ -538,6 +732,24 @@ private:
     TextureFilterMode textureFilterMode_{FILTER_TRILINEAR};
     /// Texture quality level.
     MaterialQuality textureQuality_{QUALITY_HIGH};
+    /// Compress textures on load flag.
+    bool textureCompression_{};
+    /// Clustered forward lighting flag.
+    bool clusteredLighting_{};
+    /// Dynamic resolution flag.
+    bool dynamicResolution_{};
+    /// Dynamic resolution target GPU frame time in milliseconds.
+    float dynamicResolutionTargetTime_{1000.0f / 60.0f};
+    /// Minimum dynamic resolution scale.
+    float minResolutionScale_{0.5f};
+    /// Maximum dynamic resolution scale.
+    float maxResolutionScale_{1.0f};
+    /// Unquantized dynamic resolution scale, converging towards the scale that meets the target time.
+    float targetResolutionScale_{1.0f};
+    /// Resolution scale of the backbuffer views this frame.
+    float resolutionScale_{1.0f};
+    /// Render path rendertarget aliasing flag.
+    bool renderTargetAliasing_{true};
     /// Material quality level.
     MaterialQuality materialQuality_{QUALITY_HIGH};
     /// Shadow map resolution.
@@ -552,12 +764,16 @@ private:
     int vsmMultiSample_{1};
     /// Maximum number of shadow maps per resolution.
     int maxShadowMaps_{1};
+    /// Shadow atlas texture size.
+    int shadowAtlasSize_{4096};
     /// Minimum number of instances required in a batch group to render as instanced.
     int minInstances_{2};
     /// Maximum sorted instances per batch group.
     int maxSortedInstances_{1000};
     /// Maximum occluder triangles.
     int maxOccluderTriangles_{5000};
+    /// Maximum render surfaces updated per frame.
+    int maxRenderSurfaceUpdates_{};
     /// Occlusion buffer width.
     int occlusionBufferSize_{256};
     /// Occluder screen size threshold.
@@ -594,6 +810,12 @@ private:
     int numExtraInstancingBufferElements_{};
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_{};
+    /// Occlusion reprojection flag.
+    bool occlusionReprojection_{};
+    /// Shared scene query flag.
+    bool shareSceneQueries_{true};
+    /// Shadow atlas flag.
+    bool shadowAtlas_{};
     /// Shaders need reloading flag.
     bool shadersDirty_{true};
     /// Initialized flag.
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Thread.h"
 #include "../Graphics/RibbonTrail.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/IndexBuffer.h"
@@ -88,7 +89,9 @@ RibbonTrail::RibbonTrail(Context* context) :
     tailColumn_(1),
     updateInvisible_(false),
     emitting_(true),
-    startEndTailTime_(0.0f)
+    startEndTailTime_(0.0f),
+    bufferCapacity_(0),
+    uploadPending_(false)
 {
     geometry_->SetVertexBuffer(0, vertexBuffer_);
     geometry_->SetIndexBuffer(indexBuffer_);
@@ -317,9 +320,19 @@ void RibbonTrail::UpdateTail(float timeStep)
         }
     }
 
-    // Update buffer size if size of points different with tail number
+    // Update buffer size if size of points different with tail number. The buffers are only resized when they run out
+    // of room, otherwise rewriting the vertices is enough, which can be done in a worker thread
     if (points_.Size() != numPoints_)
-        bufferSizeDirty_ = true;
+    {
+        if (points_.Size() > bufferCapacity_)
+            bufferSizeDirty_ = true;
+        else
+        {
+            numPoints_ = points_.Size();
+            bufferDirty_ = true;
+            forceUpdate_ = true;
+        }
+    }
 }
 
 void RibbonTrail::SetEndScale(float endScale)
@@ -403,10 +416,26 @@ void RibbonTrail::UpdateGeometry(const FrameInfo& frame)
         UpdateVertexBuffer(frame);
 }
 
+void RibbonTrail::FinishUpdateGeometry()
+{
+    if (!uploadPending_)
+        return;
+
+    uploadPending_ = false;
+    unsigned vertexSize = vertexBuffer_->GetVertexSize();
+    if (vertexData_.Size() && vertexSize)
+        vertexBuffer_->SetDataRange(vertexData_.Buffer(), 0, vertexData_.Size() * sizeof(float) / vertexSize, true);
+    vertexBuffer_->ClearDataLost();
+}
+
 UpdateGeometryType RibbonTrail::GetUpdateGeometryType()
 {
-    if (bufferDirty_ || bufferSizeDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+    // Resizing or restoring the buffers has to happen in the main thread. Writing the vertices is safe in a worker thread,
+    // as the upload is done afterward in the main thread
+    if (bufferSizeDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
         return UPDATE_MAIN_THREAD;
+    else if (bufferDirty_)
+        return UPDATE_WORKER_THREAD;
     else
         return UPDATE_NONE;
 }
@@ -465,7 +494,11 @@ void RibbonTrail::UpdateBufferSize()
     bufferDirty_ = true;
     forceUpdate_ = true;
 
-    if (numPoints_ < 2)
+    // Leave room for the trail to grow, so that adding points does not need a resize each time. The vertex count is limited
+    // by the 16-bit indices
+    bufferCapacity_ = numPoints_ < 2 ? 0 : Max(Min(NextPowerOfTwo(numPoints_), 65536 / vertexPerSegment), numPoints_);
+
+    if (bufferCapacity_ < 2)
     {
         indexBuffer_->SetSize(0, false);
         vertexBuffer_->SetSize(0, mask, true);
@@ -473,17 +506,17 @@ void RibbonTrail::UpdateBufferSize()
     }
     else
     {
-        indexBuffer_->SetSize(((numPoints_ - 1) * indexPerSegment), false);
-        vertexBuffer_->SetSize(numPoints_ * vertexPerSegment, mask, true);
+        indexBuffer_->SetSize(((bufferCapacity_ - 1) * indexPerSegment), false);
+        vertexBuffer_->SetSize(bufferCapacity_ * vertexPerSegment, mask, true);
     }
 
     // Indices do not change for a given tail generator capacity
-    auto* dest = (unsigned short*)indexBuffer_->Lock(0, ((numPoints_ - 1) * indexPerSegment), true);
+    auto* dest = (unsigned short*)indexBuffer_->Lock(0, ((bufferCapacity_ - 1) * indexPerSegment), true);
     if (!dest)
         return;
 
     unsigned vertexIndex = 0;
-    unsigned stripsLen = numPoints_ - 1;
+    unsigned stripsLen = bufferCapacity_ - 1;
 
     while (stripsLen--)
     {
@@ -575,9 +608,9 @@ void RibbonTrail::UpdateVertexBuffer(const FrameInfo& frame)
     bufferDirty_ = false;
     forceUpdate_ = false;
 
-    auto* dest = (float*)vertexBuffer_->Lock(0, (numPoints_ - 1) * vertexPerSegment, true);
-    if (!dest)
-        return;
+    // Write to CPU-side memory, as this may be called from a worker thread
+    vertexData_.Resize((numPoints_ - 1) * vertexPerSegment * vertexBuffer_->GetVertexSize() / sizeof(float));
+    float* dest = vertexData_.Buffer();
 
     // Generate trail mesh
     if (trailType_ == TT_FACE_CAMERA)
@@ -805,8 +838,11 @@ void RibbonTrail::UpdateVertexBuffer(const FrameInfo& frame)
         }
     }
 
-    vertexBuffer_->Unlock();
-    vertexBuffer_->ClearDataLost();
+    uploadPending_ = true;
+
+    // If not in a worker thread, upload right away
+    if (Thread::IsMainThread())
+        FinishUpdateGeometry();
 }
 
 void RibbonTrail::SetLifetime(float time)
@@ -81,6 +81,8 @@ public:
     void UpdateBatches(const FrameInfo& frame) override;
     /// Prepare geometry for rendering. Called from a worker thread if possible (no GPU update.)
     void UpdateGeometry(const FrameInfo& frame) override;
+    /// Upload the vertex data written by a worker thread geometry update.
+    void FinishUpdateGeometry() override;
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     UpdateGeometryType GetUpdateGeometryType() override;
 
@@ -193,7 +195,7 @@ private:
 
     /// Resize RibbonTrail vertex and index buffers.
     void UpdateBufferSize();
-    /// Rewrite RibbonTrail vertex buffer.
+    /// Rewrite RibbonTrail vertex data. Uploads it right away if called from the main thread.
     void UpdateVertexBuffer(const FrameInfo& frame);
     /// Update/Rebuild tail mesh only if position changed (called by UpdateBatches())
     void UpdateTail(float timeStep);
@@ -250,6 +252,12 @@ private:
     TrailPoint endTail_;
     /// The time the tail become end of trail.
     float startEndTailTime_;
+    /// Number of points the buffers have room for.
+    unsigned bufferCapacity_;
+    /// Vertex data written in UpdateGeometry() for uploading in the main thread.
+    PODVector<float> vertexData_;
+    /// Vertex data waiting to be uploaded flag.
+    bool uploadPending_;
 };
 
 }
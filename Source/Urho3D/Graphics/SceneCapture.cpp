@@ -0,0 +1,520 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Light.h"
+#include "../Graphics/SceneCapture.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned SCENECAPTURE_VERSION = 1;
+
+/// Component change flags of a scene capture frame.
+static const unsigned char COMPONENT_CHANGED_ENABLED = 0x1;
+static const unsigned char COMPONENT_CHANGED_LIGHT = 0x2;
+static const unsigned char COMPONENT_CHANGED_ATTRIBUTES = 0x4;
+
+SceneCapture::SceneCapture(Context* context) :
+    Object(context),
+    replayIndex_(M_MAX_UNSIGNED)
+{
+}
+
+SceneCapture::~SceneCapture() = default;
+
+void SceneCapture::StartRecording(Scene* scene, Camera* camera)
+{
+    StopRecording();
+    Clear();
+
+    if (!scene || !camera)
+    {
+        URHO3D_LOGERROR("Null scene or camera for scene capture");
+        return;
+    }
+
+    recordScene_ = scene;
+    recordCamera_ = camera;
+    SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(SceneCapture, HandleScenePostUpdate));
+}
+
+void SceneCapture::StopRecording()
+{
+    if (recordScene_)
+        UnsubscribeFromEvent(recordScene_, E_SCENEPOSTUPDATE);
+
+    recordScene_.Reset();
+    recordCamera_.Reset();
+}
+
+void SceneCapture::RecordFrame(float timeStep)
+{
+    Scene* scene = recordScene_;
+    Camera* camera = recordCamera_;
+    if (!scene || !camera)
+        return;
+
+    URHO3D_PROFILE(RecordSceneCapture);
+
+    SceneCaptureFrame frame;
+    frame.timeStep_ = timeStep;
+
+    Node* cameraNode = camera->GetNode();
+    if (cameraNode)
+    {
+        frame.cameraPosition_ = cameraNode->GetWorldPosition();
+        frame.cameraRotation_ = cameraNode->GetWorldRotation();
+    }
+    frame.fov_ = camera->GetFov();
+    frame.nearClip_ = camera->GetNearClip();
+    frame.farClip_ = camera->GetFarClip();
+    frame.aspectRatio_ = camera->GetAspectRatio();
+    frame.orthoSize_ = camera->GetOrthoSize();
+    frame.zoom_ = camera->GetZoom();
+    frame.orthographic_ = camera->IsOrthographic();
+
+    unsigned structureHash = GetStructureHash(scene);
+    unsigned numNodes = 0;
+    unsigned numComponents = 0;
+
+    if (frames_.Empty() || structureHash != structureHash_ || ++framesSinceKeyFrame_ >= keyFrameInterval_)
+    {
+        VectorBuffer buffer;
+        scene->Save(buffer);
+        frame.data_ = buffer.GetBuffer();
+        frame.keyFrame_ = true;
+        framesSinceKeyFrame_ = 0;
+        structureHash_ = structureHash;
+
+        // Take the states the following frames are compared to
+        nodeStates_.Clear();
+        componentStates_.Clear();
+        WriteChanges(scene, nullptr, numNodes, numComponents);
+    }
+    else
+    {
+        // The counts are not known before the scene has been compared, so write the changes first and the counts after them
+        VectorBuffer changes;
+        WriteChanges(scene, &changes, numNodes, numComponents);
+
+        VectorBuffer buffer;
+        buffer.WriteVLE(numNodes);
+        buffer.WriteVLE(numComponents);
+        buffer.Write(changes.GetData(), changes.GetSize());
+        frame.data_ = buffer.GetBuffer();
+    }
+
+    frames_.Push(frame);
+}
+
+void SceneCapture::SetKeyFrameInterval(unsigned interval)
+{
+    keyFrameInterval_ = Max(interval, 1U);
+}
+
+void SceneCapture::SetCaptureAttributes(bool enable)
+{
+    captureAttributes_ = enable;
+}
+
+void SceneCapture::Clear()
+{
+    frames_.Clear();
+    nodeStates_.Clear();
+    componentStates_.Clear();
+    structureHash_ = 0;
+    framesSinceKeyFrame_ = 0;
+    ResetReplay();
+}
+
+bool SceneCapture::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID("USCP"))
+        return false;
+
+    dest.WriteUInt(SCENECAPTURE_VERSION);
+    dest.WriteBool(captureAttributes_);
+    dest.WriteVLE(frames_.Size());
+
+    for (unsigned i = 0; i < frames_.Size(); ++i)
+    {
+        const SceneCaptureFrame& frame = frames_[i];
+        dest.WriteFloat(frame.timeStep_);
+        dest.WriteBool(frame.keyFrame_);
+        dest.WriteVector3(frame.cameraPosition_);
+        dest.WriteQuaternion(frame.cameraRotation_);
+        dest.WriteFloat(frame.fov_);
+        dest.WriteFloat(frame.nearClip_);
+        dest.WriteFloat(frame.farClip_);
+        dest.WriteFloat(frame.aspectRatio_);
+        dest.WriteFloat(frame.orthoSize_);
+        dest.WriteFloat(frame.zoom_);
+        dest.WriteBool(frame.orthographic_);
+        if (!dest.WriteBuffer(frame.data_))
+            return false;
+    }
+
+    return true;
+}
+
+bool SceneCapture::Load(Deserializer& source)
+{
+    StopRecording();
+    Clear();
+
+    if (source.ReadFileID() != "USCP")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid scene capture file");
+        return false;
+    }
+
+    unsigned version = source.ReadUInt();
+    if (version != SCENECAPTURE_VERSION)
+    {
+        URHO3D_LOGERROR("Unsupported scene capture version " + String(version));
+        return false;
+    }
+
+    captureAttributes_ = source.ReadBool();
+    frames_.Resize(source.ReadVLE());
+
+    for (unsigned i = 0; i < frames_.Size(); ++i)
+    {
+        SceneCaptureFrame& frame = frames_[i];
+        frame.timeStep_ = source.ReadFloat();
+        frame.keyFrame_ = source.ReadBool();
+        frame.cameraPosition_ = source.ReadVector3();
+        frame.cameraRotation_ = source.ReadQuaternion();
+        frame.fov_ = source.ReadFloat();
+        frame.nearClip_ = source.ReadFloat();
+        frame.farClip_ = source.ReadFloat();
+        frame.aspectRatio_ = source.ReadFloat();
+        frame.orthoSize_ = source.ReadFloat();
+        frame.zoom_ = source.ReadFloat();
+        frame.orthographic_ = source.ReadBool();
+        frame.data_ = source.ReadBuffer();
+    }
+
+    if (source.IsEof() && (frames_.Empty() || frames_.Back().data_.Empty()))
+    {
+        URHO3D_LOGERROR("Truncated scene capture " + source.GetName());
+        frames_.Clear();
+        return false;
+    }
+
+    if (!frames_.Empty() && !frames_.Front().keyFrame_)
+    {
+        URHO3D_LOGERROR("Scene capture " + source.GetName() + " does not start with a key frame");
+        frames_.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneCapture::ApplyFrame(Scene* scene, unsigned index)
+{
+    if (!scene || index >= frames_.Size())
+        return false;
+
+    URHO3D_PROFILE(ApplySceneCapture);
+
+    unsigned keyFrameIndex = index;
+    while (keyFrameIndex > 0 && !frames_[keyFrameIndex].keyFrame_)
+        --keyFrameIndex;
+
+    // Continue from the previously applied frame if no key frame lies in between
+    unsigned start;
+    if (replayScene_ == scene && replayIndex_ != M_MAX_UNSIGNED && replayIndex_ <= index && replayIndex_ >= keyFrameIndex)
+        start = replayIndex_ + 1;
+    else
+    {
+        MemoryBuffer buffer(frames_[keyFrameIndex].data_);
+        if (!scene->Load(buffer))
+        {
+            ResetReplay();
+            return false;
+        }
+        start = keyFrameIndex + 1;
+    }
+
+    for (unsigned i = start; i <= index; ++i)
+    {
+        if (!ApplyChanges(scene, frames_[i]))
+        {
+            ResetReplay();
+            return false;
+        }
+    }
+
+    ApplyCamera(scene, frames_[index]);
+    replayScene_ = scene;
+    replayIndex_ = index;
+    return true;
+}
+
+void SceneCapture::ResetReplay()
+{
+    replayIndex_ = M_MAX_UNSIGNED;
+}
+
+unsigned SceneCapture::GetNumKeyFrames() const
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < frames_.Size(); ++i)
+    {
+        if (frames_[i].keyFrame_)
+            ++count;
+    }
+    return count;
+}
+
+void SceneCapture::WriteChanges(Node* node, Serializer* dest, unsigned& numNodes, unsigned& numComponents)
+{
+    // Temporary nodes and components are not saved in the key frames either
+    if (node->IsTemporary())
+        return;
+
+    SceneCaptureNodeState& nodeState = nodeStates_[node->GetID()];
+    const Vector3& position = node->GetPosition();
+    const Quaternion& rotation = node->GetRotation();
+    const Vector3& scale = node->GetScale();
+    bool enabled = node->IsEnabled();
+    if (!dest || position != nodeState.position_ || rotation != nodeState.rotation_ || scale != nodeState.scale_ ||
+        enabled != nodeState.enabled_)
+    {
+        nodeState.position_ = position;
+        nodeState.rotation_ = rotation;
+        nodeState.scale_ = scale;
+        nodeState.enabled_ = enabled;
+
+        if (dest)
+        {
+            dest->WriteUByte(0);
+            dest->WriteUInt(node->GetID());
+            dest->WriteBool(enabled);
+            dest->WriteVector3(position);
+            dest->WriteQuaternion(rotation);
+            dest->WriteVector3(scale);
+            ++numNodes;
+        }
+    }
+
+    const Vector<SharedPtr<Component> >& components = node->GetComponents();
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        Component* component = components[i];
+        if (component->IsTemporary())
+            continue;
+
+        SceneCaptureComponentState& componentState = componentStates_[component->GetID()];
+        unsigned char changed = 0;
+
+        bool componentEnabled = component->IsEnabled();
+        if (!dest || componentEnabled != componentState.enabled_)
+        {
+            componentState.enabled_ = componentEnabled;
+            changed |= COMPONENT_CHANGED_ENABLED;
+        }
+
+        auto* light = component->GetType() == Light::GetTypeStatic() ? static_cast<Light*>(component) : nullptr;
+        if (light && (!dest || light->GetColor() != componentState.lightColor_ ||
+            light->GetBrightness() != componentState.lightBrightness_ || light->GetRange() != componentState.lightRange_))
+        {
+            componentState.lightColor_ = light->GetColor();
+            componentState.lightBrightness_ = light->GetBrightness();
+            componentState.lightRange_ = light->GetRange();
+            changed |= COMPONENT_CHANGED_LIGHT;
+        }
+
+        if (captureAttributes_)
+        {
+            VectorBuffer attributes;
+            component->Save(attributes);
+            if (!dest || attributes.GetSize() != componentState.attributes_.Size() || (attributes.GetSize() &&
+                memcmp(attributes.GetData(), &componentState.attributes_[0], attributes.GetSize()) != 0))
+            {
+                componentState.attributes_ = attributes.GetBuffer();
+                changed |= COMPONENT_CHANGED_ATTRIBUTES;
+            }
+        }
+
+        if (dest && changed)
+        {
+            dest->WriteUByte(changed);
+            dest->WriteUInt(component->GetID());
+            if (changed & COMPONENT_CHANGED_ENABLED)
+                dest->WriteBool(componentEnabled);
+            if (changed & COMPONENT_CHANGED_LIGHT)
+            {
+                dest->WriteColor(componentState.lightColor_);
+                dest->WriteFloat(componentState.lightBrightness_);
+                dest->WriteFloat(componentState.lightRange_);
+            }
+            if (changed & COMPONENT_CHANGED_ATTRIBUTES)
+                dest->WriteBuffer(componentState.attributes_);
+            ++numComponents;
+        }
+    }
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+        WriteChanges(children[i], dest, numNodes, numComponents);
+}
+
+unsigned SceneCapture::GetStructureHash(Node* node) const
+{
+    if (node->IsTemporary())
+        return 0;
+
+    unsigned hash = node->GetID();
+
+    const Vector<SharedPtr<Component> >& components = node->GetComponents();
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        if (!components[i]->IsTemporary())
+            hash = hash * 31 + components[i]->GetID();
+    }
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+        hash = hash * 31 + GetStructureHash(children[i]);
+
+    return hash;
+}
+
+bool SceneCapture::ApplyChanges(Scene* scene, const SceneCaptureFrame& frame)
+{
+    if (frame.keyFrame_)
+    {
+        MemoryBuffer buffer(frame.data_);
+        return scene->Load(buffer);
+    }
+
+    MemoryBuffer source(frame.data_);
+    unsigned numNodes = source.ReadVLE();
+    unsigned numComponents = source.ReadVLE();
+
+    // Nodes and their components are written in scene order, each entry starting with its change flags
+    for (unsigned i = 0; i < numNodes + numComponents && !source.IsEof(); ++i)
+    {
+        unsigned char changed = source.ReadUByte();
+        unsigned id = source.ReadUInt();
+
+        if (!changed)
+        {
+            bool enabled = source.ReadBool();
+            Vector3 position = source.ReadVector3();
+            Quaternion rotation = source.ReadQuaternion();
+            Vector3 scale = source.ReadVector3();
+
+            Node* node = scene->GetNode(id);
+            if (!node)
+            {
+                URHO3D_LOGERROR("Scene capture refers to missing node " + String(id));
+                return false;
+            }
+            node->SetEnabled(enabled);
+            node->SetTransform(position, rotation, scale);
+            continue;
+        }
+
+        Component* component = scene->GetComponent(id);
+        if (!component)
+        {
+            URHO3D_LOGERROR("Scene capture refers to missing component " + String(id));
+            return false;
+        }
+
+        if (changed & COMPONENT_CHANGED_ENABLED)
+            component->SetEnabled(source.ReadBool());
+        if (changed & COMPONENT_CHANGED_LIGHT)
+        {
+            Color color = source.ReadColor();
+            float brightness = source.ReadFloat();
+            float range = source.ReadFloat();
+            if (component->GetType() == Light::GetTypeStatic())
+            {
+                auto* light = static_cast<Light*>(component);
+                light->SetColor(color);
+                light->SetBrightness(brightness);
+                light->SetRange(range);
+            }
+        }
+        if (changed & COMPONENT_CHANGED_ATTRIBUTES)
+        {
+            PODVector<unsigned char> attributeData = source.ReadBuffer();
+            MemoryBuffer attributes(attributeData);
+            // Skip the type and ID written by Component::Save()
+            attributes.ReadStringHash();
+            attributes.ReadUInt();
+            component->Load(attributes);
+            component->ApplyAttributes();
+        }
+    }
+
+    return true;
+}
+
+void SceneCapture::ApplyCamera(Scene* scene, const SceneCaptureFrame& frame)
+{
+    Camera* camera = replayCamera_;
+    if (!camera || camera->GetScene() != scene)
+    {
+        Node* cameraNode = scene->CreateTemporaryChild("SceneCaptureCamera", LOCAL);
+        camera = cameraNode->CreateComponent<Camera>();
+        camera->SetAutoAspectRatio(false);
+        replayCamera_ = camera;
+    }
+
+    camera->GetNode()->SetWorldTransform(frame.cameraPosition_, frame.cameraRotation_);
+    camera->SetFov(frame.fov_);
+    camera->SetNearClip(frame.nearClip_);
+    camera->SetFarClip(frame.farClip_);
+    // Setting the ortho size resets the aspect ratio, so it is set first
+    camera->SetOrthoSize(frame.orthoSize_);
+    camera->SetAspectRatio(frame.aspectRatio_);
+    camera->SetZoom(frame.zoom_);
+    camera->SetOrthographic(frame.orthographic_);
+}
+
+void SceneCapture::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ScenePostUpdate;
+
+    RecordFrame(eventData[P_TIMESTEP].GetFloat());
+}
+
+}
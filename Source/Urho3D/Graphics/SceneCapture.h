@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Object.h"
+#include "../Math/Color.h"
+#include "../Math/Quaternion.h"
+
+namespace Urho3D
+{
+
+class Camera;
+class Deserializer;
+class Node;
+class Scene;
+class Serializer;
+
+/// Frame of a scene capture.
+struct SceneCaptureFrame
+{
+    /// Scene update time step.
+    float timeStep_{};
+    /// Key frame flag. Key frames store a snapshot of the whole scene, other frames store the changes since the previous frame.
+    bool keyFrame_{};
+    /// Camera world position.
+    Vector3 cameraPosition_;
+    /// Camera world rotation.
+    Quaternion cameraRotation_;
+    /// Camera vertical field of view.
+    float fov_{};
+    /// Camera near clip distance.
+    float nearClip_{};
+    /// Camera far clip distance.
+    float farClip_{};
+    /// Camera aspect ratio.
+    float aspectRatio_{};
+    /// Camera orthographic mode view size.
+    float orthoSize_{};
+    /// Camera zoom.
+    float zoom_{};
+    /// Camera orthographic flag.
+    bool orthographic_{};
+    /// Scene snapshot or changes.
+    PODVector<unsigned char> data_;
+};
+
+/// Captured state of a node.
+struct SceneCaptureNodeState
+{
+    /// Position.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+    /// Scale.
+    Vector3 scale_;
+    /// Enabled flag.
+    bool enabled_;
+};
+
+/// Captured state of a component.
+struct SceneCaptureComponentState
+{
+    /// Enabled flag.
+    bool enabled_;
+    /// Light color.
+    Color lightColor_;
+    /// Light brightness.
+    float lightBrightness_;
+    /// Light range.
+    float lightRange_;
+    /// Serialized attributes, when attribute capture is enabled.
+    PODVector<unsigned char> attributes_;
+};
+
+/// Records the state of a scene on each update for deterministic replay, so that a heavy frame of a gameplay session can be benchmarked repeatedly. Each frame stores the camera, the node transforms and enabled states, the drawable enabled states and the light colors and ranges that changed, and optionally the changed attributes of every component. A snapshot of the whole scene is stored as a key frame periodically and whenever nodes or components are added or removed.
+class URHO3D_API SceneCapture : public Object
+{
+    URHO3D_OBJECT(SceneCapture, Object);
+
+public:
+    /// Construct.
+    explicit SceneCapture(Context* context);
+    /// Destruct.
+    ~SceneCapture() override;
+
+    /// Start recording a scene viewed through a camera. Frames are recorded after each scene update. Previous frames are cleared.
+    void StartRecording(Scene* scene, Camera* camera);
+    /// Stop recording.
+    void StopRecording();
+    /// Record a frame manually.
+    void RecordFrame(float timeStep);
+    /// Set interval of key frames in frames. Default 60.
+    void SetKeyFrameInterval(unsigned interval);
+    /// Set whether to record the changed attributes of every component, so that for example animation and physics state replays exactly between key frames. Default false.
+    void SetCaptureAttributes(bool enable);
+    /// Clear the recorded frames.
+    void Clear();
+
+    /// Save the recorded frames. Return true if successful.
+    bool Save(Serializer& dest) const;
+    /// Load frames for replay. Return true if successful.
+    bool Load(Deserializer& source);
+    /// Restore a scene to the state of a frame. Continues from the previously applied frame when possible, otherwise loads the preceding key frame first. Return true if successful.
+    bool ApplyFrame(Scene* scene, unsigned index);
+    /// Forget the previously applied frame, so that the next ApplyFrame() starts from a key frame. Call after the scene has been updated, for example to simulate the same frame repeatedly.
+    void ResetReplay();
+
+    /// Return whether recording.
+    bool IsRecording() const { return recordScene_.NotNull(); }
+    /// Return interval of key frames.
+    unsigned GetKeyFrameInterval() const { return keyFrameInterval_; }
+    /// Return whether the changed attributes of every component are recorded.
+    bool GetCaptureAttributes() const { return captureAttributes_; }
+    /// Return number of frames.
+    unsigned GetNumFrames() const { return frames_.Size(); }
+    /// Return number of key frames.
+    unsigned GetNumKeyFrames() const;
+    /// Return a frame by index, or null if out of range.
+    const SceneCaptureFrame* GetFrame(unsigned index) const { return index < frames_.Size() ? &frames_[index] : nullptr; }
+    /// Return the replay camera, which ApplyFrame() creates as a temporary node of the scene.
+    Camera* GetReplayCamera() const { return replayCamera_; }
+
+private:
+    /// Compare the scene to the previously recorded state. Write the changes to the destination if not null, and update the recorded state.
+    void WriteChanges(Node* node, Serializer* dest, unsigned& numNodes, unsigned& numComponents);
+    /// Return a hash of the scene's node and component IDs, to detect added and removed nodes and components.
+    unsigned GetStructureHash(Node* node) const;
+    /// Apply the changes of a frame.
+    bool ApplyChanges(Scene* scene, const SceneCaptureFrame& frame);
+    /// Apply the camera of a frame, creating the replay camera if necessary.
+    void ApplyCamera(Scene* scene, const SceneCaptureFrame& frame);
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Frames.
+    Vector<SceneCaptureFrame> frames_;
+    /// Scene being recorded.
+    WeakPtr<Scene> recordScene_;
+    /// Camera being recorded.
+    WeakPtr<Camera> recordCamera_;
+    /// Recorded node states by ID.
+    HashMap<unsigned, SceneCaptureNodeState> nodeStates_;
+    /// Recorded component states by ID.
+    HashMap<unsigned, SceneCaptureComponentState> componentStates_;
+    /// Structure hash of the previous frame.
+    unsigned structureHash_{};
+    /// Frames since the previous key frame.
+    unsigned framesSinceKeyFrame_{};
+    /// Key frame interval.
+    unsigned keyFrameInterval_{60};
+    /// Attribute capture flag.
+    bool captureAttributes_{};
+    /// Scene being replayed.
+    WeakPtr<Scene> replayScene_;
+    /// Replay camera.
+    WeakPtr<Camera> replayCamera_;
+    /// Index of the previously applied frame, or M_MAX_UNSIGNED if none.
+    unsigned replayIndex_;
+};
+
+}
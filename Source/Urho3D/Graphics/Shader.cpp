@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/ShaderVariation.h"
 #include "../IO/Deserializer.h"
@@ -93,6 +94,8 @@ bool Shader::BeginLoad(Deserializer& source)
     if (!ProcessSource(shaderCode, source))
         return false;
 
+    CollectIdentifiers(shaderCode);
+
     // Comment out the unneeded shader function
     vsSourceCode_ = shaderCode;
     psSourceCode_ = shaderCode;
@@ -111,11 +114,31 @@ bool Shader::BeginLoad(Deserializer& source)
 
 bool Shader::EndLoad()
 {
-    // If variations had already been created, release them and require recompile
-    for (HashMap<StringHash, SharedPtr<ShaderVariation> >::Iterator i = vsVariations_.Begin(); i != vsVariations_.End(); ++i)
-        i->second_->Release();
-    for (HashMap<StringHash, SharedPtr<ShaderVariation> >::Iterator i = psVariations_.Begin(); i != psVariations_.End(); ++i)
-        i->second_->Release();
+    // If variations had already been created, release them and require recompile. The changed source may reference
+    // defines that were pruned before, so drop the aliases and have the renderer look up its shaders again
+    bool reloaded = false;
+    for (unsigned j = 0; j < 2; ++j)
+    {
+        HashMap<StringHash, SharedPtr<ShaderVariation> >& variations(j == 0 ? vsVariations_ : psVariations_);
+        for (HashMap<StringHash, SharedPtr<ShaderVariation> >::Iterator i = variations.Begin(); i != variations.End();)
+        {
+            if (i->first_ != StringHash(i->second_->GetDefines()))
+                i = variations.Erase(i);
+            else
+            {
+                i->second_->Release();
+                reloaded = true;
+                ++i;
+            }
+        }
+    }
+
+    if (reloaded)
+    {
+        auto* renderer = GetSubsystem<Renderer>();
+        if (renderer)
+            renderer->ReloadShaders();
+    }
 
     return true;
 }
@@ -132,9 +155,9 @@ ShaderVariation* Shader::GetVariation(ShaderType type, const char* defines)
     HashMap<StringHash, SharedPtr<ShaderVariation> >::Iterator i = variations.Find(definesHash);
     if (i == variations.End())
     {
-        // If shader not found, normalize the defines (to prevent duplicates) and check again. In that case make an alias
-        // so that further queries are faster
-        String normalizedDefines = NormalizeDefines(defines);
+        // If shader not found, normalize the defines (to prevent duplicates) and drop the ones the shader does not use,
+        // then check again. In that case make an alias so that further queries are faster
+        String normalizedDefines = PruneDefines(NormalizeDefines(defines));
         StringHash normalizedHash(normalizedDefines);
 
         i = variations.Find(normalizedHash);
@@ -212,6 +235,49 @@ String Shader::NormalizeDefines(const String& defines)
     return String::Joined(definesVec, " ");
 }
 
+String Shader::PruneDefines(const String& defines) const
+{
+    if (identifiers_.Empty())
+        return defines;
+
+    Vector<String> definesVec = defines.Split(' ');
+    for (unsigned i = 0; i < definesVec.Size();)
+    {
+        unsigned valuePos = definesVec[i].Find('=');
+        StringHash nameHash(valuePos != String::NPOS ? definesVec[i].Substring(0, valuePos) : definesVec[i]);
+        if (!identifiers_.Contains(nameHash))
+            definesVec.Erase(i);
+        else
+            ++i;
+    }
+
+    return String::Joined(definesVec, " ");
+}
+
+void Shader::CollectIdentifiers(const String& code)
+{
+    identifiers_.Clear();
+
+    const char* chars = code.CString();
+    unsigned length = code.Length();
+    unsigned start = M_MAX_UNSIGNED;
+    for (unsigned i = 0; i <= length; ++i)
+    {
+        char c = i < length ? chars[i] : ' ';
+        bool identChar = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+        if (identChar)
+        {
+            if (start == M_MAX_UNSIGNED)
+                start = i;
+        }
+        else if (start != M_MAX_UNSIGNED)
+        {
+            identifiers_.Insert(StringHash(code.Substring(start, i - start)));
+            start = M_MAX_UNSIGNED;
+        }
+    }
+}
+
 void Shader::RefreshMemoryUse()
 {
     SetMemoryUse(
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/ArrayPtr.h"
+#include "../Container/HashSet.h"
 #include "../Resource/Resource.h"
 
 namespace Urho3D
@@ -59,11 +60,18 @@ public:
     /// Return the latest timestamp of the shader code and its includes.
     unsigned GetTimeStamp() const { return timeStamp_; }
 
+    /// Return number of unique variations created so far.
+    unsigned GetNumVariations() const { return numVariations_; }
+
 private:
     /// Process source code and include files. Return true if successful.
     bool ProcessSource(String& code, Deserializer& source);
     /// Sort the defines and strip extra spaces to prevent creation of unnecessary duplicate shader variations.
     String NormalizeDefines(const String& defines);
+    /// Remove defines whose name does not appear in the source code, as they can not change the compiled shader.
+    String PruneDefines(const String& defines) const;
+    /// Collect the identifiers of the source code for pruning defines.
+    void CollectIdentifiers(const String& code);
     /// Recalculate the memory used by the shader.
     void RefreshMemoryUse();
 
@@ -75,6 +83,8 @@ private:
     HashMap<StringHash, SharedPtr<ShaderVariation> > vsVariations_;
     /// Pixel shader variations.
     HashMap<StringHash, SharedPtr<ShaderVariation> > psVariations_;
+    /// Identifiers appearing in the source code.
+    HashSet<StringHash> identifiers_;
     /// Source code timestamp.
     unsigned timeStamp_;
     /// Number of unique variations so far.
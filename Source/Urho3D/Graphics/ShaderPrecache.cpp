@@ -22,7 +22,12 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/ShaderPrecache.h"
 #include "../Graphics/ShaderVariation.h"
@@ -35,6 +40,26 @@
 namespace Urho3D
 {
 
+static bool IsSupportedCombination(const String& vsDefines, const String& psDefines)
+{
+    // Check for illegal variations on OpenGL ES
+#ifdef GL_ES_VERSION_2_0
+    if (
+#ifndef __EMSCRIPTEN__
+        vsDefines.Contains("INSTANCED") ||
+#endif
+        (psDefines.Contains("POINTLIGHT") && psDefines.Contains("SHADOW")))
+        return false;
+#endif
+
+    return true;
+}
+
+static void PrepareShaderWork(const WorkItem* item, unsigned threadIndex)
+{
+    reinterpret_cast<ShaderVariation*>(item->aux_)->Prepare();
+}
+
 ShaderPrecache::ShaderPrecache(Context* context, const String& fileName) :
     Object(context),
     fileName_(fileName),
@@ -117,18 +142,12 @@ void ShaderPrecache::LoadShaders(Graphics* graphics, Deserializer& source)
         String vsDefines = shader.GetAttribute("vsdefines");
         String psDefines = shader.GetAttribute("psdefines");
 
-        // Check for illegal variations on OpenGL ES and skip them
-#ifdef GL_ES_VERSION_2_0
-        if (
-#ifndef __EMSCRIPTEN__
-            vsDefines.Contains("INSTANCED") ||
-#endif
-            (psDefines.Contains("POINTLIGHT") && psDefines.Contains("SHADOW")))
+        // Skip illegal variations
+        if (!IsSupportedCombination(vsDefines, psDefines))
         {
             shader = shader.GetNext("shader");
             continue;
         }
-#endif
 
         ShaderVariation* vs = graphics->GetShader(VS, shader.GetAttribute("vs"), vsDefines);
         ShaderVariation* ps = graphics->GetShader(PS, shader.GetAttribute("ps"), psDefines);
@@ -141,4 +160,154 @@ void ShaderPrecache::LoadShaders(Graphics* graphics, Deserializer& source)
     URHO3D_LOGDEBUG("End precaching shaders");
 }
 
+ShaderPrecacheLoader::ShaderPrecacheLoader(Context* context) :
+    Object(context)
+{
+}
+
+ShaderPrecacheLoader::~ShaderPrecacheLoader()
+{
+    CancelPrepare();
+}
+
+bool ShaderPrecacheLoader::Load(Deserializer& source)
+{
+    CancelPrepare();
+    combinations_.Clear();
+    numLoaded_ = 0;
+
+    auto* graphics = GetSubsystem<Graphics>();
+    if (!graphics)
+        return false;
+
+    XMLFile xmlFile(context_);
+    if (!xmlFile.Load(source))
+        return false;
+
+    // Look up the shader variations in the main thread, as it loads the shader source files
+    XMLElement shader = xmlFile.GetRoot().GetChild("shader");
+    while (shader)
+    {
+        String vsDefines = shader.GetAttribute("vsdefines");
+        String psDefines = shader.GetAttribute("psdefines");
+
+        if (IsSupportedCombination(vsDefines, psDefines))
+        {
+            ShaderVariation* vs = graphics->GetShader(VS, shader.GetAttribute("vs"), vsDefines);
+            ShaderVariation* ps = graphics->GetShader(PS, shader.GetAttribute("ps"), psDefines);
+            if (vs && ps)
+                combinations_.Push(MakePair(SharedPtr<ShaderVariation>(vs), SharedPtr<ShaderVariation>(ps)));
+        }
+
+        shader = shader.GetNext("shader");
+    }
+
+    // Queue the bytecode compiles of the variations not yet created. OpenGL compiles in the main thread only
+#ifndef URHO3D_OPENGL
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue)
+    {
+        for (unsigned i = 0; i < combinations_.Size(); ++i)
+        {
+            ShaderVariation* variations[] = {combinations_[i].first_, combinations_[i].second_};
+            for (ShaderVariation* variation : variations)
+            {
+                if (variation->GetGPUObject() || prepareItems_.Contains(variation))
+                    continue;
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = 0;
+                item->workClass_ = WORK_BACKGROUND;
+                item->workFunction_ = PrepareShaderWork;
+                item->name_ = "PrepareShaderWork";
+                item->aux_ = variation;
+                prepareItems_[variation] = item;
+                queue->AddWorkItem(item);
+            }
+        }
+    }
+#endif
+
+    URHO3D_LOGDEBUGF("Begin loading %u shader combinations", combinations_.Size());
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(ShaderPrecacheLoader, HandleBeginFrame));
+    return true;
+}
+
+void ShaderPrecacheLoader::SetMaxFrameTime(int ms)
+{
+    maxFrameTime_ = Max(ms, 1);
+}
+
+bool ShaderPrecacheLoader::IsPrepared(ShaderVariation* variation) const
+{
+    HashMap<ShaderVariation*, SharedPtr<WorkItem> >::ConstIterator i = prepareItems_.Find(variation);
+    return i == prepareItems_.End() || i->second_->completed_;
+}
+
+void ShaderPrecacheLoader::CancelPrepare()
+{
+    // The work items refer to the shader variations, so they must not outlive them
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (HashMap<ShaderVariation*, SharedPtr<WorkItem> >::Iterator i = prepareItems_.Begin(); i != prepareItems_.End(); ++i)
+    {
+        if (!i->second_->completed_ && !(queue && queue->RemoveWorkItem(i->second_)))
+        {
+            while (!i->second_->completed_)
+                Time::Sleep(0);
+        }
+    }
+    prepareItems_.Clear();
+}
+
+void ShaderPrecacheLoader::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    auto* graphics = GetSubsystem<Graphics>();
+    if (!graphics || graphics->IsDeviceLost())
+        return;
+
+    URHO3D_PROFILE(LoadPrecachedShaders);
+
+    HiresTimer timer;
+    unsigned oldNumLoaded = numLoaded_;
+
+    // Create and link the combinations in order, waiting for the worker threads if necessary
+    while (numLoaded_ < combinations_.Size() && timer.GetUSec(false) < maxFrameTime_ * 1000)
+    {
+        ShaderVariation* vs = combinations_[numLoaded_].first_;
+        ShaderVariation* ps = combinations_[numLoaded_].second_;
+        if (!IsPrepared(vs) || !IsPrepared(ps))
+            break;
+
+        // Set the shaders active to actually create them
+        graphics->SetShaders(vs, ps);
+        ++numLoaded_;
+    }
+
+    if (numLoaded_ == oldNumLoaded)
+        return;
+
+    graphics->SetShaders(nullptr, nullptr);
+
+    using namespace ShaderPrecacheProgress;
+
+    VariantMap& progressEventData = GetEventDataMap();
+    progressEventData[P_LOADED] = numLoaded_;
+    progressEventData[P_TOTAL] = combinations_.Size();
+    SendEvent(E_SHADERPRECACHEPROGRESS, progressEventData);
+
+    if (IsFinished())
+    {
+        URHO3D_LOGDEBUG("End loading shader combinations");
+        UnsubscribeFromEvent(E_BEGINFRAME);
+        prepareItems_.Clear();
+        // Keep the counts but release the references to the shader variations
+        for (unsigned i = 0; i < combinations_.Size(); ++i)
+        {
+            combinations_[i].first_.Reset();
+            combinations_[i].second_.Reset();
+        }
+        SendEvent(E_SHADERPRECACHEFINISHED);
+    }
+}
+
 }
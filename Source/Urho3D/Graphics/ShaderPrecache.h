@@ -31,6 +31,7 @@ namespace Urho3D
 
 class Graphics;
 class ShaderVariation;
+struct WorkItem;
 
 /// Utility class for collecting used shader combinations during runtime for precaching.
 class URHO3D_API ShaderPrecache : public Object
@@ -60,4 +61,49 @@ private:
     HashSet<String> usedCombinations_;
 };
 
+/// Utility class for loading the shader combinations of a ShaderPrecache XML file over several frames. On Direct3D the shader bytecode is loaded or compiled in worker threads, after which the main thread creates the shaders and links the combinations within a time budget per frame.
+class URHO3D_API ShaderPrecacheLoader : public Object
+{
+    URHO3D_OBJECT(ShaderPrecacheLoader, Object);
+
+public:
+    /// Construct.
+    explicit ShaderPrecacheLoader(Context* context);
+    /// Destruct. Cancel or finish the worker thread compiles in progress.
+    ~ShaderPrecacheLoader() override;
+
+    /// Begin loading the shader combinations from an XML file. Progress is reported with the ShaderPrecacheProgress event, and the ShaderPrecacheFinished event is sent when done. Return true if successful.
+    bool Load(Deserializer& source);
+    /// Set maximum time in milliseconds to spend creating shaders in the main thread each frame. Default 5.
+    void SetMaxFrameTime(int ms);
+
+    /// Return maximum time in milliseconds to spend in the main thread each frame.
+    int GetMaxFrameTime() const { return maxFrameTime_; }
+    /// Return number of shader combinations to load.
+    unsigned GetNumCombinations() const { return combinations_.Size(); }
+    /// Return number of shader combinations loaded so far.
+    unsigned GetNumLoaded() const { return numLoaded_; }
+    /// Return loading progress from 0 to 1.
+    float GetProgress() const { return combinations_.Size() ? (float)numLoaded_ / (float)combinations_.Size() : 1.0f; }
+    /// Return whether all shader combinations have been loaded.
+    bool IsFinished() const { return numLoaded_ == combinations_.Size(); }
+
+private:
+    /// Return whether the bytecode of a shader variation has been prepared.
+    bool IsPrepared(ShaderVariation* variation) const;
+    /// Cancel or finish the worker thread compiles in progress.
+    void CancelPrepare();
+    /// Handle frame begin event. Create the prepared shaders.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Shader combinations to load.
+    Vector<Pair<SharedPtr<ShaderVariation>, SharedPtr<ShaderVariation> > > combinations_;
+    /// Worker thread compiles of the shader variations.
+    HashMap<ShaderVariation*, SharedPtr<WorkItem> > prepareItems_;
+    /// Number of shader combinations loaded.
+    unsigned numLoaded_{};
+    /// Maximum time in milliseconds per frame.
+    int maxFrameTime_{5};
+};
+
 }
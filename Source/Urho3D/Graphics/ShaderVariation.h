@@ -25,6 +25,7 @@
 #include "../Container/HashMap.h"
 #include "../Container/RefCounted.h"
 #include "../Container/ArrayPtr.h"
+#include "../Core/Mutex.h"
 #include "../Graphics/GPUObject.h"
 #include "../Graphics/GraphicsDefs.h"
 
@@ -93,6 +94,8 @@ public:
 
     /// Compile the shader. Return true if successful.
     bool Create();
+    /// Load or compile the shader bytecode without creating the GPU object, so that Create() only needs to create it. May be called from a worker thread. Does nothing on OpenGL, where compiling requires the GL context. Return true if successful.
+    bool Prepare();
     /// Set name.
     void SetName(const String& name);
     /// Set defines.
@@ -141,6 +144,8 @@ public:
     static const char* elementSemanticNames[];
 
 private:
+    /// Load bytecode from the shader cache, or compile and cache it. Called with the prepare mutex locked. Return true if successful.
+    bool PrepareByteCode();
     /// Load bytecode from a file. Return true if successful.
     bool LoadByteCode(const String& binaryShaderName);
     /// Compile from source. Return true if successful.
@@ -174,6 +179,10 @@ private:
     String definesClipPlane_;
     /// Shader compile error string.
     String compilerOutput_;
+    /// Mutex for preparing the bytecode in a worker thread. Not used on OpenGL.
+    Mutex prepareMutex_;
+    /// Bytecode prepared flag. Not used on OpenGL.
+    bool prepared_{};
 };
 
 }
@@ -28,6 +28,7 @@
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
+#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/OctreeQuery.h"
@@ -35,6 +36,7 @@
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
+#include "../Math/Sphere.h"
 #include "../Resource/ResourceEvents.h"
 
 #include "../DebugNew.h"
@@ -47,7 +49,11 @@ extern const char* GEOMETRY_CATEGORY;
 StaticModel::StaticModel(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY),
     occlusionLodLevel_(M_MAX_UNSIGNED),
-    materialsAttr_(Material::GetTypeStatic())
+    materialsAttr_(Material::GetTypeStatic()),
+    meshletFrameNumber_(M_MAX_UNSIGNED),
+    numVisibleMeshlets_(0),
+    meshletCulling_(false),
+    meshletsDirty_(false)
 {
 }
 
@@ -69,6 +75,7 @@ void StaticModel::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
     URHO3D_ATTRIBUTE("Occlusion LOD Level", int, occlusionLodLevel_, M_MAX_UNSIGNED, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Meshlet Culling", GetMeshletCulling, SetMeshletCulling, bool, false, AM_DEFAULT);
 }
 
 void StaticModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
@@ -97,12 +104,12 @@ void StaticModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQuer
 
             for (unsigned i = 0; i < batches_.Size(); ++i)
             {
-                Geometry* geometry = batches_[i].geometry_;
+                Geometry* geometry = geometries_[i][geometryData_[i].lodLevel_];
                 if (geometry)
                 {
                     Vector3 geometryNormal;
-                    float geometryDistance = level == RAY_TRIANGLE ? geometry->GetHitDistance(localRay, &geometryNormal) :
-                        geometry->GetHitDistance(localRay, &geometryNormal, &geometryUV);
+                    float geometryDistance = level == RAY_TRIANGLE ? geometry->GetStaticHitDistance(localRay, &geometryNormal) :
+                        geometry->GetStaticHitDistance(localRay, &geometryNormal, &geometryUV);
                     if (geometryDistance < query.maxDistance_ && geometryDistance < distance)
                     {
                         distance = geometryDistance;
@@ -151,6 +158,84 @@ void StaticModel::UpdateBatches(const FrameInfo& frame)
         lodDistance_ = newLodDistance;
         CalculateLodLevels();
     }
+
+    // Cull the meshlets once per frame, as the compacted index data is uploaded only once. Later views in the same frame use
+    // the meshlets visible to the first camera. Culling is skipped for shadow casters, as they are drawn from the lights too
+    if (meshletCulling_ && !castShadows_)
+    {
+        if (frame.frameNumber_ != meshletFrameNumber_)
+        {
+            meshletFrameNumber_ = frame.frameNumber_;
+            CullMeshlets(frame.camera_);
+        }
+        ApplyMeshletGeometries();
+    }
+    else if (!meshletBatches_.Empty())
+    {
+        meshletBatches_.Clear();
+        meshletsDirty_ = false;
+        ApplyMeshletGeometries();
+    }
+}
+
+void StaticModel::UpdateGeometry(const FrameInfo& frame)
+{
+    URHO3D_PROFILE(UploadMeshlets);
+
+    PODVector<unsigned char> indexData;
+
+    for (unsigned i = 0; i < meshletBatches_.Size(); ++i)
+    {
+        MeshletBatch& meshletBatch = meshletBatches_[i];
+        if (!meshletBatch.geometry_ || (!meshletBatch.dirty_ && !meshletBatch.indexBuffer_->IsDataLost()))
+            continue;
+
+        Geometry* source = meshletBatch.source_;
+        IndexBuffer* sourceBuffer = source->GetIndexBuffer();
+        const unsigned char* sourceData = sourceBuffer->GetShadowData();
+        unsigned indexSize = sourceBuffer->GetIndexSize();
+
+        unsigned indexCount = 0;
+        for (unsigned j = 1; j < meshletBatch.ranges_.Size(); j += 2)
+            indexCount += meshletBatch.ranges_[j];
+        indexData.Resize(indexCount * indexSize);
+
+        unsigned char* dest = indexData.Buffer();
+        for (unsigned j = 0; j < meshletBatch.ranges_.Size(); j += 2)
+        {
+            unsigned rangeSize = meshletBatch.ranges_[j + 1] * indexSize;
+            memcpy(dest, sourceData + meshletBatch.ranges_[j] * indexSize, rangeSize);
+            dest += rangeSize;
+        }
+
+        IndexBuffer* indexBuffer = meshletBatch.indexBuffer_;
+        if (indexBuffer->GetIndexCount() < indexCount || indexBuffer->GetIndexSize() != indexSize)
+            indexBuffer->SetSize(source->GetIndexCount(), indexSize == sizeof(unsigned), true);
+        if (indexCount)
+            indexBuffer->SetDataRange(indexData.Buffer(), 0, indexCount, true);
+        else
+            indexBuffer->ClearDataLost();
+
+        meshletBatch.geometry_->SetDrawRange(source->GetPrimitiveType(), 0, indexCount, source->GetVertexStart(),
+            source->GetVertexCount(), false);
+        meshletBatch.dirty_ = false;
+    }
+
+    meshletsDirty_ = false;
+}
+
+UpdateGeometryType StaticModel::GetUpdateGeometryType()
+{
+    if (meshletsDirty_)
+        return UPDATE_MAIN_THREAD;
+
+    for (unsigned i = 0; i < meshletBatches_.Size(); ++i)
+    {
+        if (meshletBatches_[i].indexBuffer_ && meshletBatches_[i].indexBuffer_->IsDataLost())
+            return UPDATE_MAIN_THREAD;
+    }
+
+    return UPDATE_NONE;
 }
 
 Geometry* StaticModel::GetLodGeometry(unsigned batchIndex, unsigned level)
@@ -158,11 +243,12 @@ Geometry* StaticModel::GetLodGeometry(unsigned batchIndex, unsigned level)
     if (batchIndex >= geometries_.Size())
         return nullptr;
 
-    // If level is out of range, use visible geometry
+    // If level is out of range, use the current LOD geometry rather than the batch geometry, which may hold only the visible
+    // meshlets
     if (level < geometries_[batchIndex].Size())
         return geometries_[batchIndex][level];
     else
-        return batches_[batchIndex].geometry_;
+        return geometries_[batchIndex][geometryData_[batchIndex].lodLevel_];
 }
 
 unsigned StaticModel::GetNumOccluderTriangles()
@@ -299,6 +385,12 @@ void StaticModel::SetOcclusionLodLevel(unsigned level)
     MarkNetworkUpdate();
 }
 
+void StaticModel::SetMeshletCulling(bool enable)
+{
+    meshletCulling_ = enable;
+    MarkNetworkUpdate();
+}
+
 void StaticModel::ApplyMaterialList(const String& fileName)
 {
     String useFileName = fileName;
@@ -345,7 +437,7 @@ bool StaticModel::IsInsideLocal(const Vector3& point) const
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
     {
-        Geometry* geometry = batches_[i].geometry_;
+        Geometry* geometry = geometries_[i][geometryData_[i].lodLevel_];
         if (geometry)
         {
             if (geometry->IsInside(localRay))
@@ -367,6 +459,8 @@ void StaticModel::SetNumGeometries(unsigned num)
     batches_.Resize(num);
     geometries_.Resize(num);
     geometryData_.Resize(num);
+    meshletBatches_.Clear();
+    meshletsDirty_ = false;
     ResetLodLevels();
 }
 
@@ -443,6 +537,126 @@ void StaticModel::CalculateLodLevels()
     }
 }
 
+void StaticModel::CullMeshlets(Camera* camera)
+{
+    URHO3D_PROFILE(CullMeshlets);
+
+    // Cull in the model's local space. The normal cones stay valid only under uniform positive scale
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+    Frustum frustum = camera->GetFrustum().Transformed(inverse);
+    Vector3 cameraPos = inverse * camera->GetNode()->GetWorldPosition();
+    Vector3 cameraDir = (inverse * Vector4(camera->GetNode()->GetWorldDirection(), 0.0f)).Normalized();
+    bool orthographic = camera->IsOrthographic();
+    Vector3 worldScale = node_->GetWorldScale();
+    bool cullCones = worldScale.x_ > 0.0f && Equals(worldScale.x_, worldScale.y_) && Equals(worldScale.x_, worldScale.z_);
+
+    PODVector<unsigned> ranges;
+    meshletBatches_.Resize(batches_.Size());
+    numVisibleMeshlets_ = 0;
+
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        MeshletBatch& meshletBatch = meshletBatches_[i];
+        Geometry* source = geometries_[i][geometryData_[i].lodLevel_];
+        if (meshletBatch.source_ != source)
+        {
+            meshletBatch.source_ = source;
+            meshletBatch.ranges_.Clear();
+            meshletBatch.dirty_ = true;
+        }
+
+        // Geometries without meshlets or CPU-side index data are drawn in full
+        if (!source || !source->GetNumMeshlets() || !source->GetIndexBuffer() || !source->GetIndexBuffer()->GetShadowData())
+        {
+            meshletBatch.geometry_.Reset();
+            meshletBatch.indexBuffer_.Reset();
+            meshletBatch.dirty_ = false;
+            continue;
+        }
+
+        // Front faces are clockwise unless the material culls clockwise faces
+        Material* material = batches_[i].material_;
+        CullMode cullMode = material ? material->GetCullMode() : CULL_CCW;
+        float coneSign = cullMode == CULL_CW ? -1.0f : 1.0f;
+        bool cullBackfaces = cullCones && cullMode != CULL_NONE;
+
+        const PODVector<Meshlet>& meshlets = source->GetMeshlets();
+        ranges.Clear();
+        for (unsigned j = 0; j < meshlets.Size(); ++j)
+        {
+            const Meshlet& meshlet = meshlets[j];
+            if (!frustum.IsInsideFast(Sphere(meshlet.center_, meshlet.radius_)))
+                continue;
+
+            if (cullBackfaces)
+            {
+                Vector3 axis = coneSign * meshlet.coneAxis_;
+                if (orthographic)
+                {
+                    if (cameraDir.DotProduct(axis) > meshlet.coneCutoff_)
+                        continue;
+                }
+                else
+                {
+                    Vector3 offset = meshlet.center_ - cameraPos;
+                    if (offset.DotProduct(axis) > meshlet.coneCutoff_ * offset.Length() + meshlet.radius_)
+                        continue;
+                }
+            }
+
+            // Merge with the previous range when contiguous
+            ++numVisibleMeshlets_;
+            if (ranges.Size() && ranges[ranges.Size() - 2] + ranges.Back() == meshlet.indexStart_)
+                ranges.Back() += meshlet.indexCount_;
+            else
+            {
+                ranges.Push(meshlet.indexStart_);
+                ranges.Push(meshlet.indexCount_);
+            }
+        }
+
+        // When all is visible, draw the source geometry as is
+        if (ranges.Size() == 2 && ranges[0] == source->GetIndexStart() && ranges[1] == source->GetIndexCount())
+        {
+            meshletBatch.geometry_.Reset();
+            meshletBatch.indexBuffer_.Reset();
+            meshletBatch.ranges_ = ranges;
+            meshletBatch.dirty_ = false;
+            continue;
+        }
+
+        if (!meshletBatch.geometry_)
+        {
+            meshletBatch.indexBuffer_ = new IndexBuffer(context_);
+            meshletBatch.geometry_ = new Geometry(context_);
+            meshletBatch.geometry_->SetNumVertexBuffers(source->GetNumVertexBuffers());
+            for (unsigned j = 0; j < source->GetNumVertexBuffers(); ++j)
+                meshletBatch.geometry_->SetVertexBuffer(j, source->GetVertexBuffer(j));
+            meshletBatch.geometry_->SetIndexBuffer(meshletBatch.indexBuffer_);
+            meshletBatch.dirty_ = true;
+        }
+
+        if (meshletBatch.dirty_ || ranges != meshletBatch.ranges_)
+        {
+            meshletBatch.ranges_ = ranges;
+            meshletBatch.dirty_ = true;
+            meshletsDirty_ = true;
+        }
+    }
+}
+
+void StaticModel::ApplyMeshletGeometries()
+{
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+    {
+        Geometry* lodGeometry = geometries_[i][geometryData_[i].lodLevel_];
+        if (i < meshletBatches_.Size() && meshletBatches_[i].source_ == lodGeometry && meshletBatches_[i].geometry_)
+            batches_[i].geometry_ = meshletBatches_[i].ranges_.Empty() ? nullptr : meshletBatches_[i].geometry_.Get();
+        else
+            batches_[i].geometry_ = lodGeometry;
+    }
+}
+
 void StaticModel::HandleModelReloadFinished(StringHash eventType, VariantMap& eventData)
 {
     Model* currentModel = model_;
@@ -27,6 +27,7 @@
 namespace Urho3D
 {
 
+class IndexBuffer;
 class Model;
 
 /// Static model per-geometry extra data.
@@ -42,6 +43,7 @@ struct StaticModelGeometryData
 class URHO3D_API StaticModel : public Drawable
 {
     URHO3D_OBJECT(StaticModel, Drawable);
+    URHO3D_POOLED_OBJECT(StaticModel);
 
 public:
     /// Construct.
@@ -57,6 +59,10 @@ public:
     void UpdateBatches(const FrameInfo& frame) override;
     /// Return the geometry for a specific LOD level.
     Geometry* GetLodGeometry(unsigned batchIndex, unsigned level) override;
+    /// Upload the index data of the visible meshlets.
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
     /// Return number of occlusion geometry triangles.
     unsigned GetNumOccluderTriangles() override;
     /// Draw to occlusion buffer. Return true if did not run out of triangles.
@@ -70,6 +76,8 @@ public:
     virtual bool SetMaterial(unsigned index, Material* material);
     /// Set occlusion LOD level. By default (M_MAX_UNSIGNED) same as visible.
     void SetOcclusionLodLevel(unsigned level);
+    /// Set whether to cull the meshlets of the geometries against the view frustum and by their normal cones, and draw only the visible ones. Has no effect on geometries without meshlets or when casting shadows.
+    void SetMeshletCulling(bool enable);
     /// Apply default materials from a material list file. If filename is empty (default), the model's resource name with extension .txt will be used.
     void ApplyMaterialList(const String& fileName = String::EMPTY);
 
@@ -87,6 +95,12 @@ public:
     /// Return occlusion LOD level.
     unsigned GetOcclusionLodLevel() const { return occlusionLodLevel_; }
 
+    /// Return whether meshlet culling is enabled.
+    bool GetMeshletCulling() const { return meshletCulling_; }
+
+    /// Return number of meshlets drawn in the last culled frame.
+    unsigned GetNumVisibleMeshlets() const { return numVisibleMeshlets_; }
+
     /// Determines if the given world space point is within the model geometry.
     bool IsInside(const Vector3& point) const;
     /// Determines if the given local space point is within the model geometry.
@@ -125,8 +139,38 @@ protected:
     mutable ResourceRefList materialsAttr_;
 
 private:
+    /// Meshlet culling state of a batch.
+    struct MeshletBatch
+    {
+        /// LOD geometry the meshlets were culled from.
+        Geometry* source_{};
+        /// Geometry drawing the compacted index data.
+        SharedPtr<Geometry> geometry_;
+        /// Index buffer holding the compacted index data.
+        SharedPtr<IndexBuffer> indexBuffer_;
+        /// Visible index ranges of the source geometry as start and count pairs.
+        PODVector<unsigned> ranges_;
+        /// Index data needs to be uploaded.
+        bool dirty_{};
+    };
+
+    /// Cull the meshlets of the current LOD geometries against a camera.
+    void CullMeshlets(Camera* camera);
+    /// Set the batch geometries to the culled or the current LOD geometries.
+    void ApplyMeshletGeometries();
     /// Handle model reload finished.
     void HandleModelReloadFinished(StringHash eventType, VariantMap& eventData);
+
+    /// Meshlet culling state per batch.
+    Vector<MeshletBatch> meshletBatches_;
+    /// Frame number of the last meshlet culling.
+    unsigned meshletFrameNumber_;
+    /// Number of meshlets drawn in the last culled frame.
+    unsigned numVisibleMeshlets_;
+    /// Meshlet culling flag.
+    bool meshletCulling_;
+    /// Compacted index data needs to be uploaded.
+    bool meshletsDirty_;
 };
 
 }
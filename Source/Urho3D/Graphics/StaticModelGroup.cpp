@@ -26,9 +26,11 @@
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/OctreeQuery.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Scene/Scene.h"
@@ -60,6 +62,7 @@ void StaticModelGroup::RegisterObject(Context* context)
     context->RegisterFactory<StaticModelGroup>(GEOMETRY_CATEGORY);
 
     URHO3D_COPY_BASE_ATTRIBUTES(StaticModel);
+    URHO3D_ACCESSOR_ATTRIBUTE("Static Instancing", GetStaticInstancing, SetStaticInstancing, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Instance Nodes", GetNodeIDsAttr, SetNodeIDsAttr,
         VariantVector, Variant::emptyVariantVector, AM_DEFAULT | AM_NODEIDVECTOR)
         .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, instanceNodesStructureElementNames);
@@ -141,7 +144,7 @@ void StaticModelGroup::ProcessRayQuery(const RayOctreeQuery& query, PODVector<Ra
                     if (geometry)
                     {
                         Vector3 geometryNormal;
-                        float geometryDistance = geometry->GetHitDistance(localRay, &geometryNormal);
+                        float geometryDistance = geometry->GetStaticHitDistance(localRay, &geometryNormal);
                         if (geometryDistance < query.maxDistance_ && geometryDistance < distance)
                         {
                             distance = geometryDistance;
@@ -172,6 +175,7 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
     const BoundingBox& worldBoundingBox = GetWorldBoundingBox();
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
     distance_ = frame.camera_->GetDistance(worldBoundingBox.Center());
+    VertexBuffer* instancingBuffer = numWorldTransforms_ ? instancingBuffer_.Get() : nullptr;
 
     if (batches_.Size() > 1)
     {
@@ -180,6 +184,7 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
             batches_[i].distance_ = frame.camera_->GetDistance(worldTransform * geometryData_[i].center_);
             batches_[i].worldTransform_ = numWorldTransforms_ ? &worldTransforms_[0] : &Matrix3x4::IDENTITY;
             batches_[i].numWorldTransforms_ = numWorldTransforms_;
+            batches_[i].instancingBuffer_ = instancingBuffer;
         }
     }
     else if (batches_.Size() == 1)
@@ -187,6 +192,7 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
         batches_[0].distance_ = distance_;
         batches_[0].worldTransform_ = numWorldTransforms_ ? &worldTransforms_[0] : &Matrix3x4::IDENTITY;
         batches_[0].numWorldTransforms_ = numWorldTransforms_;
+        batches_[0].instancingBuffer_ = instancingBuffer;
     }
 
     float scale = worldBoundingBox.Size().DotProduct(DOT_SCALE);
@@ -199,6 +205,20 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
     }
 }
 
+void StaticModelGroup::UpdateGeometry(const FrameInfo& frame)
+{
+    if (instancingBuffer_ && (instancingBufferDirty_ || instancingBuffer_->IsDataLost()))
+        UpdateInstancingBuffer();
+}
+
+UpdateGeometryType StaticModelGroup::GetUpdateGeometryType()
+{
+    if (instancingBuffer_ && (instancingBufferDirty_ || instancingBuffer_->IsDataLost()))
+        return UPDATE_MAIN_THREAD;
+    else
+        return UPDATE_NONE;
+}
+
 unsigned StaticModelGroup::GetNumOccluderTriangles()
 {
     // Make sure instance transforms are up-to-date
@@ -313,6 +333,26 @@ void StaticModelGroup::RemoveAllInstanceNodes()
     UpdateNumTransforms();
 }
 
+void StaticModelGroup::SetStaticInstancing(bool enable)
+{
+    if (enable == staticInstancing_)
+        return;
+
+    staticInstancing_ = enable;
+    uploadedTransforms_.Clear();
+
+    auto* graphics = GetSubsystem<Graphics>();
+    if (enable && graphics && graphics->GetInstancingSupport())
+    {
+        instancingBuffer_ = new VertexBuffer(context_);
+        instancingBufferDirty_ = true;
+    }
+    else
+        instancingBuffer_.Reset();
+
+    MarkNetworkUpdate();
+}
+
 Node* StaticModelGroup::GetInstanceNode(unsigned index) const
 {
     return index < instanceNodes_.Size() ? instanceNodes_[index] : nullptr;
@@ -388,6 +428,69 @@ void StaticModelGroup::OnWorldBoundingBoxUpdate()
     // Store the amount of valid instances we found instead of resizing worldTransforms_. This is because this function may be
     // called from multiple worker threads simultaneously
     numWorldTransforms_ = index;
+    instancingBufferDirty_ = true;
+}
+
+void StaticModelGroup::UpdateInstancingBuffer()
+{
+    instancingBufferDirty_ = false;
+
+    // Use the same vertex layout as the shared instancing buffer, as the instancing shaders expect it
+    auto* renderer = GetSubsystem<Renderer>();
+    VertexBuffer* sharedBuffer = renderer ? renderer->GetInstancingBuffer() : nullptr;
+    if (!sharedBuffer)
+        return;
+
+    const PODVector<VertexElement>& elements = sharedBuffer->GetElements();
+    if (instancingBuffer_->GetVertexCount() < numWorldTransforms_ || instancingBuffer_->GetElements() != elements)
+    {
+        instancingBuffer_->SetSize(worldTransforms_.Size(), elements);
+        uploadedTransforms_.Clear();
+    }
+    if (instancingBuffer_->IsDataLost())
+    {
+        uploadedTransforms_.Clear();
+        instancingBuffer_->ClearDataLost();
+    }
+
+    // Find the range of transforms that differ from what has been uploaded
+    unsigned first = M_MAX_UNSIGNED;
+    unsigned last = 0;
+    unsigned numCompared = Min(uploadedTransforms_.Size(), numWorldTransforms_);
+    for (unsigned i = 0; i < numCompared; ++i)
+    {
+        if (uploadedTransforms_[i] != worldTransforms_[i])
+        {
+            first = Min(first, i);
+            last = i;
+        }
+    }
+    if (numWorldTransforms_ > numCompared)
+    {
+        first = Min(first, numCompared);
+        last = numWorldTransforms_ - 1;
+    }
+    uploadedTransforms_.Resize(numWorldTransforms_);
+
+    if (first > last)
+        return;
+
+    unsigned count = last - first + 1;
+    for (unsigned i = first; i <= last; ++i)
+        uploadedTransforms_[i] = worldTransforms_[i];
+
+    unsigned vertexSize = instancingBuffer_->GetVertexSize();
+    if (vertexSize == sizeof(Matrix3x4))
+        instancingBuffer_->SetDataRange(&worldTransforms_[first], first, count);
+    else
+    {
+        // Leave extra per-instance elements zeroed
+        PODVector<unsigned char> data(count * vertexSize);
+        memset(data.Buffer(), 0, data.Size());
+        for (unsigned i = 0; i < count; ++i)
+            memcpy(&data[i * vertexSize], &worldTransforms_[first + i], sizeof(Matrix3x4));
+        instancingBuffer_->SetDataRange(data.Buffer(), first, count);
+    }
 }
 
 void StaticModelGroup::UpdateNumTransforms()
@@ -46,6 +46,10 @@ public:
     void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results) override;
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
     void UpdateBatches(const FrameInfo& frame) override;
+    /// Prepare geometry for rendering. Uploads changed instance transforms when using static instancing.
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
     /// Return number of occlusion geometry triangles.
     unsigned GetNumOccluderTriangles() override;
     /// Draw to occlusion buffer. Return true if did not run out of triangles.
@@ -57,6 +61,8 @@ public:
     void RemoveInstanceNode(Node* node);
     /// Remove all instance scene nodes.
     void RemoveAllInstanceNodes();
+    /// Set whether to keep the instance transforms in a persistent GPU buffer, re-uploading only the changed range when instance nodes move. Recommended for large groups where most instances are stationary.
+    void SetStaticInstancing(bool enable);
 
     /// Return number of instance nodes.
     unsigned GetNumInstanceNodes() const { return instanceNodes_.Size(); }
@@ -64,6 +70,9 @@ public:
     /// Return instance node by index.
     Node* GetInstanceNode(unsigned index) const;
 
+    /// Return whether uses a persistent GPU buffer for the instance transforms.
+    bool GetStaticInstancing() const { return staticInstancing_; }
+
     /// Set node IDs attribute.
     void SetNodeIDsAttr(const VariantVector& value);
 
@@ -81,11 +90,17 @@ private:
     void UpdateNumTransforms();
     /// Update node IDs attribute from the actual nodes.
     void UpdateNodeIDs() const;
+    /// Upload changed instance transforms to the persistent instancing buffer.
+    void UpdateInstancingBuffer();
 
     /// Instance nodes.
     Vector<WeakPtr<Node> > instanceNodes_;
     /// World transforms of valid (existing and visible) instances.
     PODVector<Matrix3x4> worldTransforms_;
+    /// Persistent instancing buffer for static instancing.
+    SharedPtr<VertexBuffer> instancingBuffer_;
+    /// Instance transforms currently held in the persistent instancing buffer.
+    PODVector<Matrix3x4> uploadedTransforms_;
     /// IDs of instance nodes for serialization.
     mutable VariantVector nodeIDsAttr_;
     /// Number of valid instance node transforms.
@@ -94,6 +109,10 @@ private:
     mutable bool nodesDirty_{};
     /// Whether nodes have been manipulated by the API and node ID attribute should be refreshed.
     mutable bool nodeIDsDirty_{};
+    /// Static instancing flag.
+    bool staticInstancing_{};
+    /// Whether instance transforms have changed since the last instancing buffer upload.
+    bool instancingBufferDirty_{};
 };
 
 }
@@ -23,13 +23,17 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Octree.h"
 #include "../Graphics/Terrain.h"
+#include "../Graphics/TerrainClipmap.h"
 #include "../Graphics/TerrainPatch.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
@@ -77,6 +81,12 @@ inline void GrowUpdateRegion(IntRect& updateRegion, int x, int y)
     }
 }
 
+void CalculatePatchGeometryWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* terrain = reinterpret_cast<Terrain*>(item->aux_);
+    terrain->CalculatePatchUpdate(*reinterpret_cast<Terrain::PatchGeometryUpdate*>(item->start_));
+}
+
 Terrain::Terrain(Context* context) :
     Component(context),
     indexBuffer_(new IndexBuffer(context)),
@@ -93,6 +103,7 @@ Terrain::Terrain(Context* context) :
     maxLodLevels_(MAX_LOD_LEVELS),
     occlusionLodLevel_(M_MAX_UNSIGNED),
     smoothing_(false),
+    clipmap_(false),
     visible_(true),
     castShadows_(false),
     occluder_(false),
@@ -115,7 +126,20 @@ Terrain::Terrain(Context* context) :
     indexBuffer_->SetShadowed(true);
 }
 
-Terrain::~Terrain() = default;
+Terrain::~Terrain()
+{
+    // Worker threads may still be reading the height data
+    if (!patchUpdates_.Empty())
+    {
+        auto* queue = GetSubsystem<WorkQueue>();
+        for (unsigned i = 0; i < patchUpdates_.Size(); ++i)
+        {
+            if (patchUpdates_[i].workItem_)
+                queue->RemoveWorkItem(patchUpdates_[i].workItem_);
+        }
+        queue->Complete(0);
+    }
+}
 
 void Terrain::RegisterObject(Context* context)
 {
@@ -134,6 +158,7 @@ void Terrain::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Patch Size", GetPatchSize, SetPatchSizeAttr, int, DEFAULT_PATCH_SIZE, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Max LOD Levels", GetMaxLodLevels, SetMaxLodLevelsAttr, unsigned, MAX_LOD_LEVELS, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Smooth Height Map", bool, smoothing_, MarkTerrainDirty, false, AM_DEFAULT);
+    URHO3D_ATTRIBUTE_EX("Use Clipmap", bool, clipmap_, MarkTerrainDirty, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Is Occluder", IsOccluder, SetOccluder, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Cast Shadows", GetCastShadows, SetCastShadows, bool, false, AM_DEFAULT);
@@ -178,6 +203,9 @@ void Terrain::OnSetEnabled()
         if (patches_[i])
             patches_[i]->SetEnabled(enabled);
     }
+
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetEnabled(enabled);
 }
 
 void Terrain::SetPatchSize(int size)
@@ -241,6 +269,17 @@ void Terrain::SetSmoothing(bool enable)
     }
 }
 
+void Terrain::SetClipmap(bool enable)
+{
+    if (enable != clipmap_)
+    {
+        clipmap_ = enable;
+
+        CreateGeometry();
+        MarkNetworkUpdate();
+    }
+}
+
 bool Terrain::SetHeightMap(Image* image)
 {
     bool success = SetHeightMapInternal(image, true);
@@ -258,6 +297,9 @@ void Terrain::SetMaterial(Material* material)
             patches_[i]->SetMaterial(material);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetMaterial(material);
+
     MarkNetworkUpdate();
 }
 
@@ -386,6 +428,9 @@ void Terrain::SetDrawDistance(float distance)
             patches_[i]->SetDrawDistance(distance);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetDrawDistance(distance);
+
     MarkNetworkUpdate();
 }
 
@@ -398,6 +443,9 @@ void Terrain::SetShadowDistance(float distance)
             patches_[i]->SetShadowDistance(distance);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetShadowDistance(distance);
+
     MarkNetworkUpdate();
 }
 
@@ -410,6 +458,9 @@ void Terrain::SetLodBias(float bias)
             patches_[i]->SetLodBias(bias);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetLodBias(bias);
+
     MarkNetworkUpdate();
 }
 
@@ -422,6 +473,9 @@ void Terrain::SetViewMask(unsigned mask)
             patches_[i]->SetViewMask(mask);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetViewMask(mask);
+
     MarkNetworkUpdate();
 }
 
@@ -434,6 +488,9 @@ void Terrain::SetLightMask(unsigned mask)
             patches_[i]->SetLightMask(mask);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetLightMask(mask);
+
     MarkNetworkUpdate();
 }
 
@@ -446,6 +503,9 @@ void Terrain::SetShadowMask(unsigned mask)
             patches_[i]->SetShadowMask(mask);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetShadowMask(mask);
+
     MarkNetworkUpdate();
 }
 
@@ -458,6 +518,9 @@ void Terrain::SetZoneMask(unsigned mask)
             patches_[i]->SetZoneMask(mask);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetZoneMask(mask);
+
     MarkNetworkUpdate();
 }
 
@@ -470,6 +533,9 @@ void Terrain::SetMaxLights(unsigned num)
             patches_[i]->SetMaxLights(num);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetMaxLights(num);
+
     MarkNetworkUpdate();
 }
 
@@ -482,6 +548,9 @@ void Terrain::SetCastShadows(bool enable)
             patches_[i]->SetCastShadows(enable);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetCastShadows(enable);
+
     MarkNetworkUpdate();
 }
 
@@ -494,6 +563,9 @@ void Terrain::SetOccluder(bool enable)
             patches_[i]->SetOccluder(enable);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetOccluder(enable);
+
     MarkNetworkUpdate();
 }
 
@@ -506,6 +578,9 @@ void Terrain::SetOccludee(bool enable)
             patches_[i]->SetOccludee(enable);
     }
 
+    if (clipmapDrawable_)
+        clipmapDrawable_->SetOccludee(enable);
+
     MarkNetworkUpdate();
 }
 
@@ -515,6 +590,118 @@ void Terrain::ApplyHeightMap()
         CreateGeometry();
 }
 
+void Terrain::ApplyHeightMapRegion(const IntRect& region)
+{
+    if (!heightMap_ || !node_)
+        return;
+
+    // Recreate the whole terrain if its size or settings changed since the last update
+    IntVector2 numPatches((heightMap_->GetWidth() - 1) / patchSize_, (heightMap_->GetHeight() - 1) / patchSize_);
+    if (recreateTerrain_ || !heightData_ || numPatches != numPatches_ || patchSize_ != lastPatchSize_ || spacing_ != lastSpacing_ ||
+        smoothing_ != sourceHeightData_.NotNull())
+    {
+        CreateGeometry();
+        return;
+    }
+
+    // Convert to height data coordinates, which are reversed vertically
+    IntRect vertexRegion(Max(region.left_, 0), Max(numVertices_.y_ - region.bottom_, 0), Min(region.right_, numVertices_.x_) - 1,
+        Min(numVertices_.y_ - 1 - region.top_, numVertices_.y_ - 1));
+    if (vertexRegion.left_ > vertexRegion.right_ || vertexRegion.top_ > vertexRegion.bottom_)
+        return;
+
+    URHO3D_PROFILE(ApplyHeightMapRegion);
+
+    // The worker threads of an earlier update read the height data, so let them finish first
+    CompleteHeightMapUpdates();
+
+    IntRect updateRegion = CopyHeightData(vertexRegion, false);
+    if (updateRegion.left_ < 0)
+        return;
+
+    // Smoothing reads the neighbors of each source height, so the smoothed region is one vertex larger
+    if (smoothing_)
+    {
+        updateRegion.left_ = Max(updateRegion.left_ - 1, 0);
+        updateRegion.top_ = Max(updateRegion.top_ - 1, 0);
+        updateRegion.right_ = Min(updateRegion.right_ + 1, numVertices_.x_ - 1);
+        updateRegion.bottom_ = Min(updateRegion.bottom_ + 1, numVertices_.y_ - 1);
+        SmoothHeightData(updateRegion);
+    }
+
+    if (clipmapDrawable_)
+        clipmapDrawable_->UpdateRegion(updateRegion);
+    else
+    {
+        IntRect dirtyPatches = GetDirtyPatches(updateRegion);
+        auto* queue = GetSubsystem<WorkQueue>();
+
+        if (queue)
+        {
+            // Calculate the patches in worker threads with low priority, so that rendering does not wait for them
+            patchUpdates_.Resize((unsigned)((dirtyPatches.right_ - dirtyPatches.left_ + 1) * (dirtyPatches.bottom_ - dirtyPatches.top_ + 1)));
+            unsigned index = 0;
+            for (int z = dirtyPatches.top_; z <= dirtyPatches.bottom_; ++z)
+            {
+                for (int x = dirtyPatches.left_; x <= dirtyPatches.right_; ++x)
+                {
+                    PatchGeometryUpdate& update = patchUpdates_[index++];
+                    update.coords_ = IntVector2(x, z);
+                    update.workItem_ = new WorkItem();
+                    update.workItem_->workFunction_ = CalculatePatchGeometryWork;
+                    update.workItem_->name_ = "CalculatePatchGeometryWork";
+                    update.workItem_->start_ = &update;
+                    update.workItem_->aux_ = this;
+                    update.workItem_->priority_ = 0;
+                    queue->AddWorkItem(update.workItem_);
+                }
+            }
+
+            SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Terrain, HandleEndFrame));
+        }
+        else
+        {
+            for (int z = dirtyPatches.top_; z <= dirtyPatches.bottom_; ++z)
+            {
+                for (int x = dirtyPatches.left_; x <= dirtyPatches.right_; ++x)
+                {
+                    TerrainPatch* patch = GetPatch(x, z);
+                    if (patch)
+                    {
+                        CreatePatchGeometry(patch);
+                        CalculateLodErrors(patch);
+                    }
+                }
+            }
+        }
+    }
+
+    using namespace TerrainRegionUpdated;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_NODE] = node_;
+    eventData[P_REGION] = updateRegion;
+    node_->SendEvent(E_TERRAINREGIONUPDATED, eventData);
+}
+
+void Terrain::CompleteHeightMapUpdates()
+{
+    if (patchUpdates_.Empty())
+        return;
+
+    for (unsigned i = 0; i < patchUpdates_.Size(); ++i)
+    {
+        if (patchUpdates_[i].workItem_ && !patchUpdates_[i].workItem_->completed_)
+        {
+            URHO3D_PROFILE(CompleteHeightMapUpdates);
+            GetSubsystem<WorkQueue>()->Complete(0);
+            break;
+        }
+    }
+
+    ApplyPatchUpdates();
+}
+
 Image* Terrain::GetHeightMap() const
 {
     return heightMap_;
@@ -525,6 +712,11 @@ Material* Terrain::GetMaterial() const
     return material_;
 }
 
+TerrainClipmap* Terrain::GetClipmapDrawable() const
+{
+    return clipmapDrawable_;
+}
+
 TerrainPatch* Terrain::GetPatch(unsigned index) const
 {
     return index < patches_.Size() ? patches_[index] : nullptr;
@@ -654,9 +846,6 @@ void Terrain::CreatePatchGeometry(TerrainPatch* patch)
 
     auto row = (unsigned)(patchSize_ + 1);
     VertexBuffer* vertexBuffer = patch->GetVertexBuffer();
-    Geometry* geometry = patch->GetGeometry();
-    Geometry* maxLodGeometry = patch->GetMaxLodGeometry();
-    Geometry* occlusionGeometry = patch->GetOcclusionGeometry();
 
     if (vertexBuffer->GetVertexCount() != row * row)
         vertexBuffer->SetSize(row * row, MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT);
@@ -665,85 +854,100 @@ void Terrain::CreatePatchGeometry(TerrainPatch* patch)
     SharedArrayPtr<unsigned char> occlusionCpuVertexData(new unsigned char[row * row * sizeof(Vector3)]);
 
     auto* vertexData = (float*)vertexBuffer->Lock(0, vertexBuffer->GetVertexCount());
-    auto* positionData = (float*)cpuVertexData.Get();
-    auto* occlusionData = (float*)occlusionCpuVertexData.Get();
     BoundingBox box;
 
+    if (vertexData)
+    {
+        CalculatePatchGeometry(patch->GetCoordinates(), vertexData, (float*)cpuVertexData.Get(), (float*)occlusionCpuVertexData.Get(), box);
+        vertexBuffer->Unlock();
+        vertexBuffer->ClearDataLost();
+    }
+
+    SetPatchGeometry(patch, cpuVertexData, occlusionCpuVertexData, box);
+}
+
+void Terrain::CalculatePatchGeometry(const IntVector2& coords, float* vertexData, float* positionData, float* occlusionData,
+    BoundingBox& box) const
+{
     unsigned occlusionLevel = occlusionLodLevel_;
     if (occlusionLevel > numLodLevels_ - 1)
         occlusionLevel = numLodLevels_ - 1;
 
-    if (vertexData)
-    {
-        const IntVector2& coords = patch->GetCoordinates();
-        unsigned lodExpand = (1u << (occlusionLevel)) - 1;
-        unsigned halfLodExpand = (1u << (occlusionLevel)) / 2;
+    unsigned lodExpand = (1u << (occlusionLevel)) - 1;
+    unsigned halfLodExpand = (1u << (occlusionLevel)) / 2;
 
-        for (unsigned z = 0; z <= patchSize_; ++z)
+    for (unsigned z = 0; z <= patchSize_; ++z)
+    {
+        for (unsigned x = 0; x <= patchSize_; ++x)
         {
-            for (unsigned x = 0; x <= patchSize_; ++x)
+            int xPos = coords.x_ * patchSize_ + x;
+            int zPos = coords.y_ * patchSize_ + z;
+
+            // Position
+            Vector3 position((float)x * spacing_.x_, GetRawHeight(xPos, zPos), (float)z * spacing_.z_);
+            *vertexData++ = position.x_;
+            *vertexData++ = position.y_;
+            *vertexData++ = position.z_;
+            *positionData++ = position.x_;
+            *positionData++ = position.y_;
+            *positionData++ = position.z_;
+
+            box.Merge(position);
+
+            // For vertices that are part of the occlusion LOD, calculate the minimum height in the neighborhood
+            // to prevent false positive occlusion due to inaccuracy between occlusion LOD & visible LOD
+            float minHeight = position.y_;
+            if (halfLodExpand > 0 && (x & lodExpand) == 0 && (z & lodExpand) == 0)
             {
-                int xPos = coords.x_ * patchSize_ + x;
-                int zPos = coords.y_ * patchSize_ + z;
-
-                // Position
-                Vector3 position((float)x * spacing_.x_, GetRawHeight(xPos, zPos), (float)z * spacing_.z_);
-                *vertexData++ = position.x_;
-                *vertexData++ = position.y_;
-                *vertexData++ = position.z_;
-                *positionData++ = position.x_;
-                *positionData++ = position.y_;
-                *positionData++ = position.z_;
-
-                box.Merge(position);
-
-                // For vertices that are part of the occlusion LOD, calculate the minimum height in the neighborhood
-                // to prevent false positive occlusion due to inaccuracy between occlusion LOD & visible LOD
-                float minHeight = position.y_;
-                if (halfLodExpand > 0 && (x & lodExpand) == 0 && (z & lodExpand) == 0)
+                int minX = Max(xPos - halfLodExpand, 0);
+                int maxX = Min(xPos + halfLodExpand, numVertices_.x_ - 1);
+                int minZ = Max(zPos - halfLodExpand, 0);
+                int maxZ = Min(zPos + halfLodExpand, numVertices_.y_ - 1);
+                for (int nZ = minZ; nZ <= maxZ; ++nZ)
                 {
-                    int minX = Max(xPos - halfLodExpand, 0);
-                    int maxX = Min(xPos + halfLodExpand, numVertices_.x_ - 1);
-                    int minZ = Max(zPos - halfLodExpand, 0);
-                    int maxZ = Min(zPos + halfLodExpand, numVertices_.y_ - 1);
-                    for (int nZ = minZ; nZ <= maxZ; ++nZ)
-                    {
-                        for (int nX = minX; nX <= maxX; ++nX)
-                            minHeight = Min(minHeight, GetRawHeight(nX, nZ));
-                    }
+                    for (int nX = minX; nX <= maxX; ++nX)
+                        minHeight = Min(minHeight, GetRawHeight(nX, nZ));
                 }
-                *occlusionData++ = position.x_;
-                *occlusionData++ = minHeight;
-                *occlusionData++ = position.z_;
-
-                // Normal
-                Vector3 normal = GetRawNormal(xPos, zPos);
-                *vertexData++ = normal.x_;
-                *vertexData++ = normal.y_;
-                *vertexData++ = normal.z_;
-
-                // Texture coordinate
-                Vector2 texCoord((float)xPos / (float)(numVertices_.x_ - 1), 1.0f - (float)zPos / (float)(numVertices_.y_ - 1));
-                *vertexData++ = texCoord.x_;
-                *vertexData++ = texCoord.y_;
-
-                // Tangent
-                Vector3 xyz = (Vector3::RIGHT - normal * normal.DotProduct(Vector3::RIGHT)).Normalized();
-                *vertexData++ = xyz.x_;
-                *vertexData++ = xyz.y_;
-                *vertexData++ = xyz.z_;
-                *vertexData++ = 1.0f;
             }
+            *occlusionData++ = position.x_;
+            *occlusionData++ = minHeight;
+            *occlusionData++ = position.z_;
+
+            // Normal
+            Vector3 normal = GetRawNormal(xPos, zPos);
+            *vertexData++ = normal.x_;
+            *vertexData++ = normal.y_;
+            *vertexData++ = normal.z_;
+
+            // Texture coordinate
+            Vector2 texCoord((float)xPos / (float)(numVertices_.x_ - 1), 1.0f - (float)zPos / (float)(numVertices_.y_ - 1));
+            *vertexData++ = texCoord.x_;
+            *vertexData++ = texCoord.y_;
+
+            // Tangent
+            Vector3 xyz = (Vector3::RIGHT - normal * normal.DotProduct(Vector3::RIGHT)).Normalized();
+            *vertexData++ = xyz.x_;
+            *vertexData++ = xyz.y_;
+            *vertexData++ = xyz.z_;
+            *vertexData++ = 1.0f;
         }
-
-        vertexBuffer->Unlock();
-        vertexBuffer->ClearDataLost();
     }
+}
+
+void Terrain::SetPatchGeometry(TerrainPatch* patch, const SharedArrayPtr<unsigned char>& cpuVertexData,
+    const SharedArrayPtr<unsigned char>& occlusionCpuVertexData, const BoundingBox& box)
+{
+    Geometry* geometry = patch->GetGeometry();
+    Geometry* maxLodGeometry = patch->GetMaxLodGeometry();
+    Geometry* occlusionGeometry = patch->GetOcclusionGeometry();
 
     patch->SetBoundingBox(box);
 
     if (drawRanges_.Size())
     {
+        unsigned occlusionLevel = occlusionLodLevel_;
+        if (occlusionLevel > numLodLevels_ - 1)
+            occlusionLevel = numLodLevels_ - 1;
         unsigned occlusionDrawRange = occlusionLevel << 4u;
 
         geometry->SetIndexBuffer(indexBuffer_);
@@ -760,6 +964,62 @@ void Terrain::CreatePatchGeometry(TerrainPatch* patch)
     patch->ResetLod();
 }
 
+void Terrain::CalculatePatchUpdate(PatchGeometryUpdate& update) const
+{
+    auto numPatchVertices = (unsigned)((patchSize_ + 1) * (patchSize_ + 1));
+    update.vertexData_ = new unsigned char[numPatchVertices * VertexBuffer::GetVertexSize(MASK_POSITION | MASK_NORMAL |
+        MASK_TEXCOORD1 | MASK_TANGENT)];
+    update.cpuVertexData_ = new unsigned char[numPatchVertices * sizeof(Vector3)];
+    update.occlusionCpuVertexData_ = new unsigned char[numPatchVertices * sizeof(Vector3)];
+    update.boundingBox_.Clear();
+
+    CalculatePatchGeometry(update.coords_, (float*)update.vertexData_.Get(), (float*)update.cpuVertexData_.Get(),
+        (float*)update.occlusionCpuVertexData_.Get(), update.boundingBox_);
+    CalculateLodErrors(update.coords_, update.lodErrors_);
+}
+
+void Terrain::ApplyPatchUpdates()
+{
+    URHO3D_PROFILE(ApplyPatchUpdates);
+
+    bool allApplied = true;
+    auto row = (unsigned)(patchSize_ + 1);
+
+    for (unsigned i = 0; i < patchUpdates_.Size(); ++i)
+    {
+        PatchGeometryUpdate& update = patchUpdates_[i];
+        if (!update.workItem_)
+            continue;
+        if (!update.workItem_->completed_)
+        {
+            allApplied = false;
+            continue;
+        }
+
+        // The patch may have been removed by a terrain recreation in the meanwhile
+        TerrainPatch* patch = GetPatch(update.coords_.x_, update.coords_.y_);
+        if (patch)
+        {
+            VertexBuffer* vertexBuffer = patch->GetVertexBuffer();
+            if (vertexBuffer->GetVertexCount() != row * row)
+                vertexBuffer->SetSize(row * row, MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT);
+            if (vertexBuffer->SetData(update.vertexData_.Get()))
+                vertexBuffer->ClearDataLost();
+
+            SetPatchGeometry(patch, update.cpuVertexData_, update.occlusionCpuVertexData_, update.boundingBox_);
+            patch->GetLodErrors() = update.lodErrors_;
+        }
+
+        update.workItem_.Reset();
+    }
+
+    if (allApplied)
+    {
+        patchUpdates_.Clear();
+        UnsubscribeFromEvent(E_ENDFRAME);
+    }
+}
+
 void Terrain::UpdatePatchLod(TerrainPatch* patch)
 {
     Geometry* geometry = patch->GetGeometry();
@@ -854,6 +1114,10 @@ void Terrain::CreateGeometry()
 
     URHO3D_PROFILE(CreateTerrainGeometry);
 
+    // Apply pending region updates, as the worker threads read the height data, and unchanged heights would not update the patches
+    // again
+    CompleteHeightMapUpdates();
+
     unsigned prevNumPatches = patches_.Size();
 
     // Determine number of LOD levels
@@ -905,6 +1169,26 @@ void Terrain::CreateGeometry()
     lastPatchSize_ = patchSize_;
     lastSpacing_ = spacing_;
 
+    // The clipmap needs vertex texture fetch of float textures. Without graphics use patches, so that raycasts work on a headless
+    // server
+    bool useClipmap = false;
+    if (clipmap_ && heightMap_ && GetSubsystem<Graphics>())
+    {
+        if (Graphics::GetGL3Support())
+            useClipmap = true;
+        else
+            URHO3D_LOGWARNING("Terrain clipmap requires OpenGL 3 or Direct3D 11, using patches instead");
+    }
+
+    // Rebuild everything when switching between the clipmap and patches
+    if (useClipmap != clipmapDrawable_.NotNull())
+        updateAll = true;
+    if (!useClipmap && clipmapDrawable_)
+    {
+        node_->RemoveChild(clipmapDrawable_->GetNode());
+        clipmapDrawable_.Reset();
+    }
+
     // Remove old patch nodes which are not needed
     if (updateAll)
     {
@@ -916,7 +1200,7 @@ void Terrain::CreateGeometry()
         {
             bool nodeOk = false;
             Vector<String> coords = (*i)->GetName().Substring(6).Split('_');
-            if (coords.Size() == 2)
+            if (!useClipmap && coords.Size() == 2)
             {
                 int x = ToInt(coords[0]);
                 int z = ToInt(coords[1]);
@@ -939,82 +1223,18 @@ void Terrain::CreateGeometry()
     if (heightMap_)
     {
         // Copy heightmap data
-        const unsigned char* src = heightMap_->GetData();
-        float* dest = smoothing_ ? sourceHeightData_ : heightData_;
-        unsigned imgComps = heightMap_->GetComponents();
-        unsigned imgRow = heightMap_->GetWidth() * imgComps;
-        IntRect updateRegion(-1, -1, -1, -1);
-
-        if (imgComps == 1)
-        {
-            URHO3D_PROFILE(CopyHeightData);
-
-            for (int z = 0; z < numVertices_.y_; ++z)
-            {
-                for (int x = 0; x < numVertices_.x_; ++x)
-                {
-                    float newHeight = (float)src[imgRow * (numVertices_.y_ - 1 - z) + x] * spacing_.y_;
-
-                    if (updateAll)
-                        *dest = newHeight;
-                    else
-                    {
-                        if (*dest != newHeight)
-                        {
-                            *dest = newHeight;
-                            GrowUpdateRegion(updateRegion, x, z);
-                        }
-                    }
-
-                    ++dest;
-                }
-            }
-        }
-        else
-        {
-            URHO3D_PROFILE(CopyHeightData);
-
-            // If more than 1 component, use the green channel for more accuracy
-            for (int z = 0; z < numVertices_.y_; ++z)
-            {
-                for (int x = 0; x < numVertices_.x_; ++x)
-                {
-                    float newHeight = ((float)src[imgRow * (numVertices_.y_ - 1 - z) + imgComps * x] +
-                                       (float)src[imgRow * (numVertices_.y_ - 1 - z) + imgComps * x + 1] / 256.0f) * spacing_.y_;
-
-                    if (updateAll)
-                        *dest = newHeight;
-                    else
-                    {
-                        if (*dest != newHeight)
-                        {
-                            *dest = newHeight;
-                            GrowUpdateRegion(updateRegion, x, z);
-                        }
-                    }
+        IntRect updateRegion = CopyHeightData(IntRect(0, 0, numVertices_.x_ - 1, numVertices_.y_ - 1), updateAll);
 
-                    ++dest;
-                }
-            }
-        }
+        if (useClipmap)
+            UpdateClipmap(updateRegion, updateAll);
 
         // If updating a region of the heightmap, check which patches change
-        if (!updateAll)
+        if (!updateAll && updateRegion.left_ >= 0)
         {
-            int lodExpand = 1u << (numLodLevels_ - 1);
-            // Expand the right & bottom 1 pixel more, as patches share vertices at the edge
-            updateRegion.left_ -= lodExpand;
-            updateRegion.right_ += lodExpand + 1;
-            updateRegion.top_ -= lodExpand;
-            updateRegion.bottom_ += lodExpand + 1;
-
-            int sX = Max(updateRegion.left_ / patchSize_, 0);
-            int eX = Min(updateRegion.right_ / patchSize_, numPatches_.x_ - 1);
-            int sY = Max(updateRegion.top_ / patchSize_, 0);
-            int eY = Min(updateRegion.bottom_ / patchSize_, numPatches_.y_ - 1);
-            for (int y = sY; y <= eY; ++y)
+            IntRect patchRegion = GetDirtyPatches(updateRegion);
+            for (int y = patchRegion.top_; y <= patchRegion.bottom_; ++y)
             {
-                for (int x = sX; x <= eX; ++x)
+                for (int x = patchRegion.left_; x <= patchRegion.right_; ++x)
                     dirtyPatches[y * numPatches_.x_ + x] = true;
             }
         }
@@ -1023,6 +1243,7 @@ void Terrain::CreateGeometry()
 
         bool enabled = IsEnabledEffective();
 
+        if (!useClipmap)
         {
             URHO3D_PROFILE(CreatePatches);
 
@@ -1073,7 +1294,7 @@ void Terrain::CreateGeometry()
         }
 
         // Create the shared index data
-        if (updateAll)
+        if (updateAll && !useClipmap)
             CreateIndexData();
 
         // Create vertex data for patches. First update smoothing to ensure normals are calculated correctly across patch borders
@@ -1085,26 +1306,10 @@ void Terrain::CreateGeometry()
             {
                 if (dirtyPatches[i])
                 {
-                    TerrainPatch* patch = patches_[i];
-                    const IntVector2& coords = patch->GetCoordinates();
+                    const IntVector2& coords = patches_[i]->GetCoordinates();
                     int startX = coords.x_ * patchSize_;
-                    int endX = startX + patchSize_;
                     int startZ = coords.y_ * patchSize_;
-                    int endZ = startZ + patchSize_;
-
-                    for (int z = startZ; z <= endZ; ++z)
-                    {
-                        for (int x = startX; x <= endX; ++x)
-                        {
-                            float smoothedHeight = (
-                                GetSourceHeight(x - 1, z - 1) + GetSourceHeight(x, z - 1) * 2.0f + GetSourceHeight(x + 1, z - 1) +
-                                GetSourceHeight(x - 1, z) * 2.0f + GetSourceHeight(x, z) * 4.0f + GetSourceHeight(x + 1, z) * 2.0f +
-                                GetSourceHeight(x - 1, z + 1) + GetSourceHeight(x, z + 1) * 2.0f + GetSourceHeight(x + 1, z + 1)
-                            ) / 16.0f;
-
-                            heightData_[z * numVertices_.x_ + x] = smoothedHeight;
-                        }
-                    }
+                    SmoothHeightData(IntRect(startX, startZ, startX + patchSize_, startZ + patchSize_));
                 }
             }
         }
@@ -1124,7 +1329,7 @@ void Terrain::CreateGeometry()
     }
 
     // Send event only if new geometry was generated, or the old was cleared
-    if (patches_.Size() || prevNumPatches)
+    if (patches_.Size() || prevNumPatches || clipmapDrawable_)
     {
         using namespace TerrainCreated;
 
@@ -1294,6 +1499,118 @@ void Terrain::CreateIndexData()
     indexBuffer_->SetData(&indices[0]);
 }
 
+void Terrain::UpdateClipmap(const IntRect& updateRegion, bool rebuild)
+{
+    URHO3D_PROFILE(UpdateClipmap);
+
+    if (!clipmapDrawable_)
+    {
+        // Create the clipmap scene node as local and temporary, like the patch nodes
+        Node* clipmapNode = node_->GetChild("Clipmap");
+        if (!clipmapNode)
+            clipmapNode = node_->CreateTemporaryChild("Clipmap", LOCAL);
+
+        clipmapDrawable_ = clipmapNode->GetOrCreateComponent<TerrainClipmap>();
+        clipmapDrawable_->SetOwner(this);
+
+        // Copy initial drawable parameters
+        clipmapDrawable_->SetEnabled(IsEnabledEffective());
+        clipmapDrawable_->SetMaterial(material_);
+        clipmapDrawable_->SetDrawDistance(drawDistance_);
+        clipmapDrawable_->SetShadowDistance(shadowDistance_);
+        clipmapDrawable_->SetLodBias(lodBias_);
+        clipmapDrawable_->SetViewMask(viewMask_);
+        clipmapDrawable_->SetLightMask(lightMask_);
+        clipmapDrawable_->SetShadowMask(shadowMask_);
+        clipmapDrawable_->SetZoneMask(zoneMask_);
+        clipmapDrawable_->SetMaxLights(maxLights_);
+        clipmapDrawable_->SetCastShadows(castShadows_);
+        clipmapDrawable_->SetOccluder(occluder_);
+        clipmapDrawable_->SetOccludee(occludee_);
+        rebuild = true;
+    }
+
+    IntRect region = rebuild ? IntRect(0, 0, numVertices_.x_ - 1, numVertices_.y_ - 1) : updateRegion;
+    if (region.left_ < 0)
+        return;
+
+    // Smoothing reads the neighbors of each source height, so the smoothed region is one vertex larger
+    if (smoothing_)
+    {
+        region.left_ = Max(region.left_ - 1, 0);
+        region.top_ = Max(region.top_ - 1, 0);
+        region.right_ = Min(region.right_ + 1, numVertices_.x_ - 1);
+        region.bottom_ = Min(region.bottom_ + 1, numVertices_.y_ - 1);
+        SmoothHeightData(region);
+    }
+
+    if (rebuild)
+        clipmapDrawable_->Build();
+    else
+        clipmapDrawable_->UpdateRegion(region);
+}
+
+IntRect Terrain::CopyHeightData(const IntRect& region, bool updateAll)
+{
+    URHO3D_PROFILE(CopyHeightData);
+
+    const unsigned char* src = heightMap_->GetData();
+    float* dest = smoothing_ ? sourceHeightData_ : heightData_;
+    unsigned imgComps = heightMap_->GetComponents();
+    unsigned imgRow = heightMap_->GetWidth() * imgComps;
+    IntRect updateRegion(-1, -1, -1, -1);
+
+    for (int z = region.top_; z <= region.bottom_; ++z)
+    {
+        const unsigned char* srcRow = src + imgRow * (numVertices_.y_ - 1 - z);
+        float* destRow = dest + z * numVertices_.x_;
+
+        for (int x = region.left_; x <= region.right_; ++x)
+        {
+            // If more than 1 component, use the green channel for more accuracy
+            float newHeight = imgComps == 1 ? (float)srcRow[x] * spacing_.y_ :
+                ((float)srcRow[imgComps * x] + (float)srcRow[imgComps * x + 1] / 256.0f) * spacing_.y_;
+
+            if (updateAll)
+                destRow[x] = newHeight;
+            else if (destRow[x] != newHeight)
+            {
+                destRow[x] = newHeight;
+                GrowUpdateRegion(updateRegion, x, z);
+            }
+        }
+    }
+
+    return updateRegion;
+}
+
+IntRect Terrain::GetDirtyPatches(const IntRect& updateRegion) const
+{
+    // Changed heights affect the normals and LOD errors of the surrounding vertices. Expand the right & bottom 1 pixel more, as
+    // patches share vertices at the edge
+    int lodExpand = 1u << (numLodLevels_ - 1);
+    return IntRect(Max((updateRegion.left_ - lodExpand) / patchSize_, 0), Max((updateRegion.top_ - lodExpand) / patchSize_, 0),
+        Min((updateRegion.right_ + lodExpand + 1) / patchSize_, numPatches_.x_ - 1),
+        Min((updateRegion.bottom_ + lodExpand + 1) / patchSize_, numPatches_.y_ - 1));
+}
+
+void Terrain::SmoothHeightData(const IntRect& region)
+{
+    for (int z = region.top_; z <= region.bottom_; ++z)
+    {
+        for (int x = region.left_; x <= region.right_; ++x)
+        {
+            float smoothedHeight = (
+                GetSourceHeight(x - 1, z - 1) + GetSourceHeight(x, z - 1) * 2.0f + GetSourceHeight(x + 1, z - 1) +
+                GetSourceHeight(x - 1, z) * 2.0f + GetSourceHeight(x, z) * 4.0f + GetSourceHeight(x + 1, z) * 2.0f +
+                GetSourceHeight(x - 1, z + 1) + GetSourceHeight(x, z + 1) * 2.0f + GetSourceHeight(x + 1, z + 1)
+            ) / 16.0f;
+
+            heightData_[z * numVertices_.x_ + x] = smoothedHeight;
+        }
+    }
+}
+
 float Terrain::GetRawHeight(int x, int z) const
 {
     if (!heightData_)
@@ -1366,8 +1683,11 @@ void Terrain::CalculateLodErrors(TerrainPatch* patch)
 {
     URHO3D_PROFILE(CalculateLodErrors);
 
-    const IntVector2& coords = patch->GetCoordinates();
-    PODVector<float>& lodErrors = patch->GetLodErrors();
+    CalculateLodErrors(patch->GetCoordinates(), patch->GetLodErrors());
+}
+
+void Terrain::CalculateLodErrors(const IntVector2& coords, PODVector<float>& lodErrors) const
+{
     lodErrors.Clear();
     lodErrors.Reserve(numLodLevels_);
 
@@ -1442,6 +1762,11 @@ void Terrain::HandleHeightMapReloadFinished(StringHash /*eventType*/, VariantMap
     CreateGeometry();
 }
 
+void Terrain::HandleEndFrame(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    ApplyPatchUpdates();
+}
+
 void Terrain::HandleNeighborTerrainCreated(StringHash /*eventType*/, VariantMap& eventData)
 {
     UpdateEdgePatchNeighbors();
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/ArrayPtr.h"
+#include "../Math/BoundingBox.h"
 #include "../Scene/Component.h"
 
 namespace Urho3D
@@ -32,13 +33,17 @@ class Image;
 class IndexBuffer;
 class Material;
 class Node;
+class TerrainClipmap;
 class TerrainPatch;
+struct WorkItem;
 
 /// Heightmap terrain component.
 class URHO3D_API Terrain : public Component
 {
     URHO3D_OBJECT(Terrain, Component);
 
+    friend void CalculatePatchGeometryWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit Terrain(Context* context);
@@ -62,6 +67,8 @@ public:
     void SetOcclusionLodLevel(unsigned level);
     /// Set smoothing of heightmap.
     void SetSmoothing(bool enable);
+    /// Set whether to render with a GPU clipmap instead of patches. The heights are kept in a texture that displaces a shared grid mesh in the vertex shader, so no vertex data is created per patch, and editing the heightmap only uploads the changed rows. Requires OpenGL 3 or Direct3D 11 and a material whose shaders use the Transform shader functions; otherwise patches are used.
+    void SetClipmap(bool enable);
     /// Set heightmap image. Dimensions should be a power of two + 1. Uses 8-bit grayscale, or optionally red as MSB and green as LSB for 16-bit accuracy. Return true if successful.
     bool SetHeightMap(Image* image);
     /// Set material.
@@ -100,6 +107,10 @@ public:
     void SetOccludee(bool enable);
     /// Apply changes from the heightmap image.
     void ApplyHeightMap();
+    /// Apply changes from a region of the heightmap image without stalling the frame. Only the heights of the region are copied, and the geometry of the patches overlapping it is recalculated in worker threads and uploaded at the end of the frame. Height queries and the physics heightfield use the new heights immediately. The region is in heightmap image pixel coordinates, with the right and bottom edges exclusive. Recreates the whole terrain instead if its size or settings have changed.
+    void ApplyHeightMapRegion(const IntRect& region);
+    /// Wait for the patch geometry of pending heightmap region updates and apply it immediately.
+    void CompleteHeightMapUpdates();
 
     /// Return patch quads per side.
     int GetPatchSize() const { return patchSize_; }
@@ -122,10 +133,18 @@ public:
     /// Return whether smoothing is in use.
     bool GetSmoothing() const { return smoothing_; }
 
+    /// Return whether GPU clipmap rendering is requested.
+    bool GetClipmap() const { return clipmap_; }
+
+    /// Return whether patch geometry from heightmap region updates is still waiting to be applied.
+    bool IsUpdatingHeightMap() const { return !patchUpdates_.Empty(); }
+
     /// Return heightmap image.
     Image* GetHeightMap() const;
     /// Return material.
     Material* GetMaterial() const;
+    /// Return the clipmap drawable, or null if patches are in use.
+    TerrainClipmap* GetClipmapDrawable() const;
     /// Return patch by index.
     TerrainPatch* GetPatch(unsigned index) const;
     /// Return patch by patch coordinates.
@@ -212,10 +231,46 @@ public:
     ResourceRef GetMaterialAttr() const;
 
 private:
+    /// Patch geometry calculated in a worker thread, waiting to be applied at the end of the frame.
+    struct PatchGeometryUpdate
+    {
+        /// Patch coordinates.
+        IntVector2 coords_;
+        /// Vertex buffer data.
+        SharedArrayPtr<unsigned char> vertexData_;
+        /// CPU-side position data.
+        SharedArrayPtr<unsigned char> cpuVertexData_;
+        /// CPU-side occlusion position data.
+        SharedArrayPtr<unsigned char> occlusionCpuVertexData_;
+        /// Patch bounding box.
+        BoundingBox boundingBox_;
+        /// LOD errors.
+        PODVector<float> lodErrors_;
+        /// Work item. Null once applied.
+        SharedPtr<WorkItem> workItem_;
+    };
+
     /// Regenerate terrain geometry.
     void CreateGeometry();
     /// Create index data shared by all patches.
     void CreateIndexData();
+    /// Create the clipmap drawable if necessary and update it from a region of the height data, or rebuild it fully.
+    void UpdateClipmap(const IntRect& updateRegion, bool rebuild);
+    /// Smooth a region of the height data from the source height data.
+    void SmoothHeightData(const IntRect& region);
+    /// Copy a region of the heightmap image to the height data, or to the source height data if smoothing. The region is in height data vertex coordinates and inclusive. Return the region of changed heights, or a rect with negative left if none changed.
+    IntRect CopyHeightData(const IntRect& region, bool updateAll);
+    /// Return the inclusive range of patches affected by a changed region of the height data.
+    IntRect GetDirtyPatches(const IntRect& updateRegion) const;
+    /// Calculate the vertex data and bounding box of a patch. Does not touch the GPU and may be called from a worker thread.
+    void CalculatePatchGeometry(const IntVector2& coords, float* vertexData, float* positionData, float* occlusionData, BoundingBox& box) const;
+    /// Calculate the geometry of a pending patch update. Called from a worker thread.
+    void CalculatePatchUpdate(PatchGeometryUpdate& update) const;
+    /// Set the CPU-side geometry data and bounding box of a patch and reset its LOD.
+    void SetPatchGeometry(TerrainPatch* patch, const SharedArrayPtr<unsigned char>& cpuVertexData,
+        const SharedArrayPtr<unsigned char>& occlusionCpuVertexData, const BoundingBox& box);
+    /// Upload the patch updates whose worker thread calculation has completed.
+    void ApplyPatchUpdates();
     /// Return an uninterpolated terrain height value, clamping to edges.
     float GetRawHeight(int x, int z) const;
     /// Return a source terrain height value, clamping to edges. The source data is used for smoothing.
@@ -226,12 +281,16 @@ private:
     Vector3 GetRawNormal(int x, int z) const;
     /// Calculate LOD errors for a patch.
     void CalculateLodErrors(TerrainPatch* patch);
+    /// Calculate LOD errors for patch coordinates. May be called from a worker thread.
+    void CalculateLodErrors(const IntVector2& coords, PODVector<float>& lodErrors) const;
     /// Set neighbors for a patch.
     void SetPatchNeighbors(TerrainPatch* patch);
     /// Set heightmap image and optionally recreate the geometry immediately. Return true if successful.
     bool SetHeightMapInternal(Image* image, bool recreateNow);
     /// Handle heightmap image reload finished.
     void HandleHeightMapReloadFinished(StringHash eventType, VariantMap& eventData);
+    /// Handle end of frame. Upload the completed patch updates.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
     /// Handle neighbor terrain geometry being created. Update the edge patch neighbors as necessary.
     void HandleNeighborTerrainCreated(StringHash eventType, VariantMap& eventData);
     /// Update edge patch neighbors when neighbor terrain(s) change or are recreated.
@@ -253,6 +312,10 @@ private:
     SharedPtr<Material> material_;
     /// Terrain patches.
     Vector<WeakPtr<TerrainPatch> > patches_;
+    /// Clipmap drawable.
+    WeakPtr<TerrainClipmap> clipmapDrawable_;
+    /// Pending patch geometry updates from heightmap region updates.
+    Vector<PatchGeometryUpdate> patchUpdates_;
     /// Draw ranges for different LODs and stitching combinations.
     PODVector<Pair<unsigned, unsigned> > drawRanges_;
     /// North neighbor terrain.
@@ -289,6 +352,8 @@ private:
     unsigned occlusionLodLevel_;
     /// Smoothing enable flag.
     bool smoothing_;
+    /// GPU clipmap enable flag.
+    bool clipmap_;
     /// Visible flag.
     bool visible_;
     /// Shadowcaster flag.
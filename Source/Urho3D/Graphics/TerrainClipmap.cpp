@@ -0,0 +1,576 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/IndexBuffer.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/OctreeQuery.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Terrain.h"
+#include "../Graphics/TerrainClipmap.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/Log.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Camera distance range of a quadtree level in node sizes at LOD bias 1.
+static const float RANGE_FACTOR = 4.0f;
+/// Minimum range factor. Smaller ranges could place nodes two levels apart next to each other, which would crack.
+static const float MIN_RANGE_FACTOR = 3.0f;
+/// Fraction of the range at which the vertices start to morph towards the next coarser level.
+static const float MORPH_START = 0.8f;
+static const String CLIPMAP_DEFINE("CLIPMAP");
+
+TerrainClipmap::TerrainClipmap(Context* context) :
+    Drawable(context, DRAWABLE_GEOMETRY),
+    geometry_(new Geometry(context)),
+    vertexBuffer_(new VertexBuffer(context)),
+    indexBuffer_(new IndexBuffer(context)),
+    numVertices_(IntVector2::ZERO),
+    origin_(Vector2::ZERO),
+    spacing_(Vector3::ONE),
+    gridSize_(0),
+    selectionFrameNumber_(M_MAX_UNSIGNED),
+    parametersDirty_(false),
+    parametersLodBias_(0.0f)
+{
+    vertexBuffer_->SetShadowed(true);
+    indexBuffer_->SetShadowed(true);
+    geometry_->SetVertexBuffer(0, vertexBuffer_);
+    geometry_->SetIndexBuffer(indexBuffer_);
+
+    // The selected nodes are drawn as world transforms of one static batch, instanced when possible
+    batches_.Resize(1);
+    batches_[0].geometry_ = geometry_;
+    batches_[0].geometryType_ = GEOM_STATIC;
+    batches_[0].numWorldTransforms_ = 0;
+}
+
+TerrainClipmap::~TerrainClipmap() = default;
+
+void TerrainClipmap::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TerrainClipmap>();
+}
+
+void TerrainClipmap::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
+{
+    RayQueryLevel level = query.level_;
+
+    switch (level)
+    {
+    case RAY_AABB:
+        Drawable::ProcessRayQuery(query, results);
+        break;
+
+    case RAY_OBB:
+    case RAY_TRIANGLE:
+        {
+            Matrix3x4 inverse(node_->GetWorldTransform().Inverse());
+            Ray localRay = query.ray_.Transformed(inverse);
+            float distance = localRay.HitDistance(boundingBox_);
+            Vector3 normal = -query.ray_.direction_;
+
+            if (level == RAY_TRIANGLE && distance < query.maxDistance_)
+            {
+                Vector3 geometryNormal;
+                distance = GetHitDistance(localRay, &geometryNormal);
+                normal = (node_->GetWorldTransform() * Vector4(geometryNormal, 0.0f)).Normalized();
+            }
+
+            if (distance < query.maxDistance_)
+            {
+                RayQueryResult result;
+                result.position_ = query.ray_.origin_ + distance * query.ray_.direction_;
+                result.normal_ = normal;
+                result.distance_ = distance;
+                result.drawable_ = this;
+                result.node_ = node_;
+                result.subObject_ = M_MAX_UNSIGNED;
+                results.Push(result);
+            }
+        }
+        break;
+
+    case RAY_TRIANGLE_UV:
+        URHO3D_LOGWARNING("RAY_TRIANGLE_UV query level is not supported for TerrainClipmap component");
+        break;
+    }
+}
+
+void TerrainClipmap::UpdateBatches(const FrameInfo& frame)
+{
+    distance_ = frame.camera_->GetDistance(GetWorldBoundingBox().Center());
+    batches_[0].distance_ = distance_;
+
+    // Select the nodes once per frame, as the batch transforms must stay valid until all views have been rendered. Later views
+    // in the same frame use the selection made for the first camera
+    if (frame.frameNumber_ != selectionFrameNumber_)
+    {
+        URHO3D_PROFILE(SelectClipmapNodes);
+
+        selectionFrameNumber_ = frame.frameNumber_;
+        nodeTransforms_.Clear();
+
+        if (!levels_.Empty())
+        {
+            selectionTransform_ = node_->GetWorldTransform();
+            float quadWorldSize = (selectionTransform_ * Vector4(spacing_.x_, 0.0f, 0.0f, 0.0f)).Length();
+            float rangeFactor = Max(RANGE_FACTOR * lodBias_, MIN_RANGE_FACTOR);
+            ranges_.Resize(levels_.Size());
+            for (unsigned i = 0; i < levels_.Size(); ++i)
+                ranges_[i] = quadWorldSize * (float)(gridSize_ << i) * rangeFactor;
+
+            // Culling the nodes by the view frustum would lose shadows cast from outside the view
+            const Frustum* frustum = castShadows_ ? nullptr : &frame.camera_->GetFrustum();
+            Vector3 cameraPos = frame.camera_->GetNode()->GetWorldPosition();
+            unsigned topLevel = levels_.Size() - 1;
+            const IntVector2& numRoots = levels_[topLevel].numNodes_;
+            for (int z = 0; z < numRoots.y_; ++z)
+            {
+                for (int x = 0; x < numRoots.x_; ++x)
+                    SelectNode(topLevel, x, z, cameraPos, frustum);
+            }
+        }
+    }
+
+    batches_[0].worldTransform_ = nodeTransforms_.Size() ? &nodeTransforms_[0] : nullptr;
+    batches_[0].numWorldTransforms_ = nodeTransforms_.Size();
+}
+
+void TerrainClipmap::UpdateGeometry(const FrameInfo& frame)
+{
+    if (heightTexture_ && heightTexture_->IsDataLost())
+        UploadHeights();
+
+    if (parametersDirty_ || parametersLodBias_ != lodBias_)
+        UpdateShaderParameters();
+}
+
+UpdateGeometryType TerrainClipmap::GetUpdateGeometryType()
+{
+    if ((heightTexture_ && heightTexture_->IsDataLost()) || parametersDirty_ || parametersLodBias_ != lodBias_)
+        return UPDATE_MAIN_THREAD;
+    else
+        return UPDATE_NONE;
+}
+
+Geometry* TerrainClipmap::GetLodGeometry(unsigned batchIndex, unsigned level)
+{
+    return nullptr;
+}
+
+void TerrainClipmap::SetOwner(Terrain* terrain)
+{
+    owner_ = terrain;
+}
+
+void TerrainClipmap::SetMaterial(Material* material)
+{
+    originalMaterial_ = material;
+
+    if (!material)
+    {
+        auto* renderer = GetSubsystem<Renderer>();
+        material = renderer ? renderer->GetDefaultMaterial() : nullptr;
+    }
+
+    if (material)
+    {
+        material_ = material->Clone();
+        material_->SetVertexShaderDefines((material->GetVertexShaderDefines() + " " + CLIPMAP_DEFINE).Trimmed());
+        material_->SetTexture(TU_CUSTOM2, heightTexture_);
+    }
+    else
+        material_.Reset();
+
+    batches_[0].material_ = material_;
+    parametersDirty_ = true;
+}
+
+bool TerrainClipmap::Build()
+{
+    URHO3D_PROFILE(BuildTerrainClipmap);
+
+    levels_.Clear();
+    nodeTransforms_.Clear();
+    batches_[0].worldTransform_ = nullptr;
+    batches_[0].numWorldTransforms_ = 0;
+    heightTexture_.Reset();
+
+    if (!owner_ || !owner_->GetHeightData())
+        return false;
+
+    numVertices_ = owner_->GetNumVertices();
+    spacing_ = owner_->GetSpacing();
+    gridSize_ = owner_->GetPatchSize();
+    origin_ = Vector2(-0.5f * (float)(numVertices_.x_ - 1) * spacing_.x_, -0.5f * (float)(numVertices_.y_ - 1) * spacing_.z_);
+    if (numVertices_.x_ < 2 || numVertices_.y_ < 2)
+        return false;
+
+    CreateGrid();
+
+    heightTexture_ = new Texture2D(context_);
+    heightTexture_->SetNumLevels(1);
+    heightTexture_->SetFilterMode(FILTER_NEAREST);
+    heightTexture_->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+    heightTexture_->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+    if (!heightTexture_->SetSize(numVertices_.x_, numVertices_.y_, Graphics::GetFloat32Format()))
+    {
+        URHO3D_LOGERROR("Failed to create height texture for terrain clipmap");
+        heightTexture_.Reset();
+        return false;
+    }
+
+    // Create quadtree levels until one node covers the whole terrain
+    int numQuads = Max(numVertices_.x_, numVertices_.y_) - 1;
+    for (int nodeSize = gridSize_; ; nodeSize <<= 1)
+    {
+        Level level;
+        level.numNodes_ = IntVector2((numVertices_.x_ - 2 + nodeSize) / nodeSize, (numVertices_.y_ - 2 + nodeSize) / nodeSize);
+        level.heights_.Resize((unsigned)(level.numNodes_.x_ * level.numNodes_.y_));
+        levels_.Push(level);
+        if (nodeSize >= numQuads)
+            break;
+    }
+
+    UpdateRegion(IntRect(0, 0, numVertices_.x_ - 1, numVertices_.y_ - 1));
+    SetMaterial(originalMaterial_);
+
+    return true;
+}
+
+void TerrainClipmap::UpdateRegion(const IntRect& region)
+{
+    if (!owner_ || levels_.Empty())
+        return;
+
+    const float* heightData = owner_->GetHeightData().Get();
+    IntRect rect(Max(region.left_, 0), Max(region.top_, 0), Min(region.right_, numVertices_.x_ - 1),
+        Min(region.bottom_, numVertices_.y_ - 1));
+    if (!heightData || rect.right_ < rect.left_ || rect.bottom_ < rect.top_)
+        return;
+
+    // Upload whole rows, as they are contiguous in the height data
+    if (heightTexture_)
+    {
+        heightTexture_->SetData(0, 0, rect.top_, numVertices_.x_, rect.bottom_ - rect.top_ + 1,
+            heightData + rect.top_ * numVertices_.x_);
+    }
+
+    // Recalculate the height bounds of the finest nodes that contain the changed vertices. Vertices on a node edge belong to both
+    // nodes
+    Level& finest = levels_[0];
+    int startX = Max(rect.left_ - 1, 0) / gridSize_;
+    int endX = Min(rect.right_ / gridSize_, finest.numNodes_.x_ - 1);
+    int startZ = Max(rect.top_ - 1, 0) / gridSize_;
+    int endZ = Min(rect.bottom_ / gridSize_, finest.numNodes_.y_ - 1);
+
+    for (int z = startZ; z <= endZ; ++z)
+    {
+        for (int x = startX; x <= endX; ++x)
+        {
+            Vector2 heights(M_INFINITY, -M_INFINITY);
+            int maxVertexZ = Min(z * gridSize_ + gridSize_, numVertices_.y_ - 1);
+            int maxVertexX = Min(x * gridSize_ + gridSize_, numVertices_.x_ - 1);
+            for (int vz = z * gridSize_; vz <= maxVertexZ; ++vz)
+            {
+                const float* src = heightData + vz * numVertices_.x_;
+                for (int vx = x * gridSize_; vx <= maxVertexX; ++vx)
+                {
+                    heights.x_ = Min(heights.x_, src[vx]);
+                    heights.y_ = Max(heights.y_, src[vx]);
+                }
+            }
+            finest.heights_[z * finest.numNodes_.x_ + x] = heights;
+        }
+    }
+
+    // Propagate to the coarser levels
+    for (unsigned i = 1; i < levels_.Size(); ++i)
+    {
+        const Level& finer = levels_[i - 1];
+        Level& level = levels_[i];
+        startX >>= 1;
+        endX >>= 1;
+        startZ >>= 1;
+        endZ >>= 1;
+
+        for (int z = startZ; z <= endZ; ++z)
+        {
+            for (int x = startX; x <= endX; ++x)
+            {
+                Vector2 heights(M_INFINITY, -M_INFINITY);
+                for (int cz = z * 2; cz < Min(z * 2 + 2, finer.numNodes_.y_); ++cz)
+                {
+                    for (int cx = x * 2; cx < Min(x * 2 + 2, finer.numNodes_.x_); ++cx)
+                    {
+                        const Vector2& childHeights = finer.heights_[cz * finer.numNodes_.x_ + cx];
+                        heights.x_ = Min(heights.x_, childHeights.x_);
+                        heights.y_ = Max(heights.y_, childHeights.y_);
+                    }
+                }
+                level.heights_[z * level.numNodes_.x_ + x] = heights;
+            }
+        }
+    }
+
+    UpdateBoundingBox();
+}
+
+Terrain* TerrainClipmap::GetOwner() const
+{
+    return owner_;
+}
+
+Texture2D* TerrainClipmap::GetHeightTexture() const
+{
+    return heightTexture_;
+}
+
+Material* TerrainClipmap::GetClipmapMaterial() const
+{
+    return material_;
+}
+
+void TerrainClipmap::OnMarkedDirty(Node* node)
+{
+    Drawable::OnMarkedDirty(node);
+
+    parametersDirty_ = true;
+}
+
+void TerrainClipmap::OnWorldBoundingBoxUpdate()
+{
+    worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform());
+}
+
+void TerrainClipmap::CreateGrid()
+{
+    auto row = (unsigned)(gridSize_ + 1);
+
+    // Only the position is used, but the other elements of the terrain vertex format are included for the shaders' input layouts
+    PODVector<float> vertexData;
+    vertexData.Reserve(row * row * 12);
+    for (unsigned z = 0; z < row; ++z)
+    {
+        for (unsigned x = 0; x < row; ++x)
+        {
+            // Position
+            vertexData.Push((float)x);
+            vertexData.Push(0.0f);
+            vertexData.Push((float)z);
+            // Normal
+            vertexData.Push(0.0f);
+            vertexData.Push(1.0f);
+            vertexData.Push(0.0f);
+            // Texture coordinate
+            vertexData.Push(0.0f);
+            vertexData.Push(0.0f);
+            // Tangent
+            vertexData.Push(1.0f);
+            vertexData.Push(0.0f);
+            vertexData.Push(0.0f);
+            vertexData.Push(1.0f);
+        }
+    }
+
+    vertexBuffer_->SetSize(row * row, MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT);
+    vertexBuffer_->SetData(vertexData.Buffer());
+
+    // Use the same triangulation as the terrain patches. It stays intact when the odd vertices collapse to the even ones
+    PODVector<unsigned short> indices;
+    indices.Reserve((unsigned)(gridSize_ * gridSize_ * 6));
+    for (unsigned z = 0; z < (unsigned)gridSize_; ++z)
+    {
+        for (unsigned x = 0; x < (unsigned)gridSize_; ++x)
+        {
+            indices.Push((unsigned short)((z + 1) * row + x));
+            indices.Push((unsigned short)(z * row + x + 1));
+            indices.Push((unsigned short)(z * row + x));
+            indices.Push((unsigned short)((z + 1) * row + x));
+            indices.Push((unsigned short)((z + 1) * row + x + 1));
+            indices.Push((unsigned short)(z * row + x + 1));
+        }
+    }
+
+    indexBuffer_->SetSize(indices.Size(), false);
+    indexBuffer_->SetData(indices.Buffer());
+    geometry_->SetDrawRange(TRIANGLE_LIST, 0, indices.Size(), 0, row * row);
+}
+
+void TerrainClipmap::UploadHeights()
+{
+    const float* heightData = owner_ ? owner_->GetHeightData().Get() : nullptr;
+    if (heightData)
+        heightTexture_->SetData(0, 0, 0, numVertices_.x_, numVertices_.y_, heightData);
+    heightTexture_->ClearDataLost();
+}
+
+void TerrainClipmap::UpdateShaderParameters()
+{
+    parametersDirty_ = false;
+    parametersLodBias_ = lodBias_;
+    if (!material_ || !node_)
+        return;
+
+    // Map heightmap texel coordinates and heights to world space
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    Vector3 axisX = worldTransform * Vector4(spacing_.x_, 0.0f, 0.0f, 0.0f);
+    float rangeFactor = Max(RANGE_FACTOR * lodBias_, MIN_RANGE_FACTOR);
+    material_->SetShaderParameter("ClipmapOrigin", worldTransform * Vector3(origin_.x_, 0.0f, origin_.y_));
+    material_->SetShaderParameter("ClipmapAxisX", axisX);
+    material_->SetShaderParameter("ClipmapAxisY", worldTransform * Vector4(0.0f, 1.0f, 0.0f, 0.0f));
+    material_->SetShaderParameter("ClipmapAxisZ", worldTransform * Vector4(0.0f, 0.0f, spacing_.z_, 0.0f));
+    material_->SetShaderParameter("ClipmapMorph", Vector4(axisX.Length() * (float)gridSize_ * rangeFactor, MORPH_START,
+        (float)numVertices_.x_, (float)numVertices_.y_));
+}
+
+void TerrainClipmap::UpdateBoundingBox()
+{
+    const Level& top = levels_.Back();
+    Vector2 heights(M_INFINITY, -M_INFINITY);
+    for (unsigned i = 0; i < top.heights_.Size(); ++i)
+    {
+        heights.x_ = Min(heights.x_, top.heights_[i].x_);
+        heights.y_ = Max(heights.y_, top.heights_[i].y_);
+    }
+
+    boundingBox_ = BoundingBox(Vector3(origin_.x_, heights.x_, origin_.y_), Vector3(origin_.x_ + (float)(numVertices_.x_ - 1) *
+        spacing_.x_, heights.y_, origin_.y_ + (float)(numVertices_.y_ - 1) * spacing_.z_));
+    OnMarkedDirty(node_);
+}
+
+BoundingBox TerrainClipmap::GetNodeBox(unsigned level, int x, int z) const
+{
+    const Level& nodeLevel = levels_[level];
+    const Vector2& heights = nodeLevel.heights_[z * nodeLevel.numNodes_.x_ + x];
+    int nodeSize = gridSize_ << level;
+    int minX = x * nodeSize;
+    int minZ = z * nodeSize;
+    int maxX = Min(minX + nodeSize, numVertices_.x_ - 1);
+    int maxZ = Min(minZ + nodeSize, numVertices_.y_ - 1);
+
+    return BoundingBox(Vector3(origin_.x_ + (float)minX * spacing_.x_, heights.x_, origin_.y_ + (float)minZ * spacing_.z_),
+        Vector3(origin_.x_ + (float)maxX * spacing_.x_, heights.y_, origin_.y_ + (float)maxZ * spacing_.z_));
+}
+
+void TerrainClipmap::SelectNode(unsigned level, int x, int z, const Vector3& cameraPos, const Frustum* frustum)
+{
+    BoundingBox worldBox = GetNodeBox(level, x, z).Transformed(selectionTransform_);
+    if (frustum && frustum->IsInsideFast(worldBox) == OUTSIDE)
+        return;
+
+    // Subdivide the node if it is within the range of the next finer level
+    if (level && Sphere(cameraPos, ranges_[level - 1]).IsInsideFast(worldBox) != OUTSIDE)
+    {
+        const Level& finer = levels_[level - 1];
+        for (int cz = z * 2; cz < Min(z * 2 + 2, finer.numNodes_.y_); ++cz)
+        {
+            for (int cx = x * 2; cx < Min(x * 2 + 2, finer.numNodes_.x_); ++cx)
+                SelectNode(level - 1, cx, cz, cameraPos, frustum);
+        }
+    }
+    else
+    {
+        // Transform the grid to the node's heightmap texels
+        int nodeSize = gridSize_ << level;
+        auto scale = (float)(1u << level);
+        nodeTransforms_.Push(Matrix3x4(Vector3((float)(x * nodeSize), 0.0f, (float)(z * nodeSize)), Quaternion::IDENTITY,
+            Vector3(scale, 1.0f, scale)));
+    }
+}
+
+float TerrainClipmap::GetHitDistance(const Ray& localRay, Vector3* outNormal) const
+{
+    const float* heightData = owner_ ? owner_->GetHeightData().Get() : nullptr;
+    float start = localRay.HitDistance(boundingBox_);
+    if (!heightData || levels_.Empty() || start == M_INFINITY)
+        return M_INFINITY;
+
+    auto getVertex = [&](int x, int z)
+    {
+        return Vector3(origin_.x_ + (float)x * spacing_.x_, heightData[z * numVertices_.x_ + x], origin_.y_ + (float)z * spacing_.z_);
+    };
+
+    // Walk the heightmap cells under the ray in order, starting from where it enters the bounding box
+    const Vector3& origin = localRay.origin_;
+    const Vector3& dir = localRay.direction_;
+    Vector3 startPos = origin + start * dir;
+    int x = Clamp((int)floorf((startPos.x_ - origin_.x_) / spacing_.x_), 0, numVertices_.x_ - 2);
+    int z = Clamp((int)floorf((startPos.z_ - origin_.y_) / spacing_.z_), 0, numVertices_.y_ - 2);
+    int stepX = dir.x_ >= 0.0f ? 1 : -1;
+    int stepZ = dir.z_ >= 0.0f ? 1 : -1;
+    float deltaX = dir.x_ != 0.0f ? Abs(spacing_.x_ / dir.x_) : M_INFINITY;
+    float deltaZ = dir.z_ != 0.0f ? Abs(spacing_.z_ / dir.z_) : M_INFINITY;
+    float nextX = dir.x_ != 0.0f ? (origin_.x_ + (float)(x + (stepX > 0 ? 1 : 0)) * spacing_.x_ - origin.x_) / dir.x_ : M_INFINITY;
+    float nextZ = dir.z_ != 0.0f ? (origin_.y_ + (float)(z + (stepZ > 0 ? 1 : 0)) * spacing_.z_ - origin.z_) / dir.z_ : M_INFINITY;
+
+    while (x >= 0 && x < numVertices_.x_ - 1 && z >= 0 && z < numVertices_.y_ - 1)
+    {
+        Vector3 v00 = getVertex(x, z);
+        Vector3 v10 = getVertex(x + 1, z);
+        Vector3 v01 = getVertex(x, z + 1);
+        Vector3 v11 = getVertex(x + 1, z + 1);
+        Vector3 normal1;
+        Vector3 normal2;
+        float distance1 = localRay.HitDistance(v01, v10, v00, &normal1);
+        float distance2 = localRay.HitDistance(v01, v11, v10, &normal2);
+        if (distance1 < M_INFINITY || distance2 < M_INFINITY)
+        {
+            if (outNormal)
+                *outNormal = distance1 < distance2 ? normal1 : normal2;
+            return Min(distance1, distance2);
+        }
+
+        // Stop when the ray has risen above the terrain
+        float exitDistance = Min(nextX, nextZ);
+        if (dir.y_ >= 0.0f && origin.y_ + exitDistance * dir.y_ > boundingBox_.max_.y_)
+            break;
+
+        if (nextX < nextZ)
+        {
+            x += stepX;
+            nextX += deltaX;
+        }
+        else
+        {
+            z += stepZ;
+            nextZ += deltaZ;
+        }
+    }
+
+    return M_INFINITY;
+}
+
+}
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Graphics/Drawable.h"
+
+namespace Urho3D
+{
+
+class Frustum;
+class Geometry;
+class IndexBuffer;
+class Terrain;
+class Texture2D;
+class VertexBuffer;
+
+/// Renders a heightmap terrain on the GPU. One shared grid mesh is drawn for each selected node of a quadtree, with the nodes growing in size with the distance to the camera, and displaced in the vertex shader by a height texture. Requires OpenGL 3 or Direct3D 11.
+class URHO3D_API TerrainClipmap : public Drawable
+{
+    URHO3D_OBJECT(TerrainClipmap, Drawable);
+
+public:
+    /// Construct.
+    explicit TerrainClipmap(Context* context);
+    /// Destruct.
+    ~TerrainClipmap() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Process octree raycast. May be called from a worker thread.
+    void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results) override;
+    /// Select the quadtree nodes to draw and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
+    void UpdateBatches(const FrameInfo& frame) override;
+    /// Restore the height texture if lost, and update the shader parameters after a transform change.
+    void UpdateGeometry(const FrameInfo& frame) override;
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    UpdateGeometryType GetUpdateGeometryType() override;
+    /// Return the geometry for a specific LOD level. Returns null, as the grid has no CPU-side heights; decals are not supported.
+    Geometry* GetLodGeometry(unsigned batchIndex, unsigned level) override;
+
+    /// Set owner terrain.
+    void SetOwner(Terrain* terrain);
+    /// Set material. It is cloned with the CLIPMAP vertex shader define and the height texture added.
+    void SetMaterial(Material* material);
+    /// Rebuild the grid mesh, height texture and quadtree from the owner terrain's height data. Return true if successful.
+    bool Build();
+    /// Update a region of the height texture and the quadtree height bounds after the owner terrain's height data changed. The region is in heightmap vertex coordinates and inclusive.
+    void UpdateRegion(const IntRect& region);
+
+    /// Return owner terrain.
+    Terrain* GetOwner() const;
+    /// Return the height texture.
+    Texture2D* GetHeightTexture() const;
+    /// Return the cloned clipmap material.
+    Material* GetClipmapMaterial() const;
+    /// Return number of quadtree levels.
+    unsigned GetNumLevels() const { return levels_.Size(); }
+    /// Return number of nodes selected for drawing in the last frame.
+    unsigned GetNumSelectedNodes() const { return nodeTransforms_.Size(); }
+
+protected:
+    /// Handle node transform being dirtied.
+    void OnMarkedDirty(Node* node) override;
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    /// Quadtree level.
+    struct Level
+    {
+        /// Number of nodes in the X and Z directions.
+        IntVector2 numNodes_;
+        /// Minimum and maximum heights of the nodes.
+        PODVector<Vector2> heights_;
+    };
+
+    /// Create the shared grid mesh.
+    void CreateGrid();
+    /// Upload the whole height texture.
+    void UploadHeights();
+    /// Update the shader parameters from the terrain's world transform.
+    void UpdateShaderParameters();
+    /// Update the local-space bounding box from the quadtree roots.
+    void UpdateBoundingBox();
+    /// Return the local-space bounding box of a quadtree node.
+    BoundingBox GetNodeBox(unsigned level, int x, int z) const;
+    /// Select a node or its children for drawing.
+    void SelectNode(unsigned level, int x, int z, const Vector3& cameraPos, const Frustum* frustum);
+    /// Return the distance along a local-space ray to the heightmap triangles, or infinity if no hit.
+    float GetHitDistance(const Ray& localRay, Vector3* outNormal) const;
+
+    /// Grid geometry.
+    SharedPtr<Geometry> geometry_;
+    /// Grid vertex buffer.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Grid index buffer.
+    SharedPtr<IndexBuffer> indexBuffer_;
+    /// Height texture.
+    SharedPtr<Texture2D> heightTexture_;
+    /// Original material.
+    SharedPtr<Material> originalMaterial_;
+    /// Cloned material with the clipmap define, height texture and parameters.
+    SharedPtr<Material> material_;
+    /// Parent terrain.
+    WeakPtr<Terrain> owner_;
+    /// Quadtree levels, the finest first.
+    Vector<Level> levels_;
+    /// Camera distance range of each quadtree level.
+    PODVector<float> ranges_;
+    /// Grid to heightmap texel transforms of the selected nodes.
+    PODVector<Matrix3x4> nodeTransforms_;
+    /// Terrain world transform used during node selection.
+    Matrix3x4 selectionTransform_;
+    /// Heightmap size in vertices.
+    IntVector2 numVertices_;
+    /// Local-space position of the first heightmap vertex.
+    Vector2 origin_;
+    /// Vertex spacing.
+    Vector3 spacing_;
+    /// Number of grid quads per side.
+    int gridSize_;
+    /// Frame number of the last node selection.
+    unsigned selectionFrameNumber_;
+    /// Shader parameters dirty flag.
+    bool parametersDirty_;
+    /// LOD bias the shader parameters were calculated with.
+    float parametersLodBias_;
+};
+
+}
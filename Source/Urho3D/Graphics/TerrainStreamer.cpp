@@ -0,0 +1,674 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/DrawableEvents.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Terrain.h"
+#include "../Graphics/TerrainStreamer.h"
+#include "../IO/Log.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/CollisionShape.h"
+#include "../Physics/RigidBody.h"
+#endif
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+
+static const String DEFAULT_HEIGHTMAP_EXTENSION(".png");
+static const IntVector2 DEFAULT_NUM_TILES(8, 8);
+static const int DEFAULT_TILE_SIZE = 1024;
+static const Vector3 DEFAULT_SPACING(1.0f, 0.25f, 1.0f);
+static const int DEFAULT_PATCH_SIZE = 32;
+static const unsigned DEFAULT_MAX_LOD_LEVELS = 4;
+static const float DEFAULT_STREAMING_DISTANCE = 1500.0f;
+static const unsigned DEFAULT_COLLISION_LAYER = 0x1;
+static const unsigned DEFAULT_COLLISION_MASK = M_MAX_UNSIGNED;
+
+/// Return the distance on the XZ plane from a position relative to the grid origin to a tile.
+static float GetTileDistance(const IntVector2& coords, const Vector2& tileSize, const Vector2& position)
+{
+    const Vector2 min = Vector2((float)coords.x_, (float)coords.y_) * tileSize;
+    const Vector2 max = min + tileSize;
+    return VectorMax(VectorMax(min - position, position - max), Vector2::ZERO).Length();
+}
+
+TerrainStreamer::TerrainStreamer(Context* context) :
+    Component(context),
+    heightMapExtension_(DEFAULT_HEIGHTMAP_EXTENSION),
+    numTiles_(DEFAULT_NUM_TILES),
+    tileSize_(DEFAULT_TILE_SIZE),
+    spacing_(DEFAULT_SPACING),
+    patchSize_(DEFAULT_PATCH_SIZE),
+    maxLodLevels_(DEFAULT_MAX_LOD_LEVELS),
+    drawDistance_(0.0f),
+    castShadows_(false),
+    streamingDistance_(DEFAULT_STREAMING_DISTANCE),
+    physics_(false),
+    physicsLodLevel_(0),
+    collisionLayer_(DEFAULT_COLLISION_LAYER),
+    collisionMask_(DEFAULT_COLLISION_MASK)
+{
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+    UnloadTiles();
+}
+
+void TerrainStreamer::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TerrainStreamer>(GEOMETRY_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Height Map Path", GetHeightMapPath, SetHeightMapPath, String, String::EMPTY, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Height Map Extension", GetHeightMapExtension, SetHeightMapExtension, String,
+        DEFAULT_HEIGHTMAP_EXTENSION, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Number Of Tiles", GetNumTiles, SetNumTiles, IntVector2, DEFAULT_NUM_TILES, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Tile Size", GetTileSize, SetTileSize, int, DEFAULT_TILE_SIZE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Vertex Spacing", GetSpacing, SetSpacing, Vector3, DEFAULT_SPACING, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Patch Size", GetPatchSize, SetPatchSize, int, DEFAULT_PATCH_SIZE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max LOD Levels", GetMaxLodLevels, SetMaxLodLevels, unsigned, DEFAULT_MAX_LOD_LEVELS, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Material", GetMaterialAttr, SetMaterialAttr, ResourceRef, ResourceRef(Material::GetTypeStatic()),
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cast Shadows", GetCastShadows, SetCastShadows, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Distance", GetStreamingDistance, SetStreamingDistance, float, DEFAULT_STREAMING_DISTANCE,
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Physics", GetPhysics, SetPhysics, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Physics LOD Level", GetPhysicsLodLevel, SetPhysicsLodLevel, unsigned, 0, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Collision Layer", GetCollisionLayer, SetCollisionLayer, unsigned, DEFAULT_COLLISION_LAYER, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Collision Mask", GetCollisionMask, SetCollisionMask, unsigned, DEFAULT_COLLISION_MASK, AM_DEFAULT);
+}
+
+void TerrainStreamer::OnSetEnabled()
+{
+    UpdateFrameSubscription();
+}
+
+void TerrainStreamer::SetHeightMapPath(const String& path)
+{
+    if (path != heightMapPath_)
+    {
+        UnloadTiles();
+        heightMapPath_ = path;
+        UpdateFrameSubscription();
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetHeightMapExtension(const String& extension)
+{
+    if (extension != heightMapExtension_)
+    {
+        UnloadTiles();
+        heightMapExtension_ = extension;
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetNumTiles(const IntVector2& tiles)
+{
+    const IntVector2 numTiles = VectorMax(tiles, IntVector2::ONE);
+    if (numTiles != numTiles_)
+    {
+        UnloadTiles();
+        numTiles_ = numTiles;
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetTileSize(int quads)
+{
+    quads = Max(quads, 1);
+    if (quads != tileSize_)
+    {
+        UnloadTiles();
+        tileSize_ = quads;
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetSpacing(const Vector3& spacing)
+{
+    if (spacing != spacing_)
+    {
+        spacing_ = spacing;
+
+        // The tiles are moved to their new positions as well
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            Terrain* terrain = i->second_;
+            if (terrain && terrain->GetNode())
+            {
+                const Vector2 center = (Vector2((float)i->first_.x_, (float)i->first_.y_) + Vector2(0.5f, 0.5f)) * GetTileWorldSize();
+                terrain->GetNode()->SetPosition(Vector3(center.x_, 0.0f, center.y_));
+                terrain->SetSpacing(spacing_);
+            }
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetPatchSize(int size)
+{
+    if (size != patchSize_)
+    {
+        patchSize_ = size;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                i->second_->SetPatchSize(patchSize_);
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetMaxLodLevels(unsigned levels)
+{
+    if (levels != maxLodLevels_)
+    {
+        maxLodLevels_ = levels;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                i->second_->SetMaxLodLevels(maxLodLevels_);
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetMaterial(Material* material)
+{
+    material_ = material;
+    for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+    {
+        if (i->second_)
+            i->second_->SetMaterial(material_);
+    }
+
+    MarkNetworkUpdate();
+}
+
+void TerrainStreamer::SetDrawDistance(float distance)
+{
+    drawDistance_ = distance;
+    for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+    {
+        if (i->second_)
+            i->second_->SetDrawDistance(drawDistance_);
+    }
+
+    MarkNetworkUpdate();
+}
+
+void TerrainStreamer::SetCastShadows(bool enable)
+{
+    castShadows_ = enable;
+    for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+    {
+        if (i->second_)
+            i->second_->SetCastShadows(castShadows_);
+    }
+
+    MarkNetworkUpdate();
+}
+
+void TerrainStreamer::SetStreamingDistance(float distance)
+{
+    streamingDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void TerrainStreamer::SetPhysics(bool enable)
+{
+    if (enable != physics_)
+    {
+        physics_ = enable;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                ApplyTilePhysics(i->second_->GetNode());
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetPhysicsLodLevel(unsigned level)
+{
+    if (level != physicsLodLevel_)
+    {
+        physicsLodLevel_ = level;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                ApplyTilePhysics(i->second_->GetNode());
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetCollisionLayer(unsigned layer)
+{
+    if (layer != collisionLayer_)
+    {
+        collisionLayer_ = layer;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                ApplyTilePhysics(i->second_->GetNode());
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::SetCollisionMask(unsigned mask)
+{
+    if (mask != collisionMask_)
+    {
+        collisionMask_ = mask;
+        for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        {
+            if (i->second_)
+                ApplyTilePhysics(i->second_->GetNode());
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
+void TerrainStreamer::AddStreamingObserver(Node* node)
+{
+    if (!node)
+        return;
+
+    for (unsigned i = 0; i < streamingObservers_.Size(); ++i)
+    {
+        if (streamingObservers_[i] == node)
+            return;
+    }
+
+    streamingObservers_.Push(WeakPtr<Node>(node));
+    UpdateFrameSubscription();
+}
+
+void TerrainStreamer::RemoveStreamingObserver(Node* node)
+{
+    for (unsigned i = 0; i < streamingObservers_.Size(); ++i)
+    {
+        if (streamingObservers_[i] == node)
+        {
+            streamingObservers_.Erase(i);
+            break;
+        }
+    }
+
+    UpdateFrameSubscription();
+}
+
+void TerrainStreamer::UnloadTiles()
+{
+    PODVector<IntVector2> coords;
+    for (HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Begin(); i != tiles_.End(); ++i)
+        coords.Push(i->first_);
+    for (unsigned i = 0; i < coords.Size(); ++i)
+        RemoveTile(coords[i]);
+
+    // The heightmaps still loading are ignored when they finish
+    streamedTiles_.Clear();
+    loadingTiles_.Clear();
+    loadedHeightMaps_.Clear();
+    if (HasSubscribedToEvent(E_RESOURCEBACKGROUNDLOADED))
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+}
+
+Material* TerrainStreamer::GetMaterial() const
+{
+    return material_;
+}
+
+Vector2 TerrainStreamer::GetTileWorldSize() const
+{
+    return Vector2((float)tileSize_ * spacing_.x_, (float)tileSize_ * spacing_.z_);
+}
+
+IntVector2 TerrainStreamer::GetTileCoordinates(const Vector3& worldPosition) const
+{
+    if (!node_)
+        return IntVector2::ZERO;
+
+    const Vector3 position = node_->GetWorldTransform().Inverse() * worldPosition;
+    return VectorFloorToInt(Vector2(position.x_, position.z_) / GetTileWorldSize());
+}
+
+Terrain* TerrainStreamer::GetTile(const IntVector2& coords) const
+{
+    HashMap<IntVector2, WeakPtr<Terrain> >::ConstIterator i = tiles_.Find(coords);
+    return i != tiles_.End() ? i->second_.Get() : nullptr;
+}
+
+float TerrainStreamer::GetHeight(const Vector3& worldPosition) const
+{
+    Terrain* terrain = GetTile(GetTileCoordinates(worldPosition));
+    return terrain ? terrain->GetHeight(worldPosition) : 0.0f;
+}
+
+void TerrainStreamer::SetMaterialAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetMaterial(cache->GetResource<Material>(value.name_));
+}
+
+ResourceRef TerrainStreamer::GetMaterialAttr() const
+{
+    return GetResourceRef(material_, Material::GetTypeStatic());
+}
+
+void TerrainStreamer::UpdateStreaming()
+{
+    if (!node_ || heightMapPath_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateTerrainStreaming);
+
+    // Observer positions on the XZ plane, relative to the grid origin
+    const Matrix3x4 inverseWorld = node_->GetWorldTransform().Inverse();
+    PODVector<Vector2> positions;
+    for (unsigned i = 0; i < streamingObservers_.Size();)
+    {
+        Node* observer = streamingObservers_[i];
+        if (observer)
+        {
+            const Vector3 position = inverseWorld * observer->GetWorldPosition();
+            positions.Push(Vector2(position.x_, position.z_));
+            ++i;
+        }
+        else
+            streamingObservers_.Erase(i);
+    }
+
+    if (positions.Empty())
+        return;
+
+    const Vector2 tileSize = GetTileWorldSize();
+    const float unloadDistance = streamingDistance_ + Max(tileSize.x_, tileSize.y_);
+
+    // Remove the tiles far from all observers. The extra tile edge avoids reloading when moving back and forth at the border
+    PODVector<IntVector2> farTiles;
+    for (HashSet<IntVector2>::ConstIterator i = streamedTiles_.Begin(); i != streamedTiles_.End(); ++i)
+    {
+        float distance = M_INFINITY;
+        for (unsigned j = 0; j < positions.Size(); ++j)
+            distance = Min(distance, GetTileDistance(*i, tileSize, positions[j]));
+        if (distance > unloadDistance)
+            farTiles.Push(*i);
+    }
+
+    for (unsigned i = 0; i < farTiles.Size(); ++i)
+    {
+        RemoveTile(farTiles[i]);
+        streamedTiles_.Erase(farTiles[i]);
+    }
+
+    // Request the tiles near any observer
+    const IntVector2 lastTile = numTiles_ - IntVector2::ONE;
+    const Vector2 distance(streamingDistance_, streamingDistance_);
+    for (unsigned i = 0; i < positions.Size(); ++i)
+    {
+        const IntVector2 from = VectorMax(IntVector2::ZERO, VectorFloorToInt((positions[i] - distance) / tileSize));
+        const IntVector2 to = VectorMin(lastTile, VectorFloorToInt((positions[i] + distance) / tileSize));
+        for (int z = from.y_; z <= to.y_; ++z)
+        {
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                const IntVector2 coords(x, z);
+                if (!streamedTiles_.Contains(coords) && GetTileDistance(coords, tileSize, positions[i]) <= streamingDistance_)
+                    RequestTile(coords);
+            }
+        }
+    }
+}
+
+void TerrainStreamer::RequestTile(const IntVector2& coords)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    const String name = GetTileHeightMapName(coords);
+    streamedTiles_.Insert(coords);
+
+    // Without threading support the heightmap is loaded immediately. A missing heightmap leaves a hole in the grid
+    cache->BackgroundLoadResource<Image>(name, false);
+    auto* heightMap = cache->GetExistingResource<Image>(name);
+    if (heightMap)
+    {
+        loadedHeightMaps_.Push(MakePair(coords, SharedPtr<Image>(heightMap)));
+        cache->ReleaseResource(Image::GetTypeStatic(), name, true);
+    }
+    else
+    {
+        loadingTiles_[StringHash(name)] = coords;
+        if (!HasSubscribedToEvent(E_RESOURCEBACKGROUNDLOADED))
+            SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(TerrainStreamer, HandleResourceBackgroundLoaded));
+    }
+}
+
+void TerrainStreamer::CreateTile(const IntVector2& coords, Image* heightMap)
+{
+    URHO3D_PROFILE(CreateTerrainTile);
+
+    if (heightMap->GetWidth() != tileSize_ + 1 || heightMap->GetHeight() != tileSize_ + 1)
+    {
+        URHO3D_LOGERRORF("Terrain tile heightmap %s is %dx%d, expected %dx%d", heightMap->GetName().CString(), heightMap->GetWidth(),
+            heightMap->GetHeight(), tileSize_ + 1, tileSize_ + 1);
+        return;
+    }
+
+    // The tiles are not saved with the scene or replicated, as they are streamed on each client
+    Node* tileNode = node_->CreateTemporaryChild(ToString("TerrainTile_%d_%d", coords.x_, coords.y_), LOCAL);
+    const Vector2 center = (Vector2((float)coords.x_, (float)coords.y_) + Vector2(0.5f, 0.5f)) * GetTileWorldSize();
+    tileNode->SetPosition(Vector3(center.x_, 0.0f, center.y_));
+
+    auto* terrain = tileNode->CreateComponent<Terrain>(LOCAL);
+    ApplyTileSettings(terrain);
+    terrain->SetHeightMap(heightMap);
+    tiles_[coords] = terrain;
+
+    // Link the adjacent tiles both ways so that the edge patches are stitched
+    Terrain* north = GetTile(coords + IntVector2(0, 1));
+    Terrain* south = GetTile(coords - IntVector2(0, 1));
+    Terrain* west = GetTile(coords - IntVector2(1, 0));
+    Terrain* east = GetTile(coords + IntVector2(1, 0));
+    terrain->SetNeighbors(north, south, west, east);
+    if (north)
+        north->SetSouthNeighbor(terrain);
+    if (south)
+        south->SetNorthNeighbor(terrain);
+    if (west)
+        west->SetEastNeighbor(terrain);
+    if (east)
+        east->SetWestNeighbor(terrain);
+
+    ApplyTilePhysics(tileNode);
+
+    using namespace TerrainTileLoaded;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_NODE] = node_;
+    eventData[P_TILE] = coords;
+    eventData[P_TERRAIN] = terrain;
+    node_->SendEvent(E_TERRAINTILELOADED, eventData);
+}
+
+void TerrainStreamer::RemoveTile(const IntVector2& coords)
+{
+    HashMap<IntVector2, WeakPtr<Terrain> >::Iterator i = tiles_.Find(coords);
+    if (i == tiles_.End())
+        return;
+
+    SharedPtr<Terrain> terrain(i->second_.Get());
+    tiles_.Erase(i);
+    if (!terrain || !terrain->GetNode())
+        return;
+
+    if (node_)
+    {
+        using namespace TerrainTileUnloaded;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_TILE] = coords;
+        eventData[P_TERRAIN] = terrain.Get();
+        node_->SendEvent(E_TERRAINTILEUNLOADED, eventData);
+    }
+
+    Terrain* north = GetTile(coords + IntVector2(0, 1));
+    Terrain* south = GetTile(coords - IntVector2(0, 1));
+    Terrain* west = GetTile(coords - IntVector2(1, 0));
+    Terrain* east = GetTile(coords + IntVector2(1, 0));
+    if (north)
+        north->SetSouthNeighbor(nullptr);
+    if (south)
+        south->SetNorthNeighbor(nullptr);
+    if (west)
+        west->SetEastNeighbor(nullptr);
+    if (east)
+        east->SetWestNeighbor(nullptr);
+
+    terrain->GetNode()->Remove();
+}
+
+void TerrainStreamer::ApplyTileSettings(Terrain* terrain) const
+{
+    terrain->SetSpacing(spacing_);
+    terrain->SetPatchSize(patchSize_);
+    terrain->SetMaxLodLevels(maxLodLevels_);
+    terrain->SetMaterial(material_);
+    terrain->SetDrawDistance(drawDistance_);
+    terrain->SetCastShadows(castShadows_);
+}
+
+void TerrainStreamer::ApplyTilePhysics(Node* tileNode) const
+{
+#ifdef URHO3D_PHYSICS
+    if (!tileNode)
+        return;
+
+    if (physics_)
+    {
+        auto* body = tileNode->GetOrCreateComponent<RigidBody>(LOCAL);
+        body->SetCollisionLayerAndMask(collisionLayer_, collisionMask_);
+        auto* shape = tileNode->GetOrCreateComponent<CollisionShape>(LOCAL);
+        if (shape->GetShapeType() != SHAPE_TERRAIN || shape->GetLodLevel() != physicsLodLevel_)
+            shape->SetTerrain(physicsLodLevel_);
+    }
+    else
+    {
+        tileNode->RemoveComponent<CollisionShape>();
+        tileNode->RemoveComponent<RigidBody>();
+    }
+#else
+    if (physics_)
+        URHO3D_LOGWARNING("Terrain tile physics requires the physics library");
+#endif
+}
+
+String TerrainStreamer::GetTileHeightMapName(const IntVector2& coords) const
+{
+    return heightMapPath_ + ToString("%d_%d", coords.x_, coords.y_) + heightMapExtension_;
+}
+
+void TerrainStreamer::UpdateFrameSubscription()
+{
+    bool pending = IsEnabledEffective() && ((!heightMapPath_.Empty() && !streamingObservers_.Empty()) || !loadedHeightMaps_.Empty());
+    if (pending && !HasSubscribedToEvent(E_BEGINFRAME))
+        SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(TerrainStreamer, HandleBeginFrame));
+    else if (!pending && HasSubscribedToEvent(E_BEGINFRAME))
+        UnsubscribeFromEvent(E_BEGINFRAME);
+}
+
+void TerrainStreamer::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    UpdateStreaming();
+
+    // Creating a large terrain takes a while, so at most one tile is created per frame. Tiles that became far while waiting are skipped
+    while (!loadedHeightMaps_.Empty() && node_)
+    {
+        const IntVector2 coords = loadedHeightMaps_.Front().first_;
+        SharedPtr<Image> heightMap = loadedHeightMaps_.Front().second_;
+        loadedHeightMaps_.Erase(0);
+        if (streamedTiles_.Contains(coords) && !tiles_.Contains(coords))
+        {
+            CreateTile(coords, heightMap);
+            break;
+        }
+    }
+
+    UpdateFrameSubscription();
+}
+
+void TerrainStreamer::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    HashMap<StringHash, IntVector2>::Iterator i = loadingTiles_.Find(StringHash(eventData[P_RESOURCENAME].GetString()));
+    if (i == loadingTiles_.End())
+        return;
+
+    const IntVector2 coords = i->second_;
+    loadingTiles_.Erase(i);
+    if (loadingTiles_.Empty())
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+
+    auto* heightMap = static_cast<Image*>(eventData[P_RESOURCE].GetPtr());
+    if (!eventData[P_SUCCESS].GetBool() || !heightMap)
+        return;
+
+    // The terrain keeps the heightmap, so it does not need to stay in the cache. It is freed when the tile is removed
+    SharedPtr<Image> heightMapHolder(heightMap);
+    GetSubsystem<ResourceCache>()->ReleaseResource(Image::GetTypeStatic(), heightMap->GetName(), true);
+
+    // The tile may have been removed, or the streaming settings changed, while it was loading
+    if (streamedTiles_.Contains(coords) && heightMap->GetName() == GetTileHeightMapName(coords))
+    {
+        loadedHeightMaps_.Push(MakePair(coords, heightMapHolder));
+        UpdateFrameSubscription();
+    }
+}
+
+}
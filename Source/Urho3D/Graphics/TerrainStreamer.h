@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+class Image;
+class Material;
+class Terrain;
+
+/// Streams a grid of terrain tiles around observer nodes. Each tile is a Terrain in a temporary child node, whose heightmap is loaded in the background from a resource named by the tile coordinates. Adjacent tiles are linked as neighbors, and optionally get a static rigid body with a heightfield collision shape.
+class URHO3D_API TerrainStreamer : public Component
+{
+    URHO3D_OBJECT(TerrainStreamer, Component);
+
+public:
+    /// Construct.
+    explicit TerrainStreamer(Context* context);
+    /// Destruct.
+    ~TerrainStreamer() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Handle enabled/disabled state change. A disabled streamer keeps its tiles but does not load or remove any.
+    void OnSetEnabled() override;
+
+    /// Set the resource name prefix of the tile heightmaps. The heightmap of a tile is named prefix + "x_z" + extension, for example "Terrain/Tiles/3_5.png". Empty (default) disables streaming.
+    void SetHeightMapPath(const String& path);
+    /// Set the file extension of the tile heightmaps, including the dot.
+    void SetHeightMapExtension(const String& extension);
+    /// Set number of tiles in X and Z direction. Tile (0, 0) starts at the node origin, and the tiles extend to positive X (east) and Z (north).
+    void SetNumTiles(const IntVector2& tiles);
+    /// Set quads per tile edge, which is the heightmap size minus one. Must be a multiple of the patch size.
+    void SetTileSize(int quads);
+    /// Set vertex and height spacing of the tiles.
+    void SetSpacing(const Vector3& spacing);
+    /// Set patch quads per side of the tiles. Must be a power of two.
+    void SetPatchSize(int size);
+    /// Set maximum number of LOD levels of the tiles.
+    void SetMaxLodLevels(unsigned levels);
+    /// Set material of the tiles.
+    void SetMaterial(Material* material);
+    /// Set draw distance of the tile patches.
+    void SetDrawDistance(float distance);
+    /// Set shadowcaster flag of the tile patches.
+    void SetCastShadows(bool enable);
+    /// Set the distance from the streaming observers within which tiles are loaded. Tiles are removed when further than this plus one tile edge from all observers.
+    void SetStreamingDistance(float distance);
+    /// Set whether the tiles get a static rigid body with a heightfield collision shape. Requires the physics library.
+    void SetPhysics(bool enable);
+    /// Set LOD level of the tile collision shapes.
+    void SetPhysicsLodLevel(unsigned level);
+    /// Set collision layer of the tile rigid bodies.
+    void SetCollisionLayer(unsigned layer);
+    /// Set collision mask of the tile rigid bodies.
+    void SetCollisionMask(unsigned mask);
+    /// Add a node around which tiles are loaded.
+    void AddStreamingObserver(Node* node);
+    /// Remove a streaming observer. The loaded tiles are kept while there are no observers.
+    void RemoveStreamingObserver(Node* node);
+    /// Remove all tiles, including those still loading. They are loaded again as needed.
+    void UnloadTiles();
+
+    /// Return the resource name prefix of the tile heightmaps.
+    const String& GetHeightMapPath() const { return heightMapPath_; }
+
+    /// Return the file extension of the tile heightmaps.
+    const String& GetHeightMapExtension() const { return heightMapExtension_; }
+
+    /// Return number of tiles in X and Z direction.
+    const IntVector2& GetNumTiles() const { return numTiles_; }
+
+    /// Return quads per tile edge.
+    int GetTileSize() const { return tileSize_; }
+
+    /// Return vertex and height spacing of the tiles.
+    const Vector3& GetSpacing() const { return spacing_; }
+
+    /// Return patch quads per side of the tiles.
+    int GetPatchSize() const { return patchSize_; }
+
+    /// Return maximum number of LOD levels of the tiles.
+    unsigned GetMaxLodLevels() const { return maxLodLevels_; }
+
+    /// Return material of the tiles.
+    Material* GetMaterial() const;
+
+    /// Return draw distance of the tile patches.
+    float GetDrawDistance() const { return drawDistance_; }
+
+    /// Return shadowcaster flag of the tile patches.
+    bool GetCastShadows() const { return castShadows_; }
+
+    /// Return the distance from the streaming observers within which tiles are loaded.
+    float GetStreamingDistance() const { return streamingDistance_; }
+
+    /// Return whether the tiles get rigid bodies.
+    bool GetPhysics() const { return physics_; }
+
+    /// Return LOD level of the tile collision shapes.
+    unsigned GetPhysicsLodLevel() const { return physicsLodLevel_; }
+
+    /// Return collision layer of the tile rigid bodies.
+    unsigned GetCollisionLayer() const { return collisionLayer_; }
+
+    /// Return collision mask of the tile rigid bodies.
+    unsigned GetCollisionMask() const { return collisionMask_; }
+
+    /// Return the world size of one tile on the XZ plane, without node scaling.
+    Vector2 GetTileWorldSize() const;
+    /// Return the coordinates of the tile containing a world position. May be outside the grid.
+    IntVector2 GetTileCoordinates(const Vector3& worldPosition) const;
+    /// Return the terrain of a loaded tile, or null if not loaded.
+    Terrain* GetTile(const IntVector2& coords) const;
+    /// Return the terrain height at a world position, or zero if the tile is not loaded.
+    float GetHeight(const Vector3& worldPosition) const;
+
+    /// Return number of loaded tiles.
+    unsigned GetNumLoadedTiles() const { return tiles_.Size(); }
+
+    /// Return number of tiles loading in the background or waiting to be created.
+    unsigned GetNumLoadingTiles() const { return streamedTiles_.Size() - tiles_.Size(); }
+
+    /// Set material attribute.
+    void SetMaterialAttr(const ResourceRef& value);
+    /// Return material attribute.
+    ResourceRef GetMaterialAttr() const;
+
+private:
+    /// Load and remove tiles around the streaming observers.
+    void UpdateStreaming();
+    /// Queue a tile heightmap to be loaded in the background.
+    void RequestTile(const IntVector2& coords);
+    /// Create the node and terrain of a tile from its loaded heightmap and link it to the adjacent tiles.
+    void CreateTile(const IntVector2& coords, Image* heightMap);
+    /// Remove the node of a tile and unlink it from the adjacent tiles.
+    void RemoveTile(const IntVector2& coords);
+    /// Apply the terrain settings to a tile.
+    void ApplyTileSettings(Terrain* terrain) const;
+    /// Create or remove the rigid body and collision shape of a tile according to the physics settings.
+    void ApplyTilePhysics(Node* tileNode) const;
+    /// Return the heightmap resource name of a tile.
+    String GetTileHeightMapName(const IntVector2& coords) const;
+    /// Subscribe to the frame start event while there are streaming observers or tiles waiting to be created.
+    void UpdateFrameSubscription();
+    /// Handle frame start. Update the streamed tiles and create one waiting tile.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle a background loaded resource. Queue a loaded heightmap for tile creation.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+
+    /// Resource name prefix of the tile heightmaps.
+    String heightMapPath_;
+    /// File extension of the tile heightmaps.
+    String heightMapExtension_;
+    /// Number of tiles in X and Z direction.
+    IntVector2 numTiles_;
+    /// Quads per tile edge.
+    int tileSize_;
+    /// Vertex and height spacing of the tiles.
+    Vector3 spacing_;
+    /// Patch quads per side of the tiles.
+    int patchSize_;
+    /// Maximum number of LOD levels of the tiles.
+    unsigned maxLodLevels_;
+    /// Material of the tiles.
+    SharedPtr<Material> material_;
+    /// Draw distance of the tile patches.
+    float drawDistance_;
+    /// Shadowcaster flag of the tile patches.
+    bool castShadows_;
+    /// Tile load distance from the streaming observers.
+    float streamingDistance_;
+    /// Rigid body creation flag.
+    bool physics_;
+    /// LOD level of the tile collision shapes.
+    unsigned physicsLodLevel_;
+    /// Collision layer of the tile rigid bodies.
+    unsigned collisionLayer_;
+    /// Collision mask of the tile rigid bodies.
+    unsigned collisionMask_;
+    /// Streaming observer nodes.
+    Vector<WeakPtr<Node> > streamingObservers_;
+    /// Tiles loaded, loading or waiting to be created.
+    HashSet<IntVector2> streamedTiles_;
+    /// Tiles loading in the background by heightmap resource name.
+    HashMap<StringHash, IntVector2> loadingTiles_;
+    /// Loaded heightmaps waiting to be turned into tiles, one per frame.
+    Vector<Pair<IntVector2, SharedPtr<Image> > > loadedHeightMaps_;
+    /// Terrains of the created tiles.
+    HashMap<IntVector2, WeakPtr<Terrain> > tiles_;
+};
+
+}
@@ -29,8 +29,12 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreamer.h"
+#include "../IO/File.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 
@@ -71,22 +75,63 @@ bool Texture2D::BeginLoad(Deserializer& source)
         return true;
     }
 
+    // Load the optional parameters file
+    auto* cache = GetSubsystem<ResourceCache>();
+    String xmlName = ReplaceExtension(GetName(), ".xml");
+    loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
+
+    // Check whether to compress the image on load. The parameters file can override the renderer setting
+    auto* renderer = GetSubsystem<Renderer>();
+    bool compress = renderer && renderer->GetTextureCompression();
+    if (loadParameters_)
+    {
+        XMLElement compressElem = loadParameters_->GetRoot().GetChild("compress");
+        if (compressElem)
+            compress = compressElem.GetBool("enable");
+    }
+
     // Load the image data for EndLoad()
-    loadImage_ = new Image(context_);
-    if (!loadImage_->Load(source))
+    if (compress && graphics_->GetFormat(CF_DXT5))
     {
-        loadImage_.Reset();
-        return false;
+        if (!LoadCompressedImage(source, renderer ? renderer->GetTextureCompressionCacheDir() : String::EMPTY))
+        {
+            loadImage_.Reset();
+            return false;
+        }
+    }
+    else
+    {
+        loadImage_ = new Image(context_);
+        if (!loadImage_->Load(source))
+        {
+            loadImage_.Reset();
+            return false;
+        }
     }
 
     // Precalculate mip levels if async loading
     if (GetAsyncLoadState() == ASYNC_LOADING)
+    {
         loadImage_->PrecalculateLevels();
 
-    // Load the optional parameters file
-    auto* cache = GetSubsystem<ResourceCache>();
-    String xmlName = ReplaceExtension(GetName(), ".xml");
-    loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
+        // Upload on the loader thread if supported, so that EndLoad() does not stall the main thread
+        if (graphics_->BeginBackgroundUpload())
+        {
+            bool success;
+            {
+                LoadStageTimer timer(LOADSTAGE_UPLOAD);
+                success = UploadLoadImage();
+            }
+            graphics_->EndBackgroundUpload();
+
+            loadImage_.Reset();
+            if (!success)
+            {
+                loadParameters_.Reset();
+                return false;
+            }
+        }
+    }
 
     return true;
 }
@@ -100,8 +145,18 @@ bool Texture2D::EndLoad()
     // If over the texture budget, see if materials can be freed to allow textures to be freed
     CheckTextureBudget(GetTypeStatic());
 
-    SetParameters(loadParameters_);
-    bool success = SetData(loadImage_);
+    // The image has already been uploaded if the texture was loaded in the background with an upload context
+    bool success = true;
+    if (loadImage_)
+    {
+        LoadStageTimer timer(LOADSTAGE_UPLOAD);
+        success = UploadLoadImage();
+    }
+
+    auto* renderer = GetSubsystem<Renderer>();
+    TextureStreamer* streamer = renderer && streaming_ && !GetName().Empty() ? renderer->GetTextureStreamer() : nullptr;
+    if (success && streamer)
+        streamer->AddTexture(this);
 
     loadImage_.Reset();
     loadParameters_.Reset();
@@ -109,6 +164,31 @@ bool Texture2D::EndLoad()
     return success;
 }
 
+bool Texture2D::UploadLoadImage()
+{
+    SetParameters(loadParameters_);
+    if (loadParameters_)
+    {
+        XMLElement streamingElem = loadParameters_->GetRoot().GetChild("streaming");
+        if (streamingElem)
+            SetStreaming(streamingElem.GetBool("enable"));
+    }
+
+    // Streamed textures start from the low mip levels. The streamer loads the higher levels once they are needed on screen
+    auto* renderer = GetSubsystem<Renderer>();
+    TextureStreamer* streamer = renderer && streaming_ && !GetName().Empty() ? renderer->GetTextureStreamer() : nullptr;
+    if (streamer)
+    {
+        unsigned qualityMipsToSkip = (unsigned)GetMipsToSkip(renderer->GetTextureQuality());
+        streamingMipsToSkip_ = streamer->GetMaxMipsToSkip(loadImage_->GetWidth() >> qualityMipsToSkip,
+            loadImage_->GetHeight() >> qualityMipsToSkip);
+    }
+    else
+        streamingMipsToSkip_ = 0;
+
+    return SetData(loadImage_);
+}
+
 bool Texture2D::SetSize(int width, int height, unsigned format, TextureUsage usage, int multiSample, bool autoResolve)
 {
     if (width <= 0 || height <= 0)
@@ -160,6 +240,16 @@ bool Texture2D::SetSize(int width, int height, unsigned format, TextureUsage usa
     return Create();
 }
 
+void Texture2D::SetStreaming(bool enable)
+{
+    streaming_ = enable;
+}
+
+void Texture2D::RequestStreamingMipsToSkip(unsigned mips)
+{
+    streamingRequest_ = Min(streamingRequest_, mips);
+}
+
 bool Texture2D::GetImage(Image& image) const
 {
     if (format_ != Graphics::GetRGBAFormat() && format_ != Graphics::GetRGBFormat())
@@ -181,15 +271,64 @@ SharedPtr<Image> Texture2D::GetImage() const
     return rawImage;
 }
 
-void Texture2D::HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData)
+bool Texture2D::LoadCompressedImage(Deserializer& source, const String& cacheDir)
 {
-    if (renderSurface_ && (renderSurface_->GetUpdateMode() == SURFACE_UPDATEALWAYS || renderSurface_->IsUpdateQueued()))
+    // Read the whole source file to hash it for the cache
+    unsigned size = source.GetSize() - source.GetPosition();
+    SharedArrayPtr<unsigned char> buffer(new unsigned char[size]);
+    if (source.Read(buffer.Get(), size) != size)
+        return false;
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    String cacheName;
+    if (!cacheDir.Empty())
+    {
+        unsigned hash = 0;
+        for (unsigned i = 0; i < size; ++i)
+            hash = SDBMHash(hash, buffer[i]);
+        cacheName = AddTrailingSlash(cacheDir) + ToString("%08X%08X.dds", hash, size);
+
+        if (fileSystem->FileExists(cacheName))
+        {
+            File cacheFile(context_, cacheName);
+            loadImage_ = new Image(context_);
+            if (loadImage_->Load(cacheFile))
+                return true;
+            URHO3D_LOGWARNING("Failed to load compressed texture " + cacheName + ", compressing again");
+        }
+    }
+
+    MemoryBuffer sourceBuffer(buffer.Get(), size);
+    loadImage_ = new Image(context_);
+    if (!loadImage_->Load(sourceBuffer))
+        return false;
+
+    // Only color images with block aligned dimensions are compressed, others are used as they are
+    if (loadImage_->IsCompressed() || loadImage_->GetDepth() > 1 || loadImage_->GetComponents() < 3 ||
+        (loadImage_->GetWidth() & 3) || (loadImage_->GetHeight() & 3))
+        return true;
+
+    SharedPtr<Image> compressedImage = loadImage_->GetCompressedImage(loadImage_->HasAlphaChannel() ? CF_DXT5 : CF_DXT1);
+    if (!compressedImage)
+        return true;
+
+    loadImage_ = compressedImage;
+
+    if (!cacheName.Empty())
     {
-        auto* renderer = GetSubsystem<Renderer>();
-        if (renderer)
-            renderer->QueueRenderSurface(renderSurface_);
-        renderSurface_->ResetUpdateQueued();
+        fileSystem->CreateDir(cacheDir);
+        if (!loadImage_->SaveDDS(cacheName))
+            URHO3D_LOGWARNING("Failed to save compressed texture " + cacheName);
     }
+
+    return true;
+}
+
+void Texture2D::HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData)
+{
+    auto* renderer = GetSubsystem<Renderer>();
+    if (renderer && renderSurface_)
+        renderer->QueueRenderSurfaceUpdate(renderSurface_);
 }
 
 }
@@ -65,6 +65,14 @@ public:
     bool SetData(unsigned level, int x, int y, int width, int height, const void* data);
     /// Set data from an image. Return true if successful. Optionally make a single channel image alpha-only.
     bool SetData(Image* image, bool useAlpha = false);
+    /// Set whether to stream mip levels according to the on-screen size. Only has effect on textures loaded from an image file while texture streaming is enabled in Renderer.
+    void SetStreaming(bool enable);
+    /// Set streamed mip levels to skip. Takes effect on the next SetData() from an image. Called by TextureStreamer.
+    void SetStreamingMipsToSkip(unsigned mips) { streamingMipsToSkip_ = mips; }
+    /// Request streamed mip levels to skip. The smallest request since the last streamer update is used. Called by TextureStreamer.
+    void RequestStreamingMipsToSkip(unsigned mips);
+    /// Clear the streaming request. Called by TextureStreamer.
+    void ResetStreamingRequest() { streamingRequest_ = M_MAX_UNSIGNED; }
 
     /// Get data from a mip level. The destination buffer must be big enough. Return true if successful.
     bool GetData(unsigned level, void* dest) const;
@@ -75,6 +83,12 @@ public:
 
     /// Return render surface.
     RenderSurface* GetRenderSurface() const { return renderSurface_; }
+    /// Return whether mip levels are streamed.
+    bool IsStreaming() const { return streaming_; }
+    /// Return streamed mip levels to skip.
+    unsigned GetStreamingMipsToSkip() const { return streamingMipsToSkip_; }
+    /// Return smallest streamed mip levels to skip requested since the last streamer update, or M_MAX_UNSIGNED if not requested.
+    unsigned GetStreamingRequest() const { return streamingRequest_; }
 
 protected:
     /// Create the GPU texture.
@@ -83,6 +97,10 @@ protected:
 private:
     /// Handle render surface update event.
     void HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData);
+    /// Load the image for EndLoad() compressed to DXT format, using the compressed texture cache directory if set. Return true if successful.
+    bool LoadCompressedImage(Deserializer& source, const String& cacheDir);
+    /// Apply the loaded parameters and upload the loaded image. Return true if successful.
+    bool UploadLoadImage();
 
     /// Render surface.
     SharedPtr<RenderSurface> renderSurface_;
@@ -90,6 +108,12 @@ private:
     SharedPtr<Image> loadImage_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Streamed mip levels to skip, in addition to the texture quality setting.
+    unsigned streamingMipsToSkip_{};
+    /// Streamed mip levels to skip requested by views.
+    unsigned streamingRequest_{M_MAX_UNSIGNED};
+    /// Mip level streaming flag.
+    bool streaming_{};
 };
 
 }
@@ -30,6 +30,7 @@
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2DArray.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
@@ -134,8 +135,11 @@ bool Texture2DArray::EndLoad()
     SetParameters(loadParameters_);
     SetLayers(loadImages_.Size());
 
-    for (unsigned i = 0; i < loadImages_.Size(); ++i)
-        SetData(i, loadImages_[i]);
+    {
+        LoadStageTimer timer(LOADSTAGE_UPLOAD);
+        for (unsigned i = 0; i < loadImages_.Size(); ++i)
+            SetData(i, loadImages_[i]);
+    }
 
     loadImages_.Clear();
     loadParameters_.Reset();
@@ -197,13 +201,9 @@ bool Texture2DArray::SetSize(unsigned layers, int width, int height, unsigned fo
 
 void Texture2DArray::HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData)
 {
-    if (renderSurface_ && (renderSurface_->GetUpdateMode() == SURFACE_UPDATEALWAYS || renderSurface_->IsUpdateQueued()))
-    {
-        auto* renderer = GetSubsystem<Renderer>();
-        if (renderer)
-            renderer->QueueRenderSurface(renderSurface_);
-        renderSurface_->ResetUpdateQueued();
-    }
+    auto* renderer = GetSubsystem<Renderer>();
+    if (renderer && renderSurface_)
+        renderer->QueueRenderSurfaceUpdate(renderSurface_);
 }
 
 }
@@ -30,6 +30,7 @@
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture3D.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
@@ -148,7 +149,11 @@ bool Texture3D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
-    bool success = SetData(loadImage_);
+    bool success;
+    {
+        LoadStageTimer timer(LOADSTAGE_UPLOAD);
+        success = SetData(loadImage_);
+    }
 
     loadImage_.Reset();
     loadParameters_.Reset();
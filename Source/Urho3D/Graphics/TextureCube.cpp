@@ -30,6 +30,7 @@
 #include "../Graphics/Renderer.h"
 #include "../Graphics/TextureCube.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
@@ -246,8 +247,11 @@ bool TextureCube::EndLoad()
 
     SetParameters(loadParameters_);
 
-    for (unsigned i = 0; i < loadImages_.Size() && i < MAX_CUBEMAP_FACES; ++i)
-        SetData((CubeMapFace)i, loadImages_[i]);
+    {
+        LoadStageTimer timer(LOADSTAGE_UPLOAD);
+        for (unsigned i = 0; i < loadImages_.Size() && i < MAX_CUBEMAP_FACES; ++i)
+            SetData((CubeMapFace)i, loadImages_[i]);
+    }
 
     loadImages_.Clear();
     loadParameters_.Reset();
@@ -255,6 +259,11 @@ bool TextureCube::EndLoad()
     return true;
 }
 
+void TextureCube::SetRoundRobinFaces(bool enable)
+{
+    roundRobinFaces_ = enable;
+}
+
 bool TextureCube::SetSize(int size, unsigned format, TextureUsage usage, int multiSample)
 {
     if (size <= 0)
@@ -336,14 +345,30 @@ SharedPtr<Image> TextureCube::GetImage(CubeMapFace face) const
 void TextureCube::HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData)
 {
     auto* renderer = GetSubsystem<Renderer>();
+    if (!renderer)
+        return;
 
-    for (auto& renderSurface : renderSurfaces_)
+    unsigned frameNumber = renderer->GetFrameInfo().frameNumber_;
+    bool faceQueued = false;
+
+    for (unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
     {
-        if (renderSurface && (renderSurface->GetUpdateMode() == SURFACE_UPDATEALWAYS || renderSurface->IsUpdateQueued()))
+        unsigned face = roundRobinFaces_ ? (nextFace_ + i) % MAX_CUBEMAP_FACES : i;
+        RenderSurface* renderSurface = renderSurfaces_[face];
+        if (!renderSurface)
+            continue;
+
+        // When updating one face per frame, the other due faces stay due and are picked up on the following frames
+        if (faceQueued)
+            renderSurface->ResetVisibleUpdate();
+        else
         {
-            if (renderer)
-                renderer->QueueRenderSurface(renderSurface);
-            renderSurface->ResetUpdateQueued();
+            if (roundRobinFaces_ && renderSurface->IsUpdateDue(frameNumber))
+            {
+                faceQueued = true;
+                nextFace_ = (face + 1) % MAX_CUBEMAP_FACES;
+            }
+            renderer->QueueRenderSurfaceUpdate(renderSurface);
         }
     }
 }
@@ -65,6 +65,9 @@ public:
     /// Set data of one face from an image. Return true if successful. Optionally make a single channel image alpha-only.
     bool SetData(CubeMapFace face, Image* image, bool useAlpha = false);
 
+    /// Set whether rendertarget faces are updated one per frame in turn, instead of all due faces on the same frame. Default false.
+    void SetRoundRobinFaces(bool enable);
+
     /// Get data from a face's mip level. The destination buffer must be big enough. Return true if successful.
     bool GetData(CubeMapFace face, unsigned level, void* dest) const;
     /// Get image data from a face's zero mip level. Only RGB and RGBA textures are supported.
@@ -73,6 +76,9 @@ public:
     /// Return render surface for one face.
     RenderSurface* GetRenderSurface(CubeMapFace face) const { return renderSurfaces_[face]; }
 
+    /// Return whether rendertarget faces are updated one per frame in turn.
+    bool GetRoundRobinFaces() const { return roundRobinFaces_; }
+
 protected:
     /// Create the GPU texture.
     bool Create() override;
@@ -89,6 +95,10 @@ private:
     Vector<SharedPtr<Image> > loadImages_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Next face to consider for round-robin update.
+    unsigned nextFace_{};
+    /// Round-robin face update flag.
+    bool roundRobinFaces_{};
 };
 
 }
@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreamer.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static void LoadStreamedTextureWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* entry = reinterpret_cast<StreamedTexture*>(item->aux_);
+    entry->loadImage_ = entry->loadCache_->GetTempResource<Image>(entry->loadName_, false);
+    // Precalculate mip levels so that the main thread only needs to upload them
+    if (entry->loadImage_)
+        entry->loadImage_->PrecalculateLevels();
+}
+
+static bool CompareLastUseTime(StreamedTexture* lhs, StreamedTexture* rhs)
+{
+    return lhs->lastUseTime_ < rhs->lastUseTime_;
+}
+
+static unsigned long long GetEstimatedMemoryUse(Texture2D* texture, unsigned mipsToSkip)
+{
+    // Each skipped mip level quarters the memory use
+    auto memoryUse = (unsigned long long)texture->GetMemoryUse();
+    unsigned resident = texture->GetStreamingMipsToSkip();
+    if (mipsToSkip < resident)
+        return memoryUse << (2 * (resident - mipsToSkip));
+    else
+        return memoryUse >> (2 * (mipsToSkip - resident));
+}
+
+TextureStreamer::TextureStreamer(Context* context) :
+    Object(context),
+    workQueue_(GetSubsystem<WorkQueue>())
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // The background loads refer to the streaming entries, so they must not outlive them
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        StreamedTexture* entry = textures_[i];
+        if (entry->loadItem_ && !(workQueue_ && workQueue_->RemoveWorkItem(entry->loadItem_)))
+        {
+            while (!entry->loadItem_->completed_)
+                Time::Sleep(0);
+        }
+    }
+}
+
+void TextureStreamer::SetMemoryBudget(unsigned long long budget)
+{
+    memoryBudget_ = budget;
+}
+
+void TextureStreamer::SetMaxMipsToSkip(unsigned mips)
+{
+    maxMipsToSkip_ = mips;
+}
+
+void TextureStreamer::SetMipBias(float bias)
+{
+    mipBias_ = bias;
+}
+
+void TextureStreamer::SetEvictionTime(float time)
+{
+    evictionTime_ = Max(time, 0.0f);
+}
+
+void TextureStreamer::SetMaxConcurrentLoads(unsigned loads)
+{
+    maxConcurrentLoads_ = Max(loads, 1U);
+}
+
+void TextureStreamer::AddTexture(Texture2D* texture)
+{
+    if (!texture)
+        return;
+
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        if (textures_[i]->texture_ == texture)
+        {
+            textures_[i]->targetMipsToSkip_ = texture->GetStreamingMipsToSkip();
+            return;
+        }
+    }
+
+    SharedPtr<StreamedTexture> entry(new StreamedTexture());
+    entry->texture_ = texture;
+    entry->targetMipsToSkip_ = entry->requestedMipsToSkip_ = texture->GetStreamingMipsToSkip();
+    entry->lastUseTime_ = entry->lastNeededTime_ = time_;
+    textures_.Push(entry);
+}
+
+void TextureStreamer::RequestMaterial(Material* material, float pixelSize)
+{
+    if (!material)
+        return;
+
+    pixelSize = Max(pixelSize, 1.0f);
+
+    const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material->GetTextures();
+    for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
+    {
+        Texture* texture = i->second_;
+        if (!texture || texture->GetType() != Texture2D::GetTypeStatic())
+            continue;
+
+        auto* texture2D = static_cast<Texture2D*>(texture);
+        if (!texture2D->IsStreaming())
+            continue;
+
+        // Full resolution of the texture without streaming, compared to the on-screen size
+        int size = Max(texture2D->GetWidth(), texture2D->GetHeight()) << texture2D->GetStreamingMipsToSkip();
+        float mips = log2f((float)size / pixelSize) + mipBias_;
+        texture2D->RequestStreamingMipsToSkip(mips > 0.0f ? (unsigned)mips : 0);
+    }
+}
+
+void TextureStreamer::Update(float timeStep)
+{
+    URHO3D_PROFILE(UpdateTextureStreaming);
+
+    time_ += timeStep;
+    memoryUse_ = 0;
+
+    PODVector<StreamedTexture*> sorted;
+
+    for (unsigned i = textures_.Size() - 1; i < textures_.Size(); --i)
+    {
+        StreamedTexture* entry = textures_[i];
+        if (entry->loadItem_)
+        {
+            if (!entry->loadItem_->completed_)
+            {
+                if (entry->texture_)
+                    memoryUse_ += GetEstimatedMemoryUse(entry->texture_, entry->loadMipsToSkip_);
+                continue;
+            }
+            EndLoad(entry);
+        }
+
+        Texture2D* texture = entry->texture_;
+        // Return textures with streaming disabled to full resolution before removing them
+        if (!texture || (!texture->IsStreaming() && !texture->GetStreamingMipsToSkip()))
+        {
+            textures_.Erase(i);
+            continue;
+        }
+
+        unsigned resident = texture->GetStreamingMipsToSkip();
+        unsigned maxMips = GetMaxMipsToSkip(texture->GetWidth() << resident, texture->GetHeight() << resident);
+
+        if (!texture->IsStreaming())
+            entry->targetMipsToSkip_ = 0;
+        else
+        {
+            unsigned request = texture->GetStreamingRequest();
+            if (request != M_MAX_UNSIGNED)
+            {
+                entry->requestedMipsToSkip_ = Min(request, maxMips);
+                entry->lastUseTime_ = time_;
+                texture->ResetStreamingRequest();
+            }
+
+            unsigned wanted = time_ - entry->lastUseTime_ > evictionTime_ ? maxMips : entry->requestedMipsToSkip_;
+            // Load higher detail immediately, but keep the resident detail until it has not been needed for the eviction time
+            // to avoid reloading textures back and forth
+            if (wanted <= resident)
+            {
+                entry->targetMipsToSkip_ = wanted;
+                entry->lastNeededTime_ = time_;
+            }
+            else if (time_ - entry->lastNeededTime_ > evictionTime_)
+                entry->targetMipsToSkip_ = wanted;
+            else
+                entry->targetMipsToSkip_ = resident;
+        }
+
+        memoryUse_ += GetEstimatedMemoryUse(texture, entry->targetMipsToSkip_);
+        sorted.Push(entry);
+    }
+
+    Sort(sorted.Begin(), sorted.End(), CompareLastUseTime);
+
+    // When over the budget, drop the highest mip levels starting from the least recently used textures
+    if (memoryBudget_)
+    {
+        for (unsigned i = 0; i < sorted.Size() && memoryUse_ > memoryBudget_; ++i)
+        {
+            StreamedTexture* entry = sorted[i];
+            Texture2D* texture = entry->texture_;
+            if (!texture->IsStreaming())
+                continue;
+
+            unsigned resident = texture->GetStreamingMipsToSkip();
+            unsigned maxMips = GetMaxMipsToSkip(texture->GetWidth() << resident, texture->GetHeight() << resident);
+            if (entry->targetMipsToSkip_ >= maxMips)
+                continue;
+
+            memoryUse_ -= GetEstimatedMemoryUse(texture, entry->targetMipsToSkip_);
+            entry->targetMipsToSkip_ = maxMips;
+            memoryUse_ += GetEstimatedMemoryUse(texture, entry->targetMipsToSkip_);
+        }
+    }
+
+    // Begin reloads starting from the most recently used textures
+    for (unsigned i = sorted.Size() - 1; i < sorted.Size() && numLoads_ < maxConcurrentLoads_; --i)
+    {
+        StreamedTexture* entry = sorted[i];
+        if (!entry->loadItem_ && entry->targetMipsToSkip_ != entry->texture_->GetStreamingMipsToSkip())
+            BeginLoad(entry);
+    }
+}
+
+unsigned TextureStreamer::GetMaxMipsToSkip(int width, int height) const
+{
+    unsigned mips = maxMipsToSkip_;
+    while (mips && ((width >> mips) < 4 || (height >> mips) < 4))
+        --mips;
+    return mips;
+}
+
+void TextureStreamer::BeginLoad(StreamedTexture* entry)
+{
+    if (!workQueue_)
+        return;
+
+    entry->loadCache_ = GetSubsystem<ResourceCache>();
+    entry->loadName_ = entry->texture_->GetName();
+    entry->loadMipsToSkip_ = entry->targetMipsToSkip_;
+
+    SharedPtr<WorkItem> item = workQueue_->GetFreeItem();
+    item->priority_ = 0;
+    item->workClass_ = WORK_BACKGROUND;
+    item->workFunction_ = LoadStreamedTextureWork;
+    item->name_ = "LoadStreamedTextureWork";
+    item->aux_ = entry;
+    entry->loadItem_ = item;
+    workQueue_->AddWorkItem(item);
+    ++numLoads_;
+}
+
+void TextureStreamer::EndLoad(StreamedTexture* entry)
+{
+    Texture2D* texture = entry->texture_;
+    if (texture && entry->loadImage_)
+    {
+        unsigned oldMipsToSkip = texture->GetStreamingMipsToSkip();
+        texture->SetStreamingMipsToSkip(entry->loadMipsToSkip_);
+        if (!texture->SetData(entry->loadImage_))
+        {
+            URHO3D_LOGERROR("Failed to stream texture " + entry->loadName_);
+            texture->SetStreamingMipsToSkip(oldMipsToSkip);
+        }
+    }
+    else if (texture)
+    {
+        // The image could not be loaded. Stop streaming the texture and keep its current mip levels to avoid retrying every frame
+        URHO3D_LOGERROR("Failed to load image " + entry->loadName_ + " for texture streaming");
+        texture->SetStreaming(false);
+        texture->SetStreamingMipsToSkip(0);
+    }
+
+    entry->loadItem_.Reset();
+    entry->loadImage_.Reset();
+    --numLoads_;
+}
+
+}
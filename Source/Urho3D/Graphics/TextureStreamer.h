@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class Image;
+class Material;
+class ResourceCache;
+class Texture2D;
+class WorkQueue;
+struct WorkItem;
+
+/// Streaming state of a single texture.
+struct StreamedTexture : public RefCounted
+{
+    /// Texture.
+    WeakPtr<Texture2D> texture_;
+    /// Mips to skip which the texture should have resident.
+    unsigned targetMipsToSkip_{};
+    /// Mips to skip last requested by views.
+    unsigned requestedMipsToSkip_{};
+    /// Time the texture was last requested by a view.
+    float lastUseTime_{};
+    /// Time the resident mip levels were last needed.
+    float lastNeededTime_{};
+    /// Background image load in progress.
+    SharedPtr<WorkItem> loadItem_;
+    /// Resource cache used by the background load.
+    ResourceCache* loadCache_{};
+    /// Image file name of the background load.
+    String loadName_;
+    /// Mips to skip of the background load.
+    unsigned loadMipsToSkip_{};
+    /// Image produced by the background load.
+    SharedPtr<Image> loadImage_;
+};
+
+/// %Texture mip level streaming. Reloads streamed 2D textures at the resolution their on-screen size requires, and drops the highest mip levels of least recently used textures when over the memory budget.
+class URHO3D_API TextureStreamer : public Object
+{
+    URHO3D_OBJECT(TextureStreamer, Object);
+
+public:
+    /// Construct.
+    explicit TextureStreamer(Context* context);
+    /// Destruct. Finish or cancel background loads in progress.
+    ~TextureStreamer() override;
+
+    /// Set texture memory budget in bytes for the streamed textures. Zero (default) is unlimited.
+    void SetMemoryBudget(unsigned long long budget);
+    /// Set maximum number of mip levels to skip when a texture is not visible or over the memory budget. Default 4.
+    void SetMaxMipsToSkip(unsigned mips);
+    /// Set bias for the mip levels requested by views. Positive values lower the streamed resolution. Default 0.
+    void SetMipBias(float bias);
+    /// Set time in seconds after which an unused or smaller-than-resident texture drops its highest mip levels. Default 5.
+    void SetEvictionTime(float time);
+    /// Set maximum number of background texture reloads in progress at once. Default 2.
+    void SetMaxConcurrentLoads(unsigned loads);
+
+    /// Add a streamed texture. Called by Texture2D when loaded.
+    void AddTexture(Texture2D* texture);
+    /// Request mip levels for the textures of a material based on the pixel size of the drawable using it. Called by View.
+    void RequestMaterial(Material* material, float pixelSize);
+    /// Update streaming state and apply finished background loads. Called by Renderer.
+    void Update(float timeStep);
+
+    /// Return texture memory budget in bytes.
+    unsigned long long GetMemoryBudget() const { return memoryBudget_; }
+    /// Return maximum number of mip levels to skip.
+    unsigned GetMaxMipsToSkip() const { return maxMipsToSkip_; }
+    /// Return mip level bias.
+    float GetMipBias() const { return mipBias_; }
+    /// Return eviction time in seconds.
+    float GetEvictionTime() const { return evictionTime_; }
+    /// Return maximum number of concurrent background loads.
+    unsigned GetMaxConcurrentLoads() const { return maxConcurrentLoads_; }
+    /// Return number of streamed textures.
+    unsigned GetNumTextures() const { return textures_.Size(); }
+    /// Return number of background loads in progress.
+    unsigned GetNumLoads() const { return numLoads_; }
+    /// Return memory use of the streamed textures in bytes.
+    unsigned long long GetMemoryUse() const { return memoryUse_; }
+    /// Return maximum mip levels to skip for a texture of the specified full resolution, keeping its dimensions at least 4 pixels.
+    unsigned GetMaxMipsToSkip(int width, int height) const;
+
+private:
+    /// Begin background load of a texture at the target resolution.
+    void BeginLoad(StreamedTexture* entry);
+    /// Apply a finished background load to the texture.
+    void EndLoad(StreamedTexture* entry);
+
+    /// Streamed textures.
+    Vector<SharedPtr<StreamedTexture> > textures_;
+    /// Work queue used for the background loads.
+    WeakPtr<WorkQueue> workQueue_;
+    /// Texture memory budget.
+    unsigned long long memoryBudget_{};
+    /// Streamed texture memory use after the last update.
+    unsigned long long memoryUse_{};
+    /// Maximum mip levels to skip.
+    unsigned maxMipsToSkip_{4};
+    /// Mip level bias.
+    float mipBias_{};
+    /// Eviction time.
+    float evictionTime_{5.0f};
+    /// Maximum concurrent background loads.
+    unsigned maxConcurrentLoads_{2};
+    /// Background loads in progress.
+    unsigned numLoads_{};
+    /// Accumulated time.
+    float time_{};
+};
+
+}
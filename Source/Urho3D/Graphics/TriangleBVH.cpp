@@ -0,0 +1,258 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/TriangleBVH.h"
+#include "../Math/Frustum.h"
+#include "../Math/Ray.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned MAX_LEAF_TRIANGLES = 4;
+static const unsigned MAX_SPATIAL_SPLIT_DEPTH = 32;
+static const unsigned MAX_TRAVERSAL_DEPTH = 128;
+
+void TriangleBVH::Build(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData, unsigned indexSize,
+    unsigned start, unsigned count)
+{
+    nodes_.Clear();
+    positions_.Clear();
+    triangles_.Clear();
+    vertexData_ = vertexData;
+    indexData_ = indexData;
+    start_ = start;
+    count_ = count;
+
+    unsigned numTriangles = count / 3;
+    if (!vertexData || !numTriangles)
+        return;
+
+    PODVector<Vector3> vertices(numTriangles * 3);
+    Vector<BoundingBox> boxes(numTriangles);
+    PODVector<Vector3> centers(numTriangles);
+    PODVector<unsigned> order(numTriangles);
+
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        unsigned first = start + i * 3;
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            unsigned vertex = first + j;
+            if (indexData)
+            {
+                vertex = indexSize == sizeof(unsigned short) ? ((const unsigned short*)indexData)[vertex] :
+                    ((const unsigned*)indexData)[vertex];
+            }
+            vertices[i * 3 + j] = *((const Vector3*)(&vertexData[vertex * vertexSize]));
+        }
+
+        boxes[i].Define(vertices[i * 3]);
+        boxes[i].Merge(vertices[i * 3 + 1]);
+        boxes[i].Merge(vertices[i * 3 + 2]);
+        centers[i] = boxes[i].Center();
+        order[i] = i;
+    }
+
+    nodes_.Reserve(numTriangles * 2);
+    nodes_.Resize(1);
+    BuildNode(0, 0, numTriangles, 0, order, boxes, centers);
+
+    // Store the triangles in leaf order, so that each leaf's triangles are adjacent in memory
+    positions_.Resize(numTriangles * 3);
+    triangles_.Resize(numTriangles);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        unsigned triangle = order[i];
+        positions_[i * 3] = vertices[triangle * 3];
+        positions_[i * 3 + 1] = vertices[triangle * 3 + 1];
+        positions_[i * 3 + 2] = vertices[triangle * 3 + 2];
+        triangles_[i] = start + triangle * 3;
+    }
+}
+
+float TriangleBVH::HitDistance(const Ray& ray, Vector3* outNormal, Vector3* outBary, unsigned* outTriangle) const
+{
+    if (nodes_.Empty())
+        return M_INFINITY;
+
+    float nearest = M_INFINITY;
+    unsigned nearestTriangle = M_MAX_UNSIGNED;
+    Vector3 normal;
+    Vector3 bary;
+
+    unsigned stack[MAX_TRAVERSAL_DEPTH];
+    float stackDistances[MAX_TRAVERSAL_DEPTH];
+    unsigned stackSize = 0;
+
+    float rootDistance = ray.HitDistance(nodes_[0].box_);
+    if (rootDistance < M_INFINITY)
+    {
+        stack[0] = 0;
+        stackDistances[0] = rootDistance;
+        stackSize = 1;
+    }
+
+    while (stackSize)
+    {
+        --stackSize;
+        // Skip if a nearer hit was found after the node was pushed
+        if (stackDistances[stackSize] >= nearest)
+            continue;
+
+        const TriangleBVHNode& node = nodes_[stack[stackSize]];
+        if (node.count_)
+        {
+            for (unsigned i = node.first_; i < node.first_ + node.count_; ++i)
+            {
+                Vector3 triangleNormal;
+                Vector3 triangleBary;
+                float distance = ray.HitDistance(positions_[i * 3], positions_[i * 3 + 1], positions_[i * 3 + 2],
+                    outNormal ? &triangleNormal : nullptr, outBary ? &triangleBary : nullptr);
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    nearestTriangle = i;
+                    normal = triangleNormal;
+                    bary = triangleBary;
+                }
+            }
+        }
+        else
+        {
+            // Push the farther child first, so that the nearer one is visited first
+            float distance0 = ray.HitDistance(nodes_[node.first_].box_);
+            float distance1 = ray.HitDistance(nodes_[node.first_ + 1].box_);
+            unsigned nearChild = node.first_;
+            unsigned farChild = node.first_ + 1;
+            if (distance1 < distance0)
+            {
+                Swap(nearChild, farChild);
+                Swap(distance0, distance1);
+            }
+
+            if (distance1 < nearest)
+            {
+                stack[stackSize] = farChild;
+                stackDistances[stackSize++] = distance1;
+            }
+            if (distance0 < nearest)
+            {
+                stack[stackSize] = nearChild;
+                stackDistances[stackSize++] = distance0;
+            }
+        }
+    }
+
+    if (nearestTriangle != M_MAX_UNSIGNED)
+    {
+        if (outNormal)
+            *outNormal = normal;
+        if (outBary)
+            *outBary = bary;
+        if (outTriangle)
+            *outTriangle = triangles_[nearestTriangle];
+    }
+
+    return nearest;
+}
+
+void TriangleBVH::GetTriangles(const Frustum& frustum, PODVector<unsigned>& result) const
+{
+    if (nodes_.Empty())
+        return;
+
+    unsigned stack[MAX_TRAVERSAL_DEPTH];
+    unsigned stackSize = 1;
+    stack[0] = 0;
+
+    while (stackSize)
+    {
+        const TriangleBVHNode& node = nodes_[stack[--stackSize]];
+        if (frustum.IsInsideFast(node.box_) == OUTSIDE)
+            continue;
+
+        if (node.count_)
+        {
+            for (unsigned i = node.first_; i < node.first_ + node.count_; ++i)
+                result.Push(triangles_[i]);
+        }
+        else
+        {
+            stack[stackSize++] = node.first_;
+            stack[stackSize++] = node.first_ + 1;
+        }
+    }
+}
+
+void TriangleBVH::BuildNode(unsigned nodeIndex, unsigned begin, unsigned end, unsigned depth, PODVector<unsigned>& order,
+    const Vector<BoundingBox>& boxes, const PODVector<Vector3>& centers)
+{
+    BoundingBox box;
+    BoundingBox centerBox;
+    for (unsigned i = begin; i < end; ++i)
+    {
+        box.Merge(boxes[order[i]]);
+        centerBox.Merge(centers[order[i]]);
+    }
+    nodes_[nodeIndex].box_ = box;
+
+    if (end - begin <= MAX_LEAF_TRIANGLES)
+    {
+        nodes_[nodeIndex].first_ = begin;
+        nodes_[nodeIndex].count_ = end - begin;
+        return;
+    }
+
+    // Split at the middle of the longest axis of the triangle centers
+    Vector3 size = centerBox.Size();
+    unsigned axis = size.x_ >= size.y_ && size.x_ >= size.z_ ? 0 : (size.y_ >= size.z_ ? 1 : 2);
+    float splitPos = centerBox.Center().Data()[axis];
+
+    unsigned split = begin;
+    if (depth < MAX_SPATIAL_SPLIT_DEPTH)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            if (centers[order[i]].Data()[axis] < splitPos)
+                Swap(order[i], order[split++]);
+        }
+    }
+
+    // If all the centers ended up on one side, or the hierarchy is getting too deep, split by count to guarantee progress
+    if (split == begin || split == end)
+        split = (begin + end) / 2;
+
+    unsigned firstChild = nodes_.Size();
+    nodes_.Resize(firstChild + 2);
+    nodes_[nodeIndex].first_ = firstChild;
+    nodes_[nodeIndex].count_ = 0;
+
+    BuildNode(firstChild, begin, split, depth + 1, order, boxes, centers);
+    BuildNode(firstChild + 1, split, end, depth + 1, order, boxes, centers);
+}
+
+}
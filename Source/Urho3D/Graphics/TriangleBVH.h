@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class Frustum;
+class Ray;
+
+/// Triangle bounding volume hierarchy node.
+struct TriangleBVHNode
+{
+    /// Bounding box of the node's triangles.
+    BoundingBox box_;
+    /// Index of the first triangle if a leaf, otherwise index of the first of the two child nodes.
+    unsigned first_;
+    /// Number of triangles if a leaf, zero otherwise.
+    unsigned count_;
+};
+
+/// Bounding volume hierarchy of a geometry's triangles for accelerating ray and frustum queries on static geometry.
+class URHO3D_API TriangleBVH : public RefCounted
+{
+public:
+    /// Construct empty.
+    TriangleBVH() = default;
+
+    /// Build from vertex data with Vector3 positions first and optional 16- or 32-bit index data. The start and count are an index range, or a vertex range without index data.
+    void Build(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData, unsigned indexSize,
+        unsigned start, unsigned count);
+
+    /// Return ray hit distance to the nearest triangle or infinity if no hit. Optionally return the hit triangle's unnormalized normal, barycentric coordinates of the hit and position of the triangle's first index.
+    float HitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector3* outBary = nullptr, unsigned* outTriangle = nullptr) const;
+    /// Return positions of the first indices of the triangles whose bounding boxes are (partially) inside a frustum.
+    void GetTriangles(const Frustum& frustum, PODVector<unsigned>& result) const;
+    /// Return whether was built from the given data and range.
+    bool IsBuiltFrom(const unsigned char* vertexData, const unsigned char* indexData, unsigned start, unsigned count) const
+    {
+        return vertexData == vertexData_ && indexData == indexData_ && start == start_ && count == count_;
+    }
+
+    /// Return number of triangles.
+    unsigned GetNumTriangles() const { return triangles_.Size(); }
+
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+
+private:
+    /// Build a node from a range of the triangle order recursively.
+    void BuildNode(unsigned nodeIndex, unsigned begin, unsigned end, unsigned depth, PODVector<unsigned>& order,
+        const Vector<BoundingBox>& boxes, const PODVector<Vector3>& centers);
+
+    /// Nodes, root first.
+    Vector<TriangleBVHNode> nodes_;
+    /// Triangle vertex positions in leaf order, three per triangle.
+    PODVector<Vector3> positions_;
+    /// Positions of the triangles' first indices in leaf order.
+    PODVector<unsigned> triangles_;
+    /// Vertex data the hierarchy was built from.
+    const unsigned char* vertexData_{};
+    /// Index data the hierarchy was built from.
+    const unsigned char* indexData_{};
+    /// Start of the index or vertex range.
+    unsigned start_{};
+    /// Number of indices or vertices.
+    unsigned count_{};
+};
+
+}
@@ -89,6 +89,14 @@ bool VertexBuffer::SetSize(unsigned vertexCount, const PODVector<VertexElement>&
     return Create();
 }
 
+void* VertexBuffer::LockNoOverwrite(unsigned start, unsigned count)
+{
+    noOverwriteLock_ = dynamic_;
+    void* data = Lock(start, count, false);
+    noOverwriteLock_ = false;
+    return data;
+}
+
 void VertexBuffer::UpdateOffsets()
 {
     unsigned elementOffset = 0;
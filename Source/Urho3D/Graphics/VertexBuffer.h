@@ -60,6 +60,8 @@ public:
     bool SetDataRange(const void* data, unsigned start, unsigned count, bool discard = false);
     /// Lock the buffer for write-only editing. Return data pointer if successful. Optionally discard data outside the range.
     void* Lock(unsigned start, unsigned count, bool discard = false);
+    /// Lock a range of a dynamic buffer for write-only editing without waiting for the GPU. The range must not be in use by draw calls that have already been issued, for example when appending to a ring buffer. Falls back to a normal lock if not supported. Return data pointer if successful.
+    void* LockNoOverwrite(unsigned start, unsigned count);
     /// Unlock the buffer and apply changes to the GPU buffer.
     void Unlock();
 
@@ -139,9 +141,9 @@ private:
     bool Create();
     /// Update the shadow data to the GPU buffer.
     bool UpdateToGPU();
-    /// Map the GPU buffer into CPU memory. Not used on OpenGL.
+    /// Map the GPU buffer into CPU memory. On OpenGL used only for no-overwrite locks.
     void* MapBuffer(unsigned start, unsigned count, bool discard);
-    /// Unmap the GPU buffer. Not used on OpenGL.
+    /// Unmap the GPU buffer.
     void UnmapBuffer();
 
     /// Shadow data.
@@ -170,6 +172,8 @@ private:
     bool shadowed_{};
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_{};
+    /// No-overwrite lock flag.
+    bool noOverwriteLock_{};
 };
 
 }
@@ -22,14 +22,18 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
+#include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
+#include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/GraphicsImpl.h"
+#include "../Graphics/HLODGroup.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/Octree.h"
@@ -42,6 +46,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -55,6 +60,94 @@
 namespace Urho3D
 {
 
+/// Light grid dimensions for clustered forward lighting. The shader side constants are in Lighting.glsl and Lighting.hlsl.
+static const unsigned CLUSTER_SIZE_X = 16;
+static const unsigned CLUSTER_SIZE_Y = 8;
+static const unsigned CLUSTER_SIZE_Z = 16;
+/// Light grid texture width and height. Holds the light data, followed by the cluster headers and the light index lists.
+static const unsigned CLUSTER_TEXTURE_SIZE = 256;
+/// Maximum number of clustered lights per view. Further lights are rendered as ordinary per-pixel lights.
+static const unsigned MAX_CLUSTERED_LIGHTS = 256;
+/// Maximum number of lights per cluster.
+static const unsigned MAX_LIGHTS_PER_CLUSTER = 32;
+/// First texel of the cluster headers. Each light takes 3 texels before them.
+static const unsigned CLUSTER_HEADER_START = MAX_CLUSTERED_LIGHTS * 3;
+/// First texel of the light index lists.
+static const unsigned CLUSTER_INDEX_START = CLUSTER_HEADER_START + CLUSTER_SIZE_X * CLUSTER_SIZE_Y * CLUSTER_SIZE_Z;
+/// Number of frames a shadow caster must stay unmoved to be rendered into the static shadow map with shadow caching.
+static const unsigned STATIC_SHADOW_CASTER_FRAMES = 30;
+/// Minimum number of visible zones for using the zone lookup grid.
+static const unsigned ZONE_GRID_MIN_ZONES = 16;
+/// Maximum zone lookup grid cell count per axis.
+static const int ZONE_GRID_MAX_SIZE = 8;
+/// Name of the render path rendertarget holding the scene depth, captured for occlusion reprojection.
+static const StringHash DEPTH_RENDERTARGET_NAME("depth");
+
+/// Lifetime of a transient render path rendertarget within the commands, for sharing screen buffers.
+struct RenderTargetLifetime
+{
+    /// Index of the rendertarget in the render path.
+    unsigned index_;
+    /// Rendertarget name hash.
+    StringHash nameHash_;
+    /// Width in pixels.
+    int width_;
+    /// Height in pixels.
+    int height_;
+    /// Index of the first command using the rendertarget.
+    unsigned first_;
+    /// Index of the last command using the rendertarget.
+    unsigned last_;
+    /// Index of the shared screen buffer.
+    unsigned buffer_;
+};
+
+/// Shared screen buffer of transient rendertargets.
+struct SharedRenderTarget
+{
+    /// Lifetime of the first rendertarget using the buffer, which defines the format.
+    const RenderTargetLifetime* lifetime_;
+    /// Index of the last command using the buffer so far.
+    unsigned last_;
+    /// Screen buffer texture.
+    Texture* texture_;
+};
+
+static bool CompareRenderTargetLifetimes(const RenderTargetLifetime& lhs, const RenderTargetLifetime& rhs)
+{
+    return lhs.first_ < rhs.first_;
+}
+
+/// Extend a rendertarget lifetime to include a command if the name refers to it.
+static void UseRenderTarget(PODVector<RenderTargetLifetime>& lifetimes, const String& name, unsigned commandIndex)
+{
+    if (name.Empty())
+        return;
+
+    StringHash nameHash(name);
+    for (unsigned i = 0; i < lifetimes.Size(); ++i)
+    {
+        RenderTargetLifetime& lifetime = lifetimes[i];
+        if (lifetime.nameHash_ == nameHash)
+        {
+            lifetime.first_ = Min(lifetime.first_, commandIndex);
+            lifetime.last_ = Max(lifetime.last_, commandIndex);
+        }
+    }
+}
+
+/// Return GPU memory of a screen buffer in bytes, including the multisampled surface.
+static unsigned long long GetScreenBufferMemory(Texture* texture)
+{
+    unsigned long long size = texture->GetDataSize(texture->GetWidth(), texture->GetHeight());
+    if (texture->GetType() == TextureCube::GetTypeStatic())
+        size *= MAX_CUBEMAP_FACES;
+    // A multisampled buffer that is resolved automatically also has a single-sampled texture
+    if (texture->GetMultiSample() > 1)
+        size = size * texture->GetMultiSample() + (texture->GetAutoResolve() ? size : 0);
+    return size;
+}
+
 /// %Frustum octree query for shadowcasters.
 class ShadowCasterOctreeQuery : public FrustumOctreeQuery
 {
@@ -112,14 +205,15 @@ public:
     }
 };
 
-/// %Frustum octree query with occlusion.
-class OccludedFrustumOctreeQuery : public FrustumOctreeQuery
+/// %Frustum octree query with optional occlusion, which defers the drawable frustum tests to the worker threads. Drawables of octants fully inside the frustum are returned in the result, and drawables of intersecting octants separately.
+class DeferredFrustumOctreeQuery : public FrustumOctreeQuery
 {
 public:
     /// Construct with frustum, occlusion buffer and query parameters.
-    OccludedFrustumOctreeQuery(PODVector<Drawable*>& result, const Frustum& frustum, OcclusionBuffer* buffer,
-        unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) :
+    DeferredFrustumOctreeQuery(PODVector<Drawable*>& result, PODVector<Drawable*>& intersecting, const Frustum& frustum,
+        OcclusionBuffer* buffer, unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) :
         FrustumOctreeQuery(result, frustum, drawableFlags, viewMask),
+        intersecting_(intersecting),
         buffer_(buffer)
     {
     }
@@ -127,7 +221,9 @@ public:
     /// Intersection test for an octant.
     Intersection TestOctant(const BoundingBox& box, bool inside) override
     {
-        if (inside)
+        if (!buffer_)
+            return inside ? INSIDE : frustum_.IsInside(box);
+        else if (inside)
             return buffer_->IsVisible(box) ? INSIDE : OUTSIDE;
         else
         {
@@ -138,31 +234,53 @@ public:
         }
     }
 
-    /// Intersection test for drawables. Note: drawable occlusion is performed later in worker threads.
+    /// Intersection test for drawables. Note: drawable frustum and occlusion tests are performed later in worker threads.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override
     {
+        PODVector<Drawable*>& dest = inside ? result_ : intersecting_;
+
         while (start != end)
         {
             Drawable* drawable = *start++;
 
             if ((drawable->GetDrawableFlags() & drawableFlags_) && (drawable->GetViewMask() & viewMask_))
-            {
-                if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
-                    result_.Push(drawable);
-            }
+                dest.Push(drawable);
         }
     }
 
+    /// Result vector for drawables in intersecting octants.
+    PODVector<Drawable*>& intersecting_;
     /// Occlusion buffer.
     OcclusionBuffer* buffer_;
 };
 
+/// Return whether a drawable would be returned by ZoneOccluderOctreeQuery.
+static inline bool IsZoneOrOccluder(Drawable* drawable)
+{
+    unsigned char flags = drawable->GetDrawableFlags();
+    return flags == DRAWABLE_ZONE || (flags == DRAWABLE_GEOMETRY && drawable->IsOccluder());
+}
+
+/// Return whether two frustums have the same corners.
+static bool FrustumsEqual(const Frustum& lhs, const Frustum& rhs)
+{
+    for (unsigned i = 0; i < NUM_FRUSTUM_VERTICES; ++i)
+    {
+        if (lhs.vertices_[i] != rhs.vertices_[i])
+            return false;
+    }
+
+    return true;
+}
+
 void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* view = reinterpret_cast<View*>(item->aux_);
     auto** start = reinterpret_cast<Drawable**>(item->start_);
     auto** end = reinterpret_cast<Drawable**>(item->end_);
+    Drawable** firstIntersecting = view->firstIntersectingDrawable_;
     OcclusionBuffer* buffer = view->occlusionBuffer_;
+    const Frustum& frustum = view->cullCamera_->GetFrustum();
     const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
     Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
     Vector3 absViewZ = viewZ.Abs();
@@ -172,8 +290,20 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
 
     while (start != end)
     {
+        // Drawables from octants intersecting the frustum were not tested individually in the octree query
+        if (start >= firstIntersecting && !frustum.IsInsideFast((*start)->GetWorldBoundingBox()))
+        {
+            ++start;
+            continue;
+        }
+
         Drawable* drawable = *start++;
 
+        // Members of a hierarchical LOD group are replaced by the group's proxy at a distance, and vice versa
+        HLODGroup* hlodGroup = drawable->GetHLODGroup();
+        if (hlodGroup && hlodGroup->IsProxyActive(view->cullCamera_) != (drawable == hlodGroup))
+            continue;
+
         if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
         {
             drawable->UpdateBatches(view->frame_);
@@ -234,6 +364,41 @@ void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
     view->ProcessLight(*query, threadIndex);
 }
 
+void ProcessShadowSplitWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* view = reinterpret_cast<View*>(item->aux_);
+    auto* query = reinterpret_cast<LightQueryResult*>(item->start_);
+    auto splitIndex = (unsigned)(size_t)item->end_;
+
+    if (splitIndex < query->numSplits_)
+        view->ProcessShadowSplit(*query, splitIndex, threadIndex);
+}
+
+void BuildLightClusterSliceWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* view = reinterpret_cast<View*>(item->aux_);
+    auto slice = (unsigned)(size_t)item->start_;
+
+    view->BuildLightClusterSlice(slice);
+}
+
+static void AddClusteredShaderDefine(BatchQueue& queue)
+{
+    // Only the pixel shader needs the define
+    if (!queue.hasExtraDefines_)
+    {
+        queue.hasExtraDefines_ = true;
+        queue.vsExtraDefines_.Clear();
+        queue.psExtraDefines_.Clear();
+        queue.vsExtraDefinesHash_ = StringHash(queue.vsExtraDefines_);
+    }
+    else if (queue.psExtraDefines_.Contains("CLUSTERED"))
+        return;
+
+    queue.psExtraDefines_ = (queue.psExtraDefines_ + " CLUSTERED").Trimmed();
+    queue.psExtraDefinesHash_ = StringHash(queue.psExtraDefines_);
+}
+
 void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
 {
     const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
@@ -249,6 +414,16 @@ void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
+void CalculateLateAnimationsWork(const WorkItem* item, unsigned threadIndex)
+{
+    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
+    auto** start = reinterpret_cast<AnimatedModel**>(item->start_);
+    auto** end = reinterpret_cast<AnimatedModel**>(item->end_);
+
+    while (start != end)
+        (*start++)->CalculateLateAnimation(frame);
+}
+
 void SortBatchQueueFrontToBackWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* queue = reinterpret_cast<BatchQueue*>(item->start_);
@@ -274,7 +449,10 @@ void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
     for (unsigned i = 0; i < start->shadowSplits_.Size(); ++i)
+    {
         start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
+        start->shadowSplits_[i].staticShadowBatches_.SortFrontToBack();
+    }
 }
 
 StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename);
@@ -282,7 +460,8 @@ StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename);
 View::View(Context* context) :
     Object(context),
     graphics_(GetSubsystem<Graphics>()),
-    renderer_(GetSubsystem<Renderer>())
+    renderer_(GetSubsystem<Renderer>()),
+    frameArena_(GetSubsystem<FrameArena>())
 {
     // Create octree query and scene results vector for each thread
     unsigned numThreads = GetSubsystem<WorkQueue>()->GetNumThreads() + 1; // Worker threads + main thread
@@ -290,6 +469,8 @@ View::View(Context* context) :
     sceneResults_.Resize(numThreads);
 }
 
+View::~View() = default;
+
 bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
 {
     sourceView_ = nullptr;
@@ -318,6 +499,13 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
     viewSize_ = viewRect_.Size();
     rtSize_ = IntVector2(rtWidth, rtHeight);
 
+    // With dynamic resolution, backbuffer views render the scene into a smaller substitute target and upscale it at the end
+    float resolutionScale = renderTarget_ ? 1.0f : renderer_->GetResolutionScale();
+    IntVector2 scaledSize(Max(RoundToInt(viewSize_.x_ * resolutionScale), 1), Max(RoundToInt(viewSize_.y_ * resolutionScale), 1));
+    resolutionScaled_ = scaledSize != viewSize_;
+    if (resolutionScaled_)
+        viewSize_ = scaledSize;
+
     // On OpenGL flip the viewport if rendering to a texture for consistent UV addressing with Direct3D9
 #ifdef URHO3D_OPENGL
     if (renderTarget_)
@@ -346,6 +534,8 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
             noStencil_ = sourceView_->noStencil_;
             lightVolumeCommand_ = sourceView_->lightVolumeCommand_;
             forwardLightsCommand_ = sourceView_->forwardLightsCommand_;
+            tiledLightsCommand_ = sourceView_->tiledLightsCommand_;
+            clustered_ = sourceView_->clustered_;
             octree_ = sourceView_->octree_;
             return true;
         }
@@ -371,9 +561,11 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
     noStencil_ = false;
     lightVolumeCommand_ = nullptr;
     forwardLightsCommand_ = nullptr;
+    tiledLightsCommand_ = nullptr;
 
     scenePasses_.Clear();
     geometriesUpdated_ = false;
+    transformsSnapshotted_ = false;
 
 #ifdef URHO3D_OPENGL
 #ifdef GL_ES_VERSION_2_0
@@ -490,6 +682,26 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
             forwardLightsCommand_ = &command;
             useLitBase_ = command.useLitBase_;
         }
+        else if (command.type_ == CMD_TILEDLIGHTS)
+            tiledLightsCommand_ = &command;
+    }
+
+    // Clustered lighting needs either a forward light pass to replace or a tiled deferred light pass to feed, and a float
+    // texture for the light grid. In deferred mode the lights it can not handle still go through the light volumes
+#ifndef GL_ES_VERSION_2_0
+    clustered_ = renderer_->GetClusteredLighting() && Graphics::GetRGBAFloat32Format() &&
+        ((forwardLightsCommand_ && !deferred_) || (tiledLightsCommand_ && deferred_));
+#else
+    clustered_ = false;
+#endif
+    if (clustered_)
+    {
+        // The clustered lights are applied in the base and alpha passes
+        for (PODVector<ScenePassInfo>::Iterator i = scenePasses_.Begin(); i != scenePasses_.End(); ++i)
+        {
+            if (i->passIndex_ == basePassIndex_ || i->passIndex_ == alphaPassIndex_)
+                AddClusteredShaderDefine(*i->batchQueue_);
+        }
     }
 
     drawShadows_ = renderer_->GetDrawShadows();
@@ -560,6 +772,35 @@ void View::Update(const FrameInfo& frame)
     SendViewEvent(E_ENDVIEWUPDATE);
 }
 
+void View::SnapshotTransforms()
+{
+    // A view using another prepared view's batches has nothing of its own to copy
+    if (sourceView_ || !frameArena_ || (hasScenePasses_ && (!octree_ || !camera_)))
+        return;
+
+    // Skinning and other main thread geometry updates write the transforms that the batches point to, so do them first
+    if (!geometriesUpdated_)
+        UpdateGeometries();
+
+    URHO3D_PROFILE(SnapshotTransforms);
+
+    transformsSnapshotted_ = true;
+
+    for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
+        i->second_.SnapshotTransforms(frameArena_);
+
+    for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
+    {
+        i->litBaseBatches_.SnapshotTransforms(frameArena_);
+        i->litBatches_.SnapshotTransforms(frameArena_);
+        for (Vector<ShadowBatchQueue>::Iterator j = i->shadowSplits_.Begin(); j != i->shadowSplits_.End(); ++j)
+        {
+            j->shadowBatches_.SnapshotTransforms(frameArena_);
+            j->staticShadowBatches_.SnapshotTransforms(frameArena_);
+        }
+    }
+}
+
 void View::Render()
 {
     SendViewEvent(E_BEGINVIEWRENDER);
@@ -570,14 +811,38 @@ void View::Render()
         return;
     }
 
-    UpdateGeometries();
+    // The geometries may have already been updated for a render snapshot
+    if (!geometriesUpdated_)
+        UpdateGeometries();
+    else if (transformsSnapshotted_)
+    {
+        // All views were snapshotted before any was rendered, so vertex data that depends on the camera, such as sorted or
+        // fixed screen size billboards seen from several views, holds the last snapshotted view's data. Rewrite it for this view
+        for (PODVector<Drawable*>::ConstIterator i = nonThreadedGeometries_.Begin(); i != nonThreadedGeometries_.End(); ++i)
+        {
+            if ((*i)->GetUpdateGeometryType() == UPDATE_MAIN_THREAD)
+                (*i)->UpdateGeometry(frame_);
+        }
+    }
 
     // Allocate screen buffers as necessary
     AllocateScreenBuffers();
     SendViewEvent(E_VIEWBUFFERSREADY);
 
-    // Forget parameter sources from the previous view
-    graphics_->ClearParameterSources();
+    // Forget parameter sources from the previous view. The global parameters can be kept from a previous view of the same
+    // scene, unless they are customized per view
+    EventReceiverGroup* viewReceivers = context_->GetEventReceivers(renderer_, E_VIEWGLOBALSHADERPARAMETERS);
+    EventReceiverGroup* globalReceivers = context_->GetEventReceivers(E_VIEWGLOBALSHADERPARAMETERS);
+    if ((viewReceivers && !viewReceivers->receivers_.Empty()) || (globalReceivers && !globalReceivers->receivers_.Empty()))
+    {
+        globalParameterSource_ = this;
+        graphics_->ClearParameterSources();
+    }
+    else
+    {
+        globalParameterSource_ = scene_;
+        graphics_->ClearViewParameterSources();
+    }
 
     if (renderer_->GetDynamicInstancing() && graphics_->GetInstancingSupport())
         PrepareInstancingBuffer();
@@ -609,6 +874,9 @@ void View::Render()
     // Render
     ExecuteRenderPathCommands();
 
+    if (renderer_->GetOcclusionReprojection() && maxOccluderTriangles_ > 0 && camera_)
+        CaptureOcclusionDepth();
+
     // Reset state after commands
     graphics_->SetFillMode(FILL_SOLID);
     graphics_->SetLineAntiAlias(false);
@@ -678,6 +946,14 @@ View* View::GetSourceView() const
     return sourceView_;
 }
 
+Texture2D* View::GetClusterTexture() const
+{
+    if (sourceView_)
+        return sourceView_->GetClusterTexture();
+
+    return clustered_ ? clusterTexture_.Get() : nullptr;
+}
+
 void View::SetGlobalShaderParameters()
 {
     graphics_->SetShaderParameter(VSP_DELTATIME, frame_.timeStep_);
@@ -747,6 +1023,14 @@ void View::SetCameraShaderParameters(Camera* camera)
 
     graphics_->SetShaderParameter(VSP_VIEWPROJ, projection * camera->GetView());
 
+    // The light grid is always built from the view that did the culling
+    const View* clusterView = sourceView_ ? sourceView_.Get() : this;
+    if (clusterView->clustered_)
+    {
+        graphics_->SetShaderParameter(PSP_CLUSTERMATRIX, clusterView->clusterMatrix_);
+        graphics_->SetShaderParameter(PSP_CLUSTERPARAMS, clusterView->clusterParams_);
+    }
+
     // If in a scene pass and the command defines shader parameters, set them now
     if (passCommand_)
         SetCommandShaderParameters(*passCommand_);
@@ -791,10 +1075,31 @@ void View::GetDrawables()
     auto* queue = GetSubsystem<WorkQueue>();
     PODVector<Drawable*>& tempDrawables = tempDrawables_[0];
 
+    // Use the octree query made together with the other views of the scene, unless the camera has changed since
+    const Frustum& frustum = cullCamera_->GetFrustum();
+    const SharedSceneQuery* sharedQuery = renderer_->GetSharedSceneQuery(octree_, cullCamera_);
+    if (sharedQuery && (sharedQuery->viewMask_ != cullCamera_->GetViewMask() || !FrustumsEqual(sharedQuery->frustum_, frustum)))
+        sharedQuery = nullptr;
+
     // Get zones and occluders first
+    if (sharedQuery)
+    {
+        tempDrawables.Clear();
+        for (PODVector<Drawable*>::ConstIterator i = sharedQuery->inside_.Begin(); i != sharedQuery->inside_.End(); ++i)
+        {
+            if (IsZoneOrOccluder(*i))
+                tempDrawables.Push(*i);
+        }
+        for (PODVector<Drawable*>::ConstIterator i = sharedQuery->intersecting_.Begin(); i != sharedQuery->intersecting_.End(); ++i)
+        {
+            if (IsZoneOrOccluder(*i) && frustum.IsInsideFast((*i)->GetWorldBoundingBox()))
+                tempDrawables.Push(*i);
+        }
+    }
+    else
     {
         ZoneOccluderOctreeQuery
-            query(tempDrawables, cullCamera_->GetFrustum(), DRAWABLE_GEOMETRY | DRAWABLE_ZONE, cullCamera_->GetViewMask());
+            query(tempDrawables, frustum, DRAWABLE_GEOMETRY | DRAWABLE_ZONE, cullCamera_->GetViewMask());
         octree_->GetDrawables(query);
     }
 
@@ -845,33 +1150,60 @@ void View::GetDrawables()
     if (farClipZone_ == renderer_->GetDefaultZone())
         farClipZone_ = cameraZone_;
 
+    if (!cameraZoneOverride_)
+        BuildZoneGrid();
+
     // If occlusion in use, get & render the occluders
     occlusionBuffer_ = nullptr;
     if (maxOccluderTriangles_ > 0)
     {
         UpdateOccluders(occluders_, cullCamera_);
-        if (occluders_.Size())
+
+        // The reprojected depth of earlier frames can occlude even without occluders
+        OcclusionDepthHistory* history = renderer_->GetOcclusionReprojection() ?
+            renderer_->GetOcclusionDepthHistory(cullCamera_) : nullptr;
+        const OcclusionDepthData* reprojection = history && history->valid_ ? &history->data_ : nullptr;
+
+        if (occluders_.Size() || reprojection)
         {
             URHO3D_PROFILE(DrawOcclusion);
 
             occlusionBuffer_ = renderer_->GetOcclusionBuffer(cullCamera_);
-            DrawOccluders(occlusionBuffer_, occluders_);
+            DrawOccluders(occlusionBuffer_, occluders_, reprojection);
         }
     }
     else
         occluders_.Clear();
 
-    // Get lights and geometries. Coarse occlusion for octants is used at this point
-    if (occlusionBuffer_)
+    // Get lights and geometries. Coarse occlusion for octants is used at this point. Only octants are tested on the main thread,
+    // drawables of octants intersecting the frustum are placed last for the threaded frustum test
     {
-        OccludedFrustumOctreeQuery query
-            (tempDrawables, cullCamera_->GetFrustum(), occlusionBuffer_, DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
-        octree_->GetDrawables(query);
-    }
-    else
-    {
-        FrustumOctreeQuery query(tempDrawables, cullCamera_->GetFrustum(), DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
-        octree_->GetDrawables(query);
+        intersectingDrawables_.Clear();
+        if (sharedQuery)
+        {
+            // The shared query could not use the occlusion buffer for octants, but the drawables are still tested individually
+            tempDrawables.Clear();
+            for (PODVector<Drawable*>::ConstIterator i = sharedQuery->inside_.Begin(); i != sharedQuery->inside_.End(); ++i)
+            {
+                if ((*i)->GetDrawableFlags() & (DRAWABLE_GEOMETRY | DRAWABLE_LIGHT))
+                    tempDrawables.Push(*i);
+            }
+            for (PODVector<Drawable*>::ConstIterator i = sharedQuery->intersecting_.Begin(); i != sharedQuery->intersecting_.End(); ++i)
+            {
+                if ((*i)->GetDrawableFlags() & (DRAWABLE_GEOMETRY | DRAWABLE_LIGHT))
+                    intersectingDrawables_.Push(*i);
+            }
+        }
+        else
+        {
+            DeferredFrustumOctreeQuery query(tempDrawables, intersectingDrawables_, frustum, occlusionBuffer_,
+                DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
+            octree_->GetDrawables(query);
+        }
+
+        unsigned numInside = tempDrawables.Size();
+        tempDrawables.Push(intersectingDrawables_);
+        firstIntersectingDrawable_ = tempDrawables.Buffer() + numInside;
     }
 
     // Check drawable occlusion, find zones for moved drawables and collect geometries & lights in worker threads
@@ -896,6 +1228,7 @@ void View::GetDrawables()
             SharedPtr<WorkItem> item = queue->GetFreeItem();
             item->priority_ = M_MAX_UNSIGNED;
             item->workFunction_ = CheckVisibilityWork;
+            item->name_ = "CheckVisibilityWork";
             item->aux_ = this;
 
             PODVector<Drawable*>::Iterator end = tempDrawables.End();
@@ -904,7 +1237,7 @@ void View::GetDrawables()
 
             item->start_ = &(*start);
             item->end_ = &(*end);
-            queue->AddWorkItem(item);
+            queue->AddJob(item);
 
             start = end;
         }
@@ -963,7 +1296,13 @@ void View::GetBatches()
 
     ProcessLights();
     GetLightBatches();
+
+    // Build the light grid in worker threads while the base batches are collected
+    if (clustered_)
+        GetLightClusters();
     GetBaseBatches();
+    if (clustered_)
+        FinishLightClusters();
 }
 
 void View::ProcessLights()
@@ -974,22 +1313,68 @@ void View::ProcessLights()
     auto* queue = GetSubsystem<WorkQueue>();
     lightQueryResults_.Resize(lights_.Size());
 
+    // Query the shadow casters of each directional light split and point light face as separate jobs, as the cascades of
+    // the main directional light would otherwise be processed serially while the other threads are idle. The split jobs
+    // depend on the light job, which sets up the shadow cameras, so the two stages need no sync in between. Splits beyond
+    // the number the light job decides on do nothing
     for (unsigned i = 0; i < lightQueryResults_.Size(); ++i)
     {
+        LightQueryResult& query = lightQueryResults_[i];
+        query.light_ = lights_[i];
+        query.numSplits_ = 0;
+
         SharedPtr<WorkItem> item = queue->GetFreeItem();
         item->priority_ = M_MAX_UNSIGNED;
         item->workFunction_ = ProcessLightWork;
+        item->name_ = "ProcessLightWork";
         item->aux_ = this;
+        item->start_ = &query;
 
-        LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
+        unsigned maxSplits = 0;
+        if (drawShadows_ && query.light_->GetCastShadows())
+        {
+            LightType type = query.light_->GetLightType();
+            maxSplits = type == LIGHT_DIRECTIONAL ? MAX_CASCADE_SPLITS : (type == LIGHT_POINT ? (unsigned)MAX_CUBEMAP_FACES : 1);
+        }
 
-        item->start_ = &query;
-        queue->AddWorkItem(item);
+        SharedPtr<WorkItem> splitItems[MAX_CUBEMAP_FACES];
+        for (unsigned j = 0; j < maxSplits; ++j)
+        {
+            SharedPtr<WorkItem> splitItem = queue->GetFreeItem();
+            splitItem->priority_ = M_MAX_UNSIGNED;
+            splitItem->workFunction_ = ProcessShadowSplitWork;
+            splitItem->name_ = "ProcessShadowSplitWork";
+            splitItem->aux_ = this;
+            splitItem->start_ = &query;
+            splitItem->end_ = (void*)(size_t)j;
+            splitItem->AddDependency(item);
+            splitItems[j] = splitItem;
+        }
+
+        queue->AddJob(item);
+        for (unsigned j = 0; j < maxSplits; ++j)
+            queue->AddJob(splitItems[j]);
     }
 
     // Ensure all lights have been processed before proceeding
     queue->Complete(M_MAX_UNSIGNED);
+
+    // Merge the split shadow casters. If there are none, the light can be rendered unshadowed. At this point we have not
+    // allocated a shadow map yet, so the only cost has been the shadow camera setup & queries
+    for (unsigned i = 0; i < lightQueryResults_.Size(); ++i)
+    {
+        LightQueryResult& query = lightQueryResults_[i];
+        query.shadowCasters_.Clear();
+        for (unsigned j = 0; j < query.numSplits_; ++j)
+        {
+            query.shadowCasterBegin_[j] = query.shadowCasters_.Size();
+            query.shadowCasters_.Push(query.splitShadowCasters_[j]);
+            query.shadowCasterEnd_[j] = query.shadowCasters_.Size();
+        }
+
+        if (query.shadowCasters_.Empty())
+            query.numSplits_ = 0;
+    }
 }
 
 void View::GetLightBatches()
@@ -1000,12 +1385,22 @@ void View::GetLightBatches()
     {
         URHO3D_PROFILE(GetLightBatches);
 
-        // Preallocate light queues: per-pixel lights which have lit geometries
+        // Preallocate light queues: per-pixel lights which have lit geometries, except those applied through the light grid
         unsigned numLightQueues = 0;
         unsigned usedLightQueues = 0;
-        for (Vector<LightQueryResult>::ConstIterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
+        clusterLights_.Clear();
+        for (Vector<LightQueryResult>::Iterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
         {
-            if (!i->light_->GetPerVertex() && i->litGeometries_.Size())
+            i->clustered_ = false;
+            if (i->light_->GetPerVertex() || i->litGeometries_.Empty())
+                continue;
+
+            if (clusterLights_.Size() < MAX_CLUSTERED_LIGHTS && IsClusteredLight(*i))
+            {
+                i->clustered_ = true;
+                clusterLights_.Push(i->light_);
+            }
+            else
                 ++numLightQueues;
         }
 
@@ -1023,6 +1418,10 @@ void View::GetLightBatches()
 
             Light* light = query.light_;
 
+            // Clustered lights are applied in the base passes through the light grid
+            if (query.clustered_)
+                continue;
+
             // Per-pixel light
             if (!light->GetPerVertex())
             {
@@ -1034,6 +1433,9 @@ void View::GetLightBatches()
                 lightQueue.light_ = light;
                 lightQueue.negative_ = light->IsNegative();
                 lightQueue.shadowMap_ = nullptr;
+                lightQueue.shadowAtlas_ = false;
+                lightQueue.shadowMapCache_ = nullptr;
+                lightQueue.staticShadowCasters_.Clear();
                 lightQueue.litBaseBatches_.Clear(maxSortedInstances);
                 lightQueue.litBatches_.Clear(maxSortedInstances);
                 if (forwardLightsCommand_)
@@ -1046,15 +1448,33 @@ void View::GetLightBatches()
                     lightQueue.litBaseBatches_.hasExtraDefines_ = false;
                     lightQueue.litBatches_.hasExtraDefines_ = false;
                 }
+                // The lit base pass also includes the ambient light, so it applies the clustered lights as well
+                if (clustered_)
+                    AddClusteredShaderDefine(lightQueue.litBaseBatches_);
                 lightQueue.volumeBatches_.Clear();
 
                 // Allocate shadow map now
                 if (shadowSplits > 0)
                 {
-                    lightQueue.shadowMap_ = renderer_->GetShadowMap(light, cullCamera_, (unsigned)viewSize_.x_, (unsigned)viewSize_.y_);
+                    // With shadow caching the light has its own shadow map, which keeps its contents between frames
+                    if (light->GetShadowCaching())
+                        lightQueue.shadowMapCache_ = renderer_->GetShadowMapCache(light);
+                    if (lightQueue.shadowMapCache_)
+                        lightQueue.shadowMap_ = lightQueue.shadowMapCache_->shadowMap_;
+                    else
+                    {
+                        // Prefer a shadow atlas tile, then a separate shadow map
+                        lightQueue.shadowMap_ = renderer_->GetShadowAtlasTile(light, cullCamera_, (unsigned)viewSize_.x_,
+                            (unsigned)viewSize_.y_, lightQueue.shadowMapRect_);
+                        lightQueue.shadowAtlas_ = lightQueue.shadowMap_ != nullptr;
+                        if (!lightQueue.shadowMap_)
+                            lightQueue.shadowMap_ = renderer_->GetShadowMap(light, cullCamera_, (unsigned)viewSize_.x_, (unsigned)viewSize_.y_);
+                    }
                     // If did not manage to get a shadow map, convert the light to unshadowed
                     if (!lightQueue.shadowMap_)
                         shadowSplits = 0;
+                    else if (!lightQueue.shadowAtlas_)
+                        lightQueue.shadowMapRect_ = IntRect(0, 0, lightQueue.shadowMap_->GetWidth(), lightQueue.shadowMap_->GetHeight());
                 }
 
                 // Setup shadow batch queues
@@ -1067,9 +1487,10 @@ void View::GetLightBatches()
                     shadowQueue.nearSplit_ = query.shadowNearSplits_[j];
                     shadowQueue.farSplit_ = query.shadowFarSplits_[j];
                     shadowQueue.shadowBatches_.Clear(maxSortedInstances);
+                    shadowQueue.staticShadowBatches_.Clear(maxSortedInstances);
 
                     // Setup the shadow split viewport and finalize shadow camera parameters
-                    shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
+                    shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMapRect_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
 
                     // Loop through shadow casters
@@ -1088,6 +1509,13 @@ void View::GetLightBatches()
                                 threadedGeometries_.Push(drawable);
                         }
 
+                        // With shadow caching, the casters that have not moved or animated recently go to the static shadow map
+                        bool isStatic = lightQueue.shadowMapCache_ &&
+                            frame_.frameNumber_ - drawable->GetUpdateFrameNumber() > STATIC_SHADOW_CASTER_FRAMES;
+                        BatchQueue& destQueue = isStatic ? shadowQueue.staticShadowBatches_ : shadowQueue.shadowBatches_;
+                        if (isStatic)
+                            lightQueue.staticShadowCasters_.Push(drawable);
+
                         const Vector<SourceBatch>& batches = drawable->GetBatches();
 
                         for (unsigned l = 0; l < batches.Size(); ++l)
@@ -1107,9 +1535,19 @@ void View::GetLightBatches()
                             destBatch.pass_ = pass;
                             destBatch.zone_ = nullptr;
 
-                            AddBatchToQueue(shadowQueue.shadowBatches_, destBatch, tech);
+                            AddBatchToQueue(destQueue, destBatch, tech);
+                            // Record also the geometry and pass, as they may change due to LOD or material changes
+                            if (isStatic)
+                            {
+                                lightQueue.staticShadowCasters_.Push(srcBatch.geometry_);
+                                lightQueue.staticShadowCasters_.Push(pass);
+                            }
                         }
                     }
+
+                    // Separate the splits' static shadow casters
+                    if (lightQueue.shadowMapCache_)
+                        lightQueue.staticShadowCasters_.Push(nullptr);
                 }
 
                 // Process lit geometries
@@ -1185,6 +1623,8 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE(GetBaseBatches);
 
+    TextureStreamer* textureStreamer = renderer_->GetTextureStreamer();
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1196,15 +1636,22 @@ void View::GetBaseBatches()
 
         const Vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
+        float pixelSize = textureStreamer ? GetPixelSize(drawable) : 0.0f;
 
         for (unsigned j = 0; j < batches.Size(); ++j)
         {
             const SourceBatch& srcBatch = batches[j];
 
             // Check here if the material refers to a rendertarget texture with camera(s) attached
-            // Only check this for backbuffer views (null rendertarget)
-            if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
-                CheckMaterialForAuxView(srcBatch.material_);
+            // Only check this for backbuffer views (null rendertarget). Check again if the drawable is nearer than the
+            // one seen before on this frame, as the distance can throttle the aux view update rate
+            if (srcBatch.material_ && !renderTarget_ && (srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ ||
+                drawable->GetDistance() < srcBatch.material_->GetAuxViewDistance()))
+                CheckMaterialForAuxView(srcBatch.material_, drawable->GetDistance());
+
+            // Request streamed texture mip levels according to the drawable's on-screen size
+            if (textureStreamer && srcBatch.material_)
+                textureStreamer->RequestMaterial(srcBatch.material_, pixelSize);
 
             Technique* tech = GetTechnique(drawable, srcBatch.material_);
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
@@ -1250,6 +1697,8 @@ void View::GetBaseBatches()
                             i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
                             i->second_.light_ = nullptr;
                             i->second_.shadowMap_ = nullptr;
+                            i->second_.shadowAtlas_ = false;
+                            i->second_.shadowMapCache_ = nullptr;
                             i->second_.vertexLights_ = drawableVertexLights;
                         }
 
@@ -1282,6 +1731,52 @@ void View::UpdateGeometries()
 
     auto* queue = GetSubsystem<WorkQueue>();
 
+    // Sample and blend the animations of models that came into view in worker threads, then apply the poses to the bones in
+    // the main thread, so that the geometry updates see the new bone transforms
+    {
+        lateAnimatedModels_.Clear();
+        for (PODVector<Drawable*>::ConstIterator i = nonThreadedGeometries_.Begin(); i != nonThreadedGeometries_.End(); ++i)
+        {
+            if ((*i)->IsInstanceOf<AnimatedModel>())
+            {
+                auto* model = static_cast<AnimatedModel*>(*i);
+                if (model->IsLateAnimationPending())
+                    lateAnimatedModels_.Push(model);
+            }
+        }
+
+        if (lateAnimatedModels_.Size())
+        {
+            URHO3D_PROFILE(UpdateLateAnimations);
+
+            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+            int modelsPerItem = Max((int)(lateAnimatedModels_.Size() / numWorkItems), 1);
+
+            PODVector<AnimatedModel*>::Iterator start = lateAnimatedModels_.Begin();
+            for (int i = 0; i < numWorkItems && start != lateAnimatedModels_.End(); ++i)
+            {
+                PODVector<AnimatedModel*>::Iterator end = lateAnimatedModels_.End();
+                if (i < numWorkItems - 1 && end - start > modelsPerItem)
+                    end = start + modelsPerItem;
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = CalculateLateAnimationsWork;
+                item->name_ = "CalculateLateAnimationsWork";
+                item->aux_ = const_cast<FrameInfo*>(&frame_);
+                item->start_ = &(*start);
+                item->end_ = &(*end);
+                queue->AddJob(item);
+
+                start = end;
+            }
+            queue->Complete(M_MAX_UNSIGNED);
+
+            for (PODVector<AnimatedModel*>::ConstIterator i = lateAnimatedModels_.Begin(); i != lateAnimatedModels_.End(); ++i)
+                (*i)->ApplyLateAnimation();
+        }
+    }
+
     // Sort batches
     {
         for (unsigned i = 0; i < renderPath_->commands_.Size(); ++i)
@@ -1297,7 +1792,7 @@ void View::UpdateGeometries()
                 item->workFunction_ =
                     command.sortMode_ == SORT_FRONTTOBACK ? SortBatchQueueFrontToBackWork : SortBatchQueueBackToFrontWork;
                 item->start_ = &batchQueues_[command.passIndex_];
-                queue->AddWorkItem(item);
+                queue->AddJob(item);
             }
         }
 
@@ -1306,16 +1801,18 @@ void View::UpdateGeometries()
             SharedPtr<WorkItem> lightItem = queue->GetFreeItem();
             lightItem->priority_ = M_MAX_UNSIGNED;
             lightItem->workFunction_ = SortLightQueueWork;
+            lightItem->name_ = "SortLightQueueWork";
             lightItem->start_ = &(*i);
-            queue->AddWorkItem(lightItem);
+            queue->AddJob(lightItem);
 
             if (i->shadowSplits_.Size())
             {
                 SharedPtr<WorkItem> shadowItem = queue->GetFreeItem();
                 shadowItem->priority_ = M_MAX_UNSIGNED;
                 shadowItem->workFunction_ = SortShadowQueueWork;
+                shadowItem->name_ = "SortShadowQueueWork";
                 shadowItem->start_ = &(*i);
-                queue->AddWorkItem(shadowItem);
+                queue->AddJob(shadowItem);
             }
         }
     }
@@ -1349,10 +1846,11 @@ void View::UpdateGeometries()
                 SharedPtr<WorkItem> item = queue->GetFreeItem();
                 item->priority_ = M_MAX_UNSIGNED;
                 item->workFunction_ = UpdateDrawableGeometriesWork;
+                item->name_ = "UpdateDrawableGeometriesWork";
                 item->aux_ = const_cast<FrameInfo*>(&frame_);
                 item->start_ = &(*start);
                 item->end_ = &(*end);
-                queue->AddWorkItem(item);
+                queue->AddJob(item);
 
                 start = end;
             }
@@ -1363,8 +1861,13 @@ void View::UpdateGeometries()
             (*i)->UpdateGeometry(frame_);
     }
 
-    // Finally ensure all threaded work has completed
+    // Finally ensure all threaded work has completed, then upload what the threaded updates prepared
     queue->Complete(M_MAX_UNSIGNED);
+    for (PODVector<Drawable*>::ConstIterator i = threadedGeometries_.Begin(); i != threadedGeometries_.End(); ++i)
+    {
+        if (*i)
+            (*i)->FinishUpdateGeometry();
+    }
     geometriesUpdated_ = true;
 }
 
@@ -1439,51 +1942,264 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
     }
 }
 
-void View::ExecuteRenderPathCommands()
+bool View::IsClusteredLight(const LightQueryResult& query) const
 {
-    View* actualView = sourceView_ ? sourceView_ : this;
+    // The light grid supports unshadowed point and spot lights with the default attenuation and spot shape. Lights with a
+    // custom light mask need the per-drawable filtering of the per-pixel light passes
+    Light* light = query.light_;
+    return clustered_ && light->GetLightType() != LIGHT_DIRECTIONAL && !query.numSplits_ && !light->GetRampTexture() &&
+        !light->GetShapeTexture() && light->GetLightMask() == DEFAULT_LIGHTMASK;
+}
 
-    // If not reusing shadowmaps, render all of them first
-    if (!renderer_->GetReuseShadowMaps() && renderer_->GetDrawShadows() && !actualView->lightQueues_.Empty())
+void View::GetLightClusters()
+{
+    URHO3D_PROFILE(GetLightClusters);
+
+    if (clusterData_.Empty())
+        clusterData_.Resize(CLUSTER_TEXTURE_SIZE * CLUSTER_TEXTURE_SIZE);
+    clusterSliceIndices_.Resize(CLUSTER_SIZE_Z);
+
+    const Matrix3x4& view = cullCamera_->GetView();
+    Matrix4 projection = cullCamera_->GetProjection();
+
+    // The shaders find the cluster from the clip space X & Y divided by W, and the view space Z
+    clusterMatrix_ = projection * view;
+    clusterMatrix_.m20_ = view.m20_;
+    clusterMatrix_.m21_ = view.m21_;
+    clusterMatrix_.m22_ = view.m22_;
+    clusterMatrix_.m23_ = view.m23_;
+
+    // Use logarithmic depth slices for perspective and linear for orthographic cameras
+    float nearClip = cullCamera_->GetNearClip();
+    float farClip = cullCamera_->GetFarClip();
+    if (cullCamera_->IsOrthographic())
     {
-        URHO3D_PROFILE(RenderShadowMaps);
+        float scale = (float)CLUSTER_SIZE_Z / Max(farClip - nearClip, M_EPSILON);
+        clusterParams_ = Vector4(scale, -nearClip * scale, 0.0f, 0.0f);
+    }
+    else
+    {
+        float scale = (float)CLUSTER_SIZE_Z / Max(log2f(farClip / nearClip), M_EPSILON);
+        clusterParams_ = Vector4(scale, -log2f(nearClip) * scale, 1.0f, 0.0f);
+    }
 
-        for (Vector<LightBatchQueue>::Iterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
+    if (clusterLights_.Empty())
+        return;
+
+    // Get the tile corners on the near and far planes in view space
+    Matrix4 invProjection = projection.Inverse();
+    clusterNearCorners_.Resize((CLUSTER_SIZE_X + 1) * (CLUSTER_SIZE_Y + 1));
+    clusterFarCorners_.Resize((CLUSTER_SIZE_X + 1) * (CLUSTER_SIZE_Y + 1));
+    for (unsigned y = 0; y <= CLUSTER_SIZE_Y; ++y)
+    {
+        for (unsigned x = 0; x <= CLUSTER_SIZE_X; ++x)
         {
-            if (NeedRenderShadowMap(*i))
-                RenderShadowMap(*i);
+            float ndcX = 2.0f * x / CLUSTER_SIZE_X - 1.0f;
+            float ndcY = 2.0f * y / CLUSTER_SIZE_Y - 1.0f;
+            clusterNearCorners_[y * (CLUSTER_SIZE_X + 1) + x] = invProjection * Vector3(ndcX, ndcY, 0.0f);
+            clusterFarCorners_[y * (CLUSTER_SIZE_X + 1) + x] = invProjection * Vector3(ndcX, ndcY, 1.0f);
         }
     }
 
+    // Fill the light data in the same format as vertex lights, with the spot cutoff premultiplied to the direction
+    bool specularLighting = renderer_->GetSpecularLighting();
+    clusterLightSpheres_.Resize(clusterLights_.Size());
+    for (unsigned i = 0; i < clusterLights_.Size(); ++i)
     {
-        URHO3D_PROFILE(ExecuteRenderPath);
-
-        // Set for safety in case of empty renderpath
-        currentRenderTarget_ = substituteRenderTarget_ ? substituteRenderTarget_ : renderTarget_;
-        currentViewportTexture_ = nullptr;
-        passCommand_ = nullptr;
-
-        bool viewportModified = false;
-        bool isPingponging = false;
-        usedResolve_ = false;
-
-        unsigned lastCommandIndex = 0;
-        for (unsigned i = 0; i < renderPath_->commands_.Size(); ++i)
+        Light* light = clusterLights_[i];
+        Node* lightNode = light->GetNode();
+        Vector3 position = lightNode->GetWorldPosition();
+        float range = light->GetRange();
+
+        float fade = 1.0f;
+        float fadeEnd = light->GetDrawDistance();
+        float fadeStart = light->GetFadeDistance();
+        if (fadeEnd > 0.0f && fadeStart > 0.0f && fadeStart < fadeEnd)
+            fade = Min(1.0f - (light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
+
+        Color color = light->GetEffectiveColor() * fade;
+        Vector4* data = &clusterData_[i * 3];
+        data[0] = Vector4(position, 1.0f / Max(range, M_EPSILON));
+        data[1] = Vector4(color.r_, color.g_, color.b_, specularLighting ? light->GetSpecularIntensity() : 0.0f);
+
+        if (light->GetLightType() == LIGHT_SPOT)
         {
-            RenderPathCommand& command = renderPath_->commands_[i];
-            if (actualView->IsNecessary(command))
-                lastCommandIndex = i;
+            float cutoff = Cos(light->GetFov() * 0.5f);
+            float invCutoff = 1.0f / (1.0f - cutoff);
+            data[2] = Vector4(-lightNode->GetWorldDirection() * invCutoff, -cutoff * invCutoff);
         }
+        else
+            data[2] = Vector4(Vector3::ZERO, 1.0f);
 
-        for (unsigned i = 0; i < renderPath_->commands_.Size(); ++i)
-        {
-            RenderPathCommand& command = renderPath_->commands_[i];
-            if (!actualView->IsNecessary(command))
-                continue;
+        clusterLightSpheres_[i] = Sphere(view * position, range);
+    }
 
-            bool viewportRead = actualView->CheckViewportRead(command);
-            bool viewportWrite = actualView->CheckViewportWrite(command);
-            bool beginPingpong = actualView->CheckPingpong(i);
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < CLUSTER_SIZE_Z; ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = BuildLightClusterSliceWork;
+        item->name_ = "BuildLightClusterSliceWork";
+        item->aux_ = this;
+        item->start_ = (void*)(size_t)i;
+        queue->AddJob(item);
+    }
+}
+
+void View::BuildLightClusterSlice(unsigned slice)
+{
+    // Inverse of the shader's slice calculation
+    float nearZ = ((float)slice - clusterParams_.y_) / clusterParams_.x_;
+    float farZ = ((float)(slice + 1) - clusterParams_.y_) / clusterParams_.x_;
+    if (clusterParams_.z_ > 0.0f)
+    {
+        nearZ = exp2f(nearZ);
+        farZ = exp2f(farZ);
+    }
+
+    PODVector<float>& indices = clusterSliceIndices_[slice];
+    indices.Clear();
+
+    for (unsigned y = 0; y < CLUSTER_SIZE_Y; ++y)
+    {
+        for (unsigned x = 0; x < CLUSTER_SIZE_X; ++x)
+        {
+            // Get the cluster bounding box from the tile corners at the slice depth range
+            BoundingBox box;
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                unsigned corner = (y + (j >> 1u)) * (CLUSTER_SIZE_X + 1) + x + (j & 1u);
+                const Vector3& nearCorner = clusterNearCorners_[corner];
+                Vector3 direction = clusterFarCorners_[corner] - nearCorner;
+                box.Merge(nearCorner + direction * ((nearZ - nearCorner.z_) / direction.z_));
+                box.Merge(nearCorner + direction * ((farZ - nearCorner.z_) / direction.z_));
+            }
+
+            // The lights are sorted by importance, so if a cluster has too many lights, the least important are left out
+            unsigned start = indices.Size();
+            for (unsigned i = 0; i < clusterLightSpheres_.Size() && indices.Size() - start < MAX_LIGHTS_PER_CLUSTER; ++i)
+            {
+                const Sphere& sphere = clusterLightSpheres_[i];
+                if (sphere.center_.z_ + sphere.radius_ < nearZ || sphere.center_.z_ - sphere.radius_ > farZ)
+                    continue;
+                if (box.IsInside(sphere) != OUTSIDE)
+                    indices.Push((float)(i * 3));
+            }
+
+            clusterData_[CLUSTER_HEADER_START + (slice * CLUSTER_SIZE_Y + y) * CLUSTER_SIZE_X + x] =
+                Vector4((float)start, (float)(indices.Size() - start), 0.0f, 0.0f);
+        }
+    }
+}
+
+void View::FinishLightClusters()
+{
+    URHO3D_PROFILE(FinishLightClusters);
+
+    if (!clusterTexture_)
+    {
+        clusterTexture_ = new Texture2D(context_);
+        clusterTexture_->SetNumLevels(1);
+        clusterTexture_->SetFilterMode(FILTER_NEAREST);
+        clusterTexture_->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+        clusterTexture_->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+        if (!clusterTexture_->SetSize(CLUSTER_TEXTURE_SIZE, CLUSTER_TEXTURE_SIZE, Graphics::GetRGBAFloat32Format(), TEXTURE_DYNAMIC))
+        {
+            URHO3D_LOGERROR("Failed to create light grid texture, disabling clustered lighting");
+            renderer_->SetClusteredLighting(false);
+            return;
+        }
+        clusterTextureEmpty_ = false;
+    }
+
+    unsigned numTexels = CLUSTER_INDEX_START;
+
+    if (clusterLights_.Empty())
+    {
+        // Clear the cluster headers once when the last clustered light goes out of view
+        if (clusterTextureEmpty_)
+            return;
+        for (unsigned i = CLUSTER_HEADER_START; i < CLUSTER_INDEX_START; ++i)
+            clusterData_[i] = Vector4::ZERO;
+        clusterTextureEmpty_ = true;
+    }
+    else
+    {
+        GetSubsystem<WorkQueue>()->Complete(M_MAX_UNSIGNED);
+
+        // Append the light index lists of the slices after the headers, as far as the texture has space
+        const unsigned maxTexels = CLUSTER_TEXTURE_SIZE * CLUSTER_TEXTURE_SIZE;
+        for (unsigned i = 0; i < CLUSTER_SIZE_Z; ++i)
+        {
+            const PODVector<float>& indices = clusterSliceIndices_[i];
+            unsigned sliceStart = numTexels;
+            unsigned numIndices = Min(indices.Size(), maxTexels - numTexels);
+            for (unsigned j = 0; j < numIndices; ++j)
+                clusterData_[numTexels + j].x_ = indices[j];
+            numTexels += numIndices;
+
+            Vector4* headers = &clusterData_[CLUSTER_HEADER_START + i * CLUSTER_SIZE_X * CLUSTER_SIZE_Y];
+            for (unsigned j = 0; j < CLUSTER_SIZE_X * CLUSTER_SIZE_Y; ++j)
+            {
+                headers[j].y_ = Max(Min(headers[j].y_, (float)numIndices - headers[j].x_), 0.0f);
+                headers[j].x_ += (float)sliceStart;
+            }
+        }
+        clusterTextureEmpty_ = false;
+    }
+
+    unsigned numRows = (numTexels + CLUSTER_TEXTURE_SIZE - 1) / CLUSTER_TEXTURE_SIZE;
+    clusterTexture_->SetData(0, 0, 0, CLUSTER_TEXTURE_SIZE, numRows, clusterData_.Buffer());
+}
+
+void View::ExecuteRenderPathCommands()
+{
+    View* actualView = sourceView_ ? sourceView_ : this;
+
+    // If not reusing shadowmaps, render all of them first. Shadow atlas tiles are always rendered first, so that they
+    // share one rendertarget binding
+    if (renderer_->GetDrawShadows() && !actualView->lightQueues_.Empty())
+    {
+        URHO3D_PROFILE(RenderShadowMaps);
+
+        bool reuseShadowMaps = renderer_->GetReuseShadowMaps();
+        for (Vector<LightBatchQueue>::Iterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
+        {
+            if ((!reuseShadowMaps || i->shadowAtlas_) && NeedRenderShadowMap(*i))
+                RenderShadowMap(*i);
+        }
+    }
+
+    {
+        URHO3D_PROFILE(ExecuteRenderPath);
+
+        // Set for safety in case of empty renderpath
+        currentRenderTarget_ = substituteRenderTarget_ ? substituteRenderTarget_ : renderTarget_;
+        currentViewportTexture_ = nullptr;
+        passCommand_ = nullptr;
+
+        bool viewportModified = false;
+        bool isPingponging = false;
+        usedResolve_ = false;
+
+        unsigned lastCommandIndex = 0;
+        for (unsigned i = 0; i < renderPath_->commands_.Size(); ++i)
+        {
+            RenderPathCommand& command = renderPath_->commands_[i];
+            if (actualView->IsNecessary(command))
+                lastCommandIndex = i;
+        }
+
+        for (unsigned i = 0; i < renderPath_->commands_.Size(); ++i)
+        {
+            RenderPathCommand& command = renderPath_->commands_[i];
+            if (!actualView->IsNecessary(command))
+                continue;
+
+            bool viewportRead = actualView->CheckViewportRead(command);
+            bool viewportWrite = actualView->CheckViewportWrite(command);
+            bool beginPingpong = actualView->CheckPingpong(i);
 
             // Has the viewport been modified and will be read as a texture by the current command?
             if (viewportRead && viewportModified)
@@ -1542,10 +2258,11 @@ void View::ExecuteRenderPathCommands()
                     // If the render path ends into a quad, it can be redirected to the final render target
                     // However, on OpenGL we can not reliably do this in case the final target is the backbuffer, and we want to
                     // render depth buffer sensitive debug geometry afterward (backbuffer and textures can not share depth)
+                    // When rendering at a reduced dynamic resolution the quad must stay at that resolution
 #ifndef URHO3D_OPENGL
-                    if (i == lastCommandIndex && command.type_ == CMD_QUAD)
+                    if (i == lastCommandIndex && command.type_ == CMD_QUAD && !resolutionScaled_)
 #else
-                    if (i == lastCommandIndex && command.type_ == CMD_QUAD && renderTarget_)
+                    if (i == lastCommandIndex && command.type_ == CMD_QUAD && renderTarget_ && !resolutionScaled_)
 #endif
                         currentRenderTarget_ = renderTarget_;
                 }
@@ -1553,6 +2270,11 @@ void View::ExecuteRenderPathCommands()
                     currentRenderTarget_ = substituteRenderTarget_ ? substituteRenderTarget_ : renderTarget_;
             }
 
+            // Naming the block allocates, so skip it when GPU timing is off
+            bool gpuTiming = graphics_->GetGPUTiming();
+            if (gpuTiming)
+                graphics_->BeginGPUBlock(command.GetDisplayName().CString());
+
             switch (command.type_)
             {
             case CMD_CLEAR:
@@ -1616,7 +2338,7 @@ void View::ExecuteRenderPathCommands()
                     for (Vector<LightBatchQueue>::Iterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
                     {
                         // If reusing shadowmaps, render each of them before the lit batches
-                        if (renderer_->GetReuseShadowMaps() && NeedRenderShadowMap(*i))
+                        if (renderer_->GetReuseShadowMaps() && !i->shadowAtlas_ && NeedRenderShadowMap(*i))
                         {
                             RenderShadowMap(*i);
                             SetRenderTargets(command);
@@ -1652,6 +2374,18 @@ void View::ExecuteRenderPathCommands()
                 }
                 break;
 
+            case CMD_TILEDLIGHTS:
+                // Accumulate all lights of the light grid in one fullscreen pass
+                if (actualView->clustered_ && !actualView->clusterLights_.Empty())
+                {
+                    URHO3D_PROFILE(RenderTiledLights);
+
+                    SetRenderTargets(command);
+                    SetTextures(command);
+                    RenderTiledLights(command);
+                }
+                break;
+
             case CMD_LIGHTVOLUMES:
                 // Render shadow maps + light volumes
                 if (!actualView->lightQueues_.Empty())
@@ -1662,7 +2396,7 @@ void View::ExecuteRenderPathCommands()
                     for (Vector<LightBatchQueue>::Iterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
                     {
                         // If reusing shadowmaps, render each of them before the lit batches
-                        if (renderer_->GetReuseShadowMaps() && NeedRenderShadowMap(*i))
+                        if (renderer_->GetReuseShadowMaps() && !i->shadowAtlas_ && NeedRenderShadowMap(*i))
                         {
                             RenderShadowMap(*i);
                             SetRenderTargets(command);
@@ -1711,6 +2445,9 @@ void View::ExecuteRenderPathCommands()
                 break;
             }
 
+            if (gpuTiming)
+                graphics_->EndGPUBlock();
+
             // If current command output to the viewport, mark it modified
             if (viewportWrite)
                 viewportModified = true;
@@ -1742,7 +2479,7 @@ void View::SetRenderTargets(RenderPathCommand& command)
             {
                 useColorWrite = false;
                 useCustomDepth = true;
-#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11)
+#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11) && !defined(URHO3D_NULL_GRAPHICS)
                 // On D3D9 actual depth-only rendering is illegal, we need a color rendertarget
                 if (!depthOnlyDummyTexture_)
                 {
@@ -1844,7 +2581,8 @@ void View::RenderQuad(RenderPathCommand& command)
     // Set shaders & shader parameters and textures
     graphics_->SetShaders(vs, ps);
 
-    SetGlobalShaderParameters();
+    if (graphics_->NeedParameterUpdate(SP_FRAME, globalParameterSource_))
+        SetGlobalShaderParameters();
     SetCameraShaderParameters(camera_);
 
     // During renderpath commands the G-Buffer or viewport texture is assumed to always be viewport-sized
@@ -1888,6 +2626,58 @@ void View::RenderQuad(RenderPathCommand& command)
     DrawFullscreenQuad(false);
 }
 
+void View::RenderTiledLights(RenderPathCommand& command)
+{
+    if (command.vertexShaderName_.Empty() || command.pixelShaderName_.Empty())
+        return;
+
+    // Reconstruct the world position the same way as the directional light volume
+    String vsDefines = command.vertexShaderDefines_;
+    String psDefines = command.pixelShaderDefines_;
+    if (camera_->IsOrthographic())
+    {
+        vsDefines = (vsDefines + " ORTHO").Trimmed();
+        psDefines = (psDefines + " ORTHO").Trimmed();
+    }
+
+    ShaderVariation* vs = graphics_->GetShader(VS, command.vertexShaderName_, vsDefines);
+    if (!vs)
+        command.vertexShaderName_ = String::EMPTY;
+    ShaderVariation* ps = graphics_->GetShader(PS, command.pixelShaderName_, psDefines);
+    if (!ps)
+        command.pixelShaderName_ = String::EMPTY;
+
+    graphics_->SetShaders(vs, ps);
+
+    if (graphics_->NeedParameterUpdate(SP_FRAME, globalParameterSource_))
+        SetGlobalShaderParameters();
+    SetCameraShaderParameters(camera_);
+
+    IntRect viewport = graphics_->GetViewport();
+    IntVector2 viewSize = IntVector2(viewport.Width(), viewport.Height());
+    SetGBufferShaderParameters(viewSize, IntRect(0, 0, viewSize.x_, viewSize.y_));
+    SetCommandShaderParameters(command);
+
+    graphics_->SetTexture(TU_LIGHTBUFFER, GetClusterTexture());
+
+    graphics_->SetBlendMode(BLEND_ADD);
+    graphics_->SetDepthTest(CMP_ALWAYS);
+    graphics_->SetDepthWrite(false);
+    graphics_->SetFillMode(FILL_SOLID);
+    graphics_->SetLineAntiAlias(false);
+    graphics_->SetClipPlane(false);
+    graphics_->SetScissorTest(false);
+    // Skip pixels that were not written to the G-buffer. Clustered lights always use the default light mask
+    if (!noStencil_)
+        graphics_->SetStencilTest(true, CMP_NOTEQUAL, OP_KEEP, OP_KEEP, OP_KEEP, 0, DEFAULT_LIGHTMASK);
+    else
+        graphics_->SetStencilTest(false);
+
+    DrawFullscreenQuad(false);
+
+    graphics_->SetStencilTest(false);
+}
+
 bool View::IsNecessary(const RenderPathCommand& command)
 {
     return command.enabled_ && command.outputs_.Size() &&
@@ -1994,6 +2784,9 @@ void View::AllocateScreenBuffers()
     // If backbuffer is antialiased when using deferred rendering, need to reserve a buffer
     if (deferred_ && !renderTarget_ && graphics_->GetMultiSample() > 1)
         needSubstitute = true;
+    // If rendering at a reduced dynamic resolution, the scene goes to a buffer of that size and is upscaled at the end
+    if (resolutionScaled_)
+        needSubstitute = true;
     // If viewport is smaller than whole texture/backbuffer in deferred rendering, need to reserve a buffer, as the G-buffer
     // textures will be sized equal to the viewport
     if (viewSize_.x_ < rtSize_.x_ || viewSize_.y_ < rtSize_.y_)
@@ -2057,7 +2850,10 @@ void View::AllocateScreenBuffers()
     if (numViewportTextures == 1 && substituteRenderTarget_)
         viewportTextures_[1] = substituteRenderTarget_->GetParentTexture();
 
-    // Allocate extra render targets defined by the render path
+    // Allocate extra render targets defined by the render path. Transient render targets are allocated after finding their
+    // lifetimes in the commands
+    PODVector<RenderTargetLifetime> lifetimes;
+    bool aliasing = renderer_->GetRenderTargetAliasing();
     for (unsigned i = 0; i < renderPath_->renderTargets_.Size(); ++i)
     {
         const RenderTargetInfo& rtInfo = renderPath_->renderTargets_[i];
@@ -2081,12 +2877,126 @@ void View::AllocateScreenBuffers()
         auto intWidth = RoundToInt(width);
         auto intHeight = RoundToInt(height);
 
+        // Depth-stencil buffers of the same size are always shared by the renderer
+        bool depthStencil = rtInfo.format_ == Graphics::GetDepthStencilFormat() || rtInfo.format_ == Graphics::GetReadableDepthFormat();
+        if (aliasing && !rtInfo.persistent_ && !depthStencil)
+        {
+            RenderTargetLifetime lifetime{i, StringHash(rtInfo.name_), intWidth, intHeight, M_MAX_UNSIGNED, 0, 0};
+            lifetimes.Push(lifetime);
+            continue;
+        }
+
         // If the rendertarget is persistent, key it with a hash derived from the RT name and the view's pointer
         renderTargets_[rtInfo.name_] =
             renderer_->GetScreenBuffer(intWidth, intHeight, rtInfo.format_, rtInfo.multiSample_, rtInfo.autoResolve_,
                 rtInfo.cubemap_, rtInfo.filtered_, rtInfo.sRGB_, rtInfo.persistent_ ? StringHash(rtInfo.name_).Value()
                 + (unsigned)(size_t)this : 0);
     }
+
+    if (!lifetimes.Empty())
+        AllocateTransientRenderTargets(lifetimes);
+
+    // Sum the memory of the distinct screen buffers
+    PODVector<Texture*> buffers;
+    if (substituteRenderTarget_)
+        buffers.Push(substituteRenderTarget_->GetParentTexture());
+    for (unsigned i = 0; i < MAX_VIEWPORT_TEXTURES; ++i)
+    {
+        if (viewportTextures_[i] && !buffers.Contains(viewportTextures_[i]))
+            buffers.Push(viewportTextures_[i]);
+    }
+    for (HashMap<StringHash, Texture*>::ConstIterator i = renderTargets_.Begin(); i != renderTargets_.End(); ++i)
+    {
+        if (i->second_ && !buffers.Contains(i->second_))
+            buffers.Push(i->second_);
+    }
+    renderTargetMemory_ = 0;
+    for (unsigned i = 0; i < buffers.Size(); ++i)
+        renderTargetMemory_ += GetScreenBufferMemory(buffers[i]);
+}
+
+void View::AllocateTransientRenderTargets(PODVector<RenderTargetLifetime>& lifetimes)
+{
+    View* actualView = sourceView_ ? sourceView_ : this;
+    unsigned numCommands = renderPath_->commands_.Size();
+
+    // Find the first and last command using each rendertarget as an output, depth-stencil or texture
+    for (unsigned i = 0; i < numCommands; ++i)
+    {
+        const RenderPathCommand& command = renderPath_->commands_[i];
+        if (!actualView->IsNecessary(command))
+            continue;
+
+        // Event handlers may access any rendertarget
+        if (command.type_ == CMD_SENDEVENT)
+        {
+            for (unsigned j = 0; j < lifetimes.Size(); ++j)
+            {
+                lifetimes[j].first_ = Min(lifetimes[j].first_, i);
+                lifetimes[j].last_ = Max(lifetimes[j].last_, i);
+            }
+            continue;
+        }
+
+        for (unsigned j = 0; j < command.outputs_.Size(); ++j)
+            UseRenderTarget(lifetimes, command.outputs_[j].first_, i);
+        UseRenderTarget(lifetimes, command.depthStencilName_, i);
+        for (unsigned j = 0; j < MAX_TEXTURE_UNITS; ++j)
+            UseRenderTarget(lifetimes, command.textureNames_[j], i);
+    }
+
+    // Keep unused rendertargets, which may be accessed from outside the commands, and the depth rendertarget read after the
+    // commands for occlusion reprojection, for the whole render
+    for (unsigned i = 0; i < lifetimes.Size(); ++i)
+    {
+        RenderTargetLifetime& lifetime = lifetimes[i];
+        if (lifetime.first_ == M_MAX_UNSIGNED)
+            lifetime.first_ = 0;
+        if (lifetime.first_ > lifetime.last_ || lifetime.nameHash_ == DEPTH_RENDERTARGET_NAME)
+            lifetime.last_ = numCommands;
+    }
+
+    // Assign the rendertargets in order of first use to the first buffer of the same format and size that is no longer in use
+    Sort(lifetimes.Begin(), lifetimes.End(), CompareRenderTargetLifetimes);
+    PODVector<SharedRenderTarget> buffers;
+    for (unsigned i = 0; i < lifetimes.Size(); ++i)
+    {
+        RenderTargetLifetime& lifetime = lifetimes[i];
+        const RenderTargetInfo& rtInfo = renderPath_->renderTargets_[lifetime.index_];
+
+        lifetime.buffer_ = buffers.Size();
+        for (unsigned j = 0; j < buffers.Size(); ++j)
+        {
+            SharedRenderTarget& buffer = buffers[j];
+            const RenderTargetInfo& bufferInfo = renderPath_->renderTargets_[buffer.lifetime_->index_];
+            if (buffer.last_ < lifetime.first_ && buffer.lifetime_->width_ == lifetime.width_ &&
+                buffer.lifetime_->height_ == lifetime.height_ && bufferInfo.format_ == rtInfo.format_ &&
+                bufferInfo.multiSample_ == rtInfo.multiSample_ && bufferInfo.autoResolve_ == rtInfo.autoResolve_ &&
+                bufferInfo.cubemap_ == rtInfo.cubemap_ && bufferInfo.filtered_ == rtInfo.filtered_ && bufferInfo.sRGB_ == rtInfo.sRGB_)
+            {
+                lifetime.buffer_ = j;
+                buffer.last_ = lifetime.last_;
+                break;
+            }
+        }
+
+        if (lifetime.buffer_ == buffers.Size())
+        {
+            SharedRenderTarget buffer{&lifetime, lifetime.last_, nullptr};
+            buffers.Push(buffer);
+        }
+    }
+
+    for (unsigned i = 0; i < buffers.Size(); ++i)
+    {
+        SharedRenderTarget& buffer = buffers[i];
+        const RenderTargetInfo& rtInfo = renderPath_->renderTargets_[buffer.lifetime_->index_];
+        buffer.texture_ = renderer_->GetScreenBuffer(buffer.lifetime_->width_, buffer.lifetime_->height_, rtInfo.format_,
+            rtInfo.multiSample_, rtInfo.autoResolve_, rtInfo.cubemap_, rtInfo.filtered_, rtInfo.sRGB_);
+    }
+
+    for (unsigned i = 0; i < lifetimes.Size(); ++i)
+        renderTargets_[lifetimes[i].nameHash_] = buffers[lifetimes[i].buffer_].texture_;
 }
 
 void View::BlitFramebuffer(Texture* source, RenderSurface* destination, bool depthWrite)
@@ -2160,6 +3070,85 @@ void View::DrawFullscreenQuad(bool setIdentityProjection)
     geometry->Draw(graphics_);
 }
 
+void View::CaptureOcclusionDepth()
+{
+    // The scene depth can only be captured from render paths that store it in a rendertarget
+    HashMap<StringHash, Texture*>::ConstIterator i = renderTargets_.Find(DEPTH_RENDERTARGET_NAME);
+    Texture* depthTexture = i != renderTargets_.End() ? i->second_ : nullptr;
+    if (!depthTexture || depthTexture->GetType() != Texture2D::GetTypeStatic())
+        return;
+
+    int width = renderer_->GetOcclusionBufferSize();
+    int height = Max(RoundToInt((float)width * (float)viewSize_.y_ / (float)viewSize_.x_), 1);
+    OcclusionDepthHistory* history = renderer_->GetOcclusionDepthHistory(camera_, true, width, height);
+    if (!history)
+        return;
+
+    URHO3D_PROFILE(CaptureOcclusionDepth);
+
+    // Downsample the depth into the next texture in turn, keeping the farthest depth of each destination texel
+    unsigned index = history->nextTexture_;
+    RenderSurface* destination = history->textures_[index]->GetRenderSurface();
+    IntVector2 srcSize(depthTexture->GetWidth(), depthTexture->GetHeight());
+    bool hwDepth = depthTexture->GetFormat() == Graphics::GetReadableDepthFormat();
+
+    graphics_->SetBlendMode(BLEND_REPLACE);
+    graphics_->SetColorWrite(true);
+    graphics_->SetDepthTest(CMP_ALWAYS);
+    graphics_->SetDepthWrite(false);
+    graphics_->SetFillMode(FILL_SOLID);
+    graphics_->SetClipPlane(false);
+    graphics_->SetScissorTest(false);
+    graphics_->SetStencilTest(false);
+    graphics_->SetRenderTarget(0, destination);
+    for (unsigned j = 1; j < MAX_RENDERTARGETS; ++j)
+        graphics_->SetRenderTarget(j, (RenderSurface*)nullptr);
+    graphics_->SetDepthStencil(GetDepthStencil(destination));
+    graphics_->SetViewport(IntRect(0, 0, width, height));
+
+    static const char* shaderName = "OcclusionDepth";
+    graphics_->SetShaders(graphics_->GetShader(VS, shaderName), graphics_->GetShader(PS, shaderName, hwDepth ? "HWDEPTH" : ""));
+
+    SetCameraShaderParameters(camera_);
+    SetGBufferShaderParameters(srcSize, IntRect(0, 0, srcSize.x_, srcSize.y_));
+    graphics_->SetShaderParameter(PSP_OCCLUSIONDEPTHSTEP, Vector2(0.25f / (float)width, 0.25f / (float)height));
+    graphics_->SetTexture(TU_DEPTHBUFFER, depthTexture);
+    DrawFullscreenQuad(true);
+    graphics_->SetTexture(TU_DEPTHBUFFER, nullptr);
+
+    OcclusionDepthData& view = history->views_[index];
+    view.cameraTransform_ = camera_->GetEffectiveWorldTransform();
+    view.inverseProjection_ = camera_->GetProjection().Inverse();
+    view.farClip_ = camera_->GetFarClip();
+    view.orthographic_ = camera_->IsOrthographic();
+#ifdef URHO3D_OPENGL
+    // OpenGL textures start from the bottom, unless the view is flipped for rendering to a texture
+    view.flipVertical_ = !camera_->GetFlipVertical();
+#endif
+    view.width_ = width;
+    view.height_ = height;
+    history->rendered_[index] = true;
+
+    // Read back the oldest texture. It was rendered frames ago, so reading it should not wait for the GPU to finish the
+    // current frame
+    index = (index + 1) % NUM_OCCLUSION_DEPTH_TEXTURES;
+    history->nextTexture_ = index;
+    if (history->rendered_[index])
+    {
+        OcclusionDepthData& data = history->data_;
+        const OcclusionDepthData& source = history->views_[index];
+        data.cameraTransform_ = source.cameraTransform_;
+        data.inverseProjection_ = source.inverseProjection_;
+        data.farClip_ = source.farClip_;
+        data.orthographic_ = source.orthographic_;
+        data.flipVertical_ = source.flipVertical_;
+        data.width_ = source.width_;
+        data.height_ = source.height_;
+        data.depth_.Resize((unsigned)(data.width_ * data.height_));
+        history->valid_ = history->textures_[index]->GetData(0, data.depth_.Buffer());
+    }
+}
+
 void View::UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera)
 {
     float occluderSizeThreshold_ = renderer_->GetOccluderSizeThreshold();
@@ -2220,11 +3209,14 @@ void View::UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera)
         Sort(occluders.Begin(), occluders.End(), CompareDrawables);
 }
 
-void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders)
+void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders, const OcclusionDepthData* reprojection)
 {
     buffer->SetMaxTriangles((unsigned)maxOccluderTriangles_);
     buffer->Clear();
 
+    if (reprojection)
+        buffer->Reproject(*reprojection);
+
     if (!buffer->IsThreaded())
     {
         // If not threaded, draw occluders one by one and test the next occluder against already rasterized depth
@@ -2270,7 +3262,6 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
     Light* light = query.light_;
     LightType type = light->GetLightType();
     unsigned lightMask = light->GetLightMask();
-    const Frustum& frustum = cullCamera_->GetFrustum();
 
     // Check if light should be shadowed
     bool isShadowed = drawShadows_ && light->GetCastShadows() && !light->GetPerVertex() && light->GetShadowIntensity() < 1.0f;
@@ -2283,8 +3274,8 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         isShadowed = false;
 #endif
     // Get lit geometries. They must match the light mask and be inside the main camera frustum to be considered
-    PODVector<Drawable*>& tempDrawables = tempDrawables_[threadIndex];
     query.litGeometries_.Clear();
+    query.lightDrawables_ = nullptr;
 
     switch (type)
     {
@@ -2297,27 +3288,42 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         break;
 
     case LIGHT_SPOT:
+    case LIGHT_POINT:
         {
-            FrustumOctreeQuery octreeQuery(tempDrawables, light->GetFrustum(), DRAWABLE_GEOMETRY,
-                cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
+            // The query depends only on the light and the view mask, so it is shared by views and kept across frames until
+            // a drawable is added, removed, moved or resized within the light volume. This includes the light itself, as its
+            // bounding box changes when it moves or changes range
+            LightQueryCache& cache = light->GetQueryCache();
+            unsigned viewMask = cullCamera_->GetViewMask();
+            bool cacheValid = cache.octree_ == octree_ && cache.viewMask_ == viewMask;
+            if (type == LIGHT_SPOT)
             {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
+                Frustum lightFrustum = light->GetFrustum();
+                if (!cacheValid || octree_->HasChanges(cache.numChanges_, lightFrustum))
+                {
+                    FrustumOctreeQuery octreeQuery(cache.drawables_, lightFrustum, DRAWABLE_GEOMETRY, viewMask);
+                    octree_->GetDrawables(octreeQuery);
+                }
             }
-        }
-        break;
+            else
+            {
+                Sphere lightSphere(light->GetNode()->GetWorldPosition(), light->GetRange());
+                if (!cacheValid || octree_->HasChanges(cache.numChanges_, lightSphere))
+                {
+                    SphereOctreeQuery octreeQuery(cache.drawables_, lightSphere, DRAWABLE_GEOMETRY, viewMask);
+                    octree_->GetDrawables(octreeQuery);
+                }
+            }
+            cache.octree_ = octree_;
+            cache.viewMask_ = viewMask;
+            cache.numChanges_ = octree_->GetNumChanges();
 
-    case LIGHT_POINT:
-        {
-            SphereOctreeQuery octreeQuery(tempDrawables, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
-                DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
+            query.lightDrawables_ = &cache.drawables_;
+            for (unsigned i = 0; i < cache.drawables_.Size(); ++i)
             {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
+                Drawable* drawable = cache.drawables_[i];
+                if (drawable->IsInView(frame_) && (GetLightMask(drawable) & lightMask))
+                    query.litGeometries_.Push(drawable);
             }
         }
         break;
@@ -2330,42 +3336,38 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         return;
     }
 
-    // Determine number of shadow cameras and setup their initial positions
+    // Determine number of shadow cameras and setup their initial positions. The splits are processed for shadow casters
+    // afterward
     SetupShadowCameras(query);
+}
 
-    // Process each split for shadow casters
-    query.shadowCasters_.Clear();
-    for (unsigned i = 0; i < query.numSplits_; ++i)
-    {
-        Camera* shadowCamera = query.shadowCameras_[i];
-        const Frustum& shadowCameraFrustum = shadowCamera->GetFrustum();
-        query.shadowCasterBegin_[i] = query.shadowCasterEnd_[i] = query.shadowCasters_.Size();
-
-        // For point light check that the face is visible: if not, can skip the split
-        if (type == LIGHT_POINT && frustum.IsInsideFast(BoundingBox(shadowCameraFrustum)) == OUTSIDE)
-            continue;
-
-        // For directional light check that the split is inside the visible scene: if not, can skip the split
-        if (type == LIGHT_DIRECTIONAL)
-        {
-            if (minZ_ > query.shadowFarSplits_[i])
-                continue;
-            if (maxZ_ < query.shadowNearSplits_[i])
-                continue;
+void View::ProcessShadowSplit(LightQueryResult& query, unsigned splitIndex, unsigned threadIndex)
+{
+    LightType type = query.light_->GetLightType();
+    Camera* shadowCamera = query.shadowCameras_[splitIndex];
+    const Frustum& shadowCameraFrustum = shadowCamera->GetFrustum();
+    query.splitShadowCasters_[splitIndex].Clear();
 
-            // Reuse lit geometry query for all except directional lights
-            ShadowCasterOctreeQuery query(tempDrawables, shadowCameraFrustum, DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
-            octree_->GetDrawables(query);
-        }
+    // For point light check that the face is visible: if not, can skip the split
+    if (type == LIGHT_POINT && cullCamera_->GetFrustum().IsInsideFast(BoundingBox(shadowCameraFrustum)) == OUTSIDE)
+        return;
 
-        // Check which shadow casters actually contribute to the shadowing
-        ProcessShadowCasters(query, tempDrawables, i);
+    // For directional light check that the split is inside the visible scene: if not, can skip the split
+    if (type == LIGHT_DIRECTIONAL)
+    {
+        if (minZ_ > query.shadowFarSplits_[splitIndex])
+            return;
+        if (maxZ_ < query.shadowNearSplits_[splitIndex])
+            return;
+
+        // Reuse lit geometry query for all except directional lights
+        PODVector<Drawable*>& tempDrawables = tempDrawables_[threadIndex];
+        ShadowCasterOctreeQuery octreeQuery(tempDrawables, shadowCameraFrustum, DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
+        octree_->GetDrawables(octreeQuery);
+        ProcessShadowCasters(query, tempDrawables, splitIndex);
     }
-
-    // If no shadow casters, the light can be rendered unshadowed. At this point we have not allocated a shadow map yet, so the
-    // only cost has been the shadow camera setup & queries
-    if (query.shadowCasters_.Empty())
-        query.numSplits_ = 0;
+    else
+        ProcessShadowCasters(query, *query.lightDrawables_, splitIndex);
 }
 
 void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex)
@@ -2413,6 +3415,10 @@ void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawabl
         // For point light, check that this drawable is inside the split shadow camera frustum
         if (type == LIGHT_POINT && shadowCameraFrustum.IsInsideFast(drawable->GetWorldBoundingBox()) == OUTSIDE)
             continue;
+        // Cast shadows from the same hierarchical LOD representation as is rendered
+        HLODGroup* hlodGroup = drawable->GetHLODGroup();
+        if (hlodGroup && hlodGroup->IsProxyActive(cullCamera_) != (drawable == hlodGroup))
+            continue;
 
         // Check shadow distance
         // Note: as lights are processed threaded, it is possible a drawable's UpdateBatches() function is called several
@@ -2429,7 +3435,10 @@ void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawabl
         // Project shadow caster bounding box to light view space for visibility check
         lightViewBox = drawable->GetWorldBoundingBox().Transformed(lightView);
 
-        if (IsShadowCasterVisible(drawable, lightViewBox, shadowCamera, lightView, lightViewFrustum, lightViewFrustumBox))
+        // With shadow caching, point and spot lights render all shadow casters so that the static shadow map does not
+        // depend on the view
+        if ((light->GetShadowCaching() && type != LIGHT_DIRECTIONAL) ||
+            IsShadowCasterVisible(drawable, lightViewBox, shadowCamera, lightView, lightViewFrustum, lightViewFrustumBox))
         {
             // Merge to shadow caster bounding box (only needed for focused spot lights) and add to the list
             if (type == LIGHT_SPOT && light->GetShadowFocus().focus_)
@@ -2437,11 +3446,9 @@ void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawabl
                 lightProjBox = lightViewBox.Projected(lightProj);
                 query.shadowCasterBox_[splitIndex].Merge(lightProjBox);
             }
-            query.shadowCasters_.Push(drawable);
+            query.splitShadowCasters_[splitIndex].Push(drawable);
         }
     }
-
-    query.shadowCasterEnd_[splitIndex] = query.shadowCasters_.Size();
 }
 
 bool View::IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, Camera* shadowCamera, const Matrix3x4& lightView,
@@ -2480,10 +3487,12 @@ bool View::IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, C
     }
 }
 
-IntRect View::GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shadowMap)
+IntRect View::GetShadowMapViewport(Light* light, int splitIndex, const IntRect& shadowMapRect)
 {
-    int width = shadowMap->GetWidth();
-    int height = shadowMap->GetHeight();
+    int x = shadowMapRect.left_;
+    int y = shadowMapRect.top_;
+    int width = shadowMapRect.Width();
+    int height = shadowMapRect.Height();
 
     switch (light->GetLightType())
     {
@@ -2491,20 +3500,20 @@ IntRect View::GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shad
         {
             int numSplits = light->GetNumShadowSplits();
             if (numSplits == 1)
-                return {0, 0, width, height};
+                return shadowMapRect;
             else if (numSplits == 2)
-                return {splitIndex * width / 2, 0, (splitIndex + 1) * width / 2, height};
+                return {x + splitIndex * width / 2, y, x + (splitIndex + 1) * width / 2, y + height};
             else
-                return {(splitIndex & 1) * width / 2, (splitIndex / 2) * height / 2,
-                    ((splitIndex & 1) + 1) * width / 2, (splitIndex / 2 + 1) * height / 2};
+                return {x + (splitIndex & 1) * width / 2, y + (splitIndex / 2) * height / 2,
+                    x + ((splitIndex & 1) + 1) * width / 2, y + (splitIndex / 2 + 1) * height / 2};
         }
 
     case LIGHT_SPOT:
-        return {0, 0, width, height};
+        return shadowMapRect;
 
     case LIGHT_POINT:
-        return {(splitIndex & 1) * width / 2, (splitIndex / 2) * height / 3,
-            ((splitIndex & 1) + 1) * width / 2, (splitIndex / 2 + 1) * height / 3};
+        return {x + (splitIndex & 1) * width / 2, y + (splitIndex / 2) * height / 3,
+            x + ((splitIndex & 1) + 1) * width / 2, y + (splitIndex / 2 + 1) * height / 3};
     }
 
     return {};
@@ -2769,10 +3778,99 @@ void View::QuantizeDirLightShadowCamera(Camera* shadowCamera, Light* light, cons
     }
 }
 
+static bool CompareZonePriority(Zone* lhs, Zone* rhs)
+{
+    // Order zones with the same priority by ID so that the choice between them stays the same between frames
+    if (lhs->GetPriority() != rhs->GetPriority())
+        return lhs->GetPriority() > rhs->GetPriority();
+    else
+        return lhs->GetID() < rhs->GetID();
+}
+
+void View::BuildZoneGrid()
+{
+    URHO3D_PROFILE(BuildZoneGrid);
+
+    // In priority order the first zone that contains a drawable is the one to use
+    Sort(zones_.Begin(), zones_.End(), CompareZonePriority);
+
+    zoneGridSize_ = IntVector3::ZERO;
+    if (zones_.Size() < ZONE_GRID_MIN_ZONES)
+        return;
+
+    // Drawables are only looked up near the view, so limit the grid to the view frustum
+    BoundingBox zonesBox;
+    for (PODVector<Zone*>::Iterator i = zones_.Begin(); i != zones_.End(); ++i)
+        zonesBox.Merge((*i)->GetWorldBoundingBox());
+    zoneGridBox_ = BoundingBox(cullCamera_->GetFrustum());
+    zoneGridBox_.Clip(zonesBox);
+    if (!zoneGridBox_.Defined() || zoneGridBox_.Size().x_ <= 0.0f || zoneGridBox_.Size().y_ <= 0.0f ||
+        zoneGridBox_.Size().z_ <= 0.0f)
+        return;
+
+    int size = Clamp((int)cbrtf((float)zones_.Size()) + 1, 2, ZONE_GRID_MAX_SIZE);
+    zoneGridSize_ = IntVector3(size, size, size);
+    zoneGridInvCellSize_ = Vector3((float)size, (float)size, (float)size) / zoneGridBox_.Size();
+
+    unsigned numCells = (unsigned)(size * size * size);
+    zoneGridCells_.Resize(numCells + 1);
+    for (unsigned i = 0; i <= numCells; ++i)
+        zoneGridCells_[i] = 0;
+
+    // Count the zones of each cell first, then fill the cells going through the zones in priority order
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        for (PODVector<Zone*>::Iterator i = zones_.Begin(); i != zones_.End(); ++i)
+        {
+            const BoundingBox& box = (*i)->GetWorldBoundingBox();
+            if (zoneGridBox_.IsInside(box) == OUTSIDE)
+                continue;
+
+            Vector3 minCell = (box.min_ - zoneGridBox_.min_) * zoneGridInvCellSize_;
+            Vector3 maxCell = (box.max_ - zoneGridBox_.min_) * zoneGridInvCellSize_;
+            int minX = Clamp((int)minCell.x_, 0, size - 1);
+            int minY = Clamp((int)minCell.y_, 0, size - 1);
+            int minZ = Clamp((int)minCell.z_, 0, size - 1);
+            int maxX = Clamp((int)maxCell.x_, 0, size - 1);
+            int maxY = Clamp((int)maxCell.y_, 0, size - 1);
+            int maxZ = Clamp((int)maxCell.z_, 0, size - 1);
+
+            for (int z = minZ; z <= maxZ; ++z)
+            {
+                for (int y = minY; y <= maxY; ++y)
+                {
+                    for (int x = minX; x <= maxX; ++x)
+                    {
+                        unsigned cell = (unsigned)((z * size + y) * size + x);
+                        if (!pass)
+                            ++zoneGridCells_[cell + 1];
+                        else
+                            zoneGridZones_[zoneGridCells_[cell]++] = *i;
+                    }
+                }
+            }
+        }
+
+        if (!pass)
+        {
+            // Turn the counts into start indices
+            for (unsigned i = 1; i <= numCells; ++i)
+                zoneGridCells_[i] += zoneGridCells_[i - 1];
+            zoneGridZones_.Resize(zoneGridCells_[numCells]);
+        }
+        else
+        {
+            // Filling advanced each start index to the next cell's start, so shift them back
+            for (unsigned i = numCells; i > 0; --i)
+                zoneGridCells_[i] = zoneGridCells_[i - 1];
+            zoneGridCells_[0] = 0;
+        }
+    }
+}
+
 void View::FindZone(Drawable* drawable)
 {
     Vector3 center = drawable->GetWorldBoundingBox().Center();
-    int bestPriority = M_MIN_INT;
     Zone* newZone = nullptr;
 
     // If bounding box center is in view, the zone assignment is conclusive also for next frames. Otherwise it is temporary
@@ -2787,14 +3885,29 @@ void View::FindZone(Drawable* drawable)
         newZone = lastZone;
     else
     {
-        for (PODVector<Zone*>::Iterator i = zones_.Begin(); i != zones_.End(); ++i)
+        // Check only the zones overlapping the grid cell if the grid is in use. Points outside the grid may be in zones
+        // outside the view frustum, so check all zones for them
+        Zone** zones = zones_.Buffer();
+        Zone** zonesEnd = zones + zones_.Size();
+        if (zoneGridSize_.x_ && zoneGridBox_.IsInside(center) != OUTSIDE)
+        {
+            Vector3 cellPos = (center - zoneGridBox_.min_) * zoneGridInvCellSize_;
+            int x = Min((int)cellPos.x_, zoneGridSize_.x_ - 1);
+            int y = Min((int)cellPos.y_, zoneGridSize_.y_ - 1);
+            int z = Min((int)cellPos.z_, zoneGridSize_.z_ - 1);
+            unsigned cell = (unsigned)((z * zoneGridSize_.y_ + y) * zoneGridSize_.x_ + x);
+            zones = zoneGridZones_.Buffer() + zoneGridCells_[cell];
+            zonesEnd = zoneGridZones_.Buffer() + zoneGridCells_[cell + 1];
+        }
+
+        // The zones are in priority order, so the first one containing the drawable is the best
+        for (Zone** i = zones; i != zonesEnd; ++i)
         {
             Zone* zone = *i;
-            int priority = zone->GetPriority();
-            if (priority > bestPriority && (drawable->GetZoneMask() & zone->GetZoneMask()) && zone->IsInside(center))
+            if ((drawable->GetZoneMask() & zone->GetZoneMask()) && zone->IsInside(center))
             {
                 newZone = zone;
-                bestPriority = priority;
+                break;
             }
         }
     }
@@ -2836,7 +3949,7 @@ Technique* View::GetTechnique(Drawable* drawable, Material* material)
     }
 }
 
-void View::CheckMaterialForAuxView(Material* material)
+void View::CheckMaterialForAuxView(Material* material, float distance)
 {
     const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material->GetTextures();
 
@@ -2850,8 +3963,8 @@ void View::CheckMaterialForAuxView(Material* material)
             {
                 auto* tex2D = static_cast<Texture2D*>(texture);
                 RenderSurface* target = tex2D->GetRenderSurface();
-                if (target && target->GetUpdateMode() == SURFACE_UPDATEVISIBLE)
-                    target->QueueUpdate();
+                if (target && target->GetUpdateMode() != SURFACE_MANUALUPDATE)
+                    target->QueueVisibleUpdate(distance);
             }
             else if (texture->GetType() == TextureCube::GetTypeStatic())
             {
@@ -2859,15 +3972,25 @@ void View::CheckMaterialForAuxView(Material* material)
                 for (unsigned j = 0; j < MAX_CUBEMAP_FACES; ++j)
                 {
                     RenderSurface* target = texCube->GetRenderSurface((CubeMapFace)j);
-                    if (target && target->GetUpdateMode() == SURFACE_UPDATEVISIBLE)
-                        target->QueueUpdate();
+                    if (target && target->GetUpdateMode() != SURFACE_MANUALUPDATE)
+                        target->QueueVisibleUpdate(distance);
                 }
             }
         }
     }
 
-    // Flag as processed so we can early-out next time we come across this material on the same frame
-    material->MarkForAuxView(frame_.frameNumber_);
+    // Flag as processed so we can early-out next time we come across this material on the same frame, unless nearer
+    material->MarkForAuxView(frame_.frameNumber_, distance);
+}
+
+float View::GetPixelSize(Drawable* drawable) const
+{
+    float size = drawable->GetWorldBoundingBox().Size().Length();
+    float halfViewSize = cullCamera_->GetHalfViewSize();
+    if (!cullCamera_->IsOrthographic())
+        halfViewSize *= Max(drawable->GetDistance(), M_EPSILON);
+
+    return size * 0.5f * (float)viewSize_.y_ / Max(halfViewSize, M_EPSILON);
 }
 
 void View::SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command)
@@ -2891,6 +4014,51 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     if (!batch.material_)
         batch.material_ = renderer_->GetDefaultMaterial();
 
+    // Batches with a persistent instancing buffer are drawn as is, without grouping into the shared instancing buffer
+    if (batch.instancingBuffer_)
+    {
+        if (allowInstancing && renderer_->GetDynamicInstancing() && batch.geometryType_ == GEOM_STATIC &&
+            batch.geometry_->GetIndexBuffer())
+        {
+            batch.geometryType_ = GEOM_INSTANCED;
+            renderer_->SetBatchShaders(batch, tech, allowShadows, queue);
+            batch.CalculateSortKey();
+            queue.batches_.Push(batch);
+            return;
+        }
+        else
+            batch.instancingBuffer_ = nullptr;
+    }
+
+    // Substitute the shared texture array material, so that instances of different materials can be grouped. The extra instancing
+    // data selects each material's layer, so the group must always use instancing shaders
+    bool useArrayMaterial = false;
+    int numExtraElements = renderer_->GetNumExtraInstancingBufferElements();
+    if (allowInstancing && batch.material_->GetArrayMaterial() && numExtraElements > 0 && !batch.instancingData_ &&
+        batch.geometryType_ == GEOM_STATIC && batch.geometry_->GetIndexBuffer() && renderer_->GetDynamicInstancing() &&
+        graphics_->GetInstancingSupport() && batch.material_->GetArrayInstanceData().Size() >= (unsigned)numExtraElements)
+    {
+        Material* arrayMaterial = batch.material_->GetArrayMaterial();
+        const Vector<TechniqueEntry>& techniques = batch.material_->GetTechniques();
+        for (unsigned i = 0; i < techniques.Size(); ++i)
+        {
+            if (techniques[i].technique_ != tech)
+                continue;
+
+            Technique* arrayTech = arrayMaterial->GetTechnique(i);
+            Pass* arrayPass = arrayTech ? arrayTech->GetSupportedPass(batch.pass_->GetIndex()) : nullptr;
+            if (arrayPass)
+            {
+                batch.instancingData_ = const_cast<Vector4*>(batch.material_->GetArrayInstanceData().Buffer());
+                batch.material_ = arrayMaterial;
+                batch.pass_ = arrayPass;
+                tech = arrayTech;
+                useArrayMaterial = true;
+            }
+            break;
+        }
+    }
+
     // Convert to instanced if possible
     if (allowInstancing && batch.geometryType_ == GEOM_STATIC && batch.geometry_->GetIndexBuffer())
         batch.geometryType_ = GEOM_INSTANCED;
@@ -2904,8 +4072,10 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
         {
             // Create a new group based on the batch
             // In case the group remains below the instancing limit, do not enable instancing shaders yet
+            // The instance lists are rebuilt each frame, so allocate them from the frame arena
             BatchGroup newGroup(batch);
-            newGroup.geometryType_ = GEOM_STATIC;
+            newGroup.instances_.SetArena(frameArena_, 0);
+            newGroup.geometryType_ = useArrayMaterial ? GEOM_INSTANCED : GEOM_STATIC;
             renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
             newGroup.CalculateSortKey();
             i = queue.batchGroups_.Insert(MakePair(key, newGroup));
@@ -2914,7 +4084,7 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
         int oldSize = i->second_.instances_.Size();
         i->second_.AddTransforms(batch);
         // Convert to using instancing shaders when the instancing limit is reached
-        if (oldSize < minInstances_ && (int)i->second_.instances_.Size() >= minInstances_)
+        if (!useArrayMaterial && oldSize < minInstances_ && (int)i->second_.instances_.Size() >= minInstances_)
         {
             i->second_.geometryType_ = GEOM_INSTANCED;
             renderer_->SetBatchShaders(i->second_, tech, allowShadows, queue);
@@ -2963,20 +4133,20 @@ void View::PrepareInstancingBuffer()
     for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
+        {
             totalInstances += i->shadowSplits_[j].shadowBatches_.GetNumInstances();
+            totalInstances += i->shadowSplits_[j].staticShadowBatches_.GetNumInstances();
+        }
         totalInstances += i->litBaseBatches_.GetNumInstances();
         totalInstances += i->litBatches_.GetNumInstances();
     }
 
-    if (!totalInstances || !renderer_->ResizeInstancingBuffer(totalInstances))
-        return;
-
-    VertexBuffer* instancingBuffer = renderer_->GetInstancingBuffer();
     unsigned freeIndex = 0;
-    void* dest = instancingBuffer->Lock(0, totalInstances, true);
+    void* dest = renderer_->LockInstancingBuffer(totalInstances, freeIndex);
     if (!dest)
         return;
 
+    VertexBuffer* instancingBuffer = renderer_->GetInstancingBuffer();
     const unsigned stride = instancingBuffer->GetVertexSize();
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
         i->second_.SetInstancingData(dest, stride, freeIndex);
@@ -2984,7 +4154,10 @@ void View::PrepareInstancingBuffer()
     for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
+        {
             i->shadowSplits_[j].shadowBatches_.SetInstancingData(dest, stride, freeIndex);
+            i->shadowSplits_[j].staticShadowBatches_.SetInstancingData(dest, stride, freeIndex);
+        }
         i->litBaseBatches_.SetInstancingData(dest, stride, freeIndex);
         i->litBatches_.SetInstancingData(dest, stride, freeIndex);
     }
@@ -3062,6 +4235,16 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
     // Set shadow depth bias
     BiasParameters parameters = queue.light_->GetShadowBias();
 
+    // With shadow caching, the shadow map needs to be rendered only if there are dynamic shadow casters or the static
+    // shadow map has changed
+    graphics_->BeginGPUBlock("ShadowMap");
+    ShadowMapCache* cache = queue.shadowMapCache_;
+    if (cache && !UpdateStaticShadowMap(queue, parameters))
+    {
+        graphics_->EndGPUBlock();
+        return;
+    }
+
     // The shadow map is a depth stencil texture
     if (shadowMap->GetUsage() == TEXTURE_DEPTHSTENCIL)
     {
@@ -3071,8 +4254,27 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
         // Disable other render targets
         for (unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
             graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
-        graphics_->SetViewport(IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
-        graphics_->Clear(CLEAR_DEPTH);
+        // With the shadow atlas, restrict the clear to the light's tile
+        graphics_->SetViewport(queue.shadowMapRect_);
+
+        // Start from the static shadow casters' depth, so that only the dynamic shadow casters need to be rendered. The
+        // static shadow caster list always holds a separator for each split
+        if (cache && queue.staticShadowCasters_.Size() > queue.shadowSplits_.Size())
+        {
+            graphics_->SetBlendMode(BLEND_REPLACE);
+            graphics_->SetDepthTest(CMP_ALWAYS);
+            graphics_->SetDepthWrite(true);
+            graphics_->SetDepthBias(0.0f, 0.0f);
+            graphics_->SetScissorTest(false);
+
+            static const char* shaderName = "CopyDepth";
+            graphics_->SetShaders(graphics_->GetShader(VS, shaderName), graphics_->GetShader(PS, shaderName));
+            graphics_->SetTexture(TU_DIFFUSE, cache->staticShadowMap_);
+            DrawFullscreenQuad(true);
+            graphics_->SetTexture(TU_DIFFUSE, nullptr);
+        }
+        else
+            graphics_->Clear(CLEAR_DEPTH);
     }
     else // if the shadow map is a color rendertarget
     {
@@ -3083,16 +4285,32 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
             graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
         graphics_->SetDepthStencil(renderer_->GetDepthStencil(shadowMap->GetWidth(), shadowMap->GetHeight(),
             shadowMap->GetMultiSample(), shadowMap->GetAutoResolve()));
-        graphics_->SetViewport(IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
+        graphics_->SetViewport(queue.shadowMapRect_);
         graphics_->Clear(CLEAR_DEPTH | CLEAR_COLOR, Color::WHITE);
 
         parameters = BiasParameters(0.0f, 0.0f);
     }
 
-    // Render each of the splits
+    RenderShadowSplits(queue, parameters, false);
+
+    // Scale filter blur amount to shadow map viewport size so that different shadow map resolutions don't behave differently
+    // The filter works on the whole texture, so it is not applied to shadow atlas tiles
+    float blurScale = queue.shadowSplits_[0].shadowViewport_.Width() / 1024.0f;
+    if (!queue.shadowAtlas_)
+        renderer_->ApplyShadowMapFilter(this, shadowMap, blurScale);
+
+    // reset some parameters
+    graphics_->SetColorWrite(true);
+    graphics_->SetDepthBias(0.0f, 0.0f);
+    graphics_->EndGPUBlock();
+}
+
+void View::RenderShadowSplits(const LightBatchQueue& queue, const BiasParameters& parameters, bool staticCasters)
+{
     for (unsigned i = 0; i < queue.shadowSplits_.Size(); ++i)
     {
         const ShadowBatchQueue& shadowQueue = queue.shadowSplits_[i];
+        const BatchQueue& shadowBatches = staticCasters ? shadowQueue.staticShadowBatches_ : shadowQueue.shadowBatches_;
 
         float multiplier = 1.0f;
         // For directional light cascade splits, adjust depth bias according to the far clip ratio of the splits
@@ -3114,20 +4332,74 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
 
         graphics_->SetDepthBias(multiplier * parameters.constantBias_ + addition, multiplier * parameters.slopeScaledBias_);
 
-        if (!shadowQueue.shadowBatches_.IsEmpty())
+        if (!shadowBatches.IsEmpty())
         {
             graphics_->SetViewport(shadowQueue.shadowViewport_);
-            shadowQueue.shadowBatches_.Draw(this, shadowQueue.shadowCamera_, false, false, true);
+            shadowBatches.Draw(this, shadowQueue.shadowCamera_, false, false, true);
         }
     }
+}
 
-    // Scale filter blur amount to shadow map viewport size so that different shadow map resolutions don't behave differently
-    float blurScale = queue.shadowSplits_[0].shadowViewport_.Width() / 1024.0f;
-    renderer_->ApplyShadowMapFilter(this, shadowMap, blurScale);
+bool View::UpdateStaticShadowMap(const LightBatchQueue& queue, const BiasParameters& parameters)
+{
+    ShadowMapCache* cache = queue.shadowMapCache_;
+    Vector2 depthBias(parameters.constantBias_, parameters.slopeScaledBias_);
+
+    // The static shadow map is valid as long as the same static shadow casters are rendered with the same shadow
+    // cameras. Compare against the cache at render time, as other views may have used it in between
+    bool staticValid = cache->staticValid_ && cache->depthBias_ == depthBias &&
+        cache->staticCasters_ == queue.staticShadowCasters_ && cache->shadowCameras_.Size() == queue.shadowSplits_.Size();
+    for (unsigned i = 0; i < queue.shadowSplits_.Size() && staticValid; ++i)
+    {
+        Camera* shadowCamera = queue.shadowSplits_[i].shadowCamera_;
+        if (cache->shadowCameras_[i] != shadowCamera->GetProjection() * shadowCamera->GetView())
+            staticValid = false;
+    }
 
-    // reset some parameters
-    graphics_->SetColorWrite(true);
-    graphics_->SetDepthBias(0.0f, 0.0f);
+    if (!staticValid)
+    {
+        URHO3D_PROFILE(RenderStaticShadowMap);
+
+        cache->staticCasters_ = queue.staticShadowCasters_;
+        cache->shadowCameras_.Resize(queue.shadowSplits_.Size());
+        for (unsigned i = 0; i < queue.shadowSplits_.Size(); ++i)
+        {
+            Camera* shadowCamera = queue.shadowSplits_[i].shadowCamera_;
+            cache->shadowCameras_[i] = shadowCamera->GetProjection() * shadowCamera->GetView();
+        }
+        cache->depthBias_ = depthBias;
+        cache->staticValid_ = true;
+        cache->valid_ = false;
+
+        Texture2D* staticShadowMap = cache->staticShadowMap_;
+        graphics_->SetColorWrite(false);
+        graphics_->SetDepthStencil(staticShadowMap);
+        graphics_->SetRenderTarget(0, staticShadowMap->GetRenderSurface()->GetLinkedRenderTarget());
+        for (unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
+            graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
+        graphics_->SetViewport(IntRect(0, 0, staticShadowMap->GetWidth(), staticShadowMap->GetHeight()));
+        graphics_->Clear(CLEAR_DEPTH);
+
+        RenderShadowSplits(queue, parameters, true);
+    }
+
+    // Without dynamic shadow casters, the shadow map rendered the last time is still valid
+    bool hasDynamicCasters = false;
+    for (unsigned i = 0; i < queue.shadowSplits_.Size(); ++i)
+    {
+        if (!queue.shadowSplits_[i].shadowBatches_.IsEmpty())
+            hasDynamicCasters = true;
+    }
+
+    if (cache->valid_ && !hasDynamicCasters)
+    {
+        graphics_->SetColorWrite(true);
+        graphics_->SetDepthBias(0.0f, 0.0f);
+        return false;
+    }
+
+    cache->valid_ = !hasDynamicCasters;
+    return true;
 }
 
 RenderSurface* View::GetDepthStencil(RenderSurface* renderTarget)
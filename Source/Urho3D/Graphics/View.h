@@ -29,10 +29,12 @@
 #include "../Graphics/Light.h"
 #include "../Graphics/Zone.h"
 #include "../Math/Polyhedron.h"
+#include "../Math/Sphere.h"
 
 namespace Urho3D
 {
 
+class AnimatedModel;
 class Camera;
 class DebugRenderer;
 class Light;
@@ -48,7 +50,9 @@ class Texture;
 class Texture2D;
 class Viewport;
 class Zone;
+struct OcclusionDepthData;
 struct RenderPathCommand;
+struct RenderTargetLifetime;
 struct WorkItem;
 
 /// Intermediate light processing result.
@@ -60,6 +64,10 @@ struct LightQueryResult
     PODVector<Drawable*> litGeometries_;
     /// Shadow casters.
     PODVector<Drawable*> shadowCasters_;
+    /// Shadow casters of each split before they are merged to the shadow casters.
+    PODVector<Drawable*> splitShadowCasters_[MAX_LIGHT_SPLITS];
+    /// Drawables in the light volume from the light's query cache. Only used for point and spot lights.
+    const PODVector<Drawable*>* lightDrawables_;
     /// Shadow cameras.
     Camera* shadowCameras_[MAX_LIGHT_SPLITS];
     /// Shadow caster start indices.
@@ -74,6 +82,8 @@ struct LightQueryResult
     float shadowFarSplits_[MAX_LIGHT_SPLITS];
     /// Shadow map split count.
     unsigned numSplits_;
+    /// Whether the light is applied through the light grid in clustered forward lighting.
+    bool clustered_;
 };
 
 /// Scene render pass info.
@@ -111,6 +121,8 @@ class URHO3D_API View : public Object
 {
     friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
     friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void ProcessShadowSplitWork(const WorkItem* item, unsigned threadIndex);
+    friend void BuildLightClusterSliceWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -118,7 +130,7 @@ public:
     /// Construct.
     explicit View(Context* context);
     /// Destruct.
-    ~View() override = default;
+    ~View() override;
 
     /// Define with rendertarget and viewport. Return true if successful.
     bool Define(RenderSurface* renderTarget, Viewport* viewport);
@@ -126,6 +138,8 @@ public:
     void Update(const FrameInfo& frame);
     /// Render batches.
     void Render();
+    /// Update geometries and copy the world transforms of the batches into the frame arena, so that rendering does not depend on scene nodes being unchanged.
+    void SnapshotTransforms();
 
     /// Return graphics subsystem.
     Graphics* GetGraphics() const;
@@ -156,9 +170,12 @@ public:
     /// Return view rectangle.
     const IntRect& GetViewRect() const { return viewRect_; }
 
-    /// Return view dimensions.
+    /// Return view dimensions. Smaller than the view rectangle when rendering at a reduced dynamic resolution.
     const IntVector2& GetViewSize() const { return viewSize_; }
 
+    /// Return GPU memory of the screen buffers allocated for rendering the view in bytes, including the substitute rendertarget, viewport textures and render path rendertargets, but not the depth-stencil buffers. Screen buffers shared by transient rendertargets are counted once.
+    unsigned long long GetRenderTargetMemory() const { return renderTargetMemory_; }
+
     /// Return geometry objects.
     const PODVector<Drawable*>& GetGeometries() const { return geometries_; }
 
@@ -171,6 +188,12 @@ public:
     /// Return light batch queues.
     const Vector<LightBatchQueue>& GetLightQueues() const { return lightQueues_; }
 
+    /// Return lights applied through the light grid in clustered forward lighting.
+    const PODVector<Light*>& GetClusterLights() const { return clusterLights_; }
+
+    /// Return the light grid texture for clustered forward lighting, or null if not in use.
+    Texture2D* GetClusterTexture() const;
+
     /// Return the last used software occlusion buffer.
     OcclusionBuffer* GetOcclusionBuffer() const { return occlusionBuffer_; }
 
@@ -182,6 +205,8 @@ public:
 
     /// Set global (per-frame) shader parameters. Called by Batch and internally by View.
     void SetGlobalShaderParameters();
+    /// Return the source of the global (per-frame) shader parameters. Views of the same scene share it during a frame, unless the parameters are customized per view.
+    const void* GetGlobalShaderParameterSource() const { return globalParameterSource_; }
     /// Set camera-specific shader parameters. Called by Batch and internally by View.
     void SetCameraShaderParameters(Camera* camera);
     /// Set command's shader parameters if any. Called internally by View.
@@ -210,6 +235,14 @@ private:
     void UpdateGeometries();
     /// Get pixel lit batches for a certain light and drawable.
     void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
+    /// Return whether a light can be applied through the light grid in clustered forward lighting.
+    bool IsClusteredLight(const LightQueryResult& query) const;
+    /// Fill the clustered light data and begin building the light grid in worker threads.
+    void GetLightClusters();
+    /// Gather the light lists of a light grid depth slice. Called from worker threads.
+    void BuildLightClusterSlice(unsigned slice);
+    /// Wait for the light grid to finish and upload it to the light grid texture.
+    void FinishLightClusters();
     /// Execute render commands.
     void ExecuteRenderPathCommands();
     /// Set rendertargets for current render command.
@@ -218,6 +251,8 @@ private:
     bool SetTextures(RenderPathCommand& command);
     /// Perform a quad rendering command.
     void RenderQuad(RenderPathCommand& command);
+    /// Perform a tiled deferred light accumulation command.
+    void RenderTiledLights(RenderPathCommand& command);
     /// Check if a command is enabled and has content to render. To be called only after render update has completed for the frame.
     bool IsNecessary(const RenderPathCommand& command);
     /// Check if a command reads the destination render target.
@@ -228,14 +263,20 @@ private:
     bool CheckPingpong(unsigned index);
     /// Allocate needed screen buffers.
     void AllocateScreenBuffers();
+    /// Allocate the transient render path rendertargets, sharing screen buffers between rendertargets whose lifetimes in the commands do not overlap.
+    void AllocateTransientRenderTargets(PODVector<RenderTargetLifetime>& lifetimes);
     /// Blit the viewport from one surface to another.
     void BlitFramebuffer(Texture* source, RenderSurface* destination, bool depthWrite);
     /// Query for occluders as seen from a camera.
     void UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera);
-    /// Draw occluders to occlusion buffer.
-    void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders);
-    /// Query for lit geometries and shadow casters for a light.
+    /// Draw occluders to occlusion buffer, optionally on top of reprojected depth from an earlier frame.
+    void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders, const OcclusionDepthData* reprojection = nullptr);
+    /// Downsample the scene depth for occlusion reprojection in later frames, and read back the depth rendered earlier.
+    void CaptureOcclusionDepth();
+    /// Query for lit geometries for a light and set up its shadow cameras.
     void ProcessLight(LightQueryResult& query, unsigned threadIndex);
+    /// Query for shadow casters of one shadow split of a light.
+    void ProcessShadowSplit(LightQueryResult& query, unsigned splitIndex, unsigned threadIndex);
     /// Process shadow casters' visibilities and build their combined view- or projection-space bounding box.
     void ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex);
     /// Set up initial shadow camera view(s).
@@ -252,13 +293,17 @@ private:
     bool IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, Camera* shadowCamera, const Matrix3x4& lightView,
         const Frustum& lightViewFrustum, const BoundingBox& lightViewFrustumBox);
     /// Return the viewport for a shadow map split.
-    IntRect GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shadowMap);
+    IntRect GetShadowMapViewport(Light* light, int splitIndex, const IntRect& shadowMapRect);
+    /// Sort the visible zones by priority and build the zone lookup grid for them.
+    void BuildZoneGrid();
     /// Find and set a new zone for a drawable when it has moved.
     void FindZone(Drawable* drawable);
     /// Return material technique, considering the drawable's LOD distance.
     Technique* GetTechnique(Drawable* drawable, Material* material);
-    /// Check if material should render an auxiliary view (if it has a camera attached.)
-    void CheckMaterialForAuxView(Material* material);
+    /// Check if material should render an auxiliary view (if it has a camera attached), recording the distance of the drawable using it.
+    void CheckMaterialForAuxView(Material* material, float distance);
+    /// Return the on-screen size of a drawable in pixels. Used for texture streaming.
+    float GetPixelSize(Drawable* drawable) const;
     /// Set shader defines for a batch queue if used.
     void SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command);
     /// Choose shaders for a batch and add it to queue.
@@ -271,6 +316,10 @@ private:
     bool NeedRenderShadowMap(const LightBatchQueue& queue);
     /// Render a shadow map.
     void RenderShadowMap(const LightBatchQueue& queue);
+    /// Render the shadow casters of each shadow map split, either the static casters for the cached static shadow map or the others.
+    void RenderShadowSplits(const LightBatchQueue& queue, const BiasParameters& parameters, bool staticCasters);
+    /// Render the static shadow map of a cached shadow map if the static shadow casters or the shadow cameras have changed. Return whether the shadow map itself needs to be rendered.
+    bool UpdateStaticShadowMap(const LightBatchQueue& queue, const BiasParameters& parameters);
     /// Return the proper depth-stencil surface to use for a rendertarget.
     RenderSurface* GetDepthStencil(RenderSurface* renderTarget);
     /// Helper function to get the render surface from a texture. 2D textures will always return the first face only.
@@ -312,8 +361,12 @@ private:
     WeakPtr<Graphics> graphics_;
     /// Renderer subsystem.
     WeakPtr<Renderer> renderer_;
+    /// Frame arena subsystem for transient per-frame data.
+    WeakPtr<FrameArena> frameArena_;
     /// Scene to use.
     Scene* scene_{};
+    /// Source of the global shader parameters.
+    const void* globalParameterSource_{};
     /// Octree to use.
     Octree* octree_{};
     /// Viewport (rendering) camera.
@@ -366,6 +419,8 @@ private:
     int highestZonePriority_{};
     /// Geometries updated flag.
     bool geometriesUpdated_{};
+    /// Transforms snapshotted for pipelined rendering flag.
+    bool transformsSnapshotted_{};
     /// Camera zone's override flag.
     bool cameraZoneOverride_{};
     /// Draw shadows flag.
@@ -382,20 +437,40 @@ private:
     bool noStencil_{};
     /// Draw debug geometry flag. Copied from the viewport.
     bool drawDebug_{};
+    /// Clustered forward lighting flag.
+    bool clustered_{};
+    /// Whether the light grid texture was last uploaded without any lights.
+    bool clusterTextureEmpty_{};
     /// Renderpath.
     RenderPath* renderPath_{};
     /// Per-thread octree query results.
     Vector<PODVector<Drawable*> > tempDrawables_;
+    /// Drawables from octants intersecting the frustum, which still need a frustum test in the worker threads.
+    PODVector<Drawable*> intersectingDrawables_;
+    /// First drawable in the visibility check range that needs a frustum test.
+    Drawable** firstIntersectingDrawable_{};
     /// Per-thread geometries, lights and Z range collection results.
     Vector<PerThreadSceneResult> sceneResults_;
-    /// Visible zones.
+    /// Visible zones, sorted by priority once the camera and far clip zones have been found.
     PODVector<Zone*> zones_;
+    /// Zone lookup grid bounds.
+    BoundingBox zoneGridBox_;
+    /// Zone lookup grid cell count per axis. Zero when the grid is not in use.
+    IntVector3 zoneGridSize_;
+    /// Zone lookup grid inverse cell size.
+    Vector3 zoneGridInvCellSize_;
+    /// Start index of the zone lookup grid cells' zones, followed by the end index.
+    PODVector<unsigned> zoneGridCells_;
+    /// Zones overlapping each zone lookup grid cell, in priority order.
+    PODVector<Zone*> zoneGridZones_;
     /// Visible geometry objects.
     PODVector<Drawable*> geometries_;
     /// Geometry objects that will be updated in the main thread.
     PODVector<Drawable*> nonThreadedGeometries_;
     /// Geometry objects that will be updated in worker threads.
     PODVector<Drawable*> threadedGeometries_;
+    /// Animated models that came into view and have a late animation update pending.
+    PODVector<AnimatedModel*> lateAnimatedModels_;
     /// Occluder objects.
     PODVector<Drawable*> occluders_;
     /// Lights.
@@ -403,10 +478,30 @@ private:
     /// Number of active occluders.
     unsigned activeOccluders_{};
 
+    /// Lights applied through the light grid in clustered forward lighting.
+    PODVector<Light*> clusterLights_;
+    /// View space bounding spheres of the clustered lights.
+    PODVector<Sphere> clusterLightSpheres_;
+    /// Light grid tile corners on the near plane in view space.
+    PODVector<Vector3> clusterNearCorners_;
+    /// Light grid tile corners on the far plane in view space.
+    PODVector<Vector3> clusterFarCorners_;
+    /// Light indices of each light grid depth slice, gathered in worker threads.
+    Vector<PODVector<float> > clusterSliceIndices_;
+    /// Light data, cluster headers and light indices to upload to the light grid texture.
+    PODVector<Vector4> clusterData_;
+    /// Light grid texture.
+    SharedPtr<Texture2D> clusterTexture_;
+    /// Transform from world space to the light grid tiles and view depth, used by the shaders.
+    Matrix4 clusterMatrix_;
+    /// Light grid depth slice scale, bias and logarithmic flag, used by the shaders.
+    Vector4 clusterParams_;
     /// Drawables that limit their maximum light count.
     HashSet<Drawable*> maxLightsDrawables_;
     /// Rendertargets defined by the renderpath.
     HashMap<StringHash, Texture*> renderTargets_;
+    /// GPU memory of the allocated screen buffers.
+    unsigned long long renderTargetMemory_{};
     /// Intermediate light processing results.
     Vector<LightQueryResult> lightQueryResults_;
     /// Info for scene render passes defined by the renderpath.
@@ -433,10 +528,14 @@ private:
     const RenderPathCommand* lightVolumeCommand_{};
     /// Pointer to the forwardlights command if any.
     const RenderPathCommand* forwardLightsCommand_{};
+    /// Pointer to the tiledlights command if any.
+    const RenderPathCommand* tiledLightsCommand_{};
     /// Pointer to the current commmand if it contains shader parameters to be set for a render pass.
     const RenderPathCommand* passCommand_{};
     /// Flag for scene being resolved from the backbuffer.
     bool usedResolve_{};
+    /// Flag for rendering at a dynamic resolution below the view rectangle size, and upscaling to the backbuffer at the end.
+    bool resolutionScaled_{};
 };
 
 }
@@ -28,10 +28,12 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
+#include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
 #include <ik/effector.h>
@@ -44,10 +46,23 @@ namespace Urho3D
 
 extern const char* IK_CATEGORY;
 
+/// Automatically solved solvers of each scene, in the order they were registered. Only accessed from the main thread.
+static HashMap<Scene*, PODVector<IKSolver*> > autoSolvers;
+
+void SolveIKWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto** start = reinterpret_cast<IKSolver**>(item->start_);
+    auto** end = reinterpret_cast<IKSolver**>(item->end_);
+
+    while (start != end)
+        (*start++)->SolvePose();
+}
+
 // ----------------------------------------------------------------------------
 IKSolver::IKSolver(Context* context) :
     Component(context),
     solver_(nullptr),
+    autoSolveScene_(nullptr),
     algorithm_(FABRIK),
     features_(AUTO_SOLVE | JOINT_ROTATIONS | UPDATE_ACTIVE_POSE),
     chainTreesNeedUpdating_(false),
@@ -72,6 +87,7 @@ IKSolver::~IKSolver()
     for (PODVector<IKEffector*>::ConstIterator it = effectorList_.Begin(); it != effectorList_.End(); ++it)
         (*it)->SetIKEffectorNode(nullptr);
 
+    UpdateAutoSolve(nullptr);
     ik_solver_destroy(solver_);
     context_->ReleaseIK();
 }
@@ -175,10 +191,8 @@ void IKSolver::SetFeature(Feature feature, bool enable)
             if (((features_ & AUTO_SOLVE) != 0) == enable)
                 break;
 
-            if (enable)
-                SubscribeToEvent(GetScene(), E_SCENEDRAWABLEUPDATEFINISHED, URHO3D_HANDLER(IKSolver, HandleSceneDrawableUpdateFinished));
-            else
-                UnsubscribeFromEvent(GetScene(), E_SCENEDRAWABLEUPDATEFINISHED);
+            features_ ^= AUTO_SOLVE;
+            UpdateAutoSolve(GetScene());
         } break;
 
         default: break;
@@ -400,6 +414,19 @@ void IKSolver::Solve()
 {
     URHO3D_PROFILE(IKSolve);
 
+    if (PrepareSolve() == false)
+        return;
+
+    SolvePose();
+    ApplySolvedPose();
+}
+
+// ----------------------------------------------------------------------------
+static void ApplySceneToActivePoseCallback(ik_node_t* ikNode);
+static void ApplyActivePoseToSceneCallback(ik_node_t* ikNode);
+
+bool IKSolver::PrepareSolve()
+{
     if (treeNeedsRebuild)
         RebuildTree();
 
@@ -407,13 +434,16 @@ void IKSolver::Solve()
         RebuildChainTrees();
 
     if (IsSolverTreeValid() == false)
-        return;
+        return false;
 
     if (features_ & UPDATE_ORIGINAL_POSE)
         ApplySceneToOriginalPose();
 
+    /* Only the nodes that are part of a chain are moved by the solver. When
+     * the active pose follows the scene graph, the remaining nodes of the tree
+     * already match it, so there is no need to copy them back and forth. */
     if (features_ & UPDATE_ACTIVE_POSE)
-        ApplySceneToActivePose();
+        ik_solver_iterate_chain_tree(solver_, ApplySceneToActivePoseCallback);
 
     if (features_ & USE_ORIGINAL_POSE)
         ApplyOriginalPoseToActivePose();
@@ -423,12 +453,123 @@ void IKSolver::Solve()
         (*it)->UpdateTargetNodePosition();
     }
 
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+void IKSolver::SolvePose()
+{
     ik_solver_solve(solver_);
 
     if (features_ & JOINT_ROTATIONS)
         ik_solver_calculate_joint_rotations(solver_);
+}
+
+// ----------------------------------------------------------------------------
+void IKSolver::ApplySolvedPose()
+{
+    if (features_ & UPDATE_ACTIVE_POSE)
+        ik_solver_iterate_chain_tree(solver_, ApplyActivePoseToSceneCallback);
+    else
+        ApplyActivePoseToScene();
+}
+
+// ----------------------------------------------------------------------------
+void IKSolver::UpdateAutoSolve(Scene* scene)
+{
+    if ((features_ & AUTO_SOLVE) == 0 || node_ == nullptr)
+        scene = nullptr;
+
+    if (scene == autoSolveScene_)
+        return;
+
+    if (autoSolveScene_ != nullptr)
+    {
+        UnsubscribeFromEvent(autoSolveScene_, E_SCENEDRAWABLEUPDATEFINISHED);
+
+        HashMap<Scene*, PODVector<IKSolver*> >::Iterator it = autoSolvers.Find(autoSolveScene_);
+        if (it != autoSolvers.End())
+        {
+            it->second_.Remove(this);
+            if (it->second_.Empty())
+                autoSolvers.Erase(it);
+        }
+    }
+
+    autoSolveScene_ = scene;
+
+    if (autoSolveScene_ != nullptr)
+    {
+        SubscribeToEvent(autoSolveScene_, E_SCENEDRAWABLEUPDATEFINISHED, URHO3D_HANDLER(IKSolver, HandleSceneDrawableUpdateFinished));
+        autoSolvers[autoSolveScene_].Push(this);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void IKSolver::SolveAutoSolvers()
+{
+    Scene* scene = autoSolveScene_;
+    HashMap<Scene*, PODVector<IKSolver*> >::ConstIterator it = autoSolvers.Find(scene);
+    if (it == autoSolvers.End())
+        return;
+
+    URHO3D_PROFILE(IKSolve);
+
+    const PODVector<IKSolver*>& solvers = it->second_;
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    /* A solver below another automatically solved solver must see the pose of
+     * its parent solver, so those are solved one by one after the others have
+     * been applied. */
+    PODVector<IKSolver*> independent;
+    PODVector<IKSolver*> dependent;
+    for (PODVector<IKSolver*>::ConstIterator i = solvers.Begin(); i != solvers.End(); ++i)
+    {
+        bool isDependent = false;
+        for (Node* iterNode = (*i)->node_->GetParent(); iterNode != nullptr && !isDependent; iterNode = iterNode->GetParent())
+        {
+            auto* parentSolver = iterNode->GetComponent<IKSolver>();
+            isDependent = parentSolver != nullptr && parentSolver->autoSolveScene_ == scene;
+        }
+
+        if (isDependent)
+            dependent.Push(*i);
+        else if ((*i)->PrepareSolve())
+            independent.Push(*i);
+    }
+
+    if (queue == nullptr || queue->GetNumThreads() == 0 || independent.Size() < 2)
+    {
+        for (PODVector<IKSolver*>::ConstIterator i = independent.Begin(); i != independent.End(); ++i)
+            (*i)->SolvePose();
+    }
+    else
+    {
+        // Solving only touches the solvers' own trees, so each worker can take a share of them
+        unsigned numWorkItems = Min(queue->GetNumThreads() + 1, independent.Size()); // Worker threads + main thread
+        unsigned solversPerItem = independent.Size() / numWorkItems;
+        IKSolver** start = independent.Buffer();
+
+        for (unsigned i = 0; i < numWorkItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = SolveIKWork;
+            item->name_ = "SolveIKWork";
+            item->aux_ = nullptr;
+            item->start_ = start + i * solversPerItem;
+            item->end_ = i < numWorkItems - 1 ? start + (i + 1) * solversPerItem : start + independent.Size();
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    for (PODVector<IKSolver*>::ConstIterator i = independent.Begin(); i != independent.End(); ++i)
+        (*i)->ApplySolvedPose();
 
-    ApplyActivePoseToScene();
+    for (PODVector<IKSolver*>::ConstIterator i = dependent.Begin(); i != dependent.End(); ++i)
+        (*i)->Solve();
 }
 
 // ----------------------------------------------------------------------------
@@ -518,8 +659,7 @@ bool IKSolver::IsSolverTreeValid() const
 // ----------------------------------------------------------------------------
 void IKSolver::OnSceneSet(Scene* scene)
 {
-    if (features_ & AUTO_SOLVE)
-        SubscribeToEvent(scene, E_SCENEDRAWABLEUPDATEFINISHED, URHO3D_HANDLER(IKSolver, HandleSceneDrawableUpdateFinished));
+    UpdateAutoSolve(scene);
 }
 
 // ----------------------------------------------------------------------------
@@ -722,7 +862,10 @@ void IKSolver::HandleNodeRemoved(StringHash eventType, VariantMap& eventData)
 // ----------------------------------------------------------------------------
 void IKSolver::HandleSceneDrawableUpdateFinished(StringHash eventType, VariantMap& eventData)
 {
-    Solve();
+    // The first registered solver of the scene solves all of them together
+    HashMap<Scene*, PODVector<IKSolver*> >::ConstIterator it = autoSolvers.Find(autoSolveScene_);
+    if (it != autoSolvers.End() && it->second_.Front() == this)
+        SolveAutoSolvers();
 }
 
 // ----------------------------------------------------------------------------
@@ -32,6 +32,7 @@ namespace Urho3D
 class AnimationState;
 class IKConstraint;
 class IKEffector;
+struct WorkItem;
 
 /*!
  * @brief Marks the root or "beginning" of an IK chain or multiple IK chains.
@@ -310,6 +311,7 @@ public:
 
 private:
     friend class IKEffector;
+    friend void SolveIKWork(const WorkItem* item, unsigned threadIndex);
 
     /// Indicates that the internal structures of the IK library need to be updated. See the documentation of ik_solver_rebuild_chain_trees() for more info on when this happens.
     void MarkChainsNeedUpdating();
@@ -318,6 +320,17 @@ private:
     /// Returns false if calling Solve() would cause the IK library to abort. Urho3D's error handling philosophy is to log an error and continue, not crash.
     bool IsSolverTreeValid() const;
 
+    /// Rebuilds the tree if necessary and copies the scene graph and effector targets into the active pose. Returns false if the tree can't be solved. Must be called from the main thread.
+    bool PrepareSolve();
+    /// Runs the solving algorithm on the active pose. Does not touch the scene graph, so it may be called from a worker thread.
+    void SolvePose();
+    /// Copies the solved active pose back to the scene graph. Must be called from the main thread.
+    void ApplySolvedPose();
+    /// Adds or removes this solver from the automatically solved solvers of its scene, depending on the AUTO_SOLVE feature.
+    void UpdateAutoSolve(Scene* scene);
+    /// Solves all automatically solved solvers of the scene. Solvers that don't have another automatically solved solver above them are solved in parallel.
+    void SolveAutoSolvers();
+
     /// Subscribe to drawable update finished event here
     void OnSceneSet(Scene* scene) override;
     /// Destroys and creates the tree
@@ -370,6 +383,8 @@ private:
     PODVector<IKEffector*> effectorList_;
     PODVector<IKConstraint*> constraintList_;
     ik_solver_t* solver_;
+    /// Scene this solver is registered to for automatic solving.
+    Scene* autoSolveScene_;
     Algorithm algorithm_;
     unsigned features_;
     bool chainTreesNeedUpdating_;
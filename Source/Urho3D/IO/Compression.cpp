@@ -27,6 +27,7 @@
 #include "../IO/Deserializer.h"
 #include "../IO/Serializer.h"
 #include "../IO/VectorBuffer.h"
+#include "../Math/MathDefs.h"
 
 #include <LZ4/lz4.h>
 #include <LZ4/lz4hc.h>
@@ -122,4 +123,72 @@ VectorBuffer DecompressVectorBuffer(VectorBuffer& src)
     return ret;
 }
 
+StreamCompressor::StreamCompressor() :
+    stream_(LZ4_createStream())
+{
+}
+
+StreamCompressor::~StreamCompressor()
+{
+    LZ4_freeStream(static_cast<LZ4_stream_t*>(stream_));
+    stream_ = nullptr;
+}
+
+void StreamCompressor::Reset(const PODVector<unsigned char>& dictionary)
+{
+    history_.Clear();
+    AddHistory(dictionary.Buffer(), dictionary.Size());
+}
+
+unsigned StreamCompressor::Compress(void* dest, const void* src, unsigned srcSize)
+{
+    if (!dest || !src || !srcSize)
+        return 0;
+
+    auto* stream = static_cast<LZ4_stream_t*>(stream_);
+    LZ4_loadDict(stream, (const char*)history_.Buffer(), history_.Size());
+    int compressedSize = LZ4_compress_fast_continue(stream, (const char*)src, (char*)dest, srcSize, LZ4_compressBound(srcSize), 1);
+    if (compressedSize <= 0)
+        return 0;
+
+    AddHistory((const unsigned char*)src, srcSize);
+    return (unsigned)compressedSize;
+}
+
+bool StreamCompressor::Decompress(void* dest, const void* src, unsigned srcSize, unsigned destSize)
+{
+    if (!dest || !src || !srcSize || !destSize)
+        return false;
+
+    // Unlike DecompressData(), checks the source bounds, as the data comes from the network
+    int size = LZ4_decompress_safe_usingDict((const char*)src, (char*)dest, srcSize, destSize, (const char*)history_.Buffer(),
+        history_.Size());
+    if (size != (int)destSize)
+        return false;
+
+    AddHistory((const unsigned char*)dest, destSize);
+    return true;
+}
+
+void StreamCompressor::AddHistory(const unsigned char* data, unsigned size)
+{
+    if (!size)
+        return;
+
+    if (size >= COMPRESSION_HISTORY_SIZE)
+    {
+        history_.Resize(COMPRESSION_HISTORY_SIZE);
+        memcpy(history_.Buffer(), data + size - COMPRESSION_HISTORY_SIZE, COMPRESSION_HISTORY_SIZE);
+        return;
+    }
+
+    unsigned keep = Min(history_.Size(), COMPRESSION_HISTORY_SIZE - size);
+    if (keep < history_.Size())
+    {
+        memmove(history_.Buffer(), history_.Buffer() + history_.Size() - keep, keep);
+        history_.Resize(keep);
+    }
+    history_.Insert(history_.End(), data, data + size);
+}
+
 }
@@ -28,6 +28,8 @@
 #include <Urho3D/Urho3D.h>
 #endif
 
+#include "../Container/Vector.h"
+
 namespace Urho3D
 {
 
@@ -50,4 +52,37 @@ URHO3D_API VectorBuffer CompressVectorBuffer(VectorBuffer& src);
 /// Decompress a VectorBuffer produced using CompressVectorBuffer().
 URHO3D_API VectorBuffer DecompressVectorBuffer(VectorBuffer& src);
 
+/// Size of the stream history used as the dictionary by StreamCompressor, the maximum match distance of LZ4.
+static const unsigned COMPRESSION_HISTORY_SIZE = 65536;
+
+/// LZ4 compression of a stream of blocks, using the data of the preceding blocks as the dictionary, so that small blocks resembling earlier ones compress well. The blocks must be decompressed in the same order by another instance reset with the same preset dictionary.
+class URHO3D_API StreamCompressor
+{
+public:
+    /// Construct with an empty history.
+    StreamCompressor();
+    /// Destruct.
+    ~StreamCompressor();
+    /// Prevent copy construction.
+    StreamCompressor(const StreamCompressor& rhs) = delete;
+    /// Prevent assignment.
+    StreamCompressor& operator =(const StreamCompressor& rhs) = delete;
+
+    /// Reset the history to a preset dictionary, for example data typical of the stream. Only the last 64 KB are used.
+    void Reset(const PODVector<unsigned char>& dictionary);
+    /// Compress a block and append it to the history. The destination buffer worst-case size is given by EstimateCompressBound(). Return the compressed size, or 0 on failure.
+    unsigned Compress(void* dest, const void* src, unsigned srcSize);
+    /// Decompress a block produced by Compress() and append it to the history. The uncompressed size must be known. Return true on success.
+    bool Decompress(void* dest, const void* src, unsigned srcSize, unsigned destSize);
+
+private:
+    /// Append data to the history, discarding the oldest data beyond the history size.
+    void AddHistory(const unsigned char* data, unsigned size);
+
+    /// LZ4 stream state.
+    void* stream_;
+    /// Most recent data of the stream.
+    PODVector<unsigned char> history_;
+};
+
 }
@@ -30,6 +30,8 @@ namespace Urho3D
 {
 
 static const float invQ = 1.0f / 32767.0f;
+static const float invCompactQ = 1.0f / 1023.0f;
+static const float invSqrt2 = 0.70710678f;
 
 Deserializer::Deserializer() :
     position_(0),
@@ -209,6 +211,28 @@ Quaternion Deserializer::ReadPackedQuaternion()
     return ret;
 }
 
+Quaternion Deserializer::ReadCompactQuaternion()
+{
+    unsigned packed = ReadUInt();
+    unsigned largest = packed >> 30u;
+    float components[4];
+    float sumSquares = 0.0f;
+
+    for (unsigned i = 4; i-- > 0;)
+    {
+        if (i == largest)
+            continue;
+        components[i] = ((packed & 0x3ffu) * invCompactQ * 2.0f - 1.0f) * invSqrt2;
+        sumSquares += components[i] * components[i];
+        packed >>= 10u;
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    Quaternion ret(components[0], components[1], components[2], components[3]);
+    ret.Normalize();
+    return ret;
+}
+
 Matrix3 Deserializer::ReadMatrix3()
 {
     float data[9];
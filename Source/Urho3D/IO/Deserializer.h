@@ -103,6 +103,8 @@ public:
     Quaternion ReadQuaternion();
     /// Read a quaternion with each component packed in 16 bits.
     Quaternion ReadPackedQuaternion();
+    /// Read a quaternion packed into 32 bits as the index of the largest component and the three smallest components in 10 bits each.
+    Quaternion ReadCompactQuaternion();
     /// Read a Matrix3.
     Matrix3 ReadMatrix3();
     /// Read a Matrix3x4.
@@ -25,6 +25,7 @@
 #include "../Core/Profiler.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
@@ -33,6 +34,14 @@
 #include <SDL/SDL_rwops.h>
 #endif
 
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <cstdio>
 #include <LZ4/lz4.h>
 
@@ -63,7 +72,16 @@ static const char* openMode[] =
 const char* APK = "/apk/";
 static const unsigned READ_BUFFER_SIZE = 32768;
 #endif
-static const unsigned SKIP_BUFFER_SIZE = 1024;
+static const unsigned BLOCK_HEADER_SIZE = 4;
+
+static void UnmapFileView(void* view, unsigned size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+#elif !defined(__EMSCRIPTEN__)
+    munmap(view, size);
+#endif
+}
 
 File::File(Context* context) :
     Object(context),
@@ -74,11 +92,16 @@ File::File(Context* context) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
-    writeSyncNeeded_(false)
+    writeSyncNeeded_(false),
+    mappedView_(nullptr),
+    mappedViewOffset_(0),
+    mappedViewSize_(0),
+    mappedPosition_(0)
 {
 }
 
@@ -91,11 +114,16 @@ File::File(Context* context, const String& fileName, FileMode mode) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
-    writeSyncNeeded_(false)
+    writeSyncNeeded_(false),
+    mappedView_(nullptr),
+    mappedViewOffset_(0),
+    mappedViewSize_(0),
+    mappedPosition_(0)
 {
     Open(fileName, mode);
 }
@@ -109,11 +137,16 @@ File::File(Context* context, PackageFile* package, const String& fileName) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
-    writeSyncNeeded_(false)
+    writeSyncNeeded_(false),
+    mappedView_(nullptr),
+    mappedViewOffset_(0),
+    mappedViewSize_(0),
+    mappedPosition_(0)
 {
     Open(package, fileName);
 }
@@ -128,6 +161,22 @@ bool File::Open(const String& fileName, FileMode mode)
     return OpenInternal(fileName, mode);
 }
 
+bool File::OpenMapped(const String& fileName)
+{
+    // Open normally first to check access and get the size
+    if (!OpenInternal(fileName, FILE_READ))
+        return false;
+
+    unsigned size = size_;
+    if (OpenMappedInternal(fileName, 0, size))
+    {
+        size_ = size;
+        return true;
+    }
+
+    return OpenInternal(fileName, FILE_READ);
+}
+
 bool File::Open(PackageFile* package, const String& fileName)
 {
     if (!package)
@@ -137,7 +186,10 @@ bool File::Open(PackageFile* package, const String& fileName)
     if (!entry)
         return false;
 
-    bool success = OpenInternal(package->GetName(), FILE_READ, true);
+    // Map up to the end of the package, as the packed size of a compressed entry is not known beforehand
+    bool success = package->IsMemoryMapped() && OpenMappedInternal(package->GetName(), entry->offset_, package->GetTotalSize());
+    if (!success)
+        success = OpenInternal(package->GetName(), FILE_READ, true);
     if (!success)
     {
         URHO3D_LOGERROR("Could not open package file " + fileName);
@@ -148,7 +200,14 @@ bool File::Open(PackageFile* package, const String& fileName)
     offset_ = entry->offset_;
     checksum_ = entry->checksum_;
     size_ = entry->size_;
-    compressed_ = package->IsCompressed();
+    compressed_ = entry->compressed_;
+
+    // The first compressed block starts at the beginning of the data, further blocks are indexed when first reached
+    if (compressed_)
+    {
+        blockPositions_.Push(0);
+        blockOffsets_.Push(offset_);
+    }
 
     // Seek to beginning of package entry's file data
     SeekInternal(offset_);
@@ -218,25 +277,11 @@ unsigned File::Read(void* dest, unsigned size)
         {
             if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
             {
-                unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
-
-                MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
-                unsigned unpackedSize = blockHeader.ReadUShort();
-                unsigned packedSize = blockHeader.ReadUShort();
-
-                if (!readBuffer_)
+                if (!ReadCompressedBlock(position_))
                 {
-                    readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
+                    URHO3D_LOGERROR("Error while reading from compressed file " + GetName());
+                    return size - sizeLeft;
                 }
-
-                /// \todo Handle errors
-                ReadInternal(inputBuffer_.Get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), unpackedSize);
-
-                readBufferSize_ = unpackedSize;
-                readBufferOffset_ = 0;
             }
 
             unsigned copySize = Min((readBufferSize_ - readBufferOffset_), sizeLeft);
@@ -284,24 +329,25 @@ unsigned File::Seek(unsigned position)
 
     if (compressed_)
     {
-        // Start over from the beginning
-        if (position == 0)
+        // Stay within the current block if possible, otherwise decompress only the block containing the position
+        unsigned blockPosition = position_ - readBufferOffset_;
+        if (readBufferSize_ && position >= blockPosition && position < blockPosition + readBufferSize_)
+            readBufferOffset_ = position - blockPosition;
+        else if (position < size_)
         {
-            position_ = 0;
-            readBufferOffset_ = 0;
-            readBufferSize_ = 0;
-            SeekInternal(offset_);
+            if (!ReadCompressedBlock(position))
+            {
+                URHO3D_LOGERROR("Error while seeking in compressed file " + GetName());
+                return position_;
+            }
         }
-        // Skip bytes
-        else if (position >= position_)
+        else
         {
-            unsigned char skipBuffer[SKIP_BUFFER_SIZE];
-            while (position > position_)
-                Read(skipBuffer, Min(position - position_, SKIP_BUFFER_SIZE));
+            readBufferOffset_ = 0;
+            readBufferSize_ = 0;
         }
-        else
-            URHO3D_LOGERROR("Seeking backward in a compressed file is not supported");
 
+        position_ = position;
         return position_;
     }
 
@@ -393,6 +439,24 @@ void File::Close()
 
     readBuffer_.Reset();
     inputBuffer_.Reset();
+    readBufferOffset_ = 0;
+    readBufferSize_ = 0;
+    readBufferCapacity_ = 0;
+    blockPositions_.Clear();
+    blockOffsets_.Clear();
+
+    if (mappedView_)
+    {
+        UnmapFileView(mappedView_, mappedViewSize_);
+        mappedView_ = nullptr;
+        mappedViewOffset_ = 0;
+        mappedViewSize_ = 0;
+        mappedPosition_ = 0;
+        position_ = 0;
+        size_ = 0;
+        offset_ = 0;
+        checksum_ = 0;
+    }
 
     if (handle_)
     {
@@ -419,12 +483,17 @@ void File::SetName(const String& name)
 bool File::IsOpen() const
 {
 #ifdef __ANDROID__
-    return handle_ != 0 || assetHandle_ != 0;
+    return handle_ != 0 || assetHandle_ != 0 || mappedView_ != 0;
 #else
-    return handle_ != nullptr;
+    return handle_ != nullptr || mappedView_ != nullptr;
 #endif
 }
 
+const unsigned char* File::GetMappedData() const
+{
+    return mappedView_ && !compressed_ ? (const unsigned char*)mappedView_ + (offset_ - mappedViewOffset_) : nullptr;
+}
+
 bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
 {
     Close();
@@ -523,8 +592,87 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
     return true;
 }
 
+bool File::OpenMappedInternal(const String& fileName, unsigned offset, unsigned endOffset)
+{
+    Close();
+
+    compressed_ = false;
+    readSyncNeeded_ = false;
+    writeSyncNeeded_ = false;
+
+    // Empty entries at the end of the package have nothing to map
+    if (offset >= endOffset)
+        return false;
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (fileSystem && !fileSystem->CheckAccess(GetPath(fileName)))
+        return false;
+
+#ifdef __ANDROID__
+    // Assets inside the APK can only be accessed through SDL RWops
+    if (URHO3D_IS_ASSET(fileName))
+        return false;
+#endif
+
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    unsigned viewOffset = offset - offset % systemInfo.dwAllocationGranularity;
+
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName).CString(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(fileHandle);
+    if (!mappingHandle)
+        return false;
+    // The view keeps the mapping alive after its handle has been closed
+    void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, viewOffset, endOffset - viewOffset);
+    CloseHandle(mappingHandle);
+    if (!view)
+        return false;
+#elif !defined(__EMSCRIPTEN__)
+    auto pageSize = (unsigned)sysconf(_SC_PAGESIZE);
+    unsigned viewOffset = offset - offset % pageSize;
+
+    int fd = open(GetNativePath(fileName).CString(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    void* view = mmap(nullptr, endOffset - viewOffset, PROT_READ, MAP_PRIVATE, fd, (off_t)viewOffset);
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+#else
+    return false;
+#endif
+
+#ifndef __EMSCRIPTEN__
+    mappedView_ = view;
+    mappedViewOffset_ = viewOffset;
+    mappedViewSize_ = endOffset - viewOffset;
+    mappedPosition_ = offset;
+    fileName_ = fileName;
+    mode_ = FILE_READ;
+    position_ = 0;
+    checksum_ = 0;
+    return true;
+#endif
+}
+
 bool File::ReadInternal(void* dest, unsigned size)
 {
+    LoadStageTimer timer(LOADSTAGE_READ);
+
+    if (mappedView_)
+    {
+        if (mappedPosition_ < mappedViewOffset_ || mappedPosition_ - mappedViewOffset_ + size > mappedViewSize_)
+            return false;
+        memcpy(dest, (unsigned char*)mappedView_ + (mappedPosition_ - mappedViewOffset_), size);
+        mappedPosition_ += size;
+        return true;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -535,8 +683,77 @@ bool File::ReadInternal(void* dest, unsigned size)
         return fread(dest, size, 1, (FILE*)handle_) == 1;
 }
 
+bool File::ReadCompressedBlock(unsigned position)
+{
+    readBufferOffset_ = 0;
+    readBufferSize_ = 0;
+
+    // Start from the closest block found so far
+    unsigned block = blockPositions_.Size() - 1;
+    while (block > 0 && blockPositions_[block] > position)
+        --block;
+
+    unsigned blockPosition = blockPositions_[block];
+    unsigned blockOffset = blockOffsets_[block];
+
+    for (;;)
+    {
+        unsigned char blockHeaderBytes[BLOCK_HEADER_SIZE];
+        SeekInternal(blockOffset);
+        if (!ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes))
+            return false;
+
+        MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
+        unsigned unpackedSize = blockHeader.ReadUShort();
+        unsigned packedSize = blockHeader.ReadUShort();
+        if (!unpackedSize)
+            return false;
+
+        if (block + 1 == blockPositions_.Size())
+        {
+            blockPositions_.Push(blockPosition + unpackedSize);
+            blockOffsets_.Push(blockOffset + BLOCK_HEADER_SIZE + packedSize);
+        }
+
+        if (position < blockPosition + unpackedSize)
+        {
+            if (unpackedSize > readBufferCapacity_)
+            {
+                readBuffer_ = new unsigned char[unpackedSize];
+                inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
+                readBufferCapacity_ = unpackedSize;
+            }
+
+            if (!ReadInternal(inputBuffer_.Get(), packedSize))
+                return false;
+
+            {
+                LoadStageTimer timer(LOADSTAGE_DECOMPRESS);
+                if (LZ4_decompress_safe((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), packedSize, unpackedSize) !=
+                    (int)unpackedSize)
+                    return false;
+            }
+
+            readBufferSize_ = unpackedSize;
+            readBufferOffset_ = position - blockPosition;
+            return true;
+        }
+
+        // Skip the block without decompressing it
+        blockPosition += unpackedSize;
+        blockOffset += BLOCK_HEADER_SIZE + packedSize;
+        ++block;
+    }
+}
+
 void File::SeekInternal(unsigned newPosition)
 {
+    if (mappedView_)
+    {
+        mappedPosition_ = newPosition;
+        return;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -88,6 +88,8 @@ public:
     bool Open(const String& fileName, FileMode mode = FILE_READ);
     /// Open from within a package file. Return true if successful.
     bool Open(PackageFile* package, const String& fileName);
+    /// Open a filesystem file for reading through a memory mapping, falling back to buffered reading if it can not be mapped. Return true if successful.
+    bool OpenMapped(const String& fileName);
     /// Close the file.
     void Close();
     /// Flush any buffered output to the file.
@@ -107,13 +109,23 @@ public:
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
+    /// Return whether the file is read through a memory mapping of its package file.
+    bool IsMemoryMapped() const { return mappedView_ != nullptr; }
+
+    /// Return the file contents if memory mapped from a filesystem file or an uncompressed package file, or null otherwise. Remains valid until the file is closed.
+    const unsigned char* GetMappedData() const;
+
 private:
     /// Open file internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful.
     bool OpenInternal(const String& fileName, FileMode mode, bool fromPackage = false);
+    /// Open a read-only memory mapping of a package file region. Return true if successful.
+    bool OpenMappedInternal(const String& fileName, unsigned offset, unsigned endOffset);
     /// Perform the file read internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful. This does not handle compressed package file reading.
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
     void SeekInternal(unsigned newPosition);
+    /// Decompress the package file block containing the position, skipping other blocks by their headers. Return true if successful.
+    bool ReadCompressedBlock(unsigned position);
 
     /// File name.
     String fileName_;
@@ -133,6 +145,12 @@ private:
     unsigned readBufferOffset_;
     /// Bytes in the current read buffer.
     unsigned readBufferSize_;
+    /// Allocated size of the compressed file read buffer.
+    unsigned readBufferCapacity_;
+    /// Uncompressed start positions of the compressed blocks found so far.
+    PODVector<unsigned> blockPositions_;
+    /// Package file offsets of the compressed blocks found so far.
+    PODVector<unsigned> blockOffsets_;
     /// Start position within a package file, 0 for regular files.
     unsigned offset_;
     /// Content checksum.
@@ -143,6 +161,14 @@ private:
     bool readSyncNeeded_;
     /// Synchronization needed before write -flag.
     bool writeSyncNeeded_;
+    /// Memory mapped view of the package file, null when using file IO.
+    void* mappedView_;
+    /// Start position of the mapped view within the package file.
+    unsigned mappedViewOffset_;
+    /// Size of the mapped view.
+    unsigned mappedViewSize_;
+    /// Read position within the package file when memory mapped.
+    unsigned mappedPosition_;
 };
 
 }
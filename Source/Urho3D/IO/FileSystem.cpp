@@ -282,6 +282,71 @@ private:
     const Vector<String>& arguments_;
 };
 
+/// Async file read or directory scan operation.
+struct AsyncIORequest
+{
+    /// Request ID.
+    unsigned requestID_{};
+    /// File or directory name.
+    String fileName_;
+    /// Directory scan filter.
+    String filter_;
+    /// Directory scan flags.
+    unsigned flags_{};
+    /// Recursive directory scan flag.
+    bool recursive_{};
+    /// Directory scan flag. Otherwise the file is read.
+    bool scanDir_{};
+    /// Success flag.
+    bool success_{};
+    /// File data.
+    PODVector<unsigned char> data_;
+    /// Directory scan result.
+    Vector<String> result_;
+};
+
+/// Thread for async file reads and directory scans.
+class AsyncIOThread : public Thread
+{
+public:
+    /// Construct.
+    explicit AsyncIOThread(FileSystem* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// The function to run in the thread.
+    void ThreadFunction() override
+    {
+        owner_->ProcessAsyncIO();
+    }
+
+private:
+    /// File system subsystem.
+    FileSystem* owner_;
+};
+
+static void ExecuteAsyncIO(FileSystem* fileSystem, AsyncIORequest* request)
+{
+    if (request->scanDir_)
+    {
+        fileSystem->ScanDir(request->result_, request->fileName_, request->filter_, request->flags_, request->recursive_);
+        request->success_ = true;
+    }
+    else
+    {
+        File file(fileSystem->GetContext());
+        if (file.Open(request->fileName_))
+        {
+            unsigned size = file.GetSize();
+            request->data_.Resize(size);
+            request->success_ = file.Read(request->data_.Buffer(), size) == size;
+            if (!request->success_)
+                request->data_.Clear();
+        }
+    }
+}
+
 FileSystem::FileSystem(Context* context) :
     Object(context)
 {
@@ -301,6 +366,13 @@ FileSystem::~FileSystem()
 
         asyncExecQueue_.Clear();
     }
+
+    // Likewise delete unfinished async I/O operations after the threads have exited
+    StopAsyncIOThreads();
+    for (List<AsyncIORequest*>::Iterator i = asyncIOQueue_.Begin(); i != asyncIOQueue_.End(); ++i)
+        delete(*i);
+    for (List<AsyncIORequest*>::Iterator i = asyncIOCompleted_.Begin(); i != asyncIOCompleted_.End(); ++i)
+        delete(*i);
 }
 
 bool FileSystem::SetCurrentDir(const String& pathName)
@@ -788,6 +860,167 @@ bool FileSystem::SetLastModifiedTime(const String& fileName, unsigned newTime)
 #endif
 }
 
+unsigned FileSystem::ReadFileAsync(const String& fileName)
+{
+    Vector<String> fileNames;
+    fileNames.Push(fileName);
+    return ReadFilesAsync(fileNames);
+}
+
+unsigned FileSystem::ReadFilesAsync(const Vector<String>& fileNames)
+{
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+    {
+        if (fileNames[i].Empty() || !CheckAccess(GetPath(fileNames[i])))
+        {
+            URHO3D_LOGERROR("Access denied to " + fileNames[i]);
+            return M_MAX_UNSIGNED;
+        }
+    }
+
+    unsigned requestID = nextAsyncIOID_++;
+    if (nextAsyncIOID_ == M_MAX_UNSIGNED)
+        nextAsyncIOID_ = 1;
+
+    // Queue the files as separate operations so that the threads can read them in parallel
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+    {
+        auto* request = new AsyncIORequest();
+        request->requestID_ = requestID;
+        request->fileName_ = fileNames[i];
+        QueueAsyncIO(request);
+    }
+
+    return requestID;
+}
+
+unsigned FileSystem::ScanDirAsync(const String& pathName, const String& filter, unsigned flags, bool recursive)
+{
+    if (!CheckAccess(pathName))
+    {
+        URHO3D_LOGERROR("Access denied to " + pathName);
+        return M_MAX_UNSIGNED;
+    }
+
+    unsigned requestID = nextAsyncIOID_++;
+    if (nextAsyncIOID_ == M_MAX_UNSIGNED)
+        nextAsyncIOID_ = 1;
+
+    auto* request = new AsyncIORequest();
+    request->requestID_ = requestID;
+    request->fileName_ = pathName;
+    request->filter_ = filter;
+    request->flags_ = flags;
+    request->recursive_ = recursive;
+    request->scanDir_ = true;
+    QueueAsyncIO(request);
+
+    return requestID;
+}
+
+void FileSystem::SetNumAsyncIOThreads(unsigned num)
+{
+    num = Max(num, 1U);
+    if (num == numAsyncIOThreads_)
+        return;
+
+    numAsyncIOThreads_ = num;
+
+    // Restart already running threads with the new count
+    if (!asyncIOThreads_.Empty())
+    {
+        StopAsyncIOThreads();
+        MutexLock lock(asyncIOMutex_);
+        StartAsyncIOThreads();
+    }
+}
+
+void FileSystem::QueueAsyncIO(AsyncIORequest* request)
+{
+    ++numAsyncIORequests_;
+
+#ifdef URHO3D_THREADING
+    MutexLock lock(asyncIOMutex_);
+    if (asyncIOThreads_.Empty())
+        StartAsyncIOThreads();
+    asyncIOQueue_.Push(request);
+    asyncIOCondition_.Set();
+#else
+    // Without threading perform the operation immediately, but post the result on the next frame as with threads
+    ExecuteAsyncIO(this, request);
+    asyncIOCompleted_.Push(request);
+#endif
+}
+
+void FileSystem::StartAsyncIOThreads()
+{
+    asyncIOShutDown_ = false;
+    for (unsigned i = 0; i < numAsyncIOThreads_; ++i)
+    {
+        auto* thread = new AsyncIOThread(this);
+        thread->Run();
+        asyncIOThreads_.Push(thread);
+    }
+
+    // Wake up a thread in case operations were left queued when the threads were stopped
+    if (!asyncIOQueue_.Empty())
+        asyncIOCondition_.Set();
+}
+
+void FileSystem::StopAsyncIOThreads()
+{
+    if (asyncIOThreads_.Empty())
+        return;
+
+    {
+        MutexLock lock(asyncIOMutex_);
+        asyncIOShutDown_ = true;
+    }
+
+    // Each exiting thread wakes up the next one
+    asyncIOCondition_.Set();
+    for (unsigned i = 0; i < asyncIOThreads_.Size(); ++i)
+    {
+        asyncIOThreads_[i]->Stop();
+        delete asyncIOThreads_[i];
+    }
+    asyncIOThreads_.Clear();
+}
+
+void FileSystem::ProcessAsyncIO()
+{
+    for (;;)
+    {
+        asyncIOMutex_.Acquire();
+        if (asyncIOShutDown_)
+        {
+            asyncIOMutex_.Release();
+            asyncIOCondition_.Set();
+            return;
+        }
+        if (asyncIOQueue_.Empty())
+        {
+            asyncIOMutex_.Release();
+            asyncIOCondition_.Wait();
+            continue;
+        }
+
+        AsyncIORequest* request = asyncIOQueue_.Front();
+        asyncIOQueue_.PopFront();
+        bool morePending = !asyncIOQueue_.Empty();
+        asyncIOMutex_.Release();
+
+        // Let another thread pick up the next operation while this one performs its own
+        if (morePending)
+            asyncIOCondition_.Set();
+
+        ExecuteAsyncIO(this, request);
+
+        MutexLock lock(asyncIOMutex_);
+        asyncIOCompleted_.Push(request);
+    }
+}
+
 void FileSystem::ScanDirInternal(Vector<String>& result, String path, const String& startPath,
     const String& filter, unsigned flags, bool recursive) const
 {
@@ -922,6 +1155,45 @@ void FileSystem::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
         else
             ++i;
     }
+
+    // Post finished async I/O operations
+    if (numAsyncIORequests_)
+    {
+        List<AsyncIORequest*> completed;
+        {
+            MutexLock lock(asyncIOMutex_);
+            completed.Swap(asyncIOCompleted_);
+        }
+
+        for (List<AsyncIORequest*>::Iterator i = completed.Begin(); i != completed.End(); ++i)
+        {
+            AsyncIORequest* request = *i;
+            if (request->scanDir_)
+            {
+                using namespace AsyncScanDirFinished;
+
+                VariantMap& newEventData = GetEventDataMap();
+                newEventData[P_REQUESTID] = request->requestID_;
+                newEventData[P_PATHNAME] = request->fileName_;
+                newEventData[P_RESULT] = request->result_;
+                SendEvent(E_ASYNCSCANDIRFINISHED, newEventData);
+            }
+            else
+            {
+                using namespace AsyncReadFinished;
+
+                VariantMap& newEventData = GetEventDataMap();
+                newEventData[P_REQUESTID] = request->requestID_;
+                newEventData[P_FILENAME] = request->fileName_;
+                newEventData[P_SUCCESS] = request->success_;
+                newEventData[P_DATA] = request->data_;
+                SendEvent(E_ASYNCREADFINISHED, newEventData);
+            }
+
+            delete request;
+            --numAsyncIORequests_;
+        }
+    }
 }
 
 void FileSystem::HandleConsoleCommand(StringHash eventType, VariantMap& eventData)
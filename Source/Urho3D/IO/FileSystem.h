@@ -24,12 +24,16 @@
 
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
+#include "../Core/Condition.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
 namespace Urho3D
 {
 
 class AsyncExecRequest;
+class AsyncIOThread;
+struct AsyncIORequest;
 
 /// Return files.
 static const unsigned SCAN_FILES = 0x1;
@@ -43,6 +47,8 @@ class URHO3D_API FileSystem : public Object
 {
     URHO3D_OBJECT(FileSystem, Object);
 
+    friend class AsyncIOThread;
+
 public:
     /// Construct.
     explicit FileSystem(Context* context);
@@ -75,6 +81,14 @@ public:
     void RegisterPath(const String& pathName);
     /// Set a file's last modified time as seconds since 1.1.1970. Return true on success.
     bool SetLastModifiedTime(const String& fileName, unsigned newTime);
+    /// Read a whole file asynchronously. Return a request ID or M_MAX_UNSIGNED if failed. The data will be posted together with the request ID in an AsyncReadFinished event.
+    unsigned ReadFileAsync(const String& fileName);
+    /// Read several files asynchronously, in parallel on the I/O threads. Return a request ID or M_MAX_UNSIGNED if failed. An AsyncReadFinished event with the request ID will be posted for each file as it completes.
+    unsigned ReadFilesAsync(const Vector<String>& fileNames);
+    /// Scan a directory for specified files asynchronously. Return a request ID or M_MAX_UNSIGNED if failed. The result will be posted together with the request ID in an AsyncScanDirFinished event.
+    unsigned ScanDirAsync(const String& pathName, const String& filter, unsigned flags, bool recursive);
+    /// Set number of threads for asynchronous file reads and directory scans. Default 2. Threads are started on the first request.
+    void SetNumAsyncIOThreads(unsigned num);
 
     /// Return the absolute current working directory.
     String GetCurrentDir() const;
@@ -82,6 +96,12 @@ public:
     /// Return whether is executing engine console commands as OS-specific system command.
     bool GetExecuteConsoleCommands() const { return executeConsoleCommands_; }
 
+    /// Return number of threads for asynchronous file reads and directory scans.
+    unsigned GetNumAsyncIOThreads() const { return numAsyncIOThreads_; }
+
+    /// Return number of asynchronous file reads and directory scans not yet posted.
+    unsigned GetNumAsyncIORequests() const { return numAsyncIORequests_; }
+
     /// Return whether paths have been registered.
     bool HasRegisteredPaths() const { return allowedPaths_.Size() > 0; }
 
@@ -108,6 +128,14 @@ private:
     /// Scan directory, called internally.
     void ScanDirInternal
         (Vector<String>& result, String path, const String& startPath, const String& filter, unsigned flags, bool recursive) const;
+    /// Queue an asynchronous I/O operation. Start the I/O threads if not started yet.
+    void QueueAsyncIO(AsyncIORequest* request);
+    /// Start the I/O threads. Called with the async I/O mutex held.
+    void StartAsyncIOThreads();
+    /// Stop the I/O threads. Queued operations are kept.
+    void StopAsyncIOThreads();
+    /// Perform queued asynchronous I/O operations until shut down. Called by the I/O threads.
+    void ProcessAsyncIO();
     /// Handle begin frame event to check for completed async executions.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Handle a console command event.
@@ -119,6 +147,24 @@ private:
     List<AsyncExecRequest*> asyncExecQueue_;
     /// Next async execution ID.
     unsigned nextAsyncExecID_{1};
+    /// Next async I/O request ID.
+    unsigned nextAsyncIOID_{1};
+    /// Async I/O operations waiting for a thread.
+    List<AsyncIORequest*> asyncIOQueue_;
+    /// Completed async I/O operations waiting to be posted.
+    List<AsyncIORequest*> asyncIOCompleted_;
+    /// Async I/O threads.
+    PODVector<AsyncIOThread*> asyncIOThreads_;
+    /// Mutex for the async I/O queues.
+    Mutex asyncIOMutex_;
+    /// Condition for waking up async I/O threads.
+    Condition asyncIOCondition_;
+    /// Number of async I/O threads to start.
+    unsigned numAsyncIOThreads_{2};
+    /// Number of async I/O operations not yet posted.
+    unsigned numAsyncIORequests_{};
+    /// Async I/O shutdown flag.
+    volatile bool asyncIOShutDown_{};
     /// Flag for executing engine console commands as OS-specific system command. Default to true.
     bool executeConsoleCommands_{};
 };
@@ -30,11 +30,14 @@
 #ifdef _WIN32
 #include <windows.h>
 #elif __linux__
+#include <cerrno>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
 extern "C"
 {
 // Need read/close for inotify
 #include "unistd.h"
+#include <poll.h>
 }
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
 extern "C"
@@ -48,6 +51,9 @@ namespace Urho3D
 #ifndef __APPLE__
 static const unsigned BUFFERSIZE = 4096;
 #endif
+#ifdef __linux__
+static const unsigned WATCH_FLAGS = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
+#endif
 
 FileWatcher::FileWatcher(Context* context) :
     Object(context),
@@ -58,6 +64,7 @@ FileWatcher::FileWatcher(Context* context) :
 #ifdef URHO3D_FILEWATCHER
 #ifdef __linux__
     watchHandle_ = inotify_init();
+    wakeHandle_ = eventfd(0, 0);
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     supported_ = IsFileWatcherSupported();
 #endif
@@ -70,6 +77,7 @@ FileWatcher::~FileWatcher()
 #ifdef URHO3D_FILEWATCHER
 #ifdef __linux__
     close(watchHandle_);
+    close(wakeHandle_);
 #endif
 #endif
 }
@@ -113,8 +121,7 @@ bool FileWatcher::StartWatching(const String& pathName, bool watchSubDirs)
         return false;
     }
 #elif defined(__linux__)
-    int flags = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
-    int handle = inotify_add_watch(watchHandle_, pathName.CString(), (unsigned)flags);
+    int handle = inotify_add_watch(watchHandle_, pathName.CString(), WATCH_FLAGS);
 
     if (handle < 0)
     {
@@ -140,7 +147,7 @@ bool FileWatcher::StartWatching(const String& pathName, bool watchSubDirs)
                 // Don't watch ./ or ../ sub-directories
                 if (!subDirFullPath.EndsWith("./"))
                 {
-                    handle = inotify_add_watch(watchHandle_, subDirFullPath.CString(), (unsigned)flags);
+                    handle = inotify_add_watch(watchHandle_, subDirFullPath.CString(), WATCH_FLAGS);
                     if (handle < 0)
                         URHO3D_LOGERROR("Failed to start watching subdirectory path " + subDirFullPath);
                     else
@@ -213,6 +220,11 @@ void FileWatcher::StopWatching()
 #ifdef _WIN32
         CloseHandle((HANDLE)dirHandle_);
 #elif defined(__linux__)
+        // Wake up the watcher thread blocking on events and let it exit before the watches are removed, as it may add
+        // watches for new subdirectories
+        uint64_t wake = 1;
+        if (write(wakeHandle_, &wake, sizeof(wake)) == sizeof(wake))
+            Stop();
         for (HashMap<int, String>::Iterator i = dirHandle_.Begin(); i != dirHandle_.End(); ++i)
             inotify_rm_watch(watchHandle_, i->first_);
         dirHandle_.Clear();
@@ -279,10 +291,30 @@ void FileWatcher::ThreadFunction()
         }
     }
 #elif defined(__linux__)
-    unsigned char buffer[BUFFERSIZE];
+    alignas(inotify_event) unsigned char buffer[BUFFERSIZE];
+    pollfd handles[2] = {{watchHandle_, POLLIN, 0}, {wakeHandle_, POLLIN, 0}};
 
     while (shouldRun_)
     {
+        // Block until there are events or the watcher is being stopped
+        if (poll(handles, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        if (handles[1].revents & POLLIN)
+        {
+            uint64_t wake;
+            if (read(wakeHandle_, &wake, sizeof(wake)) < 0)
+                return;
+            continue;
+        }
+
+        if (!(handles[0].revents & POLLIN))
+            continue;
+
         int i = 0;
         auto length = (int)read(watchHandle_, buffer, sizeof(buffer));
 
@@ -295,12 +327,21 @@ void FileWatcher::ThreadFunction()
 
             if (event->len > 0)
             {
-                if (event->mask & IN_MODIFY || event->mask & IN_MOVE)
+                String fileName;
+                fileName = dirHandle_[event->wd] + event->name;
+
+                if (event->mask & IN_ISDIR)
                 {
-                    String fileName;
-                    fileName = dirHandle_[event->wd] + event->name;
-                    AddChange(fileName);
+                    // Watch the subdirectories created or moved in while watching
+                    if (watchSubDirs_ && event->mask & (IN_CREATE | IN_MOVED_TO))
+                    {
+                        int handle = inotify_add_watch(watchHandle_, (path_ + fileName).CString(), WATCH_FLAGS);
+                        if (handle >= 0)
+                            dirHandle_[handle] = AddTrailingSlash(fileName);
+                    }
                 }
+                else if (event->mask & IN_MODIFY || event->mask & IN_MOVE)
+                    AddChange(fileName);
             }
 
             i += sizeof(inotify_event) + event->len;
@@ -329,6 +370,7 @@ void FileWatcher::AddChange(const String& fileName)
 
     // Reset the timer associated with the filename. Will be notified once timer exceeds the delay
     changes_[fileName].Reset();
+    lastChange_.Reset();
 }
 
 bool FileWatcher::GetNextChange(String& dest)
@@ -355,4 +397,19 @@ bool FileWatcher::GetNextChange(String& dest)
     }
 }
 
+bool FileWatcher::GetChanges(Vector<String>& dest)
+{
+    MutexLock lock(changesMutex_);
+
+    // Wait until no file has changed for the delay, as a save may write several files one after another. A file
+    // modified many times is in the changes only once
+    if (changes_.Empty() || lastChange_.GetMSec(false) < (unsigned)(delay_ * 1000.0f))
+        return false;
+
+    for (HashMap<String, Timer>::ConstIterator i = changes_.Begin(); i != changes_.End(); ++i)
+        dest.Push(i->first_);
+    changes_.Clear();
+    return true;
+}
+
 }
@@ -57,6 +57,8 @@ public:
     void AddChange(const String& fileName);
     /// Return a file change (true if was found, false if not.)
     bool GetNextChange(String& dest);
+    /// Move the pending file changes to the destination once no file has changed for the delay, so that the files written by one save are returned as one batch with each file once. Return true if changes were returned.
+    bool GetChanges(Vector<String>& dest);
 
     /// Return the path being watched, or empty if not watching.
     const String& GetPath() const { return path_; }
@@ -71,6 +73,8 @@ private:
     String path_;
     /// Pending changes. These will be returned and removed from the list when their timer has exceeded the delay.
     HashMap<String, Timer> changes_;
+    /// Time since the latest change.
+    Timer lastChange_;
     /// Mutex for the change buffer.
     Mutex changesMutex_;
     /// Delay in seconds for notifying changes.
@@ -89,6 +93,8 @@ private:
     HashMap<int, String> dirHandle_;
     /// Linux inotify needs a handle.
     int watchHandle_;
+    /// Event handle for waking up the watcher thread when stopping.
+    int wakeHandle_;
 
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
 
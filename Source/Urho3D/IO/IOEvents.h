@@ -41,4 +41,21 @@ URHO3D_EVENT(E_ASYNCEXECFINISHED, AsyncExecFinished)
     URHO3D_PARAM(P_EXITCODE, ExitCode);            // int
 }
 
+/// Async file read finished.
+URHO3D_EVENT(E_ASYNCREADFINISHED, AsyncReadFinished)
+{
+    URHO3D_PARAM(P_REQUESTID, RequestID);          // unsigned
+    URHO3D_PARAM(P_FILENAME, FileName);            // String
+    URHO3D_PARAM(P_SUCCESS, Success);              // bool
+    URHO3D_PARAM(P_DATA, Data);                    // Buffer
+}
+
+/// Async directory scan finished.
+URHO3D_EVENT(E_ASYNCSCANDIRFINISHED, AsyncScanDirFinished)
+{
+    URHO3D_PARAM(P_REQUESTID, RequestID);          // unsigned
+    URHO3D_PARAM(P_PATHNAME, PathName);            // String
+    URHO3D_PARAM(P_RESULT, Result);                // StringVector
+}
+
 }
@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/LoadTiming.h"
+
+#include <chrono>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace Detail
+{
+
+std::atomic<int> loadTimingScopes(0);
+
+}
+
+static const char* loadStageNames[] =
+{
+    "Open",
+    "Read",
+    "Decompress",
+    "BeginLoad",
+    "EndLoad",
+    "Upload",
+    nullptr
+};
+
+static thread_local LoadStageTimes* threadTimes = nullptr;
+static thread_local LoadStageTimer* threadTimer = nullptr;
+
+static long long GetTimingUSec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LoadStageTimes::Accumulate(const LoadStageTimes& rhs)
+{
+    for (unsigned i = 0; i < MAX_LOADSTAGES; ++i)
+        usec_[i] += rhs.usec_[i];
+}
+
+long long LoadStageTimes::GetTotal() const
+{
+    long long total = 0;
+    for (long long usec : usec_)
+        total += usec;
+    return total;
+}
+
+LoadTimingScope::LoadTimingScope(LoadStageTimes* times) :
+    previous_(threadTimes),
+    active_(times != nullptr)
+{
+    if (active_)
+    {
+        threadTimes = times;
+        ++Detail::loadTimingScopes;
+    }
+}
+
+LoadTimingScope::~LoadTimingScope()
+{
+    if (active_)
+    {
+        threadTimes = previous_;
+        --Detail::loadTimingScopes;
+    }
+}
+
+void LoadStageTimer::Begin()
+{
+    // Another thread may be recording while this one is not
+    if (!threadTimes)
+        return;
+
+    started_ = true;
+    parent_ = threadTimer;
+    threadTimer = this;
+    start_ = GetTimingUSec();
+}
+
+void LoadStageTimer::End()
+{
+    long long elapsed = GetTimingUSec() - start_;
+    if (threadTimes)
+        threadTimes->usec_[stage_] += elapsed - nested_;
+    if (parent_)
+        parent_->nested_ += elapsed;
+    threadTimer = parent_;
+}
+
+const char* GetLoadStageName(LoadStage stage)
+{
+    return stage < MAX_LOADSTAGES ? loadStageNames[stage] : "";
+}
+
+}
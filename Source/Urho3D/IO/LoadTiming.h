@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Stage of a resource load measured by the load stage timers.
+enum LoadStage
+{
+    /// Locating and opening the file, including resource directory, package and resource index lookups.
+    LOADSTAGE_OPEN = 0,
+    /// Reading bytes from a file, a package or a memory mapping.
+    LOADSTAGE_READ,
+    /// Decompressing LZ4 blocks of compressed package entries.
+    LOADSTAGE_DECOMPRESS,
+    /// Parsing in BeginLoad().
+    LOADSTAGE_BEGINLOAD,
+    /// Finishing in EndLoad().
+    LOADSTAGE_ENDLOAD,
+    /// Creating GPU objects and uploading their data.
+    LOADSTAGE_UPLOAD,
+    MAX_LOADSTAGES
+};
+
+/// Time spent in each stage of a resource load, in microseconds. Stages are exclusive: the reads made by BeginLoad() count as reading only.
+struct URHO3D_API LoadStageTimes
+{
+    /// Add the times of another load.
+    void Accumulate(const LoadStageTimes& rhs);
+    /// Return the sum of all stages.
+    long long GetTotal() const;
+
+    /// Time per stage.
+    long long usec_[MAX_LOADSTAGES]{};
+};
+
+namespace Detail
+{
+
+/// Number of active load timing scopes on all threads. Read inline by the stage timers so that they cost one branch when nothing is recorded.
+extern URHO3D_API std::atomic<int> loadTimingScopes;
+
+}
+
+/// Direct the load stage timers of the current thread to a destination for the lifetime of the scope. Null destination records nothing. The previous destination is restored on destruction.
+class URHO3D_API LoadTimingScope
+{
+public:
+    /// Construct and set the destination.
+    explicit LoadTimingScope(LoadStageTimes* times);
+    /// Destruct and restore the previous destination.
+    ~LoadTimingScope();
+
+    /// Prevent copy construction.
+    LoadTimingScope(const LoadTimingScope& rhs) = delete;
+    /// Prevent assignment.
+    LoadTimingScope& operator =(const LoadTimingScope& rhs) = delete;
+
+private:
+    /// Previous destination.
+    LoadStageTimes* previous_;
+    /// Whether this scope changed the destination.
+    bool active_;
+};
+
+/// Time a stage of the resource load recorded on the current thread. Time spent in nested stage timers, including those of other resources loaded meanwhile, is subtracted.
+class URHO3D_API LoadStageTimer
+{
+public:
+    /// Construct and start timing if the current thread records load times.
+    explicit LoadStageTimer(LoadStage stage) :
+        stage_(stage)
+    {
+        if (Detail::loadTimingScopes.load(std::memory_order_relaxed))
+            Begin();
+    }
+
+    /// Destruct and add the elapsed time to the stage.
+    ~LoadStageTimer()
+    {
+        if (started_)
+            End();
+    }
+
+    /// Prevent copy construction.
+    LoadStageTimer(const LoadStageTimer& rhs) = delete;
+    /// Prevent assignment.
+    LoadStageTimer& operator =(const LoadStageTimer& rhs) = delete;
+
+private:
+    /// Start timing.
+    void Begin();
+    /// Stop timing and record.
+    void End();
+
+    /// Stage.
+    LoadStage stage_;
+    /// Started flag.
+    bool started_{};
+    /// Enclosing timer on the same thread.
+    LoadStageTimer* parent_{};
+    /// Start time in microseconds.
+    long long start_{};
+    /// Time spent in nested timers.
+    long long nested_{};
+};
+
+/// Return the name of a load stage.
+URHO3D_API const char* GetLoadStageName(LoadStage stage);
+
+}
@@ -31,7 +31,11 @@
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <ctime>
+#include <mutex>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -55,9 +59,274 @@ const char* logLevelPrefixes[] =
     nullptr
 };
 
+/// Number of messages the asynchronous queue can hold.
+static const unsigned LOG_QUEUE_SIZE = 4096;
+/// Longest time the logger thread sleeps before checking the queue again.
+static const unsigned LOG_THREAD_TIMEOUT_MSEC = 10;
+
 static Log* logInstance = nullptr;
 static bool threadErrorDisplayed = false;
 
+/// Return whether is executing in the main thread that owns the log. Threads running a context of their own queue their messages like worker threads.
+static bool IsLogThread()
+{
+    return Thread::IsMainThread() && !Thread::IsContextThread();
+}
+
+/// Log message queued for the logger thread.
+struct LogRecord
+{
+    /// Formatted message, or empty if deferred.
+    String message_;
+    /// Format string of a deferred message.
+    const char* format_{};
+    /// Arguments of a deferred message.
+    Variant args_[MAX_DEFERRED_LOG_ARGS];
+    /// Number of arguments.
+    unsigned numArgs_{};
+    /// Time of a deferred message.
+    time_t time_{};
+    /// Message level.
+    int level_{};
+    /// Raw message flag.
+    bool raw_{};
+    /// Error flag for raw messages.
+    bool error_{};
+    /// Whether to timestamp a deferred message.
+    bool timeStamp_{};
+    /// Whether the log event must be sent at the end of the frame.
+    bool sendEvent_{};
+};
+
+/// Bounded lock-free ring buffer of log messages with multiple producers and one consumer.
+class LogQueue
+{
+public:
+    /// Construct with a power of two capacity.
+    explicit LogQueue(unsigned capacity) :
+        slots_(new Slot[capacity]),
+        mask_(capacity - 1)
+    {
+        for (unsigned i = 0; i < capacity; ++i)
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Destruct.
+    ~LogQueue()
+    {
+        delete[] slots_;
+    }
+
+    /// Add a message. Return false if the queue is full. Called from any thread.
+    bool Push(LogRecord& record)
+    {
+        unsigned pos = pushPos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;)
+        {
+            slot = &slots_[pos & mask_];
+            unsigned sequence = slot->sequence_.load(std::memory_order_acquire);
+            int diff = (int)(sequence - pos);
+            if (diff == 0)
+            {
+                if (pushPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = pushPos_.load(std::memory_order_relaxed);
+        }
+
+        Swap(slot->record_, record);
+        slot->sequence_.store(pos + 1, std::memory_order_release);
+
+        // Wake up the logger thread only if it is idle, so that the producers do not normally touch a lock. The fence
+        // keeps the sleeping flag from being read before the message is published; Wait() has the matching fence
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCondition_.notify_one();
+        }
+        return true;
+    }
+
+    /// Remove the oldest message. Return false if the queue is empty. Called from the logger thread only.
+    bool Pop(LogRecord& record)
+    {
+        Slot& slot = slots_[popPos_ & mask_];
+        if ((int)(slot.sequence_.load(std::memory_order_acquire) - (popPos_ + 1)) < 0)
+            return false;
+
+        Swap(record, slot.record_);
+        slot.sequence_.store(popPos_ + mask_ + 1, std::memory_order_release);
+        ++popPos_;
+        return true;
+    }
+
+    /// Mark a popped message as written.
+    void MarkWritten() { written_.fetch_add(1, std::memory_order_release); }
+
+    /// Return whether all pushed messages have been written.
+    bool IsDrained() const { return written_.load(std::memory_order_acquire) == pushPos_.load(std::memory_order_acquire); }
+
+    /// Wait until a message is pushed or the timeout passes. Called from the logger thread only.
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        // Either the producer sees the flag set or this sees its message, so a wakeup cannot be lost
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (IsEmpty())
+            wakeCondition_.wait_for(lock, std::chrono::milliseconds(LOG_THREAD_TIMEOUT_MSEC));
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    /// Queue slot.
+    struct Slot
+    {
+        /// Sequence number that tells whether the slot is free or holds a message.
+        std::atomic<unsigned> sequence_;
+        /// Message.
+        LogRecord record_;
+    };
+
+    /// Swap the contents of two messages.
+    static void Swap(LogRecord& lhs, LogRecord& rhs)
+    {
+        lhs.message_.Swap(rhs.message_);
+        Urho3D::Swap(lhs.format_, rhs.format_);
+        for (unsigned i = 0; i < rhs.numArgs_ || i < lhs.numArgs_; ++i)
+        {
+            Variant temp(std::move(lhs.args_[i]));
+            lhs.args_[i] = std::move(rhs.args_[i]);
+            rhs.args_[i] = std::move(temp);
+        }
+        Urho3D::Swap(lhs.numArgs_, rhs.numArgs_);
+        Urho3D::Swap(lhs.time_, rhs.time_);
+        Urho3D::Swap(lhs.level_, rhs.level_);
+        Urho3D::Swap(lhs.raw_, rhs.raw_);
+        Urho3D::Swap(lhs.error_, rhs.error_);
+        Urho3D::Swap(lhs.timeStamp_, rhs.timeStamp_);
+        Urho3D::Swap(lhs.sendEvent_, rhs.sendEvent_);
+    }
+
+    /// Return whether the next slot to pop is empty.
+    bool IsEmpty() const
+    {
+        return (int)(slots_[popPos_ & mask_].sequence_.load(std::memory_order_acquire) - (popPos_ + 1)) < 0;
+    }
+
+    /// Slots.
+    Slot* slots_;
+    /// Capacity - 1.
+    unsigned mask_;
+    /// Next push position.
+    std::atomic<unsigned> pushPos_{};
+    /// Number of messages written by the logger thread.
+    std::atomic<unsigned> written_{};
+    /// Next pop position.
+    unsigned popPos_{};
+    /// Whether the logger thread is waiting for messages.
+    std::atomic<bool> sleeping_{};
+    /// Mutex for waking up the logger thread.
+    std::mutex wakeMutex_;
+    /// Condition for waking up the logger thread.
+    std::condition_variable wakeCondition_;
+};
+
+/// Thread that writes the queued log messages.
+class LogThread : public Thread
+{
+public:
+    /// Construct.
+    explicit LogThread(Log* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Write messages until stopped.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->ProcessQueue())
+                owner_->queue_->Wait();
+        }
+
+        owner_->ProcessQueue();
+    }
+
+private:
+    /// Log subsystem.
+    Log* owner_;
+};
+
+/// Return a timestamp in the same format as Time::GetTimeStamp(), without using the shared buffer of ctime().
+static String FormatTimeStamp(time_t sysTime)
+{
+    static const char* dayNames[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char* monthNames[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    tm localTime{};
+#ifdef _WIN32
+    localtime_s(&localTime, &sysTime);
+#else
+    localtime_r(&sysTime, &localTime);
+#endif
+    char buffer[64];
+    snprintf(buffer, sizeof buffer, "%.3s %.3s%3d %.2d:%.2d:%.2d %d", dayNames[localTime.tm_wday], monthNames[localTime.tm_mon],
+        localTime.tm_mday, localTime.tm_hour, localTime.tm_min, localTime.tm_sec, 1900 + localTime.tm_year);
+    return String(buffer);
+}
+
+/// Return a message with the level prefix and optional timestamp.
+static String FormatMessage(int level, const String& message, bool timeStamp, time_t sysTime)
+{
+    String formattedMessage = logLevelPrefixes[level];
+    formattedMessage += ": " + message;
+    if (timeStamp)
+        formattedMessage = "[" + FormatTimeStamp(sysTime) + "] " + formattedMessage;
+    return formattedMessage;
+}
+
+/// Replace the "{}" placeholders of a format string with the arguments.
+static String FormatDeferred(const char* format, const Variant* args, unsigned numArgs)
+{
+    String ret;
+    unsigned argIndex = 0;
+    for (const char* c = format; *c; ++c)
+    {
+        if (c[0] == '{' && c[1] == '}' && argIndex < numArgs)
+        {
+            ret += args[argIndex++].ToString();
+            ++c;
+        }
+        else
+            ret += *c;
+    }
+    return ret;
+}
+
+bool LogRateLimiter::Allow(unsigned& suppressed)
+{
+    unsigned now = Time::GetSystemTime();
+    unsigned start = intervalStart_.load(std::memory_order_relaxed);
+    if (now - start >= intervalMSec_ && intervalStart_.compare_exchange_strong(start, now, std::memory_order_relaxed))
+        count_.store(0, std::memory_order_relaxed);
+
+    if (count_.fetch_add(1, std::memory_order_relaxed) < maxMessages_)
+    {
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
 Log::Log(Context* context) :
     Object(context),
 #ifdef _DEBUG
@@ -77,6 +346,9 @@ Log::Log(Context* context) :
 Log::~Log()
 {
     logInstance = nullptr;
+
+    // Write out the queued messages before the log file is closed
+    SetAsync(false);
 }
 
 void Log::Open(const String& fileName)
@@ -92,14 +364,17 @@ void Log::Open(const String& fileName)
             Close();
     }
 
-    logFile_ = new File(context_);
-    if (logFile_->Open(fileName, FILE_WRITE))
+    {
+        MutexLock lock(outputMutex_);
+        logFile_ = new File(context_);
+        if (!logFile_->Open(fileName, FILE_WRITE))
+            logFile_.Reset();
+    }
+
+    if (logFile_)
         Write(LOG_INFO, "Opened log file " + fileName);
     else
-    {
-        logFile_.Reset();
         Write(LOG_ERROR, "Failed to create log file " + fileName);
-    }
 #endif
 }
 
@@ -108,6 +383,9 @@ void Log::Close()
 #if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
     if (logFile_ && logFile_->IsOpen())
     {
+        Flush();
+
+        MutexLock lock(outputMutex_);
         logFile_->Close();
         logFile_.Reset();
     }
@@ -135,6 +413,51 @@ void Log::SetQuiet(bool quiet)
     quiet_ = quiet;
 }
 
+void Log::SetAsync(bool enable)
+{
+    // On mobile platforms the messages go to the system log, which is already buffered
+#if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
+    if (enable == IsAsync())
+        return;
+
+    if (enable)
+    {
+        queue_ = new LogQueue(LOG_QUEUE_SIZE);
+        thread_ = new LogThread(this);
+        if (!thread_->Run())
+        {
+            thread_.Reset();
+            queue_.Reset();
+            URHO3D_LOGERROR("Failed to start logger thread");
+        }
+    }
+    else
+    {
+        thread_->Stop();
+        thread_.Reset();
+        queue_.Reset();
+    }
+#endif
+}
+
+void Log::Flush()
+{
+    if (queue_)
+    {
+        while (!queue_->IsDrained())
+            Time::Sleep(1);
+    }
+
+    MutexLock lock(outputMutex_);
+    if (logFile_)
+        logFile_->Flush();
+}
+
+bool Log::IsLevelEnabled(int level)
+{
+    return logInstance && level >= logInstance->level_ && level < LOG_NONE;
+}
+
 void Log::Write(int level, const String& message)
 {
     // Special case for LOG_RAW level
@@ -148,8 +471,30 @@ void Log::Write(int level, const String& message)
     if (level < LOG_TRACE || level >= LOG_NONE)
         return;
 
+    // In asynchronous mode every thread formats the message and queues it for the logger thread
+    if (logInstance && logInstance->queue_)
+    {
+        bool mainThread = IsLogThread();
+        if (logInstance->level_ > level || (mainThread && logInstance->inWrite_))
+            return;
+
+        LogRecord record;
+        record.message_ = FormatMessage(level, message, logInstance->timeStamp_, time(nullptr));
+        record.level_ = level;
+        record.sendEvent_ = !mainThread;
+        String formattedMessage = mainThread ? record.message_ : String::EMPTY;
+        logInstance->Enqueue(record);
+
+        if (mainThread)
+        {
+            logInstance->lastMessage_ = message;
+            logInstance->SendMessageEvent(formattedMessage, level);
+        }
+        return;
+    }
+
     // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    if (!IsLogThread())
     {
         if (logInstance)
         {
@@ -164,51 +509,46 @@ void Log::Write(int level, const String& message)
     if (!logInstance || logInstance->level_ > level || logInstance->inWrite_)
         return;
 
-    String formattedMessage = logLevelPrefixes[level];
-    formattedMessage += ": " + message;
+    String formattedMessage = FormatMessage(level, message, logInstance->timeStamp_, time(nullptr));
     logInstance->lastMessage_ = message;
 
-    if (logInstance->timeStamp_)
-        formattedMessage = "[" + Time::GetTimeStamp() + "] " + formattedMessage;
-
 #if defined(__ANDROID__)
     int androidLevel = ANDROID_LOG_VERBOSE + level;
     __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
 #elif defined(IOS) || defined(TVOS)
     SDL_IOS_LogMessage(message.CString());
-#else
-    if (logInstance->quiet_)
-    {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (level == LOG_ERROR)
-            PrintUnicodeLine(formattedMessage, true);
-    }
-    else
-        PrintUnicodeLine(formattedMessage, level == LOG_ERROR);
 #endif
 
-    if (logInstance->logFile_)
-    {
-        logInstance->logFile_->WriteLine(formattedMessage);
-        logInstance->logFile_->Flush();
-    }
-
-    logInstance->inWrite_ = true;
-
-    using namespace LogMessage;
-
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = formattedMessage;
-    eventData[P_LEVEL] = level;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
-
-    logInstance->inWrite_ = false;
+    logInstance->WriteOutput(formattedMessage, level, false, false);
+    logInstance->SendMessageEvent(formattedMessage, level);
 }
 
 void Log::WriteRaw(const String& message, bool error)
 {
+    if (logInstance && logInstance->queue_)
+    {
+        bool mainThread = IsLogThread();
+        if (mainThread && logInstance->inWrite_)
+            return;
+
+        LogRecord record;
+        record.message_ = message;
+        record.level_ = LOG_RAW;
+        record.raw_ = true;
+        record.error_ = error;
+        record.sendEvent_ = !mainThread;
+        logInstance->Enqueue(record);
+
+        if (mainThread)
+        {
+            logInstance->lastMessage_ = message;
+            logInstance->SendMessageEvent(message, error ? LOG_ERROR : LOG_INFO);
+        }
+        return;
+    }
+
     // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    if (!IsLogThread())
     {
         if (logInstance)
         {
@@ -235,39 +575,142 @@ void Log::WriteRaw(const String& message, bool error)
         __android_log_print(error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "Urho3D", "%s", message.CString());
 #elif defined(IOS) || defined(TVOS)
     SDL_IOS_LogMessage(message.CString());
-#else
-    if (logInstance->quiet_)
+#endif
+
+    logInstance->WriteOutput(message, LOG_RAW, true, error);
+    logInstance->SendMessageEvent(message, error ? LOG_ERROR : LOG_INFO);
+}
+
+void Log::WriteDeferredValues(int level, const char* format, const Variant* args, unsigned numArgs)
+{
+    if (!logInstance || !format)
+        return;
+
+    if (!logInstance->queue_)
     {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (error)
-            PrintUnicode(message, true);
+        Write(level, FormatDeferred(format, args, numArgs));
+        return;
     }
+
+    if (IsLogThread() && logInstance->inWrite_)
+        return;
+
+    LogRecord record;
+    record.format_ = format;
+    for (unsigned i = 0; i < numArgs; ++i)
+        record.args_[i] = args[i];
+    record.numArgs_ = numArgs;
+    record.time_ = time(nullptr);
+    record.level_ = level;
+    record.timeStamp_ = logInstance->timeStamp_;
+    record.sendEvent_ = true;
+    logInstance->Enqueue(record);
+}
+
+void Log::WriteLimited(int level, const String& message, unsigned suppressed)
+{
+    if (suppressed)
+        Write(level, message + " (" + String(suppressed) + " similar messages suppressed)");
     else
-        PrintUnicode(message, error);
+        Write(level, message);
+}
+
+void Log::Enqueue(LogRecord& record)
+{
+    // Messages are not dropped on a burst, instead the callers are throttled to the speed of the output
+    while (!queue_->Push(record))
+        Time::Sleep(0);
+}
+
+void Log::WriteOutput(const String& formattedMessage, int level, bool raw, bool error)
+{
+#if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
+    if (!raw)
+        error = level == LOG_ERROR;
+
+    // If in quiet mode, still print the error message to the standard error stream
+    if (!quiet_ || error)
+    {
+        if (raw)
+            PrintUnicode(formattedMessage, error);
+        else
+            PrintUnicodeLine(formattedMessage, error);
+    }
 #endif
 
-    if (logInstance->logFile_)
+    if (logFile_)
     {
-        logInstance->logFile_->Write(message.CString(), message.Length());
-        logInstance->logFile_->Flush();
+        if (raw)
+            logFile_->Write(formattedMessage.CString(), formattedMessage.Length());
+        else
+            logFile_->WriteLine(formattedMessage);
+
+        // The logger thread flushes once per batch of messages instead
+        if (!queue_)
+            logFile_->Flush();
     }
+}
 
-    logInstance->inWrite_ = true;
+void Log::SendMessageEvent(const String& formattedMessage, int level)
+{
+    // Skip filling the event data when nobody listens, which is the common case in release builds
+    if (!context_->GetEventReceivers(E_LOGMESSAGE) && !context_->GetEventReceivers(this, E_LOGMESSAGE))
+        return;
+
+    inWrite_ = true;
 
     using namespace LogMessage;
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = message;
-    eventData[P_LEVEL] = error ? LOG_ERROR : LOG_INFO;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_MESSAGE] = formattedMessage;
+    eventData[P_LEVEL] = level;
+    SendEvent(E_LOGMESSAGE, eventData);
 
-    logInstance->inWrite_ = false;
+    inWrite_ = false;
+}
+
+bool Log::ProcessQueue()
+{
+    LogRecord record;
+    bool written = false;
+
+    MutexLock lock(outputMutex_);
+
+    while (queue_->Pop(record))
+    {
+        if (record.format_)
+        {
+            record.message_ = FormatMessage(record.level_, FormatDeferred(record.format_, record.args_, record.numArgs_),
+                record.timeStamp_, record.time_);
+            record.format_ = nullptr;
+            for (unsigned i = 0; i < record.numArgs_; ++i)
+                record.args_[i].Clear();
+            record.numArgs_ = 0;
+        }
+
+        WriteOutput(record.message_, record.level_, record.raw_, record.error_);
+
+        if (record.sendEvent_)
+        {
+            MutexLock eventLock(logMutex_);
+            threadMessages_.Push(StoredLogMessage(record.message_, record.level_, record.error_));
+            threadMessages_.Back().written_ = true;
+        }
+
+        queue_->MarkWritten();
+        written = true;
+    }
+
+    if (written && logFile_)
+        logFile_->Flush();
+
+    return written;
 }
 
 void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
 {
     // If the MainThreadID is not valid, processing this loop can potentially be endless
-    if (!Thread::IsMainThread())
+    if (!IsLogThread())
     {
         if (!threadErrorDisplayed)
         {
@@ -277,19 +720,29 @@ void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
         return;
     }
 
-    MutexLock lock(logMutex_);
+    // Take the messages accumulated from other threads (if any), so that the logger thread is not blocked while the events are sent
+    List<StoredLogMessage> messages;
+    {
+        MutexLock lock(logMutex_);
+        messages.Swap(threadMessages_);
+    }
 
-    // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.Empty())
+    while (!messages.Empty())
     {
-        const StoredLogMessage& stored = threadMessages_.Front();
+        const StoredLogMessage& stored = messages.Front();
 
-        if (stored.level_ != LOG_RAW)
+        if (stored.written_)
+        {
+            // Already written by the logger thread, only the event is left
+            lastMessage_ = stored.message_;
+            SendMessageEvent(stored.message_, stored.level_ != LOG_RAW ? stored.level_ : (stored.error_ ? LOG_ERROR : LOG_INFO));
+        }
+        else if (stored.level_ != LOG_RAW)
             Write(stored.level_, stored.message_);
         else
             WriteRaw(stored.message_, stored.error_);
 
-        threadMessages_.PopFront();
+        messages.PopFront();
     }
 }
 
@@ -26,6 +26,9 @@
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/StringUtils.h"
+#include "../Core/Variant.h"
+
+#include <atomic>
 
 namespace Urho3D
 {
@@ -45,7 +48,13 @@ static const int LOG_ERROR = 4;
 /// Disable all log messages.
 static const int LOG_NONE = 5;
 
+/// Maximum number of arguments of a deferred log message.
+static const unsigned MAX_DEFERRED_LOG_ARGS = 4;
+
 class File;
+class LogQueue;
+class LogThread;
+struct LogRecord;
 
 /// Stored log message from another thread.
 struct StoredLogMessage
@@ -67,6 +76,35 @@ struct StoredLogMessage
     int level_{};
     /// Error flag for raw messages.
     bool error_{};
+    /// Whether the message was already written to the output by the logger thread, and only the log event is pending.
+    bool written_{};
+};
+
+/// Per call site limit for the number of log messages in a time interval. Used by the URHO3D_LOG*_LIMITED macros.
+class URHO3D_API LogRateLimiter
+{
+public:
+    /// Construct with the maximum number of messages per interval.
+    explicit LogRateLimiter(unsigned maxMessages = 10, unsigned intervalMSec = 1000) :
+        maxMessages_(maxMessages),
+        intervalMSec_(intervalMSec)
+    {
+    }
+
+    /// Return whether a message may be written now. Thread-safe. If allowed, the number of messages suppressed since the previous allowed one is returned in suppressed.
+    bool Allow(unsigned& suppressed);
+
+private:
+    /// Maximum number of messages per interval.
+    unsigned maxMessages_;
+    /// Interval length in milliseconds.
+    unsigned intervalMSec_;
+    /// Start time of the current interval.
+    std::atomic<unsigned> intervalStart_{};
+    /// Messages written or suppressed in the current interval.
+    std::atomic<unsigned> count_{};
+    /// Messages suppressed since the last written message.
+    std::atomic<unsigned> suppressed_{};
 };
 
 /// Logging subsystem.
@@ -90,6 +128,10 @@ public:
     void SetTimeStamp(bool enable);
     /// Set quiet mode ie. only print error entries to standard error stream (which is normally redirected to console also). Output to log file is not affected by this mode.
     void SetQuiet(bool quiet);
+    /// Set whether to write the output on a dedicated logger thread. Messages from all threads are then queued to a lock-free ring buffer, and the log file is no longer flushed after each message.
+    void SetAsync(bool enable);
+    /// Wait until all queued messages have been written and flush the log file.
+    void Flush();
 
     /// Return logging level.
     int GetLevel() const { return level_; }
@@ -103,12 +145,40 @@ public:
     /// Return whether log is in quiet mode (only errors printed to standard error stream).
     bool IsQuiet() const { return quiet_; }
 
+    /// Return whether the output is written on a dedicated logger thread.
+    bool IsAsync() const { return queue_.Get() != nullptr; }
+
     /// Write to the log. If logging level is higher than the level of the message, the message is ignored.
     static void Write(int level, const String& message);
     /// Write raw output to the log.
     static void WriteRaw(const String& message, bool error = false);
+    /// Write a message that has "{}" placeholders for the arguments. In asynchronous mode the formatting is deferred to the logger thread, and the log event is sent at the end of the frame. The format string must stay valid for the rest of the program, for example a string literal.
+    template <class... Args> static void WriteDeferred(int level, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_DEFERRED_LOG_ARGS, "Too many deferred log message arguments");
+        if (!IsLevelEnabled(level))
+            return;
+        const Variant values[] = {Variant(args)..., Variant::EMPTY};
+        WriteDeferredValues(level, format, values, sizeof...(Args));
+    }
+    /// Write a message subject to a call site rate limit. The number of suppressed messages is appended if non-zero.
+    static void WriteLimited(int level, const String& message, unsigned suppressed);
+    /// Return whether messages of a level would be written.
+    static bool IsLevelEnabled(int level);
 
 private:
+    friend class LogThread;
+
+    /// Write a deferred message with the argument values.
+    static void WriteDeferredValues(int level, const char* format, const Variant* args, unsigned numArgs);
+    /// Queue a message for the logger thread. If the queue is full, wait until there is room.
+    void Enqueue(LogRecord& record);
+    /// Write formatted output to the standard streams and the log file.
+    void WriteOutput(const String& formattedMessage, int level, bool raw, bool error);
+    /// Send the log message event if anyone is listening.
+    void SendMessageEvent(const String& formattedMessage, int level);
+    /// Write the queued messages on the logger thread. Return whether any were written.
+    bool ProcessQueue();
     /// Handle end of frame. Process the threaded log messages.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
@@ -128,6 +198,12 @@ private:
     bool inWrite_;
     /// Quiet mode flag.
     bool quiet_;
+    /// Lock-free queue of messages for the logger thread. Null when not in asynchronous mode.
+    UniquePtr<LogQueue> queue_;
+    /// Logger thread.
+    UniquePtr<LogThread> thread_;
+    /// Mutex for changing the log file while the logger thread writes to it.
+    Mutex outputMutex_;
 };
 
 #ifdef URHO3D_LOGGING
@@ -143,6 +219,15 @@ private:
 #define URHO3D_LOGWARNINGF(format, ...) Urho3D::Log::Write(Urho3D::LOG_WARNING, Urho3D::ToString(format, ##__VA_ARGS__))
 #define URHO3D_LOGERRORF(format, ...) Urho3D::Log::Write(Urho3D::LOG_ERROR, Urho3D::ToString(format, ##__VA_ARGS__))
 #define URHO3D_LOGRAWF(format, ...) Urho3D::Log::WriteRaw(Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGDEFERRED(level, format, ...) Urho3D::Log::WriteDeferred(level, format, ##__VA_ARGS__)
+#define URHO3D_LOGLIMITED(level, message) do { \
+        static Urho3D::LogRateLimiter urhoLogLimiter; \
+        unsigned urhoLogSuppressed; \
+        if (Urho3D::Log::IsLevelEnabled(level) && urhoLogLimiter.Allow(urhoLogSuppressed)) \
+            Urho3D::Log::WriteLimited(level, message, urhoLogSuppressed); \
+    } while (false)
+#define URHO3D_LOGWARNING_LIMITED(message) URHO3D_LOGLIMITED(Urho3D::LOG_WARNING, message)
+#define URHO3D_LOGERROR_LIMITED(message) URHO3D_LOGLIMITED(Urho3D::LOG_ERROR, message)
 #else
 #define URHO3D_LOGTRACE(message) ((void)0)
 #define URHO3D_LOGDEBUG(message) ((void)0)
@@ -156,6 +241,10 @@ private:
 #define URHO3D_LOGWARNINGF(...) ((void)0)
 #define URHO3D_LOGERRORF(...) ((void)0)
 #define URHO3D_LOGRAWF(...) ((void)0)
+#define URHO3D_LOGDEFERRED(...) ((void)0)
+#define URHO3D_LOGLIMITED(level, message) ((void)0)
+#define URHO3D_LOGWARNING_LIMITED(message) ((void)0)
+#define URHO3D_LOGERROR_LIMITED(message) ((void)0)
 #endif
 
 }
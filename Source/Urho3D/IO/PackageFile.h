@@ -36,6 +36,8 @@ struct PackageEntry
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
+    /// Whether the file data is stored in LZ4 compressed blocks.
+    bool compressed_;
 };
 
 /// Stores files of a directory tree sequentially for convenient access.
@@ -79,9 +81,15 @@ public:
     /// Return checksum of the package file contents.
     unsigned GetChecksum() const { return checksum_; }
 
-    /// Return whether the files are compressed.
+    /// Return whether any of the files are compressed.
     bool IsCompressed() const { return compressed_; }
 
+    /// Set whether files opened from the package read their data through a memory mapping instead of buffered file IO.
+    void SetMemoryMapped(bool enable) { memoryMapped_ = enable; }
+
+    /// Return whether files opened from the package are memory mapped.
+    bool IsMemoryMapped() const { return memoryMapped_; }
+
     /// Return list of file names in the package.
     const Vector<String> GetEntryNames() const { return entries_.Keys(); }
 
@@ -100,6 +108,8 @@ private:
     unsigned checksum_;
     /// Compressed flag.
     bool compressed_;
+    /// Memory mapped file access flag.
+    bool memoryMapped_;
 };
 
 }
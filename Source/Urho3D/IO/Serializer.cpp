@@ -30,6 +30,8 @@ namespace Urho3D
 {
 
 static const float q = 32767.0f;
+static const float compactQ = 1023.0f;
+static const float sqrt2 = 1.41421356f;
 
 Serializer::~Serializer() = default;
 
@@ -151,6 +153,33 @@ bool Serializer::WritePackedQuaternion(const Quaternion& value)
     return Write(&coords[0], sizeof coords) == sizeof coords;
 }
 
+bool Serializer::WriteCompactQuaternion(const Quaternion& value)
+{
+    Quaternion norm = value.Normalized();
+    float components[4] = { norm.w_, norm.x_, norm.y_, norm.z_ };
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // The largest component is reconstructed from the others, so flip the sign to make it positive. The other components
+    // are then within +-1/sqrt(2)
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    unsigned packed = largest;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float normalized = Clamp(components[i] * sign * sqrt2 * 0.5f + 0.5f, 0.0f, 1.0f);
+        packed = (packed << 10u) | (unsigned)Round(normalized * compactQ);
+    }
+
+    return WriteUInt(packed);
+}
+
 bool Serializer::WriteMatrix3(const Matrix3& value)
 {
     return Write(value.Data(), sizeof value) == sizeof value;
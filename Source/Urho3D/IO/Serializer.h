@@ -92,6 +92,8 @@ public:
     bool WriteQuaternion(const Quaternion& value);
     /// Write a quaternion with each component packed in 16 bits.
     bool WritePackedQuaternion(const Quaternion& value);
+    /// Write a quaternion packed into 32 bits as the index of the largest component and the three smallest components in 10 bits each.
+    bool WriteCompactQuaternion(const Quaternion& value);
     /// Write a Matrix3.
     bool WriteMatrix3(const Matrix3& value);
     /// Write a Matrix3x4.
@@ -351,6 +351,8 @@ void JoystickState::Reset()
 
 Input::Input(Context* context) :
     Object(context),
+    rawInputBufferSize_(0),
+    numDroppedRawInputEvents_(0),
     mouseButtonDown_(0),
     mouseButtonPress_(0),
     lastVisibleMousePosition_(MOUSE_POSITION_OFFSCREEN),
@@ -372,6 +374,8 @@ Input::Input(Context* context) :
     emscriptenExitingPointerLock_(false),
 #endif
     touchEmulation_(false),
+    coalesceMoveEvents_(false),
+    mouseMovePending_(false),
     inputFocus_(false),
     minimized_(false),
     focusedThisFrame_(false),
@@ -418,6 +422,9 @@ void Input::Update()
     while (SDL_PollEvent(&evt))
         HandleSDLEvent(&evt);
 
+    // Send the movement held back since the last key or button event
+    FlushMoveEvents();
+
     if (suppressNextMouseMove_ && (mouseMove_ != IntVector2::ZERO || mouseMoved))
         UnsuppressMouseMove();
 #endif
@@ -1209,6 +1216,24 @@ void Input::SetTouchEmulation(bool enable)
 #endif
 }
 
+void Input::SetCoalesceMoveEvents(bool enable)
+{
+    if (enable != coalesceMoveEvents_)
+    {
+        if (!enable)
+            FlushMoveEvents();
+        coalesceMoveEvents_ = enable;
+    }
+}
+
+void Input::SetRawInputBufferSize(unsigned size)
+{
+    rawInputBufferSize_ = size;
+    if (rawInputEvents_.Size() > size)
+        rawInputEvents_.Resize(size);
+    rawInputEvents_.Reserve(size);
+}
+
 bool Input::RecordGesture()
 {
     // If have no touch devices, fail
@@ -1576,6 +1601,8 @@ void Input::ResetInputAccumulation()
         for (unsigned j = 0; j < i->second_.buttonPress_.Size(); ++j)
             i->second_.buttonPress_[j] = false;
     }
+    rawInputEvents_.Clear();
+    numDroppedRawInputEvents_ = 0;
 
     // Reset touch delta movement
     for (HashMap<int, TouchState>::Iterator i = touches_.Begin(); i != touches_.End(); ++i)
@@ -1651,6 +1678,11 @@ void Input::ResetState()
     mouseMove_ = IntVector2::ZERO;
     mouseMoveWheel_ = 0;
     mouseButtonPress_ = MOUSEB_NONE;
+
+    // Movement held back by coalescing no longer applies to the reset state
+    mouseMovePending_ = false;
+    pendingMouseMove_ = IntVector2::ZERO;
+    pendingJoystickAxisMoves_.Clear();
 }
 
 void Input::ResetTouches()
@@ -1669,6 +1701,7 @@ void Input::ResetTouches()
     }
 
     touches_.Clear();
+    pendingTouchMoves_.Clear();
     touchIDMap_.Clear();
     availableTouchIDs_.Clear();
     for (int i = 0; i < TOUCHID_MAX; i++)
@@ -1856,6 +1889,103 @@ void Input::UnsuppressMouseMove()
     lastMousePosition_ = GetMousePosition();
 }
 
+void Input::FlushMoveEvents()
+{
+    if (mouseMovePending_)
+    {
+        using namespace MouseMove;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_X] = (int)(pendingMousePosition_.x_ * inputScale_.x_);
+        eventData[P_Y] = (int)(pendingMousePosition_.y_ * inputScale_.y_);
+        // Scale the summed movement once, which is more accurate than scaling each message
+        eventData[P_DX] = (int)(pendingMouseMove_.x_ * inputScale_.x_);
+        eventData[P_DY] = (int)(pendingMouseMove_.y_ * inputScale_.y_);
+        eventData[P_BUTTONS] = (unsigned)mouseButtonDown_;
+        eventData[P_QUALIFIERS] = (unsigned)GetQualifiers();
+
+        mouseMovePending_ = false;
+        pendingMouseMove_ = IntVector2::ZERO;
+        SendEvent(E_MOUSEMOVE, eventData);
+    }
+
+    if (!pendingTouchMoves_.Empty())
+    {
+        using namespace TouchMove;
+
+        // Swap out the pending moves in case an event handler causes more input to be processed
+        HashMap<int, Vector2> touchMoves;
+        touchMoves.Swap(pendingTouchMoves_);
+        for (HashMap<int, Vector2>::ConstIterator i = touchMoves.Begin(); i != touchMoves.End(); ++i)
+        {
+            HashMap<int, TouchState>::ConstIterator j = touches_.Find(i->first_);
+            if (j == touches_.End())
+                continue;
+
+            const TouchState& state = j->second_;
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_TOUCHID] = state.touchID_;
+            eventData[P_X] = state.position_.x_;
+            eventData[P_Y] = state.position_.y_;
+            eventData[P_DX] = (int)i->second_.x_;
+            eventData[P_DY] = (int)i->second_.y_;
+            eventData[P_PRESSURE] = state.pressure_;
+            SendEvent(E_TOUCHMOVE, eventData);
+        }
+    }
+
+    if (!pendingJoystickAxisMoves_.Empty())
+    {
+        PODVector<Pair<SDL_JoystickID, unsigned> > axisMoves;
+        axisMoves.Swap(pendingJoystickAxisMoves_);
+        for (unsigned i = 0; i < axisMoves.Size(); ++i)
+        {
+            JoystickState* state = GetJoystick(axisMoves[i].first_);
+            if (state && axisMoves[i].second_ < state->axes_.Size())
+                SendJoystickAxisMove(axisMoves[i].first_, axisMoves[i].second_, state->axes_[axisMoves[i].second_]);
+        }
+    }
+}
+
+void Input::QueueJoystickAxisMove(SDL_JoystickID joystickID, unsigned axis)
+{
+    Pair<SDL_JoystickID, unsigned> axisMove(joystickID, axis);
+    if (!pendingJoystickAxisMoves_.Contains(axisMove))
+        pendingJoystickAxisMoves_.Push(axisMove);
+}
+
+void Input::SendJoystickAxisMove(SDL_JoystickID joystickID, unsigned axis, float position)
+{
+    using namespace JoystickAxisMove;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_JOYSTICKID] = joystickID;
+    eventData[P_AXIS] = axis;
+    eventData[P_POSITION] = position;
+    SendEvent(E_JOYSTICKAXISMOVE, eventData);
+}
+
+void Input::AddRawInputEvent(RawInputType type, unsigned timestamp, int id, int index, const IntVector2& position,
+    const IntVector2& delta, float value)
+{
+    if (rawInputEvents_.Size() >= rawInputBufferSize_)
+    {
+        if (rawInputBufferSize_)
+            ++numDroppedRawInputEvents_;
+        return;
+    }
+
+    RawInputEvent event;
+    event.type_ = type;
+    event.timestamp_ = timestamp;
+    event.id_ = id;
+    event.index_ = index;
+    event.position_ = position;
+    event.delta_ = delta;
+    event.value_ = value;
+    rawInputEvents_.Push(event);
+}
+
 void Input::HandleSDLEvent(void* sdlEvent)
 {
     SDL_Event& evt = *static_cast<SDL_Event*>(sdlEvent);
@@ -1883,11 +2013,13 @@ void Input::HandleSDLEvent(void* sdlEvent)
             return;
     }
 
-    // Possibility for custom handling or suppression of default handling for the SDL event
+    // Possibility for custom handling or suppression of default handling for the SDL event. Skip building the event data
+    // when nobody listens, as this is done for every operating system message
+    if (HasEventReceivers(E_SDLRAWINPUT))
     {
         using namespace SDLRawInput;
 
-        VariantMap eventData = GetEventDataMap();
+        VariantMap& eventData = GetEventDataMap();
         eventData[P_SDLEVENT] = &evt;
         eventData[P_CONSUMED] = false;
         SendEvent(E_SDLRAWINPUT, eventData);
@@ -1896,14 +2028,29 @@ void Input::HandleSDLEvent(void* sdlEvent)
             return;
     }
 
+    // Coalesced movement must be sent before any other event so that the event order stays consistent
+    if (coalesceMoveEvents_ && evt.type != SDL_MOUSEMOTION && evt.type != SDL_FINGERMOTION && evt.type != SDL_JOYAXISMOTION &&
+        evt.type != SDL_CONTROLLERAXISMOTION)
+        FlushMoveEvents();
+
     switch (evt.type)
     {
     case SDL_KEYDOWN:
-        SetKey(ConvertSDLKeyCode(evt.key.keysym.sym, evt.key.keysym.scancode), (Scancode)evt.key.keysym.scancode, true);
+        {
+            Key key = ConvertSDLKeyCode(evt.key.keysym.sym, evt.key.keysym.scancode);
+            AddRawInputEvent(RAWINPUT_KEYDOWN, evt.key.timestamp, key, evt.key.keysym.scancode, IntVector2::ZERO, IntVector2::ZERO,
+                0.0f);
+            SetKey(key, (Scancode)evt.key.keysym.scancode, true);
+        }
         break;
 
     case SDL_KEYUP:
-        SetKey(ConvertSDLKeyCode(evt.key.keysym.sym, evt.key.keysym.scancode), (Scancode)evt.key.keysym.scancode, false);
+        {
+            Key key = ConvertSDLKeyCode(evt.key.keysym.sym, evt.key.keysym.scancode);
+            AddRawInputEvent(RAWINPUT_KEYUP, evt.key.timestamp, key, evt.key.keysym.scancode, IntVector2::ZERO, IntVector2::ZERO,
+                0.0f);
+            SetKey(key, (Scancode)evt.key.keysym.scancode, false);
+        }
         break;
 
     case SDL_TEXTINPUT:
@@ -1932,6 +2079,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
         if (!touchEmulation_)
         {
             const auto mouseButton = static_cast<MouseButton>(1u << (evt.button.button - 1u));  // NOLINT(misc-misplaced-widening-cast)
+            AddRawInputEvent(RAWINPUT_MOUSEBUTTONDOWN, evt.button.timestamp, mouseButton, 0, IntVector2((int)(evt.button.x *
+                inputScale_.x_), (int)(evt.button.y * inputScale_.y_)), IntVector2::ZERO, 0.0f);
             SetMouseButton(mouseButton, true);
         }
         else
@@ -1958,6 +2107,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
         if (!touchEmulation_)
         {
             const auto mouseButton = static_cast<MouseButton>(1u << (evt.button.button - 1u));  // NOLINT(misc-misplaced-widening-cast)
+            AddRawInputEvent(RAWINPUT_MOUSEBUTTONUP, evt.button.timestamp, mouseButton, 0, IntVector2((int)(evt.button.x *
+                inputScale_.x_), (int)(evt.button.y * inputScale_.y_)), IntVector2::ZERO, 0.0f);
             SetMouseButton(mouseButton, false);
         }
         else
@@ -2000,7 +2151,21 @@ void Input::HandleSDLEvent(void* sdlEvent)
             mouseMove_.y_ += evt.motion.yrel;
             mouseMoveScaled_ = false;
 
-            if (!suppressNextMouseMove_)
+            if (suppressNextMouseMove_)
+                break;
+
+            AddRawInputEvent(RAWINPUT_MOUSEMOVE, evt.motion.timestamp, 0, 0, IntVector2((int)(evt.motion.x * inputScale_.x_),
+                (int)(evt.motion.y * inputScale_.y_)), IntVector2((int)(evt.motion.xrel * inputScale_.x_),
+                (int)(evt.motion.yrel * inputScale_.y_)), 0.0f);
+
+            if (coalesceMoveEvents_)
+            {
+                pendingMouseMove_.x_ += evt.motion.xrel;
+                pendingMouseMove_.y_ += evt.motion.yrel;
+                pendingMousePosition_ = IntVector2(evt.motion.x, evt.motion.y);
+                mouseMovePending_ = true;
+            }
+            else
             {
                 using namespace MouseMove;
 
@@ -2038,7 +2203,11 @@ void Input::HandleSDLEvent(void* sdlEvent)
 
     case SDL_MOUSEWHEEL:
         if (!touchEmulation_)
+        {
+            AddRawInputEvent(RAWINPUT_MOUSEWHEEL, evt.wheel.timestamp, 0, 0, IntVector2::ZERO, IntVector2(evt.wheel.x, evt.wheel.y),
+                0.0f);
             SetMouseWheel(evt.wheel.y);
+        }
         break;
 
     case SDL_FINGERDOWN:
@@ -2052,6 +2221,9 @@ void Input::HandleSDLEvent(void* sdlEvent)
             state.delta_ = IntVector2::ZERO;
             state.pressure_ = evt.tfinger.pressure;
 
+            AddRawInputEvent(RAWINPUT_TOUCHBEGIN, evt.tfinger.timestamp, touchID, 0, state.position_, IntVector2::ZERO,
+                state.pressure_);
+
             using namespace TouchBegin;
 
             VariantMap& eventData = GetEventDataMap();
@@ -2073,6 +2245,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
             int touchID = GetTouchIndexFromID(evt.tfinger.fingerId & 0x7ffffffu);
             TouchState& state = touches_[touchID];
 
+            AddRawInputEvent(RAWINPUT_TOUCHEND, evt.tfinger.timestamp, touchID, 0, state.position_, IntVector2::ZERO, 0.0f);
+
             using namespace TouchEnd;
 
             VariantMap& eventData = GetEventDataMap();
@@ -2104,16 +2278,25 @@ void Input::HandleSDLEvent(void* sdlEvent)
             state.delta_ = state.position_ - state.lastPosition_;
             state.pressure_ = evt.tfinger.pressure;
 
-            using namespace TouchMove;
+            Vector2 delta(evt.tfinger.dx * graphics_->GetWidth(), evt.tfinger.dy * graphics_->GetHeight());
+            AddRawInputEvent(RAWINPUT_TOUCHMOVE, evt.tfinger.timestamp, touchID, 0, state.position_, IntVector2((int)delta.x_,
+                (int)delta.y_), state.pressure_);
 
-            VariantMap& eventData = GetEventDataMap();
-            eventData[P_TOUCHID] = touchID;
-            eventData[P_X] = state.position_.x_;
-            eventData[P_Y] = state.position_.y_;
-            eventData[P_DX] = (int)(evt.tfinger.dx * graphics_->GetWidth());
-            eventData[P_DY] = (int)(evt.tfinger.dy * graphics_->GetHeight());
-            eventData[P_PRESSURE] = state.pressure_;
-            SendEvent(E_TOUCHMOVE, eventData);
+            if (coalesceMoveEvents_)
+                pendingTouchMoves_[touchID] += delta;
+            else
+            {
+                using namespace TouchMove;
+
+                VariantMap& eventData = GetEventDataMap();
+                eventData[P_TOUCHID] = touchID;
+                eventData[P_X] = state.position_.x_;
+                eventData[P_Y] = state.position_.y_;
+                eventData[P_DX] = (int)delta.x_;
+                eventData[P_DY] = (int)delta.y_;
+                eventData[P_PRESSURE] = state.pressure_;
+                SendEvent(E_TOUCHMOVE, eventData);
+            }
 
             // Finger touch may move the mouse cursor. Suppress next mouse move when cursor hidden to prevent jumps
             if (!mouseVisible_)
@@ -2202,6 +2385,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
                 {
                     state.buttons_[button] = true;
                     state.buttonPress_[button] = true;
+                    AddRawInputEvent(RAWINPUT_JOYSTICKBUTTONDOWN, evt.jbutton.timestamp, joystickID, button, IntVector2::ZERO,
+                        IntVector2::ZERO, 0.0f);
                     SendEvent(E_JOYSTICKBUTTONDOWN, eventData);
                 }
             }
@@ -2226,6 +2411,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
                 {
                     if (!state.controller_)
                         state.buttons_[button] = false;
+                    AddRawInputEvent(RAWINPUT_JOYSTICKBUTTONUP, evt.jbutton.timestamp, joystickID, button, IntVector2::ZERO,
+                        IntVector2::ZERO, 0.0f);
                     SendEvent(E_JOYSTICKBUTTONUP, eventData);
                 }
             }
@@ -2234,26 +2421,20 @@ void Input::HandleSDLEvent(void* sdlEvent)
 
     case SDL_JOYAXISMOTION:
         {
-            using namespace JoystickAxisMove;
-
             SDL_JoystickID joystickID = evt.jaxis.which;
             JoystickState& state = joysticks_[joystickID];
 
-            if (!state.controller_)
+            // If the joystick is a controller, only use the controller axis mappings (we'll also get the controller event)
+            if (!state.controller_ && evt.jaxis.axis < state.axes_.Size())
             {
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_JOYSTICKID] = joystickID;
-                eventData[P_AXIS] = evt.jaxis.axis;
-                eventData[P_POSITION] = Clamp((float)evt.jaxis.value / 32767.0f, -1.0f, 1.0f);
-
-                if (evt.jaxis.axis < state.axes_.Size())
-                {
-                    // If the joystick is a controller, only use the controller axis mappings
-                    // (we'll also get the controller event)
-                    if (!state.controller_)
-                        state.axes_[evt.jaxis.axis] = eventData[P_POSITION].GetFloat();
-                    SendEvent(E_JOYSTICKAXISMOVE, eventData);
-                }
+                float position = Clamp((float)evt.jaxis.value / 32767.0f, -1.0f, 1.0f);
+                state.axes_[evt.jaxis.axis] = position;
+                AddRawInputEvent(RAWINPUT_JOYSTICKAXISMOVE, evt.jaxis.timestamp, joystickID, evt.jaxis.axis, IntVector2::ZERO,
+                    IntVector2::ZERO, position);
+                if (coalesceMoveEvents_)
+                    QueueJoystickAxisMove(joystickID, evt.jaxis.axis);
+                else
+                    SendJoystickAxisMove(joystickID, evt.jaxis.axis, position);
             }
         }
         break;
@@ -2273,6 +2454,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
             if (evt.jhat.hat < state.hats_.Size())
             {
                 state.hats_[evt.jhat.hat] = evt.jhat.value;
+                AddRawInputEvent(RAWINPUT_JOYSTICKHATMOVE, evt.jhat.timestamp, joystickID, evt.jhat.hat, IntVector2::ZERO,
+                    IntVector2::ZERO, (float)evt.jhat.value);
                 SendEvent(E_JOYSTICKHATMOVE, eventData);
             }
         }
@@ -2294,6 +2477,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
             {
                 state.buttons_[button] = true;
                 state.buttonPress_[button] = true;
+                AddRawInputEvent(RAWINPUT_JOYSTICKBUTTONDOWN, evt.cbutton.timestamp, joystickID, button, IntVector2::ZERO,
+                    IntVector2::ZERO, 0.0f);
                 SendEvent(E_JOYSTICKBUTTONDOWN, eventData);
             }
         }
@@ -2314,6 +2499,8 @@ void Input::HandleSDLEvent(void* sdlEvent)
             if (button < state.buttons_.Size())
             {
                 state.buttons_[button] = false;
+                AddRawInputEvent(RAWINPUT_JOYSTICKBUTTONUP, evt.cbutton.timestamp, joystickID, button, IntVector2::ZERO,
+                    IntVector2::ZERO, 0.0f);
                 SendEvent(E_JOYSTICKBUTTONUP, eventData);
             }
         }
@@ -2321,20 +2508,19 @@ void Input::HandleSDLEvent(void* sdlEvent)
 
     case SDL_CONTROLLERAXISMOTION:
         {
-            using namespace JoystickAxisMove;
-
             SDL_JoystickID joystickID = evt.caxis.which;
             JoystickState& state = joysticks_[joystickID];
 
-            VariantMap& eventData = GetEventDataMap();
-            eventData[P_JOYSTICKID] = joystickID;
-            eventData[P_AXIS] = evt.caxis.axis;
-            eventData[P_POSITION] = Clamp((float)evt.caxis.value / 32767.0f, -1.0f, 1.0f);
-
             if (evt.caxis.axis < state.axes_.Size())
             {
-                state.axes_[evt.caxis.axis] = eventData[P_POSITION].GetFloat();
-                SendEvent(E_JOYSTICKAXISMOVE, eventData);
+                float position = Clamp((float)evt.caxis.value / 32767.0f, -1.0f, 1.0f);
+                state.axes_[evt.caxis.axis] = position;
+                AddRawInputEvent(RAWINPUT_JOYSTICKAXISMOVE, evt.caxis.timestamp, joystickID, evt.caxis.axis, IntVector2::ZERO,
+                    IntVector2::ZERO, position);
+                if (coalesceMoveEvents_)
+                    QueueJoystickAxisMove(joystickID, evt.caxis.axis);
+                else
+                    SendJoystickAxisMove(joystickID, evt.caxis.axis, position);
             }
         }
         break;
@@ -51,6 +51,43 @@ class XMLFile;
 
 const IntVector2 MOUSE_POSITION_OFFSCREEN = IntVector2(M_MIN_INT, M_MIN_INT);
 
+/// Raw input event types.
+enum RawInputType
+{
+    RAWINPUT_KEYDOWN = 0,
+    RAWINPUT_KEYUP,
+    RAWINPUT_MOUSEBUTTONDOWN,
+    RAWINPUT_MOUSEBUTTONUP,
+    RAWINPUT_MOUSEMOVE,
+    RAWINPUT_MOUSEWHEEL,
+    RAWINPUT_TOUCHBEGIN,
+    RAWINPUT_TOUCHMOVE,
+    RAWINPUT_TOUCHEND,
+    RAWINPUT_JOYSTICKBUTTONDOWN,
+    RAWINPUT_JOYSTICKBUTTONUP,
+    RAWINPUT_JOYSTICKAXISMOVE,
+    RAWINPUT_JOYSTICKHATMOVE
+};
+
+/// Timestamped input event stored in the raw input buffer. Mouse and touch coordinates use the backbuffer (Graphics width/height) coordinates.
+struct RawInputEvent
+{
+    /// Event type.
+    RawInputType type_;
+    /// Operating system timestamp in milliseconds.
+    unsigned timestamp_;
+    /// Key, mouse button, touch ID or joystick ID depending on the type.
+    int id_;
+    /// Scancode for keys, or button, axis or hat index for joysticks.
+    int index_;
+    /// Mouse or touch position.
+    IntVector2 position_;
+    /// Mouse or touch movement, or mouse wheel movement in the Y component.
+    IntVector2 delta_;
+    /// Joystick axis position, hat position or touch pressure.
+    float value_;
+};
+
 /// %Input state for a finger touch.
 struct TouchState
 {
@@ -195,6 +232,10 @@ public:
     void SetScreenKeyboardVisible(bool enable);
     /// Set touch emulation by mouse. Only available on desktop platforms. When enabled, actual mouse events are no longer sent and the mouse cursor is forced visible.
     void SetTouchEmulation(bool enable);
+    /// Set whether to coalesce mouse, touch and joystick axis movement into at most one move event per mouse, touch and axis in each update, instead of one per operating system message. Key, button and touch begin/end events are still sent in order, preceded by the movement accumulated before them. Default false.
+    void SetCoalesceMoveEvents(bool enable);
+    /// Set the maximum number of timestamped input events buffered in each update for GetRawInputEvents(). Events beyond the limit are dropped. 0 (default) disables the buffer.
+    void SetRawInputBufferSize(unsigned size);
     /// Begin recording a touch gesture. Return true if successful. The E_GESTURERECORDED event (which contains the ID for the new gesture) will be sent when recording finishes.
     bool RecordGesture();
     /// Save all in-memory touch gestures. Return true if successful.
@@ -282,6 +323,15 @@ public:
     /// Return whether touch emulation is enabled.
     bool GetTouchEmulation() const { return touchEmulation_; }
 
+    /// Return whether move events are coalesced.
+    bool GetCoalesceMoveEvents() const { return coalesceMoveEvents_; }
+    /// Return the maximum number of buffered raw input events.
+    unsigned GetRawInputBufferSize() const { return rawInputBufferSize_; }
+    /// Return the timestamped input events of the last update in the order they were received. Empty unless the raw input buffer is enabled.
+    const PODVector<RawInputEvent>& GetRawInputEvents() const { return rawInputEvents_; }
+    /// Return the number of raw input events dropped in the last update because the buffer was full.
+    unsigned GetNumDroppedRawInputEvents() const { return numDroppedRawInputEvents_; }
+
     /// Return whether the operating system mouse cursor is visible.
     bool IsMouseVisible() const { return mouseVisible_; }
     /// Return whether the mouse is currently being grabbed by an operation.
@@ -341,6 +391,14 @@ private:
     void HandleScreenJoystickTouch(StringHash eventType, VariantMap& eventData);
     /// Handle SDL event.
     void HandleSDLEvent(void* sdlEvent);
+    /// Send the move events held back by coalescing.
+    void FlushMoveEvents();
+    /// Queue a joystick axis move event for coalescing.
+    void QueueJoystickAxisMove(SDL_JoystickID joystickID, unsigned axis);
+    /// Send a joystick axis move event.
+    void SendJoystickAxisMove(SDL_JoystickID joystickID, unsigned axis, float position);
+    /// Store an event in the raw input buffer if enabled.
+    void AddRawInputEvent(RawInputType type, unsigned timestamp, int id, int index, const IntVector2& position, const IntVector2& delta, float value);
 
 #ifndef __EMSCRIPTEN__
     /// Set SDL mouse mode relative.
@@ -378,6 +436,20 @@ private:
     String textInput_;
     /// Opened joysticks.
     HashMap<SDL_JoystickID, JoystickState> joysticks_;
+    /// Buffered raw input events of this update.
+    PODVector<RawInputEvent> rawInputEvents_;
+    /// Maximum number of buffered raw input events.
+    unsigned rawInputBufferSize_;
+    /// Number of raw input events dropped in this update.
+    unsigned numDroppedRawInputEvents_;
+    /// Coalesced mouse movement not yet sent as an event, without scaling.
+    IntVector2 pendingMouseMove_;
+    /// Mouse position of the latest coalesced mouse movement, without scaling.
+    IntVector2 pendingMousePosition_;
+    /// Coalesced touch movement not yet sent as events, in backbuffer coordinates.
+    HashMap<int, Vector2> pendingTouchMoves_;
+    /// Joystick ID and axis pairs with coalesced movement not yet sent as events.
+    PODVector<Pair<SDL_JoystickID, unsigned> > pendingJoystickAxisMoves_;
     /// Mouse buttons' down state.
     MouseButtonFlags mouseButtonDown_;
     /// Mouse buttons' pressed state.
@@ -414,6 +486,10 @@ private:
 #endif
     /// Touch emulation mode flag.
     bool touchEmulation_;
+    /// Move event coalescing flag.
+    bool coalesceMoveEvents_;
+    /// Coalesced mouse movement pending flag.
+    bool mouseMovePending_;
     /// Input focus flag.
     bool inputFocus_;
     /// Minimized flag.
@@ -0,0 +1,603 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/Log.h"
+#include "../LuaScript/LuaFFI.h"
+#include "../Math/Color.h"
+#include "../Math/Matrix3x4.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Vector4.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/RigidBody.h"
+#endif
+#include "../Scene/Node.h"
+
+extern "C"
+{
+#include <lauxlib.h>
+#include <lua.h>
+}
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+// The FFI structs declared in Lua must match the memory layout of the math classes
+static_assert(sizeof(Vector2) == 2 * sizeof(float), "Unexpected size of Vector2");
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Unexpected size of Vector3");
+static_assert(sizeof(Vector4) == 4 * sizeof(float), "Unexpected size of Vector4");
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Unexpected size of Quaternion");
+static_assert(sizeof(Color) == 4 * sizeof(float), "Unexpected size of Color");
+static_assert(sizeof(Matrix3x4) == 12 * sizeof(float), "Unexpected size of Matrix3x4");
+
+/// Return the object of a tolua++ userdata. LuaJIT passes a userdata to a void* FFI argument as its payload address, and the payload of a tolua++ userdata is the object pointer.
+template <class T> static T* FFIObject(void* userData)
+{
+    return userData ? static_cast<T*>(*static_cast<void**>(userData)) : nullptr;
+}
+
+static void NodeGetPosition(void* node, Vector3* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetPosition();
+}
+
+static void NodeSetPosition(void* node, const Vector3* position)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetPosition(*position);
+}
+
+static void NodeGetRotation(void* node, Quaternion* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetRotation();
+}
+
+static void NodeSetRotation(void* node, const Quaternion* rotation)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetRotation(*rotation);
+}
+
+static void NodeGetScale(void* node, Vector3* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetScale();
+}
+
+static void NodeSetScale(void* node, const Vector3* scale)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetScale(*scale);
+}
+
+static void NodeSetTransform(void* node, const Vector3* position, const Quaternion* rotation)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetTransform(*position, *rotation);
+}
+
+static void NodeGetWorldPosition(void* node, Vector3* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetWorldPosition();
+}
+
+static void NodeSetWorldPosition(void* node, const Vector3* position)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetWorldPosition(*position);
+}
+
+static void NodeGetWorldRotation(void* node, Quaternion* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetWorldRotation();
+}
+
+static void NodeSetWorldRotation(void* node, const Quaternion* rotation)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->SetWorldRotation(*rotation);
+}
+
+static void NodeGetWorldDirection(void* node, Vector3* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetWorldDirection();
+}
+
+static void NodeGetWorldTransform(void* node, Matrix3x4* out)
+{
+    if (Node* n = FFIObject<Node>(node))
+        *out = n->GetWorldTransform();
+}
+
+static void NodeTranslate(void* node, const Vector3* delta, int space)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->Translate(*delta, (TransformSpace)space);
+}
+
+static void NodeRotate(void* node, const Quaternion* delta, int space)
+{
+    if (Node* n = FFIObject<Node>(node))
+        n->Rotate(*delta, (TransformSpace)space);
+}
+
+#ifdef URHO3D_PHYSICS
+static void RigidBodyGetLinearVelocity(void* body, Vector3* out)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        *out = b->GetLinearVelocity();
+}
+
+static void RigidBodySetLinearVelocity(void* body, const Vector3* velocity)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        b->SetLinearVelocity(*velocity);
+}
+
+static void RigidBodyGetAngularVelocity(void* body, Vector3* out)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        *out = b->GetAngularVelocity();
+}
+
+static void RigidBodySetAngularVelocity(void* body, const Vector3* velocity)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        b->SetAngularVelocity(*velocity);
+}
+
+static void RigidBodyApplyForce(void* body, const Vector3* force)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        b->ApplyForce(*force);
+}
+
+static void RigidBodyApplyImpulse(void* body, const Vector3* impulse)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        b->ApplyImpulse(*impulse);
+}
+
+static void RigidBodyApplyTorque(void* body, const Vector3* torque)
+{
+    if (RigidBody* b = FFIObject<RigidBody>(body))
+        b->ApplyTorque(*torque);
+}
+#endif
+
+/// Lua side of the FFI module. Receives a table of the function pointers above as its argument.
+static const char* ffiModuleSource =
+R"LUA(-- Only LuaJIT preloads the FFI library. Check before require(), which would otherwise log a missing resource
+if not package.preload.ffi and not package.loaded.ffi then
+    return
+end
+
+local ffi = require("ffi")
+
+local sqrt, sin, cos, abs = math.sqrt, math.sin, math.cos, math.abs
+local M_DEGTORAD_2 = math.pi / 360
+local M_EPSILON = 0.000001
+local pointers = ...
+
+ffi.cdef[[
+typedef struct { float x, y; } Urho3DVector2;
+typedef struct { float x, y, z; } Urho3DVector3;
+typedef struct { float x, y, z, w; } Urho3DVector4;
+typedef struct { float w, x, y, z; } Urho3DQuaternion;
+typedef struct { float r, g, b, a; } Urho3DColor;
+typedef struct { float m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23; } Urho3DMatrix3x4;
+]]
+
+local M = {}
+local Vector2, Vector3, Vector4, Quaternion, Color, Matrix3x4
+local Vector2Type = ffi.typeof("Urho3DVector2")
+local Vector3Type = ffi.typeof("Urho3DVector3")
+local Vector4Type = ffi.typeof("Urho3DVector4")
+local QuaternionType = ffi.typeof("Urho3DQuaternion")
+local ColorType = ffi.typeof("Urho3DColor")
+local Matrix3x4Type = ffi.typeof("Urho3DMatrix3x4")
+
+local Vector2Methods = {}
+function Vector2Methods:Length() return sqrt(self.x * self.x + self.y * self.y) end
+function Vector2Methods:LengthSquared() return self.x * self.x + self.y * self.y end
+function Vector2Methods:DotProduct(rhs) return self.x * rhs.x + self.y * rhs.y end
+function Vector2Methods:Lerp(rhs, t) return Vector2(self.x + (rhs.x - self.x) * t, self.y + (rhs.y - self.y) * t) end
+function Vector2Methods:Normalized()
+    local lenSquared = self.x * self.x + self.y * self.y
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        return Vector2(self.x * invLen, self.y * invLen)
+    end
+    return Vector2(self.x, self.y)
+end
+function Vector2Methods:Normalize()
+    local lenSquared = self.x * self.x + self.y * self.y
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        self.x, self.y = self.x * invLen, self.y * invLen
+    end
+end
+function Vector2Methods:Equals(rhs) return abs(self.x - rhs.x) < M_EPSILON and abs(self.y - rhs.y) < M_EPSILON end
+function Vector2Methods:ToTolua() return _G.Vector2(self.x, self.y) end
+
+Vector2 = ffi.metatype(Vector2Type, {
+    __add = function(a, b) return Vector2(a.x + b.x, a.y + b.y) end,
+    __sub = function(a, b) return Vector2(a.x - b.x, a.y - b.y) end,
+    __mul = function(a, b)
+        if type(a) == "number" then return Vector2(a * b.x, a * b.y) end
+        if type(b) == "number" then return Vector2(a.x * b, a.y * b) end
+        return Vector2(a.x * b.x, a.y * b.y)
+    end,
+    __div = function(a, b)
+        if type(b) == "number" then return Vector2(a.x / b, a.y / b) end
+        return Vector2(a.x / b.x, a.y / b.y)
+    end,
+    __unm = function(a) return Vector2(-a.x, -a.y) end,
+    __eq = function(a, b) return ffi.istype(Vector2Type, a) and ffi.istype(Vector2Type, b) and a.x == b.x and a.y == b.y end,
+    __tostring = function(a) return a.x .. " " .. a.y end,
+    __index = Vector2Methods,
+})
+
+local Vector3Methods = {}
+function Vector3Methods:Length() return sqrt(self.x * self.x + self.y * self.y + self.z * self.z) end
+function Vector3Methods:LengthSquared() return self.x * self.x + self.y * self.y + self.z * self.z end
+function Vector3Methods:DotProduct(rhs) return self.x * rhs.x + self.y * rhs.y + self.z * rhs.z end
+function Vector3Methods:CrossProduct(rhs)
+    return Vector3(self.y * rhs.z - self.z * rhs.y, self.z * rhs.x - self.x * rhs.z, self.x * rhs.y - self.y * rhs.x)
+end
+function Vector3Methods:Lerp(rhs, t)
+    return Vector3(self.x + (rhs.x - self.x) * t, self.y + (rhs.y - self.y) * t, self.z + (rhs.z - self.z) * t)
+end
+function Vector3Methods:DistanceToPoint(point)
+    local x, y, z = self.x - point.x, self.y - point.y, self.z - point.z
+    return sqrt(x * x + y * y + z * z)
+end
+function Vector3Methods:Normalized()
+    local lenSquared = self.x * self.x + self.y * self.y + self.z * self.z
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        return Vector3(self.x * invLen, self.y * invLen, self.z * invLen)
+    end
+    return Vector3(self.x, self.y, self.z)
+end
+function Vector3Methods:Normalize()
+    local lenSquared = self.x * self.x + self.y * self.y + self.z * self.z
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        self.x, self.y, self.z = self.x * invLen, self.y * invLen, self.z * invLen
+    end
+end
+function Vector3Methods:Equals(rhs)
+    return abs(self.x - rhs.x) < M_EPSILON and abs(self.y - rhs.y) < M_EPSILON and abs(self.z - rhs.z) < M_EPSILON
+end
+function Vector3Methods:ToTolua() return _G.Vector3(self.x, self.y, self.z) end
+
+Vector3 = ffi.metatype(Vector3Type, {
+    __add = function(a, b) return Vector3(a.x + b.x, a.y + b.y, a.z + b.z) end,
+    __sub = function(a, b) return Vector3(a.x - b.x, a.y - b.y, a.z - b.z) end,
+    __mul = function(a, b)
+        if type(a) == "number" then return Vector3(a * b.x, a * b.y, a * b.z) end
+        if type(b) == "number" then return Vector3(a.x * b, a.y * b, a.z * b) end
+        return Vector3(a.x * b.x, a.y * b.y, a.z * b.z)
+    end,
+    __div = function(a, b)
+        if type(b) == "number" then return Vector3(a.x / b, a.y / b, a.z / b) end
+        return Vector3(a.x / b.x, a.y / b.y, a.z / b.z)
+    end,
+    __unm = function(a) return Vector3(-a.x, -a.y, -a.z) end,
+    __eq = function(a, b)
+        return ffi.istype(Vector3Type, a) and ffi.istype(Vector3Type, b) and a.x == b.x and a.y == b.y and a.z == b.z
+    end,
+    __tostring = function(a) return a.x .. " " .. a.y .. " " .. a.z end,
+    __index = Vector3Methods,
+})
+
+local Vector4Methods = {}
+function Vector4Methods:DotProduct(rhs) return self.x * rhs.x + self.y * rhs.y + self.z * rhs.z + self.w * rhs.w end
+function Vector4Methods:Lerp(rhs, t)
+    return Vector4(self.x + (rhs.x - self.x) * t, self.y + (rhs.y - self.y) * t, self.z + (rhs.z - self.z) * t, self.w + (rhs.w - self.w) * t)
+end
+function Vector4Methods:ToTolua() return _G.Vector4(self.x, self.y, self.z, self.w) end
+
+Vector4 = ffi.metatype(Vector4Type, {
+    __add = function(a, b) return Vector4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w) end,
+    __sub = function(a, b) return Vector4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w) end,
+    __mul = function(a, b)
+        if type(a) == "number" then return Vector4(a * b.x, a * b.y, a * b.z, a * b.w) end
+        if type(b) == "number" then return Vector4(a.x * b, a.y * b, a.z * b, a.w * b) end
+        return Vector4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w)
+    end,
+    __unm = function(a) return Vector4(-a.x, -a.y, -a.z, -a.w) end,
+    __eq = function(a, b)
+        return ffi.istype(Vector4Type, a) and ffi.istype(Vector4Type, b) and a.x == b.x and a.y == b.y and a.z == b.z and a.w == b.w
+    end,
+    __tostring = function(a) return a.x .. " " .. a.y .. " " .. a.z .. " " .. a.w end,
+    __index = Vector4Methods,
+})
+)LUA"
+R"LUA(
+local QuaternionMethods = {}
+function QuaternionMethods:LengthSquared() return self.w * self.w + self.x * self.x + self.y * self.y + self.z * self.z end
+function QuaternionMethods:DotProduct(rhs) return self.w * rhs.w + self.x * rhs.x + self.y * rhs.y + self.z * rhs.z end
+function QuaternionMethods:Conjugate() return Quaternion(self.w, -self.x, -self.y, -self.z) end
+function QuaternionMethods:Inverse()
+    local lenSquared = self:LengthSquared()
+    if lenSquared == 1 then
+        return Quaternion(self.w, -self.x, -self.y, -self.z)
+    elseif lenSquared >= M_EPSILON then
+        local invLen = 1 / lenSquared
+        return Quaternion(self.w * invLen, -self.x * invLen, -self.y * invLen, -self.z * invLen)
+    end
+    return Quaternion()
+end
+function QuaternionMethods:Normalized()
+    local lenSquared = self:LengthSquared()
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        return Quaternion(self.w * invLen, self.x * invLen, self.y * invLen, self.z * invLen)
+    end
+    return Quaternion(self.w, self.x, self.y, self.z)
+end
+function QuaternionMethods:Normalize()
+    local lenSquared = self:LengthSquared()
+    if lenSquared ~= 1 and lenSquared > 0 then
+        local invLen = 1 / sqrt(lenSquared)
+        self.w, self.x, self.y, self.z = self.w * invLen, self.x * invLen, self.y * invLen, self.z * invLen
+    end
+end
+function QuaternionMethods:Nlerp(rhs, t, shortestPath)
+    local fact = 1
+    if shortestPath and self:DotProduct(rhs) < 0 then
+        fact = -1
+    end
+    local q = Quaternion(self.w + (rhs.w * fact - self.w) * t, self.x + (rhs.x * fact - self.x) * t,
+        self.y + (rhs.y * fact - self.y) * t, self.z + (rhs.z * fact - self.z) * t)
+    q:Normalize()
+    return q
+end
+function QuaternionMethods:Equals(rhs)
+    return abs(self.w - rhs.w) < M_EPSILON and abs(self.x - rhs.x) < M_EPSILON and abs(self.y - rhs.y) < M_EPSILON and
+        abs(self.z - rhs.z) < M_EPSILON
+end
+function QuaternionMethods:ToTolua() return _G.Quaternion(self.w, self.x, self.y, self.z) end
+
+Quaternion = ffi.metatype(QuaternionType, {
+    __new = function(ct, w, x, y, z)
+        if w == nil then
+            return ffi.new(ct, 1, 0, 0, 0)
+        end
+        return ffi.new(ct, w, x, y, z)
+    end,
+    __mul = function(a, b)
+        if type(b) == "number" then
+            return Quaternion(a.w * b, a.x * b, a.y * b, a.z * b)
+        elseif ffi.istype(Vector3Type, b) then
+            -- Rotate the vector, same as the Quaternion * Vector3 operator in C++
+            local cx, cy, cz = a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x
+            local dx, dy, dz = a.y * cz - a.z * cy, a.z * cx - a.x * cz, a.x * cy - a.y * cx
+            return Vector3(b.x + 2 * (cx * a.w + dx), b.y + 2 * (cy * a.w + dy), b.z + 2 * (cz * a.w + dz))
+        end
+        return Quaternion(
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y + a.y * b.w + a.z * b.x - a.x * b.z,
+            a.w * b.z + a.z * b.w + a.x * b.y - a.y * b.x)
+    end,
+    __eq = function(a, b)
+        return ffi.istype(QuaternionType, a) and ffi.istype(QuaternionType, b) and a.w == b.w and a.x == b.x and a.y == b.y and
+            a.z == b.z
+    end,
+    __tostring = function(a) return a.w .. " " .. a.x .. " " .. a.y .. " " .. a.z end,
+    __index = QuaternionMethods,
+})
+
+local ColorMethods = {}
+function ColorMethods:Lerp(rhs, t)
+    return Color(self.r + (rhs.r - self.r) * t, self.g + (rhs.g - self.g) * t, self.b + (rhs.b - self.b) * t, self.a + (rhs.a - self.a) * t)
+end
+function ColorMethods:ToTolua() return _G.Color(self.r, self.g, self.b, self.a) end
+
+Color = ffi.metatype(ColorType, {
+    __new = function(ct, r, g, b, a)
+        if r == nil then
+            return ffi.new(ct, 1, 1, 1, 1)
+        end
+        return ffi.new(ct, r, g, b, a or 1)
+    end,
+    __add = function(a, b) return Color(a.r + b.r, a.g + b.g, a.b + b.b, a.a + b.a) end,
+    __sub = function(a, b) return Color(a.r - b.r, a.g - b.g, a.b - b.b, a.a - b.a) end,
+    __mul = function(a, b)
+        if type(a) == "number" then return Color(a * b.r, a * b.g, a * b.b, a * b.a) end
+        return Color(a.r * b, a.g * b, a.b * b, a.a * b)
+    end,
+    __eq = function(a, b)
+        return ffi.istype(ColorType, a) and ffi.istype(ColorType, b) and a.r == b.r and a.g == b.g and a.b == b.b and a.a == b.a
+    end,
+    __tostring = function(a) return a.r .. " " .. a.g .. " " .. a.b .. " " .. a.a end,
+    __index = ColorMethods,
+})
+
+local Matrix3x4Methods = {}
+function Matrix3x4Methods:Translation() return Vector3(self.m03, self.m13, self.m23) end
+
+Matrix3x4 = ffi.metatype(Matrix3x4Type, {
+    __new = function(ct, ...)
+        if select("#", ...) == 0 then
+            return ffi.new(ct, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0)
+        end
+        return ffi.new(ct, ...)
+    end,
+    __mul = function(a, b)
+        if ffi.istype(Vector3Type, b) then
+            return Vector3(
+                a.m00 * b.x + a.m01 * b.y + a.m02 * b.z + a.m03,
+                a.m10 * b.x + a.m11 * b.y + a.m12 * b.z + a.m13,
+                a.m20 * b.x + a.m21 * b.y + a.m22 * b.z + a.m23)
+        end
+        return Matrix3x4(
+            a.m00 * b.m00 + a.m01 * b.m10 + a.m02 * b.m20,
+            a.m00 * b.m01 + a.m01 * b.m11 + a.m02 * b.m21,
+            a.m00 * b.m02 + a.m01 * b.m12 + a.m02 * b.m22,
+            a.m00 * b.m03 + a.m01 * b.m13 + a.m02 * b.m23 + a.m03,
+            a.m10 * b.m00 + a.m11 * b.m10 + a.m12 * b.m20,
+            a.m10 * b.m01 + a.m11 * b.m11 + a.m12 * b.m21,
+            a.m10 * b.m02 + a.m11 * b.m12 + a.m12 * b.m22,
+            a.m10 * b.m03 + a.m11 * b.m13 + a.m12 * b.m23 + a.m13,
+            a.m20 * b.m00 + a.m21 * b.m10 + a.m22 * b.m20,
+            a.m20 * b.m01 + a.m21 * b.m11 + a.m22 * b.m21,
+            a.m20 * b.m02 + a.m21 * b.m12 + a.m22 * b.m22,
+            a.m20 * b.m03 + a.m21 * b.m13 + a.m22 * b.m23 + a.m23)
+    end,
+    __index = Matrix3x4Methods,
+})
+
+function M.QuaternionFromAngleAxis(angle, axis)
+    local normAxis = axis:Normalized()
+    angle = angle * M_DEGTORAD_2
+    local sinAngle = sin(angle)
+    return Quaternion(cos(angle), normAxis.x * sinAngle, normAxis.y * sinAngle, normAxis.z * sinAngle)
+end
+
+function M.QuaternionFromEulerAngles(x, y, z)
+    -- Order of rotations: Z first, then X, then Y, same as in C++
+    x, y, z = x * M_DEGTORAD_2, y * M_DEGTORAD_2, z * M_DEGTORAD_2
+    local sinX, cosX, sinY, cosY, sinZ, cosZ = sin(x), cos(x), sin(y), cos(y), sin(z), cos(z)
+    return Quaternion(
+        cosY * cosX * cosZ + sinY * sinX * sinZ,
+        cosY * sinX * cosZ + sinY * cosX * sinZ,
+        sinY * cosX * cosZ - cosY * sinX * sinZ,
+        cosY * cosX * sinZ - sinY * sinX * cosZ)
+end
+
+M.Vector2, M.Vector3, M.Vector4, M.Quaternion, M.Color, M.Matrix3x4 = Vector2, Vector3, Vector4, Quaternion, Color, Matrix3x4
+)LUA"
+R"LUA(
+-- Wrap an engine accessor. Getters fill the optional out value, so that a preallocated value makes the call allocation free
+local function Getter(signature, pointer, type)
+    local fn = ffi.cast(signature, pointer)
+    return function(object, out)
+        out = out or type()
+        fn(object, out)
+        return out
+    end
+end
+
+local function Setter(signature, pointer)
+    local fn = ffi.cast(signature, pointer)
+    return function(object, value) fn(object, value) end
+end
+
+local p = pointers
+M.Node = {
+    GetPosition = Getter("void (*)(void*, Urho3DVector3*)", p.NodeGetPosition, Vector3),
+    SetPosition = Setter("void (*)(void*, const Urho3DVector3*)", p.NodeSetPosition),
+    GetRotation = Getter("void (*)(void*, Urho3DQuaternion*)", p.NodeGetRotation, Quaternion),
+    SetRotation = Setter("void (*)(void*, const Urho3DQuaternion*)", p.NodeSetRotation),
+    GetScale = Getter("void (*)(void*, Urho3DVector3*)", p.NodeGetScale, Vector3),
+    SetScale = Setter("void (*)(void*, const Urho3DVector3*)", p.NodeSetScale),
+    GetWorldPosition = Getter("void (*)(void*, Urho3DVector3*)", p.NodeGetWorldPosition, Vector3),
+    SetWorldPosition = Setter("void (*)(void*, const Urho3DVector3*)", p.NodeSetWorldPosition),
+    GetWorldRotation = Getter("void (*)(void*, Urho3DQuaternion*)", p.NodeGetWorldRotation, Quaternion),
+    SetWorldRotation = Setter("void (*)(void*, const Urho3DQuaternion*)", p.NodeSetWorldRotation),
+    GetWorldDirection = Getter("void (*)(void*, Urho3DVector3*)", p.NodeGetWorldDirection, Vector3),
+    GetWorldTransform = Getter("void (*)(void*, Urho3DMatrix3x4*)", p.NodeGetWorldTransform, Matrix3x4),
+}
+
+local setTransform = ffi.cast("void (*)(void*, const Urho3DVector3*, const Urho3DQuaternion*)", p.NodeSetTransform)
+function M.Node.SetTransform(node, position, rotation) setTransform(node, position, rotation) end
+
+-- TS_LOCAL is the default space, as in C++
+local translate = ffi.cast("void (*)(void*, const Urho3DVector3*, int)", p.NodeTranslate)
+function M.Node.Translate(node, delta, space) translate(node, delta, space or 0) end
+local rotate = ffi.cast("void (*)(void*, const Urho3DQuaternion*, int)", p.NodeRotate)
+function M.Node.Rotate(node, delta, space) rotate(node, delta, space or 0) end
+
+if p.RigidBodyGetLinearVelocity then
+    M.RigidBody = {
+        GetLinearVelocity = Getter("void (*)(void*, Urho3DVector3*)", p.RigidBodyGetLinearVelocity, Vector3),
+        SetLinearVelocity = Setter("void (*)(void*, const Urho3DVector3*)", p.RigidBodySetLinearVelocity),
+        GetAngularVelocity = Getter("void (*)(void*, Urho3DVector3*)", p.RigidBodyGetAngularVelocity, Vector3),
+        SetAngularVelocity = Setter("void (*)(void*, const Urho3DVector3*)", p.RigidBodySetAngularVelocity),
+        ApplyForce = Setter("void (*)(void*, const Urho3DVector3*)", p.RigidBodyApplyForce),
+        ApplyImpulse = Setter("void (*)(void*, const Urho3DVector3*)", p.RigidBodyApplyImpulse),
+        ApplyTorque = Setter("void (*)(void*, const Urho3DVector3*)", p.RigidBodyApplyTorque),
+    }
+end
+
+package.preload["Urho3D.FFI"] = function() return M end
+)LUA";
+
+#define URHO3D_FFI_FUNCTION(name) \
+    lua_pushlightuserdata(L, reinterpret_cast<void*>(&name)); \
+    lua_setfield(L, -2, #name)
+
+void RegisterLuaFFI(lua_State* L)
+{
+    if (luaL_loadbuffer(L, ffiModuleSource, strlen(ffiModuleSource), "Urho3D.FFI"))
+    {
+        URHO3D_LOGERROR("Failed to load Lua FFI module: " + String(lua_tostring(L, -1)));
+        lua_pop(L, 1);
+        return;
+    }
+
+    lua_newtable(L);
+    URHO3D_FFI_FUNCTION(NodeGetPosition);
+    URHO3D_FFI_FUNCTION(NodeSetPosition);
+    URHO3D_FFI_FUNCTION(NodeGetRotation);
+    URHO3D_FFI_FUNCTION(NodeSetRotation);
+    URHO3D_FFI_FUNCTION(NodeGetScale);
+    URHO3D_FFI_FUNCTION(NodeSetScale);
+    URHO3D_FFI_FUNCTION(NodeSetTransform);
+    URHO3D_FFI_FUNCTION(NodeGetWorldPosition);
+    URHO3D_FFI_FUNCTION(NodeSetWorldPosition);
+    URHO3D_FFI_FUNCTION(NodeGetWorldRotation);
+    URHO3D_FFI_FUNCTION(NodeSetWorldRotation);
+    URHO3D_FFI_FUNCTION(NodeGetWorldDirection);
+    URHO3D_FFI_FUNCTION(NodeGetWorldTransform);
+    URHO3D_FFI_FUNCTION(NodeTranslate);
+    URHO3D_FFI_FUNCTION(NodeRotate);
+#ifdef URHO3D_PHYSICS
+    URHO3D_FFI_FUNCTION(RigidBodyGetLinearVelocity);
+    URHO3D_FFI_FUNCTION(RigidBodySetLinearVelocity);
+    URHO3D_FFI_FUNCTION(RigidBodyGetAngularVelocity);
+    URHO3D_FFI_FUNCTION(RigidBodySetAngularVelocity);
+    URHO3D_FFI_FUNCTION(RigidBodyApplyForce);
+    URHO3D_FFI_FUNCTION(RigidBodyApplyImpulse);
+    URHO3D_FFI_FUNCTION(RigidBodyApplyTorque);
+#endif
+
+    if (lua_pcall(L, 1, 0, 0))
+    {
+        URHO3D_LOGERROR("Failed to register Lua FFI module: " + String(lua_tostring(L, -1)));
+        lua_pop(L, 1);
+    }
+}
+
+}
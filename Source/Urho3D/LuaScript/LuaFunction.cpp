@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../IO/Log.h"
 #include "../IO/VectorBuffer.h"
 #include "../LuaScript/LuaFunction.h"
@@ -84,6 +85,7 @@ bool LuaFunction::BeginCall(const LuaScriptInstance* instance)
 
 bool LuaFunction::EndCall(int numReturns)
 {
+    AllocationTagScope allocationTag(ALLOCTAG_SCRIPT);
     assert(numArguments_ >= 0);
     int numArguments = numArguments_;
     numArguments_ = -1;
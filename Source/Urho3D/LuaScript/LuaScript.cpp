@@ -22,13 +22,16 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../LuaScript/LuaFFI.h"
 #include "../LuaScript/LuaFile.h"
 #include "../LuaScript/LuaFunction.h"
 #include "../LuaScript/LuaScript.h"
@@ -83,9 +86,13 @@ namespace Urho3D
 LuaScript::LuaScript(Context* context) :
     Object(context),
     luaState_(nullptr),
-    executeConsoleCommands_(false)
+    coroutineUpdate_(nullptr),
+    executeConsoleCommands_(false),
+    apiRegistered_(false),
+    gcScheduled_(false),
+    gcCycleBaseline_(0)
 {
-    RegisterLuaScriptLibrary(context_);
+    context_->RegisterLibrary("LuaScript", RegisterLuaScriptLibrary);
 
     luaState_ = luaL_newstate();
     if (!luaState_)
@@ -100,6 +107,30 @@ LuaScript::LuaScript(Context* context) :
     RegisterLoader();
     ReplacePrint();
 
+    eventInvoker_ = new LuaScriptEventInvoker(context_);
+
+    // With lazy registration, postpone the script API until the Lua state is first needed
+    if (!context_->GetLazyRegistration())
+        RegisterAPI();
+
+    // Subscribe to post update
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(LuaScript, HandlePostUpdate));
+    SubscribeToEvent(E_GARBAGECOLLECT, URHO3D_HANDLER(LuaScript, HandleGarbageCollect));
+
+    // Subscribe to console commands
+    SetExecuteConsoleCommands(true);
+}
+
+void LuaScript::RegisterAPI()
+{
+    if (apiRegistered_ || !luaState_)
+        return;
+
+    URHO3D_PROFILE(RegisterLuaScriptAPI);
+
+    // Set the flag first, as looking up functions below goes through the public API
+    apiRegistered_ = true;
+
     tolua_MathLuaAPI_open(luaState_);
     tolua_CoreLuaAPI_open(luaState_);
     tolua_IOLuaAPI_open(luaState_);
@@ -131,15 +162,9 @@ LuaScript::LuaScript(Context* context) :
     tolua_LuaScriptLuaAPI_open(luaState_);
 
     SetContext(luaState_, context_);
+    RegisterLuaFFI(luaState_);
 
-    eventInvoker_ = new LuaScriptEventInvoker(context_);
     coroutineUpdate_ = GetFunction("coroutine.update");
-
-    // Subscribe to post update
-    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(LuaScript, HandlePostUpdate));
-
-    // Subscribe to console commands
-    SetExecuteConsoleCommands(true);
 }
 
 LuaScript::~LuaScript()
@@ -238,6 +263,8 @@ bool LuaScript::ExecuteFile(const String& fileName)
 {
     URHO3D_PROFILE(ExecuteFile);
 
+    RegisterAPI();
+
 #ifdef URHO3D_LUA_RAW_SCRIPT_LOADER
     if (ExecuteRawFile(fileName))
         return true;
@@ -252,6 +279,8 @@ bool LuaScript::ExecuteString(const String& string)
 {
     URHO3D_PROFILE(ExecuteString);
 
+    RegisterAPI();
+
     if (luaL_dostring(luaState_, string.CString()))
     {
         const char* message = lua_tostring(luaState_, -1);
@@ -267,6 +296,8 @@ bool LuaScript::LoadRawFile(const String& fileName)
 {
     URHO3D_PROFILE(LoadRawFile);
 
+    RegisterAPI();
+
     URHO3D_LOGINFO("Finding Lua file on file system: " + fileName);
 
     auto* cache = GetSubsystem<ResourceCache>();
@@ -424,6 +455,8 @@ int LuaScript::Print(lua_State* L)
 
 LuaFunction* LuaScript::GetFunction(int index)
 {
+    RegisterAPI();
+
     if (!lua_isfunction(luaState_, index))
         return nullptr;
 
@@ -446,6 +479,8 @@ LuaFunction* LuaScript::GetFunction(const String& functionName, bool silentIfNot
     if (!luaState_)
         return nullptr;
 
+    RegisterAPI();
+
     HashMap<String, SharedPtr<LuaFunction> >::Iterator i = functionNameToFunctionMap_.Find(functionName);
     if (i != functionNameToFunctionMap_.End())
         return i->second_;
@@ -473,13 +508,54 @@ void LuaScript::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
         coroutineUpdate_->EndCall();
     }
 
-    // Collect garbage
+    // Collect garbage, unless the engine schedules the collection
+    if (!gcScheduled_)
     {
         URHO3D_PROFILE(LuaCollectGarbage);
         lua_gc(luaState_, LUA_GCSTEP, 0);
     }
 }
 
+void LuaScript::HandleGarbageCollect(StringHash eventType, VariantMap& eventData)
+{
+    using namespace GarbageCollect;
+
+    int budget = eventData[P_TIMEBUDGET].GetInt();
+    if (budget <= 0)
+    {
+        // Not scheduled: return to the automatic collector and the per-frame step
+        if (gcScheduled_)
+        {
+            lua_gc(luaState_, LUA_GCRESTART, 0);
+            gcScheduled_ = false;
+        }
+        return;
+    }
+
+    URHO3D_PROFILE(LuaCollectGarbage);
+
+    gcScheduled_ = true;
+    HiresTimer gcTimer;
+    for (;;)
+    {
+        // Stop at the end of a cycle and leave the rest of the budget to other collectors
+        if (lua_gc(luaState_, LUA_GCSTEP, 0))
+        {
+            gcCycleBaseline_ = lua_gc(luaState_, LUA_GCCOUNT, 0);
+            break;
+        }
+        if (gcTimer.GetUSec(false) >= budget)
+            break;
+    }
+
+    // Keep the automatic collector stopped so that it does not interrupt script code at arbitrary times. Stepping re-enables it,
+    // which is left in effect if the memory use has doubled since the last cycle, as then the budget is not keeping up
+    if (lua_gc(luaState_, LUA_GCCOUNT, 0) < gcCycleBaseline_ * 2 + 1024)
+        lua_gc(luaState_, LUA_GCSTOP, 0);
+
+    eventData[P_TIMEBUDGET] = budget - (int)gcTimer.GetUSec(false);
+}
+
 void LuaScript::HandleConsoleCommand(StringHash eventType, VariantMap& eventData)
 {
     using namespace ConsoleCommand;
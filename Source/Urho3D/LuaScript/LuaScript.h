@@ -84,8 +84,16 @@ public:
     /// Set whether to execute engine console commands as script code.
     void SetExecuteConsoleCommands(bool enable);
 
-    /// Return Lua state.
-    lua_State* GetState() const { return luaState_; }
+    /// Return Lua state. Registers the script API first if it was postponed by lazy registration.
+    lua_State* GetState() const
+    {
+        if (!apiRegistered_)
+            const_cast<LuaScript*>(this)->RegisterAPI();
+        return luaState_;
+    }
+
+    /// Return whether the script API has been registered.
+    bool IsAPIRegistered() const { return apiRegistered_; }
 
     /// Return Lua function at the given stack index.
     LuaFunction* GetFunction(int index);
@@ -99,12 +107,16 @@ public:
     static bool PushLuaFunction(lua_State* L, const String& functionName);
 
 private:
+    /// Register the script API to the Lua state if not registered yet.
+    void RegisterAPI();
     /// Register loader.
     void RegisterLoader();
     /// Replace print.
     void ReplacePrint();
     /// Handle post update.
     void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the engine's garbage collection time budget.
+    void HandleGarbageCollect(StringHash eventType, VariantMap& eventData);
     /// Handle a console command event.
     void HandleConsoleCommand(StringHash eventType, VariantMap& eventData);
 
@@ -123,6 +135,12 @@ private:
     LuaFunction* coroutineUpdate_;
     /// Flag for executing engine console commands as script code. Default to true.
     bool executeConsoleCommands_;
+    /// Script API registered flag.
+    bool apiRegistered_;
+    /// Garbage collection is driven by the engine's time budget flag.
+    bool gcScheduled_;
+    /// Lua memory use in kilobytes after the last finished garbage collection cycle.
+    int gcCycleBaseline_;
     /// Function pointer to function map.
     HashMap<const void*, SharedPtr<LuaFunction> > functionPointerToFunctionMap_;
     /// Function name to function map.
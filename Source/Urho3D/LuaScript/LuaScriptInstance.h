@@ -79,6 +79,8 @@ public:
     void ApplyAttributes() override;
     /// Handle enabled/disabled state change.
     void OnSetEnabled() override;
+    /// Return whether the network attributes can be read in worker threads. The script object's network data is read by calling into the script, so it can not.
+    bool IsThreadSafeNetworkUpdate() const override { return false; }
 
     /// Add a scripted event handler by function.
     void AddEventHandler(const String& eventName, int functionIndex) override;
@@ -114,6 +114,12 @@ template <typename T> int ToluaIsPODVector(lua_State* L, int lo, const char* typ
     return ToluaIsVector<T>(L, lo, type, def, err);
 }
 
+/// Check is PODVector<T, is_pointer<T>>. Use template function overload as non-type partial template specialization is not allowed.
+template <typename T> int ToluaIsPODVector(const char* /*overload*/, lua_State* L, int lo, const char* type, int def, tolua_Error* err)
+{
+    return ToluaIsVector<T>(L, lo, type, def, err);
+}
+
 /// Check is PODVector<T, is_arithmetic<T>>. Use template function overload as non-type partial template specialization is not allowed.
 template <typename T> int ToluaIsPODVector(double /*overload*/, lua_State* L, int lo, const char* /*type*/, int def, tolua_Error* err)
 {
@@ -126,6 +132,23 @@ template <typename T> void* ToluaToPODVector(lua_State* L, int narg, void* def)
     return ToluaToVector<T>(L, narg, def);
 }
 
+/// Convert to PODVector<T, is_pointer<T>>. This function is not thread-safe. Use template function overload as non-type partial template specialization is not allowed.
+template <typename T> void* ToluaToPODVector(const char* /*overload*/, lua_State* L, int narg, void* def)
+{
+    if (!lua_istable(L, narg))
+        return nullptr;
+    static PODVector<T> result;
+    result.Clear();
+    result.Resize((unsigned)lua_objlen(L, narg));
+    for (unsigned i = 0; i < result.Size(); ++i)
+    {
+        lua_rawgeti(L, narg, i + 1);
+        result[i] = static_cast<T>(tolua_tousertype(L, -1, def));
+        lua_pop(L, 1);
+    }
+    return &result;
+}
+
 /// Convert to PODVector<T, is_arithmetic<T>>. This function is not thread-safe. Use template function overload as non-type partial template specialization is not allowed.
 template <typename T> void* ToluaToPODVector(double /*overload*/, lua_State* L, int narg, void* /*def*/)
 {
@@ -199,8 +199,7 @@ Frustum Frustum::Transformed(const Matrix3& transform) const
 Frustum Frustum::Transformed(const Matrix3x4& transform) const
 {
     Frustum transformed;
-    for (unsigned i = 0; i < NUM_FRUSTUM_VERTICES; ++i)
-        transformed.vertices_[i] = transform * vertices_[i];
+    Matrix3x4::BulkTransform(transformed.vertices_, transform, vertices_, NUM_FRUSTUM_VERTICES);
 
     transformed.UpdatePlanes();
     return transformed;
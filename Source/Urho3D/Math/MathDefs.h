@@ -227,7 +227,7 @@ inline unsigned CountSetBits(unsigned value)
 }
 
 /// Update a hash with the given 8-bit value using the SDBM algorithm.
-inline unsigned SDBMHash(unsigned hash, unsigned char c) { return c + (hash << 6u) + (hash << 16u) - hash; }
+constexpr unsigned SDBMHash(unsigned hash, unsigned char c) { return c + (hash << 6u) + (hash << 16u) - hash; }
 
 /// Return a random float between 0.0 (inclusive) and 1.0 (exclusive.)
 inline float Random() { return Rand() / 32768.0f; }
@@ -290,6 +290,12 @@ inline float HalfToFloat(unsigned short value)
     return out;
 }
 
+/// Convert float in range -1 to 1 to a signed normalized 16-bit integer.
+inline short FloatToSNorm16(float value) { return (short)RoundToInt(Clamp(value, -1.0f, 1.0f) * 32767.0f); }
+
+/// Convert float in range 0 to 1 to an unsigned normalized 16-bit integer.
+inline unsigned short FloatToUNorm16(float value) { return (unsigned short)RoundToInt(Clamp(value, 0.0f, 1.0f) * 65535.0f); }
+
 /// Calculate both sine and cosine, with angle in degrees.
 URHO3D_API void SinCos(float angle, float& sin, float& cos);
 
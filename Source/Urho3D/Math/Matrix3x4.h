@@ -681,6 +681,30 @@ public:
     float m22_;
     float m23_;
 
+    /// Bulk transform positions: dest[i] = matrix * src[i]. Destination may be the same as the source.
+    static void BulkTransform(Vector3* dest, const Matrix3x4& matrix, const Vector3* src, unsigned count)
+    {
+#ifdef URHO3D_SSE
+        // Use the matrix columns to avoid horizontal adds
+        __m128 c0 = _mm_set_ps(0.f, matrix.m20_, matrix.m10_, matrix.m00_);
+        __m128 c1 = _mm_set_ps(0.f, matrix.m21_, matrix.m11_, matrix.m01_);
+        __m128 c2 = _mm_set_ps(0.f, matrix.m22_, matrix.m12_, matrix.m02_);
+        __m128 c3 = _mm_set_ps(0.f, matrix.m23_, matrix.m13_, matrix.m03_);
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            __m128 vec = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src[i].x_)), _mm_mul_ps(c1, _mm_set1_ps(src[i].y_))),
+                _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(src[i].z_)), c3));
+            // Store exactly three floats to not overwrite the next element
+            _mm_storel_pi(reinterpret_cast<__m64*>(&dest[i].x_), vec);
+            _mm_store_ss(&dest[i].z_, _mm_movehl_ps(vec, vec));
+        }
+#else
+        for (unsigned i = 0; i < count; ++i)
+            dest[i] = matrix * src[i];
+#endif
+    }
+
     /// Zero matrix.
     static const Matrix3x4 ZERO;
     /// Identity matrix.
@@ -705,6 +705,27 @@ public:
         }
     }
 
+    /// Bulk transform positions to homogeneous coordinates without the perspective divide: dest[i] = matrix * Vector4(src[i], 1).
+    static void BulkTransform(Vector4* dest, const Matrix4& matrix, const Vector3* src, unsigned count)
+    {
+#ifdef URHO3D_SSE
+        // Use the matrix columns to avoid horizontal adds
+        __m128 c0 = _mm_set_ps(matrix.m30_, matrix.m20_, matrix.m10_, matrix.m00_);
+        __m128 c1 = _mm_set_ps(matrix.m31_, matrix.m21_, matrix.m11_, matrix.m01_);
+        __m128 c2 = _mm_set_ps(matrix.m32_, matrix.m22_, matrix.m12_, matrix.m02_);
+        __m128 c3 = _mm_set_ps(matrix.m33_, matrix.m23_, matrix.m13_, matrix.m03_);
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            _mm_storeu_ps(&dest[i].x_, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src[i].x_)),
+                _mm_mul_ps(c1, _mm_set1_ps(src[i].y_))), _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(src[i].z_)), c3)));
+        }
+#else
+        for (unsigned i = 0; i < count; ++i)
+            dest[i] = matrix * Vector4(src[i], 1.0f);
+#endif
+    }
+
     /// Zero matrix.
     static const Matrix4 ZERO;
     /// Identity matrix.
@@ -249,8 +249,7 @@ void Polyhedron::Transform(const Matrix3x4& transform)
     for (unsigned i = 0; i < faces_.Size(); ++i)
     {
         PODVector<Vector3>& face = faces_[i];
-        for (unsigned j = 0; j < face.Size(); ++j)
-            face[j] = transform * face[j];
+        Matrix3x4::BulkTransform(face.Buffer(), transform, face.Buffer(), face.Size());
     }
 }
 
@@ -283,8 +282,7 @@ Polyhedron Polyhedron::Transformed(const Matrix3x4& transform) const
         PODVector<Vector3>& newFace = ret.faces_[i];
         newFace.Resize(face.Size());
 
-        for (unsigned j = 0; j < face.Size(); ++j)
-            newFace[j] = transform * face[j];
+        Matrix3x4::BulkTransform(newFace.Buffer(), transform, face.Buffer(), face.Size());
     }
 
     return ret;
@@ -52,20 +52,21 @@ static StringHashRegister& GetGlobalStringHashRegister()
 
 const StringHash StringHash::ZERO;
 
-StringHash::StringHash(const char* str) noexcept :
-    value_(Calculate(str))
+StringHash::StringHash(const String& str) noexcept :
+    value_(Calculate(str.CString()))
 {
 #ifdef URHO3D_HASH_DEBUG
-    Urho3D::GetGlobalStringHashRegister().RegisterString(*this, str);
+    Urho3D::GetGlobalStringHashRegister().RegisterString(*this, str.CString());
 #endif
 }
 
-StringHash::StringHash(const String& str) noexcept :
-    value_(Calculate(str.CString()))
+unsigned StringHash::CalculateAndRegister(const char* str) noexcept
 {
+    unsigned hash = Calculate(str);
 #ifdef URHO3D_HASH_DEBUG
-    Urho3D::GetGlobalStringHashRegister().RegisterString(*this, str.CString());
+    Urho3D::GetGlobalStringHashRegister().RegisterString(StringHash(hash), str);
 #endif
+    return hash;
 }
 
 unsigned StringHash::Calculate(const char* str, unsigned hash)
@@ -23,6 +23,9 @@
 #pragma once
 
 #include "../Container/Str.h"
+#include "../Math/MathDefs.h"
+
+#include <type_traits>
 
 namespace Urho3D
 {
@@ -34,7 +37,7 @@ class URHO3D_API StringHash
 {
 public:
     /// Construct with zero value.
-    StringHash() noexcept :
+    constexpr StringHash() noexcept :
         value_(0)
     {
     }
@@ -43,13 +46,33 @@ public:
     StringHash(const StringHash& rhs) noexcept = default;
 
     /// Construct with an initial value.
-    explicit StringHash(unsigned value) noexcept :
+    explicit constexpr StringHash(unsigned value) noexcept :
         value_(value)
     {
     }
 
+#ifndef URHO3D_HASH_DEBUG
+    /// Construct from a string literal or character array. The hash of a literal is calculated at compile time, so a static
+    /// hash constant needs no dynamic initialization.
+    template <unsigned N> constexpr StringHash(const char (&str)[N]) noexcept :     // NOLINT(google-explicit-constructor)
+        value_(CalculateConstant(str, N))
+    {
+    }
+#else
+    /// Construct from a string literal or character array, registering the string for reversing.
+    template <unsigned N> StringHash(const char (&str)[N]) noexcept :               // NOLINT(google-explicit-constructor)
+        value_(CalculateAndRegister(str))
+    {
+    }
+#endif
+
     /// Construct from a C string.
-    StringHash(const char* str) noexcept;        // NOLINT(google-explicit-constructor)
+    template <class T, typename std::enable_if<std::is_convertible<T, const char*>::value && !std::is_array<T>::value, int>::type = 0>
+    StringHash(const T& str) noexcept :             // NOLINT(google-explicit-constructor)
+        value_(CalculateAndRegister(str))
+    {
+    }
+
     /// Construct from a string.
     StringHash(const String& str) noexcept;      // NOLINT(google-explicit-constructor)
 
@@ -72,22 +95,22 @@ public:
     }
 
     /// Test for equality with another hash.
-    bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
+    constexpr bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
 
     /// Test for inequality with another hash.
-    bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
+    constexpr bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
 
     /// Test if less than another hash.
-    bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
+    constexpr bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
 
     /// Test if greater than another hash.
-    bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
+    constexpr bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
 
     /// Return true if nonzero hash value.
-    explicit operator bool() const { return value_ != 0; }
+    explicit constexpr operator bool() const { return value_ != 0; }
 
     /// Return hash value.
-    unsigned Value() const { return value_; }
+    constexpr unsigned Value() const { return value_; }
 
     /// Return as string.
     String ToString() const;
@@ -96,11 +119,17 @@ public:
     String Reverse() const;
 
     /// Return hash value for HashSet & HashMap.
-    unsigned ToHash() const { return value_; }
+    constexpr unsigned ToHash() const { return value_; }
 
     /// Calculate hash value from a C string.
     static unsigned Calculate(const char* str, unsigned hash = 0);
 
+    /// Calculate hash value from at most length characters of a C string. Can be evaluated at compile time.
+    static constexpr unsigned CalculateConstant(const char* str, unsigned length, unsigned hash = 0)
+    {
+        return length && *str ? CalculateConstant(str + 1, length - 1, SDBMHash(hash, (unsigned char)*str)) : hash;
+    }
+
     /// Get global StringHashRegister. Use for debug purposes only. Return nullptr if URHO3D_HASH_DEBUG is off.
     static StringHashRegister* GetGlobalStringHashRegister();
 
@@ -108,6 +137,9 @@ public:
     static const StringHash ZERO;
 
 private:
+    /// Calculate hash value from a C string at runtime. Registers the string for reversing if URHO3D_HASH_DEBUG is on.
+    static unsigned CalculateAndRegister(const char* str) noexcept;
+
     /// Hash value.
     unsigned value_;
 };
@@ -24,7 +24,9 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
+#include "../Graphics/Drawable.h"
 #include "../IO/Log.h"
 #include "../Navigation/CrowdAgent.h"
 #include "../Navigation/CrowdManager.h"
@@ -45,6 +47,8 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const unsigned DEFAULT_MAX_AGENTS = 512;
 static const float DEFAULT_MAX_AGENT_RADIUS = 0.f;
+/// Minimum number of agents for each work item of a threaded crowd update stage.
+static const int MIN_AGENTS_PER_WORK_ITEM = 16;
 
 static const StringVector filterTypesStructureElementNames =
 {
@@ -74,6 +78,17 @@ void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt)
     static_cast<CrowdAgent*>(ag->params.userData)->OnCrowdUpdate(ag, dt);
 }
 
+void CrowdParallelUpdateCallback(dtCrowd* crowd, int stage, int count, void* userData)
+{
+    static_cast<CrowdManager*>(userData)->RunUpdateStage(stage, count);
+}
+
+void CrowdUpdateStageWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* manager = reinterpret_cast<CrowdManager*>(item->aux_);
+    manager->crowd_->updateStage(manager->currentStage_, (int)(size_t)item->start_, (int)(size_t)item->end_, threadIndex);
+}
+
 CrowdManager::CrowdManager(Context* context) :
     Component(context),
     maxAgents_(DEFAULT_MAX_AGENTS),
@@ -104,6 +119,9 @@ void CrowdManager::RegisterObject(Context* context)
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Obstacle Avoidance Types", GetObstacleAvoidanceTypesAttr, SetObstacleAvoidanceTypesAttr,
         VariantVector, Variant::emptyVariantVector, AM_DEFAULT)
         .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, obstacleAvoidanceTypesStructureElementNames);
+    URHO3D_ATTRIBUTE("LOD Distance", float, lodDistance_, 0.0f, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("LOD Update Interval", unsigned, lodUpdateInterval_, 1, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Invisible Update Interval", unsigned, invisibleUpdateInterval_, 1, AM_DEFAULT);
 }
 
 void CrowdManager::ApplyAttributes()
@@ -111,6 +129,9 @@ void CrowdManager::ApplyAttributes()
     // Values from Editor, saved-file, or network must be checked before applying
     maxAgents_ = Max(1U, maxAgents_);
     maxAgentRadius_ = Max(0.f, maxAgentRadius_);
+    lodDistance_ = Max(0.f, lodDistance_);
+    lodUpdateInterval_ = Max(1U, lodUpdateInterval_);
+    invisibleUpdateInterval_ = Max(1U, invisibleUpdateInterval_);
 
     bool navMeshChange = false;
     Scene* scene = GetScene();
@@ -387,6 +408,24 @@ void CrowdManager::SetObstacleAvoidanceParams(unsigned obstacleAvoidanceType, co
     }
 }
 
+void CrowdManager::SetLodDistance(float distance)
+{
+    lodDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void CrowdManager::SetLodUpdateInterval(unsigned interval)
+{
+    lodUpdateInterval_ = Max(interval, 1U);
+    MarkNetworkUpdate();
+}
+
+void CrowdManager::SetInvisibleUpdateInterval(unsigned interval)
+{
+    invisibleUpdateInterval_ = Max(interval, 1U);
+    MarkNetworkUpdate();
+}
+
 Vector3 CrowdManager::FindNearestPoint(const Vector3& point, int queryFilterType, dtPolyRef* nearestRef)
 {
     if (nearestRef)
@@ -589,6 +628,7 @@ bool CrowdManager::CreateCrowd()
         URHO3D_LOGERROR("Could not initialize DetourCrowd");
         return false;
     }
+    UpdateParallelism();
 
     if (recreate)
     {
@@ -679,9 +719,97 @@ void CrowdManager::Update(float delta)
 {
     assert(crowd_ && navigationMesh_);
     URHO3D_PROFILE(UpdateCrowd);
+    UpdateParallelism();
+    UpdateAgentLods();
     crowd_->update(delta, nullptr);
 }
 
+void CrowdManager::UpdateParallelism()
+{
+    // Worker threads may have been created after the crowd
+    auto* queue = GetSubsystem<WorkQueue>();
+    int maxThreads = queue ? (int)queue->GetNumThreads() + 1 : 1;
+    if (crowd_->getMaxThreads() != maxThreads && !crowd_->setParallelUpdate(CrowdParallelUpdateCallback, this, maxThreads))
+        URHO3D_LOGWARNING("Could not allocate DetourCrowd thread queries, updating the crowd in the main thread");
+}
+
+void CrowdManager::UpdateAgentLods()
+{
+    bool distanceLod = lodDistance_ > 0.0f && lodUpdateInterval_ > 1;
+    bool invisibleLod = invisibleUpdateInterval_ > 1;
+    PODVector<Drawable*> drawables;
+
+    ++lodUpdateCounter_;
+    numLodAgents_ = 0;
+
+    for (int i = 0; i < crowd_->getAgentCount(); ++i)
+    {
+        dtCrowdAgent* ag = crowd_->getEditableAgent(i);
+        if (!ag->active)
+            continue;
+
+        unsigned interval = 1;
+        auto* agent = static_cast<CrowdAgent*>(ag->params.userData);
+        Node* node = agent ? agent->GetNode() : nullptr;
+        if ((distanceLod || invisibleLod) && node)
+        {
+            // Agents without drawables in their node always update at the full rate
+            node->GetDerivedComponents<Drawable>(drawables);
+            if (!drawables.Empty())
+            {
+                bool visible = false;
+                float distance = M_INFINITY;
+                for (unsigned j = 0; j < drawables.Size(); ++j)
+                {
+                    if (drawables[j]->IsInView())
+                    {
+                        visible = true;
+                        distance = Min(distance, drawables[j]->GetDistance());
+                    }
+                }
+
+                if (!visible)
+                    interval = invisibleUpdateInterval_;
+                else if (distanceLod && distance > lodDistance_)
+                    interval = lodUpdateInterval_;
+            }
+        }
+
+        // Stagger the reduced rate agents so that their steering updates are spread over the interval
+        ag->simplifiedAvoidance = interval > 1;
+        ag->skipSteering = interval > 1 && (lodUpdateCounter_ + i) % interval != 0;
+        if (interval > 1)
+            ++numLodAgents_;
+    }
+}
+
+void CrowdManager::RunUpdateStage(int stage, int count)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    int maxThreads = crowd_->getMaxThreads();
+    int numItems = Min((count + MIN_AGENTS_PER_WORK_ITEM - 1) / MIN_AGENTS_PER_WORK_ITEM, maxThreads);
+    if (numItems <= 1)
+    {
+        crowd_->updateStage(stage, 0, count, 0);
+        return;
+    }
+
+    currentStage_ = stage;
+    int agentsPerItem = (count + numItems - 1) / numItems;
+    for (int start = 0; start < count; start += agentsPerItem)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CrowdUpdateStageWork;
+        item->name_ = "CrowdUpdateStageWork";
+        item->aux_ = this;
+        item->start_ = (void*)(size_t)start;
+        item->end_ = (void*)(size_t)Min(start + agentsPerItem, count);
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 const dtCrowdAgent* CrowdManager::GetDetourCrowdAgent(int agent) const
 {
     return crowd_ ? crowd_->getAgent(agent) : nullptr;
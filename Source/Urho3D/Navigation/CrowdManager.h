@@ -39,6 +39,7 @@ namespace Urho3D
 
 class CrowdAgent;
 class NavigationMesh;
+struct WorkItem;
 
 /// Parameter structure for obstacle avoidance params (copied from DetourObstacleAvoidance.h in order to hide Detour header from Urho3D library users).
 struct CrowdObstacleAvoidanceParams
@@ -61,6 +62,8 @@ class URHO3D_API CrowdManager : public Component
     URHO3D_OBJECT(CrowdManager, Component);
 
     friend class CrowdAgent;
+    friend void CrowdParallelUpdateCallback(dtCrowd* crowd, int stage, int count, void* userData);
+    friend void CrowdUpdateStageWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -101,6 +104,12 @@ public:
     void SetObstacleAvoidanceTypesAttr(const VariantVector& value);
     /// Set the params for the specified obstacle avoidance type.
     void SetObstacleAvoidanceParams(unsigned obstacleAvoidanceType, const CrowdObstacleAvoidanceParams& params);
+    /// Set the distance from the camera beyond which agents update their steering at the LOD update interval. Zero (default) disables distance LOD.
+    void SetLodDistance(float distance);
+    /// Set the number of crowd updates between steering updates for agents beyond the LOD distance. These agents also skip obstacle avoidance sampling. 1 (default) updates every time.
+    void SetLodUpdateInterval(unsigned interval);
+    /// Set the number of crowd updates between steering updates for agents whose drawables were not visible in the last frame. These agents also skip obstacle avoidance sampling. 1 (default) updates every time.
+    void SetInvisibleUpdateInterval(unsigned interval);
 
     /// Get all the crowd agent components in the specified node hierarchy. If the node is not specified then use scene node. When inCrowdFilter is set to true then only get agents that are in the crowd.
     PODVector<CrowdAgent*> GetAgents(Node* node = nullptr, bool inCrowdFilter = true) const;
@@ -150,6 +159,18 @@ public:
     /// Get the params for the specified obstacle avoidance type.
     const CrowdObstacleAvoidanceParams& GetObstacleAvoidanceParams(unsigned obstacleAvoidanceType) const;
 
+    /// Return the LOD distance.
+    float GetLodDistance() const { return lodDistance_; }
+
+    /// Return the LOD update interval.
+    unsigned GetLodUpdateInterval() const { return lodUpdateInterval_; }
+
+    /// Return the update interval of invisible agents.
+    unsigned GetInvisibleUpdateInterval() const { return invisibleUpdateInterval_; }
+
+    /// Return the number of agents which used a reduced update rate in the last crowd update.
+    unsigned GetNumLodAgents() const { return numLodAgents_; }
+
 protected:
     /// Create and initialized internal Detour crowd object. When it is a recreate, it preserves the configuration and attempts to re-add existing agents in the previous crowd back to the newly created crowd.
     bool CreateCrowd();
@@ -178,6 +199,12 @@ private:
     void HandleNavMeshChanged(StringHash eventType, VariantMap& eventData);
     /// Handle component added in the scene to check for late addition of the navmesh.
     void HandleComponentAdded(StringHash eventType, VariantMap& eventData);
+    /// Set the crowd to run its update stages in the work queue threads, if there are any.
+    void UpdateParallelism();
+    /// Select the update rate and avoidance quality of each agent from its drawables' visibility and distance.
+    void UpdateAgentLods();
+    /// Run a crowd update stage for the active agents, split into work items.
+    void RunUpdateStage(int stage, int count);
 
     /// Internal Detour crowd object.
     dtCrowd* crowd_{};
@@ -195,6 +222,18 @@ private:
     PODVector<unsigned> numAreas_;
     /// Number of obstacle avoidance types configured in the crowd. Limit to DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS.
     unsigned numObstacleAvoidanceTypes_{};
+    /// Distance beyond which agents use the LOD update interval.
+    float lodDistance_{};
+    /// Number of crowd updates between steering updates beyond the LOD distance.
+    unsigned lodUpdateInterval_{1};
+    /// Number of crowd updates between steering updates when not visible.
+    unsigned invisibleUpdateInterval_{1};
+    /// Number of agents at a reduced update rate in the last update.
+    unsigned numLodAgents_{};
+    /// Crowd update counter, used to stagger the reduced rate agents.
+    unsigned lodUpdateCounter_{};
+    /// Update stage being run in the work items.
+    int currentStage_{};
 };
 
 }
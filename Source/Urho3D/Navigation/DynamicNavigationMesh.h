@@ -99,8 +99,6 @@ public:
     bool GetDrawObstacles() const { return drawObstacles_; }
 
 protected:
-    struct TileCacheData;
-
     /// Subscribe to events when assigned to a scene.
     void OnSceneSet(Scene* scene) override;
     /// Trigger the tile cache to make updates to the nav mesh if necessary.
@@ -113,10 +111,12 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle*, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
-    unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Create the build data of one tile and collect its geometry. The caller owns the build data.
+    NavBuildData* CreateTileBuildData(Vector<NavigationGeometryInfo>& geometryList, int x, int z) override;
+    /// Build the compressed tile cache layers of one tile. May be called from a worker thread.
+    void BuildTileData(NavBuildData* build) override;
+    /// Replace the tile cache layers of one tile with the built data, rebuild its navigation mesh tiles and send the rebuild event. Return number of added layers.
+    unsigned AddTileData(NavBuildData* build) override;
     /// Off-mesh connections to be rebuilt in the mesh processor.
     PODVector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
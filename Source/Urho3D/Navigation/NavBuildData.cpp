@@ -31,6 +31,7 @@ namespace Urho3D
 {
 
 NavBuildData::NavBuildData() :
+    success_(false),
     ctx_(new rcContext(true)),
     heightField_(nullptr),
     compactHeightField_(nullptr)
@@ -51,7 +52,9 @@ SimpleNavBuildData::SimpleNavBuildData() :
     NavBuildData(),
     contourSet_(nullptr),
     polyMesh_(nullptr),
-    polyMeshDetail_(nullptr)
+    polyMeshDetail_(nullptr),
+    navData_(nullptr),
+    navDataSize_(0)
 {
 }
 
@@ -63,6 +66,8 @@ SimpleNavBuildData::~SimpleNavBuildData()
     polyMesh_ = nullptr;
     rcFreePolyMeshDetail(polyMeshDetail_);
     polyMeshDetail_ = nullptr;
+    dtFree(navData_);
+    navData_ = nullptr;
 }
 
 DynamicNavBuildData::DynamicNavBuildData(dtTileCacheAlloc* allocator) :
@@ -83,6 +88,9 @@ DynamicNavBuildData::~DynamicNavBuildData()
     polyMesh_ = nullptr;
     rcFreeHeightfieldLayerSet(heightFieldLayers_);
     heightFieldLayers_ = nullptr;
+    for (unsigned i = 0; i < layers_.Size(); ++i)
+        dtFree(layers_[i]);
+    layers_.Clear();
 }
 
 }
@@ -58,6 +58,10 @@ struct URHO3D_API NavBuildData
     /// Destructor.
     virtual ~NavBuildData();
 
+    /// Tile index.
+    IntVector2 tile_;
+    /// Whether the tile was built successfully.
+    bool success_;
     /// World-space bounding box of the navigation mesh tile.
     BoundingBox worldBoundingBox_;
     /// Vertices from geometries.
@@ -97,6 +101,10 @@ struct SimpleNavBuildData : public NavBuildData
     rcPolyMesh* polyMesh_;
     /// Recast detail poly mesh.
     rcPolyMeshDetail* polyMeshDetail_;
+    /// Detour navigation mesh tile data. Owned until added to the navigation mesh.
+    unsigned char* navData_;
+    /// Detour navigation mesh tile data size.
+    int navDataSize_;
 };
 
 struct DynamicNavBuildData : public NavBuildData
@@ -114,6 +122,10 @@ struct DynamicNavBuildData : public NavBuildData
     rcHeightfieldLayerSet* heightFieldLayers_;
     /// Allocator from DynamicNavigationMesh instance.
     dtTileCacheAlloc* alloc_;
+    /// Compressed tile cache layers. Owned until added to the tile cache.
+    PODVector<unsigned char*> layers_;
+    /// Compressed tile cache layer sizes.
+    PODVector<int> layerSizes_;
 };
 
 }
@@ -66,6 +66,17 @@ URHO3D_EVENT(E_NAVIGATION_ALL_TILES_REMOVED, NavigationAllTilesRemoved)
     URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
 }
 
+/// Queued path request has been processed.
+URHO3D_EVENT(E_NAVIGATION_PATH_FOUND, NavigationPathFound)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_ID, Id); // unsigned
+    URHO3D_PARAM(P_START, Start); // Vector3
+    URHO3D_PARAM(P_END, End); // Vector3
+    URHO3D_PARAM(P_PATH, Path); // VariantVector of world space Vector3 points, empty if no path found
+}
+
 /// Crowd agent formation.
 URHO3D_EVENT(E_CROWD_AGENT_FORMATION, CrowdAgentFormation)
 {
@@ -23,7 +23,10 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -31,6 +34,8 @@
 #include "../Graphics/StaticModel.h"
 #include "../Graphics/TerrainPatch.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../Navigation/CrowdAgent.h"
@@ -40,11 +45,14 @@
 #include "../Navigation/Navigable.h"
 #include "../Navigation/NavigationEvents.h"
 #include "../Navigation/NavigationMesh.h"
+#include "../Navigation/NavigationRegion.h"
 #include "../Navigation/Obstacle.h"
 #include "../Navigation/OffMeshConnection.h"
 #ifdef URHO3D_PHYSICS
 #include "../Physics/CollisionShape.h"
 #endif
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
 #include "../Scene/Scene.h"
 
 #include <cfloat>
@@ -82,6 +90,11 @@ static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
 
 static const int MAX_POLYS = 2048;
+/// Maximum number of tiles collected and built at once.
+static const unsigned TILE_BUILD_BATCH_SIZE = 64;
+static const unsigned DEFAULT_PATH_ITERATION_BUDGET = 1024;
+static const int DEFAULT_STREAMING_REGION_SIZE = 8;
+static const float DEFAULT_STREAMING_DISTANCE = 100.0f;
 
 
 /// Temporary data for finding a path.
@@ -97,12 +110,533 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Tiles building in the background.
+struct PendingTileBuilds
+{
+    /// Work items in request order.
+    Vector<SharedPtr<WorkItem> > items_;
+    /// Build data of the work items.
+    PODVector<NavBuildData*> builds_;
+};
+
+void BuildNavigationTileWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto* navMesh = reinterpret_cast<NavigationMesh*>(item->aux_);
+    auto* build = reinterpret_cast<NavBuildData*>(item->start_);
+    navMesh->BuildTileData(build);
+}
+
+struct PathQuerySlot;
+
+/// Queued path request.
+struct PathRequest
+{
+    /// Request ID.
+    unsigned id_{};
+    /// World space start point.
+    Vector3 start_;
+    /// World space end point.
+    Vector3 end_;
+    /// Local space start point.
+    Vector3 localStart_;
+    /// Local space end point.
+    Vector3 localEnd_;
+    /// Search extents.
+    Vector3 extents_;
+    /// Query filter.
+    dtQueryFilter filter_;
+    /// End polygon.
+    dtPolyRef endRef_{};
+    /// Query slot the request has been assigned to.
+    PathQuerySlot* slot_{};
+    /// Sliced search started flag.
+    bool started_{};
+    /// Search finished flag.
+    bool finished_{};
+    /// Local space path points.
+    PODVector<Vector3> points_;
+};
+
+/// Path query slot for one thread. A Detour query object can only run one sliced search at a time, so the assigned requests are searched in order.
+struct PathQuerySlot
+{
+    /// Construct.
+    PathQuerySlot() :
+        query_(dtAllocNavMeshQuery()),
+        data_(new FindPathData())
+    {
+    }
+
+    /// Destruct.
+    ~PathQuerySlot()
+    {
+        dtFreeNavMeshQuery(query_);
+    }
+
+    /// Detour navigation mesh query.
+    dtNavMeshQuery* query_;
+    /// Temporary data for finding a path.
+    UniquePtr<FindPathData> data_;
+    /// Assigned requests in order.
+    PODVector<PathRequest*> requests_;
+    /// Search iterations for this frame.
+    unsigned iterations_{};
+};
+
+/// Queued path requests.
+struct PathRequestQueue
+{
+    /// Destruct.
+    ~PathRequestQueue()
+    {
+        for (unsigned i = 0; i < slots_.Size(); ++i)
+            delete slots_[i];
+    }
+
+    /// Requests in request order.
+    List<PathRequest> requests_;
+    /// Query slots.
+    PODVector<PathQuerySlot*> slots_;
+    /// Next request ID.
+    unsigned nextId_{};
+};
+
+/// Region of connected polygons within a tile in the hierarchical path graph.
+struct PathGraphRegion
+{
+    /// Polygon used as the waypoint of the region.
+    dtPolyRef poly_{};
+    /// Center of the waypoint polygon.
+    Vector3 center_;
+    /// Index of the first edge in the tile's edges.
+    unsigned firstEdge_{};
+    /// Number of edges.
+    unsigned numEdges_{};
+};
+
+/// Edge between regions in neighbouring tiles.
+struct PathGraphEdge
+{
+    /// Target tile index.
+    unsigned tile_{};
+    /// Target region index.
+    unsigned region_{};
+    /// Cost of traveling through the portal to the target region waypoint.
+    float cost_{};
+};
+
+/// Regions and edges of a navigation mesh tile.
+struct PathGraphTile
+{
+    /// Tile reference the regions were built from, zero if the tile is empty.
+    dtTileRef ref_{};
+    /// Tile X coordinate.
+    int x_{};
+    /// Tile Z coordinate.
+    int z_{};
+    /// Region index of each polygon.
+    PODVector<unsigned> polyRegions_;
+    /// Regions.
+    PODVector<PathGraphRegion> regions_;
+    /// Edges grouped by source region.
+    PODVector<PathGraphEdge> edges_;
+};
+
+/// Tile region graph for hierarchical path planning.
+struct PathGraph
+{
+    /// Tiles indexed by the Detour tile index.
+    Vector<PathGraphTile> tiles_;
+    /// Total number of regions.
+    unsigned numRegions_{};
+};
+
+/// Node of the tile region graph search.
+struct PathGraphNode
+{
+    /// Cost from the start region.
+    float cost_{};
+    /// Key of the previous region.
+    unsigned long long parent_{};
+    /// Closed flag.
+    bool closed_{};
+};
+
+/// Open list entry of the tile region graph search.
+struct PathGraphOpenEntry
+{
+    /// Test for higher estimated total cost, so that the heap keeps the lowest on top.
+    bool operator <(const PathGraphOpenEntry& rhs) const { return total_ > rhs.total_; }
+
+    /// Estimated total cost.
+    float total_;
+    /// Region key.
+    unsigned long long key_;
+};
+
+static const unsigned long long INVALID_PATH_GRAPH_KEY = 0xffffffffffffffffULL;
+/// Number of regions ahead that a local search of a hierarchical path targets.
+static const unsigned PATH_GRAPH_REFINE_REGIONS = 8;
+/// Maximum number of layers per tile location visited when updating the tile region graph.
+static const int MAX_PATH_GRAPH_LAYERS = 32;
+
+/// Return the center of a polygon.
+static Vector3 GetPolyCenter(const dtMeshTile* tile, const dtPoly& poly)
+{
+    Vector3 center;
+    for (unsigned i = 0; i < poly.vertCount; ++i)
+        center += Vector3(&tile->verts[poly.verts[i] * 3]);
+    return center / (float)poly.vertCount;
+}
+
+/// Return the tile region graph key of a region.
+static unsigned long long MakePathGraphKey(unsigned tileIndex, unsigned region)
+{
+    return ((unsigned long long)tileIndex << 32u) | region;
+}
+
+/// Return the tile region graph key of the region containing a polygon, or INVALID_PATH_GRAPH_KEY if not in the graph.
+static unsigned long long GetPathGraphKey(const PathGraph& graph, const dtNavMesh* navMesh, dtPolyRef ref)
+{
+    unsigned tileIndex = navMesh->decodePolyIdTile(ref);
+    unsigned polyIndex = navMesh->decodePolyIdPoly(ref);
+    if (tileIndex >= graph.tiles_.Size() || polyIndex >= graph.tiles_[tileIndex].polyRegions_.Size())
+        return INVALID_PATH_GRAPH_KEY;
+    return MakePathGraphKey(tileIndex, graph.tiles_[tileIndex].polyRegions_[polyIndex]);
+}
+
+/// Return the region of a tile region graph key.
+static const PathGraphRegion& GetPathGraphRegion(const PathGraph& graph, unsigned long long key)
+{
+    return graph.tiles_[(unsigned)(key >> 32u)].regions_[(unsigned)(key & 0xffffffffu)];
+}
+
+/// Rebuild the regions of a tile by flood filling the polygons connected within the tile.
+static void BuildPathGraphRegions(PathGraphTile& graphTile, const dtNavMesh* navMesh, unsigned tileIndex)
+{
+    const dtMeshTile* tile = navMesh->getTile(tileIndex);
+    graphTile.ref_ = tile->header ? navMesh->getTileRef(tile) : 0;
+    graphTile.polyRegions_.Clear();
+    graphTile.regions_.Clear();
+    graphTile.edges_.Clear();
+    if (!graphTile.ref_)
+        return;
+
+    graphTile.x_ = tile->header->x;
+    graphTile.z_ = tile->header->y;
+    auto numPolys = (unsigned)tile->header->polyCount;
+    graphTile.polyRegions_.Resize(numPolys);
+    for (unsigned i = 0; i < numPolys; ++i)
+        graphTile.polyRegions_[i] = M_MAX_UNSIGNED;
+
+    dtPolyRef base = navMesh->getPolyRefBase(tile);
+    PODVector<unsigned> stack;
+    PODVector<unsigned> members;
+
+    for (unsigned i = 0; i < numPolys; ++i)
+    {
+        if (graphTile.polyRegions_[i] != M_MAX_UNSIGNED)
+            continue;
+
+        unsigned region = graphTile.regions_.Size();
+        Vector3 centerSum;
+        unsigned numGroundPolys = 0;
+        members.Clear();
+        stack.Push(i);
+        graphTile.polyRegions_[i] = region;
+
+        while (!stack.Empty())
+        {
+            unsigned polyIndex = stack.Back();
+            stack.Pop();
+            members.Push(polyIndex);
+
+            const dtPoly& poly = tile->polys[polyIndex];
+            if (poly.getType() == DT_POLYTYPE_GROUND)
+            {
+                centerSum += GetPolyCenter(tile, poly);
+                ++numGroundPolys;
+            }
+
+            for (unsigned j = poly.firstLink; j != DT_NULL_LINK; j = tile->links[j].next)
+            {
+                dtPolyRef ref = tile->links[j].ref;
+                if (!ref || navMesh->decodePolyIdTile(ref) != tileIndex)
+                    continue;
+                unsigned neighbour = navMesh->decodePolyIdPoly(ref);
+                if (neighbour < numPolys && graphTile.polyRegions_[neighbour] == M_MAX_UNSIGNED)
+                {
+                    graphTile.polyRegions_[neighbour] = region;
+                    stack.Push(neighbour);
+                }
+            }
+        }
+
+        // Use the ground polygon nearest to the average center as the waypoint, so that it is not inside an off-mesh connection
+        Vector3 averageCenter = numGroundPolys ? centerSum / (float)numGroundPolys : GetPolyCenter(tile, tile->polys[members[0]]);
+        unsigned bestPoly = members[0];
+        float bestDistance = M_INFINITY;
+        for (unsigned j = 0; j < members.Size(); ++j)
+        {
+            const dtPoly& poly = tile->polys[members[j]];
+            if (numGroundPolys && poly.getType() != DT_POLYTYPE_GROUND)
+                continue;
+            float distance = (GetPolyCenter(tile, poly) - averageCenter).LengthSquared();
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestPoly = members[j];
+            }
+        }
+
+        PathGraphRegion newRegion;
+        newRegion.poly_ = base | (dtPolyRef)bestPoly;
+        newRegion.center_ = GetPolyCenter(tile, tile->polys[bestPoly]);
+        graphTile.regions_.Push(newRegion);
+    }
+}
+
+/// Rebuild the edges of a tile from the links to the other tiles. The regions of the linked tiles must be up to date.
+static void BuildPathGraphEdges(PathGraph& graph, const dtNavMesh* navMesh, unsigned tileIndex)
+{
+    PathGraphTile& graphTile = graph.tiles_[tileIndex];
+    graphTile.edges_.Clear();
+    if (!graphTile.ref_)
+        return;
+
+    const dtMeshTile* tile = navMesh->getTile(tileIndex);
+    Vector<PODVector<PathGraphEdge> > regionEdges(graphTile.regions_.Size());
+
+    for (unsigned i = 0; i < graphTile.polyRegions_.Size(); ++i)
+    {
+        const dtPoly& poly = tile->polys[i];
+        const PathGraphRegion& region = graphTile.regions_[graphTile.polyRegions_[i]];
+        PODVector<PathGraphEdge>& edges = regionEdges[graphTile.polyRegions_[i]];
+
+        for (unsigned j = poly.firstLink; j != DT_NULL_LINK; j = tile->links[j].next)
+        {
+            const dtLink& link = tile->links[j];
+            if (!link.ref)
+                continue;
+            unsigned targetTileIndex = navMesh->decodePolyIdTile(link.ref);
+            if (targetTileIndex == tileIndex || targetTileIndex >= graph.tiles_.Size())
+                continue;
+            const PathGraphTile& targetTile = graph.tiles_[targetTileIndex];
+            unsigned targetPoly = navMesh->decodePolyIdPoly(link.ref);
+            if (targetPoly >= targetTile.polyRegions_.Size())
+                continue;
+            unsigned targetRegion = targetTile.polyRegions_[targetPoly];
+
+            // Off-mesh connections are entered at their center, ground polygons at the portal edge
+            Vector3 portal;
+            if (poly.getType() == DT_POLYTYPE_OFFMESH_CONNECTION || link.edge >= poly.vertCount)
+                portal = GetPolyCenter(tile, poly);
+            else
+            {
+                Vector3 v0(&tile->verts[poly.verts[link.edge] * 3]);
+                Vector3 v1(&tile->verts[poly.verts[(link.edge + 1) % poly.vertCount] * 3]);
+                portal = v0.Lerp(v1, ((float)link.bmin + (float)link.bmax) * 0.5f / 255.0f);
+            }
+            float cost = (portal - region.center_).Length() + (targetTile.regions_[targetRegion].center_ - portal).Length();
+
+            bool found = false;
+            for (unsigned k = 0; k < edges.Size(); ++k)
+            {
+                if (edges[k].tile_ == targetTileIndex && edges[k].region_ == targetRegion)
+                {
+                    edges[k].cost_ = Min(edges[k].cost_, cost);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                PathGraphEdge edge;
+                edge.tile_ = targetTileIndex;
+                edge.region_ = targetRegion;
+                edge.cost_ = cost;
+                edges.Push(edge);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < regionEdges.Size(); ++i)
+    {
+        graphTile.regions_[i].firstEdge_ = graphTile.edges_.Size();
+        graphTile.regions_[i].numEdges_ = regionEdges[i].Size();
+        graphTile.edges_.Push(regionEdges[i]);
+    }
+}
+
+/// Add the tiles at and around a tile location to a set.
+static void CollectPathGraphNeighbours(const dtNavMesh* navMesh, int x, int z, HashSet<unsigned>& dest)
+{
+    const dtMeshTile* tiles[MAX_PATH_GRAPH_LAYERS];
+    for (int dz = -1; dz <= 1; ++dz)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            int numTiles = navMesh->getTilesAt(x + dx, z + dz, tiles, MAX_PATH_GRAPH_LAYERS);
+            for (int i = 0; i < numTiles; ++i)
+                dest.Insert(navMesh->decodePolyIdTile(navMesh->getTileRef(tiles[i])));
+        }
+    }
+}
+
+/// Search the tile region graph with A*. Return the region keys from the start to the end region, or an empty list if not connected.
+static void FindPathGraphRoute(const PathGraph& graph, unsigned long long startKey, unsigned long long endKey,
+    PODVector<unsigned long long>& route)
+{
+    route.Clear();
+
+    HashMap<unsigned long long, PathGraphNode> nodes;
+    PODVector<PathGraphOpenEntry> open;
+    const Vector3& endCenter = GetPathGraphRegion(graph, endKey).center_;
+
+    PathGraphNode& startNode = nodes[startKey];
+    startNode.parent_ = INVALID_PATH_GRAPH_KEY;
+    PathGraphOpenEntry startEntry;
+    startEntry.total_ = (GetPathGraphRegion(graph, startKey).center_ - endCenter).Length();
+    startEntry.key_ = startKey;
+    open.Push(startEntry);
+
+    while (!open.Empty())
+    {
+        std::pop_heap(open.Buffer(), open.Buffer() + open.Size());
+        unsigned long long key = open.Back().key_;
+        open.Pop();
+
+        PathGraphNode& node = nodes[key];
+        if (node.closed_)
+            continue;
+        node.closed_ = true;
+        float cost = node.cost_;
+
+        if (key == endKey)
+        {
+            for (unsigned long long current = endKey; current != INVALID_PATH_GRAPH_KEY; current = nodes[current].parent_)
+                route.Push(current);
+            std::reverse(route.Buffer(), route.Buffer() + route.Size());
+            return;
+        }
+
+        const PathGraphTile& tile = graph.tiles_[(unsigned)(key >> 32u)];
+        const PathGraphRegion& region = GetPathGraphRegion(graph, key);
+        for (unsigned i = region.firstEdge_; i < region.firstEdge_ + region.numEdges_; ++i)
+        {
+            const PathGraphEdge& edge = tile.edges_[i];
+            unsigned long long neighbourKey = MakePathGraphKey(edge.tile_, edge.region_);
+            float neighbourCost = cost + edge.cost_;
+
+            HashMap<unsigned long long, PathGraphNode>::Iterator j = nodes.Find(neighbourKey);
+            if (j == nodes.End())
+                j = nodes.Insert(MakePair(neighbourKey, PathGraphNode()));
+            else if (j->second_.closed_ || neighbourCost >= j->second_.cost_)
+                continue;
+
+            j->second_.cost_ = neighbourCost;
+            j->second_.parent_ = key;
+            PathGraphOpenEntry entry;
+            entry.total_ = neighbourCost + (graph.tiles_[edge.tile_].regions_[edge.region_].center_ - endCenter).Length();
+            entry.key_ = neighbourKey;
+            open.Push(entry);
+            std::push_heap(open.Buffer(), open.Buffer() + open.Size());
+        }
+    }
+}
+
+/// Clamp the end point to the last polygon if the path is partial, and find the straight path. Return number of path points.
+static int FindStraightPath(dtNavMeshQuery* query, FindPathData& data, int numPolys, dtPolyRef endRef, const Vector3& localStart,
+    const Vector3& localEnd)
+{
+    Vector3 actualLocalEnd = localEnd;
+
+    // If full path was not found, clamp end point to the end polygon
+    if (data.polys_[numPolys - 1] != endRef)
+        query->closestPointOnPoly(data.polys_[numPolys - 1], &localEnd.x_, &actualLocalEnd.x_, nullptr);
+
+    int numPathPoints = 0;
+    query->findStraightPath(&localStart.x_, &actualLocalEnd.x_, data.polys_, numPolys, &data.pathPoints_[0].x_, data.pathFlags_,
+        data.pathPolys_, &numPathPoints, MAX_POLYS);
+    return numPathPoints;
+}
+
+/// Search the assigned path requests of a query slot until they are finished or the iterations run out.
+static void SearchPaths(PathQuerySlot* slot)
+{
+    dtNavMeshQuery* query = slot->query_;
+    auto iterations = (int)slot->iterations_;
+
+    for (unsigned i = 0; i < slot->requests_.Size() && iterations > 0; ++i)
+    {
+        PathRequest& request = *slot->requests_[i];
+        if (request.finished_)
+            continue;
+
+        if (!request.started_)
+        {
+            dtPolyRef startRef = 0;
+            query->findNearestPoly(&request.localStart_.x_, &request.extents_.x_, &request.filter_, &startRef, nullptr);
+            query->findNearestPoly(&request.localEnd_.x_, &request.extents_.x_, &request.filter_, &request.endRef_, nullptr);
+            if (!startRef || !request.endRef_)
+            {
+                request.finished_ = true;
+                continue;
+            }
+
+            query->initSlicedFindPath(startRef, request.endRef_, &request.localStart_.x_, &request.localEnd_.x_, &request.filter_);
+            request.started_ = true;
+        }
+
+        // If the budget runs out, the search continues from the same request next frame
+        int doneIterations = 0;
+        dtStatus status = query->updateSlicedFindPath(iterations, &doneIterations);
+        iterations -= doneIterations;
+        if (dtStatusInProgress(status))
+            break;
+
+        int numPolys = 0;
+        if (dtStatusSucceed(status))
+            query->finalizeSlicedFindPath(slot->data_->polys_, &numPolys, MAX_POLYS);
+        if (numPolys)
+        {
+            int numPathPoints = FindStraightPath(query, *slot->data_, numPolys, request.endRef_, request.localStart_,
+                request.localEnd_);
+            request.points_.Resize((unsigned)numPathPoints);
+            for (int j = 0; j < numPathPoints; ++j)
+                request.points_[j] = slot->data_->pathPoints_[j];
+        }
+        request.finished_ = true;
+    }
+}
+
+static void FindPathWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    SearchPaths(reinterpret_cast<PathQuerySlot*>(item->start_));
+}
+
+static String GetRegionFileName(const IntVector2& region)
+{
+    return String(region.x_) + "_" + String(region.y_) + ".navregion";
+}
+
+/// Return the distance on the XZ plane from a position relative to the bounding box minimum to a streamed region.
+static float GetRegionDistance(const IntVector2& region, float regionEdge, const Vector2& position)
+{
+    const Vector2 min = Vector2((float)region.x_, (float)region.y_) * regionEdge;
+    const Vector2 max = min + Vector2(regionEdge, regionEdge);
+    return VectorMax(VectorMax(min - position, position - max), Vector2::ZERO).Length();
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
     navMeshQuery_(nullptr),
     queryFilter_(new dtQueryFilter()),
     pathData_(new FindPathData()),
+    pendingTiles_(new PendingTileBuilds()),
+    pathRequests_(new PathRequestQueue()),
+    pathGraph_(new PathGraph()),
     tileSize_(DEFAULT_TILE_SIZE),
     cellSize_(DEFAULT_CELL_SIZE),
     cellHeight_(DEFAULT_CELL_HEIGHT),
@@ -122,7 +656,12 @@ NavigationMesh::NavigationMesh(Context* context) :
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
-    drawNavAreas_(false)
+    drawNavAreas_(false),
+    backgroundBuild_(false),
+    pathIterationBudget_(DEFAULT_PATH_ITERATION_BUDGET),
+    hierarchicalPathThreshold_(0),
+    streamingRegionSize_(DEFAULT_STREAMING_REGION_SIZE),
+    streamingDistance_(DEFAULT_STREAMING_DISTANCE)
 {
 }
 
@@ -157,6 +696,13 @@ void NavigationMesh::RegisterObject(Context* context)
         NAVMESH_PARTITION_WATERSHED, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw OffMeshConnections", GetDrawOffMeshConnections, SetDrawOffMeshConnections, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw NavAreas", GetDrawNavAreas, SetDrawNavAreas, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Hierarchical Path Threshold", GetHierarchicalPathThreshold, SetHierarchicalPathThreshold, unsigned, 0,
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Path", GetStreamingPath, SetStreamingPath, String, String::EMPTY, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Region Size", GetStreamingRegionSize, SetStreamingRegionSize, int, DEFAULT_STREAMING_REGION_SIZE,
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Distance", GetStreamingDistance, SetStreamingDistance, float, DEFAULT_STREAMING_DISTANCE,
+        AM_DEFAULT);
 }
 
 void NavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -164,31 +710,7 @@ void NavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     if (!debug || !navMesh_ || !node_)
         return;
 
-    const Matrix3x4& worldTransform = node_->GetWorldTransform();
-
-    const dtNavMesh* navMesh = navMesh_;
-
-    for (int j = 0; j < navMesh->getMaxTiles(); ++j)
-    {
-        const dtMeshTile* tile = navMesh->getTile(j);
-        assert(tile);
-        if (!tile->header)
-            continue;
-
-        for (int i = 0; i < tile->header->polyCount; ++i)
-        {
-            dtPoly* poly = tile->polys + i;
-            for (unsigned j = 0; j < poly->vertCount; ++j)
-            {
-                debug->AddLine(
-                    worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[j] * 3]),
-                    worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[(j + 1) % poly->vertCount] * 3]),
-                    Color::YELLOW,
-                    depthTest
-                );
-            }
-        }
-    }
+    DrawTileDebugGeometry(debug, depthTest);
 
     Scene* scene = GetScene();
     if (scene)
@@ -490,6 +1012,13 @@ bool NavigationMesh::Build(const BoundingBox& boundingBox)
     int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
     int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
 
+    if (backgroundBuild_)
+    {
+        unsigned numTiles = QueueBackgroundTiles(geometryList, IntVector2(sx, sz), IntVector2(ex, ez));
+        URHO3D_LOGDEBUG("Queued " + String(numTiles) + " tiles of the navigation mesh for rebuilding");
+        return true;
+    }
+
     unsigned numTiles = BuildTiles(geometryList, IntVector2(sx, sz), IntVector2(ex, ez));
 
     URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
@@ -515,12 +1044,32 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     Vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
+    if (backgroundBuild_)
+    {
+        unsigned numTiles = QueueBackgroundTiles(geometryList, from, to);
+        URHO3D_LOGDEBUG("Queued " + String(numTiles) + " tiles of the navigation mesh for rebuilding");
+        return true;
+    }
+
     unsigned numTiles = BuildTiles(geometryList, from, to);
 
     URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
     return true;
 }
 
+void NavigationMesh::SetBackgroundBuild(bool enable)
+{
+    if (!enable)
+        CompleteBackgroundBuild();
+
+    backgroundBuild_ = enable;
+}
+
+void NavigationMesh::CompleteBackgroundBuild()
+{
+    AddBackgroundTiles(true);
+}
+
 PODVector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -686,29 +1235,51 @@ void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector
     if (!startRef || !endRef)
         return;
 
-    int numPolys = 0;
+    const Vector3* pathPoints = pathData_->pathPoints_;
+    const unsigned char* pathFlags = pathData_->pathFlags_;
     int numPathPoints = 0;
 
-    navMeshQuery_->findPath(startRef, endRef, &localStart.x_, &localEnd.x_, queryFilter, pathData_->polys_, &numPolys,
-        MAX_POLYS);
-    if (!numPolys)
-        return;
-
-    Vector3 actualLocalEnd = localEnd;
+    // Plan long paths over the tile region graph first, as a single search could run out of nodes
+    PODVector<Vector3> hierarchicalPoints;
+    PODVector<unsigned char> hierarchicalFlags;
+    bool hierarchical = false;
+    if (hierarchicalPathThreshold_)
+    {
+        const dtMeshTile* startTile = nullptr;
+        const dtMeshTile* endTile = nullptr;
+        const dtPoly* poly = nullptr;
+        navMesh_->getTileAndPolyByRefUnsafe(startRef, &startTile, &poly);
+        navMesh_->getTileAndPolyByRefUnsafe(endRef, &endTile, &poly);
+        auto tileDistance = (unsigned)Max(Abs(startTile->header->x - endTile->header->x),
+            Abs(startTile->header->y - endTile->header->y));
+        if (tileDistance >= hierarchicalPathThreshold_)
+            hierarchical = FindHierarchicalPath(startRef, endRef, localStart, localEnd, queryFilter, hierarchicalPoints,
+                hierarchicalFlags);
+    }
 
-    // If full path was not found, clamp end point to the end polygon
-    if (pathData_->polys_[numPolys - 1] != endRef)
-        navMeshQuery_->closestPointOnPoly(pathData_->polys_[numPolys - 1], &localEnd.x_, &actualLocalEnd.x_, nullptr);
+    if (hierarchical)
+    {
+        pathPoints = hierarchicalPoints.Buffer();
+        pathFlags = hierarchicalFlags.Buffer();
+        numPathPoints = hierarchicalPoints.Size();
+    }
+    else
+    {
+        int numPolys = 0;
+        navMeshQuery_->findPath(startRef, endRef, &localStart.x_, &localEnd.x_, queryFilter, pathData_->polys_, &numPolys,
+            MAX_POLYS);
+        if (!numPolys)
+            return;
 
-    navMeshQuery_->findStraightPath(&localStart.x_, &actualLocalEnd.x_, pathData_->polys_, numPolys,
-        &pathData_->pathPoints_[0].x_, pathData_->pathFlags_, pathData_->pathPolys_, &numPathPoints, MAX_POLYS);
+        numPathPoints = FindStraightPath(navMeshQuery_, *pathData_, numPolys, endRef, localStart, localEnd);
+    }
 
     // Transform path result back to world space
     for (int i = 0; i < numPathPoints; ++i)
     {
         NavigationPathPoint pt;
-        pt.position_ = transform * pathData_->pathPoints_[i];
-        pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        pt.position_ = transform * pathPoints[i];
+        pt.flag_ = (NavigationPathPointFlag)pathFlags[i];
 
         // Walk through all NavAreas and find nearest
         unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
@@ -737,35 +1308,238 @@ void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector
     }
 }
 
-Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
+unsigned NavigationMesh::RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents, const dtQueryFilter* filter)
 {
-    if (!InitializeQuery())
-        return Vector3::ZERO;
-
-    dtPolyRef polyRef;
-    Vector3 point(Vector3::ZERO);
+    if (!node_)
+        return 0;
 
-    navMeshQuery_->findRandomPoint(filter ? filter : queryFilter_.Get(), Random, randomRef ? randomRef : &polyRef, &point.x_);
+    // Navigation data is in local space. Transform the points from world to local now, so that they match the request
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
 
-    return node_->GetWorldTransform() * point;
+    PathRequest request;
+    request.id_ = ++pathRequests_->nextId_;
+    if (!request.id_)
+        request.id_ = ++pathRequests_->nextId_;
+    request.start_ = start;
+    request.end_ = end;
+    request.localStart_ = inverse * start;
+    request.localEnd_ = inverse * end;
+    request.extents_ = extents;
+    request.filter_ = filter ? *filter : *queryFilter_;
+    pathRequests_->requests_.Push(request);
+
+    UpdateFrameSubscription();
+    return request.id_;
 }
 
-Vector3 NavigationMesh::GetRandomPointInCircle(const Vector3& center, float radius, const Vector3& extents,
-    const dtQueryFilter* filter, dtPolyRef* randomRef)
+bool NavigationMesh::CancelPathRequest(unsigned id)
 {
-    if (randomRef)
-        *randomRef = 0;
+    List<PathRequest>& requests = pathRequests_->requests_;
+    for (List<PathRequest>::Iterator i = requests.Begin(); i != requests.End(); ++i)
+    {
+        if (i->id_ == id)
+        {
+            if (i->slot_)
+                i->slot_->requests_.Remove(&(*i));
+            requests.Erase(i);
+            UpdateFrameSubscription();
+            return true;
+        }
+    }
 
-    if (!InitializeQuery())
-        return center;
+    return false;
+}
 
-    const Matrix3x4& transform = node_->GetWorldTransform();
-    Matrix3x4 inverse = transform.Inverse();
-    Vector3 localCenter = inverse * center;
+void NavigationMesh::SetPathIterationBudget(unsigned iterations)
+{
+    pathIterationBudget_ = Max(iterations, 1U);
+}
 
-    const dtQueryFilter* queryFilter = filter ? filter : queryFilter_.Get();
-    dtPolyRef startRef;
-    navMeshQuery_->findNearestPoly(&localCenter.x_, &extents.x_, queryFilter, &startRef, nullptr);
+void NavigationMesh::SetHierarchicalPathThreshold(unsigned tiles)
+{
+    hierarchicalPathThreshold_ = tiles;
+    MarkNetworkUpdate();
+}
+
+void NavigationMesh::UpdatePathGraph()
+{
+    if (!navMesh_)
+        return;
+
+    URHO3D_PROFILE(UpdatePathGraph);
+
+    PathGraph& graph = *pathGraph_;
+    const dtNavMesh* navMesh = navMesh_;
+    auto maxTiles = (unsigned)navMesh->getMaxTiles();
+    if (graph.tiles_.Size() != maxTiles)
+    {
+        graph.tiles_.Clear();
+        graph.tiles_.Resize(maxTiles);
+        graph.numRegions_ = 0;
+    }
+
+    // Rebuild the regions of the added and removed tiles, then the edges of them and their neighbours at the old and new locations
+    HashSet<unsigned> edgeTiles;
+    for (unsigned i = 0; i < maxTiles; ++i)
+    {
+        const dtMeshTile* tile = navMesh->getTile(i);
+        dtTileRef ref = tile->header ? navMesh->getTileRef(tile) : 0;
+        PathGraphTile& graphTile = graph.tiles_[i];
+        if (ref == graphTile.ref_)
+            continue;
+
+        if (graphTile.ref_)
+            CollectPathGraphNeighbours(navMesh, graphTile.x_, graphTile.z_, edgeTiles);
+        graph.numRegions_ -= graphTile.regions_.Size();
+        BuildPathGraphRegions(graphTile, navMesh, i);
+        graph.numRegions_ += graphTile.regions_.Size();
+        if (graphTile.ref_)
+            CollectPathGraphNeighbours(navMesh, graphTile.x_, graphTile.z_, edgeTiles);
+        edgeTiles.Insert(i);
+    }
+
+    for (HashSet<unsigned>::ConstIterator i = edgeTiles.Begin(); i != edgeTiles.End(); ++i)
+        BuildPathGraphEdges(graph, navMesh, *i);
+}
+
+void NavigationMesh::SetStreamingPath(const String& path)
+{
+    if (path != streamingPath_)
+    {
+        UnloadStreamedRegions();
+        streamingPath_ = path;
+        UpdateFrameSubscription();
+        MarkNetworkUpdate();
+    }
+}
+
+void NavigationMesh::SetStreamingRegionSize(int tiles)
+{
+    tiles = Max(tiles, 1);
+    if (tiles != streamingRegionSize_)
+    {
+        UnloadStreamedRegions();
+        streamingRegionSize_ = tiles;
+        MarkNetworkUpdate();
+    }
+}
+
+void NavigationMesh::SetStreamingDistance(float distance)
+{
+    streamingDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void NavigationMesh::AddStreamingObserver(Node* node)
+{
+    if (!node)
+        return;
+
+    for (unsigned i = 0; i < streamingObservers_.Size(); ++i)
+    {
+        if (streamingObservers_[i] == node)
+            return;
+    }
+
+    streamingObservers_.Push(WeakPtr<Node>(node));
+    UpdateFrameSubscription();
+}
+
+void NavigationMesh::RemoveStreamingObserver(Node* node)
+{
+    for (unsigned i = 0; i < streamingObservers_.Size(); ++i)
+    {
+        if (streamingObservers_[i] == node)
+        {
+            streamingObservers_.Erase(i);
+            break;
+        }
+    }
+
+    UpdateFrameSubscription();
+}
+
+bool NavigationMesh::SaveRegions(const String& directory) const
+{
+    if (!navMesh_)
+        return false;
+
+    const String path = AddTrailingSlash(directory);
+    if (!GetSubsystem<FileSystem>()->CreateDir(path))
+        return false;
+
+    const IntVector2 numRegions = GetNumStreamingRegions();
+    SharedPtr<NavigationRegion> data(new NavigationRegion(context_));
+    unsigned numSaved = 0;
+
+    for (int z = 0; z < numRegions.y_; ++z)
+    {
+        for (int x = 0; x < numRegions.x_; ++x)
+        {
+            data->Clear();
+
+            const int startX = x * streamingRegionSize_;
+            const int startZ = z * streamingRegionSize_;
+            const int endX = Min(startX + streamingRegionSize_, numTilesX_);
+            const int endZ = Min(startZ + streamingRegionSize_, numTilesZ_);
+            for (int tileZ = startZ; tileZ < endZ; ++tileZ)
+            {
+                for (int tileX = startX; tileX < endX; ++tileX)
+                {
+                    const IntVector2 tile(tileX, tileZ);
+                    PODVector<unsigned char> tileData = GetTileData(tile);
+                    if (!tileData.Empty())
+                        data->AddTile(tile, tileData);
+                }
+            }
+
+            if (!data->GetNumTiles())
+                continue;
+
+            File file(context_, path + GetRegionFileName(IntVector2(x, z)), FILE_WRITE);
+            if (!file.IsOpen() || !data->Save(file))
+            {
+                URHO3D_LOGERROR("Could not save navigation region " + file.GetName());
+                return false;
+            }
+
+            ++numSaved;
+        }
+    }
+
+    URHO3D_LOGDEBUG("Saved " + String(numSaved) + " navigation regions to " + path);
+    return true;
+}
+
+Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
+{
+    if (!InitializeQuery())
+        return Vector3::ZERO;
+
+    dtPolyRef polyRef;
+    Vector3 point(Vector3::ZERO);
+
+    navMeshQuery_->findRandomPoint(filter ? filter : queryFilter_.Get(), Random, randomRef ? randomRef : &polyRef, &point.x_);
+
+    return node_->GetWorldTransform() * point;
+}
+
+Vector3 NavigationMesh::GetRandomPointInCircle(const Vector3& center, float radius, const Vector3& extents,
+    const dtQueryFilter* filter, dtPolyRef* randomRef)
+{
+    if (randomRef)
+        *randomRef = 0;
+
+    if (!InitializeQuery())
+        return center;
+
+    const Matrix3x4& transform = node_->GetWorldTransform();
+    Matrix3x4 inverse = transform.Inverse();
+    Vector3 localCenter = inverse * center;
+
+    const dtQueryFilter* queryFilter = filter ? filter : queryFilter_.Get();
+    dtPolyRef startRef;
+    navMeshQuery_->findNearestPoly(&localCenter.x_, &extents.x_, queryFilter, &startRef, nullptr);
     if (!startRef)
         return center;
 
@@ -847,6 +1621,51 @@ Vector3 NavigationMesh::Raycast(const Vector3& start, const Vector3& end, const
     return start.Lerp(end, t);
 }
 
+void NavigationMesh::DrawTileDebugGeometry(DebugRenderer* debug, bool depthTest)
+{
+    const dtNavMesh* navMesh = navMesh_;
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    StringHash layerName(ToString("NavigationMesh_%u", GetID()));
+
+    // The tile salt changes whenever a tile is replaced or removed
+    unsigned version = depthTest ? 1 : 0;
+    for (int j = 0; j < navMesh->getMaxTiles(); ++j)
+    {
+        const dtMeshTile* tile = navMesh->getTile(j);
+        if (tile->header)
+            version = version * 31 + tile->salt * 65599 + (unsigned)j;
+    }
+
+    if (debug->DrawLayer(layerName, version, worldTransform))
+        return;
+
+    debug->BeginLayer(layerName, version, worldTransform);
+
+    for (int j = 0; j < navMesh->getMaxTiles(); ++j)
+    {
+        const dtMeshTile* tile = navMesh->getTile(j);
+        assert(tile);
+        if (!tile->header)
+            continue;
+
+        for (int i = 0; i < tile->header->polyCount; ++i)
+        {
+            dtPoly* poly = tile->polys + i;
+            for (unsigned j = 0; j < poly->vertCount; ++j)
+            {
+                debug->AddLine(
+                    *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[j] * 3]),
+                    *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[(j + 1) % poly->vertCount] * 3]),
+                    Color::YELLOW,
+                    depthTest
+                );
+            }
+        }
+    }
+
+    debug->EndLayer();
+}
+
 void NavigationMesh::DrawDebugGeometry(bool depthTest)
 {
     Scene* scene = GetScene();
@@ -869,6 +1688,27 @@ BoundingBox NavigationMesh::GetWorldBoundingBox() const
     return node_ ? boundingBox_.Transformed(node_->GetWorldTransform()) : boundingBox_;
 }
 
+unsigned NavigationMesh::GetNumPendingTiles() const
+{
+    return pendingTiles_->items_.Size();
+}
+
+unsigned NavigationMesh::GetNumPendingPaths() const
+{
+    return pathRequests_->requests_.Size();
+}
+
+IntVector2 NavigationMesh::GetNumStreamingRegions() const
+{
+    return IntVector2((numTilesX_ + streamingRegionSize_ - 1) / streamingRegionSize_,
+        (numTilesZ_ + streamingRegionSize_ - 1) / streamingRegionSize_);
+}
+
+unsigned NavigationMesh::GetNumPathGraphRegions() const
+{
+    return pathGraph_->numRegions_;
+}
+
 float NavigationMesh::GetAreaCost(unsigned areaID) const
 {
     if (queryFilter_)
@@ -940,11 +1780,13 @@ PODVector<unsigned char> NavigationMesh::GetNavigationDataAttr() const
         ret.WriteInt(params->maxTiles);
         ret.WriteInt(params->maxPolys);
 
-        const dtNavMesh* navMesh = navMesh_;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-            for (int x = 0; x < numTilesX_; ++x)
-                WriteTile(ret, x, z);
+        // Streamed tiles are saved separately as regions
+        if (streamingPath_.Empty())
+        {
+            for (int z = 0; z < numTilesZ_; ++z)
+                for (int x = 0; x < numTilesX_; ++x)
+                    WriteTile(ret, x, z);
+        }
     }
 
     return ret.GetBuffer();
@@ -1303,58 +2145,81 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 {
     URHO3D_PROFILE(BuildNavigationMeshTile);
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    UniquePtr<NavBuildData> build(CreateTileBuildData(geometryList, x, z));
+    BuildTileData(build.Get());
+    AddTileData(build.Get());
+    return build->success_;
+}
 
-    const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
+{
+    URHO3D_PROFILE(BuildNavigationMeshTiles);
 
-    SimpleNavBuildData build;
+    // Pending background tiles would later overwrite the new ones
+    CompleteBackgroundBuild();
 
-    rcConfig cfg;       // NOLINT(hicpp-member-init)
-    memset(&cfg, 0, sizeof cfg);
-    cfg.cs = cellSize_;
-    cfg.ch = cellHeight_;
-    cfg.walkableSlopeAngle = agentMaxSlope_;
-    cfg.walkableHeight = CeilToInt(agentHeight_ / cfg.ch);
-    cfg.walkableClimb = FloorToInt(agentMaxClimb_ / cfg.ch);
-    cfg.walkableRadius = CeilToInt(agentRadius_ / cfg.cs);
-    cfg.maxEdgeLen = (int)(edgeMaxLength_ / cellSize_);
-    cfg.maxSimplificationError = edgeMaxError_;
-    cfg.minRegionArea = (int)sqrtf(regionMinSize_);
-    cfg.mergeRegionArea = (int)sqrtf(regionMergeSize_);
-    cfg.maxVertsPerPoly = 6;
-    cfg.tileSize = tileSize_;
-    cfg.borderSize = cfg.walkableRadius + 3; // Add padding
-    cfg.width = cfg.tileSize + cfg.borderSize * 2;
-    cfg.height = cfg.tileSize + cfg.borderSize * 2;
-    cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
-    cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
+    unsigned numTiles = 0;
+    PODVector<NavBuildData*> builds;
 
-    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
-    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
-    cfg.bmin[0] -= cfg.borderSize * cfg.cs;
-    cfg.bmin[2] -= cfg.borderSize * cfg.cs;
-    cfg.bmax[0] += cfg.borderSize * cfg.cs;
-    cfg.bmax[2] += cfg.borderSize * cfg.cs;
+    // Collect the geometry in the main thread and build in the worker threads. Go in batches to limit the memory use
+    for (int z = from.y_; z <= to.y_; ++z)
+    {
+        for (int x = from.x_; x <= to.x_; ++x)
+        {
+            builds.Push(CreateTileBuildData(geometryList, x, z));
+            if (builds.Size() < TILE_BUILD_BATCH_SIZE && (x < to.x_ || z < to.y_))
+                continue;
+
+            BuildTileDataBatch(builds);
+            for (unsigned i = 0; i < builds.Size(); ++i)
+            {
+                numTiles += AddTileData(builds[i]);
+                delete builds[i];
+            }
+            builds.Clear();
+        }
+    }
 
+    return numTiles;
+}
+
+NavBuildData* NavigationMesh::CreateTileBuildData(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    auto* build = new SimpleNavBuildData();
+    build->tile_ = IntVector2(x, z);
+
+    rcConfig cfg;       // NOLINT(hicpp-member-init)
+    GetTileConfig(cfg, x, z);
     BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
+    GetTileGeometry(build, geometryList, expandedBox);
+    return build;
+}
+
+void NavigationMesh::BuildTileData(NavBuildData* navBuild)
+{
+    SimpleNavBuildData& build = *static_cast<SimpleNavBuildData*>(navBuild);
+
+    rcConfig cfg;       // NOLINT(hicpp-member-init)
+    GetTileConfig(cfg, build.tile_.x_, build.tile_.y_);
 
     if (build.vertices_.Empty() || build.indices_.Empty())
-        return true; // Nothing to do
+    {
+        build.success_ = true;
+        return; // Nothing to do
+    }
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return false;
+        return;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return false;
+        return;
     }
 
     unsigned numTriangles = build.indices_.Size() / 3;
@@ -1374,18 +2239,18 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     if (!build.compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return false;
+        return;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return false;
+        return;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return false;
+        return;
     }
 
     // Mark area volumes
@@ -1398,13 +2263,13 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return false;
+            return;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return false;
+            return;
         }
     }
     else
@@ -1412,7 +2277,7 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return false;
+            return;
         }
     }
 
@@ -1420,38 +2285,38 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     if (!build.contourSet_)
     {
         URHO3D_LOGERROR("Could not allocate contour set");
-        return false;
+        return;
     }
     if (!rcBuildContours(build.ctx_, *build.compactHeightField_, cfg.maxSimplificationError, cfg.maxEdgeLen,
         *build.contourSet_))
     {
         URHO3D_LOGERROR("Could not create contours");
-        return false;
+        return;
     }
 
     build.polyMesh_ = rcAllocPolyMesh();
     if (!build.polyMesh_)
     {
         URHO3D_LOGERROR("Could not allocate poly mesh");
-        return false;
+        return;
     }
     if (!rcBuildPolyMesh(build.ctx_, *build.contourSet_, cfg.maxVertsPerPoly, *build.polyMesh_))
     {
         URHO3D_LOGERROR("Could not triangulate contours");
-        return false;
+        return;
     }
 
     build.polyMeshDetail_ = rcAllocPolyMeshDetail();
     if (!build.polyMeshDetail_)
     {
         URHO3D_LOGERROR("Could not allocate detail mesh");
-        return false;
+        return;
     }
     if (!rcBuildPolyMeshDetail(build.ctx_, *build.polyMesh_, *build.compactHeightField_, cfg.detailSampleDist,
         cfg.detailSampleMaxError, *build.polyMeshDetail_))
     {
         URHO3D_LOGERROR("Could not build detail mesh");
-        return false;
+        return;
     }
 
     // Set polygon flags
@@ -1462,9 +2327,6 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1482,8 +2344,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     params.walkableHeight = agentHeight_;
     params.walkableRadius = agentRadius_;
     params.walkableClimb = agentMaxClimb_;
-    params.tileX = x;
-    params.tileY = z;
+    params.tileX = build.tile_.x_;
+    params.tileY = build.tile_.y_;
     rcVcopy(params.bmin, build.polyMesh_->bmin);
     rcVcopy(params.bmax, build.polyMesh_->bmax);
     params.cs = cfg.cs;
@@ -1501,21 +2363,40 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         params.offMeshConDir = &build.offMeshDir_[0];
     }
 
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+    if (!dtCreateNavMeshData(&params, &build.navData_, &build.navDataSize_))
     {
         URHO3D_LOGERROR("Could not build navigation mesh tile data");
-        return false;
+        return;
     }
 
-    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
+    build.success_ = true;
+}
+
+unsigned NavigationMesh::AddTileData(NavBuildData* navBuild)
+{
+    auto* build = static_cast<SimpleNavBuildData*>(navBuild);
+    const IntVector2& tile = build->tile_;
+
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(tile.x_, tile.y_, 0), nullptr, nullptr);
+
+    if (!build->success_)
+        return 0;
+    if (!build->navData_)
+        return 1; // Nothing to do
+
+    if (dtStatusFailed(navMesh_->addTile(build->navData_, build->navDataSize_, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
-        dtFree(navData);
-        return false;
+        return 0;
     }
+    // The navigation mesh owns the data now
+    build->navData_ = nullptr;
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
+        const BoundingBox tileBoundingBox = GetTileBoundingBox(tile);
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1524,24 +2405,595 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
-    return true;
+    return 1;
 }
 
-unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
+void NavigationMesh::GetTileConfig(rcConfig& cfg, int x, int z) const
+{
+    const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+
+    memset(&cfg, 0, sizeof cfg);
+    cfg.cs = cellSize_;
+    cfg.ch = cellHeight_;
+    cfg.walkableSlopeAngle = agentMaxSlope_;
+    cfg.walkableHeight = CeilToInt(agentHeight_ / cfg.ch);
+    cfg.walkableClimb = FloorToInt(agentMaxClimb_ / cfg.ch);
+    cfg.walkableRadius = CeilToInt(agentRadius_ / cfg.cs);
+    cfg.maxEdgeLen = (int)(edgeMaxLength_ / cellSize_);
+    cfg.maxSimplificationError = edgeMaxError_;
+    cfg.minRegionArea = (int)sqrtf(regionMinSize_);
+    cfg.mergeRegionArea = (int)sqrtf(regionMergeSize_);
+    cfg.maxVertsPerPoly = 6;
+    cfg.tileSize = tileSize_;
+    cfg.borderSize = cfg.walkableRadius + 3; // Add padding
+    cfg.width = cfg.tileSize + cfg.borderSize * 2;
+    cfg.height = cfg.tileSize + cfg.borderSize * 2;
+    cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
+    cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
+
+    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
+    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
+    cfg.bmin[0] -= cfg.borderSize * cfg.cs;
+    cfg.bmin[2] -= cfg.borderSize * cfg.cs;
+    cfg.bmax[0] += cfg.borderSize * cfg.cs;
+    cfg.bmax[2] += cfg.borderSize * cfg.cs;
+}
+
+void NavigationMesh::BuildTileDataBatch(const PODVector<NavBuildData*>& builds)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+    {
+        for (unsigned i = 0; i < builds.Size(); ++i)
+            BuildTileData(builds[i]);
+        return;
+    }
+
+    // The main thread waits, so the build parameters can not change meanwhile
+    for (unsigned i = 0; i < builds.Size(); ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = BuildNavigationTileWork;
+        item->name_ = "BuildNavigationTileWork";
+        item->aux_ = this;
+        item->start_ = builds[i];
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+unsigned NavigationMesh::QueueBackgroundTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from,
+    const IntVector2& to)
 {
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+        return BuildTiles(geometryList, from, to);
+
     unsigned numTiles = 0;
 
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
         {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
+            NavBuildData* build = CreateTileBuildData(geometryList, x, z);
+
+            // Low priority work runs in the low-priority pool threads across frames, or in the main thread at frame start
+            // if there are no threads. The item is not taken from the pool, so that its completed flag stays valid after
+            // the work queue has purged it
+            SharedPtr<WorkItem> item(new WorkItem());
+            item->priority_ = 0;
+            item->workClass_ = WORK_LOW;
+            item->workFunction_ = BuildNavigationTileWork;
+            item->name_ = "BuildNavigationTileWork";
+            item->aux_ = this;
+            item->start_ = build;
+            queue->AddWorkItem(item);
+
+            pendingTiles_->items_.Push(item);
+            pendingTiles_->builds_.Push(build);
+            ++numTiles;
         }
     }
+
+    UpdateFrameSubscription();
+
     return numTiles;
 }
 
+void NavigationMesh::AddBackgroundTiles(bool wait)
+{
+    Vector<SharedPtr<WorkItem> >& items = pendingTiles_->items_;
+    PODVector<NavBuildData*>& builds = pendingTiles_->builds_;
+    if (items.Empty())
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numTiles = 0;
+
+    // Stop at the first unfinished tile, so that a tile requested again later is not overwritten by its older build
+    for (; numTiles < items.Size(); ++numTiles)
+    {
+        WorkItem* item = items[numTiles];
+        if (!item->completed_)
+        {
+            if (!wait)
+                break;
+
+            // Build in the main thread if not started yet, otherwise wait for the worker thread
+            if (!queue || queue->RemoveWorkItem(items[numTiles]))
+                BuildTileData(builds[numTiles]);
+            else
+            {
+                while (!item->completed_)
+                    Time::Sleep(0);
+            }
+        }
+
+        AddTileData(builds[numTiles]);
+        delete builds[numTiles];
+    }
+
+    items.Erase(0, numTiles);
+    builds.Erase(0, numTiles);
+
+    UpdateFrameSubscription();
+
+    URHO3D_LOGDEBUG("Added " + String(numTiles) + " background built tiles to the navigation mesh");
+}
+
+void NavigationMesh::DiscardBackgroundTiles()
+{
+    Vector<SharedPtr<WorkItem> >& items = pendingTiles_->items_;
+    PODVector<NavBuildData*>& builds = pendingTiles_->builds_;
+    if (items.Empty())
+        return;
+
+    // The build data can only be freed once the worker threads are no longer using it
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < items.Size(); ++i)
+    {
+        if (queue && !queue->RemoveWorkItem(items[i]))
+        {
+            while (!items[i]->completed_)
+                Time::Sleep(0);
+        }
+        delete builds[i];
+    }
+
+    items.Clear();
+    builds.Clear();
+    UpdateFrameSubscription();
+}
+
+void NavigationMesh::UpdatePathRequests()
+{
+    List<PathRequest>& requests = pathRequests_->requests_;
+    PODVector<PathQuerySlot*>& slots = pathRequests_->slots_;
+    if (requests.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdatePathRequests);
+
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    // Use one query slot per thread, including the main thread
+    if (InitializeQuery())
+    {
+        unsigned numSlots = (queue ? queue->GetNumThreads() : 0) + 1;
+        while (slots.Size() < numSlots)
+        {
+            auto* slot = new PathQuerySlot();
+            if (!slot->query_ || dtStatusFailed(slot->query_->init(navMesh_, MAX_POLYS)))
+            {
+                URHO3D_LOGERROR("Could not create navigation mesh query");
+                delete slot;
+                break;
+            }
+            slots.Push(slot);
+        }
+    }
+
+    if (slots.Empty())
+    {
+        // No navigation data, so the requests fail
+        for (List<PathRequest>::Iterator i = requests.Begin(); i != requests.End(); ++i)
+            i->finished_ = true;
+    }
+    else
+    {
+        // Assign new requests to the least loaded slots
+        for (List<PathRequest>::Iterator i = requests.Begin(); i != requests.End(); ++i)
+        {
+            if (i->slot_)
+                continue;
+
+            PathQuerySlot* best = slots[0];
+            for (unsigned j = 1; j < slots.Size(); ++j)
+            {
+                if (slots[j]->requests_.Size() < best->requests_.Size())
+                    best = slots[j];
+            }
+            best->requests_.Push(&(*i));
+            i->slot_ = best;
+        }
+
+        // The main thread waits, so the navigation mesh can not change meanwhile
+        for (unsigned i = 0; i < slots.Size(); ++i)
+        {
+            PathQuerySlot* slot = slots[i];
+            if (slot->requests_.Empty())
+                continue;
+
+            slot->iterations_ = pathIterationBudget_;
+            if (!queue)
+            {
+                SearchPaths(slot);
+                continue;
+            }
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = FindPathWork;
+            item->name_ = "FindPathWork";
+            item->start_ = slot;
+            queue->AddWorkItem(item);
+        }
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < slots.Size(); ++i)
+        {
+            PODVector<PathRequest*>& slotRequests = slots[i]->requests_;
+            unsigned numKept = 0;
+            for (unsigned j = 0; j < slotRequests.Size(); ++j)
+            {
+                if (!slotRequests[j]->finished_)
+                    slotRequests[numKept++] = slotRequests[j];
+            }
+            slotRequests.Resize(numKept);
+        }
+    }
+
+    // Take the finished requests out before sending the events, as the event handlers may queue or cancel requests
+    Vector<PathRequest> finished;
+    for (List<PathRequest>::Iterator i = requests.Begin(); i != requests.End();)
+    {
+        if (i->finished_)
+        {
+            finished.Push(*i);
+            i = requests.Erase(i);
+        }
+        else
+            ++i;
+    }
+
+    UpdateFrameSubscription();
+
+    // Transform path results back to world space. Stop if an event handler destroys the component
+    Matrix3x4 transform = node_ ? node_->GetWorldTransform() : Matrix3x4::IDENTITY;
+    WeakPtr<NavigationMesh> self(this);
+
+    for (unsigned i = 0; i < finished.Size() && self; ++i)
+    {
+        const PathRequest& request = finished[i];
+
+        VariantVector path(request.points_.Size());
+        for (unsigned j = 0; j < request.points_.Size(); ++j)
+            path[j] = transform * request.points_[j];
+
+        using namespace NavigationPathFound;
+        VariantMap& eventData = GetContext()->GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_MESH] = this;
+        eventData[P_ID] = request.id_;
+        eventData[P_START] = request.start_;
+        eventData[P_END] = request.end_;
+        eventData[P_PATH] = path;
+        SendEvent(E_NAVIGATION_PATH_FOUND, eventData);
+    }
+}
+
+void NavigationMesh::ResetPathRequests()
+{
+    PODVector<PathQuerySlot*>& slots = pathRequests_->slots_;
+    for (unsigned i = 0; i < slots.Size(); ++i)
+        delete slots[i];
+    slots.Clear();
+
+    List<PathRequest>& requests = pathRequests_->requests_;
+    for (List<PathRequest>::Iterator i = requests.Begin(); i != requests.End(); ++i)
+    {
+        i->slot_ = nullptr;
+        i->started_ = false;
+    }
+}
+
+bool NavigationMesh::FindHierarchicalPath(dtPolyRef startRef, dtPolyRef endRef, const Vector3& localStart, const Vector3& localEnd,
+    const dtQueryFilter* filter, PODVector<Vector3>& points, PODVector<unsigned char>& flags)
+{
+    URHO3D_PROFILE(FindHierarchicalPath);
+
+    UpdatePathGraph();
+
+    const PathGraph& graph = *pathGraph_;
+    const dtNavMesh* navMesh = navMesh_;
+    unsigned long long startKey = GetPathGraphKey(graph, navMesh, startRef);
+    unsigned long long endKey = GetPathGraphKey(graph, navMesh, endRef);
+    if (startKey == INVALID_PATH_GRAPH_KEY || endKey == INVALID_PATH_GRAPH_KEY)
+        return false;
+
+    PODVector<unsigned long long> route;
+    FindPathGraphRoute(graph, startKey, endKey, route);
+    if (route.Empty())
+        return false;
+
+    HashMap<unsigned long long, unsigned> routeIndices;
+    for (unsigned i = 0; i < route.Size(); ++i)
+        routeIndices[route[i]] = i;
+
+    // Search the polygon corridor in windows of regions along the route. Only the first half of each window is kept, so that
+    // the next search can straighten the path where the windows join
+    PODVector<dtPolyRef> corridor;
+    HashMap<dtPolyRef, unsigned> corridorIndices;
+    dtPolyRef segmentStartRef = startRef;
+    Vector3 segmentStart = localStart;
+    unsigned routeIndex = 0;
+
+    for (;;)
+    {
+        bool last = routeIndex + PATH_GRAPH_REFINE_REGIONS >= route.Size() - 1;
+        dtPolyRef targetRef = endRef;
+        Vector3 target = localEnd;
+        if (!last)
+        {
+            const PathGraphRegion& region = GetPathGraphRegion(graph, route[routeIndex + PATH_GRAPH_REFINE_REGIONS]);
+            targetRef = region.poly_;
+            target = region.center_;
+        }
+
+        int numPolys = 0;
+        navMeshQuery_->findPath(segmentStartRef, targetRef, &segmentStart.x_, &target.x_, filter, pathData_->polys_, &numPolys,
+            MAX_POLYS);
+        if (!numPolys)
+            return false;
+
+        auto numCommitted = (unsigned)numPolys;
+        if (!last)
+        {
+            // Commit up to the first polygon halfway along the window, or the furthest along the route if the search was partial
+            int commitIndex = -1;
+            unsigned commitRouteIndex = routeIndex;
+            for (int i = 0; i < numPolys; ++i)
+            {
+                HashMap<unsigned long long, unsigned>::ConstIterator j =
+                    routeIndices.Find(GetPathGraphKey(graph, navMesh, pathData_->polys_[i]));
+                if (j != routeIndices.End() && j->second_ > commitRouteIndex)
+                {
+                    commitIndex = i;
+                    commitRouteIndex = j->second_;
+                    if (commitRouteIndex >= routeIndex + PATH_GRAPH_REFINE_REGIONS / 2)
+                        break;
+                }
+            }
+            if (commitIndex < 0)
+                return false;
+
+            numCommitted = (unsigned)commitIndex + 1;
+            routeIndex = commitRouteIndex;
+            segmentStartRef = pathData_->polys_[commitIndex];
+
+            const dtMeshTile* tile = nullptr;
+            const dtPoly* poly = nullptr;
+            navMesh->getTileAndPolyByRefUnsafe(segmentStartRef, &tile, &poly);
+            segmentStart = GetPolyCenter(tile, *poly);
+        }
+
+        for (unsigned i = 0; i < numCommitted; ++i)
+        {
+            dtPolyRef ref = pathData_->polys_[i];
+            HashMap<dtPolyRef, unsigned>::Iterator j = corridorIndices.Find(ref);
+            if (j == corridorIndices.End())
+            {
+                corridorIndices[ref] = corridor.Size();
+                corridor.Push(ref);
+                continue;
+            }
+
+            // Cut the loop back to the earlier visit of the polygon. This also joins the windows at their shared polygon
+            for (unsigned k = j->second_ + 1; k < corridor.Size(); ++k)
+                corridorIndices.Erase(corridor[k]);
+            corridor.Resize(j->second_ + 1);
+        }
+
+        if (last)
+            break;
+    }
+
+    // If full path was not found, clamp end point to the end polygon
+    Vector3 actualLocalEnd = localEnd;
+    if (corridor.Back() != endRef)
+        navMeshQuery_->closestPointOnPoly(corridor.Back(), &localEnd.x_, &actualLocalEnd.x_, nullptr);
+
+    int maxPoints = corridor.Size() + 2;
+    int numPoints = 0;
+    points.Resize((unsigned)maxPoints);
+    flags.Resize((unsigned)maxPoints);
+    navMeshQuery_->findStraightPath(&localStart.x_, &actualLocalEnd.x_, corridor.Buffer(), corridor.Size(), &points[0].x_,
+        flags.Buffer(), nullptr, &numPoints, maxPoints);
+    points.Resize((unsigned)numPoints);
+    flags.Resize((unsigned)numPoints);
+    return numPoints > 0;
+}
+
+void NavigationMesh::UpdateStreaming()
+{
+    if (!navMesh_ || !node_ || streamingPath_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateNavigationStreaming);
+
+    // Observer positions on the XZ plane, relative to the bounding box minimum
+    const Matrix3x4 inverseWorld = node_->GetWorldTransform().Inverse();
+    PODVector<Vector2> positions;
+    for (unsigned i = 0; i < streamingObservers_.Size();)
+    {
+        Node* observer = streamingObservers_[i];
+        if (observer)
+        {
+            const Vector3 position = inverseWorld * observer->GetWorldPosition() - boundingBox_.min_;
+            positions.Push(Vector2(position.x_, position.z_));
+            ++i;
+        }
+        else
+            streamingObservers_.Erase(i);
+    }
+
+    if (positions.Empty())
+    {
+        UpdateFrameSubscription();
+        return;
+    }
+
+    const float regionEdge = (float)(tileSize_ * streamingRegionSize_) * cellSize_;
+    const float unloadDistance = streamingDistance_ + regionEdge;
+
+    // Remove the regions far from all observers. The extra region edge avoids reloading when moving back and forth at the border
+    PODVector<IntVector2> farRegions;
+    for (HashSet<IntVector2>::ConstIterator i = streamedRegions_.Begin(); i != streamedRegions_.End(); ++i)
+    {
+        float distance = M_INFINITY;
+        for (unsigned j = 0; j < positions.Size(); ++j)
+            distance = Min(distance, GetRegionDistance(*i, regionEdge, positions[j]));
+        if (distance > unloadDistance)
+            farRegions.Push(*i);
+    }
+
+    for (unsigned i = 0; i < farRegions.Size(); ++i)
+    {
+        RemoveRegionTiles(farRegions[i]);
+        streamedRegions_.Erase(farRegions[i]);
+    }
+
+    // Request the regions near any observer
+    const IntVector2 lastRegion = GetNumStreamingRegions() - IntVector2::ONE;
+    const Vector2 distance(streamingDistance_, streamingDistance_);
+    for (unsigned i = 0; i < positions.Size(); ++i)
+    {
+        const IntVector2 from = VectorMax(IntVector2::ZERO, VectorFloorToInt((positions[i] - distance) / regionEdge));
+        const IntVector2 to = VectorMin(lastRegion, VectorFloorToInt((positions[i] + distance) / regionEdge));
+        for (int z = from.y_; z <= to.y_; ++z)
+        {
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                const IntVector2 region(x, z);
+                if (!streamedRegions_.Contains(region) && GetRegionDistance(region, regionEdge, positions[i]) <= streamingDistance_)
+                    RequestRegion(region);
+            }
+        }
+    }
+}
+
+void NavigationMesh::RequestRegion(const IntVector2& region)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    const String name = GetStreamingRegionName(region);
+    streamedRegions_.Insert(region);
+
+    // Without threading support the region is loaded immediately. A missing region file is left as an empty region
+    cache->BackgroundLoadResource<NavigationRegion>(name, false);
+    auto* data = cache->GetExistingResource<NavigationRegion>(name);
+    if (data)
+        AddRegionTiles(data);
+    else
+    {
+        loadingRegions_[StringHash(name)] = region;
+        if (!HasSubscribedToEvent(E_RESOURCEBACKGROUNDLOADED))
+            SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(NavigationMesh, HandleResourceBackgroundLoaded));
+    }
+}
+
+void NavigationMesh::AddRegionTiles(NavigationRegion* data)
+{
+    URHO3D_PROFILE(AddNavigationRegion);
+
+    for (unsigned i = 0; i < data->GetNumTiles(); ++i)
+    {
+        // Tiles built at runtime take precedence over the saved ones
+        if (!HasTile(data->GetTileIndex(i)))
+            AddTile(data->GetTileData(i));
+    }
+
+    // The tile data is now copied to the navigation mesh, so do not keep it in the cache as well
+    GetSubsystem<ResourceCache>()->ReleaseResource(NavigationRegion::GetTypeStatic(), data->GetName());
+}
+
+void NavigationMesh::RemoveRegionTiles(const IntVector2& region)
+{
+    const int startX = region.x_ * streamingRegionSize_;
+    const int startZ = region.y_ * streamingRegionSize_;
+    const int endX = Min(startX + streamingRegionSize_, numTilesX_);
+    const int endZ = Min(startZ + streamingRegionSize_, numTilesZ_);
+    for (int z = startZ; z < endZ; ++z)
+    {
+        for (int x = startX; x < endX; ++x)
+            RemoveTile(IntVector2(x, z));
+    }
+}
+
+void NavigationMesh::UnloadStreamedRegions()
+{
+    for (HashSet<IntVector2>::ConstIterator i = streamedRegions_.Begin(); i != streamedRegions_.End(); ++i)
+        RemoveRegionTiles(*i);
+    streamedRegions_.Clear();
+}
+
+String NavigationMesh::GetStreamingRegionName(const IntVector2& region) const
+{
+    return AddTrailingSlash(streamingPath_) + GetRegionFileName(region);
+}
+
+void NavigationMesh::UpdateFrameSubscription()
+{
+    bool pending = !pendingTiles_->items_.Empty() || !pathRequests_->requests_.Empty() ||
+        (!streamingPath_.Empty() && !streamingObservers_.Empty());
+    if (pending && !HasSubscribedToEvent(E_BEGINFRAME))
+        SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(NavigationMesh, HandleBeginFrame));
+    else if (!pending && HasSubscribedToEvent(E_BEGINFRAME))
+        UnsubscribeFromEvent(E_BEGINFRAME);
+}
+
+void NavigationMesh::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    UpdateStreaming();
+    AddBackgroundTiles(false);
+    UpdatePathRequests();
+}
+
+void NavigationMesh::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    HashMap<StringHash, IntVector2>::Iterator i = loadingRegions_.Find(StringHash(eventData[P_RESOURCENAME].GetString()));
+    if (i == loadingRegions_.End())
+        return;
+
+    const IntVector2 region = i->second_;
+    loadingRegions_.Erase(i);
+    if (loadingRegions_.Empty())
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+
+    auto* data = static_cast<NavigationRegion*>(eventData[P_RESOURCE].GetPtr());
+    if (!eventData[P_SUCCESS].GetBool() || !data)
+        return;
+
+    // The region may have been removed, or the streaming settings changed, while it was loading
+    if (navMesh_ && streamedRegions_.Contains(region) && data->GetName() == GetStreamingRegionName(region))
+        AddRegionTiles(data);
+    else
+        GetSubsystem<ResourceCache>()->ReleaseResource(NavigationRegion::GetTypeStatic(), data->GetName());
+}
+
 bool NavigationMesh::InitializeQuery()
 {
     if (!navMesh_ || !node_)
@@ -1568,6 +3020,12 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    DiscardBackgroundTiles();
+    ResetPathRequests();
+    pathGraph_->tiles_.Clear();
+    pathGraph_->numRegions_ = 0;
+    streamedRegions_.Clear();
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = nullptr;
 
@@ -1595,6 +3053,7 @@ void RegisterNavigationLibrary(Context* context)
     DynamicNavigationMesh::RegisterObject(context);
     Obstacle::RegisterObject(context);
     NavArea::RegisterObject(context);
+    NavigationRegion::RegisterObject(context);
 }
 
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/ArrayPtr.h"
+#include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Math/BoundingBox.h"
 #include "../Math/Matrix3x4.h"
@@ -38,6 +39,8 @@ class dtNavMesh;
 class dtNavMeshQuery;
 class dtQueryFilter;
 
+struct rcConfig;
+
 namespace Urho3D
 {
 
@@ -49,9 +52,14 @@ enum NavmeshPartitionType
 
 class Geometry;
 class NavArea;
+class NavigationRegion;
 
 struct FindPathData;
 struct NavBuildData;
+struct PathGraph;
+struct PathRequestQueue;
+struct PendingTileBuilds;
+struct WorkItem;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -92,6 +100,7 @@ class URHO3D_API NavigationMesh : public Component
     URHO3D_OBJECT(NavigationMesh, Component);
 
     friend class CrowdManager;
+    friend void BuildNavigationTileWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -142,6 +151,10 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Set whether partial rebuilds build the tiles in the background. The finished tiles are added at the start of a later frame, in the order they were requested. The build parameters must not be changed while tiles are pending. Full rebuilds always complete immediately.
+    void SetBackgroundBuild(bool enable);
+    /// Finish the tiles building in the background and add them to the navigation mesh.
+    void CompleteBackgroundBuild();
     /// Return tile data.
     virtual PODVector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -169,6 +182,29 @@ public:
     void FindPath
         (PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = nullptr);
+    /// Queue a path request between world space points. The requests are searched over the following frames using the work queue threads, and E_NAVIGATION_PATH_FOUND is sent with the returned request ID once done. The query filter is copied. Return zero if the component is not in a scene.
+    unsigned RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
+        const dtQueryFilter* filter = nullptr);
+    /// Cancel a queued path request. Return true if it was still pending.
+    bool CancelPathRequest(unsigned id);
+    /// Set the maximum number of path search iterations per thread and frame for the queued path requests.
+    void SetPathIterationBudget(unsigned iterations);
+    /// Set the minimum distance in tiles between the start and end of a path for FindPath to plan it first over the tile region graph, then refine it locally. This allows long paths exceeding the search node limit of a single query, at the cost of less optimal paths. Zero (default) disables.
+    void SetHierarchicalPathThreshold(unsigned tiles);
+    /// Update the tile region graph for the tiles that changed since the last update. Called automatically by hierarchical path queries.
+    void UpdatePathGraph();
+    /// Set the resource directory of the streamed navigation regions. When non-empty, the tiles are not saved in the navigation data attribute, but loaded in the background from region files near the streaming observers and removed when far from all of them. Empty (default) disables.
+    void SetStreamingPath(const String& path);
+    /// Set the edge length of the streamed regions in tiles.
+    void SetStreamingRegionSize(int tiles);
+    /// Set the distance from the streaming observers within which regions are loaded. Regions are removed when further than this plus one region edge from all observers.
+    void SetStreamingDistance(float distance);
+    /// Add a node around which regions are loaded.
+    void AddStreamingObserver(Node* node);
+    /// Remove a streaming observer. The loaded regions are kept while there are no observers.
+    void RemoveStreamingObserver(Node* node);
+    /// Save the current tiles as region files to a directory, which should be the streaming path within a resource directory or package. Return true if successful.
+    bool SaveRegions(const String& directory) const;
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = nullptr, dtPolyRef* randomRef = nullptr);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -272,11 +308,75 @@ public:
     /// Return whether to draw NavArea components.
     bool GetDrawNavAreas() const { return drawNavAreas_; }
 
+    /// Return whether partial rebuilds build the tiles in the background.
+    bool GetBackgroundBuild() const { return backgroundBuild_; }
+
+    /// Return number of tiles building in the background.
+    unsigned GetNumPendingTiles() const;
+
+    /// Return the maximum number of path search iterations per thread and frame for the queued path requests.
+    unsigned GetPathIterationBudget() const { return pathIterationBudget_; }
+
+    /// Return number of queued path requests.
+    unsigned GetNumPendingPaths() const;
+
+    /// Return the minimum distance in tiles between the start and end of a path for hierarchical planning.
+    unsigned GetHierarchicalPathThreshold() const { return hierarchicalPathThreshold_; }
+
+    /// Return number of regions in the tile region graph.
+    unsigned GetNumPathGraphRegions() const;
+
+    /// Return the resource directory of the streamed navigation regions.
+    const String& GetStreamingPath() const { return streamingPath_; }
+
+    /// Return the edge length of the streamed regions in tiles.
+    int GetStreamingRegionSize() const { return streamingRegionSize_; }
+
+    /// Return the distance from the streaming observers within which regions are loaded.
+    float GetStreamingDistance() const { return streamingDistance_; }
+
+    /// Return number of streamed regions in X and Z direction.
+    IntVector2 GetNumStreamingRegions() const;
+
+    /// Return number of streamed regions loaded or loading.
+    unsigned GetNumStreamedRegions() const { return streamedRegions_.Size(); }
+
 private:
     /// Write tile data.
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Build the tile data of a batch of tiles in the work queue threads and wait for completion.
+    void BuildTileDataBatch(const PODVector<NavBuildData*>& builds);
+    /// Add the finished background tiles to the navigation mesh in request order, optionally waiting for the unfinished ones.
+    void AddBackgroundTiles(bool wait);
+    /// Discard the tiles building in the background.
+    void DiscardBackgroundTiles();
+    /// Search the queued path requests for one frame and send the events of the finished ones.
+    void UpdatePathRequests();
+    /// Restart the queued path requests after the navigation mesh has been released.
+    void ResetPathRequests();
+    /// Find a path over the tile region graph, refining it locally in windows of regions. Return false if no such path was found.
+    bool FindHierarchicalPath(dtPolyRef startRef, dtPolyRef endRef, const Vector3& localStart, const Vector3& localEnd,
+        const dtQueryFilter* filter, PODVector<Vector3>& points, PODVector<unsigned char>& flags);
+    /// Load and remove streamed regions around the streaming observers.
+    void UpdateStreaming();
+    /// Queue a region to be loaded in the background.
+    void RequestRegion(const IntVector2& region);
+    /// Add the tiles of a loaded region and release the region resource.
+    void AddRegionTiles(NavigationRegion* data);
+    /// Remove the tiles of a region.
+    void RemoveRegionTiles(const IntVector2& region);
+    /// Remove the tiles of all streamed regions.
+    void UnloadStreamedRegions();
+    /// Return the resource name of a region.
+    String GetStreamingRegionName(const IntVector2& region) const;
+    /// Subscribe to the frame start event while there are background tiles, path requests or streaming observers.
+    void UpdateFrameSubscription();
+    /// Handle frame start. Update the streamed regions, add the finished background tiles and search the queued path requests.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle a background loaded resource. Add the tiles of a loaded region.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
 
 protected:
     /// Collect geometry from under Navigable components.
@@ -289,12 +389,24 @@ protected:
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
     /// Build one tile of the navigation mesh. Return true if successful.
     virtual bool BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Build tiles in the rectangular area, using the work queue threads. Return number of built tiles.
     unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Queue tiles in the rectangular area to be built in the background. Return number of queued tiles.
+    unsigned QueueBackgroundTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Create the build data of one tile and collect its geometry. The caller owns the build data.
+    virtual NavBuildData* CreateTileBuildData(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Build the Recast data of one tile. May be called from a worker thread, so must only access the build data and the build parameters.
+    virtual void BuildTileData(NavBuildData* build);
+    /// Replace one tile of the navigation mesh with the built data and send the rebuild event. Return number of added tiles.
+    virtual unsigned AddTileData(NavBuildData* build);
+    /// Return the Recast configuration of one tile.
+    void GetTileConfig(rcConfig& cfg, int x, int z) const;
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
     virtual void ReleaseNavigationMesh();
+    /// Draw the polygon edges of the tiles. They are recorded into a debug renderer layer in local space, which is rebuilt only when tiles change.
+    void DrawTileDebugGeometry(DebugRenderer* debug, bool depthTest);
 
     /// Identifying name for this navigation mesh.
     String meshName_;
@@ -306,6 +418,12 @@ protected:
     UniquePtr<dtQueryFilter> queryFilter_;
     /// Temporary data for finding a path.
     UniquePtr<FindPathData> pathData_;
+    /// Tiles building in the background.
+    UniquePtr<PendingTileBuilds> pendingTiles_;
+    /// Queued path requests.
+    UniquePtr<PathRequestQueue> pathRequests_;
+    /// Tile region graph for hierarchical path planning.
+    UniquePtr<PathGraph> pathGraph_;
     /// Tile size.
     int tileSize_;
     /// Cell size.
@@ -348,6 +466,24 @@ protected:
     bool drawOffMeshConnections_;
     /// Debug draw NavArea components.
     bool drawNavAreas_;
+    /// Build partial rebuilds in the background.
+    bool backgroundBuild_;
+    /// Path search iterations per thread and frame.
+    unsigned pathIterationBudget_;
+    /// Minimum tile distance for hierarchical path planning.
+    unsigned hierarchicalPathThreshold_;
+    /// Resource directory of the streamed regions.
+    String streamingPath_;
+    /// Edge length of the streamed regions in tiles.
+    int streamingRegionSize_;
+    /// Region load distance from the streaming observers.
+    float streamingDistance_;
+    /// Streaming observer nodes.
+    Vector<WeakPtr<Node> > streamingObservers_;
+    /// Streamed regions loaded or loading.
+    HashSet<IntVector2> streamedRegions_;
+    /// Regions loading in the background by resource name.
+    HashMap<StringHash, IntVector2> loadingRegions_;
     /// NavAreas for this NavMesh
     Vector<WeakPtr<NavArea> > areas_;
 };
@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Log.h"
+#include "../IO/Serializer.h"
+#include "../Navigation/NavigationRegion.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+NavigationRegion::NavigationRegion(Context* context) :
+    Resource(context)
+{
+}
+
+NavigationRegion::~NavigationRegion() = default;
+
+void NavigationRegion::RegisterObject(Context* context)
+{
+    context->RegisterFactory<NavigationRegion>();
+}
+
+bool NavigationRegion::BeginLoad(Deserializer& source)
+{
+    Clear();
+
+    if (source.ReadFileID() != "NREG")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid navigation region file");
+        return false;
+    }
+
+    unsigned numTiles = source.ReadVLE();
+    tiles_.Reserve(numTiles);
+    tileData_.Reserve(numTiles);
+
+    for (unsigned i = 0; i < numTiles; ++i)
+    {
+        tiles_.Push(source.ReadIntVector2());
+        tileData_.Push(source.ReadBuffer());
+        if (source.IsEof() && i + 1 < numTiles)
+        {
+            URHO3D_LOGERROR("Navigation region file " + source.GetName() + " is truncated");
+            Clear();
+            return false;
+        }
+    }
+
+    UpdateMemoryUse();
+    return true;
+}
+
+bool NavigationRegion::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID("NREG"))
+    {
+        URHO3D_LOGERROR("Can not save navigation region");
+        return false;
+    }
+
+    dest.WriteVLE(tiles_.Size());
+    for (unsigned i = 0; i < tiles_.Size(); ++i)
+    {
+        dest.WriteIntVector2(tiles_[i]);
+        dest.WriteBuffer(tileData_[i]);
+    }
+
+    return true;
+}
+
+void NavigationRegion::AddTile(const IntVector2& tile, const PODVector<unsigned char>& data)
+{
+    tiles_.Push(tile);
+    tileData_.Push(data);
+    UpdateMemoryUse();
+}
+
+void NavigationRegion::Clear()
+{
+    tiles_.Clear();
+    tileData_.Clear();
+    SetMemoryUse(0);
+}
+
+void NavigationRegion::UpdateMemoryUse()
+{
+    unsigned memoryUse = sizeof(NavigationRegion) + tiles_.Size() * (sizeof(IntVector2) + sizeof(PODVector<unsigned char>));
+    for (unsigned i = 0; i < tileData_.Size(); ++i)
+        memoryUse += tileData_[i].Size();
+    SetMemoryUse(memoryUse);
+}
+
+}
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Math/Vector2.h"
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+/// Navigation mesh tiles of one streaming region, stored as a separate resource so that the tiles can be loaded in the background and added to a NavigationMesh only around the streaming observers.
+class URHO3D_API NavigationRegion : public Resource
+{
+    URHO3D_OBJECT(NavigationRegion, Resource);
+
+public:
+    /// Construct.
+    explicit NavigationRegion(Context* context);
+    /// Destruct.
+    ~NavigationRegion() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Save resource. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Add the data of a tile, as returned by NavigationMesh::GetTileData().
+    void AddTile(const IntVector2& tile, const PODVector<unsigned char>& data);
+    /// Remove all tiles.
+    void Clear();
+
+    /// Return number of tiles.
+    unsigned GetNumTiles() const { return tiles_.Size(); }
+    /// Return index of a tile.
+    const IntVector2& GetTileIndex(unsigned index) const { return tiles_[index]; }
+    /// Return the data of a tile.
+    const PODVector<unsigned char>& GetTileData(unsigned index) const { return tileData_[index]; }
+
+private:
+    /// Recalculate the memory use.
+    void UpdateMemoryUse();
+
+    /// Tile indices.
+    PODVector<IntVector2> tiles_;
+    /// Tile data.
+    Vector<PODVector<unsigned char> > tileData_;
+};
+
+}
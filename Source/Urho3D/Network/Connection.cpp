@@ -53,15 +53,39 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+static const unsigned PACKAGE_CHUNK_SIZE = PACKAGE_CHUNK_FRAGMENTS * PACKAGE_FRAGMENT_SIZE;
+static const unsigned MAX_CONCURRENT_PACKAGE_DOWNLOADS = 4;
+static const unsigned MAX_DECOMPRESSED_BLOCK_SIZE = 16 * 1024 * 1024;
+
+/// Calculate the checksum of a package file chunk. Return 0 if the file does not contain the whole chunk.
+static unsigned GetPackageChunkChecksum(File* file, unsigned chunk, unsigned fileSize, PODVector<unsigned char>& buffer)
+{
+    unsigned start = chunk * PACKAGE_CHUNK_SIZE;
+    unsigned size = Min(PACKAGE_CHUNK_SIZE, fileSize - start);
+    if (file->GetSize() < start + size)
+        return 0;
+
+    buffer.Resize(size);
+    file->Seek(start);
+    if (file->Read(buffer.Buffer(), size) != size)
+        return 0;
+
+    unsigned checksum = 0;
+    for (unsigned i = 0; i < size; ++i)
+        checksum = SDBMHash(checksum, buffer[i]);
+    return checksum;
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
+    fileSize_(0),
     checksum_(0),
     initiated_(false)
 {
 }
 
 PackageUpload::PackageUpload() :
+    chunkIndex_(0),
     fragment_(0),
     totalFragments_(0)
 {
@@ -70,12 +94,20 @@ PackageUpload::PackageUpload() :
 Connection::Connection(Context* context, bool isClient, const SLNet::AddressOrGUID& address, SLNet::RakPeerInterface* peer) :
     Object(context),
     timeStamp_(0),
+    compressedSendPos_(0),
+    compressionThreshold_(DEFAULT_COMPRESSION_THRESHOLD),
+    replicationMutex_(nullptr),
+    interestRadius_(0.0f),
+    interestGridDirty_(true),
     peer_(peer),
     sendMode_(OPSM_NONE),
     isClient_(isClient),
     connectPending_(false),
     sceneLoaded_(false),
     logStatistics_(false),
+    prepareMessages_(false),
+    messageBatching_(false),
+    compression_(false),
     address_(nullptr)
 {
     sceneState_.connection_ = this;
@@ -114,14 +146,22 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         return;
     }
     
+    if (trafficStats_)
+        trafficStats_->RecordMessageOut(msgID, numBytes);
+
     VectorBuffer buffer;
     buffer.WriteUByte((unsigned char)msgID);
     buffer.Write(data, numBytes);
     PacketReliability reliability = reliable ? (inOrder ? RELIABLE_ORDERED : RELIABLE) : (inOrder ? UNRELIABLE_SEQUENCED : UNRELIABLE);
-    if (peer_) {
-        peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0, *address_, false);
-        tempPacketCounter_.y_++;
+    if (prepareMessages_)
+    {
+        // Hold the message until SendPreparedServerUpdate() is called from the main thread
+        preparedMessages_.WriteUByte((unsigned char)reliability);
+        preparedMessages_.WriteBuffer(buffer.GetBuffer());
+        return;
     }
+
+    SendPacket(buffer.GetData(), buffer.GetSize(), (unsigned char)reliability);
 }
 
 void Connection::SendRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData)
@@ -226,6 +266,17 @@ void Connection::SetRotation(const Quaternion& rotation)
         sendMode_ = OPSM_POSITION_ROTATION;
 }
 
+void Connection::SetInterestRadius(float radius)
+{
+    radius = Max(radius, 0.0f);
+    if (radius != interestRadius_)
+    {
+        interestRadius_ = radius;
+        // The grid cell size follows the radius, so the held back nodes need to be sorted again
+        interestGridDirty_ = true;
+    }
+}
+
 void Connection::SetConnectPending(bool connectPending)
 {
     connectPending_ = connectPending;
@@ -236,8 +287,40 @@ void Connection::SetLogStatistics(bool enable)
     logStatistics_ = enable;
 }
 
+void Connection::SetTrafficProfiling(bool enable)
+{
+    if (enable && !trafficStats_)
+        trafficStats_ = new NetworkTrafficStats();
+    else if (!enable)
+        trafficStats_.Reset();
+}
+
+void Connection::SetMessageBatching(bool enable)
+{
+    if (!enable)
+        FlushMessageBatches();
+
+    messageBatching_ = enable;
+}
+
+void Connection::SetCompression(bool enable, unsigned threshold)
+{
+    if (!enable)
+        FlushCompressedMessages();
+
+    compression_ = enable;
+    compressionThreshold_ = threshold;
+}
+
+void Connection::SetCompressionDictionary(const PODVector<unsigned char>& dictionary)
+{
+    sendCompressor_.Reset(dictionary);
+    receiveCompressor_.Reset(dictionary);
+}
+
 void Connection::Disconnect(int waitMSec)
 {
+    FlushMessageBatches();
     peer_->CloseConnection(*address_, true);
 }
 
@@ -256,6 +339,19 @@ void Connection::SendServerUpdate()
     nodesToProcess_.Insert(sceneState_.dirtyNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
+    if (interestRadius_ > 0.0f)
+        UpdateInterestArea();
+    else if (sceneState_.deferredNodes_.Size())
+    {
+        // Interest management has been disabled: send all nodes that were held back
+        for (HashMap<unsigned, IntVector3>::ConstIterator i = sceneState_.deferredNodes_.Begin();
+             i != sceneState_.deferredNodes_.End(); ++i)
+            nodesToProcess_.Insert(i->first_);
+        sceneState_.deferredNodes_.Clear();
+        sceneState_.deferredCells_.Clear();
+        interestGridDirty_ = true;
+    }
+
     while (nodesToProcess_.Size())
     {
         unsigned nodeID = nodesToProcess_.Front();
@@ -263,6 +359,42 @@ void Connection::SendServerUpdate()
     }
 }
 
+void Connection::PrepareServerUpdate(Mutex* replicationMutex)
+{
+    replicationMutex_ = replicationMutex;
+    prepareMessages_ = true;
+    SendServerUpdate();
+    prepareMessages_ = false;
+    replicationMutex_ = nullptr;
+}
+
+void Connection::SendPreparedServerUpdate()
+{
+    if (!preparedMessages_.GetSize())
+        return;
+
+    preparedMessages_.Seek(0);
+    while (!preparedMessages_.IsEof())
+    {
+        unsigned char reliability = preparedMessages_.ReadUByte();
+        unsigned numBytes = preparedMessages_.ReadVLE();
+        const unsigned char* data = preparedMessages_.GetData() + preparedMessages_.GetPosition();
+        preparedMessages_.Seek(preparedMessages_.GetPosition() + numBytes);
+
+        SendPacket(data, numBytes, reliability);
+    }
+
+    preparedMessages_.Clear();
+}
+
+void Connection::FlushMessageBatches()
+{
+    FlushCompressedMessages();
+    for (unsigned char i = 0; i < 4; ++i)
+        FlushMessageBatch(i);
+    SendCompressedFragments();
+}
+
 void Connection::SendClientUpdate()
 {
     if (!scene_ || !sceneLoaded_)
@@ -277,7 +409,7 @@ void Connection::SendClientUpdate()
     if (sendMode_ >= OPSM_POSITION)
         msg_.WriteVector3(position_);
     if (sendMode_ >= OPSM_POSITION_ROTATION)
-        msg_.WritePackedQuaternion(rotation_);
+        msg_.WriteCompactQuaternion(rotation_);
     SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
     ++timeStamp_;
@@ -312,21 +444,33 @@ void Connection::SendRemoteEvents()
 
     URHO3D_PROFILE(SendRemoteEvents);
 
+    auto* network = GetSubsystem<Network>();
+
     for (Vector<RemoteEvent>::ConstIterator i = remoteEvents_.Begin(); i != remoteEvents_.End(); ++i)
     {
         msg_.Clear();
         if (!i->senderID_)
         {
             msg_.WriteStringHash(i->eventType_);
-            msg_.WriteVariantMap(i->eventData_);
-            SendMessage(MSG_REMOTEEVENT, true, i->inOrder_, msg_);
+            if (network->WriteCompactRemoteEventData(msg_, i->eventType_, i->eventData_))
+                SendMessage(MSG_COMPACTREMOTEEVENT, true, i->inOrder_, msg_);
+            else
+            {
+                msg_.WriteVariantMap(i->eventData_);
+                SendMessage(MSG_REMOTEEVENT, true, i->inOrder_, msg_);
+            }
         }
         else
         {
             msg_.WriteNetID(i->senderID_);
             msg_.WriteStringHash(i->eventType_);
-            msg_.WriteVariantMap(i->eventData_);
-            SendMessage(MSG_REMOTENODEEVENT, true, i->inOrder_, msg_);
+            if (network->WriteCompactRemoteEventData(msg_, i->eventType_, i->eventData_))
+                SendMessage(MSG_COMPACTREMOTENODEEVENT, true, i->inOrder_, msg_);
+            else
+            {
+                msg_.WriteVariantMap(i->eventData_);
+                SendMessage(MSG_REMOTENODEEVENT, true, i->inOrder_, msg_);
+            }
         }
     }
 
@@ -343,6 +487,7 @@ void Connection::SendPackages()
         {
             HashMap<StringHash, PackageUpload>::Iterator current = i++;
             PackageUpload& upload = current->second_;
+            upload.file_->Seek(upload.fragment_ * PACKAGE_FRAGMENT_SIZE);
             auto fragmentSize =
                 (unsigned)Min((int)(upload.file_->GetSize() - upload.file_->GetPosition()), (int)PACKAGE_FRAGMENT_SIZE);
             upload.file_->Read(buffer, fragmentSize);
@@ -353,9 +498,14 @@ void Connection::SendPackages()
             msg_.Write(buffer, fragmentSize);
             SendMessage(MSG_PACKAGEDATA, true, false, msg_);
 
-            // Check if upload finished
-            if (upload.fragment_ == upload.totalFragments_)
-                uploads_.Erase(current);
+            // At the end of a chunk, skip to the next chunk to send, or finish the upload
+            if (upload.fragment_ % PACKAGE_CHUNK_FRAGMENTS == 0 || upload.fragment_ == upload.totalFragments_)
+            {
+                if (++upload.chunkIndex_ < upload.chunks_.Size())
+                    upload.fragment_ = upload.chunks_[upload.chunkIndex_] * PACKAGE_CHUNK_FRAGMENTS;
+                else
+                    uploads_.Erase(current);
+            }
         }
     }
 }
@@ -402,6 +552,15 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
     // New incomming message, reset last heard timer
     lastHeardTimer_.Reset();
     tempPacketCounter_.x_++;
+
+    return DispatchMessage(msgID, msg);
+}
+
+bool Connection::DispatchMessage(int msgID, MemoryBuffer& msg)
+{
+    if (trafficStats_)
+        trafficStats_->RecordMessageIn(msgID, msg.GetSize());
+
     bool processed = true;
 
     switch (msgID)
@@ -420,6 +579,7 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
 
     case MSG_REQUESTPACKAGE:
     case MSG_PACKAGEDATA:
+    case MSG_PACKAGECHUNKS:
         ProcessPackageDownload(msgID, msg);
         break;
 
@@ -444,6 +604,8 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
 
     case MSG_REMOTEEVENT:
     case MSG_REMOTENODEEVENT:
+    case MSG_COMPACTREMOTEEVENT:
+    case MSG_COMPACTREMOTENODEEVENT:
         ProcessRemoteEvent(msgID, msg);
         break;
 
@@ -451,6 +613,14 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
         ProcessPackageInfo(msgID, msg);
         break;
 
+    case MSG_BATCH:
+        ProcessMessageBatch(msg);
+        break;
+
+    case MSG_COMPRESSED:
+        ProcessCompressedFragment(msg);
+        break;
+
     default:
         processed = false;
         break;
@@ -781,11 +951,41 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
                         return;
                     }
 
-                    URHO3D_LOGINFO("Transmitting package file " + name + " to client " + ToString());
+                    PackageUpload& upload = uploads_[nameHash];
+                    upload.file_ = file;
+                    upload.totalFragments_ = (file->GetSize() + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+                    unsigned totalChunks = (upload.totalFragments_ + PACKAGE_CHUNK_FRAGMENTS - 1) / PACKAGE_CHUNK_FRAGMENTS;
+
+                    // Skip the chunks that the client already has intact from an interrupted download
+                    unsigned numChecksums = msg.IsEof() ? 0 : Min(msg.ReadVLE(), totalChunks);
+                    PODVector<unsigned char> chunkBuffer;
+                    for (unsigned j = 0; j < totalChunks; ++j)
+                    {
+                        if (j < numChecksums && msg.ReadUInt() == GetPackageChunkChecksum(file, j, file->GetSize(), chunkBuffer))
+                            continue;
+                        upload.chunks_.Push(j);
+                    }
 
-                    uploads_[nameHash].file_ = file;
-                    uploads_[nameHash].fragment_ = 0;
-                    uploads_[nameHash].totalFragments_ = (file->GetSize() + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+                    if (numChecksums)
+                    {
+                        URHO3D_LOGINFO("Resuming transmission of package file " + name + " to client " + ToString() + ", " +
+                            String(upload.chunks_.Size()) + "/" + String(totalChunks) + " chunks remaining");
+                    }
+                    else
+                        URHO3D_LOGINFO("Transmitting package file " + name + " to client " + ToString());
+
+                    // Tell the client which chunks to expect, so that it knows when the download is complete
+                    msg_.Clear();
+                    msg_.WriteStringHash(nameHash);
+                    msg_.WriteVLE(upload.chunks_.Size());
+                    for (unsigned j = 0; j < upload.chunks_.Size(); ++j)
+                        msg_.WriteVLE(upload.chunks_[j]);
+                    SendMessage(MSG_PACKAGECHUNKS, true, true, msg_);
+
+                    if (upload.chunks_.Size())
+                        upload.fragment_ = upload.chunks_[0] * PACKAGE_CHUNK_FRAGMENTS;
+                    else
+                        uploads_.Erase(nameHash);
                     return;
                 }
             }
@@ -822,12 +1022,12 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
                 return;
             }
 
-            // If file has not yet been opened, try to open now. Prepend the checksum to the filename to allow multiple versions
+            // If file has not yet been opened, try to open now. Keep the intact chunks of an interrupted download
             if (!download.file_)
             {
-                download.file_ = new File(context_,
-                    GetSubsystem<Network>()->GetPackageCacheDir() + ToStringHex(download.checksum_) + "_" + download.name_,
-                    FILE_WRITE);
+                String fileName = GetPartialPackageFileName(download);
+                download.file_ = new File(context_, fileName,
+                    GetSubsystem<FileSystem>()->FileExists(fileName) ? FILE_READWRITE : FILE_WRITE);
                 if (!download.file_->IsOpen())
                 {
                     OnPackageDownloadFailed(download.name_);
@@ -845,30 +1045,50 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
             download.file_->Write(buffer, fragmentSize);
             download.receivedFragments_.Insert(index);
 
-            // Check if all fragments received
-            if (download.receivedFragments_.Size() == download.totalFragments_)
-            {
-                URHO3D_LOGINFO("Package " + download.name_ + " downloaded successfully");
+            CheckPackageDownloaded(i);
+        }
+        break;
 
-                // Instantiate the package and add to the resource system, as we will need it to load the scene
-                download.file_->Close();
-                GetSubsystem<ResourceCache>()->AddPackageFile(download.file_->GetName(), 0);
+    case MSG_PACKAGECHUNKS:
+        if (IsClient())
+        {
+            URHO3D_LOGWARNING("Received unexpected PackageChunks message from client");
+            return;
+        }
+        else
+        {
+            StringHash nameHash = msg.ReadStringHash();
 
-                // Then start the next download if there are more
-                downloads_.Erase(i);
-                if (downloads_.Empty())
-                    OnPackagesReady();
-                else
-                {
-                    PackageDownload& nextDownload = downloads_.Begin()->second_;
+            HashMap<StringHash, PackageDownload>::Iterator i = downloads_.Find(nameHash);
+            if (i == downloads_.End())
+                return;
 
-                    URHO3D_LOGINFO("Requesting package " + nextDownload.name_ + " from server");
-                    msg_.Clear();
-                    msg_.WriteString(nextDownload.name_);
-                    SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
-                    nextDownload.initiated_ = true;
-                }
+            PackageDownload& download = i->second_;
+            unsigned totalChunks = (download.totalFragments_ + PACKAGE_CHUNK_FRAGMENTS - 1) / PACKAGE_CHUNK_FRAGMENTS;
+            PODVector<bool> chunksToReceive(totalChunks);
+            for (unsigned j = 0; j < totalChunks; ++j)
+                chunksToReceive[j] = false;
+
+            unsigned numChunks = msg.ReadVLE();
+            for (unsigned j = 0; j < numChunks; ++j)
+            {
+                unsigned chunk = msg.ReadVLE();
+                if (chunk < totalChunks)
+                    chunksToReceive[chunk] = true;
+            }
+
+            // The fragments of the chunks that will not be sent are already intact in the partial file
+            for (unsigned j = 0; j < totalChunks; ++j)
+            {
+                if (chunksToReceive[j])
+                    continue;
+
+                unsigned endFragment = Min((j + 1) * PACKAGE_CHUNK_FRAGMENTS, download.totalFragments_);
+                for (unsigned k = j * PACKAGE_CHUNK_FRAGMENTS; k < endFragment; ++k)
+                    download.receivedFragments_.Insert(k);
             }
+
+            CheckPackageDownloaded(i);
         }
         break;
 
@@ -919,7 +1139,7 @@ void Connection::ProcessControls(int msgID, MemoryBuffer& msg)
     if (!msg.IsEof())
         position_ = msg.ReadVector3();
     if (!msg.IsEof())
-        rotation_ = msg.ReadPackedQuaternion();
+        rotation_ = msg.ReadCompactQuaternion();
 }
 
 void Connection::ProcessSceneLoaded(int msgID, MemoryBuffer& msg)
@@ -961,16 +1181,26 @@ void Connection::ProcessRemoteEvent(int msgID, MemoryBuffer& msg)
 {
     using namespace RemoteEventData;
 
-    if (msgID == MSG_REMOTEEVENT)
+    auto* network = GetSubsystem<Network>();
+    bool compact = msgID == MSG_COMPACTREMOTEEVENT || msgID == MSG_COMPACTREMOTENODEEVENT;
+
+    if (msgID == MSG_REMOTEEVENT || msgID == MSG_COMPACTREMOTEEVENT)
     {
         StringHash eventType = msg.ReadStringHash();
-        if (!GetSubsystem<Network>()->CheckRemoteEvent(eventType))
+        if (!network->CheckRemoteEvent(eventType))
         {
             URHO3D_LOGWARNING("Discarding not allowed remote event " + eventType.ToString());
             return;
         }
 
-        VariantMap eventData = msg.ReadVariantMap();
+        VariantMap eventData;
+        if (!compact)
+            eventData = msg.ReadVariantMap();
+        else if (!network->ReadCompactRemoteEventData(msg, eventType, eventData))
+        {
+            URHO3D_LOGWARNING("Discarding remote event " + eventType.ToString() + " without a registered schema");
+            return;
+        }
         eventData[P_CONNECTION] = this;
         SendEvent(eventType, eventData);
     }
@@ -984,13 +1214,20 @@ void Connection::ProcessRemoteEvent(int msgID, MemoryBuffer& msg)
 
         unsigned nodeID = msg.ReadNetID();
         StringHash eventType = msg.ReadStringHash();
-        if (!GetSubsystem<Network>()->CheckRemoteEvent(eventType))
+        if (!network->CheckRemoteEvent(eventType))
         {
             URHO3D_LOGWARNING("Discarding not allowed remote event " + eventType.ToString());
             return;
         }
 
-        VariantMap eventData = msg.ReadVariantMap();
+        VariantMap eventData;
+        if (!compact)
+            eventData = msg.ReadVariantMap();
+        else if (!network->ReadCompactRemoteEventData(msg, eventType, eventData))
+        {
+            URHO3D_LOGWARNING("Discarding remote event " + eventType.ToString() + " without a registered schema");
+            return;
+        }
         Node* sender = scene_->GetNode(nodeID);
         if (!sender)
         {
@@ -1002,6 +1239,218 @@ void Connection::ProcessRemoteEvent(int msgID, MemoryBuffer& msg)
     }
 }
 
+void Connection::ProcessMessageBatch(MemoryBuffer& msg)
+{
+    while (!msg.IsEof())
+    {
+        unsigned numBytes = msg.ReadVLE();
+        if (!numBytes || msg.GetPosition() + numBytes > msg.GetSize())
+        {
+            URHO3D_LOGERROR("Malformed message batch");
+            return;
+        }
+
+        const unsigned char* data = msg.GetData() + msg.GetPosition();
+        msg.Seek(msg.GetPosition() + numBytes);
+
+        int msgID = data[0];
+        if (msgID == MSG_BATCH || msgID == MSG_COMPRESSED)
+        {
+            URHO3D_LOGERROR("Nested message batch, discarding");
+            continue;
+        }
+
+        MemoryBuffer subMsg(data + 1, numBytes - 1);
+        if (!DispatchMessage(msgID, subMsg))
+        {
+            // If message was not handled internally, forward as an event, like Network does for a standalone message
+            using namespace NetworkMessage;
+
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_CONNECTION] = this;
+            eventData[P_MESSAGEID] = msgID;
+            eventData[P_DATA].SetBuffer(subMsg.GetData(), subMsg.GetSize());
+            SendEvent(E_NETWORKMESSAGE, eventData);
+        }
+    }
+}
+
+void Connection::ProcessCompressedFragment(MemoryBuffer& msg)
+{
+    compressedInput_.Insert(compressedInput_.End(), msg.GetData(), msg.GetData() + msg.GetSize());
+
+    // Fragments may split blocks anywhere, so process the blocks completed so far and keep the rest
+    unsigned consumed = 0;
+    PODVector<unsigned char> block;
+    while (compressedInput_.Size() - consumed >= 2 * sizeof(unsigned))
+    {
+        MemoryBuffer header(compressedInput_.Buffer() + consumed, 2 * sizeof(unsigned));
+        unsigned uncompressedSize = header.ReadUInt();
+        unsigned compressedSize = header.ReadUInt();
+        if (!uncompressedSize || uncompressedSize > MAX_DECOMPRESSED_BLOCK_SIZE ||
+            compressedSize > EstimateCompressBound(uncompressedSize))
+        {
+            URHO3D_LOGERROR("Malformed compressed message stream");
+            compressedInput_.Clear();
+            return;
+        }
+        if (compressedInput_.Size() - consumed - 2 * sizeof(unsigned) < compressedSize)
+            break;
+
+        block.Resize(uncompressedSize);
+        if (!receiveCompressor_.Decompress(block.Buffer(), compressedInput_.Buffer() + consumed + 2 * sizeof(unsigned),
+            compressedSize, uncompressedSize))
+        {
+            URHO3D_LOGERROR("Failed to decompress compressed message stream");
+            compressedInput_.Clear();
+            return;
+        }
+        consumed += 2 * sizeof(unsigned) + compressedSize;
+
+        MemoryBuffer messages(block);
+        ProcessMessageBatch(messages);
+    }
+
+    if (consumed)
+        compressedInput_.Erase(0, consumed);
+}
+
+void Connection::FlushCompressedMessages()
+{
+    if (!compressBatch_.GetSize())
+        return;
+
+    // Once compressed data is held back, the following reliable messages must follow it to keep their order
+    unsigned srcSize = compressBatch_.GetSize();
+    if (srcSize >= compressionThreshold_ || GetNumPendingCompressedBytes())
+    {
+        compressBuffer_.Resize(EstimateCompressBound(srcSize));
+        unsigned compressedSize = sendCompressor_.Compress(compressBuffer_.Buffer(), compressBatch_.GetData(), srcSize);
+        if (compressedSize)
+        {
+            if (!GetNumPendingCompressedBytes())
+            {
+                compressedOutput_.Clear();
+                compressedSendPos_ = 0;
+            }
+            compressedOutput_.Seek(compressedOutput_.GetSize());
+            compressedOutput_.WriteUInt(srcSize);
+            compressedOutput_.WriteUInt(compressedSize);
+            compressedOutput_.Write(compressBuffer_.Buffer(), compressedSize);
+
+            compressBatch_.Clear();
+            compressReliabilities_.Clear();
+            return;
+        }
+        else
+            URHO3D_LOGERROR("Failed to compress messages, sending uncompressed");
+    }
+
+    MemoryBuffer messages(compressBatch_.GetData(), srcSize);
+    for (unsigned i = 0; i < compressReliabilities_.Size(); ++i)
+    {
+        unsigned numBytes = messages.ReadVLE();
+        const unsigned char* data = messages.GetData() + messages.GetPosition();
+        messages.Seek(messages.GetPosition() + numBytes);
+        SendUncompressedPacket(data, numBytes, compressReliabilities_[i]);
+    }
+
+    compressBatch_.Clear();
+    compressReliabilities_.Clear();
+}
+
+void Connection::SendCompressedFragments()
+{
+    if (!peer_ || !GetNumPendingCompressedBytes())
+        return;
+
+    // Keep the send buffers short, so that a large scene state does not delay the other messages for long
+    unsigned inFlight = 0;
+    SLNet::RakNetStatistics stats{};
+    if (peer_->GetStatistics(address_->systemAddress, &stats))
+        inFlight = (unsigned)(stats.bytesInSendBuffer[HIGH_PRIORITY] + stats.bytesInResendBuffer);
+
+    VectorBuffer fragment;
+    while (GetNumPendingCompressedBytes() && inFlight < MAX_COMPRESSED_BYTES_IN_FLIGHT)
+    {
+        unsigned size = Min(GetNumPendingCompressedBytes(), COMPRESSED_FRAGMENT_SIZE);
+        fragment.Clear();
+        fragment.WriteUByte((unsigned char)MSG_COMPRESSED);
+        fragment.Write(compressedOutput_.GetData() + compressedSendPos_, size);
+
+        peer_->Send((const char*)fragment.GetData(), (int)fragment.GetSize(), HIGH_PRIORITY, RELIABLE_ORDERED, (char)0, *address_,
+            false);
+        tempPacketCounter_.y_++;
+
+        compressedSendPos_ += size;
+        inFlight += size;
+    }
+
+    if (!GetNumPendingCompressedBytes())
+    {
+        compressedOutput_.Clear();
+        compressedSendPos_ = 0;
+    }
+}
+
+void Connection::SendPacket(const unsigned char* data, unsigned numBytes, unsigned char reliability)
+{
+    if (!peer_)
+        return;
+
+    // Coalesce the reliable messages of the frame, to decide on the flush whether to compress them
+    if ((compression_ || GetNumPendingCompressedBytes()) && (reliability == RELIABLE || reliability == RELIABLE_ORDERED))
+    {
+        compressBatch_.WriteVLE(numBytes);
+        compressBatch_.Write(data, numBytes);
+        compressReliabilities_.Push(reliability);
+        return;
+    }
+
+    SendUncompressedPacket(data, numBytes, reliability);
+}
+
+void Connection::SendUncompressedPacket(const unsigned char* data, unsigned numBytes, unsigned char reliability)
+{
+    if (!peer_)
+        return;
+
+    if (messageBatching_ && numBytes <= MAX_BATCHED_MESSAGE_SIZE && reliability < 4)
+    {
+        VectorBuffer& batch = messageBatches_[reliability];
+        if (batch.GetSize() + numBytes + 4 > MAX_MESSAGE_BATCH_SIZE)
+            FlushMessageBatch(reliability);
+        if (!batch.GetSize())
+            batch.WriteUByte((unsigned char)MSG_BATCH);
+        batch.WriteVLE(numBytes);
+        batch.Write(data, numBytes);
+        return;
+    }
+
+    // Send the earlier coalesced messages first to keep the order
+    if (reliability < 4)
+        FlushMessageBatch(reliability);
+
+    peer_->Send((const char*)data, (int)numBytes, HIGH_PRIORITY, (PacketReliability)reliability, (char)0, *address_, false);
+    tempPacketCounter_.y_++;
+}
+
+void Connection::FlushMessageBatch(unsigned char reliability)
+{
+    VectorBuffer& batch = messageBatches_[reliability];
+    if (!batch.GetSize())
+        return;
+
+    if (peer_)
+    {
+        peer_->Send((const char*)batch.GetData(), (int)batch.GetSize(), HIGH_PRIORITY, (PacketReliability)reliability, (char)0,
+            *address_, false);
+        tempPacketCounter_.y_++;
+    }
+
+    batch.Clear();
+}
+
 Scene* Connection::GetScene() const
 {
     return scene_;
@@ -1154,7 +1603,11 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
+            RecordReplicationTraffic(nodeID, nullptr, msg_.GetSize());
+            // Releasing the weak references to the removed node and its components touches shared reference counts
+            LockReplication();
             sceneState_.nodeStates_.Erase(nodeID);
+            UnlockReplication();
         }
         else
             ProcessExistingNode(node, i->second_);
@@ -1190,8 +1643,10 @@ void Connection::ProcessNewNode(Node* node)
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
+    LockReplication();
     nodeState.node_ = node;
     node->AddReplicationState(&nodeState);
+    UnlockReplication();
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1218,15 +1673,21 @@ void Connection::ProcessNewNode(Node* node)
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
+        LockReplication();
         componentState.component_ = component;
         component->AddReplicationState(&componentState);
+        UnlockReplication();
 
+        unsigned componentStart = msg_.GetSize();
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
         component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+        if (trafficStats_)
+            trafficStats_->RecordComponent(component->GetType(), msg_.GetSize() - componentStart);
     }
 
     SendMessage(MSG_CREATENODE, true, true, msg_);
+    RecordReplicationTraffic(node->GetID(), nullptr, msg_.GetSize());
 
     nodeState.markedDirty_ = false;
     sceneState_.dirtyNodes_.Erase(node->GetID());
@@ -1277,6 +1738,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             node->WriteLatestDataUpdate(msg_, timeStamp_);
 
             SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
+            RecordReplicationTraffic(node->GetID(), nullptr, msg_.GetSize());
         }
 
         // Send deltaupdate if remaining dirty bits, or vars have changed
@@ -1307,6 +1769,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             }
 
             SendMessage(MSG_NODEDELTAUPDATE, true, true, msg_);
+            RecordReplicationTraffic(node->GetID(), nullptr, msg_.GetSize());
 
             nodeState.dirtyAttributes_.ClearAll();
             nodeState.dirtyVars_.Clear();
@@ -1327,7 +1790,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first_);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
+            RecordReplicationTraffic(node->GetID(), nullptr, msg_.GetSize());
+            LockReplication();
             nodeState.componentStates_.Erase(current);
+            UnlockReplication();
         }
         else
         {
@@ -1355,6 +1821,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     component->WriteLatestDataUpdate(msg_, timeStamp_);
 
                     SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
+                    RecordReplicationTraffic(node->GetID(), component, msg_.GetSize());
                 }
 
                 // Send deltaupdate if remaining dirty bits
@@ -1365,6 +1832,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
 
                     SendMessage(MSG_COMPONENTDELTAUPDATE, true, true, msg_);
+                    RecordReplicationTraffic(node->GetID(), component, msg_.GetSize());
 
                     componentState.dirtyAttributes_.ClearAll();
                 }
@@ -1390,8 +1858,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
+                LockReplication();
                 componentState.component_ = component;
                 component->AddReplicationState(&componentState);
+                UnlockReplication();
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -1400,6 +1870,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 component->WriteInitialDeltaUpdate(msg_, timeStamp_);
 
                 SendMessage(MSG_CREATECOMPONENT, true, true, msg_);
+                RecordReplicationTraffic(node->GetID(), component, msg_.GetSize());
             }
         }
     }
@@ -1488,17 +1959,104 @@ void Connection::RequestPackage(const String& name, unsigned fileSize, unsigned
     PackageDownload& download = downloads_[nameHash];
     download.name_ = name;
     download.totalFragments_ = (fileSize + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+    download.fileSize_ = fileSize;
     download.checksum_ = checksum;
 
-    // Start download now only if no existing downloads, else wait for the existing ones to finish
-    if (downloads_.Size() == 1)
+    // Start download now only if under the concurrent download limit, else wait for the existing ones to finish
+    RequestQueuedPackages();
+}
+
+void Connection::SendPackageRequest(PackageDownload& download)
+{
+    msg_.Clear();
+    msg_.WriteString(download.name_);
+
+    // If an earlier attempt was interrupted, send the checksums of the chunks in the partial file so that the server
+    // can skip the intact ones
+    String fileName = GetPartialPackageFileName(download);
+    if (GetSubsystem<FileSystem>()->FileExists(fileName))
     {
-        URHO3D_LOGINFO("Requesting package " + name + " from server");
-        msg_.Clear();
-        msg_.WriteString(name);
-        SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
-        download.initiated_ = true;
+        SharedPtr<File> file(new File(context_, fileName));
+        unsigned totalChunks = (download.totalFragments_ + PACKAGE_CHUNK_FRAGMENTS - 1) / PACKAGE_CHUNK_FRAGMENTS;
+        unsigned numChecksums = Min((file->GetSize() + PACKAGE_CHUNK_SIZE - 1) / PACKAGE_CHUNK_SIZE, totalChunks);
+        PODVector<unsigned char> chunkBuffer;
+
+        URHO3D_LOGINFO("Resuming download of package " + download.name_ + " from server");
+        msg_.WriteVLE(numChecksums);
+        for (unsigned i = 0; i < numChecksums; ++i)
+            msg_.WriteUInt(GetPackageChunkChecksum(file, i, download.fileSize_, chunkBuffer));
+    }
+    else
+        URHO3D_LOGINFO("Requesting package " + download.name_ + " from server");
+
+    SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
+    download.initiated_ = true;
+}
+
+void Connection::RequestQueuedPackages()
+{
+    unsigned numInitiated = 0;
+    for (HashMap<StringHash, PackageDownload>::ConstIterator i = downloads_.Begin(); i != downloads_.End(); ++i)
+    {
+        if (i->second_.initiated_)
+            ++numInitiated;
+    }
+
+    for (HashMap<StringHash, PackageDownload>::Iterator i = downloads_.Begin();
+         i != downloads_.End() && numInitiated < MAX_CONCURRENT_PACKAGE_DOWNLOADS; ++i)
+    {
+        if (!i->second_.initiated_)
+        {
+            SendPackageRequest(i->second_);
+            ++numInitiated;
+        }
+    }
+}
+
+void Connection::CheckPackageDownloaded(HashMap<StringHash, PackageDownload>::Iterator i)
+{
+    PackageDownload& download = i->second_;
+    if (download.receivedFragments_.Size() < download.totalFragments_)
+        return;
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    String partialFileName = GetPartialPackageFileName(download);
+    // Prepend the checksum to the filename to allow multiple versions
+    String fileName = GetSubsystem<Network>()->GetPackageCacheDir() + ToStringHex(download.checksum_) + "_" + download.name_;
+
+    if (download.file_)
+        download.file_->Close();
+    else if (!fileSystem->FileExists(partialFileName))
+    {
+        // Nothing was received, as the package is empty
+        SharedPtr<File> emptyFile(new File(context_, partialFileName, FILE_WRITE));
+    }
+
+    // A file left with the final name did not pass the checks in RequestNeededPackages(), so it can be replaced
+    if (fileSystem->FileExists(fileName))
+        fileSystem->Delete(fileName);
+    if (!fileSystem->Rename(partialFileName, fileName))
+    {
+        OnPackageDownloadFailed(download.name_);
+        return;
     }
+
+    URHO3D_LOGINFO("Package " + download.name_ + " downloaded successfully");
+
+    // Instantiate the package and add to the resource system, as we will need it to load the scene
+    GetSubsystem<ResourceCache>()->AddPackageFile(fileName, 0);
+
+    // Then start the next downloads if there are more
+    downloads_.Erase(i);
+    if (downloads_.Empty())
+        OnPackagesReady();
+    else
+        RequestQueuedPackages();
+}
+
+String Connection::GetPartialPackageFileName(const PackageDownload& download) const
+{
+    return GetSubsystem<Network>()->GetPackageCacheDir() + ToStringHex(download.checksum_) + "_" + download.name_ + ".part";
 }
 
 void Connection::SendPackageError(const String& name)
@@ -1564,6 +2122,157 @@ void Connection::OnPackagesReady()
     }
 }
 
+void Connection::UpdateInterestArea()
+{
+    URHO3D_PROFILE(UpdateInterestArea);
+
+    HashMap<unsigned, IntVector3>& deferredNodes = sceneState_.deferredNodes_;
+    HashMap<IntVector3, PODVector<unsigned> >& deferredCells = sceneState_.deferredCells_;
+    IntVector3 observerCell = GetInterestCell(position_);
+
+    // Nodes the client has not received yet are not tracked for movement, so sort all held back nodes to their current
+    // cells when the observer crosses into another cell. Exception: removed nodes are always processed right away
+    if (observerCell != interestCell_ || interestGridDirty_)
+    {
+        deferredCells.Clear();
+        for (HashMap<unsigned, IntVector3>::Iterator i = deferredNodes.Begin(); i != deferredNodes.End();)
+        {
+            Node* node = scene_->GetNode(i->first_);
+            if (node)
+            {
+                i->second_ = GetInterestCell(node->GetWorldPosition());
+                deferredCells[i->second_].Push(i->first_);
+                ++i;
+            }
+            else
+            {
+                nodesToProcess_.Insert(i->first_);
+                i = deferredNodes.Erase(i);
+            }
+        }
+
+        interestCell_ = observerCell;
+        interestGridDirty_ = false;
+    }
+
+    // The candidates are the dirty nodes, plus the held back nodes in the cells the interest sphere can touch. As the
+    // cell size equals the radius, those are the observer's cell and its immediate neighbours
+    interestCandidates_.Clear();
+    for (HashSet<unsigned>::ConstIterator i = nodesToProcess_.Begin(); i != nodesToProcess_.End(); ++i)
+        interestCandidates_.Push(*i);
+    for (int z = -1; z <= 1; ++z)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            for (int x = -1; x <= 1; ++x)
+            {
+                HashMap<IntVector3, PODVector<unsigned> >::ConstIterator i =
+                    deferredCells.Find(observerCell + IntVector3(x, y, z));
+                if (i != deferredCells.End())
+                    interestCandidates_.Push(i->second_);
+            }
+        }
+    }
+
+    nodesToProcess_.Clear();
+    float radiusSquared = interestRadius_ * interestRadius_;
+
+    for (PODVector<unsigned>::ConstIterator i = interestCandidates_.Begin(); i != interestCandidates_.End(); ++i)
+    {
+        unsigned nodeID = *i;
+        // May have been added already as a dependency of another node
+        if (nodesToProcess_.Contains(nodeID))
+            continue;
+
+        Node* node = scene_->GetNode(nodeID);
+        if (!node || node->GetOwner() == this || (node->GetWorldPosition() - position_).LengthSquared() <= radiusSquared)
+            AddRelevantNode(nodeID, node);
+        else
+            DeferNode(nodeID, node);
+    }
+}
+
+void Connection::AddRelevantNode(unsigned nodeID, Node* node)
+{
+    nodesToProcess_.Insert(nodeID);
+    RemoveDeferredNode(nodeID);
+
+    // The nodes this node depends on must reach the client first, even if they are outside the interest area
+    if (node)
+    {
+        // Return a held back node to the dirty set, so that the dependency recursion in ProcessNode sees it
+        HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Find(nodeID);
+        if (i != sceneState_.nodeStates_.End())
+            i->second_.markedDirty_ = true;
+        sceneState_.dirtyNodes_.Insert(nodeID);
+
+        const PODVector<Node*>& dependencyNodes = node->GetDependencyNodes();
+        for (PODVector<Node*>::ConstIterator j = dependencyNodes.Begin(); j != dependencyNodes.End(); ++j)
+        {
+            unsigned dependencyID = (*j)->GetID();
+            if (!nodesToProcess_.Contains(dependencyID) && (sceneState_.dirtyNodes_.Contains(dependencyID) ||
+                sceneState_.deferredNodes_.Contains(dependencyID)))
+                AddRelevantNode(dependencyID, *j);
+        }
+    }
+}
+
+void Connection::DeferNode(unsigned nodeID, Node* node)
+{
+    // Take the node out of the dirty set, but keep its dirty attributes. Clearing the flag lets further changes to an
+    // already received node put it back to the dirty set, so that it is checked against the interest area again
+    HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Find(nodeID);
+    if (i != sceneState_.nodeStates_.End())
+        i->second_.markedDirty_ = false;
+    sceneState_.dirtyNodes_.Erase(nodeID);
+
+    IntVector3 cell = GetInterestCell(node->GetWorldPosition());
+    HashMap<unsigned, IntVector3>::Iterator j = sceneState_.deferredNodes_.Find(nodeID);
+    if (j != sceneState_.deferredNodes_.End())
+    {
+        if (j->second_ == cell)
+            return;
+        RemoveDeferredNode(nodeID);
+    }
+
+    sceneState_.deferredNodes_[nodeID] = cell;
+    sceneState_.deferredCells_[cell].Push(nodeID);
+}
+
+void Connection::RemoveDeferredNode(unsigned nodeID)
+{
+    HashMap<unsigned, IntVector3>::Iterator i = sceneState_.deferredNodes_.Find(nodeID);
+    if (i == sceneState_.deferredNodes_.End())
+        return;
+
+    HashMap<IntVector3, PODVector<unsigned> >::Iterator j = sceneState_.deferredCells_.Find(i->second_);
+    if (j != sceneState_.deferredCells_.End())
+    {
+        j->second_.RemoveSwap(nodeID);
+        if (j->second_.Empty())
+            sceneState_.deferredCells_.Erase(j);
+    }
+
+    sceneState_.deferredNodes_.Erase(i);
+}
+
+IntVector3 Connection::GetInterestCell(const Vector3& position) const
+{
+    float invCellSize = 1.0f / interestRadius_;
+    return IntVector3(FloorToInt(position.x_ * invCellSize), FloorToInt(position.y_ * invCellSize),
+        FloorToInt(position.z_ * invCellSize));
+}
+
+void Connection::RecordReplicationTraffic(unsigned nodeID, Component* component, unsigned bytes)
+{
+    if (!trafficStats_)
+        return;
+
+    trafficStats_->RecordNode(nodeID, bytes);
+    if (component)
+        trafficStats_->RecordComponent(component->GetType(), bytes);
+}
+
 void Connection::ProcessPackageInfo(int msgID, MemoryBuffer& msg)
 {
     if (!scene_)
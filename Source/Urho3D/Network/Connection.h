@@ -23,10 +23,13 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
+#include "../IO/Compression.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/NetworkTrafficStats.h"
 #include "../Scene/ReplicationState.h"
 
 namespace SLNet
@@ -76,6 +79,8 @@ struct PackageDownload
     String name_;
     /// Total number of fragments.
     unsigned totalFragments_;
+    /// File size.
+    unsigned fileSize_;
     /// Checksum.
     unsigned checksum_;
     /// Download initiated flag.
@@ -90,6 +95,10 @@ struct PackageUpload
 
     /// Source file.
     SharedPtr<File> file_;
+    /// Chunks to send.
+    PODVector<unsigned> chunks_;
+    /// Current index into the chunks to send.
+    unsigned chunkIndex_;
     /// Current fragment index.
     unsigned fragment_;
     /// Total number of fragments
@@ -133,20 +142,36 @@ public:
     void SetPosition(const Vector3& position);
     /// Set the observer rotation for interest management, to be sent to the server. Note: not used by the NetworkPriority component.
     void SetRotation(const Quaternion& rotation);
+    /// Set the interest management radius around the observer position. Used on the server only. Replicated nodes outside it are not updated to the client until they come within range. Zero (default) disables.
+    void SetInterestRadius(float radius);
     /// Set the connection pending status. Called by Network.
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
     void SetLogStatistics(bool enable);
+    /// Set whether to record traffic per message ID, replicated component type and node. Called by Network.
+    void SetTrafficProfiling(bool enable);
+    /// Set whether to coalesce small messages of the same reliability into one packet until the next flush. Called by Network.
+    void SetMessageBatching(bool enable);
+    /// Set whether to compress the reliable messages of a frame when their total size reaches the threshold. Called by Network.
+    void SetCompression(bool enable, unsigned threshold);
+    /// Set the preset dictionary for the compressed message stream in both directions. Must be the same on both ends and set before any compressed messages have been sent or received. Called by Network.
+    void SetCompressionDictionary(const PODVector<unsigned char>& dictionary);
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
     void SendServerUpdate();
+    /// Prepare scene update messages into a buffer without sending them. May run concurrently with other connections' preparation, with the replication bookkeeping shared between connections serialized by the mutex. Called by Network.
+    void PrepareServerUpdate(Mutex* replicationMutex);
+    /// Send the scene update messages buffered by PrepareServerUpdate. Called by Network.
+    void SendPreparedServerUpdate();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
     /// Send queued remote events. Called by Network.
     void SendRemoteEvents();
     /// Send package files to client. Called by network.
     void SendPackages();
+    /// Send the small messages coalesced since the last flush, and the compressed reliable messages the flow control allows. Called by Network.
+    void FlushMessageBatches();
     /// Process pending latest data for nodes and components.
     void ProcessPendingLatestData();
     /// Process a message from the server or client. Called by Network.
@@ -176,6 +201,9 @@ public:
     /// Return the observer rotation sent by the client for interest management.
     const Quaternion& GetRotation() const { return rotation_; }
 
+    /// Return the interest management radius around the observer position.
+    float GetInterestRadius() const { return interestRadius_; }
+
     /// Return whether is a client connection.
     bool IsClient() const { return isClient_; }
 
@@ -191,6 +219,18 @@ public:
     /// Return whether to log data in/out statistics.
     bool GetLogStatistics() const { return logStatistics_; }
 
+    /// Return whether small messages are coalesced into one packet.
+    bool GetMessageBatching() const { return messageBatching_; }
+
+    /// Return whether large amounts of reliable messages are compressed.
+    bool GetCompression() const { return compression_; }
+
+    /// Return bytes of compressed messages held back by the flow control.
+    unsigned GetNumPendingCompressedBytes() const { return compressedOutput_.GetSize() - compressedSendPos_; }
+
+    /// Return recorded traffic statistics, or null if traffic profiling is disabled.
+    NetworkTrafficStats* GetTrafficStats() const { return trafficStats_.Get(); }
+
     /// Return remote address.
     String GetAddress() const;
 
@@ -255,18 +295,58 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Process a message after it has been counted as received. Return true if handled internally.
+    bool DispatchMessage(int msgID, MemoryBuffer& msg);
+    /// Process the messages in a message batch.
+    void ProcessMessageBatch(MemoryBuffer& msg);
+    /// Process a fragment of the compressed message stream. Decompresses and processes the messages of each completed block.
+    void ProcessCompressedFragment(MemoryBuffer& msg);
+    /// Compress the reliable messages of the frame, or send them uncompressed if too small.
+    void FlushCompressedMessages();
+    /// Send fragments of the compressed message stream while the send buffers are not too full.
+    void SendCompressedFragments();
+    /// Send a packet directly or through the message batch, without compression.
+    void SendUncompressedPacket(const unsigned char* data, unsigned numBytes, unsigned char reliability);
+    /// Send a packet with the message ID in its first byte, or coalesce it into the compressed messages or the batch of its reliability.
+    void SendPacket(const unsigned char* data, unsigned numBytes, unsigned char reliability);
+    /// Send the coalesced messages of a reliability.
+    void FlushMessageBatch(unsigned char reliability);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
     /// Process a node that the client has not yet received.
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Filter the nodes to process by the interest area around the observer and hold back the rest.
+    void UpdateInterestArea();
+    /// Add a node and the held back nodes it depends on to the nodes to process.
+    void AddRelevantNode(unsigned nodeID, Node* node);
+    /// Hold back a dirty node outside the interest area.
+    void DeferNode(unsigned nodeID, Node* node);
+    /// Record the size of a sent replication message for a node, and optionally one of its components.
+    void RecordReplicationTraffic(unsigned nodeID, Component* component, unsigned bytes);
+    /// Remove a node from the held back nodes.
+    void RemoveDeferredNode(unsigned nodeID);
+    /// Return the interest grid cell of a world position.
+    IntVector3 GetInterestCell(const Vector3& position) const;
+    /// Acquire the replication mutex if preparing the server update concurrently.
+    void LockReplication() { if (replicationMutex_) replicationMutex_->Acquire(); }
+    /// Release the replication mutex if preparing the server update concurrently.
+    void UnlockReplication() { if (replicationMutex_) replicationMutex_->Release(); }
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set)
     bool RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg);
     /// Initiate a package download.
     void RequestPackage(const String& name, unsigned fileSize, unsigned checksum);
+    /// Send the request for a package download, with the checksums of the chunks already received in an earlier attempt.
+    void SendPackageRequest(PackageDownload& download);
+    /// Initiate queued package downloads up to the concurrent download limit.
+    void RequestQueuedPackages();
+    /// Finish a package download if all fragments have been received.
+    void CheckPackageDownloaded(HashMap<StringHash, PackageDownload>::Iterator i);
+    /// Return the file name for receiving a package download.
+    String GetPartialPackageFileName(const PackageDownload& download) const;
     /// Send an error reply for a package download.
     void SendPackageError(const String& name);
     /// Handle scene load failure on the server or client.
@@ -290,8 +370,36 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// Candidate node ID's for the interest area check during a replication update.
+    PODVector<unsigned> interestCandidates_;
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Buffered scene update messages when preparing the server update concurrently.
+    VectorBuffer preparedMessages_;
+    /// Coalesced small messages by reliability.
+    VectorBuffer messageBatches_[4];
+    /// Reliable messages of the frame to compress, each prefixed by its size.
+    VectorBuffer compressBatch_;
+    /// Reliabilities of the messages to compress, for sending them uncompressed if too small.
+    PODVector<unsigned char> compressReliabilities_;
+    /// Compressed blocks not yet sent, each prefixed by the uncompressed and compressed sizes.
+    VectorBuffer compressedOutput_;
+    /// Position of the next fragment to send in the compressed blocks.
+    unsigned compressedSendPos_;
+    /// Received compressed data not yet forming a complete block.
+    PODVector<unsigned char> compressedInput_;
+    /// Reusable buffer for compressing a block.
+    PODVector<unsigned char> compressBuffer_;
+    /// Compression history of the sent stream.
+    StreamCompressor sendCompressor_;
+    /// Compression history of the received stream.
+    StreamCompressor receiveCompressor_;
+    /// Minimum size of the reliable messages of a frame to compress them.
+    unsigned compressionThreshold_;
+    /// Mutex for replication bookkeeping shared between connections, when preparing the server update concurrently.
+    Mutex* replicationMutex_;
+    /// Traffic statistics. Null when traffic profiling is disabled.
+    UniquePtr<NetworkTrafficStats> trafficStats_;
     /// Queued remote events.
     Vector<RemoteEvent> remoteEvents_;
     /// Scene file to load once all packages (if any) have been downloaded.
@@ -304,6 +412,12 @@ private:
     Vector3 position_;
     /// Observer rotation for interest management.
     Quaternion rotation_;
+    /// Interest management radius. Also the interest grid cell size.
+    float interestRadius_;
+    /// Interest grid cell of the observer on the last replication update.
+    IntVector3 interestCell_;
+    /// Whether the held back nodes need to be sorted to their grid cells again on the next replication update.
+    bool interestGridDirty_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
     /// Client connection flag.
@@ -314,6 +428,12 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Buffer messages instead of sending them flag.
+    bool prepareMessages_;
+    /// Message batching flag.
+    bool messageBatching_;
+    /// Compression flag.
+    bool compression_;
     /// Address of this connection.
     SLNet::AddressOrGUID* address_;
     /// Raknet peer object.
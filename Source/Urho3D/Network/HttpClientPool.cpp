@@ -0,0 +1,219 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Thread.h"
+#include "../Network/HttpClientPool.h"
+
+#include <Civetweb/civetweb.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Time in milliseconds after which kept alive connections are closed instead of reused.
+static const unsigned MAX_CONNECTION_IDLE_TIME = 30000;
+
+/// HTTP client pool worker thread.
+class HttpClientThread : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    explicit HttpClientThread(HttpClientPool* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Process requests until stopped.
+    void ThreadFunction() override
+    {
+        owner_->ProcessRequests();
+    }
+
+private:
+    /// Owning pool.
+    HttpClientPool* owner_;
+};
+
+/// Return key identifying connections that can be shared between requests.
+static String GetHostKey(const String& host, int port, bool ssl)
+{
+    return (ssl ? "https://" : "http://") + host + ":" + String(port);
+}
+
+HttpClientPool::HttpClientPool(unsigned numThreads) :
+    shutDown_(false)
+{
+#ifdef URHO3D_THREADING
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        SharedPtr<HttpClientThread> thread(new HttpClientThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+#endif
+}
+
+HttpClientPool::~HttpClientPool()
+{
+    {
+        MutexLock lock(mutex_);
+        shutDown_ = true;
+        for (unsigned i = 0; i < activeRequests_.Size(); ++i)
+            activeRequests_[i]->shouldRun_ = false;
+    }
+
+    // Each worker thread wakes up the next one when exiting
+    wakeCondition_.Set();
+    for (unsigned i = 0; i < threads_.Size(); ++i)
+        threads_[i]->Stop();
+    threads_.Clear();
+
+    // Requests that never got to execute can not be completed anymore
+    for (List<HttpRequest*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+    {
+        MutexLock lock((*i)->mutex_);
+        (*i)->state_ = HTTP_ERROR;
+        (*i)->error_ = "HTTP client pool shut down";
+    }
+
+    for (HashMap<String, Vector<IdleConnection> >::Iterator i = idleConnections_.Begin(); i != idleConnections_.End(); ++i)
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+            mg_close_connection(i->second_[j].connection_);
+    }
+}
+
+void HttpClientPool::AddRequest(HttpRequest* request)
+{
+    if (!request)
+        return;
+
+    activeRequests_.Push(SharedPtr<HttpRequest>(request));
+
+#ifdef URHO3D_THREADING
+    {
+        MutexLock lock(mutex_);
+        request->shouldRun_ = true;
+        queue_.Push(request);
+    }
+
+    wakeCondition_.Set();
+#endif
+}
+
+void HttpClientPool::GetFinishedRequests(Vector<SharedPtr<HttpRequest> >& dest)
+{
+    dest.Clear();
+
+    MutexLock lock(mutex_);
+    for (PODVector<HttpRequest*>::ConstIterator i = finished_.Begin(); i != finished_.End(); ++i)
+    {
+        for (Vector<SharedPtr<HttpRequest> >::Iterator j = activeRequests_.Begin(); j != activeRequests_.End(); ++j)
+        {
+            if (*j == *i)
+            {
+                dest.Push(*j);
+                activeRequests_.Erase(j);
+                break;
+            }
+        }
+    }
+    finished_.Clear();
+}
+
+void HttpClientPool::ProcessRequests()
+{
+    for (;;)
+    {
+        HttpRequest* request = nullptr;
+
+        {
+            MutexLock lock(mutex_);
+            if (shutDown_)
+                break;
+            if (!queue_.Empty())
+            {
+                request = queue_.Front();
+                queue_.PopFront();
+                // Wake up another worker thread for the rest of the queue
+                if (!queue_.Empty())
+                    wakeCondition_.Set();
+            }
+        }
+
+        if (!request)
+        {
+            wakeCondition_.Wait();
+            continue;
+        }
+
+        String hostKey = GetHostKey(request->host_, request->port_, request->ssl_);
+        mg_connection* connection = AcquireConnection(hostKey);
+        if (request->Process(connection, true))
+            ReleaseConnection(hostKey, connection);
+        else if (connection)
+            mg_close_connection(connection);
+
+        MutexLock lock(mutex_);
+        finished_.Push(request);
+    }
+
+    // Let the next worker thread see the shutdown
+    wakeCondition_.Set();
+}
+
+mg_connection* HttpClientPool::AcquireConnection(const String& hostKey)
+{
+    MutexLock lock(mutex_);
+
+    HashMap<String, Vector<IdleConnection> >::Iterator i = idleConnections_.Find(hostKey);
+    if (i == idleConnections_.End())
+        return nullptr;
+
+    // Reuse the most recently idle connection, as it is the least likely to have been closed by the server
+    Vector<IdleConnection>& connections = i->second_;
+    while (!connections.Empty())
+    {
+        IdleConnection idle = connections.Back();
+        connections.Pop();
+        if (idle.idleTimer_.GetMSec(false) < MAX_CONNECTION_IDLE_TIME)
+            return idle.connection_;
+        mg_close_connection(idle.connection_);
+    }
+
+    return nullptr;
+}
+
+void HttpClientPool::ReleaseConnection(const String& hostKey, mg_connection* connection)
+{
+    IdleConnection idle;
+    idle.connection_ = connection;
+
+    MutexLock lock(mutex_);
+    idleConnections_[hostKey].Push(idle);
+}
+
+}
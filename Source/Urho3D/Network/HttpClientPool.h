@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/List.h"
+#include "../Container/Ptr.h"
+#include "../Core/Condition.h"
+#include "../Core/Mutex.h"
+#include "../Core/Timer.h"
+#include "../Network/HttpRequest.h"
+
+namespace Urho3D
+{
+
+class HttpClientThread;
+
+/// Pool of worker threads that execute HTTP requests and keep connections alive for reuse with the same host.
+class URHO3D_API HttpClientPool : public RefCounted
+{
+    friend class HttpClientThread;
+
+public:
+    /// Construct and start the worker threads.
+    explicit HttpClientPool(unsigned numThreads);
+    /// Destruct. Abort the requests in progress, stop the worker threads and close the kept alive connections.
+    ~HttpClientPool() override;
+
+    /// Queue a pooled request for execution. Called from the main thread.
+    void AddRequest(HttpRequest* request);
+    /// Return requests that have finished since the last call. The pool releases its references to them. Called from the main thread.
+    void GetFinishedRequests(Vector<SharedPtr<HttpRequest> >& dest);
+
+    /// Return number of worker threads.
+    unsigned GetNumThreads() const { return threads_.Size(); }
+    /// Return number of queued or executing requests.
+    unsigned GetNumActiveRequests() const { return activeRequests_.Size(); }
+
+private:
+    /// Execute queued requests until shut down. Called by the worker threads.
+    void ProcessRequests();
+    /// Take a kept alive connection to the host, or null if none. Close connections that have been idle too long.
+    mg_connection* AcquireConnection(const String& hostKey);
+    /// Return a connection to be kept alive.
+    void ReleaseConnection(const String& hostKey, mg_connection* connection);
+
+    /// Kept alive connection.
+    struct IdleConnection
+    {
+        /// Civetweb connection.
+        mg_connection* connection_;
+        /// Time since the connection became idle.
+        Timer idleTimer_;
+    };
+
+    /// Worker threads.
+    Vector<SharedPtr<HttpClientThread> > threads_;
+    /// Requests referenced by the pool until they finish. Only accessed by the main thread.
+    Vector<SharedPtr<HttpRequest> > activeRequests_;
+    /// Requests waiting for a worker thread.
+    List<HttpRequest*> queue_;
+    /// Requests finished by the worker threads.
+    PODVector<HttpRequest*> finished_;
+    /// Kept alive connections by host, port and protocol.
+    HashMap<String, Vector<IdleConnection> > idleConnections_;
+    /// Mutex for the queues and the kept alive connections.
+    Mutex mutex_;
+    /// Condition for waking up the worker threads.
+    Condition wakeCondition_;
+    /// Shutting down flag.
+    volatile bool shutDown_;
+};
+
+}
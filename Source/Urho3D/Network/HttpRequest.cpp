@@ -36,14 +36,19 @@ namespace Urho3D
 static const unsigned ERROR_BUFFER_SIZE = 256;
 static const unsigned READ_BUFFER_SIZE = 65536; // Must be a power of two
 
-HttpRequest::HttpRequest(const String& url, const String& verb, const Vector<String>& headers, const String& postData) :
+HttpRequest::HttpRequest(const String& url, const String& verb, const Vector<String>& headers, const String& postData, bool pooled) :
     url_(url.Trimmed()),
     verb_(!verb.Empty() ? verb : "GET"),
     headers_(headers),
     postData_(postData),
+    path_("/"),
+    port_(80),
+    ssl_(false),
+    pooled_(pooled),
     state_(HTTP_INITIALIZING),
     httpReadBuffer_(new unsigned char[READ_BUFFER_SIZE]),
     readBuffer_(new unsigned char[READ_BUFFER_SIZE]),
+    readBufferSize_(READ_BUFFER_SIZE),
     readPosition_(0),
     writePosition_(0)
 {
@@ -51,11 +56,38 @@ HttpRequest::HttpRequest(const String& url, const String& verb, const Vector<Str
     // to maximum value once the request is done, signaling end for Deserializer::IsEof().
     size_ = M_MAX_UNSIGNED;
 
+    String protocol = "http";
+    unsigned protocolEnd = url_.Find("://");
+    if (protocolEnd != String::NPOS)
+    {
+        protocol = url_.Substring(0, protocolEnd);
+        host_ = url_.Substring(protocolEnd + 3);
+    }
+    else
+        host_ = url_;
+    ssl_ = !protocol.Compare("https", false);
+
+    unsigned pathStart = host_.Find('/');
+    if (pathStart != String::NPOS)
+    {
+        path_ = host_.Substring(pathStart);
+        host_ = host_.Substring(0, pathStart);
+    }
+
+    unsigned portStart = host_.Find(':');
+    if (portStart != String::NPOS)
+    {
+        port_ = ToInt(host_.Substring(portStart + 1));
+        host_ = host_.Substring(0, portStart);
+    }
+
     URHO3D_LOGDEBUG("HTTP " + verb_ + " request to URL " + url_);
 
 #ifdef URHO3D_THREADING
-    // Start the worker thread to actually create the connection and read the response data.
-    Run();
+    // Start the worker thread to actually create the connection and read the response data. Pooled requests are instead
+    // executed by the worker threads of the HTTP client pool
+    if (!pooled_)
+        Run();
 #else
     URHO3D_LOGERROR("HTTP request will not execute as threading is disabled");
 #endif
@@ -68,66 +100,42 @@ HttpRequest::~HttpRequest()
 
 void HttpRequest::ThreadFunction()
 {
-    String protocol = "http";
-    String host;
-    String path = "/";
-    int port = 80;
-
-    unsigned protocolEnd = url_.Find("://");
-    if (protocolEnd != String::NPOS)
-    {
-        protocol = url_.Substring(0, protocolEnd);
-        host = url_.Substring(protocolEnd + 3);
-    }
-    else
-        host = url_;
-
-    unsigned pathStart = host.Find('/');
-    if (pathStart != String::NPOS)
-    {
-        path = host.Substring(pathStart);
-        host = host.Substring(0, pathStart);
-    }
+    mg_connection* connection = nullptr;
+    Process(connection, false);
 
-    unsigned portStart = host.Find(':');
-    if (portStart != String::NPOS)
-    {
-        port = ToInt(host.Substring(portStart + 1));
-        host = host.Substring(0, portStart);
-    }
+    // Close the connection
+    if (connection)
+        mg_close_connection(connection);
+}
 
+bool HttpRequest::Process(mg_connection*& connection, bool keepAlive)
+{
     char errorBuffer[ERROR_BUFFER_SIZE];
     memset(errorBuffer, 0, sizeof(errorBuffer));
 
-    String headersStr;
-    for (unsigned i = 0; i < headers_.Size(); ++i)
-    {
-        // Trim and only add non-empty header strings
-        String header = headers_[i].Trimmed();
-        if (header.Length())
-            headersStr += header + "\r\n";
-    }
-
-    // Initiate the connection. This may block due to DNS query
+    // Initiate the connection unless reusing a kept alive one. This may block due to DNS query.
+    // If the server has closed a kept alive connection in the meanwhile, retry once with a new connection
     /// \todo SSL mode will not actually work unless Civetweb's SSL mode is initialized with an external SSL DLL
-    mg_connection* connection = nullptr;
-    if (postData_.Empty())
-    {
-        connection = mg_download(host.CString(), port, protocol.Compare("https", false) ? 0 : 1, errorBuffer, sizeof(errorBuffer),
-            "%s %s HTTP/1.0\r\n"
-            "Host: %s\r\n"
-            "%s"
-            "\r\n", verb_.CString(), path.CString(), host.CString(), headersStr.CString());
-    }
-    else
+    bool reused = connection != nullptr;
+    for (;;)
     {
-        connection = mg_download(host.CString(), port, protocol.Compare("https", false) ? 0 : 1, errorBuffer, sizeof(errorBuffer),
-            "%s %s HTTP/1.0\r\n"
-            "Host: %s\r\n"
-            "%s"
-            "Content-Length: %d\r\n"
-            "\r\n"
-            "%s", verb_.CString(), path.CString(), host.CString(), headersStr.CString(), postData_.Length(), postData_.CString());
+        if (!connection)
+            connection = mg_connect_client(host_.CString(), port_, ssl_ ? 1 : 0, errorBuffer, sizeof(errorBuffer));
+        if (connection && SendRequest(connection, keepAlive) && mg_get_response(connection, errorBuffer, sizeof(errorBuffer), -1) >= 0)
+            break;
+
+        if (connection)
+        {
+            if (!errorBuffer[0])
+                strcpy(errorBuffer, "Error sending request");
+            mg_close_connection(connection);
+            connection = nullptr;
+        }
+        if (!reused)
+            break;
+
+        reused = false;
+        memset(errorBuffer, 0, sizeof(errorBuffer));
     }
 
     {
@@ -138,30 +146,40 @@ void HttpRequest::ThreadFunction()
         if (state_ == HTTP_ERROR)
         {
             error_ = String(&errorBuffer[0]);
-            return;
+            return false;
         }
     }
 
     // Loop while should run, read data from the connection, copy to the main thread buffer if there is space
+    bool complete = false;
     while (shouldRun_)
     {
         // Read less than full buffer to be able to distinguish between full and empty ring buffer. Reading may block
         int bytesRead = mg_read(connection, httpReadBuffer_.Get(), READ_BUFFER_SIZE / 4);
         if (bytesRead <= 0)
+        {
+            complete = bytesRead == 0;
             break;
+        }
 
         mutex_.Acquire();
 
-        // Wait until enough space in the main thread's ring buffer
+        // Wait until enough space in the main thread's ring buffer. Pooled requests must not stall the shared worker
+        // threads, so they grow the buffer instead
         for (;;)
         {
-            unsigned spaceInBuffer = READ_BUFFER_SIZE - ((writePosition_ - readPosition_) & (READ_BUFFER_SIZE - 1));
+            unsigned spaceInBuffer = readBufferSize_ - ((writePosition_ - readPosition_) & (readBufferSize_ - 1));
             if ((int)spaceInBuffer > bytesRead || !shouldRun_)
                 break;
 
-            mutex_.Release();
-            Time::Sleep(5);
-            mutex_.Acquire();
+            if (pooled_)
+                GrowReadBuffer();
+            else
+            {
+                mutex_.Release();
+                Time::Sleep(5);
+                mutex_.Acquire();
+            }
         }
 
         if (!shouldRun_)
@@ -170,30 +188,81 @@ void HttpRequest::ThreadFunction()
             break;
         }
 
-        if (writePosition_ + bytesRead <= READ_BUFFER_SIZE)
+        if (writePosition_ + bytesRead <= readBufferSize_)
             memcpy(readBuffer_.Get() + writePosition_, httpReadBuffer_.Get(), (size_t)bytesRead);
         else
         {
             // Handle ring buffer wrap
-            unsigned part1 = READ_BUFFER_SIZE - writePosition_;
+            unsigned part1 = readBufferSize_ - writePosition_;
             unsigned part2 = bytesRead - part1;
             memcpy(readBuffer_.Get() + writePosition_, httpReadBuffer_.Get(), part1);
             memcpy(readBuffer_.Get(), httpReadBuffer_.Get() + part1, part2);
         }
 
         writePosition_ += bytesRead;
-        writePosition_ &= READ_BUFFER_SIZE - 1;
+        writePosition_ &= readBufferSize_ - 1;
 
         mutex_.Release();
     }
 
-    // Close the connection
-    mg_close_connection(connection);
-
     {
         MutexLock lock(mutex_);
         state_ = HTTP_CLOSED;
     }
+
+    // The connection can only be reused if the whole response body, delimited by its content length, has been read
+    if (!keepAlive || !complete)
+        return false;
+    const char* connectionHeader = mg_get_header(connection, "Connection");
+    return mg_get_header(connection, "Content-Length") && (!connectionHeader || String(connectionHeader).Compare("close", false));
+}
+
+bool HttpRequest::SendRequest(mg_connection* connection, bool keepAlive)
+{
+    String headersStr;
+    for (unsigned i = 0; i < headers_.Size(); ++i)
+    {
+        // Trim and only add non-empty header strings
+        String header = headers_[i].Trimmed();
+        if (header.Length())
+            headersStr += header + "\r\n";
+    }
+
+    if (keepAlive)
+        headersStr += "Connection: keep-alive\r\n";
+    if (!postData_.Empty())
+        headersStr += "Content-Length: " + String(postData_.Length()) + "\r\n";
+
+    if (mg_printf(connection,
+        "%s %s HTTP/%s\r\n"
+        "Host: %s\r\n"
+        "%s"
+        "\r\n", verb_.CString(), path_.CString(), keepAlive ? "1.1" : "1.0", host_.CString(), headersStr.CString()) <= 0)
+        return false;
+
+    return postData_.Empty() || mg_write(connection, postData_.CString(), postData_.Length()) == (int)postData_.Length();
+}
+
+void HttpRequest::GrowReadBuffer()
+{
+    unsigned newSize = readBufferSize_ * 2;
+    unsigned size = (writePosition_ - readPosition_) & (readBufferSize_ - 1);
+    SharedArrayPtr<unsigned char> newBuffer(new unsigned char[newSize]);
+
+    // Unwrap the ring buffer contents to the start of the new buffer
+    if (readPosition_ + size <= readBufferSize_)
+        memcpy(newBuffer.Get(), readBuffer_.Get() + readPosition_, size);
+    else
+    {
+        unsigned part1 = readBufferSize_ - readPosition_;
+        memcpy(newBuffer.Get(), readBuffer_.Get() + readPosition_, part1);
+        memcpy(newBuffer.Get() + part1, readBuffer_.Get(), size - part1);
+    }
+
+    readBuffer_ = newBuffer;
+    readBufferSize_ = newSize;
+    readPosition_ = 0;
+    writePosition_ = size;
 }
 
 unsigned HttpRequest::Read(void* dest, unsigned size)
@@ -227,19 +296,19 @@ unsigned HttpRequest::Read(void* dest, unsigned size)
             if (bytesAvailable > sizeLeft)
                 bytesAvailable = sizeLeft;
 
-            if (readPosition_ + bytesAvailable <= READ_BUFFER_SIZE)
+            if (readPosition_ + bytesAvailable <= readBufferSize_)
                 memcpy(destPtr, readBuffer_.Get() + readPosition_, bytesAvailable);
             else
             {
                 // Handle ring buffer wrap
-                unsigned part1 = READ_BUFFER_SIZE - readPosition_;
+                unsigned part1 = readBufferSize_ - readPosition_;
                 unsigned part2 = bytesAvailable - part1;
                 memcpy(destPtr, readBuffer_.Get() + readPosition_, part1);
                 memcpy(destPtr + part1, readBuffer_.Get(), part2);
             }
 
             readPosition_ += bytesAvailable;
-            readPosition_ &= READ_BUFFER_SIZE - 1;
+            readPosition_ &= readBufferSize_ - 1;
             sizeLeft -= bytesAvailable;
             totalRead += bytesAvailable;
             destPtr += bytesAvailable;
@@ -288,7 +357,7 @@ unsigned HttpRequest::GetAvailableSize() const
 
 Pair<unsigned, bool> HttpRequest::CheckAvailableSizeAndEof() const
 {
-    unsigned size = (writePosition_ - readPosition_) & (READ_BUFFER_SIZE - 1);
+    unsigned size = (writePosition_ - readPosition_) & (readBufferSize_ - 1);
     return {size, (state_ == HTTP_ERROR || (state_ == HTTP_CLOSED && !size))};
 }
 
@@ -28,9 +28,13 @@
 #include "../Core/Thread.h"
 #include "../IO/Deserializer.h"
 
+struct mg_connection;
+
 namespace Urho3D
 {
 
+class HttpClientPool;
+
 /// HTTP connection state
 enum HttpRequestState
 {
@@ -43,9 +47,11 @@ enum HttpRequestState
 /// An HTTP connection with response data stream.
 class URHO3D_API HttpRequest : public RefCounted, public Deserializer, public Thread
 {
+    friend class HttpClientPool;
+
 public:
-    /// Construct with parameters.
-    HttpRequest(const String& url, const String& verb, const Vector<String>& headers, const String& postData);
+    /// Construct with parameters. A pooled request does not start its own worker thread, but is executed by the HTTP client pool.
+    HttpRequest(const String& url, const String& verb, const Vector<String>& headers, const String& postData, bool pooled = false);
     /// Destruct. Release the connection object.
     ~HttpRequest() override;
 
@@ -75,7 +81,16 @@ public:
     /// Return whether connection is in the open state.
     bool IsOpen() const { return GetState() == HTTP_OPEN; }
 
+    /// Return whether the request is executed by the HTTP client pool.
+    bool IsPooled() const { return pooled_; }
+
 private:
+    /// Send the request and read the response, connecting first if no kept alive connection given. Return true if the connection can be reused for another request to the same host.
+    bool Process(mg_connection*& connection, bool keepAlive);
+    /// Send the request line, headers and POST data. Return true on success.
+    bool SendRequest(mg_connection* connection, bool keepAlive);
+    /// Double the main thread read buffer size. Must only be called when the mutex is held.
+    void GrowReadBuffer();
     /// Check for available read data in buffer and whether end has been reached. Must only be called when the mutex is held by the main thread.
     Pair<unsigned, bool> CheckAvailableSizeAndEof() const;
 
@@ -89,6 +104,16 @@ private:
     Vector<String> headers_;
     /// POST data.
     String postData_;
+    /// Host parsed from the URL.
+    String host_;
+    /// Path parsed from the URL.
+    String path_;
+    /// Port parsed from the URL.
+    int port_;
+    /// Secure connection flag.
+    bool ssl_;
+    /// Executed by the HTTP client pool flag.
+    bool pooled_;
     /// Connection state.
     HttpRequestState state_;
     /// Mutex for synchronizing the worker and the main thread.
@@ -97,6 +122,8 @@ private:
     SharedArrayPtr<unsigned char> httpReadBuffer_;
     /// Read buffer for the main thread.
     SharedArrayPtr<unsigned char> readBuffer_;
+    /// Read buffer size for the main thread. Pooled requests grow it as needed. Always a power of two.
+    unsigned readBufferSize_;
     /// Read buffer read cursor.
     unsigned readPosition_;
     /// Read buffer write cursor.
@@ -22,16 +22,20 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
+#include "../Container/Sort.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/PerfCounters.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
-#include "../Network/HttpRequest.h"
+#include "../Network/HttpClientPool.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
 #include "../Network/NetworkPriority.h"
@@ -193,6 +197,12 @@ static const char* RAKNET_MESSAGEID_STRINGS[] = {
 static const int DEFAULT_UPDATE_FPS = 30;
 static const int SERVER_TIMEOUT_TIME = 10000;
 
+static void PrepareServerUpdateWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* connection = reinterpret_cast<Connection*>(item->start_);
+    connection->PrepareServerUpdate(reinterpret_cast<Mutex*>(item->aux_));
+}
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
@@ -201,6 +211,11 @@ Network::Network(Context* context) :
     updateInterval_(1.0f / (float)DEFAULT_UPDATE_FPS),
     updateAcc_(0.0f),
     isServer_(false),
+    threadedServerUpdate_(false),
+    messageBatching_(false),
+    compression_(false),
+    compressionThreshold_(DEFAULT_COMPRESSION_THRESHOLD),
+    trafficProfiling_(false),
     scene_(nullptr),
     natPunchServerAddress_(nullptr),
     remoteGUID_(nullptr)
@@ -217,7 +232,14 @@ Network::Network(Context* context) :
     SetNATServerInfo("127.0.0.1", 61111);
 
     // Register Network library object factories
-    RegisterNetworkLibrary(context_);
+    context_->RegisterLibrary("Network", RegisterNetworkLibrary);
+
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (perfCounters)
+    {
+        bytesInCounter_ = perfCounters->GetCounter("NetworkBytesInPerSec", PCT_GAUGE);
+        bytesOutCounter_ = perfCounters->GetCounter("NetworkBytesOutPerSec", PCT_GAUGE);
+    }
 
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(Network, HandleBeginFrame));
     SubscribeToEvent(E_RENDERUPDATE, URHO3D_HANDLER(Network, HandleRenderUpdate));
@@ -274,6 +296,9 @@ Network::~Network()
     Disconnect(100);
     serverConnection_.Reset();
 
+    finishedHttpRequests_.Clear();
+    httpClientPool_.Reset();
+
     clientConnections_.Clear();
 
     delete natPunchthroughServerClient_;
@@ -319,6 +344,10 @@ void Network::NewConnectionEstablished(const SLNet::AddressOrGUID& connection)
     // Create a new client connection corresponding to this MessageConnection
     SharedPtr<Connection> newConnection(new Connection(context_, true, connection, rakPeer_));
     newConnection->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+    newConnection->SetMessageBatching(messageBatching_);
+    newConnection->SetCompressionDictionary(compressionDictionary_);
+    newConnection->SetCompression(compression_, compressionThreshold_);
+    newConnection->SetTrafficProfiling(trafficProfiling_);
     clientConnections_[connection] = newConnection;
     URHO3D_LOGINFO("Client " + newConnection->ToString() + " connected");
 
@@ -392,6 +421,10 @@ bool Network::Connect(const String& address, unsigned short port, Scene* scene,
     if (connectResult == SLNet::CONNECTION_ATTEMPT_STARTED)
     {
         serverConnection_ = new Connection(context_, false, rakPeerClient_->GetMyBoundAddress(), rakPeerClient_);
+        serverConnection_->SetMessageBatching(messageBatching_);
+        serverConnection_->SetCompressionDictionary(compressionDictionary_);
+        serverConnection_->SetCompression(compression_, compressionThreshold_);
+        serverConnection_->SetTrafficProfiling(trafficProfiling_);
         serverConnection_->SetScene(scene);
         serverConnection_->SetIdentity(identity);
         serverConnection_->SetConnectPending(true);
@@ -427,7 +460,7 @@ void Network::Disconnect(int waitMSec)
     serverConnection_->Disconnect(waitMSec);
 }
 
-bool Network::StartServer(unsigned short port)
+bool Network::StartServer(unsigned short port, unsigned maxConnections)
 {
     if (IsServerRunning())
         return true;
@@ -437,12 +470,12 @@ bool Network::StartServer(unsigned short port)
     SLNet::SocketDescriptor socket;//(port, AF_INET);
     socket.port = port;
     socket.socketFamily = AF_INET;
-    // Startup local connection with max 128 incoming connection(first param) and 1 socket description (third param)
-    SLNet::StartupResult startResult = rakPeer_->Startup(128, &socket, 1);
+    // Startup local connection with max incoming connections(first param) and 1 socket description (third param)
+    SLNet::StartupResult startResult = rakPeer_->Startup(maxConnections, &socket, 1);
     if (startResult == SLNet::RAKNET_STARTED)
     {
         URHO3D_LOGINFO("Started server on port " + String(port));
-        rakPeer_->SetMaximumIncomingConnections(128);
+        rakPeer_->SetMaximumIncomingConnections((unsigned short)maxConnections);
         isServer_ = true;
         rakPeer_->SetOccasionalPing(true);
         rakPeer_->SetUnreliableTimeout(1000);
@@ -592,6 +625,11 @@ void Network::SetUpdateFps(int fps)
     updateAcc_ = 0.0f;
 }
 
+void Network::SetThreadedServerUpdate(bool enable)
+{
+    threadedServerUpdate_ = enable;
+}
+
 void Network::SetSimulatedLatency(int ms)
 {
     simulatedLatency_ = Max(ms, 0);
@@ -625,6 +663,76 @@ void Network::UnregisterAllRemoteEvents()
     allowedRemoteEvents_.Clear();
 }
 
+void Network::RegisterRemoteEventSchema(StringHash eventType, const VariantMap& parameters)
+{
+    RemoteEventSchema& schema = remoteEventSchemas_[eventType];
+    schema.Clear();
+    for (VariantMap::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
+        schema.Push(MakePair(i->first_, i->second_.GetType()));
+
+    // Sort so that the layout does not depend on the order the parameters were given in
+    Sort(schema.Begin(), schema.End());
+}
+
+void Network::UnregisterRemoteEventSchema(StringHash eventType)
+{
+    remoteEventSchemas_.Erase(eventType);
+}
+
+void Network::SetMessageBatching(bool enable)
+{
+    messageBatching_ = enable;
+
+    if (serverConnection_)
+        serverConnection_->SetMessageBatching(enable);
+    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        i->second_->SetMessageBatching(enable);
+}
+
+void Network::SetCompression(bool enable)
+{
+    compression_ = enable;
+
+    if (serverConnection_)
+        serverConnection_->SetCompression(compression_, compressionThreshold_);
+    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        i->second_->SetCompression(compression_, compressionThreshold_);
+}
+
+void Network::SetCompressionThreshold(unsigned bytes)
+{
+    compressionThreshold_ = bytes;
+    SetCompression(compression_);
+}
+
+void Network::SetCompressionDictionary(const PODVector<unsigned char>& dictionary)
+{
+    compressionDictionary_ = dictionary;
+}
+
+void Network::SetTrafficProfiling(bool enable)
+{
+    trafficProfiling_ = enable;
+
+    if (serverConnection_)
+        serverConnection_->SetTrafficProfiling(enable);
+    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        i->second_->SetTrafficProfiling(enable);
+}
+
+void Network::SetHttpThreads(unsigned num)
+{
+    if (num == GetHttpThreads())
+        return;
+
+    httpClientPool_.Reset();
+    if (num)
+        httpClientPool_ = new HttpClientPool(num);
+}
+
 void Network::SetPackageCacheDir(const String& path)
 {
     packageCacheDir_ = AddTrailingSlash(path);
@@ -657,10 +765,62 @@ SharedPtr<HttpRequest> Network::MakeHttpRequest(const String& url, const String&
     URHO3D_PROFILE(MakeHttpRequest);
 
     // The initialization of the request will take time, can not know at this point if it has an error or not
-    SharedPtr<HttpRequest> request(new HttpRequest(url, verb, headers, postData));
+    SharedPtr<HttpRequest> request(new HttpRequest(url, verb, headers, postData, httpClientPool_.NotNull()));
+    if (httpClientPool_)
+        httpClientPool_->AddRequest(request);
     return request;
 }
 
+void Network::GetTrafficStats(NetworkTrafficSample& dest, unsigned numWindows) const
+{
+    dest.Clear();
+
+    // The connections' windows advance together, so the duration of one of them is the duration of the whole sample
+    bool hasDuration = false;
+    Vector<Connection*> connections;
+    if (serverConnection_)
+        connections.Push(serverConnection_);
+    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::ConstIterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        connections.Push(i->second_);
+
+    NetworkTrafficSample sample;
+    for (unsigned i = 0; i < connections.Size(); ++i)
+    {
+        NetworkTrafficStats* stats = connections[i]->GetTrafficStats();
+        if (!stats)
+            continue;
+
+        sample.Clear();
+        stats->GetSample(sample, numWindows);
+        dest.Add(sample);
+        if (!hasDuration)
+        {
+            dest.duration_ = sample.duration_;
+            hasDuration = true;
+        }
+    }
+}
+
+bool Network::SaveTrafficStats(Serializer& dest, unsigned numWindows) const
+{
+    NetworkTrafficSample sample;
+    GetTrafficStats(sample, numWindows);
+    return sample.SaveCSV(dest, context_);
+}
+
+String Network::PrintTrafficStats(unsigned maxRows, unsigned numWindows) const
+{
+    NetworkTrafficSample sample;
+    GetTrafficStats(sample, numWindows);
+    return sample.Print(context_, maxRows);
+}
+
+unsigned Network::GetHttpThreads() const
+{
+    return httpClientPool_ ? httpClientPool_->GetNumThreads() : 0;
+}
+
 void Network::BanAddress(const String& address)
 {
     rakPeer_->AddToBanList(address.CString(), 0);
@@ -707,6 +867,42 @@ bool Network::CheckRemoteEvent(StringHash eventType) const
     return allowedRemoteEvents_.Contains(eventType);
 }
 
+bool Network::WriteCompactRemoteEventData(Serializer& dest, StringHash eventType, const VariantMap& eventData) const
+{
+    HashMap<StringHash, RemoteEventSchema>::ConstIterator i = remoteEventSchemas_.Find(eventType);
+    if (i == remoteEventSchemas_.End())
+        return false;
+
+    // Check that the data matches the layout exactly before writing anything
+    const RemoteEventSchema& schema = i->second_;
+    if (eventData.Size() != schema.Size())
+        return false;
+    for (RemoteEventSchema::ConstIterator j = schema.Begin(); j != schema.End(); ++j)
+    {
+        VariantMap::ConstIterator k = eventData.Find(j->first_);
+        if (k == eventData.End() || k->second_.GetType() != j->second_)
+            return false;
+    }
+
+    for (RemoteEventSchema::ConstIterator j = schema.Begin(); j != schema.End(); ++j)
+        dest.WriteVariantData(*eventData[j->first_]);
+
+    return true;
+}
+
+bool Network::ReadCompactRemoteEventData(Deserializer& source, StringHash eventType, VariantMap& eventData) const
+{
+    HashMap<StringHash, RemoteEventSchema>::ConstIterator i = remoteEventSchemas_.Find(eventType);
+    if (i == remoteEventSchemas_.End())
+        return false;
+
+    const RemoteEventSchema& schema = i->second_;
+    for (RemoteEventSchema::ConstIterator j = schema.Begin(); j != schema.End(); ++j)
+        eventData[j->first_] = source.ReadVariant(j->second_);
+
+    return true;
+}
+
 void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
 {
     unsigned char packetID = packet->data[0];
@@ -901,6 +1097,7 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
 void Network::Update(float timeStep)
 {
     URHO3D_PROFILE(UpdateNetwork);
+    AllocationTagScope allocationTag(ALLOCTAG_NETWORK);
 
     //Process all incoming messages for the server
     if (rakPeer_->IsActive())
@@ -921,11 +1118,29 @@ void Network::Update(float timeStep)
             rakPeerClient_->DeallocatePacket(packet);
         }
     }
+
+    // Notify of pooled HTTP requests finished by the worker threads
+    if (httpClientPool_)
+    {
+        httpClientPool_->GetFinishedRequests(finishedHttpRequests_);
+        for (unsigned i = 0; i < finishedHttpRequests_.Size(); ++i)
+        {
+            using namespace HttpRequestFinished;
+
+            HttpRequest* request = finishedHttpRequests_[i];
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_REQUEST] = request;
+            eventData[P_SUCCESS] = request->GetState() != HTTP_ERROR;
+            SendEvent(E_HTTPREQUESTFINISHED, eventData);
+        }
+        finishedHttpRequests_.Clear();
+    }
 }
 
 void Network::PostUpdate(float timeStep)
 {
     URHO3D_PROFILE(PostUpdateNetwork);
+    AllocationTagScope allocationTag(ALLOCTAG_NETWORK);
 
     // Check if periodic update should happen now
     updateAcc_ += timeStep;
@@ -952,9 +1167,53 @@ void Network::PostUpdate(float timeStep)
                 }
 
                 for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
-                    (*i)->PrepareNetworkUpdate();
+                    (*i)->PrepareNetworkUpdate(threadedServerUpdate_);
             }
 
+            auto* queue = GetSubsystem<WorkQueue>();
+            if (threadedServerUpdate_ && queue && queue->GetNumThreads() && clientConnections_.Size() > 1)
+            {
+                {
+                    URHO3D_PROFILE(PrepareServerUpdateMessages);
+
+                    // Build the scene update messages of each client connection in parallel. The scenes are not
+                    // modified until the messages have been sent, but reading a dirty world transform would update
+                    // it, so bring the transforms up to date first
+                    for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
+                        (*i)->UpdateTransforms();
+
+                    updateConnections_.Clear();
+                    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                        updateConnections_.Push(i->second_);
+
+                    for (unsigned i = 0; i < updateConnections_.Size(); ++i)
+                    {
+                        SharedPtr<WorkItem> item = queue->GetFreeItem();
+                        item->priority_ = M_MAX_UNSIGNED;
+                        item->workFunction_ = PrepareServerUpdateWork;
+                        item->name_ = "PrepareServerUpdateWork";
+                        item->start_ = updateConnections_[i];
+                        item->aux_ = &replicationMutex_;
+                        queue->AddWorkItem(item);
+                    }
+
+                    queue->Complete(M_MAX_UNSIGNED);
+                }
+
+                {
+                    URHO3D_PROFILE(SendServerUpdate);
+
+                    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                    {
+                        i->second_->SendPreparedServerUpdate();
+                        i->second_->SendRemoteEvents();
+                        i->second_->SendPackages();
+                    }
+                }
+            }
+            else
             {
                 URHO3D_PROFILE(SendServerUpdate);
 
@@ -978,6 +1237,45 @@ void Network::PostUpdate(float timeStep)
 
         // Notify that the update was sent
         SendEvent(E_NETWORKUPDATESENT);
+
+        if (bytesInCounter_)
+        {
+            float bytesIn = 0.0f;
+            float bytesOut = 0.0f;
+            if (serverConnection_)
+            {
+                bytesIn += serverConnection_->GetBytesInPerSec();
+                bytesOut += serverConnection_->GetBytesOutPerSec();
+            }
+            for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::ConstIterator i = clientConnections_.Begin();
+                 i != clientConnections_.End(); ++i)
+            {
+                bytesIn += i->second_->GetBytesInPerSec();
+                bytesOut += i->second_->GetBytesOutPerSec();
+            }
+            bytesInCounter_->Set(bytesIn);
+            bytesOutCounter_->Set(bytesOut);
+        }
+    }
+
+    // Send the messages coalesced during the frame, and the compressed messages held back by the flow control earlier
+    if (serverConnection_)
+        serverConnection_->FlushMessageBatches();
+    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        i->second_->FlushMessageBatches();
+
+    // Advance the traffic statistics windows
+    if (trafficProfiling_)
+    {
+        if (serverConnection_ && serverConnection_->GetTrafficStats())
+            serverConnection_->GetTrafficStats()->Update(timeStep);
+        for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+             i != clientConnections_.End(); ++i)
+        {
+            if (i->second_->GetTrafficStats())
+                i->second_->GetTrafficStats()->Update(timeStep);
+        }
     }
 }
 
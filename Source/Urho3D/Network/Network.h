@@ -30,10 +30,15 @@
 namespace Urho3D
 {
 
+class HttpClientPool;
 class HttpRequest;
 class MemoryBuffer;
+class PerfCounter;
 class Scene;
 
+/// Binary layout of a remote event's parameters: names and types, sorted by name hash.
+using RemoteEventSchema = Vector<Pair<StringHash, VariantType> >;
+
 /// %Network subsystem. Manages client-server communications using the UDP protocol.
 class URHO3D_API Network : public Object
 {
@@ -64,8 +69,8 @@ public:
     bool Connect(const String& address, unsigned short port, Scene* scene, const VariantMap& identity = Variant::emptyVariantMap);
     /// Disconnect the connection to the server. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
-    /// Start a server on a port using UDP protocol. Return true if successful.
-    bool StartServer(unsigned short port);
+    /// Start a server on a port using UDP protocol, accepting up to the specified number of client connections. Return true if successful.
+    bool StartServer(unsigned short port, unsigned maxConnections = 128);
     /// Stop the server.
     void StopServer();
     /// Start NAT punchtrough client to allow remote connections.
@@ -86,6 +91,8 @@ public:
     void BroadcastRemoteEvent(Node* node, StringHash eventType, bool inOrder, const VariantMap& eventData = Variant::emptyVariantMap);
     /// Set network update FPS.
     void SetUpdateFps(int fps);
+    /// Set whether to prepare the client connections' scene update messages concurrently in worker threads. Default false.
+    void SetThreadedServerUpdate(bool enable);
     /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet.
     void SetSimulatedLatency(int ms);
     /// Set simulated packet loss probability between 0.0 - 1.0.
@@ -96,10 +103,26 @@ public:
     void UnregisterRemoteEvent(StringHash eventType);
     /// Unregister all remote events.
     void UnregisterAllRemoteEvents();
+    /// Register a binary layout for a remote event's parameters, given as the parameter names mapped to values of their types. Events whose data matches it exactly are then sent without parameter names and types. Must be registered identically on the server and the clients.
+    void RegisterRemoteEventSchema(StringHash eventType, const VariantMap& parameters);
+    /// Unregister the binary layout of a remote event's parameters.
+    void UnregisterRemoteEventSchema(StringHash eventType);
+    /// Set whether to coalesce small messages of the same reliability into one packet per frame. Must be enabled on both ends, as older peers do not understand batches. Default false.
+    void SetMessageBatching(bool enable);
+    /// Set whether to compress the reliable messages of a frame with LZ4 when their total size reaches the compression threshold, for example the initial scene state or large remote events. The compressed data is sent in fragments as the send buffers drain. Only the sending end needs to enable it, but both ends must support it. Default false.
+    void SetCompression(bool enable);
+    /// Set minimum size in bytes of the reliable messages of a frame to compress them. Default 1024.
+    void SetCompressionThreshold(unsigned bytes);
+    /// Set a preset dictionary for compression, for example node data typical of the application's scenes. The compression also uses the earlier data of each connection as the dictionary. Must be the same on the server and the clients, and affects only connections made afterward.
+    void SetCompressionDictionary(const PODVector<unsigned char>& dictionary);
     /// Set the package download cache directory.
     void SetPackageCacheDir(const String& path);
     /// Trigger all client connections in the specified scene to download a package file from the server. Can be used to download additional resource packages when clients are already joined in the scene. The package must have been added as a requirement to the scene, or else the eventual download will fail.
     void SendPackageToClients(Scene* scene, PackageFile* package);
+    /// Set whether to record traffic per message ID, replicated component type and node in all connections. Default false.
+    void SetTrafficProfiling(bool enable);
+    /// Set number of worker threads for pooled HTTP requests. These reuse kept alive connections to the same host and send E_HTTPREQUESTFINISHED when done. 0 (default) gives each HTTP request its own thread and connection. Pending pooled requests are aborted when changed.
+    void SetHttpThreads(unsigned num);
     /// Perform an HTTP request to the specified URL. Empty verb defaults to a GET request. Return a request object which can be used to read the response data.
     SharedPtr<HttpRequest> MakeHttpRequest(const String& url, const String& verb = String::EMPTY, const Vector<String>& headers = Vector<String>(), const String& postData = String::EMPTY);
     /// Ban specific IP addresses.
@@ -107,6 +130,34 @@ public:
     /// Return network update FPS.
     int GetUpdateFps() const { return updateFps_; }
 
+    /// Return whether client connections' scene update messages are prepared in worker threads.
+    bool GetThreadedServerUpdate() const { return threadedServerUpdate_; }
+
+    /// Return whether small messages are coalesced into one packet per frame.
+    bool GetMessageBatching() const { return messageBatching_; }
+
+    /// Return whether large amounts of reliable messages are compressed.
+    bool GetCompression() const { return compression_; }
+
+    /// Return minimum size of the reliable messages of a frame to compress them.
+    unsigned GetCompressionThreshold() const { return compressionThreshold_; }
+
+    /// Return the preset compression dictionary.
+    const PODVector<unsigned char>& GetCompressionDictionary() const { return compressionDictionary_; }
+
+    /// Return number of worker threads for pooled HTTP requests.
+    unsigned GetHttpThreads() const;
+
+    /// Return whether traffic is recorded per message ID, replicated component type and node.
+    bool GetTrafficProfiling() const { return trafficProfiling_; }
+
+    /// Return recorded traffic of all connections over the specified number of most recent one-second windows.
+    void GetTrafficStats(NetworkTrafficSample& dest, unsigned numWindows = NUM_TRAFFIC_WINDOWS) const;
+    /// Write recorded traffic of all connections as CSV. Return true on success.
+    bool SaveTrafficStats(Serializer& dest, unsigned numWindows = NUM_TRAFFIC_WINDOWS) const;
+    /// Return a summary of the categories with the most recorded traffic of all connections.
+    String PrintTrafficStats(unsigned maxRows = 5, unsigned numWindows = NUM_TRAFFIC_WINDOWS) const;
+
     /// Return simulated latency in milliseconds.
     int GetSimulatedLatency() const { return simulatedLatency_; }
 
@@ -123,6 +174,10 @@ public:
     bool IsServerRunning() const;
     /// Return whether a remote event is allowed to be received.
     bool CheckRemoteEvent(StringHash eventType) const;
+    /// Write remote event data in the event's registered binary layout. Return false without writing if there is no layout, or the data does not match it.
+    bool WriteCompactRemoteEventData(Serializer& dest, StringHash eventType, const VariantMap& eventData) const;
+    /// Read remote event data in the event's registered binary layout. Return false if there is no layout.
+    bool ReadCompactRemoteEventData(Deserializer& source, StringHash eventType, VariantMap& eventData) const;
 
     /// Return the package download cache directory.
     const String& GetPackageCacheDir() const { return packageCacheDir_; }
@@ -158,8 +213,18 @@ private:
     HashSet<StringHash> allowedRemoteEvents_;
     /// Remote event fixed blacklist.
     HashSet<StringHash> blacklistedRemoteEvents_;
+    /// Remote event parameter layouts.
+    HashMap<StringHash, RemoteEventSchema> remoteEventSchemas_;
     /// Networked scenes.
     HashSet<Scene*> networkScenes_;
+    /// Client connections with a scene update to prepare.
+    PODVector<Connection*> updateConnections_;
+    /// Mutex for the replication bookkeeping shared between client connections during a threaded server update.
+    Mutex replicationMutex_;
+    /// Pooled HTTP client. Null when HTTP requests use their own threads.
+    SharedPtr<HttpClientPool> httpClientPool_;
+    /// Finished pooled HTTP requests.
+    Vector<SharedPtr<HttpRequest> > finishedHttpRequests_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
@@ -174,6 +239,18 @@ private:
     String packageCacheDir_;
     /// Whether we started as server or not.
     bool isServer_;
+    /// Threaded server update flag.
+    bool threadedServerUpdate_;
+    /// Message batching flag.
+    bool messageBatching_;
+    /// Compression flag.
+    bool compression_;
+    /// Minimum size of the reliable messages of a frame to compress them.
+    unsigned compressionThreshold_;
+    /// Preset compression dictionary.
+    PODVector<unsigned char> compressionDictionary_;
+    /// Traffic profiling flag.
+    bool trafficProfiling_;
     /// Server/Client password used for connecting.
     String password_;
     /// Scene which will be used for NAT punchtrough connections.
@@ -190,6 +267,10 @@ private:
     SLNet::RakNetGUID* remoteGUID_;
     /// Local server GUID.
     String guid_;
+    /// Received bytes per second gauge, published on network update.
+    SharedPtr<PerfCounter> bytesInCounter_;
+    /// Sent bytes per second gauge, published on network update.
+    SharedPtr<PerfCounter> bytesOutCounter_;
 };
 
 /// Register Network library objects.
@@ -148,4 +148,11 @@ URHO3D_EVENT(E_NATMASTERCONNECTIONSUCCEEDED, NetworkNatMasterConnectionSucceeded
     URHO3D_PARAM(P_PORT, Port);         // int
 }
 
+/// Pooled HTTP request finished. The whole response can be read from the request.
+URHO3D_EVENT(E_HTTPREQUESTFINISHED, HttpRequestFinished)
+{
+    URHO3D_PARAM(P_REQUEST, Request);   // HttpRequest pointer
+    URHO3D_PARAM(P_SUCCESS, Success);   // bool
+}
+
 }
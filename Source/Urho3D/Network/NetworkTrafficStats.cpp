@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/Context.h"
+#include "../IO/Serializer.h"
+#include "../Network/NetworkTrafficStats.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Traffic counter with its key formatted for output.
+struct NamedTrafficCounter
+{
+    /// Key name.
+    String name_;
+    /// Counter.
+    NetworkTrafficCounter counter_;
+};
+
+static bool CompareTrafficBytes(const NamedTrafficCounter& lhs, const NamedTrafficCounter& rhs)
+{
+    return lhs.counter_.bytes_ > rhs.counter_.bytes_;
+}
+
+static String GetComponentTypeName(StringHash type, Context* context)
+{
+    const String& name = context ? context->GetTypeName(type) : String::EMPTY;
+    return !name.Empty() ? name : type.ToString();
+}
+
+/// Return the counters of a category formatted and sorted by descending bytes.
+template <class T> static Vector<NamedTrafficCounter> GetSortedCounters(const HashMap<T, NetworkTrafficCounter>& counters,
+    String (*getName)(const T&, Context*), Context* context)
+{
+    Vector<NamedTrafficCounter> result;
+    result.Reserve(counters.Size());
+    for (typename HashMap<T, NetworkTrafficCounter>::ConstIterator i = counters.Begin(); i != counters.End(); ++i)
+    {
+        NamedTrafficCounter named;
+        named.name_ = getName(i->first_, context);
+        named.counter_ = i->second_;
+        result.Push(named);
+    }
+    Sort(result.Begin(), result.End(), CompareTrafficBytes);
+    return result;
+}
+
+static String GetMessageName(const int& msgID, Context* context)
+{
+    return String(msgID);
+}
+
+static String GetComponentName(const StringHash& type, Context* context)
+{
+    return GetComponentTypeName(type, context);
+}
+
+static String GetNodeName(const unsigned& nodeID, Context* context)
+{
+    return String(nodeID);
+}
+
+/// Add the counters of one category to another.
+template <class T> static void AddCounters(HashMap<T, NetworkTrafficCounter>& dest, const HashMap<T, NetworkTrafficCounter>& src)
+{
+    for (typename HashMap<T, NetworkTrafficCounter>::ConstIterator i = src.Begin(); i != src.End(); ++i)
+        dest[i->first_].Add(i->second_);
+}
+
+void NetworkTrafficSample::Clear()
+{
+    messagesIn_.Clear();
+    messagesOut_.Clear();
+    components_.Clear();
+    nodes_.Clear();
+    duration_ = 0.0f;
+}
+
+void NetworkTrafficSample::Add(const NetworkTrafficSample& rhs)
+{
+    AddCounters(messagesIn_, rhs.messagesIn_);
+    AddCounters(messagesOut_, rhs.messagesOut_);
+    AddCounters(components_, rhs.components_);
+    AddCounters(nodes_, rhs.nodes_);
+}
+
+bool NetworkTrafficSample::SaveCSV(Serializer& dest, Context* context) const
+{
+    static const char* categoryNames[] = { "MessageIn", "MessageOut", "Component", "Node" };
+
+    Vector<NamedTrafficCounter> categories[4];
+    categories[0] = GetSortedCounters(messagesIn_, GetMessageName, context);
+    categories[1] = GetSortedCounters(messagesOut_, GetMessageName, context);
+    categories[2] = GetSortedCounters(components_, GetComponentName, context);
+    categories[3] = GetSortedCounters(nodes_, GetNodeName, context);
+
+    bool success = dest.WriteLine("Category,Key,Count,Bytes,BytesPerSec");
+    float invDuration = duration_ > 0.0f ? 1.0f / duration_ : 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        for (unsigned j = 0; j < categories[i].Size(); ++j)
+        {
+            const NamedTrafficCounter& named = categories[i][j];
+            String line;
+            line.AppendWithFormat("%s,%s,%u,%llu,%.1f", categoryNames[i], named.name_.CString(), named.counter_.count_,
+                named.counter_.bytes_, (float)named.counter_.bytes_ * invDuration);
+            success &= dest.WriteLine(line);
+        }
+    }
+
+    return success;
+}
+
+String NetworkTrafficSample::Print(Context* context, unsigned maxRows) const
+{
+    static const char* categoryNames[] = { "Messages in", "Messages out", "Components out", "Nodes out" };
+
+    Vector<NamedTrafficCounter> categories[4];
+    categories[0] = GetSortedCounters(messagesIn_, GetMessageName, context);
+    categories[1] = GetSortedCounters(messagesOut_, GetMessageName, context);
+    categories[2] = GetSortedCounters(components_, GetComponentName, context);
+    categories[3] = GetSortedCounters(nodes_, GetNodeName, context);
+
+    String output;
+    output.AppendWithFormat("Network traffic over %.1f s", duration_);
+    float invDuration = duration_ > 0.0f ? 1.0f / duration_ : 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (categories[i].Empty())
+            continue;
+
+        output.AppendWithFormat("\n%s", categoryNames[i]);
+        unsigned numRows = Min(categories[i].Size(), maxRows);
+        for (unsigned j = 0; j < numRows; ++j)
+        {
+            const NamedTrafficCounter& named = categories[i][j];
+            output.AppendWithFormat("\n  %s: %u msgs %.2f KB/s", named.name_.CString(), named.counter_.count_,
+                (float)named.counter_.bytes_ * invDuration / 1024.0f);
+        }
+    }
+
+    return output;
+}
+
+NetworkTrafficStats::NetworkTrafficStats() :
+    current_(0)
+{
+}
+
+void NetworkTrafficStats::Update(float timeStep)
+{
+    NetworkTrafficSample& window = windows_[current_];
+    window.duration_ += timeStep;
+    if (window.duration_ >= TRAFFIC_WINDOW_LENGTH)
+    {
+        current_ = (current_ + 1) % NUM_TRAFFIC_WINDOWS;
+        windows_[current_].Clear();
+    }
+}
+
+void NetworkTrafficStats::GetSample(NetworkTrafficSample& dest, unsigned numWindows) const
+{
+    numWindows = Min(numWindows, NUM_TRAFFIC_WINDOWS);
+    for (unsigned i = 0; i < numWindows; ++i)
+    {
+        const NetworkTrafficSample& window = windows_[(current_ + NUM_TRAFFIC_WINDOWS - i) % NUM_TRAFFIC_WINDOWS];
+        dest.Add(window);
+        dest.duration_ += window.duration_;
+    }
+}
+
+}
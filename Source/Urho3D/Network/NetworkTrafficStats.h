@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Math/StringHash.h"
+
+namespace Urho3D
+{
+
+class Context;
+class Serializer;
+
+/// Number of rolling windows kept by the network traffic statistics.
+static const unsigned NUM_TRAFFIC_WINDOWS = 10;
+/// Length of one network traffic statistics window in seconds.
+static const float TRAFFIC_WINDOW_LENGTH = 1.0f;
+
+/// Message count and byte size of one network traffic category.
+struct URHO3D_API NetworkTrafficCounter
+{
+    /// Add one message.
+    void Add(unsigned bytes)
+    {
+        ++count_;
+        bytes_ += bytes;
+    }
+
+    /// Add another counter.
+    void Add(const NetworkTrafficCounter& rhs)
+    {
+        count_ += rhs.count_;
+        bytes_ += rhs.bytes_;
+    }
+
+    /// Message count.
+    unsigned count_{};
+    /// Total bytes.
+    unsigned long long bytes_{};
+};
+
+/// Network traffic broken down by message ID, replicated component type and replicated node.
+struct URHO3D_API NetworkTrafficSample
+{
+    /// Clear all counters.
+    void Clear();
+    /// Add counters from another sample.
+    void Add(const NetworkTrafficSample& rhs);
+    /// Write as CSV lines of category, key, message count, bytes and bytes per second. Component types are written by name if registered to the context. Return true on success.
+    bool SaveCSV(Serializer& dest, Context* context) const;
+    /// Return a human-readable summary of the categories with the most bytes.
+    String Print(Context* context, unsigned maxRows = 5) const;
+
+    /// Received messages by message ID.
+    HashMap<int, NetworkTrafficCounter> messagesIn_;
+    /// Sent messages by message ID.
+    HashMap<int, NetworkTrafficCounter> messagesOut_;
+    /// Sent replication messages by component type.
+    HashMap<StringHash, NetworkTrafficCounter> components_;
+    /// Sent replication messages by node ID.
+    HashMap<unsigned, NetworkTrafficCounter> nodes_;
+    /// Length in seconds.
+    float duration_{};
+};
+
+/// Records network traffic of a connection in rolling windows.
+class URHO3D_API NetworkTrafficStats
+{
+public:
+    /// Construct.
+    NetworkTrafficStats();
+
+    /// Advance time. Begins a new window and discards the oldest once the current window is full.
+    void Update(float timeStep);
+    /// Record a received message.
+    void RecordMessageIn(int msgID, unsigned bytes) { windows_[current_].messagesIn_[msgID].Add(bytes); }
+    /// Record a sent message.
+    void RecordMessageOut(int msgID, unsigned bytes) { windows_[current_].messagesOut_[msgID].Add(bytes); }
+    /// Record a sent component replication message.
+    void RecordComponent(StringHash componentType, unsigned bytes) { windows_[current_].components_[componentType].Add(bytes); }
+    /// Record a sent node replication message.
+    void RecordNode(unsigned nodeID, unsigned bytes) { windows_[current_].nodes_[nodeID].Add(bytes); }
+
+    /// Accumulate the specified number of most recent windows, including the current partial one, into a sample.
+    void GetSample(NetworkTrafficSample& dest, unsigned numWindows = NUM_TRAFFIC_WINDOWS) const;
+
+private:
+    /// Windows as a ring buffer.
+    NetworkTrafficSample windows_[NUM_TRAFFIC_WINDOWS];
+    /// Index of the current window.
+    unsigned current_;
+};
+
+}
@@ -64,9 +64,33 @@ static const int MSG_REMOTENODEEVENT = 0x97;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x98;
 
+// Note: the following are at the end of the ID range, so that the first ID for custom messages stays the same
+/// Client->server and server->client: part of the stream of LZ4-compressed reliable messages.
+static const int MSG_COMPRESSED = 0xFA;
+/// Server->client: chunks of a package file that will be sent in response to a RequestPackage message.
+static const int MSG_PACKAGECHUNKS = 0xFB;
+/// Client->server and server->client: several small messages coalesced into one packet.
+static const int MSG_BATCH = 0xFC;
+/// Client->server and server->client: remote event with the parameters in a registered binary layout.
+static const int MSG_COMPACTREMOTEEVENT = 0xFD;
+/// Client->server and server->client: remote node event with the parameters in a registered binary layout.
+static const int MSG_COMPACTREMOTENODEEVENT = 0xFE;
+
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
 /// Package file fragment size.
 static const unsigned PACKAGE_FRAGMENT_SIZE = 1024;
+/// Package file fragments per chunk. Chunks are checksummed to resume interrupted downloads.
+static const unsigned PACKAGE_CHUNK_FRAGMENTS = 64;
+/// Maximum size of a coalesced message batch, chosen to fit a typical MTU along with the SLikeNet headers.
+static const unsigned MAX_MESSAGE_BATCH_SIZE = 1200;
+/// Maximum size of a message to coalesce into a batch. Larger messages are sent on their own.
+static const unsigned MAX_BATCHED_MESSAGE_SIZE = 512;
+/// Default minimum size of the reliable messages of a frame to send them compressed.
+static const unsigned DEFAULT_COMPRESSION_THRESHOLD = 1024;
+/// Maximum size of a compressed stream fragment.
+static const unsigned COMPRESSED_FRAGMENT_SIZE = 16384;
+/// Maximum bytes waiting in the send and resend buffers of a connection before further compressed fragments are held back.
+static const unsigned MAX_COMPRESSED_BYTES_IN_FLIGHT = 65536;
 
 }
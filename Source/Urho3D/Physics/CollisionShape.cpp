@@ -32,6 +32,8 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
@@ -49,6 +51,7 @@
 #include <Bullet/BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btCylinderShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
 #include <Bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
@@ -83,6 +86,13 @@ static const char* typeNames[] =
 
 extern const char* PHYSICS_CATEGORY;
 
+static unsigned HashData(unsigned hash, const unsigned char* data, unsigned size)
+{
+    for (unsigned i = 0; i < size; ++i)
+        hash = SDBMHash(hash, data[i]);
+    return hash;
+}
+
 class TriangleMeshInterface : public btTriangleIndexVertexArray
 {
 public:
@@ -114,6 +124,12 @@ public:
                 continue;
             }
 
+            // Checksum the positions and indices, which determine the BVH
+            unsigned vertexEnd = geometry->GetVertexStart() + geometry->GetVertexCount();
+            for (unsigned j = geometry->GetVertexStart(); j < vertexEnd; ++j)
+                checksum_ = HashData(checksum_, &vertexData[j * vertexSize], sizeof(Vector3));
+            checksum_ = HashData(checksum_, &indexData[geometry->GetIndexStart() * indexSize], geometry->GetIndexCount() * indexSize);
+
             // Keep shared pointers to the vertex/index data so that if it's unloaded or changes size, we don't crash
             dataArrays_.Push(vertexData);
             dataArrays_.Push(indexData);
@@ -190,15 +206,22 @@ public:
 
     /// OK to use quantization flag.
     bool useQuantize_;
+    /// Checksum of the model geometry.
+    unsigned checksum_{};
 
 private:
     /// Shared vertex/index data used in the collision
     Vector<SharedArrayPtr<unsigned char> > dataArrays_;
 };
 
-TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel)
+TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* cachedData)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
+    checksum_ = meshInterface_->checksum_;
+
+    if (cachedData && Load(*cachedData))
+        return;
+
     shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, true);
 
     infoMap_ = new btTriangleInfoMap();
@@ -214,6 +237,93 @@ TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
     btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
 }
 
+TriangleMeshData::~TriangleMeshData()
+{
+    // The shape does not own a loaded BVH, which lives in the buffer
+    shape_.Reset();
+    if (bvh_)
+        bvh_->~btOptimizedBvh();
+    if (bvhBuffer_)
+        btAlignedFree(bvhBuffer_);
+}
+
+bool TriangleMeshData::Load(Deserializer& source)
+{
+    // The BVH is stored in its in-memory layout, so it can only be used on a matching architecture
+    if (source.ReadFileID() != "UBVH" || source.ReadUInt() != checksum_ || source.ReadUByte() != sizeof(void*) ||
+        source.ReadBool() != meshInterface_->useQuantize_)
+        return false;
+
+    unsigned bvhSize = source.ReadUInt();
+    if (!bvhSize || bvhSize > source.GetSize() - source.GetPosition())
+        return false;
+
+    bvhBuffer_ = btAlignedAlloc(bvhSize, 16);
+    if (source.Read(bvhBuffer_, bvhSize) == bvhSize)
+        bvh_ = btOptimizedBvh::deSerializeInPlace(bvhBuffer_, bvhSize, false);
+    if (!bvh_)
+    {
+        btAlignedFree(bvhBuffer_);
+        bvhBuffer_ = nullptr;
+        return false;
+    }
+
+    shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, false);
+    shape_->setOptimizedBvh(bvh_);
+
+    infoMap_ = new btTriangleInfoMap();
+    unsigned numInfos = source.ReadUInt();
+    for (unsigned i = 0; i < numInfos && !source.IsEof(); ++i)
+    {
+        int key = source.ReadInt();
+        btTriangleInfo info;
+        info.m_flags = source.ReadInt();
+        info.m_edgeV0V1Angle = source.ReadFloat();
+        info.m_edgeV1V2Angle = source.ReadFloat();
+        info.m_edgeV2V0Angle = source.ReadFloat();
+        infoMap_->insert(key, info);
+    }
+    shape_->setTriangleInfoMap(infoMap_.Get());
+
+    loaded_ = true;
+    return true;
+}
+
+bool TriangleMeshData::Save(Serializer& dest) const
+{
+    btOptimizedBvh* bvh = shape_ ? shape_->getOptimizedBvh() : nullptr;
+    if (!bvh)
+        return false;
+
+    unsigned bvhSize = bvh->calculateSerializeBufferSize();
+    void* buffer = btAlignedAlloc(bvhSize, 16);
+    bool success = bvh->serializeInPlace(buffer, bvhSize, false);
+    if (success)
+    {
+        success &= dest.WriteFileID("UBVH");
+        success &= dest.WriteUInt(checksum_);
+        success &= dest.WriteUByte((unsigned char)sizeof(void*));
+        success &= dest.WriteBool(meshInterface_->useQuantize_);
+        success &= dest.WriteUInt(bvhSize);
+        success &= dest.Write(buffer, bvhSize) == bvhSize;
+
+        auto numInfos = (unsigned)infoMap_->size();
+        success &= dest.WriteUInt(numInfos);
+        for (unsigned i = 0; i < numInfos; ++i)
+        {
+            const btTriangleInfo* info = infoMap_->getAtIndex(i);
+            success &= dest.WriteInt(infoMap_->getKeyAtIndex(i).getUid1());
+            success &= dest.WriteInt(info->m_flags);
+            success &= dest.WriteFloat(info->m_edgeV0V1Angle);
+            success &= dest.WriteFloat(info->m_edgeV1V2Angle);
+            success &= dest.WriteFloat(info->m_edgeV2V0Angle);
+        }
+    }
+
+    btAlignedFree(buffer);
+    return success;
+}
+
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
@@ -224,7 +334,7 @@ GImpactMeshData::GImpactMeshData(CustomGeometry* custom)
     meshInterface_ = new TriangleMeshInterface(custom);
 }
 
-ConvexData::ConvexData(Model* model, unsigned lodLevel)
+ConvexData::ConvexData(Model* model, unsigned lodLevel, Deserializer* cachedData)
 {
     PODVector<Vector3> vertices;
     unsigned numGeometries = model->GetNumGeometries();
@@ -262,6 +372,11 @@ ConvexData::ConvexData(Model* model, unsigned lodLevel)
         }
     }
 
+    if (vertices.Size())
+        checksum_ = HashData(0, reinterpret_cast<const unsigned char*>(vertices.Buffer()), vertices.Size() * sizeof(Vector3));
+    if (cachedData && Load(*cachedData))
+        return;
+
     BuildHull(vertices);
 }
 
@@ -314,10 +429,50 @@ void ConvexData::BuildHull(const PODVector<Vector3>& vertices)
     }
 }
 
+bool ConvexData::Load(Deserializer& source)
+{
+    if (source.ReadFileID() != "UHUL" || source.ReadUInt() != checksum_)
+        return false;
+
+    unsigned vertexCount = source.ReadUInt();
+    if (vertexCount * sizeof(Vector3) > source.GetSize() - source.GetPosition())
+        return false;
+    SharedArrayPtr<Vector3> vertexData(new Vector3[vertexCount]);
+    if (source.Read(vertexData.Get(), vertexCount * sizeof(Vector3)) != vertexCount * sizeof(Vector3))
+        return false;
+
+    unsigned indexCount = source.ReadUInt();
+    if (indexCount * sizeof(unsigned) > source.GetSize() - source.GetPosition())
+        return false;
+    SharedArrayPtr<unsigned> indexData(new unsigned[indexCount]);
+    if (source.Read(indexData.Get(), indexCount * sizeof(unsigned)) != indexCount * sizeof(unsigned))
+        return false;
+
+    vertexData_ = vertexData;
+    vertexCount_ = vertexCount;
+    indexData_ = indexData;
+    indexCount_ = indexCount;
+    loaded_ = true;
+    return true;
+}
+
+bool ConvexData::Save(Serializer& dest) const
+{
+    bool success = dest.WriteFileID("UHUL");
+    success &= dest.WriteUInt(checksum_);
+    success &= dest.WriteUInt(vertexCount_);
+    success &= dest.Write(vertexData_.Get(), vertexCount_ * sizeof(Vector3)) == vertexCount_ * sizeof(Vector3);
+    success &= dest.WriteUInt(indexCount_);
+    success &= dest.Write(indexData_.Get(), indexCount_ * sizeof(unsigned)) == indexCount_ * sizeof(unsigned);
+    return success;
+}
+
 HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
     heightData_(terrain->GetHeightData()),
+    sourceHeightData_(heightData_),
     spacing_(terrain->GetSpacing()),
     size_(terrain->GetNumVertices()),
+    skip_(1),
     minHeight_(0.0f),
     maxHeight_(0.0f)
 {
@@ -353,6 +508,7 @@ HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
 
             size_ = lodSize;
             spacing_ = lodSpacing;
+            skip_ = skip;
             heightData_ = lodHeightData;
         }
 
@@ -368,6 +524,36 @@ HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
     }
 }
 
+bool HeightfieldData::UpdateRegion(Terrain* terrain, const IntRect& region)
+{
+    // A different height data array means that the terrain was recreated
+    if (!heightData_ || terrain->GetHeightData() != sourceHeightData_)
+        return false;
+
+    // Heightfield points are every skip_ terrain vertices. Ceil the start so that only points inside the region are used
+    int startX = (region.left_ + skip_ - 1) / skip_;
+    int startY = (region.top_ + skip_ - 1) / skip_;
+    int endX = Min(region.right_ / skip_, size_.x_ - 1);
+    int endY = Min(region.bottom_ / skip_, size_.y_ - 1);
+    int sourceWidth = terrain->GetNumVertices().x_;
+    bool inside = true;
+
+    for (int y = startY; y <= endY; ++y)
+    {
+        for (int x = startX; x <= endX; ++x)
+        {
+            // On LOD level 0 the heights are shared with the terrain and already up to date
+            float height = sourceHeightData_[y * skip_ * sourceWidth + x * skip_];
+            if (heightData_ != sourceHeightData_)
+                heightData_[y * size_.x_ + x] = height;
+            if (height < minHeight_ || height > maxHeight_)
+                inside = false;
+        }
+    }
+
+    return inside;
+}
+
 bool HasDynamicBuffers(Model* model, unsigned lodLevel)
 {
     unsigned numGeometries = model->GetNumGeometries();
@@ -424,6 +610,63 @@ CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, CustomGe
     }
 }
 
+static CollisionGeometryData* CreateCachedCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel,
+    const String& cacheDir)
+{
+    if (cacheDir.Empty() || model->GetName().Empty() || (shapeType != SHAPE_TRIANGLEMESH && shapeType != SHAPE_CONVEXHULL))
+        return CreateCollisionGeometryData(shapeType, model, lodLevel);
+
+    auto* cache = model->GetSubsystem<ResourceCache>();
+    String fileName = cacheDir + model->GetName() + "_" + String(lodLevel) + (shapeType == SHAPE_TRIANGLEMESH ? ".bvh" : ".hull");
+    SharedPtr<File> file;
+    if (cache->Exists(fileName))
+        file = cache->GetFile(fileName, false);
+
+    CollisionGeometryData* geometry = nullptr;
+    bool loaded = false;
+    if (shapeType == SHAPE_TRIANGLEMESH)
+    {
+        auto* triMesh = new TriangleMeshData(model, lodLevel, file);
+        loaded = triMesh->loaded_;
+        geometry = triMesh;
+    }
+    else
+    {
+        auto* convex = new ConvexData(model, lodLevel, file);
+        loaded = convex->loaded_;
+        geometry = convex;
+    }
+    file.Reset();
+    if (loaded)
+        return geometry;
+
+    // Filename may or may not be inside the resource system. If not absolute, use the resource dir of the model
+    String fullName = fileName;
+    if (!IsAbsolutePath(fullName))
+    {
+        String modelFileName = cache->GetResourceFileName(model->GetName());
+        if (modelFileName.Empty())
+            return geometry;
+        fullName = modelFileName.Substring(0, modelFileName.Length() - model->GetName().Length()) + fileName;
+    }
+
+    auto* fileSystem = model->GetSubsystem<FileSystem>();
+    String path = GetPath(fullName);
+    if (!fileSystem->DirExists(path))
+        fileSystem->CreateDir(path);
+
+    SharedPtr<File> dest(new File(model->GetContext(), fullName, FILE_WRITE));
+    if (dest->IsOpen())
+    {
+        bool success = shapeType == SHAPE_TRIANGLEMESH ? static_cast<TriangleMeshData*>(geometry)->Save(*dest) :
+            static_cast<ConvexData*>(geometry)->Save(*dest);
+        if (!success)
+            URHO3D_LOGWARNING("Failed to save collision geometry cache file " + fullName);
+    }
+
+    return geometry;
+}
+
 btCollisionShape* CreateCollisionGeometryDataShape(ShapeType shapeType, CollisionGeometryData* geometry, const Vector3& scale)
 {
     switch (shapeType)
@@ -847,6 +1090,9 @@ void CollisionShape::NotifyRigidBody(bool updateMass)
     btCompoundShape* compound = GetParentCompoundShape();
     if (node_ && shape_ && compound)
     {
+        if (physicsWorld_)
+            physicsWorld_->WaitForAsyncStep();
+
         // Remove the shape first to ensure it is not added twice
         compound->removeChildShape(shape_.Get());
 
@@ -891,6 +1137,8 @@ void CollisionShape::ReleaseShape()
     btCompoundShape* compound = GetParentCompoundShape();
     if (shape_ && compound)
     {
+        if (physicsWorld_)
+            physicsWorld_->WaitForAsyncStep();
         compound->removeChildShape(shape_.Get());
         rigidBody_->UpdateMass();
     }
@@ -912,6 +1160,7 @@ void CollisionShape::OnNodeSet(Node* node)
 
         // Terrain collision shape depends on the terrain component's geometry updates. Subscribe to them
         SubscribeToEvent(node, E_TERRAINCREATED, URHO3D_HANDLER(CollisionShape, HandleTerrainCreated));
+        SubscribeToEvent(node, E_TERRAINREGIONUPDATED, URHO3D_HANDLER(CollisionShape, HandleTerrainRegionUpdated));
     }
 }
 
@@ -1122,11 +1371,15 @@ void CollisionShape::UpdateCachedGeometryShape(CollisionGeometryDataCache& cache
             geometry_ = cachedGeometry->second_;
         else
         {
-            geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
-            assert(geometry_);
             // Check if model has dynamic buffers, do not cache in that case
             if (!HasDynamicBuffers(model_, lodLevel_))
+            {
+                geometry_ = CreateCachedCollisionGeometryData(shapeType_, model_, lodLevel_, physicsWorld_->GetGeometryCacheDir());
                 cache[id] = geometry_;
+            }
+            else
+                geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
+            assert(geometry_);
         }
 
         shape_ = CreateCollisionGeometryDataShape(shapeType_, geometry_.Get(), cachedWorldScale_ * size_);
@@ -1206,6 +1459,47 @@ void CollisionShape::HandleTerrainCreated(StringHash eventType, VariantMap& even
     }
 }
 
+void CollisionShape::HandleTerrainRegionUpdated(StringHash eventType, VariantMap& eventData)
+{
+    if (shapeType_ != SHAPE_TERRAIN)
+        return;
+
+    using namespace TerrainRegionUpdated;
+
+    // Bullet reads the heights directly from the heightfield data, so the shape only needs to be recreated if the heights leave
+    // its bounds
+    auto* terrain = GetComponent<Terrain>();
+    auto* heightfield = static_cast<HeightfieldData*>(geometry_.Get());
+    const IntRect& region = eventData[P_REGION].GetIntRect();
+    if (!terrain || !shape_ || !heightfield || !heightfield->UpdateRegion(terrain, region))
+    {
+        UpdateShape();
+        NotifyRigidBody();
+        heightfield = static_cast<HeightfieldData*>(geometry_.Get());
+        if (!terrain || !heightfield)
+            return;
+    }
+
+    // Wake up the bodies resting on the changed region
+    if (physicsWorld_ && node_)
+    {
+        const Vector3& spacing = terrain->GetSpacing();
+        const IntVector2& numVertices = terrain->GetNumVertices();
+        Vector3 origin(-0.5f * (float)(numVertices.x_ - 1) * spacing.x_, 0.0f, -0.5f * (float)(numVertices.y_ - 1) * spacing.z_);
+        BoundingBox localBox(origin + Vector3((float)(region.left_ - 1) * spacing.x_, heightfield->minHeight_,
+            (float)(region.top_ - 1) * spacing.z_), origin + Vector3((float)(region.right_ + 1) * spacing.x_, heightfield->maxHeight_,
+            (float)(region.bottom_ + 1) * spacing.z_));
+
+        PODVector<RigidBody*> bodies;
+        physicsWorld_->GetRigidBodies(bodies, localBox.Transformed(node_->GetWorldTransform()));
+        for (unsigned i = 0; i < bodies.Size(); ++i)
+        {
+            if (bodies[i]->GetMass() > 0.0f)
+                bodies[i]->Activate();
+        }
+    }
+}
+
 void CollisionShape::HandleModelReloadFinished(StringHash eventType, VariantMap& eventData)
 {
     if (physicsWorld_)
@@ -31,6 +31,7 @@ class btBvhTriangleMeshShape;
 class btCollisionShape;
 class btCompoundShape;
 class btGImpactMeshShape;
+class btOptimizedBvh;
 class btTriangleMesh;
 
 struct btTriangleInfoMap;
@@ -39,10 +40,12 @@ namespace Urho3D
 {
 
 class CustomGeometry;
+class Deserializer;
 class Geometry;
 class Model;
 class PhysicsWorld;
 class RigidBody;
+class Serializer;
 class Terrain;
 class TriangleMeshInterface;
 
@@ -73,10 +76,17 @@ using CollisionGeometryDataCache = HashMap<Pair<Model*, unsigned>, SharedPtr<Col
 /// Triangle mesh geometry data.
 struct TriangleMeshData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    TriangleMeshData(Model* model, unsigned lodLevel);
+    /// Construct from a model. If cached data is given and matches the model geometry, load the BVH and triangle info map from it instead of building them.
+    TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* cachedData = nullptr);
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
+    /// Destruct.
+    ~TriangleMeshData() override;
+
+    /// Load the BVH and triangle info map. Return true if successful and the data matches the geometry.
+    bool Load(Deserializer& source);
+    /// Save the BVH and triangle info map. Return true if successful.
+    bool Save(Serializer& dest) const;
 
     /// Bullet triangle mesh interface.
     UniquePtr<TriangleMeshInterface> meshInterface_;
@@ -84,6 +94,14 @@ struct TriangleMeshData : public CollisionGeometryData
     UniquePtr<btBvhTriangleMeshShape> shape_;
     /// Bullet triangle info map.
     UniquePtr<btTriangleInfoMap> infoMap_;
+    /// Loaded BVH, which lives in the aligned BVH buffer.
+    btOptimizedBvh* bvh_{};
+    /// Loaded BVH buffer.
+    void* bvhBuffer_{};
+    /// Checksum of the source geometry.
+    unsigned checksum_{};
+    /// Whether the BVH was loaded instead of built.
+    bool loaded_{};
 };
 
 /// Triangle mesh geometry data.
@@ -101,13 +119,17 @@ struct GImpactMeshData : public CollisionGeometryData
 /// Convex hull geometry data.
 struct ConvexData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    ConvexData(Model* model, unsigned lodLevel);
+    /// Construct from a model. If cached data is given and matches the model geometry, load the hull from it instead of building it.
+    ConvexData(Model* model, unsigned lodLevel, Deserializer* cachedData = nullptr);
     /// Construct from a custom geometry.
     explicit ConvexData(CustomGeometry* custom);
 
     /// Build the convex hull from vertices.
     void BuildHull(const PODVector<Vector3>& vertices);
+    /// Load the hull. Return true if successful and the data matches the geometry.
+    bool Load(Deserializer& source);
+    /// Save the hull. Return true if successful.
+    bool Save(Serializer& dest) const;
 
     /// Vertex data.
     SharedArrayPtr<Vector3> vertexData_;
@@ -117,6 +139,10 @@ struct ConvexData : public CollisionGeometryData
     SharedArrayPtr<unsigned> indexData_;
     /// Number of indices.
     unsigned indexCount_{};
+    /// Checksum of the source geometry.
+    unsigned checksum_{};
+    /// Whether the hull was loaded instead of built.
+    bool loaded_{};
 };
 
 /// Heightfield geometry data.
@@ -125,12 +151,19 @@ struct HeightfieldData : public CollisionGeometryData
     /// Construct from a terrain.
     HeightfieldData(Terrain* terrain, unsigned lodLevel);
 
+    /// Update a region after the terrain's height data changed. The region is in terrain vertex coordinates and inclusive. Return true if the heights are still within the minimum and maximum height, or false if the shape needs to be recreated.
+    bool UpdateRegion(Terrain* terrain, const IntRect& region);
+
     /// Height data. On LOD level 0 the original height data will be used.
     SharedArrayPtr<float> heightData_;
+    /// Original height data of the terrain.
+    SharedArrayPtr<float> sourceHeightData_;
     /// Vertex spacing.
     Vector3 spacing_;
     /// Heightmap size.
     IntVector2 size_;
+    /// Terrain vertices skipped per heightfield point.
+    int skip_;
     /// Minimum height.
     float minHeight_;
     /// Maximum height.
@@ -141,6 +174,7 @@ struct HeightfieldData : public CollisionGeometryData
 class URHO3D_API CollisionShape : public Component
 {
     URHO3D_OBJECT(CollisionShape, Component);
+    URHO3D_POOLED_OBJECT(CollisionShape);
 
 public:
     /// Construct.
@@ -279,6 +313,8 @@ private:
         const Vector3& scale, const Vector3& position, const Quaternion& rotation);
     /// Update terrain collision shape from the terrain component.
     void HandleTerrainCreated(StringHash eventType, VariantMap& eventData);
+    /// Update the terrain collision shape from a changed region of the height data.
+    void HandleTerrainRegionUpdated(StringHash eventType, VariantMap& eventData);
     /// Update trimesh or convex shape after a model has reloaded itself.
     void HandleModelReloadFinished(StringHash eventType, VariantMap& eventData);
     /// Mark shape dirty.
@@ -348,6 +348,8 @@ void Constraint::ReleaseConstraint()
 {
     if (constraint_)
     {
+        if (physicsWorld_)
+            physicsWorld_->WaitForAsyncStep();
         if (ownBody_)
             ownBody_->RemoveConstraint(this);
         if (otherBody_)
@@ -459,6 +461,8 @@ void Constraint::CreateConstraint()
 {
     URHO3D_PROFILE(CreateConstraint);
 
+    if (physicsWorld_)
+        physicsWorld_->WaitForAsyncStep();
     cachedWorldScale_ = node_->GetWorldScale();
 
     ReleaseConstraint();
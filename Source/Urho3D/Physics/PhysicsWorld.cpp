@@ -24,9 +24,14 @@
 
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
+#include "../Core/PerfCounters.h"
+#include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
 #include "../Physics/CollisionShape.h"
@@ -43,12 +48,21 @@
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btTriangleMesh.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Bullet/BulletDynamics/Dynamics/btSimulationIslandManagerMt.h>
+#include <Bullet/LinearMath/btQuickprof.h>
+
+#include <atomic>
 
 extern ContactAddedCallback gContactAddedCallback;
+extern int gNumClampedCcdMotions;
 
 namespace Urho3D
 {
@@ -58,14 +72,356 @@ extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+static const unsigned MIN_QUERIES_PER_WORK_ITEM = 16;
+/// User index of the Bullet collision objects of static batches. Their user pointer is the batch instead of a rigid body.
+static const int STATIC_BATCH_USER_INDEX = 0x53424154;
+/// Maximum number of triangles in the merged mesh of a static batch, limited by the quantized BVH.
+static const unsigned MAX_STATIC_BATCH_TRIANGLES = 1u << 21u;
 
 PhysicsWorldConfig PhysicsWorld::config;
 
+StaticCollisionBatch::~StaticCollisionBatch() = default;
+
+RigidBody* StaticCollisionBatch::GetBody(int shapePart, int index) const
+{
+    // The merged mesh reports its own shape part and triangle index, while the compound shape reports the child index
+    const PODVector<unsigned>& bodyIndices = shapePart >= 0 ? triangleBodies_ : childBodies_;
+    return index >= 0 && (unsigned)index < bodyIndices.Size() ? bodies_[bodyIndices[index]] : nullptr;
+}
+
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+static void ClearRaycastResult(PhysicsRaycastResult& result)
+{
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+    result.body_ = nullptr;
+}
+
+/// Closest hit raycast callback which also records the shape part and index of the hit, to resolve static batches.
+struct ClosestRayCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+    /// Construct.
+    ClosestRayCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld) :
+        btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld)
+    {
+    }
+
+    /// Add a hit. Only called with hits closer than the previous.
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace) override
+    {
+        shapePart_ = rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_shapePart : -1;
+        index_ = rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_triangleIndex : -1;
+        return btCollisionWorld::ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+    }
+
+    /// Return the rigid body that was hit.
+    RigidBody* GetBody() const { return PhysicsWorld::GetRigidBody(m_collisionObject, shapePart_, index_); }
+
+    /// Shape part of the hit.
+    int shapePart_{-1};
+    /// Triangle or child shape index of the hit.
+    int index_{-1};
+};
+
+/// Closest hit convex sweep callback which also records the shape part and index of the hit, to resolve static batches.
+struct ClosestConvexCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+    /// Construct.
+    ClosestConvexCallback(const btVector3& convexFromWorld, const btVector3& convexToWorld) :
+        btCollisionWorld::ClosestConvexResultCallback(convexFromWorld, convexToWorld)
+    {
+    }
+
+    /// Add a hit. Only called with hits closer than the previous.
+    btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace) override
+    {
+        shapePart_ = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_shapePart : -1;
+        index_ = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_triangleIndex : -1;
+        return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+    }
+
+    /// Return the rigid body that was hit.
+    RigidBody* GetBody() const { return PhysicsWorld::GetRigidBody(m_hitCollisionObject, shapePart_, index_); }
+
+    /// Shape part of the hit.
+    int shapePart_{-1};
+    /// Triangle or child shape index of the hit.
+    int index_{-1};
+};
+
+/// All hits raycast callback which also records the shape part and index of each hit, to resolve static batches.
+struct AllHitsRayCallback : public btCollisionWorld::AllHitsRayResultCallback
+{
+    /// Construct.
+    AllHitsRayCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld) :
+        btCollisionWorld::AllHitsRayResultCallback(rayFromWorld, rayToWorld)
+    {
+    }
+
+    /// Add a hit.
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace) override
+    {
+        shapeParts_.Push(rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_shapePart : -1);
+        indices_.Push(rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_triangleIndex : -1);
+        return btCollisionWorld::AllHitsRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+    }
+
+    /// Return the rigid body of a hit.
+    RigidBody* GetBody(unsigned index) const
+    {
+        return PhysicsWorld::GetRigidBody(m_collisionObjects[index], shapeParts_[index], indices_[index]);
+    }
+
+    /// Shape parts of the hits.
+    PODVector<int> shapeParts_;
+    /// Triangle or child shape indices of the hits.
+    PODVector<int> indices_;
+};
+
+/// Collects the world space triangle vertices of a triangle mesh collision shape for the merged mesh of a static batch.
+struct StaticBatchTriangleCallback : public btTriangleCallback
+{
+    /// Construct.
+    StaticBatchTriangleCallback(PODVector<float>& vertices, const btTransform& transform) :
+        vertices_(vertices),
+        transform_(transform)
+    {
+    }
+
+    /// Add a triangle.
+    void processTriangle(btVector3* triangle, int partId, int triangleIndex) override
+    {
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            btVector3 vertex = transform_ * triangle[i];
+            vertices_.Push(vertex.x());
+            vertices_.Push(vertex.y());
+            vertices_.Push(vertex.z());
+        }
+    }
+
+    /// Destination vertices, three per triangle.
+    PODVector<float>& vertices_;
+    /// Transform from the collision shape to world space.
+    btTransform transform_;
+};
+
+/// Return whether a rigid body can be merged into a static batch.
+static bool IsStaticBatchCandidate(RigidBody* body)
+{
+    if (!body->IsInWorld() || body->IsBatched() || body->GetMass() > 0.0f || body->IsKinematic() || body->IsTrigger() ||
+        !body->GetConstraints().Empty())
+        return false;
+
+    // Static planes are infinite, and hits on terrains and GImpact meshes could not be mapped back to the rigid body
+    btCompoundShape* compound = body->GetCompoundShape();
+    if (!compound->getNumChildShapes())
+        return false;
+    for (int i = 0; i < compound->getNumChildShapes(); ++i)
+    {
+        btCollisionShape* shape = compound->getChildShape(i);
+        int shapeType = shape->getShapeType();
+        if (!shape->isConvex() && shapeType != SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE && shapeType != TRIANGLE_MESH_SHAPE_PROXYTYPE)
+            return false;
+    }
+
+    return true;
+}
+
+static void RaycastClosest(btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    ClosestRayCallback rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = rayCallback.GetBody();
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+static void ConvexCastClosest(btCollisionWorld* world, PhysicsRaycastResult& result, const btConvexShape* shape,
+    const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    ClosestConvexCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(shape, btTransform(ToBtQuaternion(startRot), convexCallback.m_convexFromWorld),
+        btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = convexCallback.GetBody();
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+/// Shared data of a batched physics query.
+struct BatchQueryData
+{
+    /// Bullet collision world.
+    btCollisionWorld* world_;
+    /// First query.
+    const void* queries_;
+    /// First result.
+    PhysicsRaycastResult* results_;
+};
+
+static void RaycastBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* data = static_cast<BatchQueryData*>(item->aux_);
+    auto* start = static_cast<PhysicsRaycastResult*>(item->start_);
+    auto* end = static_cast<PhysicsRaycastResult*>(item->end_);
+    const PhysicsRaycastQuery* query = static_cast<const PhysicsRaycastQuery*>(data->queries_) + (start - data->results_);
+
+    for (PhysicsRaycastResult* result = start; result != end; ++result, ++query)
+    {
+        if (query->radius_ > 0.0f)
+        {
+            btSphereShape shape(query->radius_);
+            ConvexCastClosest(data->world_, *result, &shape, query->ray_.origin_, Quaternion::IDENTITY,
+                query->ray_.origin_ + query->maxDistance_ * query->ray_.direction_, Quaternion::IDENTITY, query->collisionMask_);
+        }
+        else
+            RaycastClosest(data->world_, *result, query->ray_, query->maxDistance_, query->collisionMask_);
+    }
+}
+
+static void ConvexCastBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* data = static_cast<BatchQueryData*>(item->aux_);
+    auto* start = static_cast<PhysicsRaycastResult*>(item->start_);
+    auto* end = static_cast<PhysicsRaycastResult*>(item->end_);
+    const PhysicsConvexCastQuery* query = static_cast<const PhysicsConvexCastQuery*>(data->queries_) + (start - data->results_);
+
+    for (PhysicsRaycastResult* result = start; result != end; ++result, ++query)
+    {
+        if (query->shape_ && query->shape_->isConvex())
+        {
+            ConvexCastClosest(data->world_, *result, static_cast<const btConvexShape*>(query->shape_), query->startPos_,
+                query->startRot_, query->endPos_, query->endRot_, query->collisionMask_);
+        }
+        else
+            ClearRaycastResult(*result);
+    }
+}
+
+static void RunBatchQuery(void (*workFunction)(const WorkItem*, unsigned), BatchQueryData* data, unsigned numQueries, WorkQueue* queue)
+{
+    unsigned numThreads = queue ? queue->GetNumThreads() + 1 : 1;
+    unsigned queriesPerItem = Max((numQueries + numThreads - 1) / numThreads, MIN_QUERIES_PER_WORK_ITEM);
+
+    // Run small batches directly to avoid the work queue overhead
+    if (numThreads == 1 || queriesPerItem >= numQueries)
+    {
+        WorkItem item;
+        item.start_ = data->results_;
+        item.end_ = data->results_ + numQueries;
+        item.aux_ = data;
+        workFunction(&item, 0);
+        return;
+    }
+
+    for (unsigned start = 0; start < numQueries; start += queriesPerItem)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = workFunction;
+        item->name_ = "PhysicsQueryWork";
+        item->start_ = data->results_ + start;
+        item->end_ = data->results_ + Min(start + queriesPerItem, numQueries);
+        item->aux_ = data;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+static void WriteContactBuffer(VectorBuffer& buffer, const ManifoldPair& manifolds, bool flip)
+{
+    buffer.Clear();
+
+    // Normals of the manifold with the body pointers flipped need to be flipped also
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        btPersistentManifold* contactManifold = i ? manifolds.flippedManifold_ : manifolds.manifold_;
+        if (!contactManifold)
+            continue;
+        bool flipNormal = (i == 1) != flip;
+        for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+        {
+            btManifoldPoint& point = contactManifold->getContactPoint(j);
+            buffer.WriteVector3(ToVector3(point.m_positionWorldOnB));
+            buffer.WriteVector3(flipNormal ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB));
+            buffer.WriteFloat(point.m_distance1);
+            buffer.WriteFloat(point.m_appliedImpulse);
+        }
+    }
+}
+
+static void WriteContactPoints(PODVector<PhysicsContactPoint>& points, const ManifoldPair& manifolds, bool flip)
+{
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        btPersistentManifold* contactManifold = i ? manifolds.flippedManifold_ : manifolds.manifold_;
+        if (!contactManifold)
+            continue;
+        bool flipNormal = (i == 1) != flip;
+        for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+        {
+            btManifoldPoint& point = contactManifold->getContactPoint(j);
+            points.Resize(points.Size() + 1);
+            PhysicsContactPoint& dest = points.Back();
+            dest.position_ = ToVector3(point.m_positionWorldOnB);
+            dest.normal_ = flipNormal ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB);
+            dest.distance_ = point.m_distance1;
+            dest.impulse_ = point.m_appliedImpulse;
+        }
+    }
+}
+
+#ifdef URHO3D_PROFILING
+/// Profiler that receives Bullet's internal profiling zones.
+static std::atomic<Profiler*> bulletProfiler{nullptr};
+/// Number of physics worlds forwarding Bullet's profiling zones.
+static unsigned numBulletProfilingWorlds = 0;
+
+static void EnterBulletProfileZone(const char* name)
+{
+    Profiler* profiler = bulletProfiler.load(std::memory_order_relaxed);
+    if (profiler)
+        profiler->BeginBlock(name);
+}
+
+static void LeaveBulletProfileZone()
+{
+    Profiler* profiler = bulletProfiler.load(std::memory_order_relaxed);
+    if (profiler)
+        profiler->EndBlock();
+}
+#endif
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -83,7 +439,7 @@ static bool CustomMaterialCombinerCallback(btManifoldPoint& cp, const btCollisio
     // because btAdjustInternalEdgeContacts doesn't check types properly. Bug in the Bullet?
     const int shapeType = colObj1Wrap->getCollisionObject()->getCollisionShape()->getShapeType();
     if (shapeType == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE || shapeType == TRIANGLE_SHAPE_PROXYTYPE
-        || shapeType == MULTIMATERIAL_TRIANGLE_MESH_PROXYTYPE)
+        || shapeType == MULTIMATERIAL_TRIANGLE_MESH_PROXYTYPE || shapeType == TRIANGLE_MESH_SHAPE_PROXYTYPE)
     {
         btAdjustInternalEdgeContacts(cp, colObj1Wrap, colObj0Wrap, partId1, index1);
     }
@@ -126,13 +482,13 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     }
 
     /// Add a contact result.
-    btScalar addSingleResult(btManifoldPoint&, const btCollisionObjectWrapper* colObj0Wrap, int, int,
-        const btCollisionObjectWrapper* colObj1Wrap, int, int) override
+    btScalar addSingleResult(btManifoldPoint&, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0,
+        const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1) override
     {
-        auto* body = reinterpret_cast<RigidBody*>(colObj0Wrap->getCollisionObject()->getUserPointer());
+        RigidBody* body = PhysicsWorld::GetRigidBody(colObj0Wrap->getCollisionObject(), partId0, index0);
         if (body && !result_.Contains(body) && (body->GetCollisionLayer() & collisionMask_))
             result_.Push(body);
-        body = reinterpret_cast<RigidBody*>(colObj1Wrap->getCollisionObject()->getUserPointer());
+        body = PhysicsWorld::GetRigidBody(colObj1Wrap->getCollisionObject(), partId1, index1);
         if (body && !result_.Contains(body) && (body->GetCollisionLayer() & collisionMask_))
             result_.Push(body);
         return 0.0f;
@@ -144,6 +500,122 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+/// Constraint solver which allows simulation islands to be solved in parallel, by using one sequential impulse solver per thread.
+class ConstraintSolverPool : public btConstraintSolver
+{
+public:
+    /// Construct with the number of solvers.
+    explicit ConstraintSolverPool(unsigned numSolvers) :
+        solvers_(numSolvers),
+        mutexes_(numSolvers)
+    {
+        for (unsigned i = 0; i < numSolvers; ++i)
+        {
+            solvers_[i] = new btSequentialImpulseConstraintSolver();
+            mutexes_[i] = new Mutex();
+        }
+    }
+
+    /// Solve a group of constraints with a solver not in use by another thread.
+    btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds,
+        btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+        btDispatcher* dispatcher) override
+    {
+        // There is one solver per thread, so a free solver is found on the first pass
+        for (;;)
+        {
+            for (unsigned i = 0; i < solvers_.Size(); ++i)
+            {
+                if (mutexes_[i]->TryAcquire())
+                {
+                    btScalar result = solvers_[i]->solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints,
+                        info, debugDrawer, dispatcher);
+                    mutexes_[i]->Release();
+                    return result;
+                }
+            }
+        }
+    }
+
+    /// Reset the solvers.
+    void reset() override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->reset();
+    }
+
+    /// Return solver type.
+    btConstraintSolverType getSolverType() const override { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+
+private:
+    /// Solvers.
+    Vector<UniquePtr<btSequentialImpulseConstraintSolver> > solvers_;
+    /// Solver locks.
+    Vector<UniquePtr<Mutex> > mutexes_;
+};
+
+/// Work queue used for dispatching simulation islands. The Bullet island dispatch function takes no user data.
+static WorkQueue* islandWorkQueue = nullptr;
+
+static void SolveIslandWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* island = reinterpret_cast<btSimulationIslandManagerMt::Island*>(item->start_);
+    auto* callback = reinterpret_cast<btSimulationIslandManagerMt::IslandCallback*>(item->aux_);
+
+    callback->processIsland(&island->bodyArray[0], island->bodyArray.size(),
+        island->manifoldArray.size() ? &island->manifoldArray[0] : nullptr, island->manifoldArray.size(),
+        island->constraintArray.size() ? &island->constraintArray[0] : nullptr, island->constraintArray.size(), island->id);
+}
+
+static void WorkQueueIslandDispatch(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands,
+    btSimulationIslandManagerMt::IslandCallback* callback)
+{
+    // The work queue can only be used from the main thread, so an asynchronous step solves the islands serially
+    if (!islandWorkQueue || islands->size() < 2 || !Thread::IsMainThread())
+    {
+        btSimulationIslandManagerMt::defaultIslandDispatch(islands, callback);
+        return;
+    }
+
+    // Bullet has already merged the small islands into batches, so each island is one work item
+    for (int i = 0; i < islands->size(); ++i)
+    {
+        SharedPtr<WorkItem> item = islandWorkQueue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = SolveIslandWork;
+        item->name_ = "SolveIslandWork";
+        item->start_ = (*islands)[i];
+        item->aux_ = callback;
+        islandWorkQueue->AddWorkItem(item);
+    }
+
+    islandWorkQueue->Complete(M_MAX_UNSIGNED);
+}
+
+/// Thread running one asynchronous simulation step of a physics world. A new thread is started for each step and joined to
+/// complete it, as Condition can not be waited on reliably without a lost wakeup when the step finishes early.
+class PhysicsStepThread : public Thread
+{
+public:
+    /// Construct.
+    explicit PhysicsStepThread(PhysicsWorld* world) :
+        world_(world)
+    {
+    }
+
+    /// Run the simulation step.
+    void ThreadFunction() override
+    {
+        InitFPU();
+        world_->StepSimulation(timeStep_);
+    }
+
+    /// Physics world.
+    PhysicsWorld* world_;
+    /// Timestep of the step.
+    float timeStep_{};
+};
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -160,8 +632,21 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.Get()));
 
     broadphase_ = new btDbvtBroadphase();
-    solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+
+    // Solve the simulation islands in the work queue threads if requested and the threads exist
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (PhysicsWorld::config.multiThreaded_ && queue && queue->GetNumThreads())
+    {
+        islandWorkQueue = queue;
+        solver_ = new ConstraintSolverPool(queue->GetNumThreads() + 1);
+        world_ = new btDiscreteDynamicsWorldMt(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+        static_cast<btSimulationIslandManagerMt*>(world_->getSimulationIslandManager())->setIslandDispatchFunction(WorkQueueIslandDispatch);
+    }
+    else
+    {
+        solver_ = new btSequentialImpulseConstraintSolver();
+        world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -170,10 +655,37 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     world_->setInternalTickCallback(InternalPreTickCallback, static_cast<void*>(this), true);
     world_->setInternalTickCallback(InternalTickCallback, static_cast<void*>(this), false);
     world_->setSynchronizeAllMotionStates(true);
+
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (perfCounters)
+    {
+        pairsCounter_ = perfCounters->GetCounter("PhysicsPairs");
+        activeBodiesCounter_ = perfCounters->GetCounter("PhysicsActiveBodies", PCT_GAUGE);
+        overlappingPairsCounter_ = perfCounters->GetCounter("PhysicsOverlappingPairs", PCT_GAUGE);
+        ccdHitsCounter_ = perfCounters->GetCounter("PhysicsCCDHits");
+    }
+
+#ifdef URHO3D_PROFILING
+    // Show Bullet's own profiling zones, such as the broadphase, narrowphase, solver and integration stages, as blocks under the
+    // simulation step. The zones of worker threads only appear in the profiler timeline
+    auto* profiler = GetSubsystem<Profiler>();
+    if (profiler)
+    {
+        bulletProfiler = profiler;
+        btSetCustomEnterProfileZoneFunc(EnterBulletProfileZone);
+        btSetCustomLeaveProfileZoneFunc(LeaveBulletProfileZone);
+        ++numBulletProfilingWorlds;
+        bulletProfiling_ = true;
+    }
+#endif
+
+    lastCcdHits_ = gNumClampedCcdMotions;
 }
 
 PhysicsWorld::~PhysicsWorld()
 {
+    WaitForAsyncStep();
+
     if (scene_)
     {
         // Force all remaining constraints, rigid bodies and collision shapes to release themselves
@@ -196,6 +708,11 @@ PhysicsWorld::~PhysicsWorld()
     if (!PhysicsWorld::config.collisionConfig_)
         delete collisionConfiguration_;
     collisionConfiguration_ = nullptr;
+
+#ifdef URHO3D_PROFILING
+    if (bulletProfiling_ && --numBulletProfilingWorlds == 0)
+        bulletProfiler = nullptr;
+#endif
 }
 
 void PhysicsWorld::RegisterObject(Context* context)
@@ -210,6 +727,11 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Sync Position Threshold", GetSyncPositionThreshold, SetSyncPositionThreshold, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Sync Rotation Threshold", GetSyncRotationThreshold, SetSyncRotationThreshold, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Static Batching", GetStaticBatching, SetStaticBatching, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Static Batch Cell Size", GetStaticBatchCellSize, SetStaticBatchCellSize, float,
+        DEFAULT_STATIC_BATCH_CELL_SIZE, AM_DEFAULT);
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -226,16 +748,64 @@ void PhysicsWorld::drawLine(const btVector3& from, const btVector3& to, const bt
         debugRenderer_->AddLine(ToVector3(from), ToVector3(to), Color(color.x(), color.y(), color.z()), debugDepthTest_);
 }
 
+void PhysicsWorld::drawSphere(btScalar radius, const btTransform& transform, const btVector3& color)
+{
+    if (debugRenderer_)
+    {
+        debugRenderer_->AddShape(DEBUGSHAPE_SPHERE, Matrix3x4(ToVector3(transform.getOrigin()), ToQuaternion(transform.getRotation()),
+            radius), Color(color.x(), color.y(), color.z()), debugDepthTest_);
+    }
+}
+
+void PhysicsWorld::drawBox(const btVector3& bbMin, const btVector3& bbMax, const btTransform& trans, const btVector3& color)
+{
+    if (debugRenderer_)
+    {
+        BoundingBox box(ToVector3(bbMin), ToVector3(bbMax));
+        debugRenderer_->AddBoundingBox(box, Matrix3x4(ToVector3(trans.getOrigin()), ToQuaternion(trans.getRotation()), 1.0f),
+            Color(color.x(), color.y(), color.z()), debugDepthTest_);
+    }
+}
+
+void PhysicsWorld::drawCapsule(btScalar radius, btScalar halfHeight, int upAxis, const btTransform& transform, const btVector3& color)
+{
+    if (debugRenderer_)
+    {
+        btVector3 offset(0.0f, 0.0f, 0.0f);
+        offset[upAxis] = halfHeight;
+        debugRenderer_->AddCapsule(ToVector3(transform * -offset), ToVector3(transform * offset), radius,
+            Color(color.x(), color.y(), color.z()), debugDepthTest_);
+    }
+}
+
+void PhysicsWorld::drawCylinder(btScalar radius, btScalar halfHeight, int upAxis, const btTransform& transform, const btVector3& color)
+{
+    if (debugRenderer_)
+    {
+        // The debug cylinder extends upward from its base, so rotate the up axis into place and offset by half the height
+        btVector3 axis(0.0f, 0.0f, 0.0f);
+        axis[upAxis] = 1.0f;
+        Quaternion rotation = ToQuaternion(transform.getRotation()) * Quaternion(Vector3::UP, ToVector3(axis));
+        debugRenderer_->AddShape(DEBUGSHAPE_CYLINDER, Matrix3x4(ToVector3(transform * (-halfHeight * axis)), rotation,
+            Vector3(radius, 2.0f * halfHeight, radius)), Color(color.x(), color.y(), color.z()), debugDepthTest_);
+    }
+}
+
 void PhysicsWorld::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 {
     if (debug)
     {
         URHO3D_PROFILE(PhysicsDrawDebug);
 
+        WaitForAsyncStep();
+
         debugRenderer_ = debug;
         debugDepthTest_ = depthTest;
         world_->debugDrawWorld();
         debugRenderer_ = nullptr;
+
+        if (drawIslands_)
+            DrawIslands(debug, depthTest);
     }
 }
 
@@ -257,6 +827,30 @@ void PhysicsWorld::Update(float timeStep)
 {
     URHO3D_PROFILE(UpdatePhysics);
 
+    if (rewinding_)
+    {
+        URHO3D_LOGWARNING("Physics world still rewound at simulation update, restoring current transforms");
+        EndRewind();
+    }
+
+    // Results of an asynchronous step are applied first, also if asynchronous mode has been disabled since
+    CompleteAsyncStep();
+    UpdateStaticBatches();
+
+    if (asyncUpdate_)
+    {
+        BeginAsyncStep(timeStep);
+        return;
+    }
+
+    contacts_.Clear();
+    contactPoints_.Clear();
+    StepSimulation(timeStep);
+    SyncWorldTransforms();
+}
+
+void PhysicsWorld::StepSimulation(float timeStep)
+{
     float internalTimeStep = 1.0f / fps_;
     int maxSubSteps = (int)(timeStep * fps_) + 1;
     if (maxSubSteps_ < 0)
@@ -267,6 +861,7 @@ void PhysicsWorld::Update(float timeStep)
     else if (maxSubSteps_ > 0)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
+    pendingWorldTransforms_.Clear();
     delayedWorldTransforms_.Clear();
     simulating_ = true;
 
@@ -284,6 +879,21 @@ void PhysicsWorld::Update(float timeStep)
     }
 
     simulating_ = false;
+}
+
+void PhysicsWorld::SyncWorldTransforms()
+{
+    // Apply the simulated transforms to the scene nodes in one pass, at most once per body
+    URHO3D_PROFILE(SyncWorldTransforms);
+
+    numSyncedTransforms_ = 0;
+    float minRotationDot = Cos(syncRotationThreshold_ * 0.5f);
+    for (PODVector<RigidBody*>::ConstIterator i = pendingWorldTransforms_.Begin(); i != pendingWorldTransforms_.End(); ++i)
+    {
+        if ((*i)->SyncWorldTransform(syncPositionThreshold_, minRotationDot))
+            ++numSyncedTransforms_;
+    }
+    pendingWorldTransforms_.Clear();
 
     // Apply delayed (parented) world transforms now
     while (!delayedWorldTransforms_.Empty())
@@ -305,79 +915,554 @@ void PhysicsWorld::Update(float timeStep)
     }
 }
 
-void PhysicsWorld::UpdateCollisions()
+void PhysicsWorld::CompleteAsyncStep()
+{
+    if (!asyncResultsPending_)
+        return;
+
+    URHO3D_PROFILE(CompleteAsyncStep);
+
+    // Commands are applied before the sync pass, so that teleported bodies are not moved back to their simulated transforms
+    WaitForAsyncStep();
+    asyncResultsPending_ = false;
+
+    SyncWorldTransforms();
+
+    // Events are sent once for the whole step, with the collisions of its last substep
+    if (numAsyncSubSteps_)
+    {
+        contacts_.Clear();
+        contactPoints_.Clear();
+        SendCollisionEvents();
+
+        using namespace PhysicsPostStep;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_WORLD] = this;
+        eventData[P_TIMESTEP] = asyncTimeStep_;
+        SendEvent(E_PHYSICSPOSTSTEP, eventData);
+    }
+}
+
+void PhysicsWorld::BeginAsyncStep(float timeStep)
+{
+    // Send the pre-step event once for the whole step, as the handlers can not run in the step thread
+    {
+        using namespace PhysicsPreStep;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_WORLD] = this;
+        eventData[P_TIMESTEP] = timeStep;
+        SendEvent(E_PHYSICSPRESTEP, eventData);
+    }
+
+    // Kinematic bodies read their scene node transforms during the step. Read them now, as the main thread may move the nodes
+    // while the step is in progress. Also store the state of each body, so that queries do not read what the step writes
+    btTransform kinematicTransform;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        if ((*i)->IsKinematic())
+            (*i)->getWorldTransform(kinematicTransform);
+        (*i)->CacheStepState();
+    }
+
+    if (!stepThread_)
+        stepThread_ = new PhysicsStepThread(this);
+
+    asyncTimeStep_ = timeStep;
+    numAsyncSubSteps_ = 0;
+    asyncResultsPending_ = true;
+    stepThread_->timeStep_ = timeStep;
+    stepInProgress_ = true;
+
+    // If the thread can not be started, for example when threading is disabled, step immediately
+    if (!stepThread_->Run())
+    {
+        StepSimulation(timeStep);
+        stepInProgress_ = false;
+    }
+}
+
+void PhysicsWorld::WaitForAsyncStep()
+{
+    if (!stepInProgress_)
+        return;
+
+    URHO3D_PROFILE(WaitForAsyncStep);
+
+    stepThread_->Stop();
+    stepInProgress_ = false;
+
+    for (Vector<PhysicsCommand>::ConstIterator i = commands_.Begin(); i != commands_.End(); ++i)
+        ApplyCommand(*i);
+    commands_.Clear();
+}
+
+void PhysicsWorld::QueueCommand(const PhysicsCommand& command)
+{
+    if (stepInProgress_)
+        commands_.Push(command);
+    else
+        ApplyCommand(command);
+}
+
+void PhysicsWorld::ApplyCommand(const PhysicsCommand& command)
+{
+    RigidBody* body = command.body_;
+    if (!body)
+        return;
+
+    switch (command.type_)
+    {
+    case PHYSICS_APPLY_FORCE:
+        body->ApplyForce(command.vector_);
+        break;
+
+    case PHYSICS_APPLY_FORCE_AT_POSITION:
+        body->ApplyForce(command.vector_, command.position_);
+        break;
+
+    case PHYSICS_APPLY_TORQUE:
+        body->ApplyTorque(command.vector_);
+        break;
+
+    case PHYSICS_APPLY_IMPULSE:
+        body->ApplyImpulse(command.vector_);
+        break;
+
+    case PHYSICS_APPLY_IMPULSE_AT_POSITION:
+        body->ApplyImpulse(command.vector_, command.position_);
+        break;
+
+    case PHYSICS_APPLY_TORQUE_IMPULSE:
+        body->ApplyTorqueImpulse(command.vector_);
+        break;
+
+    case PHYSICS_SET_LINEAR_VELOCITY:
+        body->SetLinearVelocity(command.vector_);
+        break;
+
+    case PHYSICS_SET_ANGULAR_VELOCITY:
+        body->SetAngularVelocity(command.vector_);
+        break;
+
+    case PHYSICS_SET_POSITION:
+        body->SetPosition(command.vector_);
+        break;
+
+    case PHYSICS_SET_ROTATION:
+        body->SetRotation(command.rotation_);
+        break;
+    }
+}
+
+void PhysicsWorld::UpdateStaticBatches()
+{
+    if (pendingStaticBodies_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateStaticBatches);
+
+    PODVector<StaticCollisionBatch*> dirtyBatches;
+
+    for (HashSet<RigidBody*>::ConstIterator i = pendingStaticBodies_.Begin(); i != pendingStaticBodies_.End(); ++i)
+    {
+        RigidBody* body = *i;
+        if (!IsStaticBatchCandidate(body))
+            continue;
+
+        Vector3 cellPosition = body->GetPosition() / staticBatchCellSize_;
+        StaticBatchKey key;
+        key.cell_ = IntVector3(FloorToInt(cellPosition.x_), FloorToInt(cellPosition.y_), FloorToInt(cellPosition.z_));
+        key.collisionLayer_ = body->GetCollisionLayer();
+        key.collisionMask_ = body->GetCollisionMask();
+        key.friction_ = body->GetFriction();
+        key.rollingFriction_ = body->GetRollingFriction();
+        key.restitution_ = body->GetRestitution();
+
+        SharedPtr<StaticCollisionBatch>& batch = staticBatches_[key];
+        if (!batch)
+        {
+            batch = new StaticCollisionBatch();
+            batch->key_ = key;
+        }
+        if (!batch->dirty_)
+        {
+            batch->dirty_ = true;
+            dirtyBatches.Push(batch);
+        }
+
+        batch->bodies_.Push(body);
+        batchedBodies_[body] = batch;
+        body->SetBatched(true);
+    }
+
+    pendingStaticBodies_.Clear();
+
+    for (PODVector<StaticCollisionBatch*>::ConstIterator i = dirtyBatches.Begin(); i != dirtyBatches.End(); ++i)
+        BuildStaticBatch(*i);
+}
+
+void PhysicsWorld::BuildStaticBatch(StaticCollisionBatch* batch)
+{
+    if (!batch->object_)
+    {
+        batch->object_ = new btCollisionObject();
+        batch->object_->setUserPointer(batch);
+        batch->object_->setUserIndex(STATIC_BATCH_USER_INDEX);
+    }
+    else if (batch->object_->getBroadphaseHandle())
+        world_->removeCollisionObject(batch->object_.Get());
+
+    batch->infoMap_.Reset();
+    batch->meshShape_.Reset();
+    batch->compoundShape_ = new btCompoundShape();
+    batch->mesh_ = new btTriangleMesh();
+    batch->childBodies_.Clear();
+    batch->triangleBodies_.Clear();
+
+    PODVector<float> vertices;
+    PODVector<RigidBody*> overflowBodies;
+    const btVector3 meshAabbMin(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    const btVector3 meshAabbMax(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+
+    for (unsigned i = 0; i < batch->bodies_.Size();)
+    {
+        RigidBody* body = batch->bodies_[i];
+        btCompoundShape* bodyShape = body->GetCompoundShape();
+        btTransform bodyTransform(ToBtQuaternion(body->GetRotation()), ToBtVector3(body->GetPosition()));
+
+        // Collect the triangles first to check that they still fit into the merged mesh
+        vertices.Clear();
+        for (int j = 0; j < bodyShape->getNumChildShapes(); ++j)
+        {
+            btCollisionShape* shape = bodyShape->getChildShape(j);
+            if (!shape->isConvex())
+            {
+                StaticBatchTriangleCallback callback(vertices, bodyTransform * bodyShape->getChildTransform(j));
+                static_cast<btConcaveShape*>(shape)->processAllTriangles(&callback, meshAabbMin, meshAabbMax);
+            }
+        }
+
+        unsigned numTriangles = vertices.Size() / 9;
+        if (batch->triangleBodies_.Size() + numTriangles > MAX_STATIC_BATCH_TRIANGLES)
+        {
+            overflowBodies.Push(body);
+            batchedBodies_.Erase(body);
+            batch->bodies_.Erase(i);
+            continue;
+        }
+
+        for (unsigned j = 0; j < vertices.Size(); j += 9)
+        {
+            const float* v = &vertices[j];
+            batch->mesh_->addTriangle(btVector3(v[0], v[1], v[2]), btVector3(v[3], v[4], v[5]), btVector3(v[6], v[7], v[8]));
+            batch->triangleBodies_.Push(i);
+        }
+
+        // The convex shapes are shared with the rigid body
+        for (int j = 0; j < bodyShape->getNumChildShapes(); ++j)
+        {
+            btCollisionShape* shape = bodyShape->getChildShape(j);
+            if (shape->isConvex())
+            {
+                batch->compoundShape_->addChildShape(bodyTransform * bodyShape->getChildTransform(j), shape);
+                batch->childBodies_.Push(i);
+            }
+        }
+
+        ++i;
+    }
+
+    // The bodies that did not fit stay in the Bullet world on their own
+    if (!overflowBodies.Empty())
+    {
+        URHO3D_LOGWARNING("Static batch triangle limit reached, leaving " + String(overflowBodies.Size()) + " rigid bodies unbatched");
+        for (PODVector<RigidBody*>::ConstIterator i = overflowBodies.Begin(); i != overflowBodies.End(); ++i)
+            (*i)->SetBatched(false);
+    }
+
+    batch->dirty_ = false;
+
+    if (batch->bodies_.Empty())
+    {
+        staticBatches_.Erase(batch->key_);
+        return;
+    }
+
+    btCollisionShape* shape = batch->compoundShape_.Get();
+    if (batch->mesh_->getNumTriangles())
+    {
+        batch->meshShape_ = new btBvhTriangleMeshShape(batch->mesh_.Get(), true, true);
+        // The mesh child is added last, so that the child indices of the other shapes match the child body indices
+        if (batch->compoundShape_->getNumChildShapes())
+            batch->compoundShape_->addChildShape(btTransform::getIdentity(), batch->meshShape_.Get());
+        else
+        {
+            // Use the mesh directly when there are no other shapes, which also allows adjusting the internal edges
+            shape = batch->meshShape_.Get();
+            if (internalEdge_)
+            {
+                batch->infoMap_ = new btTriangleInfoMap();
+                btGenerateInternalEdgeInfo(batch->meshShape_.Get(), batch->infoMap_.Get());
+            }
+        }
+    }
+    else
+        batch->mesh_.Reset();
+
+    btCollisionObject* object = batch->object_.Get();
+    object->setCollisionShape(shape);
+    object->setFriction(batch->key_.friction_);
+    object->setRollingFriction(batch->key_.rollingFriction_);
+    object->setRestitution(batch->key_.restitution_);
+    int flags = object->getCollisionFlags() | btCollisionObject::CF_STATIC_OBJECT;
+    if (batch->infoMap_)
+        flags |= btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK;
+    else
+        flags &= ~btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK;
+    object->setCollisionFlags(flags);
+    world_->addCollisionObject(object, (short)batch->key_.collisionLayer_, (short)batch->key_.collisionMask_);
+}
+
+void PhysicsWorld::DissolveStaticBatch(StaticCollisionBatch* batch)
+{
+    // Keep the batch alive until its bodies have been returned
+    SharedPtr<StaticCollisionBatch> batchHolder(batch);
+
+    if (batch->object_ && batch->object_->getBroadphaseHandle())
+        world_->removeCollisionObject(batch->object_.Get());
+    staticBatches_.Erase(batch->key_);
+
+    for (PODVector<RigidBody*>::ConstIterator i = batch->bodies_.Begin(); i != batch->bodies_.End(); ++i)
+    {
+        RigidBody* body = *i;
+        batchedBodies_.Erase(body);
+        body->SetBatched(false);
+        if (staticBatching_)
+            pendingStaticBodies_.Insert(body);
+    }
+}
+
+void PhysicsWorld::ClearStaticBatches()
+{
+    while (!staticBatches_.Empty())
+        DissolveStaticBatch(staticBatches_.Begin()->second_);
+}
+
+void PhysicsWorld::UpdateCollisions()
+{
+    WaitForAsyncStep();
+    world_->performDiscreteCollisionDetection();
+}
+
+void PhysicsWorld::SetFps(int fps)
+{
+    WaitForAsyncStep();
+    fps_ = (unsigned)Clamp(fps, 1, 1000);
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetGravity(const Vector3& gravity)
+{
+    WaitForAsyncStep();
+    world_->setGravity(ToBtVector3(gravity));
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetMaxSubSteps(int num)
+{
+    WaitForAsyncStep();
+    maxSubSteps_ = num;
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetNumIterations(int num)
+{
+    WaitForAsyncStep();
+    num = Clamp(num, 1, MAX_SOLVER_ITERATIONS);
+    world_->getSolverInfo().m_numIterations = num;
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetUpdateEnabled(bool enable)
+{
+    updateEnabled_ = enable;
+}
+
+void PhysicsWorld::SetInterpolation(bool enable)
+{
+    WaitForAsyncStep();
+    interpolation_ = enable;
+}
+
+void PhysicsWorld::SetInternalEdge(bool enable)
+{
+    internalEdge_ = enable;
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetSplitImpulse(bool enable)
+{
+    WaitForAsyncStep();
+    world_->getSolverInfo().m_splitImpulse = enable;
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetContactStream(bool enable)
+{
+    contactStream_ = enable;
+    if (!enable)
+    {
+        contacts_.Clear();
+        contactPoints_.Clear();
+    }
+}
+
+void PhysicsWorld::SetGeometryCacheDir(const String& path)
 {
-    world_->performDiscreteCollisionDetection();
+    String trimmedPath = path.Trimmed();
+    geometryCacheDir_ = trimmedPath.Length() ? AddTrailingSlash(trimmedPath) : String::EMPTY;
 }
 
-void PhysicsWorld::SetFps(int fps)
+void PhysicsWorld::SetSyncPositionThreshold(float threshold)
 {
-    fps_ = (unsigned)Clamp(fps, 1, 1000);
+    syncPositionThreshold_ = Max(threshold, 0.0f);
+    MarkNetworkUpdate();
+}
 
+void PhysicsWorld::SetSyncRotationThreshold(float threshold)
+{
+    syncRotationThreshold_ = Clamp(threshold, 0.0f, 180.0f);
     MarkNetworkUpdate();
 }
 
-void PhysicsWorld::SetGravity(const Vector3& gravity)
+void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
 {
-    world_->setGravity(ToBtVector3(gravity));
+    maxNetworkAngularVelocity_ = Clamp(velocity, 1.0f, 32767.0f);
 
     MarkNetworkUpdate();
 }
 
-void PhysicsWorld::SetMaxSubSteps(int num)
+void PhysicsWorld::SetAsyncUpdate(bool enable)
 {
-    maxSubSteps_ = num;
-    MarkNetworkUpdate();
+    if (!enable)
+        WaitForAsyncStep();
+    asyncUpdate_ = enable;
 }
 
-void PhysicsWorld::SetNumIterations(int num)
+void PhysicsWorld::SetTransformHistoryLength(unsigned steps)
 {
-    num = Clamp(num, 1, MAX_SOLVER_ITERATIONS);
-    world_->getSolverInfo().m_numIterations = num;
+    WaitForAsyncStep();
+    if (steps == transformHistoryLength_)
+        return;
 
-    MarkNetworkUpdate();
+    EndRewind();
+    transformHistoryLength_ = steps;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+        (*i)->ClearTransformHistory();
 }
 
-void PhysicsWorld::SetUpdateEnabled(bool enable)
+void PhysicsWorld::SetStaticBatching(bool enable)
 {
-    updateEnabled_ = enable;
+    if (enable == staticBatching_)
+        return;
+
+    WaitForAsyncStep();
+    staticBatching_ = enable;
+
+    if (enable)
+    {
+        for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+            pendingStaticBodies_.Insert(*i);
+    }
+    else
+    {
+        ClearStaticBatches();
+        pendingStaticBodies_.Clear();
+    }
 }
 
-void PhysicsWorld::SetInterpolation(bool enable)
+void PhysicsWorld::SetStaticBatchCellSize(float size)
 {
-    interpolation_ = enable;
+    size = Max(size, M_EPSILON);
+    if (size == staticBatchCellSize_)
+        return;
+
+    WaitForAsyncStep();
+    staticBatchCellSize_ = size;
+    // The dissolved bodies are merged into the new cells on the next simulation update
+    ClearStaticBatches();
 }
 
-void PhysicsWorld::SetInternalEdge(bool enable)
+void PhysicsWorld::RebuildStaticBatches()
 {
-    internalEdge_ = enable;
+    if (!staticBatching_)
+        return;
 
-    MarkNetworkUpdate();
+    WaitForAsyncStep();
+    ClearStaticBatches();
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+        pendingStaticBodies_.Insert(*i);
+    UpdateStaticBatches();
 }
 
-void PhysicsWorld::SetSplitImpulse(bool enable)
+bool PhysicsWorld::BeginRewind(unsigned step)
 {
-    world_->getSolverInfo().m_splitImpulse = enable;
+    WaitForAsyncStep();
+    EndRewind();
 
-    MarkNetworkUpdate();
+    // Steps in the future or older than the history can not be rewound to
+    unsigned stepsAgo = historyStep_ - step;
+    if (stepsAgo && stepsAgo >= transformHistoryLength_)
+        return false;
+
+    rewinding_ = true;
+    if (!stepsAgo)
+        return true;
+
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        if ((*i)->Rewind(step))
+            rewoundBodies_.Push(*i);
+    }
+
+    return true;
 }
 
-void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
+void PhysicsWorld::EndRewind()
 {
-    maxNetworkAngularVelocity_ = Clamp(velocity, 1.0f, 32767.0f);
+    for (PODVector<RigidBody*>::ConstIterator i = rewoundBodies_.Begin(); i != rewoundBodies_.End(); ++i)
+        (*i)->EndRewind();
 
-    MarkNetworkUpdate();
+    rewoundBodies_.Clear();
+    rewinding_ = false;
+}
+
+unsigned PhysicsWorld::GetHistoryStepAt(float secondsAgo) const
+{
+    if (!transformHistoryLength_)
+        return historyStep_;
+
+    auto stepsAgo = (unsigned)Clamp(RoundToInt(secondsAgo * fps_), 0, (int)transformHistoryLength_ - 1);
+    return historyStep_ - stepsAgo;
 }
 
 void PhysicsWorld::Raycast(PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask)
 {
     URHO3D_PROFILE(PhysicsRaycast);
 
+    WaitForAsyncStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::AllHitsRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    AllHitsRayCallback rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
     rayCallback.m_collisionFilterGroup = (short)0xffff;
     rayCallback.m_collisionFilterMask = (short)collisionMask;
 
@@ -386,7 +1471,7 @@ void PhysicsWorld::Raycast(PODVector<PhysicsRaycastResult>& result, const Ray& r
     for (int i = 0; i < rayCallback.m_collisionObjects.size(); ++i)
     {
         PhysicsRaycastResult newResult;
-        newResult.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObjects[i]->getUserPointer());
+        newResult.body_ = rayCallback.GetBody((unsigned)i);
         newResult.position_ = ToVector3(rayCallback.m_hitPointWorld[i]);
         newResult.normal_ = ToVector3(rayCallback.m_hitNormalWorld[i]);
         newResult.distance_ = (newResult.position_ - ray.origin_).Length();
@@ -401,38 +1486,20 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
 {
     URHO3D_PROFILE(PhysicsRaycastSingle);
 
+    WaitForAsyncStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
-
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
-    {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+    RaycastClosest(world_.Get(), result, ray, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
 {
     URHO3D_PROFILE(PhysicsRaycastSingleSegmented);
 
+    WaitForAsyncStep();
+
     assert(overlapDistance < segmentDistance);
 
     if (maxDistance >= M_INFINITY)
@@ -451,7 +1518,7 @@ void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ra
         const float distance = Min(remainingDistance, segmentDistance); // The last segment may be shorter
         const btVector3 end = start + distance * direction;
 
-        btCollisionWorld::ClosestRayResultCallback rayCallback(start, end);
+        ClosestRayCallback rayCallback(start, end);
         rayCallback.m_collisionFilterGroup = (short)0xffff;
         rayCallback.m_collisionFilterMask = (short)collisionMask;
 
@@ -463,7 +1530,7 @@ void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ra
             result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
             result.distance_ = (result.position_ - ray.origin_).Length();
             result.hitFraction_ = rayCallback.m_closestHitFraction;
-            result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+            result.body_ = rayCallback.GetBody();
             // No need to cast the rest of the segments
             return;
         }
@@ -485,41 +1552,21 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
 {
     URHO3D_PROFILE(PhysicsSphereCast);
 
+    WaitForAsyncStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
     btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
-
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
-    {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+    ConvexCastClosest(world_.Get(), result, &shape, ray.origin_, Quaternion::IDENTITY, ray.origin_ + maxDistance * ray.direction_,
+        Quaternion::IDENTITY, collisionMask);
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
     const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
 {
+    WaitForAsyncStep();
+
     if (!shape || !shape->GetCollisionShape())
     {
         URHO3D_LOGERROR("Null collision shape for convex cast");
@@ -585,30 +1632,43 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
 
     URHO3D_PROFILE(PhysicsConvexCast);
 
-    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    WaitForAsyncStep();
 
-    world_->convexSweepTest(static_cast<btConvexShape*>(shape), btTransform(ToBtQuaternion(startRot),
-            convexCallback.m_convexFromWorld), btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld),
-        convexCallback);
+    ConvexCastClosest(world_.Get(), result, static_cast<btConvexShape*>(shape), startPos, startRot, endPos, endRot, collisionMask);
+}
 
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
-    {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+void PhysicsWorld::RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsRaycastQuery>& queries)
+{
+    URHO3D_PROFILE(PhysicsRaycastSingleBatch);
+
+    WaitForAsyncStep();
+
+    results.Resize(queries.Size());
+    if (queries.Empty())
+        return;
+
+    BatchQueryData data;
+    data.world_ = world_.Get();
+    data.queries_ = queries.Buffer();
+    data.results_ = results.Buffer();
+    RunBatchQuery(RaycastBatchWork, &data, queries.Size(), GetSubsystem<WorkQueue>());
+}
+
+void PhysicsWorld::ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsConvexCastQuery>& queries)
+{
+    URHO3D_PROFILE(PhysicsConvexCastBatch);
+
+    WaitForAsyncStep();
+
+    results.Resize(queries.Size());
+    if (queries.Empty())
+        return;
+
+    BatchQueryData data;
+    data.world_ = world_.Get();
+    data.queries_ = queries.Buffer();
+    data.results_ = results.Buffer();
+    RunBatchQuery(ConvexCastBatchWork, &data, queries.Size(), GetSubsystem<WorkQueue>());
 }
 
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
@@ -622,6 +1682,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const Sphere& s
 {
     URHO3D_PROFILE(PhysicsSphereQuery);
 
+    WaitForAsyncStep();
+
     result.Clear();
 
     btSphereShape sphereShape(sphere.radius_);
@@ -641,6 +1703,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const BoundingB
 {
     URHO3D_PROFILE(PhysicsBoxQuery);
 
+    WaitForAsyncStep();
+
     result.Clear();
 
     btBoxShape boxShape(ToBtVector3(box.HalfSize()));
@@ -659,6 +1723,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const RigidBody
 {
     URHO3D_PROFILE(PhysicsBodyQuery);
 
+    WaitForAsyncStep();
+
     result.Clear();
 
     if (!body || !body->GetBody())
@@ -700,6 +1766,20 @@ void PhysicsWorld::GetCollidingBodies(PODVector<RigidBody*>& result, const Rigid
     }
 }
 
+void PhysicsWorld::GetContacts(PODVector<const PhysicsContact*>& result, unsigned collisionLayerMask) const
+{
+    result.Clear();
+
+    for (Vector<PhysicsContact>::ConstIterator i = contacts_.Begin(); i != contacts_.End(); ++i)
+    {
+        RigidBody* bodyA = i->bodyA_;
+        RigidBody* bodyB = i->bodyB_;
+        if ((bodyA && (bodyA->GetCollisionLayer() & collisionLayerMask)) ||
+            (bodyB && (bodyB->GetCollisionLayer() & collisionLayerMask)))
+            result.Push(&(*i));
+    }
+}
+
 Vector3 PhysicsWorld::GetGravity() const
 {
     return ToVector3(world_->getGravity());
@@ -723,8 +1803,38 @@ void PhysicsWorld::AddRigidBody(RigidBody* body)
 void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 {
     rigidBodies_.Remove(body);
-    // Remove possible dangling pointer from the delayedWorldTransforms structure
+    if (rewoundBodies_.Remove(body))
+        body->EndRewind();
+    // Remove possible dangling pointers from the pending and delayed world transform structures
+    pendingWorldTransforms_.Remove(body);
     delayedWorldTransforms_.Erase(body);
+    pendingStaticBodies_.Erase(body);
+}
+
+void PhysicsWorld::AddStaticBatchCandidate(RigidBody* body)
+{
+    if (staticBatching_)
+        pendingStaticBodies_.Insert(body);
+}
+
+void PhysicsWorld::RemoveFromStaticBatch(RigidBody* body)
+{
+    WaitForAsyncStep();
+
+    HashMap<RigidBody*, StaticCollisionBatch*>::Iterator i = batchedBodies_.Find(body);
+    if (i != batchedBodies_.End())
+        DissolveStaticBatch(i->second_);
+    else
+        body->SetBatched(false);
+}
+
+RigidBody* PhysicsWorld::GetRigidBody(const btCollisionObject* object, int shapePart, int index)
+{
+    if (!object)
+        return nullptr;
+    if (object->getUserIndex() != STATIC_BATCH_USER_INDEX)
+        return static_cast<RigidBody*>(object->getUserPointer());
+    return static_cast<StaticCollisionBatch*>(object->getUserPointer())->GetBody(shapePart, index);
 }
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
@@ -747,6 +1857,11 @@ void PhysicsWorld::RemoveConstraint(Constraint* constraint)
     constraints_.Remove(constraint);
 }
 
+void PhysicsWorld::AddPendingWorldTransform(RigidBody* body)
+{
+    pendingWorldTransforms_.Push(body);
+}
+
 void PhysicsWorld::AddDelayedWorldTransform(const DelayedWorldTransform& transform)
 {
     delayedWorldTransforms_[transform.rigidBody_] = transform;
@@ -785,7 +1900,10 @@ void PhysicsWorld::OnSceneSet(Scene* scene)
         SubscribeToEvent(scene_, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(PhysicsWorld, HandleSceneSubsystemUpdate));
     }
     else
+    {
+        WaitForAsyncStep();
         UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    }
 }
 
 void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
@@ -799,6 +1917,10 @@ void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap&
 
 void PhysicsWorld::PreStep(float timeStep)
 {
+    // Events and profiling are not possible in the step thread
+    if (stepInProgress_)
+        return;
+
     // Send pre-step event
     using namespace PhysicsPreStep;
 
@@ -817,6 +1939,16 @@ void PhysicsWorld::PreStep(float timeStep)
 
 void PhysicsWorld::PostStep(float timeStep)
 {
+    UpdateStepStats();
+
+    // In the step thread only record the history, the events are sent when the step is completed
+    if (stepInProgress_)
+    {
+        ++numAsyncSubSteps_;
+        RecordTransformHistory();
+        return;
+    }
+
 #ifdef URHO3D_PROFILING
     auto* profiler = GetSubsystem<Profiler>();
     if (profiler)
@@ -824,6 +1956,7 @@ void PhysicsWorld::PostStep(float timeStep)
 #endif
 
     SendCollisionEvents();
+    RecordTransformHistory();
 
     // Send post-step event
     using namespace PhysicsPostStep;
@@ -834,15 +1967,124 @@ void PhysicsWorld::PostStep(float timeStep)
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
+void PhysicsWorld::RecordTransformHistory()
+{
+    // Record rigid body transforms for lag-compensated queries
+    ++historyStep_;
+    if (transformHistoryLength_)
+    {
+        for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+            (*i)->RecordTransformHistory(historyStep_, transformHistoryLength_);
+    }
+}
+
+void PhysicsWorld::UpdateStepStats()
+{
+    stepStats_.numActiveBodies_ = 0;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        btRigidBody* body = (*i)->GetBody();
+        if (body && !body->isStaticOrKinematicObject() && body->isActive())
+            ++stepStats_.numActiveBodies_;
+    }
+
+    stepStats_.numOverlappingPairs_ = (unsigned)broadphase_->getOverlappingPairCache()->getNumOverlappingPairs();
+
+    int numManifolds = collisionDispatcher_->getNumManifolds();
+    stepStats_.numManifolds_ = (unsigned)numManifolds;
+    stepStats_.numTouchingManifolds_ = 0;
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        if (collisionDispatcher_->getManifoldByIndexInternal(i)->getNumContacts())
+            ++stepStats_.numTouchingManifolds_;
+    }
+
+    // Bullet counts the clamped motions globally, so with several worlds stepping at the same time the hits may be attributed
+    // to the wrong world
+    int ccdHits = gNumClampedCcdMotions;
+    stepStats_.numCcdHits_ = (unsigned)Max(ccdHits - lastCcdHits_, 0);
+    lastCcdHits_ = ccdHits;
+
+    // The counters are lock-free, so they can be published also from the step thread
+    if (activeBodiesCounter_)
+    {
+        activeBodiesCounter_->Set(stepStats_.numActiveBodies_);
+        overlappingPairsCounter_->Set(stepStats_.numOverlappingPairs_);
+        ccdHitsCounter_->Add(stepStats_.numCcdHits_);
+    }
+}
+
+void PhysicsWorld::DrawIslands(DebugRenderer* debug, bool depthTest)
+{
+    struct IslandInfo
+    {
+        BoundingBox box_;
+        unsigned numBodies_{};
+        unsigned numContacts_{};
+        bool active_{};
+    };
+
+    // Bullet tags the dynamic bodies with their island on each step. Static bodies have no island
+    HashMap<int, IslandInfo> islands;
+    btVector3 aabbMin, aabbMax;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        btRigidBody* body = (*i)->GetBody();
+        if (!body || body->isStaticOrKinematicObject() || body->getIslandTag() < 0)
+            continue;
+
+        IslandInfo& island = islands[body->getIslandTag()];
+        body->getAabb(aabbMin, aabbMax);
+        island.box_.Merge(BoundingBox(ToVector3(aabbMin), ToVector3(aabbMax)));
+        ++island.numBodies_;
+        island.active_ |= body->isActive();
+    }
+
+    int numManifolds = collisionDispatcher_->getNumManifolds();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* manifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+        int tag = manifold->getBody0()->getIslandTag();
+        if (tag < 0)
+            tag = manifold->getBody1()->getIslandTag();
+
+        HashMap<int, IslandInfo>::Iterator island = islands.Find(tag);
+        if (island != islands.End())
+            island->second_.numContacts_ += manifold->getNumContacts();
+    }
+
+    // The solver cost of an island grows with its contacts, so the island with the most contacts is drawn red
+    unsigned maxContacts = 1;
+    for (HashMap<int, IslandInfo>::ConstIterator i = islands.Begin(); i != islands.End(); ++i)
+    {
+        if (i->second_.active_)
+            maxContacts = Max(maxContacts, i->second_.numContacts_);
+    }
+
+    for (HashMap<int, IslandInfo>::ConstIterator i = islands.Begin(); i != islands.End(); ++i)
+    {
+        const IslandInfo& island = i->second_;
+        if (!island.active_)
+            continue;
+
+        float heat = (float)island.numContacts_ / maxContacts;
+        debug->AddBoundingBox(island.box_, Color(heat, 1.0f - heat, 0.0f), depthTest);
+    }
+}
+
 void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE(SendCollisionEvents);
 
+    // Keep the previous collisions to check if a collision is new. Swapping reuses the hash map nodes
+    previousCollisions_.Swap(currentCollisions_);
     currentCollisions_.Clear();
     physicsCollisionData_.Clear();
     nodeCollisionData_.Clear();
 
     int numManifolds = collisionDispatcher_->getNumManifolds();
+    if (pairsCounter_)
+        pairsCounter_->Add(numManifolds);
 
     if (numManifolds)
     {
@@ -858,8 +2100,10 @@ void PhysicsWorld::SendCollisionEvents()
             const btCollisionObject* objectA = contactManifold->getBody0();
             const btCollisionObject* objectB = contactManifold->getBody1();
 
-            auto* bodyA = static_cast<RigidBody*>(objectA->getUserPointer());
-            auto* bodyB = static_cast<RigidBody*>(objectB->getUserPointer());
+            // A static batch is resolved to the rigid body of the first contact point
+            const btManifoldPoint& firstPoint = contactManifold->getContactPoint(0);
+            RigidBody* bodyA = GetRigidBody(objectA, firstPoint.m_partId0, firstPoint.m_index0);
+            RigidBody* bodyB = GetRigidBody(objectB, firstPoint.m_partId1, firstPoint.m_index1);
             // If it's not a rigidbody, maybe a ghost object
             if (!bodyA || !bodyB)
                 continue;
@@ -891,134 +2135,130 @@ void PhysicsWorld::SendCollisionEvents()
             }
         }
 
-        for (HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair>::Iterator i = currentCollisions_.Begin();
-             i != currentCollisions_.End(); ++i)
+        // Record the contact stream before any event handler gets to modify the world
+        if (contactStream_)
         {
-            RigidBody* bodyA = i->first_.first_;
-            RigidBody* bodyB = i->first_.second_;
-            if (!bodyA || !bodyB)
-                continue;
+            for (HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair>::ConstIterator i = currentCollisions_.Begin();
+                 i != currentCollisions_.End(); ++i)
+            {
+                RigidBody* bodyA = i->first_.first_;
+                RigidBody* bodyB = i->first_.second_;
 
-            Node* nodeA = bodyA->GetNode();
-            Node* nodeB = bodyB->GetNode();
-            WeakPtr<Node> nodeWeakA(nodeA);
-            WeakPtr<Node> nodeWeakB(nodeB);
+                contacts_.Resize(contacts_.Size() + 1);
+                PhysicsContact& contact = contacts_.Back();
+                contact.bodyA_ = i->first_.first_;
+                contact.bodyB_ = i->first_.second_;
+                contact.firstPoint_ = contactPoints_.Size();
+                contact.trigger_ = bodyA->IsTrigger() || bodyB->IsTrigger();
+                contact.newCollision_ = !previousCollisions_.Contains(i->first_);
+                WriteContactPoints(contactPoints_, i->second_, false);
+                contact.numPoints_ = contactPoints_.Size() - contact.firstPoint_;
+            }
+        }
 
-            bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
-            bool newCollision = !previousCollisions_.Contains(i->first_);
+        if (collisionEvents_)
+        {
+            for (HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair>::Iterator i = currentCollisions_.Begin();
+                 i != currentCollisions_.End(); ++i)
+            {
+                RigidBody* bodyA = i->first_.first_;
+                RigidBody* bodyB = i->first_.second_;
+                if (!bodyA || !bodyB)
+                    continue;
 
-            physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
-            physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
-            physicsCollisionData_[PhysicsCollision::P_BODYA] = bodyA;
-            physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
-            physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
+                Node* nodeA = bodyA->GetNode();
+                Node* nodeB = bodyB->GetNode();
+                WeakPtr<Node> nodeWeakA(nodeA);
+                WeakPtr<Node> nodeWeakB(nodeB);
 
-            contacts_.Clear();
+                bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
+                bool newCollision = !previousCollisions_.Contains(i->first_);
+
+                // Skip building the event data entirely if nobody listens to the pair
+                bool worldListens = HasEventReceivers(E_PHYSICSCOLLISION) ||
+                    (newCollision && HasEventReceivers(E_PHYSICSCOLLISIONSTART));
+                bool nodeAListens = nodeA->HasEventReceivers(E_NODECOLLISION) ||
+                    (newCollision && nodeA->HasEventReceivers(E_NODECOLLISIONSTART));
+                if (!worldListens && !nodeAListens && !nodeB->HasEventReceivers(E_NODECOLLISION) &&
+                    !(newCollision && nodeB->HasEventReceivers(E_NODECOLLISIONSTART)))
+                    continue;
 
-            // "Pointers not flipped"-manifold, send unmodified normals
-            btPersistentManifold* contactManifold = i->second_.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            // "Pointers flipped"-manifold, flip normals also
-            contactManifold = i->second_.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+                if (worldListens || nodeAListens)
                 {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
+                    WriteContactBuffer(contactBuffer_, i->second_, false);
+
+                    if (worldListens)
+                    {
+                        physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
+                        physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
+                        physicsCollisionData_[PhysicsCollision::P_BODYA] = bodyA;
+                        physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
+                        physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
+                        physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contactBuffer_.GetBuffer();
+
+                        // Send separate collision start event if collision is new
+                        if (newCollision)
+                        {
+                            SendEvent(E_PHYSICSCOLLISIONSTART, physicsCollisionData_);
+                            // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
+                            if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                                continue;
+                        }
+
+                        // Then send the ongoing collision event
+                        SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
+                        if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                            continue;
+                    }
+
+                    if (nodeAListens)
+                    {
+                        nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
+                        nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
+                        nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
+                        nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
+                        nodeCollisionData_[NodeCollision::P_CONTACTS] = contactBuffer_.GetBuffer();
+
+                        if (newCollision)
+                        {
+                            nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                            if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                                continue;
+                        }
+
+                        nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+                        if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                            continue;
+                    }
                 }
-            }
-
-            physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contacts_.GetBuffer();
 
-            // Send separate collision start event if collision is new
-            if (newCollision)
-            {
-                SendEvent(E_PHYSICSCOLLISIONSTART, physicsCollisionData_);
-                // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
-                if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                // Skip flipping the contacts if body B's node does not listen to the collision
+                if (!nodeB->HasEventReceivers(E_NODECOLLISION) && !(newCollision && nodeB->HasEventReceivers(E_NODECOLLISIONSTART)))
                     continue;
-            }
 
-            // Then send the ongoing collision event
-            SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
-                continue;
-
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
-            if (newCollision)
-            {
-                nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
-                    continue;
-            }
+                // Flip perspective to body B
+                WriteContactBuffer(contactBuffer_, i->second_, true);
 
-            nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
-                continue;
+                nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
+                nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
+                nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
+                nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
+                nodeCollisionData_[NodeCollision::P_CONTACTS] = contactBuffer_.GetBuffer();
 
-            // Flip perspective to body B
-            contacts_.Clear();
-            contactManifold = i->second_.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            contactManifold = i->second_.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+                if (newCollision)
                 {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
+                    nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                    if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
+                        continue;
                 }
-            }
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
-            if (newCollision)
-            {
-                nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
-                    continue;
+                nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
             }
-
-            nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
         }
     }
 
     // Send collision end events as applicable
+    if (collisionEvents_)
     {
         physicsCollisionData_[PhysicsCollisionEnd::P_WORLD] = this;
 
@@ -1076,8 +2316,6 @@ void PhysicsWorld::SendCollisionEvents()
             }
         }
     }
-
-    previousCollisions_ = currentCollisions_;
 }
 
 void RegisterPhysicsLibrary(Context* context)
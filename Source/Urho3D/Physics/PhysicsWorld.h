@@ -25,20 +25,27 @@
 #include "../Container/HashSet.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
 
 #include <Bullet/LinearMath/btIDebugDraw.h>
 
+class btBvhTriangleMeshShape;
 class btCollisionConfiguration;
+class btCollisionObject;
 class btCollisionShape;
+class btCompoundShape;
 class btBroadphaseInterface;
 class btConstraintSolver;
 class btDiscreteDynamicsWorld;
 class btDispatcher;
 class btDynamicsWorld;
 class btPersistentManifold;
+class btTriangleMesh;
+
+struct btTriangleInfoMap;
 
 namespace Urho3D
 {
@@ -48,7 +55,8 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
+class PerfCounter;
+class PhysicsStepThread;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -77,6 +85,96 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Ray or sphere sweep for a batched physics query.
+struct URHO3D_API PhysicsRaycastQuery
+{
+    /// Ray, or the sweep start position and direction.
+    Ray ray_;
+    /// Maximum distance.
+    float maxDistance_{};
+    /// Sphere radius. 0 for a raycast.
+    float radius_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Convex shape sweep for a batched physics query.
+struct URHO3D_API PhysicsConvexCastQuery
+{
+    /// Bullet convex collision shape.
+    btCollisionShape* shape_{};
+    /// Start position.
+    Vector3 startPos_;
+    /// Start rotation.
+    Quaternion startRot_;
+    /// End position.
+    Vector3 endPos_;
+    /// End rotation.
+    Quaternion endRot_;
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Contact point in the physics contact stream.
+struct URHO3D_API PhysicsContactPoint
+{
+    /// Worldspace position.
+    Vector3 position_;
+    /// Worldspace normal, pointing from body B towards body A.
+    Vector3 normal_;
+    /// Penetration distance.
+    float distance_{};
+    /// Applied impulse.
+    float impulse_{};
+};
+
+/// Colliding rigid body pair in the physics contact stream.
+struct URHO3D_API PhysicsContact
+{
+    /// First rigid body.
+    WeakPtr<RigidBody> bodyA_;
+    /// Second rigid body.
+    WeakPtr<RigidBody> bodyB_;
+    /// Index of the first contact point in the contact point array.
+    unsigned firstPoint_{};
+    /// Number of contact points.
+    unsigned numPoints_{};
+    /// Trigger flag. True if either body is a trigger.
+    bool trigger_{};
+    /// Whether the pair was not colliding on the previous simulation step.
+    bool newCollision_{};
+};
+
+/// Rigid body command type for the asynchronous simulation command buffer.
+enum PhysicsCommandType
+{
+    PHYSICS_APPLY_FORCE = 0,
+    PHYSICS_APPLY_FORCE_AT_POSITION,
+    PHYSICS_APPLY_TORQUE,
+    PHYSICS_APPLY_IMPULSE,
+    PHYSICS_APPLY_IMPULSE_AT_POSITION,
+    PHYSICS_APPLY_TORQUE_IMPULSE,
+    PHYSICS_SET_LINEAR_VELOCITY,
+    PHYSICS_SET_ANGULAR_VELOCITY,
+    PHYSICS_SET_POSITION,
+    PHYSICS_SET_ROTATION
+};
+
+/// Rigid body command submitted while an asynchronous simulation step is in progress. Applied in submission order once the step has completed.
+struct URHO3D_API PhysicsCommand
+{
+    /// Rigid body.
+    WeakPtr<RigidBody> body_;
+    /// Command type.
+    PhysicsCommandType type_{PHYSICS_APPLY_FORCE};
+    /// Force, torque, impulse, velocity or position.
+    Vector3 vector_;
+    /// Force or impulse application position relative to the scene node, in world space.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -106,20 +204,97 @@ struct ManifoldPair
     btPersistentManifold* flippedManifold_;
 };
 
+/// Statistics of the latest physics simulation substep.
+struct PhysicsStepStats
+{
+    /// Dynamic rigid bodies that were awake.
+    unsigned numActiveBodies_{};
+    /// Overlapping pairs in the broadphase.
+    unsigned numOverlappingPairs_{};
+    /// Contact manifolds, including those of bodies that are close but not touching.
+    unsigned numManifolds_{};
+    /// Contact manifolds with at least one contact point.
+    unsigned numTouchingManifolds_{};
+    /// Continuous collision detection hits that clamped the motion of a body.
+    unsigned numCcdHits_{};
+};
+
+/// Spatial cell and shared properties of the static rigid bodies merged into one static collision batch.
+struct StaticBatchKey
+{
+    /// Test for equality with another key.
+    bool operator ==(const StaticBatchKey& rhs) const
+    {
+        return cell_ == rhs.cell_ && collisionLayer_ == rhs.collisionLayer_ && collisionMask_ == rhs.collisionMask_ &&
+            friction_ == rhs.friction_ && rollingFriction_ == rhs.rollingFriction_ && restitution_ == rhs.restitution_;
+    }
+
+    /// Return hash value for HashSet & HashMap.
+    unsigned ToHash() const { return (cell_.ToHash() * 31 + collisionLayer_) * 31 + collisionMask_; }
+
+    /// Cell coordinates.
+    IntVector3 cell_;
+    /// Collision layer.
+    unsigned collisionLayer_{};
+    /// Collision mask.
+    unsigned collisionMask_{};
+    /// Friction coefficient.
+    float friction_{};
+    /// Rolling friction coefficient.
+    float rollingFriction_{};
+    /// Restitution coefficient.
+    float restitution_{};
+};
+
+/// Static rigid bodies merged into one Bullet collision object. Triangle meshes are copied into one merged mesh, and the other shapes become children of a compound shape. Per-triangle and per-child indices map back to the rigid bodies.
+struct StaticCollisionBatch : public RefCounted
+{
+    /// Destruct.
+    ~StaticCollisionBatch() override;
+
+    /// Return the rigid body of a merged mesh triangle when the shape part is non-negative, or of a compound child shape otherwise. Return null if out of range.
+    RigidBody* GetBody(int shapePart, int index) const;
+
+    /// Key.
+    StaticBatchKey key_;
+    /// Merged rigid bodies.
+    PODVector<RigidBody*> bodies_;
+    /// Rigid body indices of the compound child shapes.
+    PODVector<unsigned> childBodies_;
+    /// Rigid body indices of the merged mesh triangles.
+    PODVector<unsigned> triangleBodies_;
+    /// Bullet collision object.
+    UniquePtr<btCollisionObject> object_;
+    /// Compound shape. Null if the batch only has triangle meshes.
+    UniquePtr<btCompoundShape> compoundShape_;
+    /// Merged triangle mesh.
+    UniquePtr<btTriangleMesh> mesh_;
+    /// Merged triangle mesh shape.
+    UniquePtr<btBvhTriangleMeshShape> meshShape_;
+    /// Internal edge information of the merged triangle mesh.
+    UniquePtr<btTriangleInfoMap> infoMap_;
+    /// Waiting to be rebuilt flag.
+    bool dirty_{};
+};
+
 /// Custom overrides of physics internals. To use overrides, must be set before the physics component is created.
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multiThreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Solve independent simulation islands in the work queue threads, using btDiscreteDynamicsWorldMt. Has no effect without worker threads. Default false.
+    bool multiThreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
 static const float DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY = 100.0f;
+static const float DEFAULT_STATIC_BATCH_CELL_SIZE = 64.0f;
 
 /// Cache of collision geometry data.
 using CollisionGeometryDataCache = HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >;
@@ -131,6 +306,7 @@ class URHO3D_API PhysicsWorld : public Component, public btIDebugDraw
 
     friend void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep);
     friend void InternalTickCallback(btDynamicsWorld* world, btScalar timeStep);
+    friend class PhysicsStepThread;
 
 public:
     /// Construct.
@@ -144,6 +320,14 @@ public:
     bool isVisible(const btVector3& aabbMin, const btVector3& aabbMax) override;
     /// Draw a physics debug line.
     void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override;
+    /// Draw a physics debug sphere as an instanced debug shape.
+    void drawSphere(btScalar radius, const btTransform& transform, const btVector3& color) override;
+    /// Draw a physics debug box as an instanced debug shape.
+    void drawBox(const btVector3& bbMin, const btVector3& bbMax, const btTransform& trans, const btVector3& color) override;
+    /// Draw a physics debug capsule as instanced debug shapes.
+    void drawCapsule(btScalar radius, btScalar halfHeight, int upAxis, const btTransform& transform, const btVector3& color) override;
+    /// Draw a physics debug cylinder as an instanced debug shape.
+    void drawCylinder(btScalar radius, btScalar halfHeight, int upAxis, const btTransform& transform, const btVector3& color) override;
     /// Log warning from the physics engine.
     void reportErrorWarning(const char* warningString) override;
     /// Draw a physics debug contact point. Not implemented.
@@ -181,8 +365,38 @@ public:
     void SetInternalEdge(bool enable);
     /// Set split impulse collision mode. This is more accurate, but slower. Disabled by default.
     void SetSplitImpulse(bool enable);
+    /// Set distance a rigid body must move before its scene node is updated after a simulation step. 0 (default) updates on any change.
+    void SetSyncPositionThreshold(float threshold);
+    /// Set angle in degrees a rigid body must rotate before its scene node is updated after a simulation step. 0 (default) updates on any change.
+    void SetSyncRotationThreshold(float threshold);
+    /// Set directory for saving and loading the triangle mesh BVHs and convex hulls built from models. A relative path is a resource path, and new files are saved next to the model's resource directory. Empty (default) disables.
+    void SetGeometryCacheDir(const String& path);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set whether to send the collision events. When disabled, collisions can still be read from the contact stream. Enabled by default.
+    void SetCollisionEvents(bool enable) { collisionEvents_ = enable; }
+    /// Set whether to record the colliding body pairs and their contact points of each frame into the contact stream. Disabled by default.
+    void SetContactStream(bool enable);
+    /// Set whether to run the simulation step in a separate thread, overlapping with the rest of the frame. The step started during a scene update is completed at the start of the next one, so the scene nodes show the results one frame later. While the step is in progress, the rigid body force, impulse, velocity and transform functions are queued to the command buffer, and the world queries and structural changes wait for the step to complete. Disabled by default.
+    void SetAsyncUpdate(bool enable);
+    /// Wait for an asynchronous simulation step in progress to complete and apply the queued rigid body commands. The scene nodes are updated on the next scene update.
+    void WaitForAsyncStep();
+    /// Queue a rigid body command to be applied once the asynchronous simulation step in progress completes, or apply immediately if no step is in progress.
+    void QueueCommand(const PhysicsCommand& command);
+    /// Set number of simulation steps to keep rigid body transform history for, used for lag-compensated queries. 0 (default) disables.
+    void SetTransformHistoryLength(unsigned steps);
+    /// Set whether the debug geometry includes the bounding boxes of the awake simulation islands, colored from green to red by their number of contact points. Disabled by default.
+    void SetDrawIslands(bool enable) { drawIslands_ = enable; }
+    /// Set whether to merge static rigid bodies into one Bullet collision object per spatial cell at the start of the simulation update, which keeps the broadphase small in levels with many static props. Queries and collision events still report the original rigid bodies. Disabled by default.
+    void SetStaticBatching(bool enable);
+    /// Set the edge length of the spatial cells for static batching.
+    void SetStaticBatchCellSize(float size);
+    /// Dissolve all static batches and merge the eligible static rigid bodies again immediately.
+    void RebuildStaticBatches();
+    /// Temporarily move rigid bodies to their transforms at the specified simulation step, so that the query functions operate on the past state of the world. Return true if the step is within the recorded history.
+    bool BeginRewind(unsigned step);
+    /// Restore rigid bodies to their current transforms after BeginRewind().
+    void EndRewind();
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -200,6 +414,10 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of closest-hit raycasts and sphere casts, with one result per query. The queries are divided to the work queue threads. Must not be called during the simulation step.
+    void RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsRaycastQuery>& queries);
+    /// Perform a batch of swept convex tests using Bullet collision shapes, with one result per query. The queries are divided to the work queue threads. Must not be called during the simulation step.
+    void ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsConvexCastQuery>& queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -210,6 +428,8 @@ public:
     void GetRigidBodies(PODVector<RigidBody*>& result, const RigidBody* body);
     /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
     void GetCollidingBodies(PODVector<RigidBody*>& result, const RigidBody* body);
+    /// Return colliding body pairs in the contact stream whose either body's collision layer matches the mask.
+    void GetContacts(PODVector<const PhysicsContact*>& result, unsigned collisionLayerMask = M_MAX_UNSIGNED) const;
 
     /// Return gravity.
     Vector3 GetGravity() const;
@@ -235,13 +455,83 @@ public:
     /// Return simulation steps per second.
     int GetFps() const { return fps_; }
 
+    /// Return distance a rigid body must move before its scene node is updated.
+    float GetSyncPositionThreshold() const { return syncPositionThreshold_; }
+
+    /// Return angle in degrees a rigid body must rotate before its scene node is updated.
+    float GetSyncRotationThreshold() const { return syncRotationThreshold_; }
+
+    /// Return number of scene nodes updated from rigid bodies on the last simulation update.
+    unsigned GetNumSyncedTransforms() const { return numSyncedTransforms_; }
+
+    /// Return statistics of the latest simulation substep. Not valid while an asynchronous step is in progress.
+    const PhysicsStepStats& GetStepStats() const { return stepStats_; }
+
+    /// Return whether the debug geometry includes the simulation islands.
+    bool GetDrawIslands() const { return drawIslands_; }
+
+    /// Return whether static rigid bodies are merged into static batches.
+    bool GetStaticBatching() const { return staticBatching_; }
+
+    /// Return the edge length of the spatial cells for static batching.
+    float GetStaticBatchCellSize() const { return staticBatchCellSize_; }
+
+    /// Return number of static batches.
+    unsigned GetNumStaticBatches() const { return staticBatches_.Size(); }
+
+    /// Return number of rigid bodies merged into static batches.
+    unsigned GetNumBatchedBodies() const { return batchedBodies_.Size(); }
+
+    /// Return the rigid body of a Bullet collision object. For a static batch, the shape part and the triangle or child shape index reported by Bullet for a hit or contact point select the merged rigid body.
+    static RigidBody* GetRigidBody(const btCollisionObject* object, int shapePart = -1, int index = -1);
+
+    /// Return directory for the triangle mesh BVHs and convex hulls built from models.
+    const String& GetGeometryCacheDir() const { return geometryCacheDir_; }
+
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return whether the collision events are sent.
+    bool GetCollisionEvents() const { return collisionEvents_; }
+
+    /// Return whether the contact stream is recorded.
+    bool GetContactStream() const { return contactStream_; }
+
+    /// Return colliding body pairs of the last frame in the contact stream, one entry per pair and simulation substep.
+    const Vector<PhysicsContact>& GetContacts() const { return contacts_; }
+
+    /// Return contact points of the last frame in the contact stream, indexed by the colliding body pairs.
+    const PODVector<PhysicsContactPoint>& GetContactPoints() const { return contactPoints_; }
+
+    /// Return whether the simulation step runs in a separate thread.
+    bool GetAsyncUpdate() const { return asyncUpdate_; }
+
+    /// Return whether an asynchronous simulation step is in progress.
+    bool IsStepInProgress() const { return stepInProgress_; }
+
+    /// Return number of rigid body commands waiting for the asynchronous simulation step to complete.
+    unsigned GetNumQueuedCommands() const { return commands_.Size(); }
+
+    /// Return number of simulation steps to keep rigid body transform history for.
+    unsigned GetTransformHistoryLength() const { return transformHistoryLength_; }
+
+    /// Return number of the latest simulation step. Increments after each step.
+    unsigned GetHistoryStep() const { return historyStep_; }
+
+    /// Return number of the simulation step that was current the specified amount of seconds ago, clamped to the recorded history. For lag compensation, pass e.g. the client connection's round trip time plus its interpolation delay.
+    unsigned GetHistoryStepAt(float secondsAgo) const;
+
+    /// Return whether rigid bodies are currently rewound.
+    bool IsRewinding() const { return rewinding_; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
     void RemoveRigidBody(RigidBody* body);
+    /// Queue a rigid body to be merged into a static batch on the next simulation update if it is eligible. Called by RigidBody.
+    void AddStaticBatchCandidate(RigidBody* body);
+    /// Dissolve the static batch of a rigid body before the body changes. The other bodies of the batch return to the Bullet world and are merged again on the next simulation update. Called by RigidBody.
+    void RemoveFromStaticBatch(RigidBody* body);
     /// Add a collision shape to keep track of. Called by CollisionShape.
     void AddCollisionShape(CollisionShape* shape);
     /// Remove a collision shape. Called by CollisionShape.
@@ -250,6 +540,8 @@ public:
     void AddConstraint(Constraint* constraint);
     /// Remove a constraint. Called by Constraint.
     void RemoveConstraint(Constraint* constraint);
+    /// Add a rigid body whose world transform changed in the simulation. Called by RigidBody.
+    void AddPendingWorldTransform(RigidBody* body);
     /// Add a delayed world transform assignment. Called by RigidBody.
     void AddDelayedWorldTransform(const DelayedWorldTransform& transform);
     /// Add debug geometry to the debug renderer.
@@ -299,6 +591,30 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Advance the Bullet world by the frame's timestep. Called from the step thread in asynchronous mode.
+    void StepSimulation(float timeStep);
+    /// Apply the simulated transforms to the scene nodes.
+    void SyncWorldTransforms();
+    /// Record the rigid body transform history after a simulation step.
+    void RecordTransformHistory();
+    /// Update the substep statistics and publish them to the performance counters.
+    void UpdateStepStats();
+    /// Draw the bounding boxes of the awake simulation islands.
+    void DrawIslands(DebugRenderer* debug, bool depthTest);
+    /// Complete the asynchronous simulation step started on the previous update and send its events.
+    void CompleteAsyncStep();
+    /// Start an asynchronous simulation step.
+    void BeginAsyncStep(float timeStep);
+    /// Apply a rigid body command.
+    void ApplyCommand(const PhysicsCommand& command);
+    /// Merge the queued eligible static rigid bodies into static batches and rebuild the changed batches.
+    void UpdateStaticBatches();
+    /// Rebuild the Bullet collision object of a static batch from its rigid bodies.
+    void BuildStaticBatch(StaticCollisionBatch* batch);
+    /// Remove a static batch and return its rigid bodies to the Bullet world.
+    void DissolveStaticBatch(StaticCollisionBatch* batch);
+    /// Dissolve all static batches.
+    void ClearStaticBatches();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -322,6 +638,8 @@ private:
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
     /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
+    /// Rigid bodies whose world transform changed in the simulation.
+    PODVector<RigidBody*> pendingWorldTransforms_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
@@ -330,12 +648,30 @@ private:
     CollisionGeometryDataCache convexCache_;
     /// Cache for GImpact trimesh geometry data by model and LOD level.
     CollisionGeometryDataCache gimpactTrimeshCache_;
+    /// Collision geometry cache directory.
+    String geometryCacheDir_;
     /// Preallocated event data map for physics collision events.
     VariantMap physicsCollisionData_;
     /// Preallocated event data map for node collision events.
     VariantMap nodeCollisionData_;
     /// Preallocated buffer for physics collision contact data.
-    VectorBuffer contacts_;
+    VectorBuffer contactBuffer_;
+    /// Colliding body pairs in the contact stream.
+    Vector<PhysicsContact> contacts_;
+    /// Contact points in the contact stream.
+    PODVector<PhysicsContactPoint> contactPoints_;
+    /// Thread for the asynchronous simulation step.
+    UniquePtr<PhysicsStepThread> stepThread_;
+    /// Rigid body commands queued during the asynchronous simulation step.
+    Vector<PhysicsCommand> commands_;
+    /// Static batches.
+    HashMap<StaticBatchKey, SharedPtr<StaticCollisionBatch> > staticBatches_;
+    /// Static batches by merged rigid body.
+    HashMap<RigidBody*, StaticCollisionBatch*> batchedBodies_;
+    /// Rigid bodies waiting to be merged into static batches.
+    HashSet<RigidBody*> pendingStaticBodies_;
+    /// Static batch cell size.
+    float staticBatchCellSize_{DEFAULT_STATIC_BATCH_CELL_SIZE};
     /// Simulation substeps per second.
     unsigned fps_{DEFAULT_FPS};
     /// Maximum number of simulation substeps per frame. 0 (default) unlimited, or negative values for adaptive timestep.
@@ -344,22 +680,68 @@ private:
     float timeAcc_{};
     /// Maximum angular velocity for network replication.
     float maxNetworkAngularVelocity_{DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY};
+    /// Scene node update position threshold.
+    float syncPositionThreshold_{};
+    /// Scene node update rotation threshold in degrees.
+    float syncRotationThreshold_{};
+    /// Number of scene nodes updated on the last simulation update.
+    unsigned numSyncedTransforms_{};
+    /// Statistics of the latest substep.
+    PhysicsStepStats stepStats_;
+    /// Bullet's count of clamped continuous collision motions after the latest substep.
+    int lastCcdHits_{};
+    /// Timestep of the asynchronous simulation step.
+    float asyncTimeStep_{};
+    /// Number of substeps taken by the asynchronous simulation step.
+    unsigned numAsyncSubSteps_{};
+    /// Rigid body transform history length in simulation steps.
+    unsigned transformHistoryLength_{};
+    /// Latest simulation step number.
+    unsigned historyStep_{};
+    /// Rigid bodies moved by BeginRewind().
+    PODVector<RigidBody*> rewoundBodies_;
+    /// Rewinding flag.
+    bool rewinding_{};
     /// Automatic simulation update enabled flag.
     bool updateEnabled_{true};
     /// Interpolation flag.
     bool interpolation_{true};
     /// Use internal edge utility flag.
     bool internalEdge_{true};
+    /// Collision events flag.
+    bool collisionEvents_{true};
+    /// Contact stream flag.
+    bool contactStream_{};
     /// Applying transforms flag.
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Asynchronous simulation update flag.
+    bool asyncUpdate_{};
+    /// Asynchronous simulation step in progress flag.
+    bool stepInProgress_{};
+    /// Asynchronous simulation step results waiting to be applied flag.
+    bool asyncResultsPending_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
+    /// Draw simulation islands flag.
+    bool drawIslands_{};
+    /// Static batching flag.
+    bool staticBatching_{};
+    /// Forwarding Bullet's profiling zones to the profiler flag.
+    bool bulletProfiling_{};
     /// Debug renderer.
     DebugRenderer* debugRenderer_{};
     /// Debug draw flags.
     int debugMode_{};
+    /// Counter of broadphase pairs with a contact manifold.
+    SharedPtr<PerfCounter> pairsCounter_;
+    /// Gauge of awake dynamic rigid bodies.
+    SharedPtr<PerfCounter> activeBodiesCounter_;
+    /// Gauge of overlapping broadphase pairs.
+    SharedPtr<PerfCounter> overlappingPairsCounter_;
+    /// Counter of continuous collision detection hits.
+    SharedPtr<PerfCounter> ccdHitsCounter_;
 };
 
 /// Register Physics library objects.
@@ -61,6 +61,29 @@ static const char* collisionEventModeNames[] =
 
 extern const char* PHYSICS_CATEGORY;
 
+/// Queue a command to the physics world if its asynchronous simulation step is in progress. Return true if queued.
+static bool QueueCommand(PhysicsWorld* world, RigidBody* body, PhysicsCommandType type, const Vector3& vector,
+    const Vector3& position = Vector3::ZERO, const Quaternion& rotation = Quaternion::IDENTITY)
+{
+    if (!world || !world->IsStepInProgress())
+        return false;
+
+    PhysicsCommand command;
+    command.body_ = body;
+    command.type_ = type;
+    command.vector_ = vector;
+    command.position_ = position;
+    command.rotation_ = rotation;
+    world->QueueCommand(command);
+    return true;
+}
+
+/// Return whether the Bullet rigid body state is being written by an asynchronous simulation step, so that queries have to use the cached state.
+static bool IsStepInProgress(PhysicsWorld* world)
+{
+    return world && world->IsStepInProgress();
+}
+
 RigidBody::RigidBody(Context* context) :
     Component(context),
     gravityOverride_(Vector3::ZERO),
@@ -76,8 +99,13 @@ RigidBody::RigidBody(Context* context) :
     useGravity_(true),
     readdBody_(false),
     inWorld_(false),
+    batched_(false),
     enableMassUpdate_(true),
-    hasSimulated_(false)
+    hasSimulated_(false),
+    syncPending_(false),
+    historyStep_(0),
+    historyCount_(0),
+    stepActive_(false)
 {
     compoundShape_ = new btCompoundShape();
     shiftedCompoundShape_ = new btCompoundShape();
@@ -147,8 +175,14 @@ void RigidBody::OnSetEnabled()
 void RigidBody::getWorldTransform(btTransform& worldTrans) const
 {
     // We may be in a pathological state where a RigidBody exists without a scene node when this callback is fired,
-    // so check to be sure
-    if (node_)
+    // so check to be sure. During an asynchronous simulation step the node may be moving in the main thread, so use the
+    // transform PhysicsWorld read before the step
+    if (physicsWorld_ && physicsWorld_->IsStepInProgress())
+    {
+        worldTrans.setOrigin(ToBtVector3(lastPosition_ + lastRotation_ * centerOfMass_));
+        worldTrans.setRotation(ToBtQuaternion(lastRotation_));
+    }
+    else if (node_)
     {
         lastPosition_ = node_->GetWorldPosition();
         lastRotation_ = node_->GetWorldRotation();
@@ -161,36 +195,55 @@ void RigidBody::getWorldTransform(btTransform& worldTrans) const
 
 void RigidBody::setWorldTransform(const btTransform& worldTrans)
 {
-    Quaternion newWorldRotation = ToQuaternion(worldTrans.getRotation());
-    Vector3 newWorldPosition = ToVector3(worldTrans.getOrigin()) - newWorldRotation * centerOfMass_;
-    RigidBody* parentRigidBody = nullptr;
+    // Store the transform to be applied to the scene node in PhysicsWorld's sync pass after the simulation, so that the node
+    // is written at most once per frame
+    syncRotation_ = ToQuaternion(worldTrans.getRotation());
+    syncPosition_ = ToVector3(worldTrans.getOrigin()) - syncRotation_ * centerOfMass_;
+    if (!syncPending_ && physicsWorld_)
+    {
+        syncPending_ = true;
+        physicsWorld_->AddPendingWorldTransform(this);
+    }
+
+    hasSimulated_ = true;
+}
+
+bool RigidBody::SyncWorldTransform(float positionThreshold, float minRotationDot)
+{
+    syncPending_ = false;
 
     // It is possible that the RigidBody component has been kept alive via a shared pointer,
     // while its scene node has already been destroyed
-    if (node_)
-    {
-        // If the rigid body is parented to another rigid body, can not set the transform immediately.
-        // In that case store it to PhysicsWorld for delayed assignment
-        Node* parent = node_->GetParent();
-        if (parent != GetScene() && parent)
-            parentRigidBody = parent->GetComponent<RigidBody>();
-
-        if (!parentRigidBody)
-            ApplyWorldTransform(newWorldPosition, newWorldRotation);
-        else
-        {
-            DelayedWorldTransform delayed;
-            delayed.rigidBody_ = this;
-            delayed.parentRigidBody_ = parentRigidBody;
-            delayed.worldPosition_ = newWorldPosition;
-            delayed.worldRotation_ = newWorldRotation;
-            physicsWorld_->AddDelayedWorldTransform(delayed);
-        }
+    if (!node_ || !physicsWorld_)
+        return false;
 
-        MarkNetworkUpdate();
+    // Skip changes below the thresholds, for example from a resting body jittering before it falls asleep
+    bool rotationChanged = minRotationDot < 1.0f ? Abs(syncRotation_.DotProduct(lastRotation_)) < minRotationDot :
+        syncRotation_ != lastRotation_;
+    if (!rotationChanged && (syncPosition_ - lastPosition_).LengthSquared() <= positionThreshold * positionThreshold)
+        return false;
+
+    // If the rigid body is parented to another rigid body, can not set the transform immediately.
+    // In that case store it to PhysicsWorld for delayed assignment
+    RigidBody* parentRigidBody = nullptr;
+    Node* parent = node_->GetParent();
+    if (parent != GetScene() && parent)
+        parentRigidBody = parent->GetComponent<RigidBody>();
+
+    if (!parentRigidBody)
+        ApplyWorldTransform(syncPosition_, syncRotation_);
+    else
+    {
+        DelayedWorldTransform delayed;
+        delayed.rigidBody_ = this;
+        delayed.parentRigidBody_ = parentRigidBody;
+        delayed.worldPosition_ = syncPosition_;
+        delayed.worldRotation_ = syncRotation_;
+        physicsWorld_->AddDelayedWorldTransform(delayed);
     }
 
-    hasSimulated_ = true;
+    MarkNetworkUpdate();
+    return true;
 }
 
 void RigidBody::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -222,8 +275,16 @@ void RigidBody::SetMass(float mass)
 
 void RigidBody::SetPosition(const Vector3& position)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_SET_POSITION, position))
+    {
+        stepPosition_ = position;
+        return;
+    }
+
     if (body_)
     {
+        ReleaseStaticBatch();
+
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setOrigin(ToBtVector3(position + ToQuaternion(worldTrans.getRotation()) * centerOfMass_));
 
@@ -238,6 +299,10 @@ void RigidBody::SetPosition(const Vector3& position)
             body_->setInterpolationWorldTransform(interpTrans);
         }
 
+        // A scene node update still pending from an asynchronous simulation step would move the node back
+        if (syncPending_)
+            syncPosition_ = position;
+
         Activate();
         MarkNetworkUpdate();
     }
@@ -245,8 +310,16 @@ void RigidBody::SetPosition(const Vector3& position)
 
 void RigidBody::SetRotation(const Quaternion& rotation)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_SET_ROTATION, Vector3::ZERO, Vector3::ZERO, rotation))
+    {
+        stepRotation_ = rotation;
+        return;
+    }
+
     if (body_)
     {
+        ReleaseStaticBatch();
+
         Vector3 oldPosition = GetPosition();
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setRotation(ToBtQuaternion(rotation));
@@ -264,6 +337,9 @@ void RigidBody::SetRotation(const Quaternion& rotation)
 
         body_->updateInertiaTensor();
 
+        if (syncPending_)
+            syncRotation_ = rotation;
+
         Activate();
         MarkNetworkUpdate();
     }
@@ -271,8 +347,17 @@ void RigidBody::SetRotation(const Quaternion& rotation)
 
 void RigidBody::SetTransform(const Vector3& position, const Quaternion& rotation)
 {
+    if (physicsWorld_ && physicsWorld_->IsStepInProgress())
+    {
+        SetRotation(rotation);
+        SetPosition(position);
+        return;
+    }
+
     if (body_)
     {
+        ReleaseStaticBatch();
+
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setRotation(ToBtQuaternion(rotation));
         worldTrans.setOrigin(ToBtVector3(position + rotation * centerOfMass_));
@@ -287,6 +372,12 @@ void RigidBody::SetTransform(const Vector3& position, const Quaternion& rotation
 
         body_->updateInertiaTensor();
 
+        if (syncPending_)
+        {
+            syncPosition_ = position;
+            syncRotation_ = rotation;
+        }
+
         Activate();
         MarkNetworkUpdate();
     }
@@ -294,6 +385,12 @@ void RigidBody::SetTransform(const Vector3& position, const Quaternion& rotation
 
 void RigidBody::SetLinearVelocity(const Vector3& velocity)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_SET_LINEAR_VELOCITY, velocity))
+    {
+        stepLinearVelocity_ = velocity;
+        return;
+    }
+
     if (body_)
     {
         body_->setLinearVelocity(ToBtVector3(velocity));
@@ -332,6 +429,12 @@ void RigidBody::SetLinearDamping(float damping)
 
 void RigidBody::SetAngularVelocity(const Vector3& velocity)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_SET_ANGULAR_VELOCITY, velocity))
+    {
+        stepAngularVelocity_ = velocity;
+        return;
+    }
+
     if (body_)
     {
         body_->setAngularVelocity(ToBtVector3(velocity));
@@ -372,6 +475,7 @@ void RigidBody::SetFriction(float friction)
 {
     if (body_)
     {
+        ReleaseStaticBatch();
         body_->setFriction(friction);
         MarkNetworkUpdate();
     }
@@ -390,6 +494,7 @@ void RigidBody::SetRollingFriction(float friction)
 {
     if (body_)
     {
+        ReleaseStaticBatch();
         body_->setRollingFriction(friction);
         MarkNetworkUpdate();
     }
@@ -399,6 +504,7 @@ void RigidBody::SetRestitution(float restitution)
 {
     if (body_)
     {
+        ReleaseStaticBatch();
         body_->setRestitution(restitution);
         MarkNetworkUpdate();
     }
@@ -512,6 +618,9 @@ void RigidBody::SetCollisionEventMode(CollisionEventMode mode)
 
 void RigidBody::ApplyForce(const Vector3& force)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_FORCE, force))
+        return;
+
     if (body_ && force != Vector3::ZERO)
     {
         Activate();
@@ -521,6 +630,9 @@ void RigidBody::ApplyForce(const Vector3& force)
 
 void RigidBody::ApplyForce(const Vector3& force, const Vector3& position)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_FORCE_AT_POSITION, force, position))
+        return;
+
     if (body_ && force != Vector3::ZERO)
     {
         Activate();
@@ -530,6 +642,9 @@ void RigidBody::ApplyForce(const Vector3& force, const Vector3& position)
 
 void RigidBody::ApplyTorque(const Vector3& torque)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_TORQUE, torque))
+        return;
+
     if (body_ && torque != Vector3::ZERO)
     {
         Activate();
@@ -539,6 +654,9 @@ void RigidBody::ApplyTorque(const Vector3& torque)
 
 void RigidBody::ApplyImpulse(const Vector3& impulse)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_IMPULSE, impulse))
+        return;
+
     if (body_ && impulse != Vector3::ZERO)
     {
         Activate();
@@ -548,6 +666,9 @@ void RigidBody::ApplyImpulse(const Vector3& impulse)
 
 void RigidBody::ApplyImpulse(const Vector3& impulse, const Vector3& position)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_IMPULSE_AT_POSITION, impulse, position))
+        return;
+
     if (body_ && impulse != Vector3::ZERO)
     {
         Activate();
@@ -557,6 +678,9 @@ void RigidBody::ApplyImpulse(const Vector3& impulse, const Vector3& position)
 
 void RigidBody::ApplyTorqueImpulse(const Vector3& torque)
 {
+    if (QueueCommand(physicsWorld_, this, PHYSICS_APPLY_TORQUE_IMPULSE, torque))
+        return;
+
     if (body_ && torque != Vector3::ZERO)
     {
         Activate();
@@ -600,6 +724,9 @@ Vector3 RigidBody::GetPosition() const
 {
     if (body_)
     {
+        if (IsStepInProgress(physicsWorld_))
+            return stepPosition_;
+
         const btTransform& transform = body_->getWorldTransform();
         return ToVector3(transform.getOrigin()) - ToQuaternion(transform.getRotation()) * centerOfMass_;
     }
@@ -609,11 +736,17 @@ Vector3 RigidBody::GetPosition() const
 
 Quaternion RigidBody::GetRotation() const
 {
+    if (body_ && IsStepInProgress(physicsWorld_))
+        return stepRotation_;
+
     return body_ ? ToQuaternion(body_->getWorldTransform().getRotation()) : Quaternion::IDENTITY;
 }
 
 Vector3 RigidBody::GetLinearVelocity() const
 {
+    if (body_ && IsStepInProgress(physicsWorld_))
+        return stepLinearVelocity_;
+
     return body_ ? ToVector3(body_->getLinearVelocity()) : Vector3::ZERO;
 }
 
@@ -624,6 +757,9 @@ Vector3 RigidBody::GetLinearFactor() const
 
 Vector3 RigidBody::GetVelocityAtPoint(const Vector3& position) const
 {
+    if (body_ && IsStepInProgress(physicsWorld_))
+        return stepLinearVelocity_ + stepAngularVelocity_.CrossProduct(position - centerOfMass_);
+
     return body_ ? ToVector3(body_->getVelocityInLocalPoint(ToBtVector3(position - centerOfMass_))) : Vector3::ZERO;
 }
 
@@ -639,6 +775,9 @@ float RigidBody::GetLinearDamping() const
 
 Vector3 RigidBody::GetAngularVelocity() const
 {
+    if (body_ && IsStepInProgress(physicsWorld_))
+        return stepAngularVelocity_;
+
     return body_ ? ToVector3(body_->getAngularVelocity()) : Vector3::ZERO;
 }
 
@@ -694,9 +833,25 @@ float RigidBody::GetCcdMotionThreshold() const
 
 bool RigidBody::IsActive() const
 {
+    if (body_ && IsStepInProgress(physicsWorld_))
+        return stepActive_;
+
     return body_ ? body_->isActive() : false;
 }
 
+void RigidBody::CacheStepState()
+{
+    if (!body_)
+        return;
+
+    const btTransform& transform = body_->getWorldTransform();
+    stepRotation_ = ToQuaternion(transform.getRotation());
+    stepPosition_ = ToVector3(transform.getOrigin()) - stepRotation_ * centerOfMass_;
+    stepLinearVelocity_ = ToVector3(body_->getLinearVelocity());
+    stepAngularVelocity_ = ToVector3(body_->getAngularVelocity());
+    stepActive_ = body_->isActive();
+}
+
 void RigidBody::GetCollidingBodies(PODVector<RigidBody*>& result) const
 {
     if (physicsWorld_)
@@ -738,6 +893,12 @@ void RigidBody::UpdateMass()
     if (!body_ || !enableMassUpdate_)
         return;
 
+    if (physicsWorld_)
+        physicsWorld_->WaitForAsyncStep();
+
+    // A static batch refers to the collision shapes, which may be about to be deleted
+    ReleaseStaticBatch();
+
     btTransform principal;
     principal.setRotation(btQuaternion::getIdentity());
     principal.setOrigin(btVector3(0.0f, 0.0f, 0.0f));
@@ -859,6 +1020,8 @@ const PODVector<unsigned char>& RigidBody::GetNetAngularVelocityAttr() const
 
 void RigidBody::AddConstraint(Constraint* constraint)
 {
+    // Constraints need the Bullet rigid body in the world
+    ReleaseStaticBatch();
     constraints_.Push(constraint);
 }
 
@@ -867,6 +1030,9 @@ void RigidBody::RemoveConstraint(Constraint* constraint)
     constraints_.Remove(constraint);
     // A constraint being removed should possibly cause the object to eg. start falling, so activate
     Activate();
+
+    if (physicsWorld_ && inWorld_)
+        physicsWorld_->AddStaticBatchCandidate(this);
 }
 
 void RigidBody::ReleaseBody()
@@ -885,6 +1051,69 @@ void RigidBody::ReleaseBody()
     }
 }
 
+void RigidBody::RecordTransformHistory(unsigned step, unsigned historyLength)
+{
+    // Static bodies do not move during simulation, so their current transform is always valid
+    if (!body_ || !inWorld_ || (mass_ == 0.0f && !kinematic_))
+    {
+        historyCount_ = 0;
+        return;
+    }
+
+    if (historyPositions_.Size() != historyLength)
+    {
+        historyPositions_.Resize(historyLength);
+        historyRotations_.Resize(historyLength);
+        historyCount_ = 0;
+    }
+    // Restart the history if steps were missed
+    if (step != historyStep_ + 1)
+        historyCount_ = 0;
+
+    const btTransform& worldTrans = body_->getWorldTransform();
+    unsigned index = step % historyLength;
+    historyPositions_[index] = ToVector3(worldTrans.getOrigin());
+    historyRotations_[index] = ToQuaternion(worldTrans.getRotation());
+    historyStep_ = step;
+    historyCount_ = Min(historyCount_ + 1, historyLength);
+}
+
+void RigidBody::ClearTransformHistory()
+{
+    historyPositions_.Clear();
+    historyRotations_.Clear();
+    historyCount_ = 0;
+}
+
+bool RigidBody::Rewind(unsigned step)
+{
+    unsigned stepsAgo = historyStep_ - step;
+    if (!body_ || !inWorld_ || !stepsAgo || stepsAgo >= historyCount_)
+        return false;
+
+    btTransform& worldTrans = body_->getWorldTransform();
+    rewindPosition_ = ToVector3(worldTrans.getOrigin());
+    rewindRotation_ = ToQuaternion(worldTrans.getRotation());
+
+    unsigned index = step % historyPositions_.Size();
+    worldTrans.setOrigin(ToBtVector3(historyPositions_[index]));
+    worldTrans.setRotation(ToBtQuaternion(historyRotations_[index]));
+    physicsWorld_->GetWorld()->updateSingleAabb(body_.Get());
+    return true;
+}
+
+void RigidBody::EndRewind()
+{
+    if (!body_)
+        return;
+
+    btTransform& worldTrans = body_->getWorldTransform();
+    worldTrans.setOrigin(ToBtVector3(rewindPosition_));
+    worldTrans.setRotation(ToBtQuaternion(rewindRotation_));
+    if (inWorld_)
+        physicsWorld_->GetWorld()->updateSingleAabb(body_.Get());
+}
+
 void RigidBody::OnMarkedDirty(Node* node)
 {
     // If node transform changes, apply it back to the physics transform. However, do not do this when a SmoothedTransform
@@ -927,6 +1156,13 @@ void RigidBody::OnNodeSet(Node* node)
 
 void RigidBody::OnSceneSet(Scene* scene)
 {
+    // Bodies can not be added to or removed from the world during an asynchronous simulation step
+    if (physicsWorld_)
+        physicsWorld_->WaitForAsyncStep();
+
+    // The physics world forgets a pending world transform along with the body
+    syncPending_ = false;
+
     if (scene)
     {
         if (scene == node_)
@@ -953,6 +1189,8 @@ void RigidBody::AddBodyToWorld()
 
     URHO3D_PROFILE(AddBodyToWorld);
 
+    physicsWorld_->WaitForAsyncStep();
+
     if (mass_ < 0.0f)
         mass_ = 0.0f;
 
@@ -1020,18 +1258,46 @@ void RigidBody::AddBodyToWorld()
         SetLinearVelocity(Vector3::ZERO);
         SetAngularVelocity(Vector3::ZERO);
     }
+
+    physicsWorld_->AddStaticBatchCandidate(this);
 }
 
 void RigidBody::RemoveBodyFromWorld()
 {
     if (physicsWorld_ && body_ && inWorld_)
     {
-        btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
-        world->removeRigidBody(body_.Get());
+        physicsWorld_->WaitForAsyncStep();
         inWorld_ = false;
+        // A batched body is not in the Bullet world itself. Clear the world flag first so that the body stays out
+        if (batched_)
+            physicsWorld_->RemoveFromStaticBatch(this);
+        else
+            physicsWorld_->GetWorld()->removeRigidBody(body_.Get());
     }
 }
 
+void RigidBody::SetBatched(bool enable)
+{
+    if (enable == batched_ || !body_)
+        return;
+
+    batched_ = enable;
+    if (!inWorld_ || !physicsWorld_)
+        return;
+
+    btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
+    if (enable)
+        world->removeRigidBody(body_.Get());
+    else
+        world->addRigidBody(body_.Get(), (short)collisionLayer_, (short)collisionMask_);
+}
+
+void RigidBody::ReleaseStaticBatch()
+{
+    if (batched_ && physicsWorld_)
+        physicsWorld_->RemoveFromStaticBatch(this);
+}
+
 void RigidBody::HandleTargetPosition(StringHash eventType, VariantMap& eventData)
 {
     // Copy the smoothing target position to the rigid body
@@ -50,6 +50,7 @@ enum CollisionEventMode
 class URHO3D_API RigidBody : public Component, public btMotionState
 {
     URHO3D_OBJECT(RigidBody, Component);
+    URHO3D_POOLED_OBJECT(RigidBody);
 
 public:
     /// Construct.
@@ -226,8 +227,21 @@ public:
     /// Return colliding rigid bodies from the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
     void GetCollidingBodies(PODVector<RigidBody*>& result) const;
 
+    /// Return whether the rigid body has been added to the physics world, including when merged into a static collision batch.
+    bool IsInWorld() const { return inWorld_; }
+
+    /// Return whether the rigid body is merged into a static collision batch of the physics world instead of being in the Bullet world itself.
+    bool IsBatched() const { return batched_; }
+
+    /// Return constraints that refer to this rigid body.
+    const PODVector<Constraint*>& GetConstraints() const { return constraints_; }
+
     /// Apply new world transform after a simulation step. Called internally.
     void ApplyWorldTransform(const Vector3& newWorldPosition, const Quaternion& newWorldRotation);
+    /// Apply the world transform from the last simulation step to the scene node, unless the position moved at most the threshold distance and the absolute quaternion dot product with the last applied rotation is at least the minimum. Called by PhysicsWorld. Return true if the node is updated.
+    bool SyncWorldTransform(float positionThreshold, float minRotationDot);
+    /// Store the Bullet rigid body state for queries while an asynchronous simulation step is in progress. Called by PhysicsWorld.
+    void CacheStepState();
     /// Update mass and inertia to the Bullet rigid body. Readd body to world if necessary: if was in world and the Bullet collision shape to use changed.
     void UpdateMass();
     /// Update gravity parameters to the Bullet rigid body.
@@ -242,6 +256,16 @@ public:
     void RemoveConstraint(Constraint* constraint);
     /// Remove the rigid body.
     void ReleaseBody();
+    /// Record the current Bullet world transform for the specified simulation step. Called by PhysicsWorld.
+    void RecordTransformHistory(unsigned step, unsigned historyLength);
+    /// Clear recorded transform history. Called by PhysicsWorld.
+    void ClearTransformHistory();
+    /// Move the Bullet rigid body temporarily to its recorded transform at the specified simulation step. Return true if moved. Called by PhysicsWorld.
+    bool Rewind(unsigned step);
+    /// Restore the Bullet rigid body transform after Rewind(). Called by PhysicsWorld.
+    void EndRewind();
+    /// Remove the Bullet rigid body from the Bullet world while merged into a static collision batch, or add it back. Called by PhysicsWorld.
+    void SetBatched(bool enable);
 
 protected:
     /// Handle node being assigned.
@@ -262,6 +286,8 @@ private:
     void HandleTargetRotation(StringHash eventType, VariantMap& eventData);
     /// Mark body dirty.
     void MarkBodyDirty() { readdBody_ = true; }
+    /// Take the body out of its static collision batch before the Bullet rigid body or its collision shapes change.
+    void ReleaseStaticBatch();
 
     /// Bullet rigid body.
     UniquePtr<btRigidBody> body_;
@@ -303,10 +329,40 @@ private:
     bool readdBody_;
     /// Body exists in world flag.
     bool inWorld_;
+    /// Merged into a static collision batch flag.
+    bool batched_;
     /// Mass update enable flag.
     bool enableMassUpdate_;
     /// Internal flag whether has simulated at least once.
     mutable bool hasSimulated_;
+    /// World transform from the simulation waiting to be applied flag.
+    bool syncPending_;
+    /// World position from the simulation waiting to be applied.
+    Vector3 syncPosition_;
+    /// World rotation from the simulation waiting to be applied.
+    Quaternion syncRotation_;
+    /// Recorded Bullet world positions ring buffer.
+    PODVector<Vector3> historyPositions_;
+    /// Recorded Bullet world rotations ring buffer.
+    Vector<Quaternion> historyRotations_;
+    /// Simulation step of the latest recorded transform.
+    unsigned historyStep_;
+    /// Number of valid recorded transforms.
+    unsigned historyCount_;
+    /// Bullet world transform to restore after rewinding.
+    Vector3 rewindPosition_;
+    /// Bullet world rotation to restore after rewinding.
+    Quaternion rewindRotation_;
+    /// World position returned while an asynchronous simulation step is in progress.
+    Vector3 stepPosition_;
+    /// World rotation returned while an asynchronous simulation step is in progress.
+    Quaternion stepRotation_;
+    /// Linear velocity returned while an asynchronous simulation step is in progress.
+    Vector3 stepLinearVelocity_;
+    /// Angular velocity returned while an asynchronous simulation step is in progress.
+    Vector3 stepAngularVelocity_;
+    /// Active flag returned while an asynchronous simulation step is in progress.
+    bool stepActive_;
 };
 
 }
@@ -36,54 +36,100 @@
 namespace Urho3D
 {
 
+/// Worker thread of the background loader.
+class BackgroundLoaderThread : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    explicit BackgroundLoaderThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Load resources until stopped.
+    void ThreadFunction() override
+    {
+        owner_->ProcessResources();
+    }
+
+private:
+    /// Owning background loader.
+    BackgroundLoader* owner_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numThreads_(1),
+    shutDown_(false)
 {
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    StopThreads();
+
     MutexLock lock(backgroundLoadMutex_);
 
     backgroundLoadQueue_.Clear();
+    pendingResources_.Clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::ProcessResources()
 {
-    while (shouldRun_)
+    for (;;)
     {
         backgroundLoadMutex_.Acquire();
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
+        if (shutDown_)
         {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            backgroundLoadMutex_.Release();
+            // Pass the wakeup on to the next thread
+            queueCondition_.Set();
+            break;
+        }
+
+        // Take the next queued resource that has not been loaded yet
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.End();
+        while (!pendingResources_.Empty() && i == backgroundLoadQueue_.End())
+        {
+            i = backgroundLoadQueue_.Find(pendingResources_.Front());
+            pendingResources_.PopFront();
         }
 
         if (i == backgroundLoadQueue_.End())
         {
-            // No resources to load found
+            // No resources to load found, sleep until more are queued
             backgroundLoadMutex_.Release();
-            Time::Sleep(5);
+            queueCondition_.Wait();
         }
         else
         {
             BackgroundLoadItem& item = i->second_;
             Resource* resource = item.resource_;
+            resource->SetAsyncLoadState(ASYNC_LOADING);
+            // Let another thread pick up the remaining resources in parallel
+            bool moreResources = !pendingResources_.Empty();
             // We can be sure that the item is not removed from the queue as long as it is in the
             // "queued" or "loading" state
             backgroundLoadMutex_.Release();
 
+            if (moreResources)
+                queueCondition_.Set();
+
             bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
             {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
+#ifdef URHO3D_PROFILING
+                // The hierarchical profiler ignores this thread, but it is shown in the timeline capture
+                AutoProfileBlock profileBlock(owner_->GetSubsystem<Profiler>(), "BackgroundLoadResource");
+#endif
+                LoadTimingScope loadTiming(owner_->GetLoadProfiling() ? &item.loadTimes_ : nullptr);
+                SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+                if (file)
+                {
+                    item.fileSize_ = file->GetSize();
+                    LoadStageTimer timer(LOADSTAGE_BEGINLOAD);
+                    success = resource->BeginLoad(*file);
+                }
             }
 
             // Process dependencies now
@@ -147,6 +193,12 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
 
+    // Resources requested by other resources in loading go first, as something is already waiting for them
+    if (caller)
+        pendingResources_.PushFront(key);
+    else
+        pendingResources_.Push(key);
+
     // If this is a resource calling for the background load of more resources, mark the dependency as necessary
     if (caller)
     {
@@ -163,9 +215,9 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    // Start the background loader threads now if not yet running, and wake up an idle one
+    StartThreads();
+    queueCondition_.Set();
 
     return true;
 }
@@ -179,6 +231,17 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
+        // Needed immediately, so move it to the front of the loading order if it has not started yet
+        if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+        {
+            List<Pair<StringHash, StringHash> >::Iterator j = pendingResources_.Find(key);
+            if (j != pendingResources_.End() && j != pendingResources_.Begin())
+            {
+                pendingResources_.Erase(j);
+                pendingResources_.PushFront(key);
+            }
+        }
+
         backgroundLoadMutex_.Release();
 
         {
@@ -217,7 +280,7 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
+    if (!threads_.Empty())
     {
         HiresTimer timer;
 
@@ -250,6 +313,55 @@ void BackgroundLoader::FinishResources(int maxMs)
     }
 }
 
+void BackgroundLoader::SetNumThreads(unsigned num)
+{
+    num = Max(num, 1U);
+    if (num == numThreads_)
+        return;
+
+    // Threads can not be removed individually, so restart all of them to reduce the count
+    bool running = !threads_.Empty();
+    if (num < threads_.Size())
+        StopThreads();
+
+    MutexLock lock(backgroundLoadMutex_);
+    numThreads_ = num;
+    if (running)
+        StartThreads();
+}
+
+void BackgroundLoader::StartThreads()
+{
+    while (threads_.Size() < numThreads_)
+    {
+        SharedPtr<BackgroundLoaderThread> thread(new BackgroundLoaderThread(this));
+        if (!thread->Run())
+        {
+            URHO3D_LOGERROR("Failed to start background loader thread");
+            break;
+        }
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::StopThreads()
+{
+    if (threads_.Empty())
+        return;
+
+    backgroundLoadMutex_.Acquire();
+    shutDown_ = true;
+    backgroundLoadMutex_.Release();
+
+    queueCondition_.Set();
+    for (unsigned i = 0; i < threads_.Size(); ++i)
+        threads_[i]->Stop();
+    threads_.Clear();
+
+    // The last exiting thread leaves the condition set, so that restarted threads check the queue immediately
+    shutDown_ = false;
+}
+
 unsigned BackgroundLoader::GetNumQueuedResources() const
 {
     MutexLock lock(backgroundLoadMutex_);
@@ -272,6 +384,8 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
             profiler->BeginBlock(profileBlockName.CString());
 #endif
         URHO3D_LOGDEBUG("Finishing background loaded resource " + resource->GetName());
+        LoadTimingScope loadTiming(owner_->GetLoadProfiling() ? &item.loadTimes_ : nullptr);
+        LoadStageTimer timer(LOADSTAGE_ENDLOAD);
         success = resource->EndLoad();
 
 #ifdef URHO3D_PROFILING
@@ -280,6 +394,7 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 #endif
     }
     resource->SetAsyncLoadState(ASYNC_DONE);
+    owner_->AddLoadRecord(resource, item.fileSize_, item.loadTimes_, true, success);
 
     if (!success && item.sendEventOnFailure_)
     {
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Resource/Compress.h"
+
+// DXT compression by bounding box endpoints, inset to reduce the error, and nearest palette index per pixel
+
+namespace Urho3D
+{
+
+static unsigned short Pack565(const int* color)
+{
+    int red = (color[0] * 31 + 127) / 255;
+    int green = (color[1] * 63 + 127) / 255;
+    int blue = (color[2] * 31 + 127) / 255;
+    return (unsigned short)((red << 11) | (green << 5) | blue);
+}
+
+static void Unpack565(unsigned short value, int* color)
+{
+    int red = (value >> 11) & 0x1f;
+    int green = (value >> 5) & 0x3f;
+    int blue = value & 0x1f;
+
+    // Scale up to 8 bits the same way as the decompressor
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+static int ColorDistance(const unsigned char* pixel, const int* color)
+{
+    int dr = pixel[0] - color[0];
+    int dg = pixel[1] - color[1];
+    int db = pixel[2] - color[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+static void CompressColorDXT(unsigned char* block, const unsigned char* rgba, bool isDxt1)
+{
+    // Transparent pixels in DXT1 need the 3-color mode, and do not contribute to the endpoints
+    bool transparent = false;
+    if (isDxt1)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            if (rgba[i * 4 + 3] < 128)
+                transparent = true;
+        }
+    }
+
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+        const unsigned char* pixel = &rgba[i * 4];
+        if (transparent && pixel[3] < 128)
+            continue;
+        for (int j = 0; j < 3; ++j)
+        {
+            minColor[j] = Min(minColor[j], (int)pixel[j]);
+            maxColor[j] = Max(maxColor[j], (int)pixel[j]);
+        }
+    }
+    if (minColor[0] > maxColor[0])
+    {
+        // Fully transparent block
+        for (int j = 0; j < 3; ++j)
+            minColor[j] = maxColor[j] = 0;
+    }
+
+    // Inset the bounding box by 1/16 of its size, as the extremes are represented by the endpoints exactly
+    for (int j = 0; j < 3; ++j)
+    {
+        int inset = (maxColor[j] - minColor[j]) >> 4;
+        minColor[j] += inset;
+        maxColor[j] -= inset;
+    }
+
+    unsigned short color0 = Pack565(maxColor);
+    unsigned short color1 = Pack565(minColor);
+    // Order the endpoints to select the 4-color mode, or the 3-color mode with transparency
+    if ((!transparent && color0 < color1) || (transparent && color0 > color1))
+        Swap(color0, color1);
+
+    int palette[4][3];
+    Unpack565(color0, palette[0]);
+    Unpack565(color1, palette[1]);
+    int numColors;
+    if (transparent)
+    {
+        for (int j = 0; j < 3; ++j)
+            palette[2][j] = (palette[0][j] + palette[1][j]) / 2;
+        numColors = 3;
+    }
+    else if (color0 == color1)
+        numColors = 1;
+    else
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+            palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+        }
+        numColors = 4;
+    }
+
+    unsigned indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        const unsigned char* pixel = &rgba[i * 4];
+        unsigned index = 0;
+        if (transparent && pixel[3] < 128)
+            index = 3;
+        else
+        {
+            int bestDistance = ColorDistance(pixel, palette[0]);
+            for (int j = 1; j < numColors; ++j)
+            {
+                int distance = ColorDistance(pixel, palette[j]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    index = (unsigned)j;
+                }
+            }
+        }
+        indices |= index << (i * 2);
+    }
+
+    block[0] = (unsigned char)(color0 & 0xff);
+    block[1] = (unsigned char)(color0 >> 8);
+    block[2] = (unsigned char)(color1 & 0xff);
+    block[3] = (unsigned char)(color1 >> 8);
+    for (int i = 0; i < 4; ++i)
+        block[4 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+static void CompressAlphaDXT3(unsigned char* block, const unsigned char* rgba)
+{
+    // Quantize to 4 bits, two pixels per byte
+    for (int i = 0; i < 8; ++i)
+    {
+        int lo = (rgba[i * 8 + 3] * 15 + 127) / 255;
+        int hi = (rgba[i * 8 + 7] * 15 + 127) / 255;
+        block[i] = (unsigned char)(lo | (hi << 4));
+    }
+}
+
+static void CompressAlphaDXT5(unsigned char* block, const unsigned char* rgba)
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        minAlpha = Min(minAlpha, (int)rgba[i * 4 + 3]);
+        maxAlpha = Max(maxAlpha, (int)rgba[i * 4 + 3]);
+    }
+
+    // Use the 8-alpha codebook, which requires the first endpoint to be larger
+    int codes[8];
+    codes[0] = maxAlpha;
+    codes[1] = minAlpha;
+    int numCodes = 1;
+    if (maxAlpha > minAlpha)
+    {
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = ((7 - i) * maxAlpha + i * minAlpha) / 7;
+        numCodes = 8;
+    }
+
+    unsigned long long indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int alpha = rgba[i * 4 + 3];
+        unsigned long long index = 0;
+        int bestDistance = Abs(alpha - codes[0]);
+        for (int j = 1; j < numCodes; ++j)
+        {
+            int distance = Abs(alpha - codes[j]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                index = (unsigned long long)j;
+            }
+        }
+        indices |= index << (i * 3);
+    }
+
+    block[0] = (unsigned char)maxAlpha;
+    block[1] = (unsigned char)minAlpha;
+    for (int i = 0; i < 6; ++i)
+        block[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+void CompressImageDXT(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat format)
+{
+    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+
+    for (int y = 0; y < height; y += 4)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            // Gather the block, repeating the edge pixels for partial blocks
+            unsigned char sourceRgba[4 * 16];
+            for (int py = 0; py < 4; ++py)
+            {
+                int sy = Min(y + py, height - 1);
+                for (int px = 0; px < 4; ++px)
+                {
+                    int sx = Min(x + px, width - 1);
+                    const unsigned char* sourcePixel = rgba + 4 * (width * sy + sx);
+                    unsigned char* targetPixel = sourceRgba + 4 * (py * 4 + px);
+                    for (int i = 0; i < 4; ++i)
+                        targetPixel[i] = sourcePixel[i];
+                }
+            }
+
+            if (format == CF_DXT1)
+                CompressColorDXT(blocks, sourceRgba, true);
+            else
+            {
+                if (format == CF_DXT3)
+                    CompressAlphaDXT3(blocks, sourceRgba);
+                else
+                    CompressAlphaDXT5(blocks, sourceRgba);
+                CompressColorDXT(blocks + 8, sourceRgba, false);
+            }
+
+            blocks += bytesPerBlock;
+        }
+    }
+}
+
+}
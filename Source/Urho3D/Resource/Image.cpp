@@ -24,9 +24,12 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Compress.h"
 #include "../Resource/Decompress.h"
 
 #include <SDL/SDL_surface.h>
@@ -39,6 +42,9 @@
 #include <webp/encode.h>
 #include <webp/mux.h>
 #endif
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 
 #include "../DebugNew.h"
 
@@ -757,17 +763,23 @@ bool Image::BeginLoad(Deserializer& source)
             return false;
         }
 
-        // Read the file to buffer.
+        // Read the file to buffer, or use a memory mapped package file directly
         size_t dataSize(source.GetSize());
-        SharedArrayPtr<uint8_t> data(new uint8_t[dataSize]);
-
-        memset(data.Get(), 0, sizeof(uint8_t) * dataSize);
-        source.Seek(0);
-        source.Read(data.Get(), dataSize);
+        SharedArrayPtr<uint8_t> dataBuffer;
+        auto* file = dynamic_cast<File*>(&source);
+        const uint8_t* data = file ? file->GetMappedData() : nullptr;
+        if (!data)
+        {
+            dataBuffer = new uint8_t[dataSize];
+            memset(dataBuffer.Get(), 0, sizeof(uint8_t) * dataSize);
+            source.Seek(0);
+            source.Read(dataBuffer.Get(), dataSize);
+            data = dataBuffer.Get();
+        }
 
         WebPBitstreamFeatures features;
 
-        if (WebPGetFeatures(data.Get(), dataSize, &features) != VP8_STATUS_OK)
+        if (WebPGetFeatures(data, dataSize, &features) != VP8_STATUS_OK)
         {
             URHO3D_LOGERROR("Error reading WebP image: " + source.GetName());
             return false;
@@ -779,11 +791,11 @@ bool Image::BeginLoad(Deserializer& source)
         bool decodeError(false);
         if (features.has_alpha)
         {
-            decodeError = WebPDecodeRGBAInto(data.Get(), dataSize, pixelData.Get(), imgSize, 4 * features.width) == nullptr;
+            decodeError = WebPDecodeRGBAInto(data, dataSize, pixelData.Get(), imgSize, 4 * features.width) == nullptr;
         }
         else
         {
-            decodeError = WebPDecodeRGBInto(data.Get(), dataSize, pixelData.Get(), imgSize, 3 * features.width) == nullptr;
+            decodeError = WebPDecodeRGBInto(data, dataSize, pixelData.Get(), imgSize, 3 * features.width) == nullptr;
         }
         if (decodeError)
         {
@@ -1125,63 +1137,6 @@ bool Image::FlipVertical()
     return true;
 }
 
-bool Image::Resize(int width, int height)
-{
-    URHO3D_PROFILE(ResizeImage);
-
-    if (IsCompressed())
-    {
-        URHO3D_LOGERROR("Resize not supported for compressed images");
-        return false;
-    }
-
-    if (depth_ > 1)
-    {
-        URHO3D_LOGERROR("Resize not supported for 3D images");
-        return false;
-    }
-
-    if (!data_ || width <= 0 || height <= 0)
-        return false;
-
-    /// \todo Reducing image size does not sample all needed pixels
-    SharedArrayPtr<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
-        {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
-            {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
-            }
-        }
-    }
-
-    width_ = width;
-    height_ = height;
-    data_ = newData;
-    SetMemoryUse(width * height * depth_ * components_);
-    return true;
-}
-
 void Image::Clear(const Color& color)
 {
     ClearInt(color.ToUInt());
@@ -1308,10 +1263,7 @@ bool Image::SaveDDS(const String& fileName) const
     }
 
     if (IsCompressed())
-    {
-        URHO3D_LOGERROR("Can not save compressed image to DDS");
-        return false;
-    }
+        return SaveCompressedDDS(outFile);
 
     if (components_ != 4)
     {
@@ -1348,6 +1300,57 @@ bool Image::SaveDDS(const String& fileName) const
     return true;
 }
 
+bool Image::SaveCompressedDDS(Serializer& dest) const
+{
+    unsigned fourCC;
+    switch (compressedFormat_)
+    {
+    case CF_DXT1:
+        fourCC = FOURCC_DXT1;
+        break;
+
+    case CF_DXT3:
+        fourCC = FOURCC_DXT3;
+        break;
+
+    case CF_DXT5:
+        fourCC = FOURCC_DXT5;
+        break;
+
+    default:
+        URHO3D_LOGERROR("Can not save image with this compressed format to DDS");
+        return false;
+    }
+
+    if (depth_ > 1 || cubemap_ || array_)
+    {
+        URHO3D_LOGERROR("Can not save compressed 3D, cube map or array image to DDS");
+        return false;
+    }
+
+    dest.WriteFileID("DDS ");
+
+    DDSurfaceDesc2 ddsd;        // NOLINT(hicpp-member-init)
+    memset(&ddsd, 0, sizeof(ddsd));
+    ddsd.dwSize_ = sizeof(ddsd);
+    ddsd.dwFlags_ = 0x00000001l /*DDSD_CAPS*/
+        | 0x00000002l /*DDSD_HEIGHT*/ | 0x00000004l /*DDSD_WIDTH*/ | 0x00020000l /*DDSD_MIPMAPCOUNT*/ | 0x00001000l /*DDSD_PIXELFORMAT*/
+        | 0x00080000l /*DDSD_LINEARSIZE*/;
+    ddsd.dwWidth_ = width_;
+    ddsd.dwHeight_ = height_;
+    ddsd.dwMipMapCount_ = numCompressedLevels_;
+    ddsd.dwLinearSize_ = GetCompressedLevel(0).dataSize_;
+    ddsd.ddpfPixelFormat_.dwFlags_ = 0x00000004l /*DDPF_FOURCC*/;
+    ddsd.ddpfPixelFormat_.dwSize_ = sizeof(ddsd.ddpfPixelFormat_);
+    ddsd.ddpfPixelFormat_.dwFourCC_ = fourCC;
+    ddsd.ddsCaps_.dwCaps_ = DDSCAPS_TEXTURE | (numCompressedLevels_ > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    dest.Write(&ddsd, sizeof(ddsd));
+    dest.Write(data_.Get(), GetMemoryUse());
+
+    return true;
+}
+
 bool Image::SaveWEBP(const String& fileName, float compression /* = 0.0f */) const
 {
 #ifdef URHO3D_WEBP
@@ -1558,6 +1561,708 @@ Color Image::GetPixelTrilinear(float x, float y, float z) const
     return colorNear.Lerp(colorFar, zF);
 }
 
+/// Minimum number of destination pixels before image processing is split into worker thread tasks.
+static const int MIN_PARALLEL_IMAGE_PIXELS = 256 * 256;
+
+/// Row range task of image processing.
+struct ImageRowTask
+{
+    /// Function to process the rows.
+    void (*function_)(void*, int, int);
+    /// Data for the function.
+    void* data_;
+    /// First row.
+    int start_;
+    /// Row after the last.
+    int end_;
+};
+
+static void ProcessImageRowsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* task = reinterpret_cast<ImageRowTask*>(item->aux_);
+    task->function_(task->data_, task->start_, task->end_);
+}
+
+/// Process rows of an image, splitting them among the worker threads when called from the main thread and the image is large enough.
+static void ProcessImageRows(Context* context, int numRows, int rowPixels, void (*function)(void*, int, int), void* data)
+{
+    auto* queue = context->GetSubsystem<WorkQueue>();
+    // Worker threads may be loading images in the background themselves, and the main thread may be completing
+    // other work, so only split the work when the main thread is free to wait for it
+    if (!queue || !queue->GetNumThreads() || queue->IsCompleting() || !Thread::IsMainThread() || numRows < 2 ||
+        numRows * rowPixels < MIN_PARALLEL_IMAGE_PIXELS)
+    {
+        function(data, 0, numRows);
+        return;
+    }
+
+    int numTasks = Min((int)queue->GetNumThreads() + 1, numRows); // Worker threads + main thread
+    int rowsPerTask = (numRows + numTasks - 1) / numTasks;
+    PODVector<ImageRowTask> tasks(numTasks);
+
+    for (int i = 0; i < numTasks; ++i)
+    {
+        ImageRowTask& task = tasks[i];
+        task.function_ = function;
+        task.data_ = data;
+        task.start_ = Min(i * rowsPerTask, numRows);
+        task.end_ = Min(task.start_ + rowsPerTask, numRows);
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = ProcessImageRowsWork;
+        item->name_ = "ProcessImageRowsWork";
+        item->aux_ = &task;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+/// Decompression task for a range of block rows of a compressed level.
+struct DecompressLevelTask
+{
+    /// Compressed level.
+    const CompressedLevel* level_;
+    /// Destination RGBA data.
+    unsigned char* dest_;
+};
+
+static void DecompressLevelRows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<DecompressLevelTask*>(data);
+    const CompressedLevel& level = *task->level_;
+
+    // Each block row decodes to 4 pixel rows
+    int startY = start * 4;
+    int height = Min(end * 4, level.height_) - startY;
+    unsigned char* dest = task->dest_ + startY * level.width_ * 4;
+    const unsigned char* source = level.data_ + start * level.rowSize_;
+
+    if (level.format_ == CF_ETC1)
+        DecompressImageETC(dest, source, level.width_, height);
+    else
+        DecompressImageDXT(dest, source, level.width_, height, 1, level.format_);
+}
+
+/// Compression task for a range of block rows of an image level.
+struct CompressLevelTask
+{
+    /// Source RGBA data.
+    const unsigned char* source_;
+    /// Destination blocks.
+    unsigned char* dest_;
+    /// Width.
+    int width_;
+    /// Height.
+    int height_;
+    /// Block row size in bytes.
+    unsigned rowSize_;
+    /// Compression format.
+    CompressedFormat format_;
+};
+
+static void CompressLevelRows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<CompressLevelTask*>(data);
+
+    // Each block row encodes 4 pixel rows
+    int startY = start * 4;
+    int height = Min(end * 4, task->height_) - startY;
+    CompressImageDXT(task->dest_ + start * task->rowSize_, task->source_ + startY * task->width_ * 4, task->width_, height,
+        task->format_);
+}
+
+/// Decompress a compressed level to RGBA, splitting the block rows among the worker threads when possible.
+static bool DecompressLevel(Context* context, CompressedLevel& level, unsigned char* dest)
+{
+    if (!level.data_)
+        return false;
+
+    if (level.format_ == CF_RGBA)
+    {
+        memcpy(dest, level.data_, level.dataSize_);
+        return true;
+    }
+
+    // PVRTC data is twiddled and 3D levels are stored slice by slice, so decompress them as a whole
+    if (level.depth_ > 1 || level.format_ >= CF_PVRTC_RGB_2BPP || level.format_ < CF_DXT1)
+        return level.Decompress(dest);
+
+    DecompressLevelTask task{&level, dest};
+    ProcessImageRows(context, level.rows_, level.width_ * 4, DecompressLevelRows, &task);
+    return true;
+}
+
+/// Mip level generation task for a range of 2D image rows.
+struct MipLevelTask
+{
+    /// Source pixel data.
+    const unsigned char* in_;
+    /// Destination pixel data.
+    unsigned char* out_;
+    /// Source width.
+    int widthIn_;
+    /// Destination width.
+    int widthOut_;
+    /// Number of color components.
+    unsigned components_;
+};
+
+static void CalculateMipLevelRows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<MipLevelTask*>(data);
+
+    switch (task->components_)
+    {
+    case 1:
+        for (int y = start; y < end; ++y)
+        {
+            const unsigned char* inUpper = &task->in_[(y * 2) * task->widthIn_];
+            const unsigned char* inLower = &task->in_[(y * 2 + 1) * task->widthIn_];
+            unsigned char* out = &task->out_[y * task->widthOut_];
+
+            for (int x = 0; x < task->widthOut_; ++x)
+            {
+                out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
+                                          inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
+            }
+        }
+        break;
+
+    case 2:
+        for (int y = start; y < end; ++y)
+        {
+            const unsigned char* inUpper = &task->in_[(y * 2) * task->widthIn_ * 2];
+            const unsigned char* inLower = &task->in_[(y * 2 + 1) * task->widthIn_ * 2];
+            unsigned char* out = &task->out_[y * task->widthOut_ * 2];
+
+            for (int x = 0; x < task->widthOut_ * 2; x += 2)
+            {
+                out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
+                                          inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
+                out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
+                                              inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
+            }
+        }
+        break;
+
+    case 3:
+        for (int y = start; y < end; ++y)
+        {
+            const unsigned char* inUpper = &task->in_[(y * 2) * task->widthIn_ * 3];
+            const unsigned char* inLower = &task->in_[(y * 2 + 1) * task->widthIn_ * 3];
+            unsigned char* out = &task->out_[y * task->widthOut_ * 3];
+
+            for (int x = 0; x < task->widthOut_ * 3; x += 3)
+            {
+                out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
+                                          inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
+                out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
+                                              inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
+                out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
+                                              inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
+            }
+        }
+        break;
+
+    case 4:
+        for (int y = start; y < end; ++y)
+        {
+            const unsigned char* inUpper = &task->in_[(y * 2) * task->widthIn_ * 4];
+            const unsigned char* inLower = &task->in_[(y * 2 + 1) * task->widthIn_ * 4];
+            unsigned char* out = &task->out_[y * task->widthOut_ * 4];
+            int x = 0;
+
+#ifdef URHO3D_SSE
+            // Filter two output pixels at a time, widening to 16 bits so that the result matches the scalar loop
+            __m128i zero = _mm_setzero_si128();
+            for (; x + 8 <= task->widthOut_ * 4; x += 8)
+            {
+                __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 2]));
+                __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 2]));
+                __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+                __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+                left = _mm_add_epi16(left, _mm_srli_si128(left, 8));
+                right = _mm_add_epi16(right, _mm_srli_si128(right, 8));
+                __m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(left, right), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(sum, sum));
+            }
+#endif
+
+            for (; x < task->widthOut_ * 4; x += 4)
+            {
+                out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
+                                          inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
+                out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
+                                              inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
+                out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
+                                              inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
+                out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
+                                              inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
+            }
+        }
+        break;
+
+    default:
+        assert(false);  // Should never reach here
+        break;
+    }
+}
+
+/// Filter taps of one destination row or column.
+struct ResampleTaps
+{
+    /// First source pixel.
+    int first_;
+    /// Number of source pixels.
+    int count_;
+    /// Index of the first weight.
+    unsigned weightStart_;
+};
+
+/// Return the filter support radius in source pixels when not reducing.
+static float GetResampleSupport(ResampleFilter filter)
+{
+    switch (filter)
+    {
+    case RESAMPLE_BOX:
+        return 0.5f;
+
+    case RESAMPLE_LANCZOS:
+        return 3.0f;
+
+    default:
+        return 1.0f;
+    }
+}
+
+/// Evaluate a resampling filter at a distance from the sample center.
+static float EvaluateResampleFilter(ResampleFilter filter, float t)
+{
+    t = Abs(t);
+    switch (filter)
+    {
+    case RESAMPLE_BOX:
+        return t < 0.5f ? 1.0f : 0.0f;
+
+    case RESAMPLE_LANCZOS:
+    {
+        if (t >= 3.0f)
+            return 0.0f;
+        if (t < M_EPSILON)
+            return 1.0f;
+        const float x = M_PI * t;
+        return 3.0f * sinf(x) * sinf(x / 3.0f) / (x * x);
+    }
+
+    default:
+        return t < 1.0f ? 1.0f - t : 0.0f;
+    }
+}
+
+/// Calculate the normalized filter weights of each destination pixel along one axis. When reducing, the filter is widened so that every source pixel contributes.
+static void CalculateResampleTaps(ResampleFilter filter, int sourceSize, int destSize, PODVector<ResampleTaps>& taps,
+    PODVector<float>& weights)
+{
+    const float scale = (float)sourceSize / (float)destSize;
+    const float filterScale = Max(scale, 1.0f);
+    const float support = GetResampleSupport(filter) * filterScale;
+
+    taps.Resize((unsigned)destSize);
+    weights.Clear();
+
+    for (int i = 0; i < destSize; ++i)
+    {
+        const float center = ((float)i + 0.5f) * scale - 0.5f;
+        int first = Max(CeilToInt(center - support), 0);
+        int last = Min(FloorToInt(center + support), sourceSize - 1);
+
+        // Leave out the zero weights at the ends of the range
+        while (first < last && EvaluateResampleFilter(filter, ((float)first - center) / filterScale) == 0.0f)
+            ++first;
+        while (last > first && EvaluateResampleFilter(filter, ((float)last - center) / filterScale) == 0.0f)
+            --last;
+
+        ResampleTaps& tap = taps[i];
+        tap.weightStart_ = weights.Size();
+
+        float total = 0.0f;
+        for (int j = first; j <= last; ++j)
+        {
+            const float weight = EvaluateResampleFilter(filter, ((float)j - center) / filterScale);
+            weights.Push(weight);
+            total += weight;
+        }
+
+        if (first > last || total == 0.0f)
+        {
+            // Fall back to the nearest pixel
+            first = last = Clamp(RoundToInt(center), 0, sourceSize - 1);
+            weights.Resize(tap.weightStart_);
+            weights.Push(1.0f);
+            total = 1.0f;
+        }
+
+        for (unsigned j = tap.weightStart_; j < weights.Size(); ++j)
+            weights[j] /= total;
+
+        tap.first_ = first;
+        tap.count_ = last - first + 1;
+    }
+}
+
+/// Resampling task for a range of destination rows.
+struct ResampleTask
+{
+    /// Source pixel data.
+    const unsigned char* in_;
+    /// Destination pixel data.
+    unsigned char* out_;
+    /// Source width.
+    int widthIn_;
+    /// Destination width.
+    int widthOut_;
+    /// Number of color components.
+    unsigned components_;
+    /// Horizontal filter taps.
+    const ResampleTaps* xTaps_;
+    /// Vertical filter taps.
+    const ResampleTaps* yTaps_;
+    /// Horizontal filter weights.
+    const float* xWeights_;
+    /// Vertical filter weights.
+    const float* yWeights_;
+    /// Maximum number of vertical taps.
+    int maxTapsY_;
+};
+
+/// Filter one source row horizontally to the destination width.
+static void ResampleRowHorizontal(const ResampleTask& task, const unsigned char* in, float* out)
+{
+    const unsigned components = task.components_;
+
+    for (int x = 0; x < task.widthOut_; ++x)
+    {
+        const ResampleTaps& tap = task.xTaps_[x];
+        const float* weights = task.xWeights_ + tap.weightStart_;
+        const unsigned char* src = in + tap.first_ * components;
+
+#ifdef URHO3D_SSE
+        // One RGBA pixel fits one vector
+        if (components == 4)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < tap.count_; ++k)
+            {
+                int value;
+                memcpy(&value, src + k * 4, sizeof value);
+                __m128i pixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+                pixel = _mm_unpacklo_epi16(pixel, zero);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set1_ps(weights[k])));
+            }
+            _mm_storeu_ps(out + x * 4, sum);
+            continue;
+        }
+#endif
+
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < tap.count_; ++k)
+        {
+            for (unsigned c = 0; c < components; ++c)
+                sum[c] += weights[k] * src[k * components + c];
+        }
+        for (unsigned c = 0; c < components; ++c)
+            out[x * components + c] = sum[c];
+    }
+}
+
+static void ResampleRows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<ResampleTask*>(data);
+    const int rowSize = task->widthOut_ * task->components_;
+    const int maxTaps = task->maxTapsY_;
+
+    // Horizontally filtered source rows are kept in a ring indexed by the source row, as the vertical windows of consecutive rows overlap
+    PODVector<float> cache((unsigned)(maxTaps * rowSize));
+    PODVector<int> cachedRows((unsigned)maxTaps);
+    for (int i = 0; i < maxTaps; ++i)
+        cachedRows[i] = -1;
+    PODVector<float> sum((unsigned)rowSize);
+
+    for (int y = start; y < end; ++y)
+    {
+        const ResampleTaps& tap = task->yTaps_[y];
+        const float* weights = task->yWeights_ + tap.weightStart_;
+
+        for (int i = 0; i < rowSize; ++i)
+            sum[i] = 0.0f;
+
+        for (int k = 0; k < tap.count_; ++k)
+        {
+            const int row = tap.first_ + k;
+            const int slot = row % maxTaps;
+            float* src = &cache[slot * rowSize];
+            if (cachedRows[slot] != row)
+            {
+                ResampleRowHorizontal(*task, task->in_ + row * task->widthIn_ * task->components_, src);
+                cachedRows[slot] = row;
+            }
+
+            const float weight = weights[k];
+            int i = 0;
+#ifdef URHO3D_SSE
+            const __m128 weightVec = _mm_set1_ps(weight);
+            for (; i + 4 <= rowSize; i += 4)
+                _mm_storeu_ps(&sum[i], _mm_add_ps(_mm_loadu_ps(&sum[i]), _mm_mul_ps(_mm_loadu_ps(src + i), weightVec)));
+#endif
+            for (; i < rowSize; ++i)
+                sum[i] += src[i] * weight;
+        }
+
+        // Round and clamp to bytes, as the Lanczos filter may overshoot
+        unsigned char* out = task->out_ + y * rowSize;
+        int i = 0;
+#ifdef URHO3D_SSE
+        for (; i + 4 <= rowSize; i += 4)
+        {
+            __m128i value = _mm_cvtps_epi32(_mm_loadu_ps(&sum[i]));
+            value = _mm_packs_epi32(value, value);
+            value = _mm_packus_epi16(value, value);
+            int packed = _mm_cvtsi128_si32(value);
+            memcpy(out + i, &packed, sizeof packed);
+        }
+#endif
+        for (; i < rowSize; ++i)
+            out[i] = (unsigned char)Clamp(RoundToInt(sum[i]), 0, 255);
+    }
+}
+
+/// Alpha premultiplication task for a range of RGBA image rows.
+struct PremultiplyAlphaTask
+{
+    /// Pixel data.
+    unsigned char* data_;
+    /// Width.
+    int width_;
+};
+
+static void PremultiplyAlphaRows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<PremultiplyAlphaTask*>(data);
+
+    for (int y = start; y < end; ++y)
+    {
+        unsigned char* pixels = task->data_ + y * task->width_ * 4;
+        int x = 0;
+
+#ifdef URHO3D_SSE
+        // Four pixels at a time in 16 bits. The alpha lanes are multiplied by 255 so that they stay unchanged
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        const __m128i alphaOne = _mm_and_si128(alphaMask, _mm_set1_epi16(255));
+        const __m128i half = _mm_set1_epi16(128);
+        for (; x + 4 <= task->width_; x += 4)
+        {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x * 4));
+            __m128i halves[2] = {_mm_unpacklo_epi8(value, zero), _mm_unpackhi_epi8(value, zero)};
+            for (__m128i& h : halves)
+            {
+                __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alpha = _mm_or_si128(_mm_andnot_si128(alphaMask, alpha), alphaOne);
+                // Divide by 255 with rounding as (t + (t >> 8)) >> 8, where t = c * a + 128
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(h, alpha), half);
+                h = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x * 4), _mm_packus_epi16(halves[0], halves[1]));
+        }
+#endif
+
+        for (; x < task->width_; ++x)
+        {
+            unsigned char* pixel = pixels + x * 4;
+            const unsigned alpha = pixel[3];
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                const unsigned t = pixel[c] * alpha + 128;
+                pixel[c] = (unsigned char)((t + (t >> 8)) >> 8);
+            }
+        }
+    }
+}
+
+/// RGBA conversion task for a range of image rows.
+struct ConvertToRGBATask
+{
+    /// Source pixel data.
+    const unsigned char* in_;
+    /// Destination RGBA data.
+    unsigned char* out_;
+    /// Width.
+    int width_;
+    /// Number of source color components.
+    unsigned components_;
+};
+
+static void ConvertToRGBARows(void* data, int start, int end)
+{
+    auto* task = reinterpret_cast<ConvertToRGBATask*>(data);
+    const int width = task->width_;
+
+    for (int y = start; y < end; ++y)
+    {
+        const unsigned char* src = task->in_ + y * width * task->components_;
+        unsigned char* dest = task->out_ + y * width * 4;
+        int x = 0;
+
+        switch (task->components_)
+        {
+        case 1:
+#ifdef URHO3D_SSE
+            // Interleave 16 gray values as gray-gray and gray-255 pairs
+            for (; x + 16 <= width; x += 16)
+            {
+                __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+                __m128i grayGray[2] = {_mm_unpacklo_epi8(gray, gray), _mm_unpackhi_epi8(gray, gray)};
+                __m128i grayAlpha[2] = {_mm_unpacklo_epi8(gray, _mm_set1_epi8(-1)), _mm_unpackhi_epi8(gray, _mm_set1_epi8(-1))};
+                auto* out = reinterpret_cast<__m128i*>(dest + x * 4);
+                for (unsigned i = 0; i < 2; ++i)
+                {
+                    _mm_storeu_si128(out + i * 2, _mm_unpacklo_epi16(grayGray[i], grayAlpha[i]));
+                    _mm_storeu_si128(out + i * 2 + 1, _mm_unpackhi_epi16(grayGray[i], grayAlpha[i]));
+                }
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                unsigned char pixel = src[x];
+                dest[x * 4] = pixel;
+                dest[x * 4 + 1] = pixel;
+                dest[x * 4 + 2] = pixel;
+                dest[x * 4 + 3] = 255;
+            }
+            break;
+
+        case 2:
+#ifdef URHO3D_SSE
+            // Each gray-alpha pair is already the upper half of the output pixel; the lower half repeats the gray
+            for (; x + 8 <= width; x += 8)
+            {
+                __m128i grayAlpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+                __m128i gray = _mm_and_si128(grayAlpha, _mm_set1_epi16(0xff));
+                __m128i grayGray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+                auto* out = reinterpret_cast<__m128i*>(dest + x * 4);
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(grayGray, grayAlpha));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(grayGray, grayAlpha));
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                unsigned char pixel = src[x * 2];
+                dest[x * 4] = pixel;
+                dest[x * 4 + 1] = pixel;
+                dest[x * 4 + 2] = pixel;
+                dest[x * 4 + 3] = src[x * 2 + 1];
+            }
+            break;
+
+        case 3:
+            for (; x < width; ++x)
+            {
+                dest[x * 4] = src[x * 3];
+                dest[x * 4 + 1] = src[x * 3 + 1];
+                dest[x * 4 + 2] = src[x * 3 + 2];
+                dest[x * 4 + 3] = 255;
+            }
+            break;
+
+        default:
+            assert(false);  // Should never reach here
+            break;
+        }
+    }
+}
+
+bool Image::Resize(int width, int height, ResampleFilter filter)
+{
+    URHO3D_PROFILE(ResizeImage);
+
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Resize not supported for compressed images");
+        return false;
+    }
+
+    if (depth_ > 1)
+    {
+        URHO3D_LOGERROR("Resize not supported for 3D images");
+        return false;
+    }
+
+    if (components_ < 1 || components_ > 4)
+    {
+        URHO3D_LOGERROR("Illegal number of image components for resize");
+        return false;
+    }
+
+    if (!data_ || width <= 0 || height <= 0)
+        return false;
+
+    PODVector<ResampleTaps> xTaps;
+    PODVector<ResampleTaps> yTaps;
+    PODVector<float> xWeights;
+    PODVector<float> yWeights;
+    CalculateResampleTaps(filter, width_, width, xTaps, xWeights);
+    CalculateResampleTaps(filter, height_, height, yTaps, yWeights);
+
+    SharedArrayPtr<unsigned char> newData(new unsigned char[width * height * components_]);
+
+    ResampleTask task;
+    task.in_ = data_.Get();
+    task.out_ = newData.Get();
+    task.widthIn_ = width_;
+    task.widthOut_ = width;
+    task.components_ = components_;
+    task.xTaps_ = &xTaps[0];
+    task.yTaps_ = &yTaps[0];
+    task.xWeights_ = &xWeights[0];
+    task.yWeights_ = &yWeights[0];
+    task.maxTapsY_ = 1;
+    for (unsigned i = 0; i < yTaps.Size(); ++i)
+        task.maxTapsY_ = Max(task.maxTapsY_, yTaps[i].count_);
+    ProcessImageRows(context_, height, width, ResampleRows, &task);
+
+    width_ = width;
+    height_ = height;
+    data_ = newData;
+    nextLevel_.Reset();
+    SetMemoryUse(width * height * depth_ * components_);
+    return true;
+}
+
+bool Image::PremultiplyAlpha()
+{
+    URHO3D_PROFILE(PremultiplyImageAlpha);
+
+    if (IsCompressed() || components_ != 4)
+    {
+        URHO3D_LOGERROR("Alpha premultiplication only supported for uncompressed RGBA images");
+        return false;
+    }
+
+    if (!data_)
+        return false;
+
+    PremultiplyAlphaTask task;
+    task.data_ = data_.Get();
+    task.width_ = width_;
+    ProcessImageRows(context_, height_ * depth_, width_, PremultiplyAlphaRows, &task);
+
+    nextLevel_.Reset();
+    return true;
+}
+
 SharedPtr<Image> Image::GetNextLevel() const
 {
     if (IsCompressed())
@@ -1646,84 +2351,8 @@ SharedPtr<Image> Image::GetNextLevel() const
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
-        {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+        MipLevelTask task{pixelDataIn, pixelDataOut, width_, widthOut, components_};
+        ProcessImageRows(context_, heightOut, widthOut, CalculateMipLevelRows, &task);
     }
     // 3D case
     else
@@ -1884,47 +2513,12 @@ SharedPtr<Image> Image::ConvertToRGBA() const
     SharedPtr<Image> ret(new Image(context_));
     ret->SetSize(width_, height_, depth_, 4);
 
-    const unsigned char* src = data_;
-    unsigned char* dest = ret->GetData();
-
-    switch (components_)
-    {
-    case 1:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = 255;
-        }
-        break;
-
-    case 2:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = *src++;
-        }
-        break;
-
-    case 3:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = 255;
-        }
-        break;
-
-    default:
-        assert(false);  // Should never reach nere
-        break;
-    }
+    ConvertToRGBATask task;
+    task.in_ = data_.Get();
+    task.out_ = ret->GetData();
+    task.width_ = width_;
+    task.components_ = components_;
+    ProcessImageRows(context_, height_ * depth_, width_, ConvertToRGBARows, &task);
 
     return ret;
 }
@@ -2259,6 +2853,122 @@ void Image::PrecalculateLevels()
     }
 }
 
+SharedPtr<Image> Image::GetDecompressedImage(unsigned firstLevel) const
+{
+    if (!IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is not compressed");
+        return SharedPtr<Image>();
+    }
+    if (firstLevel >= numCompressedLevels_)
+    {
+        URHO3D_LOGERROR("Compressed image mip level out of bounds");
+        return SharedPtr<Image>();
+    }
+
+    URHO3D_PROFILE(DecompressImage);
+
+    SharedPtr<Image> decompressed;
+    Image* previous = nullptr;
+
+    for (unsigned i = firstLevel; i < numCompressedLevels_; ++i)
+    {
+        CompressedLevel level = GetCompressedLevel(i);
+        SharedPtr<Image> levelImage(new Image(context_));
+        if (level.depth_ > 1)
+            levelImage->SetSize(level.width_, level.height_, level.depth_, 4);
+        else
+            levelImage->SetSize(level.width_, level.height_, 4);
+
+        if (!DecompressLevel(context_, level, levelImage->data_.Get()))
+        {
+            URHO3D_LOGERROR("Failed to decompress image " + GetName());
+            return SharedPtr<Image>();
+        }
+
+        if (previous)
+            previous->nextLevel_ = levelImage;
+        else
+            decompressed = levelImage;
+        previous = levelImage;
+    }
+
+    return decompressed;
+}
+
+SharedPtr<Image> Image::GetCompressedImage(CompressedFormat format) const
+{
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is already compressed");
+        return SharedPtr<Image>();
+    }
+    if (format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5)
+    {
+        URHO3D_LOGERROR("Unsupported image compression format");
+        return SharedPtr<Image>();
+    }
+    if (depth_ > 1)
+    {
+        URHO3D_LOGERROR("Can not compress 3D image");
+        return SharedPtr<Image>();
+    }
+    if (!data_)
+        return SharedPtr<Image>();
+
+    URHO3D_PROFILE(CompressImage);
+
+    // Gather the full mip chain in RGBA format, using the precalculated levels if available
+    Vector<SharedPtr<Image> > levelImages;
+    PODVector<const Image*> levels;
+    const Image* level = this;
+    if (components_ != 4)
+    {
+        levelImages.Push(ConvertToRGBA());
+        level = levelImages.Back();
+        if (!level)
+            return SharedPtr<Image>();
+    }
+    levels.Push(level);
+    while (level->width_ > 1 || level->height_ > 1)
+    {
+        levelImages.Push(level->GetNextLevel());
+        level = levelImages.Back();
+        if (!level)
+            return SharedPtr<Image>();
+        levels.Push(level);
+    }
+
+    unsigned blockSize = format == CF_DXT1 ? 8 : 16;
+    unsigned dataSize = 0;
+    for (unsigned i = 0; i < levels.Size(); ++i)
+        dataSize += ((levels[i]->width_ + 3) / 4) * ((levels[i]->height_ + 3) / 4) * blockSize;
+
+    SharedPtr<Image> compressed(new Image(context_));
+    compressed->data_ = new unsigned char[dataSize];
+    compressed->width_ = width_;
+    compressed->height_ = height_;
+    compressed->depth_ = 1;
+    compressed->components_ = format == CF_DXT1 ? 3 : 4;
+    compressed->compressedFormat_ = format;
+    compressed->numCompressedLevels_ = levels.Size();
+    compressed->sRGB_ = sRGB_;
+    compressed->SetMemoryUse(dataSize);
+
+    unsigned char* dest = compressed->data_.Get();
+    for (unsigned i = 0; i < levels.Size(); ++i)
+    {
+        const Image* source = levels[i];
+        int blockRows = (source->height_ + 3) / 4;
+        CompressLevelTask task{source->data_.Get(), dest, source->width_, source->height_,
+            ((source->width_ + 3) / 4) * blockSize, format};
+        ProcessImageRows(context_, blockRows, source->width_ * 4, CompressLevelRows, &task);
+        dest += blockRows * task.rowSize_;
+    }
+
+    return compressed;
+}
+
 void Image::CleanupLevels()
 {
     nextLevel_.Reset();
@@ -2290,6 +3000,16 @@ void Image::GetLevels(PODVector<const Image*>& levels) const
 
 unsigned char* Image::GetImageData(Deserializer& source, int& width, int& height, unsigned& components)
 {
+    // Decode directly from a memory mapped package file when possible
+    auto* file = dynamic_cast<File*>(&source);
+    if (file && file->GetMappedData())
+    {
+        unsigned position = file->GetPosition();
+        unsigned dataSize = file->GetSize() - position;
+        file->Seek(file->GetSize());
+        return stbi_load_from_memory(file->GetMappedData() + position, dataSize, &width, &height, (int*)&components, 0);
+    }
+
     unsigned dataSize = source.GetSize();
 
     SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
@@ -47,6 +47,17 @@ enum CompressedFormat
     CF_PVRTC_RGBA_4BPP,
 };
 
+/// Image resampling filter.
+enum ResampleFilter
+{
+    /// Tent filter. Widens to cover all source pixels when reducing.
+    RESAMPLE_BILINEAR = 0,
+    /// Box filter. Averages the covered source pixels when reducing and repeats the nearest when enlarging.
+    RESAMPLE_BOX,
+    /// Lanczos filter with three lobes. Sharpest, at the cost of some ringing near hard edges.
+    RESAMPLE_LANCZOS,
+};
+
 /// Compressed image mip level.
 struct CompressedLevel
 {
@@ -113,8 +124,10 @@ public:
     bool FlipHorizontal();
     /// Flip image vertically. Return true if successful.
     bool FlipVertical();
-    /// Resize image by bilinear resampling. Return true if successful.
-    bool Resize(int width, int height);
+    /// Resize image by resampling with a separable filter. The rows are split among the worker threads for large images. Return true if successful.
+    bool Resize(int width, int height, ResampleFilter filter = RESAMPLE_BILINEAR);
+    /// Multiply the color components by alpha. Only for uncompressed RGBA images. Return true if successful.
+    bool PremultiplyAlpha();
     /// Clear the image with a color.
     void Clear(const Color& color);
     /// Clear the image with an integer color. R component is in the 8 lowest bits.
@@ -127,7 +140,7 @@ public:
     bool SaveTGA(const String& fileName) const;
     /// Save in JPG format with specified quality. Return true if successful.
     bool SaveJPG(const String& fileName, int quality) const;
-    /// Save in DDS format. Only uncompressed RGBA images are supported. Return true if successful.
+    /// Save in DDS format. Uncompressed RGBA and 2D DXT compressed images are supported. Return true if successful.
     bool SaveDDS(const String& fileName) const;
     /// Save in WebP format with minimum (fastest) or specified compression. Return true if successful. Fails always if WebP support is not compiled in.
     bool SaveWEBP(const String& fileName, float compression = 0.0f) const;
@@ -187,8 +200,12 @@ public:
     Image* GetSubimage(const IntRect& rect) const;
     /// Return an SDL surface from the image, or null if failed. Only RGB images are supported. Specify rect to only return partial image. You must free the surface yourself.
     SDL_Surface* GetSDLSurface(const IntRect& rect = IntRect::ZERO) const;
-    /// Precalculate the mip levels. Used by asynchronous texture loading.
+    /// Precalculate the mip levels. Used by asynchronous texture loading. Large levels are split among the worker threads when called from the main thread.
     void PrecalculateLevels();
+    /// Return the compressed mip levels starting from the specified level decompressed to RGBA, with the rest of the levels stored as its precalculated mip levels. Large levels are decompressed in the worker threads when called from the main thread. Return null if failed.
+    SharedPtr<Image> GetDecompressedImage(unsigned firstLevel = 0) const;
+    /// Return the image and its full mip chain compressed to DXT1, DXT3 or DXT5 format. 3D images are not supported. Large levels are compressed in the worker threads when called from the main thread. Return null if failed.
+    SharedPtr<Image> GetCompressedImage(CompressedFormat format) const;
     /// Whether this texture has an alpha channel
     bool HasAlphaChannel() const;
     /// Copy contents of the image into the defined rect, scaling if necessary. This image should already be large enough to include the rect. Compressed and 3D images are not supported.
@@ -201,6 +218,8 @@ public:
     void GetLevels(PODVector<const Image*>& levels) const;
 
 private:
+    /// Save a DXT compressed image in DDS format.
+    bool SaveCompressedDDS(Serializer& dest) const;
     /// Decode an image using stb_image.
     static unsigned char* GetImageData(Deserializer& source, int& width, int& height, unsigned& components);
     /// Free an image file's pixel data.
@@ -111,6 +111,124 @@ static void ToJSONValue(JSONValue& jsonValue, const rapidjson::Value& rapidjsonV
     }
 }
 
+/// Identifier of the binary cooked JSON format.
+static const char* BINARY_JSON_ID = "UJSB";
+
+// Write JSON value in the binary cooked format.
+static void WriteBinaryValue(Serializer& dest, const JSONValue& jsonValue)
+{
+    dest.WriteUByte((unsigned char)jsonValue.GetValueType());
+
+    switch (jsonValue.GetValueType())
+    {
+    case JSON_BOOL:
+        dest.WriteBool(jsonValue.GetBool());
+        break;
+
+    case JSON_NUMBER:
+        dest.WriteUByte((unsigned char)jsonValue.GetNumberType());
+        if (jsonValue.GetNumberType() == JSONNT_INT)
+            dest.WriteInt(jsonValue.GetInt());
+        else if (jsonValue.GetNumberType() == JSONNT_UINT)
+            dest.WriteUInt(jsonValue.GetUInt());
+        else
+            dest.WriteDouble(jsonValue.GetDouble());
+        break;
+
+    case JSON_STRING:
+        dest.WriteString(jsonValue.GetString());
+        break;
+
+    case JSON_ARRAY:
+        {
+            const JSONArray& jsonArray = jsonValue.GetArray();
+            dest.WriteVLE(jsonArray.Size());
+            for (unsigned i = 0; i < jsonArray.Size(); ++i)
+                WriteBinaryValue(dest, jsonArray[i]);
+        }
+        break;
+
+    case JSON_OBJECT:
+        {
+            const JSONObject& jsonObject = jsonValue.GetObject();
+            dest.WriteVLE(jsonObject.Size());
+            for (JSONObject::ConstIterator i = jsonObject.Begin(); i != jsonObject.End(); ++i)
+            {
+                dest.WriteString(i->first_);
+                WriteBinaryValue(dest, i->second_);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Read JSON value in the binary cooked format. Return true if successful.
+static bool ReadBinaryValue(Deserializer& source, JSONValue& jsonValue)
+{
+    if (source.IsEof())
+        return false;
+
+    switch (source.ReadUByte())
+    {
+    case JSON_NULL:
+        jsonValue.SetType(JSON_NULL);
+        break;
+
+    case JSON_BOOL:
+        jsonValue = source.ReadBool();
+        break;
+
+    case JSON_NUMBER:
+        {
+            auto numberType = (JSONNumberType)source.ReadUByte();
+            if (numberType == JSONNT_INT)
+                jsonValue = source.ReadInt();
+            else if (numberType == JSONNT_UINT)
+                jsonValue = source.ReadUInt();
+            else
+                jsonValue = source.ReadDouble();
+        }
+        break;
+
+    case JSON_STRING:
+        jsonValue = source.ReadString();
+        break;
+
+    case JSON_ARRAY:
+        {
+            unsigned size = source.ReadVLE();
+            jsonValue.Resize(size);
+            for (unsigned i = 0; i < size; ++i)
+            {
+                if (!ReadBinaryValue(source, jsonValue[i]))
+                    return false;
+            }
+        }
+        break;
+
+    case JSON_OBJECT:
+        {
+            unsigned size = source.ReadVLE();
+            jsonValue.SetType(JSON_OBJECT);
+            for (unsigned i = 0; i < size; ++i)
+            {
+                String name = source.ReadString();
+                if (!ReadBinaryValue(source, jsonValue[name]))
+                    return false;
+            }
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
 bool JSONFile::BeginLoad(Deserializer& source)
 {
     unsigned dataSize = source.GetSize();
@@ -125,6 +243,21 @@ bool JSONFile::BeginLoad(Deserializer& source)
         return false;
     buffer[dataSize] = '\0';
 
+    // Binary cooked data is converted to JSON values directly, skipping rapidjson
+    if (dataSize >= 4 && !memcmp(buffer.Get(), BINARY_JSON_ID, 4))
+    {
+        MemoryBuffer binarySource(buffer.Get() + 4, dataSize - 4);
+        if (!ReadBinaryValue(binarySource, root_))
+        {
+            URHO3D_LOGERROR("Could not read binary JSON data from " + source.GetName());
+            root_.SetType(JSON_NULL);
+            return false;
+        }
+
+        SetMemoryUse(dataSize);
+        return true;
+    }
+
     rapidjson::Document document;
     if (document.Parse<kParseCommentsFlag | kParseTrailingCommasFlag>(buffer).HasParseError())
     {
@@ -229,6 +362,15 @@ bool JSONFile::Save(Serializer& dest, const String& indendation) const
     return dest.Write(buffer.GetString(), size) == size;
 }
 
+bool JSONFile::SaveBinary(Serializer& dest) const
+{
+    if (!dest.WriteFileID(BINARY_JSON_ID))
+        return false;
+
+    WriteBinaryValue(dest, root_);
+    return true;
+}
+
 bool JSONFile::FromString(const String & source)
 {
     if (source.Empty())
@@ -22,10 +22,12 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Resource/Localization.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/JSONFile.h"
 #include "../Resource/ResourceEvents.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
 
 #include "../DebugNew.h"
@@ -33,9 +35,26 @@
 namespace Urho3D
 {
 
+/// Binary string table header size: file ID and number of strings. It is followed by the entries sorted by string ID
+/// hash, each holding the hash and the offset of the zero-terminated UTF-8 string from the start of the file.
+static const unsigned TABLE_HEADER_SIZE = 8;
+/// Binary string table entry size.
+static const unsigned TABLE_ENTRY_SIZE = 8;
+
+static unsigned ReadTableUInt(const unsigned char* data)
+{
+    // The table may not be aligned within a package file
+    unsigned value;
+    memcpy(&value, data, sizeof value);
+    return value;
+}
+
 Localization::Localization(Context* context) :
     Object(context),
-    languageIndex_(-1)
+    languageIndex_(-1),
+    tableData_(nullptr),
+    tableSize_(0),
+    numTableEntries_(0)
 {
 }
 
@@ -100,6 +119,8 @@ void Localization::SetLanguage(int index)
     }
     if (index != languageIndex_)
     {
+        // Only the string table of the current language is kept loaded
+        ReleaseTable();
         languageIndex_ = index;
         VariantMap& eventData = GetEventDataMap();
         SendEvent(E_CHANGELANGUAGE, eventData);
@@ -136,13 +157,47 @@ String Localization::Get(const String& id)
         URHO3D_LOGWARNING("Localization::Get(id): no loaded languages");
         return id;
     }
-    String result = strings_[StringHash(GetLanguage())][StringHash(id)];
-    if (result.Empty())
+    const char* result = GetCString(StringHash(id));
+    if (!result || !*result)
     {
         URHO3D_LOGWARNING("Localization::Get(\"" + id + "\") not found translation, language=\"" + GetLanguage() + "\"");
         return id;
     }
-    return result;
+    return String(result);
+}
+
+const char* Localization::GetCString(StringHash id)
+{
+    if (languageIndex_ == -1)
+        return nullptr;
+
+    if (LoadTable())
+    {
+        // Binary search the entries sorted by hash
+        unsigned low = 0;
+        unsigned high = numTableEntries_;
+        while (low < high)
+        {
+            unsigned mid = (low + high) / 2;
+            const unsigned char* entry = tableData_ + TABLE_HEADER_SIZE + mid * TABLE_ENTRY_SIZE;
+            unsigned hash = ReadTableUInt(entry);
+            if (hash < id.Value())
+                low = mid + 1;
+            else if (hash > id.Value())
+                high = mid;
+            else
+            {
+                unsigned offset = ReadTableUInt(entry + 4);
+                return offset < tableSize_ ? (const char*)tableData_ + offset : nullptr;
+            }
+        }
+    }
+
+    HashMap<StringHash, HashMap<StringHash, String> >::ConstIterator i = strings_.Find(StringHash(languages_[languageIndex_]));
+    if (i == strings_.End())
+        return nullptr;
+    HashMap<StringHash, String>::ConstIterator j = i->second_.Find(id);
+    return j != i->second_.End() ? j->second_.CString() : nullptr;
 }
 
 void Localization::Reset()
@@ -150,6 +205,8 @@ void Localization::Reset()
     languages_.Clear();
     languageIndex_ = -1;
     strings_.Clear();
+    tableFiles_.Clear();
+    ReleaseTable();
 }
 
 void Localization::LoadJSONFile(const String& name, const String language)
@@ -251,4 +308,127 @@ void Localization::LoadSingleLanguageJSON(const JSONValue& source, const String&
     }
 }
 
+void Localization::LoadBinaryFile(const String& name, const String& language)
+{
+    if (language.Empty())
+    {
+        URHO3D_LOGWARNING("Localization::LoadBinaryFile(name, language): language name is empty");
+        return;
+    }
+
+    StringHash languageHash(language);
+    tableFiles_[languageHash] = name;
+    if (tableLanguage_ == languageHash)
+        ReleaseTable();
+    if (!languages_.Contains(language))
+        languages_.Push(language);
+    if (languageIndex_ == -1)
+        languageIndex_ = 0;
+}
+
+bool Localization::SaveBinaryFile(Serializer& dest, const String& language) const
+{
+    HashMap<StringHash, HashMap<StringHash, String> >::ConstIterator i = strings_.Find(StringHash(language));
+    if (i == strings_.End())
+    {
+        URHO3D_LOGERROR("Localization::SaveBinaryFile(dest, language): no strings loaded from JSON, language=\"" + language + "\"");
+        return false;
+    }
+
+    const HashMap<StringHash, String>& strings = i->second_;
+    PODVector<StringHash> ids;
+    ids.Reserve(strings.Size());
+    for (HashMap<StringHash, String>::ConstIterator j = strings.Begin(); j != strings.End(); ++j)
+        ids.Push(j->first_);
+    Sort(ids.Begin(), ids.End());
+
+    bool success = true;
+    success &= dest.WriteFileID("ULOC");
+    success &= dest.WriteUInt(ids.Size());
+
+    unsigned offset = TABLE_HEADER_SIZE + ids.Size() * TABLE_ENTRY_SIZE;
+    for (unsigned j = 0; j < ids.Size(); ++j)
+    {
+        success &= dest.WriteUInt(ids[j].Value());
+        success &= dest.WriteUInt(offset);
+        offset += strings.Find(ids[j])->second_.Length() + 1;
+    }
+    for (unsigned j = 0; j < ids.Size(); ++j)
+        success &= dest.WriteString(strings.Find(ids[j])->second_);
+
+    return success;
+}
+
+bool Localization::LoadTable()
+{
+    StringHash language(languages_[languageIndex_]);
+    if (tableData_ && tableLanguage_ == language)
+        return true;
+
+    HashMap<StringHash, String>::Iterator i = tableFiles_.Find(language);
+    if (i == tableFiles_.End())
+        return false;
+
+    ReleaseTable();
+
+    // Read the table through a memory mapping when possible, so that only the pages used are loaded
+    auto* cache = GetSubsystem<ResourceCache>();
+    SharedPtr<File> file = cache->GetFile(i->second_);
+    if (file && !file->IsPackaged() && !file->IsMemoryMapped())
+    {
+        SharedPtr<File> mappedFile(new File(context_));
+        if (mappedFile->OpenMapped(cache->GetResourceFileName(i->second_)))
+            file = mappedFile;
+    }
+
+    bool success = false;
+    if (file)
+    {
+        unsigned size = file->GetSize();
+        const unsigned char* data = file->GetMappedData();
+        if (!data)
+        {
+            tableBuffer_ = new unsigned char[size];
+            if (file->Read(tableBuffer_.Get(), size) == size)
+                data = tableBuffer_.Get();
+        }
+
+        // The last string must be terminated so that no string can run past the end
+        if (data && size >= TABLE_HEADER_SIZE && !memcmp(data, "ULOC", 4) && !data[size - 1])
+        {
+            unsigned numEntries = ReadTableUInt(data + 4);
+            if (numEntries <= (size - TABLE_HEADER_SIZE) / TABLE_ENTRY_SIZE)
+            {
+                if (file->GetMappedData())
+                    tableFile_ = file;
+                tableData_ = data;
+                tableSize_ = size;
+                numTableEntries_ = numEntries;
+                tableLanguage_ = language;
+                success = true;
+            }
+        }
+    }
+
+    if (!success)
+    {
+        URHO3D_LOGERROR("Localization: could not load string table " + i->second_ + ", language=\"" + languages_[languageIndex_] + "\"");
+        // Do not try again on every lookup
+        tableFiles_.Erase(i);
+        tableBuffer_.Reset();
+    }
+
+    return success;
+}
+
+void Localization::ReleaseTable()
+{
+    tableFile_.Reset();
+    tableBuffer_.Reset();
+    tableData_ = nullptr;
+    tableSize_ = 0;
+    numTableEntries_ = 0;
+    tableLanguage_ = StringHash();
+}
+
 }
@@ -22,13 +22,17 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
 #include "../Core/Context.h"
 #include "../Resource/JSONValue.h"
 
 namespace Urho3D
 {
 
-/// %Localization subsystem. Stores all the strings in all languages.
+class File;
+class Serializer;
+
+/// %Localization subsystem. Stores the strings of the languages loaded from JSON, and the string table of the current language for languages loaded from binary files.
 class URHO3D_API Localization : public Object
 {
     URHO3D_OBJECT(Localization, Object);
@@ -57,6 +61,8 @@ public:
     void SetLanguage(const String& language);
     /// Return a string in the current language. Returns String::EMPTY if id is empty. Returns id if translation is not found and logs a warning.
     String Get(const String& id);
+    /// Return a string in the current language without copying it, or null if not found. Remains valid until the language is changed or strings are loaded or cleared.
+    const char* GetCString(StringHash id);
     /// Clear all loaded strings.
     void Reset();
     /// Load strings from JSONFile. The file should be UTF8 without BOM.
@@ -65,14 +71,37 @@ public:
     void LoadMultipleLanguageJSON(const JSONValue& source);
     /// Load strings from JSONValue for specific language.
     void LoadSingleLanguageJSON(const JSONValue& source, const String& language = String::EMPTY);
+    /// Add a language whose strings are in a binary string table file. The file is read only when the language is used.
+    void LoadBinaryFile(const String& name, const String& language);
+    /// Save the strings of a language loaded from JSON as a binary string table. Return true if successful.
+    bool SaveBinaryFile(Serializer& dest, const String& language) const;
 
 private:
+    /// Load the string table of the current language if it is in a binary file. Return true if the language has a string table.
+    bool LoadTable();
+    /// Release the loaded string table.
+    void ReleaseTable();
+
     /// Language names.
     Vector<String> languages_;
     /// Index of current language.
     int languageIndex_;
     /// Storage strings: <Language <StringId, Value> >.
     HashMap<StringHash, HashMap<StringHash, String> > strings_;
+    /// Binary string table resource names by language.
+    HashMap<StringHash, String> tableFiles_;
+    /// Language of the loaded string table.
+    StringHash tableLanguage_;
+    /// File of the loaded string table, kept open when the table is read through a memory mapping.
+    SharedPtr<File> tableFile_;
+    /// Loaded string table contents when not memory mapped.
+    SharedArrayPtr<unsigned char> tableBuffer_;
+    /// Loaded string table data.
+    const unsigned char* tableData_;
+    /// Loaded string table size in bytes.
+    unsigned tableSize_;
+    /// Number of strings in the loaded string table.
+    unsigned numTableEntries_;
 };
 
 }
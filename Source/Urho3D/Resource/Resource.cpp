@@ -24,6 +24,7 @@
 
 #include "../Core/Profiler.h"
 #include "../IO/File.h"
+#include "../IO/LoadTiming.h"
 #include "../IO/Log.h"
 #include "../Resource/Resource.h"
 #include "../Resource/XMLElement.h"
@@ -36,6 +37,8 @@ Resource::Resource(Context* context) :
     memoryUse_(0),
     asyncLoadState_(ASYNC_DONE)
 {
+    // Resources are created and referenced on the background loading thread as well as the main thread
+    SetAtomicRefCount(true);
 }
 
 bool Resource::Load(Deserializer& source)
@@ -53,9 +56,16 @@ bool Resource::Load(Deserializer& source)
     // If we are loading synchronously in a non-main thread, behave as if async loading (for example use
     // GetTempResource() instead of GetResource() to load resource dependencies)
     SetAsyncLoadState(Thread::IsMainThread() ? ASYNC_DONE : ASYNC_LOADING);
-    bool success = BeginLoad(source);
+    bool success;
+    {
+        LoadStageTimer timer(LOADSTAGE_BEGINLOAD);
+        success = BeginLoad(source);
+    }
     if (success)
+    {
+        LoadStageTimer timer(LOADSTAGE_ENDLOAD);
         success &= EndLoad();
+    }
     SetAsyncLoadState(ASYNC_DONE);
 
 #ifdef URHO3D_PROFILING
@@ -24,7 +24,9 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/PerfCounters.h"
 #include "../Core/Profiler.h"
+#include "../Container/Sort.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/FileSystem.h"
 #include "../IO/FileWatcher.h"
@@ -67,22 +69,59 @@ static const char* checkDirs[] =
 
 static const SharedPtr<Resource> noResource;
 
+/// Load profiling totals of one resource type.
+struct LoadTypeTotals
+{
+    /// Resource type name.
+    String typeName_;
+    /// Number of loads.
+    unsigned count_{};
+    /// Bytes loaded.
+    unsigned long long size_{};
+    /// Time spent in each load stage.
+    LoadStageTimes times_;
+};
+
+static bool CompareLoadTypeTotals(const LoadTypeTotals& lhs, const LoadTypeTotals& rhs)
+{
+    return lhs.times_.GetTotal() > rhs.times_.GetTotal();
+}
+
+static bool CompareLoadRecords(const ResourceLoadRecord& lhs, const ResourceLoadRecord& rhs)
+{
+    return lhs.times_.GetTotal() > rhs.times_.GetTotal();
+}
+
+static void FormatLoadStageTimes(char* dest, const LoadStageTimes& times)
+{
+    sprintf(dest, "%8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %9.2f", times.usec_[LOADSTAGE_OPEN] / 1000.0,
+        times.usec_[LOADSTAGE_READ] / 1000.0, times.usec_[LOADSTAGE_DECOMPRESS] / 1000.0, times.usec_[LOADSTAGE_BEGINLOAD] / 1000.0,
+        times.usec_[LOADSTAGE_ENDLOAD] / 1000.0, times.usec_[LOADSTAGE_UPLOAD] / 1000.0, times.GetTotal() / 1000.0);
+}
+
 ResourceCache::ResourceCache(Context* context) :
     Object(context),
     autoReloadResources_(false),
     returnFailedResources_(false),
     searchPackagesFirst_(true),
+    memoryMappedPackages_(false),
+    resourceIndexEnabled_(false),
+    loadProfiling_(false),
     isRouting_(false),
     finishBackgroundResourcesMs_(5)
 {
     // Register Resource library object factories
-    RegisterResourceLibrary(context_);
+    context_->RegisterLibrary("Resource", RegisterResourceLibrary);
 
 #ifdef URHO3D_THREADING
     // Create resource background loader. Its thread will start on the first background request
     backgroundLoader_ = new BackgroundLoader(this);
 #endif
 
+    auto* perfCounters = GetSubsystem<PerfCounters>();
+    if (perfCounters)
+        missCounter_ = perfCounters->GetCounter("ResourceCacheMisses");
+
     // Subscribe BeginFrame for handling directory watchers and background loaded resource finalization
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(ResourceCache, HandleBeginFrame));
 }
@@ -120,6 +159,8 @@ bool ResourceCache::AddResourceDir(const String& pathName, unsigned priority)
         resourceDirs_.Insert(priority, fixedPath);
     else
         resourceDirs_.Push(fixedPath);
+    // Resource directory indices and search order have changed
+    resourceIndex_.Clear();
 
     // If resource auto-reloading active, create a file watcher for the directory
     if (autoReloadResources_)
@@ -144,10 +185,14 @@ bool ResourceCache::AddPackageFile(PackageFile* package, unsigned priority)
         return false;
     }
 
+    if (memoryMappedPackages_)
+        package->SetMemoryMapped(true);
+
     if (priority < packages_.Size())
         packages_.Insert(priority, SharedPtr<PackageFile>(package));
     else
         packages_.Push(SharedPtr<PackageFile>(package));
+    resourceIndex_.Clear();
 
     URHO3D_LOGINFO("Added resource package " + package->GetName());
     return true;
@@ -191,6 +236,7 @@ void ResourceCache::RemoveResourceDir(const String& pathName)
         if (!resourceDirs_[i].Compare(fixedPath, false))
         {
             resourceDirs_.Erase(i);
+            resourceIndex_.Clear();
             // Remove the filewatcher with the matching path
             for (unsigned j = 0; j < fileWatchers_.Size(); ++j)
             {
@@ -218,6 +264,7 @@ void ResourceCache::RemovePackageFile(PackageFile* package, bool releaseResource
                 ReleasePackageResources(*i, forceRelease);
             URHO3D_LOGINFO("Removed resource package " + (*i)->GetName());
             packages_.Erase(i);
+            resourceIndex_.Clear();
             return;
         }
     }
@@ -238,6 +285,7 @@ void ResourceCache::RemovePackageFile(const String& fileName, bool releaseResour
                 ReleasePackageResources(*i, forceRelease);
             URHO3D_LOGINFO("Removed resource package " + (*i)->GetName());
             packages_.Erase(i);
+            resourceIndex_.Clear();
             return;
         }
     }
@@ -265,10 +313,10 @@ void ResourceCache::ReleaseResources(StringHash type, bool force)
     HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End();)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
+            FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
             // If other references exist, do not release, unless forced
             if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
             {
@@ -289,10 +337,10 @@ void ResourceCache::ReleaseResources(StringHash type, const String& partialName,
     HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End();)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
+            FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
             if (current->second_->GetName().Contains(partialName))
             {
                 // If other references exist, do not release, unless forced
@@ -320,10 +368,10 @@ void ResourceCache::ReleaseResources(const String& partialName, bool force)
 
         for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
         {
-            for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+            for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
                  j != i->second_.resources_.End();)
             {
-                HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
+                FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
                 if (current->second_->GetName().Contains(partialName))
                 {
                     // If other references exist, do not release, unless forced
@@ -351,10 +399,10 @@ void ResourceCache::ReleaseAllResources(bool force)
         for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin();
              i != resourceGroups_.End(); ++i)
         {
-            for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+            for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
                  j != i->second_.resources_.End();)
             {
-                HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
+                FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
                 // If other references exist, do not release, unless forced
                 if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
                 {
@@ -438,6 +486,26 @@ void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
     resourceGroups_[type].memoryBudget_ = budget;
 }
 
+void ResourceCache::SetMemoryMappedPackages(bool enable)
+{
+    MutexLock lock(resourceMutex_);
+
+    memoryMappedPackages_ = enable;
+    for (Vector<SharedPtr<PackageFile> >::Iterator i = packages_.Begin(); i != packages_.End(); ++i)
+        (*i)->SetMemoryMapped(enable);
+}
+
+void ResourceCache::SetSearchPackagesFirst(bool value)
+{
+    MutexLock lock(resourceMutex_);
+
+    if (value != searchPackagesFirst_)
+    {
+        searchPackagesFirst_ = value;
+        resourceIndex_.Clear();
+    }
+}
+
 void ResourceCache::SetAutoReloadResources(bool enable)
 {
     if (enable != autoReloadResources_)
@@ -487,6 +555,7 @@ void ResourceCache::RemoveResourceRouter(ResourceRouter* router)
 
 SharedPtr<File> ResourceCache::GetFile(const String& name, bool sendEventOnFailure)
 {
+    LoadStageTimer timer(LOADSTAGE_OPEN);
     MutexLock lock(resourceMutex_);
 
     String sanitatedName = SanitateResourceName(name);
@@ -500,9 +569,11 @@ SharedPtr<File> ResourceCache::GetFile(const String& name, bool sendEventOnFailu
 
     if (sanitatedName.Length())
     {
-        File* file = nullptr;
+        File* file = resourceIndexEnabled_ ? SearchResourceIndex(sanitatedName) : nullptr;
 
-        if (searchPackagesFirst_)
+        if (file)
+            return SharedPtr<File>(file);
+        else if (searchPackagesFirst_)
         {
             file = SearchPackages(sanitatedName);
             if (!file)
@@ -584,6 +655,9 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     if (existing)
         return existing;
 
+    if (missCounter_)
+        missCounter_->Add();
+
     SharedPtr<Resource> resource;
     // Make sure the pointer is non-null and is a Resource subclass
     resource = DynamicCast<Resource>(context_->CreateObject(type));
@@ -604,6 +678,8 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     }
 
     // Attempt to load the resource
+    LoadStageTimes loadTimes;
+    LoadTimingScope loadTiming(loadProfiling_ ? &loadTimes : nullptr);
     SharedPtr<File> file = GetFile(sanitatedName, sendEventOnFailure);
     if (!file)
         return nullptr;   // Error is already logged
@@ -611,7 +687,10 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     URHO3D_LOGDEBUG("Loading resource " + sanitatedName);
     resource->SetName(sanitatedName);
 
-    if (!resource->Load(*(file.Get())))
+    bool success = resource->Load(*(file.Get()));
+    AddLoadRecord(resource, file->GetSize(), loadTimes, false, success);
+
+    if (!success)
     {
         // Error should already been logged by corresponding resource descendant class
         if (sendEventOnFailure)
@@ -683,6 +762,8 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String
     }
 
     // Attempt to load the resource
+    LoadStageTimes loadTimes;
+    LoadTimingScope loadTiming(loadProfiling_ ? &loadTimes : nullptr);
     SharedPtr<File> file = GetFile(sanitatedName, sendEventOnFailure);
     if (!file)
         return SharedPtr<Resource>();  // Error is already logged
@@ -690,7 +771,10 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String
     URHO3D_LOGDEBUG("Loading temporary resource " + sanitatedName);
     resource->SetName(file->GetName());
 
-    if (!resource->Load(*(file.Get())))
+    bool success = resource->Load(*(file.Get()));
+    AddLoadRecord(resource, file->GetSize(), loadTimes, false, success);
+
+    if (!success)
     {
         // Error should already been logged by corresponding resource descendant class
         if (sendEventOnFailure)
@@ -708,6 +792,209 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String
     return resource;
 }
 
+void ResourceCache::SetBackgroundLoadThreads(unsigned num)
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(num);
+#endif
+}
+
+unsigned ResourceCache::GetBackgroundLoadThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumThreads();
+#else
+    return 0;
+#endif
+}
+
+void ResourceCache::SetResourceIndex(bool enable)
+{
+    MutexLock lock(resourceMutex_);
+
+    resourceIndexEnabled_ = enable;
+    if (!enable)
+        resourceIndex_.Clear();
+}
+
+void ResourceCache::BuildResourceIndex()
+{
+    URHO3D_PROFILE(BuildResourceIndex);
+
+    MutexLock lock(resourceMutex_);
+
+    resourceIndexEnabled_ = true;
+    resourceIndex_.Clear();
+
+    // Insert in reverse search order, so that the locations searched first override the others
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        if ((pass == 0) == searchPackagesFirst_)
+        {
+            for (unsigned i = resourceDirs_.Size() - 1; i < resourceDirs_.Size(); --i)
+            {
+                Vector<String> fileNames;
+                fileSystem->ScanDir(fileNames, resourceDirs_[i], "*", SCAN_FILES, true);
+                for (unsigned j = 0; j < fileNames.Size(); ++j)
+                    resourceIndex_[StringHash(fileNames[j])] = ResourceLocation(i, false);
+            }
+        }
+        else
+        {
+            for (unsigned i = packages_.Size() - 1; i < packages_.Size(); --i)
+            {
+                const HashMap<String, PackageEntry>& entries = packages_[i]->GetEntries();
+                for (HashMap<String, PackageEntry>::ConstIterator j = entries.Begin(); j != entries.End(); ++j)
+                    resourceIndex_[StringHash(j->first_)] = ResourceLocation(i, true);
+            }
+        }
+    }
+
+    URHO3D_LOGINFO("Built resource index with " + String(resourceIndex_.Size()) + " entries");
+}
+
+void ResourceCache::ClearResourceIndex()
+{
+    MutexLock lock(resourceMutex_);
+
+    resourceIndex_.Clear();
+}
+
+bool ResourceCache::SaveResourceIndex(const String& fileName) const
+{
+    MutexLock lock(resourceMutex_);
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+
+    // Store the directory and package names so that the index can be matched against the setup when loading
+    file.WriteFileID("URIX");
+    file.WriteVLE(resourceDirs_.Size());
+    for (unsigned i = 0; i < resourceDirs_.Size(); ++i)
+        file.WriteString(resourceDirs_[i]);
+    file.WriteVLE(packages_.Size());
+    for (unsigned i = 0; i < packages_.Size(); ++i)
+        file.WriteString(packages_[i]->GetName());
+
+    file.WriteVLE(resourceIndex_.Size());
+    for (HashMap<StringHash, ResourceLocation>::ConstIterator i = resourceIndex_.Begin(); i != resourceIndex_.End(); ++i)
+    {
+        file.WriteStringHash(i->first_);
+        file.WriteBool(i->second_.package_);
+        file.WriteVLE(i->second_.index_);
+    }
+
+    return true;
+}
+
+bool ResourceCache::LoadResourceIndex(const String& fileName)
+{
+    MutexLock lock(resourceMutex_);
+
+    File file(context_);
+    if (!file.Open(fileName))
+        return false;
+
+    if (file.ReadFileID() != "URIX")
+    {
+        URHO3D_LOGERROR(fileName + " is not a valid resource index file");
+        return false;
+    }
+
+    // Map the stored directories and packages to the current ones
+    PODVector<unsigned> dirMapping(file.ReadVLE());
+    for (unsigned i = 0; i < dirMapping.Size(); ++i)
+    {
+        String dirName = file.ReadString();
+        dirMapping[i] = M_MAX_UNSIGNED;
+        for (unsigned j = 0; j < resourceDirs_.Size(); ++j)
+        {
+            if (!resourceDirs_[j].Compare(dirName, false))
+            {
+                dirMapping[i] = j;
+                break;
+            }
+        }
+    }
+    PODVector<unsigned> packageMapping(file.ReadVLE());
+    for (unsigned i = 0; i < packageMapping.Size(); ++i)
+    {
+        String packageName = file.ReadString();
+        packageMapping[i] = M_MAX_UNSIGNED;
+        for (unsigned j = 0; j < packages_.Size(); ++j)
+        {
+            if (packages_[j]->GetName() == packageName)
+            {
+                packageMapping[i] = j;
+                break;
+            }
+        }
+    }
+
+    resourceIndexEnabled_ = true;
+    resourceIndex_.Clear();
+
+    unsigned numEntries = file.ReadVLE();
+    for (unsigned i = 0; i < numEntries && !file.IsEof(); ++i)
+    {
+        StringHash nameHash = file.ReadStringHash();
+        bool package = file.ReadBool();
+        unsigned index = file.ReadVLE();
+
+        const PODVector<unsigned>& mapping = package ? packageMapping : dirMapping;
+        if (index < mapping.Size() && mapping[index] != M_MAX_UNSIGNED)
+            resourceIndex_[nameHash] = ResourceLocation(mapping[index], package);
+    }
+
+    return true;
+}
+
+void ResourceCache::SetLoadProfiling(bool enable)
+{
+    if (enable && !loadProfiling_)
+        ClearLoadRecords();
+
+    loadProfiling_ = enable;
+}
+
+void ResourceCache::ClearLoadRecords()
+{
+    MutexLock lock(loadRecordMutex_);
+    loadRecords_.Clear();
+}
+
+void ResourceCache::AddLoadRecord(Resource* resource, unsigned size, const LoadStageTimes& times, bool background, bool success)
+{
+    if (!loadProfiling_ || !resource)
+        return;
+
+    ResourceLoadRecord record;
+    record.type_ = resource->GetType();
+    record.typeName_ = resource->GetTypeName();
+    record.name_ = resource->GetName();
+    record.size_ = size;
+    record.times_ = times;
+    record.background_ = background;
+    record.success_ = success;
+
+    MutexLock lock(loadRecordMutex_);
+    loadRecords_.Push(record);
+}
+
+bool ResourceCache::SaveLoadList(Serializer& dest) const
+{
+    Vector<ResourceLoadRecord> records = GetLoadRecords();
+    for (unsigned i = 0; i < records.Size(); ++i)
+    {
+        if (!dest.WriteLine(records[i].typeName_ + " " + records[i].name_))
+            return false;
+    }
+
+    return true;
+}
+
 unsigned ResourceCache::GetNumBackgroundLoadResources() const
 {
 #ifdef URHO3D_THREADING
@@ -723,7 +1010,7 @@ void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type)
     HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End(); ++j)
             result.Push(j->second_);
     }
@@ -745,13 +1032,26 @@ bool ResourceCache::Exists(const String& name) const
     if (sanitatedName.Empty())
         return false;
 
+    auto* fileSystem = GetSubsystem<FileSystem>();
+
+    if (resourceIndexEnabled_)
+    {
+        HashMap<StringHash, ResourceLocation>::ConstIterator i = resourceIndex_.Find(StringHash(sanitatedName));
+        if (i != resourceIndex_.End())
+        {
+            const ResourceLocation& location = i->second_;
+            if (location.package_ ? (location.index_ < packages_.Size() && packages_[location.index_]->Exists(sanitatedName)) :
+                (location.index_ < resourceDirs_.Size() && fileSystem->FileExists(resourceDirs_[location.index_] + sanitatedName)))
+                return true;
+        }
+    }
+
     for (unsigned i = 0; i < packages_.Size(); ++i)
     {
         if (packages_[i]->Exists(sanitatedName))
             return true;
     }
 
-    auto* fileSystem = GetSubsystem<FileSystem>();
     for (unsigned i = 0; i < resourceDirs_.Size(); ++i)
     {
         if (fileSystem->FileExists(resourceDirs_[i] + sanitatedName))
@@ -932,7 +1232,7 @@ String ResourceCache::PrintMemoryUsage() const
         else
             average = 0;
         unsigned long long largest = 0;
-        for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator resIt = cit->second_.resources_.Begin(); resIt != cit->second_.resources_.End(); ++resIt)
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator resIt = cit->second_.resources_.Begin(); resIt != cit->second_.resources_.End(); ++resIt)
         {
             if (resIt->second_->GetMemoryUse() > largest)
                 largest = resIt->second_->GetMemoryUse();
@@ -972,6 +1272,72 @@ String ResourceCache::PrintMemoryUsage() const
     return output;
 }
 
+Vector<ResourceLoadRecord> ResourceCache::GetLoadRecords() const
+{
+    MutexLock lock(loadRecordMutex_);
+    return loadRecords_;
+}
+
+String ResourceCache::GetLoadProfileReport(unsigned maxResources) const
+{
+    Vector<ResourceLoadRecord> records = GetLoadRecords();
+
+    HashMap<StringHash, LoadTypeTotals> typeTotals;
+    LoadTypeTotals allTotals;
+    allTotals.typeName_ = "All";
+    for (unsigned i = 0; i < records.Size(); ++i)
+    {
+        const ResourceLoadRecord& record = records[i];
+        LoadTypeTotals& totals = typeTotals[record.type_];
+        totals.typeName_ = record.typeName_;
+        ++totals.count_;
+        totals.size_ += record.size_;
+        totals.times_.Accumulate(record.times_);
+        ++allTotals.count_;
+        allTotals.size_ += record.size_;
+        allTotals.times_.Accumulate(record.times_);
+    }
+
+    Vector<LoadTypeTotals> sortedTotals = typeTotals.Values();
+    Sort(sortedTotals.Begin(), sortedTotals.End(), CompareLoadTypeTotals);
+    sortedTotals.Push(allTotals);
+
+    String output = "Resource Type                 Cnt      Size     Open     Read   Decomp    Begin      End   Upload  Total ms\n\n";
+    char times[256];
+    char outputLine[512];
+
+    for (unsigned i = 0; i < sortedTotals.Size(); ++i)
+    {
+        const LoadTypeTotals& totals = sortedTotals[i];
+        FormatLoadStageTimes(times, totals.times_);
+        sprintf(outputLine, "%-28s %4u %9s %s\n", totals.typeName_.CString(), totals.count_, GetFileSizeString(totals.size_).CString(),
+            times);
+        output += ((const char*)outputLine);
+    }
+
+    Sort(records.Begin(), records.End(), CompareLoadRecords);
+    if (records.Size() > maxResources)
+        records.Resize(maxResources);
+
+    output += "\nResource (* failed)                          Size     Open     Read   Decomp    Begin      End   Upload  Total ms\n\n";
+    for (unsigned i = 0; i < records.Size(); ++i)
+    {
+        const ResourceLoadRecord& record = records[i];
+        // Keep the end of long names, as it identifies the resource best
+        String name = record.name_;
+        if (name.Length() > 38)
+            name = "..." + name.Substring(name.Length() - 35);
+        if (!record.success_)
+            name += " *";
+
+        FormatLoadStageTimes(times, record.times_);
+        sprintf(outputLine, "%-40s %9s %s\n", name.CString(), GetFileSizeString(record.size_).CString(), times);
+        output += ((const char*)outputLine);
+    }
+
+    return output;
+}
+
 const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHash nameHash)
 {
     MutexLock lock(resourceMutex_);
@@ -979,7 +1345,7 @@ const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHa
     HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i == resourceGroups_.End())
         return noResource;
-    HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
+    FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
     if (j == i->second_.resources_.End())
         return noResource;
 
@@ -992,7 +1358,7 @@ const SharedPtr<Resource>& ResourceCache::FindResource(StringHash nameHash)
 
     for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
     {
-        HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
+        FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
         if (j != i->second_.resources_.End())
             return j->second_;
     }
@@ -1012,7 +1378,7 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
         // We do not know the actual resource type, so search all type containers
         for (HashMap<StringHash, ResourceGroup>::Iterator j = resourceGroups_.Begin(); j != resourceGroups_.End(); ++j)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator k = j->second_.resources_.Find(nameHash);
+            FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator k = j->second_.resources_.Find(nameHash);
             if (k != j->second_.resources_.End())
             {
                 // If other references exist, do not release, unless forced
@@ -1040,9 +1406,9 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     {
         unsigned totalSize = 0;
         unsigned oldestTimer = 0;
-        HashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = i->second_.resources_.End();
+        FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = i->second_.resources_.End();
 
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End(); ++j)
         {
             totalSize += j->second_->GetMemoryUse();
@@ -1070,21 +1436,80 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     }
 }
 
+void ResourceCache::ReloadChangedResources(const Vector<String>& fileNames)
+{
+    // The files may have been added to a directory searched before the indexed location
+    if (resourceIndexEnabled_)
+    {
+        MutexLock lock(resourceMutex_);
+        for (unsigned i = 0; i < fileNames.Size(); ++i)
+            resourceIndex_.Erase(StringHash(fileNames[i]));
+    }
+
+    // Reload once per dependency root. A changed file depending on another changed file is reloaded with it
+    HashSet<StringHash> dependents;
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+        GetReloadedDependents(StringHash(fileNames[i]), dependents);
+
+    HashSet<StringHash> reloaded;
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+    {
+        StringHash fileNameHash(fileNames[i]);
+        if (!dependents.Contains(fileNameHash))
+        {
+            reloaded.Insert(fileNameHash);
+            GetReloadedDependents(fileNameHash, reloaded);
+            ReloadResourceWithDependencies(fileNames[i]);
+        }
+    }
+
+    // Files depending on each other in a cycle have no root
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+    {
+        StringHash fileNameHash(fileNames[i]);
+        if (!reloaded.Contains(fileNameHash))
+        {
+            reloaded.Insert(fileNameHash);
+            GetReloadedDependents(fileNameHash, reloaded);
+            ReloadResourceWithDependencies(fileNames[i]);
+        }
+    }
+}
+
+void ResourceCache::GetReloadedDependents(StringHash fileNameHash, HashSet<StringHash>& dest)
+{
+    // Follows the rules of ReloadResourceWithDependencies()
+    const SharedPtr<Resource>& resource = FindResource(fileNameHash);
+    if (resource && GetExtension(resource->GetName()) != ".xml")
+        return;
+
+    HashMap<StringHash, HashSet<StringHash> >::ConstIterator i = dependentResources_.Find(fileNameHash);
+    if (i != dependentResources_.End())
+    {
+        for (HashSet<StringHash>::ConstIterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+            dest.Insert(*j);
+    }
+}
+
 void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     for (unsigned i = 0; i < fileWatchers_.Size(); ++i)
     {
-        String fileName;
-        while (fileWatchers_[i]->GetNextChange(fileName))
-        {
-            ReloadResourceWithDependencies(fileName);
+        // Files are reloaded in batches once they have settled, instead of each time a file changes
+        Vector<String> fileNames;
+        if (!fileWatchers_[i]->GetChanges(fileNames))
+            continue;
 
-            // Finally send a general file changed event even if the file was not a tracked resource
-            using namespace FileChanged;
+        ReloadChangedResources(fileNames);
 
+        // Finally send a general file changed event even if the file was not a tracked resource
+        using namespace FileChanged;
+
+        for (unsigned j = 0; j < fileNames.Size(); ++j)
+        {
             VariantMap& eventData = GetEventDataMap();
-            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + fileName;
-            eventData[P_RESOURCENAME] = fileName;
+            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + fileNames[j];
+            eventData[P_RESOURCENAME] = fileNames[j];
             SendEvent(E_FILECHANGED, eventData);
         }
     }
@@ -1109,6 +1534,8 @@ File* ResourceCache::SearchResourceDirs(const String& name)
             // so that the file's sanitatedName can be used in further GetFile() calls (for example over the network)
             File* file(new File(context_, resourceDirs_[i] + name));
             file->SetName(name);
+            if (resourceIndexEnabled_)
+                resourceIndex_[StringHash(name)] = ResourceLocation(i, false);
             return file;
         }
     }
@@ -1125,9 +1552,41 @@ File* ResourceCache::SearchPackages(const String& name)
     for (unsigned i = 0; i < packages_.Size(); ++i)
     {
         if (packages_[i]->Exists(name))
+        {
+            if (resourceIndexEnabled_)
+                resourceIndex_[StringHash(name)] = ResourceLocation(i, true);
             return new File(context_, packages_[i], name);
+        }
+    }
+
+    return nullptr;
+}
+
+File* ResourceCache::SearchResourceIndex(const String& name)
+{
+    HashMap<StringHash, ResourceLocation>::Iterator i = resourceIndex_.Find(StringHash(name));
+    if (i == resourceIndex_.End())
+        return nullptr;
+
+    // Verify the location, as the file may have been removed, or the entry may be for another name with the same hash
+    const ResourceLocation& location = i->second_;
+    if (location.package_)
+    {
+        if (location.index_ < packages_.Size() && packages_[location.index_]->Exists(name))
+            return new File(context_, packages_[location.index_], name);
+    }
+    else if (location.index_ < resourceDirs_.Size())
+    {
+        const String& resourceDir = resourceDirs_[location.index_];
+        if (GetSubsystem<FileSystem>()->FileExists(resourceDir + name))
+        {
+            File* file(new File(context_, resourceDir + name));
+            file->SetName(name);
+            return file;
+        }
     }
 
+    resourceIndex_.Erase(i);
     return nullptr;
 }
 
@@ -22,10 +22,12 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../IO/File.h"
+#include "../IO/LoadTiming.h"
 #include "../Resource/Resource.h"
 
 namespace Urho3D
@@ -34,6 +36,8 @@ namespace Urho3D
 class BackgroundLoader;
 class FileWatcher;
 class PackageFile;
+class PerfCounter;
+class Serializer;
 
 /// Sets to priority so that a package or file is pushed to the end of the vector.
 static const unsigned PRIORITY_LAST = 0xffffffff;
@@ -53,7 +57,7 @@ struct ResourceGroup
     /// Current memory use.
     unsigned long long memoryUse_;
     /// Resources.
-    HashMap<StringHash, SharedPtr<Resource> > resources_;
+    FlatHashMap<StringHash, SharedPtr<Resource> > resources_;
 };
 
 /// Resource request types.
@@ -63,6 +67,44 @@ enum ResourceRequest
     RESOURCE_GETFILE = 1
 };
 
+/// Resolved file location of a resource in the resource index.
+struct ResourceLocation
+{
+    /// Construct undefined.
+    ResourceLocation() = default;
+
+    /// Construct with resource directory or package index.
+    ResourceLocation(unsigned index, bool package) :
+        index_(index),
+        package_(package)
+    {
+    }
+
+    /// Index of the resource directory or package file.
+    unsigned index_{};
+    /// Package file flag. Otherwise a resource directory.
+    bool package_{};
+};
+
+/// Timing of one resource load, recorded when load profiling is enabled.
+struct ResourceLoadRecord
+{
+    /// Resource type.
+    StringHash type_;
+    /// Resource type name.
+    String typeName_;
+    /// Resource name.
+    String name_;
+    /// Size of the resource file in bytes.
+    unsigned size_{};
+    /// Time spent in each load stage.
+    LoadStageTimes times_;
+    /// Background loaded flag.
+    bool background_{};
+    /// Success flag.
+    bool success_{};
+};
+
 /// Optional resource request processor. Can deny requests, re-route resource file names, or perform other processing per request.
 class URHO3D_API ResourceRouter : public Object
 {
@@ -124,11 +166,37 @@ public:
     void SetReturnFailedResources(bool enable) { returnFailedResources_ = enable; }
 
     /// Define whether when getting resources should check package files or directories first. True for packages, false for directories.
-    void SetSearchPackagesFirst(bool value) { searchPackagesFirst_ = value; }
+    void SetSearchPackagesFirst(bool value);
+
+    /// Enable or disable memory mapped reading of package files, including already added packages. Default false. Uncompressed package entries can then be parsed without copying.
+    void SetMemoryMappedPackages(bool enable);
 
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
 
+    /// Set number of threads used for background loading, so that independent resources can be loaded in parallel. Default 1.
+    void SetBackgroundLoadThreads(unsigned num);
+
+    /// Enable or disable the resource index. When enabled, the resource directory or package a file was found in is remembered, and later requests for the same name only verify that location instead of searching all of them. Default false.
+    void SetResourceIndex(bool enable);
+    /// Fill the resource index by scanning all resource directories and packages, and enable it.
+    void BuildResourceIndex();
+    /// Clear the resource index. It is also cleared when resource directories or packages are added or removed.
+    void ClearResourceIndex();
+    /// Save the resource index to a file. Return true if successful.
+    bool SaveResourceIndex(const String& fileName) const;
+    /// Load a previously saved resource index and enable it. Entries of resource directories or packages that are not currently added are skipped. Return true if successful.
+    bool LoadResourceIndex(const String& fileName);
+
+    /// Enable or disable load profiling. When enabled, the time each loaded resource spends in opening, reading, decompression, BeginLoad(), EndLoad() and GPU upload is recorded. Enabling clears the previous records. Default false.
+    void SetLoadProfiling(bool enable);
+    /// Clear the load profiling records.
+    void ClearLoadRecords();
+    /// Add a load profiling record if load profiling is enabled. Called by the cache and the background loader.
+    void AddLoadRecord(Resource* resource, unsigned size, const LoadStageTimes& times, bool background, bool success);
+    /// Save the type and name of each recorded load as text, one per line in load order, for replaying with the LoadProfiler tool. Return true if successful.
+    bool SaveLoadList(Serializer& dest) const;
+
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
     /// Remove a resource router object.
@@ -190,9 +258,29 @@ public:
     /// Return whether when getting resources should check package files or directories first.
     bool GetSearchPackagesFirst() const { return searchPackagesFirst_; }
 
+    /// Return whether package files are memory mapped.
+    bool GetMemoryMappedPackages() const { return memoryMappedPackages_; }
+
     /// Return how many milliseconds maximum to spend on finishing background loaded resources.
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
 
+    /// Return number of threads used for background loading.
+    unsigned GetBackgroundLoadThreads() const;
+
+    /// Return whether the resource index is enabled.
+    bool GetResourceIndex() const { return resourceIndexEnabled_; }
+
+    /// Return number of entries in the resource index.
+    unsigned GetResourceIndexSize() const { return resourceIndex_.Size(); }
+
+    /// Return whether load profiling is enabled.
+    bool GetLoadProfiling() const { return loadProfiling_; }
+
+    /// Return the load profiling records in completion order.
+    Vector<ResourceLoadRecord> GetLoadRecords() const;
+    /// Return a report of the load profiling records, with the totals per resource type and the most expensive resources sorted by cost.
+    String GetLoadProfileReport(unsigned maxResources = 20) const;
+
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
 
@@ -219,12 +307,18 @@ private:
     void ReleasePackageResources(PackageFile* package, bool force = false);
     /// Update a resource group. Recalculate memory use and release resources if over memory budget.
     void UpdateResourceGroup(StringHash type);
+    /// Reload a batch of changed files. Files that are reloaded as dependents of other changed files are not reloaded again.
+    void ReloadChangedResources(const Vector<String>& fileNames);
+    /// Add the resources reloaded as dependents when a file changes.
+    void GetReloadedDependents(StringHash fileNameHash, HashSet<StringHash>& dest);
     /// Handle begin frame event. Automatic resource reloads and the finalization of background loaded resources are processed here.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Search FileSystem for file.
     File* SearchResourceDirs(const String& name);
     /// Search resource packages for file.
     File* SearchPackages(const String& name);
+    /// Open file from the location stored in the resource index. Remove the entry if no longer valid.
+    File* SearchResourceIndex(const String& name);
 
     /// Mutex for thread-safe access to the resource directories, resource packages and resource dependencies.
     mutable Mutex resourceMutex_;
@@ -242,16 +336,30 @@ private:
     SharedPtr<BackgroundLoader> backgroundLoader_;
     /// Resource routers.
     Vector<SharedPtr<ResourceRouter> > resourceRouters_;
+    /// Resource file locations by name hash.
+    HashMap<StringHash, ResourceLocation> resourceIndex_;
+    /// Mutex for the load profiling records, which the background loader threads also add to.
+    mutable Mutex loadRecordMutex_;
+    /// Load profiling records.
+    Vector<ResourceLoadRecord> loadRecords_;
     /// Automatic resource reloading flag.
     bool autoReloadResources_;
     /// Return failed resources flag.
     bool returnFailedResources_;
     /// Search priority flag.
     bool searchPackagesFirst_;
+    /// Memory mapped package files flag.
+    bool memoryMappedPackages_;
+    /// Resource index flag.
+    bool resourceIndexEnabled_;
+    /// Load profiling flag.
+    bool loadProfiling_;
     /// Resource routing flag to prevent endless recursion.
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// Counter of resource requests that were not found in the cache.
+    SharedPtr<PerfCounter> missCounter_;
 };
 
 template <class T> T* ResourceCache::GetExistingResource(const String& name)
@@ -26,6 +26,7 @@
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../IO/Deserializer.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
@@ -63,6 +64,82 @@ public:
     bool success_;
 };
 
+/// Identifier of the binary cooked XML format.
+static const char* BINARY_XML_ID = "UXMB";
+
+/// Write a node with its attributes and children in the binary cooked format.
+static void WriteBinaryNode(Serializer& dest, const pugi::xml_node& node)
+{
+    dest.WriteUByte((unsigned char)node.type());
+    dest.WriteString(node.name());
+    dest.WriteString(node.value());
+
+    unsigned numAttributes = 0;
+    for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
+        ++numAttributes;
+    dest.WriteVLE(numAttributes);
+    for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
+    {
+        dest.WriteString(attr.name());
+        dest.WriteString(attr.value());
+    }
+
+    unsigned numChildren = 0;
+    for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        ++numChildren;
+    dest.WriteVLE(numChildren);
+    for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+        WriteBinaryNode(dest, child);
+}
+
+/// Return a null-terminated string in place from binary cooked data, or null if truncated.
+static const char* ReadBinaryString(MemoryBuffer& source)
+{
+    unsigned position = source.GetPosition();
+    const auto* str = (const char*)source.GetData() + position;
+    const void* end = memchr(str, 0, source.GetSize() - position);
+    if (!end)
+        return nullptr;
+
+    source.Seek(position + (unsigned)((const char*)end - str) + 1);
+    return str;
+}
+
+/// Read the children of a node in the binary cooked format. Return true if successful.
+static bool ReadBinaryChildren(MemoryBuffer& source, pugi::xml_node& parent)
+{
+    unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        unsigned char type = source.ReadUByte();
+        const char* name = ReadBinaryString(source);
+        const char* value = ReadBinaryString(source);
+        if (type < pugi::node_element || type > pugi::node_doctype || !name || !value)
+            return false;
+
+        pugi::xml_node node = parent.append_child((pugi::xml_node_type)type);
+        if (*name)
+            node.set_name(name);
+        if (*value)
+            node.set_value(value);
+
+        unsigned numAttributes = source.ReadVLE();
+        for (unsigned j = 0; j < numAttributes; ++j)
+        {
+            const char* attrName = ReadBinaryString(source);
+            const char* attrValue = ReadBinaryString(source);
+            if (!attrName || !attrValue)
+                return false;
+            node.append_attribute(attrName).set_value(attrValue);
+        }
+
+        if (!ReadBinaryChildren(source, node))
+            return false;
+    }
+
+    return true;
+}
+
 XMLFile::XMLFile(Context* context) :
     Resource(context),
     document_(new pugi::xml_document())
@@ -85,15 +162,38 @@ bool XMLFile::BeginLoad(Deserializer& source)
         return false;
     }
 
-    SharedArrayPtr<char> buffer(new char[dataSize]);
-    if (source.Read(buffer.Get(), dataSize) != dataSize)
-        return false;
-
-    if (!document_->load_buffer(buffer.Get(), dataSize))
+    // Binary cooked data in a memory mapped package can be used in place
+    auto* file = dynamic_cast<File*>(&source);
+    const unsigned char* mappedData = file && !file->GetPosition() ? file->GetMappedData() : nullptr;
+    if (mappedData && dataSize >= 4 && !memcmp(mappedData, BINARY_XML_ID, 4))
     {
-        URHO3D_LOGERROR("Could not parse XML data from " + source.GetName());
-        document_->reset();
-        return false;
+        file->Seek(dataSize);
+        if (!LoadBinary(mappedData, dataSize))
+        {
+            URHO3D_LOGERROR("Could not read binary XML data from " + source.GetName());
+            return false;
+        }
+    }
+    else
+    {
+        SharedArrayPtr<char> buffer(new char[dataSize]);
+        if (source.Read(buffer.Get(), dataSize) != dataSize)
+            return false;
+
+        if (dataSize >= 4 && !memcmp(buffer.Get(), BINARY_XML_ID, 4))
+        {
+            if (!LoadBinary((const unsigned char*)buffer.Get(), dataSize))
+            {
+                URHO3D_LOGERROR("Could not read binary XML data from " + source.GetName());
+                return false;
+            }
+        }
+        else if (!document_->load_buffer(buffer.Get(), dataSize))
+        {
+            URHO3D_LOGERROR("Could not parse XML data from " + source.GetName());
+            document_->reset();
+            return false;
+        }
     }
 
     XMLElement rootElem = GetRoot();
@@ -141,6 +241,21 @@ bool XMLFile::Save(Serializer& dest, const String& indentation) const
     return writer.success_;
 }
 
+bool XMLFile::SaveBinary(Serializer& dest) const
+{
+    if (!dest.WriteFileID(BINARY_XML_ID))
+        return false;
+
+    unsigned numChildren = 0;
+    for (pugi::xml_node child = document_->first_child(); child; child = child.next_sibling())
+        ++numChildren;
+    dest.WriteVLE(numChildren);
+    for (pugi::xml_node child = document_->first_child(); child; child = child.next_sibling())
+        WriteBinaryNode(dest, child);
+
+    return true;
+}
+
 XMLElement XMLFile::CreateRoot(const String& name)
 {
     document_->reset();
@@ -168,6 +283,21 @@ bool XMLFile::FromString(const String& source)
     return Load(buffer);
 }
 
+bool XMLFile::LoadBinary(const unsigned char* data, unsigned size)
+{
+    document_->reset();
+
+    MemoryBuffer source(data, size);
+    source.Seek(4);
+    if (!ReadBinaryChildren(source, *document_))
+    {
+        document_->reset();
+        return false;
+    }
+
+    return true;
+}
+
 XMLElement XMLFile::GetRoot(const String& name)
 {
     pugi::xml_node root = document_->first_child();
@@ -56,6 +56,8 @@ public:
     bool Save(Serializer& dest) const override;
     /// Save resource with user-defined indentation. Return true if successful.
     bool Save(Serializer& dest, const String& indentation) const;
+    /// Save resource in the binary cooked format, which loads without text parsing. Return true if successful.
+    bool SaveBinary(Serializer& dest) const;
 
     /// Deserialize from a string. Return true if successful.
     bool FromString(const String& source);
@@ -79,6 +81,8 @@ public:
     void Patch(const XMLElement& patchElement);
 
 private:
+    /// Build the document from binary cooked data. Return true if successful.
+    bool LoadBinary(const unsigned char* data, unsigned size);
     /// Add an node in the Patch.
     void PatchAdd(const pugi::xml_node& patch, pugi::xpath_node& original) const;
     /// Replace a node or attribute in the Patch.
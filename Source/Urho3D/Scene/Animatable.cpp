@@ -42,7 +42,9 @@ extern const char* wrapModeNames[];
 AttributeAnimationInfo::AttributeAnimationInfo(Animatable* animatable, const AttributeInfo& attributeInfo,
     ValueAnimation* attributeAnimation, WrapMode wrapMode, float speed) :
     ValueAnimationInfo(animatable, attributeAnimation, wrapMode, speed),
-    attributeInfo_(attributeInfo)
+    attributeInfo_(attributeInfo),
+    // The ID attributes may be intercepted by OnSetAttribute(), but they never consist of floats
+    setFloats_(attributeInfo.accessor_ && attributeAnimation && attributeAnimation->GetNumFloats())
 {
 }
 
@@ -50,6 +52,31 @@ AttributeAnimationInfo::AttributeAnimationInfo(const AttributeAnimationInfo& oth
 
 AttributeAnimationInfo::~AttributeAnimationInfo() = default;
 
+void AttributeAnimationInfo::ApplyAnimationValue(float scaledTime)
+{
+    auto* animatable = static_cast<Animatable*>(target_.Get());
+    if (!animatable)
+        return;
+
+    if (setFloats_)
+    {
+        float values[MAX_ANIMATION_FLOATS];
+        if (animation_->GetAnimationFloats(scaledTime, values))
+        {
+            if (attributeInfo_.accessor_->SetFloats(animatable, values))
+            {
+                animatable->ApplyAttributes();
+                return;
+            }
+
+            // The accessor only supports Variants
+            setFloats_ = false;
+        }
+    }
+
+    ApplyValue(animation_->GetAnimationValue(scaledTime));
+}
+
 void AttributeAnimationInfo::ApplyValue(const Variant& newValue)
 {
     auto* animatable = static_cast<Animatable*>(target_.Get());
@@ -51,12 +51,16 @@ public:
     const AttributeInfo& GetAttributeInfo() const { return attributeInfo_; }
 
 protected:
-    /// Apply new animation value to the target object. Called by Update().
+    /// Evaluate the animation at a scaled time and apply to the target object. Called by Update().
+    void ApplyAnimationValue(float scaledTime) override;
+    /// Apply new animation value to the target object. Called by ApplyAnimationValue().
     void ApplyValue(const Variant& newValue) override;
 
 private:
     /// Attribute information.
     const AttributeInfo& attributeInfo_;
+    /// Whether to evaluate and set the value as float components without a Variant.
+    bool setFloats_;
 };
 
 /// Base class for animatable object, an animatable object can be set animation on it's attributes, or can be set an object animation to it.
@@ -64,6 +68,8 @@ class URHO3D_API Animatable : public Serializable
 {
     URHO3D_OBJECT(Animatable, Serializable);
 
+    friend class Scene;
+
 public:
     /// Construct.
     explicit Animatable(Context* context);
@@ -166,15 +166,23 @@ void Component::AddReplicationState(ComponentReplicationState* state)
 }
 
 void Component::PrepareNetworkUpdate()
+{
+    DirtyBits dirtyAttributes;
+    if (CheckNetworkUpdate(dirtyAttributes))
+        MarkNetworkUpdateDirty(dirtyAttributes);
+}
+
+bool Component::CheckNetworkUpdate(DirtyBits& dirtyAttributes)
 {
     if (!networkState_)
         AllocateNetworkState();
 
     const Vector<AttributeInfo>* attributes = networkState_->attributes_;
     if (!attributes)
-        return;
+        return false;
 
     unsigned numAttributes = attributes->Size();
+    bool changed = false;
 
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
@@ -184,31 +192,34 @@ void Component::PrepareNetworkUpdate()
         if (animationEnabled_ && IsAnimatedNetworkAttribute(attr))
             continue;
 
-        OnGetAttribute(attr, networkState_->currentValues_[i]);
-
-        if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
+        if (UpdateNetworkValue(i))
         {
-            networkState_->previousValues_[i] = networkState_->currentValues_[i];
-
-            // Mark the attribute dirty in all replication states that are tracking this component
-            for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
-                 j != networkState_->replicationStates_.End(); ++j)
-            {
-                auto* compState = static_cast<ComponentReplicationState*>(*j);
-                compState->dirtyAttributes_.Set(i);
-
-                // Add component's parent node to the dirty set if not added yet
-                NodeReplicationState* nodeState = compState->nodeState_;
-                if (!nodeState->markedDirty_)
-                {
-                    nodeState->markedDirty_ = true;
-                    nodeState->sceneState_->dirtyNodes_.Insert(node_->GetID());
-                }
-            }
+            dirtyAttributes.Set(i);
+            changed = true;
         }
     }
 
     networkUpdate_ = false;
+    return changed;
+}
+
+void Component::MarkNetworkUpdateDirty(const DirtyBits& dirtyAttributes)
+{
+    // Mark the attributes dirty in all replication states that are tracking this component
+    for (PODVector<ReplicationState*>::Iterator i = networkState_->replicationStates_.Begin();
+         i != networkState_->replicationStates_.End(); ++i)
+    {
+        auto* compState = static_cast<ComponentReplicationState*>(*i);
+        compState->dirtyAttributes_.Set(dirtyAttributes);
+
+        // Add component's parent node to the dirty set if not added yet
+        NodeReplicationState* nodeState = compState->nodeState_;
+        if (!nodeState->markedDirty_)
+        {
+            nodeState->markedDirty_ = true;
+            nodeState->sceneState_->dirtyNodes_.Insert(node_->GetID());
+        }
+    }
 }
 
 void Component::CleanupConnection(Connection* connection)
@@ -225,14 +236,16 @@ void Component::CleanupConnection(Connection* connection)
 
 void Component::OnAttributeAnimationAdded()
 {
-    if (attributeAnimationInfos_.Size() == 1)
-        SubscribeToEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE, URHO3D_HANDLER(Component, HandleAttributeAnimationUpdate));
+    Scene* scene = GetScene();
+    if (scene && attributeAnimationInfos_.Size() == 1)
+        scene->AddAnimatedObject(this);
 }
 
 void Component::OnAttributeAnimationRemoved()
 {
-    if (attributeAnimationInfos_.Empty())
-        UnsubscribeFromEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE);
+    Scene* scene = GetScene();
+    if (scene && attributeAnimationInfos_.Empty())
+        scene->RemoveAnimatedObject(this);
 }
 
 void Component::OnNodeSet(Node* node)
@@ -280,13 +293,6 @@ void Component::GetComponents(PODVector<Component*>& dest, StringHash type) cons
         dest.Clear();
 }
 
-void Component::HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData)
-{
-    using namespace AttributeAnimationUpdate;
-
-    UpdateAttributeAnimations(eventData[P_TIMESTEP].GetFloat());
-}
-
 Component* Component::GetFixedUpdateSource()
 {
     Component* ret = nullptr;
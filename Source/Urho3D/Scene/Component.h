@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/ObjectPool.h"
 #include "../Scene/Animatable.h"
 
 namespace Urho3D
@@ -32,6 +33,7 @@ class Node;
 class Scene;
 
 struct ComponentReplicationState;
+struct DirtyBits;
 
 /// Autoremove is used by some components for automatic removal from the scene hierarchy upon completion of an action, for example sound or particle effect.
 enum AutoRemoveMode
@@ -68,6 +70,8 @@ public:
     void MarkNetworkUpdate() override;
     /// Return the depended on nodes to order network updates.
     virtual void GetDependencyNodes(PODVector<Node*>& dest);
+    /// Return whether the network attributes can be read in worker threads for the threaded network update. Components whose attribute getters run script code return false.
+    virtual bool IsThreadSafeNetworkUpdate() const { return true; }
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
 
@@ -105,6 +109,10 @@ public:
     void AddReplicationState(ComponentReplicationState* state);
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
+    /// Compare the network attributes to their previous values and set the changed ones in the bitmask. Does not touch the replication states, so that different components can be checked in worker threads if their attributes can be read there. Return true if anything changed.
+    bool CheckNetworkUpdate(DirtyBits& dirtyAttributes);
+    /// Mark changed attributes dirty in the replication states tracking this component.
+    void MarkNetworkUpdateDirty(const DirtyBits& dirtyAttributes);
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
 
@@ -125,8 +133,6 @@ protected:
     void SetID(unsigned id);
     /// Set scene node. Called by Node when creating the component.
     void SetNode(Node* node);
-    /// Handle scene attribute animation update event.
-    void HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData);
     /// Return a component from the scene root that sends out fixed update events (either PhysicsWorld or PhysicsWorld2D). Return null if neither exists.
     Component* GetFixedUpdateSource();
     /// Perform autoremove. Called by subclasses. Caller should keep a weak pointer to itself to check whether was actually removed, and return immediately without further member operations in that case.
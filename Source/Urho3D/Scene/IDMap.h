@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+/// Map from scene node or component IDs to objects, stored as pages of dense arrays. As IDs are allocated sequentially, lookup is a direct index instead of a hash. Pages are freed when they become empty, and the page array is trimmed from both ends.
+template <class T> class IDMap
+{
+public:
+    /// Number of IDs per page as a power of two.
+    static const unsigned PAGE_BITS = 8;
+    /// Number of IDs per page.
+    static const unsigned PAGE_SIZE = 1u << PAGE_BITS;
+
+    /// Page of objects.
+    struct Page
+    {
+        /// Objects by ID, null if not used.
+        T* objects_[PAGE_SIZE];
+        /// Number of non-null objects.
+        unsigned count_;
+    };
+
+    /// Iterator over the objects in ID order.
+    class ConstIterator
+    {
+    public:
+        /// Construct at the first object at or after a page and slot.
+        ConstIterator(const IDMap<T>* map, unsigned page, unsigned slot) :
+            map_(map),
+            page_(page),
+            slot_(slot)
+        {
+            SkipEmpty();
+        }
+
+        /// Advance to the next object.
+        ConstIterator& operator ++()
+        {
+            ++slot_;
+            SkipEmpty();
+            return *this;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return page_ == rhs.page_ && slot_ == rhs.slot_; }
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return page_ != rhs.page_ || slot_ != rhs.slot_; }
+        /// Return the object.
+        T* operator *() const { return map_->pages_[page_]->objects_[slot_]; }
+        /// Return the object's ID.
+        unsigned GetID() const { return map_->firstID_ + ((map_->firstPage_ + page_) << PAGE_BITS) + slot_; }
+
+    private:
+        /// Move forward to the next non-null object or the end.
+        void SkipEmpty()
+        {
+            const PODVector<Page*>& pages = map_->pages_;
+            while (page_ < pages.Size())
+            {
+                if (pages[page_])
+                {
+                    T* const* objects = pages[page_]->objects_;
+                    while (slot_ < PAGE_SIZE && !objects[slot_])
+                        ++slot_;
+                    if (slot_ < PAGE_SIZE)
+                        return;
+                }
+                ++page_;
+                slot_ = 0;
+            }
+            slot_ = 0;
+        }
+
+        /// Map.
+        const IDMap<T>* map_;
+        /// Page index.
+        unsigned page_;
+        /// Slot index within the page.
+        unsigned slot_;
+    };
+
+    /// Construct with the first ID of the range.
+    explicit IDMap(unsigned firstID) :
+        firstID_(firstID),
+        firstPage_(0),
+        size_(0)
+    {
+    }
+
+    /// Destruct.
+    ~IDMap()
+    {
+        Clear();
+    }
+
+    /// Prevent copy construction.
+    IDMap(const IDMap<T>& rhs) = delete;
+    /// Prevent assignment.
+    IDMap<T>& operator =(const IDMap<T>& rhs) = delete;
+
+    /// Set the object for an ID, replacing any previous.
+    void Insert(unsigned id, T* object)
+    {
+        unsigned index = id - firstID_;
+        unsigned absPageIndex = index >> PAGE_BITS;
+        if (pages_.Empty())
+            firstPage_ = absPageIndex;
+        else if (absPageIndex < firstPage_)
+        {
+            pages_.Insert(0, PODVector<Page*>(firstPage_ - absPageIndex, nullptr));
+            firstPage_ = absPageIndex;
+        }
+
+        unsigned pageIndex = absPageIndex - firstPage_;
+        if (pageIndex >= pages_.Size())
+            pages_.Insert(pages_.Size(), PODVector<Page*>(pageIndex + 1 - pages_.Size(), nullptr));
+
+        Page*& page = pages_[pageIndex];
+        if (!page)
+        {
+            page = new Page();
+            page->count_ = 0;
+            for (unsigned i = 0; i < PAGE_SIZE; ++i)
+                page->objects_[i] = nullptr;
+        }
+
+        T*& slot = page->objects_[index & (PAGE_SIZE - 1)];
+        if (!slot)
+        {
+            ++page->count_;
+            ++size_;
+        }
+        slot = object;
+    }
+
+    /// Remove the object for an ID. Return true if it existed.
+    bool Erase(unsigned id)
+    {
+        unsigned pageIndex = ((id - firstID_) >> PAGE_BITS) - firstPage_;
+        if (pageIndex >= pages_.Size() || !pages_[pageIndex])
+            return false;
+
+        Page*& page = pages_[pageIndex];
+        T*& slot = page->objects_[(id - firstID_) & (PAGE_SIZE - 1)];
+        if (!slot)
+            return false;
+
+        slot = nullptr;
+        --size_;
+        if (!--page->count_)
+        {
+            delete page;
+            page = nullptr;
+            // Trim empty pages from the ends, as IDs are allocated in increasing order and the range moves on
+            while (!pages_.Empty() && !pages_.Back())
+                pages_.Pop();
+            unsigned numEmpty = 0;
+            while (numEmpty < pages_.Size() && !pages_[numEmpty])
+                ++numEmpty;
+            if (numEmpty)
+            {
+                pages_.Erase(0, numEmpty);
+                firstPage_ += numEmpty;
+            }
+        }
+        return true;
+    }
+
+    /// Remove all objects.
+    void Clear()
+    {
+        for (unsigned i = 0; i < pages_.Size(); ++i)
+            delete pages_[i];
+        pages_.Clear();
+        size_ = 0;
+    }
+
+    /// Return the object for an ID, or null if not found.
+    T* Find(unsigned id) const
+    {
+        unsigned index = id - firstID_;
+        unsigned pageIndex = (index >> PAGE_BITS) - firstPage_;
+        return pageIndex < pages_.Size() && pages_[pageIndex] ? pages_[pageIndex]->objects_[index & (PAGE_SIZE - 1)] : nullptr;
+    }
+
+    /// Return whether an ID is used.
+    bool Contains(unsigned id) const { return Find(id) != nullptr; }
+    /// Return number of objects.
+    unsigned Size() const { return size_; }
+    /// Return whether empty.
+    bool Empty() const { return size_ == 0; }
+    /// Return number of allocated pages.
+    unsigned GetNumPages() const
+    {
+        unsigned num = 0;
+        for (unsigned i = 0; i < pages_.Size(); ++i)
+        {
+            if (pages_[i])
+                ++num;
+        }
+        return num;
+    }
+
+    /// Return iterator to the first object.
+    ConstIterator Begin() const { return ConstIterator(this, 0, 0); }
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(this, pages_.Size(), 0); }
+
+private:
+    /// Pages by ID range, null if empty.
+    PODVector<Page*> pages_;
+    /// First ID of the range.
+    unsigned firstID_;
+    /// Page index of the first entry of the page array.
+    unsigned firstPage_;
+    /// Number of objects.
+    unsigned size_;
+};
+
+}
@@ -95,6 +95,11 @@ void LogicComponent::OnSceneSet(Scene* scene)
     {
         UnsubscribeFromEvent(E_SCENEUPDATE);
         UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        if (threadedUpdateScene_)
+        {
+            threadedUpdateScene_->RemoveThreadedUpdateComponent(this);
+            threadedUpdateScene_.Reset();
+        }
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
         UnsubscribeFromEvent(E_PHYSICSPRESTEP);
         UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
@@ -112,17 +117,31 @@ void LogicComponent::UpdateEventSubscription()
     bool enabled = IsEnabledEffective();
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
+    // DelayedStart() is always called from the update event, after that the threaded update can take over
+    bool needThreadedUpdate = needUpdate && delayedStartCalled_ && (updateEventMask_ & USE_THREADEDUPDATE);
+    bool needUpdateEvent = needUpdate && !needThreadedUpdate;
+    if (needUpdateEvent && !(currentEventMask_ & USE_UPDATE))
     {
         SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
         currentEventMask_ |= USE_UPDATE;
     }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
+    else if (!needUpdateEvent && (currentEventMask_ & USE_UPDATE))
     {
         UnsubscribeFromEvent(scene, E_SCENEUPDATE);
         currentEventMask_ &= ~USE_UPDATE;
     }
 
+    if (needThreadedUpdate && !threadedUpdateScene_)
+    {
+        scene->AddThreadedUpdateComponent(this);
+        threadedUpdateScene_ = scene;
+    }
+    else if (!needThreadedUpdate && threadedUpdateScene_)
+    {
+        threadedUpdateScene_->RemoveThreadedUpdateComponent(this);
+        threadedUpdateScene_.Reset();
+    }
+
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
@@ -183,6 +202,13 @@ void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
             currentEventMask_ &= ~USE_UPDATE;
             return;
         }
+
+        // If using the threaded update, switch to it now. The scene runs it after the update event in this same frame
+        if (updateEventMask_ & USE_THREADEDUPDATE)
+        {
+            UpdateEventSubscription();
+            return;
+        }
     }
 
     // Then execute user-defined update function
@@ -40,6 +40,8 @@ enum UpdateEvent : unsigned
     USE_FIXEDUPDATE = 0x4,
     /// Bitmask for using the physics post-update event.
     USE_FIXEDPOSTUPDATE = 0x8,
+    /// Bitmask for running Update() in worker threads in parallel with other components, instead of from the scene update event. Update() must then only modify the component's own node, and must not send events or create or remove objects.
+    USE_THREADEDUPDATE = 0x10,
 };
 URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 
@@ -106,6 +108,8 @@ private:
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
+    /// Scene the component is registered to for the threaded update.
+    WeakPtr<Scene> threadedUpdateScene_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
 };
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../IO/Log.h"
@@ -45,6 +46,55 @@
 namespace Urho3D
 {
 
+/// Maximum number of same-named or tagged nodes in the scene for which a lookup below a node other than the scene checks them from the scene cache, instead of walking the subtree.
+static const unsigned MAX_CACHED_LOOKUP_NODES = 64;
+
+/// Return depth of a node in its hierarchy.
+static unsigned GetNodeDepth(const Node* node)
+{
+    unsigned depth = 0;
+    while ((node = node->GetParent()))
+        ++depth;
+    return depth;
+}
+
+/// Compare nodes of the same hierarchy by depth-first order, which the recursive child lookups return.
+static bool CompareDepthFirstOrder(Node* lhs, Node* rhs)
+{
+    unsigned lhsDepth = GetNodeDepth(lhs);
+    unsigned rhsDepth = GetNodeDepth(rhs);
+    unsigned depth = Min(lhsDepth, rhsDepth);
+    Node* lhsAncestor = lhs;
+    Node* rhsAncestor = rhs;
+    for (unsigned i = depth; i < lhsDepth; ++i)
+        lhsAncestor = lhsAncestor->GetParent();
+    for (unsigned i = depth; i < rhsDepth; ++i)
+        rhsAncestor = rhsAncestor->GetParent();
+
+    // An ancestor comes before its children
+    if (lhsAncestor == rhsAncestor)
+        return lhsDepth < rhsDepth;
+
+    while (lhsAncestor->GetParent() != rhsAncestor->GetParent())
+    {
+        lhsAncestor = lhsAncestor->GetParent();
+        rhsAncestor = rhsAncestor->GetParent();
+    }
+    if (!lhsAncestor->GetParent())
+        return false;
+
+    // Siblings are in child order
+    const Vector<SharedPtr<Node> >& siblings = lhsAncestor->GetParent()->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = siblings.Begin(); i != siblings.End(); ++i)
+    {
+        if (*i == lhsAncestor)
+            return true;
+        if (*i == rhsAncestor)
+            return false;
+    }
+    return false;
+}
+
 Node::Node(Context* context) :
     Animatable(context),
     worldTransform_(Matrix3x4::IDENTITY),
@@ -323,14 +373,17 @@ void Node::SetName(const String& name)
 {
     if (name != impl_->name_)
     {
+        StringHash oldNameHash = impl_->nameHash_;
         impl_->name_ = name;
         impl_->nameHash_ = name;
 
         MarkNetworkUpdate();
 
-        // Send change event
+        // Update scene cache and send change event
         if (scene_)
         {
+            scene_->NodeNameChanged(this, oldNameHash);
+
             using namespace NodeNameChanged;
 
             VariantMap& eventData = GetEventDataMap();
@@ -735,6 +788,11 @@ void Node::SetOwner(Connection* owner)
 
 void Node::MarkDirty()
 {
+    // Record the topmost node that becomes dirty for the scene's world transform update. The children below it are dirtied
+    // along with it, so they do not need to be recorded
+    if (!dirty_ && scene_ && (!parent_ || !parent_->dirty_))
+        scene_->MarkTransformDirty(this);
+
     Node *cur = this;
     for (;;)
     {
@@ -836,6 +894,9 @@ void Node::AddChild(Node* node, unsigned index)
         scene_->NodeAdded(node);
 
     node->parent_ = this;
+    // A node that was already dirty may only have been recorded for the world transform update as part of the old parent
+    if (node->dirty_ && scene_)
+        scene_->MarkTransformDirty(node);
     node->MarkDirty();
     node->MarkNetworkUpdate();
     // If the child node has components, also mark network update on them to ensure they have a valid NetworkState
@@ -1273,6 +1334,25 @@ void Node::GetChildrenWithTag(PODVector<Node*>& dest, const String& tag, bool re
 {
     dest.Clear();
 
+    // Check the tagged nodes of the scene instead of the children, unless there are more of them
+    if (scene_)
+    {
+        const PODVector<Node*>* nodes = scene_->GetTaggedNodes(tag);
+        unsigned numNodes = nodes ? nodes->Size() : 0;
+        if (this == scene_ || (recursive ? numNodes <= MAX_CACHED_LOOKUP_NODES : numNodes <= children_.Size()))
+        {
+            for (unsigned i = 0; i < numNodes; ++i)
+            {
+                Node* node = nodes->At(i);
+                if (recursive ? node->IsChildOf(const_cast<Node*>(this)) : node->parent_ == this)
+                    dest.Push(node);
+            }
+            if (dest.Size() > 1)
+                Sort(dest.Begin(), dest.End(), CompareDepthFirstOrder);
+            return;
+        }
+    }
+
     if (!recursive)
     {
         for (Vector<SharedPtr<Node> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
@@ -1309,6 +1389,24 @@ Node* Node::GetChild(const char* name, bool recursive) const
 
 Node* Node::GetChild(StringHash nameHash, bool recursive) const
 {
+    // Check the same-named nodes of the scene instead of the whole subtree, unless there are many of them
+    if (recursive && scene_ && nameHash)
+    {
+        const PODVector<Node*>* nodes = scene_->GetNamedNodes(nameHash);
+        if (!nodes)
+            return nullptr;
+        if (this == scene_ || nodes->Size() <= MAX_CACHED_LOOKUP_NODES)
+        {
+            Node* found = nullptr;
+            for (PODVector<Node*>::ConstIterator i = nodes->Begin(); i != nodes->End(); ++i)
+            {
+                if ((*i)->IsChildOf(const_cast<Node*>(this)) && (!found || CompareDepthFirstOrder(*i, found)))
+                    found = *i;
+            }
+            return found;
+        }
+    }
+
     for (Vector<SharedPtr<Node> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
     {
         if ((*i)->GetNameHash() == nameHash)
@@ -1460,9 +1558,9 @@ void Node::SetNetRotationAttr(const PODVector<unsigned char>& value)
     MemoryBuffer buf(value);
     auto* transform = GetComponent<SmoothedTransform>();
     if (transform)
-        transform->SetTargetRotation(buf.ReadPackedQuaternion());
+        transform->SetTargetRotation(buf.ReadCompactQuaternion());
     else
-        SetRotation(buf.ReadPackedQuaternion());
+        SetRotation(buf.ReadCompactQuaternion());
 }
 
 void Node::SetNetParentAttr(const PODVector<unsigned char>& value)
@@ -1510,7 +1608,7 @@ const Vector3& Node::GetNetPositionAttr() const
 const PODVector<unsigned char>& Node::GetNetRotationAttr() const
 {
     impl_->attrBuffer_.Clear();
-    impl_->attrBuffer_.WritePackedQuaternion(rotation_);
+    impl_->attrBuffer_.WriteCompactQuaternion(rotation_);
     return impl_->attrBuffer_.GetBuffer();
 }
 
@@ -1551,10 +1649,12 @@ bool Node::Load(Deserializer& source, SceneResolver& resolver, bool loadChildren
     if (!Animatable::Load(source))
         return false;
 
+    // Reuse the resolver's buffer for the components' nested data to not allocate for each component
+    VectorBuffer& compBuffer = resolver.GetComponentBuffer();
     unsigned numComponents = source.ReadVLE();
     for (unsigned i = 0; i < numComponents; ++i)
     {
-        VectorBuffer compBuffer(source, source.ReadVLE());
+        compBuffer.SetData(source, source.ReadVLE());
         StringHash compType = compBuffer.ReadStringHash();
         unsigned compID = compBuffer.ReadUInt();
 
@@ -1676,6 +1776,14 @@ bool Node::LoadJSON(const JSONValue& source, SceneResolver& resolver, bool loadC
 }
 
 void Node::PrepareNetworkUpdate()
+{
+    DirtyBits dirtyAttributes;
+    PODVector<StringHash> dirtyVars;
+    if (CheckNetworkUpdate(dirtyAttributes, dirtyVars))
+        MarkNetworkUpdateDirty(dirtyAttributes, dirtyVars.Buffer(), dirtyVars.Size());
+}
+
+bool Node::CheckNetworkUpdate(DirtyBits& dirtyAttributes, PODVector<StringHash>& dirtyVars)
 {
     // Update dependency nodes list first
     impl_->dependencyNodes_.Clear();
@@ -1704,6 +1812,7 @@ void Node::PrepareNetworkUpdate()
 
     const Vector<AttributeInfo>* attributes = networkState_->attributes_;
     unsigned numAttributes = attributes->Size();
+    bool changed = false;
 
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
@@ -1713,26 +1822,10 @@ void Node::PrepareNetworkUpdate()
         if (animationEnabled_ && IsAnimatedNetworkAttribute(attr))
             continue;
 
-        OnGetAttribute(attr, networkState_->currentValues_[i]);
-
-        if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
+        if (UpdateNetworkValue(i))
         {
-            networkState_->previousValues_[i] = networkState_->currentValues_[i];
-
-            // Mark the attribute dirty in all replication states that are tracking this node
-            for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
-                 j != networkState_->replicationStates_.End(); ++j)
-            {
-                auto* nodeState = static_cast<NodeReplicationState*>(*j);
-                nodeState->dirtyAttributes_.Set(i);
-
-                // Add node to the dirty set if not added yet
-                if (!nodeState->markedDirty_)
-                {
-                    nodeState->markedDirty_ = true;
-                    nodeState->sceneState_->dirtyNodes_.Insert(id_);
-                }
-            }
+            dirtyAttributes.Set(i);
+            changed = true;
         }
     }
 
@@ -1743,24 +1836,33 @@ void Node::PrepareNetworkUpdate()
         if (j == networkState_->previousVars_.End() || j->second_ != i->second_)
         {
             networkState_->previousVars_[i->first_] = i->second_;
-
-            // Mark the var dirty in all replication states that are tracking this node
-            for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
-                 j != networkState_->replicationStates_.End(); ++j)
-            {
-                auto* nodeState = static_cast<NodeReplicationState*>(*j);
-                nodeState->dirtyVars_.Insert(i->first_);
-
-                if (!nodeState->markedDirty_)
-                {
-                    nodeState->markedDirty_ = true;
-                    nodeState->sceneState_->dirtyNodes_.Insert(id_);
-                }
-            }
+            dirtyVars.Push(i->first_);
+            changed = true;
         }
     }
 
     networkUpdate_ = false;
+    return changed;
+}
+
+void Node::MarkNetworkUpdateDirty(const DirtyBits& dirtyAttributes, const StringHash* dirtyVars, unsigned numDirtyVars)
+{
+    // Mark the attributes and vars dirty in all replication states that are tracking this node
+    for (PODVector<ReplicationState*>::Iterator i = networkState_->replicationStates_.Begin();
+         i != networkState_->replicationStates_.End(); ++i)
+    {
+        auto* nodeState = static_cast<NodeReplicationState*>(*i);
+        nodeState->dirtyAttributes_.Set(dirtyAttributes);
+        for (unsigned j = 0; j < numDirtyVars; ++j)
+            nodeState->dirtyVars_.Insert(dirtyVars[j]);
+
+        // Add node to the dirty set if not added yet
+        if (!nodeState->markedDirty_)
+        {
+            nodeState->markedDirty_ = true;
+            nodeState->sceneState_->dirtyNodes_.Insert(id_);
+        }
+    }
 }
 
 void Node::CleanupConnection(Connection* connection)
@@ -1893,14 +1995,16 @@ void Node::SetTransformSilent(const Vector3& position, const Quaternion& rotatio
 
 void Node::OnAttributeAnimationAdded()
 {
-    if (attributeAnimationInfos_.Size() == 1)
-        SubscribeToEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE, URHO3D_HANDLER(Node, HandleAttributeAnimationUpdate));
+    Scene* scene = GetScene();
+    if (scene && attributeAnimationInfos_.Size() == 1)
+        scene->AddAnimatedObject(this);
 }
 
 void Node::OnAttributeAnimationRemoved()
 {
-    if (attributeAnimationInfos_.Empty())
-        UnsubscribeFromEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE);
+    Scene* scene = GetScene();
+    if (scene && attributeAnimationInfos_.Empty())
+        scene->RemoveAnimatedObject(this);
 }
 
 Animatable* Node::FindAttributeAnimationTarget(const String& name, String& outName)
@@ -2251,11 +2355,4 @@ void Node::RemoveComponent(Vector<SharedPtr<Component> >::Iterator i)
     components_.Erase(i);
 }
 
-void Node::HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData)
-{
-    using namespace AttributeAnimationUpdate;
-
-    UpdateAttributeAnimations(eventData[P_TIMESTEP].GetFloat());
-}
-
 }
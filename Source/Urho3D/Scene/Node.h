@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/ObjectPool.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/Matrix3x4.h"
 #include "../Scene/Animatable.h"
@@ -35,6 +36,7 @@ class Node;
 class Scene;
 class SceneResolver;
 
+struct DirtyBits;
 struct NodeReplicationState;
 
 /// Component and child node creation mode for networking.
@@ -73,6 +75,7 @@ struct URHO3D_API NodeImpl
 class URHO3D_API Node : public Animatable
 {
     URHO3D_OBJECT(Node, Animatable);
+    URHO3D_POOLED_OBJECT(Node);
 
     friend class Connection;
 
@@ -604,6 +607,10 @@ public:
 
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
+    /// Update the dependency nodes and compare the network attributes and user variables to their previous values. Sets the changed attributes in the bitmask and appends the changed variables. Does not touch the replication states, so that different nodes can be checked in worker threads. Return true if anything changed.
+    bool CheckNetworkUpdate(DirtyBits& dirtyAttributes, PODVector<StringHash>& dirtyVars);
+    /// Mark changed attributes and user variables dirty in the replication states tracking this node.
+    void MarkNetworkUpdateDirty(const DirtyBits& dirtyAttributes, const StringHash* dirtyVars, unsigned numDirtyVars);
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
     /// Mark node dirty in scene replication states.
@@ -658,8 +665,6 @@ private:
     Node* CloneRecursive(Node* parent, SceneResolver& resolver, CreateMode mode);
     /// Remove a component from this node with the specified iterator.
     void RemoveComponent(Vector<SharedPtr<Component> >::Iterator i);
-    /// Handle attribute animation update event.
-    void HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData);
 
     /// World-space transform matrix.
     mutable Matrix3x4 worldTransform_;
@@ -0,0 +1,283 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Octree.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/Prefab.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneResolver.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+Prefab::Prefab(Context* context) :
+    Resource(context),
+    numNodes_(0),
+    numComponents_(0)
+{
+}
+
+Prefab::~Prefab() = default;
+
+void Prefab::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Prefab>();
+}
+
+bool Prefab::BeginLoad(Deserializer& source)
+{
+    loadXMLFile_.Reset();
+    loadJSONFile_.Reset();
+    loadData_.Clear();
+
+    // Only read the data here, as loading the nodes for compiling requests resources
+    String extension = GetExtension(source.GetName());
+    if (extension == ".xml")
+    {
+        loadXMLFile_ = new XMLFile(context_);
+        if (!loadXMLFile_->Load(source))
+        {
+            URHO3D_LOGERROR("Load prefab file failed");
+            loadXMLFile_.Reset();
+            return false;
+        }
+    }
+    else if (extension == ".json")
+    {
+        loadJSONFile_ = new JSONFile(context_);
+        if (!loadJSONFile_->Load(source))
+        {
+            URHO3D_LOGERROR("Load prefab file failed");
+            loadJSONFile_.Reset();
+            return false;
+        }
+    }
+    else
+    {
+        loadData_.SetData(source, source.GetSize() - source.GetPosition());
+        if (loadData_.GetSize() < sizeof(unsigned))
+        {
+            URHO3D_LOGERROR("Prefab data is empty");
+            loadData_.Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Prefab::EndLoad()
+{
+    URHO3D_PROFILE(CompilePrefab);
+
+    // Load into a scratch scene so that components initialize like in a real scene, then save the result
+    SharedPtr<Scene> scene(new Scene(context_));
+    scene->SetUpdateEnabled(false);
+    // Drawables log an error when added to a scene without an octree
+    scene->CreateComponent<Octree>(LOCAL);
+
+    SceneResolver resolver;
+    Node* node = scene->CreateChild(0, REPLICATED);
+    bool success = false;
+    if (loadXMLFile_)
+    {
+        XMLElement rootElem = loadXMLFile_->GetRoot();
+        resolver.AddNode(rootElem.GetUInt("id"), node);
+        success = node->LoadXML(rootElem, resolver, true, true, REPLICATED);
+    }
+    else if (loadJSONFile_)
+    {
+        const JSONValue& rootVal = loadJSONFile_->GetRoot();
+        resolver.AddNode(rootVal.Get("id").GetUInt(), node);
+        success = node->LoadJSON(rootVal, resolver, true, true, REPLICATED);
+    }
+    else if (loadData_.GetSize())
+    {
+        resolver.AddNode(loadData_.ReadUInt(), node);
+        success = node->Load(loadData_, resolver, true, true, REPLICATED);
+    }
+
+    if (success)
+    {
+        resolver.Resolve();
+        node->ApplyAttributes();
+        success = SetNode(node);
+    }
+
+    loadXMLFile_.Reset();
+    loadJSONFile_.Reset();
+    loadData_.Clear();
+
+    if (!success)
+    {
+        URHO3D_LOGERROR("Failed to compile prefab " + GetName());
+        Reset();
+    }
+
+    return success;
+}
+
+bool Prefab::Save(Serializer& dest) const
+{
+    if (!data_.GetSize())
+    {
+        URHO3D_LOGERROR("Can not save empty prefab");
+        return false;
+    }
+
+    return dest.Write(data_.GetData(), data_.GetSize()) == data_.GetSize();
+}
+
+bool Prefab::SetNode(Node* node)
+{
+    Reset();
+
+    if (!node || !node->Save(data_))
+    {
+        URHO3D_LOGERROR("Failed to compile prefab from node");
+        Reset();
+        return false;
+    }
+
+    PODVector<Node*> nodes;
+    node->GetChildren(nodes, true);
+    nodes.Push(node);
+    for (unsigned i = 0; i < nodes.Size(); ++i)
+    {
+        if (nodes[i]->IsTemporary())
+            continue;
+
+        ++numNodes_;
+        AddResources(nodes[i]);
+
+        const Vector<SharedPtr<Component> >& components = nodes[i]->GetComponents();
+        for (unsigned j = 0; j < components.Size(); ++j)
+        {
+            if (components[j]->IsTemporary())
+                continue;
+
+            ++numComponents_;
+            AddResources(components[j]);
+        }
+    }
+
+    SetMemoryUse(sizeof(Prefab) + data_.GetSize());
+    return true;
+}
+
+Node* Prefab::Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode) const
+{
+    URHO3D_PROFILE(InstantiatePrefab);
+
+    if (!parent)
+    {
+        URHO3D_LOGERROR("Null parent node for instantiating prefab " + GetName());
+        return nullptr;
+    }
+    if (!data_.GetSize())
+    {
+        URHO3D_LOGERROR("Can not instantiate empty prefab " + GetName());
+        return nullptr;
+    }
+
+    SceneResolver resolver;
+    MemoryBuffer source(data_.GetData(), data_.GetSize());
+    unsigned nodeID = source.ReadUInt();
+    // Rewrite IDs when instantiating
+    Node* node = parent->CreateChild(0, mode);
+    resolver.AddNode(nodeID, node);
+    if (node->Load(source, resolver, true, true, mode))
+    {
+        resolver.Resolve();
+        node->SetTransform(position, rotation);
+        node->ApplyAttributes();
+        return node;
+    }
+    else
+    {
+        node->Remove();
+        return nullptr;
+    }
+}
+
+void Prefab::AddResources(Serializable* object)
+{
+    const Vector<AttributeInfo>* attributes = object->GetAttributes();
+    if (!attributes)
+        return;
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    Variant value;
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (attr.type_ == VAR_RESOURCEREF)
+        {
+            object->OnGetAttribute(attr, value);
+            const ResourceRef& ref = value.GetResourceRef();
+            if (!ref.name_.Empty())
+            {
+                SharedPtr<Resource> resource(cache->GetResource(ref.type_, ref.name_));
+                if (resource && !resources_.Contains(resource))
+                    resources_.Push(resource);
+            }
+        }
+        else if (attr.type_ == VAR_RESOURCEREFLIST)
+        {
+            object->OnGetAttribute(attr, value);
+            const ResourceRefList& refList = value.GetResourceRefList();
+            for (unsigned j = 0; j < refList.names_.Size(); ++j)
+            {
+                if (refList.names_[j].Empty())
+                    continue;
+                SharedPtr<Resource> resource(cache->GetResource(refList.type_, refList.names_[j]));
+                if (resource && !resources_.Contains(resource))
+                    resources_.Push(resource);
+            }
+        }
+    }
+}
+
+void Prefab::Reset()
+{
+    data_.Clear();
+    resources_.Clear();
+    numNodes_ = 0;
+    numComponents_ = 0;
+}
+
+}
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/Resource.h"
+#include "../Scene/Node.h"
+
+namespace Urho3D
+{
+
+class JSONFile;
+class XMLFile;
+
+/// Compiled node hierarchy template. XML, JSON or binary node data is loaded once into a scratch scene and saved as binary node data, which is instantiated through the binary attribute readers. The resources referenced by the attributes are held for the prefab's lifetime.
+class URHO3D_API Prefab : public Resource
+{
+    URHO3D_OBJECT(Prefab, Resource);
+
+public:
+    /// Construct.
+    explicit Prefab(Context* context);
+    /// Destruct.
+    ~Prefab() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+    /// Save the compiled binary node data. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Compile from a node and its persistent children and components. Return true if successful.
+    bool SetNode(Node* node);
+    /// Instantiate as a child of a parent node. The transform is in the parent's space. Return the root node, or null if failed.
+    Node* Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED) const;
+
+    /// Return the compiled binary node data.
+    const PODVector<unsigned char>& GetData() const { return data_.GetBuffer(); }
+    /// Return number of nodes in the hierarchy.
+    unsigned GetNumNodes() const { return numNodes_; }
+    /// Return number of components in the hierarchy.
+    unsigned GetNumComponents() const { return numComponents_; }
+    /// Return the resources referenced by the attributes.
+    const Vector<SharedPtr<Resource> >& GetResources() const { return resources_; }
+
+private:
+    /// Add the resources referenced by an object's attributes.
+    void AddResources(Serializable* object);
+    /// Reset the compiled data.
+    void Reset();
+
+    /// Compiled binary node data, starting with the root node ID.
+    VectorBuffer data_;
+    /// Resources referenced by the attributes.
+    Vector<SharedPtr<Resource> > resources_;
+    /// Number of nodes.
+    unsigned numNodes_;
+    /// Number of components.
+    unsigned numComponents_;
+    /// XML file used while loading.
+    SharedPtr<XMLFile> loadXMLFile_;
+    /// JSON file used while loading.
+    SharedPtr<JSONFile> loadJSONFile_;
+    /// Binary data used while loading.
+    VectorBuffer loadData_;
+};
+
+}
@@ -0,0 +1,250 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/PrefabPool.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* LOGIC_CATEGORY;
+
+PrefabPool::PrefabPool(Context* context) :
+    Component(context),
+    maxSize_(0)
+{
+}
+
+PrefabPool::~PrefabPool() = default;
+
+void PrefabPool::RegisterObject(Context* context)
+{
+    context->RegisterFactory<PrefabPool>(LOGIC_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Prefab", GetPrefabAttr, SetPrefabAttr, ResourceRef, ResourceRef(Prefab::GetTypeStatic()),
+        AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Size", GetMaxSize, SetMaxSize, unsigned, 0, AM_DEFAULT);
+}
+
+void PrefabPool::SetPrefab(Prefab* prefab)
+{
+    if (prefab == prefab_)
+        return;
+
+    ClearIdle();
+
+    if (prefab_)
+        UnsubscribeFromEvent(prefab_, E_RELOADFINISHED);
+
+    prefab_ = prefab;
+
+    if (prefab_)
+        SubscribeToEvent(prefab_, E_RELOADFINISHED, URHO3D_HANDLER(PrefabPool, HandlePrefabReloadFinished));
+
+    MarkNetworkUpdate();
+}
+
+void PrefabPool::SetMaxSize(unsigned size)
+{
+    maxSize_ = size;
+
+    RemoveExpired();
+    while (maxSize_ && idle_.Size() > maxSize_)
+    {
+        idle_.Back()->Remove();
+        idle_.Pop();
+    }
+
+    MarkNetworkUpdate();
+}
+
+Node* PrefabPool::Spawn(const Vector3& position, const Quaternion& rotation)
+{
+    RemoveExpired();
+
+    Node* instance = nullptr;
+    if (!idle_.Empty())
+    {
+        instance = idle_.Back();
+        idle_.Pop();
+        instance->SetWorldTransform(position, rotation);
+        instance->ResetDeepEnabled();
+    }
+    else
+    {
+        instance = CreateInstance(position, rotation);
+        if (!instance)
+            return nullptr;
+    }
+
+    active_.Push(WeakPtr<Node>(instance));
+    return instance;
+}
+
+bool PrefabPool::Release(Node* instance)
+{
+    if (!instance)
+        return false;
+
+    Vector<WeakPtr<Node> >::Iterator i = active_.Find(WeakPtr<Node>(instance));
+    if (i == active_.End())
+    {
+        URHO3D_LOGWARNING("Node " + instance->GetName() + " is not an active instance of the prefab pool");
+        return false;
+    }
+    active_.Erase(i);
+
+    RemoveExpired();
+    if (!node_ || (maxSize_ && idle_.Size() >= maxSize_))
+    {
+        instance->Remove();
+        return true;
+    }
+
+    if (instance->GetParent() != node_)
+        instance->SetParent(node_);
+    instance->SetDeepEnabled(false);
+    idle_.Push(WeakPtr<Node>(instance));
+    return true;
+}
+
+void PrefabPool::Prewarm(unsigned count)
+{
+    RemoveExpired();
+    if (maxSize_)
+        count = Min(count, maxSize_);
+
+    while (idle_.Size() < count)
+    {
+        Node* instance = CreateInstance(Vector3::ZERO, Quaternion::IDENTITY);
+        if (!instance)
+            return;
+
+        instance->SetDeepEnabled(false);
+        idle_.Push(WeakPtr<Node>(instance));
+    }
+}
+
+void PrefabPool::ClearIdle()
+{
+    for (unsigned i = 0; i < idle_.Size(); ++i)
+    {
+        if (idle_[i])
+            idle_[i]->Remove();
+    }
+    idle_.Clear();
+}
+
+unsigned PrefabPool::GetNumActive() const
+{
+    unsigned num = 0;
+    for (unsigned i = 0; i < active_.Size(); ++i)
+    {
+        if (active_[i])
+            ++num;
+    }
+    return num;
+}
+
+unsigned PrefabPool::GetNumIdle() const
+{
+    unsigned num = 0;
+    for (unsigned i = 0; i < idle_.Size(); ++i)
+    {
+        if (idle_[i])
+            ++num;
+    }
+    return num;
+}
+
+void PrefabPool::SetPrefabAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetPrefab(cache->GetResource<Prefab>(value.name_));
+}
+
+ResourceRef PrefabPool::GetPrefabAttr() const
+{
+    return GetResourceRef(prefab_, Prefab::GetTypeStatic());
+}
+
+void PrefabPool::OnNodeSet(Node* node)
+{
+    // The instances are children of the node, so do not keep them when the pool is removed
+    if (!node)
+    {
+        ClearIdle();
+        active_.Clear();
+    }
+}
+
+Node* PrefabPool::CreateInstance(const Vector3& position, const Quaternion& rotation)
+{
+    if (!node_)
+    {
+        URHO3D_LOGERROR("Can not spawn from a prefab pool that is not assigned to a node");
+        return nullptr;
+    }
+    if (!prefab_)
+    {
+        URHO3D_LOGERROR("Can not spawn from a prefab pool without a prefab");
+        return nullptr;
+    }
+
+    // Instances are local and temporary, as they are runtime state of the pool
+    Quaternion parentInverse = node_->GetWorldRotation().Inverse();
+    Node* instance = prefab_->Instantiate(node_, node_->WorldToLocal(position), parentInverse * rotation, LOCAL);
+    if (instance)
+        instance->SetTemporary(true);
+    return instance;
+}
+
+void PrefabPool::RemoveExpired()
+{
+    for (unsigned i = idle_.Size() - 1; i < idle_.Size(); --i)
+    {
+        if (!idle_[i])
+            idle_.Erase(i);
+    }
+    for (unsigned i = active_.Size() - 1; i < active_.Size(); --i)
+    {
+        if (!active_[i])
+            active_.Erase(i);
+    }
+}
+
+void PrefabPool::HandlePrefabReloadFinished(StringHash eventType, VariantMap& eventData)
+{
+    // Idle instances were created from the previous data
+    ClearIdle();
+}
+
+}
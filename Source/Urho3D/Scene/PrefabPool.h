@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Scene/Component.h"
+#include "../Scene/Prefab.h"
+
+namespace Urho3D
+{
+
+/// Recycles instances of a prefab. Released instances are disabled and kept as temporary child nodes instead of being destroyed, and are reused by later spawns.
+class URHO3D_API PrefabPool : public Component
+{
+    URHO3D_OBJECT(PrefabPool, Component);
+
+public:
+    /// Construct.
+    explicit PrefabPool(Context* context);
+    /// Destruct.
+    ~PrefabPool() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set prefab. Idle instances of the previous prefab are removed.
+    void SetPrefab(Prefab* prefab);
+    /// Set maximum number of idle instances kept. Instances released beyond it are removed. Zero is unlimited.
+    void SetMaxSize(unsigned size);
+    /// Spawn an instance at a world position and rotation, reusing an idle instance if available. Return the instance's root node, or null if failed. Reused instances keep any state changed while they were active, except for the transform and enabled states.
+    Node* Spawn(const Vector3& position, const Quaternion& rotation = Quaternion::IDENTITY);
+    /// Release an instance spawned from this pool. It is disabled and kept for reuse, or removed if the pool is full. Return true if the node was an active instance.
+    bool Release(Node* instance);
+    /// Create idle instances until at least the given amount is available.
+    void Prewarm(unsigned count);
+    /// Remove all idle instances.
+    void ClearIdle();
+
+    /// Return prefab.
+    Prefab* GetPrefab() const { return prefab_; }
+    /// Return maximum number of idle instances kept.
+    unsigned GetMaxSize() const { return maxSize_; }
+    /// Return number of active instances.
+    unsigned GetNumActive() const;
+    /// Return number of idle instances.
+    unsigned GetNumIdle() const;
+
+    /// Set prefab attribute.
+    void SetPrefabAttr(const ResourceRef& value);
+    /// Return prefab attribute.
+    ResourceRef GetPrefabAttr() const;
+
+protected:
+    /// Handle node being assigned.
+    void OnNodeSet(Node* node) override;
+
+private:
+    /// Instantiate the prefab as a temporary child node at a world position and rotation. Return null if failed.
+    Node* CreateInstance(const Vector3& position, const Quaternion& rotation);
+    /// Remove pointers to instances that have been destroyed.
+    void RemoveExpired();
+    /// Handle prefab reload.
+    void HandlePrefabReloadFinished(StringHash eventType, VariantMap& eventData);
+
+    /// Prefab.
+    SharedPtr<Prefab> prefab_;
+    /// Active instances.
+    Vector<WeakPtr<Node> > active_;
+    /// Idle instances.
+    Vector<WeakPtr<Node> > idle_;
+    /// Maximum number of idle instances.
+    unsigned maxSize_;
+};
+
+}
@@ -26,6 +26,7 @@
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/Ptr.h"
+#include "../Math/Vector3.h"
 #include "../Math/StringHash.h"
 
 #include <cstring>
@@ -88,6 +89,17 @@ struct URHO3D_API DirtyBits
         }
     }
 
+    /// Set the bits that are set in another bitmask.
+    void Set(const DirtyBits& bits)
+    {
+        count_ = 0;
+        for (unsigned i = 0; i < MAX_NETWORK_ATTRIBUTES / 8; ++i)
+        {
+            data_[i] |= bits.data_[i];
+            count_ += (unsigned char)CountSetBits(data_[i]);
+        }
+    }
+
     /// Clear all bits.
     void ClearAll()
     {
@@ -126,6 +138,8 @@ struct URHO3D_API NetworkState
     Vector<Variant> currentValues_;
     /// Previous network attribute values.
     Vector<Variant> previousValues_;
+    /// Current network attribute values serialized once for all connections. Empty if not cached.
+    Vector<PODVector<unsigned char> > serializedValues_;
     /// Replication states that are tracking this object.
     PODVector<ReplicationState*> replicationStates_;
     /// Previous user variables.
@@ -178,11 +192,17 @@ struct URHO3D_API SceneReplicationState : public ReplicationState
     HashMap<unsigned, NodeReplicationState> nodeStates_;
     /// Dirty node IDs.
     HashSet<unsigned> dirtyNodes_;
+    /// Dirty node IDs held back by interest management, by interest grid cell.
+    HashMap<IntVector3, PODVector<unsigned> > deferredCells_;
+    /// Interest grid cell of each held back node ID.
+    HashMap<unsigned, IntVector3> deferredNodes_;
 
     void Clear()
     {
         nodeStates_.Clear();
         dirtyNodes_.Clear();
+        deferredCells_.Clear();
+        deferredNodes_.Clear();
     }
 };
 
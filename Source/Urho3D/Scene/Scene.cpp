@@ -22,19 +22,24 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
 #include "../Scene/Component.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/Prefab.h"
+#include "../Scene/PrefabPool.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -54,9 +59,154 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
+static const float DEFAULT_SNAPSHOT_DELAY = 0.1f;
+static const unsigned MIN_TRANSFORMS_PER_SMOOTHING_WORK_ITEM = 256;
+static const unsigned MIN_TRANSFORM_ROOTS_PER_WORK_ITEM = 64;
+static const unsigned MIN_OBJECTS_PER_NETWORK_UPDATE_WORK_ITEM = 256;
+/// Work item priority of the pipelined update. Lower than what rendering waits for, so that rendering does not wait for the update.
+static const unsigned PIPELINED_UPDATE_PRIORITY = M_MAX_UNSIGNED - 1;
+
+static void UpdateTransformsRecursive(Node* node)
+{
+    // The parent has already been updated, so calculating the world transform does not recurse upward. Children may be dirty
+    // even if the node is not, in case the node's world transform was read after it was marked dirty
+    if (node->IsDirty())
+        node->GetWorldTransform();
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
+        UpdateTransformsRecursive(*i);
+}
+
+void UpdateLogicComponentsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<LogicComponent**>(item->start_);
+    auto** end = reinterpret_cast<LogicComponent**>(item->end_);
+    float timeStep = *(reinterpret_cast<float*>(item->aux_));
+
+    while (start != end)
+        (*start++)->Update(timeStep);
+}
+
+const char* smoothingModeNames[] =
+{
+    "Exponential",
+    "Snapshot",
+    nullptr
+};
+
+/// Input and output arrays of the batched smoothing update.
+struct SmoothingBatch
+{
+    /// Smoothed transforms.
+    SmoothedTransform** transforms_;
+    /// Calculated positions.
+    Vector3* positions_;
+    /// Calculated rotations.
+    Quaternion* rotations_;
+    /// Smoothing operations still in progress.
+    SmoothingTypeFlags* remaining_;
+    /// Exponential smoothing constant for this frame.
+    float constant_;
+    /// Squared snap threshold.
+    float squaredSnapThreshold_;
+    /// Scene time to interpolate the snapshots at.
+    float snapshotTime_;
+    /// Snapshot interpolation flag.
+    bool snapshot_;
+};
+
+static void CalculateSmoothingRange(const SmoothingBatch& batch, unsigned start, unsigned end)
+{
+    for (unsigned i = start; i < end; ++i)
+    {
+        SmoothedTransform* transform = batch.transforms_[i];
+        if (!transform)
+            continue;
+
+        if (batch.snapshot_)
+        {
+            batch.remaining_[i] = transform->CalculateSnapshotSmoothing(batch.snapshotTime_, batch.squaredSnapThreshold_,
+                batch.positions_[i], batch.rotations_[i]);
+        }
+        else
+        {
+            batch.remaining_[i] = transform->CalculateSmoothing(batch.constant_, batch.squaredSnapThreshold_, batch.positions_[i],
+                batch.rotations_[i]);
+        }
+    }
+}
+
+void CalculateSmoothingWork(const WorkItem* item, unsigned threadIndex)
+{
+    const SmoothingBatch& batch = *(reinterpret_cast<const SmoothingBatch*>(item->aux_));
+    auto** start = reinterpret_cast<SmoothedTransform**>(item->start_);
+    auto** end = reinterpret_cast<SmoothedTransform**>(item->end_);
+    CalculateSmoothingRange(batch, (unsigned)(start - batch.transforms_), (unsigned)(end - batch.transforms_));
+}
+
+static bool CompareLogicComponentTypes(LogicComponent* lhs, LogicComponent* rhs)
+{
+    return lhs->GetType() < rhs->GetType();
+}
+
+void UpdateTransformsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<Node**>(item->start_);
+    auto** end = reinterpret_cast<Node**>(item->end_);
+
+    while (start != end)
+        UpdateTransformsRecursive(*start++);
+}
+
+void CheckNetworkNodesWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<Node**>(item->start_);
+    auto** end = reinterpret_cast<Node**>(item->end_);
+    NetworkUpdateBuffer& buffer = reinterpret_cast<NetworkUpdateBuffer*>(item->aux_)[threadIndex];
+
+    while (start != end)
+    {
+        Node* node = *start++;
+        NetworkUpdateChange change;
+        change.varStart_ = buffer.vars_.Size();
+        if (node->CheckNetworkUpdate(change.dirtyAttributes_, buffer.vars_))
+        {
+            change.node_ = node;
+            change.component_ = nullptr;
+            change.numVars_ = buffer.vars_.Size() - change.varStart_;
+            buffer.changes_.Push(change);
+        }
+    }
+}
+
+void CheckNetworkComponentsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<Component**>(item->start_);
+    auto** end = reinterpret_cast<Component**>(item->end_);
+    NetworkUpdateBuffer& buffer = reinterpret_cast<NetworkUpdateBuffer*>(item->aux_)[threadIndex];
+
+    while (start != end)
+    {
+        Component* component = *start++;
+        NetworkUpdateChange change;
+        if (component->CheckNetworkUpdate(change.dirtyAttributes_))
+        {
+            change.node_ = nullptr;
+            change.component_ = component;
+            change.varStart_ = 0;
+            change.numVars_ = 0;
+            buffer.changes_.Push(change);
+        }
+    }
+}
 
 Scene::Scene(Context* context) :
     Node(context),
+    replicatedNodes_(FIRST_REPLICATED_ID),
+    localNodes_(FIRST_LOCAL_ID),
+    replicatedComponents_(FIRST_REPLICATED_ID),
+    localComponents_(FIRST_LOCAL_ID),
     replicatedNodeID_(FIRST_REPLICATED_ID),
     replicatedComponentID_(FIRST_REPLICATED_ID),
     localNodeID_(FIRST_LOCAL_ID),
@@ -65,17 +215,24 @@ Scene::Scene(Context* context) :
     asyncLoadingMs_(5),
     timeScale_(1.0f),
     elapsedTime_(0),
+    threadedTimeStep_(0.0f),
     smoothingConstant_(DEFAULT_SMOOTHING_CONSTANT),
     snapThreshold_(DEFAULT_SNAP_THRESHOLD),
+    snapshotDelay_(DEFAULT_SNAPSHOT_DELAY),
+    smoothingMode_(SMOOTHING_EXPONENTIAL),
     updateEnabled_(true),
     asyncLoading_(false),
-    threadedUpdate_(false)
+    threadedUpdate_(false),
+    threadedUpdateOrderDirty_(false),
+    pipelinedUpdated_(false)
 {
     // Assign an ID to self so that nodes can refer to this node as a parent
     SetID(GetFreeNodeID(REPLICATED));
     NodeAdded(this);
 
     SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(Scene, HandleUpdate));
+    SubscribeToEvent(E_BEGINPIPELINEDUPDATE, URHO3D_HANDLER(Scene, HandleBeginPipelinedUpdate));
+    SubscribeToEvent(E_ENDPIPELINEDUPDATE, URHO3D_HANDLER(Scene, HandleEndPipelinedUpdate));
     SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(Scene, HandleResourceBackgroundLoaded));
 }
 
@@ -87,10 +244,10 @@ Scene::~Scene()
     RemoveAllChildren();
 
     // Remove scene reference and owner from all nodes that still exist
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        i->second_->ResetScene();
-    for (HashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
-        i->second_->ResetScene();
+    for (IDMap<Node>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+        (*i)->ResetScene();
+    for (IDMap<Node>::ConstIterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
+        (*i)->ResetScene();
 }
 
 void Scene::RegisterObject(Context* context)
@@ -102,6 +259,9 @@ void Scene::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Smoothing Constant", GetSmoothingConstant, SetSmoothingConstant, float, DEFAULT_SMOOTHING_CONSTANT,
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Snap Threshold", GetSnapThreshold, SetSnapThreshold, float, DEFAULT_SNAP_THRESHOLD, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Smoothing Mode", GetSmoothingMode, SetSmoothingMode, SmoothingMode, smoothingModeNames,
+        SMOOTHING_EXPONENTIAL, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Snapshot Delay", GetSnapshotDelay, SetSnapshotDelay, float, DEFAULT_SNAPSHOT_DELAY, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Elapsed Time", GetElapsedTime, SetElapsedTime, float, 0.0f, AM_FILE);
     URHO3D_ATTRIBUTE("Next Replicated Node ID", unsigned, replicatedNodeID_, FIRST_REPLICATED_ID, AM_FILE | AM_NOEDIT);
     URHO3D_ATTRIBUTE("Next Replicated Component ID", unsigned, replicatedComponentID_, FIRST_REPLICATED_ID, AM_FILE | AM_NOEDIT);
@@ -210,8 +370,8 @@ void Scene::AddReplicationState(NodeReplicationState* state)
     Node::AddReplicationState(state);
 
     // This is the first update for a new connection. Mark all replicated nodes dirty
-    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        state->sceneState_->dirtyNodes_.Insert(i->first_);
+    for (IDMap<Node>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+        state->sceneState_->dirtyNodes_.Insert(i.GetID());
 }
 
 bool Scene::LoadXML(Deserializer& source)
@@ -344,17 +504,8 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
 
     if (mode > LOAD_RESOURCES_ONLY)
     {
-        // Preload resources if appropriate, then return to the original position for loading the scene content
-        if (mode != LOAD_SCENE)
-        {
-            URHO3D_PROFILE(FindResourcesToPreload);
-
-            unsigned currentPos = file->GetPosition();
-            PreloadResources(file, isSceneFile);
-            file->Seek(currentPos);
-        }
-
         // Store own old ID for resolving possible root node references
+        unsigned dataPos = file->GetPosition();
         unsigned nodeID = file->ReadUInt();
         resolver_.AddNode(nodeID, this);
 
@@ -365,8 +516,25 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
             return false;
         }
 
-        // Then prepare to load child nodes in the async updates
+        // Then prepare to load child nodes in the async updates. They are read and parsed in a worker thread, which also
+        // finds the resources to preload, and the main thread only constructs them
         asyncProgress_.totalNodes_ = file->ReadVLE();
+        asyncProgress_.parser_ = new SceneParser(context_, file, asyncProgress_.totalNodes_, mode != LOAD_SCENE);
+        if (!asyncProgress_.parser_->Run())
+        {
+            // Without threads, load from the file in the async updates. Preload resources if appropriate from the start of
+            // the scene data, then return to the child nodes
+            asyncProgress_.parser_.Reset();
+            if (mode != LOAD_SCENE)
+            {
+                URHO3D_PROFILE(FindResourcesToPreload);
+
+                unsigned currentPos = file->GetPosition();
+                file->Seek(dataPos);
+                PreloadResources(file, isSceneFile);
+                file->Seek(currentPos);
+            }
+        }
     }
     else
     {
@@ -389,6 +557,10 @@ bool Scene::LoadAsyncXML(File* file, LoadMode mode)
 
     StopAsyncLoading();
 
+    // Text files are split into per-node documents by a worker thread, so that the whole scene is never in memory as one
+    if (LoadAsyncStream(file, SSF_XML, mode))
+        return true;
+
     SharedPtr<XMLFile> xml(new XMLFile(context_));
     if (!xml->Load(*file))
         return false;
@@ -458,6 +630,9 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
 
     StopAsyncLoading();
 
+    if (LoadAsyncStream(file, SSF_JSON, mode))
+        return true;
+
     SharedPtr<JSONFile> json(new JSONFile(context_));
     if (!json->Load(*file))
         return false;
@@ -516,6 +691,14 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
 void Scene::StopAsyncLoading()
 {
     asyncLoading_ = false;
+    // Stop the parser before releasing the file it reads
+    asyncProgress_.parser_.Reset();
+    asyncProgress_.parsedNodes_.Clear();
+    asyncProgress_.createdNodes_.Clear();
+    asyncProgress_.streamParser_.Reset();
+    asyncProgress_.streamDocuments_.Clear();
+    asyncProgress_.streamIndex_ = 0;
+    asyncProgress_.streamHeadLoaded_ = false;
     asyncProgress_.file_.Reset();
     asyncProgress_.xmlFile_.Reset();
     asyncProgress_.jsonFile_.Reset();
@@ -664,6 +847,18 @@ void Scene::SetSnapThreshold(float threshold)
     Node::MarkNetworkUpdate();
 }
 
+void Scene::SetSmoothingMode(SmoothingMode mode)
+{
+    smoothingMode_ = mode;
+    Node::MarkNetworkUpdate();
+}
+
+void Scene::SetSnapshotDelay(float delay)
+{
+    snapshotDelay_ = Max(delay, 0.0f);
+    Node::MarkNetworkUpdate();
+}
+
 void Scene::SetAsyncLoadingMs(int ms)
 {
     asyncLoadingMs_ = Max(ms, 1);
@@ -706,15 +901,9 @@ void Scene::UnregisterAllVars()
 Node* Scene::GetNode(unsigned id) const
 {
     if (IsReplicatedID(id))
-    {
-        HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
-        return i != replicatedNodes_.End() ? i->second_ : nullptr;
-    }
+        return replicatedNodes_.Find(id);
     else
-    {
-        HashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
-        return i != localNodes_.End() ? i->second_ : nullptr;
-    }
+        return localNodes_.Find(id);
 }
 
 bool Scene::GetNodesWithTag(PODVector<Node*>& dest, const String& tag) const
@@ -733,15 +922,9 @@ bool Scene::GetNodesWithTag(PODVector<Node*>& dest, const String& tag) const
 Component* Scene::GetComponent(unsigned id) const
 {
     if (IsReplicatedID(id))
-    {
-        HashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
-        return i != replicatedComponents_.End() ? i->second_ : nullptr;
-    }
+        return replicatedComponents_.Find(id);
     else
-    {
-        HashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
-        return i != localComponents_.End() ? i->second_ : nullptr;
-    }
+        return localComponents_.Find(id);
 }
 
 float Scene::GetAsyncProgress() const
@@ -759,6 +942,7 @@ const String& Scene::GetVarName(StringHash hash) const
 
 void Scene::Update(float timeStep)
 {
+    AllocationTagScope allocationTag(ALLOCTAG_SCENE);
     if (asyncLoading_)
     {
         UpdateAsyncLoading();
@@ -780,35 +964,329 @@ void Scene::Update(float timeStep)
     // Update variable timestep logic
     SendEvent(E_SCENEUPDATE, eventData);
 
+    // Update thread-safe logic components in parallel
+    UpdateThreadedComponents(timeStep);
+
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    UpdateAnimatedObjects(timeStep);
 
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
     SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
 
     // Update transform smoothing
-    {
-        URHO3D_PROFILE(UpdateSmoothing);
-
-        float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
-        float squaredSnapThreshold = snapThreshold_ * snapThreshold_;
-
-        using namespace UpdateSmoothing;
-
-        smoothingData_[P_CONSTANT] = constant;
-        smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
-        SendEvent(E_UPDATESMOOTHING, smoothingData_);
-    }
+    UpdateSmoothing(timeStep);
 
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
 
+    // Update the world transforms of moved nodes in one pass, instead of lazily during rendering
+    UpdateTransforms();
+
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
     // SetElapsedTime()
     elapsedTime_ += timeStep;
 }
 
+void Scene::AddThreadedUpdateComponent(LogicComponent* component)
+{
+    threadedUpdateComponents_.Push(component);
+    threadedUpdateOrderDirty_ = true;
+}
+
+void Scene::RemoveThreadedUpdateComponent(LogicComponent* component)
+{
+    // Order does not need to be kept, it is restored by sorting before the next update
+    PODVector<LogicComponent*>::Iterator i = threadedUpdateComponents_.Find(component);
+    if (i != threadedUpdateComponents_.End())
+    {
+        *i = threadedUpdateComponents_.Back();
+        threadedUpdateComponents_.Pop();
+        threadedUpdateOrderDirty_ = true;
+    }
+}
+
+void Scene::AddAnimatedObject(Animatable* animatable)
+{
+    animatedObjects_.Push(WeakPtr<Animatable>(animatable));
+}
+
+void Scene::RemoveAnimatedObject(Animatable* animatable)
+{
+    // May be called during the update, so only clear the entry
+    for (unsigned i = 0; i < animatedObjects_.Size(); ++i)
+    {
+        if (animatedObjects_[i] == animatable)
+        {
+            animatedObjects_[i].Reset();
+            break;
+        }
+    }
+}
+
+void Scene::AddSmoothedTransform(SmoothedTransform* transform)
+{
+    transform->smoothingIndex_ = smoothedTransforms_.Size();
+    transform->smoothingScene_ = this;
+    smoothedTransforms_.Push(transform);
+}
+
+void Scene::RemoveSmoothedTransform(SmoothedTransform* transform)
+{
+    // May be called during the update, so only clear the entry
+    if (transform->smoothingIndex_ < smoothedTransforms_.Size() && smoothedTransforms_[transform->smoothingIndex_] == transform)
+        smoothedTransforms_[transform->smoothingIndex_] = nullptr;
+    transform->smoothingIndex_ = M_MAX_UNSIGNED;
+    transform->smoothingScene_.Reset();
+}
+
+void Scene::UpdateSmoothing(float timeStep)
+{
+    URHO3D_PROFILE(UpdateSmoothing);
+
+    float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
+    float squaredSnapThreshold = snapThreshold_ * snapThreshold_;
+
+    // Drop the removed transforms and those that finished smoothing, also when snapped outside the update
+    unsigned numTransforms = 0;
+    for (unsigned i = 0; i < smoothedTransforms_.Size(); ++i)
+    {
+        SmoothedTransform* transform = smoothedTransforms_[i];
+        if (!transform)
+            continue;
+        if (!transform->IsInProgress())
+        {
+            transform->smoothingIndex_ = M_MAX_UNSIGNED;
+            transform->smoothingScene_.Reset();
+            continue;
+        }
+        transform->smoothingIndex_ = numTransforms;
+        smoothedTransforms_[numTransforms++] = transform;
+    }
+    smoothedTransforms_.Resize(numTransforms);
+
+    if (numTransforms)
+    {
+        smoothingPositions_.Resize(numTransforms);
+        smoothingRotations_.Resize(numTransforms);
+        smoothingRemaining_.Resize(numTransforms);
+
+        SmoothingBatch batch;
+        batch.transforms_ = smoothedTransforms_.Buffer();
+        batch.positions_ = smoothingPositions_.Buffer();
+        batch.rotations_ = smoothingRotations_.Buffer();
+        batch.remaining_ = smoothingRemaining_.Buffer();
+        batch.constant_ = constant;
+        batch.squaredSnapThreshold_ = squaredSnapThreshold;
+        batch.snapshotTime_ = elapsedTime_ - snapshotDelay_;
+        batch.snapshot_ = smoothingMode_ == SMOOTHING_SNAPSHOT;
+
+        // Calculate the transforms without touching the nodes, so that ranges can be calculated in worker threads
+        auto* queue = GetSubsystem<WorkQueue>();
+        unsigned numThreads = queue ? queue->GetNumThreads() : 0;
+        if (!numThreads || numTransforms < 2 * MIN_TRANSFORMS_PER_SMOOTHING_WORK_ITEM)
+            CalculateSmoothingRange(batch, 0, numTransforms);
+        else
+        {
+            unsigned numWorkItems = Min(numThreads + 1, numTransforms / MIN_TRANSFORMS_PER_SMOOTHING_WORK_ITEM);
+            unsigned transformsPerItem = numTransforms / numWorkItems;
+            SmoothedTransform** start = smoothedTransforms_.Buffer();
+
+            for (unsigned i = 0; i < numWorkItems; ++i)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = CalculateSmoothingWork;
+                item->name_ = "CalculateSmoothingWork";
+                item->aux_ = &batch;
+                item->start_ = start + i * transformsPerItem;
+                item->end_ = i < numWorkItems - 1 ? start + (i + 1) * transformsPerItem : start + numTransforms;
+                queue->AddWorkItem(item);
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+
+        // Write the node transforms on the main thread. Entries may be cleared by dirty notifications while applying
+        for (unsigned i = 0; i < numTransforms; ++i)
+        {
+            SmoothedTransform* transform = smoothedTransforms_[i];
+            if (transform)
+                transform->ApplySmoothing(smoothingPositions_[i], smoothingRotations_[i], smoothingRemaining_[i]);
+        }
+    }
+
+    // Send the event for custom smoothing by the application
+    using namespace UpdateSmoothing;
+
+    smoothingData_[P_CONSTANT] = constant;
+    smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
+    SendEvent(E_UPDATESMOOTHING, smoothingData_);
+}
+
+void Scene::UpdateAnimatedObjects(float timeStep)
+{
+    if (animatedObjects_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateAttributeAnimations);
+
+    // Objects added during the update are updated from the next frame
+    unsigned numObjects = animatedObjects_.Size();
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Animatable* animatable = animatedObjects_[i];
+        if (animatable)
+            animatable->UpdateAttributeAnimations(timeStep);
+    }
+
+    // Remove the cleared and destroyed objects, keeping the update order
+    unsigned numRemaining = 0;
+    for (unsigned i = 0; i < animatedObjects_.Size(); ++i)
+    {
+        if (!animatedObjects_[i].Expired())
+        {
+            if (numRemaining != i)
+                animatedObjects_[numRemaining] = animatedObjects_[i];
+            ++numRemaining;
+        }
+    }
+    animatedObjects_.Resize(numRemaining);
+}
+
+void Scene::UpdateThreadedComponents(float timeStep)
+{
+    // With pipelined frames the components may have already been updated while the previous frame was rendered
+    if (pipelinedUpdated_)
+    {
+        pipelinedUpdated_ = false;
+        return;
+    }
+
+    if (threadedUpdateComponents_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateThreadedComponents);
+
+    SortThreadedComponents();
+    BeginThreadedUpdate();
+
+    if (!threadedUpdate_)
+    {
+        for (PODVector<LogicComponent*>::ConstIterator i = threadedUpdateComponents_.Begin(); i != threadedUpdateComponents_.End(); ++i)
+            (*i)->Update(timeStep);
+        return;
+    }
+
+    QueueThreadedComponents(timeStep, M_MAX_UNSIGNED);
+    GetSubsystem<WorkQueue>()->Complete(M_MAX_UNSIGNED);
+
+    // Notify the components whose dirtying was delayed
+    EndThreadedUpdate();
+}
+
+void Scene::SortThreadedComponents()
+{
+    // Batch the components by type so that each worker mostly runs the same update code
+    if (threadedUpdateOrderDirty_)
+    {
+        Sort(threadedUpdateComponents_.Begin(), threadedUpdateComponents_.End(), CompareLogicComponentTypes);
+        threadedUpdateOrderDirty_ = false;
+    }
+}
+
+void Scene::QueueThreadedComponents(float timeStep, unsigned priority)
+{
+    threadedTimeStep_ = timeStep;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = Min(queue->GetNumThreads() + 1, threadedUpdateComponents_.Size()); // Worker threads + main thread
+    unsigned componentsPerItem = threadedUpdateComponents_.Size() / numWorkItems;
+    LogicComponent** start = threadedUpdateComponents_.Buffer();
+
+    for (unsigned i = 0; i < numWorkItems; ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = priority;
+        item->workFunction_ = UpdateLogicComponentsWork;
+        item->name_ = "UpdateLogicComponentsWork";
+        item->aux_ = &threadedTimeStep_;
+        item->start_ = start + i * componentsPerItem;
+        item->end_ = i < numWorkItems - 1 ? start + (i + 1) * componentsPerItem : start + threadedUpdateComponents_.Size();
+        queue->AddWorkItem(item);
+    }
+}
+
+void Scene::UpdateTransforms()
+{
+    if (dirtyTransformNodes_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateTransforms);
+
+    transformNodeSet_.Clear();
+    for (Vector<WeakPtr<Node> >::ConstIterator i = dirtyTransformNodes_.Begin(); i != dirtyTransformNodes_.End(); ++i)
+    {
+        Node* node = *i;
+        if (node && node->GetScene() == this)
+            transformNodeSet_.Insert(node);
+    }
+    dirtyTransformNodes_.Clear();
+
+    // Visit each subtree once: skip the nodes that are inside the subtree of another marked node. The remaining subtrees are
+    // disjoint and their parents are not dirty, so they can be updated in parallel
+    transformRoots_.Clear();
+    for (HashSet<Node*>::ConstIterator i = transformNodeSet_.Begin(); i != transformNodeSet_.End(); ++i)
+    {
+        Node* parent = (*i)->GetParent();
+        while (parent && !transformNodeSet_.Contains(parent))
+            parent = parent->GetParent();
+        if (!parent)
+            transformRoots_.Push(*i);
+    }
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numThreads = queue ? queue->GetNumThreads() : 0;
+    unsigned numRoots = transformRoots_.Size();
+
+    if (!numThreads || numRoots < 2 * MIN_TRANSFORM_ROOTS_PER_WORK_ITEM)
+    {
+        for (PODVector<Node*>::ConstIterator i = transformRoots_.Begin(); i != transformRoots_.End(); ++i)
+            UpdateTransformsRecursive(*i);
+    }
+    else
+    {
+        unsigned numWorkItems = Min(numThreads + 1, numRoots / MIN_TRANSFORM_ROOTS_PER_WORK_ITEM);
+        unsigned rootsPerItem = numRoots / numWorkItems;
+        Node** start = transformRoots_.Buffer();
+
+        for (unsigned i = 0; i < numWorkItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = UpdateTransformsWork;
+            item->name_ = "UpdateTransformsWork";
+            item->start_ = start + i * rootsPerItem;
+            item->end_ = i < numWorkItems - 1 ? start + (i + 1) * rootsPerItem : start + numRoots;
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+}
+
+void Scene::MarkTransformDirty(Node* node)
+{
+    if (threadedUpdate_)
+    {
+        MutexLock lock(sceneMutex_);
+        dirtyTransformNodes_.Push(WeakPtr<Node>(node));
+    }
+    else
+        dirtyTransformNodes_.Push(WeakPtr<Node>(node));
+}
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -908,6 +1386,43 @@ void Scene::NodeAdded(Node* node)
     if (!node || node->GetScene() == this)
         return;
 
+    // Cache the names of the whole hierarchy first, so that components can find child nodes by name already when added
+    AddNamedNodes(node);
+    AddNodeRecursive(node);
+}
+
+void Scene::AddNamedNodes(Node* node)
+{
+    if (node->GetScene() == this)
+        return;
+
+    if (node->GetNameHash())
+        namedNodes_[node->GetNameHash()].Push(node);
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
+        AddNamedNodes(*i);
+}
+
+void Scene::RemoveNamedNode(Node* node, StringHash nameHash)
+{
+    if (!nameHash)
+        return;
+
+    HashMap<StringHash, PODVector<Node*> >::Iterator i = namedNodes_.Find(nameHash);
+    if (i != namedNodes_.End())
+    {
+        i->second_.Remove(node);
+        if (i->second_.Empty())
+            namedNodes_.Erase(i);
+    }
+}
+
+void Scene::AddNodeRecursive(Node* node)
+{
+    if (node->GetScene() == this)
+        return;
+
     // Remove from old scene first
     Scene* oldScene = node->GetScene();
     if (oldScene)
@@ -915,6 +1430,10 @@ void Scene::NodeAdded(Node* node)
 
     node->SetScene(this);
 
+    // A node that was marked dirty outside the scene was not recorded for the world transform update
+    if (node->IsDirty())
+        MarkTransformDirty(node);
+
     // If the new node has an ID of zero (default), assign a replicated ID now
     unsigned id = node->GetID();
     if (!id)
@@ -926,27 +1445,27 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (IsReplicatedID(id))
     {
-        HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
-        if (i != replicatedNodes_.End() && i->second_ != node)
+        Node* existing = replicatedNodes_.Find(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
-            NodeRemoved(i->second_);
+            NodeRemoved(existing);
         }
 
-        replicatedNodes_[id] = node;
+        replicatedNodes_.Insert(id, node);
 
         MarkNetworkUpdate(node);
         MarkReplicationDirty(node);
     }
     else
     {
-        HashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
-        if (i != localNodes_.End() && i->second_ != node)
+        Node* existing = localNodes_.Find(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
-            NodeRemoved(i->second_);
+            NodeRemoved(existing);
         }
-        localNodes_[id] = node;
+        localNodes_.Insert(id, node);
     }
 
     // Cache tag if already tagged.
@@ -963,7 +1482,7 @@ void Scene::NodeAdded(Node* node)
         ComponentAdded(*i);
     const Vector<SharedPtr<Node> >& children = node->GetChildren();
     for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
-        NodeAdded(*i);
+        AddNodeRecursive(*i);
 }
 
 void Scene::NodeTagAdded(Node* node, const String& tag)
@@ -976,6 +1495,25 @@ void Scene::NodeTagRemoved(Node* node, const String& tag)
     taggedNodes_[tag].Remove(node);
 }
 
+void Scene::NodeNameChanged(Node* node, StringHash oldNameHash)
+{
+    RemoveNamedNode(node, oldNameHash);
+    if (node->GetNameHash())
+        namedNodes_[node->GetNameHash()].Push(node);
+}
+
+const PODVector<Node*>* Scene::GetNamedNodes(StringHash nameHash) const
+{
+    HashMap<StringHash, PODVector<Node*> >::ConstIterator i = namedNodes_.Find(nameHash);
+    return i != namedNodes_.End() ? &i->second_ : nullptr;
+}
+
+const PODVector<Node*>* Scene::GetTaggedNodes(const String& tag) const
+{
+    HashMap<StringHash, PODVector<Node*> >::ConstIterator i = taggedNodes_.Find(tag);
+    return i != taggedNodes_.End() ? &i->second_ : nullptr;
+}
+
 void Scene::NodeRemoved(Node* node)
 {
     if (!node || node->GetScene() != this)
@@ -992,7 +1530,8 @@ void Scene::NodeRemoved(Node* node)
 
     node->ResetScene();
 
-    // Remove node from tag cache
+    // Remove node from name and tag caches
+    RemoveNamedNode(node, node->GetNameHash());
     if (!node->GetTags().Empty())
     {
         const StringVector& tags = node->GetTags();
@@ -1025,25 +1564,25 @@ void Scene::ComponentAdded(Component* component)
 
     if (IsReplicatedID(id))
     {
-        HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
-        if (i != replicatedComponents_.End() && i->second_ != component)
+        Component* existing = replicatedComponents_.Find(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
-            ComponentRemoved(i->second_);
+            ComponentRemoved(existing);
         }
 
-        replicatedComponents_[id] = component;
+        replicatedComponents_.Insert(id, component);
     }
     else
     {
-        HashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
-        if (i != localComponents_.End() && i->second_ != component)
+        Component* existing = localComponents_.Find(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
-            ComponentRemoved(i->second_);
+            ComponentRemoved(existing);
         }
 
-        localComponents_[id] = component;
+        localComponents_.Insert(id, component);
     }
 
     component->OnSceneSet(this);
@@ -1088,8 +1627,11 @@ String Scene::GetVarNamesAttr() const
     return ret;
 }
 
-void Scene::PrepareNetworkUpdate()
+void Scene::PrepareNetworkUpdate(bool threaded)
 {
+    if (threaded && PrepareNetworkUpdateThreaded())
+        return;
+
     for (HashSet<unsigned>::Iterator i = networkUpdateNodes_.Begin(); i != networkUpdateNodes_.End(); ++i)
     {
         Node* node = GetNode(*i);
@@ -1108,15 +1650,113 @@ void Scene::PrepareNetworkUpdate()
     networkUpdateComponents_.Clear();
 }
 
+bool Scene::PrepareNetworkUpdateThreaded()
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numThreads = queue ? queue->GetNumThreads() : 0;
+    unsigned numObjects = networkUpdateNodes_.Size() + networkUpdateComponents_.Size();
+    if (!numThreads || numObjects < 2 * MIN_OBJECTS_PER_NETWORK_UPDATE_WORK_ITEM)
+        return false;
+
+    URHO3D_PROFILE(PrepareNetworkUpdateThreaded);
+
+    // Attribute getters may read the world transform, so make sure no worker needs to update it
+    UpdateTransforms();
+
+    networkCheckNodes_.Clear();
+    networkCheckComponents_.Clear();
+
+    for (HashSet<unsigned>::Iterator i = networkUpdateNodes_.Begin(); i != networkUpdateNodes_.End(); ++i)
+    {
+        Node* node = GetNode(*i);
+        if (node)
+            networkCheckNodes_.Push(node);
+    }
+
+    // Components whose attributes can not be read in worker threads are checked right away
+    for (HashSet<unsigned>::Iterator i = networkUpdateComponents_.Begin(); i != networkUpdateComponents_.End(); ++i)
+    {
+        Component* component = GetComponent(*i);
+        if (!component)
+            continue;
+        if (component->IsThreadSafeNetworkUpdate())
+            networkCheckComponents_.Push(component);
+        else
+            component->PrepareNetworkUpdate();
+    }
+
+    networkUpdateNodes_.Clear();
+    networkUpdateComponents_.Clear();
+
+    // Workers and the main thread write to buffers of their own, which are merged afterward
+    networkUpdateBuffers_.Resize(numThreads + 1);
+    for (unsigned i = 0; i < networkUpdateBuffers_.Size(); ++i)
+    {
+        networkUpdateBuffers_[i].changes_.Clear();
+        networkUpdateBuffers_[i].vars_.Clear();
+    }
+
+    unsigned numNodes = networkCheckNodes_.Size();
+    unsigned numComponents = networkCheckComponents_.Size();
+    unsigned numWorkItems = Max(Min(numThreads + 1, (numNodes + numComponents) / MIN_OBJECTS_PER_NETWORK_UPDATE_WORK_ITEM), 1U);
+
+    // Split the work items between nodes and components in proportion to their counts
+    unsigned numNodeItems = numNodes ? Max((unsigned)((unsigned long long)numWorkItems * numNodes / (numNodes + numComponents)), 1U) : 0;
+    unsigned numComponentItems = numComponents ? Max(numWorkItems - Min(numNodeItems, numWorkItems), 1U) : 0;
+
+    Node** nodeStart = networkCheckNodes_.Buffer();
+    for (unsigned i = 0; i < numNodeItems; ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CheckNetworkNodesWork;
+        item->name_ = "CheckNetworkNodesWork";
+        item->aux_ = networkUpdateBuffers_.Buffer();
+        item->start_ = nodeStart + i * numNodes / numNodeItems;
+        item->end_ = nodeStart + (i + 1) * numNodes / numNodeItems;
+        queue->AddWorkItem(item);
+    }
+
+    Component** componentStart = networkCheckComponents_.Buffer();
+    for (unsigned i = 0; i < numComponentItems; ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CheckNetworkComponentsWork;
+        item->name_ = "CheckNetworkComponentsWork";
+        item->aux_ = networkUpdateBuffers_.Buffer();
+        item->start_ = componentStart + i * numComponents / numComponentItems;
+        item->end_ = componentStart + (i + 1) * numComponents / numComponentItems;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+
+    // Mark the changes to the replication states, which are shared between the objects
+    for (unsigned i = 0; i < networkUpdateBuffers_.Size(); ++i)
+    {
+        const NetworkUpdateBuffer& buffer = networkUpdateBuffers_[i];
+        for (Vector<NetworkUpdateChange>::ConstIterator j = buffer.changes_.Begin(); j != buffer.changes_.End(); ++j)
+        {
+            if (j->node_)
+                j->node_->MarkNetworkUpdateDirty(j->dirtyAttributes_, buffer.vars_.Buffer() + j->varStart_, j->numVars_);
+            else
+                j->component_->MarkNetworkUpdateDirty(j->dirtyAttributes_);
+        }
+    }
+
+    return true;
+}
+
 void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
 
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        i->second_->CleanupConnection(connection);
+    for (IDMap<Node>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+        (*i)->CleanupConnection(connection);
 
-    for (HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
-        i->second_->CleanupConnection(connection);
+    for (IDMap<Component>::ConstIterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
+        (*i)->CleanupConnection(connection);
 }
 
 void Scene::MarkNetworkUpdate(Node* node)
@@ -1170,6 +1810,32 @@ void Scene::HandleUpdate(StringHash eventType, VariantMap& eventData)
     Update(eventData[P_TIMESTEP].GetFloat());
 }
 
+void Scene::HandleBeginPipelinedUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // Without worker threads nothing would run in parallel with rendering, so leave the components to the next scene update
+    if (!updateEnabled_ || asyncLoading_ || pipelinedUpdated_ || threadedUpdateComponents_.Empty() ||
+        !GetSubsystem<WorkQueue>()->GetNumThreads())
+        return;
+
+    using namespace BeginPipelinedUpdate;
+
+    SortThreadedComponents();
+    BeginThreadedUpdate();
+    QueueThreadedComponents(eventData[P_TIMESTEP].GetFloat() * timeScale_, PIPELINED_UPDATE_PRIORITY);
+    pipelinedUpdated_ = true;
+}
+
+void Scene::HandleEndPipelinedUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (!pipelinedUpdated_ || !threadedUpdate_)
+        return;
+
+    URHO3D_PROFILE(UpdateThreadedComponents);
+
+    GetSubsystem<WorkQueue>()->Complete(PIPELINED_UPDATE_PRIORITY);
+    EndThreadedUpdate();
+}
+
 void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
 {
     using namespace ResourceBackgroundLoaded;
@@ -1189,6 +1855,26 @@ void Scene::UpdateAsyncLoading()
 {
     URHO3D_PROFILE(UpdateAsyncLoading);
 
+    // Take the node records and resources parsed so far. When preloading, wait until all resources are known
+    bool parsingFinished = false;
+    if (asyncProgress_.parser_)
+    {
+        Vector<ResourceRef> resources;
+        parsingFinished = asyncProgress_.parser_->TakeParsed(asyncProgress_.parsedNodes_, resources);
+        PreloadResources(resources);
+        if (!parsingFinished && asyncProgress_.mode_ != LOAD_SCENE)
+            return;
+    }
+    else if (asyncProgress_.streamParser_)
+    {
+        Vector<ResourceRef> resources;
+        asyncProgress_.streamParser_->TakeResources(resources);
+        PreloadResources(resources);
+        asyncProgress_.totalNodes_ = asyncProgress_.streamParser_->GetNumNodes();
+        if (!asyncProgress_.streamParser_->HasFoundResources() && asyncProgress_.mode_ != LOAD_SCENE)
+            return;
+    }
+
     // If resources left to load, do not load nodes yet
     if (asyncProgress_.loadedResources_ < asyncProgress_.totalResources_)
         return;
@@ -1197,16 +1883,61 @@ void Scene::UpdateAsyncLoading()
 
     for (;;)
     {
-        if (asyncProgress_.loadedNodes_ >= asyncProgress_.totalNodes_)
+        if (asyncProgress_.parser_)
         {
-            FinishAsyncLoading();
-            return;
+            // Create one node without its children from the parsed binary data
+            unsigned index = asyncProgress_.createdNodes_.Size();
+            if (index >= asyncProgress_.parsedNodes_.Size())
+            {
+                if (!parsingFinished)
+                    break;
+
+                if (asyncProgress_.parser_->IsFailed())
+                    URHO3D_LOGERROR("Could not load all nodes of " + asyncProgress_.file_->GetName() + ", truncated or corrupt data");
+                FinishAsyncLoading();
+                return;
+            }
+
+            LoadParsedNode(asyncProgress_.parsedNodes_[index]);
         }
+        else if (asyncProgress_.streamParser_)
+        {
+            // Take more documents only when the previous ones have been loaded, so that the parser's budget bounds them
+            if (asyncProgress_.streamIndex_ >= asyncProgress_.streamDocuments_.Size())
+            {
+                bool streamFinished = asyncProgress_.streamParser_->IsFinished();
+                asyncProgress_.streamDocuments_.Clear();
+                asyncProgress_.streamIndex_ = 0;
+                asyncProgress_.streamParser_->TakeDocuments(asyncProgress_.streamDocuments_);
+                if (asyncProgress_.streamDocuments_.Empty())
+                {
+                    if (!streamFinished)
+                        break;
 
+                    if (asyncProgress_.streamParser_->IsFailed())
+                        URHO3D_LOGERROR("Could not load all nodes of " + asyncProgress_.file_->GetName() + ", truncated or malformed data");
+                    FinishAsyncLoading();
+                    return;
+                }
+            }
 
+            // Release each document once loaded
+            SharedPtr<Resource> document = asyncProgress_.streamDocuments_[asyncProgress_.streamIndex_];
+            asyncProgress_.streamDocuments_[asyncProgress_.streamIndex_++].Reset();
+            if (!LoadStreamDocument(document))
+            {
+                StopAsyncLoading();
+                return;
+            }
+        }
+        else if (asyncProgress_.loadedNodes_ >= asyncProgress_.totalNodes_)
+        {
+            FinishAsyncLoading();
+            return;
+        }
         // Read one child node with its full sub-hierarchy either from binary, JSON, or XML
         /// \todo Works poorly in scenes where one root-level child node contains all content
-        if (asyncProgress_.xmlFile_)
+        else if (asyncProgress_.xmlFile_)
         {
             unsigned nodeID = asyncProgress_.xmlElement_.GetUInt("id");
             Node* newNode = CreateChild(nodeID, IsReplicatedID(nodeID) ? REPLICATED : LOCAL);
@@ -1232,7 +1963,8 @@ void Scene::UpdateAsyncLoading()
             newNode->Load(*asyncProgress_.file_, resolver_);
         }
 
-        ++asyncProgress_.loadedNodes_;
+        if (!asyncProgress_.parser_ && !asyncProgress_.streamParser_)
+            ++asyncProgress_.loadedNodes_;
 
         // Break if time limit exceeded, so that we keep sufficient FPS
         if (asyncLoadTimer.GetUSec(false) >= asyncLoadingMs_ * 1000LL)
@@ -1364,166 +2096,134 @@ void Scene::PreloadResources(File* file, bool isSceneFile)
 #endif
 }
 
-void Scene::PreloadResourcesXML(const XMLElement& element)
+void Scene::PreloadResources(const Vector<ResourceRef>& resources)
 {
-    // If not threaded, can not background load resources, so rather load synchronously later when needed
-#ifdef URHO3D_THREADING
     auto* cache = GetSubsystem<ResourceCache>();
 
-    // Node or Scene attributes do not include any resources; therefore skip to the components
-    XMLElement compElem = element.GetChild("component");
-    while (compElem)
+    for (unsigned i = 0; i < resources.Size(); ++i)
     {
-        String typeName = compElem.GetAttribute("type");
-        const Vector<AttributeInfo>* attributes = context_->GetAttributes(StringHash(typeName));
-        if (attributes)
+        // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
+        String name = cache->SanitateResourceName(resources[i].name_);
+        bool success = cache->BackgroundLoadResource(resources[i].type_, name);
+        if (success)
         {
-            XMLElement attrElem = compElem.GetChild("attribute");
-            unsigned startIndex = 0;
-
-            while (attrElem)
-            {
-                String name = attrElem.GetAttribute("name");
-                unsigned i = startIndex;
-                unsigned attempts = attributes->Size();
-
-                while (attempts)
-                {
-                    const AttributeInfo& attr = attributes->At(i);
-                    if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
-                    {
-                        if (attr.type_ == VAR_RESOURCEREF)
-                        {
-                            ResourceRef ref = attrElem.GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
-                        }
-                        else if (attr.type_ == VAR_RESOURCEREFLIST)
-                        {
-                            ResourceRefList refList = attrElem.GetVariantValue(attr.type_).GetResourceRefList();
-                            for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
-                        }
-
-                        startIndex = (i + 1) % attributes->Size();
-                        break;
-                    }
-                    else
-                    {
-                        i = (i + 1) % attributes->Size();
-                        --attempts;
-                    }
-                }
-
-                attrElem = attrElem.GetNext("attribute");
-            }
+            ++asyncProgress_.totalResources_;
+            asyncProgress_.resources_.Insert(StringHash(name));
         }
-
-        compElem = compElem.GetNext("component");
     }
+}
 
-    XMLElement childElem = element.GetChild("node");
-    while (childElem)
+void Scene::LoadParsedNode(const ParsedNode& parsed)
+{
+    // The parent may have been removed while loading, in which case its children are skipped
+    Node* parent = parsed.parent_ == M_MAX_UNSIGNED ? this : asyncProgress_.createdNodes_[parsed.parent_].Get();
+    Node* newNode = nullptr;
+    if (parent)
     {
-        PreloadResourcesXML(childElem);
-        childElem = childElem.GetNext("node");
+        newNode = parent->CreateChild(parsed.id_, IsReplicatedID(parsed.id_) ? REPLICATED : LOCAL);
+        resolver_.AddNode(parsed.id_, newNode);
+        MemoryBuffer source(asyncProgress_.parser_->GetData() + parsed.offset_, parsed.size_);
+        newNode->Load(source, resolver_, false);
     }
-#endif
+
+    asyncProgress_.createdNodes_.Push(WeakPtr<Node>(newNode));
+    if (parsed.parent_ == M_MAX_UNSIGNED)
+        ++asyncProgress_.loadedNodes_;
 }
 
-void Scene::PreloadResourcesJSON(const JSONValue& value)
+bool Scene::LoadAsyncStream(File* file, SceneStreamFormat format, LoadMode mode)
 {
-    // If not threaded, can not background load resources, so rather load synchronously later when needed
-#ifdef URHO3D_THREADING
-    auto* cache = GetSubsystem<ResourceCache>();
+    // Binary cooked files are loaded as a whole
+    if (!SceneStreamParser::IsTextSource(*file, format))
+        return false;
 
-    // Node or Scene attributes do not include any resources; therefore skip to the components
-    JSONArray componentArray = value.Get("components").GetArray();
+    // Without threads, fall back to loading the file as a whole
+    SharedPtr<SceneStreamParser> parser(new SceneStreamParser(context_, file, format, mode != LOAD_SCENE, mode > LOAD_RESOURCES_ONLY));
+    if (!parser->Run())
+        return false;
 
-    for (unsigned i = 0; i < componentArray.Size(); i++)
+    if (mode > LOAD_RESOURCES_ONLY)
     {
-        const JSONValue& compValue = componentArray.At(i);
-        String typeName = compValue.Get("type").GetString();
-
-        const Vector<AttributeInfo>* attributes = context_->GetAttributes(StringHash(typeName));
-        if (attributes)
-        {
-            JSONArray attributesArray = compValue.Get("attributes").GetArray();
-
-            unsigned startIndex = 0;
+        URHO3D_LOGINFO("Loading scene from " + file->GetName());
+        Clear();
+    }
+    else
+        URHO3D_LOGINFO("Preloading resources from " + file->GetName());
 
-            for (unsigned j = 0; j < attributesArray.Size(); j++)
-            {
-                const JSONValue& attrVal = attributesArray.At(j);
-                String name = attrVal.Get("name").GetString();
-                unsigned i = startIndex;
-                unsigned attempts = attributes->Size();
+    asyncLoading_ = true;
+    asyncProgress_.file_ = file;
+    asyncProgress_.streamParser_ = parser;
+    asyncProgress_.mode_ = mode;
+    asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_ = asyncProgress_.loadedResources_ = asyncProgress_.totalResources_ = 0;
+    asyncProgress_.resources_.Clear();
 
-                while (attempts)
-                {
-                    const AttributeInfo& attr = attributes->At(i);
-                    if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
-                    {
-                        if (attr.type_ == VAR_RESOURCEREF)
-                        {
-                            ResourceRef ref = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
-                        }
-                        else if (attr.type_ == VAR_RESOURCEREFLIST)
-                        {
-                            ResourceRefList refList = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRefList();
-                            for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
-                        }
+    return true;
+}
 
-                        startIndex = (i + 1) % attributes->Size();
-                        break;
-                    }
-                    else
-                    {
-                        i = (i + 1) % attributes->Size();
-                        --attempts;
-                    }
-                }
+bool Scene::LoadStreamDocument(Resource* document)
+{
+    bool isHead = !asyncProgress_.streamHeadLoaded_;
 
-            }
+    if (document->GetType() == XMLFile::GetTypeStatic())
+    {
+        XMLElement element = static_cast<XMLFile*>(document)->GetRoot();
+        unsigned nodeID = element.GetUInt("id");
+        if (isHead)
+        {
+            // Store own old ID for resolving possible root node references, then load the root level components
+            resolver_.AddNode(nodeID, this);
+            if (!Node::LoadXML(element, resolver_, false))
+                return false;
+        }
+        else
+        {
+            Node* newNode = CreateChild(nodeID, IsReplicatedID(nodeID) ? REPLICATED : LOCAL);
+            resolver_.AddNode(nodeID, newNode);
+            newNode->LoadXML(element, resolver_);
         }
-
     }
-
-    JSONArray childrenArray = value.Get("children").GetArray();
-    for (unsigned i = 0; i < childrenArray.Size(); i++)
+    else
     {
-        const JSONValue& childVal = childrenArray.At(i);
-        PreloadResourcesJSON(childVal);
+        const JSONValue& value = static_cast<JSONFile*>(document)->GetRoot();
+        unsigned nodeID = value.Get("id").GetUInt();
+        if (isHead)
+        {
+            resolver_.AddNode(nodeID, this);
+            if (!Node::LoadJSON(value, resolver_, false))
+                return false;
+        }
+        else
+        {
+            Node* newNode = CreateChild(nodeID, IsReplicatedID(nodeID) ? REPLICATED : LOCAL);
+            resolver_.AddNode(nodeID, newNode);
+            newNode->LoadJSON(value, resolver_);
+        }
     }
+
+    if (isHead)
+        asyncProgress_.streamHeadLoaded_ = true;
+    else
+        ++asyncProgress_.loadedNodes_;
+    return true;
+}
+
+void Scene::PreloadResourcesXML(const XMLElement& element)
+{
+    // If not threaded, can not background load resources, so rather load synchronously later when needed
+#ifdef URHO3D_THREADING
+    Vector<ResourceRef> resources;
+    SceneStreamParser::FindResourcesXML(context_, element, resources);
+    PreloadResources(resources);
+#endif
+}
+
+void Scene::PreloadResourcesJSON(const JSONValue& value)
+{
+    // If not threaded, can not background load resources, so rather load synchronously later when needed
+#ifdef URHO3D_THREADING
+    Vector<ResourceRef> resources;
+    SceneStreamParser::FindResourcesJSON(context_, value, resources);
+    PreloadResources(resources);
 #endif
 }
 
@@ -1536,6 +2236,8 @@ void RegisterSceneLibrary(Context* context)
     SmoothedTransform::RegisterObject(context);
     UnknownComponent::RegisterObject(context);
     SplinePath::RegisterObject(context);
+    Prefab::RegisterObject(context);
+    PrefabPool::RegisterObject(context);
 }
 
 }
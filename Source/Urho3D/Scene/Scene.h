@@ -22,17 +22,24 @@
 
 #pragma once
 
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/IDMap.h"
 #include "../Scene/Node.h"
+#include "../Scene/ReplicationState.h"
+#include "../Scene/SceneParser.h"
+#include "../Scene/SceneStreamParser.h"
+#include "../Scene/SmoothedTransform.h"
 #include "../Scene/SceneResolver.h"
 
 namespace Urho3D
 {
 
 class File;
+class LogicComponent;
 class PackageFile;
 
 static const unsigned FIRST_REPLICATED_ID = 0x1;
@@ -51,6 +58,15 @@ enum LoadMode
     LOAD_SCENE_AND_RESOURCES
 };
 
+/// Network client motion smoothing mode.
+enum SmoothingMode
+{
+    /// Approach the latest received transform exponentially with the smoothing constant (default.)
+    SMOOTHING_EXPONENTIAL = 0,
+    /// Interpolate between the buffered received transforms, delayed so that the next one has usually arrived.
+    SMOOTHING_SNAPSHOT
+};
+
 /// Asynchronous loading progress of a scene.
 struct AsyncProgress
 {
@@ -60,6 +76,20 @@ struct AsyncProgress
     SharedPtr<XMLFile> xmlFile_;
     /// JSON file for JSON mode
     SharedPtr<JSONFile> jsonFile_;
+    /// Worker thread parser for binary mode.
+    SharedPtr<SceneParser> parser_;
+    /// Node records taken from the parser.
+    PODVector<ParsedNode> parsedNodes_;
+    /// Nodes created from the records so far.
+    Vector<WeakPtr<Node> > createdNodes_;
+    /// Worker thread parser for streamed XML and JSON mode.
+    SharedPtr<SceneStreamParser> streamParser_;
+    /// Documents taken from the stream parser.
+    Vector<SharedPtr<Resource> > streamDocuments_;
+    /// Index of the next document to load.
+    unsigned streamIndex_;
+    /// Whether the root node's own document has been loaded in streamed mode.
+    bool streamHeadLoaded_;
 
     /// Current XML element for XML mode.
     XMLElement xmlElement_;
@@ -70,7 +100,7 @@ struct AsyncProgress
     /// Current load mode.
     LoadMode mode_;
     /// Resource name hashes left to load.
-    HashSet<StringHash> resources_;
+    FlatHashSet<StringHash> resources_;
     /// Loaded resources.
     unsigned loadedResources_;
     /// Total resources.
@@ -81,6 +111,30 @@ struct AsyncProgress
     unsigned totalNodes_;
 };
 
+/// Attribute change of a node or component found by the threaded network update.
+struct NetworkUpdateChange
+{
+    /// Changed node, or null for a component.
+    Node* node_;
+    /// Changed component, or null for a node.
+    Component* component_;
+    /// Changed attributes.
+    DirtyBits dirtyAttributes_;
+    /// Start index of the changed user variables in the buffer.
+    unsigned varStart_;
+    /// Number of changed user variables.
+    unsigned numVars_;
+};
+
+/// Per-thread buffer of the attribute changes found by the threaded network update.
+struct NetworkUpdateBuffer
+{
+    /// Changes found.
+    Vector<NetworkUpdateChange> changes_;
+    /// Changed user variables of the nodes.
+    PODVector<StringHash> vars_;
+};
+
 /// Root scene node, represents the whole scene.
 class URHO3D_API Scene : public Node
 {
@@ -152,6 +206,10 @@ public:
     void SetSmoothingConstant(float constant);
     /// Set network client motion smoothing snap threshold.
     void SetSnapThreshold(float threshold);
+    /// Set network client motion smoothing mode.
+    void SetSmoothingMode(SmoothingMode mode);
+    /// Set delay in seconds of the snapshot interpolation behind the latest received transform. Should cover the network update interval and its jitter.
+    void SetSnapshotDelay(float delay);
     /// Set maximum milliseconds per frame to spend on async scene loading.
     void SetAsyncLoadingMs(int ms);
     /// Add a required package file for networking. To be called on the server.
@@ -202,6 +260,12 @@ public:
     /// Return motion smoothing snap threshold.
     float GetSnapThreshold() const { return snapThreshold_; }
 
+    /// Return motion smoothing mode.
+    SmoothingMode GetSmoothingMode() const { return smoothingMode_; }
+
+    /// Return snapshot interpolation delay in seconds.
+    float GetSnapshotDelay() const { return snapshotDelay_; }
+
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
@@ -213,6 +277,8 @@ public:
 
     /// Update scene. Called by HandleUpdate.
     void Update(float timeStep);
+    /// Recalculate the world transforms in the subtrees of the nodes marked dirty since the last call, splitting many subtrees over worker threads. Called at the end of Update().
+    void UpdateTransforms();
     /// Begin a threaded update. During threaded update components can choose to delay dirty processing.
     void BeginThreadedUpdate();
     /// End a threaded update. Notify components that marked themselves for delayed dirty processing.
@@ -234,11 +300,31 @@ public:
     void NodeTagAdded(Node* node, const String& tag);
     /// Cache node by tag if tag not zero.
     void NodeTagRemoved(Node* node, const String& tag);
+    /// Move node in the name cache after its name changed. Used internally in Node::SetName.
+    void NodeNameChanged(Node* node, StringHash oldNameHash);
+    /// Return cached nodes with a name hash, or null if none. Used internally in Node::GetChild.
+    const PODVector<Node*>* GetNamedNodes(StringHash nameHash) const;
+    /// Return cached nodes with a tag, or null if none. Used internally in Node::GetChildrenWithTag.
+    const PODVector<Node*>* GetTaggedNodes(const String& tag) const;
 
     /// Node added. Assign scene pointer and add to ID map.
     void NodeAdded(Node* node);
     /// Node removed. Remove from ID map.
     void NodeRemoved(Node* node);
+    /// Add a logic component to the threaded update.
+    void AddThreadedUpdateComponent(LogicComponent* component);
+    /// Remove a logic component from the threaded update.
+    void RemoveThreadedUpdateComponent(LogicComponent* component);
+    /// Add a node or component with attribute animations to the update.
+    void AddAnimatedObject(Animatable* animatable);
+    /// Remove a node or component from the attribute animation update.
+    void RemoveAnimatedObject(Animatable* animatable);
+    /// Add a smoothed transform with smoothing in progress to the batched smoothing update.
+    void AddSmoothedTransform(SmoothedTransform* transform);
+    /// Remove a smoothed transform from the batched smoothing update.
+    void RemoveSmoothedTransform(SmoothedTransform* transform);
+    /// Record a node whose subtree has to be visited by the next world transform update. Is thread-safe during a threaded update. Called by Node.
+    void MarkTransformDirty(Node* node);
     /// Component added. Add to ID map.
     void ComponentAdded(Component* component);
     /// Component removed. Remove from ID map.
@@ -247,8 +333,8 @@ public:
     void SetVarNamesAttr(const String& value);
     /// Return node user variable reverse mappings.
     String GetVarNamesAttr() const;
-    /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
-    void PrepareNetworkUpdate();
+    /// Prepare network update by comparing attributes and marking replication states dirty as necessary. When threaded, compares the attributes of the nodes and thread-safe components in the work queue threads.
+    void PrepareNetworkUpdate(bool threaded = false);
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
     /// Mark a node for attribute check on the next network update.
@@ -261,8 +347,18 @@ public:
 private:
     /// Handle the logic update event to update the scene, if active.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the pipelined update beginning. Start the update of thread-safe logic components for the next frame.
+    void HandleBeginPipelinedUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the pipelined update ending. Wait for the logic components to finish.
+    void HandleEndPipelinedUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+    /// Cache the names of a node and its children.
+    void AddNamedNodes(Node* node);
+    /// Remove a node from the name cache.
+    void RemoveNamedNode(Node* node, StringHash nameHash);
+    /// Assign scene pointer and add to ID map for a node and its children, after their names have been cached.
+    void AddNodeRecursive(Node* node);
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
     /// Finish asynchronous loading.
@@ -273,21 +369,43 @@ private:
     void FinishSaving(Serializer* dest) const;
     /// Preload resources from a binary scene or object prefab file.
     void PreloadResources(File* file, bool isSceneFile);
+    /// Preload resources found by the worker thread parser.
+    void PreloadResources(const Vector<ResourceRef>& resources);
+    /// Create a node from a record of the worker thread parser.
+    void LoadParsedNode(const ParsedNode& parsed);
+    /// Start asynchronous loading of a text scene file streamed by a worker thread parser. Return false if not possible, in which case the file is loaded as a whole.
+    bool LoadAsyncStream(File* file, SceneStreamFormat format, LoadMode mode);
+    /// Load the root node or a root-level child node from a document of the stream parser. Return false on failure.
+    bool LoadStreamDocument(Resource* document);
     /// Preload resources from an XML scene or object prefab file.
     void PreloadResourcesXML(const XMLElement& element);
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
+    /// Run the update of thread-safe logic components in worker threads.
+    void UpdateThreadedComponents(float timeStep);
+    /// Sort the thread-safe logic components by type if the order has changed.
+    void SortThreadedComponents();
+    /// Queue the update of thread-safe logic components to the work queue.
+    void QueueThreadedComponents(float timeStep, unsigned priority);
+    /// Update the attribute animations of nodes and components.
+    void UpdateAnimatedObjects(float timeStep);
+    /// Update network client motion smoothing of all smoothed transforms in one batch, splitting the calculation over worker threads when there are many.
+    void UpdateSmoothing(float timeStep);
+    /// Compare the attributes of the nodes and components to check on the network update in the work queue threads and mark the changes to the replication states. Return false if there are too few objects to split.
+    bool PrepareNetworkUpdateThreaded();
 
     /// Replicated scene nodes by ID.
-    HashMap<unsigned, Node*> replicatedNodes_;
+    IDMap<Node> replicatedNodes_;
     /// Local scene nodes by ID.
-    HashMap<unsigned, Node*> localNodes_;
+    IDMap<Node> localNodes_;
     /// Replicated components by ID.
-    HashMap<unsigned, Component*> replicatedComponents_;
+    IDMap<Component> replicatedComponents_;
     /// Local components by ID.
-    HashMap<unsigned, Component*> localComponents_;
+    IDMap<Component> localComponents_;
     /// Cached tagged nodes by tag.
     HashMap<StringHash, PODVector<Node*> > taggedNodes_;
+    /// Cached named nodes by name hash. Unnamed nodes are not included.
+    HashMap<StringHash, PODVector<Node*> > namedNodes_;
     /// Asynchronous loading progress.
     AsyncProgress asyncProgress_;
     /// Node and component ID resolver for asynchronous loading.
@@ -302,9 +420,33 @@ private:
     HashSet<unsigned> networkUpdateNodes_;
     /// Components to check for attribute changes on the next network update.
     HashSet<unsigned> networkUpdateComponents_;
+    /// Nodes being checked by the threaded network update.
+    PODVector<Node*> networkCheckNodes_;
+    /// Components being checked by the threaded network update.
+    PODVector<Component*> networkCheckComponents_;
+    /// Per-thread attribute changes found by the threaded network update.
+    Vector<NetworkUpdateBuffer> networkUpdateBuffers_;
+    /// Logic components using the threaded update.
+    PODVector<LogicComponent*> threadedUpdateComponents_;
+    /// Nodes and components with attribute animations. Removed objects are cleared and compacted after the update.
+    Vector<WeakPtr<Animatable> > animatedObjects_;
+    /// Smoothed transforms with smoothing in progress. Removed transforms are cleared and compacted before the next update.
+    PODVector<SmoothedTransform*> smoothedTransforms_;
+    /// Positions calculated by the batched smoothing update.
+    PODVector<Vector3> smoothingPositions_;
+    /// Rotations calculated by the batched smoothing update.
+    Vector<Quaternion> smoothingRotations_;
+    /// Smoothing operations still in progress after the batched smoothing update.
+    PODVector<SmoothingTypeFlags> smoothingRemaining_;
+    /// Nodes marked dirty since the last world transform update.
+    Vector<WeakPtr<Node> > dirtyTransformNodes_;
+    /// Nodes marked dirty that are still in the scene, used by the world transform update.
+    HashSet<Node*> transformNodeSet_;
+    /// Marked dirty nodes outside the subtrees of the other marked nodes, used by the world transform update.
+    PODVector<Node*> transformRoots_;
     /// Delayed dirty notification queue for components.
     PODVector<Component*> delayedDirtyComponents_;
-    /// Mutex for the delayed dirty notification queue.
+    /// Mutex for the delayed dirty notification and dirty transform queues.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
     VariantMap smoothingData_;
@@ -324,16 +466,26 @@ private:
     float timeScale_;
     /// Elapsed time accumulator.
     float elapsedTime_;
+    /// Timestep of the thread-safe logic component update.
+    float threadedTimeStep_;
     /// Motion smoothing constant.
     float smoothingConstant_;
     /// Motion smoothing snap threshold.
     float snapThreshold_;
+    /// Snapshot interpolation delay.
+    float snapshotDelay_;
+    /// Motion smoothing mode.
+    SmoothingMode smoothingMode_;
     /// Update enabled flag.
     bool updateEnabled_;
     /// Asynchronous loading flag.
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Threaded update component order dirty flag.
+    bool threadedUpdateOrderDirty_;
+    /// Thread-safe logic components updated for the next frame by the pipelined update flag.
+    bool pipelinedUpdated_;
 };
 
 /// Register Scene library objects.
@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Scene/Node.h"
+#include "../Scene/SceneParser.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Size of the reads from the source.
+static const unsigned READ_CHUNK_SIZE = 1024 * 1024;
+/// Number of node records parsed between publishing them to the main thread.
+static const unsigned PUBLISH_INTERVAL = 256;
+
+SceneParser::SceneParser(Context* context, Deserializer* source, unsigned numRootNodes, bool findResources) :
+    context_(context),
+    source_(source),
+    numNodes_(0),
+    numRootNodes_(numRootNodes),
+    findResources_(findResources),
+    finished_(false),
+    failed_(false)
+{
+}
+
+SceneParser::~SceneParser()
+{
+    Stop();
+}
+
+void SceneParser::ThreadFunction()
+{
+    // Read the rest of the source in chunks, so that a stop request does not have to wait for a large read
+    unsigned size = source_->GetSize() - source_->GetPosition();
+    data_.Resize(size);
+    unsigned position = 0;
+    while (position < size && shouldRun_)
+    {
+        unsigned read = source_->Read(&data_[position], Min(size - position, READ_CHUNK_SIZE));
+        if (!read)
+            break;
+        position += read;
+    }
+
+    if (position < size)
+    {
+        failed_ = shouldRun_;
+        data_.Resize(position);
+    }
+    else
+    {
+        MemoryBuffer buffer(data_);
+        for (unsigned i = 0; i < numRootNodes_ && shouldRun_; ++i)
+        {
+            if (!ParseNode(buffer, M_MAX_UNSIGNED))
+            {
+                failed_ = shouldRun_;
+                break;
+            }
+        }
+    }
+
+    Publish(true);
+}
+
+bool SceneParser::TakeParsed(PODVector<ParsedNode>& nodes, Vector<ResourceRef>& resources)
+{
+    MutexLock lock(parserMutex_);
+
+    nodes.Push(publishedNodes_);
+    publishedNodes_.Clear();
+    resources.Push(publishedResources_);
+    publishedResources_.Clear();
+    return finished_;
+}
+
+bool SceneParser::ParseNode(MemoryBuffer& source, unsigned parent)
+{
+    if (!shouldRun_)
+        return false;
+
+    ParsedNode node;
+    node.parent_ = parent;
+    node.id_ = source.ReadUInt();
+    node.offset_ = source.GetPosition();
+
+    // Node attributes have no size, so they are decoded to find where the components begin
+    const Vector<AttributeInfo>* attributes = context_->GetAttributes(Node::GetTypeStatic());
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+        if (source.IsEof())
+            return false;
+        source.ReadVariant(attr.type_);
+    }
+
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        unsigned compSize = source.ReadVLE();
+        unsigned compStart = source.GetPosition();
+        if (compStart + compSize > source.GetSize())
+            return false;
+
+        if (findResources_)
+        {
+            MemoryBuffer compBuffer(source.GetData() + compStart, compSize);
+            FindResources(compBuffer);
+        }
+        source.Seek(compStart + compSize);
+    }
+
+    node.size_ = source.GetPosition() - node.offset_;
+    unsigned index = numNodes_++;
+    nodes_.Push(node);
+    if (nodes_.Size() >= PUBLISH_INTERVAL)
+        Publish(false);
+
+    unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        if (source.IsEof() || !ParseNode(source, index))
+            return false;
+    }
+
+    return true;
+}
+
+void SceneParser::FindResources(MemoryBuffer& source)
+{
+    StringHash compType = source.ReadStringHash();
+    // Skip the component ID
+    source.ReadUInt();
+
+    const Vector<AttributeInfo>* attributes = context_->GetAttributes(compType);
+    if (!attributes)
+        return;
+
+    for (unsigned i = 0; i < attributes->Size() && !source.IsEof(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (attr.type_ == VAR_RESOURCEREF)
+            AddResource(source.ReadResourceRef());
+        else if (attr.type_ == VAR_RESOURCEREFLIST)
+        {
+            ResourceRefList refList = source.ReadResourceRefList();
+            for (unsigned j = 0; j < refList.names_.Size(); ++j)
+                AddResource(ResourceRef(refList.type_, refList.names_[j]));
+        }
+        else
+            source.ReadVariant(attr.type_);
+    }
+}
+
+void SceneParser::AddResource(const ResourceRef& ref)
+{
+    // Scenes typically refer to the same resources many times, so pass each name only once
+    if (ref.name_.Empty())
+        return;
+
+    bool exists;
+    foundResources_.Insert(StringHash(ref.name_), exists);
+    if (!exists)
+        resources_.Push(ref);
+}
+
+void SceneParser::Publish(bool finished)
+{
+    MutexLock lock(parserMutex_);
+
+    publishedNodes_.Push(nodes_);
+    nodes_.Clear();
+    publishedResources_.Push(resources_);
+    resources_.Clear();
+    finished_ = finished;
+}
+
+}
@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+#include "../Core/Variant.h"
+
+namespace Urho3D
+{
+
+class Context;
+class Deserializer;
+class MemoryBuffer;
+
+/// Location of one node's own data in a parsed binary scene.
+struct ParsedNode
+{
+    /// Index of the parent node record, or M_MAX_UNSIGNED for the root-level nodes.
+    unsigned parent_;
+    /// Node ID in the file.
+    unsigned id_;
+    /// Offset of the node's attributes and components in the parsed data.
+    unsigned offset_;
+    /// Size of the node's attributes and components in bytes.
+    unsigned size_;
+};
+
+/// Reads and parses the child nodes of a binary scene file in a worker thread for asynchronous loading. The nodes are split into records of their own attributes and components in depth-first order, so that the main thread can construct them in batches of any size, and the resources they refer to are collected for preloading.
+class URHO3D_API SceneParser : public RefCounted, public Thread
+{
+public:
+    /// Construct with the source positioned after the child node count of the root node. Does not start the parser thread yet.
+    SceneParser(Context* context, Deserializer* source, unsigned numRootNodes, bool findResources);
+    /// Destruct. Stop the parser thread.
+    ~SceneParser() override;
+
+    /// Read and parse in the worker thread.
+    void ThreadFunction() override;
+
+    /// Move the node records and resources parsed since the last call to the destination vectors. Return true if parsing has finished and there are no more records.
+    bool TakeParsed(PODVector<ParsedNode>& nodes, Vector<ResourceRef>& resources);
+    /// Return the parsed data. Valid once node records have been taken.
+    const unsigned char* GetData() const { return data_.Buffer(); }
+
+    /// Return whether the data was truncated or corrupt. Valid once parsing has finished.
+    bool IsFailed() const { return failed_; }
+
+private:
+    /// Parse a node and its children. Return true if successful.
+    bool ParseNode(MemoryBuffer& source, unsigned parent);
+    /// Collect the resources referred to by a component's attributes.
+    void FindResources(MemoryBuffer& source);
+    /// Add a resource to preload if not found before.
+    void AddResource(const ResourceRef& ref);
+    /// Publish the records and resources parsed so far to the main thread.
+    void Publish(bool finished);
+
+    /// Context.
+    Context* context_;
+    /// Source stream. Only accessed by the parser thread once started.
+    Deserializer* source_;
+    /// Data read from the source.
+    PODVector<unsigned char> data_;
+    /// Records parsed and not yet published.
+    PODVector<ParsedNode> nodes_;
+    /// Resources found and not yet published.
+    Vector<ResourceRef> resources_;
+    /// Name hashes of the resources found so far.
+    HashSet<StringHash> foundResources_;
+    /// Mutex for the published records and resources.
+    Mutex parserMutex_;
+    /// Records published to the main thread and not yet taken.
+    PODVector<ParsedNode> publishedNodes_;
+    /// Resources published to the main thread and not yet taken.
+    Vector<ResourceRef> publishedResources_;
+    /// Number of records parsed so far.
+    unsigned numNodes_;
+    /// Number of root-level nodes.
+    unsigned numRootNodes_;
+    /// Resource collection flag.
+    bool findResources_;
+    /// Finished flag. Protected by the mutex.
+    bool finished_;
+    /// Failure flag.
+    bool failed_;
+};
+
+}
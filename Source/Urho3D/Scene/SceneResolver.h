@@ -24,6 +24,7 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
 
 namespace Urho3D
 {
@@ -49,11 +50,16 @@ public:
     /// Resolve component and node ID attributes and reset.
     void Resolve();
 
+    /// Return buffer reused for loading the components' binary attribute data.
+    VectorBuffer& GetComponentBuffer() { return componentBuffer_; }
+
 private:
     /// Nodes.
     HashMap<unsigned, WeakPtr<Node> > nodes_;
     /// Components.
     HashMap<unsigned, WeakPtr<Component> > components_;
+    /// Component binary data buffer.
+    VectorBuffer componentBuffer_;
 };
 
 }
@@ -0,0 +1,758 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Timer.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/SceneStreamParser.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Size of the reads from the source.
+static const unsigned READ_CHUNK_SIZE = 64 * 1024;
+/// Text size of the documents published and not yet taken by the main thread, beyond which the parser waits.
+static const unsigned MAX_PUBLISHED_BYTES = 16 * 1024 * 1024;
+
+/// XML markup being scanned.
+enum XMLScanState
+{
+    XS_TEXT = 0,
+    XS_TAG,
+    XS_COMMENT,
+    XS_CDATA,
+    XS_PI,
+    XS_DECL
+};
+
+static inline bool IsTextSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool StartsWith(const char* text, unsigned length, const char* prefix)
+{
+    unsigned prefixLength = String::CStringLength(prefix);
+    return length >= prefixLength && !strncmp(text, prefix, prefixLength);
+}
+
+/// Collect the resources of one component's attribute, matching the attribute by name starting from the index after the previous match.
+static void FindAttributeResources(const Vector<AttributeInfo>& attributes, const String& name, unsigned& startIndex,
+    const XMLElement* attrElem, const JSONValue* attrValue, Vector<ResourceRef>& dest)
+{
+    unsigned i = startIndex;
+    unsigned attempts = attributes.Size();
+
+    while (attempts)
+    {
+        const AttributeInfo& attr = attributes[i];
+        if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
+        {
+            if (attr.type_ == VAR_RESOURCEREF || attr.type_ == VAR_RESOURCEREFLIST)
+            {
+                Variant value = attrElem ? attrElem->GetVariantValue(attr.type_) : attrValue->GetVariantValue(attr.type_);
+                if (attr.type_ == VAR_RESOURCEREF)
+                    dest.Push(value.GetResourceRef());
+                else
+                {
+                    const ResourceRefList& refList = value.GetResourceRefList();
+                    for (unsigned k = 0; k < refList.names_.Size(); ++k)
+                        dest.Push(ResourceRef(refList.type_, refList.names_[k]));
+                }
+            }
+
+            startIndex = (i + 1) % attributes.Size();
+            return;
+        }
+
+        i = (i + 1) % attributes.Size();
+        --attempts;
+    }
+}
+
+SceneStreamParser::SceneStreamParser(Context* context, Deserializer* source, SceneStreamFormat format, bool findResources, bool parseNodes) :
+    context_(context),
+    source_(source),
+    format_(format),
+    publishedBytes_(0),
+    skipNodes_(0),
+    numNodes_(0),
+    findResources_(findResources),
+    parseNodes_(parseNodes),
+    resourcePass_(false),
+    keepDocuments_(false),
+    elementIsNode_(false),
+    headPublished_(false),
+    resourcesFound_(false),
+    finished_(false),
+    failed_(false)
+{
+    ResetScanner();
+}
+
+SceneStreamParser::~SceneStreamParser()
+{
+    Stop();
+}
+
+void SceneStreamParser::ThreadFunction()
+{
+    unsigned startPosition = source_->GetPosition();
+
+    // When preloading, the first pass finds the resources so that they can be loaded before any node is created. The node
+    // documents parsed in it are kept while they fit in the memory budget, and the rest are parsed again in a second pass
+    resourcePass_ = findResources_;
+    keepDocuments_ = parseNodes_;
+    bool success = Scan();
+    Publish();
+    {
+        MutexLock lock(parserMutex_);
+        resourcesFound_ = true;
+    }
+
+    if (success && findResources_ && parseNodes_ && !keepDocuments_ && shouldRun_)
+    {
+        resourcePass_ = false;
+        ResetScanner();
+        source_->Seek(startPosition);
+        success = Scan();
+        Publish();
+    }
+
+    failed_ = !success && shouldRun_;
+
+    MutexLock lock(parserMutex_);
+    finished_ = true;
+}
+
+void SceneStreamParser::TakeDocuments(Vector<SharedPtr<Resource> >& documents)
+{
+    MutexLock lock(parserMutex_);
+
+    documents.Push(publishedDocuments_);
+    publishedDocuments_.Clear();
+    publishedBytes_ = 0;
+}
+
+void SceneStreamParser::TakeResources(Vector<ResourceRef>& resources)
+{
+    MutexLock lock(parserMutex_);
+
+    resources.Push(publishedResources_);
+    publishedResources_.Clear();
+}
+
+unsigned SceneStreamParser::GetNumNodes() const
+{
+    MutexLock lock(parserMutex_);
+    return numNodes_;
+}
+
+bool SceneStreamParser::HasFoundResources() const
+{
+    MutexLock lock(parserMutex_);
+    return resourcesFound_;
+}
+
+bool SceneStreamParser::IsFinished() const
+{
+    MutexLock lock(parserMutex_);
+    return finished_;
+}
+
+bool SceneStreamParser::IsTextSource(Deserializer& source, SceneStreamFormat format)
+{
+    unsigned position = source.GetPosition();
+    char text[16];
+    unsigned read = source.Read(text, sizeof text);
+    source.Seek(position);
+
+    // Skip an UTF-8 byte order mark and whitespace
+    unsigned i = 0;
+    if (read >= 3 && (unsigned char)text[0] == 0xef && (unsigned char)text[1] == 0xbb && (unsigned char)text[2] == 0xbf)
+        i = 3;
+    while (i < read && IsTextSpace(text[i]))
+        ++i;
+
+    return i < read && text[i] == (format == SSF_XML ? '<' : '{');
+}
+
+void SceneStreamParser::FindResourcesXML(Context* context, const XMLElement& element, Vector<ResourceRef>& dest)
+{
+    // Node or Scene attributes do not include any resources; therefore skip to the components
+    XMLElement compElem = element.GetChild("component");
+    while (compElem)
+    {
+        const Vector<AttributeInfo>* attributes = context->GetAttributes(StringHash(compElem.GetAttribute("type")));
+        if (attributes && attributes->Size())
+        {
+            unsigned startIndex = 0;
+            XMLElement attrElem = compElem.GetChild("attribute");
+            while (attrElem)
+            {
+                FindAttributeResources(*attributes, attrElem.GetAttribute("name"), startIndex, &attrElem, nullptr, dest);
+                attrElem = attrElem.GetNext("attribute");
+            }
+        }
+
+        compElem = compElem.GetNext("component");
+    }
+
+    XMLElement childElem = element.GetChild("node");
+    while (childElem)
+    {
+        FindResourcesXML(context, childElem, dest);
+        childElem = childElem.GetNext("node");
+    }
+}
+
+void SceneStreamParser::FindResourcesJSON(Context* context, const JSONValue& value, Vector<ResourceRef>& dest)
+{
+    // Node or Scene attributes do not include any resources; therefore skip to the components
+    const JSONArray& componentArray = value.Get("components").GetArray();
+    for (unsigned i = 0; i < componentArray.Size(); ++i)
+    {
+        const JSONValue& compValue = componentArray[i];
+        const Vector<AttributeInfo>* attributes = context->GetAttributes(StringHash(compValue.Get("type").GetString()));
+        if (attributes && attributes->Size())
+        {
+            unsigned startIndex = 0;
+            const JSONArray& attributesArray = compValue.Get("attributes").GetArray();
+            for (unsigned j = 0; j < attributesArray.Size(); ++j)
+            {
+                const JSONValue& attrVal = attributesArray[j];
+                FindAttributeResources(*attributes, attrVal.Get("name").GetString(), startIndex, nullptr, &attrVal.Get("value"), dest);
+            }
+        }
+    }
+
+    const JSONArray& childrenArray = value.Get("children").GetArray();
+    for (unsigned i = 0; i < childrenArray.Size(); ++i)
+        FindResourcesJSON(context, childrenArray[i], dest);
+}
+
+bool SceneStreamParser::Scan()
+{
+    while (shouldRun_ && !rootClosed_)
+    {
+        CompactBuffer();
+
+        unsigned oldSize = buffer_.Size();
+        buffer_.Resize(oldSize + READ_CHUNK_SIZE);
+        unsigned read = source_->IsEof() ? 0 : source_->Read(&buffer_[oldSize], READ_CHUNK_SIZE);
+        buffer_.Resize(oldSize + read);
+
+        if (!(format_ == SSF_XML ? ScanXML(!read) : ScanJSON()))
+            return false;
+        if (!read)
+            break;
+    }
+
+    // A root left open means truncated text
+    return shouldRun_ && rootClosed_ && PublishHead();
+}
+
+bool SceneStreamParser::ScanXML(bool endOfData)
+{
+    unsigned size = buffer_.Size();
+
+    while (scanPos_ < size && !rootClosed_)
+    {
+        char c = buffer_[scanPos_];
+
+        switch (xmlState_)
+        {
+        case XS_TEXT:
+            if (c == '<')
+            {
+                // Classify the markup once its longest prefix is available
+                unsigned available = size - scanPos_;
+                if (available < 9 && !endOfData)
+                    return true;
+
+                const char* text = &buffer_[scanPos_];
+                markupStart_ = scanPos_;
+                if (StartsWith(text, available, "<!--"))
+                {
+                    xmlState_ = XS_COMMENT;
+                    scanPos_ += 4;
+                }
+                else if (StartsWith(text, available, "<![CDATA["))
+                {
+                    xmlState_ = XS_CDATA;
+                    scanPos_ += 9;
+                }
+                else if (StartsWith(text, available, "<?"))
+                {
+                    xmlState_ = XS_PI;
+                    scanPos_ += 2;
+                }
+                else if (StartsWith(text, available, "<!"))
+                {
+                    xmlState_ = XS_DECL;
+                    scanPos_ += 2;
+                }
+                else
+                {
+                    xmlState_ = XS_TAG;
+                    quote_ = 0;
+                    ++scanPos_;
+                }
+                continue;
+            }
+            break;
+
+        case XS_TAG:
+            if (quote_)
+            {
+                if (c == quote_)
+                    quote_ = 0;
+            }
+            else if (c == '"' || c == '\'')
+                quote_ = c;
+            else if (c == '>')
+            {
+                unsigned start = markupStart_;
+                xmlState_ = XS_TEXT;
+                markupStart_ = M_MAX_UNSIGNED;
+                if (!HandleTag(start, scanPos_ + 1))
+                    return false;
+            }
+            break;
+
+        case XS_COMMENT:
+            if (c == '>' && scanPos_ >= markupStart_ + 6 && buffer_[scanPos_ - 1] == '-' && buffer_[scanPos_ - 2] == '-')
+            {
+                xmlState_ = XS_TEXT;
+                markupStart_ = M_MAX_UNSIGNED;
+            }
+            break;
+
+        case XS_CDATA:
+            if (c == '>' && scanPos_ >= markupStart_ + 11 && buffer_[scanPos_ - 1] == ']' && buffer_[scanPos_ - 2] == ']')
+            {
+                xmlState_ = XS_TEXT;
+                markupStart_ = M_MAX_UNSIGNED;
+            }
+            break;
+
+        case XS_PI:
+            if (c == '>' && scanPos_ >= markupStart_ + 3 && buffer_[scanPos_ - 1] == '?')
+            {
+                xmlState_ = XS_TEXT;
+                markupStart_ = M_MAX_UNSIGNED;
+            }
+            break;
+
+        default:
+            // Document type declarations with an internal subset are not supported
+            if (c == '>')
+            {
+                xmlState_ = XS_TEXT;
+                markupStart_ = M_MAX_UNSIGNED;
+            }
+            break;
+        }
+
+        ++scanPos_;
+    }
+
+    return true;
+}
+
+bool SceneStreamParser::HandleTag(unsigned start, unsigned end)
+{
+    const char* tag = &buffer_[start];
+    unsigned length = end - start;
+
+    if (tag[1] == '/')
+    {
+        if (!depth_)
+            return false;
+        if (--depth_ == 1 && elementStart_ != M_MAX_UNSIGNED)
+            return CompleteElement(end);
+        if (!depth_)
+            rootClosed_ = true;
+        return true;
+    }
+
+    bool selfClosing = length >= 3 && tag[length - 2] == '/';
+    unsigned nameEnd = 1;
+    while (nameEnd < length - 1 && !IsTextSpace(tag[nameEnd]) && tag[nameEnd] != '/')
+        ++nameEnd;
+
+    if (!depth_)
+    {
+        // The root start tag begins the head document, which is closed when published
+        if (!headPublished_)
+            head_.Append(tag, length);
+        if (selfClosing)
+        {
+            rootClosed_ = true;
+            return true;
+        }
+        rootName_ = String(tag + 1, nameEnd - 1);
+    }
+    else if (depth_ == 1)
+    {
+        elementStart_ = start;
+        elementIsNode_ = nameEnd == 5 && !strncmp(tag + 1, "node", 4);
+        if (selfClosing)
+            return CompleteElement(end);
+    }
+
+    if (!selfClosing)
+        ++depth_;
+    return true;
+}
+
+bool SceneStreamParser::CompleteElement(unsigned end)
+{
+    unsigned start = elementStart_;
+    elementStart_ = M_MAX_UNSIGNED;
+
+    if (elementIsNode_)
+        return AddNode(start, end);
+
+    AddHeadText(start, end);
+    return true;
+}
+
+bool SceneStreamParser::ScanJSON()
+{
+    unsigned size = buffer_.Size();
+
+    for (; scanPos_ < size && !rootClosed_; ++scanPos_)
+    {
+        char c = buffer_[scanPos_];
+
+        if (inString_)
+        {
+            if (escape_)
+                escape_ = false;
+            else if (c == '\\')
+                escape_ = true;
+            else if (c == '"')
+            {
+                inString_ = false;
+                if (keyStart_ != M_MAX_UNSIGNED)
+                {
+                    key_ = String(&buffer_[keyStart_ + 1], scanPos_ - keyStart_ - 1);
+                    keyStart_ = M_MAX_UNSIGNED;
+                }
+            }
+            continue;
+        }
+
+        if (IsTextSpace(c))
+            continue;
+
+        // The children member is split into nodes only when its value is an array
+        bool isChildren = pendingChildren_;
+        pendingChildren_ = false;
+
+        switch (c)
+        {
+        case '"':
+            inString_ = true;
+            if (depth_ == 1 && expectKey_)
+            {
+                keyStart_ = memberStart_ = scanPos_;
+                expectKey_ = false;
+            }
+            break;
+
+        case ':':
+            pendingChildren_ = depth_ == 1 && key_ == "children";
+            break;
+
+        case '{':
+        case '[':
+            if (!depth_)
+            {
+                if (c != '{')
+                    return false;
+                expectKey_ = true;
+            }
+            else if (depth_ == 1 && isChildren && c == '[')
+            {
+                inChildren_ = true;
+                memberStart_ = M_MAX_UNSIGNED;
+            }
+            else if (depth_ == 2 && inChildren_ && c == '{')
+                elementStart_ = scanPos_;
+            ++depth_;
+            break;
+
+        case '}':
+        case ']':
+            if (!depth_)
+                return false;
+            --depth_;
+            if (depth_ == 2 && elementStart_ != M_MAX_UNSIGNED)
+            {
+                unsigned start = elementStart_;
+                elementStart_ = M_MAX_UNSIGNED;
+                if (!AddNode(start, scanPos_ + 1))
+                    return false;
+            }
+            else if (depth_ == 1 && inChildren_)
+                inChildren_ = false;
+            else if (!depth_)
+            {
+                EndMember(scanPos_);
+                rootClosed_ = true;
+            }
+            break;
+
+        case ',':
+            if (depth_ == 1)
+            {
+                EndMember(scanPos_);
+                expectKey_ = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+void SceneStreamParser::EndMember(unsigned end)
+{
+    if (memberStart_ == M_MAX_UNSIGNED)
+        return;
+
+    unsigned start = memberStart_;
+    memberStart_ = M_MAX_UNSIGNED;
+    AddHeadText(start, end);
+}
+
+void SceneStreamParser::AddHeadText(unsigned start, unsigned end)
+{
+    if (headPublished_)
+    {
+        // The head is loaded before the first child node, so it can not be extended after it. Warn only in the first pass
+        if (resourcePass_ || !findResources_)
+            URHO3D_LOGWARNING("Ignoring root node content after its child nodes in " + source_->GetName());
+        return;
+    }
+
+    if (format_ == SSF_JSON && !head_.Empty())
+        head_ += ',';
+    head_.Append(&buffer_[start], end - start);
+}
+
+bool SceneStreamParser::AddNode(unsigned start, unsigned end)
+{
+    if (!PublishHead())
+        return false;
+
+    unsigned index = nodeIndex_++;
+    bool keep = parseNodes_ && (resourcePass_ ? keepDocuments_ : index >= skipNodes_);
+    if (keep || resourcePass_)
+    {
+        unsigned size = end - start;
+        SharedPtr<Resource> document = ParseDocument(&buffer_[start], size);
+        if (!document)
+            return false;
+        if (resourcePass_)
+            FindResources(document);
+
+        if (keep)
+        {
+            // The main thread takes no documents before all resources are found, so stop keeping them when over the budget
+            bool overBudget = false;
+            if (resourcePass_)
+            {
+                MutexLock lock(parserMutex_);
+                overBudget = publishedBytes_ + size > MAX_PUBLISHED_BYTES;
+            }
+
+            if (overBudget)
+            {
+                keepDocuments_ = false;
+                skipNodes_ = index;
+            }
+            else
+                AddDocument(document, size);
+        }
+    }
+
+    Publish();
+    return true;
+}
+
+bool SceneStreamParser::PublishHead()
+{
+    if (headPublished_)
+        return true;
+    headPublished_ = true;
+
+    String text;
+    if (format_ == SSF_XML)
+        text = rootName_.Empty() ? head_ : head_ + "</" + rootName_ + ">";
+    else
+        text = "{" + head_ + "}";
+    head_.Clear();
+
+    SharedPtr<Resource> document = ParseDocument(text.CString(), text.Length());
+    if (!document)
+        return false;
+    if (resourcePass_)
+        FindResources(document);
+    if (parseNodes_)
+        AddDocument(document, text.Length());
+
+    Publish();
+    return true;
+}
+
+SharedPtr<Resource> SceneStreamParser::ParseDocument(const char* text, unsigned length) const
+{
+    MemoryBuffer buffer(text, length);
+
+    if (format_ == SSF_XML)
+    {
+        SharedPtr<XMLFile> xml(new XMLFile(context_));
+        if (xml->Load(buffer))
+            return xml;
+    }
+    else
+    {
+        SharedPtr<JSONFile> json(new JSONFile(context_));
+        if (json->Load(buffer))
+            return json;
+    }
+
+    return SharedPtr<Resource>();
+}
+
+void SceneStreamParser::FindResources(Resource* document)
+{
+    Vector<ResourceRef> refs;
+    if (format_ == SSF_XML)
+        FindResourcesXML(context_, static_cast<XMLFile*>(document)->GetRoot(), refs);
+    else
+        FindResourcesJSON(context_, static_cast<JSONFile*>(document)->GetRoot(), refs);
+
+    for (unsigned i = 0; i < refs.Size(); ++i)
+        AddResource(refs[i]);
+}
+
+void SceneStreamParser::AddDocument(SharedPtr<Resource>& document, unsigned size)
+{
+    for (;;)
+    {
+        {
+            MutexLock lock(parserMutex_);
+            // Reference counts are not atomic, so release the parser's reference before the main thread can take the document
+            if (resourcePass_ || !publishedBytes_ || publishedBytes_ + size <= MAX_PUBLISHED_BYTES || !shouldRun_)
+            {
+                publishedDocuments_.Push(document);
+                document.Reset();
+                publishedBytes_ += size;
+                return;
+            }
+        }
+
+        Time::Sleep(1);
+    }
+}
+
+void SceneStreamParser::AddResource(const ResourceRef& ref)
+{
+    // Scenes typically refer to the same resources many times, so pass each name only once
+    if (ref.name_.Empty())
+        return;
+
+    bool exists;
+    foundResources_.Insert(StringHash(ref.name_), exists);
+    if (!exists)
+        resources_.Push(ref);
+}
+
+void SceneStreamParser::CompactBuffer()
+{
+    unsigned keep = Min(Min(scanPos_, markupStart_), Min(elementStart_, Min(memberStart_, keyStart_)));
+    if (!keep)
+        return;
+
+    unsigned remaining = buffer_.Size() - keep;
+    if (remaining)
+        memmove(&buffer_[0], &buffer_[keep], remaining);
+    buffer_.Resize(remaining);
+
+    scanPos_ -= keep;
+    if (markupStart_ != M_MAX_UNSIGNED)
+        markupStart_ -= keep;
+    if (elementStart_ != M_MAX_UNSIGNED)
+        elementStart_ -= keep;
+    if (memberStart_ != M_MAX_UNSIGNED)
+        memberStart_ -= keep;
+    if (keyStart_ != M_MAX_UNSIGNED)
+        keyStart_ -= keep;
+}
+
+void SceneStreamParser::Publish()
+{
+    MutexLock lock(parserMutex_);
+
+    publishedResources_.Push(resources_);
+    resources_.Clear();
+    numNodes_ = Max(numNodes_, nodeIndex_);
+}
+
+void SceneStreamParser::ResetScanner()
+{
+    buffer_.Clear();
+    rootName_.Clear();
+    key_.Clear();
+    scanPos_ = 0;
+    markupStart_ = M_MAX_UNSIGNED;
+    elementStart_ = M_MAX_UNSIGNED;
+    memberStart_ = M_MAX_UNSIGNED;
+    keyStart_ = M_MAX_UNSIGNED;
+    depth_ = 0;
+    xmlState_ = XS_TEXT;
+    quote_ = 0;
+    nodeIndex_ = 0;
+    rootClosed_ = false;
+    inString_ = false;
+    escape_ = false;
+    expectKey_ = false;
+    pendingChildren_ = false;
+    inChildren_ = false;
+}
+
+}
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+#include "../Core/Variant.h"
+
+namespace Urho3D
+{
+
+class Context;
+class Deserializer;
+class JSONValue;
+class Resource;
+class XMLElement;
+
+/// Text format of a streamed scene file.
+enum SceneStreamFormat
+{
+    SSF_XML = 0,
+    SSF_JSON
+};
+
+/// Reads a text scene file in chunks in a worker thread and splits it into small documents, one per root-level child node, for asynchronous loading. Only the documents not yet taken by the main thread and the text of the node being scanned are held in memory, so the whole scene never exists as one document. The first document holds the root node's own attributes and components.
+class URHO3D_API SceneStreamParser : public RefCounted, public Thread
+{
+public:
+    /// Construct. Does not start the parser thread yet. When finding resources and parsing nodes, the source is read twice unless the node documents fit in the memory budget.
+    SceneStreamParser(Context* context, Deserializer* source, SceneStreamFormat format, bool findResources, bool parseNodes);
+    /// Destruct. Stop the parser thread.
+    ~SceneStreamParser() override;
+
+    /// Read and parse in the worker thread.
+    void ThreadFunction() override;
+
+    /// Move the documents parsed since the last call to the destination vector. These are XMLFile or JSONFile according to the format.
+    void TakeDocuments(Vector<SharedPtr<Resource> >& documents);
+    /// Move the resources found since the last call to the destination vector.
+    void TakeResources(Vector<ResourceRef>& resources);
+    /// Return number of root-level child nodes found so far.
+    unsigned GetNumNodes() const;
+    /// Return whether all resources have been found.
+    bool HasFoundResources() const;
+    /// Return whether parsing has finished. Documents published before are still available to take.
+    bool IsFinished() const;
+    /// Return whether the text was truncated or malformed. Valid once parsing has finished.
+    bool IsFailed() const { return failed_; }
+
+    /// Return whether the source starts like a text file of the format, rather than binary cooked data. Restores the source position.
+    static bool IsTextSource(Deserializer& source, SceneStreamFormat format);
+    /// Collect the resources referred to by the components of a node and its children in an XML scene or object prefab.
+    static void FindResourcesXML(Context* context, const XMLElement& element, Vector<ResourceRef>& dest);
+    /// Collect the resources referred to by the components of a node and its children in a JSON scene or object prefab.
+    static void FindResourcesJSON(Context* context, const JSONValue& value, Vector<ResourceRef>& dest);
+
+private:
+    /// Scan the source from the current position to the end. Return true if successful.
+    bool Scan();
+    /// Scan the XML text read so far. Return false on malformed text.
+    bool ScanXML(bool endOfData);
+    /// Handle a complete XML start or end tag. Return false on malformed text.
+    bool HandleTag(unsigned start, unsigned end);
+    /// Handle a complete root-level child element ending at the position. Return false if it could not be parsed.
+    bool CompleteElement(unsigned end);
+    /// Scan the JSON text read so far. Return false on malformed text.
+    bool ScanJSON();
+    /// Add a complete JSON member of the root object to the head document.
+    void EndMember(unsigned end);
+    /// Add a complete child element or member of the root to the head document.
+    void AddHeadText(unsigned start, unsigned end);
+    /// Handle the complete text of a root-level child node. Return false if it could not be parsed.
+    bool AddNode(unsigned start, unsigned end);
+    /// Publish the head document if not published yet. Return false if it could not be parsed.
+    bool PublishHead();
+    /// Parse a document from text.
+    SharedPtr<Resource> ParseDocument(const char* text, unsigned length) const;
+    /// Collect the resources referred to by a parsed document.
+    void FindResources(Resource* document);
+    /// Publish a parsed document and release the reference to it. Outside the resource pass, waits while the published documents exceed the memory budget.
+    void AddDocument(SharedPtr<Resource>& document, unsigned size);
+    /// Add a resource to preload if not found before.
+    void AddResource(const ResourceRef& ref);
+    /// Discard the text before the earliest position still needed.
+    void CompactBuffer();
+    /// Publish the resources and node count found so far to the main thread.
+    void Publish();
+    /// Reset the scanner state for a pass over the source.
+    void ResetScanner();
+
+    /// Context.
+    Context* context_;
+    /// Source stream. Only accessed by the parser thread once started.
+    Deserializer* source_;
+    /// Text format.
+    SceneStreamFormat format_;
+    /// Text read and not yet discarded.
+    PODVector<char> buffer_;
+    /// Text of the head document, or JSON members of the root object.
+    String head_;
+    /// XML root element name.
+    String rootName_;
+    /// Current JSON member name.
+    String key_;
+    /// Resources found and not yet published.
+    Vector<ResourceRef> resources_;
+    /// Name hashes of the resources found so far.
+    HashSet<StringHash> foundResources_;
+    /// Mutex for the published documents, resources and state.
+    mutable Mutex parserMutex_;
+    /// Documents published to the main thread and not yet taken.
+    Vector<SharedPtr<Resource> > publishedDocuments_;
+    /// Resources published to the main thread and not yet taken.
+    Vector<ResourceRef> publishedResources_;
+    /// Text size of the documents published and not yet taken.
+    unsigned publishedBytes_;
+    /// Next text position to scan.
+    unsigned scanPos_;
+    /// Start of the current XML markup, or M_MAX_UNSIGNED.
+    unsigned markupStart_;
+    /// Start of the current root-level child element or JSON child node, or M_MAX_UNSIGNED.
+    unsigned elementStart_;
+    /// Start of the current JSON member of the root object, or M_MAX_UNSIGNED.
+    unsigned memberStart_;
+    /// Start of the current JSON member name, or M_MAX_UNSIGNED.
+    unsigned keyStart_;
+    /// Nesting depth of elements, objects and arrays.
+    unsigned depth_;
+    /// XML markup being scanned.
+    unsigned xmlState_;
+    /// Quote character of the XML attribute value being scanned, or 0.
+    char quote_;
+    /// Index of the next root-level child node in the current pass.
+    unsigned nodeIndex_;
+    /// Root-level child nodes whose documents were published in the first pass.
+    unsigned skipNodes_;
+    /// Root-level child nodes found so far. Protected by the mutex.
+    unsigned numNodes_;
+    /// Resource collection flag.
+    bool findResources_;
+    /// Node document creation flag.
+    bool parseNodes_;
+    /// Whether the current pass collects resources.
+    bool resourcePass_;
+    /// Whether documents are still kept in the resource pass.
+    bool keepDocuments_;
+    /// Whether the current root-level child element is a node.
+    bool elementIsNode_;
+    /// Whether the head document has been published.
+    bool headPublished_;
+    /// Whether the root has been closed.
+    bool rootClosed_;
+    /// Whether a JSON string is being scanned.
+    bool inString_;
+    /// Whether the next JSON string character is escaped.
+    bool escape_;
+    /// Whether a JSON member name is expected next.
+    bool expectKey_;
+    /// Whether the value of the JSON "children" member is expected next.
+    bool pendingChildren_;
+    /// Whether the JSON "children" array is being scanned.
+    bool inChildren_;
+    /// Resources found flag. Protected by the mutex.
+    bool resourcesFound_;
+    /// Finished flag. Protected by the mutex.
+    bool finished_;
+    /// Failure flag.
+    bool failed_;
+};
+
+}
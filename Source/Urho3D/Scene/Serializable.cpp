@@ -26,6 +26,7 @@
 #include "../IO/Deserializer.h"
 #include "../IO/Log.h"
 #include "../IO/Serializer.h"
+#include "../IO/VectorBuffer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONValue.h"
 #include "../Scene/ReplicationState.h"
@@ -53,6 +54,326 @@ static unsigned RemapAttributeIndex(const Vector<AttributeInfo>* attributes, con
     return netAttrIndex; // Could not remap
 }
 
+/// Return whether an attribute can be read and written directly through its accessor. The ID attributes may be intercepted by OnSetAttribute() and OnGetAttribute(), so they always go through a Variant.
+static inline bool IsDirectAttribute(const AttributeInfo& attr)
+{
+    return attr.accessor_ && !(attr.mode_ & (AM_NODEID | AM_COMPONENTID | AM_NODEIDVECTOR));
+}
+
+/// Buffer for the binary data of a network attribute being checked for changes. Per thread, as the threaded network update checks nodes and components in worker threads.
+static thread_local VectorBuffer networkValueBuffer;
+
+template <> bool ReadAttributeValue<int>(Deserializer& source, int& value)
+{
+    value = source.ReadInt();
+    return true;
+}
+
+template <> bool ReadAttributeValue<unsigned>(Deserializer& source, unsigned& value)
+{
+    value = source.ReadUInt();
+    return true;
+}
+
+template <> bool ReadAttributeValue<long long>(Deserializer& source, long long& value)
+{
+    value = source.ReadInt64();
+    return true;
+}
+
+template <> bool ReadAttributeValue<unsigned long long>(Deserializer& source, unsigned long long& value)
+{
+    value = source.ReadUInt64();
+    return true;
+}
+
+template <> bool ReadAttributeValue<bool>(Deserializer& source, bool& value)
+{
+    value = source.ReadBool();
+    return true;
+}
+
+template <> bool ReadAttributeValue<float>(Deserializer& source, float& value)
+{
+    value = source.ReadFloat();
+    return true;
+}
+
+template <> bool ReadAttributeValue<double>(Deserializer& source, double& value)
+{
+    value = source.ReadDouble();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Vector2>(Deserializer& source, Vector2& value)
+{
+    value = source.ReadVector2();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Vector3>(Deserializer& source, Vector3& value)
+{
+    value = source.ReadVector3();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Vector4>(Deserializer& source, Vector4& value)
+{
+    value = source.ReadVector4();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Quaternion>(Deserializer& source, Quaternion& value)
+{
+    value = source.ReadQuaternion();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Color>(Deserializer& source, Color& value)
+{
+    value = source.ReadColor();
+    return true;
+}
+
+template <> bool ReadAttributeValue<String>(Deserializer& source, String& value)
+{
+    value = source.ReadString();
+    return true;
+}
+
+template <> bool ReadAttributeValue<PODVector<unsigned char> >(Deserializer& source, PODVector<unsigned char>& value)
+{
+    value = source.ReadBuffer();
+    return true;
+}
+
+template <> bool ReadAttributeValue<ResourceRef>(Deserializer& source, ResourceRef& value)
+{
+    value = source.ReadResourceRef();
+    return true;
+}
+
+template <> bool ReadAttributeValue<ResourceRefList>(Deserializer& source, ResourceRefList& value)
+{
+    value = source.ReadResourceRefList();
+    return true;
+}
+
+template <> bool ReadAttributeValue<VariantVector>(Deserializer& source, VariantVector& value)
+{
+    value = source.ReadVariantVector();
+    return true;
+}
+
+template <> bool ReadAttributeValue<StringVector>(Deserializer& source, StringVector& value)
+{
+    value = source.ReadStringVector();
+    return true;
+}
+
+template <> bool ReadAttributeValue<VariantMap>(Deserializer& source, VariantMap& value)
+{
+    value = source.ReadVariantMap();
+    return true;
+}
+
+template <> bool ReadAttributeValue<IntRect>(Deserializer& source, IntRect& value)
+{
+    value = source.ReadIntRect();
+    return true;
+}
+
+template <> bool ReadAttributeValue<IntVector2>(Deserializer& source, IntVector2& value)
+{
+    value = source.ReadIntVector2();
+    return true;
+}
+
+template <> bool ReadAttributeValue<IntVector3>(Deserializer& source, IntVector3& value)
+{
+    value = source.ReadIntVector3();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Matrix3>(Deserializer& source, Matrix3& value)
+{
+    value = source.ReadMatrix3();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Matrix3x4>(Deserializer& source, Matrix3x4& value)
+{
+    value = source.ReadMatrix3x4();
+    return true;
+}
+
+template <> bool ReadAttributeValue<Matrix4>(Deserializer& source, Matrix4& value)
+{
+    value = source.ReadMatrix4();
+    return true;
+}
+
+template <> bool WriteAttributeValue<int>(Serializer& dest, const int& value)
+{
+    return dest.WriteInt(value);
+}
+
+template <> bool WriteAttributeValue<unsigned>(Serializer& dest, const unsigned& value)
+{
+    return dest.WriteUInt(value);
+}
+
+template <> bool WriteAttributeValue<long long>(Serializer& dest, const long long& value)
+{
+    return dest.WriteInt64(value);
+}
+
+template <> bool WriteAttributeValue<unsigned long long>(Serializer& dest, const unsigned long long& value)
+{
+    return dest.WriteUInt64(value);
+}
+
+template <> bool WriteAttributeValue<bool>(Serializer& dest, const bool& value)
+{
+    return dest.WriteBool(value);
+}
+
+template <> bool WriteAttributeValue<float>(Serializer& dest, const float& value)
+{
+    return dest.WriteFloat(value);
+}
+
+template <> bool WriteAttributeValue<double>(Serializer& dest, const double& value)
+{
+    return dest.WriteDouble(value);
+}
+
+template <> bool WriteAttributeValue<Vector2>(Serializer& dest, const Vector2& value)
+{
+    return dest.WriteVector2(value);
+}
+
+template <> bool WriteAttributeValue<Vector3>(Serializer& dest, const Vector3& value)
+{
+    return dest.WriteVector3(value);
+}
+
+template <> bool WriteAttributeValue<Vector4>(Serializer& dest, const Vector4& value)
+{
+    return dest.WriteVector4(value);
+}
+
+template <> bool WriteAttributeValue<Quaternion>(Serializer& dest, const Quaternion& value)
+{
+    return dest.WriteQuaternion(value);
+}
+
+template <> bool WriteAttributeValue<Color>(Serializer& dest, const Color& value)
+{
+    return dest.WriteColor(value);
+}
+
+template <> bool WriteAttributeValue<String>(Serializer& dest, const String& value)
+{
+    return dest.WriteString(value);
+}
+
+template <> bool WriteAttributeValue<PODVector<unsigned char> >(Serializer& dest, const PODVector<unsigned char>& value)
+{
+    return dest.WriteBuffer(value);
+}
+
+template <> bool WriteAttributeValue<ResourceRef>(Serializer& dest, const ResourceRef& value)
+{
+    return dest.WriteResourceRef(value);
+}
+
+template <> bool WriteAttributeValue<ResourceRefList>(Serializer& dest, const ResourceRefList& value)
+{
+    return dest.WriteResourceRefList(value);
+}
+
+template <> bool WriteAttributeValue<VariantVector>(Serializer& dest, const VariantVector& value)
+{
+    return dest.WriteVariantVector(value);
+}
+
+template <> bool WriteAttributeValue<StringVector>(Serializer& dest, const StringVector& value)
+{
+    return dest.WriteStringVector(value);
+}
+
+template <> bool WriteAttributeValue<VariantMap>(Serializer& dest, const VariantMap& value)
+{
+    return dest.WriteVariantMap(value);
+}
+
+template <> bool WriteAttributeValue<IntRect>(Serializer& dest, const IntRect& value)
+{
+    return dest.WriteIntRect(value);
+}
+
+template <> bool WriteAttributeValue<IntVector2>(Serializer& dest, const IntVector2& value)
+{
+    return dest.WriteIntVector2(value);
+}
+
+template <> bool WriteAttributeValue<IntVector3>(Serializer& dest, const IntVector3& value)
+{
+    return dest.WriteIntVector3(value);
+}
+
+template <> bool WriteAttributeValue<Matrix3>(Serializer& dest, const Matrix3& value)
+{
+    return dest.WriteMatrix3(value);
+}
+
+template <> bool WriteAttributeValue<Matrix3x4>(Serializer& dest, const Matrix3x4& value)
+{
+    return dest.WriteMatrix3x4(value);
+}
+
+template <> bool WriteAttributeValue<Matrix4>(Serializer& dest, const Matrix4& value)
+{
+    return dest.WriteMatrix4(value);
+}
+
+template <> bool FloatsToAttributeValue<float>(const float* values, float& value)
+{
+    value = values[0];
+    return true;
+}
+
+template <> bool FloatsToAttributeValue<Vector2>(const float* values, Vector2& value)
+{
+    value = Vector2(values);
+    return true;
+}
+
+template <> bool FloatsToAttributeValue<Vector3>(const float* values, Vector3& value)
+{
+    value = Vector3(values);
+    return true;
+}
+
+template <> bool FloatsToAttributeValue<Vector4>(const float* values, Vector4& value)
+{
+    value = Vector4(values);
+    return true;
+}
+
+template <> bool FloatsToAttributeValue<Quaternion>(const float* values, Quaternion& value)
+{
+    value = Quaternion(values);
+    return true;
+}
+
+template <> bool FloatsToAttributeValue<Color>(const float* values, Color& value)
+{
+    value = Color(values);
+    return true;
+}
+
 Serializable::Serializable(Context* context) :
     Object(context),
     setInstanceDefault_(false),
@@ -308,6 +629,11 @@ bool Serializable::Load(Deserializer& source)
             return false;
         }
 
+        // Set the common attribute types directly from the binary data, without a Variant. The instance default values
+        // and the ID attributes, which may be intercepted by OnSetAttribute(), still go through a Variant
+        if (!setInstanceDefault_ && IsDirectAttribute(attr) && attr.accessor_->Read(this, source))
+            continue;
+
         Variant varValue = source.ReadVariant(attr.type_);
         OnSetAttribute(attr, varValue);
     }
@@ -329,6 +655,9 @@ bool Serializable::Save(Serializer& dest) const
         if (!(attr.mode_ & AM_FILE) || (attr.mode_ & AM_FILEREADONLY) == AM_FILEREADONLY)
             continue;
 
+        if (IsDirectAttribute(attr) && attr.accessor_->Write(this, dest))
+            continue;
+
         OnGetAttribute(attr, value);
 
         if (!dest.WriteVariantData(value))
@@ -709,6 +1038,15 @@ void Serializable::SetInterceptNetworkUpdate(const String& attributeName, bool e
     }
 }
 
+void Serializable::WriteNetworkValue(Serializer& dest, unsigned index) const
+{
+    const PODVector<unsigned char>& serialized = networkState_->serializedValues_[index];
+    if (serialized.Size())
+        dest.Write(serialized.Buffer(), serialized.Size());
+    else
+        dest.WriteVariantData(networkState_->currentValues_[index]);
+}
+
 void Serializable::AllocateNetworkState()
 {
     if (networkState_)
@@ -727,6 +1065,7 @@ void Serializable::AllocateNetworkState()
     {
         networkState_->currentValues_.Resize(numAttributes);
         networkState_->previousValues_.Resize(numAttributes);
+        networkState_->serializedValues_.Resize(numAttributes);
 
         // Copy the default attribute values to the previous state as a starting point
         for (unsigned i = 0; i < numAttributes; ++i)
@@ -764,7 +1103,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, i);
     }
 }
 
@@ -790,7 +1129,7 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, i);
     }
 }
 
@@ -813,10 +1152,66 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, i);
     }
 }
 
+void Serializable::UpdateSerializedNetworkValue(unsigned index)
+{
+    PODVector<unsigned char>& serialized = networkState_->serializedValues_[index];
+
+    // Connections that start tracking the object later write the value directly, so nothing is cached if none are
+    // tracking it now. The copy is only written here on the main thread, so that the connections can read it
+    // concurrently
+    if (networkState_->replicationStates_.Empty())
+    {
+        serialized.Clear();
+        return;
+    }
+
+    VectorBuffer buffer;
+    buffer.WriteVariantData(networkState_->currentValues_[index]);
+    serialized = buffer.GetBuffer();
+}
+
+bool Serializable::UpdateNetworkValue(unsigned index)
+{
+    const AttributeInfo& attr = networkState_->attributes_->At(index);
+    Variant& current = networkState_->currentValues_[index];
+    Variant& previous = networkState_->previousValues_[index];
+
+    if (IsDirectAttribute(attr))
+    {
+        networkValueBuffer.Clear();
+        if (attr.accessor_->Write(this, networkValueBuffer))
+        {
+            // The serialized copy is always kept for these attributes to compare against. An empty previous value
+            // means that the value must be checked again, even if the data is the same
+            PODVector<unsigned char>& serialized = networkState_->serializedValues_[index];
+            unsigned size = networkValueBuffer.GetSize();
+            if (!previous.IsEmpty() && serialized.Size() == size && !memcmp(serialized.Buffer(), networkValueBuffer.GetData(), size))
+                return false;
+
+            serialized = networkValueBuffer.GetBuffer();
+            networkValueBuffer.Seek(0);
+            current = networkValueBuffer.ReadVariant(attr.type_);
+            if (current == previous)
+                return false;
+
+            previous = current;
+            return true;
+        }
+    }
+
+    OnGetAttribute(attr, current);
+    if (current == previous)
+        return false;
+
+    previous = current;
+    UpdateSerializedNetworkValue(index);
+    return true;
+}
+
 bool Serializable::ReadDeltaUpdate(Deserializer& source)
 {
     const Vector<AttributeInfo>* attributes = GetNetworkAttributes();
@@ -838,7 +1233,8 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
             const AttributeInfo& attr = attributes->At(i);
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                if (!IsDirectAttribute(attr) || !attr.accessor_->Read(this, source))
+                    OnSetAttribute(attr, source.ReadVariant(attr.type_));
                 changed = true;
             }
             else
@@ -878,7 +1274,8 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         {
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                if (!IsDirectAttribute(attr) || !attr.accessor_->Read(this, source))
+                    OnSetAttribute(attr, source.ReadVariant(attr.type_));
                 changed = true;
             }
             else
@@ -51,7 +51,7 @@ public:
     /// Destruct.
     ~Serializable() override;
 
-    /// Handle attribute write access. Default implementation writes to the variable at offset, or invokes the set accessor.
+    /// Handle attribute write access. Default implementation writes to the variable at offset, or invokes the set accessor. Not called by binary Load() for attributes whose accessor reads binary data directly.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
     /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
@@ -103,6 +103,10 @@ public:
     void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
     /// Write a latest data network update.
     void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Update the serialized copy of a changed network attribute value that is shared by all connections' updates.
+    void UpdateSerializedNetworkValue(unsigned index);
+    /// Fetch the current value of a network attribute and return true if it changed since the last update. Attributes that can be written directly are compared by their binary data, and only converted to a Variant when changed.
+    bool UpdateNetworkValue(unsigned index);
     /// Read and apply a network delta update. Return true if attributes were changed.
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
@@ -139,6 +143,8 @@ private:
     void SetInstanceDefault(const String& name, const Variant& defaultValue);
     /// Get instance-level default value.
     Variant GetInstanceDefault(const String& name) const;
+    /// Write a current network attribute value, from the serialized copy if available.
+    void WriteNetworkValue(Serializer& dest, unsigned index) const;
 
     /// Attribute default value at each instance level.
     UniquePtr<VariantMap> instanceDefaultValues_;
@@ -179,6 +185,119 @@ private:
     TSetFunction setFunction_;
 };
 
+/// Template implementation of the variant attribute accessor that also reads, writes and sets values directly.
+template <class TClassType, class TGetFunction, class TSetFunction, class TReadFunction, class TWriteFunction, class TSetFloatsFunction>
+class DirectAttributeAccessorImpl : public VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>
+{
+public:
+    /// Construct.
+    DirectAttributeAccessorImpl(TGetFunction getFunction, TSetFunction setFunction, TReadFunction readFunction, TWriteFunction writeFunction,
+        TSetFloatsFunction setFloatsFunction) :
+        VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction),
+        readFunction_(readFunction),
+        writeFunction_(writeFunction),
+        setFloatsFunction_(setFloatsFunction)
+    {
+    }
+
+    /// Invoke read function.
+    bool Read(Serializable* ptr, Deserializer& source) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        return readFunction_(*classPtr, source);
+    }
+
+    /// Invoke write function.
+    bool Write(const Serializable* ptr, Serializer& dest) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        return writeFunction_(*classPtr, dest);
+    }
+
+    /// Invoke set floats function.
+    bool SetFloats(Serializable* ptr, const float* values) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        return setFloatsFunction_(*classPtr, values);
+    }
+
+private:
+    /// Read functor.
+    TReadFunction readFunction_;
+    /// Write functor.
+    TWriteFunction writeFunction_;
+    /// Set floats functor.
+    TSetFloatsFunction setFloatsFunction_;
+};
+
+/// Read an attribute value from binary data in the same format as Deserializer::ReadVariant(). Return false without reading if the type is not supported.
+template <class T> bool ReadAttributeValue(Deserializer& source, T& value) { return false; }
+template <> URHO3D_API bool ReadAttributeValue<int>(Deserializer& source, int& value);
+template <> URHO3D_API bool ReadAttributeValue<unsigned>(Deserializer& source, unsigned& value);
+template <> URHO3D_API bool ReadAttributeValue<long long>(Deserializer& source, long long& value);
+template <> URHO3D_API bool ReadAttributeValue<unsigned long long>(Deserializer& source, unsigned long long& value);
+template <> URHO3D_API bool ReadAttributeValue<bool>(Deserializer& source, bool& value);
+template <> URHO3D_API bool ReadAttributeValue<float>(Deserializer& source, float& value);
+template <> URHO3D_API bool ReadAttributeValue<double>(Deserializer& source, double& value);
+template <> URHO3D_API bool ReadAttributeValue<Vector2>(Deserializer& source, Vector2& value);
+template <> URHO3D_API bool ReadAttributeValue<Vector3>(Deserializer& source, Vector3& value);
+template <> URHO3D_API bool ReadAttributeValue<Vector4>(Deserializer& source, Vector4& value);
+template <> URHO3D_API bool ReadAttributeValue<Quaternion>(Deserializer& source, Quaternion& value);
+template <> URHO3D_API bool ReadAttributeValue<Color>(Deserializer& source, Color& value);
+template <> URHO3D_API bool ReadAttributeValue<String>(Deserializer& source, String& value);
+template <> URHO3D_API bool ReadAttributeValue<PODVector<unsigned char> >(Deserializer& source, PODVector<unsigned char>& value);
+template <> URHO3D_API bool ReadAttributeValue<ResourceRef>(Deserializer& source, ResourceRef& value);
+template <> URHO3D_API bool ReadAttributeValue<ResourceRefList>(Deserializer& source, ResourceRefList& value);
+template <> URHO3D_API bool ReadAttributeValue<VariantVector>(Deserializer& source, VariantVector& value);
+template <> URHO3D_API bool ReadAttributeValue<StringVector>(Deserializer& source, StringVector& value);
+template <> URHO3D_API bool ReadAttributeValue<VariantMap>(Deserializer& source, VariantMap& value);
+template <> URHO3D_API bool ReadAttributeValue<IntRect>(Deserializer& source, IntRect& value);
+template <> URHO3D_API bool ReadAttributeValue<IntVector2>(Deserializer& source, IntVector2& value);
+template <> URHO3D_API bool ReadAttributeValue<IntVector3>(Deserializer& source, IntVector3& value);
+template <> URHO3D_API bool ReadAttributeValue<Matrix3>(Deserializer& source, Matrix3& value);
+template <> URHO3D_API bool ReadAttributeValue<Matrix3x4>(Deserializer& source, Matrix3x4& value);
+template <> URHO3D_API bool ReadAttributeValue<Matrix4>(Deserializer& source, Matrix4& value);
+
+/// Write an attribute value to binary data in the same format as Serializer::WriteVariantData(). Return false without writing if the type is not supported.
+template <class T> bool WriteAttributeValue(Serializer& dest, const T& value) { return false; }
+template <> URHO3D_API bool WriteAttributeValue<int>(Serializer& dest, const int& value);
+template <> URHO3D_API bool WriteAttributeValue<unsigned>(Serializer& dest, const unsigned& value);
+template <> URHO3D_API bool WriteAttributeValue<long long>(Serializer& dest, const long long& value);
+template <> URHO3D_API bool WriteAttributeValue<unsigned long long>(Serializer& dest, const unsigned long long& value);
+template <> URHO3D_API bool WriteAttributeValue<bool>(Serializer& dest, const bool& value);
+template <> URHO3D_API bool WriteAttributeValue<float>(Serializer& dest, const float& value);
+template <> URHO3D_API bool WriteAttributeValue<double>(Serializer& dest, const double& value);
+template <> URHO3D_API bool WriteAttributeValue<Vector2>(Serializer& dest, const Vector2& value);
+template <> URHO3D_API bool WriteAttributeValue<Vector3>(Serializer& dest, const Vector3& value);
+template <> URHO3D_API bool WriteAttributeValue<Vector4>(Serializer& dest, const Vector4& value);
+template <> URHO3D_API bool WriteAttributeValue<Quaternion>(Serializer& dest, const Quaternion& value);
+template <> URHO3D_API bool WriteAttributeValue<Color>(Serializer& dest, const Color& value);
+template <> URHO3D_API bool WriteAttributeValue<String>(Serializer& dest, const String& value);
+template <> URHO3D_API bool WriteAttributeValue<PODVector<unsigned char> >(Serializer& dest, const PODVector<unsigned char>& value);
+template <> URHO3D_API bool WriteAttributeValue<ResourceRef>(Serializer& dest, const ResourceRef& value);
+template <> URHO3D_API bool WriteAttributeValue<ResourceRefList>(Serializer& dest, const ResourceRefList& value);
+template <> URHO3D_API bool WriteAttributeValue<VariantVector>(Serializer& dest, const VariantVector& value);
+template <> URHO3D_API bool WriteAttributeValue<StringVector>(Serializer& dest, const StringVector& value);
+template <> URHO3D_API bool WriteAttributeValue<VariantMap>(Serializer& dest, const VariantMap& value);
+template <> URHO3D_API bool WriteAttributeValue<IntRect>(Serializer& dest, const IntRect& value);
+template <> URHO3D_API bool WriteAttributeValue<IntVector2>(Serializer& dest, const IntVector2& value);
+template <> URHO3D_API bool WriteAttributeValue<IntVector3>(Serializer& dest, const IntVector3& value);
+template <> URHO3D_API bool WriteAttributeValue<Matrix3>(Serializer& dest, const Matrix3& value);
+template <> URHO3D_API bool WriteAttributeValue<Matrix3x4>(Serializer& dest, const Matrix3x4& value);
+template <> URHO3D_API bool WriteAttributeValue<Matrix4>(Serializer& dest, const Matrix4& value);
+
+/// Convert float components in the memory order of a value type to an attribute value. Return false if the type does not consist of floats.
+template <class T> bool FloatsToAttributeValue(const float* values, T& value) { return false; }
+template <> URHO3D_API bool FloatsToAttributeValue<float>(const float* values, float& value);
+template <> URHO3D_API bool FloatsToAttributeValue<Vector2>(const float* values, Vector2& value);
+template <> URHO3D_API bool FloatsToAttributeValue<Vector3>(const float* values, Vector3& value);
+template <> URHO3D_API bool FloatsToAttributeValue<Vector4>(const float* values, Vector4& value);
+template <> URHO3D_API bool FloatsToAttributeValue<Quaternion>(const float* values, Quaternion& value);
+template <> URHO3D_API bool FloatsToAttributeValue<Color>(const float* values, Color& value);
+
 /// Make variant attribute accessor implementation.
 /// \tparam TClassType Serializable class type.
 /// \tparam TGetFunction Functional object with call signature `void getFunction(const TClassType& self, Variant& value)`
@@ -189,35 +308,80 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     return SharedPtr<AttributeAccessor>(new VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction));
 }
 
+/// Make variant attribute accessor implementation that also reads, writes and sets values directly.
+/// \tparam TClassType Serializable class type.
+/// \tparam TGetFunction Functional object with call signature `void getFunction(const TClassType& self, Variant& value)`
+/// \tparam TSetFunction Functional object with call signature `void setFunction(TClassType& self, const Variant& value)`
+/// \tparam TReadFunction Functional object with call signature `bool readFunction(TClassType& self, Deserializer& source)`
+/// \tparam TWriteFunction Functional object with call signature `bool writeFunction(const TClassType& self, Serializer& dest)`
+/// \tparam TSetFloatsFunction Functional object with call signature `bool setFloatsFunction(TClassType& self, const float* values)`
+template <class TClassType, class TGetFunction, class TSetFunction, class TReadFunction, class TWriteFunction, class TSetFloatsFunction>
+SharedPtr<AttributeAccessor> MakeDirectAttributeAccessor(TGetFunction getFunction, TSetFunction setFunction, TReadFunction readFunction,
+    TWriteFunction writeFunction, TSetFloatsFunction setFloatsFunction)
+{
+    return SharedPtr<AttributeAccessor>(new DirectAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction, TReadFunction, TWriteFunction,
+        TSetFloatsFunction>(getFunction, setFunction, readFunction, writeFunction, setFloatsFunction));
+}
+
 /// Make member attribute accessor.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { typeName value{}; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } self.variable = value; return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<typeName>(dest, self.variable); }, \
+    [](ClassName& self, const float* values) -> bool { typeName value{}; \
+        if (!Urho3D::FloatsToAttributeValue(values, value)) { return false; } self.variable = value; return true; })
 
 /// Make member attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { typeName value{}; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } self.variable = value; self.postSetCallback(); return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<typeName>(dest, self.variable); }, \
+    [](ClassName& self, const float* values) -> bool { typeName value{}; \
+        if (!Urho3D::FloatsToAttributeValue(values, value)) { return false; } self.variable = value; self.postSetCallback(); return true; })
 
 /// Make get/set attribute accessor.
-#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.getFunction(); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { typeName value{}; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } self.setFunction(value); return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<typeName>(dest, self.getFunction()); }, \
+    [](ClassName& self, const float* values) -> bool { typeName value{}; \
+        if (!Urho3D::FloatsToAttributeValue(values, value)) { return false; } self.setFunction(value); return true; })
 
 /// Make member enum attribute accessor
-#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.variable); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { int value = 0; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } \
+        self.variable = static_cast<decltype(self.variable)>(value); return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<int>(dest, static_cast<int>(self.variable)); }, \
+    [](ClassName& self, const float* values) -> bool { return false; })
 
 /// Make member enum attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR_EX(variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR_EX(variable, postSetCallback) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.variable); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); self.postSetCallback(); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); self.postSetCallback(); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { int value = 0; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } \
+        self.variable = static_cast<decltype(self.variable)>(value); self.postSetCallback(); return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<int>(dest, static_cast<int>(self.variable)); }, \
+    [](ClassName& self, const float* values) -> bool { return false; })
 
 /// Make get/set enum attribute accessor.
-#define URHO3D_MAKE_GET_SET_ENUM_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_GET_SET_ENUM_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeDirectAttributeAccessor<ClassName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.getFunction()); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(static_cast<typeName>(value.Get<int>())); })
+    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(static_cast<typeName>(value.Get<int>())); }, \
+    [](ClassName& self, Urho3D::Deserializer& source) -> bool { int value = 0; \
+        if (!Urho3D::ReadAttributeValue(source, value)) { return false; } \
+        self.setFunction(static_cast<typeName>(value)); return true; }, \
+    [](const ClassName& self, Urho3D::Serializer& dest) -> bool { return Urho3D::WriteAttributeValue<int>(dest, static_cast<int>(self.getFunction())); }, \
+    [](ClassName& self, const float* values) -> bool { return false; })
 
 /// Attribute metadata.
 namespace AttributeMetadata
@@ -36,12 +36,17 @@ SmoothedTransform::SmoothedTransform(Context* context) :
     Component(context),
     targetPosition_(Vector3::ZERO),
     targetRotation_(Quaternion::IDENTITY),
+    numSnapshots_(0),
     smoothingMask_(SMOOTH_NONE),
-    subscribed_(false)
+    smoothingIndex_(M_MAX_UNSIGNED)
 {
 }
 
-SmoothedTransform::~SmoothedTransform() = default;
+SmoothedTransform::~SmoothedTransform()
+{
+    if (smoothingScene_)
+        smoothingScene_->RemoveSmoothedTransform(this);
+}
 
 void SmoothedTransform::RegisterObject(Context* context)
 {
@@ -52,61 +57,127 @@ void SmoothedTransform::Update(float constant, float squaredSnapThreshold)
 {
     if (smoothingMask_ && node_)
     {
-        Vector3 position = node_->GetPosition();
-        Quaternion rotation = node_->GetRotation();
+        Vector3 position;
+        Quaternion rotation;
+        SmoothingTypeFlags remaining;
 
-        if (smoothingMask_ & SMOOTH_POSITION)
+        Scene* scene = GetScene();
+        if (constant < 1.0f && scene && scene->GetSmoothingMode() == SMOOTHING_SNAPSHOT)
         {
-            // If position snaps, snap everything to the end
-            float delta = (position - targetPosition_).LengthSquared();
-            if (delta > squaredSnapThreshold)
-                constant = 1.0f;
-
-            if (delta < M_EPSILON || constant >= 1.0f)
-            {
-                position = targetPosition_;
-                smoothingMask_ &= ~SMOOTH_POSITION;
-            }
-            else
-                position = position.Lerp(targetPosition_, constant);
-
-            node_->SetPosition(position);
+            remaining = CalculateSnapshotSmoothing(scene->GetElapsedTime() - scene->GetSnapshotDelay(), squaredSnapThreshold,
+                position, rotation);
         }
+        else
+            remaining = CalculateSmoothing(constant, squaredSnapThreshold, position, rotation);
+
+        ApplySmoothing(position, rotation, remaining);
+    }
+}
+
+SmoothingTypeFlags SmoothedTransform::CalculateSmoothing(float constant, float squaredSnapThreshold, Vector3& position,
+    Quaternion& rotation) const
+{
+    SmoothingTypeFlags remaining = smoothingMask_;
+    position = node_->GetPosition();
+    rotation = node_->GetRotation();
 
-        if (smoothingMask_ & SMOOTH_ROTATION)
+    if (smoothingMask_ & SMOOTH_POSITION)
+    {
+        // If position snaps, snap everything to the end
+        float delta = (position - targetPosition_).LengthSquared();
+        if (delta > squaredSnapThreshold)
+            constant = 1.0f;
+
+        if (delta < M_EPSILON || constant >= 1.0f)
         {
-            float delta = (rotation - targetRotation_).LengthSquared();
-            if (delta < M_EPSILON || constant >= 1.0f)
-            {
-                rotation = targetRotation_;
-                smoothingMask_ &= ~SMOOTH_ROTATION;
-            }
-            else
-                rotation = rotation.Slerp(targetRotation_, constant);
-
-            node_->SetRotation(rotation);
+            position = targetPosition_;
+            remaining &= ~SMOOTH_POSITION;
         }
+        else
+            position = position.Lerp(targetPosition_, constant);
     }
 
-    // If smoothing has completed, unsubscribe from the update event
-    if (!smoothingMask_)
+    if (smoothingMask_ & SMOOTH_ROTATION)
     {
-        UnsubscribeFromEvent(GetScene(), E_UPDATESMOOTHING);
-        subscribed_ = false;
+        float delta = (rotation - targetRotation_).LengthSquared();
+        if (delta < M_EPSILON || constant >= 1.0f)
+        {
+            rotation = targetRotation_;
+            remaining &= ~SMOOTH_ROTATION;
+        }
+        else
+            rotation = rotation.Slerp(targetRotation_, constant);
     }
+
+    return remaining;
 }
 
-void SmoothedTransform::SetTargetPosition(const Vector3& position)
+SmoothingTypeFlags SmoothedTransform::CalculateSnapshotSmoothing(float time, float squaredSnapThreshold, Vector3& position,
+    Quaternion& rotation) const
 {
-    targetPosition_ = position;
-    smoothingMask_ |= SMOOTH_POSITION;
+    if (!numSnapshots_)
+    {
+        position = targetPosition_;
+        rotation = targetRotation_;
+        return SMOOTH_NONE;
+    }
+
+    // Past the newest snapshot there is nothing to interpolate to, so hold it and finish
+    const SmoothingSnapshot& newest = snapshots_[numSnapshots_ - 1];
+    if (time >= newest.time_)
+    {
+        position = newest.position_;
+        rotation = newest.rotation_;
+        return SMOOTH_NONE;
+    }
 
-    // Subscribe to smoothing update if not yet subscribed
-    if (!subscribed_)
+    unsigned index = 0;
+    while (index + 2 < numSnapshots_ && snapshots_[index + 1].time_ <= time)
+        ++index;
+
+    const SmoothingSnapshot& from = snapshots_[index];
+    const SmoothingSnapshot& to = snapshots_[index + 1];
+    if (time <= from.time_)
+    {
+        position = from.position_;
+        rotation = from.rotation_;
+    }
+    else if ((to.position_ - from.position_).LengthSquared() > squaredSnapThreshold)
     {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
-        subscribed_ = true;
+        // Teleport instead of interpolating over a long distance
+        position = to.position_;
+        rotation = to.rotation_;
     }
+    else
+    {
+        float t = Clamp((time - from.time_) / Max(to.time_ - from.time_, M_EPSILON), 0.0f, 1.0f);
+        position = from.position_.Lerp(to.position_, t);
+        rotation = from.rotation_.Slerp(to.rotation_, t);
+    }
+
+    return SMOOTH_POSITION | SMOOTH_ROTATION;
+}
+
+void SmoothedTransform::ApplySmoothing(const Vector3& position, const Quaternion& rotation, SmoothingTypeFlags remaining)
+{
+    if (!node_)
+        return;
+
+    // Write both with one dirty propagation
+    if ((smoothingMask_ & SMOOTH_POSITION) && (smoothingMask_ & SMOOTH_ROTATION))
+        node_->SetTransform(position, rotation);
+    else if (smoothingMask_ & SMOOTH_POSITION)
+        node_->SetPosition(position);
+    else if (smoothingMask_ & SMOOTH_ROTATION)
+        node_->SetRotation(rotation);
+
+    smoothingMask_ = remaining;
+}
+
+void SmoothedTransform::SetTargetPosition(const Vector3& position)
+{
+    targetPosition_ = position;
+    StartSmoothing(SMOOTH_POSITION);
 
     SendEvent(E_TARGETPOSITION);
 }
@@ -114,13 +185,7 @@ void SmoothedTransform::SetTargetPosition(const Vector3& position)
 void SmoothedTransform::SetTargetRotation(const Quaternion& rotation)
 {
     targetRotation_ = rotation;
-    smoothingMask_ |= SMOOTH_ROTATION;
-
-    if (!subscribed_)
-    {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
-        subscribed_ = true;
-    }
+    StartSmoothing(SMOOTH_ROTATION);
 
     SendEvent(E_TARGETROTATION);
 }
@@ -167,13 +232,65 @@ void SmoothedTransform::OnNodeSet(Node* node)
     }
 }
 
-void SmoothedTransform::HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData)
+void SmoothedTransform::OnSceneSet(Scene* scene)
+{
+    if (smoothingScene_ && smoothingScene_ != scene)
+        smoothingScene_->RemoveSmoothedTransform(this);
+
+    if (scene && smoothingMask_ && !smoothingScene_)
+        scene->AddSmoothedTransform(this);
+}
+
+void SmoothedTransform::StartSmoothing(SmoothingTypeFlags operations)
+{
+    Scene* scene = GetScene();
+
+    // Snapshot interpolation moves position and rotation together along the buffered targets
+    if (scene && scene->GetSmoothingMode() == SMOOTHING_SNAPSHOT)
+    {
+        AddSnapshot(scene);
+        operations = SMOOTH_POSITION | SMOOTH_ROTATION;
+    }
+
+    smoothingMask_ |= operations;
+
+    // Add to the scene's smoothing update if not yet added
+    if (scene && !smoothingScene_)
+        scene->AddSmoothedTransform(this);
+}
+
+void SmoothedTransform::AddSnapshot(Scene* scene)
 {
-    using namespace UpdateSmoothing;
+    float time = scene->GetElapsedTime();
+
+    // Position and rotation of one network update arrive separately, so combine them into the same snapshot
+    if (numSnapshots_ && snapshots_[numSnapshots_ - 1].time_ == time)
+    {
+        snapshots_[numSnapshots_ - 1].position_ = targetPosition_;
+        snapshots_[numSnapshots_ - 1].rotation_ = targetRotation_;
+        return;
+    }
+
+    // After coming to rest, start over from the current transform, so that the motion to the new target takes the delay
+    if (!smoothingMask_ && node_)
+    {
+        snapshots_[0].position_ = node_->GetPosition();
+        snapshots_[0].rotation_ = node_->GetRotation();
+        snapshots_[0].time_ = time - scene->GetSnapshotDelay();
+        numSnapshots_ = 1;
+    }
+
+    if (numSnapshots_ == MAX_SMOOTHING_SNAPSHOTS)
+    {
+        for (unsigned i = 1; i < numSnapshots_; ++i)
+            snapshots_[i - 1] = snapshots_[i];
+        --numSnapshots_;
+    }
 
-    float constant = eventData[P_CONSTANT].GetFloat();
-    float squaredSnapThreshold = eventData[P_SQUAREDSNAPTHRESHOLD].GetFloat();
-    Update(constant, squaredSnapThreshold);
+    SmoothingSnapshot& snapshot = snapshots_[numSnapshots_++];
+    snapshot.position_ = targetPosition_;
+    snapshot.rotation_ = targetRotation_;
+    snapshot.time_ = time;
 }
 
 }
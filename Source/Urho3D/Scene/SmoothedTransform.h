@@ -38,10 +38,27 @@ enum SmoothingType : unsigned
 };
 URHO3D_FLAGSET(SmoothingType, SmoothingTypeFlags);
 
+/// Maximum number of buffered target transforms for snapshot interpolation.
+static const unsigned MAX_SMOOTHING_SNAPSHOTS = 8;
+
+/// Target transform received at a scene time, for snapshot interpolation.
+struct SmoothingSnapshot
+{
+    /// Position in parent space.
+    Vector3 position_;
+    /// Rotation in parent space.
+    Quaternion rotation_;
+    /// Scene elapsed time when received.
+    float time_;
+};
+
 /// Transform smoothing component for network updates.
 class URHO3D_API SmoothedTransform : public Component
 {
     URHO3D_OBJECT(SmoothedTransform, Component);
+    URHO3D_POOLED_OBJECT(SmoothedTransform);
+
+    friend class Scene;
 
 public:
     /// Construct.
@@ -51,8 +68,14 @@ public:
     /// Register object factory.
     static void RegisterObject(Context* context);
 
-    /// Update smoothing.
+    /// Update smoothing. A constant of 1 snaps to the target immediately.
     void Update(float constant, float squaredSnapThreshold);
+    /// Calculate exponentially smoothed transform from the current node transform, without modifying the node. Return the smoothing operations still in progress afterward. Can be called from worker threads.
+    SmoothingTypeFlags CalculateSmoothing(float constant, float squaredSnapThreshold, Vector3& position, Quaternion& rotation) const;
+    /// Calculate the transform interpolated between the buffered targets at a scene time, without modifying the node. Return the smoothing operations still in progress afterward. Can be called from worker threads.
+    SmoothingTypeFlags CalculateSnapshotSmoothing(float time, float squaredSnapThreshold, Vector3& position, Quaternion& rotation) const;
+    /// Apply a calculated transform to the node, with one dirty propagation for both position and rotation, and set the smoothing operations still in progress.
+    void ApplySmoothing(const Vector3& position, const Quaternion& rotation, SmoothingTypeFlags remaining);
     /// Set target position in parent space.
     void SetTargetPosition(const Vector3& position);
     /// Set target rotation in parent space.
@@ -76,22 +99,35 @@ public:
     /// Return whether smoothing is in progress.
     bool IsInProgress() const { return smoothingMask_ != SMOOTH_NONE; }
 
+    /// Return number of buffered target transforms for snapshot interpolation.
+    unsigned GetNumSnapshots() const { return numSnapshots_; }
+
 protected:
     /// Handle scene node being assigned at creation.
     void OnNodeSet(Node* node) override;
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Handle smoothing update event.
-    void HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData);
+    /// Start smoothing after a target change. Buffers a snapshot in snapshot interpolation mode and adds to the scene's batched smoothing update.
+    void StartSmoothing(SmoothingTypeFlags operations);
+    /// Buffer the current target transform as a snapshot.
+    void AddSnapshot(Scene* scene);
 
     /// Target position.
     Vector3 targetPosition_;
     /// Target rotation.
     Quaternion targetRotation_;
+    /// Buffered target transforms for snapshot interpolation, oldest first.
+    SmoothingSnapshot snapshots_[MAX_SMOOTHING_SNAPSHOTS];
+    /// Number of buffered target transforms.
+    unsigned numSnapshots_;
     /// Active smoothing operations bitmask.
     SmoothingTypeFlags smoothingMask_;
-    /// Subscribed to smoothing update event flag.
-    bool subscribed_;
+    /// Scene whose batched smoothing update this transform has been added to.
+    WeakPtr<Scene> smoothingScene_;
+    /// Index in the scene's batched smoothing update, or M_MAX_UNSIGNED if not added.
+    unsigned smoothingIndex_;
 };
 
 }
@@ -46,6 +46,64 @@ const char* interpMethodNames[] =
     nullptr
 };
 
+/// Return number of float components of a value type, or 0 if it does not consist of floats.
+static unsigned GetNumValueFloats(VariantType type)
+{
+    switch (type)
+    {
+    case VAR_FLOAT:
+        return 1;
+
+    case VAR_VECTOR2:
+        return 2;
+
+    case VAR_VECTOR3:
+        return 3;
+
+    case VAR_VECTOR4:
+    case VAR_QUATERNION:
+    case VAR_COLOR:
+        return 4;
+
+    default:
+        return 0;
+    }
+}
+
+/// Copy the float components of a value.
+static void CopyValueFloats(const Variant& value, float* dest)
+{
+    switch (value.GetType())
+    {
+    case VAR_FLOAT:
+        dest[0] = value.GetFloat();
+        break;
+
+    case VAR_VECTOR2:
+        memcpy(dest, value.GetVector2().Data(), sizeof(Vector2));
+        break;
+
+    case VAR_VECTOR3:
+        memcpy(dest, value.GetVector3().Data(), sizeof(Vector3));
+        break;
+
+    case VAR_VECTOR4:
+        memcpy(dest, value.GetVector4().Data(), sizeof(Vector4));
+        break;
+
+    case VAR_QUATERNION:
+        memcpy(dest, value.GetQuaternion().Data(), sizeof(Quaternion));
+        break;
+
+    case VAR_COLOR:
+        memcpy(dest, value.GetColor().Data(), sizeof(Color));
+        break;
+
+    default:
+        break;
+    }
+}
+
 ValueAnimation::ValueAnimation(Context* context) :
     Resource(context),
     owner_(nullptr),
@@ -53,9 +111,11 @@ ValueAnimation::ValueAnimation(Context* context) :
     splineTension_(0.5f),
     valueType_(VAR_NONE),
     interpolatable_(false),
+    numFloats_(0),
     beginTime_(M_INFINITY),
     endTime_(-M_INFINITY),
-    splineTangentsDirty_(false)
+    splineTangentsDirty_(false),
+    floatsDirty_(false)
 {
 }
 
@@ -232,6 +292,7 @@ void ValueAnimation::SetValueType(VariantType valueType)
     interpolatable_ =
         (valueType_ == VAR_FLOAT) || (valueType_ == VAR_VECTOR2) || (valueType_ == VAR_VECTOR3) || (valueType_ == VAR_VECTOR4) ||
         (valueType_ == VAR_QUATERNION) || (valueType_ == VAR_COLOR);
+    numFloats_ = GetNumValueFloats(valueType_);
 
     if ((valueType_ == VAR_INTRECT) || (valueType_ == VAR_INTVECTOR2) || (valueType_ == VAR_INTVECTOR3))
     {
@@ -245,6 +306,7 @@ void ValueAnimation::SetValueType(VariantType valueType)
     eventFrames_.Clear();
     beginTime_ = M_INFINITY;
     endTime_ = -M_INFINITY;
+    floatsDirty_ = true;
 }
 
 void ValueAnimation::SetOwner(void* owner)
@@ -263,12 +325,14 @@ void ValueAnimation::SetInterpolationMethod(InterpMethod method)
 
     interpolationMethod_ = method;
     splineTangentsDirty_ = true;
+    floatsDirty_ = true;
 }
 
 void ValueAnimation::SetSplineTension(float tension)
 {
     splineTension_ = tension;
     splineTangentsDirty_ = true;
+    floatsDirty_ = true;
 }
 
 bool ValueAnimation::SetKeyFrame(float time, const Variant& value)
@@ -302,6 +366,7 @@ bool ValueAnimation::SetKeyFrame(float time, const Variant& value)
     beginTime_ = Min(time, beginTime_);
     endTime_ = Max(time, endTime_);
     splineTangentsDirty_ = true;
+    floatsDirty_ = true;
 
     return true;
 }
@@ -358,6 +423,75 @@ Variant ValueAnimation::GetAnimationValue(float scaledTime) const
     }
 }
 
+bool ValueAnimation::GetAnimationFloats(float scaledTime, float* dest) const
+{
+    if (!numFloats_ || !IsValid())
+        return false;
+
+    if (floatsDirty_)
+        UpdateFloats();
+
+    unsigned numKeyFrames = keyFrameTimes_.Size();
+    if (!numKeyFrames)
+        return false;
+
+    // Find the first key frame after the time with a binary search, same as the linear search in GetAnimationValue()
+    unsigned index = 1;
+    unsigned end = numKeyFrames;
+    while (index < end)
+    {
+        unsigned middle = (index + end) >> 1u;
+        if (scaledTime < keyFrameTimes_[middle])
+            end = middle;
+        else
+            index = middle + 1;
+    }
+
+    const float* value1 = &keyFrameFloats_[(index - 1) * numFloats_];
+
+    if (index >= numKeyFrames || !interpolatable_ || interpolationMethod_ == IM_NONE)
+    {
+        for (unsigned i = 0; i < numFloats_; ++i)
+            dest[i] = value1[i];
+        return true;
+    }
+
+    const float* value2 = value1 + numFloats_;
+    float t = (scaledTime - keyFrameTimes_[index - 1]) / (keyFrameTimes_[index] - keyFrameTimes_[index - 1]);
+
+    if (interpolationMethod_ == IM_LINEAR)
+    {
+        if (valueType_ == VAR_QUATERNION)
+        {
+            Quaternion result = Quaternion(value1).Slerp(Quaternion(value2), t);
+            memcpy(dest, result.Data(), sizeof(Quaternion));
+        }
+        else
+        {
+            for (unsigned i = 0; i < numFloats_; ++i)
+                dest[i] = Lerp(value1[i], value2[i], t);
+        }
+    }
+    else
+    {
+        float tt = t * t;
+        float ttt = t * tt;
+
+        float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
+        float h2 = -2.0f * ttt + 3.0f * tt;
+        float h3 = ttt - 2.0f * tt + t;
+        float h4 = ttt - tt;
+
+        const float* t1 = &splineTangentFloats_[(index - 1) * numFloats_];
+        const float* t2 = t1 + numFloats_;
+
+        for (unsigned i = 0; i < numFloats_; ++i)
+            dest[i] = value1[i] * h1 + value2[i] * h2 + t1[i] * h3 + t2[i] * h4;
+    }
+
+    return true;
+}
+
 void ValueAnimation::GetEventFrames(float beginTime, float endTime, PODVector<const VAnimEventFrame*>& eventFrames) const
 {
     for (unsigned i = 0; i < eventFrames_.Size(); ++i)
@@ -510,6 +644,50 @@ void ValueAnimation::UpdateSplineTangents() const
     splineTangentsDirty_ = false;
 }
 
+void ValueAnimation::UpdateFloats() const
+{
+    unsigned size = keyFrames_.Size();
+    keyFrameTimes_.Resize(size);
+    keyFrameFloats_.Resize(size * numFloats_);
+    splineTangentFloats_.Clear();
+
+    for (unsigned i = 0; i < size; ++i)
+    {
+        keyFrameTimes_[i] = keyFrames_[i].time_;
+        CopyValueFloats(keyFrames_[i].value_, &keyFrameFloats_[i * numFloats_]);
+    }
+
+    // Calculate the spline tangents the same way as UpdateSplineTangents()
+    if (interpolationMethod_ == IM_SPLINE && IsValid())
+    {
+        splineTangentFloats_.Resize(size * numFloats_);
+        const float* values = &keyFrameFloats_[0];
+        float* tangents = &splineTangentFloats_[0];
+
+        for (unsigned i = 1; i < size - 1; ++i)
+        {
+            for (unsigned j = 0; j < numFloats_; ++j)
+                tangents[i * numFloats_ + j] = (values[(i + 1) * numFloats_ + j] - values[(i - 1) * numFloats_ + j]) * splineTension_;
+        }
+
+        bool closed = true;
+        for (unsigned j = 0; j < numFloats_; ++j)
+        {
+            if (values[j] != values[(size - 1) * numFloats_ + j])
+                closed = false;
+        }
+
+        // If spline is not closed, make end point's tangent zero
+        for (unsigned j = 0; j < numFloats_; ++j)
+        {
+            tangents[j] = tangents[(size - 1) * numFloats_ + j] = closed ?
+                (values[numFloats_ + j] - values[(size - 2) * numFloats_ + j]) * splineTension_ : 0.0f;
+        }
+    }
+
+    floatsDirty_ = false;
+}
+
 Variant ValueAnimation::SubstractAndMultiply(const Variant& value1, const Variant& value2, float t) const
 {
     switch (valueType_)
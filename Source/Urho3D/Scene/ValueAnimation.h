@@ -31,6 +31,9 @@ namespace Urho3D
 class XMLElement;
 class JSONValue;
 
+/// Maximum number of float components in a value evaluated without Variants.
+static const unsigned MAX_ANIMATION_FLOATS = 4;
+
 /// Interpolation method.
 enum InterpMethod
 {
@@ -125,6 +128,11 @@ public:
 
     /// Return animation value.
     Variant GetAnimationValue(float scaledTime) const;
+    /// Write animation value as float components without a Variant, in the memory order of the value type. Return false without writing if the value type does not consist of floats.
+    bool GetAnimationFloats(float scaledTime, float* dest) const;
+
+    /// Return number of float components of the value type, or 0 if it does not consist of floats.
+    unsigned GetNumFloats() const { return numFloats_; }
 
     /// Return all key frames.
     const Vector<VAnimKeyFrame>& GetKeyFrames() const { return keyFrames_; }
@@ -142,6 +150,8 @@ protected:
     Variant SplineInterpolation(unsigned index1, unsigned index2, float scaledTime) const;
     /// Update spline tangents.
     void UpdateSplineTangents() const;
+    /// Update the key frame times, values and spline tangents as float components.
+    void UpdateFloats() const;
     /// Return (value1 - value2) * t.
     Variant SubstractAndMultiply(const Variant& value1, const Variant& value2, float t) const;
 
@@ -155,6 +165,8 @@ protected:
     VariantType valueType_;
     /// Interpolatable flag.
     bool interpolatable_;
+    /// Number of float components of the value type.
+    unsigned numFloats_;
     /// Begin time.
     float beginTime_;
     /// End time.
@@ -165,6 +177,14 @@ protected:
     mutable VariantVector splineTangents_;
     /// Spline tangents dirty.
     mutable bool splineTangentsDirty_;
+    /// Key frame times.
+    mutable PODVector<float> keyFrameTimes_;
+    /// Key frame values as float components.
+    mutable PODVector<float> keyFrameFloats_;
+    /// Spline tangents as float components.
+    mutable PODVector<float> splineTangentFloats_;
+    /// Float components dirty.
+    mutable bool floatsDirty_;
     /// Event frames.
     Vector<VAnimEventFrame> eventFrames_;
 };
@@ -88,7 +88,7 @@ bool ValueAnimationInfo::SetTime(float time)
     float scaledTime = CalculateScaledTime(currentTime_, finished);
 
     // Apply to the target object
-    ApplyValue(animation_->GetAnimationValue(scaledTime));
+    ApplyAnimationValue(scaledTime);
 
     // Send keyframe event if necessary
     if (animation_->HasEventFrames())
@@ -121,6 +121,11 @@ Object* ValueAnimationInfo::GetTarget() const
     return target_;
 }
 
+void ValueAnimationInfo::ApplyAnimationValue(float scaledTime)
+{
+    ApplyValue(animation_->GetAnimationValue(scaledTime));
+}
+
 void ValueAnimationInfo::ApplyValue(const Variant& newValue)
 {
 }
@@ -75,7 +75,9 @@ public:
     float GetSpeed() const { return speed_; }
 
 protected:
-    /// Apply new animation value to the target object. Called by Update().
+    /// Evaluate the animation at a scaled time and apply to the target object. Called by Update().
+    virtual void ApplyAnimationValue(float scaledTime);
+    /// Apply new animation value to the target object. Called by ApplyAnimationValue().
     virtual void ApplyValue(const Variant& newValue);
     /// Calculate scaled time.
     float CalculateScaledTime(float currentTime, bool& finished) const;
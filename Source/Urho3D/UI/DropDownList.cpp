@@ -341,6 +341,8 @@ void DropDownList::HandleSelectionChanged(StringHash eventType, VariantMap& even
 {
     // Display the place holder text when there is no selection, however, the place holder text is only visible when the place holder itself is set to visible
     placeholder_->GetChild(0)->SetVisible(GetSelection() == M_MAX_UNSIGNED);
+    // The selected item is drawn on the placeholder, so the cached batches change even when the placeholder text does not
+    MarkBatchesDirty();
 }
 
 }
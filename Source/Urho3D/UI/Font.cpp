@@ -30,6 +30,8 @@
 #include "../UI/Font.h"
 #include "../UI/FontFaceBitmap.h"
 #include "../UI/FontFaceFreeType.h"
+#include "../UI/FontGlyphAtlas.h"
+#include "../UI/UI.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/XMLFile.h"
@@ -57,7 +59,9 @@ Font::Font(Context* context) :
     absoluteOffset_(IntVector2::ZERO),
     scaledOffset_(Vector2::ZERO),
     fontType_(FONT_NONE),
-    sdfFont_(false)
+    sdfFont_(false),
+    sdfPointSize_(0.0f),
+    sdfSpread_(4)
 {
 }
 
@@ -136,6 +140,26 @@ void Font::SetScaledGlyphOffset(const Vector2& offset)
     scaledOffset_ = offset;
 }
 
+void Font::SetSDFPointSize(float pointSize)
+{
+    pointSize = pointSize > 0.0f ? Clamp(pointSize, MIN_POINT_SIZE, MAX_POINT_SIZE) : 0.0f;
+    if (pointSize != sdfPointSize_)
+    {
+        sdfPointSize_ = pointSize;
+        ReleaseFaces();
+    }
+}
+
+void Font::SetSDFSpread(int spread)
+{
+    spread = Max(spread, 1);
+    if (spread != sdfSpread_)
+    {
+        sdfSpread_ = spread;
+        ReleaseFaces();
+    }
+}
+
 FontFace* Font::GetFace(float pointSize)
 {
     // In headless mode, always return null
@@ -146,6 +170,9 @@ FontFace* Font::GetFace(float pointSize)
     // For bitmap font type, always return the same font face provided by the font's bitmap file regardless of the actual requested point size
     if (fontType_ == FONT_BITMAP)
         pointSize = 0;
+    // Likewise for generated signed distance field glyphs, which are scaled at rendering
+    else if (sdfPointSize_ > 0.0f)
+        pointSize = sdfPointSize_;
     else
         pointSize = Clamp(pointSize, MIN_POINT_SIZE, MAX_POINT_SIZE);
 
@@ -187,6 +214,18 @@ IntVector2 Font::GetTotalGlyphOffset(float pointSize) const
 void Font::ReleaseFaces()
 {
     faces_.Clear();
+    glyphAtlas_.Reset();
+}
+
+FontGlyphAtlas* Font::GetGlyphAtlas()
+{
+    // When the atlas textures are lost, the faces using them are recreated, and the new faces use a new atlas
+    if (!glyphAtlas_ || glyphAtlas_->IsDataLost())
+    {
+        auto* ui = GetSubsystem<UI>();
+        glyphAtlas_ = new FontGlyphAtlas(this, ui->GetMaxFontTextureSize(), ui->GetMaxFontTextures());
+    }
+    return glyphAtlas_;
 }
 
 void Font::LoadParameters()
@@ -218,6 +257,14 @@ void Font::LoadParameters()
         scaledOffset_.x_ = scaledElem.GetFloat("x");
         scaledOffset_.y_ = scaledElem.GetFloat("y");
     }
+
+    XMLElement sdfElem = rootElem.GetChild("sdf");
+    if (sdfElem)
+    {
+        if (sdfElem.HasAttribute("spread"))
+            sdfSpread_ = Max(sdfElem.GetInt("spread"), 1);
+        sdfPointSize_ = Clamp(sdfElem.GetFloat("pointsize"), MIN_POINT_SIZE, MAX_POINT_SIZE);
+    }
 }
 
 FontFace* Font::GetFaceFreeType(float pointSize)
@@ -29,6 +29,7 @@ namespace Urho3D
 {
 
 class FontFace;
+class FontGlyphAtlas;
 
 static const int FONT_TEXTURE_MIN_SIZE = 128;
 static const int FONT_DPI = 96;
@@ -63,6 +64,10 @@ public:
     void SetAbsoluteGlyphOffset(const IntVector2& offset);
     /// Set point size scaled position adjustment for glyphs.
     void SetScaledGlyphOffset(const Vector2& offset);
+    /// Set point size at which signed distance field glyphs are generated from a FreeType font, or 0 to disable (default). When enabled, the font is an SDF font and all requested sizes use the face of this size.
+    void SetSDFPointSize(float pointSize);
+    /// Set spread in pixels of the generated signed distance field glyphs. Default 4.
+    void SetSDFSpread(int spread);
 
     /// Return font face. Pack and render to a texture if not rendered yet. Return null on error.
     FontFace* GetFace(float pointSize);
@@ -71,7 +76,16 @@ public:
     FontType GetFontType() const { return fontType_; }
 
     /// Is signed distance field font.
-    bool IsSDFFont() const { return sdfFont_; }
+    bool IsSDFFont() const { return sdfFont_ || (fontType_ == FONT_FREETYPE && sdfPointSize_ > 0.0f); }
+
+    /// Return point size of generated signed distance field glyphs, or 0 if not generated.
+    float GetSDFPointSize() const { return sdfPointSize_; }
+
+    /// Return spread of generated signed distance field glyphs.
+    int GetSDFSpread() const { return sdfSpread_; }
+
+    /// Return the glyph atlas shared by the faces with mutable glyphs. Create if not created yet or if the texture data was lost.
+    FontGlyphAtlas* GetGlyphAtlas();
 
     /// Return absolute position adjustment for glyphs.
     const IntVector2& GetAbsoluteGlyphOffset() const { return absoluteOffset_; }
@@ -107,6 +121,12 @@ private:
     FontType fontType_;
     /// Signed distance field font flag.
     bool sdfFont_;
+    /// Point size of generated signed distance field glyphs.
+    float sdfPointSize_;
+    /// Spread of generated signed distance field glyphs.
+    int sdfSpread_;
+    /// Glyph atlas shared by the faces with mutable glyphs.
+    SharedPtr<FontGlyphAtlas> glyphAtlas_;
 };
 
 }
@@ -90,6 +90,13 @@ public:
     /// Return row height.
     float GetRowHeight() const { return rowHeight_; }
 
+    /// Take glyphs rasterized in the background into use. Must be called from the main thread.
+    virtual void UpdateQueuedGlyphs() { }
+    /// Return whether glyphs are waiting for background rasterization.
+    virtual bool HasQueuedGlyphs() const { return false; }
+    /// Return revision, incremented when already returned glyphs change, for example after background rasterization or texture eviction.
+    unsigned GetRevision() const { return revision_; }
+
     /// Return textures.
     const Vector<SharedPtr<Texture2D> >& GetTextures() const { return textures_; }
 
@@ -112,6 +119,8 @@ protected:
     float pointSize_{};
     /// Row height.
     float rowHeight_{};
+    /// Glyph revision.
+    unsigned revision_{};
 };
 
 }
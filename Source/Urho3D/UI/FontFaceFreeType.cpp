@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Texture2D.h"
 #include "../IO/FileSystem.h"
@@ -30,6 +32,7 @@
 #include "../IO/MemoryBuffer.h"
 #include "../UI/Font.h"
 #include "../UI/FontFaceFreeType.h"
+#include "../UI/FontGlyphAtlas.h"
 #include "../UI/UI.h"
 
 #include <cassert>
@@ -48,6 +51,12 @@ inline float FixedToFloat(FT_Pos value)
     return value / 64.0f;
 }
 
+static void RasterizeGlyphsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* face = reinterpret_cast<FontFaceFreeType*>(item->aux_);
+    face->RasterizeQueuedGlyphs();
+}
+
 /// FreeType library subsystem.
 class FreeTypeLibrary : public Object
 {
@@ -84,6 +93,24 @@ FontFaceFreeType::FontFaceFreeType(Font* font) :
 
 FontFaceFreeType::~FontFaceFreeType()
 {
+    // The background rasterization uses the FreeType face, so it must finish first
+    if (rasterizeItem_)
+    {
+        auto* queue = font_->GetSubsystem<WorkQueue>();
+        if (!(queue && queue->RemoveWorkItem(rasterizeItem_)))
+        {
+            while (!rasterizeItem_->completed_)
+                Time::Sleep(0);
+        }
+    }
+
+    if (atlas_)
+    {
+        atlas_->RemoveFace(this);
+        // The textures belong to the atlas, which deducts their memory use
+        textures_.Clear();
+    }
+
     if (face_)
     {
         FT_Done_Face((FT_Face)face_);
@@ -108,7 +135,9 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
     const FontHintLevel hintLevel = ui->GetFontHintLevel();
     const float subpixelThreshold = ui->GetFontSubpixelThreshold();
 
-    subpixel_ = (hintLevel <= FONT_HINT_LEVEL_LIGHT) && (pointSize <= subpixelThreshold);
+    // Distance fields are generated from pixel-aligned glyphs
+    sdfSpread_ = font_->GetSDFPointSize() > 0.0f ? font_->GetSDFSpread() : 0;
+    subpixel_ = !sdfSpread_ && (hintLevel <= FONT_HINT_LEVEL_LIGHT) && (pointSize <= subpixelThreshold);
     oversampling_ = subpixel_ ? ui->GetFontOversampling() : 1;
 
     FT_Face face;
@@ -180,6 +209,7 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
     ascender_ = FixedToFloat(face->size->metrics.ascender);
     rowHeight_ = FixedToFloat(face->size->metrics.height);
     pointSize_ = pointSize;
+    emWidth_ = (float)face->size->metrics.x_ppem / oversampling_;
 
     // Check if the font's OS/2 info gives different (larger) values for ascender & descender
     auto* os2Info = (TT_OS2*)FT_Get_Sfnt_Table(face, ft_sfnt_os2);
@@ -194,35 +224,47 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
         rowHeight_ = Max(rowHeight_, ascender_ + descender);
     }
 
-    int textureWidth = maxTextureSize;
-    int textureHeight = maxTextureSize;
-    hasMutableGlyph_ = false;
-
-    SharedPtr<Image> image(new Image(font_->GetContext()));
-    image->SetSize(textureWidth, textureHeight, 1);
-    unsigned char* imageData = image->GetData();
-    memset(imageData, 0, (size_t)image->GetWidth() * image->GetHeight());
-    allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
-
-    for (unsigned i = 0; i < charCodes.Size(); ++i)
+    if (ui->GetUseMutableGlyphs())
+    {
+        // Rasterize glyphs only when first used, into the atlas shared by all sizes of the font
+        atlas_ = font_->GetGlyphAtlas();
+        atlas_->AddFace(this);
+        textures_ = atlas_->GetTextures();
+        hasMutableGlyph_ = true;
+        asyncRasterization_ = ui->GetFontAsyncRasterization() && font_->GetSubsystem<WorkQueue>();
+    }
+    else
     {
-        unsigned charCode = charCodes[i];
-        if (charCode == 0)
-            continue;
+        int textureWidth = maxTextureSize;
+        int textureHeight = maxTextureSize;
+        hasMutableGlyph_ = false;
+
+        SharedPtr<Image> image(new Image(font_->GetContext()));
+        image->SetSize(textureWidth, textureHeight, 1);
+        unsigned char* imageData = image->GetData();
+        memset(imageData, 0, (size_t)image->GetWidth() * image->GetHeight());
+        allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
 
-        if (!LoadCharGlyph(charCode, image))
+        for (unsigned i = 0; i < charCodes.Size(); ++i)
         {
-            hasMutableGlyph_ = true;
-            break;
+            unsigned charCode = charCodes[i];
+            if (charCode == 0)
+                continue;
+
+            if (!LoadCharGlyph(charCode, image))
+            {
+                hasMutableGlyph_ = true;
+                break;
+            }
         }
-    }
 
-    SharedPtr<Texture2D> texture = LoadFaceTexture(image);
-    if (!texture)
-        return false;
+        SharedPtr<Texture2D> texture = LoadFaceTexture(image);
+        if (!texture)
+            return false;
 
-    textures_.Push(texture);
-    font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
+        textures_.Push(texture);
+        font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
+    }
 
     // Store kerning if face has kerning information
     if (FT_HAS_KERNING(face))
@@ -307,26 +349,66 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
 
 const FontGlyph* FontFaceFreeType::GetGlyph(unsigned c)
 {
+    if (asyncRasterization_)
+        UpdateQueuedGlyphs();
+
     HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
-    if (i != glyphMapping_.End())
+    // Glyphs on a cleared atlas texture are not resident and must be rasterized again
+    if (i == glyphMapping_.End() || i->second_.page_ == M_MAX_UNSIGNED)
+    {
+        if (asyncRasterization_)
+            QueueGlyph(c);
+        else if (!LoadCharGlyph(c))
+            return nullptr;
+
+        i = glyphMapping_.Find(c);
+        if (i == glyphMapping_.End())
+            return nullptr;
+    }
+
+    FontGlyph& glyph = i->second_;
+    glyph.used_ = true;
+    if (atlas_ && glyph.page_ != M_MAX_UNSIGNED)
+        atlas_->MarkUsed(glyph.page_);
+    return &glyph;
+}
+
+void FontFaceFreeType::OnAtlasPageCleared(unsigned page)
+{
+    for (HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Begin(); i != glyphMapping_.End(); ++i)
     {
         FontGlyph& glyph = i->second_;
-        glyph.used_ = true;
-        return &glyph;
+        if (glyph.page_ == page && glyph.texWidth_ > 0 && glyph.texHeight_ > 0)
+            glyph.page_ = M_MAX_UNSIGNED;
     }
+    ++revision_;
+}
+
+void FontFaceFreeType::RasterizeQueuedGlyphs()
+{
+    PODVector<unsigned> charCodes;
+    RasterizedGlyph rasterized;
 
-    if (LoadCharGlyph(c))
+    // Keep taking the glyphs queued while rasterizing, so that a text's glyphs are not split into several work items
+    for (;;)
     {
-        HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
-        if (i != glyphMapping_.End())
         {
-            FontGlyph& glyph = i->second_;
-            glyph.used_ = true;
-            return &glyph;
+            MutexLock lock(rasterizeMutex_);
+            charCodes.Clear();
+            charCodes.Swap(rasterizeQueue_);
         }
-    }
+        if (charCodes.Empty())
+            break;
 
-    return nullptr;
+        for (unsigned i = 0; i < charCodes.Size(); ++i)
+        {
+            rasterized.charCode_ = charCodes[i];
+            RasterizeGlyph(rasterized.charCode_, rasterized.glyph_, rasterized.data_);
+
+            MutexLock lock(rasterizeMutex_);
+            rasterizedGlyphs_.Push(rasterized);
+        }
+    }
 }
 
 bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
@@ -348,7 +430,7 @@ bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
     return true;
 }
 
-void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize)
+void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize) const
 {
     const int filterSize = oversampling_;
 
@@ -412,10 +494,16 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
     if (!face_)
         return false;
 
+    FontGlyph fontGlyph;
+    RasterizeGlyph(charCode, fontGlyph, glyphData_);
+    return PlaceGlyph(charCode, fontGlyph, glyphData_, image);
+}
+
+void FontFaceFreeType::RasterizeGlyph(unsigned charCode, FontGlyph& fontGlyph, PODVector<unsigned char>& data) const
+{
     auto face = (FT_Face)face_;
     FT_GlyphSlot slot = face->glyph;
 
-    FontGlyph fontGlyph;
     FT_Error error = FT_Load_Char(face, charCode, loadMode_ | FT_LOAD_RENDER);
     if (error)
     {
@@ -429,103 +517,198 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
         fontGlyph.offsetY_ = 0;
         fontGlyph.advanceX_ = 0;
         fontGlyph.page_ = 0;
+        data.Clear();
+        return;
+    }
+
+    // Note: position within texture will be filled later
+    fontGlyph.texWidth_ = slot->bitmap.width + oversampling_ - 1;
+    fontGlyph.texHeight_ = slot->bitmap.rows;
+    fontGlyph.width_ = slot->bitmap.width + oversampling_ - 1;
+    fontGlyph.height_ = slot->bitmap.rows;
+    fontGlyph.offsetX_ = slot->bitmap_left - (oversampling_ - 1) / 2.0f;
+    fontGlyph.offsetY_ = floorf(ascender_ + 0.5f) - slot->bitmap_top;
+
+    if (subpixel_ && slot->linearHoriAdvance)
+    {
+        // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
+        fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
+    }
+    else
+    {
+        // Round to nearest pixel (only necessary when hinting is disabled)
+        fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
+    }
+
+    fontGlyph.width_ /= oversampling_;
+    fontGlyph.offsetX_ /= oversampling_;
+    fontGlyph.advanceX_ /= oversampling_;
+
+    if (fontGlyph.texWidth_ <= 0 || fontGlyph.texHeight_ <= 0)
+    {
+        data.Clear();
+        return;
+    }
+
+    // The distance field extends outside the glyph outline by the spread
+    if (sdfSpread_)
+    {
+        fontGlyph.texWidth_ += 2 * sdfSpread_;
+        fontGlyph.texHeight_ += 2 * sdfSpread_;
+        fontGlyph.width_ += 2 * sdfSpread_;
+        fontGlyph.height_ += 2 * sdfSpread_;
+        fontGlyph.offsetX_ -= sdfSpread_;
+        fontGlyph.offsetY_ -= sdfSpread_;
+    }
+
+    unsigned width = slot->bitmap.width + oversampling_ - 1;
+    unsigned height = slot->bitmap.rows;
+    PODVector<unsigned char> coverage;
+    unsigned char* dest;
+    if (sdfSpread_)
+    {
+        coverage.Resize(width * height);
+        dest = coverage.Buffer();
     }
     else
     {
-        // Note: position within texture will be filled later
-        fontGlyph.texWidth_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.texHeight_ = slot->bitmap.rows;
-        fontGlyph.width_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.height_ = slot->bitmap.rows;
-        fontGlyph.offsetX_ = slot->bitmap_left - (oversampling_ - 1) / 2.0f;
-        fontGlyph.offsetY_ = floorf(ascender_ + 0.5f) - slot->bitmap_top;
+        data.Resize(width * height);
+        dest = data.Buffer();
+    }
+    memset(dest, 0, width * height);
 
-        if (subpixel_ && slot->linearHoriAdvance)
+    if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+    {
+        for (unsigned y = 0; y < height; ++y)
         {
-            // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
-            fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + (oversampling_ - 1)/2 + y * width;
+
+            // Don't do any oversampling, just unpack the bits directly.
+            for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
+                rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
         }
-        else
+    }
+    else
+    {
+        for (unsigned y = 0; y < height; ++y)
         {
-            // Round to nearest pixel (only necessary when hinting is disabled)
-            fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + y * width;
+            BoxFilter(rowDest, width, src, slot->bitmap.width);
         }
+    }
 
-        fontGlyph.width_ /= oversampling_;
-        fontGlyph.offsetX_ /= oversampling_;
-        fontGlyph.advanceX_ /= oversampling_;
+    if (sdfSpread_)
+    {
+        data.Resize((unsigned)(fontGlyph.texWidth_ * fontGlyph.texHeight_));
+        GenerateDistanceField(data.Buffer(), coverage.Buffer(), width, height);
     }
+}
 
-    int x = 0, y = 0;
-    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
+void FontFaceFreeType::GenerateDistanceField(unsigned char* dest, const unsigned char* src, int width, int height) const
+{
+    const int spread = sdfSpread_;
+    const int destWidth = width + 2 * spread;
+    const int destHeight = height + 2 * spread;
+
+    // For each pixel, search the nearest pixel on the other side of the outline within the spread. The distance is 0.5 at
+    // the outline, to match the signed distance field text shader
+    for (int y = 0; y < destHeight; ++y)
     {
-        if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
+        for (int x = 0; x < destWidth; ++x)
         {
-            if (image)
+            int srcX = x - spread;
+            int srcY = y - spread;
+            bool inside = srcX >= 0 && srcY >= 0 && srcX < width && srcY < height && src[srcY * width + srcX] >= 128;
+            int minDistSquared = (spread + 1) * (spread + 1);
+
+            for (int dy = -spread; dy <= spread; ++dy)
             {
-                // We're rendering into a fixed image and we ran out of room.
-                return false;
+                int sy = srcY + dy;
+                for (int dx = -spread; dx <= spread; ++dx)
+                {
+                    int sx = srcX + dx;
+                    bool otherInside = sx >= 0 && sy >= 0 && sx < width && sy < height && src[sy * width + sx] >= 128;
+                    if (otherInside != inside)
+                        minDistSquared = Min(minDistSquared, dx * dx + dy * dy);
+                }
             }
 
-            int w = allocator_.GetWidth();
-            int h = allocator_.GetHeight();
-            if (!SetupNextTexture(w, h))
+            float distance = Min(Sqrt((float)minDistSquared) - 0.5f, (float)spread);
+            float value = 0.5f + (inside ? distance : -distance) / (2.0f * spread);
+            dest[y * destWidth + x] = (unsigned char)(Clamp(value, 0.0f, 1.0f) * 255.0f);
+        }
+    }
+}
+
+bool FontFaceFreeType::PlaceGlyph(unsigned charCode, FontGlyph& fontGlyph, const PODVector<unsigned char>& data, Image* image)
+{
+    int x = 0, y = 0;
+    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0 && !data.Empty())
+    {
+        if (atlas_)
+        {
+            unsigned page = 0;
+            if (atlas_->Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, page, x, y))
             {
-                URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to allocate new %dx%d texture", w, h);
-                return false;
+                textures_ = atlas_->GetTextures();
+                textures_[page]->SetData(0, x, y, fontGlyph.texWidth_, fontGlyph.texHeight_, data.Buffer());
             }
-
-            if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
+            else
             {
-                URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to position char code %u in blank page", charCode);
-                return false;
+                // Store as an empty glyph, so that it is not rasterized again on each use
+                URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: char code %u does not fit in the glyph atlas", charCode);
+                fontGlyph.texWidth_ = 0;
+                fontGlyph.texHeight_ = 0;
             }
-        }
 
-        fontGlyph.x_ = (short)x;
-        fontGlyph.y_ = (short)y;
-
-        unsigned char* dest = nullptr;
-        unsigned pitch = 0;
-        if (image)
-        {
-            fontGlyph.page_ = 0;
-            dest = image->GetData() + fontGlyph.y_ * image->GetWidth() + fontGlyph.x_;
-            pitch = (unsigned)image->GetWidth();
+            fontGlyph.x_ = (short)x;
+            fontGlyph.y_ = (short)y;
+            fontGlyph.page_ = page;
         }
         else
         {
-            fontGlyph.page_ = textures_.Size() - 1;
-            dest = new unsigned char[fontGlyph.texWidth_ * fontGlyph.texHeight_];
-            pitch = (unsigned)fontGlyph.texWidth_;
-        }
-
-        if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
-        {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
+            if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
             {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + (oversampling_ - 1)/2 + y * pitch;
+                if (image)
+                {
+                    // We're rendering into a fixed image and we ran out of room.
+                    return false;
+                }
 
-                // Don't do any oversampling, just unpack the bits directly.
-                for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
-                    rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
+                int w = allocator_.GetWidth();
+                int h = allocator_.GetHeight();
+                if (!SetupNextTexture(w, h))
+                {
+                    URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to allocate new %dx%d texture", w, h);
+                    return false;
+                }
+
+                if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
+                {
+                    URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to position char code %u in blank page", charCode);
+                    return false;
+                }
             }
-        }
-        else
-        {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
+
+            fontGlyph.x_ = (short)x;
+            fontGlyph.y_ = (short)y;
+
+            if (image)
             {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + y * pitch;
-                BoxFilter(rowDest, fontGlyph.texWidth_, src, slot->bitmap.width);
+                fontGlyph.page_ = 0;
+                for (int row = 0; row < fontGlyph.texHeight_; ++row)
+                {
+                    memcpy(image->GetData() + (fontGlyph.y_ + row) * image->GetWidth() + fontGlyph.x_,
+                        data.Buffer() + row * fontGlyph.texWidth_, (size_t)fontGlyph.texWidth_);
+                }
+            }
+            else
+            {
+                fontGlyph.page_ = textures_.Size() - 1;
+                textures_.Back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.texWidth_, fontGlyph.texHeight_, data.Buffer());
             }
-        }
-
-        if (!image)
-        {
-            textures_.Back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.texWidth_, fontGlyph.texHeight_, dest);
-            delete[] dest;
         }
     }
     else
@@ -535,9 +718,84 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
         fontGlyph.page_ = 0;
     }
 
-    glyphMapping_[charCode] = fontGlyph;
+    // Text that already uses the glyph must re-evaluate it
+    HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(charCode);
+    if (i != glyphMapping_.End())
+    {
+        i->second_ = fontGlyph;
+        ++revision_;
+    }
+    else
+        glyphMapping_[charCode] = fontGlyph;
 
     return true;
 }
 
+void FontFaceFreeType::QueueGlyph(unsigned charCode)
+{
+    if (pendingGlyphs_.Contains(charCode))
+        return;
+
+    // Reserve the glyph with an estimated advance. Glyphs rasterized before and evicted from the atlas keep their metrics
+    if (!glyphMapping_.Contains(charCode))
+    {
+        FontGlyph placeholder;
+        placeholder.advanceX_ = charCode >= 0x1100 ? emWidth_ : 0.5f * emWidth_;
+        glyphMapping_[charCode] = placeholder;
+    }
+
+    pendingGlyphs_.Insert(charCode);
+    {
+        MutexLock lock(rasterizeMutex_);
+        rasterizeQueue_.Push(charCode);
+    }
+
+    if (!rasterizeItem_)
+        StartRasterization();
+}
+
+void FontFaceFreeType::StartRasterization()
+{
+    auto* queue = font_->GetSubsystem<WorkQueue>();
+    SharedPtr<WorkItem> item = queue->GetFreeItem();
+    item->priority_ = 0;
+    item->workClass_ = WORK_BACKGROUND;
+    item->workFunction_ = RasterizeGlyphsWork;
+    item->name_ = "RasterizeGlyphsWork";
+    item->aux_ = this;
+    rasterizeItem_ = item;
+    queue->AddWorkItem(item);
+}
+
+void FontFaceFreeType::UpdateQueuedGlyphs()
+{
+    if (!rasterizeItem_)
+        return;
+
+    // Check for completion before taking the results, so that a completed work item's results are all taken
+    bool completed = rasterizeItem_->completed_;
+    bool queued;
+    Vector<RasterizedGlyph> rasterized;
+    {
+        MutexLock lock(rasterizeMutex_);
+        rasterized.Swap(rasterizedGlyphs_);
+        queued = !rasterizeQueue_.Empty();
+    }
+
+    for (unsigned i = 0; i < rasterized.Size(); ++i)
+    {
+        RasterizedGlyph& glyph = rasterized[i];
+        pendingGlyphs_.Erase(glyph.charCode_);
+        PlaceGlyph(glyph.charCode_, glyph.glyph_, glyph.data_, nullptr);
+    }
+
+    if (completed)
+    {
+        rasterizeItem_.Reset();
+        // Glyphs queued after the work item checked the queue for the last time need a new work item
+        if (queued)
+            StartRasterization();
+    }
+}
+
 }
@@ -22,13 +22,17 @@
 
 #pragma once
 
+#include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../UI/FontFace.h"
 
 namespace Urho3D
 {
 
+class FontGlyphAtlas;
 class FreeTypeLibrary;
 class Texture2D;
+struct WorkItem;
 
 /// Free type font face description.
 class URHO3D_API FontFaceFreeType : public FontFace
@@ -46,14 +50,44 @@ public:
 
     /// Return if font face uses mutable glyphs.
     bool HasMutableGlyphs() const override { return hasMutableGlyph_; }
+    /// Take background rasterized glyphs into use, and restart the background rasterization if glyphs were queued after it finished.
+    void UpdateQueuedGlyphs() override;
+    /// Return whether glyphs are waiting for background rasterization.
+    bool HasQueuedGlyphs() const override { return !pendingGlyphs_.Empty(); }
+
+    /// Handle a glyph atlas texture being cleared. Called by FontGlyphAtlas.
+    void OnAtlasPageCleared(unsigned page);
+    /// Rasterize the glyphs queued for background rasterization. Called from a worker thread.
+    void RasterizeQueuedGlyphs();
 
 private:
+    /// Glyph rasterized in the background.
+    struct RasterizedGlyph
+    {
+        /// Character code.
+        unsigned charCode_;
+        /// Glyph metrics.
+        FontGlyph glyph_;
+        /// Glyph image.
+        PODVector<unsigned char> data_;
+    };
+
     /// Setup next texture.
     bool SetupNextTexture(int textureWidth, int textureHeight);
     /// Load char glyph.
     bool LoadCharGlyph(unsigned charCode, Image* image = nullptr);
+    /// Rasterize a glyph to an image of the glyph's texture size. Does not modify the face's glyphs, so can be called from a worker thread.
+    void RasterizeGlyph(unsigned charCode, FontGlyph& fontGlyph, PODVector<unsigned char>& data) const;
+    /// Convert a glyph coverage image to a signed distance field with the spread as padding.
+    void GenerateDistanceField(unsigned char* dest, const unsigned char* src, int width, int height) const;
+    /// Position a rasterized glyph in a texture and store it. Return false if there was no room.
+    bool PlaceGlyph(unsigned charCode, FontGlyph& fontGlyph, const PODVector<unsigned char>& data, Image* image);
+    /// Queue a glyph for background rasterization. Until finished, an empty glyph with an estimated advance is returned.
+    void QueueGlyph(unsigned charCode);
+    /// Start a work item for the background rasterization.
+    void StartRasterization();
     /// Smooth one row of a horizontally oversampled glyph image.
-    void BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize);
+    void BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize) const;
 
     /// FreeType library.
     SharedPtr<FreeTypeLibrary> freeType_;
@@ -71,6 +105,26 @@ private:
     bool hasMutableGlyph_{};
     /// Glyph area allocator.
     AreaAllocator allocator_;
+    /// Shared glyph atlas of the font. Used instead of own textures with mutable glyphs.
+    SharedPtr<FontGlyphAtlas> atlas_;
+    /// Signed distance field spread in pixels, or 0 if not generating a distance field.
+    int sdfSpread_{};
+    /// Em width in pixels, used for the advance of glyphs that are not rasterized yet.
+    float emWidth_{};
+    /// Rasterize glyphs in the background flag.
+    bool asyncRasterization_{};
+    /// Character codes queued or being rasterized in the background.
+    HashSet<unsigned> pendingGlyphs_;
+    /// Character codes waiting for the background rasterization. Protected by the mutex.
+    PODVector<unsigned> rasterizeQueue_;
+    /// Background rasterized glyphs waiting to be placed in the atlas. Protected by the mutex.
+    Vector<RasterizedGlyph> rasterizedGlyphs_;
+    /// Background rasterization work item.
+    SharedPtr<WorkItem> rasterizeItem_;
+    /// Mutex for the background rasterization.
+    Mutex rasterizeMutex_;
+    /// Glyph image buffer for rasterizing in the main thread.
+    PODVector<unsigned char> glyphData_;
 };
 
 }
@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Texture2D.h"
+#include "../IO/Log.h"
+#include "../UI/Font.h"
+#include "../UI/FontFaceFreeType.h"
+#include "../UI/FontGlyphAtlas.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+FontGlyphAtlas::FontGlyphAtlas(Font* font, int textureSize, unsigned maxTextures) :
+    font_(font),
+    textureSize_(textureSize),
+    maxTextures_(Max(maxTextures, 1U)),
+    useCounter_(0)
+{
+}
+
+FontGlyphAtlas::~FontGlyphAtlas()
+{
+    font_->SetMemoryUse(font_->GetMemoryUse() - textures_.Size() * textureSize_ * textureSize_);
+}
+
+void FontGlyphAtlas::AddFace(FontFaceFreeType* face)
+{
+    faces_.Push(face);
+}
+
+void FontGlyphAtlas::RemoveFace(FontFaceFreeType* face)
+{
+    faces_.Remove(face);
+}
+
+bool FontGlyphAtlas::Allocate(int width, int height, unsigned& page, int& x, int& y)
+{
+    if (width > textureSize_ || height > textureSize_)
+        return false;
+
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        if (pages_[i].allocator_.Allocate(width, height, x, y))
+        {
+            page = i;
+            MarkUsed(page);
+            return true;
+        }
+    }
+
+    // When all textures are in use, reuse the least recently used one
+    if (pages_.Size() < maxTextures_ && AddPage())
+        page = pages_.Size() - 1;
+    else if (!pages_.Empty())
+    {
+        page = 0;
+        for (unsigned i = 1; i < pages_.Size(); ++i)
+        {
+            if (pages_[i].lastUse_ < pages_[page].lastUse_)
+                page = i;
+        }
+        ClearPage(page);
+
+        // The faces rasterize their glyphs from the cleared texture again when needed
+        for (unsigned i = 0; i < faces_.Size(); ++i)
+            faces_[i]->OnAtlasPageCleared(page);
+    }
+    else
+        return false;
+
+    MarkUsed(page);
+    return pages_[page].allocator_.Allocate(width, height, x, y);
+}
+
+bool FontGlyphAtlas::IsDataLost() const
+{
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        if (textures_[i]->IsDataLost())
+            return true;
+    }
+    return false;
+}
+
+bool FontGlyphAtlas::AddPage()
+{
+    // Use the same settings as the font face textures
+    SharedPtr<Texture2D> texture(new Texture2D(font_->GetContext()));
+    texture->SetMipsToSkip(QUALITY_LOW, 0);
+    texture->SetNumLevels(1);
+    texture->SetAddressMode(COORD_U, ADDRESS_BORDER);
+    texture->SetAddressMode(COORD_V, ADDRESS_BORDER);
+    texture->SetBorderColor(Color(0.0f, 0.0f, 0.0f, 0.0f));
+    if (!texture->SetSize(textureSize_, textureSize_, Graphics::GetAlphaFormat()))
+    {
+        URHO3D_LOGERROR("Could not create font glyph atlas texture");
+        return false;
+    }
+
+    textures_.Push(texture);
+    pages_.Resize(pages_.Size() + 1);
+    ClearPage(pages_.Size() - 1);
+    font_->SetMemoryUse(font_->GetMemoryUse() + textureSize_ * textureSize_);
+    return true;
+}
+
+void FontGlyphAtlas::ClearPage(unsigned page)
+{
+    PODVector<unsigned char> emptyData((unsigned)(textureSize_ * textureSize_));
+    memset(emptyData.Buffer(), 0, emptyData.Size());
+    textures_[page]->SetData(0, 0, 0, textureSize_, textureSize_, emptyData.Buffer());
+    pages_[page].allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureSize_, textureSize_);
+}
+
+}
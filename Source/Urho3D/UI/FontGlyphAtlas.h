@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Container/Ptr.h"
+#include "../Container/Vector.h"
+#include "../Math/AreaAllocator.h"
+
+namespace Urho3D
+{
+
+class Font;
+class FontFaceFreeType;
+class Texture2D;
+
+/// Glyph texture atlas shared by the dynamically rasterized faces of all sizes of a font. When all textures are full, the least recently used texture is cleared and its glyphs are rasterized again when next needed.
+class URHO3D_API FontGlyphAtlas : public RefCounted
+{
+public:
+    /// Construct.
+    FontGlyphAtlas(Font* font, int textureSize, unsigned maxTextures);
+    /// Destruct.
+    ~FontGlyphAtlas() override;
+
+    /// Add a face to be notified of cleared textures.
+    void AddFace(FontFaceFreeType* face);
+    /// Remove a face.
+    void RemoveFace(FontFaceFreeType* face);
+    /// Allocate space for a glyph. Return false if it does not fit even to an empty texture.
+    bool Allocate(int width, int height, unsigned& page, int& x, int& y);
+    /// Mark a texture used.
+    void MarkUsed(unsigned page) { if (page < pages_.Size()) pages_[page].lastUse_ = ++useCounter_; }
+
+    /// Return textures.
+    const Vector<SharedPtr<Texture2D> >& GetTextures() const { return textures_; }
+    /// Return whether one of the textures has lost its data.
+    bool IsDataLost() const;
+
+private:
+    /// Atlas texture page.
+    struct Page
+    {
+        /// Glyph area allocator.
+        AreaAllocator allocator_;
+        /// Value of the use counter when last used.
+        unsigned lastUse_{};
+    };
+
+    /// Add a texture. Return true if successful.
+    bool AddPage();
+    /// Clear a texture and its allocator.
+    void ClearPage(unsigned page);
+
+    /// Parent font.
+    Font* font_;
+    /// Textures.
+    Vector<SharedPtr<Texture2D> > textures_;
+    /// Texture pages.
+    Vector<Page> pages_;
+    /// Faces with glyphs in the atlas.
+    PODVector<FontFaceFreeType*> faces_;
+    /// Texture width and height.
+    int textureSize_;
+    /// Maximum number of textures.
+    unsigned maxTextures_;
+    /// Counter incremented on each use, for finding the least recently used texture.
+    unsigned useCounter_;
+};
+
+}
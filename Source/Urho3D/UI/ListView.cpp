@@ -171,7 +171,12 @@ ListView::ListView(Context* context) :
     hierarchyMode_(true),    // Init to true here so that the setter below takes effect
     baseIndent_(0),
     clearSelectionOnDefocus_(false),
-    selectOnClickEnd_(false)
+    selectOnClickEnd_(false),
+    virtualMode_(false),
+    virtualItemCount_(0),
+    virtualItemHeight_(16),
+    virtualItemType_(Text::GetTypeStatic()),
+    virtualItemsUpdating_(false)
 {
     resizeContentWidth_ = true;
 
@@ -199,6 +204,9 @@ void ListView::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Multiselect", GetMultiselect, SetMultiselect, bool, false, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Hierarchy Mode", GetHierarchyMode, SetHierarchyMode, bool, false, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Base Indent", GetBaseIndent, SetBaseIndent, int, 0, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Virtual Mode", GetVirtualMode, SetVirtualMode, bool, false, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Virtual Item Height", GetVirtualItemHeight, SetVirtualItemHeight, int, 16, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Virtual Item Style", GetVirtualItemStyle, SetVirtualItemStyle, String, String::EMPTY, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Clear Sel. On Defocus", GetClearSelectionOnDefocus, SetClearSelectionOnDefocus, bool, false, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Select On Click End", GetSelectOnClickEnd, SetSelectOnClickEnd, bool, false, AM_FILE);
 }
@@ -260,6 +268,13 @@ void ListView::OnKey(Key key, MouseButtonFlags buttons, QualifierFlags qualifier
                 // Convert page step to pixels and see how many items have to be skipped to reach that many pixels
                 if (selection == M_MAX_UNSIGNED)
                     selection = 0;      // Assume as if first item is selected
+                if (virtualMode_)
+                {
+                    // All rows are visible and of the same height
+                    int stepRows = (int)(pageStep_ * scrollPanel_->GetHeight()) / virtualItemHeight_ - 1;
+                    delta = pageDirection * Max(stepRows, 1);
+                    break;
+                }
                 int stepPixels = ((int)(pageStep_ * scrollPanel_->GetHeight())) - contentElement_->GetChild(selection)->GetHeight();
                 unsigned newSelection = selection;
                 unsigned okSelection = selection;
@@ -319,6 +334,9 @@ void ListView::OnResize(const IntVector2& newSize, const IntVector2& delta)
     // When in hierarchy mode also need to resize the overlay container
     if (hierarchyMode_)
         overlayContainer_->SetSize(scrollPanel_->GetSize());
+    // In virtual mode the number of visible rows may have changed
+    else if (virtualMode_)
+        UpdateVirtualItems();
 }
 
 void ListView::UpdateInternalLayout()
@@ -349,7 +367,7 @@ void ListView::AddItem(UIElement* item)
 
 void ListView::InsertItem(unsigned index, UIElement* item, UIElement* parentItem)
 {
-    if (!item || item->GetParent() == contentElement_)
+    if (!item || item->GetParent() == contentElement_ || virtualMode_)
         return;
 
     // Enable input so that clicking the item can be detected
@@ -414,7 +432,7 @@ void ListView::InsertItem(unsigned index, UIElement* item, UIElement* parentItem
 
 void ListView::RemoveItem(UIElement* item, unsigned index)
 {
-    if (!item)
+    if (!item || virtualMode_)
         return;
 
     unsigned numItems = GetNumItems();
@@ -495,6 +513,13 @@ void ListView::RemoveItem(unsigned index)
 
 void ListView::RemoveAllItems()
 {
+    if (virtualMode_)
+    {
+        ClearSelection();
+        SetVirtualItemCount(0);
+        return;
+    }
+
     contentElement_->DisableLayoutUpdate();
 
     ClearSelection();
@@ -679,8 +704,8 @@ void ListView::ChangeSelection(int delta, bool additive)
         if (newSelection >= numItems)
             break;
 
-        UIElement* item = GetItem(newSelection);
-        if (item->IsVisible())
+        // In virtual mode all rows are visible, even when they have no item element
+        if (virtualMode_ || GetItem(newSelection)->IsVisible())
         {
             indices.Push(okSelection = newSelection);
             delta -= direction;
@@ -714,6 +739,9 @@ void ListView::SetHierarchyMode(bool enable)
     if (enable == hierarchyMode_)
         return;
 
+    if (enable)
+        SetVirtualMode(false);
+
     hierarchyMode_ = enable;
     UIElement* container;
     if (enable)
@@ -827,12 +855,19 @@ void ListView::ToggleExpand(unsigned index, bool recursive)
 
 unsigned ListView::GetNumItems() const
 {
-    return contentElement_->GetNumChildren();
+    return virtualMode_ ? virtualItemCount_ : contentElement_->GetNumChildren();
 }
 
 UIElement* ListView::GetItem(unsigned index) const
 {
-    return contentElement_->GetChild(index);
+    if (!virtualMode_)
+        return contentElement_->GetChild(index);
+
+    // Only the rows assigned to a pooled element have one
+    if (virtualItemRows_.Empty())
+        return nullptr;
+    unsigned poolIndex = index % virtualItemRows_.Size();
+    return virtualItemRows_[poolIndex] == index ? contentElement_->GetChild(poolIndex) : nullptr;
 }
 
 PODVector<UIElement*> ListView::GetItems() const
@@ -853,6 +888,16 @@ unsigned ListView::FindItem(UIElement* item) const
 
     const Vector<SharedPtr<UIElement> >& children = contentElement_->GetChildren();
 
+    if (virtualMode_)
+    {
+        for (unsigned i = 0; i < children.Size() && i < virtualItemRows_.Size(); ++i)
+        {
+            if (children[i] == item)
+                return virtualItemRows_[i];
+        }
+        return M_MAX_UNSIGNED;
+    }
+
     // Binary search for list item based on screen coordinate Y
     if (contentElement_->GetLayoutMode() == LM_VERTICAL && item->GetHeight())
     {
@@ -891,7 +936,7 @@ unsigned ListView::GetSelection() const
 
 UIElement* ListView::GetSelectedItem() const
 {
-    return contentElement_->GetChild(GetSelection());
+    return GetItem(GetSelection());
 }
 
 PODVector<UIElement*> ListView::GetSelectedItems() const
@@ -930,7 +975,7 @@ bool ListView::IsSelected(unsigned index) const
 
 bool ListView::IsExpanded(unsigned index) const
 {
-    return GetItemExpanded(contentElement_->GetChild(index));
+    return GetItemExpanded(GetItem(index));
 }
 
 bool ListView::FilterImplicitAttributes(XMLElement& dest) const
@@ -978,9 +1023,21 @@ bool ListView::FilterImplicitAttributes(XMLElement& dest) const
 
 void ListView::UpdateSelectionEffect()
 {
-    unsigned numItems = GetNumItems();
     bool highlighted = highlightMode_ == HM_ALWAYS || HasFocus();
 
+    if (virtualMode_)
+    {
+        for (unsigned i = 0; i < virtualItemRows_.Size(); ++i)
+        {
+            unsigned row = virtualItemRows_[i];
+            contentElement_->GetChild(i)->SetSelected(highlightMode_ != HM_NEVER && row != M_MAX_UNSIGNED &&
+                selections_.Contains(row) && highlighted);
+        }
+        return;
+    }
+
+    unsigned numItems = GetNumItems();
+
     for (unsigned i = 0; i < numItems; ++i)
     {
         UIElement* item = GetItem(i);
@@ -993,6 +1050,14 @@ void ListView::UpdateSelectionEffect()
 
 void ListView::EnsureItemVisibility(unsigned index)
 {
+    // In virtual mode the row may not have an item element yet
+    if (virtualMode_)
+    {
+        if (index < virtualItemCount_)
+            EnsureVisibility(IntVector2(0, (int)index * virtualItemHeight_), virtualItemHeight_);
+        return;
+    }
+
     EnsureItemVisibility(GetItem(index));
 }
 
@@ -1001,16 +1066,192 @@ void ListView::EnsureItemVisibility(UIElement* item)
     if (!item || !item->IsVisible())
         return;
 
+    EnsureVisibility(item->GetPosition(), item->GetHeight());
+}
+
+void ListView::SetVirtualMode(bool enable)
+{
+    if (enable == virtualMode_)
+        return;
+
+    if (enable)
+    {
+        SetHierarchyMode(false);
+        RemoveAllItems();
+
+        virtualMode_ = true;
+        SubscribeToEvent(this, E_VIEWCHANGED, URHO3D_HANDLER(ListView, HandleVirtualViewChanged));
+        UpdateVirtualItems();
+    }
+    else
+    {
+        ClearSelection();
+        RemoveVirtualItems();
+        virtualMode_ = false;
+        virtualItemCount_ = 0;
+        UnsubscribeFromEvent(this, E_VIEWCHANGED);
+
+        contentElement_->SetLayoutMode(LM_VERTICAL);
+    }
+}
+
+void ListView::SetVirtualItemCount(unsigned count)
+{
+    if (count == virtualItemCount_)
+        return;
+
+    virtualItemCount_ = count;
+
+    // Remove the selections of rows that no longer exist
+    unsigned numSelections = selections_.Size();
+    while (!selections_.Empty() && selections_.Back() >= count)
+        selections_.Pop();
+
+    UpdateVirtualItems();
+    if (selections_.Size() != numSelections)
+        SendEvent(E_SELECTIONCHANGED);
+}
+
+void ListView::SetVirtualItemHeight(int height)
+{
+    height = Max(height, 1);
+    if (height == virtualItemHeight_)
+        return;
+
+    virtualItemHeight_ = height;
+    UpdateVirtualItems();
+}
+
+void ListView::SetVirtualItemType(StringHash type)
+{
+    if (type == virtualItemType_)
+        return;
+
+    virtualItemType_ = type;
+    RemoveVirtualItems();
+    UpdateVirtualItems();
+}
+
+void ListView::SetVirtualItemStyle(const String& style)
+{
+    if (style == virtualItemStyle_)
+        return;
+
+    virtualItemStyle_ = style;
+    RemoveVirtualItems();
+    UpdateVirtualItems();
+}
+
+void ListView::RefreshVirtualItems()
+{
+    UpdateVirtualItems(true);
+}
+
+void ListView::UpdateVirtualItems(bool refresh)
+{
+    if (!virtualMode_ || virtualItemsUpdating_)
+        return;
+
+    // Make a weak pointer to self to check for destruction as a response to events
+    WeakPtr<ListView> self(this);
+    virtualItemsUpdating_ = true;
+
+    // Size the content for all rows, so that the scroll bars cover the whole list. This may also clamp the view position
+    if (contentElement_->GetLayoutMode() != LM_FREE)
+        contentElement_->SetLayoutMode(LM_FREE);
+    contentElement_->SetHeight((int)virtualItemCount_ * virtualItemHeight_);
+
+    const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+    int windowHeight = Max(scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_, 0);
+    auto capacity = (unsigned)(windowHeight / virtualItemHeight_ + 2);
+
+    unsigned poolSize = contentElement_->GetNumChildren();
+    if (poolSize < capacity)
+    {
+        for (unsigned i = poolSize; i < capacity; ++i)
+        {
+            UIElement* item = contentElement_->CreateChild(virtualItemType_);
+            if (!item)
+                break;
+
+            // Enable input so that clicking the item can be detected
+            item->SetInternal(true);
+            item->SetEnabled(true);
+            if (virtualItemStyle_.Empty())
+                item->SetStyleAuto();
+            else
+                item->SetStyle(virtualItemStyle_);
+        }
+
+        // The rows map to different elements with the new pool size, so all are refilled
+        poolSize = contentElement_->GetNumChildren();
+        virtualItemRows_.Resize(poolSize);
+        for (unsigned i = 0; i < poolSize; ++i)
+            virtualItemRows_[i] = M_MAX_UNSIGNED;
+    }
+
+    if (poolSize)
+    {
+        auto first = (unsigned)(GetViewPosition().y_ / virtualItemHeight_);
+        unsigned last = Min(first + capacity, virtualItemCount_);
+        int width = contentElement_->GetWidth();
+
+        for (unsigned i = 0; i < poolSize; ++i)
+        {
+            // Rows map to the pooled elements cyclically, so that scrolling by one row refills only one element
+            unsigned row = first + (i + poolSize - first % poolSize) % poolSize;
+            UIElement* item = contentElement_->GetChild(i);
+            if (row >= last)
+            {
+                item->SetVisible(false);
+                virtualItemRows_[i] = M_MAX_UNSIGNED;
+                continue;
+            }
+
+            item->SetPosition(0, (int)row * virtualItemHeight_);
+            item->SetSize(width, virtualItemHeight_);
+            item->SetVisible(true);
+
+            if (refresh || virtualItemRows_[i] != row)
+            {
+                virtualItemRows_[i] = row;
+
+                using namespace VirtualItemUpdate;
+
+                VariantMap& eventData = GetEventDataMap();
+                eventData[P_ELEMENT] = this;
+                eventData[P_ITEM] = item;
+                eventData[P_INDEX] = row;
+                SendEvent(E_VIRTUALITEMUPDATE, eventData);
+
+                if (self.Expired())
+                    return;
+            }
+        }
+    }
+
+    virtualItemsUpdating_ = false;
+    UpdateSelectionEffect();
+}
+
+void ListView::RemoveVirtualItems()
+{
+    contentElement_->RemoveAllChildren();
+    virtualItemRows_.Clear();
+}
+
+void ListView::EnsureVisibility(const IntVector2& position, int height)
+{
     IntVector2 newView = GetViewPosition();
-    IntVector2 currentOffset = item->GetPosition() - newView;
+    IntVector2 currentOffset = position - newView;
     const IntRect& clipBorder = scrollPanel_->GetClipBorder();
     IntVector2 windowSize(scrollPanel_->GetWidth() - clipBorder.left_ - clipBorder.right_,
         scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_);
 
     if (currentOffset.y_ < 0)
         newView.y_ += currentOffset.y_;
-    if (currentOffset.y_ + item->GetHeight() > windowSize.y_)
-        newView.y_ += currentOffset.y_ + item->GetHeight() - windowSize.y_;
+    if (currentOffset.y_ + height > windowSize.y_)
+        newView.y_ += currentOffset.y_ + height - windowSize.y_;
 
     SetViewPosition(newView);
 }
@@ -1154,6 +1395,11 @@ void ListView::HandleFocusChanged(StringHash eventType, VariantMap& eventData)
         UpdateSelectionEffect();
 }
 
+void ListView::HandleVirtualViewChanged(StringHash eventType, VariantMap& eventData)
+{
+    UpdateVirtualItems();
+}
+
 void ListView::UpdateUIClickSubscription()
 {
     UnsubscribeFromEvent(E_UIMOUSECLICK);
@@ -100,6 +100,19 @@ public:
     void SetHierarchyMode(bool enable);
     /// Set base indent, i.e. the indent level of the ultimate parent item.
     void SetBaseIndent(int baseIndent);
+    /// \brief Enable virtual mode. The list then holds only a pool of item elements covering the visible rows, and sends the VirtualItemUpdate event to fill an element when it is assigned a row. Rows have a fixed height and are referred to by index, including the selection.
+    /// All items in the list will be lost during mode change. Disables hierarchy mode. Items can not be added or removed individually in virtual mode.
+    void SetVirtualMode(bool enable);
+    /// Set number of rows in virtual mode. Selections beyond the new count are removed.
+    void SetVirtualItemCount(unsigned count);
+    /// Set row height in virtual mode. Default 16.
+    void SetVirtualItemHeight(int height);
+    /// Set type of the pooled item elements in virtual mode. Default Text. Recreates the pool.
+    void SetVirtualItemType(StringHash type);
+    /// Set style of the pooled item elements in virtual mode. Empty uses the type's default style. Recreates the pool.
+    void SetVirtualItemStyle(const String& style);
+    /// Refill all visible item elements in virtual mode, for example after the row data has changed.
+    void RefreshVirtualItems();
     /// Enable clearing of selection on defocus.
     void SetClearSelectionOnDefocus(bool enable);
     /// Enable reacting to click end instead of click start for item selection. Default false.
@@ -153,6 +166,21 @@ public:
     /// Return base indent.
     int GetBaseIndent() const { return baseIndent_; }
 
+    /// Return whether virtual mode enabled.
+    bool GetVirtualMode() const { return virtualMode_; }
+
+    /// Return number of rows in virtual mode.
+    unsigned GetVirtualItemCount() const { return virtualItemCount_; }
+
+    /// Return row height in virtual mode.
+    int GetVirtualItemHeight() const { return virtualItemHeight_; }
+
+    /// Return type of the pooled item elements in virtual mode.
+    StringHash GetVirtualItemType() const { return virtualItemType_; }
+
+    /// Return style of the pooled item elements in virtual mode.
+    const String& GetVirtualItemStyle() const { return virtualItemStyle_; }
+
     /// Ensure full visibility of the item.
     void EnsureItemVisibility(unsigned index);
     /// Ensure full visibility of the item.
@@ -163,6 +191,12 @@ protected:
     bool FilterImplicitAttributes(XMLElement& dest) const override;
     /// Update selection effect when selection or focus changes.
     void UpdateSelectionEffect();
+    /// Resize the content for the virtual rows, grow the item element pool and assign the visible rows to the elements. Optionally refill all elements.
+    void UpdateVirtualItems(bool refresh = false);
+    /// Remove the pooled item elements of virtual mode.
+    void RemoveVirtualItems();
+    /// Scroll to fully show an area of the content element.
+    void EnsureVisibility(const IntVector2& position, int height);
 
     /// Current selection.
     PODVector<unsigned> selections_;
@@ -180,6 +214,20 @@ protected:
     bool clearSelectionOnDefocus_;
     /// React to click end instead of click start flag.
     bool selectOnClickEnd_;
+    /// Virtual mode flag.
+    bool virtualMode_;
+    /// Number of rows in virtual mode.
+    unsigned virtualItemCount_;
+    /// Row height in virtual mode.
+    int virtualItemHeight_;
+    /// Type of the pooled item elements.
+    StringHash virtualItemType_;
+    /// Style of the pooled item elements.
+    String virtualItemStyle_;
+    /// Rows assigned to the pooled item elements, or M_MAX_UNSIGNED if hidden.
+    PODVector<unsigned> virtualItemRows_;
+    /// Virtual item update in progress flag.
+    bool virtualItemsUpdating_;
 
 private:
     /// Handle global UI mouseclick to check for selection change.
@@ -190,6 +238,8 @@ private:
     void HandleItemFocusChanged(StringHash eventType, VariantMap& eventData);
     /// Handle focus changed.
     void HandleFocusChanged(StringHash eventType, VariantMap& eventData);
+    /// Handle view changed in virtual mode by reassigning the item elements.
+    void HandleVirtualViewChanged(StringHash eventType, VariantMap& eventData);
     /// Update subscription to UI click events
     void UpdateUIClickSubscription();
 };
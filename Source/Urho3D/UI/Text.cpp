@@ -59,6 +59,8 @@ Text::Text(Context* context) :
     wordWrap_(false),
     autoLocalizable_(false),
     charLocationsDirty_(true),
+    textFaceRevision_(0),
+    charLocationsFaceRevision_(0),
     selectionStart_(0),
     selectionLength_(0),
     textEffect_(TE_NONE),
@@ -67,7 +69,13 @@ Text::Text(Context* context) :
     roundStroke_(false),
     effectColor_(Color::BLACK),
     effectDepthBias_(0.0f),
-    rowHeight_(0)
+    rowHeight_(0),
+    layoutWidth_(0),
+    layoutWordWrap_(false),
+    layoutLength_(0),
+    lastRowTextStart_(0),
+    lastRowPrintStart_(0),
+    lastRowIndex_(0)
 {
     // By default Text does not derive opacity from parent elements
     useDerivedOpacity_ = false;
@@ -134,6 +142,9 @@ void Text::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData,
     {
         for (unsigned i = 0; i < printText_.Size(); ++i)
             face->GetGlyph(printText_[i]);
+        // Glyphs may have moved to other textures. Changed sizes are measured on the next update
+        if (face->GetRevision() != charLocationsFaceRevision_)
+            UpdateCharLocations();
     }
 
     // Hovering and/or whole selection batch
@@ -237,6 +248,29 @@ void Text::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData,
     }
 }
 
+void Text::Update(float timeStep)
+{
+    UpdateGlyphs();
+}
+
+void Text::UpdateGlyphs()
+{
+    if (fontFace_)
+        fontFace_->UpdateQueuedGlyphs();
+    if (GetGlyphsChanged())
+        UpdateText();
+}
+
+bool Text::GetGlyphsChanged() const
+{
+    return fontFace_ && fontFace_->GetRevision() != textFaceRevision_;
+}
+
+bool Text::HasQueuedGlyphs() const
+{
+    return fontFace_ && fontFace_->HasQueuedGlyphs();
+}
+
 void Text::OnResize(const IntVector2& newSize, const IntVector2& delta)
 {
     if (wordWrap_)
@@ -288,6 +322,9 @@ void Text::DecodeToUnicode()
     unicodeText_.Clear();
     for (unsigned i = 0; i < text_.Length();)
         unicodeText_.Push(text_.NextUTF8Char(i));
+
+    // The existing layout is not valid for the new text
+    ResetLayout();
 }
 
 void Text::SetText(const String& text)
@@ -296,10 +333,16 @@ void Text::SetText(const String& text)
     {
         stringId_ = text;
         auto* l10n = GetSubsystem<Localization>();
-        text_ = l10n->Get(stringId_);
+        String localized = l10n->Get(stringId_);
+        if (localized == text_ && layoutFace_)
+            return;
+        text_ = localized;
     }
     else
     {
+        // Setting the same text again keeps the existing layout, for example when updating list items every frame
+        if (text == text_ && layoutFace_)
+            return;
         text_ = text;
     }
 
@@ -308,6 +351,26 @@ void Text::SetText(const String& text)
     UpdateText();
 }
 
+void Text::AppendText(const String& text)
+{
+    if (text.Empty())
+        return;
+
+    // Localized text is looked up as a whole
+    if (autoLocalizable_)
+    {
+        SetText(stringId_ + text);
+        return;
+    }
+
+    text_ += text;
+    for (unsigned i = 0; i < text.Length();)
+        unicodeText_.Push(text.NextUTF8Char(i));
+
+    ValidateSelection();
+    UpdateText();
+}
+
 void Text::SetTextAlignment(HorizontalAlignment align)
 {
     if (align != textAlignment_)
@@ -315,6 +378,7 @@ void Text::SetTextAlignment(HorizontalAlignment align)
         textAlignment_ = align;
         charLocationsDirty_ = true;
     }
+    MarkBatchesDirty();
 }
 
 void Text::SetRowSpacing(float spacing)
@@ -373,42 +437,50 @@ void Text::SetSelection(unsigned start, unsigned length)
     selectionStart_ = start;
     selectionLength_ = length;
     ValidateSelection();
+    MarkBatchesDirty();
 }
 
 void Text::ClearSelection()
 {
     selectionStart_ = 0;
     selectionLength_ = 0;
+    MarkBatchesDirty();
 }
 
 void Text::SetTextEffect(TextEffect textEffect)
 {
     textEffect_ = textEffect;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectShadowOffset(const IntVector2& offset)
 {
     shadowOffset_ = offset;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectStrokeThickness(int thickness)
 {
     strokeThickness_ = Abs(thickness);
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectRoundStroke(bool roundStroke)
 {
     roundStroke_ = roundStroke;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectColor(const Color& effectColor)
 {
     effectColor_ = effectColor;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectDepthBias(float bias)
 {
     effectDepthBias_ = bias;
+    MarkBatchesDirty();
 }
 
 float Text::GetRowWidth(unsigned index) const
@@ -456,6 +528,8 @@ void Text::SetTextAttr(const String& value)
     text_ = value;
     if (autoLocalizable_)
         stringId_ = value;
+    // The text is decoded and laid out in ApplyAttributes()
+    layoutFace_.Reset();
 }
 
 String Text::GetTextAttr() const
@@ -486,194 +560,245 @@ bool Text::FilterImplicitAttributes(XMLElement& dest) const
 
 void Text::UpdateText(bool onResize)
 {
-    rowWidths_.Clear();
-    printText_.Clear();
+    MarkBatchesDirty();
 
     if (font_)
     {
         FontFace* face = font_->GetFace(fontSize_);
         if (!face)
+        {
+            ResetLayout();
             return;
+        }
 
         rowHeight_ = face->GetRowHeight();
-
-        int width = 0;
-        int height = 0;
-        int rowWidth = 0;
         auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
 
-        // First see if the text must be split up
-        if (!wordWrap_)
+        // Reuse the existing layout if it was made with the same face, glyphs and wrap width. If text was only appended,
+        // continue it from the last row
+        int maxWidth = wordWrap_ ? GetWidth() : 0;
+        if (face != layoutFace_ || face->GetRevision() != textFaceRevision_ || wordWrap_ != layoutWordWrap_ ||
+            maxWidth != layoutWidth_ || layoutLength_ > unicodeText_.Size())
+            ResetLayout();
+        if (!layoutFace_ || layoutLength_ < unicodeText_.Size())
         {
-            printText_ = unicodeText_;
-            printToText_.Resize(printText_.Size());
-            for (unsigned i = 0; i < printText_.Size(); ++i)
-                printToText_[i] = i;
+            // Glyphs that change while measuring are measured again on the next update
+            layoutFace_ = face;
+            textFaceRevision_ = face->GetRevision();
+            layoutWordWrap_ = wordWrap_;
+            layoutWidth_ = maxWidth;
+            LayoutText(face, maxWidth);
         }
-        else
+
+        float width = 0.0f;
+        for (unsigned i = 0; i < rowWidths_.Size(); ++i)
+            width = Max(width, rowWidths_[i]);
+        int height = (int)rowWidths_.Size() * rowHeight;
+
+        // Set at least one row height even if text is empty
+        if (!height)
+            height = rowHeight;
+
+        // Set minimum and current size according to the text size, but respect fixed width if set
+        if (!IsFixedWidth())
         {
-            int maxWidth = GetWidth();
-            unsigned nextBreak = 0;
-            unsigned lineStart = 0;
-            printToText_.Clear();
+            if (wordWrap_)
+                SetMinWidth(0);
+            else
+            {
+                SetMinWidth((int)width);
+                SetWidth((int)width);
+            }
+        }
+        SetFixedHeight(height);
+
+        charLocationsDirty_ = true;
+    }
+    else
+    {
+        // No font, nothing to render
+        ResetLayout();
+        pageGlyphLocations_.Clear();
+    }
 
-            for (unsigned i = 0; i < unicodeText_.Size(); ++i)
+    // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
+    // update is a response to resize, as that could cause infinite recursion
+    if (wordWrap_ && !onResize)
+    {
+        UIElement* parent = GetParent();
+        if (parent && parent->GetLayoutMode() != LM_FREE)
+            parent->UpdateLayout();
+    }
+}
+
+void Text::LayoutText(FontFace* face, int maxWidth)
+{
+    // Appended text may continue the last row, so lay out again from its start
+    unsigned textStart = lastRowTextStart_;
+    unsigned printStart = lastRowPrintStart_;
+    printText_.Resize(printStart);
+    printToText_.Resize(printStart);
+    rowWidths_.Resize(lastRowIndex_);
+
+    int rowWidth = 0;
+
+    // First see if the text must be split up
+    if (!wordWrap_)
+    {
+        for (unsigned i = textStart; i < unicodeText_.Size(); ++i)
+        {
+            printText_.Push(unicodeText_[i]);
+            printToText_.Push(i);
+            if (unicodeText_[i] == '\n')
             {
-                unsigned j;
-                unsigned c = unicodeText_[i];
+                lastRowTextStart_ = i + 1;
+                lastRowPrintStart_ = printText_.Size();
+                ++lastRowIndex_;
+            }
+        }
+    }
+    else
+    {
+        unsigned nextBreak = textStart;
+        unsigned lineStart = textStart;
 
-                if (c != '\n')
-                {
-                    bool ok = true;
+        for (unsigned i = textStart; i < unicodeText_.Size(); ++i)
+        {
+            unsigned j;
+            unsigned c = unicodeText_[i];
+
+            if (c != '\n')
+            {
+                bool ok = true;
 
-                    if (nextBreak <= i)
+                if (nextBreak <= i)
+                {
+                    int futureRowWidth = rowWidth;
+                    for (j = i; j < unicodeText_.Size(); ++j)
                     {
-                        int futureRowWidth = rowWidth;
-                        for (j = i; j < unicodeText_.Size(); ++j)
+                        unsigned d = unicodeText_[j];
+                        if (d == ' ' || d == '\n')
                         {
-                            unsigned d = unicodeText_[j];
-                            if (d == ' ' || d == '\n')
-                            {
-                                nextBreak = j;
-                                break;
-                            }
-                            const FontGlyph* glyph = face->GetGlyph(d);
-                            if (glyph)
-                            {
-                                futureRowWidth += glyph->advanceX_;
-                                if (j < unicodeText_.Size() - 1)
-                                    futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
-                            }
-                            if (d == '-' && futureRowWidth <= maxWidth)
-                            {
-                                nextBreak = j + 1;
-                                break;
-                            }
-                            if (futureRowWidth > maxWidth)
-                            {
-                                ok = false;
-                                break;
-                            }
+                            nextBreak = j;
+                            break;
                         }
-                    }
-
-                    if (!ok)
-                    {
-                        // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
-                        if (nextBreak == lineStart)
+                        const FontGlyph* glyph = face->GetGlyph(d);
+                        if (glyph)
                         {
-                            while (i < j)
-                            {
-                                printText_.Push(unicodeText_[i]);
-                                printToText_.Push(i);
-                                ++i;
-                            }
+                            futureRowWidth += glyph->advanceX_;
+                            if (j < unicodeText_.Size() - 1)
+                                futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
                         }
-                        // Eliminate spaces that have been copied before the forced break
-                        while (printText_.Size() && printText_.Back() == ' ')
+                        if (d == '-' && futureRowWidth <= maxWidth)
                         {
-                            printText_.Pop();
-                            printToText_.Pop();
+                            nextBreak = j + 1;
+                            break;
+                        }
+                        if (futureRowWidth > maxWidth)
+                        {
+                            ok = false;
+                            break;
                         }
-                        printText_.Push('\n');
-                        printToText_.Push(Min(i, unicodeText_.Size() - 1));
-                        rowWidth = 0;
-                        nextBreak = lineStart = i;
                     }
+                }
 
-                    if (i < unicodeText_.Size())
+                if (!ok)
+                {
+                    // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
+                    if (nextBreak == lineStart)
                     {
-                        // When copying a space, position is allowed to be over row width
-                        c = unicodeText_[i];
-                        const FontGlyph* glyph = face->GetGlyph(c);
-                        if (glyph)
+                        while (i < j)
                         {
-                            rowWidth += glyph->advanceX_;
-                            if (i < unicodeText_.Size() - 1)
-                                rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
-                        }
-                        if (rowWidth <= maxWidth)
-                        {
-                            printText_.Push(c);
+                            printText_.Push(unicodeText_[i]);
                             printToText_.Push(i);
+                            ++i;
                         }
                     }
-                }
-                else
-                {
+                    // Eliminate spaces that have been copied before the forced break
+                    while (printText_.Size() && printText_.Back() == ' ')
+                    {
+                        printText_.Pop();
+                        printToText_.Pop();
+                    }
                     printText_.Push('\n');
                     printToText_.Push(Min(i, unicodeText_.Size() - 1));
                     rowWidth = 0;
                     nextBreak = lineStart = i;
+                    lastRowTextStart_ = i;
+                    lastRowPrintStart_ = printText_.Size();
+                    ++lastRowIndex_;
                 }
-            }
-        }
-
-        rowWidth = 0;
 
-        for (unsigned i = 0; i < printText_.Size(); ++i)
-        {
-            unsigned c = printText_[i];
-
-            if (c != '\n')
-            {
-                const FontGlyph* glyph = face->GetGlyph(c);
-                if (glyph)
+                if (i < unicodeText_.Size())
                 {
-                    rowWidth += glyph->advanceX_;
-                    if (i < printText_.Size() - 1)
-                        rowWidth += face->GetKerning(c, printText_[i + 1]);
+                    // When copying a space, position is allowed to be over row width
+                    c = unicodeText_[i];
+                    const FontGlyph* glyph = face->GetGlyph(c);
+                    if (glyph)
+                    {
+                        rowWidth += glyph->advanceX_;
+                        if (i < unicodeText_.Size() - 1)
+                            rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
+                    }
+                    if (rowWidth <= maxWidth)
+                    {
+                        printText_.Push(c);
+                        printToText_.Push(i);
+                    }
                 }
             }
             else
             {
-                width = Max(width, rowWidth);
-                height += rowHeight;
-                rowWidths_.Push(rowWidth);
+                printText_.Push('\n');
+                printToText_.Push(Min(i, unicodeText_.Size() - 1));
                 rowWidth = 0;
+                nextBreak = lineStart = i;
+                lastRowTextStart_ = i + 1;
+                lastRowPrintStart_ = printText_.Size();
+                ++lastRowIndex_;
             }
         }
+    }
 
-        if (rowWidth)
-        {
-            width = Max(width, rowWidth);
-            height += rowHeight;
-            rowWidths_.Push(rowWidth);
-        }
+    rowWidth = 0;
 
-        // Set at least one row height even if text is empty
-        if (!height)
-            height = rowHeight;
+    for (unsigned i = printStart; i < printText_.Size(); ++i)
+    {
+        unsigned c = printText_[i];
 
-        // Set minimum and current size according to the text size, but respect fixed width if set
-        if (!IsFixedWidth())
+        if (c != '\n')
         {
-            if (wordWrap_)
-                SetMinWidth(0);
-            else
+            const FontGlyph* glyph = face->GetGlyph(c);
+            if (glyph)
             {
-                SetMinWidth(width);
-                SetWidth(width);
+                rowWidth += glyph->advanceX_;
+                if (i < printText_.Size() - 1)
+                    rowWidth += face->GetKerning(c, printText_[i + 1]);
             }
         }
-        SetFixedHeight(height);
-
-        charLocationsDirty_ = true;
-    }
-    else
-    {
-        // No font, nothing to render
-        pageGlyphLocations_.Clear();
+        else
+        {
+            rowWidths_.Push(rowWidth);
+            rowWidth = 0;
+        }
     }
 
-    // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
-    // update is a response to resize, as that could cause infinite recursion
-    if (wordWrap_ && !onResize)
-    {
-        UIElement* parent = GetParent();
-        if (parent && parent->GetLayoutMode() != LM_FREE)
-            parent->UpdateLayout();
-    }
+    if (rowWidth)
+        rowWidths_.Push(rowWidth);
+
+    layoutLength_ = unicodeText_.Size();
+}
+
+void Text::ResetLayout()
+{
+    printText_.Clear();
+    printToText_.Clear();
+    rowWidths_.Clear();
+    layoutFace_.Reset();
+    layoutLength_ = 0;
+    lastRowTextStart_ = 0;
+    lastRowPrintStart_ = 0;
+    lastRowIndex_ = 0;
 }
 
 void Text::UpdateCharLocations()
@@ -683,6 +808,7 @@ void Text::UpdateCharLocations()
     if (!face)
         return;
     fontFace_ = face;
+    charLocationsFaceRevision_ = face->GetRevision();
 
     auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
 
@@ -86,6 +86,8 @@ public:
 
     /// Apply attribute changes that can not be applied immediately.
     void ApplyAttributes() override;
+    /// Perform UI element update.
+    void Update(float timeStep) override;
     /// Return UI rendering batches.
     void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override;
     /// React to resize.
@@ -101,6 +103,8 @@ public:
     bool SetFontSize(float size);
     /// Set text. Text is assumed to be either ASCII or UTF8-encoded.
     void SetText(const String& text);
+    /// Append text to the end. Only the last row and the appended text are laid out again, which suits log and chat texts that grow by lines.
+    void AppendText(const String& text);
     /// Set row alignment.
     void SetTextAlignment(HorizontalAlignment align);
     /// Set row spacing, 1.0 for original font spacing.
@@ -185,6 +189,13 @@ public:
     /// Set text effect Z bias. Zero by default, adjusted only in 3D mode.
     void SetEffectDepthBias(float bias);
 
+    /// Update the text if the font face glyphs changed since, for example after background rasterization. Called automatically each frame for text in the UI hierarchy.
+    void UpdateGlyphs();
+    /// Return whether the font face glyphs changed since the text was updated.
+    bool GetGlyphsChanged() const;
+    /// Return whether the font face has glyphs waiting for background rasterization.
+    bool HasQueuedGlyphs() const;
+
     /// Return effect Z bias.
     float GetEffectDepthBias() const { return effectDepthBias_; }
 
@@ -202,6 +213,10 @@ protected:
     bool FilterImplicitAttributes(XMLElement& dest) const override;
     /// Update text when text, font or spacing changed.
     void UpdateText(bool onResize = false);
+    /// Lay out the printed text and row widths, continuing from the start of the last row.
+    void LayoutText(FontFace* face, int maxWidth);
+    /// Clear the printed text and row widths so that the next update lays out the whole text.
+    void ResetLayout();
     /// Update cached character locations after text update, or when text alignment or indent has changed.
     void UpdateCharLocations();
     /// Validate text selection to be within the text.
@@ -229,6 +244,10 @@ protected:
     bool wordWrap_;
     /// Char positions dirty flag.
     bool charLocationsDirty_;
+    /// Font face glyph revision when the text was updated.
+    unsigned textFaceRevision_;
+    /// Font face glyph revision when the char positions were updated.
+    unsigned charLocationsFaceRevision_;
     /// Selection start.
     unsigned selectionStart_;
     /// Selection length.
@@ -255,6 +274,20 @@ protected:
     PODVector<unsigned> printToText_;
     /// Row widths.
     PODVector<float> rowWidths_;
+    /// Font face the printed text was laid out with. Null if the layout is not valid.
+    WeakPtr<FontFace> layoutFace_;
+    /// Width the printed text was wrapped to, or 0 if not wrapped.
+    int layoutWidth_;
+    /// Wordwrap mode the printed text was laid out with.
+    bool layoutWordWrap_;
+    /// Number of characters laid out.
+    unsigned layoutLength_;
+    /// Character index where the last printed row starts.
+    unsigned lastRowTextStart_;
+    /// Printed text index where the last printed row starts.
+    unsigned lastRowPrintStart_;
+    /// Number of printed rows before the last row.
+    unsigned lastRowIndex_;
     /// Glyph locations per each texture in the font.
     Vector<PODVector<GlyphLocation> > pageGlyphLocations_;
     /// Cached locations of each character in the text.
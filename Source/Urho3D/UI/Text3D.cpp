@@ -133,6 +133,10 @@ void Text3D::UpdateBatches(const FrameInfo& frame)
             break;
         }
     }
+
+    // Poll the background rasterized glyphs in the main thread geometry update
+    if (text_.GetGlyphsChanged() || text_.HasQueuedGlyphs())
+        fontDataLost_ = true;
 }
 
 void Text3D::UpdateGeometry(const FrameInfo& frame)
@@ -140,6 +144,7 @@ void Text3D::UpdateGeometry(const FrameInfo& frame)
     if (fontDataLost_)
     {
         // Re-evaluation of the text triggers the font face to reload itself
+        text_.UpdateGlyphs();
         UpdateTextBatches();
         UpdateTextMaterials();
         fontDataLost_ = false;
@@ -163,7 +168,7 @@ void Text3D::UpdateGeometry(const FrameInfo& frame)
     {
         unsigned vertexCount = uiVertexData_.Size() / UI_VERTEX_SIZE;
         if (vertexBuffer_->GetVertexCount() != vertexCount)
-            vertexBuffer_->SetSize(vertexCount, MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1);
+            vertexBuffer_->SetSize(vertexCount, UIBatch::GetVertexElements());
         vertexBuffer_->SetData(&uiVertexData_[0]);
     }
 
@@ -222,6 +227,10 @@ bool Text3D::SetFontSize(float size)
 
 void Text3D::SetText(const String& text)
 {
+    // Setting the same text again does not require rebuilding the batches
+    if (!text_.GetAutoLocalizable() && text == text_.GetText())
+        return;
+
     text_.SetText(text);
 
     // Changing text requires materials to be re-evaluated, in case the font is multi-page
@@ -230,6 +239,18 @@ void Text3D::SetText(const String& text)
     UpdateTextMaterials();
 }
 
+void Text3D::AppendText(const String& text)
+{
+    if (text.Empty())
+        return;
+
+    text_.AppendText(text);
+
+    MarkTextDirty();
+    UpdateTextBatches();
+    UpdateTextMaterials();
+}
+
 void Text3D::SetAlignment(HorizontalAlignment hAlign, VerticalAlignment vAlign)
 {
     text_.SetAlignment(hAlign, vAlign);
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/AllocationTracker.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
@@ -39,9 +40,12 @@
 #include "../Scene/Scene.h"
 #include "../Input/Input.h"
 #include "../Input/InputEvents.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Math/Matrix3x4.h"
+#include "../Resource/Image.h"
 #include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
 #include "../UI/CheckBox.h"
 #include "../UI/Cursor.h"
 #include "../UI/DropDownList.h"
@@ -76,6 +80,12 @@ static MouseButton MakeTouchIDMask(int id)
     return static_cast<MouseButton>(1u << static_cast<MouseButtonFlags::Integer>(id)); // NOLINT(misc-misplaced-widening-cast)
 }
 
+/// Return whether two screen rects cover any common pixels. Rects that only share an edge do not.
+static bool RectsOverlap(const Rect& a, const Rect& b)
+{
+    return a.min_.x_ < b.max_.x_ && b.min_.x_ < a.max_.x_ && a.min_.y_ < b.max_.y_ && b.min_.y_ < a.max_.y_;
+}
+
 StringHash VAR_ORIGIN("Origin");
 const StringHash VAR_ORIGINAL_PARENT("OriginalParent");
 const StringHash VAR_ORIGINAL_CHILD_INDEX("OriginalChildIndex");
@@ -86,6 +96,9 @@ const float DEFAULT_DRAGBEGIN_INTERVAL = 0.5f;
 const float DEFAULT_TOOLTIP_DELAY = 0.5f;
 const int DEFAULT_DRAGBEGIN_DISTANCE = 5;
 const int DEFAULT_FONT_TEXTURE_MAX_SIZE = 2048;
+const int DEFAULT_MAX_ATLAS_TEXTURE_SIZE = 256;
+/// Maximum number of batches a batch may be moved back to merge with an earlier batch.
+const unsigned MAX_BATCH_MERGE_DISTANCE = 64;
 
 const char* UI_CATEGORY = "UI";
 
@@ -102,6 +115,7 @@ UI::UI(Context* context) :
     maxDoubleClickDist_(M_LARGE_VALUE),
     qualifiers_(0),
     maxFontTextureSize_(DEFAULT_FONT_TEXTURE_MAX_SIZE),
+    maxFontTextures_(2),
     initialized_(false),
     usingTouchInput_(false),
 #ifdef _WIN32
@@ -117,6 +131,7 @@ UI::UI(Context* context) :
 #endif
     useMutableGlyphs_(false),
     forceAutoHint_(false),
+    fontAsyncRasterization_(false),
     fontHintLevel_(FONT_HINT_LEVEL_NORMAL),
     fontSubpixelThreshold_(12),
     fontOversampling_(2),
@@ -125,13 +140,22 @@ UI::UI(Context* context) :
     dragElementsCount_(0),
     dragConfirmedCount_(0),
     uiScale_(1.0f),
-    customSize_(IntVector2::ZERO)
+    customSize_(IntVector2::ZERO),
+    deferredLayout_(false),
+    updatingLayouts_(false),
+    layoutElement_(nullptr),
+    hitTestRevision_(0),
+    hitTestCellSize_(0),
+    hitTestDirty_(true),
+    textureAtlasSize_(0),
+    maxAtlasTextureSize_(DEFAULT_MAX_ATLAS_TEXTURE_SIZE),
+    textureAtlasRevision_(0)
 {
     rootElement_->SetTraversalMode(TM_DEPTH_FIRST);
     rootModalElement_->SetTraversalMode(TM_DEPTH_FIRST);
 
     // Register UI library object factories
-    RegisterUILibrary(context_);
+    context_->RegisterLibrary("UI", RegisterUILibrary);
 
     SubscribeToEvent(E_SCREENMODE, URHO3D_HANDLER(UI, HandleScreenMode));
     SubscribeToEvent(E_MOUSEBUTTONDOWN, URHO3D_HANDLER(UI, HandleMouseButtonDown));
@@ -206,6 +230,7 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     {
         UIElement* oldFocusElement = focusElement_;
         focusElement_.Reset();
+        oldFocusElement->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Defocused::P_ELEMENT] = oldFocusElement;
@@ -216,6 +241,7 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     if (element && element->GetFocusMode() >= FM_FOCUSABLE)
     {
         focusElement_ = element;
+        element->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Focused::P_ELEMENT] = element;
@@ -316,6 +342,10 @@ void UI::Update(float timeStep)
     assert(rootElement_ && rootModalElement_);
 
     URHO3D_PROFILE(UpdateUI);
+    AllocationTagScope allocationTag(ALLOCTAG_UI);
+
+    // Lay out the changes made since the last frame, so that input hits the current layout
+    UpdateLayouts();
 
     // Expire hovers
     for (HashMap<WeakPtr<UIElement>, bool>::Iterator i = hoveredElements_.Begin(); i != hoveredElements_.End(); ++i)
@@ -387,6 +417,10 @@ void UI::Update(float timeStep)
     // End hovers that expired without refreshing
     for (HashMap<WeakPtr<UIElement>, bool>::Iterator i = hoveredElements_.Begin(); i != hoveredElements_.End();)
     {
+        // Batches of hovered elements depend on their hover flag, which is refreshed each frame
+        if (i->first_)
+            i->first_->MarkBatchesDirty();
+
         if (i->first_.Expired() || !i->second_)
         {
             UIElement* element = i->first_;
@@ -413,9 +447,17 @@ void UI::RenderUpdate()
     assert(rootElement_ && rootModalElement_ && graphics_);
 
     URHO3D_PROFILE(GetUIBatches);
+    AllocationTagScope allocationTag(ALLOCTAG_UI);
 
     uiRendered_ = false;
 
+    // Lay out the changes made by the update event handlers
+    UpdateLayouts();
+
+    // Recreate the texture atlas after a size change, before batches referring to it are generated
+    if (textureAtlas_ && textureAtlas_->GetWidth() != textureAtlasSize_)
+        textureAtlas_.Reset();
+
     // If the OS cursor is visible, do not render the UI's own cursor
     bool osCursorVisible = GetSubsystem<Input>()->IsMouseVisible();
 
@@ -443,6 +485,8 @@ void UI::RenderUpdate()
         GetBatches(batches_, vertexData_, cursor_, currentScissor);
     }
 
+    nonModalBatchSize_ = MergeBatches(batches_, vertexData_, nonModalBatchSize_);
+
     // Get batches for UI elements rendered into textures. Each element rendered into texture is treated as root element.
     for (auto it = renderToTexture_.Begin(); it != renderToTexture_.End();)
     {
@@ -463,6 +507,7 @@ void UI::RenderUpdate()
             // Note: the scissors operate on unscaled coordinates. Scissor scaling is only performed during render
             IntRect scissor = IntRect(pos.x_, pos.y_, pos.x_ + size.x_, pos.y_ + size.y_);
             GetBatches(data.batches_, data.vertexData_, element, scissor);
+            MergeBatches(data.batches_, data.vertexData_, data.batches_.Size());
 
             // UIElement does not have anything to show. Insert dummy batch that will clear the texture.
             if (data.batches_.Empty())
@@ -480,6 +525,7 @@ void UI::RenderUpdate()
 void UI::Render(bool renderUICommand)
 {
     URHO3D_PROFILE(RenderUI);
+    AllocationTagScope allocationTag(ALLOCTAG_UI);
 
     // If the OS cursor is visible, apply its shape now if changed
     if (!renderUICommand)
@@ -670,6 +716,16 @@ void UI::SetMaxFontTextureSize(int size)
     }
 }
 
+void UI::SetMaxFontTextures(unsigned count)
+{
+    count = Max(count, 1U);
+    if (count != maxFontTextures_)
+    {
+        maxFontTextures_ = count;
+        ReleaseFontFaces();
+    }
+}
+
 void UI::SetNonFocusedMouseWheel(bool nonFocusedMouseWheel)
 {
     nonFocusedMouseWheel_ = nonFocusedMouseWheel;
@@ -694,6 +750,15 @@ void UI::SetUseMutableGlyphs(bool enable)
     }
 }
 
+void UI::SetFontAsyncRasterization(bool enable)
+{
+    if (enable != fontAsyncRasterization_)
+    {
+        fontAsyncRasterization_ = enable;
+        ReleaseFontFaces();
+    }
+}
+
 void UI::SetForceAutoHint(bool enable)
 {
     if (enable != forceAutoHint_)
@@ -763,6 +828,207 @@ void UI::SetCustomSize(int width, int height)
     ResizeRootElement();
 }
 
+void UI::SetDeferredLayout(bool enable)
+{
+    if (enable == deferredLayout_)
+        return;
+
+    // Perform the pending updates before the elements start updating their layout immediately
+    if (!enable)
+        UpdateLayouts();
+    deferredLayout_ = enable;
+}
+
+void UI::UpdateLayouts()
+{
+    if (layoutQueue_.Empty() || updatingLayouts_)
+        return;
+
+    URHO3D_PROFILE(UpdateUILayouts);
+
+    // Update children before their parents, so that the parents lay out with the children's new minimum sizes.
+    // When a child resizes, the update of a queued parent is skipped until the parent's own turn
+    Vector<Pair<unsigned, WeakPtr<UIElement> > > elements;
+    elements.Reserve(layoutQueue_.Size());
+    for (unsigned i = 0; i < layoutQueue_.Size(); ++i)
+    {
+        UIElement* element = layoutQueue_[i];
+        if (!element)
+            continue;
+
+        unsigned depth = 0;
+        for (UIElement* parent = element->GetParent(); parent; parent = parent->GetParent())
+            ++depth;
+        elements.Push(MakePair(depth, layoutQueue_[i]));
+    }
+    layoutQueue_.Clear();
+    Sort(elements.Begin(), elements.End());
+
+    // Elements that are not queued, for example children resized by their parent, update their layout immediately
+    updatingLayouts_ = true;
+    for (unsigned i = elements.Size() - 1; i < elements.Size(); --i)
+    {
+        UIElement* element = elements[i].second_;
+        if (element && element->IsLayoutQueued())
+        {
+            layoutElement_ = element;
+            element->UpdateLayout();
+        }
+    }
+    layoutElement_ = nullptr;
+    updatingLayouts_ = false;
+}
+
+bool UI::QueueLayoutUpdate(UIElement* element)
+{
+    if (!deferredLayout_ || updatingLayouts_ || !element)
+        return false;
+
+    // Elements outside the UI hierarchy are not updated by the UI, so they update immediately
+    UIElement* root = element->GetRoot();
+    if (!root)
+        root = element;
+    if (root != rootElement_ && root != rootModalElement_)
+        return false;
+
+    layoutQueue_.Push(WeakPtr<UIElement>(element));
+    return true;
+}
+
+void UI::SetHitTestCellSize(int size)
+{
+    size = Max(size, 0);
+    if (size == hitTestCellSize_)
+        return;
+
+    hitTestCellSize_ = size;
+    hitTestDirty_ = true;
+    if (!size)
+    {
+        hitTestEntries_.Clear();
+        hitTestCellStart_.Clear();
+        hitTestCellEntries_.Clear();
+    }
+}
+
+void UI::SetTextureAtlasSize(int size)
+{
+    size = Max(size, 0);
+    if (size && !IsPowerOfTwo((unsigned)size))
+    {
+        URHO3D_LOGERROR("UI texture atlas size must be a power of two");
+        return;
+    }
+    if (size == textureAtlasSize_)
+        return;
+
+    // The atlas texture is recreated on the next render update, when no batches refer to it
+    textureAtlasSize_ = size;
+    ClearTextureAtlas();
+}
+
+void UI::SetMaxAtlasTextureSize(int size)
+{
+    size = Max(size, 1);
+    if (size == maxAtlasTextureSize_)
+        return;
+
+    maxAtlasTextureSize_ = size;
+    ClearTextureAtlas();
+}
+
+void UI::ClearTextureAtlas()
+{
+    for (HashMap<WeakPtr<Texture>, IntVector2>::ConstIterator i = textureAtlasOffsets_.Begin(); i != textureAtlasOffsets_.End(); ++i)
+    {
+        if (i->first_ && i->second_.x_ >= 0)
+            UnsubscribeFromEvent(i->first_.Get(), E_RELOADFINISHED);
+    }
+
+    textureAtlasOffsets_.Clear();
+    textureAtlasAllocator_.Reset(textureAtlasSize_, textureAtlasSize_, 0, 0, false);
+    // Invalidate the cached batches that refer to atlas regions
+    ++textureAtlasRevision_;
+}
+
+Texture2D* UI::GetAtlasTexture(Texture* texture, IntVector2& offset)
+{
+    if (!textureAtlasSize_ || !texture || !graphics_)
+        return nullptr;
+
+    // Start over if the atlas contents have been lost along with the graphics context
+    if (textureAtlas_ && textureAtlas_->IsDataLost())
+    {
+        textureAtlas_->ClearDataLost();
+        ClearTextureAtlas();
+    }
+
+    WeakPtr<Texture> key(texture);
+    HashMap<WeakPtr<Texture>, IntVector2>::ConstIterator i = textureAtlasOffsets_.Find(key);
+    if (i != textureAtlasOffsets_.End())
+    {
+        offset = i->second_;
+        return offset.x_ >= 0 ? textureAtlas_.Get() : nullptr;
+    }
+
+    // Copy only textures that can be read back from their source image and have no sampling state the atlas would change
+    int width = texture->GetWidth();
+    int height = texture->GetHeight();
+    const String& name = texture->GetName();
+    SharedPtr<Image> image;
+    if (texture->GetType() == Texture2D::GetTypeStatic() && !name.Empty() && GetExtension(name) != ".xml" &&
+        !texture->GetSRGB() && texture->GetFilterMode() != FILTER_NEAREST && width <= maxAtlasTextureSize_ &&
+        height <= maxAtlasTextureSize_)
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+        if (cache->Exists(name))
+            image = cache->GetTempResource<Image>(name, false);
+    }
+    if (image && (image->IsCompressed() || image->GetDepth() > 1 || image->GetComponents() < 3 || image->GetWidth() != width ||
+        image->GetHeight() != height))
+        image.Reset();
+    if (image && image->GetComponents() != 4)
+        image = image->ConvertToRGBA();
+
+    IntVector2 position(-1, -1);
+    if (image)
+    {
+        if (!textureAtlas_)
+        {
+            textureAtlas_ = new Texture2D(context_);
+            textureAtlas_->SetNumLevels(1);
+            textureAtlas_->SetFilterMode(FILTER_BILINEAR);
+            textureAtlas_->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+            textureAtlas_->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+            if (!textureAtlas_->SetSize(textureAtlasSize_, textureAtlasSize_, Graphics::GetRGBAFormat()))
+                textureAtlas_.Reset();
+        }
+
+        // Surround the region with a border of repeated edge texels, so that filtering does not blend in the neighbors
+        int x, y;
+        if (textureAtlas_ && textureAtlasAllocator_.Allocate(width + 2, height + 2, x, y))
+        {
+            const auto* src = reinterpret_cast<const unsigned*>(image->GetData());
+            PODVector<unsigned> data((unsigned)((width + 2) * (height + 2)));
+            unsigned* dest = data.Buffer();
+            for (int dy = 0; dy < height + 2; ++dy)
+            {
+                const unsigned* srcRow = src + Clamp(dy - 1, 0, height - 1) * width;
+                for (int dx = 0; dx < width + 2; ++dx)
+                    *dest++ = srcRow[Clamp(dx - 1, 0, width - 1)];
+            }
+
+            textureAtlas_->SetData(0, x, y, width + 2, height + 2, data.Buffer());
+            position = IntVector2(x + 1, y + 1);
+            SubscribeToEvent(texture, E_RELOADFINISHED, URHO3D_HANDLER(UI, HandleAtlasTextureReloaded));
+        }
+    }
+
+    textureAtlasOffsets_[key] = position;
+    offset = position;
+    return position.x_ >= 0 ? textureAtlas_.Get() : nullptr;
+}
+
 IntVector2 UI::GetCursorPosition() const
 {
     return cursor_ ? cursor_->GetPosition() : GetSubsystem<Input>()->GetMousePosition();
@@ -833,6 +1099,9 @@ UIElement* UI::GetElementAt(UIElement* root, const IntVector2& position, bool en
             positionCopy.y_ = rootPos.y_ + ((positionCopy.y_ - rootPos.y_) % rootSize.y_);
     }
 
+    if (root == rootElement_ && hitTestCellSize_ > 0)
+        return GetElementAtGrid(positionCopy, enabledOnly);
+
     UIElement* result = nullptr;
     GetElementAt(result, root, positionCopy, enabledOnly);
     return result;
@@ -970,7 +1239,7 @@ void UI::SetVertexData(VertexBuffer* dest, const PODVector<float>& vertexData)
     // Resize the vertex buffer first if too small or much too large
     unsigned numVertices = vertexData.Size() / UI_VERTEX_SIZE;
     if (dest->GetVertexCount() < numVertices || dest->GetVertexCount() > numVertices * 2)
-        dest->SetSize(numVertices, MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1, true);
+        dest->SetSize(numVertices, UIBatch::GetVertexElements(), true);
 
     dest->SetData(&vertexData[0]);
 }
@@ -1024,12 +1293,13 @@ void UI::Render(VertexBuffer* buffer, const PODVector<UIBatch>& batches, unsigne
     graphics_->SetStencilTest(false);
     graphics_->SetVertexBuffer(buffer);
 
-    ShaderVariation* noTextureVS = graphics_->GetShader(VS, "Basic", "VERTEXCOLOR");
-    ShaderVariation* diffTextureVS = graphics_->GetShader(VS, "Basic", "DIFFMAP VERTEXCOLOR");
-    ShaderVariation* noTexturePS = graphics_->GetShader(PS, "Basic", "VERTEXCOLOR");
-    ShaderVariation* diffTexturePS = graphics_->GetShader(PS, "Basic", "DIFFMAP VERTEXCOLOR");
-    ShaderVariation* diffMaskTexturePS = graphics_->GetShader(PS, "Basic", "DIFFMAP ALPHAMASK VERTEXCOLOR");
-    ShaderVariation* alphaTexturePS = graphics_->GetShader(PS, "Basic", "ALPHAMAP VERTEXCOLOR");
+    // The default shaders clip to the batch scissor rect stored in the vertices, so that batches with different scissors merge
+    ShaderVariation* noTextureVS = graphics_->GetShader(VS, "Basic", "VERTEXCOLOR CLIPRECT");
+    ShaderVariation* diffTextureVS = graphics_->GetShader(VS, "Basic", "DIFFMAP VERTEXCOLOR CLIPRECT");
+    ShaderVariation* noTexturePS = graphics_->GetShader(PS, "Basic", "VERTEXCOLOR CLIPRECT");
+    ShaderVariation* diffTexturePS = graphics_->GetShader(PS, "Basic", "DIFFMAP VERTEXCOLOR CLIPRECT");
+    ShaderVariation* diffMaskTexturePS = graphics_->GetShader(PS, "Basic", "DIFFMAP ALPHAMASK VERTEXCOLOR CLIPRECT");
+    ShaderVariation* alphaTexturePS = graphics_->GetShader(PS, "Basic", "ALPHAMAP VERTEXCOLOR CLIPRECT");
 
 
     for (unsigned i = batchStart; i < batchEnd; ++i)
@@ -1093,30 +1363,33 @@ void UI::Render(VertexBuffer* buffer, const PODVector<UIBatch>& batches, unsigne
         graphics_->SetShaderParameter(VSP_ELAPSEDTIME, elapsedTime);
         graphics_->SetShaderParameter(PSP_ELAPSEDTIME, elapsedTime);
 
-        IntRect scissor = batch.scissor_;
-        scissor.left_ = (int)(scissor.left_ * uiScale_);
-        scissor.top_ = (int)(scissor.top_ * uiScale_);
-        scissor.right_ = (int)(scissor.right_ * uiScale_);
-        scissor.bottom_ = (int)(scissor.bottom_ * uiScale_);
-
-        // Flip scissor vertically if using OpenGL texture rendering
-#ifdef URHO3D_OPENGL
-        if (surface)
-        {
-            int top = scissor.top_;
-            int bottom = scissor.bottom_;
-            scissor.top_ = viewSize.y_ - bottom;
-            scissor.bottom_ = viewSize.y_ - top;
-        }
-#endif
-
         graphics_->SetBlendMode(batch.blendMode_);
-        graphics_->SetScissorTest(true, scissor);
         if (!batch.custom_material_)
         {
+            graphics_->SetScissorTest(false);
             graphics_->SetTexture(0, batch.texture_);
         } else
         {
+            // Custom shaders do not clip to the vertex clip rect, so use the scissor test
+            IntRect scissor = batch.scissor_;
+            scissor.left_ = (int)(scissor.left_ * uiScale_);
+            scissor.top_ = (int)(scissor.top_ * uiScale_);
+            scissor.right_ = (int)(scissor.right_ * uiScale_);
+            scissor.bottom_ = (int)(scissor.bottom_ * uiScale_);
+
+            // Flip scissor vertically if using OpenGL texture rendering
+#ifdef URHO3D_OPENGL
+            if (surface)
+            {
+                int top = scissor.top_;
+                int bottom = scissor.bottom_;
+                scissor.top_ = viewSize.y_ - bottom;
+                scissor.bottom_ = viewSize.y_ - top;
+            }
+#endif
+
+            graphics_->SetScissorTest(true, scissor);
+
             // Update custom shader parameters if needed
             if (graphics_->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(batch.custom_material_->GetShaderParameterHash())))
             {
@@ -1150,6 +1423,44 @@ void UI::Render(VertexBuffer* buffer, const PODVector<UIBatch>& batches, unsigne
 }
 
 void UI::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, UIElement* element, IntRect currentScissor)
+{
+    UIBatchCache* cache = element->GetBatchCache();
+    if (!cache)
+    {
+        GetChildBatches(batches, vertexData, element, currentScissor);
+        return;
+    }
+
+    // Regenerate the cached child batches only after a change in the subtree, in the scissor given by the parents or in the
+    // texture atlas
+    if (cache->dirty_ || cache->scissor_ != currentScissor || cache->textureAtlasRevision_ != textureAtlasRevision_)
+    {
+        cache->batches_.Clear();
+        cache->vertexData_.Clear();
+        GetChildBatches(cache->batches_, cache->vertexData_, element, currentScissor);
+        cache->scissor_ = currentScissor;
+        cache->textureAtlasRevision_ = textureAtlasRevision_;
+        cache->dirty_ = false;
+    }
+
+    unsigned vertexOffset = vertexData.Size();
+    if (!cache->vertexData_.Empty())
+    {
+        vertexData.Resize(vertexOffset + cache->vertexData_.Size());
+        memcpy(&vertexData[vertexOffset], cache->vertexData_.Buffer(), cache->vertexData_.Size() * sizeof(float));
+    }
+
+    for (unsigned i = 0; i < cache->batches_.Size(); ++i)
+    {
+        UIBatch batch = cache->batches_[i];
+        batch.vertexData_ = &vertexData;
+        batch.vertexStart_ += vertexOffset;
+        batch.vertexEnd_ += vertexOffset;
+        UIBatch::AddOrMerge(batch, batches);
+    }
+}
+
+void UI::GetChildBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, UIElement* element, IntRect currentScissor)
 {
     // Set clipping scissor for child elements. No need to draw if zero size
     element->AdjustScissor(currentScissor);
@@ -1202,6 +1513,101 @@ void UI::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, U
     }
 }
 
+unsigned UI::MergeBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, unsigned splitIndex)
+{
+    if (batches.Size() < 2)
+        return splitIndex;
+
+    URHO3D_PROFILE(MergeUIBatches);
+
+    mergedBatches_.Clear();
+    mergedBatchBounds_.Clear();
+    batchMergeIndices_.Resize(batches.Size());
+    unsigned newSplitIndex = M_MAX_UNSIGNED;
+    unsigned firstMergeIndex = 0;
+
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        // The batches before and after the split index are drawn separately, so do not merge across it
+        if (i == splitIndex)
+        {
+            newSplitIndex = mergedBatches_.Size();
+            firstMergeIndex = newSplitIndex;
+        }
+
+        const UIBatch& batch = batches[i];
+        Rect bounds;
+        for (unsigned j = batch.vertexStart_; j < batch.vertexEnd_; j += UI_VERTEX_SIZE)
+            bounds.Merge(Vector2(vertexData[j], vertexData[j + 1]));
+
+        // Search back for a batch with the same render state. Drawing the batch together with it moves the batch before the
+        // batches in between, which keeps the result the same only if none of them overlap the batch
+        unsigned numMerged = mergedBatches_.Size();
+        unsigned searchEnd = Max(firstMergeIndex, numMerged > MAX_BATCH_MERGE_DISTANCE ? numMerged - MAX_BATCH_MERGE_DISTANCE : 0);
+        unsigned mergeIndex = M_MAX_UNSIGNED;
+        for (unsigned j = numMerged; j > searchEnd; --j)
+        {
+            if (mergedBatches_[j - 1].CanMerge(batch))
+            {
+                mergeIndex = j - 1;
+                break;
+            }
+            if (RectsOverlap(mergedBatchBounds_[j - 1], bounds))
+                break;
+        }
+
+        // Count the vertex data of the merged batches in their end index until the vertex data is laid out
+        unsigned dataSize = batch.vertexEnd_ - batch.vertexStart_;
+        if (mergeIndex == M_MAX_UNSIGNED)
+        {
+            mergeIndex = numMerged;
+            mergedBatches_.Push(batch);
+            mergedBatches_.Back().vertexStart_ = 0;
+            mergedBatches_.Back().vertexEnd_ = dataSize;
+            mergedBatchBounds_.Push(bounds);
+        }
+        else
+        {
+            mergedBatches_[mergeIndex].vertexEnd_ += dataSize;
+            mergedBatchBounds_[mergeIndex].Merge(bounds);
+        }
+        batchMergeIndices_[i] = mergeIndex;
+    }
+
+    if (newSplitIndex == M_MAX_UNSIGNED)
+        newSplitIndex = mergedBatches_.Size();
+    // Keep the vertex data as is if nothing was merged
+    if (mergedBatches_.Size() == batches.Size())
+        return splitIndex;
+
+    unsigned vertexStart = 0;
+    for (unsigned i = 0; i < mergedBatches_.Size(); ++i)
+    {
+        UIBatch& merged = mergedBatches_[i];
+        unsigned dataSize = merged.vertexEnd_;
+        merged.vertexData_ = &vertexData;
+        merged.vertexStart_ = vertexStart;
+        merged.vertexEnd_ = vertexStart;
+        vertexStart += dataSize;
+    }
+
+    // Copy the vertex data of each batch to the end of its merged batch, in the original order
+    mergedVertexData_.Resize(vertexStart);
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        const UIBatch& batch = batches[i];
+        UIBatch& merged = mergedBatches_[batchMergeIndices_[i]];
+        unsigned dataSize = batch.vertexEnd_ - batch.vertexStart_;
+        if (dataSize)
+            memcpy(&mergedVertexData_[merged.vertexEnd_], &vertexData[batch.vertexStart_], dataSize * sizeof(float));
+        merged.vertexEnd_ += dataSize;
+    }
+
+    batches.Swap(mergedBatches_);
+    vertexData.Swap(mergedVertexData_);
+    return newSplitIndex;
+}
+
 void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly)
 {
     if (!current)
@@ -1275,6 +1681,124 @@ void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2&
     }
 }
 
+UIElement* UI::GetElementAtGrid(const IntVector2& position, bool enabledOnly)
+{
+    UpdateHitTestGrid();
+
+    if (position.x_ < hitTestRect_.left_ || position.y_ < hitTestRect_.top_ || position.x_ >= hitTestRect_.right_ ||
+        position.y_ >= hitTestRect_.bottom_)
+        return nullptr;
+
+    int x = (position.x_ - hitTestRect_.left_) / hitTestCellSize_;
+    int y = (position.y_ - hitTestRect_.top_) / hitTestCellSize_;
+    unsigned cell = (unsigned)(y * hitTestNumCells_.x_ + x);
+
+    // The entries are in traversal order, so the last match is the topmost element, like in the recursive search
+    for (unsigned i = hitTestCellStart_[cell + 1]; i-- > hitTestCellStart_[cell];)
+    {
+        const HitTestEntry& entry = hitTestEntries_[hitTestCellEntries_[i]];
+        if (position.x_ >= entry.rect_.left_ && position.y_ >= entry.rect_.top_ && position.x_ < entry.rect_.right_ &&
+            position.y_ < entry.rect_.bottom_ && (entry.element_->IsEnabled() || !enabledOnly))
+            return entry.element_;
+    }
+
+    return nullptr;
+}
+
+void UI::UpdateHitTestGrid()
+{
+    if (!hitTestDirty_ && hitTestRoot_ == rootElement_ && hitTestRevision_ == rootElement_->GetHitTestRevision())
+        return;
+
+    hitTestDirty_ = false;
+    hitTestRoot_ = rootElement_;
+    hitTestRevision_ = rootElement_->GetHitTestRevision();
+
+    const IntVector2& rootPos = rootElement_->GetScreenPosition();
+    const IntVector2& rootSize = rootElement_->GetSize();
+    hitTestRect_ = IntRect(rootPos.x_, rootPos.y_, rootPos.x_ + Max(rootSize.x_, 0), rootPos.y_ + Max(rootSize.y_, 0));
+    hitTestNumCells_.x_ = Max((hitTestRect_.Width() + hitTestCellSize_ - 1) / hitTestCellSize_, 1);
+    hitTestNumCells_.y_ = Max((hitTestRect_.Height() + hitTestCellSize_ - 1) / hitTestCellSize_, 1);
+
+    hitTestEntries_.Clear();
+    GetHitTestEntries(rootElement_, hitTestRect_);
+
+    // Count the entries of each cell, then store the entry indices in traversal order
+    unsigned numCells = (unsigned)(hitTestNumCells_.x_ * hitTestNumCells_.y_);
+    hitTestCellStart_.Resize(numCells + 1);
+    for (unsigned i = 0; i <= numCells; ++i)
+        hitTestCellStart_[i] = 0;
+
+    for (unsigned i = 0; i < hitTestEntries_.Size(); ++i)
+    {
+        const IntRect& rect = hitTestEntries_[i].rect_;
+        int left = (rect.left_ - hitTestRect_.left_) / hitTestCellSize_;
+        int right = (rect.right_ - 1 - hitTestRect_.left_) / hitTestCellSize_;
+        int top = (rect.top_ - hitTestRect_.top_) / hitTestCellSize_;
+        int bottom = (rect.bottom_ - 1 - hitTestRect_.top_) / hitTestCellSize_;
+        for (int y = top; y <= bottom; ++y)
+        {
+            for (int x = left; x <= right; ++x)
+                ++hitTestCellStart_[y * hitTestNumCells_.x_ + x + 1];
+        }
+    }
+
+    for (unsigned i = 1; i <= numCells; ++i)
+        hitTestCellStart_[i] += hitTestCellStart_[i - 1];
+
+    hitTestCellEntries_.Resize(hitTestCellStart_[numCells]);
+    PODVector<unsigned> cellFill(hitTestCellStart_.Buffer(), numCells);
+    for (unsigned i = 0; i < hitTestEntries_.Size(); ++i)
+    {
+        const IntRect& rect = hitTestEntries_[i].rect_;
+        int left = (rect.left_ - hitTestRect_.left_) / hitTestCellSize_;
+        int right = (rect.right_ - 1 - hitTestRect_.left_) / hitTestCellSize_;
+        int top = (rect.top_ - hitTestRect_.top_) / hitTestCellSize_;
+        int bottom = (rect.bottom_ - 1 - hitTestRect_.top_) / hitTestCellSize_;
+        for (int y = top; y <= bottom; ++y)
+        {
+            for (int x = left; x <= right; ++x)
+                hitTestCellEntries_[cellFill[y * hitTestNumCells_.x_ + x]++] = i;
+        }
+    }
+}
+
+void UI::GetHitTestEntries(UIElement* element, const IntRect& clipRect)
+{
+    element->SortChildren();
+    const Vector<SharedPtr<UIElement> >& children = element->GetChildren();
+
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        UIElement* child = children[i];
+        if (child == cursor_.Get() || !child->IsVisible())
+            continue;
+
+        const IntVector2& screenPos = child->GetScreenPosition();
+        const IntVector2& size = child->GetSize();
+        IntRect rect(Max(screenPos.x_, clipRect.left_), Max(screenPos.y_, clipRect.top_),
+            Min(screenPos.x_ + size.x_, clipRect.right_), Min(screenPos.y_ + size.y_, clipRect.bottom_));
+        bool hasArea = rect.left_ < rect.right_ && rect.top_ < rect.bottom_;
+
+        if (hasArea)
+        {
+            HitTestEntry entry;
+            entry.element_ = child;
+            entry.rect_ = rect;
+            hitTestEntries_.Push(entry);
+        }
+
+        // Children of a clipping element can only be hit inside it
+        if (child->GetNumChildren())
+        {
+            if (!child->GetClipChildren())
+                GetHitTestEntries(child, clipRect);
+            else if (hasArea)
+                GetHitTestEntries(child, rect);
+        }
+    }
+}
+
 UIElement* UI::GetFocusableElement(UIElement* element)
 {
     while (element)
@@ -2072,6 +2596,12 @@ void UI::HandleDropFile(StringHash eventType, VariantMap& eventData)
     }
 }
 
+void UI::HandleAtlasTextureReloaded(StringHash eventType, VariantMap& eventData)
+{
+    // The reloaded texture may not fit its old region, so copy all textures again
+    ClearTextureAtlas();
+}
+
 HashMap<WeakPtr<UIElement>, UI::DragData*>::Iterator UI::DragElementErase(HashMap<WeakPtr<UIElement>, UI::DragData*>::Iterator i)
 {
     // If running the engine frame in response to an event (re-entering UI frame logic) the dragElements_ may already be empty
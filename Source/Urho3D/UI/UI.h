@@ -24,6 +24,7 @@
 
 #include "../Core/Object.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../Math/AreaAllocator.h"
 #include "../UI/Cursor.h"
 #include "../UI/UIBatch.h"
 
@@ -102,14 +103,18 @@ public:
     void SetDefaultToolTipDelay(float delay);
     /// Set maximum font face texture size. Must be a power of two. Default is 2048.
     void SetMaxFontTextureSize(int size);
+    /// Set maximum number of glyph atlas textures per font when using mutable glyphs. Default is 2.
+    void SetMaxFontTextures(unsigned count);
     /// Set whether mouse wheel can control also a non-focused element.
     void SetNonFocusedMouseWheel(bool nonFocusedMouseWheel);
     /// Set whether to use system clipboard. Default false.
     void SetUseSystemClipboard(bool enable);
     /// Set whether to show the on-screen keyboard (if supported) when a %LineEdit is focused. Default true on mobile devices.
     void SetUseScreenKeyboard(bool enable);
-    /// Set whether to use mutable (eraseable) glyphs to ensure a font face never expands to more than one texture. Default false.
+    /// Set whether to use mutable (eraseable) glyphs. Glyphs are then rasterized when first used, into a glyph atlas shared by all sizes of a font, which clears its least recently used texture when full. Default false.
     void SetUseMutableGlyphs(bool enable);
+    /// Set whether mutable glyphs are rasterized in a worker thread. Until rasterized, text leaves space for the glyphs without rendering them. Default false.
+    void SetFontAsyncRasterization(bool enable);
     /// Set whether to force font autohinting instead of using FreeType's TTF bytecode interpreter.
     void SetForceAutoHint(bool enable);
     /// Set the hinting level used by FreeType fonts.
@@ -128,6 +133,20 @@ public:
     void SetCustomSize(const IntVector2& size);
     /// Set custom size of the root element.
     void SetCustomSize(int width, int height);
+    /// Set whether layout updates of elements in the %UI hierarchy are deferred and performed once per element before the %UI is updated and rendered, instead of on each change. Default false.
+    void SetDeferredLayout(bool enable);
+    /// Perform the deferred layout updates now. Call before reading sizes or positions that depend on layout changes made in the same frame.
+    void UpdateLayouts();
+    /// Queue a deferred layout update of an element. Return false if layout updates are not deferred for the element. Called by UIElement.
+    bool QueueLayoutUpdate(UIElement* element);
+    /// Set the cell size in pixels of the screen-space grid used to find the element at a position in the root element, or 0 to search the element hierarchy recursively. The grid is rebuilt on the first query after an element changes position, size, visibility or order. Default 0.
+    void SetHitTestCellSize(int size);
+    /// Set the width and height of the texture atlas into which small element textures are copied when first drawn, so that elements with different textures can be drawn in the same batch. Only 2D textures loaded from uncompressed RGB or RGBA images are copied. Must be a power of two, or 0 to disable. Default 0.
+    void SetTextureAtlasSize(int size);
+    /// Set the maximum width and height of a texture to be copied into the texture atlas. Default 256.
+    void SetMaxAtlasTextureSize(int size);
+    /// Clear the texture atlas. The textures are copied again when next drawn. Called automatically when a copied texture is reloaded.
+    void ClearTextureAtlas();
 
     /// Return root UI element.
     UIElement* GetRoot() const { return rootElement_; }
@@ -181,6 +200,9 @@ public:
     /// Return font texture maximum size.
     int GetMaxFontTextureSize() const { return maxFontTextureSize_; }
 
+    /// Return maximum number of glyph atlas textures per font.
+    unsigned GetMaxFontTextures() const { return maxFontTextures_; }
+
     /// Return whether mouse wheel can control also a non-focused element.
     bool IsNonFocusedMouseWheel() const { return nonFocusedMouseWheel_; }
 
@@ -196,6 +218,9 @@ public:
     /// Return whether is using forced autohinting.
     bool GetForceAutoHint() const { return forceAutoHint_; }
 
+    /// Return whether mutable glyphs are rasterized in a worker thread.
+    bool GetFontAsyncRasterization() const { return fontAsyncRasterization_; }
+
     /// Return the current FreeType font hinting level.
     FontHintLevel GetFontHintLevel() const { return fontHintLevel_; }
 
@@ -217,6 +242,27 @@ public:
     /// Return root element custom size. Returns 0,0 when custom size is not being used and automatic resizing according to window size is in use instead (default.)
     const IntVector2& GetCustomSize() const { return customSize_; }
 
+    /// Return whether layout updates are deferred.
+    bool GetDeferredLayout() const { return deferredLayout_; }
+
+    /// Return whether the deferred layout update of an element is being performed.
+    bool IsUpdatingLayout(UIElement* element) const { return layoutElement_ == element; }
+
+    /// Return the hit-test grid cell size, or 0 if not using the grid.
+    int GetHitTestCellSize() const { return hitTestCellSize_; }
+
+    /// Return the texture atlas size, or 0 if not using the atlas.
+    int GetTextureAtlasSize() const { return textureAtlasSize_; }
+
+    /// Return the maximum width and height of a texture to be copied into the texture atlas.
+    int GetMaxAtlasTextureSize() const { return maxAtlasTextureSize_; }
+
+    /// Return the texture atlas revision, which changes when the atlas is cleared.
+    unsigned GetTextureAtlasRevision() const { return textureAtlasRevision_; }
+
+    /// Return the texture atlas and the offset of a texture's region in it, copying the texture on first use. Return null if the texture is not atlased. Called by UIBatch.
+    Texture2D* GetAtlasTexture(Texture* texture, IntVector2& offset);
+
     /// Set texture to which element will be rendered.
     void SetElementRenderTexture(UIElement* element, Texture2D* texture);
 
@@ -259,6 +305,15 @@ private:
         SharedPtr<VertexBuffer> debugVertexBuffer_;
     };
 
+    /// Hit-test grid entry.
+    struct HitTestEntry
+    {
+        /// Element.
+        UIElement* element_;
+        /// Screen rect of the element clipped by its parents.
+        IntRect rect_;
+    };
+
     /// Initialize when screen mode initially set.
     void Initialize();
     /// Update UI element logic recursively.
@@ -267,12 +322,22 @@ private:
     void SetVertexData(VertexBuffer* dest, const PODVector<float>& vertexData);
     /// Render UI batches to the current rendertarget. Geometry must have been uploaded first.
     void Render(VertexBuffer* buffer, const PODVector<UIBatch>& batches, unsigned batchStart, unsigned batchEnd);
-    /// Generate batches from an UI element recursively. Skip the cursor element.
+    /// Generate batches from an UI element recursively, or reuse the element's cached child batches. Skip the cursor element.
     void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, UIElement* element, IntRect currentScissor);
+    /// Generate batches from the child elements of an UI element recursively. Skip the cursor element.
+    void GetChildBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, UIElement* element, IntRect currentScissor);
+    /// Merge each batch into an earlier batch with the same render state, if the batches between them do not overlap it, and reorder the vertex data to match. Batches are not moved across the split index. Return the new split index.
+    unsigned MergeBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, unsigned splitIndex);
     /// Return UI element at global screen coordinates. Return position converted to element's screen coordinates.
     UIElement* GetElementAt(const IntVector2& position, bool enabledOnly, IntVector2* elementScreenPosition);
     /// Return UI element at screen position recursively.
     void GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly);
+    /// Return the element at screen position in the root element using the hit-test grid.
+    UIElement* GetElementAtGrid(const IntVector2& position, bool enabledOnly);
+    /// Rebuild the hit-test grid if the root element hierarchy has changed.
+    void UpdateHitTestGrid();
+    /// Add the visible child elements of an element to the hit-test entries recursively in traversal order. Skip the cursor element.
+    void GetHitTestEntries(UIElement* element, const IntRect& clipRect);
     /// Return the first element in hierarchy that can alter focus.
     UIElement* GetFocusableElement(UIElement* element);
     /// Return cursor position and visibility either from the cursor element, or the Input subsystem.
@@ -330,6 +395,8 @@ private:
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a file being drag-dropped into the application window.
     void HandleDropFile(StringHash eventType, VariantMap& eventData);
+    /// Handle reload of a texture copied into the texture atlas.
+    void HandleAtlasTextureReloaded(StringHash eventType, VariantMap& eventData);
     /// Remove drag data and return next iterator.
     HashMap<WeakPtr<UIElement>, DragData*>::Iterator DragElementErase(HashMap<WeakPtr<UIElement>, DragData*>::Iterator i);
     /// Handle clean up on a drag cancel.
@@ -383,6 +450,8 @@ private:
     QualifierFlags qualifiers_;
     /// Font texture maximum size.
     int maxFontTextureSize_;
+    /// Maximum number of glyph atlas textures per font.
+    unsigned maxFontTextures_;
     /// Initialized flag.
     bool initialized_;
     /// Touch used flag.
@@ -397,6 +466,8 @@ private:
     bool useMutableGlyphs_;
     /// Flag for forcing FreeType auto hinting.
     bool forceAutoHint_;
+    /// Flag for rasterizing mutable glyphs in a worker thread.
+    bool fontAsyncRasterization_;
     /// FreeType hinting level (default is FONT_HINT_LEVEL_NORMAL).
     FontHintLevel fontHintLevel_;
     /// Maxmimum font size for subpixel glyph positioning and oversampling (default is 12).
@@ -433,6 +504,52 @@ private:
     IntVector2 customSize_;
     /// Elements that should be rendered to textures.
     HashMap<UIElement*, RenderToTextureData> renderToTexture_;
+    /// Elements with a deferred layout update.
+    Vector<WeakPtr<UIElement> > layoutQueue_;
+    /// Deferred layout flag.
+    bool deferredLayout_;
+    /// Flag for the deferred layout updates being performed.
+    bool updatingLayouts_;
+    /// Element whose deferred layout update is being performed.
+    UIElement* layoutElement_;
+    /// Hit-test grid entries in traversal order.
+    PODVector<HitTestEntry> hitTestEntries_;
+    /// Start index of each hit-test grid cell's entry indices, plus one for the end.
+    PODVector<unsigned> hitTestCellStart_;
+    /// Hit-test entry indices of the grid cells.
+    PODVector<unsigned> hitTestCellEntries_;
+    /// Screen rect covered by the hit-test grid.
+    IntRect hitTestRect_;
+    /// Number of hit-test grid cells.
+    IntVector2 hitTestNumCells_;
+    /// Root element the hit-test grid was built from.
+    WeakPtr<UIElement> hitTestRoot_;
+    /// Root element hit-test revision the grid was built from.
+    unsigned hitTestRevision_;
+    /// Hit-test grid cell size.
+    int hitTestCellSize_;
+    /// Hit-test grid dirty flag.
+    bool hitTestDirty_;
+    /// Texture atlas of small element textures.
+    SharedPtr<Texture2D> textureAtlas_;
+    /// Allocator of the texture atlas regions.
+    AreaAllocator textureAtlasAllocator_;
+    /// Region offsets of the textures that have been considered for the texture atlas, negative if not atlased.
+    HashMap<WeakPtr<Texture>, IntVector2> textureAtlasOffsets_;
+    /// Texture atlas size.
+    int textureAtlasSize_;
+    /// Maximum width and height of an atlased texture.
+    int maxAtlasTextureSize_;
+    /// Texture atlas revision.
+    unsigned textureAtlasRevision_;
+    /// Merged batch index of each batch, used when merging batches.
+    PODVector<unsigned> batchMergeIndices_;
+    /// Screen bounds of the merged batches, used when merging batches.
+    PODVector<Rect> mergedBatchBounds_;
+    /// Merged batches.
+    PODVector<UIBatch> mergedBatches_;
+    /// Vertex data of the merged batches.
+    PODVector<float> mergedVertexData_;
 };
 
 /// Register UI library objects.
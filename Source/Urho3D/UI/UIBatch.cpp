@@ -23,7 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Graphics/Graphics.h"
-#include "../Graphics/Texture.h"
+#include "../Graphics/Texture2D.h"
+#include "../UI/UI.h"
 #include "../UI/UIElement.h"
 
 #include "../DebugNew.h"
@@ -33,6 +34,25 @@ namespace Urho3D
 
 Vector3 UIBatch::posAdjust(0.0f, 0.0f, 0.0f);
 
+/// Write the clip rectangle of a batch to the six vertices of a quad.
+static void SetClipRect(float* dest, const IntRect& scissor)
+{
+    // The clip rectangle is adjusted like the vertex positions, so that it covers the same pixels as a scissor test would
+    float left = (float)scissor.left_ - UIBatch::posAdjust.x_;
+    float top = (float)scissor.top_ - UIBatch::posAdjust.y_;
+    float right = (float)scissor.right_ - UIBatch::posAdjust.x_;
+    float bottom = (float)scissor.bottom_ - UIBatch::posAdjust.y_;
+
+    for (unsigned i = 0; i < 6; ++i)
+    {
+        dest[6] = left;
+        dest[7] = top;
+        dest[8] = right;
+        dest[9] = bottom;
+        dest += UI_VERTEX_SIZE;
+    }
+}
+
 UIBatch::UIBatch()
 {
     SetDefaultColor();
@@ -51,6 +71,21 @@ UIBatch::UIBatch(UIElement* element, BlendMode blendMode, const IntRect& scissor
     SetDefaultColor();
 }
 
+void UIBatch::UseTextureAtlas()
+{
+    if (!texture_ || !element_ || custom_material_)
+        return;
+
+    IntVector2 offset;
+    Texture2D* atlasTexture = element_->GetSubsystem<UI>()->GetAtlasTexture(texture_, offset);
+    if (!atlasTexture)
+        return;
+
+    texture_ = atlasTexture;
+    invTextureSize_ = Vector2(1.0f / (float)atlasTexture->GetWidth(), 1.0f / (float)atlasTexture->GetHeight());
+    uvOffset_ = Vector2((float)offset.x_ * invTextureSize_.x_, (float)offset.y_ * invTextureSize_.y_);
+}
+
 void UIBatch::SetColor(const Color& color, bool overrideAlpha)
 {
     if (!element_)
@@ -105,10 +140,10 @@ void UIBatch::AddQuad(float x, float y, float width, float height, int texOffset
     float top = y + screenPos.y_ - posAdjust.x_;
     float bottom = top + height;
 
-    float leftUV = texOffsetX * invTextureSize_.x_;
-    float topUV = texOffsetY * invTextureSize_.y_;
-    float rightUV = (texOffsetX + (texWidth ? texWidth : width)) * invTextureSize_.x_;
-    float bottomUV = (texOffsetY + (texHeight ? texHeight : height)) * invTextureSize_.y_;
+    float leftUV = texOffsetX * invTextureSize_.x_ + uvOffset_.x_;
+    float topUV = texOffsetY * invTextureSize_.y_ + uvOffset_.y_;
+    float rightUV = (texOffsetX + (texWidth ? texWidth : width)) * invTextureSize_.x_ + uvOffset_.x_;
+    float bottomUV = (texOffsetY + (texHeight ? texHeight : height)) * invTextureSize_.y_ + uvOffset_.y_;
 
     unsigned begin = vertexData_->Size();
     vertexData_->Resize(begin + 6 * UI_VERTEX_SIZE);
@@ -122,40 +157,42 @@ void UIBatch::AddQuad(float x, float y, float width, float height, int texOffset
     dest[4] = leftUV;
     dest[5] = topUV;
 
-    dest[6] = right;
-    dest[7] = top;
-    dest[8] = 0.0f;
-    ((unsigned&)dest[9]) = topRightColor;
-    dest[10] = rightUV;
-    dest[11] = topUV;
-
-    dest[12] = left;
-    dest[13] = bottom;
-    dest[14] = 0.0f;
-    ((unsigned&)dest[15]) = bottomLeftColor;
-    dest[16] = leftUV;
-    dest[17] = bottomUV;
-
-    dest[18] = right;
-    dest[19] = top;
-    dest[20] = 0.0f;
-    ((unsigned&)dest[21]) = topRightColor;
-    dest[22] = rightUV;
-    dest[23] = topUV;
-
-    dest[24] = right;
-    dest[25] = bottom;
-    dest[26] = 0.0f;
-    ((unsigned&)dest[27]) = bottomRightColor;
-    dest[28] = rightUV;
-    dest[29] = bottomUV;
-
-    dest[30] = left;
-    dest[31] = bottom;
+    dest[10] = right;
+    dest[11] = top;
+    dest[12] = 0.0f;
+    ((unsigned&)dest[13]) = topRightColor;
+    dest[14] = rightUV;
+    dest[15] = topUV;
+
+    dest[20] = left;
+    dest[21] = bottom;
+    dest[22] = 0.0f;
+    ((unsigned&)dest[23]) = bottomLeftColor;
+    dest[24] = leftUV;
+    dest[25] = bottomUV;
+
+    dest[30] = right;
+    dest[31] = top;
     dest[32] = 0.0f;
-    ((unsigned&)dest[33]) = bottomLeftColor;
-    dest[34] = leftUV;
-    dest[35] = bottomUV;
+    ((unsigned&)dest[33]) = topRightColor;
+    dest[34] = rightUV;
+    dest[35] = topUV;
+
+    dest[40] = right;
+    dest[41] = bottom;
+    dest[42] = 0.0f;
+    ((unsigned&)dest[43]) = bottomRightColor;
+    dest[44] = rightUV;
+    dest[45] = bottomUV;
+
+    dest[50] = left;
+    dest[51] = bottom;
+    dest[52] = 0.0f;
+    ((unsigned&)dest[53]) = bottomLeftColor;
+    dest[54] = leftUV;
+    dest[55] = bottomUV;
+
+    SetClipRect(dest, scissor_);
 }
 
 void UIBatch::AddQuad(const Matrix3x4& transform, int x, int y, int width, int height, int texOffsetX, int texOffsetY,
@@ -187,10 +224,10 @@ void UIBatch::AddQuad(const Matrix3x4& transform, int x, int y, int width, int h
     Vector3 v3 = (transform * Vector3((float)x, (float)y + (float)height, 0.0f)) - posAdjust;
     Vector3 v4 = (transform * Vector3((float)x + (float)width, (float)y + (float)height, 0.0f)) - posAdjust;
 
-    float leftUV = ((float)texOffsetX) * invTextureSize_.x_;
-    float topUV = ((float)texOffsetY) * invTextureSize_.y_;
-    float rightUV = ((float)(texOffsetX + (texWidth ? texWidth : width))) * invTextureSize_.x_;
-    float bottomUV = ((float)(texOffsetY + (texHeight ? texHeight : height))) * invTextureSize_.y_;
+    float leftUV = ((float)texOffsetX) * invTextureSize_.x_ + uvOffset_.x_;
+    float topUV = ((float)texOffsetY) * invTextureSize_.y_ + uvOffset_.y_;
+    float rightUV = ((float)(texOffsetX + (texWidth ? texWidth : width))) * invTextureSize_.x_ + uvOffset_.x_;
+    float bottomUV = ((float)(texOffsetY + (texHeight ? texHeight : height))) * invTextureSize_.y_ + uvOffset_.y_;
 
     unsigned begin = vertexData_->Size();
     vertexData_->Resize(begin + 6 * UI_VERTEX_SIZE);
@@ -204,40 +241,42 @@ void UIBatch::AddQuad(const Matrix3x4& transform, int x, int y, int width, int h
     dest[4] = leftUV;
     dest[5] = topUV;
 
-    dest[6] = v2.x_;
-    dest[7] = v2.y_;
-    dest[8] = 0.0f;
-    ((unsigned&)dest[9]) = topRightColor;
-    dest[10] = rightUV;
-    dest[11] = topUV;
-
-    dest[12] = v3.x_;
-    dest[13] = v3.y_;
-    dest[14] = 0.0f;
-    ((unsigned&)dest[15]) = bottomLeftColor;
-    dest[16] = leftUV;
-    dest[17] = bottomUV;
-
-    dest[18] = v2.x_;
-    dest[19] = v2.y_;
-    dest[20] = 0.0f;
-    ((unsigned&)dest[21]) = topRightColor;
-    dest[22] = rightUV;
-    dest[23] = topUV;
-
-    dest[24] = v4.x_;
-    dest[25] = v4.y_;
-    dest[26] = 0.0f;
-    ((unsigned&)dest[27]) = bottomRightColor;
-    dest[28] = rightUV;
-    dest[29] = bottomUV;
-
-    dest[30] = v3.x_;
-    dest[31] = v3.y_;
+    dest[10] = v2.x_;
+    dest[11] = v2.y_;
+    dest[12] = 0.0f;
+    ((unsigned&)dest[13]) = topRightColor;
+    dest[14] = rightUV;
+    dest[15] = topUV;
+
+    dest[20] = v3.x_;
+    dest[21] = v3.y_;
+    dest[22] = 0.0f;
+    ((unsigned&)dest[23]) = bottomLeftColor;
+    dest[24] = leftUV;
+    dest[25] = bottomUV;
+
+    dest[30] = v2.x_;
+    dest[31] = v2.y_;
     dest[32] = 0.0f;
-    ((unsigned&)dest[33]) = bottomLeftColor;
-    dest[34] = leftUV;
-    dest[35] = bottomUV;
+    ((unsigned&)dest[33]) = topRightColor;
+    dest[34] = rightUV;
+    dest[35] = topUV;
+
+    dest[40] = v4.x_;
+    dest[41] = v4.y_;
+    dest[42] = 0.0f;
+    ((unsigned&)dest[43]) = bottomRightColor;
+    dest[44] = rightUV;
+    dest[45] = bottomUV;
+
+    dest[50] = v3.x_;
+    dest[51] = v3.y_;
+    dest[52] = 0.0f;
+    ((unsigned&)dest[53]) = bottomLeftColor;
+    dest[54] = leftUV;
+    dest[55] = bottomUV;
+
+    SetClipRect(dest, scissor_);
 }
 
 void UIBatch::AddQuad(int x, int y, int width, int height, int texOffsetX, int texOffsetY, int texWidth, int texHeight, bool tiled)
@@ -282,10 +321,10 @@ void UIBatch::AddQuad(const Matrix3x4& transform, const IntVector2& a, const Int
     Vector3 v3 = (transform * Vector3((float)c.x_, (float)c.y_, 0.0f)) - posAdjust;
     Vector3 v4 = (transform * Vector3((float)d.x_, (float)d.y_, 0.0f)) - posAdjust;
 
-    Vector2 uv1((float)texA.x_ * invTextureSize_.x_, (float)texA.y_ * invTextureSize_.y_);
-    Vector2 uv2((float)texB.x_ * invTextureSize_.x_, (float)texB.y_ * invTextureSize_.y_);
-    Vector2 uv3((float)texC.x_ * invTextureSize_.x_, (float)texC.y_ * invTextureSize_.y_);
-    Vector2 uv4((float)texD.x_ * invTextureSize_.x_, (float)texD.y_ * invTextureSize_.y_);
+    Vector2 uv1((float)texA.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texA.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv2((float)texB.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texB.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv3((float)texC.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texC.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv4((float)texD.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texD.y_ * invTextureSize_.y_ + uvOffset_.y_);
 
     unsigned begin = vertexData_->Size();
     vertexData_->Resize(begin + 6 * UI_VERTEX_SIZE);
@@ -299,40 +338,42 @@ void UIBatch::AddQuad(const Matrix3x4& transform, const IntVector2& a, const Int
     dest[4] = uv1.x_;
     dest[5] = uv1.y_;
 
-    dest[6] = v2.x_;
-    dest[7] = v2.y_;
-    dest[8] = 0.0f;
-    ((unsigned&)dest[9]) = color_;
-    dest[10] = uv2.x_;
-    dest[11] = uv2.y_;
-
-    dest[12] = v3.x_;
-    dest[13] = v3.y_;
-    dest[14] = 0.0f;
-    ((unsigned&)dest[15]) = color_;
-    dest[16] = uv3.x_;
-    dest[17] = uv3.y_;
-
-    dest[18] = v1.x_;
-    dest[19] = v1.y_;
-    dest[20] = 0.0f;
-    ((unsigned&)dest[21]) = color_;
-    dest[22] = uv1.x_;
-    dest[23] = uv1.y_;
-
-    dest[24] = v3.x_;
-    dest[25] = v3.y_;
-    dest[26] = 0.0f;
-    ((unsigned&)dest[27]) = color_;
-    dest[28] = uv3.x_;
-    dest[29] = uv3.y_;
-
-    dest[30] = v4.x_;
-    dest[31] = v4.y_;
+    dest[10] = v2.x_;
+    dest[11] = v2.y_;
+    dest[12] = 0.0f;
+    ((unsigned&)dest[13]) = color_;
+    dest[14] = uv2.x_;
+    dest[15] = uv2.y_;
+
+    dest[20] = v3.x_;
+    dest[21] = v3.y_;
+    dest[22] = 0.0f;
+    ((unsigned&)dest[23]) = color_;
+    dest[24] = uv3.x_;
+    dest[25] = uv3.y_;
+
+    dest[30] = v1.x_;
+    dest[31] = v1.y_;
     dest[32] = 0.0f;
     ((unsigned&)dest[33]) = color_;
-    dest[34] = uv4.x_;
-    dest[35] = uv4.y_;
+    dest[34] = uv1.x_;
+    dest[35] = uv1.y_;
+
+    dest[40] = v3.x_;
+    dest[41] = v3.y_;
+    dest[42] = 0.0f;
+    ((unsigned&)dest[43]) = color_;
+    dest[44] = uv3.x_;
+    dest[45] = uv3.y_;
+
+    dest[50] = v4.x_;
+    dest[51] = v4.y_;
+    dest[52] = 0.0f;
+    ((unsigned&)dest[53]) = color_;
+    dest[54] = uv4.x_;
+    dest[55] = uv4.y_;
+
+    SetClipRect(dest, scissor_);
 }
 
 void UIBatch::AddQuad(const Matrix3x4& transform, const IntVector2& a, const IntVector2& b, const IntVector2& c, const IntVector2& d,
@@ -344,10 +385,10 @@ void UIBatch::AddQuad(const Matrix3x4& transform, const IntVector2& a, const Int
     Vector3 v3 = (transform * Vector3((float)c.x_, (float)c.y_, 0.0f)) - posAdjust;
     Vector3 v4 = (transform * Vector3((float)d.x_, (float)d.y_, 0.0f)) - posAdjust;
 
-    Vector2 uv1((float)texA.x_ * invTextureSize_.x_, (float)texA.y_ * invTextureSize_.y_);
-    Vector2 uv2((float)texB.x_ * invTextureSize_.x_, (float)texB.y_ * invTextureSize_.y_);
-    Vector2 uv3((float)texC.x_ * invTextureSize_.x_, (float)texC.y_ * invTextureSize_.y_);
-    Vector2 uv4((float)texD.x_ * invTextureSize_.x_, (float)texD.y_ * invTextureSize_.y_);
+    Vector2 uv1((float)texA.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texA.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv2((float)texB.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texB.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv3((float)texC.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texC.y_ * invTextureSize_.y_ + uvOffset_.y_);
+    Vector2 uv4((float)texD.x_ * invTextureSize_.x_ + uvOffset_.x_, (float)texD.y_ * invTextureSize_.y_ + uvOffset_.y_);
 
     unsigned c1 = colA.ToUInt();
     unsigned c2 = colB.ToUInt();
@@ -366,47 +407,47 @@ void UIBatch::AddQuad(const Matrix3x4& transform, const IntVector2& a, const Int
     dest[4] = uv1.x_;
     dest[5] = uv1.y_;
 
-    dest[6] = v2.x_;
-    dest[7] = v2.y_;
-    dest[8] = 0.0f;
-    ((unsigned&)dest[9]) = c2;
-    dest[10] = uv2.x_;
-    dest[11] = uv2.y_;
-
-    dest[12] = v3.x_;
-    dest[13] = v3.y_;
-    dest[14] = 0.0f;
-    ((unsigned&)dest[15]) = c3;
-    dest[16] = uv3.x_;
-    dest[17] = uv3.y_;
-
-    dest[18] = v1.x_;
-    dest[19] = v1.y_;
-    dest[20] = 0.0f;
-    ((unsigned&)dest[21]) = c1;
-    dest[22] = uv1.x_;
-    dest[23] = uv1.y_;
-
-    dest[24] = v3.x_;
-    dest[25] = v3.y_;
-    dest[26] = 0.0f;
-    ((unsigned&)dest[27]) = c3;
-    dest[28] = uv3.x_;
-    dest[29] = uv3.y_;
-
-    dest[30] = v4.x_;
-    dest[31] = v4.y_;
+    dest[10] = v2.x_;
+    dest[11] = v2.y_;
+    dest[12] = 0.0f;
+    ((unsigned&)dest[13]) = c2;
+    dest[14] = uv2.x_;
+    dest[15] = uv2.y_;
+
+    dest[20] = v3.x_;
+    dest[21] = v3.y_;
+    dest[22] = 0.0f;
+    ((unsigned&)dest[23]) = c3;
+    dest[24] = uv3.x_;
+    dest[25] = uv3.y_;
+
+    dest[30] = v1.x_;
+    dest[31] = v1.y_;
     dest[32] = 0.0f;
-    ((unsigned&)dest[33]) = c4;
-    dest[34] = uv4.x_;
-    dest[35] = uv4.y_;
+    ((unsigned&)dest[33]) = c1;
+    dest[34] = uv1.x_;
+    dest[35] = uv1.y_;
+
+    dest[40] = v3.x_;
+    dest[41] = v3.y_;
+    dest[42] = 0.0f;
+    ((unsigned&)dest[43]) = c3;
+    dest[44] = uv3.x_;
+    dest[45] = uv3.y_;
+
+    dest[50] = v4.x_;
+    dest[51] = v4.y_;
+    dest[52] = 0.0f;
+    ((unsigned&)dest[53]) = c4;
+    dest[54] = uv4.x_;
+    dest[55] = uv4.y_;
+
+    SetClipRect(dest, scissor_);
 }
 
 bool UIBatch::Merge(const UIBatch& batch)
 {
-    if (batch.blendMode_ != blendMode_ ||
-        batch.scissor_ != scissor_ ||
-        batch.texture_ != texture_ ||
+    if (!CanMerge(batch) ||
         batch.vertexData_ != vertexData_ ||
         batch.vertexStart_ != vertexEnd_)
         return false;
@@ -415,6 +456,15 @@ bool UIBatch::Merge(const UIBatch& batch)
     return true;
 }
 
+bool UIBatch::CanMerge(const UIBatch& batch) const
+{
+    // Batches without a custom material are clipped by the shader, so only custom material batches depend on the scissor
+    return batch.blendMode_ == blendMode_ &&
+        batch.texture_ == texture_ &&
+        batch.custom_material_ == custom_material_ &&
+        (!custom_material_ || batch.scissor_ == scissor_);
+}
+
 unsigned UIBatch::GetInterpolatedColor(float x, float y)
 {
     const IntVector2& size = element_->GetSize();
@@ -438,6 +488,17 @@ unsigned UIBatch::GetInterpolatedColor(float x, float y)
     }
 }
 
+const PODVector<VertexElement>& UIBatch::GetVertexElements()
+{
+    static const PODVector<VertexElement> elements = {
+        VertexElement(TYPE_VECTOR3, SEM_POSITION),
+        VertexElement(TYPE_UBYTE4_NORM, SEM_COLOR),
+        VertexElement(TYPE_VECTOR2, SEM_TEXCOORD),
+        VertexElement(TYPE_VECTOR4, SEM_TEXCOORD, 2)
+    };
+    return elements;
+}
+
 void UIBatch::AddOrMerge(const UIBatch& batch, PODVector<UIBatch>& batches)
 {
     if (batch.vertexEnd_ == batch.vertexStart_)
@@ -36,7 +36,8 @@ class Matrix3x4;
 class Texture;
 class UIElement;
 
-static const unsigned UI_VERTEX_SIZE = 6;
+/// Number of floats per UI vertex: position, color, texture coordinates and clip rectangle.
+static const unsigned UI_VERTEX_SIZE = 10;
 
 /// %UI rendering draw call.
 class URHO3D_API UIBatch
@@ -47,6 +48,8 @@ public:
     /// Construct.
     UIBatch(UIElement* element, BlendMode blendMode, const IntRect& scissor, Texture* texture, PODVector<float>* vertexData);
 
+    /// Replace the texture with its region in the %UI texture atlas, if the texture can be atlased. Call before adding quads.
+    void UseTextureAtlas();
     /// Set new color for the batch. Overrides gradient.
     void SetColor(const Color& color, bool overrideAlpha = false);
     /// Restore UI element's default color.
@@ -67,11 +70,15 @@ public:
         const Color& colB, const Color& colC, const Color& colD);
     /// Merge with another batch.
     bool Merge(const UIBatch& batch);
+    /// Return whether another batch has the same render state, so that their vertices can be drawn together.
+    bool CanMerge(const UIBatch& batch) const;
     /// Return an interpolated color for the UI element.
     unsigned GetInterpolatedColor(float x, float y);
 
     /// Add or merge a batch.
     static void AddOrMerge(const UIBatch& batch, PODVector<UIBatch>& batches);
+    /// Return the vertex elements of %UI vertex data.
+    static const PODVector<VertexElement>& GetVertexElements();
 
     /// Element this batch represents.
     UIElement* element_{};
@@ -83,6 +90,8 @@ public:
     Texture* texture_{};
     /// Inverse texture size.
     Vector2 invTextureSize_{Vector2::ONE};
+    /// Texture coordinate offset of the texture's region in the %UI texture atlas.
+    Vector2 uvOffset_;
     /// Vertex data.
     PODVector<float>* vertexData_{};
     /// Vertex data start index.
@@ -100,4 +109,19 @@ public:
     static Vector3 posAdjust;
 };
 
+/// Cached batches of an UI element's children.
+struct UIBatchCache
+{
+    /// Batches.
+    PODVector<UIBatch> batches_;
+    /// Vertex data of the batches.
+    PODVector<float> vertexData_;
+    /// Scissor the batches were generated with.
+    IntRect scissor_;
+    /// %UI texture atlas revision the batches were generated with.
+    unsigned textureAtlasRevision_{};
+    /// Dirty flag.
+    bool dirty_{true};
+};
+
 }
@@ -144,6 +144,7 @@ void UIElement::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Bring To Back", GetBringToBack, SetBringToBack, bool, true, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Clip Children", GetClipChildren, SetClipChildren, bool, false, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Use Derived Opacity", GetUseDerivedOpacity, SetUseDerivedOpacity, bool, true, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Batch Caching", GetBatchCaching, SetBatchCaching, bool, false, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Focus Mode", GetFocusMode, SetFocusMode, FocusMode, focusModes, FM_NOTFOCUSABLE, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Drag And Drop Mode", GetDragDropMode, SetDragDropMode, DragAndDropModeFlags, dragDropModes, DD_DISABLED, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Layout Mode", GetLayoutMode, SetLayoutMode, LayoutMode, layoutModes, LM_FREE, AM_FILE);
@@ -817,6 +818,7 @@ void UIElement::SetClipBorder(const IntRect& rect)
     clipBorder_.top_ = Max(rect.top_, 0);
     clipBorder_.right_ = Max(rect.right_, 0);
     clipBorder_.bottom_ = Max(rect.bottom_, 0);
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(const Color& color)
@@ -825,6 +827,7 @@ void UIElement::SetColor(const Color& color)
         cornerColor = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(Corner corner, const Color& color)
@@ -838,6 +841,7 @@ void UIElement::SetColor(Corner corner, const Color& color)
         if (i != corner && colors_[i] != colors_[corner])
             colorGradient_ = true;
     }
+    MarkBatchesDirty();
 }
 
 void UIElement::SetPriority(int priority)
@@ -848,6 +852,8 @@ void UIElement::SetPriority(int priority)
     priority_ = priority;
     if (parent_)
         parent_->sortOrderDirty_ = true;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetOpacity(float opacity)
@@ -869,6 +875,8 @@ void UIElement::SetBringToBack(bool enable)
 void UIElement::SetClipChildren(bool enable)
 {
     clipChildren_ = enable;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetSortChildren(bool enable)
@@ -877,17 +885,21 @@ void UIElement::SetSortChildren(bool enable)
         sortOrderDirty_ = true;
 
     sortChildren_ = enable;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetUseDerivedOpacity(bool enable)
 {
     useDerivedOpacity_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetEnabled(bool enable)
 {
     enabled_ = enable;
     enabledPrev_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetDeepEnabled(bool enable)
@@ -896,6 +908,7 @@ void UIElement::SetDeepEnabled(bool enable)
 
     for (Vector<SharedPtr<UIElement> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
         (*i)->SetDeepEnabled(enable);
+    MarkBatchesDirty();
 }
 
 void UIElement::ResetDeepEnabled()
@@ -904,6 +917,7 @@ void UIElement::ResetDeepEnabled()
 
     for (Vector<SharedPtr<UIElement> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
         (*i)->ResetDeepEnabled();
+    MarkBatchesDirty();
 }
 
 void UIElement::SetEnabledRecursive(bool enable)
@@ -913,6 +927,7 @@ void UIElement::SetEnabledRecursive(bool enable)
 
     for (Vector<SharedPtr<UIElement> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
         (*i)->SetEnabledRecursive(enable);
+    MarkBatchesDirty();
 }
 
 void UIElement::SetEditable(bool enable)
@@ -951,6 +966,9 @@ void UIElement::SetFocus(bool enable)
 
 void UIElement::SetSelected(bool enable)
 {
+    if (enable != selected_)
+        MarkBatchesDirty();
+
     selected_ = enable;
 }
 
@@ -983,6 +1001,9 @@ void UIElement::SetVisible(bool enable)
             if (focusElement && !focusElement->IsVisibleEffective())
                 focusElement->SetFocus(false);
         }
+
+        MarkBatchesDirty();
+        MarkHitTestDirty();
     }
 }
 
@@ -1097,6 +1118,20 @@ void UIElement::UpdateLayout()
     if (layoutNestingLevel_)
         return;
 
+    // When the UI defers layout updates, queue the update once and skip it until the UI performs it
+    auto* ui = GetSubsystem<UI>();
+    if (ui)
+    {
+        if (layoutQueued_ && !ui->IsUpdatingLayout(this))
+            return;
+        if (!layoutQueued_ && ui->QueueLayoutUpdate(this))
+        {
+            layoutQueued_ = true;
+            return;
+        }
+    }
+    layoutQueued_ = false;
+
     // Prevent further updates while this update happens
     DisableLayoutUpdate();
 
@@ -1363,6 +1398,8 @@ void UIElement::RemoveChild(UIElement* element, unsigned index)
             element->Detach();
             children_.Erase(i);
             UpdateLayout();
+            MarkBatchesDirty();
+            MarkHitTestDirty();
             return;
         }
     }
@@ -1390,6 +1427,8 @@ void UIElement::RemoveChildAtIndex(unsigned index)
     children_[index]->Detach();
     children_.Erase(index);
     UpdateLayout();
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::RemoveAllChildren()
@@ -1416,6 +1455,8 @@ void UIElement::RemoveAllChildren()
     }
     children_.Clear();
     UpdateLayout();
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::Remove()
@@ -1449,6 +1490,7 @@ void UIElement::SetInternal(bool enable)
 void UIElement::SetTraversalMode(TraversalMode traversalMode)
 {
     traversalMode_ = traversalMode;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetElementEventSender(bool flag)
@@ -1456,6 +1498,38 @@ void UIElement::SetElementEventSender(bool flag)
     elementEventSender_ = flag;
 }
 
+void UIElement::SetBatchCaching(bool enable)
+{
+    if (enable == GetBatchCaching())
+        return;
+
+    if (enable)
+        batchCache_ = new UIBatchCache();
+    else
+        batchCache_.Reset();
+
+    // The batches move between this element's cache and the caches of the parents
+    MarkBatchesDirty();
+}
+
+void UIElement::MarkBatchesDirty()
+{
+    // Walk all the way up, as the caches of invisible parts of the hierarchy may have stayed dirty
+    for (UIElement* element = this; element; element = element->parent_)
+    {
+        if (element->batchCache_)
+            element->batchCache_->dirty_ = true;
+    }
+}
+
+void UIElement::MarkHitTestDirty()
+{
+    UIElement* root = this;
+    while (root->parent_)
+        root = root->parent_;
+    ++root->hitTestRevision_;
+}
+
 void UIElement::SetTags(const StringVector& tags)
 {
     RemoveAllTags();
@@ -1802,6 +1876,9 @@ void UIElement::SetChildOffset(const IntVector2& offset)
 
 void UIElement::SetHovering(bool enable)
 {
+    if (enable != hovering_)
+        MarkBatchesDirty();
+
     hovering_ = enable;
 }
 
@@ -1829,7 +1906,7 @@ void UIElement::GetBatchesWithOffset(IntVector2& offset, PODVector<UIBatch>& bat
     unsigned initialSize = vertexData.Size();
 
     GetBatches(batches, vertexData, currentScissor);
-    for (unsigned i = initialSize; i < vertexData.Size(); i += 6)
+    for (unsigned i = initialSize; i < vertexData.Size(); i += UI_VERTEX_SIZE)
     {
         vertexData[i] += floatOffset.x_;
         vertexData[i + 1] += floatOffset.y_;
@@ -1930,6 +2007,8 @@ void UIElement::MarkDirty()
     positionDirty_ = true;
     opacityDirty_ = true;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 
     for (Vector<SharedPtr<UIElement> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
         (*i)->MarkDirty();
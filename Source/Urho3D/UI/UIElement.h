@@ -337,7 +337,7 @@ public:
     void SetIndent(int indent);
     /// Set indent spacing (number of pixels per indentation level).
     void SetIndentSpacing(int indentSpacing);
-    /// Manually update layout. Should not be necessary in most cases, but is provided for completeness.
+    /// Manually update layout. Should not be necessary in most cases, but is provided for completeness. Is queued to be performed later when the UI defers layout updates.
     void UpdateLayout();
     /// Disable automatic layout update. Should only be used if there are performance problems.
     void DisableLayoutUpdate();
@@ -371,6 +371,12 @@ public:
     void SetTraversalMode(TraversalMode traversalMode);
     /// Set element event sender flag. When child element is added or deleted, the event would be sent using UIElement found in the parental chain having this flag set. If not set, the event is sent using UI's root as per normal.
     void SetElementEventSender(bool flag);
+    /// Set whether the batches of the child elements are cached and reused until a change in the subtree marks them dirty. Intended for static windows with many children. Custom elements whose batches depend on state not changed through their setters must call MarkBatchesDirty(). Default false.
+    void SetBatchCaching(bool enable);
+    /// Mark the cached child batches of this element and its parents dirty.
+    void MarkBatchesDirty();
+    /// Increment the hit-test revision of the root element, to rebuild the %UI hit-test grid. Called when the position, size, visibility or child order of the element changes.
+    void MarkHitTestDirty();
 
     /// Set tags. Old tags are overwritten.
     void SetTags(const StringVector& tags);
@@ -640,6 +646,18 @@ public:
     /// Return whether element should send child added / removed events by itself. If false, defers to parent element.
     bool IsElementEventSender() const { return elementEventSender_; }
 
+    /// Return whether child batches are cached.
+    bool GetBatchCaching() const { return batchCache_.Get() != nullptr; }
+
+    /// Return the child batch cache, or null if not caching. Used internally.
+    UIBatchCache* GetBatchCache() const { return batchCache_.Get(); }
+
+    /// Return the hit-test revision. Only incremented on root elements. Used internally.
+    unsigned GetHitTestRevision() const { return hitTestRevision_; }
+
+    /// Return whether a deferred layout update is queued for the element.
+    bool IsLayoutQueued() const { return layoutQueued_; }
+
     /// Get element which should send child added / removed events.
     UIElement* GetElementEventSender() const;
 
@@ -723,6 +741,8 @@ protected:
     unsigned resizeNestingLevel_{};
     /// Layout update nesting level to prevent endless loop.
     unsigned layoutNestingLevel_{};
+    /// Deferred layout update queued flag.
+    bool layoutQueued_{};
     /// Layout element maximum size in layout direction.
     int layoutElementMaxSize_{};
     /// Horizontal indentation.
@@ -810,6 +830,10 @@ private:
     TraversalMode traversalMode_{TM_BREADTH_FIRST};
     /// Flag whether node should send child added / removed events by itself.
     bool elementEventSender_{};
+    /// Cached child batches.
+    UniquePtr<UIBatchCache> batchCache_;
+    /// Hit-test revision of the hierarchy, when this is the root element.
+    unsigned hitTestRevision_{};
     /// XPath query for selecting UI-style.
     static XPathQuery styleXPathQuery_;
     /// Tag list.
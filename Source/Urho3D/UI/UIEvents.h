@@ -294,6 +294,14 @@ URHO3D_EVENT(E_ITEMCLICKED, ItemClicked)
     URHO3D_PARAM(P_QUALIFIERS, Qualifiers);        // int
 }
 
+/// Listview item element in virtual mode needs to be filled with the data of a row.
+URHO3D_EVENT(E_VIRTUALITEMUPDATE, VirtualItemUpdate)
+{
+    URHO3D_PARAM(P_ELEMENT, Element);              // UIElement pointer
+    URHO3D_PARAM(P_ITEM, Item);                    // UIElement pointer
+    URHO3D_PARAM(P_INDEX, Index);                  // int
+}
+
 /// Listview item double clicked.
 URHO3D_EVENT(E_ITEMDOUBLECLICKED, ItemDoubleClicked)
 {
@@ -59,11 +59,13 @@ void UISelectable::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& ver
 void UISelectable::SetSelectionColor(const Color& color)
 {
     selectionColor_ = color;
+    MarkBatchesDirty();
 }
 
 void UISelectable::SetHoverColor(const Color& color)
 {
     hoverColor_ = color;
+    MarkBatchesDirty();
 }
 
 }
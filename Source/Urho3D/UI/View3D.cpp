@@ -161,9 +161,9 @@ void View3D::ResetScene()
     if (!ownScene_)
     {
         RefCount* refCount = scene_->RefCountPtr();
-        ++refCount->refs_;
+        refCount->AddRef();
         scene_ = nullptr;
-        --refCount->refs_;
+        refCount->ReleaseRef();
     }
     else
         scene_ = nullptr;
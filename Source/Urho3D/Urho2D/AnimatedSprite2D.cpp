@@ -60,7 +60,8 @@ AnimatedSprite2D::AnimatedSprite2D(Context* context) :
     animationState_(0),
 #endif
     speed_(1.0f),
-    loopMode_(LM_DEFAULT)
+    loopMode_(LM_DEFAULT),
+    spriterTimeQuantum_(0.0f)
 {
 }
 
@@ -81,6 +82,7 @@ void AnimatedSprite2D::RegisterObject(Context* context)
         ResourceRef(AnimatedSprite2D::GetTypeStatic()), AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Animation", GetAnimation, SetAnimationAttr, String, String::EMPTY, AM_DEFAULT);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Loop Mode", GetLoopMode, SetLoopMode, LoopMode2D, loopModeNames, LM_DEFAULT, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Spriter Time Quantum", GetSpriterTimeQuantum, SetSpriterTimeQuantum, float, 0.0f, AM_DEFAULT);
 }
 
 void AnimatedSprite2D::OnSetEnabled()
@@ -136,6 +138,7 @@ void AnimatedSprite2D::SetAnimationSet(AnimationSet2D* animationSet)
     if (animationSet_->GetSpriterData())
     {
         spriterInstance_ = new Spriter::SpriterInstance(this, animationSet_->GetSpriterData());
+        spriterInstance_->SetTimeQuantum(spriterTimeQuantum_);
 
         if (!animationSet_->GetSpriterData()->entities_.Empty())
         {
@@ -193,6 +196,14 @@ void AnimatedSprite2D::SetSpeed(float speed)
     MarkNetworkUpdate();
 }
 
+void AnimatedSprite2D::SetSpriterTimeQuantum(float quantum)
+{
+    spriterTimeQuantum_ = Max(quantum, 0.0f);
+    if (spriterInstance_)
+        spriterInstance_->SetTimeQuantum(spriterTimeQuantum_);
+    MarkNetworkUpdate();
+}
+
 AnimationSet2D* AnimatedSprite2D::GetAnimationSet() const
 {
     return animationSet_;
@@ -405,7 +416,10 @@ void AnimatedSprite2D::UpdateSourceBatchesSpine()
 void AnimatedSprite2D::SetSpriterAnimation()
 {
     if (!spriterInstance_)
+    {
         spriterInstance_ = new Spriter::SpriterInstance(this, animationSet_->GetSpriterData());
+        spriterInstance_->SetTimeQuantum(spriterTimeQuantum_);
+    }
 
     // Use entity is empty first entity
     if (entity_.Empty())
@@ -491,10 +505,12 @@ void AnimatedSprite2D::UpdateSourceBatchesSpriter()
         vertex2.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
         vertex3.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
 
-        vertex0.uv_ = textureRect.min_;
-        vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
-        vertex2.uv_ = textureRect.max_;
-        vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+        Vector2 uvs[4];
+        sprite->GetTextureCorners(textureRect, uvs);
+        vertex0.uv_ = uvs[0];
+        vertex1.uv_ = uvs[1];
+        vertex2.uv_ = uvs[2];
+        vertex3.uv_ = uvs[3];
 
         vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color;
 
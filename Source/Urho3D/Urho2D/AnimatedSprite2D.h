@@ -77,6 +77,8 @@ public:
     void SetLoopMode(LoopMode2D loopMode);
     /// Set speed.
     void SetSpeed(float speed);
+    /// Set the time step to which Spriter animation time is quantized. Instances playing the same animation at the same quantized time then share one evaluated pose, cached in the animation set. 0 evaluates each instance at its exact time. Default 0.
+    void SetSpriterTimeQuantum(float quantum);
 
     /// Return animation.
     AnimationSet2D* GetAnimationSet() const;
@@ -88,6 +90,8 @@ public:
     LoopMode2D GetLoopMode() const { return loopMode_; }
     /// Return speed.
     float GetSpeed() const { return speed_; }
+    /// Return Spriter animation time quantum.
+    float GetSpriterTimeQuantum() const { return spriterTimeQuantum_; }
 
     /// Set animation set attribute.
     void SetAnimationSetAttr(const ResourceRef& value);
@@ -132,6 +136,8 @@ protected:
     String animationName_;
     /// Loop mode.
     LoopMode2D loopMode_;
+    /// Spriter animation time quantum.
+    float spriterTimeQuantum_;
 
 #ifdef URHO3D_SPINE
     /// Skeleton.
@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Material.h"
 #include "../Resource/ResourceCache.h"
@@ -34,6 +36,10 @@
 #include "../Urho2D/Sprite2D.h"
 #include "../Urho2D/Urho2DEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -42,6 +48,102 @@ namespace Urho3D
 extern const char* URHO2D_CATEGORY;
 extern const char* blendModeNames[];
 
+/// Minimum number of particles updated per work item.
+static const unsigned PARTICLE_UPDATE_CHUNK_SIZE = 2048;
+
+/// Update task of a range of 2D particles.
+struct ParticleUpdateTask2D
+{
+    /// Emitter.
+    ParticleEmitter2D* emitter_;
+    /// First particle index.
+    unsigned start_;
+    /// End particle index.
+    unsigned end_;
+    /// Time step.
+    float timeStep_;
+    /// Gravity in world units.
+    Vector2 gravity_;
+    /// Extents of the updated particles.
+    BoundingBox bounds_;
+};
+
+void UpdateParticles2DWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* task = reinterpret_cast<ParticleUpdateTask2D*>(item->aux_);
+    task->emitter_->UpdateParticles(task->start_, task->end_, task->timeStep_, task->gravity_, task->bounds_);
+}
+
+/// Advance the emit rotation and radius of a radial emitter particle and calculate its position. Trigonometry has no SIMD version, so this is done one particle at a time.
+static inline void UpdateRadialParticle(ParticleData2D& particles, unsigned index, float timeStep)
+{
+    particles.emitRotation_[index] += particles.emitRotationDelta_[index] * timeStep;
+    particles.emitRadius_[index] += particles.emitRadiusDelta_[index] * timeStep;
+
+    particles.positionX_[index] = particles.startX_[index] - Cos(particles.emitRotation_[index]) * particles.emitRadius_[index];
+    particles.positionY_[index] = particles.startY_[index] + Sin(particles.emitRotation_[index]) * particles.emitRadius_[index];
+}
+
+void ParticleData2D::Resize(unsigned size)
+{
+    timeToLive_.Resize(size);
+    positionX_.Resize(size);
+    positionY_.Resize(size);
+    positionZ_.Resize(size);
+    size_.Resize(size);
+    sizeDelta_.Resize(size);
+    rotation_.Resize(size);
+    rotationDelta_.Resize(size);
+    colorR_.Resize(size);
+    colorG_.Resize(size);
+    colorB_.Resize(size);
+    colorA_.Resize(size);
+    colorDeltaR_.Resize(size);
+    colorDeltaG_.Resize(size);
+    colorDeltaB_.Resize(size);
+    colorDeltaA_.Resize(size);
+    startX_.Resize(size);
+    startY_.Resize(size);
+    velocityX_.Resize(size);
+    velocityY_.Resize(size);
+    radialAcceleration_.Resize(size);
+    tangentialAcceleration_.Resize(size);
+    emitRadius_.Resize(size);
+    emitRadiusDelta_.Resize(size);
+    emitRotation_.Resize(size);
+    emitRotationDelta_.Resize(size);
+}
+
+void ParticleData2D::Copy(unsigned dest, unsigned source)
+{
+    timeToLive_[dest] = timeToLive_[source];
+    positionX_[dest] = positionX_[source];
+    positionY_[dest] = positionY_[source];
+    positionZ_[dest] = positionZ_[source];
+    size_[dest] = size_[source];
+    sizeDelta_[dest] = sizeDelta_[source];
+    rotation_[dest] = rotation_[source];
+    rotationDelta_[dest] = rotationDelta_[source];
+    colorR_[dest] = colorR_[source];
+    colorG_[dest] = colorG_[source];
+    colorB_[dest] = colorB_[source];
+    colorA_[dest] = colorA_[source];
+    colorDeltaR_[dest] = colorDeltaR_[source];
+    colorDeltaG_[dest] = colorDeltaG_[source];
+    colorDeltaB_[dest] = colorDeltaB_[source];
+    colorDeltaA_[dest] = colorDeltaA_[source];
+    startX_[dest] = startX_[source];
+    startY_[dest] = startY_[source];
+    velocityX_[dest] = velocityX_[source];
+    velocityY_[dest] = velocityY_[source];
+    radialAcceleration_[dest] = radialAcceleration_[source];
+    tangentialAcceleration_[dest] = tangentialAcceleration_[source];
+    emitRadius_[dest] = emitRadius_[source];
+    emitRadiusDelta_[dest] = emitRadiusDelta_[source];
+    emitRotation_[dest] = emitRotation_[source];
+    emitRotationDelta_[dest] = emitRotationDelta_[source];
+}
+
 ParticleEmitter2D::ParticleEmitter2D(Context* context) :
     Drawable2D(context),
     blendMode_(BLEND_ADDALPHA),
@@ -132,7 +234,6 @@ void ParticleEmitter2D::SetMaxParticles(unsigned maxParticles)
     maxParticles = Max(maxParticles, 1U);
 
     particles_.Resize(maxParticles);
-    sourceBatches_[0].vertices_.Reserve(maxParticles * 4);
 
     numParticles_ = Min(maxParticles, numParticles_);
 }
@@ -235,32 +336,48 @@ void ParticleEmitter2D::UpdateSourceBatches()
     Vertex2D vertex2;
     Vertex2D vertex3;
 
-    vertex0.uv_ = textureRect.min_;
-    vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
-    vertex2.uv_ = textureRect.max_;
-    vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+    Vector2 uvs[4];
+    sprite_->GetTextureCorners(textureRect, uvs);
+    vertex0.uv_ = uvs[0];
+    vertex1.uv_ = uvs[1];
+    vertex2.uv_ = uvs[2];
+    vertex3.uv_ = uvs[3];
 
-    for (unsigned i = 0; i < numParticles_; ++i)
+    if (!numParticles_)
     {
-        Particle2D& p = particles_[i];
+        sourceBatchesDirty_ = false;
+        return;
+    }
+
+    // Size the vertex array once and write the quads in place
+    vertices.Resize(numParticles_ * 4);
+    Vertex2D* dest = &vertices[0];
+    const ParticleData2D& p = particles_;
 
-        float rotation = -p.rotation_;
+    for (unsigned i = 0; i < numParticles_; ++i)
+    {
+        float rotation = -p.rotation_[i];
         float c = Cos(rotation);
         float s = Sin(rotation);
-        float add = (c + s) * p.size_ * 0.5f;
-        float sub = (c - s) * p.size_ * 0.5f;
-
-        vertex0.position_ = Vector3(p.position_.x_ - sub, p.position_.y_ - add, p.position_.z_);
-        vertex1.position_ = Vector3(p.position_.x_ - add, p.position_.y_ + sub, p.position_.z_);
-        vertex2.position_ = Vector3(p.position_.x_ + sub, p.position_.y_ + add, p.position_.z_);
-        vertex3.position_ = Vector3(p.position_.x_ + add, p.position_.y_ - sub, p.position_.z_);
-
-        vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = p.color_.ToUInt();
-
-        vertices.Push(vertex0);
-        vertices.Push(vertex1);
-        vertices.Push(vertex2);
-        vertices.Push(vertex3);
+        float add = (c + s) * p.size_[i] * 0.5f;
+        float sub = (c - s) * p.size_[i] * 0.5f;
+        float x = p.positionX_[i];
+        float y = p.positionY_[i];
+        float z = p.positionZ_[i];
+
+        vertex0.position_ = Vector3(x - sub, y - add, z);
+        vertex1.position_ = Vector3(x - add, y + sub, z);
+        vertex2.position_ = Vector3(x + sub, y + add, z);
+        vertex3.position_ = Vector3(x + add, y - sub, z);
+
+        vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ =
+            Color(p.colorR_[i], p.colorG_[i], p.colorB_[i], p.colorA_[i]).ToUInt();
+
+        dest[0] = vertex0;
+        dest[1] = vertex1;
+        dest[2] = vertex2;
+        dest[3] = vertex3;
+        dest += 4;
     }
 
     sourceBatchesDirty_ = false;
@@ -315,27 +432,59 @@ void ParticleEmitter2D::Update(float timeStep)
 
     Vector3 worldPosition = GetNode()->GetWorldPosition();
     float worldScale = GetNode()->GetWorldScale().x_ * PIXEL_SIZE;
+    Vector2 gravity = effect_->GetGravity() * worldScale;
 
-    boundingBoxMinPoint_ = Vector3(M_INFINITY, M_INFINITY, M_INFINITY);
-    boundingBoxMaxPoint_ = Vector3(-M_INFINITY, -M_INFINITY, -M_INFINITY);
-
+    // Remove expired particles by moving the last particle in their place
     unsigned particleIndex = 0;
     while (particleIndex < numParticles_)
     {
-        Particle2D& particle = particles_[particleIndex];
-        if (particle.timeToLive_ > 0.0f)
-        {
-            UpdateParticle(particle, timeStep, worldPosition, worldScale);
+        if (particles_.timeToLive_[particleIndex] > 0.0f)
             ++particleIndex;
-        }
         else
         {
             if (particleIndex != numParticles_ - 1)
-                particles_[particleIndex] = particles_[numParticles_ - 1];
+                particles_.Copy(particleIndex, numParticles_ - 1);
             --numParticles_;
         }
     }
 
+    BoundingBox bounds;
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = queue && Thread::IsMainThread() ? queue->GetNumThreads() + 1 : 1;
+    unsigned chunkSize = Max((numParticles_ + numWorkItems - 1) / numWorkItems, PARTICLE_UPDATE_CHUNK_SIZE);
+
+    // Split large emitters into chunks updated in parallel
+    if (chunkSize < numParticles_)
+    {
+        URHO3D_PROFILE(UpdateParticles2D);
+
+        Vector<ParticleUpdateTask2D> tasks((numParticles_ + chunkSize - 1) / chunkSize);
+        for (unsigned i = 0; i < tasks.Size(); ++i)
+        {
+            ParticleUpdateTask2D& task = tasks[i];
+            task.emitter_ = this;
+            task.start_ = i * chunkSize;
+            task.end_ = Min(task.start_ + chunkSize, numParticles_);
+            task.timeStep_ = timeStep;
+            task.gravity_ = gravity;
+            task.bounds_ = BoundingBox();
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = UpdateParticles2DWork;
+            item->name_ = "UpdateParticles2DWork";
+            item->aux_ = &task;
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < tasks.Size(); ++i)
+            bounds.Merge(tasks[i].bounds_);
+    }
+    else
+        UpdateParticles(0, numParticles_, timeStep, gravity, bounds);
+
     if (emitting_ && emissionTime_ > 0.0f)
     {
         float worldAngle = GetNode()->GetWorldRotation().RollAngle();
@@ -346,7 +495,7 @@ void ParticleEmitter2D::Update(float timeStep)
         while (emitParticleTime_ > 0.0f)
         {
             if (EmitParticle(worldPosition, worldAngle, worldScale))
-                UpdateParticle(particles_[numParticles_ - 1], emitParticleTime_, worldPosition, worldScale);
+                UpdateParticles(numParticles_ - 1, numParticles_, emitParticleTime_, gravity, bounds);
 
             emitParticleTime_ -= timeBetweenParticles;
         }
@@ -355,6 +504,8 @@ void ParticleEmitter2D::Update(float timeStep)
             emissionTime_ = Max(0.0f, emissionTime_ - timeStep);
     }
 
+    boundingBoxMinPoint_ = bounds.min_;
+    boundingBoxMaxPoint_ = bounds.max_;
     sourceBatchesDirty_ = true;
 
     OnMarkedDirty(node_);
@@ -371,103 +522,190 @@ bool ParticleEmitter2D::EmitParticle(const Vector3& worldPosition, float worldAn
 
     float invLifespan = 1.0f / lifespan;
 
-    Particle2D& particle = particles_[numParticles_++];
-    particle.timeToLive_ = lifespan;
+    ParticleData2D& p = particles_;
+    unsigned i = numParticles_++;
+    p.timeToLive_[i] = lifespan;
 
-    particle.position_.x_ = worldPosition.x_ + worldScale * effect_->GetSourcePositionVariance().x_ * Random(-1.0f, 1.0f);
-    particle.position_.y_ = worldPosition.y_ + worldScale * effect_->GetSourcePositionVariance().y_ * Random(-1.0f, 1.0f);
-    particle.position_.z_ = worldPosition.z_;
-    particle.startPos_.x_ = worldPosition.x_;
-    particle.startPos_.y_ = worldPosition.y_;
+    p.positionX_[i] = worldPosition.x_ + worldScale * effect_->GetSourcePositionVariance().x_ * Random(-1.0f, 1.0f);
+    p.positionY_[i] = worldPosition.y_ + worldScale * effect_->GetSourcePositionVariance().y_ * Random(-1.0f, 1.0f);
+    p.positionZ_[i] = worldPosition.z_;
+    p.startX_[i] = worldPosition.x_;
+    p.startY_[i] = worldPosition.y_;
 
     float angle = worldAngle + effect_->GetAngle() + effect_->GetAngleVariance() * Random(-1.0f, 1.0f);
     float speed = worldScale * (effect_->GetSpeed() + effect_->GetSpeedVariance() * Random(-1.0f, 1.0f));
-    particle.velocity_.x_ = speed * Cos(angle);
-    particle.velocity_.y_ = speed * Sin(angle);
+    p.velocityX_[i] = speed * Cos(angle);
+    p.velocityY_[i] = speed * Sin(angle);
 
     float maxRadius = Max(0.0f, worldScale * (effect_->GetMaxRadius() + effect_->GetMaxRadiusVariance() * Random(-1.0f, 1.0f)));
     float minRadius = Max(0.0f, worldScale * (effect_->GetMinRadius() + effect_->GetMinRadiusVariance() * Random(-1.0f, 1.0f)));
-    particle.emitRadius_ = maxRadius;
-    particle.emitRadiusDelta_ = (minRadius - maxRadius) * invLifespan;
-    particle.emitRotation_ = worldAngle + effect_->GetAngle() + effect_->GetAngleVariance() * Random(-1.0f, 1.0f);
-    particle.emitRotationDelta_ = effect_->GetRotatePerSecond() + effect_->GetRotatePerSecondVariance() * Random(-1.0f, 1.0f);
-    particle.radialAcceleration_ =
+    p.emitRadius_[i] = maxRadius;
+    p.emitRadiusDelta_[i] = (minRadius - maxRadius) * invLifespan;
+    p.emitRotation_[i] = worldAngle + effect_->GetAngle() + effect_->GetAngleVariance() * Random(-1.0f, 1.0f);
+    p.emitRotationDelta_[i] = effect_->GetRotatePerSecond() + effect_->GetRotatePerSecondVariance() * Random(-1.0f, 1.0f);
+    p.radialAcceleration_[i] =
         worldScale * (effect_->GetRadialAcceleration() + effect_->GetRadialAccelVariance() * Random(-1.0f, 1.0f));
-    particle.tangentialAcceleration_ =
+    p.tangentialAcceleration_[i] =
         worldScale * (effect_->GetTangentialAcceleration() + effect_->GetTangentialAccelVariance() * Random(-1.0f, 1.0f));
 
     float startSize =
         worldScale * Max(0.1f, effect_->GetStartParticleSize() + effect_->GetStartParticleSizeVariance() * Random(-1.0f, 1.0f));
     float finishSize =
         worldScale * Max(0.1f, effect_->GetFinishParticleSize() + effect_->GetFinishParticleSizeVariance() * Random(-1.0f, 1.0f));
-    particle.size_ = startSize;
-    particle.sizeDelta_ = (finishSize - startSize) * invLifespan;
+    p.size_[i] = startSize;
+    p.sizeDelta_[i] = (finishSize - startSize) * invLifespan;
 
-    particle.color_ = effect_->GetStartColor() + effect_->GetStartColorVariance() * Random(-1.0f, 1.0f);
+    Color startColor = effect_->GetStartColor() + effect_->GetStartColorVariance() * Random(-1.0f, 1.0f);
     Color endColor = effect_->GetFinishColor() + effect_->GetFinishColorVariance() * Random(-1.0f, 1.0f);
-    particle.colorDelta_ = (endColor - particle.color_) * invLifespan;
-
-    particle.rotation_ = worldAngle + effect_->GetRotationStart() + effect_->GetRotationStartVariance() * Random(-1.0f, 1.0f);
+    Color colorDelta = (endColor - startColor) * invLifespan;
+    p.colorR_[i] = startColor.r_;
+    p.colorG_[i] = startColor.g_;
+    p.colorB_[i] = startColor.b_;
+    p.colorA_[i] = startColor.a_;
+    p.colorDeltaR_[i] = colorDelta.r_;
+    p.colorDeltaG_[i] = colorDelta.g_;
+    p.colorDeltaB_[i] = colorDelta.b_;
+    p.colorDeltaA_[i] = colorDelta.a_;
+
+    p.rotation_[i] = worldAngle + effect_->GetRotationStart() + effect_->GetRotationStartVariance() * Random(-1.0f, 1.0f);
     float endRotation = worldAngle + effect_->GetRotationEnd() + effect_->GetRotationEndVariance() * Random(-1.0f, 1.0f);
-    particle.rotationDelta_ = (endRotation - particle.rotation_) * invLifespan;
+    p.rotationDelta_[i] = (endRotation - p.rotation_[i]) * invLifespan;
 
     return true;
 }
 
-void ParticleEmitter2D::UpdateParticle(Particle2D& particle, float timeStep, const Vector3& worldPosition, float worldScale)
+void ParticleEmitter2D::UpdateParticles(unsigned start, unsigned end, float timeStep, const Vector2& gravity, BoundingBox& bounds)
 {
-    if (timeStep > particle.timeToLive_)
-        timeStep = particle.timeToLive_;
-
-    particle.timeToLive_ -= timeStep;
+    ParticleData2D& p = particles_;
+    bool radial = effect_->GetEmitterType() == EMITTER_TYPE_RADIAL;
+    unsigned i = start;
 
-    if (effect_->GetEmitterType() == EMITTER_TYPE_RADIAL)
+#ifdef URHO3D_SSE
+    // Update four particles at a time
+    if (end - start >= 4)
     {
-        particle.emitRotation_ += particle.emitRotationDelta_ * timeStep;
-        particle.emitRadius_ += particle.emitRadiusDelta_ * timeStep;
+        __m128 step = _mm_set1_ps(timeStep);
+        __m128 gravityX = _mm_set1_ps(gravity.x_);
+        __m128 gravityY = _mm_set1_ps(gravity.y_);
+        __m128 minDistance = _mm_set1_ps(0.0001f);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 minX = _mm_set1_ps(M_INFINITY);
+        __m128 minY = minX;
+        __m128 minZ = minX;
+        __m128 maxX = _mm_set1_ps(-M_INFINITY);
+        __m128 maxY = maxX;
+        __m128 maxZ = maxX;
+
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 timeToLive = _mm_loadu_ps(&p.timeToLive_[i]);
+            __m128 dt = _mm_min_ps(step, timeToLive);
+            _mm_storeu_ps(&p.timeToLive_[i], _mm_sub_ps(timeToLive, dt));
+
+            __m128 x;
+            __m128 y;
+            if (radial)
+            {
+                float dts[4];
+                _mm_storeu_ps(dts, dt);
+                for (unsigned j = 0; j < 4; ++j)
+                    UpdateRadialParticle(p, i + j, dts[j]);
+                x = _mm_loadu_ps(&p.positionX_[i]);
+                y = _mm_loadu_ps(&p.positionY_[i]);
+            }
+            else
+            {
+                x = _mm_loadu_ps(&p.positionX_[i]);
+                y = _mm_loadu_ps(&p.positionY_[i]);
+                __m128 distanceX = _mm_sub_ps(x, _mm_loadu_ps(&p.startX_[i]));
+                __m128 distanceY = _mm_sub_ps(y, _mm_loadu_ps(&p.startY_[i]));
+                __m128 distance = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX),
+                    _mm_mul_ps(distanceY, distanceY))), minDistance);
+                __m128 radialX = _mm_div_ps(distanceX, distance);
+                __m128 radialY = _mm_div_ps(distanceY, distance);
+                __m128 radialAcceleration = _mm_loadu_ps(&p.radialAcceleration_[i]);
+                __m128 tangentialAcceleration = _mm_loadu_ps(&p.tangentialAcceleration_[i]);
+
+                __m128 accelerationX = _mm_add_ps(gravityX, _mm_add_ps(_mm_mul_ps(radialX, radialAcceleration),
+                    _mm_mul_ps(radialY, tangentialAcceleration)));
+                __m128 accelerationY = _mm_add_ps(gravityY, _mm_sub_ps(_mm_mul_ps(radialX, tangentialAcceleration),
+                    _mm_mul_ps(radialY, radialAcceleration)));
+                __m128 velocityX = _mm_add_ps(_mm_loadu_ps(&p.velocityX_[i]), _mm_mul_ps(accelerationX, dt));
+                __m128 velocityY = _mm_sub_ps(_mm_loadu_ps(&p.velocityY_[i]), _mm_mul_ps(accelerationY, dt));
+                _mm_storeu_ps(&p.velocityX_[i], velocityX);
+                _mm_storeu_ps(&p.velocityY_[i], velocityY);
+
+                x = _mm_add_ps(x, _mm_mul_ps(velocityX, dt));
+                y = _mm_add_ps(y, _mm_mul_ps(velocityY, dt));
+                _mm_storeu_ps(&p.positionX_[i], x);
+                _mm_storeu_ps(&p.positionY_[i], y);
+            }
+
+            __m128 size = _mm_add_ps(_mm_loadu_ps(&p.size_[i]), _mm_mul_ps(_mm_loadu_ps(&p.sizeDelta_[i]), dt));
+            _mm_storeu_ps(&p.size_[i], size);
+            _mm_storeu_ps(&p.rotation_[i], _mm_add_ps(_mm_loadu_ps(&p.rotation_[i]), _mm_mul_ps(_mm_loadu_ps(&p.rotationDelta_[i]), dt)));
+            _mm_storeu_ps(&p.colorR_[i], _mm_add_ps(_mm_loadu_ps(&p.colorR_[i]), _mm_mul_ps(_mm_loadu_ps(&p.colorDeltaR_[i]), dt)));
+            _mm_storeu_ps(&p.colorG_[i], _mm_add_ps(_mm_loadu_ps(&p.colorG_[i]), _mm_mul_ps(_mm_loadu_ps(&p.colorDeltaG_[i]), dt)));
+            _mm_storeu_ps(&p.colorB_[i], _mm_add_ps(_mm_loadu_ps(&p.colorB_[i]), _mm_mul_ps(_mm_loadu_ps(&p.colorDeltaB_[i]), dt)));
+            _mm_storeu_ps(&p.colorA_[i], _mm_add_ps(_mm_loadu_ps(&p.colorA_[i]), _mm_mul_ps(_mm_loadu_ps(&p.colorDeltaA_[i]), dt)));
+
+            __m128 halfSize = _mm_mul_ps(size, half);
+            __m128 z = _mm_loadu_ps(&p.positionZ_[i]);
+            minX = _mm_min_ps(minX, _mm_sub_ps(x, halfSize));
+            minY = _mm_min_ps(minY, _mm_sub_ps(y, halfSize));
+            minZ = _mm_min_ps(minZ, z);
+            maxX = _mm_max_ps(maxX, _mm_add_ps(x, halfSize));
+            maxY = _mm_max_ps(maxY, _mm_add_ps(y, halfSize));
+            maxZ = _mm_max_ps(maxZ, z);
+        }
 
-        particle.position_.x_ = particle.startPos_.x_ - Cos(particle.emitRotation_) * particle.emitRadius_;
-        particle.position_.y_ = particle.startPos_.y_ + Sin(particle.emitRotation_) * particle.emitRadius_;
+        float minXs[4], minYs[4], minZs[4], maxXs[4], maxYs[4], maxZs[4];
+        _mm_storeu_ps(minXs, minX);
+        _mm_storeu_ps(minYs, minY);
+        _mm_storeu_ps(minZs, minZ);
+        _mm_storeu_ps(maxXs, maxX);
+        _mm_storeu_ps(maxYs, maxY);
+        _mm_storeu_ps(maxZs, maxZ);
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            bounds.Merge(Vector3(minXs[j], minYs[j], minZs[j]));
+            bounds.Merge(Vector3(maxXs[j], maxYs[j], maxZs[j]));
+        }
     }
-    else
-    {
-        float distanceX = particle.position_.x_ - particle.startPos_.x_;
-        float distanceY = particle.position_.y_ - particle.startPos_.y_;
-
-        float distanceScalar = Vector2(distanceX, distanceY).Length();
-        if (distanceScalar < 0.0001f)
-            distanceScalar = 0.0001f;
+#endif
 
-        float radialX = distanceX / distanceScalar;
-        float radialY = distanceY / distanceScalar;
-
-        float tangentialX = radialX;
-        float tangentialY = radialY;
+    for (; i < end; ++i)
+    {
+        float dt = Min(timeStep, p.timeToLive_[i]);
+        p.timeToLive_[i] -= dt;
 
-        radialX *= particle.radialAcceleration_;
-        radialY *= particle.radialAcceleration_;
+        if (radial)
+            UpdateRadialParticle(p, i, dt);
+        else
+        {
+            float distanceX = p.positionX_[i] - p.startX_[i];
+            float distanceY = p.positionY_[i] - p.startY_[i];
+            float distance = Max(sqrtf(distanceX * distanceX + distanceY * distanceY), 0.0001f);
+            float radialX = distanceX / distance;
+            float radialY = distanceY / distance;
+
+            p.velocityX_[i] += (gravity.x_ + radialX * p.radialAcceleration_[i] + radialY * p.tangentialAcceleration_[i]) * dt;
+            p.velocityY_[i] -= (gravity.y_ - radialY * p.radialAcceleration_[i] + radialX * p.tangentialAcceleration_[i]) * dt;
+            p.positionX_[i] += p.velocityX_[i] * dt;
+            p.positionY_[i] += p.velocityY_[i] * dt;
+        }
 
-        float newY = tangentialX;
-        tangentialX = -tangentialY * particle.tangentialAcceleration_;
-        tangentialY = newY * particle.tangentialAcceleration_;
+        p.size_[i] += p.sizeDelta_[i] * dt;
+        p.rotation_[i] += p.rotationDelta_[i] * dt;
+        p.colorR_[i] += p.colorDeltaR_[i] * dt;
+        p.colorG_[i] += p.colorDeltaG_[i] * dt;
+        p.colorB_[i] += p.colorDeltaB_[i] * dt;
+        p.colorA_[i] += p.colorDeltaA_[i] * dt;
 
-        particle.velocity_.x_ += (effect_->GetGravity().x_ * worldScale + radialX - tangentialX) * timeStep;
-        particle.velocity_.y_ -= (effect_->GetGravity().y_ * worldScale - radialY + tangentialY) * timeStep;
-        particle.position_.x_ += particle.velocity_.x_ * timeStep;
-        particle.position_.y_ += particle.velocity_.y_ * timeStep;
+        float halfSize = p.size_[i] * 0.5f;
+        bounds.Merge(Vector3(p.positionX_[i] - halfSize, p.positionY_[i] - halfSize, p.positionZ_[i]));
+        bounds.Merge(Vector3(p.positionX_[i] + halfSize, p.positionY_[i] + halfSize, p.positionZ_[i]));
     }
-
-    particle.size_ += particle.sizeDelta_ * timeStep;
-    particle.rotation_ += particle.rotationDelta_ * timeStep;
-    particle.color_ += particle.colorDelta_ * timeStep;
-
-    float halfSize = particle.size_ * 0.5f;
-    boundingBoxMinPoint_.x_ = Min(boundingBoxMinPoint_.x_, particle.position_.x_ - halfSize);
-    boundingBoxMinPoint_.y_ = Min(boundingBoxMinPoint_.y_, particle.position_.y_ - halfSize);
-    boundingBoxMinPoint_.z_ = Min(boundingBoxMinPoint_.z_, particle.position_.z_);
-    boundingBoxMaxPoint_.x_ = Max(boundingBoxMaxPoint_.x_, particle.position_.x_ + halfSize);
-    boundingBoxMaxPoint_.y_ = Max(boundingBoxMaxPoint_.y_, particle.position_.y_ + halfSize);
-    boundingBoxMaxPoint_.z_ = Max(boundingBoxMaxPoint_.z_, particle.position_.z_);
 }
 
 }
@@ -29,47 +29,75 @@ namespace Urho3D
 
 class ParticleEffect2D;
 class Sprite2D;
+struct WorkItem;
 
-/// 2D particle.
-struct Particle2D
+/// 2D particles stored as one array per attribute, so that several particles can be updated at once with SIMD.
+struct ParticleData2D
 {
-    /// Time to live.
-    float timeToLive_;
+    /// Set number of particles.
+    void Resize(unsigned size);
+    /// Copy a particle over another.
+    void Copy(unsigned dest, unsigned source);
+
+    /// Return number of particles.
+    unsigned Size() const { return timeToLive_.Size(); }
 
-    /// Position.
-    Vector3 position_;
+    /// Time to live.
+    PODVector<float> timeToLive_;
+    /// Position X.
+    PODVector<float> positionX_;
+    /// Position Y.
+    PODVector<float> positionY_;
+    /// Position Z.
+    PODVector<float> positionZ_;
     /// Size.
-    float size_;
+    PODVector<float> size_;
     /// Size delta.
-    float sizeDelta_;
+    PODVector<float> sizeDelta_;
     /// Rotation.
-    float rotation_;
+    PODVector<float> rotation_;
     /// Rotation delta.
-    float rotationDelta_;
-    /// Color.
-    Color color_;
-    /// Color delta.
-    Color colorDelta_;
+    PODVector<float> rotationDelta_;
+    /// Color red component.
+    PODVector<float> colorR_;
+    /// Color green component.
+    PODVector<float> colorG_;
+    /// Color blue component.
+    PODVector<float> colorB_;
+    /// Color alpha component.
+    PODVector<float> colorA_;
+    /// Color red component delta.
+    PODVector<float> colorDeltaR_;
+    /// Color green component delta.
+    PODVector<float> colorDeltaG_;
+    /// Color blue component delta.
+    PODVector<float> colorDeltaB_;
+    /// Color alpha component delta.
+    PODVector<float> colorDeltaA_;
 
     // EMITTER_TYPE_GRAVITY parameters
-    /// Start position.
-    Vector2 startPos_;
-    /// Velocity.
-    Vector2 velocity_;
+    /// Start position X.
+    PODVector<float> startX_;
+    /// Start position Y.
+    PODVector<float> startY_;
+    /// Velocity X.
+    PODVector<float> velocityX_;
+    /// Velocity Y.
+    PODVector<float> velocityY_;
     /// Radial acceleration.
-    float radialAcceleration_;
+    PODVector<float> radialAcceleration_;
     /// Tangential acceleration.
-    float tangentialAcceleration_;
+    PODVector<float> tangentialAcceleration_;
 
     // EMITTER_TYPE_RADIAL parameters
     /// Emit radius.
-    float emitRadius_;
+    PODVector<float> emitRadius_;
     /// Emit radius delta.
-    float emitRadiusDelta_;
+    PODVector<float> emitRadiusDelta_;
     /// Emit rotation.
-    float emitRotation_;
+    PODVector<float> emitRotation_;
     /// Emit rotation delta.
-    float emitRotationDelta_;
+    PODVector<float> emitRotationDelta_;
 };
 
 /// 2D particle emitter component.
@@ -77,6 +105,8 @@ class URHO3D_API ParticleEmitter2D : public Drawable2D
 {
     URHO3D_OBJECT(ParticleEmitter2D, Drawable2D);
 
+    friend void UpdateParticles2DWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit ParticleEmitter2D(Context* context);
@@ -138,8 +168,8 @@ private:
     void Update(float timeStep);
     /// Emit particle.
     bool EmitParticle(const Vector3& worldPosition, float worldAngle, float worldScale);
-    /// Update particle.
-    void UpdateParticle(Particle2D& particle, float timeStep, const Vector3& worldPosition, float worldScale);
+    /// Update a range of particles and merge their extents to a bounding box. Gravity is in world units.
+    void UpdateParticles(unsigned start, unsigned end, float timeStep, const Vector2& gravity, BoundingBox& bounds);
 
     /// Particle effect.
     SharedPtr<ParticleEffect2D> effect_;
@@ -156,7 +186,7 @@ private:
     /// Currently emitting flag.
     bool emitting_;
     /// Particles.
-    Vector<Particle2D> particles_;
+    ParticleData2D particles_;
     /// Bounding box min point.
     Vector3 boundingBoxMinPoint_;
     /// Bounding box max point.
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
@@ -45,6 +46,16 @@ extern const char* SUBSYSTEM_CATEGORY;
 static const Vector2 DEFAULT_GRAVITY(0.0f, -9.81f);
 static const int DEFAULT_VELOCITY_ITERATIONS = 8;
 static const int DEFAULT_POSITION_ITERATIONS = 3;
+static const unsigned MIN_THREADED_RIGID_BODIES = 256;
+
+static void ApplyWorldTransformsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<RigidBody2D**>(item->start_);
+    auto** end = reinterpret_cast<RigidBody2D**>(item->end_);
+
+    while (start != end)
+        (*start++)->ApplyWorldTransform();
+}
 
 PhysicsWorld2D::PhysicsWorld2D(Context* context) :
     Component(context),
@@ -89,6 +100,7 @@ void PhysicsWorld2D::RegisterObject(Context* context)
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Position Iterations", GetPositionIterations, SetPositionIterations, int, DEFAULT_POSITION_ITERATIONS,
         AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Threaded Transforms", bool, threadedTransforms_, false, AM_DEFAULT);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -287,16 +299,47 @@ void PhysicsWorld2D::Update(float timeStep)
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
 
-    physicsStepping_ = true;
-    world_->Step(timeStep, velocityIterations_, positionIterations_);
-    physicsStepping_ = false;
+    {
+        URHO3D_PROFILE(StepPhysics2D);
 
-    // Apply world transforms. Unparented transforms first
+        physicsStepping_ = true;
+        world_->Step(timeStep, velocityIterations_, positionIterations_);
+        physicsStepping_ = false;
+    }
+
+    ApplyWorldTransforms();
+
+    {
+        URHO3D_PROFILE(SendContactEvents2D);
+
+        SendBeginContactEvents();
+        SendEndContactEvents();
+    }
+
+    using namespace PhysicsPostStep;
+    SendEvent(E_PHYSICSPOSTSTEP, eventData);
+}
+
+void PhysicsWorld2D::ApplyWorldTransforms()
+{
+    URHO3D_PROFILE(ApplyTransforms2D);
+
+    Scene* scene = GetScene();
+    auto* queue = GetSubsystem<WorkQueue>();
+    bool threaded = threadedTransforms_ && scene && queue->GetNumThreads() && rigidBodies_.Size() >= MIN_THREADED_RIGID_BODIES;
+
+    // Apply world transforms. Unparented transforms first. When threaded, only collect the bodies of the scene's child nodes,
+    // as their node hierarchies are disjoint
+    threadedRigidBodies_.Clear();
     for (unsigned i = 0; i < rigidBodies_.Size();)
     {
-        if (rigidBodies_[i])
+        RigidBody2D* rigidBody = rigidBodies_[i];
+        if (rigidBody)
         {
-            rigidBodies_[i]->ApplyWorldTransform();
+            if (!threaded)
+                rigidBody->ApplyWorldTransform();
+            else if (rigidBody->GetNode() && rigidBody->GetNode()->GetParent() == scene)
+                threadedRigidBodies_.Push(rigidBody);
             ++i;
         }
         else
@@ -306,6 +349,52 @@ void PhysicsWorld2D::Update(float timeStep)
         }
     }
 
+    if (threaded)
+    {
+        // Make sure the scene's world transform is not updated from the worker threads
+        scene->GetWorldTransform();
+
+        // Node dirtying is disregarded for the whole threaded update. Components which may not be dirtied from worker threads,
+        // such as collision shapes, are notified when the threaded update ends
+        applyingTransforms_ = true;
+        scene->BeginThreadedUpdate();
+
+        unsigned numWorkItems = Min(queue->GetNumThreads() + 1, Max(threadedRigidBodies_.Size() / MIN_THREADED_RIGID_BODIES, 1U));
+        unsigned bodiesPerItem = threadedRigidBodies_.Size() / numWorkItems;
+        RigidBody2D** start = threadedRigidBodies_.Buffer();
+        RigidBody2D** bodiesEnd = start + threadedRigidBodies_.Size();
+
+        for (unsigned i = 0; i < numWorkItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ApplyWorldTransformsWork;
+            item->name_ = "ApplyWorldTransformsWork";
+            item->aux_ = this;
+
+            RigidBody2D** end = bodiesEnd;
+            if (i < numWorkItems - 1 && end - start > bodiesPerItem)
+                end = start + bodiesPerItem;
+
+            item->start_ = start;
+            item->end_ = end;
+            queue->AddWorkItem(item);
+
+            start = end;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+        scene->EndThreadedUpdate();
+        applyingTransforms_ = false;
+
+        for (unsigned i = 0; i < rigidBodies_.Size(); ++i)
+        {
+            RigidBody2D* rigidBody = rigidBodies_[i];
+            if (!rigidBody->GetNode() || rigidBody->GetNode()->GetParent() != scene)
+                rigidBody->ApplyWorldTransform();
+        }
+    }
+
     // Apply delayed (parented) world transforms now, if any
     while (!delayedWorldTransforms_.Empty())
     {
@@ -324,12 +413,6 @@ void PhysicsWorld2D::Update(float timeStep)
                 ++i;
         }
     }
-
-    SendBeginContactEvents();
-    SendEndContactEvents();
-
-    using namespace PhysicsPostStep;
-    SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry()
@@ -405,6 +488,11 @@ void PhysicsWorld2D::SetSubStepping(bool enable)
     world_->SetSubStepping(enable);
 }
 
+void PhysicsWorld2D::SetThreadedTransforms(bool enable)
+{
+    threadedTransforms_ = enable;
+}
+
 void PhysicsWorld2D::SetGravity(const Vector2& gravity)
 {
     gravity_ = gravity;
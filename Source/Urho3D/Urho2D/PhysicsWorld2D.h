@@ -130,6 +130,8 @@ public:
     void SetContinuousPhysics(bool enable);
     /// Set sub stepping.
     void SetSubStepping(bool enable);
+    /// Set whether the world transforms of rigid bodies in the scene's child nodes are applied in worker threads. Components listening to the node transforms must support threaded scene updates, as with threaded logic component updates. Default false.
+    void SetThreadedTransforms(bool enable);
     /// Set gravity.
     void SetGravity(const Vector2& gravity);
     /// Set auto clear forces.
@@ -186,6 +188,8 @@ public:
     bool GetSubStepping() const;
     /// Return auto clear forces.
     bool GetAutoClearForces() const;
+    /// Return whether world transforms are applied in worker threads.
+    bool GetThreadedTransforms() const { return threadedTransforms_; }
 
     /// Return gravity.
     const Vector2& GetGravity() const { return gravity_; }
@@ -211,6 +215,8 @@ protected:
 
     /// Handle the scene subsystem update event, step simulation here.
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Apply the simulated world transforms to the scene nodes.
+    void ApplyWorldTransforms();
     /// Send begin contact events.
     void SendBeginContactEvents();
     /// Send end contact events.
@@ -238,10 +244,14 @@ protected:
     bool physicsStepping_{};
     /// Applying transforms.
     bool applyingTransforms_{};
+    /// Apply world transforms in worker threads flag.
+    bool threadedTransforms_{};
     /// Rigid bodies.
     Vector<WeakPtr<RigidBody2D> > rigidBodies_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody2D*, DelayedWorldTransform2D> delayedWorldTransforms_;
+    /// Rigid bodies whose world transforms are applied in worker threads.
+    PODVector<RigidBody2D*> threadedRigidBodies_;
 
     /// Contact info.
     struct ContactInfo
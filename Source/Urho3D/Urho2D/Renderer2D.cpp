@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/FrameArena.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
@@ -49,6 +50,10 @@ namespace Urho3D
 extern const char* blendModeNames[];
 
 static const unsigned MASK_VERTEX2D = MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1;
+/// Minimum number of source batches per work item when sorting in worker threads.
+static const unsigned MIN_SORT_BATCHES_PER_ITEM = 4096;
+/// Minimum number of vertices per work item when copying vertices in worker threads.
+static const unsigned MIN_COPY_VERTICES_PER_ITEM = 16384;
 
 ViewBatchInfo2D::ViewBatchInfo2D() :
     vertexBufferUpdateFrameNumber_(0),
@@ -63,7 +68,9 @@ Renderer2D::Renderer2D(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY),
     material_(new Material(context)),
     indexBuffer_(new IndexBuffer(context_)),
-    viewMask_(DEFAULT_VIEWMASK)
+    viewMask_(DEFAULT_VIEWMASK),
+    viewCamera_(nullptr),
+    collectSourceBatches_(false)
 {
     material_->SetName("Urho2D");
 
@@ -200,15 +207,7 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
             auto* dest = reinterpret_cast<Vertex2D*>(vertexBuffer->Lock(0, vertexCount, true));
             if (dest)
             {
-                const PODVector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
-                for (unsigned b = 0; b < sourceBatches.Size(); ++b)
-                {
-                    const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
-                    for (unsigned i = 0; i < vertices.Size(); ++i)
-                        dest[i] = vertices[i];
-                    dest += vertices.Size();
-                }
-
+                CopyVertices(dest, viewBatchInfo.sourceBatches_, vertexCount);
                 vertexBuffer->Unlock();
             }
             else
@@ -309,11 +308,34 @@ void CheckDrawableVisibilityWork(const WorkItem* item, unsigned threadIndex)
     auto** start = reinterpret_cast<Drawable2D**>(item->start_);
     auto** end = reinterpret_cast<Drawable2D**>(item->end_);
 
+    PODVector<const SourceBatch2D*>* sourceBatches =
+        renderer->collectSourceBatches_ ? &renderer->threadSourceBatches_[threadIndex] : nullptr;
+
     while (start != end)
     {
         Drawable2D* drawable = *start++;
         if (renderer->CheckVisibility(drawable))
+        {
             drawable->MarkInView(renderer->frame_);
+
+            // Update the vertices and camera distances of the visible drawables here as well, to have them in parallel
+            if (sourceBatches)
+            {
+                const Vector<SourceBatch2D>& batches = drawable->GetSourceBatches();
+                if (batches.Empty())
+                    continue;
+
+                float distance = renderer->viewCamera_->GetDistance(drawable->GetNode()->GetWorldPosition());
+                for (unsigned i = 0; i < batches.Size(); ++i)
+                {
+                    if (batches[i].material_ && !batches[i].vertices_.Empty())
+                    {
+                        batches[i].distance_ = distance;
+                        sourceBatches->Push(&batches[i]);
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -332,6 +354,10 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
     auto* camera = static_cast<Camera*>(eventData[P_CAMERA].GetPtr());
     frustum_ = camera->GetFrustum();
     viewMask_ = camera->GetViewMask();
+    viewCamera_ = camera;
+
+    ViewBatchInfo2D& viewBatchInfo = viewBatchInfos_[camera];
+    collectSourceBatches_ = viewBatchInfo.batchUpdatedFrameNumber_ != frame_.frameNumber_;
 
     // Check visibility
     {
@@ -339,6 +365,10 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
 
         auto* queue = GetSubsystem<WorkQueue>();
         int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+        threadSourceBatches_.Resize((unsigned)numWorkItems);
+        for (unsigned i = 0; i < threadSourceBatches_.Size(); ++i)
+            threadSourceBatches_[i].Clear();
+
         int drawablesPerItem = drawables_.Size() / numWorkItems;
 
         PODVector<Drawable2D*>::Iterator start = drawables_.Begin();
@@ -347,6 +377,7 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
             SharedPtr<WorkItem> item = queue->GetFreeItem();
             item->priority_ = M_MAX_UNSIGNED;
             item->workFunction_ = CheckDrawableVisibilityWork;
+            item->name_ = "CheckDrawableVisibilityWork";
             item->aux_ = this;
 
             PODVector<Drawable2D*>::Iterator end = drawables_.End();
@@ -363,8 +394,6 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
         queue->Complete(M_MAX_UNSIGNED);
     }
 
-    ViewBatchInfo2D& viewBatchInfo = viewBatchInfos_[camera];
-
     // Create vertex buffer
     if (!viewBatchInfo.vertexBuffer_)
         viewBatchInfo.vertexBuffer_ = new VertexBuffer(context_);
@@ -422,29 +451,13 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     if (viewBatchInfo.batchUpdatedFrameNumber_ == frame_.frameNumber_)
         return;
 
+    // The visible source batches were collected and their distances calculated during the visibility check
     PODVector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
     sourceBatches.Clear();
-    for (unsigned d = 0; d < drawables_.Size(); ++d)
-    {
-        if (!drawables_[d]->IsInView(camera))
-            continue;
+    for (unsigned i = 0; i < threadSourceBatches_.Size(); ++i)
+        sourceBatches.Push(threadSourceBatches_[i]);
 
-        const Vector<SourceBatch2D>& batches = drawables_[d]->GetSourceBatches();
-        for (unsigned b = 0; b < batches.Size(); ++b)
-        {
-            if (batches[b].material_ && !batches[b].vertices_.Empty())
-                sourceBatches.Push(&batches[b]);
-        }
-    }
-
-    for (unsigned i = 0; i < sourceBatches.Size(); ++i)
-    {
-        const SourceBatch2D* sourceBatch = sourceBatches[i];
-        Vector3 worldPos = sourceBatch->owner_->GetNode()->GetWorldPosition();
-        sourceBatch->distance_ = camera->GetDistance(worldPos);
-    }
-
-    Sort(sourceBatches.Begin(), sourceBatches.End(), CompareSourceBatch2Ds);
+    SortSourceBatches(sourceBatches);
 
     viewBatchInfo.batchCount_ = 0;
     Material* currMaterial = nullptr;
@@ -489,6 +502,139 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     viewBatchInfo.batchUpdatedFrameNumber_ = frame_.frameNumber_;
 }
 
+static void SortSourceBatchesWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<const SourceBatch2D**>(item->start_);
+    auto** end = reinterpret_cast<const SourceBatch2D**>(item->end_);
+    Sort(RandomAccessIterator<const SourceBatch2D*>(start), RandomAccessIterator<const SourceBatch2D*>(end), CompareSourceBatch2Ds);
+}
+
+static void CopyVerticesWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<const SourceBatch2D**>(item->start_);
+    auto** end = reinterpret_cast<const SourceBatch2D**>(item->end_);
+    auto* dest = reinterpret_cast<Vertex2D*>(item->aux_);
+
+    while (start != end)
+    {
+        const Vector<Vertex2D>& vertices = (*start++)->vertices_;
+        for (unsigned i = 0; i < vertices.Size(); ++i)
+            dest[i] = vertices[i];
+        dest += vertices.Size();
+    }
+}
+
+void Renderer2D::SortSourceBatches(PODVector<const SourceBatch2D*>& sourceBatches)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numBatches = sourceBatches.Size();
+    unsigned numRanges = Min(queue->GetNumThreads() + 1, numBatches / MIN_SORT_BATCHES_PER_ITEM);
+    if (numRanges <= 1)
+    {
+        Sort(sourceBatches.Begin(), sourceBatches.End(), CompareSourceBatch2Ds);
+        return;
+    }
+
+    URHO3D_PROFILE(SortSourceBatches2D);
+
+    // Sort equal ranges in parallel. The range bookkeeping is temporary, so it is allocated from the frame arena
+    auto* arena = GetSubsystem<FrameArena>();
+    FrameVector<unsigned> rangeStarts(arena, 0, numRanges + 1);
+    for (unsigned i = 0; i <= numRanges; ++i)
+        rangeStarts[i] = numBatches * i / numRanges;
+
+    for (unsigned i = 0; i < numRanges; ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = SortSourceBatchesWork;
+        item->name_ = "SortSourceBatchesWork";
+        item->start_ = sourceBatches.Buffer() + rangeStarts[i];
+        item->end_ = sourceBatches.Buffer() + rangeStarts[i + 1];
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+
+    // Merge pairs of sorted ranges until one is left. As the comparison is a total order, the result equals a serial sort
+    sortBuffer_.Resize(numBatches);
+    const SourceBatch2D** src = sourceBatches.Buffer();
+    const SourceBatch2D** dest = sortBuffer_.Buffer();
+    while (rangeStarts.Size() > 2)
+    {
+        FrameVector<unsigned> mergedStarts(arena);
+        mergedStarts.Reserve(rangeStarts.Size() / 2 + 1);
+        for (unsigned i = 0; i + 1 < rangeStarts.Size(); i += 2)
+        {
+            mergedStarts.Push(rangeStarts[i]);
+
+            const SourceBatch2D** a = src + rangeStarts[i];
+            const SourceBatch2D** aEnd = src + rangeStarts[i + 1];
+            const SourceBatch2D** b = aEnd;
+            const SourceBatch2D** bEnd = i + 2 < rangeStarts.Size() ? src + rangeStarts[i + 2] : aEnd;
+            const SourceBatch2D** out = dest + rangeStarts[i];
+            while (a != aEnd && b != bEnd)
+                *out++ = CompareSourceBatch2Ds(*b, *a) ? *b++ : *a++;
+            while (a != aEnd)
+                *out++ = *a++;
+            while (b != bEnd)
+                *out++ = *b++;
+        }
+        mergedStarts.Push(numBatches);
+
+        rangeStarts.Swap(mergedStarts);
+        Swap(src, dest);
+    }
+
+    if (src != sourceBatches.Buffer())
+        sourceBatches.Swap(sortBuffer_);
+}
+
+void Renderer2D::CopyVertices(Vertex2D* dest, const PODVector<const SourceBatch2D*>& sourceBatches, unsigned vertexCount)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numItems = Min(queue->GetNumThreads() + 1, vertexCount / MIN_COPY_VERTICES_PER_ITEM);
+    if (numItems <= 1)
+    {
+        for (unsigned b = 0; b < sourceBatches.Size(); ++b)
+        {
+            const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
+            for (unsigned i = 0; i < vertices.Size(); ++i)
+                dest[i] = vertices[i];
+            dest += vertices.Size();
+        }
+        return;
+    }
+
+    URHO3D_PROFILE(CopyVertices2D);
+
+    // Split the source batches into ranges of about equal vertex count
+    auto** batches = const_cast<const SourceBatch2D**>(sourceBatches.Buffer());
+    unsigned verticesPerItem = vertexCount / numItems;
+    unsigned rangeStart = 0;
+    unsigned rangeVertices = 0;
+    for (unsigned b = 0; b < sourceBatches.Size(); ++b)
+    {
+        rangeVertices += sourceBatches[b]->vertices_.Size();
+        if (rangeVertices < verticesPerItem && b + 1 < sourceBatches.Size())
+            continue;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CopyVerticesWork;
+        item->name_ = "CopyVerticesWork";
+        item->aux_ = dest;
+        item->start_ = batches + rangeStart;
+        item->end_ = batches + b + 1;
+        queue->AddWorkItem(item);
+
+        dest += rangeVertices;
+        rangeStart = b + 1;
+        rangeVertices = 0;
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 void Renderer2D::AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material,
     unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance)
 {
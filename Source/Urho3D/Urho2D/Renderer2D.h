@@ -35,6 +35,7 @@ class Technique;
 class VertexBuffer;
 struct FrameInfo;
 struct SourceBatch2D;
+struct Vertex2D;
 
 /// 2D view batch info.
 struct ViewBatchInfo2D
@@ -109,6 +110,10 @@ private:
     void GetDrawables(PODVector<Drawable2D*>& drawables, Node* node);
     /// Update view batch info.
     void UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera);
+    /// Sort source batches by draw order, distance and material. Large amounts are sorted in ranges in worker threads and then merged.
+    void SortSourceBatches(PODVector<const SourceBatch2D*>& sourceBatches);
+    /// Copy the source batch vertices to a locked vertex buffer. Large amounts are copied in worker threads.
+    void CopyVertices(Vertex2D* dest, const PODVector<const SourceBatch2D*>& sourceBatches, unsigned vertexCount);
     /// Add view batch.
     void AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material,
         unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance);
@@ -127,6 +132,14 @@ private:
     Frustum frustum_;
     /// View mask of current camera for visibility checking.
     unsigned viewMask_;
+    /// Current camera for the source batch distances.
+    Camera* viewCamera_;
+    /// Collect the visible source batches during the visibility check flag.
+    bool collectSourceBatches_;
+    /// Visible source batches per thread.
+    Vector<PODVector<const SourceBatch2D*> > threadSourceBatches_;
+    /// Buffer for merging the sorted source batch ranges.
+    PODVector<const SourceBatch2D*> sortBuffer_;
     /// Cached materials.
     HashMap<Texture2D*, HashMap<int, SharedPtr<Material> > > cachedMaterials_;
     /// Cached techniques per blend mode.
@@ -457,11 +457,14 @@ void RigidBody2D::ApplyWorldTransform(const Vector3& newWorldPosition, const Qua
 {
     if (newWorldPosition != node_->GetWorldPosition() || newWorldRotation != node_->GetWorldRotation())
     {
-        // Do not feed changed position back to simulation now
-        physicsWorld_->SetApplyingTransforms(true);
+        // Do not feed changed position back to simulation now. When applying in worker threads, the flag is already set
+        bool applyingTransforms = physicsWorld_->IsApplyingTransforms();
+        if (!applyingTransforms)
+            physicsWorld_->SetApplyingTransforms(true);
         node_->SetWorldPosition(newWorldPosition);
         node_->SetWorldRotation(newWorldRotation);
-        physicsWorld_->SetApplyingTransforms(false);
+        if (!applyingTransforms)
+            physicsWorld_->SetApplyingTransforms(false);
     }
 }
 
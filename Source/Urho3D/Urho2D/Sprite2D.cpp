@@ -28,6 +28,7 @@
 #include "../Resource/ResourceCache.h"
 #include "../Urho2D/Drawable2D.h"
 #include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
 #include "../Urho2D/SpriteSheet2D.h"
 
 #include "../DebugNew.h"
@@ -39,7 +40,8 @@ Sprite2D::Sprite2D(Context* context) :
     Resource(context),
     hotSpot_(0.5f, 0.5f),
     offset_(0, 0),
-    edgeOffset_(M_LARGE_EPSILON)
+    edgeOffset_(M_LARGE_EPSILON),
+    rotated_(false)
 {
 
 }
@@ -56,8 +58,8 @@ bool Sprite2D::BeginLoad(Deserializer& source)
     if (GetName().Empty())
         SetName(source.GetName());
 
-    // Reload
-    if (texture_)
+    // Reload into the own texture, but not into a texture shared with other sprites, such as an atlas page
+    if (texture_ && texture_->GetName() == GetName())
         loadTexture_ = texture_;
     else
     {
@@ -89,6 +91,10 @@ bool Sprite2D::EndLoad()
 
         if (texture_)
             SetRectangle(IntRect(0, 0, texture_->GetWidth(), texture_->GetHeight()));
+
+        auto* atlas = GetSubsystem<SpriteAtlas2D>();
+        if (atlas && atlas->IsEnabled())
+            atlas->AddSprite(this);
     }
     else
     {
@@ -135,6 +141,11 @@ void Sprite2D::SetTextureEdgeOffset(float offset)
     edgeOffset_ = offset;
 }
 
+void Sprite2D::SetRotated(bool enable)
+{
+    rotated_ = enable;
+}
+
 void Sprite2D::SetSpriteSheet(SpriteSheet2D* spriteSheet)
 {
     spriteSheet_ = spriteSheet;
@@ -150,8 +161,8 @@ bool Sprite2D::GetDrawRectangle(Rect& rect, const Vector2& hotSpot, bool flipX,
     if (rectangle_.Width() == 0 || rectangle_.Height() == 0)
         return false;
 
-    float width = (float)rectangle_.Width() * PIXEL_SIZE;
-    float height = (float)rectangle_.Height() * PIXEL_SIZE;
+    float width = (float)(rotated_ ? rectangle_.Height() : rectangle_.Width()) * PIXEL_SIZE;
+    float height = (float)(rotated_ ? rectangle_.Width() : rectangle_.Height()) * PIXEL_SIZE;
 
     float hotSpotX = flipX ? (1.0f - hotSpot.x_) : hotSpot.x_;
     float hotSpotY = flipY ? (1.0f - hotSpot.y_) : hotSpot.y_;
@@ -178,15 +189,35 @@ bool Sprite2D::GetTextureRectangle(Rect& rect, bool flipX, bool flipY) const
     rect.min_.y_ = ((float)rectangle_.bottom_ - edgeOffset_) * invHeight;
     rect.max_.y_ = ((float)rectangle_.top_ + edgeOffset_) * invHeight;
 
-    if (flipX)
+    // The sprite's horizontal axis runs down the texture when rotated
+    if (rotated_ ? flipY : flipX)
         Swap(rect.min_.x_, rect.max_.x_);
 
-    if (flipY)
+    if (rotated_ ? flipX : flipY)
         Swap(rect.min_.y_, rect.max_.y_);
 
     return true;
 }
 
+void Sprite2D::GetTextureCorners(const Rect& textureRect, Vector2* corners) const
+{
+    if (!rotated_)
+    {
+        corners[0] = textureRect.min_;
+        corners[1] = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+        corners[2] = textureRect.max_;
+        corners[3] = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+    }
+    else
+    {
+        // The sprite's bottom left corner is at the top left of the texture rectangle
+        corners[0] = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+        corners[1] = textureRect.max_;
+        corners[2] = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+        corners[3] = textureRect.min_;
+    }
+}
+
 ResourceRef Sprite2D::SaveToResourceRef(Sprite2D* sprite)
 {
     SpriteSheet2D* spriteSheet = nullptr;
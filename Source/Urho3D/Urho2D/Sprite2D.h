@@ -58,6 +58,8 @@ public:
     void SetOffset(const IntVector2& offset);
     /// Set texture edge offset in pixels. This affects the left/right and top/bottom edges equally to prevent edge sampling artifacts. Default 0.
     void SetTextureEdgeOffset(float offset);
+    /// Set whether the sprite is stored rotated 90 degrees clockwise within the rectangle, as sprite sheet packers may do to fit more sprites.
+    void SetRotated(bool enable);
     /// Set sprite sheet.
     void SetSpriteSheet(SpriteSheet2D* spriteSheet);
 
@@ -76,6 +78,9 @@ public:
     /// Return texture edge offset.
     float GetTextureEdgeOffset() const { return edgeOffset_; }
 
+    /// Return whether the sprite is stored rotated within the rectangle.
+    bool IsRotated() const { return rotated_; }
+
     /// Return sprite sheet.
     SpriteSheet2D* GetSpriteSheet() const { return spriteSheet_; }
 
@@ -84,8 +89,10 @@ public:
     bool GetDrawRectangle(Rect& rect, bool flipX = false, bool flipY = false) const;
     /// Return draw rectangle with custom hot spot.
     bool GetDrawRectangle(Rect& rect, const Vector2& hotSpot, bool flipX = false, bool flipY = false) const;
-    /// Return texture rectangle.
+    /// Return texture rectangle. When the sprite is rotated, the flips apply along the sprite's axes.
     bool GetTextureRectangle(Rect& rect, bool flipX = false, bool flipY = false) const;
+    /// Return texture coordinates of the draw rectangle's bottom left, top left, top right and bottom right corners from a texture rectangle, accounting for rotation.
+    void GetTextureCorners(const Rect& textureRect, Vector2* corners) const;
 
     /// Save sprite to ResourceRef.
     static ResourceRef SaveToResourceRef(Sprite2D* sprite);
@@ -107,6 +114,8 @@ private:
     SharedPtr<Texture2D> loadTexture_;
     /// Offset to fix texture edge bleeding.
     float edgeOffset_;
+    /// Rotated in the rectangle flag.
+    bool rotated_;
 };
 
 }
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Texture2D.h"
+#include "../IO/Log.h"
+#include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+SpriteAtlas2D::SpriteAtlas2D(Context* context) :
+    Object(context),
+    pageSize_(2048),
+    maxSpriteSize_(256),
+    padding_(1),
+    numSprites_(0),
+    enabled_(false)
+{
+}
+
+SpriteAtlas2D::~SpriteAtlas2D() = default;
+
+void SpriteAtlas2D::SetEnabled(bool enable)
+{
+    enabled_ = enable;
+}
+
+void SpriteAtlas2D::SetPageSize(int size)
+{
+    pageSize_ = Max(size, 1);
+}
+
+void SpriteAtlas2D::SetMaxSpriteSize(int size)
+{
+    maxSpriteSize_ = Max(size, 1);
+}
+
+void SpriteAtlas2D::SetPadding(int padding)
+{
+    padding_ = Max(padding, 0);
+}
+
+bool SpriteAtlas2D::AddSprite(Sprite2D* sprite)
+{
+    if (!sprite || sprite->GetSpriteSheet() || !GetSubsystem<Graphics>())
+        return false;
+
+    Texture2D* texture = sprite->GetTexture();
+    if (!texture || IsPage(texture))
+        return false;
+
+    const IntRect& rect = sprite->GetRectangle();
+    int width = rect.Width();
+    int height = rect.Height();
+    int paddedWidth = width + 2 * padding_;
+    int paddedHeight = height + 2 * padding_;
+    if (width <= 0 || height <= 0 || width > maxSpriteSize_ || height > maxSpriteSize_ || paddedWidth > pageSize_ ||
+        paddedHeight > pageSize_)
+        return false;
+    if (rect.left_ < 0 || rect.top_ < 0 || rect.right_ > texture->GetWidth() || rect.bottom_ > texture->GetHeight())
+        return false;
+
+    unsigned format = texture->GetFormat();
+    if (format != Graphics::GetRGBAFormat() && format != Graphics::GetRGBFormat())
+        return false;
+
+    unsigned components = texture->GetComponents();
+    sourceData_.Resize(texture->GetDataSize(texture->GetWidth(), texture->GetHeight()));
+    if (!texture->GetData(0, sourceData_.Buffer()))
+    {
+        // Texture data can not be read back on this platform, so stop trying on each load
+        URHO3D_LOGWARNING("Failed to read back texture " + texture->GetName() + ", disabling sprite atlas");
+        enabled_ = false;
+        return false;
+    }
+
+    // Copy the sprite rectangle and repeat its edge pixels into the padding
+    pixels_.Resize((unsigned)(paddedWidth * paddedHeight * 4));
+    unsigned char* dest = pixels_.Buffer();
+    for (int y = 0; y < paddedHeight; ++y)
+    {
+        int sourceY = rect.top_ + Clamp(y - padding_, 0, height - 1);
+        for (int x = 0; x < paddedWidth; ++x)
+        {
+            int sourceX = rect.left_ + Clamp(x - padding_, 0, width - 1);
+            const unsigned char* src = sourceData_.Buffer() + (sourceY * texture->GetWidth() + sourceX) * components;
+            dest[0] = src[0];
+            dest[1] = src[1];
+            dest[2] = src[2];
+            dest[3] = components == 4 ? src[3] : 255;
+            dest += 4;
+        }
+    }
+
+    Page* page = nullptr;
+    int x = 0;
+    int y = 0;
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        Texture2D* pageTexture = pages_[i].texture_;
+        if (pageTexture->GetFilterMode() == texture->GetFilterMode() && pageTexture->GetSRGB() == texture->GetSRGB() &&
+            pages_[i].allocator_.Allocate(paddedWidth, paddedHeight, x, y))
+        {
+            page = &pages_[i];
+            break;
+        }
+    }
+
+    if (!page)
+    {
+        // Pages are not mipmapped, as the padding would only protect the full resolution level
+        SharedPtr<Texture2D> pageTexture(new Texture2D(context_));
+        pageTexture->SetName("SpriteAtlas2D_Page" + String(pages_.Size()));
+        pageTexture->SetNumLevels(1);
+        pageTexture->SetFilterMode(texture->GetFilterMode());
+        pageTexture->SetAddressMode(COORD_U, ADDRESS_CLAMP);
+        pageTexture->SetAddressMode(COORD_V, ADDRESS_CLAMP);
+        pageTexture->SetSRGB(texture->GetSRGB());
+        if (!pageTexture->SetSize(pageSize_, pageSize_, Graphics::GetRGBAFormat()))
+            return false;
+
+        pages_.Resize(pages_.Size() + 1);
+        page = &pages_.Back();
+        page->texture_ = pageTexture;
+        page->allocator_.Reset(pageSize_, pageSize_, 0, 0, false);
+        if (!page->allocator_.Allocate(paddedWidth, paddedHeight, x, y))
+            return false;
+    }
+
+    if (!page->texture_->SetData(0, x, y, paddedWidth, paddedHeight, pixels_.Buffer()))
+        return false;
+
+    sprite->SetTexture(page->texture_);
+    sprite->SetRectangle(IntRect(x + padding_, y + padding_, x + padding_ + width, y + padding_ + height));
+    ++numSprites_;
+    return true;
+}
+
+void SpriteAtlas2D::Clear()
+{
+    pages_.Clear();
+    numSprites_ = 0;
+}
+
+Texture2D* SpriteAtlas2D::GetPage(unsigned index) const
+{
+    return index < pages_.Size() ? pages_[index].texture_.Get() : nullptr;
+}
+
+bool SpriteAtlas2D::IsPage(Texture2D* texture) const
+{
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        if (pages_[i].texture_ == texture)
+            return true;
+    }
+    return false;
+}
+
+}
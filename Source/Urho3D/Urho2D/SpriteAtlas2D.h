@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Core/Object.h"
+#include "../Graphics/GraphicsDefs.h"
+#include "../Math/AreaAllocator.h"
+
+namespace Urho3D
+{
+
+class Sprite2D;
+class Texture2D;
+
+/// Packs standalone sprites at runtime into shared atlas page textures. Drawables using sprites on the same page with the same blend mode share a material, so Renderer2D merges their batches without changing the draw order.
+class URHO3D_API SpriteAtlas2D : public Object
+{
+    URHO3D_OBJECT(SpriteAtlas2D, Object);
+
+public:
+    /// Construct.
+    explicit SpriteAtlas2D(Context* context);
+    /// Destruct.
+    ~SpriteAtlas2D() override;
+
+    /// Set whether sprites are packed automatically when they finish loading. Default false.
+    void SetEnabled(bool enable);
+    /// Set width and height of page textures created from now on. Default 2048.
+    void SetPageSize(int size);
+    /// Set maximum sprite width or height to pack. Larger sprites keep their own texture. Default 256.
+    void SetMaxSpriteSize(int size);
+    /// Set number of edge pixels repeated around each packed sprite to prevent bleeding from its neighbours. Default 1.
+    void SetPadding(int padding);
+    /// Copy a sprite's image into an atlas page and point the sprite to the page. Sprites of sprite sheets, sprites already packed and sprites with compressed or oversized textures are skipped. Should be called before drawables use the sprite. Return true if packed.
+    bool AddSprite(Sprite2D* sprite);
+    /// Release the pages. Packed sprites keep referencing their page textures.
+    void Clear();
+
+    /// Return whether sprites are packed automatically.
+    bool IsEnabled() const { return enabled_; }
+    /// Return page texture size.
+    int GetPageSize() const { return pageSize_; }
+    /// Return maximum sprite size to pack.
+    int GetMaxSpriteSize() const { return maxSpriteSize_; }
+    /// Return padding pixels.
+    int GetPadding() const { return padding_; }
+    /// Return number of pages.
+    unsigned GetNumPages() const { return pages_.Size(); }
+    /// Return page texture by index.
+    Texture2D* GetPage(unsigned index) const;
+    /// Return number of packed sprites.
+    unsigned GetNumSprites() const { return numSprites_; }
+    /// Return whether a texture is an atlas page.
+    bool IsPage(Texture2D* texture) const;
+
+private:
+    /// Atlas page.
+    struct Page
+    {
+        /// Page texture.
+        SharedPtr<Texture2D> texture_;
+        /// Area allocator.
+        AreaAllocator allocator_;
+    };
+
+    /// Pages. Sprites with different filter modes or sRGB settings go to different pages.
+    Vector<Page> pages_;
+    /// Copied pixels including the padding.
+    PODVector<unsigned char> pixels_;
+    /// Source texture data.
+    PODVector<unsigned char> sourceData_;
+    /// Page texture size.
+    int pageSize_;
+    /// Maximum sprite size to pack.
+    int maxSpriteSize_;
+    /// Padding pixels.
+    int padding_;
+    /// Number of packed sprites.
+    unsigned numSprites_;
+    /// Automatic packing flag.
+    bool enabled_;
+};
+
+}
@@ -245,6 +245,10 @@ bool SpriteSheet2D::EndLoadFromXMLFile()
         int width = subTextureElem.GetInt("width");
         int height = subTextureElem.GetInt("height");
         IntRect rectangle(x, y, x + width, y + height);
+        // A rotated sprite is stored turned clockwise, so its upright size is transposed
+        bool rotated = subTextureElem.GetBool("rotated");
+        if (rotated)
+            Swap(width, height);
 
         Vector2 hotSpot(0.5f, 0.5f);
         IntVector2 offset(0, 0);
@@ -259,6 +263,8 @@ bool SpriteSheet2D::EndLoadFromXMLFile()
         }
 
         DefineSprite(name, rectangle, hotSpot, offset);
+        if (rotated)
+            GetSprite(name)->SetRotated(true);
 
         subTextureElem = subTextureElem.GetNext("SubTexture");
     }
@@ -321,6 +327,9 @@ bool SpriteSheet2D::EndLoadFromJSONFile()
         int width = subTextureVal.Get("width").GetInt();
         int height = subTextureVal.Get("height").GetInt();
         IntRect rectangle(x, y, x + width, y + height);
+        bool rotated = subTextureVal.Get("rotated").GetBool();
+        if (rotated)
+            Swap(width, height);
 
         Vector2 hotSpot(0.5f, 0.5f);
         IntVector2 offset(0, 0);
@@ -338,7 +347,8 @@ bool SpriteSheet2D::EndLoadFromJSONFile()
         }
 
         DefineSprite(name, rectangle, hotSpot, offset);
-
+        if (rotated)
+            GetSprite(name)->SetRotated(true);
     }
 
     loadJSONFile_.Reset();
@@ -243,6 +243,8 @@ Animation::~Animation()
 
 void Animation::Reset()
 {
+    ClearPoseCache();
+
     if (!mainlineKeys_.Empty())
     {
         for (unsigned i = 0; i < mainlineKeys_.Size(); ++i)
@@ -255,6 +257,16 @@ void Animation::Reset()
     timelines_.Clear();
 }
 
+void Animation::ClearPoseCache()
+{
+    for (HashMap<unsigned long long, PODVector<SpatialTimelineKey*> >::Iterator i = poseCache_.Begin(); i != poseCache_.End(); ++i)
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+            delete i->second_[j];
+    }
+    poseCache_.Clear();
+}
+
 bool Animation::Load(const pugi::xml_node& node)
 {
     Reset();
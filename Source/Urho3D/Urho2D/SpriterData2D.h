@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../Container/HashMap.h"
+
 namespace pugi
 {
 class xml_node;
@@ -148,6 +150,7 @@ struct Animation
 
     void Reset();
     bool Load(const pugi::xml_node& node);
+    void ClearPoseCache();
 
     int id_{};
     String name_;
@@ -155,6 +158,7 @@ struct Animation
     bool looping_{};
     PODVector<MainlineKey*> mainlineKeys_;
     PODVector<Timeline*> timelines_;
+    HashMap<unsigned long long, PODVector<SpatialTimelineKey*> > poseCache_;
 };
 
 /// Mainline key.
@@ -35,6 +35,9 @@ namespace Urho3D
 namespace Spriter
 {
 
+/// Maximum number of cached poses per animation. When full, further poses are evaluated per instance.
+static const unsigned MAX_CACHED_POSES = 4096;
+
 SpriterInstance::SpriterInstance(Component* owner, SpriterData* spriteData) :
     owner_(owner),
     spriterData_(spriteData),
@@ -122,6 +125,11 @@ void SpriterInstance::setSpatialInfo(float x, float y, float angle, float scaleX
     spatialInfo_ = SpatialInfo(x, y, angle, scaleX, scaleY);
 }
 
+void SpriterInstance::SetTimeQuantum(float quantum)
+{
+    timeQuantum_ = Max(quantum, 0.0f);
+}
+
 void SpriterInstance::Update(float deltaTime)
 {
     if (!animation_)
@@ -164,8 +172,40 @@ void SpriterInstance::Update(float deltaTime)
         }
     }
 
-    UpdateMainlineKey();
-    UpdateTimelineKeys();
+    // The root spatial info is applied during evaluation, so only poses with the default root can be shared
+    if (timeQuantum_ > 0.0f && spatialInfo_.x_ == 0.0f && spatialInfo_.y_ == 0.0f && spatialInfo_.angle_ == 0.0f &&
+        spatialInfo_.scaleX_ == 1.0f && spatialInfo_.scaleY_ == 1.0f && spatialInfo_.alpha_ == 1.0f)
+        UpdateCachedPose();
+    else
+    {
+        UpdateMainlineKey(currentTime_);
+        UpdateTimelineKeys(currentTime_);
+    }
+}
+
+void SpriterInstance::UpdateCachedPose()
+{
+    auto step = (unsigned)(currentTime_ / timeQuantum_ + 0.5f);
+    unsigned long long key = ((unsigned long long)(timeQuantum_ * 1000000.0f) << 32u) | step;
+
+    HashMap<unsigned long long, PODVector<SpatialTimelineKey*> >::ConstIterator i = animation_->poseCache_.Find(key);
+    if (i != animation_->poseCache_.End())
+    {
+        timelineKeys_ = i->second_;
+        sharedTimelineKeys_ = true;
+        return;
+    }
+
+    float time = Min(step * timeQuantum_, animation_->length_);
+    UpdateMainlineKey(time);
+    UpdateTimelineKeys(time);
+
+    // Other instances may be using the cached poses until their next update, so a full cache is not cleared
+    if (animation_->poseCache_.Size() < MAX_CACHED_POSES)
+    {
+        animation_->poseCache_[key] = timelineKeys_;
+        sharedTimelineKeys_ = true;
+    }
 }
 
 void SpriterInstance::OnSetEntity(Entity* entity)
@@ -198,12 +238,12 @@ void SpriterInstance::OnSetAnimation(Animation* animation, LoopMode loopMode)
     Clear();
 }
 
-void SpriterInstance::UpdateTimelineKeys()
+void SpriterInstance::UpdateTimelineKeys(float time)
 {
     for (unsigned i = 0; i < mainlineKey_->boneRefs_.Size(); ++i)
     {
         Ref* ref = mainlineKey_->boneRefs_[i];
-        auto* timelineKey = (BoneTimelineKey*)GetTimelineKey(ref);
+        auto* timelineKey = (BoneTimelineKey*)GetTimelineKey(ref, time);
         if (ref->parent_ >= 0)
         {
             timelineKey->info_ = timelineKey->info_.UnmapFromParent(timelineKeys_[ref->parent_]->info_);
@@ -218,7 +258,7 @@ void SpriterInstance::UpdateTimelineKeys()
     for (unsigned i = 0; i < mainlineKey_->objectRefs_.Size(); ++i)
     {
         Ref* ref = mainlineKey_->objectRefs_[i];
-        auto* timelineKey = (SpriteTimelineKey*)GetTimelineKey(ref);
+        auto* timelineKey = (SpriteTimelineKey*)GetTimelineKey(ref, time);
 
         if (ref->parent_ >= 0)
         {
@@ -235,17 +275,17 @@ void SpriterInstance::UpdateTimelineKeys()
     }
 }
 
-void SpriterInstance::UpdateMainlineKey()
+void SpriterInstance::UpdateMainlineKey(float time)
 {
     const PODVector<MainlineKey*>& mainlineKeys = animation_->mainlineKeys_;
     for (unsigned i = 0; i < mainlineKeys.Size(); ++i)
     {
-        if (mainlineKeys[i]->time_ <= currentTime_)
+        if (mainlineKeys[i]->time_ <= time)
         {
             mainlineKey_ = mainlineKeys[i];
         }
 
-        if (mainlineKeys[i]->time_ >= currentTime_)
+        if (mainlineKeys[i]->time_ >= time)
         {
             break;
         }
@@ -257,7 +297,7 @@ void SpriterInstance::UpdateMainlineKey()
     }
 }
 
-TimelineKey* SpriterInstance::GetTimelineKey(Ref* ref) const
+TimelineKey* SpriterInstance::GetTimelineKey(Ref* ref, float time) const
 {
     Timeline* timeline = animation_->timelines_[ref->timeline_];
     TimelineKey* timelineKey = timeline->keys_[ref->key_]->Clone();
@@ -287,7 +327,7 @@ TimelineKey* SpriterInstance::GetTimelineKey(Ref* ref) const
         nextTimelineKeyTime += animation_->length_;
     }
 
-    float t = timelineKey->GetTByCurveType(currentTime_, nextTimelineKeyTime);
+    float t = timelineKey->GetTByCurveType(time, nextTimelineKeyTime);
     timelineKey->Interpolate(*nextTimelineKey, t);
 
     return timelineKey;
@@ -297,7 +337,13 @@ void SpriterInstance::Clear()
 {
     mainlineKey_ = nullptr;
 
-    if (!timelineKeys_.Empty())
+    // Keys shared through the animation's pose cache are deleted by the animation
+    if (sharedTimelineKeys_)
+    {
+        timelineKeys_.Clear();
+        sharedTimelineKeys_ = false;
+    }
+    else if (!timelineKeys_.Empty())
     {
         for (unsigned i = 0; i < timelineKeys_.Size(); ++i)
         {
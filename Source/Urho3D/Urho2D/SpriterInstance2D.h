@@ -61,6 +61,8 @@ public:
     void setSpatialInfo(const SpatialInfo& spatialInfo);
     /// Set root spatial info.
     void setSpatialInfo(float x, float y, float angle, float scaleX, float scaleY);
+    /// Set the time step to which the evaluated animation time is quantized. When positive and the root spatial info is the default, the poses are shared with the other instances through a cache in the animation. 0 evaluates the exact time.
+    void SetTimeQuantum(float quantum);
     /// Update animation.
     void Update(float deltaTime);
 
@@ -72,6 +74,8 @@ public:
     const SpatialInfo& GetSpatialInfo() const { return spatialInfo_; }
     /// Return animation result timeline keys.
     const PODVector<SpatialTimelineKey*>& GetTimelineKeys() const { return timelineKeys_; }
+    /// Return the time quantum.
+    float GetTimeQuantum() const { return timeQuantum_; }
 
 private:
     /// Handle set entity.
@@ -79,11 +83,13 @@ private:
     /// Handle set animation.
     void OnSetAnimation(Animation* animation, LoopMode loopMode = Default);
     /// Update mainline key.
-    void UpdateMainlineKey();
+    void UpdateMainlineKey(float time);
     /// Update timeline keys.
-    void UpdateTimelineKeys();
+    void UpdateTimelineKeys(float time);
+    /// Use the shared pose of the quantized current time, evaluating it if not cached yet.
+    void UpdateCachedPose();
     /// Get timeline key by ref.
-    TimelineKey* GetTimelineKey(Ref* ref) const;
+    TimelineKey* GetTimelineKey(Ref* ref, float time) const;
     /// Clear mainline key and timeline keys.
     void Clear();
 
@@ -105,6 +111,10 @@ private:
     MainlineKey* mainlineKey_{};
     /// Current timeline keys.
     PODVector<SpatialTimelineKey*> timelineKeys_;
+    /// Time quantum for shared poses.
+    float timeQuantum_{};
+    /// Whether the timeline keys are owned by the animation's pose cache.
+    bool sharedTimelineKeys_{};
 };
 
 }
@@ -330,10 +330,12 @@ void StaticSprite2D::UpdateSourceBatches()
     vertex2.position_ = worldTransform * Vector3(drawRect_.max_.x_, drawRect_.max_.y_, 0.0f);
     vertex3.position_ = worldTransform * Vector3(drawRect_.max_.x_, drawRect_.min_.y_, 0.0f);
 
-    vertex0.uv_ = textureRect_.min_;
-    (swapXY_ ? vertex3.uv_ : vertex1.uv_) = Vector2(textureRect_.min_.x_, textureRect_.max_.y_);
-    vertex2.uv_ = textureRect_.max_;
-    (swapXY_ ? vertex1.uv_ : vertex3.uv_) = Vector2(textureRect_.max_.x_, textureRect_.min_.y_);
+    Vector2 uvs[4];
+    sprite_->GetTextureCorners(textureRect_, uvs);
+    vertex0.uv_ = uvs[0];
+    (swapXY_ ? vertex3.uv_ : vertex1.uv_) = uvs[1];
+    vertex2.uv_ = uvs[2];
+    (swapXY_ ? vertex1.uv_ : vertex3.uv_) = uvs[3];
 
     vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color_.ToUInt();
 
@@ -79,8 +79,8 @@ void prepareUVCoords(float coords[4], float low, float high, float lowBorder, fl
     coords[3] = high;
 }
 
-void prepareVertices(Vertex2D vtx[4][4], const float xs[4], const float ys[4], const float us[4], const float vs[4], unsigned color,
-    const Vector3& position, const Quaternion& rotation)
+void prepareVertices(Vertex2D vtx[4][4], const float xs[4], const float ys[4], const float us[4], const float vs[4], bool rotated,
+    unsigned color, const Vector3& position, const Quaternion& rotation)
 {
     for (unsigned i = 0; i < 4; ++i)
     {
@@ -88,7 +88,7 @@ void prepareVertices(Vertex2D vtx[4][4], const float xs[4], const float ys[4], c
         {
             vtx[i][j].position_ = position + rotation * Vector3{xs[i], ys[j], 0.0f};
             vtx[i][j].color_ = color;
-            vtx[i][j].uv_ = Vector2{us[i], vs[j]};
+            vtx[i][j].uv_ = rotated ? Vector2{vs[j], us[i]} : Vector2{us[i], vs[j]};
         }
     }
 }
@@ -180,13 +180,25 @@ void StretchableSprite2D::UpdateSourceBatches()
     prepareXYCoords(xs, drawRect_.min_.x_, drawRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_, signedScale.x_);
     prepareXYCoords(ys, drawRect_.min_.y_, drawRect_.max_.y_, effectiveBorder.min_.y_, effectiveBorder.max_.y_, signedScale.y_);
 
-    prepareUVCoords(us, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
-        drawRect_.max_.x_ - drawRect_.min_.x_);
-    prepareUVCoords(vs, textureRect_.min_.y_, textureRect_.max_.y_, -effectiveBorder.min_.y_,
-        -effectiveBorder.max_.y_ /* texture y direction inverted*/, drawRect_.max_.y_ - drawRect_.min_.y_);
+    bool rotated = sprite_->IsRotated();
+    if (!rotated)
+    {
+        prepareUVCoords(us, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
+            drawRect_.max_.x_ - drawRect_.min_.x_);
+        prepareUVCoords(vs, textureRect_.min_.y_, textureRect_.max_.y_, -effectiveBorder.min_.y_,
+            -effectiveBorder.max_.y_ /* texture y direction inverted*/, drawRect_.max_.y_ - drawRect_.min_.y_);
+    }
+    else
+    {
+        // The sprite's x axis runs down the texture and its y axis to the right
+        prepareUVCoords(us, textureRect_.max_.y_, textureRect_.min_.y_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
+            drawRect_.max_.x_ - drawRect_.min_.x_);
+        prepareUVCoords(vs, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.y_, effectiveBorder.max_.y_,
+            drawRect_.max_.y_ - drawRect_.min_.y_);
+    }
 
     Vertex2D vtx[4][4]; // prepare all vertices
-    prepareVertices(vtx, xs, ys, us, vs, color_.ToUInt(), node_->GetWorldPosition(), node_->GetWorldRotation());
+    prepareVertices(vtx, xs, ys, us, vs, rotated, color_.ToUInt(), node_->GetWorldPosition(), node_->GetWorldRotation());
 
     pushVertices(vertices, vtx); // push the vertices that make up each patch
 
@@ -51,6 +51,8 @@ void TileMap2D::RegisterObject(Context* context)
     context->RegisterFactory<TileMap2D>(URHO2D_CATEGORY);
 
     URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    // Before the tmx file, so that the layers are created only once on load
+    URHO3D_ACCESSOR_ATTRIBUTE("Tile Chunk Size", GetTileChunkSize, SetTileChunkSize, int, 0, AM_DEFAULT);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Tmx File", GetTmxFileAttr, SetTmxFileAttr, ResourceRef, ResourceRef(TmxFile2D::GetTypeStatic()),
         AM_DEFAULT);
 }
@@ -118,12 +120,27 @@ void TileMap2D::SetTmxFile(TmxFile2D* tmxFile)
     if (tmxFile == tmxFile_)
         return;
 
+    tmxFile_ = tmxFile;
+    CreateLayers();
+}
+
+void TileMap2D::SetTileChunkSize(int size)
+{
+    size = Max(size, 0);
+    if (size == tileChunkSize_)
+        return;
+
+    tileChunkSize_ = size;
+    CreateLayers();
+}
+
+void TileMap2D::CreateLayers()
+{
     if (rootNode_)
         rootNode_->RemoveAllChildren();
 
     layers_.Clear();
 
-    tmxFile_ = tmxFile;
     if (!tmxFile_)
         return;
 
@@ -49,12 +49,17 @@ public:
 
     /// Set tmx file.
     void SetTmxFile(TmxFile2D* tmxFile);
+    /// Set tile chunk size. When above 0, tile layers are drawn in chunks of this many tiles per side instead of creating a node for each tile, and tile nodes are not available. Default 0.
+    void SetTileChunkSize(int size);
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry();
 
     /// Return tmx file.
     TmxFile2D* GetTmxFile() const;
 
+    /// Return tile chunk size.
+    int GetTileChunkSize() const { return tileChunkSize_; }
+
     /// Return information.
     const TileMapInfo2D& GetInfo() const { return info_; }
 
@@ -75,6 +80,9 @@ public:
     ///
     Vector<SharedPtr<TileMapObject2D> > GetTileCollisionShapes(unsigned gid) const;
 private:
+    /// Create the layers from the tmx file.
+    void CreateLayers();
+
     /// Tmx file.
     SharedPtr<TmxFile2D> tmxFile_;
     /// Tile map information.
@@ -83,6 +91,8 @@ private:
     SharedPtr<Node> rootNode_;
     /// Tile map layers.
     Vector<WeakPtr<TileMapLayer2D> > layers_;
+    /// Tile chunk size, or 0 for a node per tile.
+    int tileChunkSize_{};
 };
 
 }
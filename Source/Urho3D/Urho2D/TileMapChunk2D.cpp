@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Texture2D.h"
+#include "../Scene/Node.h"
+#include "../Urho2D/Renderer2D.h"
+#include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
+#include "../Urho2D/TileMapLayer2D.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+TileMapChunk2D::TileMapChunk2D(Context* context) :
+    Drawable2D(context),
+    tileRect_(IntRect::ZERO)
+{
+}
+
+TileMapChunk2D::~TileMapChunk2D() = default;
+
+void TileMapChunk2D::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TileMapChunk2D>();
+}
+
+void TileMapChunk2D::SetTiles(TileMapLayer2D* layer, const IntRect& tileRect)
+{
+    tileLayer_ = layer;
+    tileRect_ = tileRect;
+    MarkTilesDirty();
+}
+
+void TileMapChunk2D::MarkTilesDirty()
+{
+    UpdateMaterials();
+    sourceBatchesDirty_ = true;
+    worldBoundingBoxDirty_ = true;
+}
+
+TileMapLayer2D* TileMapChunk2D::GetTileLayer() const
+{
+    return tileLayer_;
+}
+
+void TileMapChunk2D::OnSceneSet(Scene* scene)
+{
+    Drawable2D::OnSceneSet(scene);
+
+    UpdateMaterials();
+    sourceBatchesDirty_ = true;
+}
+
+void TileMapChunk2D::OnWorldBoundingBoxUpdate()
+{
+    boundingBox_.Clear();
+    worldBoundingBox_.Clear();
+
+    const Vector<SourceBatch2D>& sourceBatches = GetSourceBatches();
+    for (unsigned i = 0; i < sourceBatches.Size(); ++i)
+    {
+        const Vector<Vertex2D>& vertices = sourceBatches[i].vertices_;
+        for (unsigned j = 0; j < vertices.Size(); ++j)
+            worldBoundingBox_.Merge(vertices[j].position_);
+    }
+
+    boundingBox_ = worldBoundingBox_.Transformed(node_->GetWorldTransform().Inverse());
+}
+
+void TileMapChunk2D::OnDrawOrderChanged()
+{
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+        sourceBatches_[i].drawOrder_ = GetDrawOrder();
+}
+
+void TileMapChunk2D::UpdateSourceBatches()
+{
+    if (!sourceBatchesDirty_)
+        return;
+
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+        sourceBatches_[i].vertices_.Clear();
+
+    TileMap2D* tileMap = tileLayer_ ? tileLayer_->GetTileMap() : nullptr;
+    if (!tileMap)
+        return;
+
+    const TileMapInfo2D& info = tileMap->GetInfo();
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    unsigned color = Color::WHITE.ToUInt();
+
+    // Tiles are added in the same row-major order in which the tile nodes would be drawn
+    for (int y = tileRect_.top_; y < tileRect_.bottom_; ++y)
+    {
+        for (int x = tileRect_.left_; x < tileRect_.right_; ++x)
+        {
+            const Tile2D* tile = tileLayer_->GetTile(x, y);
+            Sprite2D* sprite = tile ? tile->GetSprite() : nullptr;
+            if (!sprite)
+                continue;
+
+            unsigned batchIndex = textures_.IndexOf(sprite->GetTexture());
+            if (batchIndex >= sourceBatches_.Size())
+                continue;
+
+            bool flipX = tile->GetFlipX();
+            bool flipY = tile->GetFlipY();
+            bool swapXY = tile->GetSwapXY();
+            Rect drawRect;
+            Rect textureRect;
+            if (!sprite->GetDrawRectangle(drawRect, flipX, flipY) || !sprite->GetTextureRectangle(textureRect, flipX, flipY))
+                continue;
+
+            Vector2 position = info.TileIndexToPosition(x, y);
+            drawRect.min_ += position;
+            drawRect.max_ += position;
+
+            // Same vertex layout as StaticSprite2D
+            Vertex2D vertex0;
+            Vertex2D vertex1;
+            Vertex2D vertex2;
+            Vertex2D vertex3;
+
+            vertex0.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.min_.y_, 0.0f);
+            vertex1.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.max_.y_, 0.0f);
+            vertex2.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
+            vertex3.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
+
+            Vector2 uvs[4];
+            sprite->GetTextureCorners(textureRect, uvs);
+            vertex0.uv_ = uvs[0];
+            (swapXY ? vertex3.uv_ : vertex1.uv_) = uvs[1];
+            vertex2.uv_ = uvs[2];
+            (swapXY ? vertex1.uv_ : vertex3.uv_) = uvs[3];
+
+            vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color;
+
+            Vector<Vertex2D>& vertices = sourceBatches_[batchIndex].vertices_;
+            vertices.Push(vertex0);
+            vertices.Push(vertex1);
+            vertices.Push(vertex2);
+            vertices.Push(vertex3);
+        }
+    }
+
+    sourceBatchesDirty_ = false;
+}
+
+void TileMapChunk2D::UpdateMaterials()
+{
+    textures_.Clear();
+
+    if (tileLayer_)
+    {
+        for (int y = tileRect_.top_; y < tileRect_.bottom_; ++y)
+        {
+            for (int x = tileRect_.left_; x < tileRect_.right_; ++x)
+            {
+                const Tile2D* tile = tileLayer_->GetTile(x, y);
+                Sprite2D* sprite = tile ? tile->GetSprite() : nullptr;
+                if (sprite && !textures_.Contains(sprite->GetTexture()))
+                    textures_.Push(sprite->GetTexture());
+            }
+        }
+    }
+
+    sourceBatches_.Resize(textures_.Size());
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        SourceBatch2D& sourceBatch = sourceBatches_[i];
+        sourceBatch.owner_ = this;
+        sourceBatch.drawOrder_ = GetDrawOrder();
+        sourceBatch.material_ = renderer_ ? renderer_->GetMaterial(textures_[i], BLEND_ALPHA) : nullptr;
+    }
+}
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Urho2D/Drawable2D.h"
+
+namespace Urho3D
+{
+
+class TileMapLayer2D;
+
+/// Draws a rectangular chunk of a tile layer with one source batch per tileset texture. Created by TileMapLayer2D when the tile map uses a tile chunk size; culled as a whole by Renderer2D.
+class URHO3D_API TileMapChunk2D : public Drawable2D
+{
+    URHO3D_OBJECT(TileMapChunk2D, Drawable2D);
+
+public:
+    /// Construct.
+    explicit TileMapChunk2D(Context* context);
+    /// Destruct.
+    ~TileMapChunk2D() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set the tile layer and the rectangle of tiles to draw. The right and bottom edges are exclusive.
+    void SetTiles(TileMapLayer2D* layer, const IntRect& tileRect);
+    /// Rebuild the vertices after tiles in the rectangle have changed.
+    void MarkTilesDirty();
+
+    /// Return tile layer.
+    TileMapLayer2D* GetTileLayer() const;
+    /// Return the rectangle of tiles.
+    const IntRect& GetTileRect() const { return tileRect_; }
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+    /// Handle draw order changed.
+    void OnDrawOrderChanged() override;
+    /// Update source batches.
+    void UpdateSourceBatches() override;
+
+private:
+    /// Create a source batch for each texture used by the tiles. Called in the main thread, as the materials are created by Renderer2D.
+    void UpdateMaterials();
+
+    /// Tile layer.
+    WeakPtr<TileMapLayer2D> tileLayer_;
+    /// Rectangle of tiles.
+    IntRect tileRect_;
+    /// Texture of each source batch.
+    PODVector<Texture2D*> textures_;
+};
+
+}
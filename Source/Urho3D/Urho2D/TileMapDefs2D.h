@@ -149,6 +149,7 @@ public:
     const String& GetProperty(const String& name) const;
 
 private:
+    friend class TileMapLayer2D;
     friend class TmxTileLayer2D;
 
     /// Gid.
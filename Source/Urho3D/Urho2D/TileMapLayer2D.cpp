@@ -28,6 +28,7 @@
 #include "../Scene/Node.h"
 #include "../Urho2D/StaticSprite2D.h"
 #include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
 #include "../Urho2D/TmxFile2D.h"
 
@@ -183,6 +184,9 @@ void TileMapLayer2D::Initialize(TileMap2D* tileMap, const TmxLayer2D* tmxLayer)
         nodes_.Clear();
     }
 
+    tiles_.Clear();
+    chunkSize_ = 0;
+    numChunksX_ = 0;
     tileLayer_ = nullptr;
     objectGroup_ = nullptr;
     imageLayer_ = nullptr;
@@ -226,9 +230,10 @@ void TileMapLayer2D::SetDrawOrder(int drawOrder)
         if (!nodes_[i])
             continue;
 
-        auto* staticSprite = nodes_[i]->GetComponent<StaticSprite2D>();
-        if (staticSprite)
-            staticSprite->SetLayer(drawOrder_);
+        // Tile layers in chunked mode have one TileMapChunk2D per node instead
+        auto* drawable = nodes_[i]->GetDerivedComponent<Drawable2D>();
+        if (drawable)
+            drawable->SetLayer(drawOrder_);
     }
 }
 
@@ -286,12 +291,54 @@ Tile2D* TileMapLayer2D::GetTile(int x, int y) const
     if (!tileLayer_)
         return nullptr;
 
-    return tileLayer_->GetTile(x, y);
+    if (x < 0 || x >= tileLayer_->GetWidth() || y < 0 || y >= tileLayer_->GetHeight())
+        return nullptr;
+
+    return tiles_[y * tileLayer_->GetWidth() + x];
 }
 
-Node* TileMapLayer2D::GetTileNode(int x, int y) const
+void TileMapLayer2D::SetTile(int x, int y, unsigned gid)
 {
     if (!tileLayer_)
+        return;
+
+    int width = tileLayer_->GetWidth();
+    if (x < 0 || x >= width || y < 0 || y >= tileLayer_->GetHeight())
+        return;
+
+    SharedPtr<Tile2D> tile;
+    if (gid & ~FLIP_ALL)
+    {
+        TmxFile2D* tmxFile = tileLayer_->GetTmxFile();
+        tile = new Tile2D();
+        tile->gid_ = gid;
+        tile->sprite_ = tmxFile->GetTileSprite(gid & ~FLIP_ALL);
+        tile->propertySet_ = tmxFile->GetTilePropertySet(gid & ~FLIP_ALL);
+    }
+    tiles_[y * width + x] = tile;
+
+    if (chunkSize_)
+    {
+        Node* chunkNode = nodes_[(y / chunkSize_) * numChunksX_ + x / chunkSize_];
+        auto* chunk = chunkNode->GetComponent<TileMapChunk2D>();
+        if (chunk)
+            chunk->MarkTilesDirty();
+    }
+    else
+    {
+        SharedPtr<Node>& tileNode = nodes_[y * width + x];
+        if (tileNode)
+        {
+            tileNode->Remove();
+            tileNode.Reset();
+        }
+        CreateTileNode(x, y);
+    }
+}
+
+Node* TileMapLayer2D::GetTileNode(int x, int y) const
+{
+    if (!tileLayer_ || chunkSize_)
         return nullptr;
 
     if (x < 0 || x >= tileLayer_->GetWidth() || y < 0 || y >= tileLayer_->GetHeight())
@@ -341,29 +388,67 @@ void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
 
     int width = tileLayer->GetWidth();
     int height = tileLayer->GetHeight();
-    nodes_.Resize((unsigned)(width * height));
-
-    const TileMapInfo2D& info = tileMap_->GetInfo();
+    tiles_.Resize((unsigned)(width * height));
     for (int y = 0; y < height; ++y)
     {
         for (int x = 0; x < width; ++x)
-        {
-            const Tile2D* tile = tileLayer->GetTile(x, y);
-            if (!tile)
-                continue;
+            tiles_[y * width + x] = tileLayer->GetTile(x, y);
+    }
 
-            SharedPtr<Node> tileNode(GetNode()->CreateTemporaryChild("Tile"));
-            tileNode->SetPosition(Vector3(info.TileIndexToPosition(x, y)));
+    chunkSize_ = tileMap_->GetTileChunkSize();
+    if (chunkSize_ > 0)
+    {
+        // One drawable per chunk of tiles, ordered like the tiles they contain
+        numChunksX_ = (width + chunkSize_ - 1) / chunkSize_;
+        int numChunksY = (height + chunkSize_ - 1) / chunkSize_;
+        nodes_.Resize((unsigned)(numChunksX_ * numChunksY));
 
-            auto* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
-            staticSprite->SetSprite(tile->GetSprite());
-            staticSprite->SetFlip(tile->GetFlipX(), tile->GetFlipY(), tile->GetSwapXY());
-            staticSprite->SetLayer(drawOrder_);
-            staticSprite->SetOrderInLayer(y * width + x);
+        for (int y = 0; y < numChunksY; ++y)
+        {
+            for (int x = 0; x < numChunksX_; ++x)
+            {
+                SharedPtr<Node> chunkNode(GetNode()->CreateTemporaryChild("TileChunk"));
+                chunkNode->SetEnabled(visible_);
+
+                auto* chunk = chunkNode->CreateComponent<TileMapChunk2D>();
+                chunk->SetLayer(drawOrder_);
+                chunk->SetOrderInLayer(y * numChunksX_ + x);
+                chunk->SetTiles(this, IntRect(x * chunkSize_, y * chunkSize_, Min((x + 1) * chunkSize_, width),
+                    Min((y + 1) * chunkSize_, height)));
 
-            nodes_[y * width + x] = tileNode;
+                nodes_[y * numChunksX_ + x] = chunkNode;
+            }
         }
     }
+    else
+    {
+        nodes_.Resize((unsigned)(width * height));
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+                CreateTileNode(x, y);
+        }
+    }
+}
+
+void TileMapLayer2D::CreateTileNode(int x, int y)
+{
+    int width = tileLayer_->GetWidth();
+    const Tile2D* tile = tiles_[y * width + x];
+    if (!tile)
+        return;
+
+    SharedPtr<Node> tileNode(GetNode()->CreateTemporaryChild("Tile"));
+    tileNode->SetPosition(Vector3(tileMap_->GetInfo().TileIndexToPosition(x, y)));
+    tileNode->SetEnabled(visible_);
+
+    auto* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
+    staticSprite->SetSprite(tile->GetSprite());
+    staticSprite->SetFlip(tile->GetFlipX(), tile->GetFlipY(), tile->GetSwapXY());
+    staticSprite->SetLayer(drawOrder_);
+    staticSprite->SetOrderInLayer(y * width + x);
+
+    nodes_[y * width + x] = tileNode;
 }
 
 void TileMapLayer2D::SetObjectGroup(const TmxObjectGroup2D* objectGroup)
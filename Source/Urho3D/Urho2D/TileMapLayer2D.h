@@ -90,6 +90,10 @@ public:
     Node* GetTileNode(int x, int y) const;
     /// Return tile (for tile layer only).
     Tile2D* GetTile(int x, int y) const;
+    /// Set tile by gid, which may include the flip flags, or 0 to clear (for tile layer only). Changes only this layer, not the tmx file. In chunked mode only the chunk containing the tile is rebuilt.
+    void SetTile(int x, int y, unsigned gid);
+    /// Return tile chunk size, or 0 if each tile has its own node.
+    int GetChunkSize() const { return chunkSize_; }
 
     /// Return number of tile map objects (for object group only).
     unsigned GetNumObjects() const;
@@ -108,6 +112,8 @@ private:
     void SetObjectGroup(const TmxObjectGroup2D* objectGroup);
     /// Set image layer.
     void SetImageLayer(const TmxImageLayer2D* imageLayer);
+    /// Create the node of a tile in node per tile mode.
+    void CreateTileNode(int x, int y);
 
     /// Tile map.
     WeakPtr<TileMap2D> tileMap_;
@@ -123,7 +129,13 @@ private:
     int drawOrder_{};
     /// Visible.
     bool visible_{true};
-    /// Tile node or image nodes.
+    /// Tile size of the chunks, or 0 for a node per tile.
+    int chunkSize_{};
+    /// Number of chunks in the X direction.
+    int numChunksX_{};
+    /// Tiles of the tile layer, which may be changed from the tmx file.
+    Vector<SharedPtr<Tile2D> > tiles_;
+    /// Tile, chunk, object or image nodes.
     Vector<SharedPtr<Node> > nodes_;
 };
 
@@ -8,6 +8,9 @@
 #ifdef VERTEXCOLOR
     varying vec4 vColor;
 #endif
+#ifdef CLIPRECT
+    varying vec4 vClipDist;
+#endif
 
 void VS()
 {
@@ -21,10 +24,19 @@ void VS()
     #ifdef VERTEXCOLOR
         vColor = iColor;
     #endif
+    #ifdef CLIPRECT
+        // Distances to the left, top, right and bottom edges of the clip rectangle, negative outside
+        vClipDist = vec4(worldPos.xy - iTexCoord2.xy, iTexCoord2.zw - worldPos.xy);
+    #endif
 }
 
 void PS()
 {
+    #ifdef CLIPRECT
+        if (min(min(vClipDist.x, vClipDist.y), min(vClipDist.z, vClipDist.w)) < 0.0)
+            discard;
+    #endif
+
     vec4 diffColor = cMatDiffColor;
 
     #ifdef VERTEXCOLOR
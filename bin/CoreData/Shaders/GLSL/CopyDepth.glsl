@@ -0,0 +1,20 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+
+varying vec2 vTexCoord;
+
+void VS()
+{
+    mat4 modelMatrix = iModelMatrix;
+    vec3 worldPos = GetWorldPos(modelMatrix);
+    gl_Position = GetClipPos(worldPos);
+    vTexCoord = GetQuadTexCoord(gl_Position);
+}
+
+void PS()
+{
+    // Copy the depth values of a depth texture, used for the static shadow map of cached shadows
+    gl_FragDepth = texture2D(sDiffMap, vTexCoord).r;
+}
@@ -0,0 +1,147 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+#include "Fog.glsl"
+
+// Particle vertex data:
+// iPos = start position, iNormal = start velocity, iTexCoord = corner, iTexCoord1 = (emission offset, lifetime),
+// iTangent = (size x, size y, rotation, rotation speed)
+
+varying vec2 vTexCoord;
+varying vec4 vWorldPos;
+varying vec4 vColor;
+#ifdef SOFTPARTICLES
+    varying vec4 vScreenPos;
+    uniform float cSoftParticleFadeScale;
+#endif
+
+#ifdef COMPILEVS
+// x = emitter time, y = emission cycle length, z = emission start time, w = emission end time
+uniform vec4 cGPUParticleTime;
+// xyz = constant force in emitter space, w = damping force
+uniform vec4 cGPUParticleForce;
+// x = size add, y = size mul - 1, z = size scale
+uniform vec4 cGPUParticleSize;
+uniform vec4 cGPUParticleUV;
+uniform vec4 cGPUParticleColors[8];
+uniform float cGPUParticleColorTimes[8];
+
+float GetParticleScale(float age)
+{
+    float k = cGPUParticleSize.y;
+    float scale = abs(k) > 0.0001 ? (1.0 + cGPUParticleSize.x / k) * exp(k * age) - cGPUParticleSize.x / k :
+        1.0 + cGPUParticleSize.x * age;
+    return max(scale, 0.0) * cGPUParticleSize.z;
+}
+
+vec3 GetParticleOffset(vec3 velocity, float age)
+{
+    vec3 force = cGPUParticleForce.xyz;
+    float damping = cGPUParticleForce.w;
+    if (abs(damping) > 0.0001)
+    {
+        vec3 terminal = force / damping;
+        return terminal * age + (velocity - terminal) * (1.0 - exp(-damping * age)) / damping;
+    }
+    else
+        return velocity * age + 0.5 * force * age * age;
+}
+
+vec4 GetParticleColor(float age)
+{
+    vec4 color = cGPUParticleColors[0];
+    for (int i = 1; i < 8; ++i)
+    {
+        float startTime = cGPUParticleColorTimes[i - 1];
+        float interval = cGPUParticleColorTimes[i] - startTime;
+        float t = interval > 0.0 ? clamp((age - startTime) / interval, 0.0, 1.0) : (age >= startTime ? 1.0 : 0.0);
+        color = mix(color, cGPUParticleColors[i], t);
+    }
+    return color;
+}
+#endif
+
+void VS()
+{
+    // Each particle is emitted once per cycle at its own offset. Hide it when it is dead or was emitted outside the emission period
+    float age = mod(cGPUParticleTime.x - iTexCoord1.x, cGPUParticleTime.y);
+    float emitTime = cGPUParticleTime.x - age;
+    float alive = age < iTexCoord1.y && emitTime >= cGPUParticleTime.z && emitTime < cGPUParticleTime.w ? 1.0 : 0.0;
+
+    vec2 size = iTangent.xy * GetParticleScale(age) * alive;
+    float angle = radians(iTangent.z + iTangent.w * age);
+    float s = sin(angle);
+    float c = cos(angle);
+    vec2 corner = iTexCoord * size;
+    vec2 offset = vec2(corner.x * c + corner.y * s, -corner.x * s + corner.y * c);
+
+    mat4 modelMatrix = iModelMatrix;
+    vec4 localPos = vec4(iPos.xyz + GetParticleOffset(iNormal, age), 1.0);
+    vec3 worldPos = (localPos * modelMatrix).xyz + vec3(offset, 0.0) * cBillboardRot;
+    gl_Position = GetClipPos(worldPos);
+
+    vec2 uvFactor = vec2(iTexCoord.x, -iTexCoord.y) * 0.5 + 0.5;
+    vTexCoord = GetTexCoord(mix(cGPUParticleUV.xy, cGPUParticleUV.zw, uvFactor));
+    vWorldPos = vec4(worldPos, GetDepth(gl_Position));
+    vColor = GetParticleColor(age);
+
+    #ifdef SOFTPARTICLES
+        vScreenPos = GetScreenPos(gl_Position);
+    #endif
+}
+
+void PS()
+{
+    // Get material diffuse albedo
+    #ifdef DIFFMAP
+        vec4 diffColor = cMatDiffColor * texture2D(sDiffMap, vTexCoord);
+        #ifdef ALPHAMASK
+            if (diffColor.a < 0.5)
+                discard;
+        #endif
+    #else
+        vec4 diffColor = cMatDiffColor;
+    #endif
+
+    diffColor *= vColor;
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(vWorldPos.w, vWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(vWorldPos.w);
+    #endif
+
+    // Soft particle fade
+    // In expand mode depth test should be off. In that case do manual alpha discard test first to reduce fill rate
+    #ifdef SOFTPARTICLES
+        #ifdef EXPAND
+            if (diffColor.a < 0.01)
+                discard;
+        #endif
+
+        float particleDepth = vWorldPos.w;
+        #ifdef HWDEPTH
+            float depth = ReconstructDepth(texture2DProj(sDepthBuffer, vScreenPos).r);
+        #else
+            float depth = DecodeDepth(texture2DProj(sDepthBuffer, vScreenPos).rgb);
+        #endif
+
+        #ifdef EXPAND
+            float diffZ = max(particleDepth - depth, 0.0) * (cFarClipPS - cNearClipPS);
+            float fade = clamp(diffZ * cSoftParticleFadeScale, 0.0, 1.0);
+        #else
+            float diffZ = (depth - particleDepth) * (cFarClipPS - cNearClipPS);
+            float fade = clamp(1.0 - diffZ * cSoftParticleFadeScale, 0.0, 1.0);
+        #endif
+
+        #ifndef ADDITIVE
+            diffColor.a = max(diffColor.a - fade, 0.0);
+        #else
+            diffColor.rgb = max(diffColor.rgb - fade, vec3(0.0, 0.0, 0.0));
+        #endif
+    #endif
+
+    gl_FragColor = vec4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+}
@@ -0,0 +1,67 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+#include "Fog.glsl"
+
+varying vec2 vTexCoord;
+varying vec4 vWorldPos;
+
+void VS()
+{
+    // Position is the impostor center in world space, texcoord the quad corner, texcoord1 the quad size and
+    // tangent the model forward direction on the XZ plane, number of atlas angles and switch distance
+    vec3 center = iPos.xyz;
+    vec3 toCamera = cCameraPos - center;
+    vec3 right = normalize(vec3(-toCamera.z, 0.0, toCamera.x));
+    vec3 worldPos = center + right * iTexCoord.x * iTexCoord1.x + vec3(0.0, iTexCoord.y * iTexCoord1.y, 0.0);
+
+    // Collapse the quad while the full model is drawn instead
+    if (length(toCamera) < iTangent.w)
+        worldPos = center;
+
+    gl_Position = GetClipPos(worldPos);
+    vWorldPos = vec4(worldPos, GetDepth(gl_Position));
+
+    // Choose the atlas cell nearest to the view angle around the model's vertical axis
+    float numAngles = iTangent.z;
+    float angle = atan(toCamera.x * iTangent.y - toCamera.z * iTangent.x, toCamera.x * iTangent.x + toCamera.z * iTangent.y);
+    if (angle < 0.0)
+        angle += 6.28318530718;
+    float cell = mod(floor(angle / 6.28318530718 * numAngles + 0.5), numAngles);
+    vTexCoord = vec2((cell + iTexCoord.x + 0.5) / numAngles, 0.5 - iTexCoord.y);
+}
+
+void PS()
+{
+    // Get material diffuse albedo
+    #ifdef DIFFMAP
+        vec4 diffColor = cMatDiffColor * texture2D(sDiffMap, vTexCoord);
+        #ifdef ALPHAMASK
+            if (diffColor.a < 0.5)
+                discard;
+        #endif
+    #else
+        vec4 diffColor = cMatDiffColor;
+    #endif
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(vWorldPos.w, vWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(vWorldPos.w);
+    #endif
+
+    #if defined(PREPASS)
+        // Fill light pre-pass G-Buffer
+        gl_FragData[0] = vec4(0.5, 0.5, 0.5, 1.0);
+        gl_FragData[1] = vec4(EncodeDepth(vWorldPos.w), 0.0);
+    #elif defined(DEFERRED)
+        gl_FragData[0] = vec4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+        gl_FragData[1] = vec4(0.0, 0.0, 0.0, 0.0);
+        gl_FragData[2] = vec4(0.5, 0.5, 0.5, 1.0);
+        gl_FragData[3] = vec4(EncodeDepth(vWorldPos.w), 0.0);
+    #else
+        gl_FragColor = vec4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+    #endif
+}
@@ -174,6 +174,64 @@ float GetIntensity(vec3 color)
     return dot(color, vec3(0.299, 0.587, 0.114));
 }
 
+#ifdef CLUSTERED
+// Clustered forward lighting data layout. Must match the constants in View.cpp
+#define CLUSTER_TEXTURE_SIZE 256.0
+#define CLUSTER_HEADER_START 768.0
+#define CLUSTER_SIZE_X 16.0
+#define CLUSTER_SIZE_Y 8.0
+#define CLUSTER_SIZE_Z 16.0
+#define MAX_CLUSTER_LIGHTS 32
+
+vec4 GetClusterData(float index)
+{
+    float y = floor(index / CLUSTER_TEXTURE_SIZE);
+    return texture2D(sLightBuffer, (vec2(index - y * CLUSTER_TEXTURE_SIZE, y) + 0.5) / CLUSTER_TEXTURE_SIZE);
+}
+
+vec3 GetClusteredLight(vec3 worldPos, vec3 normal, vec3 diffColor, vec3 specColor, float specularPower)
+{
+    // Find the cluster from the screen position and the view depth
+    vec4 clusterPos = vec4(worldPos, 1.0) * cClusterMatrix;
+    vec2 tile = floor(clamp(clusterPos.xy / clusterPos.w * 0.5 + 0.5, 0.0, 0.9999) * vec2(CLUSTER_SIZE_X, CLUSTER_SIZE_Y));
+    float depth = cClusterParams.z > 0.0 ? log2(max(clusterPos.z, 0.0001)) : clusterPos.z;
+    float slice = clamp(floor(depth * cClusterParams.x + cClusterParams.y), 0.0, CLUSTER_SIZE_Z - 1.0);
+    vec4 cluster = GetClusterData(CLUSTER_HEADER_START + (slice * CLUSTER_SIZE_Y + tile.y) * CLUSTER_SIZE_X + tile.x);
+
+    vec3 eyeVec = cCameraPosPS - worldPos;
+    vec3 finalColor = vec3(0.0, 0.0, 0.0);
+
+    for (int i = 0; i < MAX_CLUSTER_LIGHTS; ++i)
+    {
+        if (float(i) >= cluster.y)
+            break;
+
+        // Each light is stored as position & inverse range, color & specular intensity and the scaled spot direction & cutoff
+        float lightStart = GetClusterData(cluster.x + float(i)).x;
+        vec4 lightPos = GetClusterData(lightStart);
+        vec4 lightColor = GetClusterData(lightStart + 1.0);
+        vec4 lightSpot = GetClusterData(lightStart + 2.0);
+
+        vec3 lightVec = (lightPos.xyz - worldPos) * lightPos.w;
+        float lightDist = length(lightVec);
+        vec3 lightDir = lightVec / lightDist;
+        #ifdef TRANSLUCENT
+            float NdotL = abs(dot(normal, lightDir));
+        #else
+            float NdotL = max(dot(normal, lightDir), 0.0);
+        #endif
+        float atten = clamp(1.0 - lightDist * lightDist, 0.0, 1.0);
+        float spotAtten = clamp(dot(lightDir, lightSpot.xyz) + lightSpot.w, 0.0, 1.0);
+        float diff = NdotL * atten * spotAtten;
+
+        float spec = GetSpecular(normal, eyeVec, lightDir, specularPower);
+        finalColor += diff * lightColor.rgb * (diffColor + spec * specColor * lightColor.a);
+    }
+
+    return finalColor;
+}
+#endif
+
 #ifdef SHADOW
 
 #if defined(DIRLIGHT) && (!defined(GL_ES) || defined(WEBGL))
@@ -16,6 +16,13 @@ varying vec4 vWorldPos;
 #ifdef VERTEXCOLOR
     varying vec4 vColor;
 #endif
+#ifdef TEXARRAY
+    // xyz = diffuse color, w = texture array layer
+    varying vec4 vTexArrayData;
+    #define SampleMaterial(tex, uv) texture(tex, vec3(uv, vTexArrayData.w))
+#else
+    #define SampleMaterial(tex, uv) texture2D(tex, uv)
+#endif
 #ifdef PERPIXEL
     #ifdef SHADOW
         #ifndef GL_ES
@@ -53,6 +60,14 @@ void VS()
         vColor = iColor;
     #endif
 
+    #ifdef TEXARRAY
+        #ifdef INSTANCED
+            vTexArrayData = iTexCoord7;
+        #else
+            vTexArrayData = vec4(1.0, 1.0, 1.0, 0.0);
+        #endif
+    #endif
+
     #ifdef NORMALMAP
         vec4 tangent = GetWorldTangent(modelMatrix);
         vec3 bitangent = cross(tangent.xyz, vNormal) * tangent.w;
@@ -108,7 +123,7 @@ void PS()
 {
     // Get material diffuse albedo
     #ifdef DIFFMAP
-        vec4 diffInput = texture2D(sDiffMap, vTexCoord.xy);
+        vec4 diffInput = SampleMaterial(sDiffMap, vTexCoord.xy);
         #ifdef ALPHAMASK
             if (diffInput.a < 0.5)
                 discard;
@@ -121,10 +136,14 @@ void PS()
     #ifdef VERTEXCOLOR
         diffColor *= vColor;
     #endif
+
+    #ifdef TEXARRAY
+        diffColor.rgb *= vTexArrayData.rgb;
+    #endif
     
     // Get material specular albedo
     #ifdef SPECMAP
-        vec3 specColor = cMatSpecColor.rgb * texture2D(sSpecMap, vTexCoord.xy).rgb;
+        vec3 specColor = cMatSpecColor.rgb * SampleMaterial(sSpecMap, vTexCoord.xy).rgb;
     #else
         vec3 specColor = cMatSpecColor.rgb;
     #endif
@@ -132,7 +151,7 @@ void PS()
     // Get normal
     #ifdef NORMALMAP
         mat3 tbn = mat3(vTangent.xyz, vec3(vTexCoord.zw, vTangent.w), vNormal);
-        vec3 normal = normalize(tbn * DecodeNormal(texture2D(sNormalMap, vTexCoord.xy)));
+        vec3 normal = normalize(tbn * DecodeNormal(SampleMaterial(sNormalMap, vTexCoord.xy)));
     #else
         vec3 normal = normalize(vNormal);
     #endif
@@ -172,6 +191,9 @@ void PS()
         #endif
 
         #ifdef AMBIENT
+            #ifdef CLUSTERED
+                finalColor += GetClusteredLight(vWorldPos.xyz, normal, diffColor.rgb, specColor, cMatSpecColor.a);
+            #endif
             finalColor += cAmbientColor.rgb * diffColor.rgb;
             finalColor += cMatEmissiveColor;
             gl_FragColor = vec4(GetFog(finalColor, fogFactor), diffColor.a);
@@ -192,17 +214,17 @@ void PS()
         vec3 finalColor = vVertexLight * diffColor.rgb;
         #ifdef AO
             // If using AO, the vertex light ambient is black, calculate occluded ambient here
-            finalColor += texture2D(sEmissiveMap, vTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
+            finalColor += SampleMaterial(sEmissiveMap, vTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
         #endif
 
         #ifdef ENVCUBEMAP
             finalColor += cMatEnvMapColor * textureCube(sEnvCubeMap, reflect(vReflectionVec, normal)).rgb;
         #endif
         #ifdef LIGHTMAP
-            finalColor += texture2D(sEmissiveMap, vTexCoord2).rgb * diffColor.rgb;
+            finalColor += SampleMaterial(sEmissiveMap, vTexCoord2).rgb * diffColor.rgb;
         #endif
         #ifdef EMISSIVEMAP
-            finalColor += cMatEmissiveColor * texture2D(sEmissiveMap, vTexCoord.xy).rgb;
+            finalColor += cMatEmissiveColor * SampleMaterial(sEmissiveMap, vTexCoord.xy).rgb;
         #else
             finalColor += cMatEmissiveColor;
         #endif
@@ -216,7 +238,7 @@ void PS()
         vec3 finalColor = vVertexLight * diffColor.rgb;
         #ifdef AO
             // If using AO, the vertex light ambient is black, calculate occluded ambient here
-            finalColor += texture2D(sEmissiveMap, vTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
+            finalColor += SampleMaterial(sEmissiveMap, vTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
         #endif
         
         #ifdef MATERIAL
@@ -228,14 +250,19 @@ void PS()
             finalColor += lightInput.rgb * diffColor.rgb + lightSpecColor * specColor;
         #endif
 
+        #ifdef CLUSTERED
+            // Add clustered forward lights
+            finalColor += GetClusteredLight(vWorldPos.xyz, normal, diffColor.rgb, specColor, cMatSpecColor.a);
+        #endif
+
         #ifdef ENVCUBEMAP
             finalColor += cMatEnvMapColor * textureCube(sEnvCubeMap, reflect(vReflectionVec, normal)).rgb;
         #endif
         #ifdef LIGHTMAP
-            finalColor += texture2D(sEmissiveMap, vTexCoord2).rgb * diffColor.rgb;
+            finalColor += SampleMaterial(sEmissiveMap, vTexCoord2).rgb * diffColor.rgb;
         #endif
         #ifdef EMISSIVEMAP
-            finalColor += cMatEmissiveColor * texture2D(sEmissiveMap, vTexCoord.xy).rgb;
+            finalColor += cMatEmissiveColor * SampleMaterial(sEmissiveMap, vTexCoord.xy).rgb;
         #else
             finalColor += cMatEmissiveColor;
         #endif
@@ -0,0 +1,40 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+
+varying vec2 vScreenPos;
+
+#ifdef COMPILEPS
+uniform vec2 cOcclusionDepthStep;
+#endif
+
+void VS()
+{
+    mat4 modelMatrix = iModelMatrix;
+    vec3 worldPos = GetWorldPos(modelMatrix);
+    gl_Position = GetClipPos(worldPos);
+    vScreenPos = GetScreenPosPreDiv(gl_Position);
+}
+
+void PS()
+{
+    // Keep the farthest linear depth of the area covered by the destination texel, so that the reprojected depth
+    // does not occlude more than the actual scene
+    float depth = 0.0;
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            vec2 texCoord = vScreenPos + (vec2(float(x), float(y)) - 1.5) * cOcclusionDepthStep;
+            #ifdef HWDEPTH
+                float texelDepth = ReconstructDepth(texture2D(sDepthBuffer, texCoord).r);
+            #else
+                float texelDepth = DecodeDepth(texture2D(sDepthBuffer, texCoord).rgb);
+            #endif
+            depth = max(depth, texelDepth);
+        }
+    }
+
+    gl_FragColor = vec4(depth, 0.0, 0.0, 1.0);
+}
@@ -1,9 +1,17 @@
 #ifdef COMPILEPS
-uniform sampler2D sDiffMap;
+#ifdef TEXARRAY
+    // Material textures packed into texture arrays, sampled with the instance's layer
+    uniform sampler2DArray sDiffMap;
+    uniform sampler2DArray sNormalMap;
+    uniform sampler2DArray sSpecMap;
+    uniform sampler2DArray sEmissiveMap;
+#else
+    uniform sampler2D sDiffMap;
+    uniform sampler2D sNormalMap;
+    uniform sampler2D sSpecMap;
+    uniform sampler2D sEmissiveMap;
+#endif
 uniform samplerCube sDiffCubeMap;
-uniform sampler2D sNormalMap;
-uniform sampler2D sSpecMap;
-uniform sampler2D sEmissiveMap;
 uniform sampler2D sEnvMap;
 uniform samplerCube sEnvCubeMap;
 uniform sampler2D sLightRampMap;
@@ -0,0 +1,47 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+#include "Lighting.glsl"
+
+varying vec2 vScreenPos;
+varying vec3 vFarRay;
+#ifdef ORTHO
+    varying vec3 vNearRay;
+#endif
+
+void VS()
+{
+    mat4 modelMatrix = iModelMatrix;
+    vec3 worldPos = GetWorldPos(modelMatrix);
+    gl_Position = GetClipPos(worldPos);
+    vScreenPos = GetScreenPosPreDiv(gl_Position);
+    vFarRay = GetFarRay(gl_Position);
+    #ifdef ORTHO
+        vNearRay = GetNearRay(gl_Position);
+    #endif
+}
+
+void PS()
+{
+    // Read the G-buffer once and accumulate all lights of the pixel's cluster
+    #ifdef HWDEPTH
+        float depth = ReconstructDepth(texture2D(sDepthBuffer, vScreenPos).r);
+    #else
+        float depth = DecodeDepth(texture2D(sDepthBuffer, vScreenPos).rgb);
+    #endif
+    #ifdef ORTHO
+        vec3 worldPos = mix(vNearRay, vFarRay, depth);
+    #else
+        vec3 worldPos = vFarRay * depth;
+    #endif
+    vec4 albedoInput = texture2D(sAlbedoBuffer, vScreenPos);
+    vec4 normalInput = texture2D(sNormalBuffer, vScreenPos);
+
+    // Position acquired via near/far ray is relative to camera. Bring position to world space
+    worldPos += cCameraPosPS;
+
+    vec3 normal = normalize(normalInput.rgb * 2.0 - 1.0);
+    vec3 finalColor = GetClusteredLight(worldPos, normal, albedoInput.rgb, albedoInput.aaa, normalInput.a * 255.0);
+    gl_FragColor = vec4(finalColor, 0.0);
+}
@@ -16,10 +16,16 @@ attribute vec4 iBlendWeights;
 attribute vec4 iBlendIndices;
 attribute vec3 iCubeTexCoord;
 attribute vec4 iCubeTexCoord1;
+#ifdef CLIPRECT
+    attribute vec4 iTexCoord2;
+#endif
 #ifdef INSTANCED
     attribute vec4 iTexCoord4;
     attribute vec4 iTexCoord5;
     attribute vec4 iTexCoord6;
+    #if defined(TEXARRAY) || defined(BAKEDANIM)
+        attribute vec4 iTexCoord7;
+    #endif
 #endif
 attribute float iObjectIndex;
 
@@ -43,6 +49,35 @@ mat4 GetInstanceMatrix()
 }
 #endif
 
+#if defined(BAKEDANIM) && defined(INSTANCED) && defined(GL3)
+uniform sampler2D sAnimMap6;
+
+mat4 GetBakedBoneMatrix(int column, ivec2 rows, float t)
+{
+    const vec4 lastColumn = vec4(0.0, 0.0, 0.0, 1.0);
+    return mat4(mix(texelFetch(sAnimMap6, ivec2(column, rows.x), 0), texelFetch(sAnimMap6, ivec2(column, rows.y), 0), t),
+        mix(texelFetch(sAnimMap6, ivec2(column + 1, rows.x), 0), texelFetch(sAnimMap6, ivec2(column + 1, rows.y), 0), t),
+        mix(texelFetch(sAnimMap6, ivec2(column + 2, rows.x), 0), texelFetch(sAnimMap6, ivec2(column + 2, rows.y), 0), t),
+        lastColumn);
+}
+
+mat4 GetBakedAnimMatrix(vec4 blendWeights, vec4 blendIndices)
+{
+    // The instance data holds the first texture row, number of frames, frame rate and frame offset of the animation
+    float numFrames = max(iTexCoord7.y, 1.0);
+    float frame = mod(cElapsedTime * iTexCoord7.z + iTexCoord7.w, numFrames);
+    float frameFloor = floor(frame);
+    ivec2 rows = ivec2(iTexCoord7.x + frameFloor, iTexCoord7.x + mod(frameFloor + 1.0, numFrames));
+    float t = frame - frameFloor;
+    ivec4 idx = ivec4(blendIndices) * 3 + int(cBakedAnimOffset);
+    mat4 skinMatrix = GetBakedBoneMatrix(idx.x, rows, t) * blendWeights.x +
+        GetBakedBoneMatrix(idx.y, rows, t) * blendWeights.y +
+        GetBakedBoneMatrix(idx.z, rows, t) * blendWeights.z +
+        GetBakedBoneMatrix(idx.w, rows, t) * blendWeights.w;
+    return skinMatrix * GetInstanceMatrix();
+}
+#endif
+
 mat3 GetNormalMatrix(mat4 modelMatrix)
 {
     return mat3(modelMatrix[0].xyz, modelMatrix[1].xyz, modelMatrix[2].xyz);
@@ -144,17 +179,85 @@ vec3 GetTrailNormal(vec4 iPos, vec3 iParentPos, vec3 iForward)
 }
 #endif
 
+#ifdef CLIPMAP
+// Terrain clipmap: the grid vertices are displaced by a height texture. The model matrix maps grid to heightmap texel coordinates
+uniform sampler2D sHeightMap7;
+
+float GetClipmapHeight(vec2 texel)
+{
+    return textureLod(sHeightMap7, (texel + 0.5) / cClipmapMorph.zw, 0.0).r;
+}
+
+vec3 GetClipmapPos(vec2 texel)
+{
+    return cClipmapOrigin + cClipmapAxisX * texel.x + cClipmapAxisZ * texel.y + cClipmapAxisY * GetClipmapHeight(texel);
+}
+
+vec4 GetClipmapTexels(mat4 modelMatrix)
+{
+    // Return the texel of the vertex in xy, and in zw the texel it collapses to at the end of the node's LOD range.
+    // The odd grid vertices collapse to the even ones, which makes the grid match the next coarser node
+    vec2 texel = (iPos * modelMatrix).xz;
+    vec2 target = texel - fract(iPos.xz * 0.5) * 2.0 * modelMatrix[0].x;
+    vec2 maxTexel = cClipmapMorph.zw - 1.0;
+    return vec4(min(texel, maxTexel), min(target, maxTexel));
+}
+
+float GetClipmapMorph(vec2 texel, mat4 modelMatrix)
+{
+    float dist = distance(GetClipmapPos(texel), cCameraPos);
+    return clamp((dist / (modelMatrix[0].x * cClipmapMorph.x) - cClipmapMorph.y) / (1.0 - cClipmapMorph.y), 0.0, 1.0);
+}
+
+vec3 GetClipmapWorldPos(mat4 modelMatrix)
+{
+    vec4 texels = GetClipmapTexels(modelMatrix);
+    return mix(GetClipmapPos(texels.xy), GetClipmapPos(texels.zw), GetClipmapMorph(texels.xy, modelMatrix));
+}
+
+vec2 GetClipmapTexel(mat4 modelMatrix)
+{
+    vec4 texels = GetClipmapTexels(modelMatrix);
+    return mix(texels.xy, texels.zw, GetClipmapMorph(texels.xy, modelMatrix));
+}
+
+vec3 GetClipmapTangentX(vec2 texel)
+{
+    return cClipmapAxisX * 2.0 + cClipmapAxisY * (GetClipmapHeight(texel + vec2(1.0, 0.0)) - GetClipmapHeight(texel - vec2(1.0, 0.0)));
+}
+
+vec3 GetClipmapTangentZ(vec2 texel)
+{
+    return cClipmapAxisZ * 2.0 + cClipmapAxisY * (GetClipmapHeight(texel + vec2(0.0, 1.0)) - GetClipmapHeight(texel - vec2(0.0, 1.0)));
+}
+
+vec2 GetClipmapTexCoord(mat4 modelMatrix)
+{
+    vec2 texel = GetClipmapTexel(modelMatrix);
+    return GetTexCoord(vec2(texel.x / (cClipmapMorph.z - 1.0), 1.0 - texel.y / (cClipmapMorph.w - 1.0)));
+}
+#endif
+
 #if defined(SKINNED)
     #define iModelMatrix GetSkinMatrix(iBlendWeights, iBlendIndices)
+#elif defined(BAKEDANIM) && defined(INSTANCED) && defined(GL3)
+    #define iModelMatrix GetBakedAnimMatrix(iBlendWeights, iBlendIndices)
 #elif defined(INSTANCED)
     #define iModelMatrix GetInstanceMatrix()
 #else
     #define iModelMatrix cModel
 #endif
 
+#ifdef CLIPMAP
+    // The terrain texture coordinates are derived from the heightmap position instead of the vertex data
+    #define GetTexCoord(texCoord) GetClipmapTexCoord(iModelMatrix)
+#endif
+
 vec3 GetWorldPos(mat4 modelMatrix)
 {
-    #if defined(BILLBOARD)
+    #if defined(CLIPMAP)
+        return GetClipmapWorldPos(modelMatrix);
+    #elif defined(BILLBOARD)
         return GetBillboardPos(iPos, iTexCoord1, modelMatrix);
     #elif defined(DIRBILLBOARD)
         return GetBillboardPos(iPos, iNormal, modelMatrix);
@@ -169,7 +272,10 @@ vec3 GetWorldPos(mat4 modelMatrix)
 
 vec3 GetWorldNormal(mat4 modelMatrix)
 {
-    #if defined(BILLBOARD)
+    #if defined(CLIPMAP)
+        vec2 texel = floor(GetClipmapTexel(modelMatrix) + 0.5);
+        return normalize(cross(GetClipmapTangentZ(texel), GetClipmapTangentX(texel)));
+    #elif defined(BILLBOARD)
         return GetBillboardNormal();
     #elif defined(DIRBILLBOARD)
         return GetBillboardNormal(iPos, iNormal, modelMatrix);
@@ -184,7 +290,9 @@ vec3 GetWorldNormal(mat4 modelMatrix)
 
 vec4 GetWorldTangent(mat4 modelMatrix)
 {
-    #if defined(BILLBOARD)
+    #if defined(CLIPMAP)
+        return vec4(normalize(GetClipmapTangentX(floor(GetClipmapTexel(modelMatrix) + 0.5))), 1.0);
+    #elif defined(BILLBOARD)
         return vec4(normalize(vec3(1.0, 0.0, 0.0) * cBillboardRot), 1.0);
     #elif defined(DIRBILLBOARD)
         return vec4(normalize(vec3(1.0, 0.0, 0.0) * GetNormalMatrix(modelMatrix)), 1.0);
@@ -43,6 +43,16 @@ uniform mat4 cZone;
 #ifdef GL3
     uniform vec4 cClipPlane;
 #endif
+#ifdef CLIPMAP
+    uniform vec3 cClipmapOrigin;
+    uniform vec3 cClipmapAxisX;
+    uniform vec3 cClipmapAxisY;
+    uniform vec3 cClipmapAxisZ;
+    uniform vec4 cClipmapMorph;
+#endif
+#ifdef BAKEDANIM
+    uniform float cBakedAnimOffset;
+#endif
 #endif
 
 #ifdef COMPILEPS
@@ -87,6 +97,10 @@ uniform mat4 cLightMatricesPS[4];
 #ifdef VSM_SHADOW
 uniform vec2 cVSMShadowParams;
 #endif
+#ifdef CLUSTERED
+uniform mat4 cClusterMatrix;
+uniform vec4 cClusterParams;
+#endif
 #endif
 
 #else
@@ -139,6 +153,16 @@ uniform MaterialVS
 {
     vec4 cUOffset;
     vec4 cVOffset;
+#ifdef CLIPMAP
+    vec3 cClipmapOrigin;
+    vec3 cClipmapAxisX;
+    vec3 cClipmapAxisY;
+    vec3 cClipmapAxisZ;
+    vec4 cClipmapMorph;
+#endif
+#ifdef BAKEDANIM
+    float cBakedAnimOffset;
+#endif
 };
 #endif
 
@@ -171,6 +195,10 @@ uniform CameraPS
     vec2 cGBufferInvSize;
     float cNearClipPS;
     float cFarClipPS;
+#ifdef CLUSTERED
+    mat4 cClusterMatrix;
+    vec4 cClusterParams;
+#endif
 };
 
 uniform ZonePS
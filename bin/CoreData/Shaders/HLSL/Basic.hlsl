@@ -25,12 +25,18 @@ void VS(float4 iPos : POSITION,
     #if defined(TRAILFACECAM) || defined(TRAILBONE)
         float4 iTangent : TANGENT,
     #endif
+    #ifdef CLIPRECT
+        float4 iClipRect : TEXCOORD2,
+    #endif
     #ifdef DIFFMAP
         out float2 oTexCoord : TEXCOORD0,
     #endif
     #ifdef VERTEXCOLOR
         out float4 oColor : COLOR0,
     #endif
+    #ifdef CLIPRECT
+        out float4 oClipDist : TEXCOORD1,
+    #endif
     #if defined(D3D11) && defined(CLIPPLANE)
         out float oClip : SV_CLIPDISTANCE0,
     #endif
@@ -50,6 +56,10 @@ void VS(float4 iPos : POSITION,
     #ifdef DIFFMAP
         oTexCoord = iTexCoord;
     #endif
+    #ifdef CLIPRECT
+        // Distances to the left, top, right and bottom edges of the clip rectangle, negative outside
+        oClipDist = float4(worldPos.xy - iClipRect.xy, iClipRect.zw - worldPos.xy);
+    #endif
 }
 
 void PS(
@@ -59,11 +69,18 @@ void PS(
     #ifdef VERTEXCOLOR
         float4 iColor : COLOR0,
     #endif
+    #ifdef CLIPRECT
+        float4 iClipDist : TEXCOORD1,
+    #endif
     #if defined(D3D11) && defined(CLIPPLANE)
         float iClip : SV_CLIPDISTANCE0,
     #endif
     out float4 oColor : OUTCOLOR0)
 {
+    #ifdef CLIPRECT
+        clip(iClipDist);
+    #endif
+
     float4 diffColor = cMatDiffColor;
 
     #ifdef VERTEXCOLOR
@@ -0,0 +1,21 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "ScreenPos.hlsl"
+
+void VS(float4 iPos : POSITION,
+    out float2 oTexCoord : TEXCOORD0,
+    out float4 oPos : OUTPOSITION)
+{
+    float4x3 modelMatrix = iModelMatrix;
+    float3 worldPos = GetWorldPos(modelMatrix);
+    oPos = GetClipPos(worldPos);
+    oTexCoord = GetQuadTexCoord(oPos);
+}
+
+void PS(float2 iTexCoord : TEXCOORD0,
+    out float oDepth : OUTDEPTH)
+{
+    // Copy the depth values of a depth texture, used for the static shadow map of cached shadows
+    oDepth = Sample2D(DiffMap, iTexCoord).r;
+}
@@ -3,12 +3,15 @@
 #include "Transform.hlsl"
 
 void VS(float4 iPos : POSITION,
-    #ifdef SKINNED
+    #if defined(SKINNED) || defined(BAKEDANIM)
         float4 iBlendWeights : BLENDWEIGHT,
         int4 iBlendIndices : BLENDINDICES,
     #endif
     #ifdef INSTANCED
         float4x3 iModelInstance : TEXCOORD4,
+        #ifdef BAKEDANIM
+            float4 iBakedAnimData : TEXCOORD7,
+        #endif
     #endif
     #ifndef NOUV
         float2 iTexCoord : TEXCOORD0,
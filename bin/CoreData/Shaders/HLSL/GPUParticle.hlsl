@@ -0,0 +1,198 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "ScreenPos.hlsl"
+#include "Fog.hlsl"
+
+// Particle vertex data:
+// iPos = start position, iNormal = start velocity, iTexCoord = corner, iTexCoord1 = (emission offset, lifetime),
+// iTangent = (size x, size y, rotation, rotation speed)
+
+#ifdef COMPILEVS
+#ifndef D3D11
+// D3D9 uniforms
+uniform float4 cGPUParticleTime;
+uniform float4 cGPUParticleForce;
+uniform float4 cGPUParticleSize;
+uniform float4 cGPUParticleUV;
+uniform float4 cGPUParticleColors[8];
+uniform float4 cGPUParticleColorTimes[2];
+#else
+// D3D11 constant buffer
+cbuffer CustomVS : register(b6)
+{
+    // x = emitter time, y = emission cycle length, z = emission start time, w = emission end time
+    float4 cGPUParticleTime;
+    // xyz = constant force in emitter space, w = damping force
+    float4 cGPUParticleForce;
+    // x = size add, y = size mul - 1, z = size scale
+    float4 cGPUParticleSize;
+    float4 cGPUParticleUV;
+    float4 cGPUParticleColors[8];
+    float4 cGPUParticleColorTimes[2];
+}
+#endif
+
+float GetParticleScale(float age)
+{
+    float k = cGPUParticleSize.y;
+    float scale = abs(k) > 0.0001 ? (1.0 + cGPUParticleSize.x / k) * exp(k * age) - cGPUParticleSize.x / k :
+        1.0 + cGPUParticleSize.x * age;
+    return max(scale, 0.0) * cGPUParticleSize.z;
+}
+
+float3 GetParticleOffset(float3 velocity, float age)
+{
+    float3 force = cGPUParticleForce.xyz;
+    float damping = cGPUParticleForce.w;
+    if (abs(damping) > 0.0001)
+    {
+        float3 terminal = force / damping;
+        return terminal * age + (velocity - terminal) * (1.0 - exp(-damping * age)) / damping;
+    }
+    else
+        return velocity * age + 0.5 * force * age * age;
+}
+
+float4 GetParticleColor(float age)
+{
+    float colorTimes[8] = {
+        cGPUParticleColorTimes[0].x, cGPUParticleColorTimes[0].y, cGPUParticleColorTimes[0].z, cGPUParticleColorTimes[0].w,
+        cGPUParticleColorTimes[1].x, cGPUParticleColorTimes[1].y, cGPUParticleColorTimes[1].z, cGPUParticleColorTimes[1].w
+    };
+
+    float4 color = cGPUParticleColors[0];
+    [unroll] for (int i = 1; i < 8; ++i)
+    {
+        float startTime = colorTimes[i - 1];
+        float interval = colorTimes[i] - startTime;
+        float t = interval > 0.0 ? saturate((age - startTime) / interval) : (age >= startTime ? 1.0 : 0.0);
+        color = lerp(color, cGPUParticleColors[i], t);
+    }
+    return color;
+}
+#endif
+
+#if defined(COMPILEPS) && defined(SOFTPARTICLES)
+#ifndef D3D11
+// D3D9 uniform
+uniform float cSoftParticleFadeScale;
+#else
+// D3D11 constant buffer
+cbuffer CustomPS : register(b6)
+{
+    float cSoftParticleFadeScale;
+}
+#endif
+#endif
+
+void VS(float4 iPos : POSITION,
+    float3 iNormal : NORMAL,
+    float2 iTexCoord : TEXCOORD0,
+    float2 iTexCoord1 : TEXCOORD1,
+    float4 iTangent : TANGENT,
+    out float2 oTexCoord : TEXCOORD0,
+    #ifdef SOFTPARTICLES
+        out float4 oScreenPos : TEXCOORD1,
+    #endif
+    out float4 oWorldPos : TEXCOORD2,
+    out float4 oColor : COLOR0,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        out float oClip : SV_CLIPDISTANCE0,
+    #endif
+    out float4 oPos : OUTPOSITION)
+{
+    // Each particle is emitted once per cycle at its own offset. Hide it when it is dead or was emitted outside the emission period
+    float elapsed = cGPUParticleTime.x - iTexCoord1.x;
+    float age = elapsed - floor(elapsed / cGPUParticleTime.y) * cGPUParticleTime.y;
+    float emitTime = cGPUParticleTime.x - age;
+    float alive = age < iTexCoord1.y && emitTime >= cGPUParticleTime.z && emitTime < cGPUParticleTime.w ? 1.0 : 0.0;
+
+    float2 size = iTangent.xy * GetParticleScale(age) * alive;
+    float angle = radians(iTangent.z + iTangent.w * age);
+    float s, c;
+    sincos(angle, s, c);
+    float2 corner = iTexCoord * size;
+    float2 offset = float2(corner.x * c + corner.y * s, -corner.x * s + corner.y * c);
+
+    float4x3 modelMatrix = iModelMatrix;
+    float4 localPos = float4(iPos.xyz + GetParticleOffset(iNormal, age), 1.0);
+    float3 worldPos = mul(localPos, modelMatrix) + mul(float3(offset, 0.0), cBillboardRot);
+    oPos = GetClipPos(worldPos);
+
+    float2 uvFactor = float2(iTexCoord.x, -iTexCoord.y) * 0.5 + 0.5;
+    oTexCoord = GetTexCoord(lerp(cGPUParticleUV.xy, cGPUParticleUV.zw, uvFactor));
+    oWorldPos = float4(worldPos, GetDepth(oPos));
+    oColor = GetParticleColor(age);
+
+    #if defined(D3D11) && defined(CLIPPLANE)
+        oClip = dot(oPos, cClipPlane);
+    #endif
+
+    #ifdef SOFTPARTICLES
+        oScreenPos = GetScreenPos(oPos);
+    #endif
+}
+
+void PS(float2 iTexCoord : TEXCOORD0,
+    #ifdef SOFTPARTICLES
+        float4 iScreenPos: TEXCOORD1,
+    #endif
+    float4 iWorldPos: TEXCOORD2,
+    float4 iColor : COLOR0,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        float iClip : SV_CLIPDISTANCE0,
+    #endif
+    out float4 oColor : OUTCOLOR0)
+{
+    // Get material diffuse albedo
+    #ifdef DIFFMAP
+        float4 diffColor = cMatDiffColor * Sample2D(DiffMap, iTexCoord);
+        #ifdef ALPHAMASK
+            if (diffColor.a < 0.5)
+                discard;
+        #endif
+    #else
+        float4 diffColor = cMatDiffColor;
+    #endif
+
+    diffColor *= iColor;
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(iWorldPos.w, iWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(iWorldPos.w);
+    #endif
+
+    // Soft particle fade
+    // In expand mode depth test should be off. In that case do manual alpha discard test first to reduce fill rate
+    #ifdef SOFTPARTICLES
+        #if defined(EXPAND) && !defined(ADDITIVE)
+            if (diffColor.a < 0.01)
+                discard;
+        #endif
+
+        float particleDepth = iWorldPos.w;
+        float depth = Sample2DProj(DepthBuffer, iScreenPos).r;
+        #ifdef HWDEPTH
+            depth = ReconstructDepth(depth);
+        #endif
+
+        #ifdef EXPAND
+            float diffZ = max(particleDepth - depth, 0.0) * (cFarClipPS - cNearClipPS);
+            float fade = saturate(diffZ * cSoftParticleFadeScale);
+        #else
+            float diffZ = (depth - particleDepth) * (cFarClipPS - cNearClipPS);
+            float fade = saturate(1.0 - diffZ * cSoftParticleFadeScale);
+        #endif
+
+        #ifndef ADDITIVE
+            diffColor.a = max(diffColor.a - fade, 0.0);
+        #else
+            diffColor.rgb = max(diffColor.rgb - fade, float3(0.0, 0.0, 0.0));
+        #endif
+    #endif
+
+    oColor = float4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+}
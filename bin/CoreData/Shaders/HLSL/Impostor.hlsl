@@ -0,0 +1,90 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "Fog.hlsl"
+
+void VS(float4 iPos : POSITION,
+    float2 iTexCoord : TEXCOORD0,
+    float2 iSize : TEXCOORD1,
+    float4 iTangent : TANGENT,
+    out float2 oTexCoord : TEXCOORD0,
+    out float4 oWorldPos : TEXCOORD2,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        out float oClip : SV_CLIPDISTANCE0,
+    #endif
+    out float4 oPos : OUTPOSITION)
+{
+    // Position is the impostor center in world space, texcoord the quad corner, texcoord1 the quad size and
+    // tangent the model forward direction on the XZ plane, number of atlas angles and switch distance
+    float3 center = iPos.xyz;
+    float3 toCamera = cCameraPos - center;
+    float3 right = normalize(float3(-toCamera.z, 0.0, toCamera.x));
+    float3 worldPos = center + right * iTexCoord.x * iSize.x + float3(0.0, iTexCoord.y * iSize.y, 0.0);
+
+    // Collapse the quad while the full model is drawn instead
+    if (length(toCamera) < iTangent.w)
+        worldPos = center;
+
+    oPos = GetClipPos(worldPos);
+    oWorldPos = float4(worldPos, GetDepth(oPos));
+
+    // Choose the atlas cell nearest to the view angle around the model's vertical axis
+    float numAngles = iTangent.z;
+    float angle = atan2(toCamera.x * iTangent.y - toCamera.z * iTangent.x, toCamera.x * iTangent.x + toCamera.z * iTangent.y);
+    if (angle < 0.0)
+        angle += 6.28318530718;
+    float cell = fmod(floor(angle / 6.28318530718 * numAngles + 0.5), numAngles);
+    oTexCoord = float2((cell + iTexCoord.x + 0.5) / numAngles, 0.5 - iTexCoord.y);
+
+    #if defined(D3D11) && defined(CLIPPLANE)
+        oClip = dot(oPos, cClipPlane);
+    #endif
+}
+
+void PS(float2 iTexCoord : TEXCOORD0,
+    float4 iWorldPos: TEXCOORD2,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        float iClip : SV_CLIPDISTANCE0,
+    #endif
+    #ifdef PREPASS
+        out float4 oDepth : OUTCOLOR1,
+    #endif
+    #ifdef DEFERRED
+        out float4 oAlbedo : OUTCOLOR1,
+        out float4 oNormal : OUTCOLOR2,
+        out float4 oDepth : OUTCOLOR3,
+    #endif
+    out float4 oColor : OUTCOLOR0)
+{
+    // Get material diffuse albedo
+    #ifdef DIFFMAP
+        float4 diffColor = cMatDiffColor * Sample2D(DiffMap, iTexCoord);
+        #ifdef ALPHAMASK
+            if (diffColor.a < 0.5)
+                discard;
+        #endif
+    #else
+        float4 diffColor = cMatDiffColor;
+    #endif
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(iWorldPos.w, iWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(iWorldPos.w);
+    #endif
+
+    #if defined(PREPASS)
+        // Fill light pre-pass G-Buffer
+        oColor = float4(0.5, 0.5, 0.5, 1.0);
+        oDepth = iWorldPos.w;
+    #elif defined(DEFERRED)
+        // Fill deferred G-buffer
+        oColor = float4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+        oAlbedo = float4(0.0, 0.0, 0.0, 0.0);
+        oNormal = float4(0.5, 0.5, 0.5, 1.0);
+        oDepth = iWorldPos.w;
+    #else
+        oColor = float4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+    #endif
+}
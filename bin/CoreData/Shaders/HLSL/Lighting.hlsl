@@ -187,6 +187,64 @@ float GetIntensity(float3 color)
     return dot(color, float3(0.299, 0.587, 0.114));
 }
 
+#ifdef CLUSTERED
+// Clustered forward lighting data layout. Must match the constants in View.cpp
+#define CLUSTER_TEXTURE_SIZE 256.0
+#define CLUSTER_HEADER_START 768.0
+#define CLUSTER_SIZE_X 16.0
+#define CLUSTER_SIZE_Y 8.0
+#define CLUSTER_SIZE_Z 16.0
+#define MAX_CLUSTER_LIGHTS 32
+
+float4 GetClusterData(float index)
+{
+    float y = floor(index / CLUSTER_TEXTURE_SIZE);
+    return Sample2DLod0(LightBuffer, (float2(index - y * CLUSTER_TEXTURE_SIZE, y) + 0.5) / CLUSTER_TEXTURE_SIZE);
+}
+
+float3 GetClusteredLight(float3 worldPos, float3 normal, float3 diffColor, float3 specColor, float specularPower)
+{
+    // Find the cluster from the screen position and the view depth
+    float4 clusterPos = mul(float4(worldPos, 1.0), cClusterMatrix);
+    float2 tile = floor(clamp(clusterPos.xy / clusterPos.w * 0.5 + 0.5, 0.0, 0.9999) * float2(CLUSTER_SIZE_X, CLUSTER_SIZE_Y));
+    float depth = cClusterParams.z > 0.0 ? log2(max(clusterPos.z, 0.0001)) : clusterPos.z;
+    float slice = clamp(floor(depth * cClusterParams.x + cClusterParams.y), 0.0, CLUSTER_SIZE_Z - 1.0);
+    float4 cluster = GetClusterData(CLUSTER_HEADER_START + (slice * CLUSTER_SIZE_Y + tile.y) * CLUSTER_SIZE_X + tile.x);
+
+    float3 eyeVec = cCameraPosPS - worldPos;
+    float3 finalColor = 0.0;
+
+    [loop] for (int i = 0; i < MAX_CLUSTER_LIGHTS; ++i)
+    {
+        if (float(i) >= cluster.y)
+            break;
+
+        // Each light is stored as position & inverse range, color & specular intensity and the scaled spot direction & cutoff
+        float lightStart = GetClusterData(cluster.x + float(i)).x;
+        float4 lightPos = GetClusterData(lightStart);
+        float4 lightColor = GetClusterData(lightStart + 1.0);
+        float4 lightSpot = GetClusterData(lightStart + 2.0);
+
+        float3 lightVec = (lightPos.xyz - worldPos) * lightPos.w;
+        float lightDist = length(lightVec);
+        float3 lightDir = lightVec / lightDist;
+        #ifdef TRANSLUCENT
+            float NdotL = abs(dot(normal, lightDir));
+        #else
+            float NdotL = max(dot(normal, lightDir), 0.0);
+        #endif
+        float atten = saturate(1.0 - lightDist * lightDist);
+        float spotAtten = saturate(dot(lightDir, lightSpot.xyz) + lightSpot.w);
+        float diff = NdotL * atten * spotAtten;
+
+        float spec = GetSpecular(normal, eyeVec, lightDir, specularPower);
+        finalColor += diff * lightColor.rgb * (diffColor + spec * specColor * lightColor.a);
+    }
+
+    return finalColor;
+}
+#endif
+
 #ifdef SHADOW
 
 #ifdef DIRLIGHT
@@ -5,6 +5,12 @@
 #include "Lighting.hlsl"
 #include "Fog.hlsl"
 
+#ifdef TEXARRAY
+    #define SampleMaterial(tex, uv) t##tex.Sample(s##tex, float3(uv, iTexArrayData.w))
+#else
+    #define SampleMaterial(tex, uv) Sample2D(tex, uv)
+#endif
+
 void VS(float4 iPos : POSITION,
     #if !defined(BILLBOARD) && !defined(TRAILFACECAM)
         float3 iNormal : NORMAL,
@@ -21,16 +27,25 @@ void VS(float4 iPos : POSITION,
     #if (defined(NORMALMAP) || defined(TRAILFACECAM) || defined(TRAILBONE)) && !defined(BILLBOARD) && !defined(DIRBILLBOARD)
         float4 iTangent : TANGENT,
     #endif
-    #ifdef SKINNED
+    #if defined(SKINNED) || defined(BAKEDANIM)
         float4 iBlendWeights : BLENDWEIGHT,
         int4 iBlendIndices : BLENDINDICES,
     #endif
     #ifdef INSTANCED
         float4x3 iModelInstance : TEXCOORD4,
+        #if defined(TEXARRAY)
+            float4 iTexArrayData : TEXCOORD7,
+        #elif defined(BAKEDANIM)
+            float4 iBakedAnimData : TEXCOORD7,
+        #endif
     #endif
     #if defined(BILLBOARD) || defined(DIRBILLBOARD)
         float2 iSize : TEXCOORD1,
     #endif
+    #ifdef TEXARRAY
+        // xyz = diffuse color, w = texture array layer
+        out float4 oTexArrayData : TEXCOORD8,
+    #endif
     #ifndef NORMALMAP
         out float2 oTexCoord : TEXCOORD0,
     #else
@@ -86,6 +101,14 @@ void VS(float4 iPos : POSITION,
         oColor = iColor;
     #endif
 
+    #ifdef TEXARRAY
+        #ifdef INSTANCED
+            oTexArrayData = iTexArrayData;
+        #else
+            oTexArrayData = float4(1.0, 1.0, 1.0, 0.0);
+        #endif
+    #endif
+
     #ifdef NORMALMAP
         float4 tangent = GetWorldTangent(modelMatrix);
         float3 bitangent = cross(tangent.xyz, oNormal) * tangent.w;
@@ -137,6 +160,9 @@ void VS(float4 iPos : POSITION,
 }
 
 void PS(
+    #ifdef TEXARRAY
+        float4 iTexArrayData : TEXCOORD8,
+    #endif
     #ifndef NORMALMAP
         float2 iTexCoord : TEXCOORD0,
     #else
@@ -183,7 +209,7 @@ void PS(
 {
     // Get material diffuse albedo
     #ifdef DIFFMAP
-        float4 diffInput = Sample2D(DiffMap, iTexCoord.xy);
+        float4 diffInput = SampleMaterial(DiffMap, iTexCoord.xy);
         #ifdef ALPHAMASK
             if (diffInput.a < 0.5)
                 discard;
@@ -197,9 +223,13 @@ void PS(
         diffColor *= iColor;
     #endif
 
+    #ifdef TEXARRAY
+        diffColor.rgb *= iTexArrayData.rgb;
+    #endif
+
     // Get material specular albedo
     #ifdef SPECMAP
-        float3 specColor = cMatSpecColor.rgb * Sample2D(SpecMap, iTexCoord.xy).rgb;
+        float3 specColor = cMatSpecColor.rgb * SampleMaterial(SpecMap, iTexCoord.xy).rgb;
     #else
         float3 specColor = cMatSpecColor.rgb;
     #endif
@@ -207,7 +237,7 @@ void PS(
     // Get normal
     #ifdef NORMALMAP
         float3x3 tbn = float3x3(iTangent.xyz, float3(iTexCoord.zw, iTangent.w), iNormal);
-        float3 normal = normalize(mul(DecodeNormal(Sample2D(NormalMap, iTexCoord.xy)), tbn));
+        float3 normal = normalize(mul(DecodeNormal(SampleMaterial(NormalMap, iTexCoord.xy)), tbn));
     #else
         float3 normal = normalize(iNormal);
     #endif
@@ -247,6 +277,9 @@ void PS(
         #endif
 
         #ifdef AMBIENT
+            #ifdef CLUSTERED
+                finalColor += GetClusteredLight(iWorldPos.xyz, normal, diffColor.rgb, specColor, cMatSpecColor.a);
+            #endif
             finalColor += cAmbientColor.rgb * diffColor.rgb;
             finalColor += cMatEmissiveColor;
             oColor = float4(GetFog(finalColor, fogFactor), diffColor.a);
@@ -267,16 +300,16 @@ void PS(
         float3 finalColor = iVertexLight * diffColor.rgb;
         #ifdef AO
             // If using AO, the vertex light ambient is black, calculate occluded ambient here
-            finalColor += Sample2D(EmissiveMap, iTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
+            finalColor += SampleMaterial(EmissiveMap, iTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
         #endif
         #ifdef ENVCUBEMAP
             finalColor += cMatEnvMapColor * SampleCube(EnvCubeMap, reflect(iReflectionVec, normal)).rgb;
         #endif
         #ifdef LIGHTMAP
-            finalColor += Sample2D(EmissiveMap, iTexCoord2).rgb * diffColor.rgb;
+            finalColor += SampleMaterial(EmissiveMap, iTexCoord2).rgb * diffColor.rgb;
         #endif
         #ifdef EMISSIVEMAP
-            finalColor += cMatEmissiveColor * Sample2D(EmissiveMap, iTexCoord.xy).rgb;
+            finalColor += cMatEmissiveColor * SampleMaterial(EmissiveMap, iTexCoord.xy).rgb;
         #else
             finalColor += cMatEmissiveColor;
         #endif
@@ -290,7 +323,7 @@ void PS(
         float3 finalColor = iVertexLight * diffColor.rgb;
         #ifdef AO
             // If using AO, the vertex light ambient is black, calculate occluded ambient here
-            finalColor += Sample2D(EmissiveMap, iTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
+            finalColor += SampleMaterial(EmissiveMap, iTexCoord2).rgb * cAmbientColor.rgb * diffColor.rgb;
         #endif
 
         #ifdef MATERIAL
@@ -302,14 +335,19 @@ void PS(
             finalColor += lightInput.rgb * diffColor.rgb + lightSpecColor * specColor;
         #endif
 
+        #ifdef CLUSTERED
+            // Add clustered forward lights
+            finalColor += GetClusteredLight(iWorldPos.xyz, normal, diffColor.rgb, specColor, cMatSpecColor.a);
+        #endif
+
         #ifdef ENVCUBEMAP
             finalColor += cMatEnvMapColor * SampleCube(EnvCubeMap, reflect(iReflectionVec, normal)).rgb;
         #endif
         #ifdef LIGHTMAP
-            finalColor += Sample2D(EmissiveMap, iTexCoord2).rgb * diffColor.rgb;
+            finalColor += SampleMaterial(EmissiveMap, iTexCoord2).rgb * diffColor.rgb;
         #endif
         #ifdef EMISSIVEMAP
-            finalColor += cMatEmissiveColor * Sample2D(EmissiveMap, iTexCoord.xy).rgb;
+            finalColor += cMatEmissiveColor * SampleMaterial(EmissiveMap, iTexCoord.xy).rgb;
         #else
             finalColor += cMatEmissiveColor;
         #endif
@@ -0,0 +1,50 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "ScreenPos.hlsl"
+
+#ifdef COMPILEPS
+#ifndef D3D11
+// D3D9 uniform
+uniform float2 cOcclusionDepthStep;
+#else
+// D3D11 constant buffer
+cbuffer CustomPS : register(b6)
+{
+    float2 cOcclusionDepthStep;
+}
+#endif
+#endif
+
+void VS(float4 iPos : POSITION,
+    out float2 oScreenPos : TEXCOORD0,
+    out float4 oPos : OUTPOSITION)
+{
+    float4x3 modelMatrix = iModelMatrix;
+    float3 worldPos = GetWorldPos(modelMatrix);
+    oPos = GetClipPos(worldPos);
+    oScreenPos = GetScreenPosPreDiv(oPos);
+}
+
+void PS(float2 iScreenPos : TEXCOORD0,
+    out float4 oColor : OUTCOLOR0)
+{
+    // Keep the farthest linear depth of the area covered by the destination texel, so that the reprojected depth
+    // does not occlude more than the actual scene
+    float depth = 0.0;
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            float2 texCoord = iScreenPos + (float2(x, y) - 1.5) * cOcclusionDepthStep;
+            #ifdef HWDEPTH
+                float texelDepth = ReconstructDepth(Sample2DLod0(DepthBuffer, texCoord).r);
+            #else
+                float texelDepth = Sample2DLod0(DepthBuffer, texCoord).r;
+            #endif
+            depth = max(depth, texelDepth);
+        }
+    }
+
+    oColor = float4(depth, 0.0, 0.0, 1.0);
+}
@@ -46,14 +46,22 @@ sampler3D sZoneVolumeMap : register(s15);
 
 // D3D11 textures and samplers
 
-Texture2D tDiffMap : register(t0);
+#ifdef TEXARRAY
+    // Material textures packed into texture arrays, sampled with the instance's layer
+    Texture2DArray tDiffMap : register(t0);
+    Texture2DArray tNormalMap : register(t1);
+    Texture2DArray tSpecMap : register(t2);
+    Texture2DArray tEmissiveMap : register(t3);
+#else
+    Texture2D tDiffMap : register(t0);
+    Texture2D tNormalMap : register(t1);
+    Texture2D tSpecMap : register(t2);
+    Texture2D tEmissiveMap : register(t3);
+#endif
 TextureCube tDiffCubeMap : register(t0);
 Texture2D tAlbedoBuffer : register(t0);
-Texture2D tNormalMap : register(t1);
 Texture2D tNormalBuffer : register(t1);
-Texture2D tSpecMap : register(t2);
 Texture2D tRoughMetalFresnel : register(t2); //R: Roughness, G: Metal
-Texture2D tEmissiveMap : register(t3);
 Texture2D tEnvMap : register(t4);
 Texture3D tVolumeMap : register(t5);
 TextureCube tEnvCubeMap : register(t4);
@@ -6,12 +6,15 @@ void VS(float4 iPos : POSITION,
     #ifndef NOUV
         float2 iTexCoord : TEXCOORD0,
     #endif
-    #ifdef SKINNED
+    #if defined(SKINNED) || defined(BAKEDANIM)
         float4 iBlendWeights : BLENDWEIGHT,
         int4 iBlendIndices : BLENDINDICES,
     #endif
     #ifdef INSTANCED
         float4x3 iModelInstance : TEXCOORD4,
+        #ifdef BAKEDANIM
+            float4 iBakedAnimData : TEXCOORD7,
+        #endif
     #endif
     #if defined(BILLBOARD) || defined(DIRBILLBOARD)
         float2 iSize : TEXCOORD1,
@@ -0,0 +1,52 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "ScreenPos.hlsl"
+#include "Lighting.hlsl"
+
+void VS(float4 iPos : POSITION,
+    out float2 oScreenPos : TEXCOORD0,
+    out float3 oFarRay : TEXCOORD1,
+    #ifdef ORTHO
+        out float3 oNearRay : TEXCOORD2,
+    #endif
+    out float4 oPos : OUTPOSITION)
+{
+    float4x3 modelMatrix = iModelMatrix;
+    float3 worldPos = GetWorldPos(modelMatrix);
+    oPos = GetClipPos(worldPos);
+    oScreenPos = GetScreenPosPreDiv(oPos);
+    oFarRay = GetFarRay(oPos);
+    #ifdef ORTHO
+        oNearRay = GetNearRay(oPos);
+    #endif
+}
+
+void PS(
+    float2 iScreenPos : TEXCOORD0,
+    float3 iFarRay : TEXCOORD1,
+    #ifdef ORTHO
+        float3 iNearRay : TEXCOORD2,
+    #endif
+    out float4 oColor : OUTCOLOR0)
+{
+    // Read the G-buffer once and accumulate all lights of the pixel's cluster
+    float depth = Sample2DLod0(DepthBuffer, iScreenPos).r;
+    #ifdef HWDEPTH
+        depth = ReconstructDepth(depth);
+    #endif
+    #ifdef ORTHO
+        float3 worldPos = lerp(iNearRay, iFarRay, depth);
+    #else
+        float3 worldPos = iFarRay * depth;
+    #endif
+    float4 albedoInput = Sample2DLod0(AlbedoBuffer, iScreenPos);
+    float4 normalInput = Sample2DLod0(NormalBuffer, iScreenPos);
+
+    // Position acquired via near/far ray is relative to camera. Bring position to world space
+    worldPos += cCameraPosPS;
+
+    float3 normal = normalize(normalInput.rgb * 2.0 - 1.0);
+    float3 finalColor = GetClusteredLight(worldPos, normal, albedoInput.rgb, albedoInput.aaa, normalInput.a * 255.0);
+    oColor = float4(finalColor, 0.0);
+}
@@ -16,6 +16,38 @@ float4x3 GetSkinMatrix(float4 blendWeights, int4 blendIndices)
 }
 #endif
 
+#if defined(BAKEDANIM) && defined(INSTANCED) && defined(D3D11)
+Texture2D tAnimMap6 : register(t6);
+
+float4x3 GetBakedBoneMatrix(int column, int2 rows, float t)
+{
+    return transpose(float3x4(
+        lerp(tAnimMap6.Load(int3(column, rows.x, 0)), tAnimMap6.Load(int3(column, rows.y, 0)), t),
+        lerp(tAnimMap6.Load(int3(column + 1, rows.x, 0)), tAnimMap6.Load(int3(column + 1, rows.y, 0)), t),
+        lerp(tAnimMap6.Load(int3(column + 2, rows.x, 0)), tAnimMap6.Load(int3(column + 2, rows.y, 0)), t)));
+}
+
+float4x3 GetBakedAnimMatrix(float4 blendWeights, int4 blendIndices, float4 animData, float4x3 modelInstance)
+{
+    // The instance data holds the first texture row, number of frames, frame rate and frame offset of the animation
+    float numFrames = max(animData.y, 1.0);
+    float frame = cElapsedTime * animData.z + animData.w;
+    frame -= floor(frame / numFrames) * numFrames;
+    float frameFloor = floor(frame);
+    float nextFrame = frameFloor + 1.0 < numFrames ? frameFloor + 1.0 : 0.0;
+    int2 rows = int2(animData.x + frameFloor, animData.x + nextFrame);
+    float t = frame - frameFloor;
+    int4 idx = blendIndices * 3 + (int)cBakedAnimOffset;
+    float4x3 skinMatrix = GetBakedBoneMatrix(idx.x, rows, t) * blendWeights.x +
+        GetBakedBoneMatrix(idx.y, rows, t) * blendWeights.y +
+        GetBakedBoneMatrix(idx.z, rows, t) * blendWeights.z +
+        GetBakedBoneMatrix(idx.w, rows, t) * blendWeights.w;
+    float4x4 skinMatrix4 = float4x4(float4(skinMatrix[0], 0.0), float4(skinMatrix[1], 0.0), float4(skinMatrix[2], 0.0),
+        float4(skinMatrix[3], 1.0));
+    return mul(skinMatrix4, modelInstance);
+}
+#endif
+
 float2 GetTexCoord(float2 iTexCoord)
 {
     return float2(dot(iTexCoord, cUOffset.xy) + cUOffset.w, dot(iTexCoord, cVOffset.xy) + cVOffset.w);
@@ -105,15 +137,90 @@ float3 GetTrailNormal(float4 iPos, float3 iParentPos, float3 iForward)
 }
 #endif
 
+#ifdef CLIPMAP
+// Terrain clipmap: the grid vertices are displaced by a height texture. The model matrix maps grid to heightmap texel coordinates
+Texture2D tHeightMap7 : register(t7);
+SamplerState sHeightMap7 : register(s7);
+
+float GetClipmapHeight(float2 texel)
+{
+    return Sample2DLod0(HeightMap7, (texel + 0.5) / cClipmapMorph.zw).r;
+}
+
+float3 GetClipmapPos(float2 texel)
+{
+    return cClipmapOrigin + cClipmapAxisX * texel.x + cClipmapAxisZ * texel.y + cClipmapAxisY * GetClipmapHeight(texel);
+}
+
+float4 GetClipmapTexels(float4 iPos, float4x3 modelMatrix)
+{
+    // Return the texel of the vertex in xy, and in zw the texel it collapses to at the end of the node's LOD range.
+    // The odd grid vertices collapse to the even ones, which makes the grid match the next coarser node
+    float2 texel = mul(iPos, modelMatrix).xz;
+    float2 target = texel - frac(iPos.xz * 0.5) * 2.0 * modelMatrix[0].x;
+    float2 maxTexel = cClipmapMorph.zw - 1.0;
+    return float4(min(texel, maxTexel), min(target, maxTexel));
+}
+
+float GetClipmapMorph(float2 texel, float4x3 modelMatrix)
+{
+    float dist = distance(GetClipmapPos(texel), cCameraPos);
+    return saturate((dist / (modelMatrix[0].x * cClipmapMorph.x) - cClipmapMorph.y) / (1.0 - cClipmapMorph.y));
+}
+
+float3 GetClipmapWorldPos(float4 iPos, float4x3 modelMatrix)
+{
+    float4 texels = GetClipmapTexels(iPos, modelMatrix);
+    return lerp(GetClipmapPos(texels.xy), GetClipmapPos(texels.zw), GetClipmapMorph(texels.xy, modelMatrix));
+}
+
+float2 GetClipmapTexel(float4 iPos, float4x3 modelMatrix)
+{
+    float4 texels = GetClipmapTexels(iPos, modelMatrix);
+    return lerp(texels.xy, texels.zw, GetClipmapMorph(texels.xy, modelMatrix));
+}
+
+float3 GetClipmapTangentX(float2 texel)
+{
+    return cClipmapAxisX * 2.0 + cClipmapAxisY * (GetClipmapHeight(texel + float2(1.0, 0.0)) - GetClipmapHeight(texel - float2(1.0, 0.0)));
+}
+
+float3 GetClipmapTangentZ(float2 texel)
+{
+    return cClipmapAxisZ * 2.0 + cClipmapAxisY * (GetClipmapHeight(texel + float2(0.0, 1.0)) - GetClipmapHeight(texel - float2(0.0, 1.0)));
+}
+
+float3 GetClipmapNormal(float4 iPos, float4x3 modelMatrix)
+{
+    float2 texel = floor(GetClipmapTexel(iPos, modelMatrix) + 0.5);
+    return normalize(cross(GetClipmapTangentZ(texel), GetClipmapTangentX(texel)));
+}
+
+float2 GetClipmapTexCoord(float4 iPos, float4x3 modelMatrix)
+{
+    float2 texel = GetClipmapTexel(iPos, modelMatrix);
+    return GetTexCoord(float2(texel.x / (cClipmapMorph.z - 1.0), 1.0 - texel.y / (cClipmapMorph.w - 1.0)));
+}
+#endif
+
 #if defined(SKINNED)
     #define iModelMatrix GetSkinMatrix(iBlendWeights, iBlendIndices)
+#elif defined(BAKEDANIM) && defined(INSTANCED) && defined(D3D11)
+    #define iModelMatrix GetBakedAnimMatrix(iBlendWeights, iBlendIndices, iBakedAnimData, iModelInstance)
 #elif defined(INSTANCED)
     #define iModelMatrix iModelInstance
 #else
     #define iModelMatrix cModel
 #endif
 
-#if defined(BILLBOARD)
+#ifdef CLIPMAP
+    // The terrain texture coordinates are derived from the heightmap position instead of the vertex data
+    #define GetTexCoord(texCoord) GetClipmapTexCoord(iPos, iModelMatrix)
+#endif
+
+#if defined(CLIPMAP)
+    #define GetWorldPos(modelMatrix) GetClipmapWorldPos(iPos, modelMatrix)
+#elif defined(BILLBOARD)
     #define GetWorldPos(modelMatrix) GetBillboardPos(iPos, iSize, modelMatrix)
 #elif defined(DIRBILLBOARD)
     #define GetWorldPos(modelMatrix) GetBillboardPos(iPos, iSize, iNormal, modelMatrix)
@@ -125,7 +232,9 @@ float3 GetTrailNormal(float4 iPos, float3 iParentPos, float3 iForward)
     #define GetWorldPos(modelMatrix) mul(iPos, modelMatrix)
 #endif
 
-#if defined(BILLBOARD)
+#if defined(CLIPMAP)
+    #define GetWorldNormal(modelMatrix) GetClipmapNormal(iPos, modelMatrix)
+#elif defined(BILLBOARD)
     #define GetWorldNormal(modelMatrix) GetBillboardNormal()
 #elif defined(DIRBILLBOARD)
     #define GetWorldNormal(modelMatrix) GetBillboardNormal(iPos, iNormal, modelMatrix)
@@ -137,7 +246,9 @@ float3 GetTrailNormal(float4 iPos, float3 iParentPos, float3 iForward)
     #define GetWorldNormal(modelMatrix) normalize(mul(iNormal, (float3x3)modelMatrix))
 #endif
 
-#if defined(BILLBOARD)
+#if defined(CLIPMAP)
+    #define GetWorldTangent(modelMatrix) float4(normalize(GetClipmapTangentX(floor(GetClipmapTexel(iPos, modelMatrix) + 0.5))), 1.0)
+#elif defined(BILLBOARD)
     #define GetWorldTangent(modelMatrix) float4(normalize(mul(float3(1.0, 0.0, 0.0), cBillboardRot)), 1.0)
 #elif defined(DIRBILLBOARD)
     #define GetWorldTangent(modelMatrix) float4(normalize(mul(float3(1.0, 0.0, 0.0), (float3x3)modelMatrix)), 1.0)
@@ -154,11 +265,13 @@ float3 GetTrailNormal(float4 iPos, float3 iParentPos, float3 iForward)
 #define OUTCOLOR1 SV_TARGET1
 #define OUTCOLOR2 SV_TARGET2
 #define OUTCOLOR3 SV_TARGET3
+#define OUTDEPTH SV_DEPTH
 #else
 #define OUTCOLOR0 COLOR0
 #define OUTCOLOR1 COLOR1
 #define OUTCOLOR2 COLOR2
 #define OUTCOLOR3 COLOR3
+#define OUTDEPTH DEPTH
 #endif
 
 #endif
@@ -76,6 +76,10 @@ uniform float4x4 cLightMatricesPS[4];
 #ifdef VSM_SHADOW
 uniform float2 cVSMShadowParams;
 #endif
+#ifdef CLUSTERED
+uniform float4x4 cClusterMatrix;
+uniform float4 cClusterParams;
+#endif
 #endif
 
 #else
@@ -129,6 +133,16 @@ cbuffer MaterialVS : register(b4)
 {
     float4 cUOffset;
     float4 cVOffset;
+#ifdef CLIPMAP
+    float3 cClipmapOrigin;
+    float3 cClipmapAxisX;
+    float3 cClipmapAxisY;
+    float3 cClipmapAxisZ;
+    float4 cClipmapMorph;
+#endif
+#ifdef BAKEDANIM
+    float cBakedAnimOffset;
+#endif
 }
 #endif
 
@@ -160,6 +174,10 @@ cbuffer CameraPS : register(b1)
     float2 cGBufferInvSize;
     float cNearClipPS;
     float cFarClipPS;
+#ifdef CLUSTERED
+    float4x4 cClusterMatrix;
+    float4 cClusterParams;
+#endif
 }
 
 cbuffer ZonePS : register(b2)
@@ -96,6 +96,7 @@ const StringHash JSON_TYPE_GENERIC("json");
 const StringHash BINARY_TYPE_SCENE("USCN");
 const StringHash BINARY_TYPE_PACKAGE("UPAK");
 const StringHash BINARY_TYPE_COMPRESSED_PACKAGE("ULZ4");
+const StringHash BINARY_TYPE_PACKAGE2("UPK2");
 const StringHash BINARY_TYPE_ANGELSCRIPT("ASBC");
 const StringHash BINARY_TYPE_MODEL("UMDL");
 const StringHash BINARY_TYPE_MODEL2("UMD2");
@@ -1086,7 +1087,7 @@ int GetResourceType(StringHash fileType)
         return RESOURCE_TYPE_SCENE;
     else if (fileType == BINARY_TYPE_PACKAGE)
         return RESOURCE_TYPE_UNUSABLE;
-    else if (fileType == BINARY_TYPE_COMPRESSED_PACKAGE)
+    else if (fileType == BINARY_TYPE_COMPRESSED_PACKAGE || fileType == BINARY_TYPE_PACKAGE2)
         return RESOURCE_TYPE_UNUSABLE;
     else if (fileType == BINARY_TYPE_ANGELSCRIPT)
         return RESOURCE_TYPE_SCRIPTFILE;
@@ -1311,6 +1312,8 @@ bool GetBinaryType(String path, StringHash &out fileType, bool useCache = false)
         fileType = BINARY_TYPE_PACKAGE;
     else if (type == BINARY_TYPE_COMPRESSED_PACKAGE)
         fileType = BINARY_TYPE_COMPRESSED_PACKAGE;
+    else if (type == BINARY_TYPE_PACKAGE2)
+        fileType = BINARY_TYPE_PACKAGE2;
     else if (type == BINARY_TYPE_ANGELSCRIPT)
         fileType = BINARY_TYPE_ANGELSCRIPT;
     else if (type == BINARY_TYPE_MODEL || type == BINARY_TYPE_MODEL2)